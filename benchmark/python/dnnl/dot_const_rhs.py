@@ -0,0 +1,124 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# Benchmark of the oneDNN dot and batch_dot with a constant rhs, e.g. weights, which is reordered
+# once to the format picked by oneDNN. Run it with MXNET_ONEDNN_CACHE_CONST_OPERANDS=0 for the
+# plain format read at every call, on AMX hosts the bfloat16 and int8 kernels gain the most.
+
+import time
+import gc
+import sys
+import mxnet as mx
+from mxnet.amp import amp
+from mxnet.contrib import quantization
+from mxnet.gluon import nn
+
+# lhs shape, rhs shape
+dot_sizes = [
+    ((  1, 1024), (1024, 1024)),
+    (( 32, 1024), (1024, 4096)),
+    ((128, 4096), (4096, 1024)),
+    ((512, 1024), (1024, 1024))]
+
+batch_dot_sizes = [
+    ((16,   1, 1024), (16, 1024, 1024)),
+    ((16,  32, 1024), (16, 1024,  512)),
+    ((16, 128,  512), (16,  512,  512))]
+
+rounds = 1000
+warmup = 10
+
+test_header = "--no_test_header" not in sys.argv
+table_header = "--no_table_header" not in sys.argv
+table_left_colums = "--no_size_column" not in sys.argv
+
+def print_header(header):
+    print("\n")
+    print(header if test_header else "", "\n")
+    if table_header:
+        if table_left_colums:
+            print("|      lhs       |       rhs       | Mean [ms] |" )
+            print("|---------------:|----------------:|----------:|" )
+        else:
+            print(" Mean [ms] |" )
+            print("----------:|" )
+
+def print_value(lhs_shape, rhs_shape, mean):
+    if table_left_colums:
+        print(f"| {str(lhs_shape):>14} | {str(rhs_shape):>15} | {mean:9.3f} |")
+    else:
+        print(f" {mean:9.3f} |")
+
+def measure(net, data, lhs_shape, rhs_shape):
+    mx.nd.waitall()
+    gc.collect()
+    gc.disable()
+    for i in range(rounds + warmup):
+        if i == warmup:
+            start_time = time.time()
+        o = net(data)
+        o.wait_to_read()
+    end_time = time.time()
+    run_time = (end_time - start_time)
+    print_value(lhs_shape, rhs_shape, 1000 * run_time / rounds)
+    gc.enable()
+
+
+class DotConstRhs(nn.HybridBlock):
+    def __init__(self, rhs_shape, batch_dot, **kwargs):
+        super(DotConstRhs, self).__init__(**kwargs)
+        self.rhs = mx.gluon.Parameter('rhs', shape=rhs_shape)
+        self.batch_dot = batch_dot
+
+    def forward(self, data):
+        rhs = self.rhs.data().as_nd_ndarray()
+        if self.batch_dot:
+            out = mx.nd.batch_dot(data.as_nd_ndarray(), rhs)
+        else:
+            out = mx.nd.dot(data.as_nd_ndarray(), rhs)
+        return out.as_np_ndarray()
+
+def benchmark(batch_dot, dtype):
+    header = ('batch_dot' if batch_dot else 'dot') + ', ' + dtype
+    print_header(header)
+    for lhs_shape, rhs_shape in (batch_dot_sizes if batch_dot else dot_sizes):
+        net = DotConstRhs(rhs_shape, batch_dot)
+        net.initialize()
+        net.hybridize(static_alloc=True, static_shape=True)
+        data = mx.np.random.uniform(size=lhs_shape, low=-1.0, high=1.0)
+        if dtype == 'bfloat16':
+            net = amp.convert_hybrid_block(net, data, target_dtype='bfloat16',
+                                           target_dtype_ops=['dot', 'batch_dot'],
+                                           cast_params_offline=True)
+        elif dtype == 'int8':
+            calib_data = mx.gluon.data.DataLoader(mx.gluon.data.ArrayDataset(data),
+                                                 batch_size=lhs_shape[0])
+            net = quantization.quantize_net(net,
+                                            device=mx.cpu(),
+                                            calib_mode='naive',
+                                            calib_data=calib_data,
+                                            num_calib_batches=1,
+                                            quantize_mode='full')
+        net.hybridize(static_alloc=True, static_shape=True)
+        measure(net, data, lhs_shape, rhs_shape)
+
+for dtype in ['float32', 'bfloat16']:
+    benchmark(False, dtype)
+
+# only batch_dot has a quantized oneDNN version
+for dtype in ['float32', 'bfloat16', 'int8']:
+    benchmark(True, dtype)
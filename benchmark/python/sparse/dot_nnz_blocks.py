@@ -0,0 +1,103 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Compare the CPU kernels of dot(csr, dns) balanced by the number of non-zeros with the
+kernels parallelized over evenly sized row blocks (MXNET_CSR_DOT_NNZ_BLOCKS=0).
+
+The rows of the csr matrix get a power law number of non-zeros, like the sparse features
+of wide-and-deep models, so that a few rows hold most of the work.
+"""
+
+import os
+import time
+import argparse
+
+import mxnet as mx
+import numpy as np
+import scipy.sparse as sp
+from mxnet.test_utils import assert_almost_equal
+
+PARSER = argparse.ArgumentParser(description="Benchmark dot(csr, dns) on CPU",
+                                 formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+PARSER.add_argument('--num-rows', type=int, nargs='+', default=[256, 4096, 65536],
+                    help='rows of the csr matrix')
+PARSER.add_argument('--feature-dim', type=int, default=100000,
+                    help='columns of the csr matrix')
+PARSER.add_argument('--output-dim', type=int, nargs='+', default=[16, 128, 1024],
+                    help='columns of the dense matrix')
+PARSER.add_argument('--avg-nnz', type=int, default=64,
+                    help='average number of non-zeros per row')
+PARSER.add_argument('--skew', type=float, default=1.5,
+                    help='exponent of the power law of the non-zeros per row, 0 for uniform')
+PARSER.add_argument('--num-repeat', type=int, default=10,
+                    help='runs averaged for each measure')
+ARGS = PARSER.parse_args()
+
+
+def random_csr(num_rows, num_cols, avg_nnz, skew):
+    if skew > 0:
+        weights = np.random.pareto(skew, size=num_rows) + 1
+    else:
+        weights = np.ones(num_rows)
+    row_nnz = np.minimum(np.maximum(1, weights / weights.mean() * avg_nnz), num_cols)
+    row_nnz = row_nnz.astype(np.int64)
+    indptr = np.concatenate([[0], np.cumsum(row_nnz)])
+    indices = np.concatenate([np.sort(np.random.choice(num_cols, n, replace=False))
+                              if n < num_cols // 2 else np.arange(n) for n in row_nnz])
+    data = np.random.uniform(-1, 1, size=indptr[-1]).astype(np.float32)
+    return sp.csr_matrix((data, indices, indptr), shape=(num_rows, num_cols))
+
+
+def measure_cost(repeat, func, *args, **kwargs):
+    mx.nd.waitall()
+    func(*args, **kwargs).wait_to_read()
+    start = time.time()
+    for _ in range(repeat):
+        func(*args, **kwargs)
+    mx.nd.waitall()
+    return (time.time() - start) / repeat
+
+
+def run(nnz_blocks, *args, **kwargs):
+    os.environ['MXNET_CSR_DOT_NNZ_BLOCKS'] = '1' if nnz_blocks else '0'
+    cost = measure_cost(ARGS.num_repeat, mx.nd.sparse.dot, *args, **kwargs)
+    out = mx.nd.sparse.dot(*args, **kwargs)
+    return cost, out
+
+
+def bench_dot():
+    fmt = '{:>10} {:>12} {:>10} {:>10} {:>10} {:>15} {:>15} {:>10}'
+    print(fmt.format('rows', 'features', 'out_dim', 'nnz', 'transpose',
+                     'row blocks(ms)', 'nnz blocks(ms)', 'speedup'))
+    for num_rows in ARGS.num_rows:
+        csr_sp = random_csr(num_rows, ARGS.feature_dim, ARGS.avg_nnz, ARGS.skew)
+        csr = mx.nd.sparse.csr_matrix(csr_sp)
+        for output_dim in ARGS.output_dim:
+            for transpose in [False, True]:
+                rhs_rows = num_rows if transpose else ARGS.feature_dim
+                rhs = mx.nd.random.uniform(shape=(rhs_rows, output_dim))
+                old_cost, old_out = run(False, csr, rhs, transpose_a=transpose)
+                new_cost, new_out = run(True, csr, rhs, transpose_a=transpose)
+                assert_almost_equal(old_out.asnumpy(), new_out.asnumpy(), rtol=1e-4, atol=1e-4)
+                print(fmt.format(num_rows, ARGS.feature_dim, output_dim, csr_sp.nnz, str(transpose),
+                                 '{:.3f}'.format(old_cost * 1000), '{:.3f}'.format(new_cost * 1000),
+                                 '{:.2f}x'.format(old_cost / new_cost)))
+    os.environ.pop('MXNET_CSR_DOT_NNZ_BLOCKS')
+
+
+if __name__ == "__main__":
+    bench_dot()
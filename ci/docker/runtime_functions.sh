@@ -1044,11 +1044,19 @@ integrationtest_ubuntu_cpu_dist_kvstore() {
     python3 ../../tools/launch.py -n 7 --launcher local python3 dist_sync_kvstore.py --type=gluon_type_cpu
     python3 ../../tools/launch.py -n 7 --launcher local python3 dist_sync_kvstore.py
     python3 ../../tools/launch.py -n 7 --launcher local python3 dist_sync_kvstore.py --no-multiprecision
+    MXNET_KVSTORE_ROW_CACHE_SIZE=100 python3 ../../tools/launch.py -n 7 --launcher local python3 dist_sync_kvstore.py --type=row_sparse_cache_cpu
+    MXNET_KVSTORE_ELASTIC=1 python3 ../../tools/launch.py -n 7 --launcher local python3 dist_sync_kvstore.py --type=elastic_cpu
+    MXNET_KVSTORE_SERVER_THREADS=4 python3 ../../tools/launch.py -n 7 --launcher local python3 dist_sync_kvstore.py
+    MXNET_KVSTORE_SERVER_THREADS=4 python3 ../../tools/launch.py -n 7 --launcher local python3 dist_sync_kvstore.py --type=gluon_sparse_step_cpu
+    MXNET_KVSTORE_FUSION_BOUND=1048576 python3 ../../tools/launch.py -n 7 --launcher local python3 dist_sync_kvstore.py
+    MXNET_KVSTORE_FUSION_BOUND=1048576 python3 ../../tools/launch.py -n 7 --launcher local python3 dist_sync_kvstore.py --type=gluon_step_cpu
+    MXNET_KVSTORE_FUSION_BOUND=1048576 MXNET_KVSTORE_SERVER_THREADS=4 python3 ../../tools/launch.py -n 7 --launcher local python3 dist_sync_kvstore.py --no-multiprecision
     python3 ../../tools/launch.py -n 7 --launcher local python3 dist_sync_kvstore.py --type=compressed_cpu_1bit
     python3 ../../tools/launch.py -n 7 --launcher local python3 dist_sync_kvstore.py --type=compressed_cpu_1bit --no-multiprecision
     python3 ../../tools/launch.py -n 7 --launcher local python3 dist_sync_kvstore.py --type=compressed_cpu_2bit
     python3 ../../tools/launch.py -n 7 --launcher local python3 dist_sync_kvstore.py --type=compressed_cpu_2bit --no-multiprecision
     python3 ../../tools/launch.py -n 3 --launcher local python3 test_server_profiling.py
+    python3 dist_sync_allreduce_kvstore.py --num-workers 4
     popd
 }
 
@@ -0,0 +1,131 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# coding: utf-8
+"""Build the kernels tuned by the TVM auto-scheduler for the shapes of a model.
+
+The workloads are auto-scheduler workloads registered with `mxnet_workload`, in a python
+file given with --workloads. Each of them computes one call of a registered MXNet operator:
+it returns the tensors of the inputs of the operator, in their order, followed by the tensors
+of its outputs. After tuning the workloads with the auto-scheduler, this script builds the best
+schedule of each of them from the tuning logs into a library, with a json manifest of its
+kernels. Load them at runtime with `mx.tvmop.load_tuned_kernels(library)`, so that the calls of
+the operators with the tuned dtypes, shapes and attributes run the tuned kernels, without
+rebuilding MXNet.
+
+Example of a workloads file::
+
+    from tvm import te, topi
+    from tvmop.tune import mxnet_workload
+
+    @mxnet_workload("FullyConnected", no_bias="True", num_hidden="512", flatten="True")
+    def dense_64x1024x512():
+        data = te.placeholder((64, 1024), name="data")
+        weight = te.placeholder((512, 1024), name="weight")
+        return [data, weight, topi.nn.dense(data, weight)]
+"""
+import argparse
+import importlib.util
+import json
+import logging
+import os
+import sys
+
+import tvm
+from tvm import auto_scheduler
+
+logging.basicConfig(level=logging.INFO)
+
+# operator and attributes of the registered workloads, by function name
+__WORKLOADS__ = {}
+
+
+def mxnet_workload(op_name, **attrs):
+    """Register an auto-scheduler workload computing a call of an MXNet operator.
+
+    Parameters
+    ----------
+    op_name : str
+        The registered MXNet operator.
+    attrs : str
+        The attributes of the calls of the operator the workload is valid for, as strings.
+    """
+    def register(func):
+        __WORKLOADS__[func.__name__] = (op_name, {k: str(v) for k, v in attrs.items()})
+        return auto_scheduler.register_workload(func)
+    return register
+
+
+def build(log_files, target, output):
+    """Build the best schedules of the tuning logs into output.so and its output.json manifest."""
+    keys = []
+    for log_file in log_files:
+        for inp, _ in auto_scheduler.load_records(log_file):
+            key = inp.task.workload_key
+            if key not in keys:
+                keys.append(key)
+    device = "cpu" if tvm.target.Target(target).kind.name == "llvm" else "gpu"
+    mod = tvm.IRModule({})
+    kernels = []
+    for key in keys:
+        func_name = json.loads(key)[0]
+        if func_name not in __WORKLOADS__:
+            logging.warning("Skipping the workload %s, which is not an MXNet workload", func_name)
+            continue
+        op_name, attrs = __WORKLOADS__[func_name]
+        task = auto_scheduler.SearchTask(workload_key=key, target=target)
+        best = None
+        for log_file in log_files:
+            # the best schedule is looked up in each log, as apply_best takes one of them
+            inp, res = auto_scheduler.load_best_record(log_file, key, target)
+            if inp is None:
+                continue
+            cost = sum(float(c) for c in res.costs) / len(res.costs)
+            if best is None or cost < best[0]:
+                best = (cost, log_file)
+        sch, args = task.apply_best(best[1])
+        kernel_name = "tuned_" + func_name
+        mod.update(tvm.lower(sch, args, name=kernel_name))
+        kernels.append({"op": op_name,
+                        "func": kernel_name,
+                        "device": device,
+                        "attrs": attrs,
+                        "dtypes": [str(arg.dtype) for arg in args],
+                        "shapes": [[int(dim) for dim in arg.shape] for arg in args]})
+        logging.info("Built %s for %s with a cost of %g s", kernel_name, op_name, best[0])
+    tvm.build(mod, target=target).export_library(output + ".so")
+    with open(output + ".json", "w") as f:
+        json.dump(kernels, f, indent=2)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Build the kernels tuned by the auto-scheduler")
+    parser.add_argument("--workloads", required=True,
+                        help="Python file registering the workloads with mxnet_workload")
+    parser.add_argument("--log", required=True, nargs="+", dest="log_files",
+                        help="Tuning logs of the auto-scheduler")
+    parser.add_argument("--target", default="llvm", help="TVM target of the kernels")
+    parser.add_argument("-o", required=True, dest="output",
+                        help="Path of the library and of its manifest, without extension")
+    arguments = parser.parse_args()
+
+    # the workloads register with the tvmop.tune module, not with this script
+    sys.path.append(os.path.dirname(sys.path[0]))
+    from tvmop import tune
+    spec = importlib.util.spec_from_file_location("workloads", arguments.workloads)
+    spec.loader.exec_module(importlib.util.module_from_spec(spec))
+    tune.build(arguments.log_files, arguments.target, os.path.abspath(arguments.output))
@@ -0,0 +1,436 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file model_throughput.cpp
+ * \brief End-to-end throughput benchmark of an exported model run with a CachedOp.
+ *
+ * Loads a symbol JSON (and optionally its parameters), feeds it synthetic inputs and runs
+ * forward, or forward and backward, for a number of iterations. Reports the throughput in
+ * images or tokens per second, the latency percentiles of an iteration and the peak memory.
+ */
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "mxnet/c_api.h"
+#include "mxnet-cpp/MxNetCpp.h"
+
+using namespace mxnet::cpp;
+
+#define CHECK_MX_CALL(call)                 \
+  do {                                      \
+    if ((call) != 0) {                      \
+      LOG(FATAL) << MXGetLastError();       \
+    }                                       \
+  } while (0)
+
+/*! \brief How a synthetic input is filled */
+enum class Fill { kRandom, kZeros, kValue };
+
+/*! \brief A data input of the model, all other inputs are parameters */
+struct InputSpec {
+  std::string name;
+  std::vector<mx_uint> shape;
+  Fill fill;
+  float value;
+};
+
+/*! \brief Shapes of the data inputs and unit of work of one batch */
+struct Workload {
+  std::vector<InputSpec> inputs;
+  std::string unit;
+  size_t units_per_batch;
+};
+
+// Inputs of the standard models as exported by Gluon and GluonNLP. Inputs missing from the symbol
+// are skipped, and the shapes of other data inputs (e.g. RNN begin states) are inferred.
+Workload PresetWorkload(const std::string& model, mx_uint batch_size, mx_uint seq_len) {
+  Workload w;
+  if (model == "resnet50") {
+    w.inputs = {{"data", {batch_size, 3, 224, 224}, Fill::kRandom, 0.f},
+                {"softmax_label", {batch_size}, Fill::kZeros, 0.f}};
+    w.unit            = "images";
+    w.units_per_batch = batch_size;
+  } else if (model == "bert") {
+    // token ids, token types and valid lengths, the ids are kept in the vocabulary
+    w.inputs = {{"data0", {batch_size, seq_len}, Fill::kZeros, 0.f},
+                {"data1", {batch_size, seq_len}, Fill::kZeros, 0.f},
+                {"data2", {batch_size}, Fill::kValue, static_cast<float>(seq_len)}};
+    w.unit            = "tokens";
+    w.units_per_batch = batch_size * seq_len;
+  } else if (model == "lstm") {
+    // TNC layout of the word language model
+    w.inputs          = {{"data", {seq_len, batch_size}, Fill::kZeros, 0.f}};
+    w.unit            = "tokens";
+    w.units_per_batch = batch_size * seq_len;
+  } else {
+    LOG(FATAL) << "Unknown model preset " << model << ", expected resnet50, bert or lstm";
+  }
+  return w;
+}
+
+// name:d0,d1,... with an optional :value suffix filling the input with a constant
+InputSpec ParseInput(const std::string& spec) {
+  InputSpec input{"", {}, Fill::kRandom, 0.f};
+  std::stringstream ss(spec);
+  std::string shape, value;
+  std::getline(ss, input.name, ':');
+  std::getline(ss, shape, ':');
+  if (std::getline(ss, value, ':')) {
+    input.fill  = Fill::kValue;
+    input.value = std::stof(value);
+  }
+  std::stringstream dims(shape);
+  std::string dim;
+  while (std::getline(dims, dim, ',')) {
+    input.shape.push_back(static_cast<mx_uint>(std::stoul(dim)));
+  }
+  CHECK(!input.name.empty() && !input.shape.empty()) << "Malformed --input " << spec;
+  return input;
+}
+
+// type flags of mshadow/base.h
+const std::map<std::string, int> kTypeFlags = {{"float32", 0},
+                                               {"float64", 1},
+                                               {"float16", 2},
+                                               {"uint8", 3},
+                                               {"int32", 4},
+                                               {"int8", 5},
+                                               {"int64", 6},
+                                               {"bfloat16", 12}};
+
+std::string TypeName(int flag) {
+  for (const auto& kv : kTypeFlags) {
+    if (kv.second == flag)
+      return kv.first;
+  }
+  LOG(FATAL) << "Unknown type flag " << flag;
+  return "";
+}
+
+void FillArray(NDArray* arr, Fill fill, float value) {
+  if (fill == Fill::kRandom) {
+    Operator("_random_uniform").SetParam("low", -1.f).SetParam("high", 1.f).Invoke(*arr);
+  } else {
+    *arr = fill == Fill::kZeros ? 0.f : value;
+  }
+}
+
+/*! \brief Peak memory in MB: device memory in use for a GPU, resident set size for the CPU */
+class PeakMemory {
+ public:
+  explicit PeakMemory(const Context& ctx) : ctx_(ctx) {}
+
+  // device memory is sampled between iterations, which includes the memory pool of MXNet
+  void Sample() {
+    if (ctx_.GetDeviceType() != DeviceType::kGPU)
+      return;
+    uint64_t free_mem, total_mem;
+    CHECK_MX_CALL(MXGetGPUMemoryInformation64(ctx_.GetDeviceId(), &free_mem, &total_mem));
+    peak_mb_ = std::max(peak_mb_, static_cast<double>(total_mem - free_mem) / (1 << 20));
+  }
+
+  double PeakMB() const {
+    if (ctx_.GetDeviceType() == DeviceType::kGPU)
+      return peak_mb_;
+#ifndef _WIN32
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+#else
+    return 0;
+#endif
+  }
+
+ private:
+  Context ctx_;
+  double peak_mb_ = 0;
+};
+
+double Percentile(const std::vector<double>& sorted, double p) {
+  const size_t rank = static_cast<size_t>(std::ceil(p / 100 * sorted.size()));
+  return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+void printUsage() {
+  std::cout << "Usage:" << std::endl;
+  std::cout << "model_throughput --symbol_file <model symbol file in json format>" << std::endl
+            << "--params_file <model params file, default: random parameters>" << std::endl
+            << "--model <input preset: resnet50, bert or lstm, default: resnet50>" << std::endl
+            << "--input <data input name:shape, e.g. \"data:32,3,224,224\", with an optional "
+            << ":value to fill it with a constant. Replaces the preset inputs, repeatable>"
+            << std::endl
+            << "--unit <unit of work reported, default: the one of the preset>" << std::endl
+            << "--units_per_batch <units of work in one batch, default: the one of the preset>"
+            << std::endl
+            << "--batch_size <default: 32>" << std::endl
+            << "--seq_len <sequence length of the bert and lstm presets, default: 128>" << std::endl
+            << "--dtype <type of the floating point data inputs, the types of the parameters are "
+            << "inferred from the graph. default: \"float32\" "
+            << "choices: [\"float32\",\"float16\",\"bfloat16\"]>" << std::endl
+            << "--backend <subgraph backend to partition the graph for, default: none>"
+            << std::endl
+            << "--inference <run forward only, default: forward and backward>" << std::endl
+            << "--no_static <disable static_alloc and static_shape of the CachedOp>" << std::endl
+            << "--warmup <number of iterations not measured, default: 10>" << std::endl
+            << "--iterations <number of iterations measured, default: 100>" << std::endl
+            << "--gpu <GPU id to run on, default: CPU>" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  std::string symbol_file;
+  std::string params_file;
+  std::string model = "resnet50";
+  std::vector<InputSpec> user_inputs;
+  std::string unit;
+  size_t units_per_batch = 0;
+  mx_uint batch_size     = 32;
+  mx_uint seq_len        = 128;
+  std::string dtype      = "float32";
+  std::string backend;
+  bool training     = true;
+  bool static_graph = true;
+  int warmup        = 10;
+  int iterations    = 100;
+  int gpu           = -1;
+
+  for (int index = 1; index < argc; ++index) {
+    const bool has_value = index + 1 < argc;
+    if (strcmp("--symbol_file", argv[index]) == 0 && has_value) {
+      symbol_file = argv[++index];
+    } else if (strcmp("--params_file", argv[index]) == 0 && has_value) {
+      params_file = argv[++index];
+    } else if (strcmp("--model", argv[index]) == 0 && has_value) {
+      model = argv[++index];
+    } else if (strcmp("--input", argv[index]) == 0 && has_value) {
+      user_inputs.push_back(ParseInput(argv[++index]));
+    } else if (strcmp("--unit", argv[index]) == 0 && has_value) {
+      unit = argv[++index];
+    } else if (strcmp("--units_per_batch", argv[index]) == 0 && has_value) {
+      units_per_batch = strtoul(argv[++index], nullptr, 10);
+    } else if (strcmp("--batch_size", argv[index]) == 0 && has_value) {
+      batch_size = strtoul(argv[++index], nullptr, 10);
+    } else if (strcmp("--seq_len", argv[index]) == 0 && has_value) {
+      seq_len = strtoul(argv[++index], nullptr, 10);
+    } else if (strcmp("--dtype", argv[index]) == 0 && has_value) {
+      dtype = argv[++index];
+    } else if (strcmp("--backend", argv[index]) == 0 && has_value) {
+      backend = argv[++index];
+    } else if (strcmp("--inference", argv[index]) == 0) {
+      training = false;
+    } else if (strcmp("--no_static", argv[index]) == 0) {
+      static_graph = false;
+    } else if (strcmp("--warmup", argv[index]) == 0 && has_value) {
+      warmup = strtol(argv[++index], nullptr, 10);
+    } else if (strcmp("--iterations", argv[index]) == 0 && has_value) {
+      iterations = strtol(argv[++index], nullptr, 10);
+    } else if (strcmp("--gpu", argv[index]) == 0 && has_value) {
+      gpu = strtol(argv[++index], nullptr, 10);
+    } else {
+      printUsage();
+      return strcmp("--help", argv[index]) == 0 ? 0 : 1;
+    }
+  }
+  if (symbol_file.empty() || iterations <= 0) {
+    printUsage();
+    return 1;
+  }
+
+  Workload workload = PresetWorkload(model, batch_size, seq_len);
+  if (!user_inputs.empty())
+    workload.inputs = user_inputs;
+  if (!unit.empty())
+    workload.unit = unit;
+  if (units_per_batch > 0)
+    workload.units_per_batch = units_per_batch;
+  const Context ctx  = gpu >= 0 ? Context::gpu(gpu) : Context::cpu();
+  CHECK(dtype == "float32" || dtype == "float16" || dtype == "bfloat16")
+      << "Unsupported dtype " << dtype << ", expected float32, float16 or bfloat16";
+  const int dtype_id = kTypeFlags.at(dtype);
+
+  Symbol net = Symbol::Load(symbol_file);
+  if (!backend.empty())
+    net = net.GetBackendSymbol(backend);
+  const std::vector<std::string> input_names = net.ListInputs();
+
+  // shapes and types of the parameters are inferred from the data inputs present in the graph
+  std::map<std::string, const InputSpec*> data_inputs;
+  std::map<std::string, std::vector<mx_uint>> data_shapes;
+  for (const InputSpec& input : workload.inputs) {
+    if (std::find(input_names.begin(), input_names.end(), input.name) == input_names.end()) {
+      LOG(INFO) << "Skipping input " << input.name << " absent from the symbol";
+      continue;
+    }
+    data_inputs[input.name] = &input;
+    data_shapes[input.name] = input.shape;
+  }
+  std::vector<std::vector<mx_uint>> arg_shapes, aux_shapes, out_shapes;
+  net.InferShape(data_shapes, &arg_shapes, &aux_shapes, &out_shapes);
+  std::vector<const char*> type_keys;
+  std::vector<int> type_values;
+  for (const auto& kv : data_inputs) {
+    type_keys.push_back(kv.first.c_str());
+    type_values.push_back(kv.second->fill == Fill::kRandom ? dtype_id : 0);
+  }
+  mx_uint num_arg_types, num_out_types, num_aux_types;
+  const int *arg_types, *out_types, *aux_types;
+  int complete;
+  CHECK_MX_CALL(MXSymbolInferType(net.GetHandle(),
+                                  type_keys.size(),
+                                  type_keys.data(),
+                                  type_values.data(),
+                                  &num_arg_types,
+                                  &arg_types,
+                                  &num_out_types,
+                                  &out_types,
+                                  &num_aux_types,
+                                  &aux_types,
+                                  &complete));
+  CHECK(complete) << "Could not infer the types of all the inputs of " << symbol_file;
+
+  std::map<std::string, std::pair<std::vector<mx_uint>, int>> input_info;
+  const std::vector<std::string> arg_names = net.ListArguments();
+  const std::vector<std::string> aux_names = net.ListAuxiliaryStates();
+  for (size_t i = 0; i < arg_names.size(); ++i)
+    input_info[arg_names[i]] = {arg_shapes[i], arg_types[i]};
+  for (size_t i = 0; i < aux_names.size(); ++i)
+    input_info[aux_names[i]] = {aux_shapes[i], aux_types[i]};
+
+  std::map<std::string, NDArray> saved_params;
+  if (!params_file.empty())
+    NDArray::Load(params_file, nullptr, &saved_params);
+
+  // the inputs of the CachedOp follow ListInputs, the parameters get a gradient buffer
+  std::vector<NDArray> inputs, grads;
+  std::vector<NDArrayHandle> input_handles, param_handles, grad_handles;
+  std::string data_indices = "[", param_indices = "[";
+  for (size_t i = 0; i < input_names.size(); ++i) {
+    const std::string& name = input_names[i];
+    const auto& info        = input_info.at(name);
+    CHECK(!info.first.empty()) << "Could not infer the shape of " << name
+                               << ", pass it with --input";
+    NDArray arr(info.first, ctx, false, info.second);
+    const bool is_aux   = std::find(aux_names.begin(), aux_names.end(), name) != aux_names.end();
+    const auto data_it  = data_inputs.find(name);
+    const auto saved_it = saved_params.find((is_aux ? "aux:" : "arg:") + name);
+    if (data_it != data_inputs.end()) {
+      FillArray(&arr, data_it->second->fill, data_it->second->value);
+      data_indices += std::to_string(i) + ",";
+    } else {
+      if (saved_it != saved_params.end()) {
+        Operator("Cast")
+            .SetParam("dtype", TypeName(info.second))
+            .PushInput(saved_it->second.Copy(ctx))
+            .Invoke(arr);
+      } else {
+        FillArray(&arr, Fill::kRandom, 0.f);
+      }
+      param_indices += std::to_string(i) + ",";
+      if (!is_aux) {
+        grads.emplace_back(info.first, ctx, false, info.second);
+        param_handles.push_back(arr.GetHandle());
+        grad_handles.push_back(grads.back().GetHandle());
+      }
+    }
+    inputs.push_back(arr);
+    input_handles.push_back(arr.GetHandle());
+  }
+  data_indices += "]";
+  param_indices += "]";
+  NDArray::WaitAll();
+
+  const std::string static_str         = static_graph ? "true" : "false";
+  std::vector<const char*> flag_keys   = {
+      "data_indices", "param_indices", "static_alloc", "static_shape"};
+  std::vector<const char*> flag_values = {
+      data_indices.c_str(), param_indices.c_str(), static_str.c_str(), static_str.c_str()};
+  CachedOpHandle cached_op;
+  CHECK_MX_CALL(MXCreateCachedOp(
+      net.GetHandle(), flag_keys.size(), flag_keys.data(), flag_values.data(), &cached_op));
+
+  int prev;
+  CHECK_MX_CALL(MXAutogradSetIsTraining(training, &prev));
+  if (training) {
+    std::vector<mx_uint> reqs(param_handles.size(), 1);  // kWriteTo
+    CHECK_MX_CALL(MXAutogradMarkVariables(
+        param_handles.size(), param_handles.data(), reqs.data(), grad_handles.data()));
+  }
+
+  PeakMemory memory(ctx);
+  std::vector<double> latencies_ms;
+  for (int iter = 0; iter < warmup + iterations; ++iter) {
+    const auto start = std::chrono::steady_clock::now();
+    int num_outputs;
+    NDArrayHandle* outputs;
+    const int* out_stypes;
+    CHECK_MX_CALL(MXAutogradSetIsRecording(training, &prev));
+    CHECK_MX_CALL(MXInvokeCachedOp(cached_op,
+                                   input_handles.size(),
+                                   input_handles.data(),
+                                   ctx.GetDeviceType(),
+                                   ctx.GetDeviceId(),
+                                   &num_outputs,
+                                   &outputs,
+                                   &out_stypes));
+    CHECK_MX_CALL(MXAutogradSetIsRecording(0, &prev));
+    // the returned array is reused by the next call of the thread
+    std::vector<NDArrayHandle> output_handles(outputs, outputs + num_outputs);
+    if (training) {
+      CHECK_MX_CALL(MXAutogradBackward(num_outputs, output_handles.data(), nullptr, 0));
+    }
+    NDArray::WaitAll();
+    const auto end = std::chrono::steady_clock::now();
+    for (NDArrayHandle output : output_handles)
+      CHECK_MX_CALL(MXNDArrayFree(output));
+    memory.Sample();
+    if (iter >= warmup)
+      latencies_ms.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+  }
+  CHECK_MX_CALL(MXFreeCachedOp(cached_op));
+
+  double total_ms = 0;
+  for (double ms : latencies_ms)
+    total_ms += ms;
+  std::sort(latencies_ms.begin(), latencies_ms.end());
+  std::cout << std::fixed << std::setprecision(2) << "model: " << symbol_file
+            << " mode: " << (training ? "training" : "inference")
+            << " batch_size: " << batch_size << " dtype: " << dtype
+            << " backend: " << (backend.empty() ? "none" : backend)
+            << " context: " << (gpu >= 0 ? "gpu(" + std::to_string(gpu) + ")" : "cpu") << std::endl
+            << "throughput: " << 1e3 * workload.units_per_batch * iterations / total_ms << " "
+            << workload.unit << "/s" << std::endl
+            << "latency (ms): mean " << total_ms / iterations << " p50 "
+            << Percentile(latencies_ms, 50) << " p90 " << Percentile(latencies_ms, 90)
+            << " p99 " << Percentile(latencies_ms, 99) << " max " << latencies_ms.back()
+            << std::endl
+            << "peak memory: " << memory.PeakMB() << " MB" << std::endl;
+  MXNotifyShutdown();
+  return 0;
+}
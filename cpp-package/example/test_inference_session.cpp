@@ -0,0 +1,97 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ * 
+ */
+#include <future>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include "mxnet/c_api.h"
+#include "dmlc/logging.h"
+#include "mxnet-cpp/MxNetCpp.h"
+using namespace mxnet::cpp;
+
+/*
+ * The file is used for testing the runs of an inference session on bound buffers,
+ * synchronous, asynchronous and from several threads.
+ * By running: build/test_inference_session.
+ */
+int main(int argc, char** argv) {
+  const int batch = 4, in_dim = 8, out_dim = 3;
+
+  int gpu_count = 0;
+  if (MXGetGPUCount(&gpu_count) != 0) {
+    LOG(ERROR) << "MXGetGPUCount failed";
+    return -1;
+  }
+  Context context = (gpu_count > 0) ? Context::gpu() : Context::cpu();
+
+  Symbol data = Symbol::Variable("data");
+  Symbol fc   = FullyConnected("fc", data, Symbol::Variable("w"), Symbol::Variable("b"), out_dim);
+  std::map<std::string, NDArray> params;
+  params["w"] = NDArray(Shape(out_dim, in_dim), context, false);
+  params["b"] = NDArray(Shape(out_dim), context, false);
+  params["w"] = 1.0f;
+  params["b"] = 0.5f;
+  InferenceSession session(fc, params, context);
+  CHECK(session.ListDataInputs() == std::vector<std::string>{"data"});
+
+  // every output is the sum of the inputs plus the bias
+  auto check = [&](InferenceSession::Binding* binding, mx_float value) {
+    std::vector<mx_float> out;
+    binding->outputs()[0].SyncCopyToCPU(&out, batch * out_dim);
+    for (mx_float v : out)
+      CHECK_EQ(v, value * in_dim + 0.5f);
+  };
+  auto bind = [&]() {
+    return session.Bind({{"data", NDArray(Shape(batch, in_dim), context, false)}},
+                        {NDArray(Shape(batch, out_dim), context, false)});
+  };
+
+  InferenceSession::Binding binding = bind();
+  for (int i = 0; i < 3; ++i) {
+    NDArray input = binding.inputs().at("data");
+    input         = static_cast<mx_float>(i);
+    session.Run(&binding);
+    check(&binding, i);
+  }
+
+  std::promise<std::string> done;
+  NDArray input = binding.inputs().at("data");
+  input         = 2.0f;
+  session.RunAsync(&binding, [&done](const char* error) { done.set_value(error ? error : ""); });
+  CHECK_EQ(done.get_future().get(), "");
+  check(&binding, 2);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t]() {
+      InferenceSession::Binding thread_binding = bind();
+      for (int i = 0; i < 10; ++i) {
+        NDArray thread_input = thread_binding.inputs().at("data");
+        thread_input         = static_cast<mx_float>(t + i);
+        session.Run(&thread_binding);
+        check(&thread_binding, t + i);
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  return 0;
+}
@@ -27,6 +27,7 @@
 #define MXNET_CPP_MXNETCPP_H_
 
 #include "mxnet-cpp/executor.hpp"
+#include "mxnet-cpp/inference_session.hpp"
 #include "mxnet-cpp/symbol.hpp"
 #include "mxnet-cpp/ndarray.hpp"
 #include "mxnet-cpp/operator.hpp"
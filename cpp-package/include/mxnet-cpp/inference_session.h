@@ -0,0 +1,127 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file inference_session.h
+ * \brief inference on input and output buffers bound once, allocating nothing per run
+ */
+
+#ifndef MXNET_CPP_INFERENCE_SESSION_H_
+#define MXNET_CPP_INFERENCE_SESSION_H_
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "mxnet-cpp/base.h"
+#include "mxnet-cpp/ndarray.h"
+#include "mxnet-cpp/symbol.h"
+
+namespace mxnet {
+namespace cpp {
+
+/*!
+ * \brief Inference session of a symbol, run with static memory on buffers bound once.
+ *  Each thread running the session has its own cached op, whose memory and operator states
+ *  stay warm between its runs. The runs of different threads may be concurrent, on different
+ *  bindings. All the runs must be finished before the session is destroyed.
+ */
+class InferenceSession {
+ public:
+  /*!
+   * \brief Input and output buffers of the session, in device or host pinned memory. A binding
+   *  is used by one run at a time: its inputs are written before the run and its outputs read
+   *  after it completes.
+   */
+  class Binding {
+   public:
+    const std::map<std::string, NDArray>& inputs() const {
+      return inputs_;
+    }
+    const std::vector<NDArray>& outputs() const {
+      return outputs_;
+    }
+
+   private:
+    friend class InferenceSession;
+    std::map<std::string, NDArray> inputs_;
+    std::vector<NDArray> outputs_;
+    std::vector<NDArrayHandle> input_handles_;
+    std::vector<NDArrayHandle> output_handles_;
+    std::function<void(const char*)> on_complete_;
+  };
+
+  /*!
+   * \brief create a session
+   * \param symbol the symbol to run
+   * \param params the parameters and auxiliary states of the symbol, on context
+   * \param context the context the symbol runs on
+   * \param flags flags of the cached op, static_alloc and static_shape are on by default
+   */
+  InferenceSession(const Symbol& symbol,
+                   const std::map<std::string, NDArray>& params,
+                   const Context& context,
+                   const std::map<std::string, std::string>& flags = {});
+  ~InferenceSession();
+  /*!
+   * \return names of the inputs of the symbol which are not parameters
+   */
+  std::vector<std::string> ListDataInputs() const;
+  /*!
+   * \brief bind buffers to the inputs and the outputs of the symbol
+   * \param inputs buffers of the inputs listed by ListDataInputs
+   * \param outputs buffers of the outputs of the symbol, of the shapes and types it infers
+   */
+  Binding Bind(const std::map<std::string, NDArray>& inputs,
+               const std::vector<NDArray>& outputs) const;
+  /*!
+   * \brief push a run of the symbol on a binding to the engine, its outputs can be read after
+   *  NDArray::WaitToRead
+   */
+  void Run(Binding* binding);
+  /*!
+   * \brief push a run of the symbol on a binding to the engine, without blocking
+   * \param binding the binding, which must outlive the run
+   * \param on_complete called on an engine thread once the outputs are written, with the error
+   *  message of a failed run or nullptr. It must not wait for NDArrays.
+   */
+  void RunAsync(Binding* binding, std::function<void(const char* error)> on_complete);
+
+ private:
+  InferenceSession(const InferenceSession&) = delete;
+  InferenceSession& operator=(const InferenceSession&) = delete;
+  CachedOpHandle GetCachedOp();
+  static void OnComplete(const char* error, void* param);
+
+  Symbol symbol_;
+  Context context_;
+  std::map<std::string, NDArray> params_;
+  std::vector<std::string> flag_keys_;
+  std::vector<std::string> flag_vals_;
+  std::mutex mutex_;
+  std::unordered_map<std::thread::id, CachedOpHandle> cached_ops_;
+};
+
+}  // namespace cpp
+}  // namespace mxnet
+
+#endif  // MXNET_CPP_INFERENCE_SESSION_H_
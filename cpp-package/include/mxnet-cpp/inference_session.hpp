@@ -0,0 +1,137 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file inference_session.hpp
+ * \brief implementation of the inference session
+ */
+
+#ifndef MXNET_CPP_INFERENCE_SESSION_HPP_
+#define MXNET_CPP_INFERENCE_SESSION_HPP_
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "mxnet-cpp/inference_session.h"
+
+namespace mxnet {
+namespace cpp {
+
+inline InferenceSession::InferenceSession(const Symbol& symbol,
+                                          const std::map<std::string, NDArray>& params,
+                                          const Context& context,
+                                          const std::map<std::string, std::string>& flags)
+    : symbol_(symbol), context_(context), params_(params) {
+  std::map<std::string, std::string> all_flags = {{"static_alloc", "true"},
+                                                  {"static_shape", "true"}};
+  for (const auto& flag : flags)
+    all_flags[flag.first] = flag.second;
+  for (const auto& flag : all_flags) {
+    flag_keys_.push_back(flag.first);
+    flag_vals_.push_back(flag.second);
+  }
+}
+
+inline InferenceSession::~InferenceSession() {
+  for (const auto& op : cached_ops_)
+    MXFreeCachedOp(op.second);
+}
+
+inline std::vector<std::string> InferenceSession::ListDataInputs() const {
+  std::vector<std::string> names;
+  for (const auto& name : symbol_.ListInputs()) {
+    if (params_.find(name) == params_.end())
+      names.push_back(name);
+  }
+  return names;
+}
+
+inline InferenceSession::Binding InferenceSession::Bind(
+    const std::map<std::string, NDArray>& inputs,
+    const std::vector<NDArray>& outputs) const {
+  Binding binding;
+  binding.inputs_  = inputs;
+  binding.outputs_ = outputs;
+  for (const auto& name : symbol_.ListInputs()) {
+    auto it = inputs.find(name);
+    if (it == inputs.end()) {
+      it = params_.find(name);
+      CHECK(it != params_.end()) << "No buffer bound to the input " << name;
+    }
+    binding.input_handles_.push_back(it->second.GetHandle());
+  }
+  CHECK_EQ(outputs.size(), symbol_.ListOutputs().size())
+      << "Number of output buffers differs from the number of outputs of the symbol";
+  for (const auto& output : outputs)
+    binding.output_handles_.push_back(output.GetHandle());
+  return binding;
+}
+
+inline CachedOpHandle InferenceSession::GetCachedOp() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  CachedOpHandle& op = cached_ops_[std::this_thread::get_id()];
+  if (op == nullptr) {
+    std::vector<const char*> keys, vals;
+    for (size_t i = 0; i < flag_keys_.size(); ++i) {
+      keys.push_back(flag_keys_[i].c_str());
+      vals.push_back(flag_vals_[i].c_str());
+    }
+    CHECK_EQ(MXCreateCachedOp(symbol_.GetHandle(), keys.size(), keys.data(), vals.data(), &op),
+             0);
+  }
+  return op;
+}
+
+inline void InferenceSession::Run(Binding* binding) {
+  int num_outputs        = binding->output_handles_.size();
+  NDArrayHandle* outputs = binding->output_handles_.data();
+  CHECK_EQ(MXInvokeCachedOp(GetCachedOp(),
+                            binding->input_handles_.size(),
+                            binding->input_handles_.data(),
+                            context_.GetDeviceType(),
+                            context_.GetDeviceId(),
+                            &num_outputs,
+                            &outputs,
+                            nullptr),
+           0);
+}
+
+inline void InferenceSession::RunAsync(Binding* binding,
+                                       std::function<void(const char* error)> on_complete) {
+  binding->on_complete_ = std::move(on_complete);
+  Run(binding);
+  CHECK_EQ(MXNDArrayNotifyReady(binding->output_handles_.size(),
+                                binding->output_handles_.data(),
+                                &InferenceSession::OnComplete,
+                                binding),
+           0);
+}
+
+inline void InferenceSession::OnComplete(const char* error, void* param) {
+  Binding* binding = static_cast<Binding*>(param);
+  // the callback may start the next run of the binding
+  auto on_complete = std::move(binding->on_complete_);
+  on_complete(error);
+}
+
+}  // namespace cpp
+}  // namespace mxnet
+
+#endif  // MXNET_CPP_INFERENCE_SESSION_HPP_
@@ -60,6 +60,9 @@ cp /work/build/cpp-package/example/test_score .
 cp /work/build/cpp-package/example/test_ndarray_copy .
 ./test_ndarray_copy
 
+cp /work/build/cpp-package/example/test_inference_session .
+./test_inference_session
+
 # skippping temporarily, tracked by https://github.com/apache/mxnet/issues/20011
 cp /work/build/cpp-package/example/test_regress_label .
 ./test_regress_label
@@ -23,6 +23,7 @@
  */
 
 #include <iostream>
+#include <string>
 #include <utility>
 #include "mxnet/lib_api.h"
 
@@ -236,6 +237,98 @@ REGISTER_OP(state_gemm)
     .setMutateInputs(mutateInputs)
     .setCreateOpState(createOpState, "cpu");
 
+/* ------------------------------------------------------------------------- */
+
+/*
+ * Executes C = alpha * A * B through the fast compute path: alpha is parsed once
+ * when the state is created and the tensors are passed as views, not converted
+ */
+class MyFastGemm : public CustomStatefulOp {
+ public:
+  explicit MyFastGemm(float alpha) : alpha(alpha) {}
+
+  bool supportsFastCompute() const override {
+    return true;
+  }
+
+  MXReturnValue ForwardFast(const MXTensorView* inputs,
+                            int num_inputs,
+                            const MXTensorView* outputs,
+                            int num_outputs,
+                            const OpResource& op_res) override {
+    const float* A = inputs[0].data<float>();
+    const float* B = inputs[1].data<float>();
+    float* C       = outputs[0].data<float>();
+    unsigned n     = inputs[0].shape[0];
+    unsigned k     = inputs[0].shape[1];
+    unsigned m     = inputs[1].shape[1];
+
+    gemm(A, B, C, n, k, m);
+    for (unsigned i = 0; i < n * m; i++)
+      C[i] *= alpha;
+    return MX_SUCCESS;
+  }
+
+  /*
+   * inputs[0] = dC; inputs[1] = A; inputs[2] = B; inputs[3] = C
+   * outputs[0] = dA; outputs[1] = dB
+   */
+  MXReturnValue BackwardFast(const MXTensorView* inputs,
+                             int num_inputs,
+                             const MXTensorView* outputs,
+                             int num_outputs,
+                             const OpResource& op_res) override {
+    const float* dC = inputs[0].data<float>();
+    const float* A  = inputs[1].data<float>();
+    const float* B  = inputs[2].data<float>();
+    float* dA       = outputs[0].data<float>();
+    float* dB       = outputs[1].data<float>();
+    unsigned n      = inputs[1].shape[0];
+    unsigned k      = inputs[1].shape[1];
+    unsigned m      = inputs[2].shape[1];
+    void* workspace = op_res.alloc_cpu((k * n + m * k) * sizeof(float));
+    float* At       = static_cast<float*>(workspace);
+    float* Bt       = static_cast<float*>(workspace) + (k * n);
+
+    transpose(A, At, k, n);
+    transpose(B, Bt, m, k);
+    gemm(dC, Bt, dA, n, m, k);
+    gemm(At, dC, dB, k, n, m);
+    for (unsigned i = 0; i < n * k; i++)
+      dA[i] *= alpha;
+    for (unsigned i = 0; i < k * m; i++)
+      dB[i] *= alpha;
+    return MX_SUCCESS;
+  }
+
+  // only reached with sparse tensors, which this operator does not support
+  MXReturnValue Forward(std::vector<MXTensor>* inputs,
+                        std::vector<MXTensor>* outputs,
+                        const OpResource& op_res) override {
+    MX_ERROR_MSG << "fast_gemm only supports dense tensors";
+    return MX_FAIL;
+  }
+
+ private:
+  const float alpha;
+};
+
+MXReturnValue createFastOpState(const std::unordered_map<std::string, std::string>& attrs,
+                                const MXContext& ctx,
+                                const std::vector<std::vector<unsigned int>>& in_shapes,
+                                const std::vector<int> in_types,
+                                CustomStatefulOp** op_inst) {
+  float alpha = attrs.count("alpha") > 0 ? std::stof(attrs.at("alpha")) : 1.0f;
+  *op_inst    = CustomStatefulOp::create<MyFastGemm>(alpha);
+  return MX_SUCCESS;
+}
+
+REGISTER_OP(fast_gemm)
+    .setParseAttrs(parseAttrs)
+    .setInferType(inferType)
+    .setInferShape(inferShape)
+    .setCreateOpState(createFastOpState, "cpu");
+
 MXReturnValue initialize(int version) {
   if (version >= 10700) {
     std::cout << "MXNet version " << version << " supported" << std::endl;
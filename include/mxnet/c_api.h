@@ -78,6 +78,10 @@ typedef const void* FunctionHandle;
 typedef void* AtomicSymbolCreator;
 /*! \brief handle to cached operator */
 typedef void* CachedOpHandle;
+/*! \brief handle to an operator with parsed attributes, see MXImperativePrepare */
+typedef void* PreparedOpHandle;
+/*! \brief handle to the batcher of the requests of a cached operator */
+typedef void* CachedOpBatcherHandle;
 /*! \brief handle to a symbol that can be bind as operator */
 typedef void* SymbolHandle;
 /*! \brief handle to a AtomicSymbol */
@@ -108,6 +112,8 @@ typedef void* CudaModuleHandle;
 typedef void* CudaKernelHandle;
 /*! \brief handle to a Profile object (domain, duration, counter, etc.) */
 typedef void* ProfileHandle;
+/*! \brief handle to a checkpoint saved in the background */
+typedef void* CheckpointHandle;
 /*! \brief handle to DLManagedTensor*/
 typedef void* DLManagedTensorHandle;
 /*! \brief handle to Context */
@@ -125,6 +131,10 @@ typedef void (*EngineSyncFunc)(void*, void*);
 typedef void (*EngineFuncParamDeleter)(void*);
 /*! \brief Monitor callback called at operator level for cached op */
 typedef void (*CachedOpMonitorCallback)(const char*, const char*, NDArrayHandle);
+/*! \brief Callback of MXNDArrayNotifyReady, with the error message or NULL, and its param */
+typedef void (*NDArrayReadyCallback)(const char*, void*);
+/*! \brief Gradient hook of MXAutogradSetGradHook, called with its param */
+typedef void (*MXGradHookCallback)(void*);
 
 struct NativeOpInfo {
   void (*forward)(int, float**, int*, unsigned**, int*, void*);
@@ -378,7 +388,8 @@ MXNET_DLL int MXDumpProfile(int finished);
  *        How aggregate stats are stored will not change
  * \param out_str will receive a pointer to the output string
  * \param reset clear the aggregate stats after printing
- * \param format whether to return in tabular or json format
+ * \param format 0 for tabular, 1 for json, 2 for the OpenMetrics text format, a snapshot
+ *        which does not stop the profiler and ignores sort_by and ascending
  * \param sort_by sort by total, avg, min, max, or count
  * \param ascending whether to sort ascendingly
  * \return 0 when success, -1 when failure happens.
@@ -390,6 +401,14 @@ MXNET_DLL int MXAggregateProfileStatsPrint(const char** out_str,
                                            int sort_by,
                                            int ascending);
 
+/*!
+ * \brief Mark the end of a training step for the step breakdown of the profiler
+ * \param out_str will receive a pointer to the breakdown of the wall time of the last
+ *        step_report_period steps, every step_report_period steps, else to an empty string
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXProfileMarkStep(const char** out_str);
+
 /*!
  * \brief Pause profiler tuning collection
  * \param paused If nonzero, profiling pauses. Otherwise, profiling resumes/continues
@@ -517,6 +536,60 @@ MXNET_DLL int MXSetNumOMPThreads(int thread_num);
  */
 MXNET_DLL int MXEngineSetBulkSize(int bulk_size, int* prev_bulk_size);
 
+/*!
+ * \brief Create a named stream of a GPU, or get the one of the same name already created.
+ *  The operators pushed on the GPU by a thread which set the stream run in order on their own
+ *  worker and CUDA stream, concurrently with the other streams of the GPU.
+ * \param dev_type device type of the stream, must be GPU
+ * \param dev_id device id of the stream
+ * \param name name of the stream, unique per GPU
+ * \param priority CUDA priority of the stream, lower numbers are higher priorities
+ * \param out id of the stream, 0 (the default streams) when the engine does not support them
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXEngineCreateStream(int dev_type,
+                                   int dev_id,
+                                   const char* name,
+                                   int priority,
+                                   int* out);
+
+/*!
+ * \brief Set the stream of the operators pushed by the calling thread
+ * \param stream id of the stream, 0 for the default streams
+ * \param prev_stream previous stream of the thread
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXEngineSetStream(int stream, int* prev_stream);
+
+/*!
+ * \brief Save the cuDNN convolution plans selected so far by the process, by operator, shapes,
+ *  GPU architecture and cuDNN version. Writes no file in builds without cuDNN.
+ * \param fname name of the file
+ * \param num_plans number of plans saved
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXCudnnPlanCacheSave(const char* fname, uint32_t* num_plans);
+
+/*!
+ * \brief Load cuDNN convolution plans saved by MXCudnnPlanCacheSave. The convolutions they
+ *  cover then build their plans directly, without heuristics or autotuning. Plans of another
+ *  GPU architecture or cuDNN version are never used. Ignored in builds without cuDNN.
+ * \param fname name of the file
+ * \param num_plans number of plans loaded
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXCudnnPlanCacheLoad(const char* fname, uint32_t* num_plans);
+
+/*!
+ * \brief Get the engine overhead counters as a json string: number of pushed operators,
+ *  current and maximum number of ready operators waiting for a worker, and histograms of
+ *  the wait-to-run latency, the dependency fan-out and the bulk segment sizes.
+ * \param out_str will receive a pointer to the output string
+ * \param reset clear the counters after reading them
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXEngineGetStats(const char** out_str, int reset);
+
 /*!
  * \brief Get the number of GPUs.
  * \param pointer to int that will hold the number of GPUs available.
@@ -597,6 +670,15 @@ typedef struct ConfigSpaces {
 } ConfigSpaces;
 
 MXNET_DLL int MXLoadTVMConfig(ConfigSpaces config);
+
+/*!
+ * \brief Load kernels tuned by the TVM auto-scheduler, which replace the FCompute of registered
+ *        operators for the dtypes, shapes and attributes they were tuned for
+ * \param libpath library of the kernels exported by TVM
+ * \param manifest_path json list of the kernels, as written by contrib/tvmop/tune.py
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXLoadTVMTunedKernels(const char* libpath, const char* manifest_path);
 #endif  // MXNET_USE_TVM_OP
 
 //-------------------------------------
@@ -775,6 +857,94 @@ MXNET_DLL int MXNDArrayLoad(const char* fname,
                             uint32_t* out_name_size,
                             const char*** out_names);
 
+/*!
+ * \brief Save list of narray into a parameter file which can be memory-mapped, with the payload
+ *  of every array aligned to 64 bytes. MXNDArrayLoad reads it back with arrays viewing the mapping.
+ * \param fname name of the file.
+ * \param num_args number of arguments to save.
+ * \param args the array of NDArrayHandles to be saved, only dense arrays are supported.
+ * \param keys the name of the NDArray, optional, can be NULL
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArraySaveMapped(const char* fname,
+                                  uint32_t num_args,
+                                  NDArrayHandle* args,
+                                  const char** keys);
+/*!
+ * \brief Save list of narray into num_shards files of about the same size, written in parallel,
+ *  and an index file named fname. MXNDArrayLoad reads the shards back in parallel.
+ * \param fname name of the index file, the shards are named fname.shard-<i>-of-<num_shards>.
+ * \param num_shards number of shards.
+ * \param num_args number of arguments to save.
+ * \param args the array of NDArrayHandles to be saved.
+ * \param keys the name of the NDArray, optional, can be NULL
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArraySaveSharded(const char* fname,
+                                   uint32_t num_shards,
+                                   uint32_t num_args,
+                                   NDArrayHandle* args,
+                                   const char** keys);
+/*!
+ * \brief Load list of narray from a parameter file saved by MXNDArraySaveMapped to a context.
+ *  On the CPU the arrays are views of the memory-mapped file, on other devices they are uploaded
+ *  from the mapping in chunks, asynchronously.
+ * \param fname name of the file.
+ * \param dev_type device type of the context of the arrays.
+ * \param dev_id device id of the context of the arrays.
+ * \param out_size number of narray loaded.
+ * \param out_arr head of the returning narray handles.
+ * \param out_name_size size of output name arrray.
+ * \param out_names the names of returning NDArrays, can be NULL
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArrayLoadMapped(const char* fname,
+                                  int dev_type,
+                                  int dev_id,
+                                  uint32_t* out_size,
+                                  NDArrayHandle** out_arr,
+                                  uint32_t* out_name_size,
+                                  const char*** out_names);
+/*!
+ * \brief Save list of narray into a file without blocking. A copy of every array to the CPU,
+ *  in pinned memory for arrays of a GPU, is pushed to the engine and the copies are written by a
+ *  background thread, so the arrays can be updated as soon as the call returns.
+ * \param fname name of the file.
+ * \param num_args number of arguments to save.
+ * \param args the array of NDArrayHandles to be saved.
+ * \param keys the name of the NDArray, optional, can be NULL
+ * \param mapped whether to save a parameter file which can be memory-mapped.
+ * \param num_shards number of shards, the file is not sharded when 1.
+ * \param out the checkpoint, to be freed with MXCheckpointFree.
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArraySaveAsync(const char* fname,
+                                 uint32_t num_args,
+                                 NDArrayHandle* args,
+                                 const char** keys,
+                                 int mapped,
+                                 uint32_t num_shards,
+                                 CheckpointHandle* out);
+/*!
+ * \brief Whether a checkpoint is written, or its writing failed.
+ * \param handle the checkpoint.
+ * \param out 1 when done, 0 otherwise.
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXCheckpointIsDone(CheckpointHandle handle, int* out);
+/*!
+ * \brief Wait for a checkpoint to be written.
+ * \param handle the checkpoint.
+ * \return 0 when success, -1 when the writing failed
+ */
+MXNET_DLL int MXCheckpointWait(CheckpointHandle handle);
+/*!
+ * \brief Wait for a checkpoint to be written and free it. Errors of the writing are logged.
+ * \param handle the checkpoint.
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXCheckpointFree(CheckpointHandle handle);
+
 /*!
  * \brief Load list / dictionary of narrays from file content loaded into memory.
  * This will load a list of ndarrays in a similar
@@ -862,6 +1032,22 @@ MXNET_DLL int MXNDArrayWaitToWrite(NDArrayHandle handle);
  */
 MXNET_DLL int MXNDArrayWaitAll();
 
+/*!
+ * \brief Call a function once the pending writes to NDArrays are finished, without blocking.
+ *  The function runs on an engine thread and must not wait for NDArrays. It is also called
+ *  when one of the writes failed, with the error, which is then no longer raised by
+ *  MXNDArrayWaitToRead.
+ * \param num_arrays number of NDArrays
+ * \param handles the NDArray handles
+ * \param callback the function to call
+ * \param param the parameter passed to callback
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArrayNotifyReady(uint32_t num_arrays,
+                                   NDArrayHandle* handles,
+                                   NDArrayReadyCallback callback,
+                                   void* param);
+
 /*!
  * \brief free the narray handle
  * \param handle the handle to be freed
@@ -989,6 +1175,18 @@ MXNET_DLL int MXNDArrayGetData(NDArrayHandle handle, void** out_pdata);
  * \return 0 when success, -1 when failure happens
  */
 MXNET_DLL int MXNDArrayToDLPack(NDArrayHandle handle, DLManagedTensorHandle* out_dlpack);
+/*!
+ * \brief Create a reference view of the i-th aux data of a sparse NDArray, the indptr and
+ *  indices for csr, the indices for row_sparse, that represents as DLManagedTensor.
+ *  MXNDArrayToDLPack views its data.
+ * \param handle the handle to the ndarray
+ * \param i the index of the aux data
+ * \param out_dlpack pointer holder to get pointer of DLManagedTensor
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArrayAuxToDLPack(NDArrayHandle handle,
+                                   uint32_t i,
+                                   DLManagedTensorHandle* out_dlpack);
 
 /*!
  * \brief Create a NDArray backed by a dlpack tensor.
@@ -1007,6 +1205,27 @@ MXNET_DLL int MXNDArrayToDLPack(NDArrayHandle handle, DLManagedTensorHandle* out
 MXNET_DLL int MXNDArrayFromDLPack(DLManagedTensorHandle dlpack,
                                   const bool transient_handle,
                                   NDArrayHandle* out_handle);
+/*!
+ * \brief Create a sparse NDArray backed by dlpack tensors of its data and aux data, as
+ *  exported by MXNDArrayToDLPack and MXNDArrayAuxToDLPack.
+ * \param storage_type the storage type of the NDArray, csr or row_sparse
+ * \param shape the shape of the NDArray
+ * \param ndim the number of dimensions of the NDArray
+ * \param data the pointer of the DLManagedTensor of the data
+ * \param num_aux the number of aux data
+ * \param aux_data the pointers of the DLManagedTensor of the aux data
+ * \param transient_handle whether the handles will be destructed before calling the deleters
+ * \param out_handle pointer holder to get pointer of NDArray
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArrayFromDLPackSparse(int storage_type,
+                                        const int64_t* shape,
+                                        int ndim,
+                                        DLManagedTensorHandle data,
+                                        uint32_t num_aux,
+                                        DLManagedTensorHandle* aux_data,
+                                        const bool transient_handle,
+                                        NDArrayHandle* out_handle);
 
 /*!
  * \brief Delete a dlpack tensor
@@ -1199,6 +1418,63 @@ MXNET_DLL int MXImperativeInvoke(AtomicSymbolCreator creator,
                                  const char** param_keys,
                                  const char** param_vals,
                                  const int** out_stypes);
+/*!
+ * \brief parse the attributes of a nnvm op once, for the op to be invoked repeatedly by
+ *  MXImperativeInvokePrepared without the overhead of parsing them on every call
+ * \param creator the op
+ * \param num_inputs number of input NDArrays of every invocation
+ * \param num_params number of keyword parameters
+ * \param param_keys keys for keyword parameters
+ * \param param_vals values for keyword parameters
+ * \param out the prepared op, to be freed with MXFreePreparedOp
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXImperativePrepare(AtomicSymbolCreator creator,
+                                  int num_inputs,
+                                  int num_params,
+                                  const char** param_keys,
+                                  const char** param_vals,
+                                  PreparedOpHandle* out);
+/*!
+ * \brief invoke a prepared op, as MXImperativeInvoke
+ * \param handle the prepared op
+ * \param num_inputs number of input NDArrays, as given to MXImperativePrepare
+ * \param inputs input NDArrays
+ * \param num_outputs number of output NDArrays
+ * \param outputs output NDArrays, created when NULL
+ * \param out_stypes output ndarrays' stypes, can be NULL
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXImperativeInvokePrepared(PreparedOpHandle handle,
+                                         int num_inputs,
+                                         NDArrayHandle* inputs,
+                                         int* num_outputs,
+                                         NDArrayHandle** outputs,
+                                         const int** out_stypes);
+/*!
+ * \brief invoke a list of prepared ops in order in one call. The outputs are given by the
+ *  caller, created with MXNDArrayCreateNone when they are to be allocated by the op, so that
+ *  the outputs of an op can be the inputs of the next ones.
+ * \param num_ops number of ops to invoke
+ * \param handles the prepared ops
+ * \param num_inputs number of input NDArrays of every op
+ * \param inputs input NDArrays of all the ops, one after the other
+ * \param num_outputs number of output NDArrays of every op, all or only the visible ones
+ * \param outputs output NDArrays of all the ops, one after the other
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXImperativeInvokePreparedBatch(uint32_t num_ops,
+                                              PreparedOpHandle* handles,
+                                              const int* num_inputs,
+                                              NDArrayHandle* inputs,
+                                              const int* num_outputs,
+                                              NDArrayHandle* outputs);
+/*!
+ * \brief free a prepared op
+ * \param handle the prepared op
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXFreePreparedOp(PreparedOpHandle handle);
 /*!
  * \brief set whether to record operator for autograd
  * \param is_recording 1 when recording, 0 when not recording.
@@ -1329,6 +1605,18 @@ MXNET_DLL int MXAutogradBackwardEx(uint32_t num_output,
  * \param out output symbol handle
  */
 MXNET_DLL int MXAutogradGetSymbol(NDArrayHandle handle, SymbolHandle* out);
+/*!
+ * \brief set the hook called during backward, once per call, after the operator computing the
+ *        gradient array is pushed to the engine. The gradient is not ready yet, operators pushed
+ *        by the hook on it run once it is.
+ * \param grad gradient array, as given to MXAutogradMarkVariables
+ * \param callback hook, NULL removes the hook of the array
+ * \param callback_handle param of the hook
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXAutogradSetGradHook(NDArrayHandle grad,
+                                    MXGradHookCallback callback,
+                                    void* callback_handle);
 
 /*!
  * \brief create cached operator, allows to choose thread_safe version
@@ -1372,6 +1660,50 @@ MXNET_DLL int MXInvokeCachedOp(CachedOpHandle handle,
                                NDArrayHandle** outputs,
                                const int** out_stypes);
 
+/*!
+ * \brief create a batcher running the concurrent forwards of a cached op as one
+ *  forward, with their data inputs concatenated along their first axis
+ * \param handle the handle to the cached op, preferably thread safe
+ * \param num_data_indices number of data inputs
+ * \param data_indices positions of the data inputs batched along their first axis
+ * \param max_batch_size maximum number of samples of a batch
+ * \param timeout_us maximum time in microseconds a request waits for others
+ * \param dev_type the context type the batches run on
+ * \param dev_id the context device id the batches run on
+ * \param out the handle to the batcher created
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXCreateCachedOpBatcher(CachedOpHandle handle,
+                                      int num_data_indices,
+                                      const int* data_indices,
+                                      int max_batch_size,
+                                      int timeout_us,
+                                      int dev_type,
+                                      int dev_id,
+                                      CachedOpBatcherHandle* out);
+
+/*!
+ * \brief free the batcher of a cached op, after the requests queued are run
+ */
+MXNET_DLL int MXFreeCachedOpBatcher(CachedOpBatcherHandle handle);
+
+/*!
+ * \brief invoke a cached op as part of a batch, may be called by several threads
+ * \param handle the handle to the batcher
+ * \param num_inputs number of input NDArrays
+ * \param inputs input NDArrays
+ * \param num_outputs number of output NDArrays
+ * \param outputs output NDArrays, views of the outputs of the batch
+ * \param out_stypes output ndarrays' stypes
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXInvokeCachedOpBatcher(CachedOpBatcherHandle handle,
+                                      int num_inputs,
+                                      NDArrayHandle* inputs,
+                                      int* num_outputs,
+                                      NDArrayHandle** outputs,
+                                      const int** out_stypes);
+
 /*!
  * \brief cached op set monitor callback
  */
@@ -1530,7 +1862,7 @@ MXNET_DLL int MXSymbolCreateVariable(const char* name, SymbolHandle* out);
  */
 MXNET_DLL int MXSymbolCreateGroup(uint32_t num_symbols, SymbolHandle* symbols, SymbolHandle* out);
 /*!
- * \brief Load a symbol from a json file.
+ * \brief Load a symbol from a json file, or a binary file saved by MXSymbolSaveToBinaryFile.
  * \param fname the file name.
  * \param out the output symbol.
  * \return 0 when success, -1 when failure happens
@@ -1543,6 +1875,15 @@ MXNET_DLL int MXSymbolCreateFromFile(const char* fname, SymbolHandle* out);
  * \return 0 when success, -1 when failure happens
  */
 MXNET_DLL int MXSymbolCreateFromJSON(const char* json, SymbolHandle* out);
+/*!
+ * \brief Load a symbol from the buffer of its binary graph, which is faster than JSON for
+ *  large graphs.
+ * \param buf the binary graph.
+ * \param size the size of buf in bytes.
+ * \param out the output symbol.
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXSymbolCreateFromBinary(const char* buf, size_t size, SymbolHandle* out);
 /*!
  * \brief Remove the operators amp_cast and amp_multicast
  * \param sym_handle the input symbol.
@@ -1564,6 +1905,21 @@ MXNET_DLL int MXSymbolSaveToFile(SymbolHandle symbol, const char* fname);
  * \return 0 when success, -1 when failure happens
  */
 MXNET_DLL int MXSymbolSaveToJSON(SymbolHandle symbol, const char** out_json);
+/*!
+ * \brief Save a symbol into a binary file, with interned operator names and attributes.
+ * \param symbol the input symbol.
+ * \param fname the file name.
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXSymbolSaveToBinaryFile(SymbolHandle symbol, const char* fname);
+/*!
+ * \brief Save a symbol into a binary graph buffer
+ * \param symbol the input symbol.
+ * \param out_size size of the buffer in bytes.
+ * \param out_buf the buffer, valid until the next call from the thread.
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXSymbolSaveToBinary(SymbolHandle symbol, size_t* out_size, const char** out_buf);
 /*!
  * \brief Free the symbol handle.
  * \param symbol the symbol
@@ -2993,6 +3349,35 @@ MXNET_DLL int MXRtcCudaKernelCall(CudaKernelHandle handle,
  */
 MXNET_DLL int MXNDArrayGetSharedMemHandle(NDArrayHandle handle, int* shared_pid, int* shared_id);
 
+/*!
+ * \brief Get the CUDA IPC handle of the device allocation of a GPU NDArray, for another process
+ *  to map it. The NDArray is computed first, and must be kept alive as long as other processes
+ *  use the allocation.
+ * \param handle NDArray handle.
+ * \param ipc_handle output CUDA IPC memory handle, 64 bytes.
+ * \param offset output offset of the data of the NDArray in the allocation.
+ */
+MXNET_DLL int MXNDArrayGetCudaIpcHandle(NDArrayHandle handle, void* ipc_handle, uint64_t* offset);
+
+/*!
+ * \brief Reconstruct a GPU NDArray from the CUDA IPC handle of another process. The allocation
+ *  is mapped without copy, and unmapped once the NDArrays created from it are freed.
+ * \param ipc_handle CUDA IPC memory handle, 64 bytes
+ * \param offset offset of the data of the NDArray in the allocation
+ * \param shape pointer to NDArray dimensions
+ * \param ndim number of NDArray dimensions
+ * \param dtype data type of NDArray
+ * \param dev_id the device id of the allocation
+ * \param out constructed NDArray
+ */
+MXNET_DLL int MXNDArrayCreateFromCudaIpcHandle(const void* ipc_handle,
+                                               uint64_t offset,
+                                               const int64_t* shape,
+                                               int ndim,
+                                               int dtype,
+                                               int dev_id,
+                                               NDArrayHandle* out);
+
 /*!
  * \brief Release all unreferenced memory from the devices storage managers memory pool
  * \param dev_type device type, specify device we want to take
@@ -3000,6 +3385,25 @@ MXNET_DLL int MXNDArrayGetSharedMemHandle(NDArrayHandle handle, int* shared_pid,
  */
 MXNET_DLL int MXStorageEmptyCache(int dev_type, int dev_id);
 
+/*!
+ * \brief Get the usage counters of the memory pools as a json string: reserved and
+ *  peak reserved bytes, hit/miss counts and, per bucket, the bytes requested vs
+ *  the bytes of the served chunks, keyed by the device of each storage manager
+ * \param out_str will receive a pointer to the output string
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXStorageGetStats(const char** out_str);
+
+/*!
+ * \brief Limit the memory held by the memory pool of a device. Cached free memory
+ *  is released and memory pressure callbacks are called before an allocation fails.
+ * \param dev_type device type, specify device we want to take
+ * \param dev_id the device id of the specific device
+ * \param bytes the budget in bytes, 0 for no limit
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXStorageSetBudget(int dev_type, int dev_id, uint64_t bytes);
+
 /*!
  * \brief Reconstruct NDArray from shared memory handle
  * \param shared_pid shared PID
@@ -3150,18 +3554,21 @@ MXNET_DLL int MXEnginePushSyncND(EngineSyncFunc sync_func,
 MXNET_DLL int MXCheckDynamicShapeOp(SymbolHandle sym_handle, bool* has_dynamic_shape);
 
 /*!
- * \brief Synchronize the consumer stream with the producer stream where the NDArray lives.
+ * \brief Make the consumer stream wait for the pending operations on a GPU NDArray, without
+ *  waiting for them on the host.
  * \param handle NDArray handle of producer.
- * \param stream A pointer to a stream from consumer.
+ * \param stream A pointer to a stream from consumer, or 1 and 2 for the legacy and the
+ *  per-thread default streams, as in the DLPack stream convention.
  */
-MXNET_DLL int MXPushStreamDep(NDArrayHandle handle, int stream);
+MXNET_DLL int MXPushStreamDep(NDArrayHandle handle, int64_t stream);
 
 /*!
- * \brief Get current stream pointer based on current device type and id
+ * \brief Get the stream for producers of arrays consumed by MXNet to sync with, in the DLPack
+ *  stream convention. MXNet operations wait for the work enqueued on it.
  * \param device_id Current device id.
  * \param stream A pointer pointing to current stream.
  */
-MXNET_DLL int MXGetCurrentStream(int device_id, int* stream);
+MXNET_DLL int MXGetCurrentStream(int device_id, int64_t* stream);
 
 /*!
  * \brief Push a new NVTX range. Requires building with CUDA and NVTX.
@@ -29,6 +29,7 @@
 #include <memory>
 #include <functional>
 #endif
+#include <string>
 #include <utility>
 #include <vector>
 #include "./base.h"
@@ -112,6 +113,13 @@ struct Var {
   virtual size_t version() {
     return version_;
   }
+  /*!
+   * \return whether no write on the variable is waiting or running.
+   *  Engines which run the operations when they are pushed are always idle.
+   */
+  virtual bool idle() {
+    return true;
+  }
   virtual ~Var() = default;
   /*!
    * \brief cast variable to derived type T
@@ -434,6 +442,26 @@ class MXNET_API Engine {
   virtual int set_bulk_size(int) {
     return 0;
   }
+  /*!
+   * \brief Create a named stream of a GPU, or get the one of the same name already created.
+   *  The operators pushed on the GPU by a thread which set the stream run in order on a
+   *  dedicated worker and CUDA stream, concurrently with the other streams of the GPU.
+   * \param ctx the GPU of the stream
+   * \param name name of the stream, unique per GPU
+   * \param priority CUDA priority of the stream, lower numbers are higher priorities
+   * \return id of the stream, 0 (the default streams) when the engine does not support them
+   */
+  virtual int CreateStream(const Context& ctx, const std::string& name, int priority) {
+    return 0;
+  }
+  /*! \brief query the stream of the operators pushed by this thread, 0 for the default */
+  virtual int stream() const {
+    return 0;
+  }
+  /*! \brief set the stream of the operators pushed by this thread, return the previous one */
+  virtual int set_stream(int) {
+    return 0;
+  }
 };      // class Engine
 #endif  // DMLC_USE_CXX11
 }  // namespace mxnet
@@ -28,6 +28,8 @@
 #include <nnvm/graph.h>
 #include <vector>
 #include <atomic>
+#include <functional>
+#include <mutex>
 #include <utility>
 #include <string>
 #include <unordered_map>
@@ -302,6 +304,24 @@ class Imperative {
                                  bool create_graph);
   /*! \brief Return the marked nonleaf nodes. */
   std::vector<nnvm::ObjectPtr> ListNonleafVariables(const nnvm::Symbol& sym) const;
+  /*! \brief callback run once the operator computing a gradient is scheduled */
+  typedef std::function<void()> GradHook;
+  /*!
+   * \brief set the hook run during backward, once per call, after the operator writing the
+   *        gradient array is pushed to the engine. An empty hook removes it.
+   */
+  void SetGradHook(const NDArray& grad, GradHook hook);
+  /*!
+   * \brief map the nodes in [start, end) to the hooked gradient variables they are the last
+   *        writer of. Empty when there are no hooks.
+   */
+  std::unordered_map<uint32_t, std::vector<Engine::VarHandle>> GradHookNodes(
+      const nnvm::IndexedGraph& idx,
+      const std::vector<NDArray*>& arrays,
+      size_t start,
+      size_t end);
+  /*! \brief run the hooks of the variables not run yet in the current backward call */
+  void RunGradHooks(const std::vector<Engine::VarHandle>& vars);
   /*! \return AutogradRuntime singleton */
   static Imperative* Get();
   /*! \brief Should op execution bulking be employed during inference. */
@@ -362,6 +382,17 @@ class Imperative {
   std::atomic<uint64_t> variable_count_{0};
   /*! \brief default backward bulk size */
   int backward_bulk_size_{0};
+  /*! \brief gradient hook, the array keeps its variable alive */
+  struct GradHookInfo {
+    NDArray grad;
+    GradHook hook;
+    uint64_t epoch;
+  };
+  /*! \brief gradient hooks by variable */
+  std::unordered_map<Engine::VarHandle, GradHookInfo> grad_hooks_;
+  /*! \brief number of backward calls, hooks run once per call */
+  uint64_t backward_epoch_{0};
+  std::mutex grad_hooks_mutex_;
 };
 
 }  // namespace mxnet
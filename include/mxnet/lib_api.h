@@ -52,7 +52,7 @@
 #endif
 
 /* Make sure to update the version number everytime you make changes */
-#define MX_LIBRARY_VERSION 11
+#define MX_LIBRARY_VERSION 12
 
 /*!
  * \brief For loading multiple custom op libraries in Linux, exporting same symbol multiple
@@ -380,6 +380,32 @@ struct MXTensor {
   MXStorageType stype;
 };
 
+/*!
+ * \brief Non-owning view of a dense tensor, passed to the fast compute path of stateful ops as
+ *        is: no shape vector, context string or DLTensor is built for it
+ */
+struct MXTensorView {
+  /*! \brief helper function to cast data pointer */
+  template <typename data_type>
+  inline data_type* data() const {
+    return reinterpret_cast<data_type*>(data_ptr);
+  }
+
+  /*! \brief helper function to get data size */
+  int64_t size() const;
+
+  void* data_ptr;
+  // ndim dimensions, owned by MXNet and valid during the call
+  const int64_t* shape;
+  int ndim;
+  MXDType dtype;
+  // version number updated if the tensor has changed since the last use by custom op
+  size_t verID;
+  // "cpu" or "gpu", a static string
+  const char* dev_type;
+  int dev_id;
+};
+
 /*! \brief resource malloc function to allocate memory inside Forward/Backward functions */
 typedef void* (*xpu_malloc_t)(void*, int);
 /*! \brief sparse alloc function to allocate memory inside Forward/Backward functions */
@@ -737,6 +763,34 @@ class CustomStatefulOp {
     return MX_FAIL;
   }
 
+  /*!
+   * \brief Whether ForwardFast/BackwardFast replace Forward/Backward when all the inputs and
+   *        outputs are dense. Queried once, when the state is created.
+   */
+  virtual bool supportsFastCompute() const {
+    return false;
+  }
+  /*!
+   * \brief Fast path of Forward: the tensors are views of the MXNet arrays and nothing is
+   *        converted or allocated per call, so attributes should be parsed when creating the state
+   */
+  virtual MXReturnValue ForwardFast(const MXTensorView* inputs,
+                                    int num_inputs,
+                                    const MXTensorView* outputs,
+                                    int num_outputs,
+                                    const OpResource& op_res) {
+    MX_ERROR_MSG << "Error! Operator does not support fast forward" << std::endl;
+    return MX_FAIL;
+  }
+  virtual MXReturnValue BackwardFast(const MXTensorView* inputs,
+                                     int num_inputs,
+                                     const MXTensorView* outputs,
+                                     int num_outputs,
+                                     const OpResource& op_res) {
+    MX_ERROR_MSG << "Error! Operator does not support fast backward" << std::endl;
+    return MX_FAIL;
+  }
+
   bool ignore_warn;
 
  private:
@@ -1103,7 +1157,8 @@ typedef int (*opCallCreateOpState_t)(createOpState_t create_op,
                                      int* indims,
                                      int num_in,
                                      const int* intypes,
-                                     void** state_op);
+                                     void** state_op,
+                                     int* fast_compute);
 
 #define MXLIB_OPCALLDESTROYOPSTATE_STR "_opCallDestroyOpState"
 typedef int (*opCallDestroyOpState_t)(void* state_op);
@@ -1147,6 +1202,23 @@ typedef int (*opCallFStatefulComp_t)(int is_forward,
                                      void* rng_cpu_states,
                                      void* rng_gpu_states);
 
+#define MXLIB_OPCALLFSTATEFULCOMPFAST_STR "_opCallFStatefulComputeFast"
+typedef int (*opCallFStatefulCompFast_t)(int is_forward,
+                                         void* state_op,
+                                         const MXTensorView* inputs,
+                                         int num_in,
+                                         const MXTensorView* outputs,
+                                         int num_out,
+                                         xpu_malloc_t cpu_malloc,
+                                         void* cpu_alloc,
+                                         xpu_malloc_t gpu_malloc,
+                                         void* gpu_alloc,
+                                         void* stream,
+                                         sparse_malloc_t sparse_malloc,
+                                         void* sparse_alloc,
+                                         void* rng_cpu_states,
+                                         void* rng_gpu_states);
+
 #define MXLIB_PARTREGSIZE_STR "_partRegSize"
 typedef int (*partRegSize_t)(void);
 
@@ -1282,15 +1354,19 @@ typedef int (*msgGet_t)(int idx, const char** msg);
 class CustomStatefulOpWrapper {
  public:
   ~CustomStatefulOpWrapper();
-  explicit CustomStatefulOpWrapper(CustomStatefulOp* inst, opCallDestroyOpState_t destroy)
-      : instance(inst), destroy_(destroy) {}
+  CustomStatefulOpWrapper(CustomStatefulOp* inst, opCallDestroyOpState_t destroy, bool fast)
+      : instance(inst), destroy_(destroy), fast_compute(fast) {}
   CustomStatefulOp* get_instance() {
     return instance;
   }
+  bool supports_fast_compute() const {
+    return fast_compute;
+  }
 
  private:
   CustomStatefulOp* instance;
   opCallDestroyOpState_t destroy_;
+  bool fast_compute;
 };
 
 #if defined(_WIN32) || defined(_WIN64) || defined(__WINDOWS__)
@@ -1435,7 +1511,8 @@ MX_INT_RET _opCallCreateOpState(mxnet::ext::createOpState_t create_op,
                                 int* indims,
                                 int num_in,
                                 const int* intypes,
-                                void** state_op);
+                                void** state_op,
+                                int* fast_compute);
 
 /*! \brief returns status of deleting StatefulOp instance for operator from library */
 MX_VOID_RET _opCallDestroyOpState(void* state_op);
@@ -1479,6 +1556,23 @@ MX_INT_RET _opCallFStatefulCompute(int is_forward,
                                    void* rng_cpu_states,
                                    void* rng_gpu_states);
 
+/*! \brief returns status of calling Stateful ForwardFast/BackwardFast for operator from library */
+MX_INT_RET _opCallFStatefulComputeFast(int is_forward,
+                                       void* state_op,
+                                       const mxnet::ext::MXTensorView* inputs,
+                                       int num_in,
+                                       const mxnet::ext::MXTensorView* outputs,
+                                       int num_out,
+                                       mxnet::ext::xpu_malloc_t cpu_malloc,
+                                       void* cpu_alloc,
+                                       mxnet::ext::xpu_malloc_t gpu_malloc,
+                                       void* gpu_alloc,
+                                       void* stream,
+                                       mxnet::ext::sparse_malloc_t sparse_malloc,
+                                       void* sparse_alloc,
+                                       void* rng_cpu_states,
+                                       void* rng_gpu_states);
+
 /*! \brief returns number of partitioners registered in this library */
 MX_INT_RET _partRegSize();
 
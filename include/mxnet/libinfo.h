@@ -66,6 +66,10 @@
 #define MXNET_USE_NCCL 0
 #endif
 
+#ifndef MXNET_USE_NVJPEG
+#define MXNET_USE_NVJPEG 0
+#endif
+
 /*!
  *\brief whether to use cusolver library
  */
@@ -173,6 +177,7 @@ enum : unsigned {
 
   // Image processing
   OPENCV,
+  NVJPEG,
 
   // Misc
   DIST_KVSTORE,
@@ -184,6 +184,32 @@ class NDArray {
         dtype_(data.type_flag_),
         storage_type_(stype),
         autograd_entry_(nullptr) {}
+
+  /*!
+   * \brief constructing a static NDArray of non-default storage that shares data with TBlob
+   *  which is with deleter
+   * \param stype the storage type of NDArray
+   * \param shape the shape of NDArray
+   * \param data the memory content of static data
+   * \param aux_data the memory content of static aux data
+   * \param dev_id the device id this tensor sits at
+   * \param deleter the function pointer of custom deleter
+   */
+  NDArray(const NDArrayStorageType stype,
+          const mxnet::TShape& shape,
+          const TBlob& data,
+          const std::vector<TBlob>& aux_data,
+          int dev_id,
+          const std::function<void()>& deleter)
+      : ptr_(new Chunk(stype, data, aux_data, dev_id),
+             [deleter](Chunk* p) {
+               deleter();  // call custom deleter
+               delete p;   // delete Chunk object
+             }),
+        shape_(shape),
+        dtype_(data.type_flag_),
+        storage_type_(stype),
+        autograd_entry_(nullptr) {}
   /*!
    * \brief initialize the NDArray, assuming it is not assigned a meaningful shape before
    * \param shape the shape of the NDArray
@@ -402,11 +428,12 @@ class NDArray {
    */
   void WaitToWrite() const;
   /*!
-   * \brief Synchronize the destination stream provided by consumer with the
-   *    source stream that current NDArray lives on.
-   * \param stream a pointer to the stream provided by consumer.
+   * \brief Make the stream provided by a consumer wait for the pending operations on the array,
+   *    without waiting for them on the host. Returns once the wait is enqueued on the stream.
+   * \param stream a pointer to the stream provided by consumer, or 1 and 2 for the legacy and
+   *    the per-thread default streams, as in the DLPack stream convention.
    */
-  void StreamSync(int stream) const;
+  void StreamSync(int64_t stream) const;
   /*! \return the associated variable of the ndarray.*/
   inline Engine::VarHandle var() const {
     return ptr_->var;
@@ -610,12 +637,19 @@ class NDArray {
   }
 
   /*!
-   * \brief Create a reference view of NDArray that
+   * \brief Create a reference view of NDArray, of its data for sparse NDArray, that
    *  represents as DLManagedTensor.
    * \return A DLManagedTensor
    */
   DLManagedTensor* ToDLPack() const;
 
+  /*!
+   * \brief Create a reference view of the i-th aux data of a sparse NDArray
+   *  that represents as DLManagedTensor.
+   * \return A DLManagedTensor
+   */
+  DLManagedTensor* AuxToDLPack(size_t i) const;
+
   /*!
    * \brief Create a NDArray backed by a dlpack tensor.
    *
@@ -629,6 +663,19 @@ class NDArray {
    */
   static NDArray FromDLPack(const DLManagedTensor* tensor, bool transient_handle);
 
+  /*!
+   * \brief Create a sparse NDArray backed by dlpack tensors of its data and aux data.
+   *
+   * The memory of all of them is retained until the NDArray went out of scope.
+   *
+   * \return The created NDArray view.
+   */
+  static NDArray FromDLPack(NDArrayStorageType stype,
+                            const mxnet::TShape& shape,
+                            const DLManagedTensor* data,
+                            const std::vector<const DLManagedTensor*>& aux_data,
+                            bool transient_handle);
+
   /*!
    * \brief Update ndarray chunk storage handles using existing ndarray storage handles
    * Also update the aux_handle, aux_shapes and aux_types.
@@ -849,6 +896,17 @@ class NDArray {
 
  private:
   friend class Imperative;
+  /*!
+   * \brief the array to serialize: itself on the CPU, else a copy to the CPU, started
+   *  asynchronously so that the copies of several arrays overlap with the writes.
+   */
+  NDArray StageForSave() const;
+  /*!
+   * \brief save the content into binary stream, from the array returned by StageForSave
+   * \param strm the output stream
+   * \param staged the array returned by StageForSave
+   */
+  void Save(dmlc::Stream* strm, const NDArray& staged) const;
   /*! \brief the real data chunk that backs NDArray */
   // shandle is used to store the actual values in the NDArray
   // aux_handles store the aux data(such as indices) if it's needed by non-default storage.
@@ -303,6 +303,27 @@ using FComputeEx = std::function<void(const nnvm::NodeAttrs& attrs,
                                       const std::vector<OpReqType>& req,
                                       const std::vector<NDArray>& outputs)>;
 
+/*!
+ * \brief Work done by one execution of an operator
+ */
+struct OpCost {
+  /*! \brief floating point operations, a multiply-add counts as two */
+  uint64_t flops = 0;
+  /*! \brief bytes read and written in memory */
+  uint64_t bytes = 0;
+};
+
+/*!
+ * \brief Register a function estimating the work of an operator from the shapes and
+ *        types of its inputs and outputs, the profiler uses it to report the achieved
+ *        GFLOP/s and GB/s of the operator.
+ *
+ * \note Register under "FOpCost", the data pointers of the blobs may be null
+ */
+using FOpCost = std::function<OpCost(const nnvm::NodeAttrs& attrs,
+                                     const std::vector<TBlob>& inputs,
+                                     const std::vector<TBlob>& outputs)>;
+
 /*!
  * \brief Register a storage and dispatch mode inference function based on
  *        storage types of the inputs and outputs, and the dev_mask for the operator.
@@ -24,7 +24,11 @@
 #ifndef MXNET_RANDOM_GENERATOR_H_
 #define MXNET_RANDOM_GENERATOR_H_
 
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <random>
+#include <type_traits>
 #include <new>
 #include "./base.h"
 
@@ -40,6 +44,39 @@ namespace random {
 template <typename Device, typename DType MSHADOW_DEFAULT_DTYPE>
 class RandGenerator;
 
+/*!
+ * \brief Philox4x32-10 counter-based generator (Salmon et al., "Parallel Random Numbers: As
+ *        Easy as 1, 2, 3"). The 128 bits returned in out are a pure function of the counter and
+ *        the key, so that a kernel can regenerate them, on any device and in any order, instead
+ *        of storing them.
+ */
+MSHADOW_XINLINE void Philox4x32_10(const uint32_t counter[4],
+                                   const uint32_t key[2],
+                                   uint32_t out[4]) {
+  uint32_t c0 = counter[0];
+  uint32_t c1 = counter[1];
+  uint32_t c2 = counter[2];
+  uint32_t c3 = counter[3];
+  uint32_t k0 = key[0];
+  uint32_t k1 = key[1];
+  for (int r = 0; r < 10; ++r) {
+    const uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * c0;
+    const uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * c2;
+    const uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+    const uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+    c1                = static_cast<uint32_t>(p1);
+    c3                = static_cast<uint32_t>(p0);
+    c0                = n0;
+    c2                = n2;
+    k0 += 0x9E3779B9u;
+    k1 += 0xBB67AE85u;
+  }
+  out[0] = c0;
+  out[1] = c1;
+  out[2] = c2;
+  out[3] = c3;
+}
+
 template <typename DType>
 class RandGenerator<cpu, DType> {
  public:
@@ -49,53 +86,111 @@ class RandGenerator<cpu, DType> {
   static const int kNumRandomStates;
 
   // implementation class for random number generator
+  // Each state is a Philox stream: the state index and the position in the stream form the
+  // counter, so that the numbers only depend on the seed and on the partition of the work
+  // among the states, not on the OpenMP threads running them.
   // TODO(alexzai): move impl class to separate file - tracked in MXNET-948
   class Impl {
    public:
     typedef
         typename std::conditional<std::is_floating_point<DType>::value, DType, double>::type FType;
     explicit Impl(RandGenerator<cpu, DType>* gen, int state_idx)
-        : engine_(gen->states_ + state_idx) {}
+        : gen_(gen), state_idx_(state_idx), counter_(gen->counters_[state_idx]) {}
+
+    ~Impl() {
+      // store the position in the stream back
+      gen_->counters_[state_idx_] = counter_;
+    }
 
     Impl(const Impl&) = delete;
     Impl& operator=(const Impl&) = delete;
 
     MSHADOW_XINLINE int rand() {
-      return engine_->operator()();
+      return static_cast<int>(next());
     }
 
     MSHADOW_XINLINE int64_t rand_int64() {
-      return static_cast<int64_t>(engine_->operator()() << 31) + engine_->operator()();
+      const uint64_t hi = next();
+      return static_cast<int64_t>((hi << 31) + next());
     }
 
     MSHADOW_XINLINE FType uniform() {
-      typedef typename std::conditional<std::is_integral<DType>::value,
-                                        std::uniform_int_distribution<DType>,
-                                        std::uniform_real_distribution<FType>>::type GType;
-      GType dist_uniform;
-      return dist_uniform(*engine_);
+      return uniform(std::is_integral<DType>());
     }
 
+    // Box-Muller, the second variate of a pair is kept for the next call
     MSHADOW_XINLINE FType normal() {
-      std::normal_distribution<FType> dist_normal;
-      return dist_normal(*engine_);
+      if (has_normal_) {
+        has_normal_ = false;
+        return normal_;
+      }
+      // u1 in (0, 1] for the log
+      const FType u1     = FType(1) - uniform(std::false_type());
+      const FType u2     = uniform(std::false_type());
+      const FType radius = std::sqrt(FType(-2) * std::log(u1));
+      const FType theta  = FType(6.283185307179586) * u2;
+      normal_            = radius * std::sin(theta);
+      has_normal_        = true;
+      return radius * std::cos(theta);
     }
 
    private:
-    std::mt19937* engine_;
+    MSHADOW_XINLINE uint32_t next() {
+      if (pos_ == 4) {
+        const uint32_t counter[4] = {static_cast<uint32_t>(counter_),
+                                     static_cast<uint32_t>(counter_ >> 32),
+                                     static_cast<uint32_t>(state_idx_),
+                                     0};
+        Philox4x32_10(counter, gen_->key_, bits_);
+        ++counter_;
+        pos_ = 0;
+      }
+      return bits_[pos_++];
+    }
+
+    // in [0, 1), with the precision of FType
+    MSHADOW_XINLINE FType uniform(std::false_type) {
+      if (sizeof(FType) == sizeof(float))
+        return FType((next() >> 8) * (1.0f / 16777216.0f));
+      const uint64_t hi = next() >> 5;
+      const uint64_t lo = next() >> 6;
+      return FType(((hi << 26) + lo) * (1.0 / 9007199254740992.0));
+    }
+
+    // in [0, max of DType], as std::uniform_int_distribution<DType>
+    MSHADOW_XINLINE FType uniform(std::true_type) {
+      const uint64_t hi   = next();
+      const uint64_t bits = (hi << 32) | next();
+      return FType(
+          static_cast<DType>(bits & static_cast<uint64_t>(std::numeric_limits<DType>::max())));
+    }
+
+    RandGenerator<cpu, DType>* gen_;
+    int state_idx_;
+    uint64_t counter_;
+    uint32_t bits_[4];
+    int pos_         = 4;
+    bool has_normal_ = false;
+    FType normal_;
   };  // class RandGenerator<cpu, DType>::Impl
 
   static void AllocState(RandGenerator<cpu, DType>* inst) {
-    inst->states_ = new std::mt19937[kNumRandomStates];
+    inst->states_   = new std::mt19937[kNumRandomStates];
+    inst->counters_ = new uint64_t[kNumRandomStates];
   }
 
   static void FreeState(RandGenerator<cpu, DType>* inst) {
     delete[] inst->states_;
+    delete[] inst->counters_;
   }
 
   MSHADOW_XINLINE void Seed(mshadow::Stream<cpu>*, uint32_t seed) {
-    for (int i = 0; i < kNumRandomStates; ++i)
+    key_[0] = seed;
+    key_[1] = 0x6a09e667u;
+    for (int i = 0; i < kNumRandomStates; ++i) {
       (states_ + i)->seed(seed + i);
+      counters_[i] = 0;
+    }
   }
 
   // export global random states, used by c++ custom operator
@@ -104,7 +199,11 @@ class RandGenerator<cpu, DType> {
   }
 
  private:
+  // mt19937 states, only exported to the custom operators of extension libraries
   std::mt19937* states_;
+  // key of the Philox streams, and position in its stream of each state
+  uint32_t key_[2];
+  uint64_t* counters_;
 };  // class RandGenerator<cpu, DType>
 
 template <typename DType>
@@ -24,6 +24,7 @@
 #ifndef MXNET_STORAGE_H_
 #define MXNET_STORAGE_H_
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -50,6 +51,11 @@ class Storage {
     std::vector<std::weak_ptr<cudaEvent_t>> events;
 #endif
   };
+  /*!
+   * \brief Callback asked to drop memory it caches on a context, e.g. static memory plans,
+   *  when an allocation on that context fails. It must not allocate memory.
+   */
+  typedef std::function<void(const Context& ctx)> MemoryPressureCallback;
   /*!
    * \brief Storage handle.
    */
@@ -129,6 +135,38 @@ class Storage {
    * For non-pool memory managers this has no effect.
    */
   virtual void ReleaseAll(Context ctx) = 0;
+  /*!
+   * \brief Get the usage counters of the storage managers.
+   * \return json object with one entry per storage manager in use.
+   */
+  virtual std::string GetStats() = 0;
+  /*!
+   * \brief Get the usage counters of the memory pools.
+   * \return the counters in the OpenMetrics text format, labeled by device.
+   */
+  virtual std::string GetMetrics() = 0;
+  /*!
+   * \brief Limit the memory held by the storage manager of a context.
+   *
+   * When an allocation would exceed the budget, the cached free memory of the pool
+   * is released first, then the memory pressure callbacks are called, and the
+   * allocation fails only if the budget is still exceeded. Contexts sharing a storage
+   * manager, e.g. all CPU contexts, share the budget.
+   * \param ctx the context.
+   * \param bytes the budget in bytes, 0 for no limit.
+   */
+  virtual void SetBudget(Context ctx, size_t bytes) = 0;
+  /*!
+   * \brief Register a callback called when an allocation fails.
+   * \return id of the callback for RemoveMemoryPressureCallback.
+   */
+  virtual int AddMemoryPressureCallback(MemoryPressureCallback callback) = 0;
+  /*!
+   * \brief Unregister a memory pressure callback.
+   *  Once it returns, the callback is not running and will not be called again.
+   * \param id the id returned by AddMemoryPressureCallback.
+   */
+  virtual void RemoveMemoryPressureCallback(int id) = 0;
   /*!
    * \brief Destructor.
    */
@@ -156,6 +194,19 @@ class Storage {
    * \return A shared pointer to Storage singleton.
    */
   static const std::shared_ptr<Storage>& _GetSharedRef();
+#if MXNET_USE_CUDA
+  /*!
+   * \brief Set the stream on which the calling thread uses the GPU memory it allocates.
+   *  Stream-ordered storage managers make this stream wait for an allocation instead
+   *  of synchronizing the host. Set by the GPU workers of the engine.
+   * \param stream the stream, nullptr when the thread has none.
+   */
+  static void SetConsumerStream(cudaStream_t stream);
+  /*!
+   * \return the stream set by SetConsumerStream on the calling thread, or nullptr.
+   */
+  static cudaStream_t ConsumerStream();
+#endif
 
  private:
   std::mutex cpu_mutex_;
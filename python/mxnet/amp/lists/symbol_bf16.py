@@ -32,7 +32,9 @@ if Features.instance.is_enabled('ONEDNN'):
         '_sg_onednn_fully_connected',
         '_sg_onednn_selfatt_qk',
         '_sg_onednn_selfatt_qk_split',
-        '_sg_onednn_selfatt_valatt'
+        '_sg_onednn_selfatt_valatt',
+        # bfloat16 inference only, and needs MXNET_USE_ONEDNN_RNN=1 (the default)
+        'RNN'
     ])
 
 
@@ -78,8 +80,17 @@ BF16_FP32_FUNCS = [
     'Cast',
     'where',
     'take',
+    'sort',
+    'argsort',
+    'topk',
+    'mp_sgd_update',
+    'mp_sgd_mom_update',
+    'mp_nag_mom_update',
+    'multi_mp_sgd_update',
+    'multi_mp_sgd_mom_update',
+    'mp_lamb_update_phase1',
+    'mp_lamb_update_phase2',
 ]
-# 'RNN', # GetEnv("MXNET_USE_ONEDNN_RNN", 1)
 
 # Functions with multiple inputs, that need the same
 # type of all their inputs
@@ -135,7 +146,6 @@ FP32_FUNCS = [
     'MAERegressionOutput',
     'MakeLoss',
     'Pad',
-    'RNN',
     'ROIPooling',
     'SVMOutput',
     'SequenceLast',
@@ -156,13 +166,16 @@ FP32_FUNCS = [
     '_NoGradient',
     '_adabelief_update',
     '_adamw_update',
+    '_alias_table',
     '_arange',
     '_cond',
     '_contrib_BilinearResize2D',
     '_contrib_DeformablePSROIPooling',
+    '_contrib_HashedEmbedding',
     '_contrib_MultiBoxDetection',
     '_contrib_MultiBoxPrior',
     '_contrib_MultiBoxTarget',
+    '_contrib_MultiLevelROIAlign',
     '_contrib_MultiProposal',
     '_contrib_PSROIPooling',
     '_contrib_Proposal',
@@ -173,11 +186,14 @@ FP32_FUNCS = [
     '_contrib_arange_like',
     '_contrib_bipartite_matching',
     '_contrib_boolean_mask',
+    '_contrib_boolean_mask_bounded',
     '_contrib_box_decode',
+    '_contrib_box_detection',
     '_contrib_box_encode',
     '_contrib_box_iou',
     '_contrib_box_nms',
     '_contrib_calibrate_entropy',
+    '_contrib_calibrate_observe',
     '_contrib_count_sketch',
     '_contrib_dequantize',
     '_contrib_dgl_adjacency',
@@ -186,15 +202,19 @@ FP32_FUNCS = [
     '_contrib_dgl_graph_compact',
     '_contrib_dgl_subgraph',
     '_contrib_div_sqrt_dim',
+    '_contrib_dropout_add_layer_norm',
     '_contrib_dynamic_reshape',
     '_contrib_edge_id',
     '_contrib_fft',
+    '_contrib_fp8_fully_connected',
     '_contrib_getnnz',
     '_contrib_gradientmultiplier',
     '_contrib_group_adagrad_update',
     '_contrib_hawkesll',
     '_contrib_index_array',
     '_contrib_index_copy',
+    '_contrib_interleaved_decode_selfatt',
+    '_contrib_interleaved_fused_selfatt',
     '_contrib_interleaved_matmul_encdec_qk',
     '_contrib_interleaved_matmul_encdec_valatt',
     '_contrib_interleaved_matmul_selfatt_qk',
@@ -217,9 +237,12 @@ FP32_FUNCS = [
     '_contrib_quantized_embedding',
     '_contrib_quantized_flatten',
     '_contrib_quantized_fully_connected',
+    '_contrib_quantized_layer_norm',
+    '_contrib_quantized_leaky_relu',
     '_contrib_quantized_pooling',
     '_contrib_quantized_reshape',
     '_contrib_quantized_rnn',
+    '_contrib_quantized_softmax',
     '_contrib_quantized_transpose',
     '_contrib_requantize',
     '_contrib_round_ste',
@@ -227,6 +250,10 @@ FP32_FUNCS = [
     '_contrib_sldwin_atten_context',
     '_contrib_sldwin_atten_mask_like',
     '_contrib_sldwin_atten_score',
+    '_contrib_sparse24_compress',
+    '_contrib_sparse24_fully_connected',
+    '_contrib_weight_only_fully_connected',
+    '_contrib_weight_only_quantize',
     '_copyto',
     '_cvcopyMakeBorder',
     '_cvimdecode',
@@ -248,6 +275,7 @@ FP32_FUNCS = [
     '_hypot_scalar',
     '_identity_with_attr_like_rhs',
     '_image_adjust_lighting',
+    '_image_batch_preprocess',
     '_image_crop',
     '_image_flip_left_right',
     '_image_flip_top_bottom',
@@ -587,6 +615,7 @@ FP32_FUNCS = [
     '_sample_normal',
     '_sample_poisson',
     '_sample_uniform',
+    '_sample_candidates',
     '_sample_unique_zipfian',
     '_scatter_set_nd',
     '_set_value',
@@ -612,7 +641,6 @@ FP32_FUNCS = [
     'argmax',
     'argmax_channel',
     'argmin',
-    'argsort',
     'batch_take',
     'broadcast_axis',
     'broadcast_equal',
@@ -674,18 +702,12 @@ FP32_FUNCS = [
     'min',
     'mish',
     'moments',
-    'mp_lamb_update_phase1',
-    'mp_lamb_update_phase2',
-    'mp_nag_mom_update',
-    'mp_sgd_mom_update',
-    'mp_sgd_update',
     'multi_all_finite',
     'multi_lars',
-    'multi_mp_sgd_mom_update',
-    'multi_mp_sgd_update',
     'multi_sgd_mom_update',
     'multi_sgd_update',
     'multi_sum_sq',
+    'multi_tensor_stats',
     'nag_mom_update',
     'nanprod',
     'nansum',
@@ -729,17 +751,22 @@ FP32_FUNCS = [
     'softmax_cross_entropy',
     'softmin',
     'softsign',
-    'sort',
     'sqrt',
     'square',
     'squeeze',
     'tan',
     'tanh',
     'tile',
-    'topk',
     'trunc',
     'zeros_like',
 ]
+if Features.instance.is_enabled('ONEDNN'):
+    FP32_FUNCS.extend([
+        '_sg_onednn_layout_eltwise',
+        '_sg_onednn_selfatt',
+    ])
+else:
+    FP32_FUNCS.append('RNN')
 
 # Functions that have to be cast to FP32 only for
 # some values of their parameters
@@ -51,10 +51,17 @@ FP16_FP32_FUNCS = [
     '_contrib_intgemm_prepare_data',
     '_contrib_intgemm_prepare_weight',
     '_contrib_intgemm_take_weight',
+    '_contrib_sparse24_compress',
+    '_contrib_sparse24_fully_connected',
+    '_contrib_weight_only_fully_connected',
+    '_contrib_weight_only_quantize',
     '_contrib_quantized_batch_norm',
     '_contrib_quantized_batch_norm_relu',
     '_contrib_quantized_elemwise_mul',
     '_contrib_quantized_embedding',
+    '_contrib_quantized_layer_norm',
+    '_contrib_quantized_leaky_relu',
+    '_contrib_quantized_softmax',
     '_contrib_mrcnn_mask_target',
     '_contrib_round_ste',
     '_contrib_sign_ste',
@@ -84,14 +91,17 @@ FP16_FP32_FUNCS = [
     '_NoGradient',
     '_adabelief_update',
     '_adamw_update',
+    '_alias_table',
     '_arange',
     '_cond',
     '_contrib_AdaptiveAvgPooling2D',
     '_contrib_BilinearResize2D',
+    '_contrib_HashedEmbedding',
     '_contrib_bipartite_matching',
     '_contrib_dequantize',
     '_contrib_div_sqrt_dim',
     '_contrib_boolean_mask',
+    '_contrib_boolean_mask_bounded',
     '_contrib_getnnz',
     '_contrib_gradientmultiplier',
     '_contrib_group_adagrad_update',
@@ -135,6 +145,7 @@ FP16_FP32_FUNCS = [
     '_hypot_scalar',
     '_identity_with_attr_like_rhs',
     '_image_adjust_lighting',
+    '_image_batch_preprocess',
     '_image_flip_left_right',
     '_image_flip_top_bottom',
     '_image_normalize',
@@ -369,6 +380,7 @@ FP16_FP32_FUNCS = [
     '_sample_normal',
     '_sample_poisson',
     '_sample_uniform',
+    '_sample_candidates',
     '_sample_unique_zipfian',
     '_scatter_set_nd',
     '_set_value',
@@ -433,6 +445,7 @@ FP16_FP32_FUNCS = [
     'multi_sgd_mom_update',
     'multi_sgd_update',
     'multi_sum_sq',
+    'multi_tensor_stats',
     'nag_mom_update',
     'negative',
     'one_hot',
@@ -490,7 +503,10 @@ FP32_FUNCS = [
     'tan',
     'arctanh',
     '_contrib_calibrate_entropy',
+    '_contrib_calibrate_observe',
+    '_contrib_fp8_fully_connected',
     '_contrib_MultiBoxDetection',
+    '_contrib_box_detection',
     '_contrib_MultiBoxPrior',
     '_contrib_MultiBoxTarget',
     '_npi_arccos',
@@ -608,6 +624,7 @@ FP32_FUNCS = [
     'masked_log_softmax',
     'InstanceNorm',
     'LayerNorm',
+    '_contrib_dropout_add_layer_norm',
     'GroupNorm',
     'L2Normalization',
     'LRN',
@@ -637,8 +654,10 @@ if Features().is_enabled('ONEDNN'):
         '_sg_onednn_selfatt_qk',
         '_sg_onednn_selfatt_qk_split',
         '_sg_onednn_selfatt_valatt',
+        '_sg_onednn_selfatt',
         '_sg_onednn_batch_dot',
         '_sg_onednn_batch_norm',
+        '_sg_onednn_layout_eltwise',
         '_sg_pow_mul_scalar'
     ])
 
@@ -720,6 +739,7 @@ WIDEST_TYPE_CASTS = [
     'elemwise_mul',
     'elemwise_sub',
     'stack',
+    '_contrib_MultiLevelROIAlign',
     '_contrib_MultiProposal',
     '_contrib_PSROIPooling',
     '_contrib_Proposal',
@@ -738,6 +758,8 @@ WIDEST_TYPE_CASTS = [
     '_contrib_interleaved_matmul_encdec_valatt',
     '_contrib_interleaved_matmul_selfatt_qk',
     '_contrib_interleaved_matmul_selfatt_valatt',
+    '_contrib_interleaved_fused_selfatt',
+    '_contrib_interleaved_decode_selfatt',
     'where',
 
     '_random_pdf_gamma',
@@ -366,6 +366,44 @@ def get_symbol(x):
     return Symbol(hdl)
 
 
+_GRAD_HOOK_FUNCTYPE = CFUNCTYPE(None, c_void_p)
+# callbacks passed to the backend, by gradient handle
+_grad_hooks = {}
+
+
+def set_grad_hook(grad, hook):
+    """Set a function called during `backward`, once per call, as soon as the operator
+    computing `grad` is scheduled and before the rest of the backward pass is.
+
+    `grad` is not computed yet when `hook` is called, but operators issued on it by
+    `hook`, for example a gradient reduction, run as soon as it is. This lets them
+    overlap with the computation of the remaining gradients.
+
+    Parameters
+    ----------
+    grad : NDArray
+        Gradient array, as attached by `attach_grad` or `mark_variables`.
+    hook : callable or None
+        Called without arguments. None removes the hook of `grad`.
+    """
+    assert isinstance(grad, NDArray), \
+       f"set_grad_hook: Invalid argument type, expecting {NDArray}, got {type(grad)}"
+    key = grad.handle.value
+    if hook is None:
+        check_call(_LIB.MXAutogradSetGradHook(grad.handle, None, None))
+        _grad_hooks.pop(key, None)
+        return
+
+    def callback(_):
+        try:
+            hook()
+        except Exception:  # pylint: disable=broad-except
+            print(f'Error in autograd grad hook: {traceback.format_exc()}')
+    callback = _GRAD_HOOK_FUNCTYPE(callback)
+    check_call(_LIB.MXAutogradSetGradHook(grad.handle, callback, None))
+    _grad_hooks[key] = callback
+
+
 class Function(object):
     """Customize differentiation in autograd.
 
@@ -342,6 +342,7 @@ RtcHandle = ctypes.c_void_p
 CudaModuleHandle = ctypes.c_void_p
 CudaKernelHandle = ctypes.c_void_p
 ProfileHandle = ctypes.c_void_p
+CheckpointHandle = ctypes.c_void_p
 
 
 #----------------------------
@@ -47,7 +47,20 @@ def _multilist_iterator(arg, func):
 
     return ret
 
-def _quantize_params(qsym, params, min_max_dict):
+def _quantize_channel_wise(param):
+    """Quantizes a weight to int8 with one symmetric range per output channel (axis 0).
+    Returns the quantized weight and the per channel min/max ranges."""
+    array_cls = mx.np if is_np_array() else mx.nd
+    weight = param.asnumpy().astype('float32')
+    max_abs = np.abs(weight.reshape(weight.shape[0], -1)).max(axis=1)
+    scale = np.where(max_abs > 0, 127.0 / np.maximum(max_abs, 1e-30), 0.0).astype('float32')
+    scale = scale.reshape((-1,) + (1,) * (weight.ndim - 1))
+    quantized = np.sign(weight) * np.minimum(np.floor(np.abs(weight) * scale + 0.5), 127)
+    return (array_cls.array(quantized, dtype='int8'),
+            array_cls.array(-max_abs),
+            array_cls.array(max_abs))
+
+def _quantize_params(qsym, params, min_max_dict, channel_wise=False):
     """Given a quantized symbol and a dict of params that have not been quantized,
     generate quantized params. Currently only supports quantizing the arg_params
     with names of `weight` or `bias`, not aux_params. If `qsym` contains symbols
@@ -61,6 +74,9 @@ def _quantize_params(qsym, params, min_max_dict):
         Quantized symbol from FP32 symbol.
     params : dict of str->NDArray
     min_max_dict : dict of min/max pairs of layers' output
+    channel_wise : bool
+        Whether the weights get one quantization range per output channel instead of one
+        per tensor.
     """
     inputs_name = qsym.list_arguments()
     quantized_params = {}
@@ -79,6 +95,12 @@ def _quantize_params(qsym, params, min_max_dict):
         if name.endswith(('weight_quantize', 'bias_quantize')):
             original_name = name[:-len('_quantize')]
             param = params[original_name]
+            if channel_wise and name.endswith('weight_quantize') and param.ndim > 1:
+                val, vmin, vmax = _quantize_channel_wise(param)
+                quantized_params[name] = val
+                quantized_params[name+'_min'] = vmin
+                quantized_params[name+'_max'] = vmax
+                continue
             # pylint: disable=unbalanced-tuple-unpacking
             param_min = min_fn(param)
             param_max = max_fn(param)
@@ -211,10 +233,14 @@ class _LayerHistogramCollector(CalibrationCollector):
     """Saves layer histogram in a dict with layer names as keys and lists of NDArrays as
     values. The collected histogram will be used for calculating the optimal thresholds for
     quantization using KL divergence.
+
+    The histograms are accumulated by the `calibrate_observe` operator on the device of the
+    layer outputs, so collecting a batch does not wait for it nor copy it to the host.
     """
     def __init__(self, quantized_dtype, num_bins=8001, include_layers=None, logger=None):
         super(_LayerHistogramCollector, self).__init__()
         self.hist_dict = {}
+        self.observers = {}
         self.num_bins = num_bins
         self.include_layers = include_layers
         self.logger = logger
@@ -224,19 +250,22 @@ class _LayerHistogramCollector(CalibrationCollector):
         """Callback function for collecting layer output NDArrays."""
         if name not in self.include_layers:
             return
-        arr = arr.copyto(cpu()).asnumpy()
+        arr = arr.as_nd_ndarray()
         if self.logger:
             self.logger.debug(f"Collecting layer {name} histogram of shape {arr.shape}")
-        min_range = np.min(arr)
-        max_range = np.max(arr)
-        th = max(abs(min_range), abs(max_range))
-        if name in self.hist_dict:
-            self.hist_dict[name] = self.combine_histogram(self.hist_dict[name], arr, min_range, max_range, th)
-        else:
-            hist, hist_edges = np.histogram(arr, bins=self.num_bins, range=(-th, th))
-            self.hist_dict[name] = (hist, hist_edges, min_range, max_range, th)
+        if name not in self.observers:
+            hist = ndarray.zeros((self.num_bins,), ctx=arr.context, dtype='float64')
+            stats = ndarray.array([np.inf, -np.inf, 0], ctx=arr.context, dtype='float32')
+            self.observers[name] = (hist, stats)
+        hist, stats = self.observers[name]
+        ndarray.contrib.calibrate_observe(data=arr, hist=hist, stats=stats)
 
     def post_collect(self):
+        for name, (hist, stats) in self.observers.items():
+            min_range, max_range, th = stats.asnumpy().tolist()
+            hist_edges = np.linspace(-th, th, self.num_bins + 1)
+            self.hist_dict[name] = (np.rint(hist.asnumpy()), hist_edges, min_range, max_range, th)
+        self.observers = {}
         min_max_dict = self.get_optimal_thresholds(self.hist_dict, self.quantized_dtype, logger=self.logger)
         return min_max_dict
 
@@ -285,26 +314,44 @@ class _LayerHistogramCollector(CalibrationCollector):
 
     @staticmethod
     def get_optimal_thresholds(hist_dict, quantized_dtype, num_quantized_bins=255, logger=None):
-        """Given a ndarray dict, find the optimal threshold for quantizing each value of the key."""
+        """Given a ndarray dict, find the optimal threshold for quantizing each value of the key.
+        The histograms of the same size are searched together by a single operator call."""
         assert isinstance(hist_dict, dict)
         if logger is not None:
             logger.info('Calculating optimal thresholds for quantization using KL divergence'
                         f' with num_quantized_bins={num_quantized_bins}')
         th_dict = {}
-        # copy hist_dict keys since the keys() only returns a view in python3
-        layer_names = list(hist_dict.keys())
-        for name in layer_names:
-            assert name in hist_dict
-            min_val, max_val, th, divergence = \
-                _LayerHistogramCollector.get_optimal_threshold(hist_dict[name], quantized_dtype,
-                                                               num_quantized_bins=num_quantized_bins)
-            if min_val >= 0 and quantized_dtype in ['auto', 'uint8']:
-                th_dict[name] = (0, th)
-            else:
-                th_dict[name] = (-th, th)
+        # group the layers by the arguments of the search, non negative layers quantized
+        # to uint8 use twice as many quantized bins
+        groups = {}
+        for name, hist_data in hist_dict.items():
+            (hist, _, min_val, _, _) = hist_data
+            assert len(hist) % 2 == 1
+            unsigned = min_val >= 0 and quantized_dtype in ['auto', 'uint8']
+            group_bins = num_quantized_bins * 2 + 1 if unsigned else num_quantized_bins
+            groups.setdefault((len(hist), group_bins), []).append(name)
+        for (_, group_bins), names in groups.items():
+            hist = ndarray.array(np.stack([np.asarray(hist_dict[name][0]) for name in names]),
+                                 ctx=cpu())
+            hist_edges = ndarray.array(np.stack([np.asarray(hist_dict[name][1]) for name in names]),
+                                       ctx=cpu())
+            thresholds, divergences = ndarray.contrib.calibrate_entropy(hist=hist,
+                                                                        hist_edges=hist_edges,
+                                                                        num_quantized_bins=group_bins)
+            thresholds = thresholds.asnumpy()
+            divergences = divergences.asnumpy()
+            for i, name in enumerate(names):
+                (_, _, min_val, max_val, _) = hist_dict[name]
+                th = thresholds[i:i + 1]
+                if min_val >= 0 and quantized_dtype in ['auto', 'uint8']:
+                    th_dict[name] = (0, th)
+                else:
+                    th_dict[name] = (-th, th)
+                if logger:
+                    logger.debug(f"layer={name}, min_val={min_val}, max_val={max_val}, th={th},"
+                                 f" divergence={divergences[i:i + 1]}")
+        for name in list(th_dict.keys()):
             del hist_dict[name]  # release the memory
-            if logger:
-                logger.debug(f"layer={name}, min_val={min_val}, max_val={max_val}, th={th}, divergence={divergence}")
         return th_dict
 
 
@@ -560,7 +607,10 @@ def quantize_model(sym, arg_params, aux_params, data_names=('data',),
 
     if logger:
         logger.info('Quantizing parameters')
-    qarg_params = _quantize_params(qsym, arg_params, min_max_dict)
+    # the GPU kernels take one weight range per output channel, the oneDNN backend derives its
+    # own channel-wise scales from the per tensor ranges
+    channel_wise = quantize_granularity == 'channel-wise' and device.device_type == 'gpu'
+    qarg_params = _quantize_params(qsym, arg_params, min_max_dict, channel_wise=channel_wise)
 
     if is_np_array():
         qsym = qsym.as_np_ndarray()
@@ -730,7 +780,8 @@ def quantize_graph(sym, arg_params, aux_params, device=cpu(),
 
     if logger:
         logger.info('Quantizing parameters')
-    qarg_params = _quantize_params(qsym, arg_params, min_max_dict={})
+    channel_wise = quantize_granularity == 'channel-wise' and device.device_type == 'gpu'
+    qarg_params = _quantize_params(qsym, arg_params, min_max_dict={}, channel_wise=channel_wise)
 
     if is_np_array():
         qsym = qsym.as_np_ndarray()
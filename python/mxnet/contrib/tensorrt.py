@@ -34,6 +34,19 @@ def get_use_fp16():
     """
     return bool(int(os.environ.get("MXNET_TENSORRT_USE_FP16", 1)) == 1)
 
+def save_calib_table(fname, min_max_dict):
+    """
+    Save the ranges of the layer outputs collected by a calibration of MXNet, for the int8
+    TensorRT engines built with MXNET_TENSORRT_PRECISION=int8 and
+    MXNET_TENSORRT_CALIB_TABLE=fname
+    :param fname: String, path of the calibration table
+    :param min_max_dict: dict of (min, max) of the layer outputs by name, e.g. the result of
+    the post_collect method of a calibration collector of mxnet.contrib.quantization
+    """
+    with open(fname, 'w') as fout:
+        for name, (min_range, max_range) in sorted(min_max_dict.items()):
+            fout.write(f"{name} {float(min_range)} {float(max_range)}\n")
+
 def init_tensorrt_params(sym, arg_params, aux_params):
     """
     Set weights in attributes of TensorRT nodes
@@ -17,7 +17,8 @@
 """Device management API of mxnet."""
 import contextvars
 import ctypes
-from .base import _LIB
+import json
+from .base import _LIB, py_str
 from .base import check_call
 
 
@@ -135,6 +136,29 @@ class Device:
         dev_id = ctypes.c_int(self.device_id)
         check_call(_LIB.MXStorageEmptyCache(dev_type, dev_id))
 
+    def set_memory_budget(self, budget):
+        """Limits the memory held by the memory pool of the current device.
+
+        When an allocation would exceed the budget, the memory cached by the pool
+        is released and cached operators drop their static memory, before the
+        allocation fails. Devices sharing a memory pool, e.g. all CPU devices,
+        share the budget. It can also be set by `MXNET_GPU_MEM_POOL_BUDGET` and
+        `MXNET_CPU_MEM_POOL_BUDGET`.
+
+        Parameters
+        ----------
+        budget : int
+            The budget in bytes, 0 for no limit.
+
+        Examples
+        -------
+        >>> ctx = mx.gpu(0)
+        >>> ctx.set_memory_budget(4 * 1024 ** 3)
+        """
+        dev_type = ctypes.c_int(self.device_typeid)
+        dev_id = ctypes.c_int(self.device_id)
+        check_call(_LIB.MXStorageSetBudget(dev_type, dev_id, ctypes.c_uint64(budget)))
+
 
 def cpu(device_id=0):
     """Returns a CPU device.
@@ -269,6 +293,29 @@ def gpu_memory_info(device_id=0):
     return (free.value, total.value)
 
 
+def memory_pool_stats():
+    """Query the usage counters of the memory pools of all devices in use.
+
+    The counters help choosing the memory pool type and rounding parameters
+    (see `MXNET_*_MEM_POOL_TYPE`) from data: low `efficiency` means that much
+    of the served memory is lost to rounding, low `hit_rate` means that chunks
+    are seldom reused.
+
+    Returns
+    -------
+    dict
+        One entry per storage manager, keyed by its device, e.g. `cpu(0)`. With
+        `MXNET_CPU_NUMA_AWARE=1` the CPU managers serve a NUMA node and are keyed
+        `cpu_numa(node)`. Pooled managers report
+        `reserved` and `peak_reserved` bytes, `hits`, `misses`, `hit_rate`, the bytes
+        `requested` by allocations vs the bytes of the `served` chunks, their ratio
+        `efficiency`, and the same counters per bucket in `buckets`.
+    """
+    out = ctypes.c_char_p()
+    check_call(_LIB.MXStorageGetStats(ctypes.byref(out)))
+    return json.loads(py_str(out.value))
+
+
 _current = contextvars.ContextVar('namemanager', default=Device('cpu', 0))
 
 
@@ -101,6 +101,37 @@ def dl_managed_tensor_deleter(dl_managed_tensor_handle):
     pyobj = ctypes.cast(void_p, ctypes.py_object)
     ctypes.pythonapi.Py_DecRef(pyobj)
 
+def _consume_capsule(dlpack):
+    """Returns the DLManagedTensor of a capsule, which is marked as used."""
+    assert ctypes.pythonapi.PyCapsule_IsValid(dlpack, _c_str_dltensor), ValueError(
+        'Invalid DLPack Tensor. DLTensor capsules can be consumed only once.')
+    dlpack_handle = ctypes.c_void_p(ctypes.pythonapi.PyCapsule_GetPointer(dlpack, _c_str_dltensor))
+    # Rename PyCapsule (DLPack)
+    ctypes.pythonapi.PyCapsule_SetName(dlpack, _c_str_used_dltensor)
+    # delete the deleter of the old dlpack
+    ctypes.pythonapi.PyCapsule_SetDestructor(dlpack, None)
+    return dlpack_handle
+
+
+def _sparse_from_dlpack(dlpack):
+    """Returns a sparse array from a tuple (stype, shape, data, aux data...) of capsules."""
+    from .ndarray.ndarray import _STORAGE_TYPE_STR_TO_ID
+    from .ndarray.sparse import _ndarray_cls
+    stype, shape, data, aux = dlpack[0], dlpack[1], dlpack[2], dlpack[3:]
+    for capsule in dlpack[2:]:
+        assert ctypes.pythonapi.PyCapsule_IsValid(ctypes.py_object(capsule), _c_str_dltensor), \
+            ValueError('Invalid DLPack Tensor. DLTensor capsules can be consumed only once.')
+    data_handle = _consume_capsule(ctypes.py_object(data))
+    aux_handles = (ctypes.c_void_p * len(aux))(
+        *[_consume_capsule(ctypes.py_object(capsule)) for capsule in aux])
+    handle = NDArrayHandle()
+    check_call(_LIB.MXNDArrayFromDLPackSparse(
+        ctypes.c_int(_STORAGE_TYPE_STR_TO_ID[stype]), (ctypes.c_int64 * len(shape))(*shape),
+        ctypes.c_int(len(shape)), data_handle, ctypes.c_uint32(len(aux)), aux_handles, False,
+        ctypes.byref(handle)))
+    return _ndarray_cls(handle)
+
+
 def ndarray_from_dlpack(array_cls):
     """Returns a function that returns specified array_cls from dlpack.
 
@@ -111,31 +142,48 @@ def ndarray_from_dlpack(array_cls):
     def from_dlpack(dlpack):
         tp = type(dlpack)
         if tp.__module__ == "builtins" and tp.__name__ == "PyCapsule":
-            dlpack = ctypes.py_object(dlpack)        
+            dlpack = ctypes.py_object(dlpack)
+        elif isinstance(dlpack, tuple):
+            return _sparse_from_dlpack(dlpack)
         elif hasattr(dlpack, "__dlpack__"):
             device, device_id = dlpack.__dlpack_device__()
             if device != DLDeviceType.DLGPU:
                 dlpack = ctypes.py_object(dlpack.__dlpack__())
             else:
-                s = mx_int()
+                s = ctypes.c_int64()
                 check_call(_LIB.MXGetCurrentStream(
                     ctypes.c_int(device_id), ctypes.byref(s)))
                 dlpack = ctypes.py_object(dlpack.__dlpack__(stream=s.value))
         else:
             raise AttributeError("Required PyCapsule or object with __dlpack__")
         handle = NDArrayHandle()
-        assert ctypes.pythonapi.PyCapsule_IsValid(dlpack, _c_str_dltensor), ValueError(
-            'Invalid DLPack Tensor. DLTensor capsules can be consumed only once.')
-        dlpack_handle = ctypes.c_void_p(ctypes.pythonapi.PyCapsule_GetPointer(dlpack, _c_str_dltensor))
+        dlpack_handle = _consume_capsule(dlpack)
         check_call(_LIB.MXNDArrayFromDLPack(dlpack_handle, False, ctypes.byref(handle)))
-        # Rename PyCapsule (DLPack)
-        ctypes.pythonapi.PyCapsule_SetName(dlpack, _c_str_used_dltensor)
-        # delete the deleter of the old dlpack
-        ctypes.pythonapi.PyCapsule_SetDestructor(dlpack, None)
         return array_cls(handle=handle)
     return from_dlpack
 
 
+def ndarray_to_dlpack(data):
+    """Returns dlpack of an mxnet array without waiting for its pending operations.
+
+    For sparse arrays, returns a tuple (stype, shape, data, aux data...) of the storage type, the
+    shape and the capsules of the data and of the aux data, indptr and indices for csr.
+    """
+    dlpack = DLPackHandle()
+    check_call(_LIB.MXNDArrayToDLPack(data.handle, ctypes.byref(dlpack)))
+    capsule = ctypes.pythonapi.PyCapsule_New(dlpack, _c_str_dltensor, _c_dlpack_deleter)
+    if data.stype == 'default':
+        return capsule
+    capsules = [capsule]
+    for i in range(data._num_aux):
+        dlpack = DLPackHandle()
+        check_call(_LIB.MXNDArrayAuxToDLPack(data.handle, ctypes.c_uint32(i),
+                                             ctypes.byref(dlpack)))
+        capsules.append(ctypes.pythonapi.PyCapsule_New(dlpack, _c_str_dltensor,
+                                                       _c_dlpack_deleter))
+    return (data.stype, data.shape) + tuple(capsules)
+
+
 def ndarray_to_dlpack_for_read():
     """Returns a function that returns dlpack for reading from mxnet array.
 
@@ -145,9 +193,7 @@ def ndarray_to_dlpack_for_read():
     """
     def to_dlpack_for_read(data):
         data.wait_to_read()
-        dlpack = DLPackHandle()
-        check_call(_LIB.MXNDArrayToDLPack(data.handle, ctypes.byref(dlpack)))
-        return ctypes.pythonapi.PyCapsule_New(dlpack, _c_str_dltensor, _c_dlpack_deleter)
+        return ndarray_to_dlpack(data)
     return to_dlpack_for_read
 
 def ndarray_to_dlpack_for_write():
@@ -160,9 +206,7 @@ def ndarray_to_dlpack_for_write():
     def to_dlpack_for_write(data):
 
         check_call(_LIB.MXNDArrayWaitToWrite(data.handle))
-        dlpack = DLPackHandle()
-        check_call(_LIB.MXNDArrayToDLPack(data.handle, ctypes.byref(dlpack)))
-        return ctypes.pythonapi.PyCapsule_New(dlpack, _c_str_dltensor, _c_dlpack_deleter)
+        return ndarray_to_dlpack(data)
     return to_dlpack_for_write
 
 def ndarray_from_numpy(array_cls, array_create_fn):
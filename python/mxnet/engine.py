@@ -19,7 +19,9 @@
 """Engine properties management."""
 
 import ctypes
-from .base import _LIB, check_call
+import json
+from .base import _LIB, check_call, py_str, c_str
+from .device import current_device
 
 
 def set_bulk_size(size):
@@ -72,3 +74,116 @@ def bulk(size):
                 x += 1
     """
     return _BulkScope(size)
+
+
+def set_stream(stream):
+    """Set the stream of the operators pushed by the calling thread.
+
+    Parameters
+    ----------
+    stream : int
+        Id of a stream returned by `create_stream`, 0 for the default streams.
+
+    Returns
+    -------
+    int
+        Previous stream of the thread.
+    """
+    prev = ctypes.c_int()
+    check_call(_LIB.MXEngineSetStream(ctypes.c_int(stream), ctypes.byref(prev)))
+    return prev.value
+
+
+def create_stream(name, device=None, priority=0):
+    """Create a named stream of a GPU, or get the one of the same name already created.
+
+    The operators pushed on the GPU while the stream is set run in order on their own
+    worker thread and CUDA stream, concurrently with the operators of the other streams
+    of the GPU, e.g. those of another model. Returns 0, the default streams, with the
+    engines other than `ThreadedEnginePerDevice`.
+
+    Parameters
+    ----------
+    name : str
+        Name of the stream, unique per GPU.
+    device : Device
+        GPU of the stream, the current device by default.
+    priority : int
+        CUDA priority of the stream. Lower numbers are higher priorities, 0 is the default
+        priority and -1 usually the highest one.
+
+    Returns
+    -------
+    int
+        Id of the stream.
+    """
+    device = current_device() if device is None else device
+    out = ctypes.c_int()
+    check_call(_LIB.MXEngineCreateStream(ctypes.c_int(device.device_typeid),
+                                         ctypes.c_int(device.device_id),
+                                         c_str(name), ctypes.c_int(priority),
+                                         ctypes.byref(out)))
+    return out.value
+
+
+class _StreamScope(object):
+    """Scope object for a named stream."""
+    def __init__(self, stream):
+        self._stream = stream
+        self._old_stream = None
+
+    def __enter__(self):
+        self._old_stream = set_stream(self._stream)
+        return self
+
+    def __exit__(self, ptype, value, trace):
+        set_stream(self._old_stream)
+
+
+def stream(name, device=None, priority=0):
+    """Run the operators pushed by the calling thread on a named stream of a GPU.
+
+    Returns a scope for managing the stream, e.g. to run two models concurrently on
+    one GPU, one of them with a higher priority::
+
+        with mx.engine.stream('detector', mx.gpu(0), priority=-1):
+            boxes = detector(image)
+        with mx.engine.stream('classifier', mx.gpu(0)):
+            labels = classifier(crops)
+
+    The operators of a hybridized block called in the scope, including those of its
+    CachedOp, run on the stream. See `create_stream` for the parameters.
+    """
+    return _StreamScope(create_stream(name, device, priority))
+
+
+def get_stats(reset=False):
+    """Get the engine overhead counters.
+
+    The counters tell whether a workload is bound by the engine scheduling overhead
+    or by the operator kernels. Collection can be disabled by setting the environment
+    variable `MXNET_ENGINE_STATS` to 0.
+
+    Parameters
+    ----------
+    reset : bool
+        Whether to clear the counters after reading them.
+
+    Returns
+    -------
+    dict
+        Number of pushed operators (`pushed`), current and maximum number of ready
+        operators waiting for a worker (`queue_depth`, `max_queue_depth`) and histograms
+        of the latency between push and start of execution in microseconds
+        (`wait_to_run_us`), of the number of operators made ready by each completion
+        (`dependency_fanout`) and of the number of operators per bulk segment
+        (`bulk_segment_size`). Bucket 0 of each histogram counts the value 0 and
+        bucket i counts values in [2**(i-1), 2**i). With `MXNET_TEMP_SPACE_DYNAMIC`,
+        also the number of temp space requests (`temp_space_requests`), of those finding
+        all copies busy (`temp_space_contended`), of added copies
+        (`temp_space_copies_added`) and the bytes of released oversized workspaces
+        (`temp_space_released_bytes`).
+    """
+    out = ctypes.c_char_p()
+    check_call(_LIB.MXEngineGetStats(ctypes.byref(out), ctypes.c_int(reset)))
+    return json.loads(py_str(out.value))
@@ -23,6 +23,7 @@ __all__ = ['Block', 'HybridBlock', 'SymbolBlock']
 import enum
 import ctypes
 import copy
+import os
 import warnings
 import weakref
 from collections import OrderedDict, defaultdict
@@ -33,7 +34,8 @@ import re
 import json
 import numpy as np
 
-from ..base import mx_real_t, MXNetError, NDArrayHandle, SymbolHandle, py_str, check_call, _LIB
+from ..base import mx_real_t, MXNetError, NDArrayHandle, SymbolHandle, py_str, check_call, _LIB, \
+    c_str
 from .. import symbol, ndarray, initializer, autograd, _deferred_compute as dc, name as _name, \
     profiler as _profiler, device as _device
 from ..symbol.numpy import _symbol as np_symbol
@@ -49,6 +51,19 @@ from .. util import is_np_array, np_shape, np_array, wrap_ctx_to_device_func
 
 _naming_counter = contextvars.ContextVar('namecounter')
 _prefix = contextvars.ContextVar('prefix', default='')
+# flags of HybridBlock.hybridize saved with a compiled model
+_HYBRIDIZE_FLAGS = ('static_alloc', 'static_shape', 'inline_limit', 'forward_bulk_size',
+                    'backward_bulk_size', 'backward_recompute', 'recompute_segment_size')
+# attributes of HybridBlock holding its compiled graph, see HybridBlock._cached_op_state
+_CACHED_OP_STATE = ('_cached_graph', '_cached_op', '_cached_op_args', '_cached_input_desc',
+                    '_in_format', '_out_format', '_first_forward', '_backend', '_backend_opts',
+                    '_flags')
+
+
+def _auto_hybridize_threshold():
+    """Number of identical traces of an input signature after which a HybridBlock which is not
+    hybridized runs it through a CachedOp, 0 when disabled. See MXNET_GLUON_AUTO_HYBRIDIZE."""
+    return int(os.environ.get('MXNET_GLUON_AUTO_HYBRIDIZE', '0'))
 
 
 @contextlib.contextmanager
@@ -1089,6 +1104,9 @@ class HybridBlock(Block):
         self._backend_opts = {}
         self._partition_if_dynamic = True
         self._first_forward = True
+        self._auto_hybridize = _auto_hybridize_threshold()
+        self._auto_signatures = {}
+        self._auto_graphs = {}
 
     def __setattr__(self, name, value):
         """Registers parameters."""
@@ -1128,8 +1146,75 @@ class HybridBlock(Block):
             self._cached_graph = symbol_inputs, symbol_outputs
         return self._cached_graph
 
+    @contextlib.contextmanager
+    def _cached_op_state(self, state):
+        """Swaps in the compiled graph held by the dict `state`, which gets the changes made to
+        it on exit."""
+        saved = {name: getattr(self, name, None) for name in _CACHED_OP_STATE}
+        for name in _CACHED_OP_STATE:
+            setattr(self, name, state[name])
+        try:
+            yield
+        finally:
+            for name in _CACHED_OP_STATE:
+                state[name] = getattr(self, name)
+                setattr(self, name, saved[name])
+
+    def _trace_graph(self, *args):
+        """Traces forward in deferred compute mode into a new compiled graph state.
+
+        Returns the key of the structure of the graph, which does not depend on the names given
+        to its operators, and the state. Both are None when forward cannot be traced.
+        """
+        state = {name: None for name in _CACHED_OP_STATE}
+        state.update(_cached_graph=(), _cached_op_args=[], _first_forward=True,
+                     _backend_opts={}, _flags=[('static_alloc', True), ('static_shape', False),
+                                               ('inline_limit', 2)])
+        try:
+            with self._cached_op_state(state):
+                _, out = self._get_graph(*args)
+        except Exception:  # pylint: disable=broad-except
+            return None, None
+        graph = json.loads(out.tojson())
+        for node in graph['nodes']:
+            if node['op'] != 'null':
+                node['name'] = ''
+        key = '{}{}{}'.format(json.dumps(graph, sort_keys=True), state['_in_format'],
+                              state['_out_format'])
+        return key, state
+
+    def _call_auto_hybridized(self, x, *args):
+        """Runs forward eagerly while tracing it, per input signature: devices, shapes, dtypes
+        and training mode. Once MXNET_GLUON_AUTO_HYBRIDIZE traces in a row of a signature are
+        identical, the signature runs through a static_alloc CachedOp of the traced graph, shared
+        with the signatures of the same graph. Signatures whose traces differ, or which cannot be
+        traced, stay eager."""
+        flatten_args, fmt = _flatten([x, *args], "input")
+        real_args = [ele for ele in flatten_args if ele is not None]
+        signature = (str(fmt), autograd.is_training(),
+                     tuple((ele.shape, ele.dtype, str(ele.device)) for ele in real_args))
+        trace = self._auto_signatures.get(signature)
+        if trace is None or (trace[0] is not None and trace[1] < self._auto_hybridize):
+            key, state = self._trace_graph(x, *args)
+            if trace is None:
+                trace = self._auto_signatures[signature] = [key, 0]
+            if key is not None and key == trace[0]:
+                trace[1] += 1
+                if trace[1] >= self._auto_hybridize:
+                    self._auto_graphs.setdefault(key, state)
+            else:
+                trace[0] = None
+        if trace[0] is None or trace[1] < self._auto_hybridize:
+            return super().__call__(x, *args)
+
+        with self._cached_op_state(self._auto_graphs[trace[0]]), real_args[0].device:
+            return self._call_cached_op(x, *args)
+
     def _build_cache(self, *args, update_graph=True):
         data, out = self._get_graph(*args)
+        # input shapes of the compiled model, see export
+        self._cached_input_desc = [(ele.shape, ele.dtype) for ele in _flatten(args, "input")[0]
+                                   if isinstance(ele, NDArray)]
         data_names = {data.name: i for i, data in enumerate(data)}
         params = {p.var().name: p for p in self.collect_params().values()}
         param_serialization_names = {p.var().name: n for n, p in self.collect_params().items()}
@@ -1171,9 +1256,14 @@ class HybridBlock(Block):
             device = device_set.pop() if len(device_set) > 0 else None
             # get list of params in the order of out.list_arguments
             input_shapes = dict()
+            # the ConstantFolding pass folds everything computed from the given arrays, so it
+            # only gets the shapes of the data
+            data_as_shapes = self._backend == 'ConstantFolding'
             for name in out.list_arguments():
                 if name in data_names.keys() and data_names[name] < len(args):
-                    if isinstance(args[data_names[name]], NDArray):
+                    if isinstance(args[data_names[name]], NDArray) and data_as_shapes:
+                        input_shapes[name] = args[data_names[name]].shape
+                    elif isinstance(args[data_names[name]], NDArray):
                         arg_dict[name] = args[data_names[name]]
                     elif (isinstance(args[data_names[name]], symbol.Symbol) and
                           '__shape__' in args[data_names[name]].list_attr()):
@@ -1184,7 +1274,9 @@ class HybridBlock(Block):
 
             for name in out.list_auxiliary_states():
                 if name in data_names.keys() and data_names[name] < len(args):
-                    if isinstance(args[data_names[name]], NDArray):
+                    if isinstance(args[data_names[name]], NDArray) and data_as_shapes:
+                        input_shapes[name] = args[data_names[name]].shape
+                    elif isinstance(args[data_names[name]], NDArray):
                         aux_dict[name] = args[data_names[name]]
                     elif (isinstance(args[data_names[name]], symbol.Symbol) and
                           '__shape__' in args[data_names[name]].list_attr()):
@@ -1312,6 +1404,7 @@ class HybridBlock(Block):
                      inline_limit=2,
                      forward_bulk_size=None,
                      backward_bulk_size=None,
+                     prepack=False,
                      **kwargs):
         """Partitions the current HybridBlock and optimizes it for a given backend
         without executing a forward pass. Modifies the HybridBlock in-place.
@@ -1358,9 +1451,21 @@ class HybridBlock(Block):
             Segment size of bulk execution during forward pass.
         backward_bulk_size : optional int, default None
             Segment size of bulk execution during backward pass.
+        prepack : bool, default False
+            Runs the optimized graph once on the given inputs, so that the operators prepare
+            their weights before the first inference instead of during it. The oneDNN
+            convolution and fully connected subgraphs fold, quantize and reorder their weights
+            to the blocked layouts then. The prepared weights are kept by the operators of
+            this block only, `export` saves the weights as they were given. Requires
+            static_alloc, as the operators are created again at every call otherwise.
         **kwargs: The backend options, optional
             Passed on to `PrePartition` and `PostPartition` functions of `SubgraphProperty`
         """
+        if prepack:
+            rebuild = clear or not self._active
+            if not (static_alloc if rebuild else dict(self._flags).get('static_alloc', False)):
+                raise ValueError('prepack=True requires static_alloc=True, the weights prepared '
+                                 'by the operators are dropped with them at every call otherwise')
         self._backend = backend
         if len(kwargs) > 0:
             self._backend_opts = kwargs
@@ -1393,10 +1498,18 @@ class HybridBlock(Block):
         self._backend = None
         self._backend_opts = {}
 
+        if prepack:
+            with autograd.pause(train_mode=False):
+                out, _ = _flatten(self._call_cached_op(x, *args), "output")
+            for o in out:
+                o.wait_to_read()
+
     def _clear_cached_op(self):
         self._cached_graph = ()
         self._cached_op = None
         self._first_forward = True
+        self._auto_signatures = {}
+        self._auto_graphs = {}
 
     def register_child(self, block, name=None):
         if not isinstance(block, HybridBlock):
@@ -1417,7 +1530,9 @@ class HybridBlock(Block):
                   static_shape=False,
                   inline_limit=2,
                   forward_bulk_size=None,
-                  backward_bulk_size=None):
+                  backward_bulk_size=None,
+                  backward_recompute=False,
+                  recompute_segment_size=None):
         """Activates or deactivates :py:class:`HybridBlock` s recursively. Has no effect on
         non-hybrid children.
 
@@ -1439,6 +1554,12 @@ class HybridBlock(Block):
             Segment size of bulk execution during forward pass.
         backward_bulk_size : optional int, default None
             Segment size of bulk execution during backward pass.
+        backward_recompute : bool, default False
+            Recompute during backward the activations between checkpoints instead of
+            keeping them from the forward pass. Saves memory for more computation.
+        recompute_segment_size : optional int, default None
+            Number of operators between two checkpoints when backward_recompute is
+            True. Defaults to the square root of the number of operators.
         """
 
         self._active = active
@@ -1449,6 +1570,10 @@ class HybridBlock(Block):
             self._flags.append(("forward_bulk_size", forward_bulk_size))
         if backward_bulk_size is not None:
             self._flags.append(("backward_bulk_size", backward_bulk_size))
+        if backward_recompute:
+            self._flags.append(("backward_recompute", backward_recompute))
+        if recompute_segment_size is not None:
+            self._flags.append(("recompute_segment_size", recompute_segment_size))
         self._clear_cached_op()
         if active and self._forward_hooks or self._forward_pre_hooks:
             warnings.warn('"{block}" is being hybridized while still having forward hook/pre-hook. '
@@ -1459,7 +1584,9 @@ class HybridBlock(Block):
                                            static_shape=static_shape,
                                            inline_limit=inline_limit,
                                            forward_bulk_size=forward_bulk_size,
-                                           backward_bulk_size=backward_bulk_size)
+                                           backward_bulk_size=backward_bulk_size,
+                                           backward_recompute=backward_recompute,
+                                           recompute_segment_size=recompute_segment_size)
 
     def cast(self, dtype):
         if self._active:
@@ -1503,7 +1630,7 @@ class HybridBlock(Block):
         """Infers data type of Parameters from inputs."""
         self._infer_attrs('infer_type', 'dtype', *args)
 
-    def export(self, path, epoch=0, remove_amp_cast=True):
+    def export(self, path, epoch=0, remove_amp_cast=True, compiled=False):
         """Export HybridBlock to json format that can be loaded by
         `gluon.SymbolBlock.imports` or the C++ interface.
 
@@ -1521,6 +1648,13 @@ class HybridBlock(Block):
             Epoch number of saved model.
         remove_amp_cast : bool, optional
             Whether to remove the amp_cast and amp_multicast operators, before saving the model.
+        compiled : bool, default False
+            Also save `path-compiled.json`, which `gluon.SymbolBlock.imports_compiled` loads
+            to deploy the model without compiling it again: the graph as partitioned by
+            `optimize_for`, the hybridize flags, the input shapes the block was last built
+            for and, in `path-cudnn_plans`, the cuDNN convolution plans selected by the
+            process. Run the block on representative inputs first so that the plans are
+            selected.
 
         Returns
         -------
@@ -1572,6 +1706,8 @@ class HybridBlock(Block):
                 _mx_npx.savez(params_filename, **arg_dict)
             else:
                 ndarray.save(params_filename, arg_dict)
+            if compiled:
+                self._export_compiled(path, sym_filename, params_filename if arg_dict else None)
             return (sym_filename, params_filename if arg_dict else None)
 
         if remove_amp_cast:
@@ -1580,6 +1716,29 @@ class HybridBlock(Block):
             sym = type(sym)(handle)
         return sym, arg_dict
 
+    def _export_compiled(self, path, sym_filename, params_filename):
+        """Saves the manifest of a compiled model next to its symbol and parameters."""
+        plans_filename = f'{path}-cudnn_plans'
+        num_plans = ctypes.c_uint32()
+        check_call(_LIB.MXCudnnPlanCacheSave(c_str(plans_filename), ctypes.byref(num_plans)))
+        if num_plans.value == 0 and os.path.exists(plans_filename):
+            os.remove(plans_filename)
+        input_names = [var.name for var in self._cached_graph[0]]
+        input_desc = getattr(self, '_cached_input_desc', [])
+        manifest = {
+            'format': 'mxnet-compiled-model',
+            'version': 1,
+            'symbol': os.path.basename(sym_filename),
+            'params': os.path.basename(params_filename) if params_filename else None,
+            'cudnn_plans': os.path.basename(plans_filename) if num_plans.value else None,
+            'np_array': is_np_array(),
+            'flags': {k: v for k, v in self._flags if k in _HYBRIDIZE_FLAGS},
+            'inputs': [{'name': name, 'shape': list(shape), 'dtype': np.dtype(dtype).name}
+                       for name, (shape, dtype) in zip(input_names, input_desc)],
+        }
+        with open(f'{path}-compiled.json', 'w') as f:
+            json.dump(manifest, f, indent=2)
+
     def register_op_hook(self, callback, monitor_all=False):
         """Install op hook for block recursively.
 
@@ -1634,6 +1793,9 @@ class HybridBlock(Block):
             self._called_infer_shape_already = True
 
         if not self._active:
+            if self._auto_hybridize > 0 and len(device_set) == 1 and \
+                    not dc.is_deferred_compute():
+                return self._call_auto_hybridized(x, *args)
             # Normal imperative computation of forward()
             return super().__call__(x, *args)
 
@@ -1764,6 +1926,60 @@ class SymbolBlock(HybridBlock):
             ret.load_parameters(param_file, device, allow_missing, ignore_extra, True, 'saved')
         return ret
 
+    @staticmethod
+    @wrap_ctx_to_device_func
+    def imports_compiled(path, device=None, warmup=True):
+        """Import a model saved by `gluon.HybridBlock.export` with `compiled=True`.
+
+        The graph is used as it was partitioned and the block is hybridized with the flags it
+        was exported with. The saved cuDNN plans are loaded, so that the convolutions of the
+        same shapes on the same GPU architecture and cuDNN version skip autotuning.
+
+        Parameters
+        ----------
+        path : str
+            Path prefix given to `export`.
+        device : Device or list of Device, default None
+            The device to load the model on.
+        warmup : bool, default True
+            Run the model once on zeros of the exported input shapes, so that the memory is
+            planned, the operators create their primitives and prepare their weights, and the
+            cuDNN plans are built at load time rather than during the first request.
+
+        Returns
+        -------
+        gluon.SymbolBlock
+            The hybridized `gluon.SymbolBlock`.
+        """
+        with open(f'{path}-compiled.json') as f:
+            manifest = json.load(f)
+        if manifest.get('format') != 'mxnet-compiled-model' or manifest.get('version', 0) > 1:
+            raise ValueError(f'{path}-compiled.json is not a supported compiled model')
+        directory = os.path.dirname(path)
+        if manifest['cudnn_plans']:
+            num_plans = ctypes.c_uint32()
+            check_call(_LIB.MXCudnnPlanCacheLoad(
+                c_str(os.path.join(directory, manifest['cudnn_plans'])), ctypes.byref(num_plans)))
+        with np_array(manifest['np_array']):
+            input_names = [i['name'] for i in manifest['inputs']] or ['data']
+            params = manifest['params'] and os.path.join(directory, manifest['params'])
+            ret = SymbolBlock.imports(os.path.join(directory, manifest['symbol']), input_names,
+                                      params, device)
+            ret.hybridize(**manifest['flags'])
+            if warmup and manifest['inputs']:
+                dev = device[0] if isinstance(device, (list, tuple)) else device
+                if manifest['np_array']:
+                    args = [_mx_np.zeros(tuple(i['shape']), dtype=i['dtype'], device=dev)
+                            for i in manifest['inputs']]
+                else:
+                    args = [nd.zeros(tuple(i['shape']), ctx=dev, dtype=i['dtype'])
+                            for i in manifest['inputs']]
+                with autograd.pause(train_mode=False):
+                    out, _ = _flatten(ret(*args), "output")
+                for o in out:
+                    o.wait_to_read()
+        return ret
+
     def __repr__(self):
         s = '{name}(\n{modstr}\n)'
         modstr = '\n'.join(['{block} : {numinputs} -> {numoutputs}'.format(block=self._cached_graph[1],
@@ -0,0 +1,314 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# coding: utf-8
+"""Pipeline model parallelism: stages of a symbol on different devices, trained on
+micro-batches with a one-forward-one-backward schedule."""
+
+import json
+
+from ..block import Block, SymbolBlock
+from ... import autograd
+from ... import symbol
+from ... import ndarray
+from ... import numpy as _mx_np
+
+__all__ = ['Pipeline', 'split_stages']
+
+
+def split_stages(sym, input_names, groups):
+    """Splits a symbol into pipeline stages by the `ctx_group` attribute of its operators.
+
+    Operators without `ctx_group` belong to the latest stage of their inputs, the first
+    stage without inputs from operators. Every operator must belong to the same or a later
+    stage as the operators it reads from, so that the stages form a pipeline.
+
+    Parameters
+    ----------
+    sym : Symbol
+        The model. Its outputs must all be computed by the last stage.
+    input_names : list of str
+        Names of the variables of `sym` which are data inputs, the others are parameters.
+    groups : list of str
+        The `ctx_group` of each stage, in pipeline order.
+
+    Returns
+    -------
+    list of (Symbol, list of str, list of tuple)
+        For every stage, its symbol, the names of its inputs and the outputs of earlier
+        stages each input reads, as `(stage, output index)`, or `(None, input name)` for
+        data inputs.
+    """
+    graph = json.loads(sym.tojson())
+    nodes = graph['nodes']
+    stage_of = {}
+    for nid, node in enumerate(nodes):
+        if node['op'] == 'null':
+            continue
+        group = node.get('attrs', {}).get('__ctx_group__')
+        earliest = max([stage_of[e[0]] for e in node['inputs'] if e[0] in stage_of] + [0])
+        if group is None:
+            stage_of[nid] = earliest
+            continue
+        if group not in groups:
+            raise ValueError(f"Operator {node['name']} has ctx_group {group}, "
+                             f"which is not one of the stages {groups}")
+        stage_of[nid] = groups.index(group)
+        if stage_of[nid] < earliest:
+            raise ValueError(f"Operator {node['name']} of stage {group} reads the output of a "
+                             "later stage: the ctx_group attributes do not form a pipeline")
+    num_stages = len(groups)
+    for head in graph['heads']:
+        if stage_of.get(head[0]) != num_stages - 1:
+            raise ValueError("The outputs of the model must be computed by the last stage")
+
+    param_stage = {}
+    # outputs of every stage read by later stages, as (node id, index)
+    stage_outputs = [[] for _ in range(num_stages)]
+    for nid in sorted(stage_of):
+        for e in nodes[nid]['inputs']:
+            src = e[0]
+            if src not in stage_of:
+                name = nodes[src]['name']
+                if name not in input_names and param_stage.setdefault(name, stage_of[nid]) \
+                        != stage_of[nid]:
+                    raise ValueError(f"Parameter {name} is used by several stages")
+            elif stage_of[src] != stage_of[nid] and (src, e[1]) not in stage_outputs[stage_of[src]]:
+                stage_outputs[stage_of[src]].append((src, e[1]))
+
+    stages = []
+    for k in range(num_stages):
+        new_nodes, remap, names, sources = [], {}, [], []
+
+        def entry(e, k=k, new_nodes=new_nodes, remap=remap, names=names, sources=sources):
+            src = e[0]
+            if src in stage_of and stage_of[src] != k:
+                # an output of an earlier stage is a new input of this stage
+                key = (src, e[1])
+                if key not in remap:
+                    owner = stage_of[src]
+                    name = f"{nodes[src]['name']}_stage{owner}_output{e[1]}"
+                    remap[key] = len(new_nodes)
+                    new_nodes.append({'op': 'null', 'name': name, 'inputs': []})
+                    names.append(name)
+                    sources.append((owner, stage_outputs[owner].index(key)))
+                return [remap[key], 0, 0]
+            if src not in remap:
+                # a variable, the operators of the stage are added in topological order
+                if nodes[src]['name'] in input_names:
+                    names.append(nodes[src]['name'])
+                    sources.append((None, nodes[src]['name']))
+                remap[src] = len(new_nodes)
+                new_nodes.append(nodes[src])
+            return [remap[src], e[1], e[2] if len(e) > 2 else 0]
+
+        for nid, node in enumerate(nodes):
+            if stage_of.get(nid) == k:
+                inputs = [entry(e) for e in node['inputs']]
+                remap[nid] = len(new_nodes)
+                new_nodes.append(dict(node, inputs=inputs))
+        heads = graph['heads'] if k == num_stages - 1 else \
+            [[nid, idx, 0] for nid, idx in stage_outputs[k]]
+        stage_graph = dict(graph, nodes=new_nodes, heads=[entry(h) for h in heads],
+                           arg_nodes=[i for i, n in enumerate(new_nodes) if n['op'] == 'null'])
+        stage_graph.pop('node_row_ptr', None)
+        stages.append((symbol.load_json(json.dumps(stage_graph)), names, sources))
+    return stages
+
+
+def _concat(arrays):
+    if isinstance(arrays[0], _mx_np.ndarray):
+        return _mx_np.concatenate(arrays, axis=0)
+    return ndarray.concat(*arrays, dim=0)
+
+
+class Pipeline(Block):
+    """Runs a model split in stages on several devices as a pipeline.
+
+    The stages are set by the `ctx_group` attribute of the operators, see `split_stages`,
+    and each runs as a CachedOp on its device. A batch is split into micro-batches.
+    The outputs of a stage are copied to the device of the next stage on the copy
+    streams, while the stages compute other micro-batches.
+
+    `forward_backward` trains with the one-forward-one-backward (1F1B) schedule: after
+    a warmup of forward passes, every stage alternates between the forward pass of a
+    micro-batch and the backward pass of the oldest one. Then at most as many
+    micro-batches as there are stages after a stage keep their activations alive on it.
+
+    The parameters of each stage live on its device only, so train them with one
+    `Trainer` per stage, e.g. on `pipeline.stages[i].collect_params()`.
+
+    Parameters
+    ----------
+    sym : Symbol
+        The model. The outputs of the last stage are those of the model, and its first
+        output is the loss when training.
+    input_names : list of str
+        Names of the data inputs of `sym`.
+    group2ctx : dict of str to Device
+        Device of the stage of each `ctx_group`, in pipeline order.
+    num_microbatches : int
+        Number of micro-batches a batch is split into along its first axis.
+    params : dict of str to Parameter, optional
+        Parameters to use for the variables of `sym` of the same name.
+    """
+    def __init__(self, sym, input_names, group2ctx, num_microbatches, params=None):
+        super(Pipeline, self).__init__()
+        if num_microbatches < 1:
+            raise ValueError("num_microbatches must be positive")
+        params = params or {}
+        self._devices = list(group2ctx.values())
+        self._input_names = list(input_names)
+        self._num_microbatches = num_microbatches
+        self._stages = []
+        self._stage_inputs = []
+        for i, (stage_sym, names, sources) in enumerate(
+                split_stages(sym, self._input_names, list(group2ctx.keys()))):
+            used = set(stage_sym.list_inputs())
+            stage = SymbolBlock(stage_sym, [symbol.var(name) for name in names],
+                                {k: v for k, v in params.items() if k in used})
+            # the gradients of the micro-batches are summed
+            for param in stage.collect_params().values():
+                if param.grad_req != 'null':
+                    param.grad_req = 'add'
+            self.register_child(stage, str(i))
+            self._stages.append(stage)
+            self._stage_inputs.append(sources)
+
+    @property
+    def stages(self):
+        """The blocks of the stages, in pipeline order."""
+        return list(self._stages)
+
+    def initialize(self, init=None, device=None, verbose=False, force_reinit=False):
+        """Initializes the parameters of every stage on its device."""
+        # pylint: disable=arguments-differ, unused-argument
+        for stage, dev in zip(self._stages, self._devices):
+            kwargs = {} if init is None else {'init': init}
+            stage.initialize(device=dev, verbose=verbose, force_reinit=force_reinit, **kwargs)
+
+    def hybridize(self, active=True, **kwargs):
+        for stage in self._stages:
+            stage.hybridize(active, **kwargs)
+
+    def _split(self, inputs):
+        batch_size = inputs[0].shape[0]
+        if batch_size % self._num_microbatches:
+            raise ValueError(f"The batch size {batch_size} is not a multiple of the "
+                             f"{self._num_microbatches} micro-batches")
+        step = batch_size // self._num_microbatches
+        return [{name: x[m * step:(m + 1) * step] for name, x in zip(self._input_names, inputs)}
+                for m in range(self._num_microbatches)]
+
+    def _stage_forward(self, k, data, outputs, record):
+        """Runs stage k on a micro-batch, returns its inputs from earlier stages."""
+        dev = self._devices[k]
+        args, grad_inputs = [], []
+        for owner, key in self._stage_inputs[k]:
+            if owner is None:
+                x = data[key]
+                args.append(x if x.device == dev else x.copyto(dev))
+                continue
+            # queued on the copy streams, overlapping the compute of the stages
+            arg = outputs[owner][key].copyto(dev)
+            if record:
+                arg.attach_grad()
+                grad_inputs.append((owner, key, arg))
+            args.append(arg)
+        if record:
+            with autograd.record():
+                out = self._stages[k](*args)
+        else:
+            out = self._stages[k](*args)
+        outputs[k] = list(out) if isinstance(out, (list, tuple)) else [out]
+        return grad_inputs
+
+    def forward(self, *inputs):
+        """Runs the model on a batch without recording, and concatenates the outputs of the
+        micro-batches."""
+        # pylint: disable=arguments-differ
+        results = []
+        for data in self._split(inputs):
+            outputs = [None] * len(self._stages)
+            for k in range(len(self._stages)):
+                self._stage_forward(k, data, outputs, False)
+            results.append(outputs[-1])
+        out = [_concat([r[i] for r in results]) for i in range(len(results[0]))]
+        return out[0] if len(out) == 1 else out
+
+    def forward_backward(self, *inputs):
+        """Runs the forward and backward passes of a batch with the 1F1B schedule.
+
+        The gradients of the parameters are cleared, then summed over the micro-batches.
+
+        Returns
+        -------
+        NDArray
+            The loss, the first output of the model, concatenated over the micro-batches.
+        """
+        for stage in self._stages:
+            stage.zero_grad()
+        micro = self._split(inputs)
+        num_stages, num_micro = len(self._stages), len(micro)
+        outputs = [[None] * num_stages for _ in range(num_micro)]
+        grad_inputs = [[None] * num_stages for _ in range(num_micro)]
+        # gradients of the outputs of every stage, by micro-batch
+        head_grads = [[{} for _ in range(num_stages)] for _ in range(num_micro)]
+        schedule = []
+        for k in range(num_stages):
+            warmup = min(num_stages - 1 - k, num_micro)
+            actions = [('F', m) for m in range(warmup)]
+            for m in range(num_micro - warmup):
+                actions += [('F', warmup + m), ('B', m)]
+            actions += [('B', m) for m in range(num_micro - warmup, num_micro)]
+            schedule.append(actions)
+        done = set()
+        # the actions are queued to the engine in the order a synchronous 1F1B pipeline would
+        # run them, the engine overlaps them across devices
+        while any(schedule):
+            for k in range(num_stages):
+                if not schedule[k]:
+                    continue
+                kind, m = schedule[k][0]
+                if kind == 'F':
+                    if k > 0 and ('F', k - 1, m) not in done:
+                        continue
+                    grad_inputs[m][k] = self._stage_forward(k, micro[m], outputs[m], True)
+                else:
+                    if k < num_stages - 1 and ('B', k + 1, m) not in done:
+                        continue
+                    self._stage_backward(k, outputs[m][k], head_grads[m][k],
+                                         grad_inputs[m][k], head_grads[m])
+                    if k < num_stages - 1:
+                        outputs[m][k] = None
+                done.add((kind, k, m))
+                schedule[k].pop(0)
+        return _concat([outputs[m][-1][0] for m in range(num_micro)])
+
+    def _stage_backward(self, k, outs, grads, grad_inputs, all_grads):
+        """Runs the backward pass of stage k on a micro-batch, and adds the gradients of its
+        inputs from earlier stages to theirs."""
+        if k == len(self._stages) - 1:
+            # the loss
+            autograd.backward([outs[0]])
+        elif grads:
+            keys = sorted(grads)
+            autograd.backward([outs[i] for i in keys], [grads[i] for i in keys])
+        for owner, key, arg in grad_inputs:
+            grad = arg.grad.copyto(self._devices[owner])
+            prev = all_grads[owner]
+            prev[key] = prev[key] + grad if key in prev else grad
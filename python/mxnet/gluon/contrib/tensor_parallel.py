@@ -0,0 +1,277 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# coding: utf-8
+"""Tensor model parallel layers: the weights of a layer are sharded across devices, which
+compute their part of the layer concurrently."""
+
+from ..block import Block
+from ..parameter import Parameter
+from ... import initializer
+from ... import numpy as np
+from ... import numpy_extension as npx
+from ...util import use_np
+
+__all__ = ['ColumnParallelDense', 'RowParallelDense', 'ParallelEmbedding']
+
+
+def _shard_ranges(size, num_shards):
+    """Splits range(size) in num_shards contiguous ranges, the first ones one larger.
+
+    Every shard must get at least one row, as the operators reject zero-size weights.
+    """
+    if size < num_shards:
+        raise ValueError(f"Cannot shard {size} rows across {num_shards} devices")
+    ranges, begin = [], 0
+    for i in range(num_shards):
+        end = begin + size // num_shards + (1 if i < size % num_shards else 0)
+        ranges.append((begin, end))
+        begin = end
+    return ranges
+
+
+def _reduce(parts, device):
+    """Sums the partial results of the devices on `device`.
+
+    The copies are queued on the copy streams as soon as each device has its part, while
+    the other devices still compute theirs. Backward broadcasts the gradient of the sum.
+    """
+    out = None
+    for part in parts:
+        part = part.to_device(device)
+        out = part if out is None else out + part
+    return out
+
+
+class _ShardedBlock(Block):
+    """Holds one shard of each parameter per device."""
+    def __init__(self, devices, **kwargs):
+        super(_ShardedBlock, self).__init__(**kwargs)
+        if not devices:
+            raise ValueError("At least one device is required")
+        self._devices = list(devices)
+        self._shard_devices = {}
+
+    def _add_shards(self, name, shapes, **kwargs):
+        shards = []
+        for i, shape in enumerate(shapes):
+            param = Parameter(f'{name}{i}', shape=shape, **kwargs)
+            setattr(self, f'{name}{i}', param)
+            self._shard_devices[f'{name}{i}'] = self._devices[i]
+            shards.append(param)
+        return shards
+
+    def initialize(self, init=initializer.Uniform(), device=None, verbose=False,
+                   force_reinit=False):
+        """Initializes every shard on its device. `device` is ignored."""
+        # pylint: disable=unused-argument
+        if verbose:
+            init.set_verbosity(verbose=verbose)
+        for name, param in self._reg_params.items():
+            param.initialize(None, self._shard_devices[name], init, force_reinit=force_reinit)
+
+
+@use_np
+class ColumnParallelDense(_ShardedBlock):
+    r"""Densely-connected layer whose output units are sharded across devices.
+
+    Every device computes `dot(data, weight_i.T) + bias_i` for its slice of the units.
+    The slices are gathered on the device of `data`, or returned as they are with
+    `gather_output=False`, to feed a `RowParallelDense` without communication.
+
+    Parameters
+    ----------
+    units : int
+        Dimensionality of the output space.
+    in_units : int
+        Size of the input data.
+    devices : list of Device
+        Devices of the shards.
+    use_bias : bool, default True
+        Whether the layer uses a bias vector.
+    flatten : bool, default True
+        Whether the input tensor should be flattened, as for `Dense`.
+    gather_output : bool, default True
+        Whether to concatenate the slices of the output on the device of the input.
+    dtype : str or np.dtype, default 'float32'
+        Data type of the weights.
+    weight_initializer : str or `Initializer`
+        Initializer for the weights.
+    bias_initializer : str or `Initializer`
+        Initializer for the biases.
+
+    Inputs:
+        - **data**: input tensor, as for `Dense`.
+
+    Outputs:
+        - **out**: tensor of shape `(batch_size, units)`, or the list of its slices on
+          every device, of `units / len(devices)` units each.
+    """
+    def __init__(self, units, in_units, devices, use_bias=True, flatten=True,
+                 gather_output=True, dtype='float32', weight_initializer=None,
+                 bias_initializer='zeros', **kwargs):
+        super(ColumnParallelDense, self).__init__(devices, **kwargs)
+        self._flatten = flatten
+        self._gather_output = gather_output
+        self._units = [end - begin for begin, end in _shard_ranges(units, len(self._devices))]
+        self.weight = self._add_shards('weight', [(u, in_units) for u in self._units],
+                                       init=weight_initializer, dtype=dtype)
+        self.bias = self._add_shards('bias', [(u,) for u in self._units],
+                                     init=bias_initializer, dtype=dtype) if use_bias else None
+
+    def forward(self, x):
+        parts = []
+        for i, dev in enumerate(self._devices):
+            bias = self.bias[i].data(dev) if self.bias is not None else None
+            parts.append(npx.fully_connected(x.to_device(dev), self.weight[i].data(dev), bias,
+                                             no_bias=bias is None, num_hidden=self._units[i],
+                                             flatten=self._flatten))
+        if not self._gather_output:
+            return parts
+        return np.concatenate([part.to_device(x.device) for part in parts], axis=-1)
+
+    def __repr__(self):
+        return '{name}({in_units} -> {units}, {num} devices)'.format(
+            name=self.__class__.__name__, in_units=self.weight[0].shape[1],
+            units=sum(self._units), num=len(self._devices))
+
+
+@use_np
+class RowParallelDense(_ShardedBlock):
+    r"""Densely-connected layer whose input units are sharded across devices.
+
+    Every device multiplies its slice of the input features by its slice of the weight,
+    and the partial results are summed on the output device before the bias is added.
+
+    Parameters
+    ----------
+    units : int
+        Dimensionality of the output space.
+    in_units : int
+        Size of the input data.
+    devices : list of Device
+        Devices of the shards.
+    use_bias : bool, default True
+        Whether the layer uses a bias vector, which lives on the first device.
+    flatten : bool, default True
+        Whether the input tensor should be flattened, as for `Dense`.
+    dtype : str or np.dtype, default 'float32'
+        Data type of the weights.
+    weight_initializer : str or `Initializer`
+        Initializer for the weights.
+    bias_initializer : str or `Initializer`
+        Initializer for the bias.
+
+    Inputs:
+        - **data**: input tensor, as for `Dense`, or the list of its slices along the last
+          axis on every device, e.g. the output of a `ColumnParallelDense` with
+          `gather_output=False`.
+
+    Outputs:
+        - **out**: tensor of shape `(batch_size, units)`, on the device of the input, or
+          the first device when the input is sharded.
+    """
+    def __init__(self, units, in_units, devices, use_bias=True, flatten=True,
+                 dtype='float32', weight_initializer=None, bias_initializer='zeros', **kwargs):
+        super(RowParallelDense, self).__init__(devices, **kwargs)
+        self._units = units
+        self._flatten = flatten
+        self._in_ranges = _shard_ranges(in_units, len(self._devices))
+        self.weight = self._add_shards('weight',
+                                       [(units, end - begin) for begin, end in self._in_ranges],
+                                       init=weight_initializer, dtype=dtype)
+        self.bias = self._add_shards('bias', [(units,)], init=bias_initializer,
+                                     dtype=dtype)[0] if use_bias else None
+
+    def forward(self, x):
+        if isinstance(x, (list, tuple)):
+            if len(x) != len(self._devices):
+                raise ValueError(f"Expected {len(self._devices)} input slices, got {len(x)}")
+            device = self._devices[0]
+        else:
+            device = x.device
+            if self._flatten:
+                x = x.reshape(x.shape[0], -1)
+            x = [x[..., begin:end] for begin, end in self._in_ranges]
+        parts = [npx.fully_connected(x[i].to_device(dev), self.weight[i].data(dev), None,
+                                     no_bias=True, num_hidden=self._units,
+                                     flatten=self._flatten)
+                 for i, dev in enumerate(self._devices)]
+        out = _reduce(parts, device)
+        if self.bias is not None:
+            out = out + self.bias.data(self._devices[0]).to_device(device)
+        return out
+
+    def __repr__(self):
+        return '{name}({in_units} -> {units}, {num} devices)'.format(
+            name=self.__class__.__name__, in_units=self._in_ranges[-1][1],
+            units=self._units, num=len(self._devices))
+
+
+@use_np
+class ParallelEmbedding(_ShardedBlock):
+    r"""Embedding whose vocabulary is sharded across devices.
+
+    Every device looks up the indices of its rows and zeroes the others, and the lookups
+    are summed on the device of the input.
+
+    Parameters
+    ----------
+    input_dim : int
+        Size of the vocabulary, i.e. maximum integer index + 1. It must be at least the
+        number of devices.
+    output_dim : int
+        Dimension of the dense embedding.
+    devices : list of Device
+        Devices of the shards.
+    dtype : str or np.dtype, default 'float32'
+        Data type of output embeddings.
+    weight_initializer : Initializer
+        Initializer for the embeddings matrix.
+
+    Inputs:
+        - **data**: (N-1)-D tensor with shape: `(x1, x2, ..., xN-1)`.
+
+    Output:
+        - **out**: N-D tensor with shape: `(x1, x2, ..., xN-1, output_dim)`.
+    """
+    def __init__(self, input_dim, output_dim, devices, dtype='float32',
+                 weight_initializer=None, **kwargs):
+        super(ParallelEmbedding, self).__init__(devices, **kwargs)
+        self._output_dim = output_dim
+        self._dtype = dtype
+        self._ranges = _shard_ranges(input_dim, len(self._devices))
+        self.weight = self._add_shards('weight',
+                                       [(end - begin, output_dim) for begin, end in self._ranges],
+                                       init=weight_initializer, dtype=dtype)
+
+    def forward(self, x):
+        parts = []
+        for i, dev in enumerate(self._devices):
+            begin, end = self._ranges[i]
+            local = x.to_device(dev)
+            mask = np.logical_and(local >= begin, local < end).astype(self._dtype)
+            rows = npx.embedding(np.clip(local - begin, 0, end - begin - 1),
+                                 self.weight[i].data(dev), input_dim=end - begin,
+                                 output_dim=self._output_dim, dtype=self._dtype)
+            parts.append(rows * np.expand_dims(mask, -1))
+        return _reduce(parts, x.device)
+
+    def __repr__(self):
+        return '{name}({input_dim} -> {output_dim}, {num} devices)'.format(
+            name=self.__class__.__name__, input_dim=self._ranges[-1][1],
+            output_dim=self._output_dim, num=len(self._devices))
@@ -254,7 +254,9 @@ class Pad(object):
 
     def __mx_handle__(self):
         from ._internal import PadBatchify
-        return PadBatchify(pad_val=self._pad_val, dtype=self._dtype if self._dtype is not None else -1)
+        dtype = nd.dtype_np_to_mx(self._dtype) if self._dtype is not None else -1
+        return PadBatchify(pad_val=self._pad_val, dtype=dtype,
+                           round_to=self._round_to if self._round_to is not None else -1)
 
 def _append_arrs(arrs, use_shared_mem=False, expand=False, batch_axis=0):
     """Internal impl for returning appened arrays as list."""
@@ -21,12 +21,15 @@
 __all__ = ['Trainer']
 
 import warnings
+import weakref
 from collections import OrderedDict
 
+from .. import autograd
 from .. import optimizer as opt
 from ..model import _create_kvstore, _create_sparse_kvstore
 from .parameter import Parameter
 from ..kvstore import KVStore
+from ..device import cpu_pinned
 
 
 class Trainer(object):
@@ -69,6 +72,32 @@ class Trainer(object):
         If None and optimizer.aggregate_num > 1, `update_on_kvstore` is set to False.
         If the `update_on_kvstore` argument is provided,
         environment variable `MXNET_UPDATE_ON_KVSTORE` will be ignored.
+    shard_optimizer_states : bool, default False
+        Whether to shard the optimizer states, including the fp32 master weights of
+        multi-precision updates, across the devices instead of replicating them. Each
+        parameter is owned by one device: its gradients are reduced to the owner only, the
+        owner updates it, and the updated weight is copied to the other devices. This divides
+        the memory of the optimizer states by the number of devices. Parameters are sharded
+        whole, balanced by size. Requires `update_on_kvstore=False` and dense parameters and
+        gradients. After `allreduce_grads`, the reduced gradient of a parameter is only on its
+        owner device.
+    offload_optimizer_states : bool, default False
+        Whether to keep the optimizer states, including the fp32 master weights of
+        multi-precision updates, in pinned host memory and run the updates on the CPU. At each
+        step the gradients and weights are copied to host buffers, updated there by the
+        optimizer, which aggregates them in its multi-tensor kernels when `aggregate_num > 1`,
+        and the weights are copied back. The copies are queued as soon as `step` is called, so
+        those of the gradients computed first overlap with the rest of the backward pass.
+        The weights are copied at each step as they may be set between steps, which
+        doubles the traffic of the gradients alone for single-precision weights.
+        Requires `update_on_kvstore=False` and dense parameters and gradients. Combine with
+        `shard_optimizer_states` to keep a single copy of the states on the host.
+    overlap_allreduce : bool, default False
+        Whether to reduce the gradients of a parameter as soon as `backward` has scheduled
+        their computation on all the devices, instead of in `step`, so that the reductions of
+        the gradients computed first overlap with the rest of the backward pass. Applies to
+        the dense gradients with `grad_req='write'` when the parameters are not updated on the
+        kvstore. Takes effect from the second step, once the kvstore is created.
 
     Properties
     ----------
@@ -77,7 +106,8 @@ class Trainer(object):
         optimizer, its learning rate can be accessed as optimizer.learning_rate.
     """
     def __init__(self, params, optimizer, optimizer_params=None, kvstore='device',
-                 compression_params=None, update_on_kvstore=None):
+                 compression_params=None, update_on_kvstore=None, shard_optimizer_states=False,
+                 offload_optimizer_states=False, overlap_allreduce=False):
         param_list = []
         if isinstance(params, (dict, OrderedDict)):
             for key in sorted(list(params.keys())):
@@ -118,6 +148,27 @@ class Trainer(object):
                                  "when optimizer.aggregate_num > 1.")
         if update_on_kvstore is None and self._optimizer.aggregate_num > 1:
             update_on_kvstore = False
+        if shard_optimizer_states or offload_optimizer_states:
+            if update_on_kvstore:
+                option = 'shard_optimizer_states' if shard_optimizer_states \
+                    else 'offload_optimizer_states'
+                raise ValueError(f"Cannot set update_on_kvstore=True when {option}=True.")
+            update_on_kvstore = False
+        self._shard_optimizer_states = shard_optimizer_states
+        # index of the device owning each parameter when the optimizer states are sharded
+        self._shard_owners = None
+        self._offload_optimizer_states = offload_optimizer_states
+        # host copies of the gradient and weight of each parameter, per updater, when offloading
+        self._offload_buffers = {}
+        self._overlap_allreduce = overlap_allreduce
+        # gradient arrays with a reduction hook, and hooks still to run before it, by parameter
+        self._hooked_grads = {}
+        self._pending_hooks = {}
+        # parameters whose gradients were reduced by their hooks since the last reduction
+        self._reduced_by_hooks = set()
+        # the hooks outlive a trainer dropped without resetting its kvstore, remove them with it
+        self._hooks_finalizer = weakref.finalize(self, Trainer._unhook_grads, self._hooked_grads)
+        self._hooks_finalizer.atexit = False
         self._kvstore_params = {'kvstore': kvstore, 'update_on_kvstore': update_on_kvstore}
         self._kv_initialized = False
         self._kvstore = None
@@ -186,10 +237,13 @@ class Trainer(object):
         """Reset kvstore."""
         if self._kvstore and 'dist' in self._kvstore.type:
             raise RuntimeError("Cannot reset distributed KVStore.")
+        self._remove_grad_hooks()
         self._kv_initialized = False
         self._kvstore = None
         self._distributed = None
         self._update_on_kvstore = None
+        self._shard_owners = None
+        self._offload_buffers = {}
         self._params_to_init = [param for param in self._params]
 
     def _init_kvstore(self):
@@ -268,6 +322,21 @@ class Trainer(object):
                                      "when training with {}".format(type(kvstore)))
                 update_on_kvstore = False
 
+        if self._shard_optimizer_states and kvstore:
+            if update_on_kvstore:
+                raise ValueError("Cannot shard the optimizer states when parameters are "
+                                 f"updated on {kvstore.type} kvstore.")
+            if self._contains_sparse_weight or self._contains_sparse_grad:
+                raise ValueError("Cannot shard the optimizer states of sparse parameters "
+                                 "or gradients.")
+        if self._offload_optimizer_states:
+            if kvstore and update_on_kvstore:
+                raise ValueError("Cannot offload the optimizer states when parameters are "
+                                 f"updated on {kvstore.type} kvstore.")
+            if self._contains_sparse_weight or self._contains_sparse_grad:
+                raise ValueError("Cannot offload the optimizer states of sparse parameters "
+                                 "or gradients.")
+
         # set grad compression and optimizers
         if kvstore:
             if self._compression_params:
@@ -394,7 +463,7 @@ class Trainer(object):
         if not self._kvstore:
             return
         for i, param in enumerate(self._params):
-            if param.grad_req != 'null':
+            if param.grad_req != 'null' and i not in self._reduced_by_hooks:
                 idx = self._param2idx[param._uuid]
                 grad_list = param.list_grad()
                 # sparse gradients, call push and pull separately
@@ -413,7 +482,69 @@ class Trainer(object):
                     if self._update_on_kvstore:
                         self._kvstore.pushpull(idx, grad_list, out=param.list_data(), priority=-i)
                     else:
-                        self._kvstore.pushpull(idx, grad_list, priority=-i)
+                        self._reduce_dense_grads(i, grad_list)
+        self._reduced_by_hooks.clear()
+        if self._overlap_allreduce and not self._update_on_kvstore:
+            self._set_grad_hooks()
+
+    def _reduce_dense_grads(self, i, grad_list):
+        """Allreduces the dense gradients of the i-th parameter, when not updated on kvstore."""
+        idx = self._param2idx[self._params[i]._uuid]
+        if self._is_sharded():
+            # reduce the gradients to the owner of the parameter only
+            owner = self._shard_owner(i)
+            self._kvstore.pushpull(idx, grad_list, out=grad_list[owner], priority=-i)
+        else:
+            self._kvstore.pushpull(idx, grad_list, priority=-i)
+
+    def _set_grad_hooks(self):
+        """Sets the hooks reducing the gradients of each parameter once backward has
+        scheduled them on all the devices, on the gradient arrays not hooked yet."""
+        trainer = weakref.ref(self)
+
+        def make_hook(i):
+            def hook():
+                this = trainer()
+                if this is None or i not in this._pending_hooks:
+                    return
+                this._pending_hooks[i] -= 1
+                if this._pending_hooks[i] == 0:
+                    # a later backward writes the gradients again and reduces them again
+                    this._pending_hooks[i] = len(this._hooked_grads[i])
+                    this._reduced_by_hooks.add(i)
+                    this._reduce_dense_grads(i, this._hooked_grads[i])
+            return hook
+
+        for i, param in enumerate(self._params):
+            if param.grad_req != 'write' or param._grad_stype != 'default' or \
+                    param._deferred_init:
+                continue
+            grad_list = param.list_grad()
+            hooked = self._hooked_grads.get(i)
+            if hooked is not None and all(a is b for a, b in zip(hooked, grad_list)):
+                self._pending_hooks[i] = len(grad_list)
+                continue
+            for grad in hooked or []:
+                autograd.set_grad_hook(grad, None)
+            self._hooked_grads[i] = grad_list
+            self._pending_hooks[i] = len(grad_list)
+            for grad in grad_list:
+                autograd.set_grad_hook(grad, make_hook(i))
+
+    @staticmethod
+    def _unhook_grads(hooked_grads):
+        """Removes the hooks of the gradient arrays of `hooked_grads` and clears it. Does not
+        refer to the trainer, as it also runs when the trainer is collected."""
+        for grad_list in hooked_grads.values():
+            for grad in grad_list:
+                autograd.set_grad_hook(grad, None)
+        hooked_grads.clear()
+
+    def _remove_grad_hooks(self):
+        # _hooked_grads is cleared in place, the finalizer holds it
+        Trainer._unhook_grads(self._hooked_grads)
+        self._pending_hooks = {}
+        self._reduced_by_hooks = set()
 
     def update(self, batch_size, ignore_stale_grad=False):
         """Makes one step of parameter update.
@@ -455,6 +586,8 @@ class Trainer(object):
                 return  # skip on overflow
 
         updates = [[] for _ in self._updaters]
+        sharded = self._is_sharded()
+        gathers = []
 
         for i, param in enumerate(self._params):
             if param.grad_req == 'null':
@@ -474,16 +607,88 @@ class Trainer(object):
             if self._kvstore and self._update_on_kvstore:
                 continue
 
+            if sharded:
+                # only the owner updates the parameter, then its weight is copied to the others
+                owner = self._shard_owner(i)
+                data = param.list_data()
+                if not ignore_stale_grad or data[owner]._fresh_grad:
+                    updates[owner].append((i, param.list_grad()[owner], data[owner]))
+                    gathers.append((data[owner], data[:owner] + data[owner + 1:]))
+                for arr in data:
+                    arr._fresh_grad = False
+                continue
+
             for upd, arr, grad in zip(updates, param.list_data(), param.list_grad()):
                 if not ignore_stale_grad or arr._fresh_grad:
                     upd.append((i, grad, arr))
                     arr._fresh_grad = False
 
         if not (self._kvstore and self._update_on_kvstore):
-            for updater, upd in zip(self._updaters, updates):
+            for k, (updater, upd) in enumerate(zip(self._updaters, updates)):
                 if upd:
+                    if self._offload_optimizer_states:
+                        upd = self._offload(k, upd)
                     i, g, w = zip(*upd)
                     updater(i, g, w)
+                    if self._offload_optimizer_states:
+                        for (_, _, src), (_, _, dst) in zip(upd, updates[k]):
+                            src.copyto(dst)
+        for src, dsts in gathers:
+            for dst in dsts:
+                src.copyto(dst)
+
+    def _is_sharded(self):
+        """Whether the optimizer states are sharded across the devices."""
+        return self._shard_optimizer_states and self._kvstore is not None \
+            and not self._update_on_kvstore and len(self._devices) > 1
+
+    def _shard_owner(self, i):
+        """Index of the device owning the i-th parameter. Parameters are assigned from the
+        largest, each to the device owning the fewest elements so far."""
+        if self._shard_owners is None:
+            loads = [0] * len(self._devices)
+            self._shard_owners = {}
+            sizes = [(param.data(self._devices[0]).size, j)
+                     for j, param in enumerate(self._params) if param.grad_req != 'null']
+            for size, j in sorted(sizes, key=lambda x: (-x[0], x[1])):
+                owner = loads.index(min(loads))
+                self._shard_owners[j] = owner
+                loads[owner] += size
+            self._prune_shard_states()
+        return self._shard_owners[i]
+
+    def _prune_shard_states(self):
+        """Drops the optimizer states of the parameters a device does not own."""
+        if self._shard_owners is None:
+            return
+        for owner, updater in enumerate(self._updaters):
+            for i in list(updater.states.keys()):
+                if self._shard_owners.get(i, owner) != owner:
+                    del updater.states[i]
+                    del updater.states_synced[i]
+
+    def _offload(self, k, updates):
+        """Queues the copies of the gradients and weights of the k-th updater to its host
+        buffers, allocated in pinned memory on first use, and returns the updates on them.
+
+        The weights are copied at every step, not only the first time, because the device
+        weight is the value of the parameter: `set_data`, `load_parameters` or `initialize`
+        may write it between two steps, in place and without the trainer knowing, and a
+        host weight kept across steps would then silently undo them. The copy is queued
+        with the one of the gradient and overlaps with the backward pass like it."""
+        host_updates = [None] * len(updates)
+        # the gradients of the last parameters are the first computed by backward
+        for j in reversed(range(len(updates))):
+            i, grad, weight = updates[j]
+            if (k, i) not in self._offload_buffers:
+                host = cpu_pinned(weight.device.device_id)
+                self._offload_buffers[(k, i)] = (grad.copyto(host), weight.copyto(host))
+            else:
+                host_grad, host_weight = self._offload_buffers[(k, i)]
+                grad.copyto(host_grad)
+                weight.copyto(host_weight)
+            host_updates[j] = (i,) + self._offload_buffers[(k, i)]
+        return host_updates
 
     def save_states(self, fname):
         """Saves trainer states (e.g. optimizer, momentum) to a file.
@@ -510,6 +715,13 @@ class Trainer(object):
             assert not self._params_to_init, "Cannot save trainer states when some " \
                                              "parameters are not yet initialized in kvstore."
             self._kvstore.save_optimizer_states(fname, dump_optimizer=True)
+        elif self._is_sharded():
+            # the states of every device are merged in the file
+            updater = opt.get_updater(self._updaters[0].optimizer)
+            for shard in self._updaters:
+                updater.states.update(shard.states)
+            with open(fname, 'wb') as fout:
+                fout.write(updater.get_states(dump_optimizer=True))
         else:
             with open(fname, 'wb') as fout:
                 fout.write(self._updaters[0].get_states(dump_optimizer=True))
@@ -543,5 +755,7 @@ class Trainer(object):
                 updater.set_states(states)
                 updater.optimizer = self._updaters[0].optimizer
             self._optimizer = self._updaters[0].optimizer
+            if self._is_sharded():
+                self._prune_shard_states()
         param_dict = {i: param for i, param in enumerate(self._params)}
         self._optimizer.param_dict = param_dict
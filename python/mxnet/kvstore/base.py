@@ -427,13 +427,19 @@ def create(name='local'):
     No two updates happen on the same weight at the same time. However, the order is not
     guaranteed.
 
+    ``dist_sync_allreduce``: Identical to ``dist_sync`` but without servers. The workers
+    allreduce the gradients over a ring between them and each worker updates its own copy
+    of the weights. ``dist_device_sync_allreduce`` reduces the gradients of the GPUs of a
+    worker on the GPUs first.
+
     ``byteps``: Use byteps as broadcast/pushpull backend.
     This kind of kvstore doesn't store weights, thus there won't be optimizer in this kvstore server.
     Byteps doesn't support pure cpu training, so be sure to enable gpu training when using this kvstore.
 
     Parameters
     ----------
-    name : {'local', 'device', 'nccl', 'dist_sync', 'dist_device_sync', 'dist_async', 'horovod', 'byteps'}
+    name : {'local', 'device', 'nccl', 'dist_sync', 'dist_device_sync', 'dist_async',
+            'dist_sync_allreduce', 'dist_device_sync_allreduce', 'horovod', 'byteps'}
         The type of KVStore.
 
     Returns
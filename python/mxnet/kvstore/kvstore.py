@@ -46,7 +46,10 @@ def _get_kvstore_server_command_type(command):
                      'kStopServer': 2,
                      'kSyncMode': 3,
                      'kSetGradientCompression': 4,
-                     'kSetProfilerParams': 5}
+                     'kSetProfilerParams': 5,
+                     'kWorkerJoin': 6,
+                     'kWorkerLeave': 7,
+                     'kWorkerBarrier': 8}
     assert (command in command_types), "Unknown command type to send to server"
     return command_types[command]
 
@@ -516,6 +519,16 @@ class KVStore(KVStoreBase):
         original values is stored at the sender's end as residual and added to the
         gradient in the next iteration.
 
+        fp16 and bf16 Gradient Compression cast the gradient to 16 bit floats, halving
+        communication costs. The rounding error is kept as residual as well.
+
+        topk Gradient Compression takes a float `ratio` in (0, 0.5], 0.01 by default.
+        The gradient is split into blocks of 1 / `ratio` values, and only the value of
+        largest magnitude of each block is sent, as a 16 bit float along with its 16 bit
+        position in the block. The values not sent are kept as residual and sent in later
+        iterations. The servers add the values received to the merged gradient without
+        decompressing them.
+
         When kvstore is 'local', gradient compression is used to reduce communication
         between multiple devices (gpus). Gradient is quantized on each GPU which
         computed the gradients, then sent to the GPU which merges the gradients. This
@@ -537,6 +550,7 @@ class KVStore(KVStoreBase):
         To completely specify the arguments for 2bit compression, we would need to pass
         a dictionary which includes `threshold` like:
         {'type': '2bit', 'threshold': 0.5}
+        Similarly, top-k compression sending 1% of the values is {'type': 'topk', 'ratio': 0.01}
 
         Parameters
         ----------
@@ -544,7 +558,7 @@ class KVStore(KVStoreBase):
             A dictionary specifying the type and parameters for gradient compression.
             The key `type` in this dictionary is a
             required string argument and specifies the type of gradient compression.
-            Currently `type` can be only `1bit` and `2bit`
+            Currently `type` can be `1bit`, `2bit`, `fp16`, `bf16` and `topk`
             Other keys in this dictionary are optional and specific to the type
             of gradient compression.
         """
@@ -590,7 +604,8 @@ class KVStore(KVStoreBase):
         check_call(_LIB.MXKVStoreIsWorkerNode(ctypes.byref(is_worker)))
 
         # pylint: disable=invalid-name
-        if 'dist' in self.type and is_worker.value: # pylint: disable=unsupported-membership-test
+        # pylint: disable=unsupported-membership-test
+        if 'dist' in self.type and 'allreduce' not in self.type and is_worker.value:
             # send the optimizer to server
             try:
                 # use ASCII protocol 0, might be slower, but not a big ideal
@@ -722,6 +737,27 @@ class KVStore(KVStoreBase):
         """
         check_call(_LIB.MXKVStoreBarrier(self.handle))
 
+    def leave(self):
+        """Stops taking part in the training, for instance before the machine of the worker
+        is preempted.
+
+        The servers stop waiting for the pushes of this worker in ``dist_sync`` mode, and the
+        other workers keep training. Call it between iterations, once the values pushed have
+        been pulled. Needs ``MXNET_KVSTORE_ELASTIC=1`` on all the nodes.
+
+        A worker restarted in place of a dead one, by the recovery of ps-lite, joins again
+        by itself.
+        """
+        self._send_command_to_servers(_get_kvstore_server_command_type('kWorkerLeave'), '')
+
+    def join(self):
+        """Takes part in the training again after ``leave``.
+
+        The pushes of the worker are merged from the next merge of each key. Pull the values
+        before pushing, since they were updated meanwhile.
+        """
+        self._send_command_to_servers(_get_kvstore_server_command_type('kWorkerJoin'), '')
+
     def _send_command_to_servers(self, head, body):
         """Sends a command to all server nodes.
 
@@ -25,12 +25,13 @@ from ..device import current_device
 from ..random import uniform
 from ..base import _as_list
 from . import ndarray
+from . import _internal
 try:
     from .gen_contrib import *
 except ImportError:
     pass
 
-__all__ = ["rand_zipfian", "foreach", "while_loop", "cond", "isinf", "isfinite", "isnan"]
+__all__ = ["rand_zipfian", "unigram_table", "rand_unigram", "foreach", "while_loop", "cond", "isinf", "isfinite", "isnan"]
 
 def _flatten_list(nested_list):
     return [item for sublist in nested_list for item in sublist]
@@ -104,6 +105,66 @@ def rand_zipfian(true_classes, num_sampled, range_max, ctx=None):
 # pylint: enable=line-too-long
 
 
+def unigram_table(weights):
+    """Build the alias table of the unigram distribution proportional to `weights`, from which
+    `rand_unigram` draws candidates in constant time.
+
+    The table is built in linear time, on CPU. Build it once and reuse it, copied to the device
+    of the sampling if needed.
+
+    Parameters
+    ----------
+    weights : NDArray
+        A 1-D NDArray of the non-negative weights of the classes, e.g. their counts.
+
+    Returns
+    -------
+    table: list of NDArray
+        The acceptance probabilities (`float32`) and the aliases (`int64`) of the columns of the
+        table, and the normalized distribution (`float32`).
+    """
+    return _internal._alias_table(weights)
+
+
+def rand_unigram(true_classes, num_sampled, table):
+    """Draw random samples from an arbitrary unigram distribution, given by its alias table.
+
+    This operation randomly samples *num_sampled* candidates with replacement, each with two
+    uniform draws, in parallel on CPU and GPU. Unlike rejection sampling, its cost does not depend
+    on the number of classes nor on the distribution, which suits large-vocabulary sampled softmax.
+
+    Additionaly, it also returns the number of times each of the true classes and the sampled
+    classes is expected to occur.
+
+    Parameters
+    ----------
+    true_classes : NDArray
+        The target classes.
+    num_sampled: int
+        The number of classes to randomly sample.
+    table: list of NDArray
+        The alias table of the distribution, built by `unigram_table`.
+
+    Returns
+    -------
+    samples: NDArray
+        The sampled candidate classes in 1-D `int64` dtype.
+    expected_count_true: NDArray
+        The expected count for true classes in `float32` dtype, with the shape of true_classes.
+    expected_count_sample: NDArray
+        The expected count for sampled candidates in 1-D `float32` dtype.
+
+    Examples
+    --------
+    >>> table = mx.nd.contrib.unigram_table(weights)
+    >>> samples, exp_count_true, exp_count_sample = \\
+    ...     mx.nd.contrib.rand_unigram(true_cls, 8192, table)
+    """
+    accept, alias, dist = table
+    return _internal._sample_candidates(accept, alias, dist, true_classes,
+                                        num_sampled=num_sampled)
+
+
 def _flatten(args, inout_str):
     if isinstance(args, ndarray.NDArray):
         return [args], int(0)
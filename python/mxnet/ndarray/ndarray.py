@@ -245,6 +245,20 @@ def _new_from_shared_mem(shared_pid, shared_id, shape, dtype):
     return hdl
 
 
+def _new_from_cuda_ipc(ipc_handle, offset, shape, dtype, device_id):
+    """Maps the GPU array of another process, described by its ``_to_cuda_ipc``."""
+    hdl = NDArrayHandle()
+    check_call(_LIB.MXNDArrayCreateFromCudaIpcHandle(
+        ctypes.c_char_p(ipc_handle),
+        ctypes.c_uint64(offset),
+        c_array(ctypes.c_int64, shape),
+        mx_int(len(shape)),
+        ctypes.c_int(int(dtype_np_to_mx(dtype))),
+        ctypes.c_int(device_id),
+        ctypes.byref(hdl)))
+    return hdl
+
+
 def waitall():
     """Wait for all async operations to finish in MXNet.
 
@@ -315,6 +329,14 @@ fixed-size items.
             self.handle, ctypes.byref(shared_pid), ctypes.byref(shared_id)))
         return shared_pid.value, shared_id.value, self.shape, self.dtype
 
+    def _to_cuda_ipc(self):
+        """Returns the description of a GPU array for another process to map it without copy
+        with ``_new_from_cuda_ipc``. The array must be kept alive as long as it is used there."""
+        ipc_handle = ctypes.create_string_buffer(64)
+        offset = ctypes.c_uint64()
+        check_call(_LIB.MXNDArrayGetCudaIpcHandle(self.handle, ipc_handle, ctypes.byref(offset)))
+        return ipc_handle.raw, offset.value, self.shape, self.dtype, self.ctx.device_id
+
     def __abs__(self):
         """x.__abs__() <=> abs(x) <=> x.abs() <=> mx.nd.abs(x, y)"""
         return self.abs()
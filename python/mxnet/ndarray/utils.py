@@ -20,6 +20,7 @@
 import ctypes
 
 from ..base import _LIB, check_call, py_str, c_str, string_types, mx_uint, NDArrayHandle
+from ..base import CheckpointHandle
 from ..base import c_array, c_handle_array, c_str_array
 from .ndarray import NDArray
 from .ndarray import array as _array
@@ -34,7 +35,8 @@ try:
 except ImportError:
     spsp = None
 
-__all__ = ['zeros', 'empty', 'array', 'load', 'load_frombuffer', 'save']
+__all__ = ['zeros', 'empty', 'array', 'load', 'load_frombuffer', 'load_mapped', 'save',
+           'save_async', 'Checkpoint']
 
 
 def zeros(shape, ctx=None, dtype=None, stype=None, **kwargs):
@@ -219,7 +221,51 @@ def load_frombuffer(buf):
             for i in range(out_size.value))
 
 
-def save(fname, data):
+def load_mapped(fname, ctx=None):
+    """Loads arrays saved with ``save(fname, data, mapped=True)`` to a context.
+
+    On the CPU the arrays are views of the memory-mapped file, so loading does not read or copy
+    the payloads, pages are read on first access. On a GPU the arrays are uploaded from the
+    mapping in chunks, asynchronously. ``load`` also reads these files, to the CPU.
+
+    Parameters
+    ----------
+    fname : str
+        The filename.
+    ctx : Device, optional
+        The device of the arrays, the current device by default.
+
+    Returns
+    -------
+    list of NDArray or dict of str to NDArray
+        Loaded data.
+    """
+    from ..device import current_device
+    if not isinstance(fname, string_types):
+        raise TypeError('fname required to be a string')
+    if ctx is None:
+        ctx = current_device()
+    out_size = mx_uint()
+    out_name_size = mx_uint()
+    handles = ctypes.POINTER(NDArrayHandle)()
+    names = ctypes.POINTER(ctypes.c_char_p)()
+    check_call(_LIB.MXNDArrayLoadMapped(c_str(fname),
+                                        ctypes.c_int(ctx.device_typeid),
+                                        ctypes.c_int(ctx.device_id),
+                                        ctypes.byref(out_size),
+                                        ctypes.byref(handles),
+                                        ctypes.byref(out_name_size),
+                                        ctypes.byref(names)))
+    if out_name_size.value == 0:
+        return [_ndarray_cls(NDArrayHandle(handles[i])) for i in range(out_size.value)]
+    else:
+        assert out_name_size.value == out_size.value
+        return dict(
+            (py_str(names[i]), _ndarray_cls(NDArrayHandle(handles[i])))
+            for i in range(out_size.value))
+
+
+def save(fname, data, mapped=False, num_shards=1):
     """Saves a list of arrays or a dict of str->array to file.
 
     Parameters
@@ -230,6 +276,13 @@ def save(fname, data):
            or list of NDArray, RowSparseNDArray or CSRNDArray, \
            or dict of str to NDArray, RowSparseNDArray or CSRNDArray
         The data to save.
+    mapped : bool, optional
+        Whether to save dense arrays in a format which can be memory-mapped, with a header
+        indexing the arrays and 64 bytes aligned payloads. See ``load_mapped``.
+    num_shards : int, optional
+        Number of files the arrays are split in, written in parallel. ``fname`` is then an
+        index of the shards, which are named ``fname.shard-<i>-of-<num_shards>``. ``load``
+        reads them back in parallel.
 
     Examples
     --------
@@ -242,10 +295,23 @@ def save(fname, data):
     >>> mx.nd.load('my_dict')
     {'y': <NDArray 1x4 @cpu(0)>, 'x': <NDArray 2x3 @cpu(0)>}
     """
+    handles, keys = _save_handles(data)
+    if mapped and num_shards > 1:
+        raise ValueError('mapped parameter files cannot be sharded')
+    if mapped:
+        check_call(_LIB.MXNDArraySaveMapped(c_str(fname), mx_uint(len(handles)), handles, keys))
+    elif num_shards > 1:
+        check_call(_LIB.MXNDArraySaveSharded(c_str(fname), mx_uint(num_shards),
+                                             mx_uint(len(handles)), handles, keys))
+    else:
+        check_call(_LIB.MXNDArrayLegacySave(c_str(fname), mx_uint(len(handles)), handles, keys))
+
+
+def _save_handles(data):
+    """Handles and keys of the arrays to save, from the data passed to ``save``."""
     from ..numpy import ndarray as np_ndarray
     if isinstance(data, NDArray):
         data = [data]
-        handles = c_array(NDArrayHandle, [])
     if isinstance(data, dict):
         str_keys = data.keys()
         nd_vals = data.values()
@@ -268,4 +334,62 @@ def save(fname, data):
     else:
         raise ValueError("data needs to either be a NDArray, dict of str, NDArray pairs "
                          "or a list of NDarrays.")
-    check_call(_LIB.MXNDArrayLegacySave(c_str(fname), mx_uint(len(handles)), handles, keys))
+    return handles, keys
+
+
+class Checkpoint(object):
+    """A checkpoint being saved in the background, returned by ``save_async``."""
+    def __init__(self, handle):
+        self.handle = handle
+
+    def __del__(self):
+        check_call(_LIB.MXCheckpointFree(self.handle))
+
+    @property
+    def done(self):
+        """Whether the file is written, or its writing failed."""
+        done = ctypes.c_int()
+        check_call(_LIB.MXCheckpointIsDone(self.handle, ctypes.byref(done)))
+        return bool(done.value)
+
+    def wait(self):
+        """Waits for the file to be written, and raises the error of the writing if any."""
+        check_call(_LIB.MXCheckpointWait(self.handle))
+
+
+def save_async(fname, data, mapped=False, num_shards=1):
+    """Saves a list of arrays or a dict of str->array to file without blocking.
+
+    A copy of the arrays to the CPU, in pinned memory for arrays of a GPU, is pushed to the
+    engine ahead of any later operation, so the arrays can be updated right away, for example by
+    the next training step. The copies are written to the file by a background thread. The
+    arrays are loaded back on the CPU.
+
+    Parameters
+    ----------
+    fname : str
+        The filename.
+    data : NDArray, list of NDArray or dict of str to NDArray
+        The data to save.
+    mapped : bool, optional
+        Whether to save in the format which can be memory-mapped, see ``save``.
+    num_shards : int, optional
+        Number of files the arrays are split in, see ``save``.
+
+    Returns
+    -------
+    Checkpoint
+        The checkpoint, whose ``wait`` blocks until the file is written.
+
+    Examples
+    --------
+    >>> ckpt = mx.nd.save_async('my_dict', {'x': x, 'y': y})
+    >>> x += 1  # does not change the saved values
+    >>> ckpt.wait()
+    """
+    handles, keys = _save_handles(data)
+    handle = CheckpointHandle()
+    check_call(_LIB.MXNDArraySaveAsync(c_str(fname), mx_uint(len(handles)), handles, keys,
+                                       ctypes.c_int(mapped), mx_uint(num_shards),
+                                       ctypes.byref(handle)))
+    return Checkpoint(handle)
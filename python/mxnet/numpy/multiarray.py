@@ -55,7 +55,7 @@ from ..ndarray import numpy as _mx_nd_np
 from ..ndarray.numpy import _internal as _npi
 from ..ndarray.ndarray import _storage_type
 from ..dlpack import ndarray_from_numpy, ndarray_to_dlpack_for_write, DLDeviceType,\
-                     ndarray_from_dlpack
+                     ndarray_from_dlpack, ndarray_to_dlpack
 from .utils import _get_np_op
 from .fallback import *  # pylint: disable=wildcard-import,unused-wildcard-import
 from . import fallback
@@ -453,23 +453,29 @@ class ndarray(NDArray):  # pylint: disable=invalid-name
             Stream is provided by the consumer to the producer to instruct the producer
             to ensure that operations can safely be performed on the array. The pointer must
             be positive integer or -1. If stream is -1, the value must be used by the consumer
-            to signal "producer must not perform any synchronization". 
+            to signal "producer must not perform any synchronization". 1 and 2 stand for the
+            legacy and the per-thread default streams, and None for the legacy one.
+            For arrays on a GPU, the stream is made to wait for the pending operations on the
+            array, which are not waited for on the host.
 
         Returns
         -------
         capsule : PyCapsule
             A DLPack capsule for the array, containing a DLPackManagedTensor.
         """
-        if stream is not None:
-            if type(stream) is not int:
-                raise TypeError('The input stream must be int or None')
-            if self.device.device_type != "gpu":
+        if self.device.device_type != "gpu":
+            if stream is not None:
                 raise ValueError('Stream {} is not supported in current device {}'\
                     .format(stream, self.device.device_type))
-            if stream != -1:
-                check_call(_LIB.MXPushStreamDep(self.handle, ctypes.c_int64(stream)))
-        to_dlpack_write = ndarray_to_dlpack_for_write()
-        return to_dlpack_write(self)
+            to_dlpack_write = ndarray_to_dlpack_for_write()
+            return to_dlpack_write(self)
+        if stream is None:
+            stream = 1
+        if type(stream) is not int:
+            raise TypeError('The input stream must be int or None')
+        if stream != -1:
+            check_call(_LIB.MXPushStreamDep(self.handle, ctypes.c_int64(stream)))
+        return ndarray_to_dlpack(self)
 
 
     def __dlpack_device__(self):
@@ -37,9 +37,17 @@ def set_config(**kwargs):
     Parameters
     ----------
     filename : string,
-        output file for profile data
+        output file for profile data. When empty, no trace is written and the records
+        only feed the aggregate stats.
     gpu_memory_profile_filename_prefix : string
         filename prefix for the GPU memory profile
+    memory_timeline_filename_prefix : string
+        filename prefix for the memory timeline. When set together with `profile_memory`,
+        every allocation and free of every device is written to `<prefix>-pid_<pid>.csv`,
+        tagged with the node name and the storage role (weight, gradient, optimizer state,
+        workspace, activation) of the allocation, and the breakdown of the peak memory usage
+        of every device by role and by name to `<prefix>-pid_<pid>-peak.csv`.
+        Defaults to empty, no timeline.
     profile_all : boolean,
         all profile types enabled
     profile_symbolic : boolean,
@@ -57,6 +65,22 @@ def set_config(**kwargs):
     aggregate_stats : boolean,
         whether to maintain aggregate stats in memory for console
         dump.  Has some negative performance impact.
+    sample_period : int,
+        record one operator, or one execution of a hybridized graph, out of every
+        `sample_period` pushed by each thread. Defaults to 1, record all of them.
+        Together with an empty `filename`, `continuous_dump` and `aggregate_stats`,
+        this keeps the profiler cheap enough to leave running in production.
+    max_pending_records : int,
+        maximum number of records of a device kept until the next dump, the ones
+        over it are dropped. Defaults to 0, no maximum.
+    hw_counters : boolean,
+        record the cycles, instructions and last level cache misses of every CPU
+        operator in the args of its trace event, through perf_event_open on Linux.
+        Defaults to False. Unprivileged users need a perf_event_paranoid of 2 or less.
+    step_report_period : int,
+        break the wall time of every `step_report_period` training steps, marked with
+        `mark_step`, down into data loading, H2D copy, forward, backward, kvstore,
+        optimizer and idle time. Defaults to 0, no breakdown.
     profile_process : string
         whether to profile kvstore `server` or `worker`.
         server can only be profiled when kvstore is of type dist.
@@ -160,7 +184,12 @@ def dumps(reset=False, format='table', sort_by='total', ascending=False):
         indicates whether to clean aggeregate statistical data collected up to this point
     format: string
         whether to return the aggregate stats in table of json format
-        can take 'table' or 'json'
+        can take 'table', 'json' or 'openmetrics'. 'openmetrics' returns a snapshot
+        in the OpenMetrics text format, with per operator count, sum and p50/p99
+        durations, the memory pool, engine and kvstore counters, to be scraped
+        periodically while the profiler keeps running
+        operators that estimate their work, such as FullyConnected, Convolution,
+        dot and the elementwise operators, also report their achieved GFLOP/s and GB/s
         defaults to 'table'
     sort_by: string
         can take 'total', 'avg', 'min', 'max', or 'count'
@@ -172,11 +201,12 @@ def dumps(reset=False, format='table', sort_by='total', ascending=False):
     """
     debug_str = ctypes.c_char_p()
     reset_to_int = {False: 0, True: 1}
-    format_to_int = {'table': 0, 'json': 1}
+    format_to_int = {'table': 0, 'json': 1, 'openmetrics': 2}
     sort_by_to_int = {'total': 0, 'avg': 1, 'min': 2, 'max': 3, 'count': 4}
     asc_to_int = {False: 0, True: 1}
     assert format in format_to_int.keys(),\
-            "Invalid value provided for format: {0}. Support: 'table', 'json'".format(format)
+            "Invalid value provided for format: {0}. Support: 'table', 'json', 'openmetrics'"\
+            .format(format)
     assert sort_by in sort_by_to_int.keys(),\
             "Invalid value provided for sort_by: {0}.\
              Support: 'total', 'avg', 'min', 'max', 'count'"\
@@ -193,6 +223,26 @@ def dumps(reset=False, format='table', sort_by='total', ascending=False):
     return py_str(debug_str.value)
 
 
+def mark_step():
+    """Mark the end of a training step for the step breakdown.
+
+    When `step_report_period` is set with `set_config`, the wall time of every
+    `step_report_period` steps is broken down into data loading, H2D copy, forward,
+    backward, kvstore, optimizer and idle time, from the operators recorded by the
+    profiler. Phases running concurrently overlap, idle is the time when no recorded
+    operator ran.
+
+    Returns
+    -------
+    str or None
+        The breakdown, every `step_report_period` steps, else None.
+    """
+    report = ctypes.c_char_p()
+    check_call(_LIB.MXProfileMarkStep(ctypes.byref(report)))
+    report = py_str(report.value)
+    return report if report else None
+
+
 def pause(profile_process='worker'):
     """Pause profiling.
 
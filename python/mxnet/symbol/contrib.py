@@ -30,11 +30,12 @@ except ImportError:
     pass
 
 from . import symbol
+from . import _internal
 from ..base import _LIB, check_call
 from ..base import SymbolHandle, _as_list
 from ..attribute import AttrScope, current as current_attribute
 
-__all__ = ["rand_zipfian", "foreach", "while_loop", "cond"]
+__all__ = ["rand_zipfian", "unigram_table", "rand_unigram", "foreach", "while_loop", "cond"]
 
 def rand_zipfian(true_classes, num_sampled, range_max):
     """Draw random samples from an approximately log-uniform or Zipfian distribution.
@@ -98,6 +99,66 @@ def rand_zipfian(true_classes, num_sampled, range_max):
     return sampled_classes, expected_count_true, expected_count_sampled
 
 
+def unigram_table(weights):
+    """Build the alias table of the unigram distribution proportional to `weights`, from which
+    `rand_unigram` draws candidates in constant time.
+
+    The table is built in linear time, on CPU. Build it once and reuse it, copied to the device
+    of the sampling if needed.
+
+    Parameters
+    ----------
+    weights : Symbol
+        A 1-D Symbol of the non-negative weights of the classes, e.g. their counts.
+
+    Returns
+    -------
+    table: list of Symbol
+        The acceptance probabilities (`float32`) and the aliases (`int64`) of the columns of the
+        table, and the normalized distribution (`float32`).
+    """
+    return _internal._alias_table(weights)
+
+
+def rand_unigram(true_classes, num_sampled, table):
+    """Draw random samples from an arbitrary unigram distribution, given by its alias table.
+
+    This operation randomly samples *num_sampled* candidates with replacement, each with two
+    uniform draws, in parallel on CPU and GPU. Unlike rejection sampling, its cost does not depend
+    on the number of classes nor on the distribution, which suits large-vocabulary sampled softmax.
+
+    Additionaly, it also returns the number of times each of the true classes and the sampled
+    classes is expected to occur.
+
+    Parameters
+    ----------
+    true_classes : Symbol
+        The target classes.
+    num_sampled: int
+        The number of classes to randomly sample.
+    table: list of Symbol
+        The alias table of the distribution, built by `unigram_table`.
+
+    Returns
+    -------
+    samples: Symbol
+        The sampled candidate classes in 1-D `int64` dtype.
+    expected_count_true: Symbol
+        The expected count for true classes in `float32` dtype, with the shape of true_classes.
+    expected_count_sample: Symbol
+        The expected count for sampled candidates in 1-D `float32` dtype.
+
+    Examples
+    --------
+    >>> table = mx.sym.contrib.unigram_table(weights)
+    >>> samples, exp_count_true, exp_count_sample = \\
+    ...     mx.sym.contrib.rand_unigram(true_cls, 8192, table)
+    """
+    accept, alias, dist = table
+    return _internal._sample_candidates(accept, alias, dist, true_classes,
+                                        num_sampled=num_sampled)
+
+
 def _flatten(args, inout_str):
     if isinstance(args, symbol.Symbol):
         length = len(args.list_outputs())
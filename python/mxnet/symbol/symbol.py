@@ -46,7 +46,7 @@ from ..util import is_np_shape
 from ..profiler import scope as _profiler_scope
 from ..profiler import _current_scope as _current_profiler_scope
 
-__all__ = ["Symbol", "var", "Variable", "Group", "load", "fromjson",
+__all__ = ["Symbol", "var", "Variable", "Group", "load", "fromjson", "frombinary",
            "pow", "power", "maximum", "minimum", "hypot", "eye", "zeros",
            "ones", "full", "arange", "linspace", "histogram", "split_v2"]
 
@@ -1356,7 +1356,7 @@ class Symbol(SymbolBase):
             self.handle, ctypes.byref(debug_str)))
         return py_str(debug_str.value)
 
-    def save(self, fname, remove_amp_cast=True):
+    def save(self, fname, remove_amp_cast=True, binary=False):
         """Saves symbol to a file.
 
         You can also use pickle to do the job if you only work on python.
@@ -1375,6 +1375,9 @@ class Symbol(SymbolBase):
             - "/path-to/my-local-symbol"
         remove_amp_cast : bool, optional
             Whether to remove the amp_cast and amp_multicast operators, before saving the model.
+        binary : bool, optional
+            Save the graph in a binary format instead of JSON, which loads much faster for
+            graphs of many nodes. `symbol.load` reads both formats.
 
         See Also
         --------
@@ -1382,12 +1385,13 @@ class Symbol(SymbolBase):
         """
         if not isinstance(fname, string_types):
             raise TypeError('fname need to be string')
+        save = _LIB.MXSymbolSaveToBinaryFile if binary else _LIB.MXSymbolSaveToFile
         if remove_amp_cast:
             handle = SymbolHandle()
             check_call(_LIB.MXSymbolRemoveAmpCast(self.handle, ctypes.byref(handle)))
-            check_call(_LIB.MXSymbolSaveToFile(handle, c_str(fname)))
+            check_call(save(handle, c_str(fname)))
         else:
-            check_call(_LIB.MXSymbolSaveToFile(self.handle, c_str(fname)))
+            check_call(save(self.handle, c_str(fname)))
 
     def tojson(self, remove_amp_cast=True):
         """Saves symbol to a JSON string.
@@ -1405,6 +1409,24 @@ class Symbol(SymbolBase):
             check_call(_LIB.MXSymbolSaveToJSON(self.handle, ctypes.byref(json_str)))
         return py_str(json_str.value)
 
+    def tobinary(self, remove_amp_cast=True):
+        """Saves symbol to the bytes of a binary graph.
+
+        See Also
+        --------
+        symbol.frombinary : Used to load symbol from binary graph bytes.
+        """
+        size = ctypes.c_size_t()
+        buf = ctypes.POINTER(ctypes.c_char)()
+        if remove_amp_cast:
+            handle = SymbolHandle()
+            check_call(_LIB.MXSymbolRemoveAmpCast(self.handle, ctypes.byref(handle)))
+            check_call(_LIB.MXSymbolSaveToBinary(handle, ctypes.byref(size), ctypes.byref(buf)))
+        else:
+            check_call(_LIB.MXSymbolSaveToBinary(self.handle, ctypes.byref(size),
+                                                 ctypes.byref(buf)))
+        return ctypes.string_at(buf, size.value)
+
     @staticmethod
     def _get_ndarray_inputs(arg_key, args, arg_names, allow_missing):
         """Helper function to get NDArray lists handles from various inputs.
@@ -2795,7 +2817,7 @@ def Group(symbols, create_fn=Symbol):
 
 
 def load(fname):
-    """Loads symbol from a JSON file.
+    """Loads symbol from a JSON file, or a binary file saved with `Symbol.save(binary=True)`.
 
     You can also use pickle to do the job if you only work on python.
     The advantage of load/save is the file is language agnostic.
@@ -2851,6 +2873,31 @@ def fromjson(json_str):
     return Symbol(handle)
 
 
+def frombinary(buf):
+    """Loads symbol from the bytes of a binary graph.
+
+    Parameters
+    ----------
+    buf : bytes
+        A binary graph.
+
+    Returns
+    -------
+    sym : Symbol
+        The loaded symbol.
+
+    See Also
+    --------
+    Symbol.tobinary : Used to save symbol into binary graph bytes.
+    """
+    if not isinstance(buf, (bytes, bytearray)):
+        raise TypeError('buf required to be bytes')
+    handle = SymbolHandle()
+    check_call(_LIB.MXSymbolCreateFromBinary(bytes(buf), ctypes.c_size_t(len(buf)),
+                                             ctypes.byref(handle)))
+    return Symbol(handle)
+
+
 # pylint: disable=no-member
 # pylint: disable=redefined-builtin
 def pow(base, exp):
@@ -17,6 +17,8 @@
 
 # coding: utf-8
 """Init tvm ops."""
+import os
+
 from .runtime import Features
 
 if Features().is_enabled("TVM_OP"):
@@ -41,3 +43,25 @@ if Features().is_enabled("TVM_OP"):
         with open(_CONF_TVM_OP[0], "r") as f:
             ret = ConfigSpaces.from_json_dict(json.load(f))
         _set_tvm_op_config(ret)
+
+
+def load_tuned_kernels(libpath, manifest=None):
+    """Load kernels tuned by the TVM auto-scheduler, built by contrib/tvmop/tune.py.
+
+    The calls of the operators with the dtypes, shapes and attributes a kernel was tuned for
+    run the kernel, the other calls run the native implementation. Load the kernels before
+    binding or hybridizing the models using them.
+
+    Parameters
+    ----------
+    libpath : str
+        The library of the kernels.
+    manifest : str, optional
+        The json manifest of the kernels, the library path with a .json extension by default.
+    """
+    if not Features().is_enabled("TVM_OP"):
+        raise RuntimeError("Tuned kernels need MXNet built with USE_TVM_OP")
+    from .base import check_call, _LIB, c_str
+    if manifest is None:
+        manifest = os.path.splitext(libpath)[0] + ".json"
+    check_call(_LIB.MXLoadTVMTunedKernels(c_str(libpath), c_str(manifest)))
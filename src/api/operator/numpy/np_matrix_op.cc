@@ -22,6 +22,7 @@
  * \brief Implementation of the API of functions in src/operator/numpy/np_matrix_op.cc
  */
 #include <mxnet/api_registry.h>
+#include <mxnet/imperative.h>
 #include <mxnet/runtime/packed_func.h>
 #include <vector>
 #include "../utils.h"
@@ -192,6 +193,57 @@ MXNET_REGISTER_API("_npi.dstack")
       *ret            = ndoutputs[0];
     });
 
+/*!
+ * \brief Return the sections of a split along `axis` as views of the input when each of
+ *        them is one contiguous block of it, i.e. all the axes before `axis` have size 1.
+ *        Like basic indexing, the views share memory with the input. Under autograd or
+ *        deferred compute the split operator is recorded and run as usual.
+ * \return false when the split has to run the operator
+ */
+inline bool SplitAsViews(const NDArray& data,
+                         int axis,
+                         const op::SplitParam& param,
+                         runtime::MXNetRetValue* ret) {
+  using namespace runtime;
+  const mxnet::TShape& ishape = data.shape();
+  if (is_recording() || is_deferred_compute() || data.storage_type() != kDefaultStorage ||
+      !shape_is_known(ishape) || ishape.Size() == 0)
+    return false;
+#if MXNET_USE_ONEDNN == 1
+  if (data.IsDNNLData())
+    return false;
+#endif
+  if (axis < 0)
+    axis += ishape.ndim();
+  if (axis < 0 || axis >= ishape.ndim() || param.squeeze_axis)
+    return false;
+  for (int i = 0; i < axis; ++i) {
+    if (ishape[i] != 1)
+      return false;
+  }
+  const mxnet::TShape indices =
+      param.sections > 0 ? op::GetSplitIndices(ishape, axis, param.sections) : param.indices;
+  const int num_outputs = param.sections > 0 ? indices.ndim() - 1 : indices.ndim();
+  for (int i = 0; i < num_outputs; ++i) {
+    const dim_t end = i < num_outputs - 1 ? indices[i + 1] : ishape[axis];
+    // leave the error message to the operator
+    if (indices[i] < 0 || indices[i] > end || end > ishape[axis])
+      return false;
+  }
+  Imperative::DCInfo::Compute(data);
+  const NDArray rows = data.Reshape(mxnet::TShape({ishape[axis], ishape.Size() / ishape[axis]}));
+  std::vector<NDArrayHandle> ndarray_handles;
+  ndarray_handles.reserve(num_outputs);
+  for (int i = 0; i < num_outputs; ++i) {
+    const dim_t end      = i < num_outputs - 1 ? indices[i + 1] : ishape[axis];
+    mxnet::TShape oshape = ishape;
+    oshape[axis]         = end - indices[i];
+    ndarray_handles.emplace_back(new NDArray(rows.Slice(indices[i], end).Reshape(oshape)));
+  }
+  *ret = ADT(0, ndarray_handles.begin(), ndarray_handles.end());
+  return true;
+}
+
 MXNET_REGISTER_API("_npi.split").set_body([](runtime::MXNetArgs args, runtime::MXNetRetValue* ret) {
   using namespace runtime;
   const nnvm::Op* op = Op::Get("_npi_split");
@@ -217,6 +269,8 @@ MXNET_REGISTER_API("_npi.split").set_body([](runtime::MXNetArgs args, runtime::M
     }
     param.sections = 0;
   }
+  if (SplitAsViews(*inputs[0], param.axis, param, ret))
+    return;
   attrs.parsed = param;
   attrs.op     = op;
   SetAttrDict<op::SplitParam>(&attrs);
@@ -345,6 +399,8 @@ MXNET_REGISTER_API("_npi.array_split")
         }
         param.sections = 0;
       }
+      if (SplitAsViews(*args[0].operator mxnet::NDArray*(), param.axis, param, ret))
+        return;
       attrs.parsed = param;
       attrs.op     = op;
       SetAttrDict<op::SplitParam>(&attrs);
@@ -423,6 +479,8 @@ MXNET_REGISTER_API("_npi.hsplit")
         }
         param.sections = 0;
       }
+      if (SplitAsViews(*inputs[0], inputs[0]->shape().ndim() > 1 ? 1 : 0, param, ret))
+        return;
       attrs.parsed = param;
       attrs.op     = op;
       SetAttrDict<op::SplitParam>(&attrs);
@@ -462,6 +520,8 @@ MXNET_REGISTER_API("_npi.vsplit")
         }
         param.sections = 0;
       }
+      if (SplitAsViews(*inputs[0], param.axis, param, ret))
+        return;
       attrs.parsed = param;
       attrs.op     = op;
       SetAttrDict<op::SplitParam>(&attrs);
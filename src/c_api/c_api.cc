@@ -29,6 +29,7 @@
 #include <functional>
 #include <unordered_map>
 #include <utility>
+#include <algorithm>
 #include "dmlc/base.h"
 #include "dmlc/logging.h"
 #include "dmlc/io.h"
@@ -48,6 +49,7 @@
 #include "mxnet/lib_api.h"
 #include "../initialize.h"
 #include "./c_api_common.h"
+#include "../operator/cudnn_ops.h"
 #include "../operator/custom/custom-inl.h"
 #include "../operator/operator_common.h"
 #include "../operator/subgraph/common.h"
@@ -57,8 +59,13 @@
 #include "../operator/subgraph/subgraph_property.h"
 #include "../common/alm.h"
 #include "../common/utils.h"
+#include "../engine/engine_stats.h"
 #include "../profiler/profiler.h"
+#include "../serialization/async_checkpoint.h"
 #include "../serialization/cnpy.h"
+#include "../serialization/mapped_params.h"
+#include "../serialization/sharded_params.h"
+#include "../storage/cuda_ipc.h"
 #include "miniz.h"
 #include "nnvm/pass_functions.h"
 
@@ -138,6 +145,40 @@ std::string getExtensionMsgs(mxnet::ext::msgSize_t msgSize, mxnet::ext::msgGet_t
   return str;
 }
 
+/*! \brief Whether the arrays can be passed to the library as views of their dense data */
+bool IsPlainDense(const std::vector<NDArray>& arrays) {
+  for (const NDArray& array : arrays) {
+    if (array.storage_type() != kDefaultStorage)
+      return false;
+#if MXNET_USE_ONEDNN == 1
+    if (array.IsDNNLData())
+      return false;
+#endif
+  }
+  return true;
+}
+
+/*!
+ * \brief Fill the views of dense arrays passed to the fast path of stateful ops. The views are
+ *        kept per thread, so that no call allocates once they have grown.
+ */
+const mxnet::ext::MXTensorView* FillTensorViews(const std::vector<NDArray>& arrays,
+                                                std::vector<mxnet::ext::MXTensorView>* views) {
+  views->resize(arrays.size());
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    mxnet::ext::MXTensorView& view = (*views)[i];
+    const TBlob& blob              = arrays[i].data();
+    view.data_ptr                  = blob.dptr_;
+    view.shape                     = blob.shape_.data();
+    view.ndim                      = blob.shape_.ndim();
+    view.dtype                     = static_cast<mxnet::ext::MXDType>(blob.type_flag_);
+    view.verID                     = arrays[i].version();
+    view.dev_type                  = blob.dev_mask() == Context::kCPU ? "cpu" : "gpu";
+    view.dev_id                    = arrays[i].ctx().real_dev_id();
+  }
+  return views->data();
+}
+
 /*!
  * \brief Common compute function dispatcher for forward/backward and stateful forward/backward
  * state_ptr will be nullptr for regular ops; fcomp_fp is nullptr for stateful ops
@@ -147,6 +188,7 @@ void CustomFComputeDispatcher(const std::string op_name,
                               const mxnet::ext::fcomp_t fcomp_fp,
                               const nnvm::NodeAttrs* attrs,
                               const mxnet::ext::opCallFStatefulComp_t callFStatefulComp,
+                              const mxnet::ext::opCallFStatefulCompFast_t callFStatefulCompFast,
                               int stateful_forward_flag,
                               const OpStatePtr* state_ptr,
                               const OpContext& ctx,
@@ -167,67 +209,86 @@ void CustomFComputeDispatcher(const std::string op_name,
   std::vector<NDArray> conv_dnnl;  // converted NDArrays from DNNL format
 
   // Extra data for sparse inputs and outputs.
-  std::vector<int> in_stypes(inputs.size(), 0), out_stypes(outputs.size(), 0);
-  std::vector<void*> in_indices(inputs.size(), nullptr), out_indices(outputs.size(), nullptr);
-  std::vector<void*> in_indptr(inputs.size(), nullptr), out_indptr(outputs.size(), nullptr);
-  std::vector<int64_t> in_indices_shapes(inputs.size(), 0), out_indices_shapes(outputs.size(), 0);
-  std::vector<int64_t> in_indptr_shapes(inputs.size(), 0), out_indptr_shapes(outputs.size(), 0);
-
-  // convert inputs/outpus NDArray to C types to be passed to lib_api.h
-  for (size_t i = 0; i < inputs.size(); i++) {
-    NDArray const* in_nd = &(inputs[i]);
+  std::vector<int> in_stypes, out_stypes;
+  std::vector<void*> in_indices, out_indices;
+  std::vector<void*> in_indptr, out_indptr;
+  std::vector<int64_t> in_indices_shapes, out_indices_shapes;
+  std::vector<int64_t> in_indptr_shapes, out_indptr_shapes;
+
+  // stateful ops which support it get their dense arrays as views, without any conversion
+  const bool fast_compute =
+      state_ptr != nullptr &&
+      state_ptr->get_state<CustomStatefulOpWrapper>().supports_fast_compute() &&
+      IsPlainDense(inputs) && IsPlainDense(outputs);
+
+  if (!fast_compute) {
+    in_stypes.assign(inputs.size(), 0);
+    out_stypes.assign(outputs.size(), 0);
+    in_indices.assign(inputs.size(), nullptr);
+    out_indices.assign(outputs.size(), nullptr);
+    in_indptr.assign(inputs.size(), nullptr);
+    out_indptr.assign(outputs.size(), nullptr);
+    in_indices_shapes.assign(inputs.size(), 0);
+    out_indices_shapes.assign(outputs.size(), 0);
+    in_indptr_shapes.assign(inputs.size(), 0);
+    out_indptr_shapes.assign(outputs.size(), 0);
+
+    // convert inputs/outpus NDArray to C types to be passed to lib_api.h
+    for (size_t i = 0; i < inputs.size(); i++) {
+      NDArray const* in_nd = &(inputs[i]);
 #if MXNET_USE_ONEDNN == 1
-    // reorder data if in DNNL format
-    if (in_nd->IsDNNLData()) {
-      // convert from DNNL
-      conv_dnnl.push_back(in_nd->Reorder2Default());
-      in_nd = &(conv_dnnl.back());
-    }
+      // reorder data if in DNNL format
+      if (in_nd->IsDNNLData()) {
+        // convert from DNNL
+        conv_dnnl.push_back(in_nd->Reorder2Default());
+        in_nd = &(conv_dnnl.back());
+      }
 #endif
-    // pull out parts to pass over to library
-    in_data.push_back(in_nd->data().dptr_);
-    in_shapes.push_back(in_nd->shape().data());
-    in_dims.push_back(in_nd->shape().ndim());
-    in_types.push_back(in_nd->dtype());
-    in_verIDs.push_back(in_nd->version());
-    // string repr of supported context for custom library, currently only "cpu" and "gpu"
-    const char* ctx_str = in_nd->ctx().dev_mask() == Context::kCPU ? "cpu" : "gpu";
-    in_dev_type.push_back(ctx_str);
-
-    in_dev_id.push_back(in_nd->ctx().real_dev_id());
-    if (inputs[i].storage_type() == mxnet::kRowSparseStorage) {
-      in_stypes[i]         = 1;
-      in_indices[i]        = inputs[i].aux_data(rowsparse::kIdx).dptr_;
-      in_indices_shapes[i] = inputs[i].aux_shape(rowsparse::kIdx).Size();
-    } else if (inputs[i].storage_type() == mxnet::kCSRStorage) {
-      in_stypes[i]         = 2;
-      in_indices[i]        = inputs[i].aux_data(csr::kIdx).dptr_;
-      in_indptr[i]         = inputs[i].aux_data(csr::kIndPtr).dptr_;
-      in_indices_shapes[i] = inputs[i].aux_shape(csr::kIdx).Size();
-      in_indptr_shapes[i]  = inputs[i].aux_shape(csr::kIndPtr).Size();
+      // pull out parts to pass over to library
+      in_data.push_back(in_nd->data().dptr_);
+      in_shapes.push_back(in_nd->shape().data());
+      in_dims.push_back(in_nd->shape().ndim());
+      in_types.push_back(in_nd->dtype());
+      in_verIDs.push_back(in_nd->version());
+      // string repr of supported context for custom library, currently only "cpu" and "gpu"
+      const char* ctx_str = in_nd->ctx().dev_mask() == Context::kCPU ? "cpu" : "gpu";
+      in_dev_type.push_back(ctx_str);
+
+      in_dev_id.push_back(in_nd->ctx().real_dev_id());
+      if (inputs[i].storage_type() == mxnet::kRowSparseStorage) {
+        in_stypes[i]         = 1;
+        in_indices[i]        = inputs[i].aux_data(rowsparse::kIdx).dptr_;
+        in_indices_shapes[i] = inputs[i].aux_shape(rowsparse::kIdx).Size();
+      } else if (inputs[i].storage_type() == mxnet::kCSRStorage) {
+        in_stypes[i]         = 2;
+        in_indices[i]        = inputs[i].aux_data(csr::kIdx).dptr_;
+        in_indptr[i]         = inputs[i].aux_data(csr::kIndPtr).dptr_;
+        in_indices_shapes[i] = inputs[i].aux_shape(csr::kIdx).Size();
+        in_indptr_shapes[i]  = inputs[i].aux_shape(csr::kIndPtr).Size();
+      }
     }
-  }
 
-  for (size_t i = 0; i < outputs.size(); i++) {
-    out_data.push_back(outputs[i].data().dptr_);
-    out_shapes.push_back(outputs[i].shape().data());
-    out_dims.push_back(outputs[i].shape().ndim());
-    out_types.push_back(outputs[i].dtype());
-    out_verIDs.push_back(outputs[i].version());
-    const char* ctx_str = outputs[i].ctx().dev_mask() == Context::kCPU ? "cpu" : "gpu";
-    out_dev_type.push_back(ctx_str);
-    out_dev_id.push_back(outputs[i].ctx().real_dev_id());
-
-    if (outputs[i].storage_type() == mxnet::kRowSparseStorage) {
-      out_stypes[i]         = 1;
-      out_indices[i]        = outputs[i].aux_data(rowsparse::kIdx).dptr_;
-      out_indices_shapes[i] = outputs[i].aux_shape(rowsparse::kIdx).Size();
-    } else if (outputs[i].storage_type() == mxnet::kCSRStorage) {
-      out_stypes[i]         = 2;
-      out_indices[i]        = outputs[i].aux_data(csr::kIdx).dptr_;
-      out_indptr[i]         = outputs[i].aux_data(csr::kIndPtr).dptr_;
-      out_indices_shapes[i] = outputs[i].aux_shape(csr::kIdx).Size();
-      out_indptr_shapes[i]  = outputs[i].aux_shape(csr::kIndPtr).Size();
+    for (size_t i = 0; i < outputs.size(); i++) {
+      out_data.push_back(outputs[i].data().dptr_);
+      out_shapes.push_back(outputs[i].shape().data());
+      out_dims.push_back(outputs[i].shape().ndim());
+      out_types.push_back(outputs[i].dtype());
+      out_verIDs.push_back(outputs[i].version());
+      const char* ctx_str = outputs[i].ctx().dev_mask() == Context::kCPU ? "cpu" : "gpu";
+      out_dev_type.push_back(ctx_str);
+      out_dev_id.push_back(outputs[i].ctx().real_dev_id());
+
+      if (outputs[i].storage_type() == mxnet::kRowSparseStorage) {
+        out_stypes[i]         = 1;
+        out_indices[i]        = outputs[i].aux_data(rowsparse::kIdx).dptr_;
+        out_indices_shapes[i] = outputs[i].aux_shape(rowsparse::kIdx).Size();
+      } else if (outputs[i].storage_type() == mxnet::kCSRStorage) {
+        out_stypes[i]         = 2;
+        out_indices[i]        = outputs[i].aux_data(csr::kIdx).dptr_;
+        out_indptr[i]         = outputs[i].aux_data(csr::kIndPtr).dptr_;
+        out_indices_shapes[i] = outputs[i].aux_shape(csr::kIdx).Size();
+        out_indptr_shapes[i]  = outputs[i].aux_shape(csr::kIndPtr).Size();
+      }
     }
   }
 
@@ -377,7 +438,30 @@ void CustomFComputeDispatcher(const std::string op_name,
     CHECK(retval) << "Error calling FCompute for custom operator '" << op_name << "'" << msgs;
   }
 
-  if (state_ptr != nullptr) {
+  if (fast_compute) {
+    static thread_local std::vector<MXTensorView> in_views, out_views;
+    CustomStatefulOpWrapper& op = state_ptr->get_state<CustomStatefulOpWrapper>();
+
+    int retval = callFStatefulCompFast(stateful_forward_flag,
+                                       op.get_instance(),
+                                       FillTensorViews(inputs, &in_views),
+                                       inputs.size(),
+                                       FillTensorViews(outputs, &out_views),
+                                       outputs.size(),
+                                       cpu_malloc,
+                                       &cpu_alloc,
+                                       gpu_malloc,
+                                       &gpu_alloc,
+                                       cuda_stream,
+                                       sparse_malloc,
+                                       &sparse_alloc,
+                                       rng_cpu_states,
+                                       rng_gpu_states);
+    if (!retval) {
+      LOG(FATAL) << "Error calling FStatefulComputeFast for custom operator '" << op_name << "'"
+                 << getExtensionMsgs(msgSize, msgGet);
+    }
+  } else if (state_ptr != nullptr) {
     // retrieve op state object created from CreateOpState
     CustomStatefulOpWrapper& op     = state_ptr->get_state<CustomStatefulOpWrapper>();
     CustomStatefulOp* state_op_inst = op.get_instance();
@@ -468,6 +552,7 @@ void registerOp(const char* name,
                 const std::unordered_map<std::string, mxnet::ext::fcomp_t>& backward_ctx_map,
                 mxnet::ext::opCallFComp_t callFComp,
                 mxnet::ext::opCallFStatefulComp_t callFStatefulComp,
+                mxnet::ext::opCallFStatefulCompFast_t callFStatefulCompFast,
                 mxnet::ext::msgSize_t msgSize,
                 mxnet::ext::msgGet_t msgGet) {
   using namespace mxnet::ext;
@@ -504,27 +589,49 @@ void registerOp(const char* name,
     regOp.set_attr<FInferStorageType>("FInferStorageType", infer_subgraph_storage_type, plevel);
     regOp.set_attr<nnvm::FMutateInputs>("FMutateInputs", DefaultSubgraphOpMutableInputs, plevel);
   }
+  // stateful ops of libraries may run asynchronously, on the workers of the custom operators,
+  // so that a slow operator does not hold an engine thread (MXNET_CUSTOM_OP_ASYNC)
+  static const bool async_stateful = dmlc::GetEnv("MXNET_CUSTOM_OP_ASYNC", false);
+  auto run_stateful = [](const std::function<void(void)>& func, const OpContext& ctx) {
+    if (!async_stateful) {
+      func();
+    } else if (ctx.run_ctx.ctx.dev_mask() == Context::kCPU) {
+      mxnet::op::custom::CustomOperator::Get()->PushNative(func, ctx);
+    } else {
+      // kernels are enqueued on the stream of the engine thread
+      func();
+      ctx.async_on_complete();
+    }
+  };
+  auto async_exec_type = [](const nnvm::NodeAttrs& attrs) { return ExecType::kAsync; };
   // optionally add stateful forward
   if (createop_map.size() != 0) {
     regOp.set_attr<FCreateOpState>("FCreateOpState", create_opstate, plevel);
+    if (async_stateful)
+      regOp.set_attr<FExecType>("FExecType", async_exec_type, plevel);
     auto fstate_forward = [=](const OpStatePtr& state_ptr,
                               const OpContext& ctx,
                               const std::vector<NDArray>& inputs,
                               const std::vector<OpReqType>& req,
                               const std::vector<NDArray>& outputs) {
-      CustomFComputeDispatcher(name_str,
-                               nullptr,
-                               nullptr,
-                               nullptr,
-                               callFStatefulComp,
-                               1,
-                               &state_ptr,
-                               ctx,
-                               inputs,
-                               req,
-                               outputs,
-                               msgSize,
-                               msgGet);
+      run_stateful(
+          [=]() {
+            CustomFComputeDispatcher(name_str,
+                                     nullptr,
+                                     nullptr,
+                                     nullptr,
+                                     callFStatefulComp,
+                                     callFStatefulCompFast,
+                                     1,
+                                     &state_ptr,
+                                     ctx,
+                                     inputs,
+                                     req,
+                                     outputs,
+                                     msgSize,
+                                     msgGet);
+          },
+          ctx);
     };
     if (createop_map.count("cpu") > 0)
       regOp.set_attr<FStatefulComputeEx>("FStatefulComputeEx<cpu>", fstate_forward, plevel);
@@ -544,6 +651,7 @@ void registerOp(const char* name,
                                  fcomp,
                                  &attrs,
                                  nullptr,
+                                 nullptr,
                                  0,
                                  nullptr,
                                  ctx,
@@ -560,6 +668,7 @@ void registerOp(const char* name,
                                  fcomp,
                                  &attrs,
                                  nullptr,
+                                 nullptr,
                                  0,
                                  nullptr,
                                  ctx,
@@ -605,24 +714,31 @@ void registerOp(const char* name,
     if (createop_map.size() != 0) {
       // for stateful operators
       gradOp.set_attr<bool>("TIsLayerOpBackward", true, plevel);
+      if (async_stateful)
+        gradOp.set_attr<FExecType>("FExecType", async_exec_type, plevel);
       auto fstate_backward = [=](const OpStatePtr& state_ptr,
                                  const OpContext& ctx,
                                  const std::vector<NDArray>& inputs,
                                  const std::vector<OpReqType>& req,
                                  const std::vector<NDArray>& outputs) {
-        CustomFComputeDispatcher(name_str,
-                                 nullptr,
-                                 nullptr,
-                                 nullptr,
-                                 callFStatefulComp,
-                                 0,
-                                 &state_ptr,
-                                 ctx,
-                                 inputs,
-                                 req,
-                                 outputs,
-                                 msgSize,
-                                 msgGet);
+        run_stateful(
+            [=]() {
+              CustomFComputeDispatcher(name_str,
+                                       nullptr,
+                                       nullptr,
+                                       nullptr,
+                                       callFStatefulComp,
+                                       callFStatefulCompFast,
+                                       0,
+                                       &state_ptr,
+                                       ctx,
+                                       inputs,
+                                       req,
+                                       outputs,
+                                       msgSize,
+                                       msgGet);
+            },
+            ctx);
       };
       gradOp.set_attr<FStatefulComputeEx>("FStatefulComputeEx<cpu>", fstate_backward, plevel);
       gradOp.set_attr<FStatefulComputeEx>("FStatefulComputeEx<gpu>", fstate_backward, plevel);
@@ -640,6 +756,7 @@ void registerOp(const char* name,
                                    fcomp_back_cpu,
                                    &attrs,
                                    nullptr,
+                                   nullptr,
                                    0,
                                    nullptr,
                                    ctx,
@@ -663,6 +780,7 @@ void registerOp(const char* name,
                                    fcomp_back_gpu,
                                    &attrs,
                                    nullptr,
+                                   nullptr,
                                    0,
                                    nullptr,
                                    ctx,
@@ -714,6 +832,9 @@ void registerOperators(void* lib,
   opCallFStatefulComp_t callFStatefulComp =
       get_func<opCallFStatefulComp_t>(lib, const_cast<char*>(MXLIB_OPCALLFSTATEFULCOMP_STR));
 
+  opCallFStatefulCompFast_t callFStatefulCompFast = get_func<opCallFStatefulCompFast_t>(
+      lib, const_cast<char*>(MXLIB_OPCALLFSTATEFULCOMPFAST_STR));
+
   // get number of operators registered in the library
   opRegSize_t opRegSize = get_func<opRegSize_t>(lib, const_cast<char*>(MXLIB_OPREGSIZE_STR));
   int numOps            = opRegSize();
@@ -1346,6 +1467,7 @@ void registerOperators(void* lib,
       // only create one stateful op depending on passing context
       // user can add new supported context and call to custom library
       void* state_op_inst = nullptr;
+      int fast_compute    = 0;
       if (ctx.dev_mask() == Context::kCPU) {
         CHECK(createop_map.count("cpu") > 0)
             << "CPU CreateOpState not implemented for '" << name_str << "'";
@@ -1359,7 +1481,8 @@ void registerOperators(void* lib,
                                        indims.data(),
                                        in_shapes.size(),
                                        in_types.data(),
-                                       &state_op_inst);
+                                       &state_op_inst,
+                                       &fast_compute);
         std::string msgs = getExtensionMsgs(msgSize, msgGet);
         CHECK(retval) << "Error calling CreateOpState CPU for custom operator '" << name_str << "'"
                       << msgs;
@@ -1376,7 +1499,8 @@ void registerOperators(void* lib,
                                        indims.data(),
                                        in_shapes.size(),
                                        in_types.data(),
-                                       &state_op_inst);
+                                       &state_op_inst,
+                                       &fast_compute);
         std::string msgs = getExtensionMsgs(msgSize, msgGet);
         CHECK(retval) << "Error calling CreateOpState GPU for custom operator '" << name_str << "'"
                       << msgs;
@@ -1393,7 +1517,8 @@ void registerOperators(void* lib,
                   << "allocated with 'new' since it will be destructed with 'delete'. "
                   << "To suppress this message without calling CustomStatefulOp::create() "
                   << "set ignore_warn to 'true' on custom stateful op instance.";
-      return OpStatePtr::Create<CustomStatefulOpWrapper>(state_op, callDestroyOpState);
+      return OpStatePtr::Create<CustomStatefulOpWrapper>(
+          state_op, callDestroyOpState, fast_compute != 0);
     };
 
     /* -------------- BELOW IS THE REGISTRATION FOR CUSTOM OPERATORS --------------- */
@@ -1422,6 +1547,7 @@ void registerOperators(void* lib,
                backward_ctx_map,
                callFComp,
                callFStatefulComp,
+               callFStatefulCompFast,
                msgSize,
                msgGet);
   }
@@ -1930,6 +2056,53 @@ int MXEngineSetBulkSize(int bulk_size, int* prev_bulk_size) {
   API_END();
 }
 
+int MXEngineCreateStream(int dev_type, int dev_id, const char* name, int priority, int* out) {
+  API_BEGIN();
+  const Context ctx = Context::Create(static_cast<Context::DeviceType>(dev_type), dev_id);
+  *out              = Engine::Get()->CreateStream(ctx, name, priority);
+  API_END();
+}
+
+int MXEngineSetStream(int stream, int* prev_stream) {
+  API_BEGIN();
+  *prev_stream = Engine::Get()->set_stream(stream);
+  API_END();
+}
+
+int MXCudnnPlanCacheSave(const char* fname, uint32_t* num_plans) {
+  API_BEGIN();
+#if MXNET_USE_CUDNN == 1
+  *num_plans = op::cudnn::SavePlanCache(fname);
+#else
+  *num_plans = 0;
+#endif
+  API_END();
+}
+
+int MXCudnnPlanCacheLoad(const char* fname, uint32_t* num_plans) {
+  API_BEGIN();
+#if MXNET_USE_CUDNN == 1
+  *num_plans = op::cudnn::LoadPlanCache(fname);
+#else
+  *num_plans = 0;
+#endif
+  API_END();
+}
+
+int MXEngineGetStats(const char** out_str, int reset) {
+  MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
+  API_BEGIN();
+  CHECK_NOTNULL(out_str);
+  engine::EngineStats* stats = engine::EngineStats::Get();
+  std::ostringstream os;
+  stats->DumpJson(os);
+  if (reset != 0)
+    stats->Reset();
+  ret->ret_str = os.str();
+  *out_str     = (ret->ret_str).c_str();
+  API_END();
+}
+
 int MXGetGPUCount(int* out) {
   API_BEGIN();
   *out = Context::GetGPUCount();
@@ -1987,6 +2160,12 @@ int MXLoadTVMOp(const char* libpath) {
   API_END();
 }
 
+int MXLoadTVMTunedKernels(const char* libpath, const char* manifest_path) {
+  API_BEGIN();
+  tvm::runtime::TunedKernels::Get()->Load(libpath, manifest_path);
+  API_END();
+}
+
 int MXLoadTVMConfig(ConfigSpaces config) {
   API_BEGIN();
   for (int k = 0; k < config.spaces_size; ++k) {
@@ -2233,6 +2412,38 @@ int MXNDArrayWaitAll() {
   API_END();
 }
 
+int MXNDArrayNotifyReady(uint32_t num_arrays,
+                         NDArrayHandle* handles,
+                         NDArrayReadyCallback callback,
+                         void* param) {
+  API_BEGIN();
+  std::vector<Engine::VarHandle> vars;
+  vars.reserve(num_arrays);
+  for (uint32_t i = 0; i < num_arrays; ++i)
+    vars.push_back(static_cast<NDArray*>(handles[i])->var());
+  std::sort(vars.begin(), vars.end());
+  vars.erase(std::unique(vars.begin(), vars.end()), vars.end());
+  // not skipped when a write failed, so that the callback is always called
+  Engine::Get()->PushSync(
+      [vars, callback, param](RunContext) {
+        try {
+          for (const auto& var : vars)
+            Engine::Get()->Throw(var);
+        } catch (const std::exception& e) {
+          callback(e.what(), param);
+          return;
+        }
+        callback(nullptr, param);
+      },
+      Context::CPU(),
+      vars,
+      {},
+      FnProperty::kNoSkip,
+      0,
+      "NotifyReady");
+  API_END();
+}
+
 int MXNDArrayLegacySave(const char* fname,
                         uint32_t num_args,
                         NDArrayHandle* args,
@@ -2337,11 +2548,29 @@ int MXNDArrayLoad(const char* fname,
     *out_arr       = dmlc::BeginPtr(ret->ret_handles);
     *out_name_size = static_cast<uint32_t>(names.size());
     *out_names     = dmlc::BeginPtr(ret->ret_vec_charp);
+  } else if (magic == mapped_params::kMappedParamsMagic ||
+             magic == sharded_params::kShardedParamsMagic) {
+    auto [data, names] = magic == sharded_params::kShardedParamsMagic ?  // NOLINT
+                             sharded_params::load_arrays(fname) :
+                             mapped_params::load_arrays(fname, Context::CPU());
+    ret->ret_handles.resize(data.size());
+    for (size_t i = 0; i < data.size(); ++i) {
+      ret->ret_handles[i] = new NDArray(data[i]);
+    }
+    ret->ret_vec_str = std::move(names);
+    ret->ret_vec_charp.resize(ret->ret_vec_str.size());
+    for (size_t i = 0; i < ret->ret_vec_str.size(); ++i) {
+      ret->ret_vec_charp[i] = ret->ret_vec_str[i].c_str();
+    }
+    *out_size      = static_cast<uint32_t>(data.size());
+    *out_arr       = dmlc::BeginPtr(ret->ret_handles);
+    *out_name_size = static_cast<uint32_t>(ret->ret_vec_str.size());
+    *out_names     = dmlc::BeginPtr(ret->ret_vec_charp);
   } else if (magic == 0x4d554e93 || magic == 0x934e554d) {  // first bytes of npy format
     *out_size = 1;
     ret->ret_handles.resize(1);
     NDArray* ptr = new NDArray();
-    *ptr         = npy::load_array(fname);  // Only supports local filesystem at this point in time
+    *ptr         = npy::load_array(fname);
     ret->ret_handles[0] = ptr;
     *out_arr            = dmlc::BeginPtr(ret->ret_handles);
   } else {
@@ -2369,6 +2598,116 @@ int MXNDArrayLoad(const char* fname,
   API_END();
 }
 
+int MXNDArraySaveMapped(const char* fname,
+                        uint32_t num_args,
+                        NDArrayHandle* args,
+                        const char** keys) {
+  API_BEGIN();
+  std::vector<NDArray> data(num_args);
+  std::vector<std::string> names;
+  for (uint32_t i = 0; i < num_args; ++i) {
+    data[i] = *static_cast<NDArray*>(args[i]);
+  }
+  if (keys != nullptr) {
+    names.resize(num_args);
+    for (uint32_t i = 0; i < num_args; ++i) {
+      names[i] = keys[i];
+    }
+  }
+  mapped_params::save_arrays(fname, data, names);
+  API_END();
+}
+
+int MXNDArraySaveSharded(const char* fname,
+                         uint32_t num_shards,
+                         uint32_t num_args,
+                         NDArrayHandle* args,
+                         const char** keys) {
+  API_BEGIN();
+  std::vector<NDArray> data(num_args);
+  std::vector<std::string> names;
+  for (uint32_t i = 0; i < num_args; ++i) {
+    data[i] = *static_cast<NDArray*>(args[i]);
+  }
+  if (keys != nullptr) {
+    names.resize(num_args);
+    for (uint32_t i = 0; i < num_args; ++i) {
+      names[i] = keys[i];
+    }
+  }
+  sharded_params::save_arrays(fname, data, names, num_shards);
+  API_END();
+}
+
+int MXNDArrayLoadMapped(const char* fname,
+                        int dev_type,
+                        int dev_id,
+                        uint32_t* out_size,
+                        NDArrayHandle** out_arr,
+                        uint32_t* out_name_size,
+                        const char*** out_names) {
+  MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
+  ret->ret_vec_str.clear();
+  API_BEGIN();
+  const Context ctx  = Context::Create(static_cast<Context::DeviceType>(dev_type), dev_id);
+  auto [data, names] = mapped_params::load_arrays(fname, ctx);  // NOLINT
+  ret->ret_handles.resize(data.size());
+  for (size_t i = 0; i < data.size(); ++i) {
+    ret->ret_handles[i] = new NDArray(data[i]);
+  }
+  ret->ret_vec_str = std::move(names);
+  ret->ret_vec_charp.resize(ret->ret_vec_str.size());
+  for (size_t i = 0; i < ret->ret_vec_str.size(); ++i) {
+    ret->ret_vec_charp[i] = ret->ret_vec_str[i].c_str();
+  }
+  *out_size      = static_cast<uint32_t>(data.size());
+  *out_arr       = dmlc::BeginPtr(ret->ret_handles);
+  *out_name_size = static_cast<uint32_t>(ret->ret_vec_str.size());
+  *out_names     = dmlc::BeginPtr(ret->ret_vec_charp);
+  API_END();
+}
+
+int MXNDArraySaveAsync(const char* fname,
+                       uint32_t num_args,
+                       NDArrayHandle* args,
+                       const char** keys,
+                       int mapped,
+                       uint32_t num_shards,
+                       CheckpointHandle* out) {
+  API_BEGIN();
+  std::vector<NDArray> data(num_args);
+  std::vector<std::string> names;
+  for (uint32_t i = 0; i < num_args; ++i) {
+    data[i] = *static_cast<NDArray*>(args[i]);
+  }
+  if (keys != nullptr) {
+    names.resize(num_args);
+    for (uint32_t i = 0; i < num_args; ++i) {
+      names[i] = keys[i];
+    }
+  }
+  *out = new AsyncCheckpoint(fname, data, names, mapped != 0, num_shards);
+  API_END();
+}
+
+int MXCheckpointIsDone(CheckpointHandle handle, int* out) {
+  API_BEGIN();
+  *out = static_cast<AsyncCheckpoint*>(handle)->Done();
+  API_END();
+}
+
+int MXCheckpointWait(CheckpointHandle handle) {
+  API_BEGIN();
+  static_cast<AsyncCheckpoint*>(handle)->Wait();
+  API_END();
+}
+
+int MXCheckpointFree(CheckpointHandle handle) {
+  API_BEGIN();
+  delete static_cast<AsyncCheckpoint*>(handle);
+  API_END();
+}
+
 int MXNDArrayLoadFromBuffer(const void* ndarray_buffer,
                             size_t size,
                             uint32_t* out_size,
@@ -2590,6 +2929,13 @@ int MXNDArrayToDLPack(NDArrayHandle handle, DLManagedTensorHandle* out_dlpack) {
   API_END();
 }
 
+int MXNDArrayAuxToDLPack(NDArrayHandle handle, uint32_t i, DLManagedTensorHandle* out_dlpack) {
+  API_BEGIN();
+  NDArray* arr = static_cast<NDArray*>(handle);
+  *out_dlpack  = arr->AuxToDLPack(i);
+  API_END();
+}
+
 int MXNDArrayFromDLPack(DLManagedTensorHandle dlpack,
                         const bool transient_handle,
                         NDArrayHandle* out_handle) {
@@ -2599,6 +2945,27 @@ int MXNDArrayFromDLPack(DLManagedTensorHandle dlpack,
   API_END();
 }
 
+int MXNDArrayFromDLPackSparse(int storage_type,
+                              const int64_t* shape,
+                              int ndim,
+                              DLManagedTensorHandle data,
+                              uint32_t num_aux,
+                              DLManagedTensorHandle* aux_data,
+                              const bool transient_handle,
+                              NDArrayHandle* out_handle) {
+  API_BEGIN();
+  std::vector<const DLManagedTensor*> aux(num_aux);
+  for (uint32_t i = 0; i < num_aux; ++i) {
+    aux[i] = static_cast<DLManagedTensor*>(aux_data[i]);
+  }
+  *out_handle = new NDArray(NDArray::FromDLPack(static_cast<NDArrayStorageType>(storage_type),
+                                                mxnet::TShape(shape, shape + ndim),
+                                                static_cast<DLManagedTensor*>(data),
+                                                aux,
+                                                transient_handle));
+  API_END();
+}
+
 int MXNDArrayCallDLPackDeleter(DLManagedTensorHandle dlpack) {
   API_BEGIN();
   if (dlpack != nullptr) {
@@ -3762,6 +4129,49 @@ int MXNDArrayGetSharedMemHandle(NDArrayHandle handle, int* shared_pid, int* shar
   API_END();
 }
 
+int MXNDArrayGetCudaIpcHandle(NDArrayHandle handle, void* ipc_handle, uint64_t* offset) {
+  API_BEGIN();
+#if MXNET_USE_CUDA
+  NDArray* arr = reinterpret_cast<NDArray*>(handle);
+  CHECK_EQ(arr->ctx().dev_mask(), gpu::kDevMask) << "Only NDArrays on a GPU have a CUDA IPC handle";
+  // other processes read the array without syncing with this one
+  arr->WaitToRead();
+  const Storage::Handle shandle = arr->storage_handle();
+  const cudaIpcMemHandle_t ipc  = storage::CudaIpcExport(shandle.dptr, shandle.ctx.real_dev_id());
+  static_assert(sizeof(ipc) == 64, "CUDA IPC handles are 64 bytes");
+  std::memcpy(ipc_handle, &ipc, sizeof(ipc));
+  *offset = static_cast<char*>(arr->data().dptr_) - static_cast<char*>(shandle.dptr);
+#else
+  LOG(FATAL) << "GPU is not enabled.";
+#endif
+  API_END();
+}
+
+int MXNDArrayCreateFromCudaIpcHandle(const void* ipc_handle,
+                                     uint64_t offset,
+                                     const int64_t* shape,
+                                     int ndim,
+                                     int dtype,
+                                     int dev_id,
+                                     NDArrayHandle* out) {
+  API_BEGIN();
+#if MXNET_USE_CUDA
+  cudaIpcMemHandle_t ipc;
+  std::memcpy(&ipc, ipc_handle, sizeof(ipc));
+  std::shared_ptr<void> base = storage::CudaIpcImport(ipc, dev_id);
+  const TBlob data(static_cast<char*>(base.get()) + offset,
+                   mxnet::TShape(shape, shape + ndim),
+                   gpu::kDevMask,
+                   dtype,
+                   dev_id);
+  // every array holds the mapping, which is released with the last one
+  *out = new NDArray(data, dev_id, [base]() {});
+#else
+  LOG(FATAL) << "GPU is not enabled.";
+#endif
+  API_END();
+}
+
 int MXNDArrayCreateFromSharedMem(int shared_pid,
                                  int shared_id,
                                  const int* shape,
@@ -3951,6 +4361,22 @@ int MXStorageEmptyCache(int dev_type, int dev_id) {
   API_END();
 }
 
+int MXStorageSetBudget(int dev_type, int dev_id, uint64_t bytes) {
+  API_BEGIN();
+  Context ctx = Context::Create(static_cast<Context::DeviceType>(dev_type), dev_id);
+  Storage::Get()->SetBudget(ctx, static_cast<size_t>(bytes));
+  API_END();
+}
+
+int MXStorageGetStats(const char** out_str) {
+  MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
+  API_BEGIN();
+  CHECK_NOTNULL(out_str);
+  ret->ret_str = Storage::Get()->GetStats();
+  *out_str     = (ret->ret_str).c_str();
+  API_END();
+}
+
 int MXShallowCopyNDArray(NDArrayHandle src_handle, NDArrayHandle* out) {
   NDArray* ret = nullptr;
   API_BEGIN();
@@ -3960,18 +4386,17 @@ int MXShallowCopyNDArray(NDArrayHandle src_handle, NDArrayHandle* out) {
   API_END_HANDLE_ERROR(delete ret);
 }
 
-int MXPushStreamDep(NDArrayHandle handle, int stream) {
+int MXPushStreamDep(NDArrayHandle handle, int64_t stream) {
   API_BEGIN();
   static_cast<NDArray*>(handle)->StreamSync(stream);
   API_END();
 }
 
-int MXGetCurrentStream(int device_id, int* stream) {
+int MXGetCurrentStream(int device_id, int64_t* stream) {
   API_BEGIN();
 #if MXNET_USE_CUDA
-  RunContext rctx{Context::GPU(device_id), new mshadow::Stream<gpu>(), nullptr};
-  mshadow::Stream<gpu>* cur_stream = rctx.get_stream<gpu>();
-  *stream = reinterpret_cast<int64_t>(mshadow::Stream<gpu>::GetStream(cur_stream));
+  // the streams of the engine are blocking streams, which wait for the legacy default stream
+  *stream = 1;
 #else
   LOG(FATAL) << "GPU is not enabled.";
 #endif
@@ -30,12 +30,14 @@
 #include <mxnet/imperative.h>
 #include <nnvm/node.h>
 #include <nnvm/op_attr_types.h>
+#include <memory>
 #include <string>
 #include "./c_api_common.h"
 #include "../common/utils.h"
 #include "../common/exec_utils.h"
 #include "../imperative/imperative_utils.h"
 #include "../imperative/cached_op.h"
+#include "../imperative/cached_op_batcher.h"
 #include "../imperative/cached_op_threadsafe.h"
 #include "../profiler/profiler.h"
 
@@ -168,6 +170,134 @@ int MXImperativeInvoke(AtomicSymbolCreator creator,
   API_END();
 }
 
+/*! \brief Op with parsed attributes, invoked by MXImperativeInvokePrepared */
+struct PreparedOp {
+  nnvm::NodeAttrs attrs;
+  int num_inputs;
+  int infered_num_outputs;
+  int num_visible_outputs;
+};
+
+void MXImperativeInvokePreparedImpl(PreparedOp* prepared,
+                                    int num_inputs,
+                                    NDArrayHandle* inputs,
+                                    int* num_outputs,
+                                    NDArrayHandle** outputs) {
+  CHECK_EQ(num_inputs, prepared->num_inputs)
+      << "Operator " << prepared->attrs.op->name << " was prepared for " << prepared->num_inputs
+      << " inputs, but got " << num_inputs << " instead.";
+  nnvm::NodeAttrs& attrs   = prepared->attrs;
+  const std::string& scope = profiler::ProfilerScope::Get()->GetCurrentProfilerScope();
+  std::string& attrs_scope = attrs.dict["__profiler_scope__"];
+  if (attrs_scope != scope)
+    attrs_scope = scope;
+
+  std::vector<NDArray*> ndinputs, ndoutputs;
+  SetNDInputsOutputs(attrs.op,
+                     &ndinputs,
+                     &ndoutputs,
+                     num_inputs,
+                     inputs,
+                     num_outputs,
+                     prepared->infered_num_outputs,
+                     prepared->num_visible_outputs,
+                     outputs);
+
+  // the attributes are only copied for the ops which are recorded
+  if (Imperative::Get()->is_deferred_compute()) {
+    Imperative::Get()->RecordDeferredCompute(nnvm::NodeAttrs(attrs), ndinputs, ndoutputs);
+  } else {
+    for (NDArray* input : ndinputs) {
+      Imperative::DCInfo::Compute(*input);
+    }
+    auto state = Imperative::Get()->Invoke(Context::CPU(), attrs, ndinputs, ndoutputs);
+    if (Imperative::Get()->is_recording()) {
+      Imperative::Get()->RecordOp(nnvm::NodeAttrs(attrs), ndinputs, ndoutputs, state);
+    }
+  }
+
+  for (int i = *num_outputs; i < prepared->infered_num_outputs; ++i)
+    delete ndoutputs[i];
+
+  if (*outputs == nullptr) {
+    MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
+    ret->ret_handles.clear();
+    ret->ret_handles.reserve(*num_outputs);
+    for (int i = 0; i < *num_outputs; ++i)
+      ret->ret_handles.push_back(ndoutputs[i]);
+    *outputs = reinterpret_cast<NDArrayHandle*>(dmlc::BeginPtr(ret->ret_handles));
+  }
+}
+
+int MXImperativePrepare(AtomicSymbolCreator creator,
+                        int num_inputs,
+                        int num_params,
+                        const char** param_keys,
+                        const char** param_vals,
+                        PreparedOpHandle* out) {
+  API_BEGIN();
+  const nnvm::Op* op = static_cast<nnvm::Op*>(creator);
+  std::unique_ptr<PreparedOp> prepared(new PreparedOp());
+  prepared->attrs = imperative::ParseAttrs(op, num_inputs, num_params, param_keys, param_vals);
+
+  prepared->attrs.name = op->name;
+  prepared->num_inputs = num_inputs;
+  imperative::SetNumOutputs(op,
+                            prepared->attrs,
+                            num_inputs,
+                            &prepared->infered_num_outputs,
+                            &prepared->num_visible_outputs);
+  *out = prepared.release();
+  API_END();
+}
+
+int MXImperativeInvokePrepared(PreparedOpHandle handle,
+                               int num_inputs,
+                               NDArrayHandle* inputs,
+                               int* num_outputs,
+                               NDArrayHandle** outputs,
+                               const int** out_stypes) {
+  MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
+  API_BEGIN();
+  MXImperativeInvokePreparedImpl(
+      static_cast<PreparedOp*>(handle), num_inputs, inputs, num_outputs, outputs);
+  if (out_stypes != nullptr) {
+    NDArray** out_array = *reinterpret_cast<NDArray***>(outputs);
+    ret->out_types.clear();
+    ret->out_types.reserve(*num_outputs);
+    for (int i = 0; i < *num_outputs; ++i) {
+      ret->out_types.emplace_back(out_array[i]->storage_type());
+    }
+    *out_stypes = dmlc::BeginPtr(ret->out_types);
+  }
+  API_END();
+}
+
+int MXImperativeInvokePreparedBatch(uint32_t num_ops,
+                                    PreparedOpHandle* handles,
+                                    const int* num_inputs,
+                                    NDArrayHandle* inputs,
+                                    const int* num_outputs,
+                                    NDArrayHandle* outputs) {
+  API_BEGIN();
+  CHECK(outputs != nullptr) << "The outputs of a batch of prepared ops are given by the caller";
+  for (uint32_t i = 0; i < num_ops; ++i) {
+    int op_num_outputs        = num_outputs[i];
+    NDArrayHandle* op_outputs = outputs;
+    MXImperativeInvokePreparedImpl(
+        static_cast<PreparedOp*>(handles[i]), num_inputs[i], inputs, &op_num_outputs, &op_outputs);
+    inputs += num_inputs[i];
+    outputs += num_outputs[i];
+  }
+  API_END();
+}
+
+int MXFreePreparedOp(PreparedOpHandle handle) {
+  API_BEGIN();
+  delete static_cast<PreparedOp*>(handle);
+  API_END();
+}
+
 int MXCreateCachedOp(SymbolHandle handle,
                      int num_flags,
                      const char** keys,
@@ -267,6 +397,66 @@ int MXInvokeCachedOp(CachedOpHandle handle,
   API_END();
 }
 
+int MXCreateCachedOpBatcher(CachedOpHandle handle,
+                            int num_data_indices,
+                            const int* data_indices,
+                            int max_batch_size,
+                            int timeout_us,
+                            int dev_type,
+                            int dev_id,
+                            CachedOpBatcherHandle* out) {
+  API_BEGIN();
+  CachedOpPtr op = *static_cast<CachedOpPtr*>(handle);
+  CHECK_GT(max_batch_size, 0) << "max_batch_size of CachedOpBatcher must be positive";
+  CHECK_GE(timeout_us, 0) << "timeout_us of CachedOpBatcher must not be negative";
+  std::vector<uint32_t> indices(data_indices, data_indices + num_data_indices);
+  Context ctx = Context::Create(static_cast<Context::DeviceType>(dev_type), dev_id);
+  *out        = new CachedOpBatcher(op, indices, max_batch_size, timeout_us, ctx);
+  API_END();
+}
+
+int MXFreeCachedOpBatcher(CachedOpBatcherHandle handle) {
+  API_BEGIN();
+  delete static_cast<CachedOpBatcher*>(handle);
+  API_END();
+}
+
+int MXInvokeCachedOpBatcher(CachedOpBatcherHandle handle,
+                            int num_inputs,
+                            NDArrayHandle* inputs,
+                            int* num_outputs,
+                            NDArrayHandle** outputs,
+                            const int** out_stypes) {
+  MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
+
+  API_BEGIN();
+  CachedOpBatcher* batcher = static_cast<CachedOpBatcher*>(handle);
+  std::vector<NDArray*> ndinputs;
+  ndinputs.reserve(num_inputs);
+  for (int i = 0; i < num_inputs; ++i) {
+    ndinputs.push_back(reinterpret_cast<NDArray*>(inputs[i]));
+  }
+  std::vector<NDArray> ndoutputs;
+  batcher->Forward(ndinputs, &ndoutputs);
+
+  *num_outputs = ndoutputs.size();
+  ret->ret_handles.clear();
+  ret->ret_handles.reserve(*num_outputs);
+  for (int i = 0; i < *num_outputs; ++i) {
+    ret->ret_handles.push_back(new NDArray(ndoutputs[i]));
+  }
+  *outputs = dmlc::BeginPtr(ret->ret_handles);
+  if (out_stypes != nullptr) {
+    ret->out_types.clear();
+    ret->out_types.reserve(*num_outputs);
+    for (int i = 0; i < *num_outputs; ++i) {
+      ret->out_types.emplace_back(ndoutputs[i].storage_type());
+    }
+    *out_stypes = dmlc::BeginPtr(ret->out_types);
+  }
+  API_END();
+}
+
 int MXAutogradIsTraining(bool* curr) {
   API_BEGIN();
   *curr = Imperative::Get()->is_training();
@@ -436,6 +626,17 @@ int MXAutogradGetSymbol(NDArrayHandle handle, SymbolHandle* out) {
   API_END();
 }
 
+int MXAutogradSetGradHook(NDArrayHandle grad,
+                          MXGradHookCallback callback,
+                          void* callback_handle) {
+  API_BEGIN();
+  Imperative::GradHook hook;
+  if (callback != nullptr)
+    hook = [callback, callback_handle]() { callback(callback_handle); };
+  Imperative::Get()->SetGradHook(*static_cast<NDArray*>(grad), std::move(hook));
+  API_END();
+}
+
 int MXCachedOpRegisterOpHook(CachedOpHandle handle,
                              CachedOpMonitorCallback callback,
                              bool monitor_all) {
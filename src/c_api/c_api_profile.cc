@@ -159,7 +159,7 @@ static PythonProfileObjects python_profile_objects;
 
 enum class ProfileProcess { kWorker, kServer };
 
-enum class PrintFormat { table, json };
+enum class PrintFormat { table, json, openmetrics };
 
 struct ProfileConfigParam : public dmlc::Parameter<ProfileConfigParam> {
   bool profile_all;
@@ -169,9 +169,14 @@ struct ProfileConfigParam : public dmlc::Parameter<ProfileConfigParam> {
   bool profile_api;
   std::string filename;
   std::string gpu_memory_profile_filename_prefix;
+  std::string memory_timeline_filename_prefix;
   bool continuous_dump;
   float dump_period;
   bool aggregate_stats;
+  int sample_period;
+  int max_pending_records;
+  bool hw_counters;
+  int step_report_period;
   int profile_process;
   DMLC_DECLARE_PARAMETER(ProfileConfigParam) {
     DMLC_DECLARE_FIELD(profile_all).set_default(false).describe("Profile all. Default is False.");
@@ -187,12 +192,21 @@ struct ProfileConfigParam : public dmlc::Parameter<ProfileConfigParam> {
     DMLC_DECLARE_FIELD(profile_api).set_default(true).describe("Profile C API.  Default is True.");
     DMLC_DECLARE_FIELD(filename)
         .set_default("profile.json")
-        .describe("File name to write profiling info.");
+        .describe(
+            "File name to write profiling info. When empty, the records only feed the "
+            "aggregate stats.");
 #if MXNET_USE_CUDA
     DMLC_DECLARE_FIELD(gpu_memory_profile_filename_prefix)
         .set_default("gpu_memory_profile")
         .describe("File name prefix to write GPU memory profile info.");
 #endif  // MXNET_USE_CUDA
+    DMLC_DECLARE_FIELD(memory_timeline_filename_prefix)
+        .set_default("")
+        .describe(
+            "File name prefix to write the memory timeline to, with every allocation "
+            "tagged with its node name and storage role, and the breakdown of the peak "
+            "memory usage of every device. Requires profile_memory. Default is empty, no "
+            "timeline.");
     DMLC_DECLARE_FIELD(continuous_dump)
         .set_default(true)
         .describe(
@@ -208,6 +222,31 @@ struct ProfileConfigParam : public dmlc::Parameter<ProfileConfigParam> {
         .describe(
             "Maintain aggregate stats, required for MXDumpAggregateStats.  Note that "
             "this can have a negative performance impact. Default is False.");
+    DMLC_DECLARE_FIELD(sample_period)
+        .set_default(1)
+        .set_lower_bound(1)
+        .describe(
+            "Record one operator, or one execution of a hybridized graph, out of every "
+            "sample_period pushed by each thread. Default is 1, record all of them.");
+    DMLC_DECLARE_FIELD(max_pending_records)
+        .set_default(0)
+        .set_lower_bound(0)
+        .describe(
+            "Maximum number of records of a device kept until the next dump, the ones over "
+            "it are dropped. Default is 0, no maximum.");
+    DMLC_DECLARE_FIELD(hw_counters)
+        .set_default(false)
+        .describe(
+            "Record the cycles, instructions and last level cache misses of every CPU "
+            "operator in the args of its trace event, through perf_event_open on Linux. "
+            "Default is False.");
+    DMLC_DECLARE_FIELD(step_report_period)
+        .set_default(0)
+        .set_lower_bound(0)
+        .describe(
+            "Break the wall time of every step_report_period training steps, marked with "
+            "MXProfileMarkStep, down into data loading, H2D copy, forward, backward, kvstore, "
+            "optimizer and idle time. Default is 0, no breakdown.");
     DMLC_DECLARE_FIELD(profile_process)
         .add_enum("worker", static_cast<int>(ProfileProcess::kWorker))
         .add_enum("server", static_cast<int>(ProfileProcess::kServer))
@@ -283,7 +322,12 @@ int MXSetProcessProfilerConfig(int num_params,
                                          std::string(param.filename),
                                          param.continuous_dump,
                                          param.dump_period,
-                                         param.aggregate_stats);
+                                         param.aggregate_stats,
+                                         param.sample_period,
+                                         static_cast<size_t>(param.max_pending_records),
+                                         param.hw_counters,
+                                         param.step_report_period);
+    profiler::MemoryTimeline::Get()->SetConfig(param.memory_timeline_filename_prefix);
 #if MXNET_USE_CUDA
     profiler::GpuDeviceStorageProfiler::Get()->SetConfig(param.gpu_memory_profile_filename_prefix);
 #endif  // MXNET_USE_CUDA
@@ -315,6 +359,8 @@ int MXAggregateProfileStatsPrint(const char** out_str,
       stats->DumpTable(os, sort_by, ascending);
     else if (static_cast<PrintFormat>(format) == PrintFormat::json)
       stats->DumpJson(os, sort_by, ascending);
+    else if (static_cast<PrintFormat>(format) == PrintFormat::openmetrics)
+      stats->DumpOpenMetrics(os);
     else
       LOG(FATAL) << "Invalid value for parameter format";
   }
@@ -325,6 +371,15 @@ int MXAggregateProfileStatsPrint(const char** out_str,
   API_END();
 }
 
+int MXProfileMarkStep(const char** out_str) {
+  MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
+  API_BEGIN();
+  CHECK_NOTNULL(out_str);
+  ret->ret_str = profiler::Profiler::Get()->MarkStep();
+  *out_str     = (ret->ret_str).c_str();
+  API_END();
+}
+
 int MXDumpProfile(int finished) {
   return MXDumpProcessProfile(finished, static_cast<int>(ProfileProcess::kWorker), nullptr);
 }
@@ -342,6 +397,7 @@ int MXDumpProcessProfile(int finished, int profile_process, KVStoreHandle kvStor
     CHECK(profiler->IsEnableOutput())
         << "Profiler hasn't been run. Config and start profiler first";
     profiler->DumpProfile(finished != 0);
+    profiler::MemoryTimeline::Get()->DumpProfile();
 #if MXNET_USE_CUDA
     profiler::GpuDeviceStorageProfiler::Get()->DumpProfile();
 #endif  // MXNET_USE_CUDA
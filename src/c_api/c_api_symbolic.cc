@@ -32,6 +32,7 @@
 #include "../common/exec_utils.h"
 #include "../operator/operator_common.h"
 #include "../imperative/exec_pass.h"
+#include "../nnvm/graph_serialization.h"
 #include "../operator/subgraph/subgraph_property.h"
 
 namespace mxnet {
@@ -444,10 +445,14 @@ int MXSymbolCreateFromFile(const char* fname, SymbolHandle* out) {
   API_BEGIN();
   std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(fname, "r"));
   dmlc::istream is(fi.get());
+  std::string contents((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
   nnvm::Graph g;
-  g.attrs["json"] = std::make_shared<nnvm::any>(
-      std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>()));
-  g = nnvm::ApplyPass(g, "LoadLegacyJSON");
+  if (mxnet::IsGraphBinary(contents.data(), contents.size())) {
+    g = mxnet::LoadGraphBinary(contents.data(), contents.size());
+  } else {
+    g.attrs["json"] = std::make_shared<nnvm::any>(std::move(contents));
+    g               = nnvm::ApplyPass(g, "LoadLegacyJSON");
+  }
   ConvertShapeAttrToNumPyCompatible(&g);
   s->outputs = g.outputs;
   *out       = s;
@@ -467,6 +472,16 @@ int MXSymbolCreateFromJSON(const char* json, SymbolHandle* out) {
   API_END_HANDLE_ERROR(delete s);
 }
 
+int MXSymbolCreateFromBinary(const char* buf, size_t size, SymbolHandle* out) {
+  nnvm::Symbol* s = new nnvm::Symbol();
+  API_BEGIN();
+  nnvm::Graph g = mxnet::LoadGraphBinary(buf, size);
+  ConvertShapeAttrToNumPyCompatible(&g);
+  s->outputs = g.outputs;
+  *out       = s;
+  API_END_HANDLE_ERROR(delete s);
+}
+
 int MXSymbolRemoveAmpCast(SymbolHandle sym_handle, SymbolHandle* ret_sym_handle) {
   nnvm::Symbol* s = new nnvm::Symbol();
   API_BEGIN();
@@ -497,6 +512,25 @@ int MXSymbolSaveToJSON(SymbolHandle symbol, const char** out_json) {
   API_END();
 }
 
+int MXSymbolSaveToBinaryFile(SymbolHandle symbol, const char* fname) {
+  nnvm::Symbol* s = static_cast<nnvm::Symbol*>(symbol);
+  API_BEGIN();
+  const std::string buf = mxnet::SaveGraphBinary(Symbol2Graph(*s));
+  std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(fname, "w"));
+  fo->Write(buf.data(), buf.size());
+  API_END();
+}
+
+int MXSymbolSaveToBinary(SymbolHandle symbol, size_t* out_size, const char** out_buf) {
+  nnvm::Symbol* s              = static_cast<nnvm::Symbol*>(symbol);
+  MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
+  API_BEGIN();
+  ret->ret_str = mxnet::SaveGraphBinary(Symbol2Graph(*s));
+  *out_size    = ret->ret_str.size();
+  *out_buf     = ret->ret_str.data();
+  API_END();
+}
+
 namespace mxnet {
 
 template <typename AttrType>
@@ -1020,6 +1054,23 @@ int MXReducePrecisionSymbol(SymbolHandle sym_handle,
   g.attrs["widest_dtype_ops"] = std::make_shared<nnvm::any>(std::move(widest_dtype_ops));
   g                           = ApplyPass(std::move(g), "ReducePrecision");
 
+  // infer the types of the mixed precision graph, the ones of parameters cast offline included
+  const nnvm::IndexedGraph& lp_idx = g.indexed_graph();
+  nnvm::DTypeVector lp_arg_types(lp_idx.input_nodes().size(), -1);
+  for (size_t i = 0; i < lp_arg_types.size(); ++i) {
+    const nnvm::Node* arg = lp_idx[lp_idx.input_nodes()[i]].source;
+    auto it               = node_name_to_type_map.find(arg->attrs.name);
+    if (it != node_name_to_type_map.end() && arg->attrs.dict.count(offline_param_cast_attr_p) == 0)
+      lp_arg_types[i] = it->second;
+  }
+  g = mxnet::exec::InferType(std::move(g), std::move(lp_arg_types), "");
+  g.attrs["cast_params_offline"] = std::make_shared<nnvm::any>(cast_params_offline);
+  g.attrs["offline_param_cast_attr"] =
+      std::make_shared<nnvm::any>(std::string(offline_param_cast_attr_p));
+  g.attrs["input_names"] = std::make_shared<nnvm::any>(
+      std::unordered_set<std::string>(input_names_p, input_names_p + num_inputs));
+  g = ApplyPass(std::move(g), "OptimizeAmpCast");
+
   result_sym->outputs                      = g.outputs;
   *ret_sym_handle                          = result_sym;
   nnvm::Symbol* ret_sym                    = static_cast<nnvm::Symbol*>(*ret_sym_handle);
@@ -1264,6 +1315,8 @@ int MXOptimizeForBackend(SymbolHandle sym_handle,
     if (options_map.count("dedup_subgraph") > 0 &&
         options_map.at("dedup_subgraph").compare("True") == 0)
       g.attrs["dedup_subgraph"] = std::make_shared<nnvm::any>(std::string("True"));
+    // the partitioner reads its cost model options from the graph
+    g.attrs["options_map"] = std::make_shared<nnvm::any>(options_map);
     return g;
   };
 
@@ -1294,6 +1347,9 @@ int MXOptimizeForBackend(SymbolHandle sym_handle,
     nnvm::Graph g          = init_graph(s);
     g.attrs["options_map"] = std::make_shared<nnvm::any>(options_map);
     g.attrs["pass_name"]   = std::make_shared<nnvm::any>(backend_name);
+    // the inputs given by their shapes are data, which the passes must not take for parameters
+    g.attrs["input_shape_names"] = std::make_shared<nnvm::any>(
+        std::vector<std::string>(input_shape_names, input_shape_names + num_input_shapes));
     g                      = ApplyPass(std::move(g), backend_name);
 
     std::vector<NDArray*> new_args         = g.GetAttr<std::vector<NDArray*>>("new_args");
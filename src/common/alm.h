@@ -38,10 +38,11 @@ namespace mxnet {
 namespace alm {
 
 /*!
- *  \brief A singleton flag, set and read by MXSetOptimizeLayout and MXGetOptimizeLayout
+ *  \brief A singleton flag, set and read by MXSetOptimizeLayout and MXGetOptimizeLayout,
+ *         initialized from MXNET_OPTIMIZE_LAYOUT
  */
 struct ALMParams {
-  bool optimize = false;
+  bool optimize = dmlc::GetEnv("MXNET_OPTIMIZE_LAYOUT", false);
 
   static ALMParams& get() {
     static ALMParams alm;
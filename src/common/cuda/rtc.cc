@@ -26,6 +26,10 @@
 #include <mutex>
 #include <string>
 #include <fstream>
+#include <sstream>
+#include <iterator>
+#include <random>
+#include <cstdio>
 #include <unordered_map>
 #include <vector>
 #include <tuple>
@@ -150,6 +154,70 @@ std::string GetCompiledCode(nvrtcProgram program, bool use_cubin) {
   return ptx;
 }
 
+// FNV-1a hash, stable across processes and builds unlike std::hash.
+uint64_t StableHash(const std::string& s) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (const unsigned char c : s) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+// Path of the file caching the compiled kernel of the given key, empty if the on-disk cache
+// is disabled.
+std::string DiskCachePath(const std::string& key) {
+  static const std::string dir = dmlc::GetEnv("MXNET_RTC_CACHE_DIR", std::string());
+  if (dir.empty())
+    return "";
+  std::ostringstream os;
+  os << dir << "/mxnet_rtc_" << std::hex << StableHash(key) << ".bin";
+  return os.str();
+}
+
+// Read the mangled name and the compiled code of a kernel from the on-disk cache. The file
+// starts with the size of the full key, including the source, and the key itself, so that
+// a collision of the hashes is a miss.
+bool ReadDiskCache(const std::string& path,
+                   const std::string& key,
+                   std::string* mangled_name,
+                   std::string* code) {
+  std::ifstream f(path, std::ios::binary);
+  std::string key_size;
+  if (!f || !std::getline(f, key_size) || key_size != std::to_string(key.size()))
+    return false;
+  std::string file_key(key.size(), '\0');
+  if (!f.read(&file_key[0], file_key.size()) || file_key != key || f.get() != '\n' ||
+      !std::getline(f, *mangled_name))
+    return false;
+  code->assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+  return !code->empty();
+}
+
+// Write the kernel to the on-disk cache. The file is written under a temporary name and then
+// renamed, so that the processes sharing the cache never read a partial file.
+void WriteDiskCache(const std::string& path,
+                    const std::string& key,
+                    const std::string& mangled_name,
+                    const std::string& code) {
+  std::ostringstream tmp_path;
+  tmp_path << path << ".tmp" << std::hex << std::random_device()();
+  {
+    std::ofstream f(tmp_path.str(), std::ios::binary);
+    f << key.size() << "\n" << key << "\n" << mangled_name << "\n";
+    f.write(code.data(), code.size());
+    if (!f) {
+      LOG(WARNING) << "Could not write the compiled kernel to " << tmp_path.str()
+                   << ", check that MXNET_RTC_CACHE_DIR is a writable directory.";
+      f.close();
+      std::remove(tmp_path.str().c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_path.str().c_str(), path.c_str()) != 0)
+    std::remove(tmp_path.str().c_str());
+}
+
 std::tuple<bool, std::string> GetArchString(const int sm_arch) {
   const int sm_arch_as_used = std::min(sm_arch, GetMaxSupportedArch());
   // Always use PTX for CUDA <= 11.0
@@ -205,14 +273,7 @@ CUfunction get_function(const std::string& parameters,
                    << CACHESIZE_WARN_THRESHOLD
                    << ".  Set MXNET_RTC_SIZE_WARNING=0 to quiet this warning.";
     }
-    nvrtcProgram program;
-    NVRTC_CALL(nvrtcCreateProgram(&program,                              // prog
-                                  &code_with_header[0],                  // buffer
-                                  (kernel_name + "_kernel.cu").c_str(),  // name
-                                  0,                                     // num headers
-                                  nullptr,                               // headers
-                                  nullptr));                             // include names
-    const auto [use_cubin, gpu_arch] = GetArchString(sm_arch);           // NOLINT(*)
+    const auto [use_cubin, gpu_arch] = GetArchString(sm_arch);  // NOLINT(*)
     std::string gpu_arch_arg         = "--gpu-architecture=" + gpu_arch;
     const char* opts[]               = {
       gpu_arch_arg.c_str(),
@@ -221,29 +282,56 @@ CUfunction get_function(const std::string& parameters,
 #endif
       "--std=c++14"
     };
-    const std::string& kernel_name_demangled = kernel_name;
-    NVRTC_CALL(nvrtcAddNameExpression(program, (kernel_name_demangled).c_str()));
-
-    nvrtcResult compileResult          = nvrtcCompileProgram(program,  // prog
-                                                    sizeof(opts) / sizeof(opts[0]),  // num options
-                                                    opts);  // options
-    static const std::string dump_file = "mxnet_rtc_debug_code.log";
-    if (compileResult != NVRTC_SUCCESS) {
-      std::ofstream f(dump_file);
-      f << code_with_header;
-      f.close();
+    // The compiled code depends on the source, the options and the versions of CUDA
+    int nvrtc_major, nvrtc_minor;
+    NVRTC_CALL(nvrtcVersion(&nvrtc_major, &nvrtc_minor));
+    std::ostringstream cache_key;
+    cache_key << "cuda " << CUDA_VERSION << " nvrtc " << nvrtc_major << "." << nvrtc_minor
+              << " kernel " << kernel_name << " options";
+    for (const char* opt : opts) {
+      cache_key << " " << opt;
+    }
+    cache_key << "\n" << code_with_header;
+    const std::string cache_path = DiskCachePath(cache_key.str());
+    if (!cache_path.empty() &&
+        ReadDiskCache(cache_path, cache_key.str(), &kinfo.mangled_name, &kinfo.ptx)) {
+      if (dmlc::GetEnv("MXNET_RTC_VERBOSE", false)) {
+        LOG(INFO) << "Loaded the compiled kernel " << kernel_name << " from " << cache_path;
+      }
+    } else {
+      nvrtcProgram program;
+      NVRTC_CALL(nvrtcCreateProgram(&program,                              // prog
+                                    &code_with_header[0],                  // buffer
+                                    (kernel_name + "_kernel.cu").c_str(),  // name
+                                    0,                                     // num headers
+                                    nullptr,                               // headers
+                                    nullptr));                             // include names
+      const std::string& kernel_name_demangled = kernel_name;
+      NVRTC_CALL(nvrtcAddNameExpression(program, (kernel_name_demangled).c_str()));
+
+      nvrtcResult compileResult =
+          nvrtcCompileProgram(program, sizeof(opts) / sizeof(opts[0]), opts);
+
+      static const std::string dump_file = "mxnet_rtc_debug_code.log";
+      if (compileResult != NVRTC_SUCCESS) {
+        std::ofstream f(dump_file);
+        f << code_with_header;
+        f.close();
+      }
+      CHECK_EQ(compileResult, NVRTC_SUCCESS)
+          << "NVRTC Compilation failed.\n"
+          << "The generated code was stored in " << dump_file << "\n"
+          << GetCompileLog(program);
+
+      kinfo.ptx = GetCompiledCode(program, use_cubin);
+      const char* mangled_name;
+      NVRTC_CALL(nvrtcGetLoweredName(program, kernel_name_demangled.c_str(), &mangled_name));
+      kinfo.mangled_name = mangled_name;
+      // Destroy the program.
+      NVRTC_CALL(nvrtcDestroyProgram(&program));
+      if (!cache_path.empty())
+        WriteDiskCache(cache_path, cache_key.str(), kinfo.mangled_name, kinfo.ptx);
     }
-    CHECK_EQ(compileResult, NVRTC_SUCCESS)
-        << "NVRTC Compilation failed.\n"
-        << "The generated code was stored in " << dump_file << "\n"
-        << GetCompileLog(program);
-
-    kinfo.ptx = GetCompiledCode(program, use_cubin);
-    const char* mangled_name;
-    NVRTC_CALL(nvrtcGetLoweredName(program, kernel_name_demangled.c_str(), &mangled_name));
-    kinfo.mangled_name = mangled_name;
-    // Destroy the program.
-    NVRTC_CALL(nvrtcDestroyProgram(&program));
   }
   // Ensure function array is deep enough to index by dev_id
   while (kinfo.functions.size() <= static_cast<size_t>(dev_id))
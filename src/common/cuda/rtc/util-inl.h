@@ -455,6 +455,39 @@ __device__ inline index_t unravel_dot(const index_t idx, const index_t (&shape)[
   return ret;
 }
 
+// unravel_dot computed in IdxType, for kernels whose indices all fit in it
+template <typename IdxType, int ndim>
+__device__ inline void unravel_dot_as(const IdxType idx, const index_t (&shape)[MAX_DIM],
+  const index_t (&stridej)[MAX_DIM], const index_t (&stridek)[MAX_DIM], IdxType* j, IdxType* k) {
+  *j = 0;
+  *k = 0;
+  IdxType cur = idx;
+  #pragma unroll
+  for (int i = ndim-1; i >=0; --i) {
+    const IdxType dim = static_cast<IdxType>(shape[i]);
+    const IdxType tmp = cur / dim;
+    const IdxType coord = cur - tmp*dim;
+    *j += coord*static_cast<IdxType>(stridej[i]);
+    *k += coord*static_cast<IdxType>(stridek[i]);
+    cur = tmp;
+  }
+}
+
+template <typename IdxType, int ndim>
+__device__ inline IdxType unravel_dot_as(const IdxType idx, const index_t (&shape)[MAX_DIM],
+  const index_t (&stride)[MAX_DIM]) {
+  IdxType ret = 0;
+  IdxType cur = idx;
+  #pragma unroll
+  for (int i = ndim-1; i >=0; --i) {
+    const IdxType dim = static_cast<IdxType>(shape[i]);
+    const IdxType tmp = cur / dim;
+    ret += (cur - tmp*dim)*static_cast<IdxType>(stride[i]);
+    cur = tmp;
+  }
+  return ret;
+}
+
 template<int ndim>
 __device__ inline index_t unravel_ravel(const index_t idx, const index_t (&shape1)[MAX_DIM],
                                         const index_t (&shape2)[MAX_DIM]) {
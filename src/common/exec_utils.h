@@ -32,6 +32,7 @@
 #include <utility>
 #include "../common/utils.h"
 #include "../imperative/exec_pass.h"
+#include "../profiler/profiler.h"
 
 namespace mxnet {
 namespace common {
@@ -187,6 +188,39 @@ inline void CastNonDefaultStorage(const std::vector<NDArray>& src,
   }
 }
 
+/*!
+ * \brief Report the work of the operator running on this thread to the profiler, when the
+ *        operator is profiled and registers FOpCost
+ */
+inline void RecordOpCost(const nnvm::NodeAttrs& attrs,
+                         const std::vector<TBlob>& inputs,
+                         const std::vector<TBlob>& outputs) {
+  static auto& fop_cost           = nnvm::Op::GetAttr<FOpCost>("FOpCost");
+  profiler::OprDispatchInfo* info = profiler::OprDispatchInfo::Get();
+  if (!info->active_ || attrs.op == nullptr || !fop_cost.count(attrs.op))
+    return;
+  const OpCost cost = fop_cost[attrs.op](attrs, inputs, outputs);
+  info->AddCost(cost.flops, cost.bytes);
+}
+
+inline void RecordOpCost(const nnvm::NodeAttrs& attrs,
+                         const std::vector<NDArray>& inputs,
+                         const std::vector<NDArray>& outputs) {
+  if (!profiler::OprDispatchInfo::Get()->active_)
+    return;
+  // the cost only depends on the shapes and types, sparse arrays count as dense
+  auto blobs = [](const std::vector<NDArray>& arrays) {
+    std::vector<TBlob> ret;
+    ret.reserve(arrays.size());
+    for (const NDArray& arr : arrays) {
+      ret.emplace_back(
+          static_cast<void*>(nullptr), arr.shape(), arr.ctx().dev_mask(), arr.dtype());
+    }
+    return ret;
+  };
+  RecordOpCost(attrs, blobs(inputs), blobs(outputs));
+}
+
 /*! \brief The default type inference function, which assigns all undefined
  *         types to the same type of one of the inputs or outputs.
  */
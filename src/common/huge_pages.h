@@ -0,0 +1,75 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file huge_pages.h
+ * \brief Host allocations backed by transparent huge pages.
+ *  Enabled for allocations of at least MXNET_CPU_HUGE_PAGE_THRESHOLD bytes.
+ */
+#ifndef MXNET_COMMON_HUGE_PAGES_H_
+#define MXNET_COMMON_HUGE_PAGES_H_
+
+#include <dmlc/parameter.h>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+#include <cstddef>
+#include "./utils.h"
+
+namespace mxnet {
+namespace common {
+
+/*! \brief size of a transparent huge page */
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+/*!
+ * \return minimal size of the host allocations backed by huge pages,
+ *  0 if disabled, controlled by MXNET_CPU_HUGE_PAGE_THRESHOLD.
+ */
+inline size_t HugePageThreshold() {
+  static const size_t threshold = dmlc::GetEnv("MXNET_CPU_HUGE_PAGE_THRESHOLD", size_t(0));
+  return threshold;
+}
+
+/*! \return whether a host allocation of this size should use huge pages */
+inline bool UseHugePages(size_t size) {
+  const size_t threshold = HugePageThreshold();
+  return threshold && size >= threshold;
+}
+
+/*!
+ * \brief allocate host memory aligned to, and padded to a multiple of, the huge
+ *  page size and ask the kernel to back it with huge pages.
+ *  The memory is released with AlignedMemFree.
+ * \return false if the allocation failed.
+ */
+inline bool HugePageMemAlloc(void** ptr, size_t size) {
+  const size_t padded = (size + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+  if (!AlignedMemAlloc(ptr, padded, kHugePageSize))
+    return false;
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  // best effort, the memory falls back to normal pages if the kernel refuses
+  madvise(*ptr, padded, MADV_HUGEPAGE);
+#endif
+  return true;
+}
+
+}  // namespace common
+}  // namespace mxnet
+#endif  // MXNET_COMMON_HUGE_PAGES_H_
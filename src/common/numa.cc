@@ -0,0 +1,123 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file numa.cc
+ * \brief NUMA topology discovery through sysfs and binding through raw
+ *  syscalls, so that no dependency on libnuma is needed.
+ */
+#include "./numa.h"
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace mxnet {
+namespace common {
+
+namespace {
+
+#if defined(__linux__)
+/*! \brief MPOL_PREFERRED from <numaif.h> */
+constexpr int kMPolPreferred = 1;
+
+/*! \brief parse a sysfs cpu list such as "0-3,8-11" */
+std::vector<int> ParseCpuList(const std::string& list) {
+  std::vector<int> cpus;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty() || range == "\n")
+      continue;
+    const size_t dash = range.find('-');
+    const int begin   = std::stoi(range.substr(0, dash));
+    const int end     = dash == std::string::npos ? begin : std::stoi(range.substr(dash + 1));
+    for (int cpu = begin; cpu <= end; ++cpu)
+      cpus.push_back(cpu);
+  }
+  return cpus;
+}
+#endif
+
+}  // namespace
+
+const NumaTopology* NumaTopology::Get() {
+  static NumaTopology inst;
+  return &inst;
+}
+
+NumaTopology::NumaTopology() {
+#if defined(__linux__)
+  for (int node = 0;; ++node) {
+    std::ifstream f("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    if (!f.good())
+      break;
+    std::string list;
+    std::getline(f, list);
+    node_cpus_.push_back(ParseCpuList(list));
+  }
+#endif
+  if (node_cpus_.empty())
+    node_cpus_.emplace_back();
+  enabled_ = dmlc::GetEnv("MXNET_CPU_NUMA_AWARE", false) && node_cpus_.size() > 1;
+  if (dmlc::GetEnv("MXNET_CPU_NUMA_AWARE", false) && !enabled_) {
+    LOG(INFO) << "MXNET_CPU_NUMA_AWARE is set but only one NUMA node was found, ignoring.";
+  }
+}
+
+bool NumaTopology::BindThreadToNode(int node) const {
+#if defined(__linux__)
+  const std::vector<int>& cpus = node_cpus_[node];
+  if (cpus.empty())
+    return false;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus)
+    CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+bool NumaTopology::BindMemoryToNode(void* ptr, size_t size, int node) const {
+#if defined(__linux__) && defined(SYS_mbind)
+  if (node < 0 || node >= 64)
+    return false;
+  const uintptr_t page  = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(ptr) & ~(page - 1);
+  const uintptr_t end   = reinterpret_cast<uintptr_t>(ptr) + size;
+  unsigned long mask    = 1UL << node;  // NOLINT(runtime/int)
+  return syscall(SYS_mbind, begin, end - begin, kMPolPreferred, &mask, sizeof(mask) * 8, 0) == 0;
+#else
+  return false;
+#endif
+}
+
+}  // namespace common
+}  // namespace mxnet
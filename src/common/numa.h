@@ -0,0 +1,80 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file numa.h
+ * \brief NUMA topology discovery, thread pinning and memory binding.
+ *  Enabled with MXNET_CPU_NUMA_AWARE=1; context cpu(i) is mapped
+ *  to NUMA node i % num_nodes().
+ */
+#ifndef MXNET_COMMON_NUMA_H_
+#define MXNET_COMMON_NUMA_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace mxnet {
+namespace common {
+
+class NumaTopology {
+ public:
+  /*! \return the process wide topology, discovered on first use */
+  static const NumaTopology* Get();
+  /*!
+   * \return whether NUMA-aware placement is requested through
+   *  MXNET_CPU_NUMA_AWARE and the host has more than one node.
+   */
+  bool enabled() const {
+    return enabled_;
+  }
+  /*! \return number of NUMA nodes, at least 1 */
+  int num_nodes() const {
+    return static_cast<int>(node_cpus_.size());
+  }
+  /*! \return logical cpus belonging to a node */
+  const std::vector<int>& node_cpus(int node) const {
+    return node_cpus_[node];
+  }
+  /*! \return the node serving context cpu(dev_id) */
+  int NodeOfDevice(int dev_id) const {
+    return dev_id < 0 ? 0 : dev_id % num_nodes();
+  }
+  /*!
+   * \brief pin the calling thread to the cpus of a node.
+   * \return whether the affinity could be set.
+   */
+  bool BindThreadToNode(int node) const;
+  /*!
+   * \brief prefer a node for the pages of a fresh allocation.
+   *  Only pages not yet touched are affected.
+   * \return whether the policy could be set.
+   */
+  bool BindMemoryToNode(void* ptr, size_t size, int node) const;
+
+ private:
+  NumaTopology();
+  /*! \brief cpus per node, index is the node id */
+  std::vector<std::vector<int>> node_cpus_;
+  /*! \brief whether NUMA-aware placement is active */
+  bool enabled_{false};
+};
+
+}  // namespace common
+}  // namespace mxnet
+#endif  // MXNET_COMMON_NUMA_H_
@@ -21,7 +21,9 @@
 #define MXNET_COMMON_OBJECT_POOL_H_
 #include <dmlc/logging.h>
 #include <cstdlib>
+#include <memory>
 #include <mutex>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -127,6 +129,51 @@ struct ObjectPoolAllocatable {
   static void Delete(T* ptr);
 };  // struct ObjectPoolAllocatable
 
+/*!
+ * \brief Allocator drawing single objects from an ObjectPool, for example with
+ *        std::allocate_shared. The objects keep their pool alive.
+ */
+template <typename T>
+class ObjectPoolAllocator {
+ public:
+  using value_type = T;
+
+  ObjectPoolAllocator() : pool_(ObjectPool<Block>::_GetSharedRef()) {}
+
+  template <typename U>
+  ObjectPoolAllocator(const ObjectPoolAllocator<U>& other)  // NOLINT(*)
+      : ObjectPoolAllocator() {}
+
+  T* allocate(std::size_t n) {
+    if (n != 1)
+      return std::allocator<T>().allocate(n);
+    return reinterpret_cast<T*>(pool_->New());
+  }
+
+  void deallocate(T* ptr, std::size_t n) {
+    if (n != 1)
+      return std::allocator<T>().deallocate(ptr, n);
+    pool_->Delete(reinterpret_cast<Block*>(ptr));
+  }
+
+  template <typename U>
+  bool operator==(const ObjectPoolAllocator<U>& other) const {
+    return std::is_same<T, U>::value;
+  }
+
+  template <typename U>
+  bool operator!=(const ObjectPoolAllocator<U>& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  /*! \brief Raw storage of an object, constructed by the user of the allocator */
+  struct Block {
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type data;
+  };
+  std::shared_ptr<ObjectPool<Block>> pool_;
+};  // class ObjectPoolAllocator
+
 template <typename T>
 ObjectPool<T>::~ObjectPool() {
   for (auto i : allocated_) {
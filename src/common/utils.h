@@ -845,6 +845,44 @@ inline void ParallelAdd(DType* dst, const DType* src, index_t size) {
   }
 }
 
+/*!
+ * \brief In-place inclusive prefix sum parallelized by OpenMP: every thread scans a block,
+ *        then adds the sum of the blocks before it.
+ */
+template <typename DType>
+inline void ParallelInclusiveScan(DType* data, index_t size) {
+  static index_t scan_block_size = dmlc::GetEnv("MXNET_CPU_PARALLEL_SIZE", 200000);
+  const int num_threads          = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  if (size < scan_block_size || num_threads <= 1) {
+    for (index_t i = 1; i < size; ++i) {
+      data[i] += data[i - 1];
+    }
+    return;
+  }
+  const index_t block = (size + num_threads - 1) / num_threads;
+  std::vector<DType> block_sums(num_threads + 1, 0);
+#pragma omp parallel for num_threads(num_threads)
+  for (int t = 0; t < num_threads; ++t) {
+    const index_t end = std::min(size, (t + 1) * block);
+    DType sum         = 0;
+    for (index_t i = t * block; i < end; ++i) {
+      sum += data[i];
+      data[i] = sum;
+    }
+    block_sums[t + 1] = sum;
+  }
+  for (int t = 1; t < num_threads; ++t) {
+    block_sums[t + 1] += block_sums[t];
+  }
+#pragma omp parallel for num_threads(num_threads)
+  for (int t = 1; t < num_threads; ++t) {
+    const index_t end = std::min(size, (t + 1) * block);
+    for (index_t i = t * block; i < end; ++i) {
+      data[i] += block_sums[t];
+    }
+  }
+}
+
 /*!
  * \brief If numpy compatibility is turned off (default), the shapes passed in
  * by users follow the legacy shape definition:
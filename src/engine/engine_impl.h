@@ -29,6 +29,14 @@
 /*! \brief MACRO on whether or not enable debug option*/
 #define ENGINE_DEBUG 0
 
+/*!
+ * \brief MACRO on whether ThreadedVar tracks reads with a CAS-updated state word
+ *  instead of taking its mutex on every dependency change.
+ */
+#ifndef MXNET_ENGINE_LOCKFREE_VAR
+#define MXNET_ENGINE_LOCKFREE_VAR 0
+#endif
+
 namespace mxnet {
 namespace engine {
 
@@ -78,6 +86,8 @@ Engine* CreateNaiveEngine();
 Engine* CreateThreadedEnginePooled();
 /*! \return ThreadedEnginePerDevie instance */
 Engine* CreateThreadedEnginePerDevice();
+/*! \return ThreadedEnginePerDevice instance with work-stealing CPU workers */
+Engine* CreateThreadedEngineWorkStealing();
 #endif
 }  // namespace engine
 }  // namespace mxnet
@@ -0,0 +1,191 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file engine_stats.cc
+ * \brief Implementation of the engine overhead counters.
+ */
+#include "./engine_stats.h"
+#include <dmlc/parameter.h>
+#include <iomanip>
+
+namespace mxnet {
+namespace engine {
+
+namespace {
+
+/*! \brief exclusive upper bound of a histogram bucket */
+inline uint64_t BucketUpperBound(int bucket) {
+  return uint64_t{1} << bucket;
+}
+
+void DumpHistogramRow(std::ostream& os,
+                      const char* name,
+                      const char* unit,
+                      const EngineStats::Histogram& h) {
+  const uint64_t count = h.count.load();
+  os << std::setw(25) << std::left << name << std::setw(16) << std::right << count << std::setw(16)
+     << std::right << std::fixed << std::setprecision(2)
+     << (count ? static_cast<double>(h.sum.load()) / count : 0.0) << std::setw(16) << std::right
+     << h.max.load() << " " << unit << std::endl;
+  os << "    buckets (<upper bound: count):";
+  for (int i = 0; i < EngineStats::kNumBuckets; ++i) {
+    const uint64_t n = h.buckets[i].load();
+    if (n == 0)
+      continue;
+    if (i == EngineStats::kNumBuckets - 1)
+      os << " inf:" << n;
+    else
+      os << " " << BucketUpperBound(i) << ":" << n;
+  }
+  os << std::endl;
+}
+
+void DumpHistogramMetric(std::ostream& os,
+                         const char* name,
+                         const char* help,
+                         const EngineStats::Histogram& h) {
+  os << "# TYPE " << name << " histogram\n"
+     << "# HELP " << name << " " << help << "\n";
+  // the values are integers, the last value of bucket i is its exclusive upper bound minus one
+  uint64_t cumulative = 0;
+  for (int i = 0; i < EngineStats::kNumBuckets - 1; ++i) {
+    cumulative += h.buckets[i].load();
+    os << name << "_bucket{le=\"" << BucketUpperBound(i) - 1 << "\"} " << cumulative << "\n";
+  }
+  os << name << "_bucket{le=\"+Inf\"} " << h.count.load() << "\n"
+     << name << "_count " << h.count.load() << "\n"
+     << name << "_sum " << h.sum.load() << "\n";
+}
+
+}  // namespace
+
+void EngineStats::Histogram::Reset() {
+  for (auto& b : buckets)
+    b.store(0);
+  count.store(0);
+  sum.store(0);
+  max.store(0);
+}
+
+void EngineStats::Histogram::DumpJson(std::ostream& os) const {
+  const uint64_t n = count.load();
+  os << "{\"count\": " << n << ", \"sum\": " << sum.load() << ", \"max\": " << max.load()
+     << ", \"avg\": " << (n ? static_cast<double>(sum.load()) / n : 0.0) << ", \"buckets\": [";
+  for (int i = 0; i < kNumBuckets; ++i) {
+    os << (i ? ", " : "") << buckets[i].load();
+  }
+  os << "]}";
+}
+
+EngineStats* EngineStats::Get() {
+  static EngineStats inst;
+  return &inst;
+}
+
+EngineStats::EngineStats() : enabled_(dmlc::GetEnv("MXNET_ENGINE_STATS", true)) {}
+
+void EngineStats::DumpTable(std::ostream& os) const {
+  std::ios state(nullptr);
+  state.copyfmt(os);
+  os << "Engine Overhead" << std::endl << "=================" << std::endl;
+  os << std::setw(25) << std::left << "Pushed Operators" << std::setw(16) << std::right
+     << num_pushed_.load() << std::endl;
+  os << std::setw(25) << std::left << "Queue Depth" << std::setw(16) << std::right
+     << queue_depth_.load() << "  (max " << max_queue_depth_.load() << ")" << std::endl;
+  os << std::setw(25) << std::left << "Name" << std::setw(16) << std::right << "Count"
+     << std::setw(16) << std::right << "Avg" << std::setw(16) << std::right << "Max" << std::endl;
+  os << std::setw(25) << std::left << "----" << std::setw(16) << std::right << "-----"
+     << std::setw(16) << std::right << "---" << std::setw(16) << std::right << "---" << std::endl;
+  DumpHistogramRow(os, "Wait To Run", "us", wait_us_);
+  DumpHistogramRow(os, "Dependency Fan-out", "oprs", fanout_);
+  DumpHistogramRow(os, "Bulk Segment Size", "oprs", bulk_size_);
+  if (num_temp_space_requests_.load() > 0) {
+    os << std::setw(25) << std::left << "Temp Space Requests" << std::setw(16) << std::right
+       << num_temp_space_requests_.load() << "  (contended " << num_temp_space_contended_.load()
+       << ", copies added " << num_temp_space_copies_.load() << ", released "
+       << temp_space_released_bytes_.load() << " bytes)" << std::endl;
+  }
+  os << std::endl << std::flush;
+  os.copyfmt(state);
+}
+
+void EngineStats::DumpJson(std::ostream& os) const {
+  os << "{\"enabled\": " << (enabled_ ? "true" : "false")
+     << ", \"pushed\": " << num_pushed_.load() << ", \"queue_depth\": " << queue_depth_.load()
+     << ", \"max_queue_depth\": " << max_queue_depth_.load() << ", \"wait_to_run_us\": ";
+  wait_us_.DumpJson(os);
+  os << ", \"dependency_fanout\": ";
+  fanout_.DumpJson(os);
+  os << ", \"bulk_segment_size\": ";
+  bulk_size_.DumpJson(os);
+  os << ", \"temp_space_requests\": " << num_temp_space_requests_.load()
+     << ", \"temp_space_contended\": " << num_temp_space_contended_.load()
+     << ", \"temp_space_copies_added\": " << num_temp_space_copies_.load()
+     << ", \"temp_space_released_bytes\": " << temp_space_released_bytes_.load() << "}";
+}
+
+void EngineStats::DumpOpenMetrics(std::ostream& os) const {
+  os << "# TYPE mxnet_engine_pushed_operators counter\n"
+     << "# HELP mxnet_engine_pushed_operators Operators pushed to the engine.\n"
+     << "mxnet_engine_pushed_operators_total " << num_pushed_.load() << "\n"
+     << "# TYPE mxnet_engine_queue_depth gauge\n"
+     << "# HELP mxnet_engine_queue_depth Ready operators waiting for a worker.\n"
+     << "mxnet_engine_queue_depth " << queue_depth_.load() << "\n"
+     << "# TYPE mxnet_engine_max_queue_depth gauge\n"
+     << "# HELP mxnet_engine_max_queue_depth Maximum of the queue depth.\n"
+     << "mxnet_engine_max_queue_depth " << max_queue_depth_.load() << "\n"
+     << "# TYPE mxnet_engine_temp_space_requests counter\n"
+     << "# HELP mxnet_engine_temp_space_requests Temp spaces requested from the dynamic pools.\n"
+     << "mxnet_engine_temp_space_requests_total " << num_temp_space_requests_.load() << "\n"
+     << "# TYPE mxnet_engine_temp_space_contended counter\n"
+     << "# HELP mxnet_engine_temp_space_contended Temp space requests finding all copies busy.\n"
+     << "mxnet_engine_temp_space_contended_total " << num_temp_space_contended_.load() << "\n"
+     << "# TYPE mxnet_engine_temp_space_copies_added gauge\n"
+     << "# HELP mxnet_engine_temp_space_copies_added Copies added by the temp space pools.\n"
+     << "mxnet_engine_temp_space_copies_added " << num_temp_space_copies_.load() << "\n"
+     << "# TYPE mxnet_engine_temp_space_released_bytes counter\n"
+     << "# HELP mxnet_engine_temp_space_released_bytes Bytes of oversized workspaces released.\n"
+     << "mxnet_engine_temp_space_released_bytes_total " << temp_space_released_bytes_.load()
+     << "\n";
+  DumpHistogramMetric(os,
+                      "mxnet_engine_wait_to_run_microseconds",
+                      "Latency between the push and the start of an operator.",
+                      wait_us_);
+  DumpHistogramMetric(os,
+                      "mxnet_engine_dependency_fanout",
+                      "Operators made ready by the completion of an operator.",
+                      fanout_);
+  DumpHistogramMetric(
+      os, "mxnet_engine_bulk_segment_size", "Operators per imperative bulk segment.", bulk_size_);
+}
+
+void EngineStats::Reset() {
+  num_pushed_.store(0);
+  max_queue_depth_.store(queue_depth_.load());
+  wait_us_.Reset();
+  fanout_.Reset();
+  bulk_size_.Reset();
+  num_temp_space_requests_.store(0);
+  num_temp_space_contended_.store(0);
+  temp_space_released_bytes_.store(0);
+}
+
+}  // namespace engine
+}  // namespace mxnet
@@ -0,0 +1,171 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file engine_stats.h
+ * \brief Low-overhead counters of the scheduling overhead of ThreadedEngine.
+ *  They tell whether a workload is engine-bound or kernel-bound:
+ *  the number of ready operators waiting for a worker, the latency between
+ *  Push and the start of execution, the number of operators released by
+ *  each completion and the size of imperative bulk segments.
+ *  The dynamic temp space pool also reports its contention here.
+ */
+#ifndef MXNET_ENGINE_ENGINE_STATS_H_
+#define MXNET_ENGINE_ENGINE_STATS_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+namespace mxnet {
+namespace engine {
+
+class EngineStats {
+ public:
+  /*! \brief number of buckets of each histogram */
+  static constexpr int kNumBuckets = 20;
+
+  /*!
+   * \brief histogram with power of two buckets.
+   *  Bucket 0 counts the value 0, bucket i counts values in [2^(i-1), 2^i),
+   *  the last bucket also counts everything above.
+   */
+  struct Histogram {
+    std::array<std::atomic<uint64_t>, kNumBuckets> buckets{};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> max{0};
+
+    inline void Add(uint64_t value) {
+      int bucket = 0;
+      for (uint64_t v = value; v != 0 && bucket < kNumBuckets - 1; v >>= 1)
+        ++bucket;
+      buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+      count.fetch_add(1, std::memory_order_relaxed);
+      sum.fetch_add(value, std::memory_order_relaxed);
+      uint64_t prev = max.load(std::memory_order_relaxed);
+      while (value > prev && !max.compare_exchange_weak(prev, value, std::memory_order_relaxed)) {
+      }
+    }
+    void Reset();
+    void DumpJson(std::ostream& os) const;
+  };
+
+  /*! \return the process wide counters */
+  static EngineStats* Get();
+  /*! \return whether counters are collected, controlled by MXNET_ENGINE_STATS */
+  inline bool enabled() const {
+    return enabled_;
+  }
+  /*! \return current time in ns on a monotonic clock */
+  static inline int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+  /*! \brief an operator was pushed */
+  inline void OnPush() {
+    num_pushed_.fetch_add(1, std::memory_order_relaxed);
+  }
+  /*! \brief all dependencies of an operator are satisfied */
+  inline void OnReady() {
+    const int64_t depth = queue_depth_.fetch_add(1, std::memory_order_relaxed) + 1;
+    int64_t prev        = max_queue_depth_.load(std::memory_order_relaxed);
+    while (depth > prev &&
+           !max_queue_depth_.compare_exchange_weak(prev, depth, std::memory_order_relaxed)) {
+    }
+  }
+  /*!
+   * \brief a ready operator starts executing.
+   * \param push_ns time at which the operator was pushed.
+   */
+  inline void OnStart(int64_t push_ns) {
+    queue_depth_.fetch_sub(1, std::memory_order_relaxed);
+    const int64_t wait_ns = NowNs() - push_ns;
+    wait_us_.Add(wait_ns > 0 ? static_cast<uint64_t>(wait_ns / 1000) : 0);
+  }
+  /*!
+   * \brief an operator completed.
+   * \param fanout number of operators its completion made ready.
+   */
+  inline void OnComplete(int fanout) {
+    fanout_.Add(static_cast<uint64_t>(fanout));
+  }
+  /*! \brief an imperative bulk segment of num_ops operators was flushed */
+  inline void OnBulkFlush(int num_ops) {
+    bulk_size_.Add(static_cast<uint64_t>(num_ops));
+  }
+  /*!
+   * \brief a temp space was requested from the dynamic pool.
+   * \param contended whether all its copies were busy and the pool could not grow.
+   */
+  inline void OnTempSpaceRequest(bool contended) {
+    num_temp_space_requests_.fetch_add(1, std::memory_order_relaxed);
+    if (contended)
+      num_temp_space_contended_.fetch_add(1, std::memory_order_relaxed);
+  }
+  /*! \brief the dynamic temp space pool added a copy */
+  inline void OnTempSpaceGrow() {
+    num_temp_space_copies_.fetch_add(1, std::memory_order_relaxed);
+  }
+  /*! \brief an oversized temp space workspace was released */
+  inline void OnTempSpaceRelease(uint64_t bytes) {
+    temp_space_released_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+  /*! \brief print the counters as a table */
+  void DumpTable(std::ostream& os) const;
+  /*! \brief print the counters as a json object */
+  void DumpJson(std::ostream& os) const;
+  /*! \brief print the counters in the OpenMetrics text format */
+  void DumpOpenMetrics(std::ostream& os) const;
+  /*! \brief reset all counters but the current queue depth and the added temp space copies */
+  void Reset();
+
+ private:
+  EngineStats();
+
+  /*! \brief whether counters are collected */
+  bool enabled_;
+  /*! \brief number of pushed operators */
+  std::atomic<uint64_t> num_pushed_{0};
+  /*! \brief number of ready operators that have not started */
+  std::atomic<int64_t> queue_depth_{0};
+  /*! \brief maximum of queue_depth_ */
+  std::atomic<int64_t> max_queue_depth_{0};
+  /*! \brief latency between Push and start of execution, in us */
+  Histogram wait_us_;
+  /*! \brief number of operators released per completion */
+  Histogram fanout_;
+  /*! \brief number of operators per bulk segment */
+  Histogram bulk_size_;
+  /*! \brief number of temp spaces requested from the dynamic pools */
+  std::atomic<uint64_t> num_temp_space_requests_{0};
+  /*! \brief number of those requests for which all copies were busy */
+  std::atomic<uint64_t> num_temp_space_contended_{0};
+  /*! \brief number of copies added by the dynamic pools, never reset */
+  std::atomic<uint64_t> num_temp_space_copies_{0};
+  /*! \brief bytes of oversized workspaces released by the dynamic pools */
+  std::atomic<uint64_t> temp_space_released_bytes_{0};
+};
+
+}  // namespace engine
+}  // namespace mxnet
+#endif  // MXNET_ENGINE_ENGINE_STATS_H_
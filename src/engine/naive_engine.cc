@@ -116,7 +116,8 @@ class NaiveEngine final : public Engine {
   void Push(OprHandle op, Context exec_ctx, int priority = 0, bool profiling = false) override {
     profiler::Profiler* profiler = profiler::Profiler::Get();
     NaiveOpr* opr                = op->Cast<NaiveOpr>();
-    opr->profiling = profiling && profiler->IsProfiling(profiler::Profiler::kSymbolic);
+    opr->profiling =
+        profiling && profiler->IsProfiling(profiler::Profiler::kSymbolic) && profiler->IsSampled();
     this->PushAsync(
         [&](RunContext ctx, CallbackOnStart on_start, CallbackOnComplete on_complete) {
           if (opr->profiling) {
@@ -161,7 +162,8 @@ class NaiveEngine final : public Engine {
     profiler::Profiler* profiler = profiler::Profiler::Get();
     auto opr_deleter             = [this](NaiveOpr* p) { this->DeleteOperator(p); };
     std::unique_ptr<NaiveOpr, decltype(opr_deleter)> opr(nullptr, opr_deleter);
-    const bool profiling = opr_name && profiler->IsProfiling(profiler::Profiler::kImperative);
+    const bool profiling =
+        opr_name && profiler->IsProfiling(profiler::Profiler::kImperative) && profiler->IsSampled();
     // GenerateDisplayName() will return a pointer to the correct name of the operator
     const char* display_name =
         profiling ? profiler::CustomOpProfiler::Get()->GenerateDisplayName(opr_name) : opr_name;
@@ -19,8 +19,10 @@
 #include <dmlc/omp.h>
 #include <dmlc/base.h>
 #include <dmlc/parameter.h>
+#include <algorithm>
 #include <climits>
 #include "./openmp.h"
+#include "../common/numa.h"
 
 namespace mxnet {
 namespace engine {
@@ -67,14 +69,32 @@ void OpenMP::initialize_process() {
 #endif
 }
 
-void OpenMP::on_start_worker_thread(bool use_omp) {
+void OpenMP::on_start_worker_thread(bool use_omp, int numa_node) {
 #ifdef _OPENMP
   if (!omp_num_threads_set_in_environment_) {
-    omp_set_num_threads(use_omp ? GetRecommendedOMPThreadCount(true) : 1);
+    int nthreads = 1;
+    if (use_omp) {
+      nthreads = numa_node >= 0 ? GetRecommendedOMPThreadCountForNode(numa_node) :
+                                  GetRecommendedOMPThreadCount(true);
+    }
+    omp_set_num_threads(nthreads);
   }
 #endif
 }
 
+int OpenMP::GetRecommendedOMPThreadCountForNode(int numa_node) const {
+  const common::NumaTopology* topo = common::NumaTopology::Get();
+  int node_cores = static_cast<int>(topo->node_cpus(numa_node).size());
+#ifdef ARCH_IS_INTEL_X86
+  node_cores >>= 1;
+#endif
+  // reserved cores are spread evenly over the sockets
+  const int nodes        = topo->num_nodes();
+  const int node_reserve = (reserve_cores_ + nodes - 1) / nodes;
+  const int node_threads = std::max(node_cores - node_reserve, 1);
+  return std::min(node_threads, GetRecommendedOMPThreadCount(true));
+}
+
 void OpenMP::set_reserve_cores(int cores) {
   CHECK_GE(cores, 0);
   reserve_cores_ = cores;
@@ -81,8 +81,17 @@ class OpenMP {
    * \brief Call at the beginning of a worker thread's life.  This will set the omp_num_threads
    *        for omp regions created by this thread
    * \param use_omp true if this thread plans to utilize parallel omp regions
+   * \param numa_node if non-negative, the NUMA node the thread is pinned to; omp regions
+   *        are then limited to that node's cores minus its share of the reserved cores
    */
-  void on_start_worker_thread(bool use_omp);
+  void on_start_worker_thread(bool use_omp, int numa_node = -1);
+
+  /*!
+   * \brief Get the recommended number of OMP threads for a thread pinned to a NUMA node
+   * \param numa_node NUMA node of the calling thread
+   * \return Recommended number of OMP threads, at least 1
+   */
+  int GetRecommendedOMPThreadCountForNode(int numa_node) const;
 
   /*!
    * \brief Initialize a new process to use omp (after a fork,
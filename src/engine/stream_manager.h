@@ -27,6 +27,7 @@
 #include <string>
 #include <memory>
 #include <mutex>
+#include <vector>
 #include "./engine_impl.h"
 #include "../common/cuda/utils.h"
 
@@ -37,12 +38,12 @@ namespace engine {
  * \brief Stream manager.
  *
  * Uses a basic round-robin algorithm to dispatch GPU streams. Returns default
- * context on CPU.
+ * context on CPU. The number of streams of each GPU is set at runtime.
  */
-template <std::size_t kNumGpus, std::size_t kStreams>
+template <std::size_t kNumGpus>
 class StreamManager {
  public:
-  StreamManager();
+  explicit StreamManager(std::size_t num_streams);
   ~StreamManager() {
     Finalize();
   }
@@ -52,9 +53,10 @@ class StreamManager {
 
  private:
   std::mutex mutex_;
+  std::size_t num_streams_;
 #if MXNET_USE_CUDA
-  std::array<std::array<mshadow::Stream<gpu>*, kStreams>, kNumGpus> gpu_streams_;
-  std::array<std::array<GPUAuxStream*, kStreams>, kNumGpus> gpu_aux_streams_;
+  std::array<std::vector<mshadow::Stream<gpu>*>, kNumGpus> gpu_streams_;
+  std::array<std::vector<GPUAuxStream*>, kNumGpus> gpu_aux_streams_;
   std::array<mshadow::Stream<gpu>*, kNumGpus> gpu_io_streams_;
   std::array<int, kNumGpus> gpu_cnt_;
   std::array<std::unique_ptr<CUDAEventPool>, kNumGpus> event_pools_;
@@ -62,8 +64,8 @@ class StreamManager {
   DISALLOW_COPY_AND_ASSIGN(StreamManager);
 };  // class StreamManager
 
-template <std::size_t kNumGpus, std::size_t kStreams>
-RunContext StreamManager<kNumGpus, kStreams>::GetRunContext(Context const& ctx) {
+template <std::size_t kNumGpus>
+RunContext StreamManager<kNumGpus>::GetRunContext(Context const& ctx) {
   RunContext ret;
   switch (ctx.dev_mask()) {
     case cpu::kDevMask:
@@ -93,7 +95,7 @@ RunContext StreamManager<kNumGpus, kStreams>::GetRunContext(Context const& ctx)
         }
         event_pool  = event_pools_.at(ctx.dev_id).get();
         use_counter = counter;
-        counter     = (counter + 1) % kStreams;
+        counter     = (counter + 1) % num_streams_;
       }
       ret = RunContext{ctx,
                        gpu_streams_.at(ctx.dev_id).at(use_counter),
@@ -110,8 +112,8 @@ RunContext StreamManager<kNumGpus, kStreams>::GetRunContext(Context const& ctx)
   return ret;
 }
 
-template <std::size_t kNumGpus, std::size_t kStreams>
-RunContext StreamManager<kNumGpus, kStreams>::GetIORunContext(Context const& ctx) {
+template <std::size_t kNumGpus>
+RunContext StreamManager<kNumGpus>::GetIORunContext(Context const& ctx) {
   RunContext ret;
   switch (ctx.dev_mask()) {
     case cpu::kDevMask:
@@ -143,11 +145,14 @@ RunContext StreamManager<kNumGpus, kStreams>::GetIORunContext(Context const& ctx
   return ret;
 }
 
-template <std::size_t kNumGpus, std::size_t kStreams>
-StreamManager<kNumGpus, kStreams>::StreamManager() {
+template <std::size_t kNumGpus>
+StreamManager<kNumGpus>::StreamManager(std::size_t num_streams) : num_streams_(num_streams) {
+  CHECK_GT(num_streams, 0) << "A GPU needs at least one stream";
 #if MXNET_USE_CUDA
   for (std::size_t i = 0; i < kNumGpus; ++i) {
     gpu_cnt_.at(i) = -1;
+    gpu_streams_.at(i).resize(num_streams, nullptr);
+    gpu_aux_streams_.at(i).resize(num_streams, nullptr);
   }
   for (auto&& i : gpu_io_streams_) {
     i = nullptr;
@@ -155,8 +160,8 @@ StreamManager<kNumGpus, kStreams>::StreamManager() {
 #endif  // MXNET_USE_CUDA
 }
 
-template <std::size_t kNumGpus, std::size_t kStreams>
-void StreamManager<kNumGpus, kStreams>::Finalize() {
+template <std::size_t kNumGpus>
+void StreamManager<kNumGpus>::Finalize() {
 #if MXNET_USE_CUDA
   for (std::size_t i = 0; i < kNumGpus; ++i) {
     if (gpu_cnt_.at(i) != -1) {
@@ -47,6 +47,167 @@ ThreadedVar::ThreadedVar(VersionedVarBlock* head) : head_{head} {
 #endif  // ENGINE_DEBUG
 }
 
+#if MXNET_ENGINE_LOCKFREE_VAR
+inline void ThreadedVar::AppendReadDependency(OprBlock* opr_block) {
+  // fast path: no pending write, only bump the number of pending reads.
+  int64_t state = state_.load();
+  while (!has_pending_write(state)) {
+    CHECK_GE(num_reads(state), 0);
+    if (state_.compare_exchange_weak(state, make_state(false, num_reads(state) + 1))) {
+      opr_block->decr_wait();
+      return;
+    }
+  }
+  std::lock_guard<std::mutex> lock{mutex_};
+  // the pending write bit is only set and cleared under the lock,
+  // re-check it as it may have been cleared meanwhile.
+  state = state_.load();
+  while (!has_pending_write(state)) {
+    CHECK_GE(num_reads(state), 0);
+    if (state_.compare_exchange_weak(state, make_state(false, num_reads(state) + 1))) {
+      opr_block->decr_wait();
+      return;
+    }
+  }
+  auto&& new_var_block = VersionedVarBlock::New();
+  assert(head_->next == nullptr);
+  assert(head_->trigger == nullptr);
+  assert(head_->write == false);
+  // append things to next.
+  head_->next    = new_var_block;
+  head_->trigger = opr_block;
+  head_          = new_var_block;
+}
+
+inline void ThreadedVar::AppendWriteDependency(OprBlock* opr_block) {
+  auto&& new_var_block = VersionedVarBlock::New();
+  std::lock_guard<std::mutex> lock{mutex_};
+  // invariant.
+  assert(head_->next == nullptr);
+  assert(head_->trigger == nullptr);
+  assert(head_->write == false);
+  // attach to head.
+  head_->next    = new_var_block;
+  head_->trigger = opr_block;
+  head_->write   = true;
+
+  // check if it is ready to write
+  if (pending_write_ == nullptr) {
+    // invariant: is_ready_to_read()
+    // publish pending_write_ before the bit that lets readers observe it
+    pending_write_ = head_;
+    int64_t state  = state_.load();
+    bool triggered = false;
+    do {
+      CHECK_GE(num_reads(state), 0);
+      triggered = num_reads(state) == 0;
+    } while (!state_.compare_exchange_weak(
+        state, make_state(true, triggered ? kWriteTriggered : num_reads(state))));
+    if (triggered) {
+      // STATE CHANGE
+      opr_block->decr_wait();
+    }
+  } else {
+    CHECK_NE(num_reads(state_.load()), 0);
+  }
+  head_ = new_var_block;
+}
+
+template <typename Dispatcher>
+inline void ThreadedVar::CompleteReadDependency(Dispatcher dispatcher) {
+  // Lock free: while reads are pending, pending_write_ cannot change,
+  // so the last reader can trigger it right away.
+  OprBlock* trigger = nullptr;
+  int64_t state     = state_.load();
+  while (true) {
+    const int32_t reads = num_reads(state);
+    CHECK_GT(reads, 0);
+    const bool pending_write = has_pending_write(state);
+    const bool fire          = pending_write && reads == 1;
+    if (state_.compare_exchange_weak(
+            state, make_state(pending_write, fire ? kWriteTriggered : reads - 1))) {
+      if (fire) {
+        // STATE CHANGE
+        trigger = pending_write_->trigger;
+      }
+      break;
+    }
+  }
+  if (trigger != nullptr && trigger->decr_wait() == 0) {
+    dispatcher(trigger);
+  }
+}
+
+template <typename Dispatcher>
+inline bool ThreadedVar::CompleteWriteDependency(Dispatcher dispatcher) {
+  // this is lock scope
+  VersionedVarBlock *old_pending_write, *end_of_read_chain;
+  OprBlock* trigger_write = nullptr;
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    // invariants
+    assert(head_->next == nullptr);
+    assert(pending_write_ != nullptr);
+    CHECK_EQ(num_reads(state_.load()), kWriteTriggered);
+
+    // increment version number
+    ++version_;
+
+    // really delete
+    if (to_delete_) {
+      VersionedVarBlock* head = pending_write_->next;
+      VersionedVarBlock::Delete(pending_write_);
+      assert(head_ == head);
+      VersionedVarBlock::Delete(head);
+      return true;
+    }
+    // detach pending write
+    old_pending_write = pending_write_;
+    // search for chains to trigger
+    end_of_read_chain = old_pending_write->next;
+    // While the write is triggered no reader touches state_ without the lock,
+    // so the new state can be computed locally and stored at once.
+    int32_t num_pending_reads = 0;
+    while (end_of_read_chain != head_ && end_of_read_chain->write == false) {
+      ++num_pending_reads;
+      end_of_read_chain = end_of_read_chain->next;
+    }
+    if (end_of_read_chain == head_) {
+      pending_write_ = nullptr;
+    } else {
+      // check if there is pending reads, if not trigger write
+      assert(end_of_read_chain->write == true);
+      pending_write_ = end_of_read_chain;
+      if (num_pending_reads == 0) {
+        // mark write as already activated in this var
+        num_pending_reads = kWriteTriggered;
+        trigger_write     = end_of_read_chain->trigger;
+      }
+    }
+    state_.store(make_state(pending_write_ != nullptr, num_pending_reads));
+  }
+  // This is outside of lock scope
+  // The linked list \in [old_pending_write, end_of_read_chain)
+  // is already detached from this Var.
+  // So it is safe to modify these
+  VersionedVarBlock* cur_head = old_pending_write->next;
+  VersionedVarBlock::Delete(old_pending_write);
+  // dispatch all the events
+  while (cur_head != end_of_read_chain) {
+    if (cur_head->trigger->decr_wait() == 0) {
+      dispatcher(cur_head->trigger);
+    }
+    auto prev = cur_head;
+    cur_head  = cur_head->next;
+    assert(cur_head != nullptr);
+    VersionedVarBlock::Delete(prev);
+  }
+  if (trigger_write != nullptr && trigger_write->decr_wait() == 0) {
+    dispatcher(trigger_write);
+  }
+  return false;
+}
+#else
 inline void ThreadedVar::AppendReadDependency(OprBlock* opr_block) {
   std::lock_guard<std::mutex> lock{mutex_};
   if (pending_write_ == nullptr) {
@@ -186,6 +347,7 @@ inline bool ThreadedVar::CompleteWriteDependency(Dispatcher dispatcher) {
   }
   return false;
 }
+#endif  // MXNET_ENGINE_LOCKFREE_VAR
 
 inline void ThreadedVar::SetToDelete() {
   std::lock_guard<std::mutex> lock{mutex_};
@@ -193,8 +355,16 @@ inline void ThreadedVar::SetToDelete() {
 }
 
 inline bool ThreadedVar::ready_to_read() {
+#if MXNET_ENGINE_LOCKFREE_VAR
+  return this->is_ready_to_read();
+#else
   std::lock_guard<std::mutex> lock{mutex_};
   return this->is_ready_to_read();
+#endif
+}
+
+inline bool ThreadedVar::idle() {
+  return ready_to_read();
 }
 
 inline size_t ThreadedVar::version() {
@@ -300,6 +470,11 @@ void ThreadedEngine::Push(OprHandle op, Context exec_ctx, int priority, bool pro
   opr_block->ctx       = exec_ctx;
   opr_block->priority  = priority;
   opr_block->profiling = profiling;
+  opr_block->stream    = BulkStatusStore::Get()->stream;
+  if (stats_) {
+    opr_block->push_ns = EngineStats::NowNs();
+    stats_->OnPush();
+  }
   ++pending_;
   // Add read dependencies.
   for (auto&& i : threaded_opr->const_vars) {
@@ -310,6 +485,9 @@ void ThreadedEngine::Push(OprHandle op, Context exec_ctx, int priority, bool pro
     i->AppendWriteDependency(opr_block);
   }
   if (opr_block->decr_wait() == 0) {
+    if (stats_) {
+      stats_->OnReady();
+    }
     this->PushToExecute(opr_block, true);
   }
 }
@@ -335,7 +513,8 @@ void ThreadedEngine::PushAsync(AsyncFn fn,
         << ", Valid device id should be less than device_count: " << device_count_;
   }
 #endif
-  const bool profiling = profiler_->IsProfiling(profiler::Profiler::kImperative);
+  const bool profiling =
+      profiler_->IsProfiling(profiler::Profiler::kImperative) && profiler_->IsSampled();
   ThreadedOpr* opr     = NewOperator(std::move(fn), const_vars, mutable_vars, prop, opr_name, wait);
   opr->temporary       = true;
   Push(opr, exec_ctx, priority, profiling);
@@ -458,9 +637,16 @@ void ThreadedEngine::WaitForAll() {
 
 inline void ThreadedEngine::OnComplete(ThreadedOpr* threaded_opr) {
   bool is_temporary_opr = threaded_opr->temporary;
+  int fanout            = 0;
   // Mark complete for read variables
   for (auto&& i : threaded_opr->const_vars) {
-    i->CompleteReadDependency([this](OprBlock* opr) { this->PushToExecute(opr, false); });
+    i->CompleteReadDependency([this, &fanout](OprBlock* opr) {
+      if (stats_) {
+        ++fanout;
+        stats_->OnReady();
+      }
+      this->PushToExecute(opr, false);
+    });
   }
   // Mark complete for write variables.
   for (auto&& i : threaded_opr->mutable_vars) {
@@ -474,11 +660,15 @@ inline void ThreadedEngine::OnComplete(ThreadedOpr* threaded_opr) {
     if (debug_info) {
       LOG(INFO) << "Complete write dep for " << i;
     }
-    const bool to_delete = i->CompleteWriteDependency([this, debug_info](OprBlock* opr) {
+    const bool to_delete = i->CompleteWriteDependency([this, debug_info, &fanout](OprBlock* opr) {
       if (debug_info) {
         LOG(INFO) << "PushToExecute " << opr;
         debug_push_opr_ = opr;
       }
+      if (stats_) {
+        ++fanout;
+        stats_->OnReady();
+      }
       this->PushToExecute(opr, false);
       if (debug_info) {
         LOG(INFO) << "Fin PushToExecute " << opr;
@@ -496,6 +686,9 @@ inline void ThreadedEngine::OnComplete(ThreadedOpr* threaded_opr) {
       ThreadedVar::Delete(i);
     }
   }
+  if (stats_) {
+    stats_->OnComplete(fanout);
+  }
   // The function been pushed from `ThreadedEngine::DeleteOperator`
   // could execute right after we mark all vars as complete, so if
   // threaded_opr is not temporary, its value is not reliable
@@ -570,15 +763,14 @@ static inline bool IsEngineAsync() {
   return tag_pos != std::string::npos;
 }
 
-void ThreadedEngine::OnStartCPU(Engine* engine, void* opr_block, const dmlc::Error* error) {
-  static bool use_new_dep_engine = IsEngineAsync();
-  if (!use_new_dep_engine) {
-    return;
-  }
-  ThreadedOpr* threaded_opr = static_cast<OprBlock*>(opr_block)->opr;
-  std::unordered_map<cudaStream_t, EventInfo> event_per_stream;
-  for (auto* read_var : threaded_opr->const_vars) {
-    auto& sync_obj = read_var->sync_object;
+/*!
+ * \brief Collect, per stream, the latest CUDA events of the GPU operators that a CPU operator
+ *        depends on: the readers and the writer of all its variables.
+ */
+static void CollectCPUDependencyEvents(ThreadedOpr* threaded_opr,
+                                       std::unordered_map<cudaStream_t, EventInfo>* events) {
+  auto collect = [events](ThreadedVar* var) {
+    auto& sync_obj = var->sync_object;
     std::lock_guard<std::mutex> l(sync_obj.mutex);
     auto& reader_events = sync_obj.reader_events;
     // check for expired events and delete them
@@ -587,43 +779,55 @@ void ThreadedEngine::OnStartCPU(Engine* engine, void* opr_block, const dmlc::Err
                                        [&](const EventInfo e_i) { return e_i.event.expired(); }),
                         reader_events.end());
     for (auto& cuda_event : reader_events) {
-      AddEventHelper(&event_per_stream, cuda_event);
+      AddEventHelper(events, cuda_event);
     }
     if (!sync_obj.writer_event.empty()) {
       if (sync_obj.writer_event[0].event.expired()) {
         sync_obj.writer_event.clear();
       } else {
-        AddEventHelper(&event_per_stream, sync_obj.writer_event[0]);
+        AddEventHelper(events, sync_obj.writer_event[0]);
       }
     }
+  };
+  for (auto* read_var : threaded_opr->const_vars) {
+    collect(read_var);
   }
-
   for (auto* write_var : threaded_opr->mutable_vars) {
-    auto& sync_obj = write_var->sync_object;
-    std::lock_guard<std::mutex> l(sync_obj.mutex);
-    auto& reader_events = sync_obj.reader_events;
-    // check for expired events and delete them
-    reader_events.erase(std::remove_if(reader_events.begin(),
-                                       reader_events.end(),
-                                       [&](const EventInfo e_i) { return e_i.event.expired(); }),
-                        reader_events.end());
-    for (auto& cuda_event : reader_events) {
-      AddEventHelper(&event_per_stream, cuda_event);
-    }
-    if (!sync_obj.writer_event.empty()) {
-      if (sync_obj.writer_event[0].event.expired()) {
-        sync_obj.writer_event.clear();
-      } else {
-        AddEventHelper(&event_per_stream, sync_obj.writer_event[0]);
-      }
-    }
+    collect(write_var);
   }
+}
+
+void ThreadedEngine::OnStartCPU(Engine* engine, void* opr_block, const dmlc::Error* error) {
+  static bool use_new_dep_engine = IsEngineAsync();
+  if (!use_new_dep_engine) {
+    return;
+  }
+  ThreadedOpr* threaded_opr = static_cast<OprBlock*>(opr_block)->opr;
+  std::unordered_map<cudaStream_t, EventInfo> event_per_stream;
+  CollectCPUDependencyEvents(threaded_opr, &event_per_stream);
   for (auto event : event_per_stream) {
     auto ev = event.second.event.lock();
     MSHADOW_CUDA_CALL(cudaEventSynchronize(*ev));
   }
 }
 
+bool ThreadedEngine::CPUDependenciesReady(OprBlock* opr_block) {
+  static bool use_new_dep_engine = IsEngineAsync();
+  if (!use_new_dep_engine) {
+    return true;
+  }
+  std::unordered_map<cudaStream_t, EventInfo> event_per_stream;
+  CollectCPUDependencyEvents(opr_block->opr, &event_per_stream);
+  for (auto event : event_per_stream) {
+    auto ev = event.second.event.lock();
+    // other errors are left to OnStartCPU to report
+    if (ev && cudaEventQuery(*ev) == cudaErrorNotReady) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void ThreadedEngine::OnStartGPU(Engine* engine, void* sync_info, const dmlc::Error* error) {
   static bool use_new_dep_engine = IsEngineAsync();
   if (!use_new_dep_engine) {
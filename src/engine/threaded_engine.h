@@ -34,12 +34,16 @@
 #include <functional>
 #include <condition_variable>
 #include <atomic>
+#include <algorithm>
+#include <chrono>
 #include <utility>
 #include <mutex>
 #include <string>
 #include <thread>
 #include "./engine_impl.h"
+#include "./engine_stats.h"
 #include "../profiler/profiler.h"
+#include "../profiler/annotation.h"
 #include "./openmp.h"
 #include "../common/object_pool.h"
 #include "../profiler/custom_op_profiler.h"
@@ -84,6 +88,10 @@ struct OprBlock : public common::ObjectPoolAllocatable<OprBlock> {
   int priority;
   /*! \brief indicate whether to profile this operator */
   bool profiling{false};
+  /*! \brief time of Push in ns, recorded when engine stats are enabled */
+  int64_t push_ns{0};
+  /*! \brief named stream set by the pushing thread, 0 for the default streams */
+  int stream{0};
   /*! \brief operator execution statistics */
   std::unique_ptr<profiler::ProfileOperator> opr_profile;
   // define possible debug information
@@ -169,6 +177,7 @@ class ThreadedVar final : public Var, public common::ObjectPoolAllocatable<Threa
   /*! \return whether this variable is ready to read. */
   inline bool ready_to_read();
   inline size_t version() override;
+  inline bool idle() override;
   /*!
    * \brief Cast a Var pointer to ThreadedVar pointer
    * \param ptr pointer from base.
@@ -196,11 +205,33 @@ class ThreadedVar final : public Var, public common::ObjectPoolAllocatable<Threa
   // TODO(hotpxl) consider rename head
   /*! \brief internal mutex of the ThreadedVar */
   std::mutex mutex_;
+#if MXNET_ENGINE_LOCKFREE_VAR
+  /*!
+   * \brief number of pending reads and whether there is a pending write, packed
+   *  in one word so that reads can be appended and completed with a CAS.
+   *  The low 32 bits hold the number of pending reads (kWriteTriggered when a
+   *  pending write has been triggered), bit 32 is set iff pending_write_ != nullptr.
+   *  The mutex is only taken to modify the linked list or the pending write.
+   */
+  std::atomic<int64_t> state_{0};
+  /*! \brief bit of state_ marking a pending write */
+  static constexpr int64_t kPendingWriteBit = static_cast<int64_t>(1) << 32;
+  static inline int32_t num_reads(int64_t state) {
+    return static_cast<int32_t>(static_cast<uint32_t>(state));
+  }
+  static inline bool has_pending_write(int64_t state) {
+    return (state & kPendingWriteBit) != 0;
+  }
+  static inline int64_t make_state(bool pending_write, int32_t reads) {
+    return (pending_write ? kPendingWriteBit : 0) | static_cast<uint32_t>(reads);
+  }
+#else
   /*!
    * \brief number of pending reads operation in the variable.
    *  will be marked as -1 when there is a already triggered pending write.
    */
   int num_pending_reads_{0};
+#endif  // MXNET_ENGINE_LOCKFREE_VAR
   /*!
    * \brief Points to the last VersionedVarBlock in the queue.
    *  head_ always points to a empty VersionedVarBlock.
@@ -227,7 +258,11 @@ class ThreadedVar final : public Var, public common::ObjectPoolAllocatable<Threa
    * \return whether the current variable is ready to read.
    */
   inline bool is_ready_to_read() const {
+#if MXNET_ENGINE_LOCKFREE_VAR
+    return !has_pending_write(state_.load());
+#else
     return pending_write_ == nullptr;
+#endif
   }
 };  // struct ThreadedVar
 
@@ -317,7 +352,9 @@ class ThreadedEngine : public Engine {
   }
 
   ThreadedEngine() {
-    engine_info_ = dmlc::GetEnv("MXNET_ENGINE_INFO", false);
+    engine_info_       = dmlc::GetEnv("MXNET_ENGINE_INFO", false);
+    bulk_target_ns_    = int64_t{dmlc::GetEnv("MXNET_ENGINE_BULK_TARGET_US", 0)} * 1000;
+    bulk_max_adaptive_ = std::max(dmlc::GetEnv("MXNET_ENGINE_BULK_MAX_NODE", 256), 1);
 
     objpool_opr_ref_    = common::ObjectPool<ThreadedOpr>::_GetSharedRef();
     objpool_blk_ref_    = common::ObjectPool<OprBlock>::_GetSharedRef();
@@ -326,6 +363,8 @@ class ThreadedEngine : public Engine {
 
     storage_ref_ = Storage::_GetSharedRef();
 
+    stats_ = EngineStats::Get()->enabled() ? EngineStats::Get() : nullptr;
+
     // Get a ref to the profiler so that it doesn't get killed before us
     profiler::Profiler::Get(&profiler_);
   }
@@ -358,6 +397,9 @@ class ThreadedEngine : public Engine {
                        CallbackOnStart on_start,
                        CallbackOnComplete callback) {
     ThreadedOpr* threaded_opr = opr_block->opr;
+    if (stats_) {
+      stats_->OnStart(opr_block->push_ns);
+    }
     if (opr_block->profiling && threaded_opr->opr_name.size()) {
       std::unique_ptr<profiler::ProfileOperator::Attributes> attrs;
       if (profiler_->AggregateEnabled()) {
@@ -380,6 +422,9 @@ class ThreadedEngine : public Engine {
           LOG(INFO) << "ExecuteOprFn ";
         }
         try {
+          static const std::string unnamed_opr("Op");
+          profiler::AnnotationRange range(
+              threaded_opr->opr_name.empty() ? unnamed_opr : threaded_opr->opr_name);
           if ((!(threaded_opr->opr_exception && *threaded_opr->opr_exception) ||
                threaded_opr->prop == FnProperty::kNoSkip) ||
               threaded_opr->wait) {
@@ -434,11 +479,28 @@ class ThreadedEngine : public Engine {
     return bulk_size;
   }
 
+  int stream() const override {
+    return BulkStatusStore::Get()->stream;
+  }
+
+  int set_stream(int stream) override {
+    CHECK_GE(stream, 0) << "Invalid stream " << stream;
+    // the bulk pending is pushed on the previous stream
+    BulkFlush();
+    std::swap(BulkStatusStore::Get()->stream, stream);
+    return stream;
+  }
+
  protected:
   static void OnStartStatic(Engine* engine, void* opr_block, const dmlc::Error* error);
   static void OnCompleteStatic(Engine* engine, void* threaded_opr, const dmlc::Error* error);
 #if MXNET_USE_CUDA
   static void OnStartCPU(Engine* engine, void* opr_block, const dmlc::Error* error);
+  /*!
+   * \brief Whether the GPU operators a CPU operator waits for in OnStartCPU are all done,
+   *        without blocking. Always true unless the engine is asynchronous.
+   */
+  static bool CPUDependenciesReady(OprBlock* opr_block);
   static void OnStartGPU(Engine* engine, void* sync_info, const dmlc::Error* error);
   static void OnCompleteGPU(Engine* engine, void* sync_info, const dmlc::Error* error);
   struct GPUWorkerSyncInfo : public common::ObjectPoolAllocatable<GPUWorkerSyncInfo> {
@@ -465,8 +527,10 @@ class ThreadedEngine : public Engine {
     std::vector<VarHandle> const_vars;
     /*! \brief mutable variables */
     std::vector<VarHandle> mutable_vars;
+    /*! \brief stream of the operators pushed by the thread */
+    int stream = 0;
   };
-  /*! thread local store for bulk */
+  /*! thread local store for bulk and stream */
   typedef dmlc::ThreadLocalStore<BulkStatus> BulkStatusStore;
 
   /*!
@@ -544,23 +608,63 @@ class ThreadedEngine : public Engine {
     bulk_status.mutable_vars.insert(
         bulk_status.mutable_vars.end(), mutable_vars.begin(), mutable_vars.end());
 
-    if (bulk_status.count >= bulk_status.bulk_size)
+    if (bulk_status.count >= BulkLimit(bulk_status.bulk_size))
       BulkFlush();
   }
+  /*!
+   * \brief number of ops after which the current bulk is flushed.
+   *  With MXNET_ENGINE_BULK_TARGET_US set, it is sized so that a segment runs for
+   *  about the target duration given the measured average op time,
+   *  otherwise it is the fixed bulk size.
+   */
+  inline int BulkLimit(int bulk_size) const {
+    if (bulk_target_ns_ <= 0)
+      return bulk_size;
+    const int64_t op_ns = bulk_op_ns_.load(std::memory_order_relaxed);
+    if (op_ns <= 0)
+      return bulk_size;
+    const int64_t limit = bulk_target_ns_ / op_ns;
+    return static_cast<int>(std::min<int64_t>(std::max<int64_t>(limit, 1), bulk_max_adaptive_));
+  }
+  /*!
+   * \brief feed the measured duration of a bulk segment into the moving
+   *  average of the op execution time.
+   */
+  inline void RecordBulkTime(int64_t elapsed_ns, size_t num_ops) {
+    if (num_ops == 0)
+      return;
+    const int64_t sample = std::max<int64_t>(elapsed_ns / static_cast<int64_t>(num_ops), 1);
+    const int64_t prev   = bulk_op_ns_.load(std::memory_order_relaxed);
+    // exponential moving average with weight 1/8, races between workers only lose samples
+    bulk_op_ns_.store(prev == 0 ? sample : prev + (sample - prev) / 8, std::memory_order_relaxed);
+  }
   /*! \brief flush current bulk to execution */
   inline void BulkFlush() {
     BulkStatus& bulk_status = *BulkStatusStore::Get();
     if (!bulk_status.count)
       return;
+    if (stats_) {
+      stats_->OnBulkFlush(bulk_status.count);
+    }
     bulk_status.count = 0;
     DeduplicateVarHandle(&bulk_status.const_vars, &bulk_status.mutable_vars);
-    auto functions = bulk_status.functions;
+    auto functions      = bulk_status.functions;
+    const bool adaptive = bulk_target_ns_ > 0;
     this->PushAsync(
-        [functions](RunContext ctx, CallbackOnStart on_start, CallbackOnComplete on_complete) {
+        [this, functions, adaptive](
+            RunContext ctx, CallbackOnStart on_start, CallbackOnComplete on_complete) {
           on_start();
+          const auto start = adaptive ? std::chrono::steady_clock::now() :
+                                        std::chrono::steady_clock::time_point();
           for (auto& fn : *functions) {
             fn(ctx);
           }
+          if (adaptive) {
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            RecordBulkTime(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                functions->size());
+          }
           on_complete();
         },
         bulk_status.ctx,
@@ -584,6 +688,12 @@ class ThreadedEngine : public Engine {
   std::atomic<bool> shutdown_phase_{false};
   /*!\brief show more information from engine actions */
   bool engine_info_{false};
+  /*! \brief target duration of an imperative bulk segment in ns, 0 for fixed bulk size */
+  int64_t bulk_target_ns_{0};
+  /*! \brief upper bound of the adaptive bulk size */
+  int bulk_max_adaptive_{256};
+  /*! \brief moving average of the execution time of a bulked op in ns */
+  std::atomic<int64_t> bulk_op_ns_{0};
   /*! \brief debug information about wait for var. */
   std::atomic<ThreadedVar*> debug_wait_var_{nullptr};
   /*! \brief debug information about wait for var. */
@@ -620,6 +730,9 @@ class ThreadedEngine : public Engine {
   /*! \brief Hold a ref count ot the profiler */
   std::shared_ptr<profiler::Profiler> profiler_;
 
+  /*! \brief engine overhead counters, nullptr if disabled by MXNET_ENGINE_STATS */
+  EngineStats* stats_{nullptr};
+
   /*!
    * \brief Disallow copy construction and assignment.
    * \note This must be last
@@ -28,14 +28,27 @@
 #include <dmlc/concurrency.h>
 #include <dmlc/thread_group.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdlib>
+#include <functional>
 #include <mutex>
 #include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 #include "../initialize.h"
 #include "./threaded_engine.h"
 #include "./thread_pool.h"
+#include "./work_stealing_queue.h"
 #include "../common/lazy_alloc_array.h"
+#include "../common/numa.h"
 #include "../common/utils.h"
-#include "../common/cuda/nvtx.h"
 
 namespace mxnet {
 namespace engine {
@@ -46,6 +59,9 @@ namespace engine {
  *  - Use fixed amount of threads for each device.
  *  - Use special threads for copy operations.
  *  - Each stream is allocated and bound to each of the thread.
+ *  - Named streams of a GPU each have their own worker, with one thread.
+ *  - Optionally, CPU workers of a device pull work from per-worker
+ *    deques and steal from each other instead of sharing one queue.
  */
 class ThreadedEnginePerDevice : public ThreadedEngine {
  public:
@@ -55,8 +71,11 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
   static auto constexpr kPriorityQueue = kPriority;
   static auto constexpr kWorkerQueue   = kFIFO;
   static int constexpr kMaxStreams     = 256;
+  /*! \brief log2 of the capacity of each work-stealing deque */
+  static int constexpr kWorkStealingDequeLog2 = 10;
 
-  ThreadedEnginePerDevice() noexcept(false) {
+  explicit ThreadedEnginePerDevice(bool work_stealing = false) noexcept(false)
+      : work_stealing_(work_stealing) {
 #if MXNET_USE_CUDA
     // Make sure that the pool is not destroyed before the engine
     objpool_gpu_sync_ref_ = common::ObjectPool<GPUWorkerSyncInfo>::_GetSharedRef();
@@ -69,11 +88,19 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
   }
 
   void StopNoWait() {
+#if MXNET_USE_CUDA
+    {
+      std::lock_guard<std::mutex> lock(cpu_dependency_poller_mutex_);
+      cpu_dependency_poller_.reset();
+    }
+#endif
     SignalQueuesForKill();
     gpu_normal_workers_.Clear();
     gpu_priority_workers_.Clear();
     gpu_copy_workers_.Clear();
+    gpu_stream_workers_.Clear();
     cpu_normal_workers_.Clear();
+    cpu_stealing_workers_.Clear();
     cpu_priority_worker_.reset(nullptr);
 #if MXNET_USE_CUDA
     streams_.clear();
@@ -97,13 +124,28 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
   }
 #endif
 
+  int CreateStream(const Context& ctx, const std::string& name, int priority) override {
+    CHECK_EQ(ctx.dev_mask(), Context::kGPU) << "Streams are created on GPUs, not on " << ctx;
+    std::lock_guard<std::mutex> lock(named_streams_mutex_);
+    for (size_t i = 0; i < named_streams_.size(); ++i) {
+      if (named_streams_[i].ctx == ctx && named_streams_[i].name == name)
+        return static_cast<int>(i) + 1;
+    }
+    named_streams_.push_back(NamedStream{ctx, name, priority});
+    return static_cast<int>(named_streams_.size());
+  }
+
   void Start() override {
     if (is_worker_)
       return;
-    gpu_worker_nthreads_ = common::GetNumThreadsPerGPU();
+    gpu_worker_nthreads_ =
+        ParseNumThreadsPerGPU("MXNET_GPU_WORKER_NTHREADS", common::GetNumThreadsPerGPU());
     // MXNET_CPU_WORKER_NTHREADS
     cpu_worker_nthreads_ = LibraryInitializer::Get()->cpu_worker_nthreads_;
-    gpu_copy_nthreads_   = dmlc::GetEnv("MXNET_GPU_COPY_NTHREADS", 2);
+#if MXNET_USE_CUDA
+    poll_gpu_dependencies_ = dmlc::GetEnv("MXNET_ENGINE_POLL_GPU_DEPENDENCIES", true);
+#endif
+    gpu_copy_nthreads_   = ParseNumThreadsPerGPU("MXNET_GPU_COPY_NTHREADS", 2);
     // create CPU task
     int cpu_priority_nthreads  = dmlc::GetEnv("MXNET_CPU_PRIORITY_NTHREADS", 4);
     cpu_priority_worker_       = std::make_unique<ThreadWorkerBlock<kPriorityQueue>>();
@@ -134,36 +176,25 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     } else {
       if (ctx.dev_mask() == Context::kCPU) {
         // CPU execution.
-        if (opr_block->opr->prop == FnProperty::kCPUPrioritized) {
-          cpu_priority_worker_->task_queue.Push(opr_block, opr_block->priority);
-        } else {
-          int dev_id  = ctx.dev_id;
-          int nthread = cpu_worker_nthreads_;
-          auto ptr    = cpu_normal_workers_.Get(dev_id, [this, ctx, nthread]() {
-            auto blk  = new ThreadWorkerBlock<kWorkerQueue>();
-            blk->pool = std::make_unique<ThreadPool>(
-                nthread,
-                [this, ctx, blk](std::shared_ptr<dmlc::ManualEvent> ready_event) {
-                  this->CPUWorker(ctx, blk, ready_event);
-                },
-                true);
-            return blk;
-          });
-          if (ptr) {
-            if (opr_block->opr->prop == FnProperty::kDeleteVar) {
-              ptr->task_queue.PushFront(opr_block, opr_block->priority);
-            } else {
-              ptr->task_queue.Push(opr_block, opr_block->priority);
-            }
-          }
+#if MXNET_USE_CUDA
+        // a task waiting for GPU producers is queued once they are done, not parked on a worker
+        if (poll_gpu_dependencies_ && !CPUDependenciesReady(opr_block)) {
+          GetCPUDependencyPoller()->Push(opr_block);
+          return;
         }
+#endif
+        PushToCPUWorker(opr_block);
       } else {
         CHECK_EQ(ctx.dev_mask(), Context::kGPU);
         // GPU execution.
         const FnProperty prop = opr_block->opr->prop;
         const bool is_copy = (prop == FnProperty::kCopyFromGPU || prop == FnProperty::kCopyToGPU);
-        if (is_copy) {
-          const size_t nthread = gpu_copy_nthreads_;
+        NamedStream named_stream;
+        if (!is_copy && opr_block->stream != 0 && prop != FnProperty::kGPUPrioritized &&
+            GetNamedStream(opr_block->stream, &named_stream) && named_stream.ctx == ctx) {
+          PushToStreamWorker(opr_block, named_stream);
+        } else if (is_copy) {
+          const size_t nthread = NumThreadsOf(gpu_copy_nthreads_, ctx);
           auto ptr             = gpu_copy_workers_.Get(ctx.dev_id, [this, ctx, is_copy, nthread]() {
             // Signify to kernel that GPU is being used, so reserve cores as necessary
             OpenMP::Get()->set_reserve_cores(GetReserveCoreCount(true));
@@ -184,7 +215,7 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
             }
           }
         } else {
-          const size_t nthread = gpu_worker_nthreads_;
+          const size_t nthread = NumThreadsOf(gpu_worker_nthreads_, ctx);
           // GPU priority task
           if (opr_block->opr->prop == FnProperty::kGPUPrioritized) {
             auto ptr = gpu_priority_workers_.Get(ctx.dev_id, [this, ctx, is_copy, nthread]() {
@@ -242,17 +273,235 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     // destructor
     ~ThreadWorkerBlock() = default;
   };
+  // working unit whose threads each own a deque and steal from each other.
+  struct StealingWorkerBlock {
+    // task queue on this task
+    WorkStealingQueue<OprBlock*> task_queue;
+    // thread pool that works on this task
+    std::unique_ptr<ThreadPool> pool;
+    // constructor
+    explicit StealingWorkerBlock(size_t nthread) : task_queue(nthread, kWorkStealingDequeLog2) {}
+  };
+
+  // named stream of a GPU
+  struct NamedStream {
+    Context ctx;
+    std::string name;
+    int priority;
+  };
+
+  /*! \brief get the named stream of an id, false for an id no stream was created with */
+  inline bool GetNamedStream(int stream, NamedStream* out) {
+    std::lock_guard<std::mutex> lock(named_streams_mutex_);
+    if (stream < 1 || static_cast<size_t>(stream) > named_streams_.size())
+      return false;
+    *out = named_streams_[stream - 1];
+    return true;
+  }
+
+  /*! \brief push a GPU task to the single thread worker of its named stream */
+  inline void PushToStreamWorker(OprBlock* opr_block, const NamedStream& named_stream) {
+    const Context ctx  = opr_block->ctx;
+    const int priority = named_stream.priority;
+    auto ptr = gpu_stream_workers_.Get(opr_block->stream, [this, ctx, priority]() {
+      // Signify to kernel that GPU is being used, so reserve cores as necessary
+      OpenMP::Get()->set_reserve_cores(GetReserveCoreCount(true));
+      auto blk  = new ThreadWorkerBlock<kWorkerQueue>();
+      blk->pool = std::make_unique<ThreadPool>(
+          1,
+          [this, ctx, priority, blk](std::shared_ptr<dmlc::ManualEvent> ready_event) {
+            this->GPUWorker(ctx, false, blk, ready_event, priority);
+          },
+          true);
+      return blk;
+    });
+    if (ptr) {
+      if (opr_block->opr->prop == FnProperty::kDeleteVar) {
+        ptr->task_queue.PushFront(opr_block, opr_block->priority);
+      } else {
+        ptr->task_queue.Push(opr_block, opr_block->priority);
+      }
+    }
+  }
+
+  /*!
+   * \brief Read a number of threads per GPU: one number for all the GPUs, or a comma separated
+   *  list indexed by device id whose last number also applies to the following GPUs.
+   */
+  static std::vector<size_t> ParseNumThreadsPerGPU(const char* env, size_t default_value) {
+    std::vector<size_t> nthreads;
+    const std::string value = dmlc::GetEnv(env, std::string());
+    std::istringstream is(value);
+    std::string item;
+    while (std::getline(is, item, ',')) {
+      char* end         = nullptr;
+      errno             = 0;
+      const long number = std::strtol(item.c_str(), &end, 10);
+      CHECK(end != item.c_str() && *end == '\0' && errno == 0 && number > 0 && number <= INT_MAX)
+          << env << " must be a positive number or a comma separated list of positive numbers, "
+          << "got \"" << value << "\"";
+      nthreads.push_back(number);
+    }
+    if (nthreads.empty())
+      nthreads.push_back(default_value);
+    return nthreads;
+  }
+
+  static size_t NumThreadsOf(const std::vector<size_t>& nthreads, const Context& ctx) {
+    return nthreads[std::min<size_t>(ctx.dev_id, nthreads.size() - 1)];
+  }
+
+  /*! \brief push a CPU task to the worker of its kind */
+  inline void PushToCPUWorker(OprBlock* opr_block) {
+    const Context ctx = opr_block->ctx;
+    if (opr_block->opr->prop == FnProperty::kCPUPrioritized) {
+      cpu_priority_worker_->task_queue.Push(opr_block, opr_block->priority);
+    } else if (work_stealing_) {
+      PushToStealingWorker(opr_block);
+    } else {
+      int dev_id  = ctx.dev_id;
+      int nthread = cpu_worker_nthreads_;
+      auto ptr    = cpu_normal_workers_.Get(dev_id, [this, ctx, nthread]() {
+        auto blk  = new ThreadWorkerBlock<kWorkerQueue>();
+        blk->pool = std::make_unique<ThreadPool>(
+            nthread,
+            [this, ctx, blk](std::shared_ptr<dmlc::ManualEvent> ready_event) {
+              this->CPUWorker(ctx, blk, ready_event, NumaNodeOf(ctx));
+            },
+            true);
+        return blk;
+      });
+      if (ptr) {
+        if (opr_block->opr->prop == FnProperty::kDeleteVar) {
+          ptr->task_queue.PushFront(opr_block, opr_block->priority);
+        } else {
+          ptr->task_queue.Push(opr_block, opr_block->priority);
+        }
+      }
+    }
+  }
+
+#if MXNET_USE_CUDA
+  /*!
+   * \brief Holds the CPU tasks whose GPU producers are still running, with the asynchronous
+   *        engine. One thread polls their CUDA events and queues each task to its CPU worker
+   *        once all of them fired, so that no CPU worker blocks in OnStartCPU.
+   */
+  class CPUDependencyPoller {
+   public:
+    explicit CPUDependencyPoller(std::function<void(OprBlock*)> on_ready)
+        : on_ready_(std::move(on_ready)), thread_([this]() { this->Run(); }) {}
+
+    /*! \brief stops polling, the tasks still waiting are queued to their CPU workers */
+    ~CPUDependencyPoller() {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+      }
+      cv_.notify_one();
+      thread_.join();
+    }
+
+    void Push(OprBlock* opr_block) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.push_back(opr_block);
+      }
+      cv_.notify_one();
+    }
+
+   private:
+    void Run() {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (!stop_) {
+        if (pending_.empty()) {
+          cv_.wait(lock);
+          continue;
+        }
+        auto it = std::stable_partition(pending_.begin(), pending_.end(), [](OprBlock* opr_block) {
+          return !CPUDependenciesReady(opr_block);
+        });
+        std::vector<OprBlock*> ready(it, pending_.end());
+        pending_.erase(it, pending_.end());
+        lock.unlock();
+        for (OprBlock* opr_block : ready) {
+          on_ready_(opr_block);
+        }
+        lock.lock();
+        if (ready.empty()) {
+          cv_.wait_for(lock, std::chrono::microseconds(kPollIntervalUs));
+        }
+      }
+      // the CPU workers wait for the events of these in OnStartCPU, so they are not dropped
+      std::vector<OprBlock*> remaining;
+      remaining.swap(pending_);
+      lock.unlock();
+      for (OprBlock* opr_block : remaining) {
+        on_ready_(opr_block);
+      }
+    }
+
+    static constexpr int kPollIntervalUs = 20;
+    std::function<void(OprBlock*)> on_ready_;
+    std::vector<OprBlock*> pending_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::thread thread_;
+  };
+
+  /*! \brief get the poller of the CPU tasks waiting for GPU producers, created on first use */
+  inline CPUDependencyPoller* GetCPUDependencyPoller() {
+    std::lock_guard<std::mutex> lock(cpu_dependency_poller_mutex_);
+    if (!cpu_dependency_poller_) {
+      cpu_dependency_poller_ = std::make_unique<CPUDependencyPoller>(
+          [this](OprBlock* opr_block) { this->PushToCPUWorker(opr_block); });
+    }
+    return cpu_dependency_poller_.get();
+  }
+#endif
+
+  /*! \brief push a normal CPU task to the work-stealing workers of its device */
+  inline void PushToStealingWorker(OprBlock* opr_block) {
+    const Context ctx = opr_block->ctx;
+    const int nthread = cpu_worker_nthreads_;
+    auto ptr          = cpu_stealing_workers_.Get(ctx.dev_id, [this, ctx, nthread]() {
+      auto blk  = new StealingWorkerBlock(nthread);
+      blk->pool = std::make_unique<ThreadPool>(
+          nthread,
+          [this, ctx, blk](std::shared_ptr<dmlc::ManualEvent> ready_event) {
+            blk->task_queue.RegisterWorker();
+            this->CPUWorker(ctx, blk, ready_event, NumaNodeOf(ctx));
+          },
+          true);
+      return blk;
+    });
+    if (ptr) {
+      if (opr_block->opr->prop == FnProperty::kDeleteVar) {
+        ptr->task_queue.PushFront(opr_block, opr_block->priority);
+      } else {
+        ptr->task_queue.Push(opr_block, opr_block->priority);
+      }
+    }
+  }
 
   /*! \brief whether this is a worker thread. */
   static MX_THREAD_LOCAL bool is_worker_;
+  /*! \brief whether normal CPU tasks are scheduled by work stealing */
+  const bool work_stealing_;
   /*! \brief number of concurrent thread cpu worker uses */
   size_t cpu_worker_nthreads_;
-  /*! \brief number of concurrent thread each gpu worker uses */
-  size_t gpu_worker_nthreads_;
-  /*! \brief number of concurrent thread each gpu copy worker uses */
-  size_t gpu_copy_nthreads_;
+  /*! \brief number of concurrent thread each gpu worker uses, per device id */
+  std::vector<size_t> gpu_worker_nthreads_;
+  /*! \brief number of concurrent thread each gpu copy worker uses, per device id */
+  std::vector<size_t> gpu_copy_nthreads_;
+  /*! \brief named streams, the stream of id i is at i - 1 */
+  std::vector<NamedStream> named_streams_;
+  std::mutex named_streams_mutex_;
   // cpu worker
   common::LazyAllocArray<ThreadWorkerBlock<kWorkerQueue>> cpu_normal_workers_;
+  // cpu workers with work stealing
+  common::LazyAllocArray<StealingWorkerBlock> cpu_stealing_workers_;
   // cpu priority worker
   std::unique_ptr<ThreadWorkerBlock<kPriorityQueue>> cpu_priority_worker_;
   // workers doing normal works on GPU
@@ -261,7 +510,13 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
   common::LazyAllocArray<ThreadWorkerBlock<kCopyQueue>> gpu_copy_workers_;
   // gpu priority workers
   common::LazyAllocArray<ThreadWorkerBlock<kPriorityQueue>> gpu_priority_workers_;
+  // workers of the named streams, by stream id
+  common::LazyAllocArray<ThreadWorkerBlock<kWorkerQueue>> gpu_stream_workers_;
 #if MXNET_USE_CUDA
+  /*! \brief whether CPU tasks waiting for GPU producers are polled instead of blocking */
+  bool poll_gpu_dependencies_ = true;
+  std::unique_ptr<CPUDependencyPoller> cpu_dependency_poller_;
+  std::mutex cpu_dependency_poller_mutex_;
   std::vector<mshadow::Stream<gpu>*> streams_;
 
   std::unordered_map<int, std::unique_ptr<CUDAEventPool>> cuda_event_pool_per_worker_;
@@ -272,12 +527,14 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
    * \param dev_id The device id of the worker.
    * \param is_copy_worker whether the worker only do copy job
    * \param block The task block of the worker.
+   * \param priority CUDA priority of the stream of a compute worker.
    */
   template <dmlc::ConcurrentQueueType type>
   inline void GPUWorker(Context ctx,
                         bool is_copy_worker,
                         ThreadWorkerBlock<type>* block,
-                        const std::shared_ptr<dmlc::ManualEvent>& ready_event) {
+                        const std::shared_ptr<dmlc::ManualEvent>& ready_event,
+                        int priority = 0) {
     this->is_worker_ = true;
 #if MXNET_USE_CUDA
     CHECK(block != nullptr);
@@ -291,9 +548,11 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
       if (is_copy_worker) {
         stream = mshadow::NewStream<gpu>(false, false, ctx.dev_id);
       } else {
-        stream     = mshadow::NewStream<gpu>(true, MXNET_USE_CUDNN != 0, ctx.dev_id);
+        stream     = NewComputeStream(ctx.dev_id, priority);
         aux_stream = new GPUAuxStream(stream);
       }
+      // the memory allocated by the operators of this worker is used on its stream
+      Storage::SetConsumerStream(stream->stream_);
       // With thread safety...
       {
         static std::mutex m;
@@ -320,13 +579,6 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     OpenMP::Get()->on_start_worker_thread(false);
 
     while (task_queue->Pop(&opr_block)) {
-#if MXNET_USE_NVTX
-      auto nvtx_name       = opr_block->opr->opr_name != "" ? opr_block->opr->opr_name : "Op";
-      auto end_pos         = nvtx_name.find('{');
-      auto name_prefix_len = end_pos != std::string::npos ? end_pos : nvtx_name.size();
-      auto color           = common::cuda::nvtx::nameToColor(nvtx_name, name_prefix_len);
-      common::cuda::nvtx::gpuRangeStart(color, nvtx_name);
-#endif
       auto* info                  = ThreadedEngine::GPUWorkerSyncInfo::New();
       info->opr_block             = opr_block;
       info->stream                = stream;
@@ -334,23 +586,50 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
       CallbackOnStart on_start    = this->CreateOnStart(ThreadedEngine::OnStartGPU, info);
       CallbackOnComplete callback = this->CreateCallback(ThreadedEngine::OnCompleteGPU, info);
       this->ExecuteOprBlock(run_ctx, opr_block, on_start, callback);
-#if MXNET_USE_NVTX
-      common::cuda::nvtx::gpuRangeStop();
-#endif
     }
 #else
     ready_event->signal();
 #endif
   }
+#if MXNET_USE_CUDA
+  /*! \brief create the stream of a compute worker, with its blas and cudnn handles */
+  static mshadow::Stream<gpu>* NewComputeStream(int dev_id, int priority) {
+    if (priority == 0)
+      return mshadow::NewStream<gpu>(true, MXNET_USE_CUDNN != 0, dev_id);
+    // the handles are bound to the cuda stream when created, so it is replaced first
+    mshadow::Stream<gpu>* stream = mshadow::NewStream<gpu>(false, false, dev_id);
+    CUDA_CALL(cudaStreamDestroy(stream->stream_));
+    CUDA_CALL(cudaStreamCreateWithPriority(&stream->stream_, cudaStreamDefault, priority));
+    stream->CreateBlasHandle();
+    stream->CreateSolverHandle();
+#if MXNET_USE_CUDNN
+    stream->CreateDnnHandle();
+#endif
+    return stream;
+  }
+#endif
+  /*!
+   * \brief NUMA node the normal CPU workers of a context are pinned to.
+   * \return the node, or -1 when NUMA-aware placement is disabled.
+   */
+  static int NumaNodeOf(const Context& ctx) {
+    const common::NumaTopology* topo = common::NumaTopology::Get();
+    return topo->enabled() ? topo->NodeOfDevice(ctx.dev_id) : -1;
+  }
   /*!
    * \brief CPU worker that performs operations on CPU.
    * \param block The task block of the worker.
+   * \param numa_node NUMA node to pin the worker to, -1 for no pinning.
    */
-  template <dmlc::ConcurrentQueueType type>
+  template <typename Block>
   inline void CPUWorker(Context ctx,
-                        ThreadWorkerBlock<type>* block,
-                        const std::shared_ptr<dmlc::ManualEvent>& ready_event) {
+                        Block* block,
+                        const std::shared_ptr<dmlc::ManualEvent>& ready_event,
+                        int numa_node = -1) {
     this->is_worker_ = true;
+    if (numa_node >= 0 && !common::NumaTopology::Get()->BindThreadToNode(numa_node)) {
+      LOG(WARNING) << "Failed to pin CPU worker of " << ctx << " to NUMA node " << numa_node;
+    }
     auto* task_queue = &(block->task_queue);
     RunContext run_ctx{ctx, nullptr, nullptr};
 
@@ -359,7 +638,7 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     ready_event->signal();
 
     // Set default number of threads for OMP parallel regions initiated by this thread
-    OpenMP::Get()->on_start_worker_thread(true);
+    OpenMP::Get()->on_start_worker_thread(true, numa_node);
 
     while (task_queue->Pop(&opr_block)) {
 #if MXNET_USE_CUDA
@@ -406,6 +685,7 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     SignalQueueForKill(&gpu_normal_workers_);
     SignalQueueForKill(&gpu_copy_workers_);
     SignalQueueForKill(&cpu_normal_workers_);
+    SignalQueueForKill(&cpu_stealing_workers_);
     if (cpu_priority_worker_) {
       cpu_priority_worker_->task_queue.SignalForKill();
     }
@@ -416,6 +696,10 @@ Engine* CreateThreadedEnginePerDevice() {
   return new ThreadedEnginePerDevice();
 }
 
+Engine* CreateThreadedEngineWorkStealing() {
+  return new ThreadedEnginePerDevice(true);
+}
+
 MX_THREAD_LOCAL bool ThreadedEnginePerDevice::is_worker_ = false;
 
 }  // namespace engine
@@ -25,6 +25,7 @@
 #include <dmlc/base.h>
 #include <dmlc/logging.h>
 #include <dmlc/concurrency.h>
+#include <dmlc/parameter.h>
 #include <cassert>
 #include <memory>
 #include <utility>
@@ -75,7 +76,9 @@ class ThreadedEnginePooled : public ThreadedEngine {
   }
 
   void Start() override {
-    streams_ = std::make_unique<StreamManager<kMaxNumGpus, kNumStreamsPerGpu>>();
+    // as many streams as the GPU workers of the per-device engine, when set
+    streams_ = std::make_unique<StreamManager<kMaxNumGpus>>(
+        dmlc::GetEnv("MXNET_GPU_WORKER_NTHREADS", kNumStreamsPerGpu));
     task_queue_.reset(new dmlc::ConcurrentBlockingQueue<OprBlock*>());
     io_task_queue_.reset(new dmlc::ConcurrentBlockingQueue<OprBlock*>());
     thread_pool_ = std::make_unique<ThreadPool>(
@@ -106,12 +109,12 @@ class ThreadedEnginePooled : public ThreadedEngine {
   static constexpr std::size_t kNumWorkingThreads = 16;
   /*! \brief Maximum number of GPUs */
   static constexpr std::size_t kMaxNumGpus = 16;
-  /*!\brief number of streams allocated for each GPU */
+  /*!\brief default number of streams allocated for each GPU */
   static constexpr std::size_t kNumStreamsPerGpu = 16;
   /*!
    * \brief Streams.
    */
-  std::unique_ptr<StreamManager<kMaxNumGpus, kNumStreamsPerGpu>> streams_;
+  std::unique_ptr<StreamManager<kMaxNumGpus>> streams_;
   /*!
    * \brief Task queues.
    */
@@ -0,0 +1,311 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file work_stealing_queue.h
+ * \brief Per-worker lock-free deques with random-victim stealing,
+ *        used by the work-stealing CPU workers of ThreadedEnginePerDevice.
+ */
+#ifndef MXNET_ENGINE_WORK_STEALING_QUEUE_H_
+#define MXNET_ENGINE_WORK_STEALING_QUEUE_H_
+
+#include <dmlc/base.h>
+#include <dmlc/logging.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+namespace mxnet {
+namespace engine {
+
+/*!
+ * \brief Bounded Chase-Lev deque.
+ *  Only the owning thread may call Push and Pop (LIFO end),
+ *  any thread may call Steal (FIFO end).
+ * \tparam T trivially copyable element type, e.g. a pointer.
+ */
+template <typename T>
+class WorkStealingDeque {
+ public:
+  /*!
+   * \brief constructor
+   * \param capacity_log2 log2 of the number of slots of the ring buffer.
+   */
+  explicit WorkStealingDeque(size_t capacity_log2)
+      : mask_((static_cast<int64_t>(1) << capacity_log2) - 1), buffer_(mask_ + 1) {}
+  /*!
+   * \brief push an element to the bottom, owner thread only.
+   * \return false if the deque is full.
+   */
+  inline bool Push(T item) {
+    const int64_t b = bottom_.load(std::memory_order_relaxed);
+    const int64_t t = top_.load(std::memory_order_acquire);
+    if (b - t > mask_)
+      return false;
+    buffer_[b & mask_].store(item, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+    return true;
+  }
+  /*!
+   * \brief pop the most recently pushed element, owner thread only.
+   * \return false if the deque is empty or the last element was stolen.
+   */
+  inline bool Pop(T* out) {
+    const int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+    *out = buffer_[b & mask_].load(std::memory_order_relaxed);
+    if (t != b)
+      return true;
+    // single element left, race against thieves
+    const bool won = top_.compare_exchange_strong(
+        t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+    return won;
+  }
+  /*!
+   * \brief steal the oldest element, callable from any thread.
+   * \return false if the deque is empty or the steal lost a race.
+   */
+  inline bool Steal(T* out) {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b)
+      return false;
+    T item = buffer_[t & mask_].load(std::memory_order_relaxed);
+    if (!top_.compare_exchange_strong(
+            t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+      return false;
+    }
+    *out = item;
+    return true;
+  }
+
+ private:
+  /*! \brief capacity - 1 */
+  const int64_t mask_;
+  /*! \brief index of the oldest element, modified by thieves */
+  alignas(64) std::atomic<int64_t> top_{0};
+  /*! \brief index one past the newest element, modified by the owner */
+  alignas(64) std::atomic<int64_t> bottom_{0};
+  /*! \brief ring buffer */
+  std::vector<std::atomic<T>> buffer_;
+};
+
+/*!
+ * \brief Task queue shared by a fixed set of worker threads.
+ *  Each worker owns a WorkStealingDeque into which it pushes the tasks
+ *  it makes ready itself, idle workers steal from random victims.
+ *  Tasks pushed from outside the worker set, tasks with non-default priority
+ *  and front-pushed tasks go through a shared priority-ordered inbox,
+ *  so that priorities are honored across all workers.
+ */
+template <typename T>
+class WorkStealingQueue {
+ public:
+  /*!
+   * \brief constructor
+   * \param num_workers number of workers that will call Pop.
+   * \param capacity_log2 log2 of capacity of each per-worker deque.
+   */
+  WorkStealingQueue(size_t num_workers, size_t capacity_log2) : num_workers_(num_workers) {
+    CHECK_GT(num_workers, 0);
+    for (size_t i = 0; i < num_workers; ++i) {
+      deques_.emplace_back(new WorkStealingDeque<T>(capacity_log2));
+    }
+  }
+  /*!
+   * \brief register calling thread as a worker of this queue.
+   *  Must be called once by each worker thread before Pop.
+   */
+  inline void RegisterWorker() {
+    const size_t id = next_worker_id_++;
+    CHECK_LT(id, num_workers_) << "Too many workers registered";
+    WorkerSlot* slot = ThisWorkerSlot();
+    slot->owner      = this;
+    slot->index      = id;
+    slot->rng        = static_cast<uint32_t>(id) * 2654435761U + 1U;
+  }
+  /*!
+   * \brief push a task, callable from any thread.
+   * \param item the task.
+   * \param priority priority of the task, larger runs first.
+   */
+  inline void Push(T item, int priority) {
+    const WorkerSlot* slot = ThisWorkerSlot();
+    if (priority == 0 && slot->owner == this && deques_[slot->index]->Push(item)) {
+      ++num_local_;
+      if (num_sleeping_.load() > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cv_.notify_one();
+      }
+      return;
+    }
+    PushInbox(item, priority);
+  }
+  /*!
+   * \brief push a task ahead of every other pending task.
+   */
+  inline void PushFront(T item, int /*priority*/) {
+    PushInbox(item, std::numeric_limits<int>::max());
+  }
+  /*!
+   * \brief pop a task, blocks until a task is available.
+   *  Must be called from a registered worker thread.
+   * \return false if the queue was signaled for kill.
+   */
+  inline bool Pop(T* out) {
+    const size_t self = ThisWorkerSlot()->index;
+    while (true) {
+      if (TryPop(self, out))
+        return true;
+      std::unique_lock<std::mutex> lock(mutex_);
+      ++num_sleeping_;
+      cv_.wait(lock, [this]() { return kill_ || !inbox_.empty() || num_local_.load() > 0; });
+      --num_sleeping_;
+      if (kill_)
+        return false;
+      if (!inbox_.empty()) {
+        PopInboxLocked(out);
+        return true;
+      }
+    }
+  }
+  /*!
+   * \brief wake up all workers and make Pop return false.
+   */
+  inline void SignalForKill() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    kill_ = true;
+    cv_.notify_all();
+  }
+
+ private:
+  /*! \brief thread local identity of a worker */
+  struct WorkerSlot {
+    const void* owner;
+    size_t index;
+    uint32_t rng;
+  };
+  /*! \brief entry of the inbox, ordered by priority then by arrival */
+  struct InboxEntry {
+    int priority;
+    uint64_t seq;
+    T item;
+    bool operator<(const InboxEntry& other) const {
+      return priority != other.priority ? priority < other.priority : seq > other.seq;
+    }
+  };
+
+  static inline WorkerSlot* ThisWorkerSlot() {
+    static MX_THREAD_LOCAL WorkerSlot slot = {nullptr, 0, 0};
+    return &slot;
+  }
+
+  inline void PushInbox(T item, int priority) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    inbox_.push(InboxEntry{priority, inbox_seq_++, item});
+    if (priority != 0)
+      ++num_prioritized_;
+    cv_.notify_one();
+  }
+
+  inline void PopInboxLocked(T* out) {
+    const InboxEntry& top = inbox_.top();
+    if (top.priority != 0)
+      --num_prioritized_;
+    *out = top.item;
+    inbox_.pop();
+  }
+
+  inline bool TryPopInbox(T* out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (inbox_.empty())
+      return false;
+    PopInboxLocked(out);
+    return true;
+  }
+
+  /*!
+   * \brief non-blocking pop: prioritized inbox tasks, own deque,
+   *  random victims, then the remaining inbox tasks.
+   */
+  inline bool TryPop(size_t self, T* out) {
+    if (num_prioritized_.load() > 0 && TryPopInbox(out))
+      return true;
+    if (deques_[self]->Pop(out)) {
+      --num_local_;
+      return true;
+    }
+    if (num_local_.load() > 0 && num_workers_ > 1) {
+      WorkerSlot* slot = ThisWorkerSlot();
+      for (size_t attempt = 0; attempt < 2 * num_workers_; ++attempt) {
+        // xorshift32, seeded by RegisterWorker
+        slot->rng ^= slot->rng << 13;
+        slot->rng ^= slot->rng >> 17;
+        slot->rng ^= slot->rng << 5;
+        const size_t victim = slot->rng % num_workers_;
+        if (victim != self && deques_[victim]->Steal(out)) {
+          --num_local_;
+          return true;
+        }
+      }
+    }
+    return TryPopInbox(out);
+  }
+
+  /*! \brief number of workers */
+  const size_t num_workers_;
+  /*! \brief per-worker deques */
+  std::vector<std::unique_ptr<WorkStealingDeque<T>>> deques_;
+  /*! \brief next id handed out by RegisterWorker */
+  std::atomic<size_t> next_worker_id_{0};
+  /*! \brief approximate number of tasks residing in the deques */
+  std::atomic<int64_t> num_local_{0};
+  /*! \brief number of tasks in the inbox with non-zero priority */
+  std::atomic<int64_t> num_prioritized_{0};
+  /*! \brief number of workers blocked in Pop */
+  std::atomic<int> num_sleeping_{0};
+  /*! \brief protects inbox_, inbox_seq_ and kill_ */
+  std::mutex mutex_;
+  /*! \brief idle workers wait on this */
+  std::condition_variable cv_;
+  /*! \brief shared inbox */
+  std::priority_queue<InboxEntry> inbox_;
+  /*! \brief arrival counter keeping FIFO order among equal priorities */
+  uint64_t inbox_seq_{0};
+  /*! \brief whether the queue is shut down */
+  bool kill_{false};
+};
+
+}  // namespace engine
+}  // namespace mxnet
+#endif  // MXNET_ENGINE_WORK_STEALING_QUEUE_H_
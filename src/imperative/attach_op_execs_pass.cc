@@ -215,6 +215,7 @@ class FComputeExecutor : public StorageFallbackOpExecutor {
     INVALIDATE_OUTPUTS(out_array, req);
     PreFCompute(is_gpu);
     fcompute_(attrs, op_ctx, in_data_, req, out_data_);
+    RecordOpCost(attrs, in_data_, out_data_);
     PostFCompute(is_gpu);
   }
 
@@ -245,6 +246,7 @@ class FComputeExExecutor : public OpExecutor {
     std::vector<NDArray>* pInArray = &in_array;
     CREATE_DEFAULT_INPUTS_DNNL(in_array, pInArray = &in_array_fallback, attrs);
     fcompute_(attrs, op_ctx, *pInArray, req, out_array);
+    common::RecordOpCost(attrs, *pInArray, out_array);
   }
 
   void Setup() override {}
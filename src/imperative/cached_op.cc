@@ -23,6 +23,7 @@
 #include "./cached_op.h"
 #include "./exec_pass.h"
 #include "../profiler/profiler.h"
+#include "../profiler/annotation.h"
 #include "../operator/operator_common.h"
 #include "../operator/subgraph/common.h"
 
@@ -56,7 +57,9 @@ CachedOp::CachedOp(const nnvm::Symbol& sym,
                   &grad_graph,
                   &full_graph_,
                   &ograd_entries_,
-                  &fwd_input_to_grad_output);
+                  &fwd_input_to_grad_output,
+                  config_.backward_recompute,
+                  config_.recompute_segment_size);
 
   {
     const auto& idx  = fwd_graph_.indexed_graph();
@@ -90,9 +93,17 @@ CachedOp::CachedOp(const nnvm::Symbol& sym,
   }
 
   SetRefCounts(&fwd_graph_, full_graph_);
+
+  if (config_.static_alloc) {
+    pressure_callback_id_ = Storage::Get()->AddMemoryPressureCallback(
+        [this](const Context& ctx) { this->ReleaseStaticMemory(ctx); });
+  }
 }
 
-CachedOp::~CachedOp() = default;
+CachedOp::~CachedOp() {
+  if (pressure_callback_id_ >= 0)
+    Storage::Get()->RemoveMemoryPressureCallback(pressure_callback_id_);
+}
 
 std::vector<nnvm::NodeEntry> CachedOp::Gradient(const nnvm::ObjectPtr& node,
                                                 const std::vector<nnvm::NodeEntry>& ograds) const {
@@ -309,8 +320,10 @@ bool CachedOp::SetBackwardGraph(GraphInfo* info,
   }
 
   // Set AddTo Entry based on the req that users provide
+  std::vector<int> addto_entry;
+  bool addto_changed = false;
   if (detect_inplace_addto) {
-    std::vector<int> addto_entry(idx.num_node_entries(), 0);
+    addto_entry.resize(idx.num_node_entries(), 0);
     for (size_t i = 0; i < info->grad_graph.outputs.size(); ++i) {
       if (reqs[i] == kAddTo) {
         auto entry = info->grad_graph.outputs[i];
@@ -320,7 +333,15 @@ bool CachedOp::SetBackwardGraph(GraphInfo* info,
         addto_entry[eid] = 1;
       }
     }
-    g.attrs["addto_entry"] = std::make_shared<nnvm::any>(std::move(addto_entry));
+    // the planned entries also hold the ones added by DetectInplaceAddTo, which accumulate
+    // into the gradients only as long as their req stays the same
+    if (g.attrs.count("addto_entry")) {
+      const auto& planned = g.GetAttr<std::vector<int> >("addto_entry");
+      for (const auto& entry : idx.outputs()) {
+        auto eid = idx.entry_id(entry);
+        addto_changed |= planned[eid] != addto_entry[eid];
+      }
+    }
   }
 
   auto shapes = info->fwd_graph.GetAttr<mxnet::ShapeVector>("shape");
@@ -351,11 +372,13 @@ bool CachedOp::SetBackwardGraph(GraphInfo* info,
   match &= CheckAndInferStorageType(
       &g, std::move(dev_mask), std::move(stypes), false, node_range, entry_range);
 
-  if (!match) {
+  if (!match || addto_changed) {
     g.attrs.erase(AddPrefix(BACKWARD, MEM_PLAN));
   } else if (g.attrs.count(AddPrefix(BACKWARD, MEM_PLAN))) {
     return true;
   }
+  if (detect_inplace_addto)
+    g.attrs["addto_entry"] = std::make_shared<nnvm::any>(std::move(addto_entry));
 
   StorageVector storage(idx.num_node_entries(), exec::kBadStorageID);
   const auto& bwd_stypes = g.GetAttr<StorageTypeVector>("storage_type");
@@ -390,12 +413,72 @@ OpStatePtr CachedOp::GetCachedOpState(const Context& ctx) {
       return i;
     }
   }
-  auto state_ptr = OpStatePtr::Create<CachedOpState>(ctx, fwd_graph_, full_graph_, inlining_);
+  auto state_ptr = OpStatePtr::Create<CachedOpState>(ctx,
+                                                     fwd_graph_,
+                                                     full_graph_,
+                                                     inlining_,
+                                                     config_.backward_recompute,
+                                                     config_.recompute_segment_size);
 
   cached_op_states_[ctx].push_back(state_ptr);
   return state_ptr;
 }
 
+OpStatePtr CachedOp::GetCachedOpState(const Context& ctx, const std::vector<NDArray*>& inputs) {
+  std::vector<int64_t> signature;
+  for (const auto* input : inputs) {
+    const mxnet::TShape& shape = input->shape();
+    signature.push_back(shape.ndim());
+    signature.insert(signature.end(), shape.begin(), shape.end());
+    signature.push_back(input->dtype());
+    signature.push_back(input->storage_type());
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // states are kept from the most to the least recently used
+  auto& states = cached_op_states_[ctx];
+  auto found   = states.end();
+  size_t idle  = 0;
+  for (auto it = states.begin(); it != states.end(); ++it) {
+    if (!it->unique())
+      continue;
+    ++idle;
+    const auto& state_signature = it->get_state<CachedOpState>().signature;
+    if (state_signature == signature) {
+      found = it;
+      break;
+    }
+    // a state not planned yet, e.g. created to check for dynamic shapes
+    if (state_signature.empty() && found == states.end())
+      found = it;
+  }
+  if (found == states.end() && idle >= config_.static_shape_cache_size) {
+    // the least recently used idle state is planned again for these inputs
+    for (auto it = states.rbegin(); it != states.rend(); ++it) {
+      if (it->unique()) {
+        found = std::next(it).base();
+        break;
+      }
+    }
+  }
+  OpStatePtr state_ptr;
+  if (found != states.end()) {
+    state_ptr = *found;
+    states.erase(found);
+  } else {
+    state_ptr = OpStatePtr::Create<CachedOpState>(ctx,
+                                                  fwd_graph_,
+                                                  full_graph_,
+                                                  inlining_,
+                                                  config_.backward_recompute,
+                                                  config_.recompute_segment_size,
+                                                  &inputs);
+  }
+  state_ptr.get_state<CachedOpState>().signature = std::move(signature);
+  states.insert(states.begin(), state_ptr);
+  return state_ptr;
+}
+
 void CachedOp::StaticAllocMemory(const OpStatePtr& state_ptr, bool recording, bool keep_fwd) {
   using namespace nnvm;
   using namespace imperative;
@@ -412,6 +495,10 @@ void CachedOp::StaticAllocMemory(const OpStatePtr& state_ptr, bool recording, bo
   if (g.attrs.count("addto_entry")) {
     addto_entry = g.GetAttr<std::vector<int> >("addto_entry");
   }
+  std::vector<int> addto_alias;
+  if (keep_fwd && g.attrs.count("addto_alias")) {
+    addto_alias = g.GetAttr<std::vector<int> >("addto_alias");
+  }
   size_t start_eid = keep_fwd ? state.info.fwd_graph.indexed_graph().num_node_entries() : 0;
   size_t end_eid   = idx.num_node_entries();
 
@@ -435,6 +522,11 @@ void CachedOp::StaticAllocMemory(const OpStatePtr& state_ptr, bool recording, bo
     if (eid >= start_eid)
       state.dynamic_entries[eid] = true;
   }
+  // bound to the gradient they are added into on each backward
+  for (size_t i = start_eid; i < addto_alias.size(); ++i) {
+    if (addto_alias[i] >= 0)
+      state.dynamic_entries[i] = true;
+  }
 
   for (size_t i = start_eid; i < end_eid; ++i) {
     if (addto_entry.size() && addto_entry[i]) {
@@ -530,6 +622,12 @@ void CachedOp::StaticInitExec(const OpStatePtr& state_ptr, bool recording, bool
         bulk_size = 0;
     }
 
+    // independent branches run on the streams of different GPU workers
+    std::vector<int> branches;
+    if (default_ctx.dev_mask() == gpu::kDevMask &&
+        dmlc::GetEnv("MXNET_CACHEDOP_PARALLEL_BRANCHES", true)) {
+      branches = AssignBranches(idx, start_nid, end_nid);
+    }
     CreateEngineOpSeg(idx,
                       default_ctx,
                       start_nid,
@@ -537,7 +635,9 @@ void CachedOp::StaticInitExec(const OpStatePtr& state_ptr, bool recording, bool
                       bulk_size,
                       state.execs,
                       skip_plus_node,
-                      &state.opr_segs);
+                      &state.opr_segs,
+                      branches,
+                      &state.cuda_graphs);
   }
 
   if (keep_fwd) {
@@ -556,7 +656,9 @@ void CachedOp::StaticRunOps(const Context& default_ctx,
   static auto& createop          = nnvm::Op::GetAttr<FCreateOpState>("FCreateOpState");
   static auto& is_layer_backward = Op::GetAttr<bool>("TIsLayerOpBackward");
 
-  bool profiling   = profiler::Profiler::Get()->GetState() == profiler::Profiler::kRunning;
+  // a sampled execution of the graph profiles all of its operators
+  bool profiling   = profiler::Profiler::Get()->GetState() == profiler::Profiler::kRunning &&
+                     profiler::Profiler::Get()->IsSampled();
   bool is_training = Imperative::Get()->is_training();
   auto& state      = state_ptr.get_state<CachedOpState>();
   const auto& idx  = g.indexed_graph();
@@ -573,12 +675,24 @@ void CachedOp::StaticRunOps(const Context& default_ctx,
       op_execs[i]->op_ctx.is_train = is_training;
   }
 
+  const auto grad_hook_nodes =
+      Imperative::Get()->GradHookNodes(idx, state_arrays, start_nid, end_nid);
+  // hooks of the gradients written in [begin, end) run once their operators are pushed
+  auto run_grad_hooks = [&](size_t begin, size_t end) {
+    for (size_t nid = begin; !grad_hook_nodes.empty() && nid < end; ++nid) {
+      auto hooked = grad_hook_nodes.find(nid);
+      if (hooked != grad_hook_nodes.end())
+        Imperative::Get()->RunGradHooks(hooked->second);
+    }
+  };
+
   for (size_t i = start_nid; i < end_nid; i = state.opr_segs[i].next_nid) {
     const auto& opr_seg = state.opr_segs[i];
     if (opr_seg.skip)
       continue;
     if (opr_seg.opr != nullptr) {
       Engine::Get()->Push(opr_seg.opr.get(), default_ctx, 0, profiling);
+      run_grad_hooks(i, opr_seg.next_nid);
     } else {
       const nnvm::IndexedGraph::Node& node = idx[i];
       if (node.source->is_variable())
@@ -642,6 +756,7 @@ void CachedOp::StaticRunOps(const Context& default_ctx,
       if (monitor_callback_) {
         mxnet::common::ExecuteMonOutputCallback(idx, state_arrays, i, monitor_callback_);
       }
+      run_grad_hooks(i, i + 1);
     }
   }
 }
@@ -677,6 +792,32 @@ static void PrepareOutputs(const nnvm::Graph& g,
   }
 }
 
+void CachedOp::ReleaseStaticMemory(const Context& ctx) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = cached_op_states_.find(ctx);
+  if (it == cached_op_states_.end())
+    return;
+  for (auto& state_ptr : it->second) {
+    // states in use by a forward or kept for backward are skipped
+    if (!state_ptr.unique())
+      continue;
+    auto& state = state_ptr.get_state<CachedOpState>();
+    std::unique_lock<std::mutex> state_lock(state.mutex, std::try_to_lock);
+    if (!state_lock.owns_lock())
+      continue;
+    for (size_t i = 0; i < state.buff.size(); ++i) {
+      state.buff[i]   = NDArray();
+      state.arrays[i] = &state.buff[i];
+    }
+    state.fwd_reuse_pool.clear();
+    state.bwd_reuse_pool.clear();
+    state.fwd_alloc     = false;
+    state.bwd_alloc     = false;
+    state.fwd_exec_init = false;
+    state.bwd_exec_init = false;
+  }
+}
+
 OpStatePtr CachedOp::StaticForward(const Context& default_ctx,
                                    const std::vector<NDArray*>& inputs,
                                    const std::vector<NDArray*>& outputs) {
@@ -684,8 +825,9 @@ OpStatePtr CachedOp::StaticForward(const Context& default_ctx,
   using namespace imperative;
 
   bool recording = Imperative::Get()->is_recording();
-  auto state_ptr = GetCachedOpState(default_ctx);
-  auto& state    = state_ptr.get_state<CachedOpState>();
+  auto state_ptr =
+      config_.static_shape ? GetCachedOpState(default_ctx, inputs) : GetCachedOpState(default_ctx);
+  auto& state = state_ptr.get_state<CachedOpState>();
 
   // Need to lock the mutex on the state, this allows
   // for multi context push of ops to dependency engine.
@@ -835,6 +977,8 @@ OpStatePtr CachedOp::Forward(const std::shared_ptr<CachedOp>& op_ptr,
                              const std::vector<NDArray*>& outputs,
                              const Context& default_ctx) {
   static const auto cached_op = nnvm::Op::Get("_CachedOp");
+  // covers the graph preparation and the push of the segments on the calling thread
+  profiler::AnnotationRange range("CachedOp::Forward");
 
   CHECK_EQ(inputs.size(), num_inputs());
   // Assign the storage information for the input arguments. Similar to the
@@ -1078,6 +1222,14 @@ void CachedOp::StaticBackward(const bool retain_graph,
       arrays[eid] = outputs[i];
     }
   }
+  if (g.attrs.count("addto_alias")) {
+    const auto& addto_alias = g.GetAttr<std::vector<int> >("addto_alias");
+    for (size_t i = state.info.fwd_graph.indexed_graph().num_node_entries(); i < addto_alias.size();
+         ++i) {
+      if (addto_alias[i] >= 0)
+        arrays[i] = arrays[addto_alias[i]];
+    }
+  }
 
   if (!state.bwd_exec_init || !match) {
     StaticInitExec(state_ptr, true, true);
@@ -1091,6 +1243,7 @@ void CachedOp::Backward(const bool retain_graph,
                         const std::vector<NDArray*>& inputs,
                         const std::vector<OpReqType>& reqs,
                         const std::vector<NDArray*>& outputs) {
+  profiler::AnnotationRange range("CachedOp::Backward");
   const auto& fwd_idx             = fwd_graph_.indexed_graph();
   const auto& full_idx            = full_graph_.indexed_graph();
   const auto& mutable_input_nodes = fwd_idx.mutable_input_nodes();
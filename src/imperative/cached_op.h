@@ -27,7 +27,12 @@
 #include <utility>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <map>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
 #include "../common/alm.h"
 #include "../operator/operator_common.h"
 #include "../operator/subgraph/common.h"
@@ -213,11 +218,59 @@ void CreateForwardGraph(const nnvm::Symbol& sym, nnvm::Graph* fwd_graph) {
     *fwd_graph = alm::OptimizeLayout(std::move(*fwd_graph));
 }
 
+/* \brief the mirroring function of the gradient pass recomputing the activations of
+ * fwd_graph during backward. Only the outputs of every segment_size-th operator, of the
+ * graph outputs and of the operators that cannot be run twice are kept from the forward,
+ * the others are recomputed from them. segment_size 0 uses the square root of the number
+ * of operators. */
+std::function<int(const nnvm::Node&)> RecomputeMirrorFun(const nnvm::Graph& fwd_graph,
+                                                         uint32_t segment_size) {
+  using namespace nnvm;
+  static const auto& fmutate      = Op::GetAttr<FMutateInputs>("FMutateInputs");
+  static const auto& fstateful    = Op::GetAttr<FCreateOpState>("FCreateOpState");
+  static const auto& fresource    = Op::GetAttr<FResourceRequest>("FResourceRequest");
+  static const auto& fresource_ex = Op::GetAttr<FResourceRequestEx>("FResourceRequestEx");
+  const IndexedGraph& idx         = fwd_graph.indexed_graph();
+  std::vector<const Node*> ops;
+  for (size_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    if (!idx[nid].source->is_variable())
+      ops.push_back(idx[nid].source);
+  }
+  if (segment_size == 0) {
+    segment_size = std::max(1, static_cast<int>(std::lround(std::sqrt(ops.size()))));
+  }
+  auto checkpoints = std::make_shared<std::unordered_set<const Node*>>();
+  for (size_t i = segment_size - 1; i < ops.size(); i += segment_size) {
+    checkpoints->insert(ops[i]);
+  }
+  // the outputs are kept for backward anyway
+  for (const NodeEntry& e : fwd_graph.outputs) {
+    checkpoints->insert(e.node.get());
+  }
+  return [checkpoints](const Node& node) -> int {
+    if (node.is_variable() || checkpoints->count(&node))
+      return false;
+    // recomputing must give the activations of the forward, and not change the inputs
+    const Op* op = node.op();
+    if (fmutate.count(op) || fstateful.count(op) || fresource_ex.count(op))
+      return false;
+    if (fresource.count(op)) {
+      for (const auto& req : fresource[op](node.attrs)) {
+        if (req.type == ResourceRequest::kRandom || req.type == ResourceRequest::kParallelRandom)
+          return false;
+      }
+    }
+    return true;
+  };
+}
+
 /* \brief construct grad_graph from fwd_graph and ograd_entries*/
 void CreateBackwardGraph(nnvm::Graph* fwd_graph,
                          nnvm::Graph* grad_graph,
                          std::vector<nnvm::NodeEntry>* ograd_entries,
-                         std::unordered_map<uint32_t, uint32_t>* fwd_input_to_grad_output) {
+                         std::unordered_map<uint32_t, uint32_t>* fwd_input_to_grad_output,
+                         bool recompute                  = false,
+                         uint32_t recompute_segment_size = 0) {
   using namespace nnvm;
   static const std::vector<const Op*> zero_ops{Op::Get("zeros_like"), Op::Get("_zeros")};
   ograd_entries->reserve(fwd_graph->outputs.size());
@@ -248,14 +301,15 @@ void CreateBackwardGraph(nnvm::Graph* fwd_graph,
   // There are inputs in computation graph that require gradients
   if (!xs.empty()) {
     try {
-      *grad_graph = pass::MXGradient(*fwd_graph,
-                                     fwd_graph->outputs,
-                                     xs,
-                                     *ograd_entries,
-                                     mxnet::AggregateGradient,
-                                     nullptr,
-                                     zero_ops,
-                                     "_copy");
+      *grad_graph = pass::MXGradient(
+          *fwd_graph,
+          fwd_graph->outputs,
+          xs,
+          *ograd_entries,
+          mxnet::AggregateGradient,
+          recompute ? RecomputeMirrorFun(*fwd_graph, recompute_segment_size) : nullptr,
+          zero_ops,
+          "_copy");
     } catch (const nnvm::pass::InvalidGraphError& e) {
       *grad_graph = nnvm::Graph();
     }
@@ -270,7 +324,9 @@ void CreateFullGraph(const nnvm::Symbol& sym,
                      nnvm::Graph* grad_graph,
                      nnvm::Graph* full_graph,
                      std::vector<nnvm::NodeEntry>* ograd_entries,
-                     std::unordered_map<uint32_t, uint32_t>* fwd_input_to_grad_output) {
+                     std::unordered_map<uint32_t, uint32_t>* fwd_input_to_grad_output,
+                     bool recompute                  = false,
+                     uint32_t recompute_segment_size = 0) {
   using namespace nnvm;
   CreateForwardGraph(sym, fwd_graph);
 
@@ -278,8 +334,16 @@ void CreateFullGraph(const nnvm::Symbol& sym,
   if (do_elim_common_expr)
     *fwd_graph = exec::EliminateCommonExpr(std::move(*fwd_graph));
 
+  if (dmlc::GetEnv("MXNET_FUSE_DROPOUT_ADD_LAYERNORM", false))
+    *fwd_graph = exec::FuseDropoutAddLayerNorm(std::move(*fwd_graph));
+
   // construct backward graph
-  CreateBackwardGraph(fwd_graph, grad_graph, ograd_entries, fwd_input_to_grad_output);
+  CreateBackwardGraph(fwd_graph,
+                      grad_graph,
+                      ograd_entries,
+                      fwd_input_to_grad_output,
+                      recompute,
+                      recompute_segment_size);
 
   full_graph->outputs = fwd_graph->outputs;
   // add backward graph outputs to full graph
@@ -330,22 +394,92 @@ void SetRefCounts(nnvm::Graph* fwd_graph, const nnvm::Graph& full_graph) {
       std::make_shared<dmlc::any>(std::move(full_ref_count));
 }
 
+/*!
+ * \brief Reorder the forward nodes of the full graph to reduce the memory alive at once,
+ *  given the inputs of the cached op. The inputs of the full graph may be permuted,
+ *  input_map is updated accordingly. The nodes are reordered in a copy of the graph, as the
+ *  original nodes are shared with the full graph of the cached op and with its other states.
+ */
+void ReorderForMemory(nnvm::Graph* full_graph,
+                      std::vector<size_t>* input_map,
+                      size_t num_forward_outputs,
+                      const std::vector<NDArray*>& inputs) {
+  if (!common::CheckForInputNameDuplicates(full_graph->indexed_graph()))
+    return;
+  nnvm::Graph copy;
+  common::CopyGraph(&copy, *full_graph, false);
+  nnvm::Graph g;
+  g.outputs = std::vector<nnvm::NodeEntry>(copy.outputs.begin(),
+                                           copy.outputs.begin() + num_forward_outputs);
+  const auto& idx = g.indexed_graph();
+  mxnet::ShapeVector shapes;
+  nnvm::DTypeVector dtypes;
+  for (size_t i = 0; i < idx.input_nodes().size(); ++i) {
+    const NDArray* input = inputs[(*input_map)[i]];
+    shapes.push_back(input->shape());
+    dtypes.push_back(input->dtype());
+  }
+  g = exec::InferShape(std::move(g), std::move(shapes));
+  if (g.GetAttr<size_t>("shape_num_unknown_nodes") != 0U)
+    return;
+  g = exec::InferType(std::move(g), std::move(dtypes));
+  if (g.GetAttr<size_t>("dtype_num_unknown_nodes") != 0U)
+    return;
+
+  const auto& full_idx = full_graph->indexed_graph();
+  std::unordered_map<std::string, size_t> original_input_map;
+  for (size_t i = 0; i < full_idx.input_nodes().size(); ++i) {
+    original_input_map[full_idx[full_idx.input_nodes()[i]].source->attrs.name] =
+        (*input_map)[i];
+  }
+  g = nnvm::ApplyPass(std::move(g), "MXReorderMemory");
+  if (!g.GetAttr<bool>("memory_order_changed"))
+    return;
+  const auto& peak = g.GetAttr<std::pair<size_t, size_t>>("memory_order_peak_bytes");
+  LOG(INFO) << "Reordered the forward of the cached op, peak memory " << peak.first << " -> "
+            << peak.second << " bytes";
+
+  // the control dependencies added to the forward nodes change the indexed graph
+  nnvm::Graph reordered;
+  reordered.outputs           = copy.outputs;
+  *full_graph                 = std::move(reordered);
+  const auto& new_idx         = full_graph->indexed_graph();
+  const auto& new_input_nodes = new_idx.input_nodes();
+  for (size_t i = 0; i < new_input_nodes.size(); ++i) {
+    auto it = original_input_map.find(new_idx[new_input_nodes[i]].source->attrs.name);
+    CHECK(it != original_input_map.end());
+    (*input_map)[i] = it->second;
+  }
+}
+
 void OptimizeGraph(nnvm::Graph* full_graph,
                    nnvm::Graph* fwd_graph,
                    nnvm::Graph* grad_graph,
                    std::vector<size_t>* input_map,
                    const Context& context,
                    size_t num_forward_outputs,
-                   const bool inlining) {
+                   const bool inlining,
+                   const std::vector<NDArray*>* inputs = nullptr) {
   input_map->resize(full_graph->indexed_graph().input_nodes().size());
   std::iota(input_map->begin(), input_map->end(), 0);
 #if MXNET_USE_CUDA && !defined(_WIN32)
-  if (context.dev_mask() == kGPU && !inlining && dmlc::GetEnv("MXNET_USE_FUSION", true)) {
+  bool use_fusion = context.dev_mask() == kGPU && dmlc::GetEnv("MXNET_USE_FUSION", true);
+#else
+  // Only warn user if MXNET_USE_FUSION env var is explicitly set
+  if (context.dev_mask() == kGPU && !inlining && dmlc::GetEnv("MXNET_USE_FUSION", false)) {
+    exec::WarnFusionNotSupported();
+  }
+  bool use_fusion = false;
+#endif  // MXNET_USE_CUDA && !defined(_WIN32)
+  // the fusion on CPU is only enabled when MXNET_USE_FUSION is set explicitly
+  use_fusion = use_fusion ||
+               (context.dev_mask() == kCPU && dmlc::GetEnv("MXNET_USE_FUSION", false));
+  if (use_fusion && !inlining) {
     nnvm::Graph unoptimized_graph;
     common::CopyGraph(&unoptimized_graph, *full_graph, false);
 
     if (common::CheckForInputNameDuplicates(unoptimized_graph.indexed_graph())) {
-      *full_graph = exec::FusePointwise(*full_graph, num_forward_outputs);
+      *full_graph = exec::FusePointwise(*full_graph, num_forward_outputs, context.dev_mask());
       // Fill in input_map - mapping from the new to the original input indices.
       const auto& original_inputs = unoptimized_graph.indexed_graph().input_nodes();
       const auto& new_inputs      = full_graph->indexed_graph().input_nodes();
@@ -372,12 +506,9 @@ void OptimizeGraph(nnvm::Graph* full_graph,
           << "Graph contains duplicate names for some of its inputs - fusion is NOT enabled!";
     }
   }
-#else
-  // Only warn user if MXNET_USE_FUSION env var is explicitly set
-  if (context.dev_mask() == kGPU && !inlining && dmlc::GetEnv("MXNET_USE_FUSION", false)) {
-    exec::WarnFusionNotSupported();
+  if (inputs && dmlc::GetEnv("MXNET_CACHEDOP_MEMORY_ORDER", false)) {
+    ReorderForMemory(full_graph, input_map, num_forward_outputs, *inputs);
   }
-#endif  // MXNET_USE_CUDA && !defined(_WIN32)
 
   *fwd_graph         = nnvm::Graph();
   fwd_graph->outputs = std::vector<nnvm::NodeEntry>(
@@ -418,7 +549,10 @@ struct CachedOpConfig : public dmlc::Parameter<CachedOpConfig> {
   uint32_t backward_bulk_size;
   bool static_alloc;
   bool static_shape;
+  uint32_t static_shape_cache_size;
   bool is_dynamic;
+  bool backward_recompute;
+  uint32_t recompute_segment_size;
   mxnet::Tuple<uint32_t> data_indices;
   mxnet::Tuple<uint32_t> param_indices;
   std::string subgraph;
@@ -434,6 +568,12 @@ struct CachedOpConfig : public dmlc::Parameter<CachedOpConfig> {
             "Optimize for invariant input shapes between iterations. "
             "Must also set static_alloc to True. "
             "Change of input shapes is still allowed but slower.");
+    DMLC_DECLARE_FIELD(static_shape_cache_size)
+        .set_default(dmlc::GetEnv("MXNET_CACHEDOP_STATIC_SHAPE_CACHE_SIZE", 1))
+        .set_lower_bound(1)
+        .describe(
+            "Maximum number of idle states planned for distinct input shapes and types "
+            "kept on each context when static_shape is True.");
     DMLC_DECLARE_FIELD(inline_limit)
         .set_default(2)
         .describe("Maximum number of operators that can be inlined.");
@@ -455,6 +595,16 @@ struct CachedOpConfig : public dmlc::Parameter<CachedOpConfig> {
     DMLC_DECLARE_FIELD(is_dynamic)
         .set_default(false)
         .describe("Whether the graph contains dynamic shape operators.");
+    DMLC_DECLARE_FIELD(backward_recompute)
+        .set_default(false)
+        .describe(
+            "Recompute during backward the activations between checkpoints "
+            "instead of keeping them from the forward pass, to save memory.");
+    DMLC_DECLARE_FIELD(recompute_segment_size)
+        .set_default(0)
+        .describe(
+            "Number of operators between two checkpoints when backward_recompute "
+            "is True. 0 uses the square root of the number of operators.");
   }
 };
 
@@ -539,7 +689,10 @@ class CachedOp {
     CachedOpState(const Context& context_,
                   const nnvm::Graph& fwd_graph_,
                   const nnvm::Graph& full_graph_,
-                  const bool inlining_) {
+                  const bool inlining_,
+                  const bool recompute_                  = false,
+                  const uint32_t recompute_segment_size_ = 0,
+                  const std::vector<NDArray*>* inputs_   = nullptr) {
       context = context_;
       nnvm::Symbol sym;
       sym.outputs = fwd_graph_.outputs;
@@ -548,7 +701,9 @@ class CachedOp {
                       &info.grad_graph,
                       &info.full_graph,
                       &info.ograd_entries,
-                      &info.fwd_input_to_grad_output);
+                      &info.fwd_input_to_grad_output,
+                      recompute_,
+                      recompute_segment_size_);
 
       OptimizeGraph(&info.full_graph,
                     &info.fwd_graph,
@@ -556,7 +711,8 @@ class CachedOp {
                     &info.input_map,
                     context_,
                     fwd_graph_.outputs.size(),
-                    inlining_);
+                    inlining_,
+                    inputs_);
 
       size_t max_nodes                = info.full_graph.indexed_graph().num_nodes();
       size_t max_entries              = info.full_graph.indexed_graph().num_node_entries();
@@ -592,13 +748,24 @@ class CachedOp {
     std::vector<OpStatePtr> op_states;
     std::vector<std::shared_ptr<exec::OpExecutor>> execs;
     std::vector<imperative::EngineOprSeg> opr_segs;
+    // CUDA graphs of the segments, updated rather than instantiated again with new executors
+    cuda_graphs::CudaGraphsSegCaches cuda_graphs;
 
     std::vector<bool> dynamic_entries;
     std::multimap<size_t, NDArray> fwd_reuse_pool;
     std::multimap<size_t, NDArray> bwd_reuse_pool;
+
+    // shapes, types and storage types of the inputs planned for with static_shape
+    std::vector<int64_t> signature;
   };
 
   OpStatePtr GetCachedOpState(const Context& ctx);
+  /*!
+   * \brief get an idle state planned for the shapes and types of the inputs, with
+   *  static_shape. The least recently used states are evicted beyond
+   *  static_shape_cache_size idle states on the context.
+   */
+  OpStatePtr GetCachedOpState(const Context& ctx, const std::vector<NDArray*>& inputs);
   bool SetForwardGraph(const Context& default_ctx,
                        GraphInfo* info,
                        const bool recording,
@@ -612,6 +779,11 @@ class CachedOp {
                                bool erase_result);
   void StaticAllocMemory(const OpStatePtr& state_ptr, bool recording, bool keep_fwd);
   void StaticInitExec(const OpStatePtr& state_ptr, bool recording, bool keep_fwd);
+  /*!
+   * \brief drop the static memory of the idle states on a context, called by the
+   *  storage under memory pressure. It is allocated again by the next forward.
+   */
+  void ReleaseStaticMemory(const Context& ctx);
   void StaticRunOps(const Context& default_ctx,
                     const nnvm::Graph& g,
                     const OpStatePtr& state_ptr,
@@ -655,6 +827,8 @@ class CachedOp {
 
   std::mutex mutex_;
   std::unordered_map<Context, std::vector<OpStatePtr>> cached_op_states_;
+  // id of the memory pressure callback registered with the storage, -1 if none
+  int pressure_callback_id_ = -1;
 
   friend class ::mxnet::io::LazyTransformDataset;
   nnvm::Symbol sym_;
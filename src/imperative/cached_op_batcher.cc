@@ -0,0 +1,201 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "./cached_op_batcher.h"
+#include <algorithm>
+#include <utility>
+
+namespace mxnet {
+
+CachedOpBatcher::CachedOpBatcher(const CachedOpPtr& op,
+                                 const std::vector<uint32_t>& data_indices,
+                                 uint32_t max_batch_size,
+                                 uint32_t timeout_us,
+                                 const Context& ctx)
+    : op_(op),
+      data_indices_(data_indices),
+      max_batch_size_(max_batch_size),
+      timeout_(timeout_us),
+      ctx_(ctx),
+      is_np_shape_(Imperative::Get()->is_np_shape()) {
+  CHECK(!data_indices_.empty()) << "CachedOpBatcher needs at least one data input";
+  CHECK_GT(max_batch_size_, 0U) << "max_batch_size of CachedOpBatcher must be positive";
+  std::sort(data_indices_.begin(), data_indices_.end());
+  for (auto i : data_indices_) {
+    CHECK_LT(i, op_->num_inputs()) << "data index " << i << " of CachedOpBatcher is out of "
+                                   << "the " << op_->num_inputs() << " inputs of the cached op";
+  }
+  thread_ = std::thread([this]() { Run(); });
+}
+
+CachedOpBatcher::~CachedOpBatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+}
+
+void CachedOpBatcher::Forward(const std::vector<NDArray*>& inputs,
+                              std::vector<NDArray>* outputs) {
+  CHECK_EQ(inputs.size(), op_->num_inputs())
+      << "CachedOp expects " << op_->num_inputs() << " inputs, but " << inputs.size()
+      << " were given.";
+  Request req;
+  req.inputs.reserve(inputs.size());
+  for (auto input : inputs) {
+    req.inputs.push_back(*input);
+  }
+  const mxnet::TShape& shape = inputs[data_indices_[0]]->shape();
+  CHECK(mxnet::ndim_is_known(shape) && shape.ndim() > 0)
+      << "The data inputs of CachedOpBatcher need a batch axis";
+  req.batch_size = shape[0];
+  for (auto i : data_indices_) {
+    const NDArray& data = *inputs[i];
+    CHECK_EQ(data.storage_type(), kDefaultStorage)
+        << "CachedOpBatcher only batches data inputs of the default storage type";
+    CHECK(data.shape().ndim() > 0 && data.shape()[0] == shape[0])
+        << "The data inputs of a request to CachedOpBatcher have different batch sizes: "
+        << data.shape() << " vs. " << shape;
+  }
+  outputs->assign(op_->num_outputs(), NDArray());
+  req.outputs = outputs;
+
+  std::future<void> done = req.done.get_future();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.emplace_back(&req, std::chrono::steady_clock::now());
+  }
+  cv_.notify_all();
+  // rethrows the error of the forward of the batch
+  done.get();
+}
+
+bool CachedOpBatcher::Compatible(const Request& a, const Request& b) const {
+  for (size_t i = 0, j = 0; i < a.inputs.size(); ++i) {
+    if (j < data_indices_.size() && data_indices_[j] == i) {
+      const mxnet::TShape& sa = a.inputs[i].shape();
+      const mxnet::TShape& sb = b.inputs[i].shape();
+      if (sa.ndim() != sb.ndim() || a.inputs[i].dtype() != b.inputs[i].dtype() ||
+          !std::equal(sa.begin() + 1, sa.end(), sb.begin() + 1)) {
+        return false;
+      }
+      ++j;
+    } else if (!a.inputs[i].IsSame(b.inputs[i])) {
+      // the other inputs are taken from the first request
+      return false;
+    }
+  }
+  return true;
+}
+
+void CachedOpBatcher::Run() {
+  Imperative::Get()->set_is_np_shape(is_np_shape_);
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+    if (queue_.empty())
+      return;
+    // number of requests of the next batch, and whether it is full
+    auto next_batch = [this](size_t* num_requests) {
+      const Request& first = *queue_.front().first;
+      size_t samples       = first.batch_size;
+      *num_requests        = 1;
+      for (; *num_requests < queue_.size(); ++*num_requests) {
+        const Request& req = *queue_[*num_requests].first;
+        if (!Compatible(first, req) || samples + req.batch_size > max_batch_size_)
+          return true;
+        samples += req.batch_size;
+      }
+      return samples >= max_batch_size_;
+    };
+    size_t num_requests = 0;
+    cv_.wait_until(lock, queue_.front().second + timeout_, [this, &next_batch, &num_requests]() {
+      return stop_ || next_batch(&num_requests);
+    });
+    next_batch(&num_requests);
+    std::vector<Request*> batch;
+    for (size_t i = 0; i < num_requests; ++i) {
+      batch.push_back(queue_.front().first);
+      queue_.pop_front();
+    }
+    lock.unlock();
+    try {
+      RunBatch(batch);
+      for (auto req : batch)
+        req->done.set_value();
+    } catch (...) {
+      // any error, e.g. std::bad_alloc, goes to the requests instead of ending the thread
+      for (auto req : batch)
+        req->done.set_exception(std::current_exception());
+    }
+    lock.lock();
+  }
+}
+
+void CachedOpBatcher::RunBatch(const std::vector<Request*>& batch) {
+  const Request& first = *batch[0];
+  std::vector<NDArray> inputs(first.inputs);
+  size_t batch_size = 0;
+  for (auto req : batch) {
+    batch_size += req->batch_size;
+  }
+  if (batch.size() > 1) {
+    for (auto i : data_indices_) {
+      mxnet::TShape shape(first.inputs[i].shape());
+      shape[0]     = batch_size;
+      inputs[i]    = NDArray(shape, ctx_, false, first.inputs[i].dtype());
+      size_t begin = 0;
+      for (auto req : batch) {
+        NDArray samples = inputs[i].Slice(begin, begin + req->batch_size);
+        CopyFromTo(req->inputs[i], &samples);
+        begin += req->batch_size;
+      }
+    }
+  }
+  std::vector<NDArray*> input_ptrs;
+  for (auto& input : inputs) {
+    input_ptrs.push_back(&input);
+  }
+  std::vector<NDArray> outputs(op_->num_outputs());
+  std::vector<NDArray*> output_ptrs;
+  for (auto& output : outputs) {
+    output_ptrs.push_back(&output);
+  }
+  op_->Forward(op_, input_ptrs, output_ptrs, ctx_);
+
+  for (size_t j = 0; j < outputs.size(); ++j) {
+    if (batch.size() == 1) {
+      (*first.outputs)[j] = outputs[j];
+      continue;
+    }
+    const mxnet::TShape& shape = outputs[j].shape();
+    CHECK(shape.ndim() > 0 && static_cast<size_t>(shape[0]) == batch_size)
+        << "Output " << j << " of shape " << shape << " cannot be split between the "
+        << "requests of CachedOpBatcher, its first axis must be the batch axis";
+    size_t begin = 0;
+    for (auto req : batch) {
+      (*req->outputs)[j] = outputs[j].Slice(begin, begin + req->batch_size);
+      begin += req->batch_size;
+    }
+  }
+}
+
+}  // namespace mxnet
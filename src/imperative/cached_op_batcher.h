@@ -0,0 +1,106 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Batches the concurrent inference requests of a cached op into one forward
+#ifndef MXNET_IMPERATIVE_CACHED_OP_BATCHER_H_
+#define MXNET_IMPERATIVE_CACHED_OP_BATCHER_H_
+
+#include <mxnet/ndarray.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "./cached_op.h"
+
+namespace mxnet {
+
+/*!
+ * \brief runs the forwards of concurrent requests of a cached op as one forward.
+ *
+ * Requests are queued, and a thread of the batcher concatenates the data inputs of
+ * the requests waiting along their first axis, up to max_batch_size samples or until
+ * the oldest request waited for timeout, runs the forward of the batch and gives each
+ * request the slices of the outputs for its samples. Only requests whose data inputs
+ * have the same shapes but for the first axis, and the same types, are batched
+ * together. The other inputs, e.g. the parameters, are those of the first request
+ * of the batch.
+ *
+ * The cached op is only called by the thread of the batcher, a CachedOpThreadSafe
+ * may still be called by other threads.
+ */
+class CachedOpBatcher {
+ public:
+  /*!
+   * \param op the cached op run
+   * \param data_indices positions of the inputs batched along their first axis
+   * \param max_batch_size maximum number of samples of a batch
+   * \param timeout_us maximum time in microseconds a request waits for others
+   * \param ctx the context the batches run on
+   */
+  CachedOpBatcher(const CachedOpPtr& op,
+                  const std::vector<uint32_t>& data_indices,
+                  uint32_t max_batch_size,
+                  uint32_t timeout_us,
+                  const Context& ctx);
+  ~CachedOpBatcher();
+
+  /*!
+   * \brief run the forward of the inputs as part of a batch, blocks the calling thread
+   *  until the operations of the batch are pushed to the engine
+   * \param inputs the inputs of the cached op
+   * \param outputs the outputs, assigned the slices of the outputs of the batch
+   */
+  void Forward(const std::vector<NDArray*>& inputs, std::vector<NDArray>* outputs);
+
+ private:
+  struct Request {
+    std::vector<NDArray> inputs;
+    size_t batch_size;
+    std::vector<NDArray>* outputs;
+    std::promise<void> done;
+  };
+
+  /*! \brief the thread batching the requests */
+  void Run();
+  /*! \brief whether two requests can be batched together */
+  bool Compatible(const Request& a, const Request& b) const;
+  /*! \brief run the forward of a batch of compatible requests */
+  void RunBatch(const std::vector<Request*>& batch);
+
+  CachedOpPtr op_;
+  std::vector<uint32_t> data_indices_;
+  size_t max_batch_size_;
+  std::chrono::microseconds timeout_;
+  Context ctx_;
+  // numpy shape semantics of the thread creating the batcher
+  int is_np_shape_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::pair<Request*, std::chrono::steady_clock::time_point>> queue_;
+  bool stop_ = false;
+  std::thread thread_;
+};
+
+}  // namespace mxnet
+#endif  // MXNET_IMPERATIVE_CACHED_OP_BATCHER_H_
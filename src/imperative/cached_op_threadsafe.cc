@@ -174,6 +174,10 @@ OpStatePtr CachedOpThreadSafe::Forward(const std::shared_ptr<CachedOp>& op_ptr,
   }
 
   int prev_bulk_size = Engine::Get()->set_bulk_size(config_.forward_bulk_size);
+#if MXNET_USE_ONEDNN == 1
+  // the ops run on the calling thread with NaiveEngine, so on its oneDNN stream and OpenMP threads
+  DNNLStreamThreadsScope threads_scope(config_.num_threads);
+#endif
   OpStatePtr op_state;
   try {
     if (CheckDynamicShapeExists(default_ctx, inputs, true)) {
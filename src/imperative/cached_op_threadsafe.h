@@ -42,6 +42,8 @@ struct CachedOpThreadSafeConfig : public dmlc::Parameter<CachedOpThreadSafeConfi
   mxnet::Tuple<uint32_t> param_indices;
   // decides the bulk size for dynamic forward
   uint32_t forward_bulk_size;
+  // threads the oneDNN primitives of a forward run with
+  int num_threads;
   bool static_alloc;
   bool static_shape;
   DMLC_DECLARE_PARAMETER(CachedOpThreadSafeConfig) {
@@ -59,6 +61,13 @@ struct CachedOpThreadSafeConfig : public dmlc::Parameter<CachedOpThreadSafeConfi
     DMLC_DECLARE_FIELD(forward_bulk_size)
         .set_default(Imperative::BulkExecMaxNodeTrainFwd())
         .describe("Segment size of bulk execution during dynamic forward");
+    DMLC_DECLARE_FIELD(num_threads)
+        .set_default(0)
+        .set_lower_bound(0)
+        .describe(
+            "Number of threads the oneDNN primitives and the OpenMP loops of a forward "
+            "run with, 0 for the threads of the calling thread. With NaiveEngine, N threads "
+            "running forwards concurrently with num_threads=M use N x M cores.");
     DMLC_DECLARE_FIELD(data_indices)
         .set_default(mxnet::Tuple<uint32_t>())
         .describe("Position of argument variables.");
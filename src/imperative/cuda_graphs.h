@@ -26,11 +26,14 @@
 #define MXNET_IMPERATIVE_CUDA_GRAPHS_H_
 
 #include <mxnet/base.h>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
 #include <map>
 #include <set>
 #include <sstream>
+#include <unordered_map>
 
 #include "./exec_pass.h"
 #include "../common/cuda/utils.h"
@@ -41,6 +44,17 @@
 #define CUDA_GRAPHS_AVAILABLE (0)
 #endif
 
+namespace mxnet {
+namespace cuda_graphs {
+
+// The CUDA Graphs of a bulked op segment, kept across the re-creations of its executors.
+struct CudaGraphsSegCache;
+// The caches of the op segments of a graph, by the node id of the first op of the segment.
+using CudaGraphsSegCaches = std::unordered_map<size_t, std::shared_ptr<CudaGraphsSegCache>>;
+
+}  // namespace cuda_graphs
+}  // namespace mxnet
+
 #if CUDA_GRAPHS_AVAILABLE
 
 namespace mxnet {
@@ -324,7 +338,10 @@ class CudaGraphsSubSegExec {
 // The CudaGraph executor and associated Tempspace ptrs for which it is valid.
 struct CudaGraphInfo {
   std::vector<CudaGraphsSubSegExec> cuda_graph_subseg_execs;
-  bool has_been_run_conventionally = false;
+  // Generations of the op executors last run conventionally, and captured.  A new generation
+  // is run conventionally once, then captured again by updating the graph executors in-place.
+  uint64_t run_conventionally_generation = 0;
+  uint64_t captured_generation           = 0;
   std::vector<void*> tempspace_dptrs;
 };
 // A CUDA graph is maintained for every combination of cudaStream_t (i.e. GPU Worker) and
@@ -340,11 +357,33 @@ struct CudaGraphCacheKey {
 };
 using CudaGraphCache = std::map<CudaGraphCacheKey, CudaGraphInfo>;
 
+// When the executors of an op segment are re-created, e.g. for new input shapes of a
+// static_shape CachedOp, the graph executors instantiated for the previous executors are
+// updated with cudaGraphExecUpdate(), which is much cheaper than instantiating them again.
+struct CudaGraphsSegCache {
+  // Serializes the runs of the old and new executors of the segment, which may overlap
+  std::mutex mutex;
+  std::string opr_names;
+  size_t num_ops      = 0;
+  uint64_t generation = 0;
+  CudaGraphCache cache;
+};
+
+inline std::shared_ptr<CudaGraphsSegCache> GetSegCache(CudaGraphsSegCaches* caches, size_t key) {
+  if (caches == nullptr)
+    return nullptr;
+  auto& seg_cache = (*caches)[key];
+  if (seg_cache == nullptr)
+    seg_cache = std::make_shared<CudaGraphsSegCache>();
+  return seg_cache;
+}
+
 class CudaGraphsExec {
  public:
   CudaGraphsExec(const std::vector<std::shared_ptr<exec::OpExecutor>>& exec_list,
                  bool is_gpu,
-                 const char* opr_names)
+                 const char* opr_names,
+                 std::shared_ptr<CudaGraphsSegCache> seg_cache = nullptr)
       : verbose_(false), is_enabled_(false) {
     opr_names_ = opr_names ? std::string(opr_names) : std::string();
     if (is_gpu) {
@@ -352,6 +391,15 @@ class CudaGraphsExec {
       verbose_    = dmlc::GetEnv("MXNET_CUDA_GRAPHS_VERBOSE", false);
       SetTempSpaces(exec_list);
     }
+    seg_cache_ = seg_cache != nullptr ? seg_cache : std::make_shared<CudaGraphsSegCache>();
+    std::lock_guard<std::mutex> lock(seg_cache_->mutex);
+    // The graphs can only be updated from executors of the same ops
+    if (seg_cache_->opr_names != opr_names_ || seg_cache_->num_ops != exec_list.size()) {
+      seg_cache_->cache.clear();
+      seg_cache_->opr_names = opr_names_;
+      seg_cache_->num_ops   = exec_list.size();
+    }
+    generation_ = ++seg_cache_->generation;
   }
 
   void RunAll(const std::vector<std::shared_ptr<exec::OpExecutor>>& exec_list,
@@ -371,13 +419,14 @@ class CudaGraphsExec {
     // All the ops in the bulked segment will have the same setting of is_train as the first op
     const bool is_train         = exec_list.size() > 0 && exec_list[0]->op_ctx.is_train;
     const CudaGraphCacheKey key = {cu_s, is_train};
+    std::lock_guard<std::mutex> lock(seg_cache_->mutex);
     // Look-up the CUDA Graph info for this combo of stream and is_train setting
     // This may create a default-initialized new entry.
-    auto& cuda_graph_info = cache_[key];
-    if (!cuda_graph_info.has_been_run_conventionally) {
+    auto& cuda_graph_info = seg_cache_->cache[key];
+    if (cuda_graph_info.run_conventionally_generation != generation_) {
       // Run all opr in the sub-graph
       exec::OpExecutor::RunAll(exec_list, rctx, is_gpu);
-      cuda_graph_info.has_been_run_conventionally = true;
+      cuda_graph_info.run_conventionally_generation = generation_;
       return;
     }
 
@@ -385,14 +434,20 @@ class CudaGraphsExec {
     //     (there might be more than one executor if some ops in the segment are not capturable)
     auto before_exec_tempspace_ptrs = GetGPUTempspacePtrs(s);
 
-    // Executors exist, but the tempspace pts have changed, so update them in-place via 'recapture'.
+    // Executors exist, but were captured from other op executors or the tempspace pts have
+    // changed, so update them in-place via 'recapture'.
     if (cuda_graph_info.cuda_graph_subseg_execs.size() > 0 &&
-        cuda_graph_info.tempspace_dptrs != before_exec_tempspace_ptrs) {
+        (cuda_graph_info.captured_generation != generation_ ||
+         cuda_graph_info.tempspace_dptrs != before_exec_tempspace_ptrs)) {
+      if (verbose_)
+        LOG(INFO) << "Updating CUDA graph of op segment " << opr_names_;
       // Update all runnable executors.  Non-runnable executors launch their ops conventionally.
       for (auto& subseg_exec : cuda_graph_info.cuda_graph_subseg_execs) {
         if (subseg_exec.IsRunnable())
           subseg_exec.Update(exec_list, rctx, is_gpu, verbose_);
       }
+      cuda_graph_info.tempspace_dptrs     = before_exec_tempspace_ptrs;
+      cuda_graph_info.captured_generation = generation_;
     } else if (cuda_graph_info.cuda_graph_subseg_execs.size() == 0) {
       // No executors exist yet, so create them.
       if (verbose_)
@@ -432,7 +487,8 @@ class CudaGraphsExec {
       auto after_capture_tempspace_ptrs = GetGPUTempspacePtrs(s);
       if (before_exec_tempspace_ptrs != after_capture_tempspace_ptrs)
         LOG(FATAL) << "Internal error: saw change in TempSpace ptrs during CUDA graph use.";
-      cuda_graph_info.tempspace_dptrs = before_exec_tempspace_ptrs;
+      cuda_graph_info.tempspace_dptrs     = before_exec_tempspace_ptrs;
+      cuda_graph_info.captured_generation = generation_;
     }
     // Now execute the CUDA Graph that we either just created or looked-up in the cache.
     if (verbose_) {
@@ -578,7 +634,8 @@ class CudaGraphsExec {
     return ret;
   }
 
-  CudaGraphCache cache_;
+  std::shared_ptr<CudaGraphsSegCache> seg_cache_;
+  uint64_t generation_;
   std::vector<Resource*> tempspaces_;
   std::string opr_names_;
   bool verbose_;
@@ -588,6 +645,18 @@ class CudaGraphsExec {
 }  // namespace cuda_graphs
 }  // namespace mxnet
 
+#else
+
+namespace mxnet {
+namespace cuda_graphs {
+
+inline std::shared_ptr<CudaGraphsSegCache> GetSegCache(CudaGraphsSegCaches* caches, size_t key) {
+  return nullptr;
+}
+
+}  // namespace cuda_graphs
+}  // namespace mxnet
+
 #endif  // CUDA_GRAPHS_AVAILABLE
 
 #endif  // MXNET_IMPERATIVE_CUDA_GRAPHS_H_
@@ -204,10 +204,12 @@ void AttachOpResources(const Graph& g,
  *
  * \param g input graph need to contain op_exec attribute.
  *
- * \return graph two new attributes, changes attribute "storage_id".
+ * \return graph three new attributes, changes attribute "storage_id".
  *  - "addto_entry", std::vector<bool> size=g.num_node_entries()
  *    - addto_entry[eid] == 1, the corresponding op need to be performed using req=kAddTo
  *  - "skip_plus_node", std::vector<int> if set to 1, current op's execution is skiped.
+ *  - "addto_alias", std::vector<int> size=g.num_node_entries()
+ *    - addto_alias[eid] >= 0, the entry is added into the external array of entry addto_alias[eid]
  */
 Graph DetectInplaceAddTo(Graph g);
 
@@ -225,10 +227,23 @@ Graph EliminateCommonExpr(Graph&& g);
  *
  * \param g input graph (needs to be entire graph, not just forward part)
  * \param num_forward_outputs number of outputs in the graph produced by the forward pass
+ * \param dev_mask device the graph runs on, the operations fused on CPU are a subset of
+ *        those fused on GPU
  *
  * \return copy of the graph with fused pointwise operations
  */
-Graph FusePointwise(const Graph& g, const size_t num_forward_outputs);
+Graph FusePointwise(const Graph& g, const size_t num_forward_outputs, const int dev_mask);
+
+/*!
+ * \brief Replace LayerNorm(residual + Dropout(x)) over the last axis by the fused
+ *        _contrib_dropout_add_layer_norm operator, which regenerates the dropout mask in the
+ *        backward instead of storing it.
+ *
+ * \param g input forward graph
+ *
+ * \return graph with the matched patterns replaced
+ */
+Graph FuseDropoutAddLayerNorm(Graph&& g);
 
 /*!
  * \brief Issue a one-time warning that fusion is not possible for this platform or build.
@@ -292,6 +307,8 @@ namespace pass {
  *                 be zero_like.
  * \param copy_op_str The name of the copy operator that handle gradient duplicates.
  * \param in_arg_shapes The shapes of input arguments, used for shape inference.
+ *                      When empty, every node passing mirror_fun is mirrored without
+ *                      comparing the storage allocated and released by mirroring.
  * \param in_arg_dtpyes The data types of input arguments, used for data type inference.
  * \return A new graph, whose outputs correspond to inputs of xs.
  */
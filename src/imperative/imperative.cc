@@ -18,11 +18,15 @@
  */
 #include <algorithm>
 #include <iostream>
+#include <list>
+#include <memory>
+#include <sstream>
 #include <unordered_map>
 #include <unordered_set>
 
 #include "./imperative_utils.h"
 #include "./cached_op.h"
+#include "../common/object_pool.h"
 
 namespace nnvm {
 ObjectPtr CreateVariableNode(const std::string& name);
@@ -138,6 +142,231 @@ OpStatePtr Imperative::Invoke(const Context& default_ctx,
   return ret;
 }
 
+namespace {
+
+/*! \brief Nodes of the tape are created and freed every iteration, they come from a pool */
+nnvm::ObjectPtr CreateTapeNode() {
+  return std::allocate_shared<nnvm::Node>(common::ObjectPoolAllocator<nnvm::Node>());
+}
+
+/*!
+ * \brief Whether the gradient of a node is defined by its op and attribute dictionary, so that
+ *        the gradients of nodes with the same key are the same.
+ */
+bool GradientKey(const nnvm::Node& node, std::ostringstream* os) {
+  if (!node.attrs.subgraphs.empty() || !node.control_deps.empty() ||
+      (node.attrs.dict.empty() && !node.attrs.parsed.empty()))
+    return false;
+  *os << (node.is_variable() ? "" : node.op()->name) << '(';
+  std::vector<std::pair<std::string, std::string>> dict(node.attrs.dict.begin(),
+                                                        node.attrs.dict.end());
+  std::sort(dict.begin(), dict.end());
+  for (const auto& kv : dict)
+    *os << kv.first.size() << ':' << kv.first << kv.second.size() << ':' << kv.second;
+  *os << ')';
+  return true;
+}
+
+/*! \brief Inputs and outputs saved for the gradients of ops, by GradientKey */
+using BackwardDependencies =
+    std::unordered_map<std::string, std::pair<std::vector<bool>, std::vector<bool>>>;
+constexpr size_t kMaxCachedDependencies = 4096;
+
+/*! \brief Reference of a node of a cached gradient graph to a node of the graph */
+struct TapeRef {
+  enum Kind { kForward, kHeadGrad, kBackward };
+  Kind kind;
+  uint32_t node;
+  uint32_t index;
+  uint32_t version;
+};
+
+/*! \brief Gradient graph of a tape, with its nodes in topological order */
+struct BackwardTemplate {
+  struct Node {
+    nnvm::NodeAttrs attrs;
+    std::vector<TapeRef> inputs;
+    std::vector<TapeRef> control_deps;
+  };
+  std::vector<Node> nodes;
+  std::vector<TapeRef> outputs;
+  std::vector<TapeRef> nleaf_grads;
+};
+
+/*!
+ * \brief Structure of a tape: the gradient graphs of tapes with the same key are the same, but
+ *        for the forward nodes and head gradients they refer to.
+ * \param fwd_nodes the forward nodes, in the order of the key
+ * \return whether the tape can be cached
+ */
+bool TapeKey(const nnvm::Graph& graph,
+             const std::vector<nnvm::NodeEntry>& xs,
+             const std::vector<nnvm::NodeEntry>& us,
+             size_t num_ograds,
+             std::vector<nnvm::ObjectPtr>* fwd_nodes,
+             std::unordered_map<const nnvm::Node*, uint32_t>* fwd_ids,
+             std::string* key) {
+  std::ostringstream os;
+  bool cachable = true;
+  nnvm::DFSVisit(graph.outputs, [&](const nnvm::ObjectPtr& n) {
+    fwd_ids->emplace(n.get(), fwd_nodes->size());
+    fwd_nodes->push_back(n);
+    if (!cachable)
+      return;
+    cachable = GradientKey(*n, &os);
+    for (const auto& e : n->inputs)
+      os << fwd_ids->at(e.node.get()) << ':' << e.index << ':' << e.version << ',';
+  });
+  auto write_entries = [&](const char* name, const std::vector<nnvm::NodeEntry>& entries) {
+    os << name;
+    for (const auto& e : entries) {
+      auto it = fwd_ids->find(e.node.get());
+      if (it == fwd_ids->end()) {
+        cachable = false;
+        return;
+      }
+      os << it->second << ':' << e.index << ',';
+    }
+  };
+  write_entries("outputs", graph.outputs);
+  write_entries("xs", xs);
+  write_entries("us", us);
+  os << "ograds" << num_ograds;
+  *key = os.str();
+  return cachable;
+}
+
+/*! \brief Record the gradient graph of a tape, nullptr if it refers to unknown nodes */
+std::shared_ptr<BackwardTemplate> MakeBackwardTemplate(
+    const nnvm::Graph& g_graph,
+    const std::unordered_map<const nnvm::Node*, uint32_t>& fwd_ids,
+    const std::vector<nnvm::NodeEntry>& ograd_entries) {
+  auto tpl = std::make_shared<BackwardTemplate>();
+  std::unordered_map<const nnvm::Node*, TapeRef> refs;
+  for (const auto& kv : fwd_ids)
+    refs[kv.first] = TapeRef{TapeRef::kForward, kv.second, 0, 0};
+  for (uint32_t i = 0; i < ograd_entries.size(); ++i)
+    refs[ograd_entries[i].node.get()] = TapeRef{TapeRef::kHeadGrad, i, 0, 0};
+  bool known = true;
+  auto ref   = [&](const nnvm::NodeEntry& e) {
+    auto it = refs.find(e.node.get());
+    if (it == refs.end()) {
+      known = false;
+      return TapeRef{TapeRef::kForward, 0, 0, 0};
+    }
+    return TapeRef{it->second.kind, it->second.node, e.index, e.version};
+  };
+  const auto& nleaf_grads = g_graph.GetAttr<std::vector<nnvm::NodeEntry>>("nleaf_grads");
+  std::vector<nnvm::NodeEntry> roots(g_graph.outputs);
+  roots.insert(roots.end(), nleaf_grads.begin(), nleaf_grads.end());
+  nnvm::DFSVisit(roots, [&](const nnvm::ObjectPtr& n) {
+    if (refs.count(n.get()))
+      return;
+    BackwardTemplate::Node node;
+    node.attrs = n->attrs;
+    for (const auto& e : n->inputs)
+      node.inputs.push_back(ref(e));
+    for (const auto& dep : n->control_deps)
+      node.control_deps.push_back(ref(nnvm::NodeEntry{dep, 0, 0}));
+    refs[n.get()] = TapeRef{TapeRef::kBackward, static_cast<uint32_t>(tpl->nodes.size()), 0, 0};
+    tpl->nodes.push_back(std::move(node));
+  });
+  for (const auto& e : g_graph.outputs)
+    tpl->outputs.push_back(ref(e));
+  for (const auto& e : nleaf_grads)
+    tpl->nleaf_grads.push_back(ref(e));
+  return known ? tpl : nullptr;
+}
+
+/*! \brief Create the gradient graph of a tape from the one of a tape with the same key */
+nnvm::Graph InstantiateBackwardTemplate(const BackwardTemplate& tpl,
+                                        const std::vector<nnvm::ObjectPtr>& fwd_nodes,
+                                        const std::vector<nnvm::NodeEntry>& ograd_entries) {
+  std::vector<nnvm::ObjectPtr> nodes;
+  nodes.reserve(tpl.nodes.size());
+  auto node = [&](const TapeRef& r) -> const nnvm::ObjectPtr& {
+    switch (r.kind) {
+      case TapeRef::kForward:
+        return fwd_nodes[r.node];
+      case TapeRef::kHeadGrad:
+        return ograd_entries[r.node].node;
+      default:
+        return nodes[r.node];
+    }
+  };
+  auto entry = [&](const TapeRef& r) { return nnvm::NodeEntry{node(r), r.index, r.version}; };
+  for (const auto& tn : tpl.nodes) {
+    nnvm::ObjectPtr n = CreateTapeNode();
+    n->attrs          = tn.attrs;
+    n->inputs.reserve(tn.inputs.size());
+    for (const auto& r : tn.inputs)
+      n->inputs.push_back(entry(r));
+    for (const auto& r : tn.control_deps)
+      n->control_deps.push_back(node(r));
+    nodes.push_back(std::move(n));
+  }
+  nnvm::Graph g_graph;
+  std::vector<nnvm::NodeEntry> nleaf_grads;
+  for (const auto& r : tpl.outputs)
+    g_graph.outputs.push_back(entry(r));
+  for (const auto& r : tpl.nleaf_grads)
+    nleaf_grads.push_back(entry(r));
+  g_graph.attrs["nleaf_grads"] = std::make_shared<nnvm::any>(std::move(nleaf_grads));
+  return g_graph;
+}
+
+/*!
+ * \brief Gradient graph of a tape. A training loop records the same tape every iteration, so
+ *        the gradient graphs of the last MXNET_BACKWARD_GRAPH_CACHE_SIZE tapes of the thread are
+ *        cached by structure and copied for a tape of the same structure.
+ */
+nnvm::Graph GradientGraph(const nnvm::Graph& graph,
+                          const std::vector<nnvm::NodeEntry>& xs,
+                          const std::vector<nnvm::NodeEntry>& ograd_entries,
+                          const std::vector<nnvm::NodeEntry>& us) {
+  static const std::vector<const nnvm::Op*> zero_ops{nnvm::Op::Get("zeros_like"),
+                                                     nnvm::Op::Get("_zeros")};
+  static const size_t cache_size = dmlc::GetEnv("MXNET_BACKWARD_GRAPH_CACHE_SIZE", 16);
+  static thread_local std::list<std::pair<std::string, std::shared_ptr<BackwardTemplate>>> cache;
+
+  std::vector<nnvm::ObjectPtr> fwd_nodes;
+  std::unordered_map<const nnvm::Node*, uint32_t> fwd_ids;
+  std::string key;
+  const bool cachable = cache_size > 0 &&
+                        TapeKey(graph, xs, us, ograd_entries.size(), &fwd_nodes, &fwd_ids, &key);
+  if (cachable) {
+    for (auto it = cache.begin(); it != cache.end(); ++it) {
+      if (it->first == key) {
+        cache.splice(cache.begin(), cache, it);
+        return InstantiateBackwardTemplate(*it->second, fwd_nodes, ograd_entries);
+      }
+    }
+  }
+
+  nnvm::Graph g_graph = nnvm::pass::MXGradient(graph,
+                                               graph.outputs,
+                                               xs,
+                                               ograd_entries,
+                                               mxnet::AggregateGradient,
+                                               nullptr,
+                                               zero_ops,
+                                               "_copy",
+                                               mxnet::ShapeVector(),
+                                               nnvm::DTypeVector(),
+                                               us);
+  if (cachable) {
+    auto tpl = MakeBackwardTemplate(g_graph, fwd_ids, ograd_entries);
+    if (tpl) {
+      cache.emplace_front(std::move(key), std::move(tpl));
+      if (cache.size() > cache_size)
+        cache.pop_back();
+    }
+  }
+  return g_graph;
+}
+
+}  // namespace
+
 // Create nnvm::NodeEntry for variables' and gradients' autograd_entry_
 // attribute and associate AGInfo with it's info attribute
 void Imperative::MarkVariables(const std::vector<NDArray*>& variables,
@@ -265,7 +494,7 @@ void Imperative::RecordOp(nnvm::NodeAttrs&& attrs,
   if (!need_grad)
     return;
 
-  nnvm::ObjectPtr node = nnvm::Node::Create();
+  nnvm::ObjectPtr node = CreateTapeNode();
   node->attrs          = std::move(attrs);
   // if node name is empty or node name is equal to op name - name it with unique name
   if (node->attrs.name == "" || node->attrs.op->name == node->attrs.name) {
@@ -280,7 +509,26 @@ void Imperative::RecordOp(nnvm::NodeAttrs&& attrs,
   if (p_save_inputs == nullptr) {
     p_save_inputs  = &(local_buff->save_inputs);
     p_save_outputs = &(local_buff->save_outputs);
-    GetBackwardDependency(node, inputs.size(), outputs.size(), p_save_inputs, p_save_outputs);
+    // the dependency of an op on its inputs and outputs is the same for every iteration
+    static thread_local BackwardDependencies dependencies;
+    std::ostringstream os;
+    if (GradientKey(*node, &os)) {
+      os << inputs.size() << ':' << outputs.size();
+      const std::string key = os.str();
+      auto it               = dependencies.find(key);
+      if (it == dependencies.end()) {
+        GetBackwardDependency(node, inputs.size(), outputs.size(), p_save_inputs, p_save_outputs);
+        if (dependencies.size() >= kMaxCachedDependencies)
+          dependencies.clear();
+        dependencies.emplace(key, std::make_pair(*p_save_inputs, *p_save_outputs));
+      } else {
+        *p_save_inputs  = it->second.first;
+        *p_save_outputs = it->second.second;
+      }
+      node->inputs.resize(inputs.size());
+    } else {
+      GetBackwardDependency(node, inputs.size(), outputs.size(), p_save_inputs, p_save_outputs);
+    }
   } else {
     node->inputs.resize(inputs.size());
   }
@@ -290,10 +538,8 @@ void Imperative::RecordOp(nnvm::NodeAttrs&& attrs,
 
   for (size_t i = 0; i < inputs.size(); ++i) {
     if (AGInfo::IsNone(*(inputs[i]))) {
-      nnvm::NodeEntry entry{
-          nnvm::Symbol::CreateVariable("null" + std::to_string(variable_count_++)).outputs[0].node,
-          0,
-          0};
+      nnvm::NodeEntry entry{CreateTapeNode(), 0, 0};
+      entry.node->attrs.name = "null" + std::to_string(variable_count_++);
       AGInfo& input_info = AGInfo::Create(entry.node);
       input_info.ctx     = inputs[i]->ctx();
       if (save_inputs[i]) {
@@ -450,8 +696,11 @@ std::vector<NDArray*> Imperative::Backward(const std::vector<NDArray*>& outputs,
                                            bool create_graph) {
   using namespace nnvm;
   using namespace imperative;
-  static const std::vector<const Op*> zero_ops{Op::Get("zeros_like"), Op::Get("_zeros")};
   static const Op* copy_op = Op::Get("_copy");
+  {
+    std::lock_guard<std::mutex> lock(grad_hooks_mutex_);
+    ++backward_epoch_;
+  }
 
   // Construct forward graph
   Graph graph;
@@ -470,7 +719,7 @@ std::vector<NDArray*> Imperative::Backward(const std::vector<NDArray*>& outputs,
   std::vector<NodeEntry> ograd_entries;
   ograd_entries.reserve(ograds.size());
   for (size_t i = 0; i < outputs.size(); ++i) {
-    nnvm::ObjectPtr np = Node::Create();
+    nnvm::ObjectPtr np = CreateTapeNode();
     np->attrs.name     = "_head_grad_" + std::to_string(i);
     ograd_entries.emplace_back(NodeEntry{np, 0, 0});
     AGInfo& info = AGInfo::Create(ograd_entries.back().node);
@@ -527,17 +776,7 @@ std::vector<NDArray*> Imperative::Backward(const std::vector<NDArray*>& outputs,
     us.emplace_back(NodeEntry{i, 0, 0});
   }
 
-  Graph g_graph = pass::MXGradient(graph,
-                                   graph.outputs,
-                                   xs,
-                                   ograd_entries,
-                                   mxnet::AggregateGradient,
-                                   nullptr,
-                                   zero_ops,
-                                   "_copy",
-                                   ShapeVector(),
-                                   DTypeVector(),
-                                   us);
+  Graph g_graph = GradientGraph(graph, xs, ograd_entries, us);
   CHECK_EQ(g_graph.outputs.size(), xs.size());
   for (const auto& e : g_graph.outputs) {
     if (e.node->op() == nullptr) {
@@ -837,4 +1076,56 @@ std::vector<nnvm::ObjectPtr> Imperative::ListNonleafVariables(const nnvm::Symbol
   return ret;
 }
 
+void Imperative::SetGradHook(const NDArray& grad, GradHook hook) {
+  CHECK(!grad.is_none()) << "Cannot set the hook of an empty gradient array";
+  std::lock_guard<std::mutex> lock(grad_hooks_mutex_);
+  if (hook) {
+    grad_hooks_[grad.var()] = GradHookInfo{grad, std::move(hook), backward_epoch_};
+  } else {
+    grad_hooks_.erase(grad.var());
+  }
+}
+
+std::unordered_map<uint32_t, std::vector<Engine::VarHandle>> Imperative::GradHookNodes(
+    const nnvm::IndexedGraph& idx,
+    const std::vector<NDArray*>& arrays,
+    size_t start,
+    size_t end) {
+  std::unordered_map<uint32_t, std::vector<Engine::VarHandle>> ret;
+  std::lock_guard<std::mutex> lock(grad_hooks_mutex_);
+  if (grad_hooks_.empty())
+    return ret;
+  std::unordered_map<Engine::VarHandle, uint32_t> last_writer;
+  for (size_t i = start; i < end; ++i) {
+    if (idx[i].source->is_variable())
+      continue;
+    for (size_t j = 0; j < idx[i].source->num_outputs(); ++j) {
+      const NDArray* arr = arrays[idx.entry_id(i, j)];
+      if (arr->is_none() || !grad_hooks_.count(arr->var()))
+        continue;
+      last_writer[arr->var()] = i;
+    }
+  }
+  for (const auto& kv : last_writer)
+    ret[kv.second].push_back(kv.first);
+  return ret;
+}
+
+void Imperative::RunGradHooks(const std::vector<Engine::VarHandle>& vars) {
+  std::vector<GradHook> hooks;
+  {
+    std::lock_guard<std::mutex> lock(grad_hooks_mutex_);
+    for (const auto& var : vars) {
+      auto it = grad_hooks_.find(var);
+      if (it == grad_hooks_.end() || it->second.epoch == backward_epoch_)
+        continue;
+      it->second.epoch = backward_epoch_;
+      hooks.push_back(it->second.hook);
+    }
+  }
+  // hooks may push operators or set hooks themselves
+  for (const auto& hook : hooks)
+    hook();
+}
+
 }  // namespace mxnet
@@ -140,6 +140,7 @@ void RunGraph(const bool retain_graph,
               const imperative::CachedOpMonCallback& callback,
               const bool monitor_all) {
   CHECK(shapes == nullptr);
+  const auto grad_hook_nodes = Imperative::Get()->GradHookNodes(idx, arrays, node_start, node_end);
   for (size_t i = node_start; i < node_end; ++i) {
     const nnvm::IndexedGraph::Node& node = idx[i];
     if (node.source->op() == nullptr) {
@@ -166,6 +167,9 @@ void RunGraph(const bool retain_graph,
     if (callback) {
       mxnet::common::ExecuteMonOutputCallback(idx, arrays, i, callback);
     }
+    auto hooked = grad_hook_nodes.find(i);
+    if (hooked != grad_hook_nodes.end())
+      Imperative::Get()->RunGradHooks(hooked->second);
   }
 }
 
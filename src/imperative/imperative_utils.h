@@ -24,6 +24,8 @@
 #include <algorithm>
 #include <map>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -173,11 +175,148 @@ inline Context GetContext(const nnvm::NodeAttrs& attrs,
   return ctx;
 }
 
+/*! \brief The attributes inferred for an operator and its inputs */
+struct InferResult {
+  mxnet::ShapeVector in_shapes;
+  mxnet::ShapeVector out_shapes;
+  std::vector<int> in_types;
+  std::vector<int> out_types;
+  std::vector<int> in_storage_types;
+  std::vector<int> out_storage_types;
+  DispatchMode dispatch_mode;
+};
+
+/*! \brief Per thread cache of the attributes inferred by SetShapeType */
+struct InferResultCache {
+  std::unordered_map<std::string, InferResult> results;
+
+  static InferResultCache* Get() {
+    return dmlc::ThreadLocalStore<InferResultCache>::Get();
+  }
+  /*! \brief maximum number of results cached per thread, 0 disables the cache */
+  static size_t Capacity() {
+    static const size_t capacity = dmlc::GetEnv("MXNET_IMPERATIVE_INFER_CACHE_SIZE", 1024);
+    return capacity;
+  }
+};
+
+/*! \brief Build the key of the attributes inferred for an invocation of an operator
+ *
+ * The key covers the operator, its attributes, the context, the numpy semantics and the
+ * shapes, types and storage types of the inputs and of the given outputs. Returns false
+ * for the invocations whose inference cannot be cached: operators without FInferShape,
+ * inputs of unknown shape, and operators whose inference depends on more than their
+ * attribute dictionary, i.e. on subgraphs, cached ops or custom operators.
+ */
+inline bool InferResultKey(const Context& ctx,
+                           const nnvm::NodeAttrs& attrs,
+                           const std::vector<NDArray*>& inputs,
+                           const std::vector<NDArray*>& outputs,
+                           std::string* key) {
+  static auto& infershape = nnvm::Op::GetAttr<mxnet::FInferShape>("FInferShape");
+  static const std::unordered_set<const nnvm::Op*> uncached_ops = {
+      nnvm::Op::Get("_CachedOp"),
+      nnvm::Op::Get("_backward_CachedOp"),
+      nnvm::Op::Get("_CachedOpThreadSafe"),
+      nnvm::Op::Get("Custom"),
+      nnvm::Op::Get("_backward_Custom"),
+      nnvm::Op::Get("_backward_CustomFunction")};
+  if (InferResultCache::Capacity() == 0 || !infershape.count(attrs.op) ||
+      !attrs.subgraphs.empty() || uncached_ops.count(attrs.op)) {
+    return false;
+  }
+  auto append = [key](const auto& value) {
+    key->append(reinterpret_cast<const char*>(&value), sizeof(value));
+  };
+  auto append_shape = [&append](const mxnet::TShape& shape) {
+    append(shape.ndim());
+    for (int i = 0; i < shape.ndim(); ++i)
+      append(shape[i]);
+  };
+  Imperative* imperative = Imperative::Get();
+  key->clear();
+  append(attrs.op);
+  append(ctx.dev_mask());
+  append(imperative->is_np_shape());
+  append(imperative->is_np_default_dtype());
+  append(imperative->is_training());
+  append(inputs.size());
+  for (const NDArray* i : inputs) {
+    if (!shape_is_known(i->shape()))
+      return false;
+    append_shape(i->shape());
+    append(i->dtype());
+    append(i->storage_type());
+  }
+  append(outputs.size());
+  for (const NDArray* o : outputs) {
+    append(o->is_none());
+    if (!o->is_none()) {
+      append_shape(o->shape());
+      append(o->dtype());
+      append(o->storage_type());
+    }
+  }
+  for (const auto& kv : attrs.dict) {
+    append(kv.first.size());
+    key->append(kv.first);
+    append(kv.second.size());
+    key->append(kv.second);
+  }
+  return true;
+}
+
+/*! \brief Initialize the outputs to the inferred shapes, dtypes and storage types, or
+ * check the given outputs against them
+ */
+inline void InitOutputs(const Context& ctx,
+                        const nnvm::NodeAttrs& attrs,
+                        const std::vector<NDArray*>& outputs,
+                        bool is_dynamic_shape_existing,
+                        const mxnet::ShapeVector& out_shapes,
+                        const std::vector<int>& out_types,
+                        const std::vector<int>& out_storage_types) {
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    if (outputs[i]->is_none() || (mxnet::op::shape_is_none(outputs[i]->shape()) &&
+                                  Imperative::DCInfo::IsNone(*outputs[i]))) {
+      if (!is_dynamic_shape_existing) {
+        const auto storage_type = static_cast<NDArrayStorageType>(out_storage_types[i]);
+        outputs[i]->ReInit(storage_type, out_shapes[i], ctx, out_types[i]);
+      } else {
+        *outputs[i] = NDArray(ctx, out_types[i]);
+      }
+      outputs[i]->AssignStorageInfo(common::NodeAttrsGetProfilerScope(attrs), attrs.name);
+    } else if (mxnet::op::shape_is_none(outputs[i]->shape())) {
+      // For deferred computed arrays with unknown shape (following dynamic
+      // shape operator), don't use copy assignment as it would destroy the
+      // deferredcompute metadata.
+      if (!is_dynamic_shape_existing) {
+        outputs[i]->Init(out_shapes[i]);
+      }
+      CHECK_EQ(outputs[i]->dtype(), out_types[i])
+          << i << "-th output has invalid dtype. "
+          << "Expecting " << out_types[i] << " got " << outputs[i]->dtype() << " in operator "
+          << attrs.op->name;
+    } else {
+      CHECK_EQ(outputs[i]->shape(), out_shapes[i])
+          << i << "-th output has invalid shape. "
+          << "Expecting " << out_shapes[i] << " got " << outputs[i]->shape() << " in operator "
+          << attrs.op->name;
+      CHECK_EQ(outputs[i]->dtype(), out_types[i])
+          << i << "-th output has invalid dtype. "
+          << "Expecting " << out_types[i] << " got " << outputs[i]->dtype() << " in operator "
+          << attrs.op->name;
+    }
+  }
+}
+
 /*! \brief Set the shape, dtype, storage type and dispatch mode via the
  * attribute inference functions
  *
  * Inferred information is stored in MXAPIThreadLocalEntry. Existing information
- * is overwritten.
+ * is overwritten. The inferred information of the invocations accepted by
+ * InferResultKey is cached, so that repeated invocations with the same operator,
+ * attributes and inputs skip the inference functions.
  */
 inline void SetShapeType(const Context& ctx,
                          const nnvm::NodeAttrs& attrs,
@@ -188,6 +327,34 @@ inline void SetShapeType(const Context& ctx,
   static auto& infertype       = nnvm::Op::GetAttr<nnvm::FInferType>("FInferType");
   static auto& inferstorage    = nnvm::Op::GetAttr<FInferStorageType>("FInferStorageType");
   MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
+  InferResultCache* cache      = InferResultCache::Get();
+  std::string key;
+  const bool cacheable = InferResultKey(ctx, attrs, inputs, outputs, &key);
+  if (cacheable) {
+    auto it = cache->results.find(key);
+    if (it != cache->results.end()) {
+      const InferResult& result = it->second;
+      ret->arg_shapes           = result.in_shapes;
+      ret->out_shapes           = result.out_shapes;
+      ret->arg_types            = result.in_types;
+      ret->out_types            = result.out_types;
+      ret->arg_storage_types    = result.in_storage_types;
+      ret->out_storage_types    = result.out_storage_types;
+      *dispatch_mode            = result.dispatch_mode;
+      if (*dispatch_mode == DispatchMode::kFComputeFallback) {
+        common::LogStorageFallback(
+            attrs, ctx.dev_mask(), &ret->arg_storage_types, &ret->out_storage_types);
+      }
+      InitOutputs(ctx,
+                  attrs,
+                  outputs,
+                  false,
+                  ret->out_shapes,
+                  ret->out_types,
+                  ret->out_storage_types);
+      return;
+    }
+  }
   // infer shape
   mxnet::ShapeVector& in_shapes = ret->arg_shapes;
   in_shapes.clear();
@@ -291,38 +458,24 @@ inline void SetShapeType(const Context& ctx,
 
   CHECK_EQ(out_storage_types.size(), outputs.size());
   CHECK(*dispatch_mode != DispatchMode::kUndefined);
-  for (size_t i = 0; i < outputs.size(); ++i) {
-    if (outputs[i]->is_none() || (mxnet::op::shape_is_none(outputs[i]->shape()) &&
-                                  Imperative::DCInfo::IsNone(*outputs[i]))) {
-      if (!is_dynamic_shape_existing) {
-        const auto storage_type = static_cast<NDArrayStorageType>(out_storage_types[i]);
-        outputs[i]->ReInit(storage_type, out_shapes[i], ctx, out_types[i]);
-      } else {
-        *outputs[i] = NDArray(ctx, out_types[i]);
-      }
-      outputs[i]->AssignStorageInfo(common::NodeAttrsGetProfilerScope(attrs), attrs.name);
-    } else if (mxnet::op::shape_is_none(outputs[i]->shape())) {
-      // For deferred computed arrays with unknown shape (following dynamic
-      // shape operator), don't use copy assignment as it would destroy the
-      // deferredcompute metadata.
-      if (!is_dynamic_shape_existing) {
-        outputs[i]->Init(out_shapes[i]);
-      }
-      CHECK_EQ(outputs[i]->dtype(), out_types[i])
-          << i << "-th output has invalid dtype. "
-          << "Expecting " << out_types[i] << " got " << outputs[i]->dtype() << " in operator "
-          << attrs.op->name;
-    } else {
-      CHECK_EQ(outputs[i]->shape(), out_shapes[i])
-          << i << "-th output has invalid shape. "
-          << "Expecting " << out_shapes[i] << " got " << outputs[i]->shape() << " in operator "
-          << attrs.op->name;
-      CHECK_EQ(outputs[i]->dtype(), out_types[i])
-          << i << "-th output has invalid dtype. "
-          << "Expecting " << out_types[i] << " got " << outputs[i]->dtype() << " in operator "
-          << attrs.op->name;
-    }
-  }
+  if (cacheable) {
+    if (cache->results.size() >= InferResultCache::Capacity())
+      cache->results.clear();
+    cache->results[key] = InferResult{in_shapes,
+                                      out_shapes,
+                                      in_types,
+                                      out_types,
+                                      in_storage_types,
+                                      out_storage_types,
+                                      *dispatch_mode};
+  }
+  InitOutputs(ctx,
+              attrs,
+              outputs,
+              is_dynamic_shape_existing,
+              out_shapes,
+              out_types,
+              out_storage_types);
 }
 
 /*! \brief Set read and write vars, resource requests and mutate_idx
@@ -698,6 +851,7 @@ inline void PushFCompute(const FCompute& fn,
     // pre-fcompute fallback, cast to default storage type
     CastNonDefaultStorage(pre_temp_src, pre_temp_dst, opctx, is_gpu);
     fn(attrs, opctx, input_blobs, tmp_req, output_blobs);
+    RecordOpCost(attrs, input_blobs, output_blobs);
     // post-fcompute fallback, cast to original storage type
     CastNonDefaultStorage(post_temp_src, post_temp_dst, opctx, is_gpu);
     DerefInputOutputRelease(inputs, outputs);
@@ -735,6 +889,7 @@ inline void PushFComputeEx(const FComputeEx& fn,
     INVALIDATE_OUTPUTS_COND(!cross_device_copy, outputsA, req);
     CREATE_DEFAULT_INPUTS(!cross_device_copy, attrs, CreateDefaultInputs(&inputsA));
     fn(attrs, opctx, inputsA, req, outputsA);
+    common::RecordOpCost(attrs, inputsA, outputsA);
   };
   if (cross_device_copy || CheckIfSkipEngine(attrs)) {
     run(RunContext{ctx, nullptr, nullptr});
@@ -1222,7 +1377,8 @@ inline void SetupOpExec(const nnvm::Graph& g,
 inline Engine::OprHandle CreateEngineOp(
     const Context& default_ctx,
     const std::vector<std::shared_ptr<exec::OpExecutor> >& execs,
-    const char* opr_names) {
+    const char* opr_names,
+    std::shared_ptr<cuda_graphs::CudaGraphsSegCache> cuda_graphs_cache = nullptr) {
   CHECK_GT(execs.size(), 0);
   std::vector<Engine::VarHandle> use_vars, mutate_vars;
 
@@ -1253,7 +1409,7 @@ inline Engine::OprHandle CreateEngineOp(
 #if CUDA_GRAPHS_AVAILABLE
   // Provide initialized `cuda_graphs_exec`, which when captured
   // by exec_fun, acts like a static variable inside the mutable closure.
-  cuda_graphs::CudaGraphsExec cuda_graphs_exec(execs, is_gpu, opr_names);
+  cuda_graphs::CudaGraphsExec cuda_graphs_exec(execs, is_gpu, opr_names, cuda_graphs_cache);
   auto exec_fun = [cuda_graphs_exec, execs, is_async, is_gpu](
                       RunContext ctx,
                       Engine::CallbackOnStart on_start,
@@ -1289,6 +1445,49 @@ inline Engine::OprHandle CreateEngineOp(
       exec_fun, use_vars, mutate_vars, FnProperty::kNormal, opr_names);
 }
 
+/*!
+ * \brief assign the nodes in [start_nid, end_nid) to branches, chains of nodes where
+ *  each node consumes an output of the previous one. A node continues the branch of
+ *  the first of its inputs not continued yet, a node whose inputs are all continued
+ *  starts a new branch, and a node without inputs in the range continues the branch
+ *  of the previous node.
+ *
+ *  Independent branches of the graph, e.g. the towers of an inception block, are
+ *  then different branches, which can run concurrently on different streams if
+ *  they are not in the same engine operator.
+ * \return the branch of each node, -1 for the nodes out of the range and variables
+ */
+inline std::vector<int> AssignBranches(const nnvm::IndexedGraph& idx,
+                                       const size_t start_nid,
+                                       const size_t end_nid) {
+  std::vector<int> branches(idx.num_nodes(), -1);
+  std::vector<bool> continued(idx.num_nodes(), false);
+  int num_branches = 0;
+  int prev_branch  = -1;
+  for (size_t nid = start_nid; nid < end_nid; ++nid) {
+    const auto& node = idx[nid];
+    if (node.source->is_variable())
+      continue;
+    int branch     = -1;
+    bool has_input = false;
+    for (const auto& e : node.inputs) {
+      if (branches[e.node_id] < 0)
+        continue;
+      has_input = true;
+      if (!continued[e.node_id]) {
+        branch               = branches[e.node_id];
+        continued[e.node_id] = true;
+        break;
+      }
+    }
+    if (branch < 0) {
+      branch = has_input || prev_branch < 0 ? num_branches++ : prev_branch;
+    }
+    branches[nid] = prev_branch = branch;
+  }
+  return branches;
+}
+
 inline void CreateEngineOpSeg(const nnvm::IndexedGraph& idx,
                               const Context default_ctx,
                               const size_t start_nid,
@@ -1296,10 +1495,13 @@ inline void CreateEngineOpSeg(const nnvm::IndexedGraph& idx,
                               const size_t bulk_size,
                               const std::vector<std::shared_ptr<exec::OpExecutor> >& execs,
                               const std::vector<int> skip_plus_node,
-                              std::vector<EngineOprSeg>* opr_segs) {
+                              std::vector<EngineOprSeg>* opr_segs,
+                              const std::vector<int>& branches = {},
+                              cuda_graphs::CudaGraphsSegCaches* cuda_graphs_caches = nullptr) {
   size_t seg_start = start_nid;
   std::vector<std::shared_ptr<exec::OpExecutor> > seg_execs;
   std::string opr_names = "[";
+  int seg_branch        = -1;
   for (size_t nid = start_nid; nid < end_nid; ++nid) {
     const auto& node = idx[nid];
     if (node.source->is_variable())
@@ -1311,8 +1513,10 @@ inline void CreateEngineOpSeg(const nnvm::IndexedGraph& idx,
     bool is_async       = exec->exec_type() != ExecType::kSync;
     bool valid          = exec->out_array.size() > 0;
 
-    // Stop at async nodes and invalid node (due to input/output is not allocated)
-    bool stop = is_async || !valid || seg_execs.size() >= bulk_size;
+    // Stop at async nodes and invalid node (due to input/output is not allocated),
+    // and between branches so that they run concurrently
+    bool stop = is_async || !valid || seg_execs.size() >= bulk_size ||
+                (branches.size() && seg_execs.size() && branches[nid] != seg_branch);
 
     // Create opr segment for previous nodes.
     if (stop && nid > seg_start) {
@@ -1321,7 +1525,10 @@ inline void CreateEngineOpSeg(const nnvm::IndexedGraph& idx,
         seg = EngineOprSeg{false, nid};
         opr_names.pop_back();
         opr_names += "]";
-        seg.opr.reset(CreateEngineOp(default_ctx, seg_execs, opr_names.c_str()));
+        seg.opr.reset(CreateEngineOp(default_ctx,
+                                   seg_execs,
+                                   opr_names.c_str(),
+                                   cuda_graphs::GetSegCache(cuda_graphs_caches, seg_start)));
       } else {
         seg = EngineOprSeg{true, nid, nullptr};
       }
@@ -1331,6 +1538,8 @@ inline void CreateEngineOpSeg(const nnvm::IndexedGraph& idx,
     }
 
     seg_execs.push_back(exec);
+    if (branches.size())
+      seg_branch = branches[nid];
 
     const auto& inode = idx[nid];
     opr_names += op_name;
@@ -1354,7 +1563,10 @@ inline void CreateEngineOpSeg(const nnvm::IndexedGraph& idx,
       seg = EngineOprSeg{false, nid + 1};
       opr_names.pop_back();
       opr_names += "]";
-      seg.opr.reset(CreateEngineOp(default_ctx, seg_execs, opr_names.c_str()));
+      seg.opr.reset(CreateEngineOp(default_ctx,
+                                   seg_execs,
+                                   opr_names.c_str(),
+                                   cuda_graphs::GetSegCache(cuda_graphs_caches, seg_start)));
       seg_execs.clear();
       opr_names.clear();
       seg_start = nid + 1;
@@ -1367,7 +1579,10 @@ inline void CreateEngineOpSeg(const nnvm::IndexedGraph& idx,
       seg = EngineOprSeg{false, end_nid};
       opr_names.pop_back();
       opr_names += "]";
-      seg.opr.reset(CreateEngineOp(default_ctx, seg_execs, opr_names.c_str()));
+      seg.opr.reset(CreateEngineOp(default_ctx,
+                                   seg_execs,
+                                   opr_names.c_str(),
+                                   cuda_graphs::GetSegCache(cuda_graphs_caches, seg_start)));
     } else {
       seg = EngineOprSeg{true, end_nid, nullptr};
     }
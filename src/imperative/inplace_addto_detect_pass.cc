@@ -26,6 +26,8 @@
 #include <mxnet/op_attr_types.h>
 #include <nnvm/graph_attr_types.h>
 
+#include <algorithm>
+
 #include "./exec_pass.h"
 
 namespace mxnet {
@@ -36,6 +38,7 @@ Graph DetectInplaceAddTo(Graph g) {
   std::vector<int> storage_inplace_index =
       g.MoveCopyAttr<std::vector<int> >("storage_inplace_index");
   static const Op* ewise_plus_op = Op::Get("_grad_add");
+  static const Op* ewise_sum_op  = Op::Get("ElementWiseSum");
   auto& idx                      = g.indexed_graph();
   // reference cont.
   std::vector<int> ref_count(idx.num_node_entries(), 0);
@@ -46,6 +49,7 @@ Graph DetectInplaceAddTo(Graph g) {
     addto_entry = std::vector<int>(idx.num_node_entries(), 0);
   }
   std::vector<int> skip_plus_node(idx.num_nodes(), 0);
+  std::vector<int> addto_alias(idx.num_node_entries(), -1);
 
   for (auto& e : idx.outputs()) {
     ++ref_count[idx.entry_id(e)];
@@ -56,8 +60,57 @@ Graph DetectInplaceAddTo(Graph g) {
     }
   }
 
+  // whether the input can be written with kAddTo into the storage of the sum
+  auto addable = [&](const nnvm::NodeEntry& e) {
+    uint32_t eid = idx.entry_id(e);
+    return !idx[e.node_id].source->is_variable() && ref_count[eid] == 1 && storage_id[eid] >= 0;
+  };
+
   for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
     const auto& inode = idx[nid];
+    if (inode.source->op() == ewise_sum_op) {
+      uint32_t eid_out = idx.entry_id(nid, 0);
+      int sid          = storage_id[eid_out];
+      if (!std::all_of(inode.inputs.begin(), inode.inputs.end(), addable))
+        continue;
+      if (sid >= 0) {
+        // the sum is planned inplace of one of its inputs, the others are added into it
+        // once that one is written
+        auto base = std::find_if(inode.inputs.begin(), inode.inputs.end(), [&](const auto& e) {
+          return storage_id[idx.entry_id(e)] == sid;
+        });
+        if (base == inode.inputs.end())
+          continue;
+        bool written_after = true;
+        for (const auto& e : inode.inputs) {
+          if (idx.entry_id(e) != idx.entry_id(*base) && e.node_id <= base->node_id)
+            written_after = false;
+        }
+        if (!written_after)
+          continue;
+        for (const auto& e : inode.inputs) {
+          uint32_t eid = idx.entry_id(e);
+          if (eid == idx.entry_id(*base))
+            continue;
+          storage_id[eid]            = sid;
+          addto_entry[eid]           = 1;
+          storage_inplace_index[eid] = -1;
+        }
+        skip_plus_node[nid] = 1;
+      } else if (sid == kExternalStorageID && addto_entry[eid_out] && ref_count[eid_out] == 1) {
+        // the sum is accumulated into a gradient with grad_req add: all its inputs are
+        // added into the gradient by their producers
+        for (const auto& e : inode.inputs) {
+          uint32_t eid               = idx.entry_id(e);
+          storage_id[eid]            = kExternalStorageID;
+          addto_entry[eid]           = 1;
+          storage_inplace_index[eid] = -1;
+          addto_alias[eid]           = eid_out;
+        }
+        skip_plus_node[nid] = 1;
+      }
+      continue;
+    }
     if (inode.source->op() != ewise_plus_op)
       continue;
     int sid = storage_id[idx.entry_id(inode.inputs[0])];
@@ -86,6 +139,7 @@ Graph DetectInplaceAddTo(Graph g) {
   g.attrs["storage_inplace_index"] = std::make_shared<nnvm::any>(std::move(storage_inplace_index));
   g.attrs["addto_entry"]           = std::make_shared<nnvm::any>(std::move(addto_entry));
   g.attrs["skip_plus_node"]        = std::make_shared<nnvm::any>(std::move(skip_plus_node));
+  g.attrs["addto_alias"]           = std::make_shared<nnvm::any>(std::move(addto_alias));
   return g;
 }
 
@@ -31,9 +31,14 @@
 #include <algorithm>
 #include <queue>
 #include <chrono>
+#include <map>
+#include <string>
+#include <utility>
 #include "./simple_partition_pass.h"
 #include "../operator/fusion/fused_op-inl.h"
 #include "../operator/fusion/fused_op.h"
+#include "../operator/nn/dropout-inl.h"
+#include "../operator/nn/layer_norm-inl.h"
 #include "../operator/operator_common.h"
 
 namespace mxnet {
@@ -54,10 +59,9 @@ void WarnFusionNotSupported() {
   }
 }
 
-#if MXNET_USE_CUDA
-
 namespace {
 
+#if MXNET_USE_CUDA
 bool IsFusionCompatible(const nnvm::Node* n) {
   using namespace mxnet::fusion;
   if (n->op() == nullptr)
@@ -104,6 +108,16 @@ bool IsInputsOnlyCompatible(const nnvm::Node* n) {
   }
   return false;
 }
+#endif  // MXNET_USE_CUDA
+
+bool IsCPUFusionCompatible(const nnvm::Node* n) {
+  return mxnet::fusion::IsCPUFusionCompatible(n->attrs);
+}
+
+bool IsCPUInputsOnlyCompatible(const nnvm::Node* n) {
+  // the fused op on CPU only reads its inputs elementwise
+  return false;
+}
 
 void CreateSubgraphNode(const nnvm::Graph& subgraph,
                         size_t inputs_size,
@@ -331,12 +345,20 @@ Graph CopyAndReplaceSubgraphs(const Graph& g,
   return ret;
 }
 
-Graph FusePointwise(const Graph& g, const size_t num_forward_outputs) {
-  auto start                            = std::chrono::steady_clock::now();
+Graph FusePointwise(const Graph& g, const size_t num_forward_outputs, const int dev_mask) {
+  auto start                                           = std::chrono::steady_clock::now();
+  bool (*is_compatible)(const nnvm::Node*)             = IsCPUFusionCompatible;
+  bool (*is_inputs_only_compatible)(const nnvm::Node*) = IsCPUInputsOnlyCompatible;
+#if MXNET_USE_CUDA
+  if (dev_mask == gpu::kDevMask) {
+    is_compatible             = IsFusionCompatible;
+    is_inputs_only_compatible = IsInputsOnlyCompatible;
+  }
+#endif  // MXNET_USE_CUDA
   auto [subset_assignment, num_subsets] = GetCompatibleSubsets(g,                    // NOLINT(*)
                                                                num_forward_outputs,  // NOLINT(*)
-                                                               IsFusionCompatible,
-                                                               IsInputsOnlyCompatible);
+                                                               is_compatible,
+                                                               is_inputs_only_compatible);
   Graph ret = CopyAndReplaceSubgraphs(g, subset_assignment, num_subsets, CreateSubgraphNode);
   auto end  = std::chrono::steady_clock::now();
   if (dmlc::GetEnv("MXNET_RTC_VERBOSE", false)) {
@@ -346,7 +368,76 @@ Graph FusePointwise(const Graph& g, const size_t num_forward_outputs) {
   }
   return ret;
 }
-#endif  // MXNET_USE_CUDA
+
+Graph FuseDropoutAddLayerNorm(Graph&& g) {
+  using nnvm::Node;
+  using nnvm::NodeEntry;
+  using nnvm::ObjectPtr;
+  static const Op* dropout_op    = Op::Get("Dropout");
+  static const Op* add_op        = Op::Get("elemwise_add");
+  static const Op* layer_norm_op = Op::Get("LayerNorm");
+  static const Op* fused_op      = Op::Get("_contrib_dropout_add_layer_norm");
+  // number of uses of every node output, the graph outputs included
+  std::map<std::pair<const Node*, uint32_t>, int> uses;
+  for (const auto& out : g.outputs)
+    ++uses[{out.node.get(), out.index}];
+  nnvm::DFSVisit(g.outputs, [&uses](const ObjectPtr& n) {
+    for (const auto& e : n->inputs)
+      ++uses[{e.node.get(), e.index}];
+  });
+  // matched LayerNorm nodes and their replacement
+  std::map<const Node*, ObjectPtr> replaced;
+  nnvm::DFSVisit(g.outputs, [&](const ObjectPtr& ln) {
+    if (ln->op() != layer_norm_op || !ln->control_deps.empty())
+      return;
+    const auto& ln_param = nnvm::get<op::LayerNormParam>(ln->attrs.parsed);
+    if (ln_param.axis != -1 || ln_param.output_mean_var)
+      return;
+    const ObjectPtr& add = ln->inputs[0].node;
+    if (add->op() != add_op || uses[{add.get(), 0}] != 1 || !add->control_deps.empty())
+      return;
+    // the dropout may be either operand of the sum
+    for (int d = 0; d < 2; ++d) {
+      const NodeEntry& dropped = add->inputs[d];
+      const ObjectPtr& dropout = dropped.node;
+      if (dropout->op() != dropout_op || dropped.index != 0 ||
+          uses[{dropout.get(), 0}] != 1 || !dropout->control_deps.empty())
+        continue;
+      const auto& dropout_param = nnvm::get<op::DropoutParam>(dropout->attrs.parsed);
+      if (dropout_param.axes.ndim() != 0)
+        continue;
+      // the fused operator has the defaults of Dropout and LayerNorm, unset attributes stay so
+      ObjectPtr fused   = Node::Create();
+      fused->attrs.op   = fused_op;
+      fused->attrs.name = ln->attrs.name;
+      for (const char* key : {"p", "mode"}) {
+        if (dropout->attrs.dict.count(key))
+          fused->attrs.dict[key] = dropout->attrs.dict.at(key);
+      }
+      if (ln->attrs.dict.count("eps"))
+        fused->attrs.dict["eps"] = ln->attrs.dict.at("eps");
+      fused_op->attr_parser(&(fused->attrs));
+      fused->inputs = {dropout->inputs[0], add->inputs[1 - d], ln->inputs[1], ln->inputs[2]};
+      replaced[ln.get()] = fused;
+      return;
+    }
+  });
+  if (replaced.empty())
+    return std::move(g);
+  // only the normalized output of a matched LayerNorm can be used by the rest of the graph
+  auto redirect = [&replaced](NodeEntry* e) {
+    auto it = replaced.find(e->node.get());
+    if (it != replaced.end())
+      *e = NodeEntry{it->second, 0, 0};
+  };
+  nnvm::DFSVisit(g.outputs, [&redirect](const ObjectPtr& n) {
+    for (auto& e : n->inputs)
+      redirect(&e);
+  });
+  for (auto& out : g.outputs)
+    redirect(&out);
+  return std::move(g);
+}
 
 }  // namespace exec
 }  // namespace mxnet
@@ -26,8 +26,8 @@
 #include <mxnet/io.h>
 #include <mshadow/tensor.h>
 #include <mshadow/extension.h>
-#include <mshadow/extension/slice.h>
 
+#include <algorithm>
 #include <stack>
 #include <cmath>
 
@@ -251,8 +251,8 @@ class PadBatchify : public BatchifyFunction {
       for (dim_t k = 0; k < ashape.ndim(); ++k) {
         // pad to multiple of round_to
         if (param_.round_to > 0) {
-          ashape[k] = param_.round_to *
-                      static_cast<int>(std::ceil(static_cast<double>(ashape[k] / param_.round_to)));
+          ashape[k] = param_.round_to * static_cast<dim_t>(std::ceil(
+                                            static_cast<double>(ashape[k]) / param_.round_to));
         }
       }
 
@@ -271,88 +271,29 @@ class PadBatchify : public BatchifyFunction {
           (*outputs)[i].ReshapeAndAlloc(sshape);
         }
       } else {
-        (*outputs)[i] = NDArray(sshape, mxnet::Context::CPU(0), false, inputs[0][i].dtype());
+        (*outputs)[i] = NDArray(sshape, mxnet::Context::CPU(0), false, dtype);
       }
       MSHADOW_TYPE_SWITCH_WITH_BOOL(dtype, DType, {
-        // fill pad value first
-        std::fill((*outputs)[i].data().dptr<DType>(),
-                  (*outputs)[i].data().dptr<DType>() + sshape.Size(),
-                  static_cast<DType>(param_.pad_val));
-        DType* ptr = (*outputs)[i].data().dptr<DType>();
-        auto asize = ashape.Size();
-        int sbs    = static_cast<int>(bs);
+        DType* ptr       = (*outputs)[i].data().dptr<DType>();
+        const DType pad  = static_cast<DType>(param_.pad_val);
+        const auto asize = ashape.Size();
+        int sbs          = static_cast<int>(bs);
         omp_parallel(bs) for (int j = 0; j < sbs; ++j) {
-          using namespace mshadow::expr;
-          auto compact_shapes = CompactShapes(ashape, inputs[j][i].shape());
-          // inputs[j][i].WaitToRead();
-          auto& fshape = compact_shapes.first;
-          auto& cshape = compact_shapes.second;
-          switch (fshape.size()) {
-            case 1U: {
-              mshadow::Tensor<cpu, 1, DType> dst =
-                  TBlob(ptr + asize * j, ashape, cpu::kDevMask, dtype, 0)
-                      .get_with_shape<cpu, 1, DType>(mshadow::Shape1(fshape[0]));
-              mshadow::Tensor<cpu, 1, DType> src =
-                  inputs[j][i].data().get_with_shape<cpu, 1, DType>(mshadow::Shape1(cshape[0]));
-              slice<0>(dst, 0, cshape[0]) = src;
-              break;
-            }
-            case 2U: {
-              mshadow::Tensor<cpu, 2, DType> dst =
-                  TBlob(ptr + asize * j, ashape, cpu::kDevMask, dtype, 0)
-                      .get_with_shape<cpu, 2, DType>(mshadow::Shape2(fshape[0], fshape[1]));
-              mshadow::Tensor<cpu, 2, DType> src =
-                  inputs[j][i].data().get_with_shape<cpu, 2, DType>(
-                      mshadow::Shape2(cshape[0], cshape[1]));
-              slice<1>(slice<0>(dst, 0, cshape[0]), 0, cshape[1]) = src;
-              break;
-            }
-            case 3U: {
-              mshadow::Tensor<cpu, 3, DType> dst =
-                  TBlob(ptr + asize * j, ashape, cpu::kDevMask, dtype, 0)
-                      .get_with_shape<cpu, 3, DType>(
-                          mshadow::Shape3(fshape[0], fshape[1], fshape[2]));
-              mshadow::Tensor<cpu, 3, DType> src =
-                  inputs[j][i].data().get_with_shape<cpu, 3, DType>(
-                      mshadow::Shape3(cshape[0], cshape[1], cshape[2]));
-              slice<2>(slice<1>(slice<0>(dst, 0, cshape[0]), 0, cshape[1]), 0, cshape[2]) = src;
-              break;
-            }
-            case 4U: {
-              mshadow::Tensor<cpu, 4, DType> dst =
-                  TBlob(ptr + asize * j, ashape, cpu::kDevMask, dtype, 0)
-                      .get_with_shape<cpu, 4, DType>(
-                          mshadow::Shape4(fshape[0], fshape[1], fshape[2], fshape[3]));
-              mshadow::Tensor<cpu, 4, DType> src =
-                  inputs[j][i].data().get_with_shape<cpu, 4, DType>(
-                      mshadow::Shape4(cshape[0], cshape[1], cshape[2], cshape[3]));
-              slice<3>(slice<2>(slice<1>(slice<0>(dst, 0, cshape[0]), 0, cshape[1]), 0, cshape[2]),
-                       0,
-                       cshape[3]) = src;
-              break;
-            }
-            case 5U: {
-              mshadow::Tensor<cpu, 5, DType> dst =
-                  TBlob(ptr + asize * j, ashape, cpu::kDevMask, dtype, 0)
-                      .get_with_shape<cpu, 5, DType>(
-                          mshadow::Shape5(fshape[0], fshape[1], fshape[2], fshape[3], fshape[4]));
-              mshadow::Tensor<cpu, 5, DType> src =
-                  inputs[j][i].data().get_with_shape<cpu, 5, DType>(
-                      mshadow::Shape5(cshape[0], cshape[1], cshape[2], cshape[3], cshape[4]));
-              slice<4>(
-                  slice<3>(
-                      slice<2>(slice<1>(slice<0>(dst, 0, cshape[0]), 0, cshape[1]), 0, cshape[2]),
+          omp_exc_.Run([&] {
+            const NDArray& sample = inputs[j][i];
+            auto compact_shapes   = CompactShapes(ashape, sample.shape());
+            // samples keep their own type, dtype only sets the output type
+            MSHADOW_TYPE_SWITCH_WITH_BOOL(sample.dtype(), SType, {
+              PadCopy(sample.data().dptr<SType>(),
+                      compact_shapes.first,
+                      compact_shapes.second,
                       0,
-                      cshape[3]),
-                  0,
-                  cshape[4]) = src;
-              break;
-            }
-            default: {
-              LOG(FATAL) << "# dim to pad: " << cshape.size() << " exceeds limit of 5.";
-            }
-          }
+                      pad,
+                      ptr + asize * j);
+            });
+          });
         }
+        omp_exc_.Rethrow();
       })
     }
     return true;
@@ -364,6 +305,35 @@ class PadBatchify : public BatchifyFunction {
   /*! \brief OMPException obj to store and rethrow exceptions from omp blocks*/
   dmlc::OMPException omp_exc_;
 
+  /*!
+   * \brief write a sample into its padded slot of the output, every element once.
+   *  Rows of the innermost dimension are cast to DType and their tail filled with pad.
+   * \param fshape compacted padded shape, cshape compacted sample shape.
+   */
+  template <typename SType, typename DType>
+  static void PadCopy(const SType* src,
+                      const std::vector<dim_t>& fshape,
+                      const std::vector<dim_t>& cshape,
+                      size_t k,
+                      DType pad,
+                      DType* dst) {
+    if (k + 1 == fshape.size()) {
+      std::transform(
+          src, src + cshape[k], dst, [](const SType& v) { return static_cast<DType>(v); });
+      std::fill(dst + cshape[k], dst + fshape[k], pad);
+      return;
+    }
+    size_t fstride = 1, cstride = 1;
+    for (size_t d = k + 1; d < fshape.size(); ++d) {
+      fstride *= fshape[d];
+      cstride *= cshape[d];
+    }
+    for (dim_t r = 0; r < cshape[k]; ++r) {
+      PadCopy(src + r * cstride, fshape, cshape, k + 1, pad, dst + r * fstride);
+    }
+    std::fill(dst + cshape[k] * fstride, dst + fshape[k] * fstride, pad);
+  }
+
   std::pair<std::vector<dim_t>, std::vector<dim_t>> CompactShapes(const TShape& ashape,
                                                                   const TShape& ishape) {
     // squeeze dimensions that do not need pad
@@ -23,7 +23,9 @@
  */
 #include <dmlc/parameter.h>
 #include <dmlc/omp.h>
+#include <dmlc/threadediter.h>
 #include <mxnet/io.h>
+#include <utility>
 
 #include "./inst_vector.h"
 #include "./iter_prefetcher.h"
@@ -61,7 +63,12 @@ class ThreadedDataLoader : public IIterator<TBlobBatch> {
  public:
   ThreadedDataLoader() = default;
   // destructor
-  ~ThreadedDataLoader() override = default;
+  ~ThreadedDataLoader() override {
+    if (current_ != nullptr) {
+      loader_.Recycle(&current_);
+    }
+    loader_.Destroy();
+  }
   // constructor
   void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) override {
     param_.InitAllowUnknown(kwargs);
@@ -79,11 +86,25 @@ class ThreadedDataLoader : public IIterator<TBlobBatch> {
     dataset_len_ = dataset_->GetLen();
     sampler_     = static_cast<IIterator<DataBatch>*>(reinterpret_cast<void*>(param_.sampler));
     batchify_fn_ = *static_cast<BatchifyFunctionPtr*>(reinterpret_cast<void*>(param_.batchify_fn));
-    this->BeforeFirst();
+    sampler_->BeforeFirst();
+    // samples are loaded by a persistent thread, at most kLoadAhead batches ahead
+    loader_.set_max_capacity(kLoadAhead);
+    loader_.Init(
+        [this](Samples** dptr) {
+          if (*dptr == nullptr) {
+            *dptr = new Samples();
+          }
+          return LoadSamples(*dptr);
+        },
+        [this]() { sampler_->BeforeFirst(); });
   }
   // before first
   void BeforeFirst() override {
-    sampler_->BeforeFirst();
+    if (current_ != nullptr) {
+      loader_.Recycle(&current_);
+    }
+    // drops the batches loaded ahead
+    loader_.BeforeFirst();
   }
 
   int64_t GetLenHint() const override {
@@ -91,8 +112,39 @@ class ThreadedDataLoader : public IIterator<TBlobBatch> {
   }
 
   bool Next() override {
-    bool has_next = sampler_->Next();
-    if (!has_next)
+    if (current_ != nullptr) {
+      loader_.Recycle(&current_);
+    }
+    // an error raised while loading the batch is rethrown here
+    if (!loader_.Next(&current_))
+      return false;
+    // the loader thread keeps loading the next batches meanwhile
+    Batchify();
+    return true;
+  }
+
+  const TBlobBatch& Value() const override {
+    return out_;
+  }
+
+ private:
+  /*! \brief number of batches loaded ahead of the one being batchified */
+  static constexpr size_t kLoadAhead = 2;
+
+  /*! \brief samples of a batch, returned by __getitem__ */
+  struct Samples {
+    std::vector<std::vector<NDArray> > inputs;
+    int num_batch_padd{0};
+  };
+
+  /*!
+   * \brief draw the next batch of indices from the sampler and load its samples.
+   *  Samples are handed to the workers one at a time, so that a worker done with
+   *  cheap samples takes over the remaining ones instead of idling.
+   * \return false at the end of the sampler.
+   */
+  bool LoadSamples(Samples* out) {
+    if (!sampler_->Next())
       return false;
     auto samples           = sampler_->Value();
     auto batch_size        = samples.data[0].shape().Size();
@@ -102,13 +154,15 @@ class ThreadedDataLoader : public IIterator<TBlobBatch> {
     idx_ptrs.assign(idx_ptr, idx_ptr + real_batch_size);
 
     // __getitem__
-    std::vector<std::vector<NDArray> > inputs(batch_size);
-    std::vector<int> is_scalars;
+    // datasets may append to the vector of an item, so the items start empty
+    std::vector<std::vector<NDArray> >& inputs = out->inputs;
+    inputs.clear();
+    inputs.resize(batch_size);
     bool profiling = profiler::Profiler::Get()->IsProfiling(profiler::Profiler::kImperative);
     if (profiling) {
       profiler::CustomOpProfiler::Get()->OnCustomBegin("MXThreadedDataLoaderGetItems");
     }
-#pragma omp parallel for num_threads(param_.num_workers)
+#pragma omp parallel for num_threads(param_.num_workers) schedule(dynamic, 1)
     for (int i = 0; i < real_batch_size; ++i) {
       omp_exc_.Run([&] {
         auto idx = idx_ptrs[i];
@@ -124,12 +178,17 @@ class ThreadedDataLoader : public IIterator<TBlobBatch> {
     for (size_t i = real_batch_size; i < batch_size; ++i) {
       inputs[i] = inputs[0];
     }
+    out->num_batch_padd = samples.num_batch_padd;
+    return true;
+  }
 
-    // batchify
+  /*! \brief batchify the samples of current_ into out_ */
+  void Batchify() {
+    bool profiling = profiler::Profiler::Get()->IsProfiling(profiler::Profiler::kImperative);
     if (profiling) {
       profiler::CustomOpProfiler::Get()->OnCustomBegin("MXThreadedDataLoaderBatchify");
     }
-    CHECK(batchify_fn_->Batchify(inputs, &batched_buffer_))
+    CHECK(batchify_fn_->Batchify(current_->inputs, &batched_buffer_))
         << "Error call batchify inside dataloader";
     if (profiling) {
       profiler::CustomOpProfiler::Get()->OnCustomEnd();
@@ -139,15 +198,9 @@ class ThreadedDataLoader : public IIterator<TBlobBatch> {
     for (size_t i = 0; i < batched_buffer_.size(); ++i) {
       out_.data[i] = batched_buffer_[i].data();
     }
-    out_.num_batch_padd = samples.num_batch_padd;
-    return true;
-  }
-
-  const TBlobBatch& Value() const override {
-    return out_;
+    out_.num_batch_padd = current_->num_batch_padd;
   }
 
- private:
   /*! \brief Params */
   ThreadedDataLoaderParam param_;
   /*! \brief output */
@@ -164,6 +217,10 @@ class ThreadedDataLoader : public IIterator<TBlobBatch> {
   BatchifyFunctionPtr batchify_fn_;
   /*! \brief OMPException obj to store and rethrow exceptions from omp blocks*/
   dmlc::OMPException omp_exc_;
+  /*! \brief thread loading the samples of the next batches */
+  dmlc::ThreadedIter<Samples> loader_;
+  /*! \brief samples being batchified, owned by loader_ */
+  Samples* current_{nullptr};
 };  // class ThreadedDataLoader
 
 MXNET_REGISTER_IO_ITER(ThreadedDataLoader)
@@ -37,6 +37,8 @@
 #include "../imperative/cached_op.h"
 #include "../imperative/naive_cached_op.h"
 #include "../ndarray/ndarray_function.h"
+#include "./mmap_recordio.h"
+#include "./sample_cache.h"
 
 #if MXNET_USE_OPENCV
 #include <opencv2/opencv.hpp>
@@ -49,10 +51,14 @@ namespace io {
 struct RecordFileDatasetParam : public dmlc::Parameter<RecordFileDatasetParam> {
   std::string rec_file;
   std::string idx_file;
+  bool use_mmap;
   // declare parameters
   DMLC_DECLARE_PARAMETER(RecordFileDatasetParam) {
     DMLC_DECLARE_FIELD(rec_file).describe("The absolute path of record file.");
     DMLC_DECLARE_FIELD(idx_file).describe("The path of the idx file.");
+    DMLC_DECLARE_FIELD(use_mmap).set_default(true).describe(
+        "Map a local record file in memory and return records as views into it "
+        "instead of copies. Ignored for remote files.");
   }
 };  // struct RecordFileDatasetParam
 
@@ -71,6 +77,9 @@ class RecordFileDataset final : public Dataset {
       idx_[key] = idx;
     }
     delete idx_stream;
+    if (param_.use_mmap && MMapRecordIOFile::Supported(param_.rec_file)) {
+      file_ = std::make_shared<MMapRecordIOFile>(param_.rec_file);
+    }
   }
 
   uint64_t GetLen() const override {
@@ -80,6 +89,25 @@ class RecordFileDataset final : public Dataset {
   bool GetItem(uint64_t idx, std::vector<NDArray>* ret) override {
     ret->resize(1);
     auto& out = (*ret)[0];
+    if (file_ != nullptr) {
+      size_t pos = idx_[static_cast<size_t>(idx)];
+      char* buf;
+      size_t size;
+      static thread_local std::string parts_buff;
+      if (file_->GetRecord(pos, &buf, &size, &parts_buff)) {
+        if (parts_buff.empty()) {
+          // view into the mapping, which the array keeps alive
+          std::shared_ptr<MMapRecordIOFile> file = file_;
+          out = NDArray(
+              TBlob(buf, TShape({static_cast<dim_t>(size)}), cpu::kDevMask, mshadow::kInt8, 0),
+              0,
+              [file]() {});
+        } else {
+          CopyRecord(buf, size, &out);
+        }
+      }
+      return true;
+    }
     static thread_local std::unique_ptr<dmlc::Stream> stream;
     static thread_local std::unique_ptr<dmlc::RecordIOReader> reader;
     if (!reader) {
@@ -91,29 +119,34 @@ class RecordFileDataset final : public Dataset {
     reader->Seek(pos);
     static thread_local std::string read_buff;
     if (reader->NextRecord(&read_buff)) {
-      const char* buf   = read_buff.c_str();
-      const size_t size = read_buff.size();
-      out = NDArray(TShape({static_cast<dim_t>(size)}), Context::CPU(), false, mshadow::kInt8);
-      TBlob dst = out.data();
-      RunContext rctx{Context::CPU(), nullptr, nullptr};
-      mxnet::ndarray::Copy<cpu, cpu>(TBlob(const_cast<void*>(reinterpret_cast<const void*>(buf)),
-                                           out.shape(),
-                                           cpu::kDevMask,
-                                           out.dtype(),
-                                           0),
-                                     &dst,
-                                     Context::CPU(),
-                                     Context::CPU(),
-                                     rctx);
+      CopyRecord(read_buff.c_str(), read_buff.size(), &out);
     }
     return true;
   }
 
  private:
+  /*! \brief copy a record into a new array */
+  static void CopyRecord(const char* buf, size_t size, NDArray* out) {
+    *out      = NDArray(TShape({static_cast<dim_t>(size)}), Context::CPU(), false, mshadow::kInt8);
+    TBlob dst = out->data();
+    RunContext rctx{Context::CPU(), nullptr, nullptr};
+    mxnet::ndarray::Copy<cpu, cpu>(TBlob(const_cast<void*>(reinterpret_cast<const void*>(buf)),
+                                         out->shape(),
+                                         cpu::kDevMask,
+                                         out->dtype(),
+                                         0),
+                                   &dst,
+                                   Context::CPU(),
+                                   Context::CPU(),
+                                   rctx);
+  }
+
   /*! \brief parameters */
   RecordFileDatasetParam param_;
   /*! \brief indices */
   std::unordered_map<size_t, size_t> idx_;
+  /*! \brief mapped record file, if use_mmap */
+  std::shared_ptr<MMapRecordIOFile> file_;
 };
 
 MXNET_REGISTER_IO_DATASET(RecordFileDataset)
@@ -522,6 +555,10 @@ struct LazyTransformDatasetParam : public dmlc::Parameter<LazyTransformDatasetPa
   Tuple<int> transform_indices;
   /*! \brief is_scalar information for outputs */
   Tuple<int> scalar_outputs;
+  /*! \brief memory of the cache of base items in MB */
+  int cache_size;
+  /*! \brief directory of the base items over cache_size */
+  std::string cache_dir;
   // declare parameters
   DMLC_DECLARE_PARAMETER(LazyTransformDatasetParam) {
     DMLC_DECLARE_FIELD(cached_op).describe("Pointer to cached transform function.");
@@ -534,6 +571,16 @@ struct LazyTransformDatasetParam : public dmlc::Parameter<LazyTransformDatasetPa
             "then all items will be processed.");
     DMLC_DECLARE_FIELD(scalar_outputs)
         .describe("Indicate whether outputs are scalars, the size must match the output size.");
+    DMLC_DECLARE_FIELD(cache_size)
+        .set_default(0)
+        .set_lower_bound(0)
+        .describe(
+            "Keep up to this many MB of the items of the internal dataset in memory, e.g. "
+            "decoded images, so that the later epochs only apply the transformation. "
+            "Only dense cpu items are cached. 0 disables the cache.");
+    DMLC_DECLARE_FIELD(cache_dir).set_default("").describe(
+        "Local directory the items over cache_size are spilled to. "
+        "If empty, these items are loaded at every epoch.");
   }
 };  // struct LazyTransformDatasetParam
 
@@ -549,6 +596,7 @@ class LazyTransformDataset final : public Dataset {
     this->cached_op_ =
         std::make_shared<NaiveCachedOp>(other.cached_op_->sym_, other.cached_op_->flags_);
     this->base_data_ = other.base_data_;
+    this->cache_     = other.cache_;
   }
 
   explicit LazyTransformDataset(const std::vector<std::pair<std::string, std::string>>& kwargs) {
@@ -556,6 +604,11 @@ class LazyTransformDataset final : public Dataset {
     auto op    = *static_cast<CachedOpPtr*>(reinterpret_cast<void*>(param_.cached_op));
     cached_op_ = std::make_shared<NaiveCachedOp>(op->sym_, op->flags_);
     base_data_ = *static_cast<std::shared_ptr<Dataset>*>(reinterpret_cast<void*>(param_.dataset));
+    if (param_.cache_size > 0) {
+      // shared by the copies of the dataset made for the workers
+      cache_ = std::make_shared<SampleCache>(static_cast<size_t>(param_.cache_size) << 20UL,
+                                             param_.cache_dir);
+    }
 
     // use first item to calculate size info
     CHECK_GT(GetLen(), 0) << "LazyTransformDataset expect the base dataset to have at least 1 item";
@@ -602,8 +655,12 @@ class LazyTransformDataset final : public Dataset {
 
   bool GetItem(uint64_t idx, std::vector<NDArray>* outputs) override {
     std::vector<NDArray> inputs;
-    if (!base_data_->GetItem(idx, &inputs))
-      return false;
+    if (cache_ == nullptr || !GetCachedItem(idx, &inputs)) {
+      if (!base_data_->GetItem(idx, &inputs))
+        return false;
+      if (cache_ != nullptr)
+        CacheItem(idx, inputs);
+    }
     outputs->reserve(num_outputs_);
     outputs->resize(cached_op_->num_outputs());
     for (auto i : pass_through_indices_) {
@@ -633,6 +690,42 @@ class LazyTransformDataset final : public Dataset {
   }
 
  private:
+  /*! \brief read the base item idx from the cache into new cpu arrays */
+  bool GetCachedItem(uint64_t idx, std::vector<NDArray>* inputs) {
+    // meta holds the number of arrays, then the dtype, ndim and dims of each array
+    return cache_->Get(idx, [inputs](const std::vector<int64_t>& meta) {
+      SampleCache::Buffers buffers;
+      size_t pos = 1;
+      for (int64_t i = 0; i < meta[0]; ++i) {
+        const int dtype = static_cast<int>(meta[pos]);
+        const int ndim  = static_cast<int>(meta[pos + 1]);
+        TShape shape(meta.begin() + pos + 2, meta.begin() + pos + 2 + ndim);
+        pos += 2 + ndim;
+        inputs->emplace_back(shape, Context::CPU(), false, dtype);
+        const TBlob& blob = inputs->back().data();
+        buffers.emplace_back(blob.dptr_, blob.Size() * mshadow::mshadow_sizeof(dtype));
+      }
+      return buffers;
+    });
+  }
+
+  /*! \brief store the base item idx, if all its arrays are dense cpu arrays */
+  void CacheItem(uint64_t idx, const std::vector<NDArray>& inputs) {
+    std::vector<int64_t> meta{static_cast<int64_t>(inputs.size())};
+    std::vector<std::pair<const void*, size_t>> parts;
+    for (const NDArray& input : inputs) {
+      if (input.storage_type() != kDefaultStorage || input.ctx().dev_mask() != cpu::kDevMask)
+        return;
+      input.WaitToRead();
+      const TBlob& blob = input.data();
+      meta.push_back(blob.type_flag_);
+      meta.push_back(blob.ndim());
+      meta.insert(meta.end(), blob.shape_.begin(), blob.shape_.end());
+      parts.emplace_back(blob.dptr_, blob.Size() * mshadow::mshadow_sizeof(blob.type_flag_));
+    }
+    cache_->Put(idx, meta, parts);
+  }
+
   /*! \brief parameters */
   LazyTransformDatasetParam param_;
   /*! \brief stored cached op */
@@ -642,6 +735,8 @@ class LazyTransformDataset final : public Dataset {
   std::vector<int> use_input_indices_;
   std::vector<int> pass_through_indices_;
   size_t num_outputs_;
+  /*! \brief items of the internal dataset, set if cache_size is positive */
+  std::shared_ptr<SampleCache> cache_;
 };  // class LazyTransformDataset
 
 MXNET_REGISTER_IO_DATASET(LazyTransformDataset)
@@ -0,0 +1,333 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file dataset_streaming.cc
+ * \brief Dataset streaming sharded record files, e.g. from object storage
+ */
+#include <dmlc/parameter.h>
+#include <dmlc/recordio.h>
+#include <dmlc/io.h>
+#include <mxnet/io.h>
+#include <mxnet/ndarray.h>
+#include <mxnet/tensor_blob.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace mxnet {
+namespace io {
+
+struct StreamingRecordFileDatasetParam
+    : public dmlc::Parameter<StreamingRecordFileDatasetParam> {
+  std::string rec_files;
+  std::string idx_files;
+  int num_readers;
+  int read_ahead;
+  int prefetch_window;
+  int shuffle_window;
+  int seed;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(StreamingRecordFileDatasetParam) {
+    DMLC_DECLARE_FIELD(rec_files).describe(
+        "The record file shards, separated by ';'. Any URI supported by dmlc streams, "
+        "e.g. s3://bucket/train-0.rec, remote files are read without being staged locally.");
+    DMLC_DECLARE_FIELD(idx_files).describe(
+        "The idx files of the shards, separated by ';', used to count the records.");
+    DMLC_DECLARE_FIELD(num_readers)
+        .set_default(4)
+        .set_lower_bound(1)
+        .describe("Number of shards streamed concurrently.");
+    DMLC_DECLARE_FIELD(read_ahead)
+        .set_default(1024)
+        .set_lower_bound(1)
+        .describe("Maximum number of records buffered ahead of the requested ones.");
+    DMLC_DECLARE_FIELD(prefetch_window)
+        .set_default(4096)
+        .set_lower_bound(1)
+        .describe(
+            "Maximum distance of a requested index past the first index not served yet in "
+            "the epoch. The records up to a requested index are buffered, so this bounds "
+            "the buffered records to read_ahead + prefetch_window.");
+    DMLC_DECLARE_FIELD(shuffle_window)
+        .set_default(1)
+        .set_lower_bound(1)
+        .describe(
+            "Records are shuffled within a window of this many records, and the order of "
+            "the shards is shuffled at every epoch. 1 disables shuffling.");
+    DMLC_DECLARE_FIELD(seed).set_default(0).describe("Random seed for shuffling.");
+  }
+};  // struct StreamingRecordFileDatasetParam
+
+DMLC_REGISTER_PARAMETER(StreamingRecordFileDatasetParam);
+
+/*!
+ * \brief Dataset streaming the records of RecordIO shards.
+ *
+ * Each reader thread streams whole shards sequentially through dmlc streams, which
+ * fetch remote files (S3, HDFS, HTTP) with ranged reads. Records are shuffled in a
+ * window and numbered in the order in which they leave it: item i of an epoch is the
+ * i-th record of the stream, not a fixed record of the files. Each index must thus be
+ * requested once per epoch, as with a sequential sampler. Requesting an index a second
+ * time, or any index after all were served, starts a new epoch. Indices may come out of
+ * order, as from several loader workers, but at most prefetch_window past the first one
+ * not served yet.
+ */
+class StreamingRecordFileDataset final : public Dataset {
+ public:
+  explicit StreamingRecordFileDataset(
+      const std::vector<std::pair<std::string, std::string>>& kwargs) {
+    param_.InitAllowUnknown(kwargs);
+    shards_ = SplitURIs(param_.rec_files);
+    CHECK(!shards_.empty()) << "StreamingRecordFileDataset requires at least one record file";
+    for (const std::string& idx_file : SplitURIs(param_.idx_files)) {
+      std::unique_ptr<dmlc::Stream> idx_stream(dmlc::Stream::Create(idx_file.c_str(), "r"));
+      dmlc::istream is(idx_stream.get());
+      std::string line;
+      while (std::getline(is, line)) {
+        if (!line.empty())
+          ++length_;
+      }
+    }
+    served_.resize(length_, false);
+    rng_.seed(param_.seed);
+  }
+
+  ~StreamingRecordFileDataset() override {
+    std::unique_lock<std::mutex> lock(mutex_);
+    Stop(&lock);
+  }
+
+  uint64_t GetLen() const override {
+    return length_;
+  }
+
+  bool GetItem(uint64_t idx, std::vector<NDArray>* ret) override {
+    CHECK_LT(idx, length_) << "Index " << idx << " out of bound: (0, " << length_ << ")";
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return !restarting_; });
+    if (readers_.empty() || served_[idx] || num_served_ == length_) {
+      Restart(&lock);
+    }
+    CHECK_LT(idx, first_unserved_ + param_.prefetch_window)
+        << "Index " << idx << " is more than prefetch_window=" << param_.prefetch_window
+        << " past the first index not served yet, " << first_unserved_
+        << ". StreamingRecordFileDataset expects the indices of an epoch about in order.";
+    wanted_ = std::max(wanted_, idx);
+    cv_.notify_all();
+    cv_.wait(lock, [this, idx]() {
+      return ready_.count(idx) != 0 || error_ || (finished_ && next_pos_ <= idx);
+    });
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+    CHECK(ready_.count(idx) != 0) << "The record files hold " << next_pos_
+                                  << " records, less than their idx files";
+    auto it                             = ready_.find(idx);
+    std::shared_ptr<std::string> record = std::move(it->second);
+    ready_.erase(it);
+    served_[idx] = true;
+    ++num_served_;
+    while (first_unserved_ < length_ && served_[first_unserved_]) {
+      ++first_unserved_;
+    }
+    cv_.notify_all();
+    lock.unlock();
+
+    // the array views the record, which it keeps alive
+    ret->resize(1);
+    (*ret)[0] = NDArray(TBlob(&(*record)[0],
+                              TShape({static_cast<dim_t>(record->size())}),
+                              cpu::kDevMask,
+                              mshadow::kInt8,
+                              0),
+                        0,
+                        [record]() {});
+    return true;
+  }
+
+ private:
+  /*! \brief split a ';' separated list of URIs */
+  static std::vector<std::string> SplitURIs(const std::string& uris) {
+    std::vector<std::string> ret;
+    size_t begin = 0;
+    while (begin <= uris.size()) {
+      size_t end = std::min(uris.find(';', begin), uris.size());
+      if (end > begin)
+        ret.emplace_back(uris.substr(begin, end - begin));
+      begin = end + 1;
+    }
+    return ret;
+  }
+
+  /*! \brief stop the readers of the current epoch and start the next one, lock is held */
+  void Restart(std::unique_lock<std::mutex>* lock) {
+    restarting_ = true;
+    Stop(lock);
+    ready_.clear();
+    pool_.clear();
+    std::fill(served_.begin(), served_.end(), false);
+    num_served_     = 0;
+    first_unserved_ = 0;
+    next_pos_       = 0;
+    wanted_         = 0;
+    next_shard_     = 0;
+    finished_       = false;
+    error_          = nullptr;
+    order_.resize(shards_.size());
+    std::iota(order_.begin(), order_.end(), 0);
+    if (param_.shuffle_window > 1) {
+      std::shuffle(order_.begin(), order_.end(), rng_);
+    }
+    active_readers_ = std::min(static_cast<size_t>(param_.num_readers), shards_.size());
+    for (size_t i = 0; i < active_readers_; ++i) {
+      readers_.emplace_back([this]() { ReadShards(); });
+    }
+    restarting_ = false;
+    cv_.notify_all();
+  }
+
+  /*! \brief stop and join the readers, lock is held and released while joining */
+  void Stop(std::unique_lock<std::mutex>* lock) {
+    stop_ = true;
+    cv_.notify_all();
+    std::vector<std::thread> readers;
+    readers.swap(readers_);
+    lock->unlock();
+    for (std::thread& reader : readers) {
+      reader.join();
+    }
+    lock->lock();
+    stop_ = false;
+  }
+
+  /*! \brief body of a reader thread, streams shards until none is left */
+  void ReadShards() {
+    try {
+      while (true) {
+        size_t shard;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          if (stop_ || next_shard_ == order_.size())
+            break;
+          shard = order_[next_shard_++];
+        }
+        std::unique_ptr<dmlc::Stream> stream(dmlc::Stream::Create(shards_[shard].c_str(), "r"));
+        dmlc::RecordIOReader reader(stream.get());
+        auto record = std::make_shared<std::string>();
+        while (reader.NextRecord(record.get())) {
+          std::unique_lock<std::mutex> lock(mutex_);
+          // read past read_ahead only for a request waiting on it
+          cv_.wait(lock, [this]() {
+            return stop_ || ready_.size() < static_cast<size_t>(param_.read_ahead) ||
+                   next_pos_ <= wanted_;
+          });
+          if (stop_)
+            return;
+          Push(std::move(record));
+          record = std::make_shared<std::string>();
+        }
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_)
+        error_ = std::current_exception();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--active_readers_ == 0 && !stop_) {
+      // the last reader flushes the shuffle window
+      std::shuffle(pool_.begin(), pool_.end(), rng_);
+      for (auto& record : pool_) {
+        ready_[next_pos_++] = std::move(record);
+      }
+      pool_.clear();
+      finished_ = true;
+    }
+    cv_.notify_all();
+  }
+
+  /*! \brief add a record to the shuffle window, lock is held */
+  void Push(std::shared_ptr<std::string> record) {
+    pool_.push_back(std::move(record));
+    if (pool_.size() < static_cast<size_t>(param_.shuffle_window))
+      return;
+    std::uniform_int_distribution<size_t> dist(0, pool_.size() - 1);
+    std::swap(pool_[dist(rng_)], pool_.back());
+    ready_[next_pos_++] = std::move(pool_.back());
+    pool_.pop_back();
+    cv_.notify_all();
+  }
+
+  /*! \brief parameters */
+  StreamingRecordFileDatasetParam param_;
+  /*! \brief URIs of the shards */
+  std::vector<std::string> shards_;
+  /*! \brief number of records of all shards */
+  uint64_t length_{0};
+  /*! \brief guards the state below, shared by readers and requests */
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  /*! \brief reader threads of the current epoch */
+  std::vector<std::thread> readers_;
+  /*! \brief number of readers still streaming */
+  size_t active_readers_{0};
+  /*! \brief order in which shards are read, and next one to read */
+  std::vector<size_t> order_;
+  size_t next_shard_{0};
+  /*! \brief shuffle window */
+  std::vector<std::shared_ptr<std::string>> pool_;
+  /*! \brief records out of the window, by index */
+  std::unordered_map<uint64_t, std::shared_ptr<std::string>> ready_;
+  /*! \brief index of the next record out of the window */
+  uint64_t next_pos_{0};
+  /*! \brief largest requested index */
+  uint64_t wanted_{0};
+  /*! \brief indices served in this epoch */
+  std::vector<bool> served_;
+  uint64_t num_served_{0};
+  /*! \brief first index not served yet in this epoch */
+  uint64_t first_unserved_{0};
+  /*! \brief all shards were read */
+  bool finished_{false};
+  bool stop_{false};
+  bool restarting_{false};
+  /*! \brief error raised by a reader */
+  std::exception_ptr error_;
+  /*! \brief random generator for shuffling, used under mutex_ */
+  std::mt19937 rng_;
+};  // class StreamingRecordFileDataset
+
+MXNET_REGISTER_IO_DATASET(StreamingRecordFileDataset)
+    .describe("MXNet Record File Dataset streaming sharded record files")
+    .add_arguments(StreamingRecordFileDatasetParam::__FIELDS__())
+    .set_body([](const std::vector<std::pair<std::string, std::string>>& kwargs) {
+      return new StreamingRecordFileDataset(kwargs);
+    });
+
+}  // namespace io
+}  // namespace mxnet
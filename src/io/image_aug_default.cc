@@ -510,6 +510,11 @@ class DefaultImageAugmenter : public ImageAugmenter {
       res = res(roi);
     }
 
+    // Brightness, contrast, saturation and PCA noise are affine in the pixel
+    // values, they are composed into one color transform applied in a single
+    // pass, which is flushed before the nonlinear HLS augmentation.
+    float color_mat[3][4] = {{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}};
+    bool has_color_mat    = false;
     // color jitter
     if (param_.brightness > 0.0f || param_.contrast > 0.0f || param_.saturation > 0.0f) {
       std::uniform_real_distribution<float> rand_uniform(0, 1);
@@ -521,28 +526,55 @@ class DefaultImageAugmenter : public ImageAugmenter {
           1.0 + std::uniform_real_distribution<float>(-param_.saturation, param_.saturation)(*prnd);
       int rand_order[3] = {0, 1, 2};
       std::shuffle(std::begin(rand_order), std::end(rand_order), *prnd);
+      // gray weights of the channels, as in cvtColor(res, gray, CV_RGB2GRAY)
+      const float gray_w[3] = {0.299f, 0.587f, 0.114f};
+      const cv::Scalar mean = param_.contrast > 0.0f ? cv::mean(res) : cv::Scalar();
       for (int i : rand_order) {
         if (i == 0) {
           // brightness
-          res.convertTo(res, -1, alpha_b, 0);
+          ScaleColor(alpha_b, 0, color_mat);
         }
         if (i == 1) {
-          // contrast
-          cvtColor(res, temp_, CV_RGB2GRAY);
-          float gray_mean = cv::mean(temp_)[0];
-          res.convertTo(res, -1, alpha_c, (1 - alpha_c) * gray_mean);
+          // contrast, against the gray mean of the image transformed so far
+          float gray_mean = 0;
+          for (int r = 0; r < 3; ++r) {
+            float v = color_mat[r][3];
+            for (int c = 0; c < 3; ++c) {
+              v += color_mat[r][c] * mean[c];
+            }
+            gray_mean += gray_w[r] * v;
+          }
+          ScaleColor(alpha_c, (1 - alpha_c) * gray_mean, color_mat);
         }
         if (i == 2) {
-          // saturation
-          cvtColor(res, temp_, CV_RGB2GRAY);
-          cvtColor(temp_, temp_, CV_GRAY2BGR);
-          cv::addWeighted(res, alpha_s, temp_, 1 - alpha_s, 0.0, res);
+          // saturation, blend with the gray image
+          float gray_row[4] = {0};
+          for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 4; ++c) {
+              gray_row[c] += gray_w[r] * color_mat[r][c];
+            }
+          }
+          ScaleColor(alpha_s, 0, color_mat);
+          for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 4; ++c) {
+              color_mat[r][c] += (1 - alpha_s) * gray_row[c];
+            }
+          }
         }
       }
+      has_color_mat = true;
     }
 
     // color space augmentation
     if (param_.random_h != 0 || param_.random_s != 0 || param_.random_l != 0) {
+      if (has_color_mat) {
+        ApplyColor(color_mat, &res);
+        ScaleColor(0, 0, color_mat);
+        for (int k = 0; k < 3; ++k) {
+          color_mat[k][k] = 1;
+        }
+        has_color_mat = false;
+      }
       std::uniform_real_distribution<float> rand_uniform(0, 1);
       cvtColor(res, res, CV_BGR2HLS);
       // use an approximation of gaussian distribution to reduce extreme value
@@ -560,16 +592,14 @@ class DefaultImageAugmenter : public ImageAugmenter {
       int l        = rl * param_.random_l * 2 - param_.random_l;
       int temp[3]  = {h, l, s};
       int limit[3] = {180, 255, 255};
-      for (int i = 0; i < res.rows; ++i) {
-        for (int j = 0; j < res.cols; ++j) {
-          for (int k = 0; k < 3; ++k) {
-            int v = res.at<cv::Vec3b>(i, j)[k];
-            v += temp[k];
-            v                          = std::max(0, std::min(limit[k], v));
-            res.at<cv::Vec3b>(i, j)[k] = v;
-          }
+      // shift and clip the channels with a lookup table
+      cv::Mat lut(1, 256, CV_8UC3);
+      for (int v = 0; v < 256; ++v) {
+        for (int k = 0; k < 3; ++k) {
+          lut.at<cv::Vec3b>(0, v)[k] = std::max(0, std::min(limit[k], v + temp[k]));
         }
       }
+      cv::LUT(res, lut, res);
       cvtColor(res, res, CV_HLS2BGR);
     }
 
@@ -586,21 +616,36 @@ class DefaultImageAugmenter : public ImageAugmenter {
       float pca_b =
           eigvec[2][0] * pca_alpha_r + eigvec[2][1] * pca_alpha_g + eigvec[2][2] * pca_alpha_b;
       float pca[3] = {pca_b, pca_g, pca_r};
-      for (int i = 0; i < res.rows; ++i) {
-        for (int j = 0; j < res.cols; ++j) {
-          for (int k = 0; k < 3; ++k) {
-            int vp = res.at<cv::Vec3b>(i, j)[k];
-            vp += pca[k];
-            vp                         = std::max(0, std::min(255, vp));
-            res.at<cv::Vec3b>(i, j)[k] = vp;
-          }
-        }
+      for (int k = 0; k < 3; ++k) {
+        color_mat[k][3] += pca[k];
       }
+      has_color_mat = true;
+    }
+    if (has_color_mat) {
+      ApplyColor(color_mat, &res);
     }
     return res;
   }
 
  private:
+  // left-multiply the color transform m by alpha * I, then add the bias beta
+  static void ScaleColor(float alpha, float beta, float m[3][4]) {
+    for (int r = 0; r < 3; ++r) {
+      for (int c = 0; c < 4; ++c) {
+        m[r][c] *= alpha;
+      }
+      m[r][3] += beta;
+    }
+  }
+  // apply the color transform m to the BGR image, in a single saturating pass
+  static void ApplyColor(const float m[3][4], cv::Mat* res) {
+    if (res->channels() == 1) {
+      res->convertTo(*res, -1, m[0][0], m[0][3]);
+      return;
+    }
+    cv::Mat mat(3, 4, CV_32F, const_cast<float*>(&m[0][0]));
+    cv::transform(*res, *res, mat);
+  }
   // temporal space
   cv::Mat temp_;
   // eigval and eigvec for adding pca noise
@@ -400,6 +400,8 @@ struct PrefetcherParam : public dmlc::Parameter<PrefetcherParam> {
   /*! \brief Context data loader optimized for */
   int ctx;
   int device_id;
+  /*! \brief whether batches are copied to GPU device_id */
+  bool copy_to_device;
   /*! \brief data type */
   dmlc::optional<int> dtype;
 
@@ -407,7 +409,10 @@ struct PrefetcherParam : public dmlc::Parameter<PrefetcherParam> {
   DMLC_DECLARE_PARAMETER(PrefetcherParam) {
     DMLC_DECLARE_FIELD(prefetch_buffer)
         .set_default(4)
-        .describe("Maximum number of batches to prefetch.");
+        .describe(
+            "Maximum number of batches to prefetch, at most 16. The prefetcher recycles "
+            "a fixed ring of about twice as many batches and does not allocate after "
+            "warm-up unless the batches grow.");
     DMLC_DECLARE_FIELD(ctx)
         .set_default(kGPU)
         .add_enum("cpu", kCPU)
@@ -416,11 +421,17 @@ struct PrefetcherParam : public dmlc::Parameter<PrefetcherParam> {
         .describe(
             "Context data loader optimized for. "
             "Note that it only indicates the optimization strategy for devices, "
-            "by no means the prefetcher will load data to GPUs. "
+            "by no means the prefetcher will load data to GPUs, see copy_to_device. "
             "If ctx is 'cpu_pinned' and device_id is not -1, "
             "it will use cpu_pinned(device_id) as ctx");
     DMLC_DECLARE_FIELD(device_id).set_default(-1).describe(
         "The default device id for context. -1 indicate it's on default device");
+    DMLC_DECLARE_FIELD(copy_to_device)
+        .set_default(false)
+        .describe(
+            "Stage batches in pinned memory and copy them to GPU device_id (0 if -1) "
+            "asynchronously, overlapping the copies with computation. "
+            "The returned batches are on the GPU.");
     DMLC_DECLARE_FIELD(dtype)
         .add_enum("float32", mshadow::kFloat32)
         .add_enum("float64", mshadow::kFloat64)
@@ -25,7 +25,7 @@
 #include <dmlc/base.h>
 #include <dmlc/logging.h>
 #include <dmlc/parameter.h>
-#include <dmlc/data.h>
+#include "./parallel_text_parser.h"
 #include "./iter_prefetcher.h"
 #include "./iter_batchloader.h"
 
@@ -41,6 +41,8 @@ struct CSVIterParam : public dmlc::Parameter<CSVIterParam> {
   std::string label_csv;
   /*! \brief label shape */
   mxnet::TShape label_shape;
+  /*! \brief number of threads parsing the files */
+  int preprocess_threads;
   // declare parameters
   DMLC_DECLARE_PARAMETER(CSVIterParam) {
     DMLC_DECLARE_FIELD(data_csv).describe("The input CSV file or a directory path.");
@@ -52,6 +54,10 @@ struct CSVIterParam : public dmlc::Parameter<CSVIterParam> {
     DMLC_DECLARE_FIELD(label_shape)
         .set_default(mxnet::TShape(shape1, shape1 + 1))
         .describe("The shape of one label.");
+    DMLC_DECLARE_FIELD(preprocess_threads)
+        .set_lower_bound(1)
+        .set_default(4)
+        .describe("The number of threads parsing each chunk of the CSV files.");
   }
 };
 
@@ -95,10 +101,11 @@ class CSVIterTyped : public CSVIterBase {
   // intialize iterator loads data in
   void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) override {
     param_.InitAllowUnknown(kwargs);
-    data_parser_.reset(dmlc::Parser<uint32_t, DType>::Create(param_.data_csv.c_str(), 0, 1, "csv"));
+    data_parser_.reset(
+        new Parser(param_.data_csv, 0, 1, Parser::kCSV, param_.preprocess_threads));
     if (param_.label_csv != "NULL") {
       label_parser_.reset(
-          dmlc::Parser<uint32_t, DType>::Create(param_.label_csv.c_str(), 0, 1, "csv"));
+          new Parser(param_.label_csv, 0, 1, Parser::kCSV, param_.preprocess_threads));
     } else {
       dummy_label.set_pad(false);
       dummy_label.Resize(mshadow::Shape1(1));
@@ -126,21 +133,21 @@ class CSVIterTyped : public CSVIterBase {
         return false;
       }
       data_ptr_  = 0;
-      data_size_ = data_parser_->Value().size;
+      data_size_ = data_parser_->Value().Size();
     }
     out_.index = inst_counter_++;
     CHECK_LT(data_ptr_, data_size_);
-    out_.data[0] = AsTBlob(data_parser_->Value()[data_ptr_++], param_.data_shape);
+    out_.data[0] = AsTBlob(data_parser_->Value(), data_ptr_++, param_.data_shape);
 
     if (label_parser_.get() != nullptr) {
       while (label_ptr_ >= label_size_) {
         CHECK(label_parser_->Next())
             << "Data CSV's row is smaller than the number of rows in label_csv";
         label_ptr_  = 0;
-        label_size_ = label_parser_->Value().size;
+        label_size_ = label_parser_->Value().Size();
       }
       CHECK_LT(label_ptr_, label_size_);
-      out_.data[1] = AsTBlob(label_parser_->Value()[label_ptr_++], param_.label_shape);
+      out_.data[1] = AsTBlob(label_parser_->Value(), label_ptr_++, param_.label_shape);
     } else {
       out_.data[1] = dummy_label;
     }
@@ -148,17 +155,21 @@ class CSVIterTyped : public CSVIterBase {
   }
 
  private:
-  inline TBlob AsTBlob(const dmlc::Row<uint32_t, DType>& row, const mxnet::TShape& shape) {
-    CHECK_EQ(row.length, shape.Size())
+  typedef ParallelTextParser<uint32_t, DType> Parser;
+
+  inline TBlob AsTBlob(const TextRowBlock<uint32_t, DType>& block,
+                       size_t row,
+                       const mxnet::TShape& shape) {
+    CHECK_EQ(block.Length(row), shape.Size())
         << "The data size in CSV do not match size of shape: "
-        << "specified shape=" << shape << ", the csv row-length=" << row.length;
-    const DType* ptr = row.value;
+        << "specified shape=" << shape << ", the csv row-length=" << block.Length(row);
+    const DType* ptr = block.value.data() + block.offset[row];
     return TBlob((DType*)ptr, shape, cpu::kDevMask, 0);  // NOLINT(*)
   }
   // dummy label
   mshadow::TensorContainer<cpu, 1, DType> dummy_label;
-  std::unique_ptr<dmlc::Parser<uint32_t, DType> > label_parser_;
-  std::unique_ptr<dmlc::Parser<uint32_t, DType> > data_parser_;
+  std::unique_ptr<Parser> label_parser_;
+  std::unique_ptr<Parser> data_parser_;
 };
 
 class CSVIter : public IIterator<DataInst> {
@@ -233,6 +244,9 @@ If ``data_csv = 'data/'`` is set, then all the files in this directory will be r
 
 ``reset()`` is expected to be called only after a complete pass of data.
 
+The files are read and parsed ahead of the consumer, each chunk being parsed by
+`preprocess_threads` threads.
+
 By default, the CSVIter parses all entries in the data file as float32 data type,
 if `dtype` argument is set to be 'int32' or 'int64' then CSVIter will parse all entries in the file
 as int32 or int64 data type accordingly.
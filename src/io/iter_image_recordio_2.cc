@@ -32,8 +32,12 @@
 #include <dmlc/omp.h>
 #include <dmlc/common.h>
 #include <dmlc/timer.h>
+#include <algorithm>
+#include <deque>
 #include <memory>
+#include <string>
 #include <type_traits>
+#include <unordered_set>
 #if MXNET_USE_LIBJPEG_TURBO
 #include <turbojpeg.h>
 #endif
@@ -41,16 +45,80 @@
 #include "./image_augmenter.h"
 #include "./image_iter_common.h"
 #include "./inst_vector.h"
+#include "./nvjpeg_decoder.h"
+#include "./sample_cache.h"
 #include "../common/utils.h"
 #include "../profiler/profiler.h"
 
 namespace mxnet {
 
 namespace io {
+
+/*! \brief parameters of the GPU decoding of ImageRecordIter */
+struct ImageRecGPUDecodeParam : public dmlc::Parameter<ImageRecGPUDecodeParam> {
+  /*! \brief whether to decode on GPU */
+  bool gpu_decode;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(ImageRecGPUDecodeParam) {
+    DMLC_DECLARE_FIELD(gpu_decode)
+        .set_default(false)
+        .describe(
+            "Decode JPEG images in batches with nvJPEG on GPU ``device_id`` and output "
+            "the data directly on that GPU. Only the resize, rand_crop, mirror, rand_mirror "
+            "and normalization augmentations are supported. Images nvJPEG cannot decode "
+            "are decoded on CPU. Requires MXNet built with USE_NVJPEG.");
+  }
+};
+DMLC_REGISTER_PARAMETER(ImageRecGPUDecodeParam);
+
+/*! \brief parameters of the cache of decoded images of ImageRecordIter */
+struct ImageRecCacheParam : public dmlc::Parameter<ImageRecCacheParam> {
+  /*! \brief memory of the cache in MB */
+  int cache_size;
+  /*! \brief directory of the images over cache_size */
+  std::string cache_dir;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(ImageRecCacheParam) {
+    DMLC_DECLARE_FIELD(cache_size)
+        .set_default(0)
+        .set_lower_bound(0)
+        .describe(
+            "Keep up to this many MB of decoded images in memory, so that the later epochs "
+            "only apply the augmentations. 0 disables the cache.");
+    DMLC_DECLARE_FIELD(cache_dir).set_default("").describe(
+        "Local directory the decoded images over cache_size are spilled to. "
+        "If empty, these images are decoded at every epoch.");
+  }
+};
+DMLC_REGISTER_PARAMETER(ImageRecCacheParam);
+
+/*!
+ * \brief subset of the default augmentation parameters applied by GPU decoding,
+ *  declared with the same defaults as in image_aug_default.cc
+ */
+struct GPUDecodeAugParam : public dmlc::Parameter<GPUDecodeAugParam> {
+  int resize;
+  bool rand_crop;
+  int inter_method;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(GPUDecodeAugParam) {
+    DMLC_DECLARE_FIELD(resize).set_default(-1);
+    DMLC_DECLARE_FIELD(rand_crop).set_default(false);
+    DMLC_DECLARE_FIELD(inter_method).set_default(1);
+  }
+};
+DMLC_REGISTER_PARAMETER(GPUDecodeAugParam);
+
 // parser to parse image recordio
 template <typename DType>
 class ImageRecordIOParser2 {
  public:
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG
+  ~ImageRecordIOParser2() {
+    if (host_images_.size != 0)
+      Storage::Get()->Free(host_images_);
+  }
+#endif
   // initialize the parser
   inline void Init(const std::vector<std::pair<std::string, std::string>>& kwargs);
 
@@ -58,6 +126,9 @@ class ImageRecordIOParser2 {
   inline void BeforeFirst() {
     if (batch_param_.round_batch == 0 || !overflow) {
       n_parsed_ = 0;
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG
+      pending_records_.clear();
+#endif
       return source_->BeforeFirst();
     } else {
       overflow = false;
@@ -78,6 +149,34 @@ class ImageRecordIOParser2 {
 #if MXNET_USE_LIBJPEG_TURBO
   cv::Mat TJimdecode(cv::Mat buf, int color);
 #endif
+  // decode the image of a record with the number of channels of data_shape
+  cv::Mat DecodeImage(const ImageRecordIO& rec);
+  // DecodeImage through the cache of decoded images, if enabled
+  cv::Mat DecodeImageCached(const ImageRecordIO& rec);
+  // draw the random normalization of an image and write it into data
+  void NormalizeImage(const cv::Mat& res,
+                      common::RANDOM_ENGINE* prnd,
+                      mshadow::Tensor<cpu, 3, DType>* data);
+#endif
+  // label of a record, before augmentations
+  inline void LoadLabel(const ImageRecordIO& rec, std::vector<float>* label_buf);
+  // draw mirroring, contrast and illumination of an image
+  inline void DrawNormalization(common::RANDOM_ENGINE* prnd,
+                                bool* is_mirrored,
+                                float* contrast_scaled,
+                                float* illumination_scaled);
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG
+  inline void InitGPUDecode(const std::vector<std::pair<std::string, std::string>>& kwargs);
+  // fill a batch with images decoded on GPU
+  inline bool ParseNextGPU(DataBatch* out);
+  // decode the records of a batch into out
+  inline void DecodeBatchGPU(const std::vector<std::string>& records, DataBatch* out);
+  // decode the images of the slots on CPU into host_images_ and queue their upload
+  inline void DecodeOnCPU(const std::vector<int>& slots,
+                          const std::vector<ImageRecordIO>& recs,
+                          real_t* label_dptr);
+  // geometry and normalization of an image of the given size decoded on GPU
+  inline NvJpegTransform MakeTransform(int height, int width, common::RANDOM_ENGINE* prnd);
 #endif
   inline size_t ParseChunk(DType* data_dptr,
                            real_t* label_dptr,
@@ -127,6 +226,18 @@ class ImageRecordIOParser2 {
   bool meanfile_ready_;
   /*! \brief OMPException obj to store and rethrow exceptions from omp blocks*/
   dmlc::OMPException omp_exc_;
+  /*! \brief decoded images, set if cache_size is positive */
+  std::unique_ptr<SampleCache> cache_;
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG
+  /*! \brief GPU decoder, set if gpu_decode is enabled */
+  std::unique_ptr<NvJpegDecoder> gpu_decoder_;
+  /*! \brief augmentations applied by the GPU decoder */
+  GPUDecodeAugParam gpu_aug_param_;
+  /*! \brief records read from the source but not yet output */
+  std::deque<std::string> pending_records_;
+  /*! \brief pinned staging buffer of a batch for images decoded on CPU */
+  Storage::Handle host_images_;
+#endif
 };
 
 template <typename DType>
@@ -258,6 +369,21 @@ inline void ImageRecordIOParser2<DType>::Init(
       }
     }
   }
+  ImageRecCacheParam cache_param;
+  cache_param.InitAllowUnknown(kwargs);
+  if (cache_param.cache_size > 0) {
+    cache_ = std::make_unique<SampleCache>(static_cast<size_t>(cache_param.cache_size) << 20UL,
+                                           cache_param.cache_dir);
+  }
+  ImageRecGPUDecodeParam gpu_decode_param;
+  gpu_decode_param.InitAllowUnknown(kwargs);
+  if (gpu_decode_param.gpu_decode) {
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG
+    InitGPUDecode(kwargs);
+#else
+    LOG(FATAL) << "gpu_decode requires MXNet built with USE_CUDA=1 and USE_NVJPEG=1";
+#endif
+  }
 #else
   LOG(FATAL) << "ImageRec need opencv to process";
 #endif
@@ -302,13 +428,25 @@ inline bool ImageRecordIOParser2<DType>::ParseNext(DataBatch* out) {
     const std::string profiler_scope =
         profiler::ProfilerScope::Get()->GetCurrentProfilerScope() + "image_io:";
 
-    out->data.at(0) = NDArray(data_shape, ctx, false, mshadow::DataType<DType>::kFlag);
+    auto data_ctx = ctx;
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG
+    // images decoded on GPU are written directly into the device batch
+    if (gpu_decoder_ != nullptr) {
+      data_ctx = Context::GPU(dev_id);
+    }
+#endif
+    out->data.at(0) = NDArray(data_shape, data_ctx, false, mshadow::DataType<DType>::kFlag);
     out->data.at(0).AssignStorageInfo(profiler_scope, "data");
     out->data.at(1) = NDArray(label_shape, ctx, false, mshadow::DataType<real_t>::kFlag);
     out->data.at(1).AssignStorageInfo(profiler_scope, "label");
     unit_size_[0] = param_.data_shape.Size();
     unit_size_[1] = param_.label_width;
   }
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG
+  if (gpu_decoder_ != nullptr) {
+    return ParseNextGPU(out);
+  }
+#endif
 
   while (current_size < batch_param_.batch_size) {
     // int n_to_copy;
@@ -423,47 +561,57 @@ void ImageRecordIOParser2<DType>::ProcessImage(const cv::Mat& res,
     swap_indices[3] = 3;
   }
 
-  DType RGBA[n_channels] = {};
+  // one pass per output row and channel, which gathers the channel from the
+  // interleaved HWC row, normalizes it and writes the CHW row, the branches are
+  // hoisted out of the loops so that they vectorize
+  const int cols = res.cols;
   for (int i = 0; i < res.rows; ++i) {
     const uchar* im_data = res.ptr<uchar>(i);
-    for (int j = 0; j < res.cols; ++j) {
-      if (std::is_same<DType, int8_t>::value) {
-        if (meanfile_ready_) {
-          for (int k = 0; k < n_channels; ++k) {
-            RGBA[k] = cv::saturate_cast<int8_t>(
-                im_data[swap_indices[k]] - static_cast<int16_t>(std::round(meanimg_[k][i][j])));
+    for (int k = 0; k < n_channels; ++k) {
+      const uchar* src      = im_data + swap_indices[k];
+      DType* dst            = data[k][i].dptr_;
+      const real_t* mean_ij = meanfile_ready_ ? meanimg_[k][i].dptr_ : nullptr;
+      if (std::is_same<DType, uint8_t>::value) {
+#pragma omp simd
+        for (int j = 0; j < cols; ++j) {
+          dst[j] = src[j * n_channels];
+        }
+      } else if (std::is_same<DType, int8_t>::value) {
+        if (mean_ij != nullptr) {
+          for (int j = 0; j < cols; ++j) {
+            dst[j] = cv::saturate_cast<int8_t>(src[j * n_channels] -
+                                               static_cast<int16_t>(std::round(mean_ij[j])));
           }
         } else {
-          for (int k = 0; k < n_channels; ++k) {
-            RGBA[k] = cv::saturate_cast<int8_t>(im_data[swap_indices[k]] - RGBA_MEAN_INT[k]);
+          const int16_t mean = RGBA_MEAN_INT[k];
+#pragma omp simd
+          for (int j = 0; j < cols; ++j) {
+            const int16_t v = std::max<int16_t>(src[j * n_channels] - mean, -128);
+            dst[j]          = static_cast<DType>(std::min<int16_t>(v, 127));
           }
         }
       } else {
-        for (int k = 0; k < n_channels; ++k) {
-          RGBA[k] = im_data[swap_indices[k]];
-        }
-        if (!std::is_same<DType, uint8_t>::value) {
-          // normalize/mirror here to avoid memory copies
-          // logic from iter_normalize.h, function SetOutImg
-          for (int k = 0; k < n_channels; ++k) {
-            if (meanfile_ready_) {
-              RGBA[k] = (RGBA[k] - meanimg_[k][i][j]) * RGBA_MULT[k] + RGBA_BIAS[k];
-            } else {
-              RGBA[k] = (RGBA[k] - RGBA_MEAN[k]) * RGBA_MULT[k] + RGBA_BIAS[k];
-            }
-          }
-        }
-      }
-      for (int k = 0; k < n_channels; ++k) {
-        // mirror here to avoid memory copies
         // logic from iter_normalize.h, function SetOutImg
-        if (is_mirrored) {
-          data[k][i][res.cols - j - 1] = RGBA[k];
+        const float mult = RGBA_MULT[k];
+        const float bias = RGBA_BIAS[k];
+        if (mean_ij != nullptr) {
+#pragma omp simd
+          for (int j = 0; j < cols; ++j) {
+            dst[j] = (src[j * n_channels] - mean_ij[j]) * mult + bias;
+          }
         } else {
-          data[k][i][j] = RGBA[k];
+          const float mean = RGBA_MEAN[k];
+#pragma omp simd
+          for (int j = 0; j < cols; ++j) {
+            dst[j] = (src[j * n_channels] - mean) * mult + bias;
+          }
         }
       }
-      im_data += n_channels;
+      // mirror the row while it is in cache
+      // logic from iter_normalize.h, function SetOutImg
+      if (is_mirrored) {
+        std::reverse(dst, dst + cols);
+      }
     }
   }
 }
@@ -505,8 +653,118 @@ cv::Mat ImageRecordIOParser2<DType>::TJimdecode(cv::Mat image, int color) {
   return ret;
 }
 #endif
+
+template <typename DType>
+cv::Mat ImageRecordIOParser2<DType>::DecodeImage(const ImageRecordIO& rec) {
+  cv::Mat res;
+  cv::Mat buf(1, rec.content_size, CV_8U, rec.content);
+  switch (param_.data_shape[0]) {
+    case 1:
+#if MXNET_USE_LIBJPEG_TURBO
+      res = TJimdecode(buf, 0);
+#else
+      res = cv::imdecode(buf, 0);
+#endif
+      break;
+    case 3:
+#if MXNET_USE_LIBJPEG_TURBO
+      res = TJimdecode(buf, 1);
+#else
+      res = cv::imdecode(buf, 1);
+#endif
+      break;
+    case 4:
+      // -1 to keep the number of channel of the encoded image, and not force gray or color.
+      res = cv::imdecode(buf, -1);
+      CHECK_EQ(res.channels(), 4) << "Invalid image with index " << rec.image_index()
+                                  << ". Expected 4 channels, got " << res.channels();
+      break;
+    default:
+      LOG(FATAL) << "Invalid output shape " << param_.data_shape;
+  }
+  return res;
+}
+
+template <typename DType>
+cv::Mat ImageRecordIOParser2<DType>::DecodeImageCached(const ImageRecordIO& rec) {
+  if (cache_ == nullptr)
+    return DecodeImage(rec);
+  // keyed by the encoded image, image indices are not always unique
+  const uint64_t key = SampleCache::Hash(rec.content, rec.content_size);
+  cv::Mat res;
+  if (cache_->Get(key, [&res](const std::vector<int64_t>& meta) {
+        res.create(meta[0], meta[1], meta[2]);
+        return SampleCache::Buffers{{res.data, res.total() * res.elemSize()}};
+      })) {
+    return res;
+  }
+  res = DecodeImage(rec);
+  if (res.empty())
+    return res;
+  if (!res.isContinuous())
+    res = res.clone();
+  cache_->Put(key, {res.rows, res.cols, res.type()}, {{res.data, res.total() * res.elemSize()}});
+  return res;
+}
+
+template <typename DType>
+void ImageRecordIOParser2<DType>::NormalizeImage(const cv::Mat& res,
+                                                 common::RANDOM_ENGINE* prnd,
+                                                 mshadow::Tensor<cpu, 3, DType>* data) {
+  bool is_mirrored;
+  float contrast_scaled, illumination_scaled;
+  DrawNormalization(prnd, &is_mirrored, &contrast_scaled, &illumination_scaled);
+  // For RGB or RGBA data, swap the B and R channel:
+  // OpenCV store as BGR (or BGRA) and we want RGB (or RGBA)
+  const int n_channels = res.channels();
+  if (n_channels == 1) {
+    ProcessImage<1>(res, data, is_mirrored, contrast_scaled, illumination_scaled);
+  } else if (n_channels == 3) {
+    ProcessImage<3>(res, data, is_mirrored, contrast_scaled, illumination_scaled);
+  } else if (n_channels == 4) {
+    ProcessImage<4>(res, data, is_mirrored, contrast_scaled, illumination_scaled);
+  }
+}
 #endif
 
+template <typename DType>
+inline void ImageRecordIOParser2<DType>::LoadLabel(const ImageRecordIO& rec,
+                                                   std::vector<float>* label_buf) {
+  if (label_map_ != nullptr) {
+    *label_buf = label_map_->FindCopy(rec.image_index());
+  } else if (rec.label != nullptr) {
+    CHECK_EQ(param_.label_width, rec.num_label) << "rec file provide " << rec.num_label
+                                                << "-dimensional label "
+                                                   "but label_width is set to "
+                                                << param_.label_width;
+    label_buf->assign(rec.label, rec.label + rec.num_label);
+  } else {
+    CHECK_EQ(param_.label_width, 1) << "label_width must be 1 unless an imglist is provided "
+                                       "or the rec file is packed with multi dimensional label";
+    label_buf->assign(&rec.header.label, &rec.header.label + 1);
+  }
+}
+
+template <typename DType>
+inline void ImageRecordIOParser2<DType>::DrawNormalization(common::RANDOM_ENGINE* prnd,
+                                                           bool* is_mirrored,
+                                                           float* contrast_scaled,
+                                                           float* illumination_scaled) {
+  std::uniform_real_distribution<float> rand_uniform(0, 1);
+  std::bernoulli_distribution coin_flip(0.5);
+  *is_mirrored = (normalize_param_.rand_mirror && coin_flip(*prnd)) || normalize_param_.mirror;
+  *contrast_scaled     = 1;
+  *illumination_scaled = 0;
+  if (!std::is_same<DType, uint8_t>::value) {
+    *contrast_scaled = (rand_uniform(*prnd) * normalize_param_.max_random_contrast * 2 -
+                        normalize_param_.max_random_contrast + 1) *
+                       normalize_param_.scale;
+    *illumination_scaled = (rand_uniform(*prnd) * normalize_param_.max_random_illumination * 2 -
+                            normalize_param_.max_random_illumination) *
+                           normalize_param_.scale;
+  }
+}
+
 // Returns the number of images that are put into output
 template <typename DType>
 inline size_t ImageRecordIOParser2<DType>::ParseChunk(DType* data_dptr,
@@ -547,7 +805,6 @@ inline size_t ImageRecordIOParser2<DType>::ParseChunk(DType* data_dptr,
         // Opencv decode and augments
         cv::Mat res;
         rec.Load(blob.dptr, blob.size);
-        cv::Mat buf(1, rec.content_size, CV_8U, rec.content);
 
         // If augmentation seed is supplied
         // Re-seed RNG to guarantee reproducible results
@@ -555,47 +812,11 @@ inline size_t ImageRecordIOParser2<DType>::ParseChunk(DType* data_dptr,
           prnds_[tid]->seed(idx + param_.seed_aug.value() + kRandMagic);
         }
 
-        switch (param_.data_shape[0]) {
-          case 1:
-#if MXNET_USE_LIBJPEG_TURBO
-            res = TJimdecode(buf, 0);
-#else
-            res = cv::imdecode(buf, 0);
-#endif
-            break;
-          case 3:
-#if MXNET_USE_LIBJPEG_TURBO
-            res = TJimdecode(buf, 1);
-#else
-            res = cv::imdecode(buf, 1);
-#endif
-            break;
-          case 4:
-            // -1 to keep the number of channel of the encoded image, and not force gray or color.
-            res = cv::imdecode(buf, -1);
-            CHECK_EQ(res.channels(), 4) << "Invalid image with index " << rec.image_index()
-                                        << ". Expected 4 channels, got " << res.channels();
-            break;
-          default:
-            LOG(FATAL) << "Invalid output shape " << param_.data_shape;
-        }
+        res                  = DecodeImageCached(rec);
         const int n_channels = res.channels();
         // load label before augmentations
         std::vector<float> label_buf;
-        if (label_map_ != nullptr) {
-          label_buf = label_map_->FindCopy(rec.image_index());
-        } else if (rec.label != nullptr) {
-          CHECK_EQ(param_.label_width, rec.num_label) << "rec file provide " << rec.num_label
-                                                      << "-dimensional label "
-                                                         "but label_width is set to "
-                                                      << param_.label_width;
-          label_buf.assign(rec.label, rec.label + rec.num_label);
-        } else {
-          CHECK_EQ(param_.label_width, 1)
-              << "label_width must be 1 unless an imglist is provided "
-                 "or the rec file is packed with multi dimensional label";
-          label_buf.assign(&rec.header.label, &rec.header.label + 1);
-        }
+        LoadLabel(rec, &label_buf);
         for (auto& aug : augmenters_[tid]) {
           res = aug->Process(res, &label_buf, prnds_[tid].get());
         }
@@ -610,31 +831,7 @@ inline size_t ImageRecordIOParser2<DType>::ParseChunk(DType* data_dptr,
           data = out_tmp.data().Back();
         }
 
-        std::uniform_real_distribution<float> rand_uniform(0, 1);
-        std::bernoulli_distribution coin_flip(0.5);
-        bool is_mirrored =
-            (normalize_param_.rand_mirror && coin_flip(*(prnds_[tid]))) || normalize_param_.mirror;
-        float contrast_scaled     = 1;
-        float illumination_scaled = 0;
-        if (!std::is_same<DType, uint8_t>::value) {
-          contrast_scaled =
-              (rand_uniform(*(prnds_[tid])) * normalize_param_.max_random_contrast * 2 -
-               normalize_param_.max_random_contrast + 1) *
-              normalize_param_.scale;
-          illumination_scaled =
-              (rand_uniform(*(prnds_[tid])) * normalize_param_.max_random_illumination * 2 -
-               normalize_param_.max_random_illumination) *
-              normalize_param_.scale;
-        }
-        // For RGB or RGBA data, swap the B and R channel:
-        // OpenCV store as BGR (or BGRA) and we want RGB (or RGBA)
-        if (n_channels == 1) {
-          ProcessImage<1>(res, &data, is_mirrored, contrast_scaled, illumination_scaled);
-        } else if (n_channels == 3) {
-          ProcessImage<3>(res, &data, is_mirrored, contrast_scaled, illumination_scaled);
-        } else if (n_channels == 4) {
-          ProcessImage<4>(res, &data, is_mirrored, contrast_scaled, illumination_scaled);
-        }
+        NormalizeImage(res, prnds_[tid].get(), &data);
 
         mshadow::Tensor<cpu, 1, real_t> label;
         if (idx < batch_param_.batch_size) {
@@ -703,6 +900,218 @@ inline void ImageRecordIOParser2<DType>::CreateMeanImg() {
   this->BeforeFirst();
 }
 
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG
+template <typename DType>
+inline void ImageRecordIOParser2<DType>::InitGPUDecode(
+    const std::vector<std::pair<std::string, std::string>>& kwargs) {
+  CHECK_GE(param_.device_id, 0) << "gpu_decode requires device_id to be a GPU";
+  CHECK_EQ(param_.aug_seq, "aug_default") << "gpu_decode only supports aug_seq=aug_default";
+  // the other default augmentations are not implemented on GPU
+  const std::unordered_set<std::string> supported = {
+      "resize", "rand_crop", "inter_method", "data_shape"};
+  std::unordered_set<std::string> aug_fields;
+  for (const auto& field : ListDefaultAugParams()) {
+    aug_fields.insert(field.name);
+  }
+  for (const auto& kv : kwargs) {
+    CHECK(aug_fields.count(kv.first) == 0 || supported.count(kv.first) != 0)
+        << "gpu_decode does not support the augmentation " << kv.first
+        << ", only resize, rand_crop, mirror, rand_mirror and normalization are applied on GPU";
+  }
+  gpu_aug_param_.InitAllowUnknown(kwargs);
+  CHECK_EQ(gpu_aug_param_.inter_method, 1)
+      << "gpu_decode only supports bilinear interpolation (inter_method=1)";
+  gpu_decoder_ = std::make_unique<NvJpegDecoder>(
+      param_.device_id, param_.data_shape[0], param_.data_shape[1], param_.data_shape[2]);
+  host_images_ =
+      Storage::Get()->Alloc(batch_param_.batch_size * param_.data_shape.Size() * sizeof(DType),
+                            Context::CPUPinned(param_.device_id));
+  if (!std::is_same<DType, uint8_t>::value && meanfile_ready_) {
+    gpu_decoder_->SetMeanImage(meanimg_.dptr_, meanimg_.shape_.Size());
+  }
+  if (param_.verbose) {
+    LOG(INFO) << "ImageRecordIOParser2: decode images on gpu(" << param_.device_id << ")";
+  }
+}
+
+template <typename DType>
+inline bool ImageRecordIOParser2<DType>::ParseNextGPU(DataBatch* out) {
+  std::vector<std::string> records;
+  records.reserve(batch_param_.batch_size);
+  out->num_batch_padd = 0;
+  while (records.size() < batch_param_.batch_size) {
+    if (!pending_records_.empty()) {
+      records.push_back(std::move(pending_records_.front()));
+      pending_records_.pop_front();
+      continue;
+    }
+    dmlc::InputSplit::Blob chunk;
+    if (source_->NextBatch(&chunk, batch_param_.batch_size)) {
+      // copy the records, the chunk is only valid until the next read
+      dmlc::RecordIOChunkReader reader(chunk, 0, 1);
+      dmlc::InputSplit::Blob blob;
+      while (reader.NextRecord(&blob)) {
+        pending_records_.emplace_back(static_cast<char*>(blob.dptr), blob.size);
+      }
+      if (legacy_shuffle_) {
+        std::shuffle(pending_records_.begin(), pending_records_.end(), rnd_);
+      }
+    } else {
+      if (records.empty()) {
+        return false;
+      }
+      CHECK(!overflow) << "number of input images must be bigger than the batch size";
+      out->num_batch_padd = batch_param_.batch_size - records.size();
+      if (batch_param_.round_batch == 0) {
+        break;
+      }
+      overflow = true;
+      source_->BeforeFirst();
+    }
+  }
+  DecodeBatchGPU(records, out);
+  return true;
+}
+
+template <typename DType>
+inline void ImageRecordIOParser2<DType>::DecodeBatchGPU(const std::vector<std::string>& records,
+                                                        DataBatch* out) {
+  DType* data_dptr   = static_cast<DType*>(out->data[0].data().dptr_);
+  real_t* label_dptr = static_cast<real_t*>(out->data[1].data().dptr_);
+  std::vector<ImageRecordIO> recs(records.size());
+  std::vector<int> fallback;
+  std::vector<float> label_buf;
+  for (size_t i = 0; i < records.size(); ++i) {
+    ImageRecordIO& rec = recs[i];
+    rec.Load(const_cast<char*>(records[i].data()), records[i].size());
+    int height, width;
+    if (!gpu_decoder_->GetImageInfo(rec.content, rec.content_size, &height, &width)) {
+      fallback.push_back(static_cast<int>(i));
+      continue;
+    }
+    // If augmentation seed is supplied
+    // Re-seed RNG to guarantee reproducible results
+    if (param_.seed_aug.has_value()) {
+      prnds_[0]->seed(i + param_.seed_aug.value() + kRandMagic);
+    }
+    gpu_decoder_->Add(rec.content,
+                      rec.content_size,
+                      height,
+                      width,
+                      static_cast<int>(i),
+                      MakeTransform(height, width, prnds_[0].get()));
+    LoadLabel(rec, &label_buf);
+    mshadow::Copy(
+        mshadow::Tensor<cpu, 1, real_t>(label_dptr + i * unit_size_[1],
+                                        mshadow::Shape1(param_.label_width)),
+        mshadow::Tensor<cpu, 1>(dmlc::BeginPtr(label_buf), mshadow::Shape1(label_buf.size())));
+  }
+  DecodeOnCPU(fallback, recs, label_dptr);
+  if (!gpu_decoder_->Decode(data_dptr)) {
+    // nvJPEG rejected the batch, decode its images on CPU
+    const std::vector<int> failed = gpu_decoder_->pending();
+    gpu_decoder_->Clear();
+    DecodeOnCPU(failed, recs, label_dptr);
+    CHECK(gpu_decoder_->Decode(data_dptr));
+  }
+}
+
+template <typename DType>
+inline void ImageRecordIOParser2<DType>::DecodeOnCPU(const std::vector<int>& slots,
+                                                     const std::vector<ImageRecordIO>& recs,
+                                                     real_t* label_dptr) {
+#if MXNET_USE_OPENCV
+  DType* host_dptr = static_cast<DType*>(host_images_.dptr);
+#pragma omp parallel for num_threads(param_.preprocess_threads)
+  for (int k = 0; k < static_cast<int>(slots.size()); ++k) {
+    omp_exc_.Run([&] {
+      const int tid            = omp_get_thread_num();
+      const int i              = slots[k];
+      const ImageRecordIO& rec = recs[i];
+      if (param_.seed_aug.has_value()) {
+        prnds_[tid]->seed(i + param_.seed_aug.value() + kRandMagic);
+      }
+      cv::Mat res = DecodeImageCached(rec);
+      std::vector<float> label_buf;
+      LoadLabel(rec, &label_buf);
+      for (auto& aug : augmenters_[tid]) {
+        res = aug->Process(res, &label_buf, prnds_[tid].get());
+      }
+      CHECK_EQ(static_cast<size_t>(res.channels()) * res.rows * res.cols, unit_size_[0])
+          << "Invalid image with index " << rec.image_index() << " after augmentations";
+      mshadow::Tensor<cpu, 3, DType> data(host_dptr + i * unit_size_[0],
+                                          mshadow::Shape3(res.channels(), res.rows, res.cols));
+      NormalizeImage(res, prnds_[tid].get(), &data);
+      mshadow::Copy(
+          mshadow::Tensor<cpu, 1, real_t>(label_dptr + i * unit_size_[1],
+                                          mshadow::Shape1(param_.label_width)),
+          mshadow::Tensor<cpu, 1>(dmlc::BeginPtr(label_buf), mshadow::Shape1(label_buf.size())));
+    });
+  }
+  omp_exc_.Rethrow();
+  for (int i : slots) {
+    gpu_decoder_->AddHostImage(host_dptr + i * unit_size_[0], unit_size_[0] * sizeof(DType), i);
+  }
+#else
+  LOG(FATAL) << "Opencv is needed for image decoding and augmenting.";
+#endif
+}
+
+template <typename DType>
+inline NvJpegTransform ImageRecordIOParser2<DType>::MakeTransform(int height,
+                                                                  int width,
+                                                                  common::RANDOM_ENGINE* prnd) {
+  const int out_h = param_.data_shape[1];
+  const int out_w = param_.data_shape[2];
+  NvJpegTransform t;
+  // same geometry as the default augmenter: resize the shorter edge,
+  // enlarge images smaller than the output, then crop
+  t.resize_h       = height;
+  t.resize_w       = width;
+  const int resize = gpu_aug_param_.resize;
+  if (resize != -1) {
+    if (height > width) {
+      t.resize_h = resize * height / width;
+      t.resize_w = resize;
+    } else {
+      t.resize_h = resize;
+      t.resize_w = resize * width / height;
+    }
+  }
+  if (t.resize_h < out_h) {
+    t.resize_w = static_cast<int>(static_cast<float>(out_h) / t.resize_h * t.resize_w);
+    t.resize_h = out_h;
+  }
+  if (t.resize_w < out_w) {
+    t.resize_h = static_cast<int>(static_cast<float>(out_w) / t.resize_w * t.resize_h);
+    t.resize_w = out_w;
+  }
+  t.crop_y = std::max(t.resize_h - out_h, 0);
+  t.crop_x = std::max(t.resize_w - out_w, 0);
+  if (gpu_aug_param_.rand_crop) {
+    t.crop_y = std::uniform_int_distribution<int>(0, t.crop_y)(*prnd);
+    t.crop_x = std::uniform_int_distribution<int>(0, t.crop_x)(*prnd);
+  } else {
+    t.crop_y /= 2;
+    t.crop_x /= 2;
+  }
+  float contrast_scaled, illumination_scaled;
+  DrawNormalization(prnd, &t.mirror, &contrast_scaled, &illumination_scaled);
+  const float mean[4] = {
+      normalize_param_.mean_r, normalize_param_.mean_g, normalize_param_.mean_b,
+      normalize_param_.mean_a};
+  const float stdev[4] = {
+      normalize_param_.std_r, normalize_param_.std_g, normalize_param_.std_b,
+      normalize_param_.std_a};
+  for (int k = 0; k < 4; ++k) {
+    t.mean[k] = mean[k];
+    t.mult[k] = contrast_scaled / stdev[k];
+    t.bias[k] = illumination_scaled / stdev[k];
+  }
+  return t;
+}
+#endif  // MXNET_USE_CUDA && MXNET_USE_NVJPEG
+
 template <typename DType = real_t>
 class ImageRecordIter2 : public IIterator<DataBatch> {
  public:
@@ -916,6 +1325,8 @@ Example::
     .add_arguments(ImageRecordParam::__FIELDS__())
     .add_arguments(BatchParam::__FIELDS__())
     .add_arguments(PrefetcherParam::__FIELDS__())
+    .add_arguments(ImageRecGPUDecodeParam::__FIELDS__())
+    .add_arguments(ImageRecCacheParam::__FIELDS__())
     .add_arguments(ListDefaultAugParams())
     .add_arguments(ImageNormalizeParam::__FIELDS__())
     .set_body([]() { return new ImageRecordIter2Wrapper(); });
@@ -933,6 +1344,8 @@ the data type instead of ``float``.
     .add_arguments(ImageRecordParam::__FIELDS__())
     .add_arguments(BatchParam::__FIELDS__())
     .add_arguments(PrefetcherParam::__FIELDS__())
+    .add_arguments(ImageRecGPUDecodeParam::__FIELDS__())
+    .add_arguments(ImageRecCacheParam::__FIELDS__())
     .add_arguments(ListDefaultAugParams())
     .set_body([]() { return new ImageRecordIter2<uint8_t>(); });
 
@@ -949,6 +1362,8 @@ the data type instead of ``float``.
     .add_arguments(ImageRecordParam::__FIELDS__())
     .add_arguments(BatchParam::__FIELDS__())
     .add_arguments(PrefetcherParam::__FIELDS__())
+    .add_arguments(ImageRecGPUDecodeParam::__FIELDS__())
+    .add_arguments(ImageRecCacheParam::__FIELDS__())
     .add_arguments(ListDefaultAugParams())
     .set_body([]() { return new ImageRecordIter2<int8_t>(); });
 
@@ -25,7 +25,7 @@
 #include <dmlc/base.h>
 #include <dmlc/logging.h>
 #include <dmlc/parameter.h>
-#include <dmlc/data.h>
+#include "./parallel_text_parser.h"
 #include "./iter_sparse_prefetcher.h"
 #include "./iter_sparse_batchloader.h"
 
@@ -45,6 +45,8 @@ struct LibSVMIterParam : public dmlc::Parameter<LibSVMIterParam> {
   int num_parts;
   /*! \brief the index of the part will read*/
   int part_index;
+  /*! \brief number of threads parsing the files */
+  int preprocess_threads;
   // declare parameters
   DMLC_DECLARE_PARAMETER(LibSVMIterParam) {
     DMLC_DECLARE_FIELD(data_libsvm)
@@ -61,6 +63,10 @@ struct LibSVMIterParam : public dmlc::Parameter<LibSVMIterParam> {
         .describe("The shape of one label.");
     DMLC_DECLARE_FIELD(num_parts).set_default(1).describe("partition the data into multiple parts");
     DMLC_DECLARE_FIELD(part_index).set_default(0).describe("the index of the part will read");
+    DMLC_DECLARE_FIELD(preprocess_threads)
+        .set_lower_bound(1)
+        .set_default(4)
+        .describe("The number of threads parsing each chunk of the LibSVM files.");
   }
 };
 
@@ -75,11 +81,17 @@ class LibSVMIter : public SparseIIterator<DataInst> {
     CHECK_EQ(param_.data_shape.ndim(), 1) << "dimension of data_shape is expected to be 1";
     CHECK_GT(param_.num_parts, 0) << "number of parts should be positive";
     CHECK_GE(param_.part_index, 0) << "part index should be non-negative";
-    data_parser_.reset(dmlc::Parser<uint64_t>::Create(
-        param_.data_libsvm.c_str(), param_.part_index, param_.num_parts, "libsvm"));
+    data_parser_.reset(new Parser(param_.data_libsvm,
+                                  param_.part_index,
+                                  param_.num_parts,
+                                  Parser::kLibSVM,
+                                  param_.preprocess_threads));
     if (param_.label_libsvm != "NULL") {
-      label_parser_.reset(dmlc::Parser<uint64_t>::Create(
-          param_.label_libsvm.c_str(), param_.part_index, param_.num_parts, "libsvm"));
+      label_parser_.reset(new Parser(param_.label_libsvm,
+                                     param_.part_index,
+                                     param_.num_parts,
+                                     Parser::kLibSVM,
+                                     param_.preprocess_threads));
       CHECK_GT(param_.label_shape.Size(), 1)
           << "label_shape is not expected to be (1,) when param_.label_libsvm is set.";
     } else {
@@ -115,31 +127,33 @@ class LibSVMIter : public SparseIIterator<DataInst> {
         return false;
       }
       data_ptr_  = 0;
-      data_size_ = data_parser_->Value().size;
+      data_size_ = data_parser_->Value().Size();
     }
     out_.index = inst_counter_++;
     CHECK_LT(data_ptr_, data_size_);
-    const auto data_row = data_parser_->Value()[data_ptr_++];
+    const RowBlock& data_block = data_parser_->Value();
+    const size_t data_row      = data_ptr_++;
     // data, indices and indptr
-    out_.data[0] = AsDataBlob(data_row);
-    out_.data[1] = AsIdxBlob(data_row);
-    out_.data[2] = AsIndPtrPlaceholder(data_row);
+    out_.data[0] = AsDataBlob(data_block, data_row);
+    out_.data[1] = AsIdxBlob(data_block, data_row);
+    out_.data[2] = AsIndPtrPlaceholder();
 
     if (label_parser_.get() != nullptr) {
       while (label_ptr_ >= label_size_) {
         CHECK(label_parser_->Next())
             << "Data LibSVM's row is smaller than the number of rows in label_libsvm";
         label_ptr_  = 0;
-        label_size_ = label_parser_->Value().size;
+        label_size_ = label_parser_->Value().Size();
       }
       CHECK_LT(label_ptr_, label_size_);
-      const auto label_row = label_parser_->Value()[label_ptr_++];
+      const RowBlock& label_block = label_parser_->Value();
+      const size_t label_row      = label_ptr_++;
       // data, indices and indptr
-      out_.data[3] = AsDataBlob(label_row);
-      out_.data[4] = AsIdxBlob(label_row);
-      out_.data[5] = AsIndPtrPlaceholder(label_row);
+      out_.data[3] = AsDataBlob(label_block, label_row);
+      out_.data[4] = AsIdxBlob(label_block, label_row);
+      out_.data[5] = AsIndPtrPlaceholder();
     } else {
-      out_.data[3] = AsScalarLabelBlob(data_row);
+      out_.data[3] = AsScalarLabelBlob(data_block, data_row);
     }
     return true;
   }
@@ -161,24 +175,28 @@ class LibSVMIter : public SparseIIterator<DataInst> {
   }
 
  private:
-  inline TBlob AsDataBlob(const dmlc::Row<uint64_t>& row) {
-    const real_t* ptr = row.value;
-    mxnet::TShape shape(mshadow::Shape1(row.length));
+  typedef ParallelTextParser<uint64_t> Parser;
+  typedef TextRowBlock<uint64_t, real_t> RowBlock;
+
+  // rows are views into the parsed block, SparseBatchLoader copies them into the batch
+  inline TBlob AsDataBlob(const RowBlock& block, size_t row) {
+    const real_t* ptr = block.value.data() + block.offset[row];
+    mxnet::TShape shape(mshadow::Shape1(block.Length(row)));
     return TBlob((real_t*)ptr, shape, cpu::kDevMask);  // NOLINT(*)
   }
 
-  inline TBlob AsIdxBlob(const dmlc::Row<uint64_t>& row) {
-    const uint64_t* ptr = row.index;
-    mxnet::TShape shape(mshadow::Shape1(row.length));
+  inline TBlob AsIdxBlob(const RowBlock& block, size_t row) {
+    const uint64_t* ptr = block.index.data() + block.offset[row];
+    mxnet::TShape shape(mshadow::Shape1(block.Length(row)));
     return TBlob((int64_t*)ptr, shape, cpu::kDevMask, mshadow::kInt64);  // NOLINT(*)
   }
 
-  inline TBlob AsIndPtrPlaceholder(const dmlc::Row<uint64_t>& row) {
+  inline TBlob AsIndPtrPlaceholder() {
     return TBlob(nullptr, mshadow::Shape1(0), cpu::kDevMask, mshadow::kInt64);
   }
 
-  inline TBlob AsScalarLabelBlob(const dmlc::Row<uint64_t>& row) {
-    const real_t* ptr = row.label;
+  inline TBlob AsScalarLabelBlob(const RowBlock& block, size_t row) {
+    const real_t* ptr = &block.label[row];
     return TBlob((real_t*)ptr, mshadow::Shape1(1), cpu::kDevMask);  // NOLINT(*)
   }
 
@@ -192,8 +210,8 @@ class LibSVMIter : public SparseIIterator<DataInst> {
   // label parser
   size_t label_ptr_{0}, label_size_{0};
   size_t data_ptr_{0}, data_size_{0};
-  std::unique_ptr<dmlc::Parser<uint64_t> > label_parser_;
-  std::unique_ptr<dmlc::Parser<uint64_t> > data_parser_;
+  std::unique_ptr<Parser> label_parser_;
+  std::unique_ptr<Parser> data_parser_;
 };
 
 DMLC_REGISTER_PARAMETER(LibSVMIterParam);
@@ -227,6 +245,9 @@ guaranteed to be even.
 
 ``reset()`` is expected to be called only after a complete pass of data.
 
+The files are read and parsed ahead of the consumer, each chunk being parsed by
+`preprocess_threads` threads.
+
 Example::
 
   # Contents of libsvm file ``data.t``.
@@ -36,9 +36,12 @@
 #include <string>
 #include <vector>
 #include <queue>
+#include <unordered_map>
 #include <algorithm>
 #include "./inst_vector.h"
 #include "./image_iter_common.h"
+#include "../profiler/profiler.h"
+#include "../profiler/annotation.h"
 
 namespace mxnet {
 namespace io {
@@ -63,10 +66,13 @@ class PrefetcherIter : public IIterator<DataBatch> {
     // init image rec param
     kwargs_left = param_.InitAllowUnknown(kwargs);
     CHECK_GT(param_.prefetch_buffer, 0) << "Prefetch_buffer must be positive number";
+#if !MXNET_USE_CUDA
+    CHECK(!param_.copy_to_device) << "copy_to_device requires MXNet built with CUDA";
+#endif
     // maximum prefetch threaded iter internal size
-    const int kMaxPrefetchBuffer = 16;
-    // init thread iter
-    iter.set_max_capacity(kMaxPrefetchBuffer);
+    const size_t kMaxPrefetchBuffer = 16;
+    // init thread iter, which bounds the number of batches in the ring
+    iter.set_max_capacity(std::min(param_.prefetch_buffer, kMaxPrefetchBuffer));
   }
 
   virtual void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) {
@@ -76,9 +82,11 @@ class PrefetcherIter : public IIterator<DataBatch> {
     length_hint_ = loader_->GetLenHint();
     iter.Init(
         [this](DataBatch** dptr) {
+          profiler::AnnotationRange range("PrefetcherIter::Load");
           if (!loader_->Next())
             return false;
           const TBlobBatch& batch = loader_->Value();
+          const int dev_id        = std::max(param_.device_id, 0);
           if (*dptr == nullptr) {
             // allocate databatch
             *dptr                   = new DataBatch();
@@ -90,21 +98,38 @@ class PrefetcherIter : public IIterator<DataBatch> {
               auto ctx = ((param_.ctx == PrefetcherParam::kCPUPinned) && (param_.device_id >= 0)) ?
                              Context::CPUPinned(param_.device_id) :
                              Context::CPU();
+              if (param_.copy_to_device) {
+                staging_[*dptr].push_back(
+                    NDArray(batch.data[i].shape_, Context::CPUPinned(dev_id), false, dtype));
+                ctx = Context::GPU(dev_id);
+              }
               (*dptr)->data.at(i) = NDArray(batch.data[i].shape_, ctx, false, dtype);
             }
           }
           CHECK(batch.data.size() == (*dptr)->data.size());
           // copy data over
           for (size_t i = 0; i < batch.data.size(); ++i) {
-            if ((*dptr)->data.at(i).shape() != batch.data[i].shape_) {
-              // TODO(zhreshold): memory pool for dynamic shaped data
-              (*dptr)->data.at(i).ReshapeAndAlloc(batch.data[i].shape_);
+            NDArray& dst = param_.copy_to_device ? staging_[*dptr][i] : (*dptr)->data.at(i);
+            if (param_.copy_to_device) {
+              // wait for the copy of the last batch staged in this slot
+              dst.WaitToWrite();
+              if ((*dptr)->data.at(i).shape() != batch.data[i].shape_) {
+                (*dptr)->data.at(i).ReshapeAndAlloc(batch.data[i].shape_);
+              }
             }
-            CHECK_EQ((*dptr)->data.at(i).shape(), batch.data[i].shape_);
+            if (dst.shape() != batch.data[i].shape_) {
+              // the buffer only grows, so batches of varying shape stop allocating
+              dst.ReshapeAndAlloc(batch.data[i].shape_);
+            }
+            CHECK_EQ(dst.shape(), batch.data[i].shape_);
             MSHADOW_TYPE_SWITCH(batch.data[i].type_flag_, DType, {
-              mshadow::Copy(((*dptr)->data)[i].data().FlatTo2D<cpu, DType>(),
+              mshadow::Copy(dst.data().FlatTo2D<cpu, DType>(),
                             batch.data[i].FlatTo2D<cpu, DType>());
             });
+            if (param_.copy_to_device) {
+              // pushed to the copy stream of the engine, ordered before any use of the batch
+              CopyFromTo(dst, &(*dptr)->data.at(i));
+            }
             (*dptr)->num_batch_padd = batch.num_batch_padd;
           }
           if (batch.inst_index) {
@@ -142,7 +167,17 @@ class PrefetcherIter : public IIterator<DataBatch> {
       recycle_queue_.pop();
       iter.Recycle(&old_batch);
     }
-    return iter.Next(&out_);
+    profiler::AnnotationRange range("PrefetcherIter::Next");
+    if (profiler::Profiler::Get()->GetState() != profiler::Profiler::kRunning) {
+      return iter.Next(&out_);
+    }
+    // the wait for the next batch is the data loading phase of the step breakdown
+    static profiler::ProfileDomain domain(profiler::StepStats::kDataLoadingCategory);
+    profiler::ProfileTask wait("PrefetcherIter::Next", &domain);
+    wait.start();
+    const bool has_next = iter.Next(&out_);
+    wait.stop();
+    return has_next;
   }
   virtual const DataBatch& Value(void) const {
     return *out_;
@@ -163,6 +198,8 @@ class PrefetcherIter : public IIterator<DataBatch> {
   std::queue<DataBatch*> recycle_queue_;
   /*! \brief size hint cache */
   int64_t length_hint_;
+  /*! \brief pinned staging arrays of each batch of the ring, if copy_to_device */
+  std::unordered_map<DataBatch*, std::vector<NDArray> > staging_;
 };
 }  // namespace io
 }  // namespace mxnet
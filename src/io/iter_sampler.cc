@@ -26,6 +26,7 @@
 #include <mxnet/io.h>
 #include <mxnet/base.h>
 #include <mxnet/resource.h>
+#include <algorithm>
 #include <memory>
 #include <numeric>
 #include "../common/utils.h"
@@ -175,5 +176,132 @@ MXNET_REGISTER_IO_ITER(RandomSampler)
     .add_arguments(BatchSamplerParam::__FIELDS__())
     .set_body([]() { return new BatchSampler(new RandomSampler()); });
 
+struct BucketSamplerParam : public dmlc::Parameter<BucketSamplerParam> {
+  /*! \brief Length of every sample. */
+  mxnet::Tuple<int> lengths;
+  /*! \brief Number of batches sorted together. */
+  int sort_window;
+  /*! \brief Whether to shuffle samples and batches. */
+  bool shuffle;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(BucketSamplerParam) {
+    DMLC_DECLARE_FIELD(lengths).describe(
+        "Length of every sample of the dataset, e.g. its number of tokens.");
+    DMLC_DECLARE_FIELD(sort_window)
+        .set_default(100)
+        .describe(
+            "Number of batches whose samples are sorted by length together. "
+            "Larger windows give batches of more similar lengths, smaller ones keep "
+            "more randomness. 0 sorts the whole dataset.");
+    DMLC_DECLARE_FIELD(shuffle).set_default(true).describe(
+        "Whether to shuffle the samples, and the batches, at every epoch.");
+  }
+};  // struct BucketSamplerParam
+
+DMLC_REGISTER_PARAMETER(BucketSamplerParam);
+
+/*!
+ * \brief Sampler grouping samples of similar length, to reduce padding.
+ *  The shuffled samples are sorted by length within windows of sort_window
+ *  batches, then the full batches are shuffled. Samples are emitted batch by
+ *  batch, with the incomplete batch last, so that the BatchSampler around it
+ *  forms the same batches when last_batch is 'keep' or 'discard'.
+ */
+class BucketSampler : public IIterator<DataInst> {
+ public:
+  void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) override {
+    param_.InitAllowUnknown(kwargs);
+    batch_param_.InitAllowUnknown(kwargs);
+    CHECK_GT(batch_param_.batch_size, 0U) << "batch_size must be positive";
+    CHECK_GE(param_.sort_window, 0) << "sort_window must be non-negative";
+    indices_.resize(param_.lengths.ndim());
+    mshadow::Random<cpu>* ctx_rng = ResourceManager::Get()
+                                        ->Request(Context::CPU(), ResourceRequest::kRandom)
+                                        .get_random<cpu, real_t>(nullptr);
+    rng_ = std::make_unique<common::RANDOM_ENGINE>(ctx_rng->GetSeed());
+    out_.data.resize(1);
+    BeforeFirst();
+  }
+
+  void BeforeFirst() override {
+    const size_t n  = indices_.size();
+    const size_t bs = batch_param_.batch_size;
+    std::iota(std::begin(indices_), std::end(indices_), 0);
+    if (param_.shuffle) {
+      std::shuffle(std::begin(indices_), std::end(indices_), *rng_);
+    }
+    const size_t window = param_.sort_window > 0 ? param_.sort_window * bs : n;
+    for (size_t begin = 0; begin < n; begin += window) {
+      std::stable_sort(indices_.begin() + begin,
+                       indices_.begin() + std::min(begin + window, n),
+                       [this](int64_t a, int64_t b) {
+                         return param_.lengths[a] < param_.lengths[b];
+                       });
+    }
+    if (param_.shuffle) {
+      // shuffle the full batches, each keeps its samples
+      batches_.resize(n / bs);
+      std::iota(std::begin(batches_), std::end(batches_), 0);
+      std::shuffle(std::begin(batches_), std::end(batches_), *rng_);
+      shuffled_.clear();
+      for (size_t b : batches_) {
+        shuffled_.insert(
+            shuffled_.end(), indices_.begin() + b * bs, indices_.begin() + (b + 1) * bs);
+      }
+      shuffled_.insert(shuffled_.end(), indices_.begin() + batches_.size() * bs, indices_.end());
+      indices_.swap(shuffled_);
+    }
+    pos_ = 0;
+  }
+
+  int64_t GetLenHint() const override {
+    return static_cast<int64_t>(indices_.size());
+  }
+
+  bool Next() override {
+    if (pos_ < indices_.size()) {
+      int64_t* ptr = indices_.data() + pos_;
+      out_.data[0] = TBlob(ptr,
+                           TShape({
+                               1,
+                           }),
+                           cpu::kDevMask,
+                           0);
+      ++pos_;
+      return true;
+    }
+    return false;
+  }
+
+  const DataInst& Value() const override {
+    return out_;
+  }
+
+ private:
+  /*! \brief Stored integer indices */
+  std::vector<int64_t> indices_;
+  /*! \brief buffer for the indices reordered by batch */
+  std::vector<int64_t> shuffled_;
+  /*! \brief order of the full batches */
+  std::vector<size_t> batches_;
+  /*! \brief current position for iteration */
+  std::size_t pos_;
+  /*! \brief data for next value */
+  DataInst out_;
+  /*! \brief random generator engine */
+  std::unique_ptr<std::mt19937> rng_;
+  /*! \brief arguments */
+  BucketSamplerParam param_;
+  /*! \brief batch arguments, shared with the BatchSampler */
+  BatchSamplerParam batch_param_;
+};  // class BucketSampler
+
+MXNET_REGISTER_IO_ITER(BucketSampler)
+    .describe(R"code(Returns the bucket sampler iterator, which batches samples of similar length.
+)code" ADD_FILELINE)
+    .add_arguments(BucketSamplerParam::__FIELDS__())
+    .add_arguments(BatchSamplerParam::__FIELDS__())
+    .set_body([]() { return new BatchSampler(new BucketSampler()); });
+
 }  // namespace io
 }  // namespace mxnet
@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file mmap_recordio.h
+ * \brief zero-copy random access to the records of a local RecordIO file
+ */
+#ifndef MXNET_IO_MMAP_RECORDIO_H_
+#define MXNET_IO_MMAP_RECORDIO_H_
+
+#include <dmlc/base.h>
+#include <dmlc/logging.h>
+#include <dmlc/recordio.h>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+namespace mxnet {
+namespace io {
+
+/*!
+ * \brief RecordIO file mapped in memory.
+ *  Records are returned as views into the mapping, so that they are consumed
+ *  without a copy. Only records the writer split around an embedded magic
+ *  number are reassembled into a buffer.
+ *  The mapping is private: writes through a view never reach the file.
+ */
+class MMapRecordIOFile {
+ public:
+  /*! \return whether the file at uri can be mapped, i.e. it is a local file */
+  static bool Supported(const std::string& uri) {
+#if defined(_WIN32)
+    return false;
+#else
+    return uri.find("://") == std::string::npos || uri.compare(0, 7, "file://") == 0;
+#endif
+  }
+
+  explicit MMapRecordIOFile(const std::string& uri) {
+#if !defined(_WIN32)
+    CHECK(Supported(uri)) << "Cannot map " << uri << ", only local files are supported";
+    const std::string path = uri.compare(0, 7, "file://") == 0 ? uri.substr(7) : uri;
+    int fid                = open(path.c_str(), O_RDONLY);
+    CHECK_NE(fid, -1) << "Failed to open " << path << ": " << strerror(errno);
+    struct stat st;
+    CHECK_EQ(fstat(fid, &st), 0) << "Failed to stat " << path << ": " << strerror(errno);
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ != 0) {
+      void* ptr = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fid, 0);
+      CHECK_NE(ptr, MAP_FAILED) << "Failed to map " << path << ": " << strerror(errno);
+      data_ = static_cast<char*>(ptr);
+    }
+    close(fid);
+#else
+    LOG(FATAL) << "Mapping record files is not supported on Windows";
+#endif
+  }
+
+  ~MMapRecordIOFile() {
+#if !defined(_WIN32)
+    if (data_ != nullptr)
+      munmap(data_, size_);
+#endif
+  }
+
+  /*!
+   * \brief get the payload of the record at offset.
+   * \param offset position of the record, as stored in the .idx file.
+   * \param dptr set to the start of the payload.
+   * \param size set to the size of the payload.
+   * \param buf storage for records written in several parts, *dptr points into it
+   *  if it is not empty on return.
+   * \return false if offset is at or past the end of the file.
+   */
+  bool GetRecord(size_t offset, char** dptr, size_t* size, std::string* buf) const {
+    const uint32_t kMagic = dmlc::RecordIOWriter::kMagic;
+    buf->clear();
+    if (offset >= size_)
+      return false;
+    size_t pos = offset;
+    while (true) {
+      uint32_t header[2];
+      CHECK_LE(pos + sizeof(header), size_) << "Invalid RecordIO File";
+      std::memcpy(header, data_ + pos, sizeof(header));
+      CHECK_EQ(header[0], kMagic) << "Invalid RecordIO File";
+      const uint32_t cflag = dmlc::RecordIOWriter::DecodeFlag(header[1]);
+      const uint32_t len   = dmlc::RecordIOWriter::DecodeLength(header[1]);
+      pos += sizeof(header);
+      CHECK_LE(pos + len, size_) << "Invalid RecordIO File";
+      if (cflag == 0U) {
+        *dptr = data_ + pos;
+        *size = len;
+        return true;
+      }
+      // the parts are separated by the magic number the writer removed
+      buf->append(data_ + pos, len);
+      if (cflag == 3U)
+        break;
+      buf->append(reinterpret_cast<const char*>(&kMagic), sizeof(kMagic));
+      pos += ((len + 3U) >> 2U) << 2U;
+    }
+    *dptr = &(*buf)[0];
+    *size = buf->size();
+    return true;
+  }
+
+ private:
+  /*! \brief start of the mapping */
+  char* data_{nullptr};
+  /*! \brief size of the file */
+  size_t size_{0};
+
+  DISALLOW_COPY_AND_ASSIGN(MMapRecordIOFile);
+};
+
+}  // namespace io
+}  // namespace mxnet
+#endif  // MXNET_IO_MMAP_RECORDIO_H_
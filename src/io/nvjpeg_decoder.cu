@@ -0,0 +1,269 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file nvjpeg_decoder.cu
+ * \brief batched JPEG decode on GPU with nvJPEG
+ */
+#include "./nvjpeg_decoder.h"
+
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG
+#include <algorithm>
+#include "../common/cuda/utils.h"
+
+namespace mxnet {
+namespace io {
+
+namespace {
+
+/*! \brief number of output pixels handled by a block of the resize kernel */
+constexpr int kTransformThreads = 256;
+
+template <typename DType>
+__device__ inline DType ConvertPixel(float v, float mean, float mult, float bias) {
+  return static_cast<DType>((v - mean) * mult + bias);
+}
+
+template <>
+__device__ inline uint8_t ConvertPixel<uint8_t>(float v, float, float, float) {
+  return static_cast<uint8_t>(fminf(fmaxf(rintf(v), 0.f), 255.f));
+}
+
+template <>
+__device__ inline int8_t ConvertPixel<int8_t>(float v, float mean, float, float) {
+  return static_cast<int8_t>(fminf(fmaxf(rintf(v) - rintf(mean), -128.f), 127.f));
+}
+
+/*!
+ * \brief bilinear resize, crop, mirror and normalization of decoded images.
+ *  blockIdx.y is the image, the other dimensions cover its output pixels.
+ *  Sampling follows cv::resize with INTER_LINEAR, which the CPU path uses.
+ */
+template <typename DType>
+__global__ void NvJpegTransformKernel(const NvJpegImageDesc* descs,
+                                      const float* mean_img,
+                                      const int channels,
+                                      const int out_h,
+                                      const int out_w,
+                                      DType* dst) {
+  const NvJpegImageDesc& d = descs[blockIdx.y];
+  const size_t plane       = static_cast<size_t>(out_h) * out_w;
+  DType* out               = dst + static_cast<size_t>(d.index) * channels * plane;
+  const float scale_y      = static_cast<float>(d.src_h) / d.t.resize_h;
+  const float scale_x      = static_cast<float>(d.src_w) / d.t.resize_w;
+  for (size_t p = blockIdx.x * blockDim.x + threadIdx.x; p < plane; p += gridDim.x * blockDim.x) {
+    const int i    = p / out_w;
+    const int j    = p % out_w;
+    const float sy = fmaxf((d.t.crop_y + i + 0.5f) * scale_y - 0.5f, 0.f);
+    const float sx = fmaxf((d.t.crop_x + j + 0.5f) * scale_x - 0.5f, 0.f);
+    const int y0   = min(static_cast<int>(sy), d.src_h - 1);
+    const int x0   = min(static_cast<int>(sx), d.src_w - 1);
+    const int y1   = min(y0 + 1, d.src_h - 1);
+    const int x1   = min(x0 + 1, d.src_w - 1);
+    const float fy = sy - y0;
+    const float fx = sx - x0;
+
+    const uint8_t* r0 = d.src + static_cast<size_t>(y0) * d.src_w * channels;
+    const uint8_t* r1 = d.src + static_cast<size_t>(y1) * d.src_w * channels;
+    const int oj      = d.t.mirror ? out_w - 1 - j : j;
+    for (int c = 0; c < channels; ++c) {
+      const float top = r0[x0 * channels + c] * (1.f - fx) + r0[x1 * channels + c] * fx;
+      const float bot = r1[x0 * channels + c] * (1.f - fx) + r1[x1 * channels + c] * fx;
+      const float v   = top * (1.f - fy) + bot * fy;
+
+      // the mean image is indexed before mirroring, as in the CPU path
+      const float mean = mean_img != nullptr ? mean_img[c * plane + p] : d.t.mean[c];
+      out[c * plane + static_cast<size_t>(i) * out_w + oj] =
+          ConvertPixel<DType>(v, mean, d.t.mult[c], d.t.bias[c]);
+    }
+  }
+}
+
+}  // namespace
+
+NvJpegDecoder::NvJpegDecoder(int dev_id, int channels, int out_h, int out_w)
+    : dev_id_(dev_id), channels_(channels), out_h_(out_h), out_w_(out_w) {
+  CHECK(channels == 1 || channels == 3)
+      << "GPU decoding supports 1 or 3 channels, got " << channels;
+  common::cuda::DeviceStore device_store(dev_id_);
+  NVJPEG_CALL(nvjpegCreateSimple(&handle_));
+  NVJPEG_CALL(nvjpegJpegStateCreate(handle_, &state_));
+  CUDA_CALL(cudaStreamCreateWithFlags(&stream_, cudaStreamNonBlocking));
+}
+
+NvJpegDecoder::~NvJpegDecoder() {
+  common::cuda::DeviceStore device_store(dev_id_);
+  CUDA_CALL(cudaStreamSynchronize(stream_));
+  for (Storage::Handle* h : {&decoded_, &desc_buf_, &mean_img_}) {
+    if (h->size != 0)
+      Storage::Get()->DirectFree(*h);
+  }
+  nvjpegJpegStateDestroy(state_);
+  nvjpegDestroy(handle_);
+  cudaStreamDestroy(stream_);
+}
+
+bool NvJpegDecoder::GetImageInfo(const uint8_t* data, size_t size, int* height, int* width) {
+  int n_components;
+  nvjpegChromaSubsampling_t subsampling;
+  int widths[NVJPEG_MAX_COMPONENT];
+  int heights[NVJPEG_MAX_COMPONENT];
+  if (nvjpegGetImageInfo(handle_, data, size, &n_components, &subsampling, widths, heights) !=
+      NVJPEG_STATUS_SUCCESS) {
+    return false;
+  }
+  if (subsampling == NVJPEG_CSS_UNKNOWN || (n_components != 1 && n_components != 3))
+    return false;
+  *height = heights[0];
+  *width  = widths[0];
+  return *height > 0 && *width > 0;
+}
+
+void NvJpegDecoder::Add(const uint8_t* data,
+                        size_t size,
+                        int height,
+                        int width,
+                        int index,
+                        const NvJpegTransform& t) {
+  data_.push_back(data);
+  lengths_.push_back(size);
+  slots_.push_back(index);
+  NvJpegImageDesc desc;
+  desc.src   = nullptr;
+  desc.src_h = height;
+  desc.src_w = width;
+  desc.index = index;
+  desc.t     = t;
+  descs_.push_back(desc);
+}
+
+void NvJpegDecoder::AddHostImage(const void* data, size_t size, int index) {
+  host_data_.push_back(data);
+  host_sizes_.push_back(size);
+  host_slots_.push_back(index);
+}
+
+void NvJpegDecoder::SetMeanImage(const float* mean_img, size_t size) {
+  CHECK_EQ(size, static_cast<size_t>(channels_) * out_h_ * out_w_)
+      << "mean image does not match the output shape";
+  common::cuda::DeviceStore device_store(dev_id_);
+  Reserve(&mean_img_, size * sizeof(float));
+  CUDA_CALL(cudaMemcpyAsync(
+      mean_img_.dptr, mean_img, size * sizeof(float), cudaMemcpyHostToDevice, stream_));
+  CUDA_CALL(cudaStreamSynchronize(stream_));
+}
+
+void NvJpegDecoder::Clear() {
+  data_.clear();
+  lengths_.clear();
+  slots_.clear();
+  descs_.clear();
+  host_data_.clear();
+  host_sizes_.clear();
+  host_slots_.clear();
+}
+
+void NvJpegDecoder::Reserve(Storage::Handle* handle, size_t size) {
+  if (handle->size >= size)
+    return;
+  // the stream is idle between batches, the old buffer is not in use
+  if (handle->size != 0)
+    Storage::Get()->DirectFree(*handle);
+  *handle = Storage::Get()->Alloc(size, Context::GPU(dev_id_));
+}
+
+template <typename DType>
+void NvJpegDecoder::LaunchTransform(DType* dst) {
+  const int n = static_cast<int>(descs_.size());
+  Reserve(&desc_buf_, n * sizeof(NvJpegImageDesc));
+  CUDA_CALL(cudaMemcpyAsync(desc_buf_.dptr,
+                            descs_.data(),
+                            n * sizeof(NvJpegImageDesc),
+                            cudaMemcpyHostToDevice,
+                            stream_));
+  const int plane = out_h_ * out_w_;
+  dim3 grid(std::min((plane + kTransformThreads - 1) / kTransformThreads, 64), n);
+  NvJpegTransformKernel<DType>
+      <<<grid, kTransformThreads, 0, stream_>>>(static_cast<const NvJpegImageDesc*>(desc_buf_.dptr),
+                                                static_cast<const float*>(mean_img_.dptr),
+                                                channels_,
+                                                out_h_,
+                                                out_w_,
+                                                dst);
+  CUDA_CALL(cudaGetLastError());
+}
+
+template <typename DType>
+bool NvJpegDecoder::Decode(DType* dst) {
+  common::cuda::DeviceStore device_store(dev_id_);
+  const size_t image_size = static_cast<size_t>(channels_) * out_h_ * out_w_ * sizeof(DType);
+  for (size_t i = 0; i < host_data_.size(); ++i) {
+    CHECK_EQ(host_sizes_[i], image_size) << "host image does not match the output shape";
+    CUDA_CALL(cudaMemcpyAsync(reinterpret_cast<char*>(dst) + host_slots_[i] * image_size,
+                              host_data_[i],
+                              image_size,
+                              cudaMemcpyHostToDevice,
+                              stream_));
+  }
+  host_data_.clear();
+  host_sizes_.clear();
+  host_slots_.clear();
+  bool success = true;
+  if (!descs_.empty()) {
+    // decoded images are packed in one buffer, each with an interleaved pitch
+    std::vector<size_t> offsets(descs_.size());
+    size_t total = 0;
+    for (size_t i = 0; i < descs_.size(); ++i) {
+      offsets[i] = total;
+      total += static_cast<size_t>(descs_[i].src_h) * descs_[i].src_w * channels_;
+    }
+    Reserve(&decoded_, total);
+    std::vector<nvjpegImage_t> images(descs_.size());
+    for (size_t i = 0; i < descs_.size(); ++i) {
+      uint8_t* ptr         = static_cast<uint8_t*>(decoded_.dptr) + offsets[i];
+      descs_[i].src        = ptr;
+      images[i]            = nvjpegImage_t();
+      images[i].channel[0] = ptr;
+      images[i].pitch[0]   = static_cast<size_t>(descs_[i].src_w) * channels_;
+    }
+    const nvjpegOutputFormat_t format = channels_ == 3 ? NVJPEG_OUTPUT_RGBI : NVJPEG_OUTPUT_Y;
+    success =
+        nvjpegDecodeBatchedInitialize(
+            handle_, state_, static_cast<int>(descs_.size()), 1, format) ==
+            NVJPEG_STATUS_SUCCESS &&
+        nvjpegDecodeBatched(
+            handle_, state_, data_.data(), lengths_.data(), images.data(), stream_) ==
+            NVJPEG_STATUS_SUCCESS;
+    if (success)
+      LaunchTransform(dst);
+  }
+  CUDA_CALL(cudaStreamSynchronize(stream_));
+  if (success)
+    Clear();
+  return success;
+}
+
+template bool NvJpegDecoder::Decode<float>(float* dst);
+template bool NvJpegDecoder::Decode<uint8_t>(uint8_t* dst);
+template bool NvJpegDecoder::Decode<int8_t>(int8_t* dst);
+
+}  // namespace io
+}  // namespace mxnet
+
+#endif  // MXNET_USE_CUDA && MXNET_USE_NVJPEG
@@ -0,0 +1,174 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file nvjpeg_decoder.h
+ * \brief batched JPEG decode, resize, crop and normalization on GPU with nvJPEG,
+ *  used by ImageRecordIter with gpu_decode=True.
+ */
+#ifndef MXNET_IO_NVJPEG_DECODER_H_
+#define MXNET_IO_NVJPEG_DECODER_H_
+
+#include <mxnet/libinfo.h>
+
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG
+#include <mxnet/storage.h>
+#include <cuda_runtime.h>
+#include <nvjpeg.h>
+#include <cstdint>
+#include <vector>
+
+/*!
+ * \brief Protected nvJPEG call.
+ * \param func Expression to call.
+ */
+#define NVJPEG_CALL(func)                                        \
+  {                                                              \
+    nvjpegStatus_t e = (func);                                   \
+    CHECK_EQ(e, NVJPEG_STATUS_SUCCESS) << "nvJPEG: error " << e; \
+  }
+
+namespace mxnet {
+namespace io {
+
+/*!
+ * \brief geometry and pixel transform of one image of the batch.
+ *  The decoded image is bilinearly resized to resize_h x resize_w, the
+ *  out_h x out_w window at (crop_y, crop_x) is kept and optionally mirrored.
+ *  Float outputs are computed as (pixel - mean) * mult + bias per channel.
+ */
+struct NvJpegTransform {
+  int resize_h;
+  int resize_w;
+  int crop_y;
+  int crop_x;
+  bool mirror;
+  float mean[4];
+  float mult[4];
+  float bias[4];
+};
+
+/*!
+ * \brief image of the batch as seen by the resize kernel
+ */
+struct NvJpegImageDesc {
+  /*! \brief decoded interleaved pixels, on device */
+  const uint8_t* src;
+  int src_h;
+  int src_w;
+  /*! \brief slot of the image in the output batch */
+  int index;
+  NvJpegTransform t;
+};
+
+/*!
+ * \brief Decodes the JPEG images of a batch on one GPU and writes them,
+ *  resized, cropped, normalized and in CHW layout, into a device batch.
+ *
+ * Images are queued with Add and decoded together by Decode.
+ * Images nvJPEG cannot handle (not JPEG, CMYK, unknown chroma subsampling)
+ * are rejected by GetImageInfo and must be decoded by the caller, which can
+ * queue their host copy with AddHostImage so that it is uploaded on the
+ * stream of the decoder.
+ */
+class NvJpegDecoder {
+ public:
+  /*!
+   * \param dev_id GPU on which images are decoded.
+   * \param channels number of output channels, 1 (gray) or 3 (RGB).
+   * \param out_h height of the output images.
+   * \param out_w width of the output images.
+   */
+  NvJpegDecoder(int dev_id, int channels, int out_h, int out_w);
+  ~NvJpegDecoder();
+  /*!
+   * \brief read the header of an encoded image.
+   * \return false if the image cannot be decoded by nvJPEG.
+   */
+  bool GetImageInfo(const uint8_t* data, size_t size, int* height, int* width);
+  /*!
+   * \brief queue an image, which GetImageInfo accepted, for Decode.
+   *  data must stay valid until Decode returns.
+   */
+  void Add(const uint8_t* data,
+           size_t size,
+           int height,
+           int width,
+           int index,
+           const NvJpegTransform& t);
+  /*!
+   * \brief queue a host image, already in the output format, for upload.
+   *  data must stay valid until Decode returns.
+   */
+  void AddHostImage(const void* data, size_t size, int index);
+  /*!
+   * \brief set the per pixel mean image, CHW floats of the output size,
+   *  which replaces the per channel mean of NvJpegTransform.
+   */
+  void SetMeanImage(const float* mean_img, size_t size);
+  /*!
+   * \brief decode the queued images into dst and wait for completion.
+   * \param dst device batch, slot i starts at dst + i * channels * out_h * out_w.
+   * \return false if nvJPEG failed on the batch, nothing valid is then written
+   *  for the images queued with Add, the queue is kept for the caller to retry
+   *  them on CPU, see pending().
+   */
+  template <typename DType>
+  bool Decode(DType* dst);
+  /*! \return slots of the images queued with Add */
+  const std::vector<int>& pending() const {
+    return slots_;
+  }
+  /*! \brief empty the queue */
+  void Clear();
+
+ private:
+  /*! \brief grow handle to hold at least size bytes */
+  void Reserve(Storage::Handle* handle, size_t size);
+  /*! \brief launch the resize kernel on the decoded images */
+  template <typename DType>
+  void LaunchTransform(DType* dst);
+
+  int dev_id_;
+  int channels_;
+  int out_h_;
+  int out_w_;
+  nvjpegHandle_t handle_;
+  nvjpegJpegState_t state_;
+  cudaStream_t stream_;
+  /*! \brief queued encoded images */
+  std::vector<const unsigned char*> data_;
+  std::vector<size_t> lengths_;
+  std::vector<int> slots_;
+  std::vector<NvJpegImageDesc> descs_;
+  /*! \brief queued host images */
+  std::vector<const void*> host_data_;
+  std::vector<size_t> host_sizes_;
+  std::vector<int> host_slots_;
+  /*! \brief device buffers for decoded pixels, descriptors and the mean image */
+  Storage::Handle decoded_;
+  Storage::Handle desc_buf_;
+  Storage::Handle mean_img_;
+};
+
+}  // namespace io
+}  // namespace mxnet
+
+#endif  // MXNET_USE_CUDA && MXNET_USE_NVJPEG
+#endif  // MXNET_IO_NVJPEG_DECODER_H_
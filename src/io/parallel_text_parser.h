@@ -0,0 +1,374 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file parallel_text_parser.h
+ * \brief multi-threaded parser of LibSVM and CSV text files into CSR row blocks
+ */
+#ifndef MXNET_IO_PARALLEL_TEXT_PARSER_H_
+#define MXNET_IO_PARALLEL_TEXT_PARSER_H_
+
+#include <mxnet/base.h>
+#include <dmlc/base.h>
+#include <dmlc/io.h>
+#include <dmlc/logging.h>
+#include <dmlc/omp.h>
+#include <dmlc/threadediter.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace mxnet {
+namespace io {
+
+/*!
+ * \brief rows parsed from text, in CSR layout.
+ *  Row i holds the entries [offset[i], offset[i + 1]) of index and value.
+ */
+template <typename IndexType, typename DType>
+struct TextRowBlock {
+  std::vector<size_t> offset{0};
+  std::vector<real_t> label;
+  std::vector<IndexType> index;
+  std::vector<DType> value;
+
+  /*! \return number of rows */
+  size_t Size() const {
+    return label.size();
+  }
+  /*! \return number of entries of row i */
+  size_t Length(size_t i) const {
+    return offset[i + 1] - offset[i];
+  }
+  void Clear() {
+    offset.assign(1, 0);
+    label.clear();
+    index.clear();
+    value.clear();
+  }
+};
+
+/*! \brief whether c ends a line */
+inline bool IsLineEnd(char c) {
+  return c == '\n' || c == '\r';
+}
+
+/*! \brief whether c separates the tokens of a line */
+inline bool IsBlank(char c) {
+  return c == ' ' || c == '\t';
+}
+
+/*!
+ * \brief parse a number in [p, end), independently of the locale.
+ *  Accepts [+-]digits[.digits][(e|E)[+-]digits], and inf or nan for floats.
+ * \return the end of the number, p if there is none.
+ */
+template <typename DType>
+inline const char* ParseNumber(const char* p, const char* end, DType* out) {
+  const char* begin = p;
+  bool negative     = false;
+  if (p != end && (*p == '+' || *p == '-')) {
+    negative = *p == '-';
+    ++p;
+  }
+  if (std::is_floating_point<DType>::value && p != end && (*p == 'i' || *p == 'n')) {
+    const char* word = *p == 'i' ? "inf" : "nan";
+    size_t len       = 0;
+    while (len < 3 && p + len != end && (p[len] | 0x20) == word[len])
+      ++len;
+    if (len < 3)
+      return begin;
+    const double v = *p == 'i' ? INFINITY : NAN;
+    *out           = static_cast<DType>(negative ? -v : v);
+    return p + 3;
+  }
+  // the first 19 significant digits are exact in the mantissa
+  uint64_t mantissa = 0;
+  int num_digits    = 0;
+  int exponent      = 0;
+  bool has_digits   = false;
+  for (; p != end && *p >= '0' && *p <= '9'; ++p) {
+    has_digits = true;
+    if (num_digits < 19) {
+      mantissa = mantissa * 10 + (*p - '0');
+      if (mantissa != 0)
+        ++num_digits;
+    } else {
+      ++exponent;
+    }
+  }
+  if (std::is_integral<DType>::value &&
+      (p == end || (*p != '.' && *p != 'e' && *p != 'E'))) {
+    if (!has_digits)
+      return begin;
+    const int64_t v = static_cast<int64_t>(mantissa);
+    *out            = static_cast<DType>(negative ? -v : v);
+    return p;
+  }
+  if (p != end && *p == '.') {
+    for (++p; p != end && *p >= '0' && *p <= '9'; ++p) {
+      has_digits = true;
+      if (num_digits < 19) {
+        mantissa = mantissa * 10 + (*p - '0');
+        --exponent;
+        if (mantissa != 0)
+          ++num_digits;
+      }
+    }
+  }
+  if (!has_digits)
+    return begin;
+  if (p != end && (*p == 'e' || *p == 'E')) {
+    const char* q     = p + 1;
+    bool negative_exp = false;
+    if (q != end && (*q == '+' || *q == '-')) {
+      negative_exp = *q == '-';
+      ++q;
+    }
+    if (q != end && *q >= '0' && *q <= '9') {
+      int e = 0;
+      for (; q != end && *q >= '0' && *q <= '9'; ++q) {
+        e = std::min(e * 10 + (*q - '0'), 100000);
+      }
+      exponent += negative_exp ? -e : e;
+      p = q;
+    }
+  }
+  static const double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                  1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                  1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  double v = static_cast<double>(mantissa);
+  if (exponent >= 0) {
+    v *= exponent <= 22 ? kPow10[exponent] : std::pow(10.0, exponent);
+  } else {
+    v /= -exponent <= 22 ? kPow10[-exponent] : std::pow(10.0, -exponent);
+  }
+  *out = static_cast<DType>(negative ? -v : v);
+  return p;
+}
+
+/*!
+ * \brief Parser of LibSVM or CSV files into CSR row blocks.
+ *
+ * Chunks of the input split are read and parsed on a background thread, so
+ * that parsing overlaps with the consumption of the rows. Every chunk is cut
+ * at line boundaries into one part per thread and the parts are parsed in
+ * parallel, each into its own row block.
+ */
+template <typename IndexType, typename DType = real_t>
+class ParallelTextParser {
+ public:
+  /*! \brief supported text formats */
+  enum Format { kLibSVM, kCSV };
+  /*!
+   * \param uri the file, directory or list of files to read.
+   * \param part_index index of the part of the input to read.
+   * \param num_parts number of parts the input is divided into.
+   * \param format format of the lines.
+   * \param num_threads number of threads parsing a chunk.
+   */
+  ParallelTextParser(const std::string& uri,
+                     unsigned part_index,
+                     unsigned num_parts,
+                     Format format,
+                     int num_threads)
+      : format_(format), num_threads_(std::max(num_threads, 1)) {
+    source_.reset(dmlc::InputSplit::Create(uri.c_str(), part_index, num_parts, "text"));
+    // a chunk being parsed and one ready are enough to keep the consumer busy
+    iter_.set_max_capacity(2);
+    iter_.Init([this](std::vector<TextRowBlock<IndexType, DType>>** dptr) {
+                 if (*dptr == nullptr)
+                   *dptr = new std::vector<TextRowBlock<IndexType, DType>>();
+                 return ParseNextChunk(*dptr);
+               },
+               [this]() { source_->BeforeFirst(); });
+  }
+
+  ~ParallelTextParser() {
+    iter_.Destroy();
+  }
+
+  void BeforeFirst() {
+    iter_.BeforeFirst();
+    block_ = 0;
+    value_ = nullptr;
+  }
+
+  /*! \brief move to the next non empty row block */
+  bool Next() {
+    while (true) {
+      if (value_ != nullptr && block_ < iter_.Value().size()) {
+        value_ = &iter_.Value()[block_++];
+      } else {
+        if (!iter_.Next()) {
+          value_ = nullptr;
+          return false;
+        }
+        block_ = 0;
+        value_ = &iter_.Value()[block_++];
+      }
+      if (value_->Size() != 0)
+        return true;
+    }
+  }
+
+  /*! \brief current row block, valid until the next call of Next or BeforeFirst */
+  const TextRowBlock<IndexType, DType>& Value() const {
+    return *value_;
+  }
+
+ private:
+  /*! \brief start of the line holding bptr, or begin */
+  static const char* BackFindLineEnd(const char* bptr, const char* begin) {
+    for (; bptr != begin; --bptr) {
+      if (IsLineEnd(*bptr))
+        return bptr;
+    }
+    return begin;
+  }
+
+  /*! \brief read a chunk and parse it into one block per thread */
+  bool ParseNextChunk(std::vector<TextRowBlock<IndexType, DType>>* blocks) {
+    dmlc::InputSplit::Blob chunk;
+    if (!source_->NextChunk(&chunk))
+      return false;
+    const char* head = static_cast<const char*>(chunk.dptr);
+    const size_t size = chunk.size;
+    // the runtime may provide fewer threads, whose blocks stay empty
+    blocks->resize(num_threads_);
+    for (auto& block : *blocks) {
+      block.Clear();
+    }
+#pragma omp parallel num_threads(num_threads_)
+    {
+      omp_exc_.Run([&] {
+        const int nthread = omp_get_num_threads();
+        const int tid     = omp_get_thread_num();
+        const size_t step = (size + nthread - 1) / nthread;
+        const char* begin = BackFindLineEnd(head + std::min(tid * step, size), head);
+        const char* end   = tid + 1 == nthread ?
+                              head + size :
+                              BackFindLineEnd(head + std::min((tid + 1) * step, size), head);
+        ParseBlock(begin, end, &(*blocks)[tid]);
+      });
+    }
+    omp_exc_.Rethrow();
+    return true;
+  }
+
+  /*! \brief parse the lines of [begin, end) into out */
+  void ParseBlock(const char* begin, const char* end, TextRowBlock<IndexType, DType>* out) {
+    const char* p = begin;
+    while (p != end) {
+      while (p != end && (IsLineEnd(*p) || IsBlank(*p)))
+        ++p;
+      const char* line_end = p;
+      while (line_end != end && !IsLineEnd(*line_end))
+        ++line_end;
+      if (p == line_end)
+        continue;
+      if (format_ == kLibSVM) {
+        ParseLibSVMLine(p, line_end, out);
+      } else {
+        ParseCSVLine(p, line_end, out);
+      }
+      out->offset.push_back(out->index.size());
+      p = line_end;
+    }
+  }
+
+  /*! \brief label[:weight] index[:value] ..., qid:n tokens are ignored */
+  static void ParseLibSVMLine(const char* p,
+                              const char* end,
+                              TextRowBlock<IndexType, DType>* out) {
+    real_t label  = 0;
+    const char* q = ParseNumber(p, end, &label);
+    CHECK(q != p) << "Invalid LibSVM line: " << std::string(p, end);
+    out->label.push_back(label);
+    // skip the weight
+    while (q != end && !IsBlank(*q))
+      ++q;
+    while (q != end) {
+      while (q != end && IsBlank(*q))
+        ++q;
+      if (q == end)
+        break;
+      if (end - q > 4 && std::equal(q, q + 4, "qid:")) {
+        while (q != end && !IsBlank(*q))
+          ++q;
+        continue;
+      }
+      uint64_t idx      = 0;
+      const char* token = q;
+      q                 = ParseNumber(q, end, &idx);
+      CHECK(q != token) << "Invalid LibSVM feature: " << std::string(token, end);
+      DType value = 1;
+      if (q != end && *q == ':') {
+        const char* v = q + 1;
+        q             = ParseNumber(v, end, &value);
+        CHECK(q != v) << "Invalid LibSVM value: " << std::string(token, end);
+      }
+      out->index.push_back(static_cast<IndexType>(idx));
+      out->value.push_back(value);
+    }
+  }
+
+  /*! \brief comma separated values, empty values are 0 */
+  static void ParseCSVLine(const char* p, const char* end, TextRowBlock<IndexType, DType>* out) {
+    out->label.push_back(0);
+    IndexType column = 0;
+    while (true) {
+      while (p != end && IsBlank(*p))
+        ++p;
+      DType value       = 0;
+      const char* token = p;
+      p                 = ParseNumber(p, end, &value);
+      while (p != end && IsBlank(*p))
+        ++p;
+      CHECK(p == end || *p == ',') << "Invalid CSV value: " << std::string(token, end);
+      out->index.push_back(column++);
+      out->value.push_back(value);
+      if (p == end)
+        break;
+      ++p;
+    }
+  }
+
+  /*! \brief format of the lines */
+  Format format_;
+  /*! \brief number of threads parsing a chunk */
+  int num_threads_;
+  /*! \brief input split */
+  std::unique_ptr<dmlc::InputSplit> source_;
+  /*! \brief background reader and parser of chunks */
+  dmlc::ThreadedIter<std::vector<TextRowBlock<IndexType, DType>>> iter_;
+  /*! \brief current block of the current chunk */
+  size_t block_{0};
+  const TextRowBlock<IndexType, DType>* value_{nullptr};
+  /*! \brief OMPException obj to store and rethrow exceptions from omp blocks */
+  dmlc::OMPException omp_exc_;
+};
+
+}  // namespace io
+}  // namespace mxnet
+#endif  // MXNET_IO_PARALLEL_TEXT_PARSER_H_
@@ -0,0 +1,263 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file sample_cache.h
+ * \brief cache of decoded samples reused across epochs, in memory and spilled to disk
+ */
+#ifndef MXNET_IO_SAMPLE_CACHE_H_
+#define MXNET_IO_SAMPLE_CACHE_H_
+
+#include <dmlc/base.h>
+#include <dmlc/logging.h>
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace mxnet {
+namespace io {
+
+/*!
+ * \brief Write-once cache of samples, e.g. decoded images before their random augmentations.
+ *
+ * A sample is a key, a small vector of metadata such as its shape, and its bytes.
+ * Samples are kept in memory up to a limit, then appended to a file in the spill
+ * directory, if any, and dropped otherwise. Samples are never evicted, so that the
+ * data of a sample is immutable once stored and is read without holding the lock.
+ * The cache is shared by the threads decoding samples.
+ */
+class SampleCache {
+ public:
+  /*! \brief destination buffers of the parts of a sample */
+  typedef std::vector<std::pair<void*, size_t>> Buffers;
+  /*!
+   * \param memory_limit bytes of samples kept in memory.
+   * \param spill_dir local directory of the file holding the samples over the limit,
+   *  empty to not cache them.
+   */
+  SampleCache(size_t memory_limit, const std::string& spill_dir) : memory_limit_(memory_limit) {
+    if (spill_dir.empty())
+      return;
+#if !defined(_WIN32)
+    std::string path = spill_dir + "/mxnet-sample-cache-XXXXXX";
+    spill_fd_        = mkstemp(&path[0]);
+    CHECK_NE(spill_fd_, -1) << "Failed to create a cache file in " << spill_dir << ": "
+                            << strerror(errno);
+    // the file is removed once closed
+    unlink(path.c_str());
+#else
+    LOG(FATAL) << "Spilling the sample cache to disk is not supported on Windows";
+#endif
+  }
+
+  ~SampleCache() {
+#if !defined(_WIN32)
+    if (spill_fd_ != -1)
+      close(spill_fd_);
+#endif
+  }
+
+  /*! \brief hash of encoded bytes, used as the key of the sample decoded from them */
+  static uint64_t Hash(const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    uint64_t h    = 14695981039346656037ULL ^ size;
+    for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t), p += sizeof(uint64_t)) {
+      uint64_t w;
+      std::memcpy(&w, p, sizeof(w));
+      h = (h ^ w) * 1099511628211ULL;
+      h ^= h >> 29;
+    }
+    for (; size != 0; --size, ++p) {
+      h = (h ^ static_cast<uint8_t>(*p)) * 1099511628211ULL;
+    }
+    return h;
+  }
+
+  /*!
+   * \brief store a sample, unless its key is already stored.
+   * \param key key of the sample.
+   * \param meta metadata of the sample.
+   * \param parts the bytes of the sample, stored contiguously.
+   */
+  void Put(uint64_t key,
+           const std::vector<int64_t>& meta,
+           const std::vector<std::pair<const void*, size_t>>& parts) {
+    size_t size = 0;
+    for (const auto& part : parts) {
+      size += part.second;
+    }
+    Entry entry;
+    entry.meta = meta;
+    entry.size = size;
+    {
+      // only the space is reserved under the lock, the bytes are copied or written after
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (full_ || entries_.count(key) != 0 || !pending_.insert(key).second)
+        return;
+      if (memory_used_ + size <= memory_limit_) {
+        memory_used_ += size;
+      } else if (spill_fd_ != -1) {
+        entry.offset = spill_size_;
+        spill_size_ += size;
+      } else {
+        full_ = true;
+        pending_.erase(key);
+        return;
+      }
+    }
+    bool written = true;
+    if (entry.offset == kInMemory) {
+      entry.data.reserve(size);
+      for (const auto& part : parts) {
+        entry.data.append(static_cast<const char*>(part.first), part.second);
+      }
+    } else {
+      size_t offset = entry.offset;
+      for (const auto& part : parts) {
+        if (!WriteAll(part.first, part.second, offset)) {
+          LOG(WARNING) << "Failed to write the sample cache file: " << strerror(errno)
+                       << ", stop caching samples";
+          written = false;
+          break;
+        }
+        offset += part.second;
+      }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.erase(key);
+    if (!written) {
+      full_ = true;
+      return;
+    }
+    entries_.emplace(key, std::move(entry));
+  }
+
+  /*!
+   * \brief read a stored sample.
+   * \param key key of the sample.
+   * \param alloc called with the metadata of the sample, returns the buffers its bytes
+   *  are copied to, whose sizes add up to the size given at Put.
+   * \return whether the sample is stored.
+   */
+  bool Get(uint64_t key, const std::function<Buffers(const std::vector<int64_t>&)>& alloc) {
+    const Entry* entry;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = entries_.find(key);
+      if (it == entries_.end())
+        return false;
+      // entries are never erased and the nodes of unordered_map are stable
+      entry = &it->second;
+    }
+    size_t pos = 0;
+    for (const auto& buf : alloc(entry->meta)) {
+      CHECK_LE(pos + buf.second, entry->size) << "Buffers do not match the cached sample";
+      if (entry->offset == kInMemory) {
+        std::memcpy(buf.first, entry->data.data() + pos, buf.second);
+      } else {
+        CHECK(ReadAll(buf.first, buf.second, entry->offset + pos))
+            << "Failed to read the sample cache file: " << strerror(errno);
+      }
+      pos += buf.second;
+    }
+    CHECK_EQ(pos, entry->size) << "Buffers do not match the cached sample";
+    return true;
+  }
+
+ private:
+  static constexpr size_t kInMemory = static_cast<size_t>(-1);
+
+  struct Entry {
+    std::vector<int64_t> meta;
+    size_t size{0};
+    /*! \brief position in the spill file, kInMemory if the bytes are in data */
+    size_t offset{kInMemory};
+    std::string data;
+  };
+
+#if !defined(_WIN32)
+  bool WriteAll(const void* data, size_t size, size_t offset) {
+    const char* p = static_cast<const char*>(data);
+    while (size != 0) {
+      ssize_t n = pwrite(spill_fd_, p, size, offset);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        return false;
+      p += n;
+      offset += n;
+      size -= n;
+    }
+    return true;
+  }
+
+  // pread does not move the file position, concurrent reads are safe
+  bool ReadAll(void* data, size_t size, size_t offset) {
+    char* p = static_cast<char*>(data);
+    while (size != 0) {
+      ssize_t n = pread(spill_fd_, p, size, offset);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        return false;
+      p += n;
+      offset += n;
+      size -= n;
+    }
+    return true;
+  }
+#else
+  bool WriteAll(const void* data, size_t size, size_t offset) {
+    return false;
+  }
+
+  bool ReadAll(void* data, size_t size, size_t offset) {
+    return false;
+  }
+#endif
+
+  /*! \brief bytes of samples kept in memory */
+  size_t memory_limit_;
+  size_t memory_used_{0};
+  /*! \brief spill file, -1 if samples over the memory limit are not cached */
+  int spill_fd_{-1};
+  size_t spill_size_{0};
+  /*! \brief no more samples can be stored */
+  bool full_{false};
+  std::mutex mutex_;
+  std::unordered_map<uint64_t, Entry> entries_;
+  /*! \brief keys of the samples being copied or written by Put */
+  std::unordered_set<uint64_t> pending_;
+
+  DISALLOW_COPY_AND_ASSIGN(SampleCache);
+};
+
+}  // namespace io
+}  // namespace mxnet
+#endif  // MXNET_IO_SAMPLE_CACHE_H_
@@ -19,7 +19,6 @@
 
 #ifndef MXNET_KVSTORE_COMM_H_
 #define MXNET_KVSTORE_COMM_H_
-#include <dmlc/omp.h>
 #include <string>
 #include <algorithm>
 #include <utility>
@@ -27,12 +26,15 @@
 #include <vector>
 #include <tuple>
 #include <thread>
+#include <functional>
+#include <unordered_map>
 #include "mxnet/ndarray.h"
 #include "gradient_compression.h"
 #include "../ndarray/ndarray_function.h"
 #include "../operator/tensor/sparse_retain-inl.h"
 #include "../profiler/profiler.h"
 #include "./kvstore_utils.h"
+#include "./reduce_sum_cpu.h"
 namespace mxnet {
 namespace kvstore {
 /**
@@ -43,7 +45,11 @@ class Comm {
   Comm() {
     pinned_ctx_ = Context::CPUPinned(0);
   }
-  virtual ~Comm() {}
+  virtual ~Comm() {
+    for (auto& kv : profile_vars_) {
+      Engine::Get()->DeleteVariable([](RunContext) {}, pinned_ctx_, kv.second);
+    }
+  }
   /**
    * \brief init key with the data shape and storage shape
    */
@@ -92,9 +98,78 @@ class Comm {
   }
 
  protected:
+  /**
+   * \brief start a communication of the profiler once the arrays read are ready
+   * \return the communication to stop, or null if the profiler is not running
+   */
+  std::shared_ptr<profiler::ProfileComm> StartComm(const char* name,
+                                                   int key,
+                                                   size_t bytes,
+                                                   const std::vector<NDArray>& reads,
+                                                   int priority) {
+    auto comm = profiler::ProfileComm::Start(name, key, bytes);
+    if (comm) {
+      PushCommMarker(key, reads, priority, [comm]() { comm->start(); });
+    }
+    return comm;
+  }
+
+  /** \brief stop a communication of the profiler once the arrays written are ready */
+  void StopComm(const std::shared_ptr<profiler::ProfileComm>& comm,
+                int key,
+                const std::vector<NDArray>& writes,
+                int priority) {
+    if (comm) {
+      PushCommMarker(key, writes, priority, [comm]() { comm->stop(); });
+    }
+  }
+
+  void StopComm(const std::shared_ptr<profiler::ProfileComm>& comm,
+                int key,
+                const std::vector<NDArray*>& writes,
+                int priority) {
+    if (comm) {
+      std::vector<NDArray> arrays;
+      for (auto w : writes) {
+        arrays.push_back(*w);
+      }
+      StopComm(comm, key, arrays, priority);
+    }
+  }
+
   Context pinned_ctx_;
 
   std::shared_ptr<GradientCompression> gc_;
+
+ private:
+  /**
+   * \brief run fn once the arrays are ready, after the markers already pushed for the key
+   */
+  void PushCommMarker(int key,
+                      const std::vector<NDArray>& arrays,
+                      int priority,
+                      const std::function<void()>& fn) {
+    auto& var = profile_vars_[key];
+    if (var == nullptr) {
+      var = Engine::Get()->NewVariable();
+    }
+    std::vector<Engine::VarHandle> const_vars;
+    for (const auto& arr : arrays) {
+      const_vars.push_back(arr.var());
+    }
+    std::sort(const_vars.begin(), const_vars.end());
+    const_vars.erase(std::unique(const_vars.begin(), const_vars.end()), const_vars.end());
+    Engine::Get()->PushSync([fn](RunContext rctx) { fn(); },
+                            Context::CPU(),
+                            const_vars,
+                            {var},
+                            FnProperty::kCPUPrioritized,
+                            priority,
+                            "KVStoreCommProfile");
+  }
+
+  /** \brief written by the markers of the communications of each key, to order them */
+  std::unordered_map<int, Engine::VarHandle> profile_vars_;
 };
 
 /**
@@ -143,6 +218,8 @@ class CommCPU : public Comm {
     NDArray& buf_merged = buf.merged_buf(stype);
     // normal dense reduce
     if (stype == kDefaultStorage) {
+      const size_t bytes = src[0].shape().Size() * mshadow::mshadow_sizeof(src[0].dtype());
+      auto comm          = StartComm("KVStoreReduce", key, bytes * src.size(), src, priority);
       std::vector<Engine::VarHandle> const_vars(src.size() - 1);
       std::vector<NDArray> reduce(src.size());
       CopyFromTo(src[0], &buf_merged, priority);
@@ -164,20 +241,8 @@ class CommCPU : public Comm {
         const_vars[i - 1] = reduce[i].var();
       }
 
-      Engine::Get()->PushAsync(
-          [reduce, this](RunContext rctx,
-                         Engine::CallbackOnStart on_start,
-                         Engine::CallbackOnComplete on_complete) {
-            on_start();
-            ReduceSumCPU(reduce);
-            on_complete();
-          },
-          Context::CPU(),
-          const_vars,
-          {reduce[0].var()},
-          FnProperty::kCPUPrioritized,
-          priority,
-          "KVStoreReduce");
+      ReduceSumCPU(reduce, const_vars, priority);
+      StopComm(comm, key, {buf_merged}, priority);
     } else {
       // sparse reduce
       std::vector<Engine::VarHandle> const_vars(src.size());
@@ -226,7 +291,9 @@ class CommCPU : public Comm {
                  const NDArray& src,
                  const std::vector<NDArray*> dst,
                  int priority) override {
-    int mask = src.ctx().dev_mask();
+    const size_t bytes = src.shape().Size() * mshadow::mshadow_sizeof(src.dtype());
+    auto comm          = StartComm("KVStoreBroadcast", key, bytes * dst.size(), {src}, priority);
+    int mask           = src.ctx().dev_mask();
     if (mask == Context::kCPU) {
       for (auto d : dst)
         CopyFromTo(src, d, priority);
@@ -241,6 +308,7 @@ class CommCPU : public Comm {
       for (auto d : dst)
         CopyFromTo(buf, d, priority);
     }
+    StopComm(comm, key, dst, priority);
   }
 
   void BroadcastRowSparse(int key,
@@ -298,8 +366,78 @@ class CommCPU : public Comm {
   }
 
  private:
-  // reduce sum into val[0]
-  inline void ReduceSumCPU(const std::vector<NDArray>& in_data) {
+  /**
+   * \brief reduce sum into in_data[0]
+   *
+   * Big arrays are split over nthread_reduction_ operations of the engine, which run
+   * concurrently on its CPU workers rather than in an OpenMP region of their own. They
+   * only read the variable of in_data[0] while writing disjoint ranges of it, and a last
+   * operation writes the variable so that later operations wait for all of them.
+   */
+  inline void ReduceSumCPU(const std::vector<NDArray>& in_data,
+                           const std::vector<Engine::VarHandle>& const_vars,
+                           int priority) {
+    const size_t total = in_data[0].shape().Size();
+    size_t ntask       = 1;
+    if (total >= bigarray_bound_ && nthread_reduction_ > 1) {
+      ntask = static_cast<size_t>(nthread_reduction_);
+    }
+    if (ntask == 1) {
+      Engine::Get()->PushAsync(
+          [in_data, total](RunContext rctx,
+                           Engine::CallbackOnStart on_start,
+                           Engine::CallbackOnComplete on_complete) {
+            on_start();
+            ReduceSumCPURange(in_data, 0, total);
+            on_complete();
+          },
+          Context::CPU(),
+          const_vars,
+          {in_data[0].var()},
+          FnProperty::kCPUPrioritized,
+          priority,
+          "KVStoreReduce");
+      return;
+    }
+    std::vector<Engine::VarHandle> read_vars(const_vars);
+    read_vars.push_back(in_data[0].var());
+    // ranges of whole cache lines, so that the tasks do not write the same line
+    const size_t step = ((total + ntask - 1) / ntask + 63) & ~static_cast<size_t>(63);
+    for (size_t begin = 0; begin < total; begin += step) {
+      const size_t end = std::min(begin + step, total);
+      Engine::Get()->PushAsync(
+          [in_data, begin, end](RunContext rctx,
+                                Engine::CallbackOnStart on_start,
+                                Engine::CallbackOnComplete on_complete) {
+            on_start();
+            ReduceSumCPURange(in_data, begin, end);
+            on_complete();
+          },
+          Context::CPU(),
+          read_vars,
+          {},
+          FnProperty::kCPUPrioritized,
+          priority,
+          "KVStoreReduce");
+    }
+    Engine::Get()->PushAsync(
+        [](RunContext rctx,
+           Engine::CallbackOnStart on_start,
+           Engine::CallbackOnComplete on_complete) {
+          on_start();
+          on_complete();
+        },
+        Context::CPU(),
+        {},
+        {in_data[0].var()},
+        FnProperty::kCPUPrioritized,
+        priority,
+        "KVStoreReduceDone");
+  }
+
+  static inline void ReduceSumCPURange(const std::vector<NDArray>& in_data,
+                                       size_t begin,
+                                       size_t end) {
     MSHADOW_TYPE_SWITCH(in_data[0].dtype(), DType, {
       std::vector<DType*> dptr(in_data.size());
       for (size_t i = 0; i < in_data.size(); ++i) {
@@ -307,8 +445,7 @@ class CommCPU : public Comm {
         CHECK(data.CheckContiguous());
         dptr[i] = data.FlatTo2D<cpu, DType>().dptr_;
       }
-      size_t total = in_data[0].shape().Size();
-      ReduceSumCPUImpl(dptr, total);
+      ReduceSumRange(dptr, begin, end);
     });
   }
 
@@ -385,61 +522,6 @@ class CommCPU : public Comm {
     });
   }
 
-  template <typename DType>
-  inline static void ReduceSumCPU(const std::vector<DType*>& dptr, size_t offset, index_t size) {
-    using namespace mshadow;  // NOLINT(*)
-    Tensor<cpu, 1, DType> in_0(dptr[0] + offset, Shape1(size));
-    for (size_t i = 1; i < dptr.size(); i += 4) {
-      switch (dptr.size() - i) {
-        case 1: {
-          Tensor<cpu, 1, DType> in_1(dptr[i] + offset, Shape1(size));
-          in_0 += in_1;
-          break;
-        }
-        case 2: {
-          Tensor<cpu, 1, DType> in_1(dptr[i] + offset, Shape1(size));
-          Tensor<cpu, 1, DType> in_2(dptr[i + 1] + offset, Shape1(size));
-          in_0 += in_1 + in_2;
-          break;
-        }
-        case 3: {
-          Tensor<cpu, 1, DType> in_1(dptr[i] + offset, Shape1(size));
-          Tensor<cpu, 1, DType> in_2(dptr[i + 1] + offset, Shape1(size));
-          Tensor<cpu, 1, DType> in_3(dptr[i + 2] + offset, Shape1(size));
-          in_0 += in_1 + in_2 + in_3;
-          break;
-        }
-        default: {
-          Tensor<cpu, 1, DType> in_1(dptr[i] + offset, Shape1(size));
-          Tensor<cpu, 1, DType> in_2(dptr[i + 1] + offset, Shape1(size));
-          Tensor<cpu, 1, DType> in_3(dptr[i + 2] + offset, Shape1(size));
-          Tensor<cpu, 1, DType> in_4(dptr[i + 3] + offset, Shape1(size));
-          in_0 += in_1 + in_2 + in_3 + in_4;
-          break;
-        }
-      }
-    }
-  }
-
-  template <typename DType>
-  inline void ReduceSumCPUImpl(std::vector<DType*> dptr, size_t total) {
-    const size_t step = std::min(bigarray_bound_, static_cast<size_t>(4 << 10));
-    long ntask        = (total + step - 1) / step;  // NOLINT(*)
-    if (total < bigarray_bound_ || nthread_reduction_ <= 1) {
-      ReduceSumCPU(dptr, 0, total);
-    } else {
-#pragma omp parallel for schedule(static) num_threads(nthread_reduction_)
-      for (long j = 0; j < ntask; ++j) {  // NOLINT(*)
-        size_t k     = static_cast<size_t>(j);
-        size_t begin = std::min(k * step, total);
-        size_t end   = std::min((k + 1) * step, total);
-        if (j == ntask - 1)
-          CHECK_EQ(end, total);
-        ReduceSumCPU(dptr, begin, static_cast<index_t>(end - begin));
-      }
-    }
-  }
-
   /// \brief temporal space for pushing and pulling
   struct BufferEntry {
     /// \brief the merged value
@@ -552,6 +634,8 @@ class CommDevice : public Comm {
     NDArray& buf_merged            = buf.merged_buf(stype);
     // normal dense reduce
     if (stype == kDefaultStorage) {
+      const size_t bytes = src[0].shape().Size() * mshadow::mshadow_sizeof(src[0].dtype());
+      auto comm          = StartComm("KVStoreReduce", key, bytes * src.size(), src, priority);
       CopyFromTo(src[0], &buf_merged, priority);
 
       std::vector<NDArray> reduce(src.size());
@@ -576,6 +660,7 @@ class CommDevice : public Comm {
         reduce[i + 1] = buf.copy_buf[i];
       }
       ElementwiseSum(reduce, &buf_merged, priority);
+      StopComm(comm, key, {buf_merged}, priority);
     } else {
       // sparse reduce
       buf_merged = ReduceRowSparse(key, src, priority);
@@ -635,6 +720,8 @@ class CommDevice : public Comm {
                  const NDArray& src,
                  const std::vector<NDArray*> dst,
                  int priority) override {
+    const size_t bytes = src.shape().Size() * mshadow::mshadow_sizeof(src.dtype());
+    auto comm          = StartComm("KVStoreBroadcast", key, bytes * dst.size(), {src}, priority);
     if (!inited_) {
       // copy to a random device first
       int dev_id = key % dst.size();
@@ -651,6 +738,7 @@ class CommDevice : public Comm {
         CopyFromTo(buf_merged, d, priority);
       }
     }
+    StopComm(comm, key, dst, priority);
   }
 
   void BroadcastRowSparse(int key,
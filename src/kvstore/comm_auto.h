@@ -0,0 +1,348 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * Copyright (c) 2015 by Contributors
+ */
+#ifndef MXNET_KVSTORE_COMM_AUTO_H_
+#define MXNET_KVSTORE_COMM_AUTO_H_
+#include <algorithm>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "mxnet/ndarray.h"
+#include "./comm.h"
+#include "./comm_tree.h"
+#include "./gpu_topology.h"
+namespace mxnet {
+namespace kvstore {
+/**
+ * \brief an implementation of Comm that chooses the reduction of each key from the
+ * link topology of the GPUs.
+ *
+ * The topology is probed when the first key is reduced. Then:
+ *  - small keys, whose reduction is latency bound, are reduced by CommDevice,
+ *    on a single device;
+ *  - medium keys, if the GPUs are connected by NVLink, are reduced by
+ *    CommDeviceTree, along trees of NVLinks;
+ *  - large keys, if a ring of NVLinks goes through all the GPUs, are reduced along
+ *    the ring. Each GPU reduces 1/n of the key, in chunks, so that all the links of
+ *    the ring are busy at the same time, and the chunks are pipelined along the ring.
+ *
+ * Compressed and row_sparse keys are always reduced by CommDevice.
+ */
+class CommDeviceAuto : public Comm {
+ public:
+  CommDeviceAuto() {
+    tree_bound_ = dmlc::GetEnv("MXNET_KVSTORE_AUTO_TREE_BOUND", 1 << 16);
+    ring_bound_ = dmlc::GetEnv("MXNET_KVSTORE_AUTO_RING_BOUND", 1 << 22);
+    chunk_size_ = dmlc::GetEnv("MXNET_KVSTORE_RING_CHUNK_SIZE", 1 << 20);
+    CHECK_GT(chunk_size_, 0) << "MXNET_KVSTORE_RING_CHUNK_SIZE must be positive";
+    const std::string algo = dmlc::GetEnv("MXNET_KVSTORE_AUTO_ALGO", std::string("auto"));
+    if (algo == "direct") {
+      forced_ = kDirect;
+    } else if (algo == "tree") {
+      forced_ = kTree;
+    } else if (algo == "ring") {
+      forced_ = kRing;
+    } else {
+      CHECK_EQ(algo, "auto") << "unknown MXNET_KVSTORE_AUTO_ALGO " << algo;
+    }
+  }
+
+  virtual ~CommDeviceAuto() {}
+
+  void Init(int key,
+            const NDArrayStorageType stype,
+            const mxnet::TShape& shape,
+            int dtype = mshadow::kFloat32) override {
+    direct_.Init(key, stype, shape, dtype);
+    if (probed_) {
+      Assign(key, stype, shape, dtype);
+    } else {
+      pending_.emplace_back(key, stype, shape, dtype);
+    }
+  }
+
+  const NDArray& Reduce(int key, const std::vector<NDArray>& src, int priority) override {
+    direct_.SetGradientCompression(gc_);
+    tree_.SetGradientCompression(gc_);
+    if (src.size() == 1) {
+      return src[0];
+    }
+    if (!probed_) {
+      Probe(src);
+    }
+    const bool compressed = gc_ != nullptr && gc_->get_type() != CompressionType::kNone;
+    if (compressed || src[0].storage_type() != kDefaultStorage || !SameDevices(src)) {
+      return direct_.Reduce(key, src, priority);
+    }
+    switch (algo_[key]) {
+      case kTree:
+        tree_started_ = true;
+        return tree_.Reduce(key, src, priority);
+      case kRing:
+        return RingReduce(key, src, priority);
+      default:
+        return direct_.Reduce(key, src, priority);
+    }
+  }
+
+  void Broadcast(int key,
+                 const NDArray& src,
+                 const std::vector<NDArray*> dst,
+                 int priority) override {
+    if (probed_ && src.storage_type() == kDefaultStorage && SameDevices(dst)) {
+      if (algo_[key] == kTree && tree_started_) {
+        tree_.Broadcast(key, src, dst, priority);
+        return;
+      }
+      if (algo_[key] == kRing) {
+        RingBroadcast(key, src, dst, priority);
+        return;
+      }
+    }
+    direct_.Broadcast(key, src, dst, priority);
+  }
+
+  void BroadcastRowSparse(int key,
+                          const NDArray& src,
+                          const std::vector<std::pair<NDArray*, NDArray>>& dst,
+                          const int priority) override {
+    direct_.BroadcastRowSparse(key, src, dst, priority);
+  }
+
+ private:
+  enum Algo { kDirect, kTree, kRing, kAuto };
+
+  using KeyAttrs = std::tuple<int, NDArrayStorageType, mxnet::TShape, int>;
+
+  /** \brief probe the links between the devices and assign the keys inited so far */
+  void Probe(const std::vector<NDArray>& src) {
+    probed_ = true;
+    for (const auto& a : src) {
+      devs_.push_back(a.ctx());
+    }
+    // enables peer access between the devices
+    direct_.InitBuffersAndComm(src);
+#if MXNET_USE_CUDA
+    const int n = devs_.size();
+    bool gpus   = true;
+    for (int i = 0; i < n; ++i) {
+      gpus = gpus && devs_[i].dev_mask() == gpu::kDevMask;
+      for (int j = 0; j < i; ++j) {
+        gpus = gpus && devs_[i] != devs_[j];
+      }
+    }
+    if (gpus) {
+      std::vector<int> p2p(n * n, 0);
+      for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+          if (i != j) {
+            cudaDeviceCanAccessPeer(&p2p[i * n + j], devs_[i].dev_id, devs_[j].dev_id);
+          }
+        }
+      }
+      std::vector<float> link(n * n);
+      GetP2PWeight(devs_, p2p, &link);
+      // NVLinks have a weight of at least 2, see GetP2PWeight
+      nvlink_tree_ = IsConnected(link, n);
+      nvlink_ring_ = FindRing(link, n, &ring_) >= 2;
+    }
+#endif
+    if (ring_.empty()) {
+      for (size_t i = 0; i < devs_.size(); ++i) {
+        ring_.push_back(i);
+      }
+    }
+    LOG(INFO) << "Topology aware reduction: tree " << (nvlink_tree_ ? "on" : "off")
+              << ", ring " << (nvlink_ring_ ? "on" : "off");
+    for (const auto& attrs : pending_) {
+      Assign(std::get<0>(attrs), std::get<1>(attrs), std::get<2>(attrs), std::get<3>(attrs));
+    }
+    pending_.clear();
+  }
+
+  /** \brief choose the reduction of a key, once the topology is known */
+  void Assign(int key, const NDArrayStorageType stype, const mxnet::TShape& shape, int dtype) {
+    const size_t size = shape.Size();
+    // the trees are built for the keys inited before the first tree reduction
+    const bool tree_ok = !tree_started_ && stype == kDefaultStorage;
+    Algo algo          = kDirect;
+    if (forced_ != kAuto) {
+      algo = forced_;
+    } else if (size >= ring_bound_ && nvlink_ring_) {
+      algo = kRing;
+    } else if (size >= tree_bound_ && nvlink_tree_) {
+      algo = kTree;
+    }
+    if (algo == kTree && !tree_ok) {
+      algo = nvlink_ring_ ? kRing : kDirect;
+    }
+    if (algo == kRing && size < devs_.size()) {
+      algo = kDirect;
+    }
+    if (algo == kTree) {
+      tree_.Init(key, stype, shape, dtype);
+    }
+    algo_[key] = algo;
+  }
+
+  /** \brief whether the arrays are on the probed devices, in the same order */
+  template <typename T>
+  bool SameDevices(const std::vector<T>& arrays) const {
+    if (arrays.size() != devs_.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < arrays.size(); ++i) {
+      if (Ctx(arrays[i]) != devs_[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static Context Ctx(const NDArray& a) {
+    return a.ctx();
+  }
+
+  static Context Ctx(const NDArray* a) {
+    return a->ctx();
+  }
+
+  /**
+   * \brief reduce-scatter along the ring, then gather the reduced segments.
+   *
+   * The key is split into one segment per device. The partial sum of segment s starts
+   * at device ring_[s] and moves along the ring, each device adding its value, so that
+   * after n - 1 steps it is complete at device ring_[s - 1]. Every device sends one
+   * segment and receives another one at each step, in chunks of chunk_size_ elements
+   * pipelined by the engine.
+   */
+  const NDArray& RingReduce(int key, const std::vector<NDArray>& src, int priority) {
+    const size_t n    = ring_.size();
+    const size_t size = src[0].shape().Size();
+    auto& buf         = ring_buf_[key];
+    if (buf.merged.is_none()) {
+      buf.bounds.resize(n + 1);
+      for (size_t s = 0; s <= n; ++s) {
+        buf.bounds[s] = size * s / n;
+      }
+      // one buffer per device and segment, so that the engine only orders the
+      // operations of the same segment on the same device
+      buf.partial.resize(n);
+      for (size_t d = 0; d < n; ++d) {
+        for (size_t s = 0; s < n; ++s) {
+          const mxnet::TShape shape(mshadow::Shape1(buf.bounds[s + 1] - buf.bounds[s]));
+          buf.partial[d].emplace_back(shape, devs_[d], false, src[0].dtype());
+        }
+      }
+      buf.merged = NDArray(src[0].shape(), devs_[ring_[key % n]], false, src[0].dtype());
+    }
+    const mxnet::TShape flat_shape(mshadow::Shape1(size));
+    std::vector<NDArray> flat;
+    for (const auto& a : src) {
+      flat.push_back(a.Reshape(flat_shape));
+    }
+    for (size_t step = 1; step < n; ++step) {
+      for (size_t s = 0; s < n; ++s) {
+        const int from     = ring_[(s + step - 1) % n];
+        const int to       = ring_[(s + step) % n];
+        const size_t begin = buf.bounds[s];
+        const size_t len   = buf.bounds[s + 1] - begin;
+        for (size_t c = 0; c < len; c += chunk_size_) {
+          const size_t end = std::min(len, c + chunk_size_);
+          NDArray recv     = buf.partial[to][s].Slice(c, end);
+          // the first step sends the value of the first device itself
+          CopyFromTo(step == 1 ? flat[from].Slice(begin + c, begin + end) :
+                                 buf.partial[from][s].Slice(c, end),
+                     &recv,
+                     priority);
+          recv += flat[to].Slice(begin + c, begin + end);
+        }
+      }
+    }
+    NDArray merged = buf.merged.Reshape(flat_shape);
+    for (size_t s = 0; s < n; ++s) {
+      NDArray part = merged.Slice(buf.bounds[s], buf.bounds[s + 1]);
+      CopyFromTo(buf.partial[ring_[(s + n - 1) % n]][s], &part, priority);
+    }
+    return buf.merged;
+  }
+
+  /**
+   * \brief copy src to a device, then along the ring in chunks, each device
+   * forwarding a chunk while it receives the next one.
+   */
+  void RingBroadcast(int key,
+                     const NDArray& src,
+                     const std::vector<NDArray*>& dst,
+                     int priority) {
+    const size_t n    = ring_.size();
+    const size_t size = src.shape().Size();
+    const size_t root = key % n;
+    CopyFromTo(src, dst[ring_[root]], priority);
+    const mxnet::TShape flat_shape(mshadow::Shape1(size));
+    std::vector<NDArray> flat;
+    for (const auto d : dst) {
+      flat.push_back(d->Reshape(flat_shape));
+    }
+    for (size_t c = 0; c < size; c += chunk_size_) {
+      const size_t end = std::min(size, c + chunk_size_);
+      for (size_t i = 1; i < n; ++i) {
+        NDArray part = flat[ring_[(root + i) % n]].Slice(c, end);
+        CopyFromTo(flat[ring_[(root + i - 1) % n]].Slice(c, end), &part, priority);
+      }
+    }
+  }
+
+  /** \brief buffers of a key reduced along the ring */
+  struct RingBufferEntry {
+    /** \brief start of the segment of each device, and the size of the key */
+    std::vector<size_t> bounds;
+    /** \brief partial sums of each segment on each device */
+    std::vector<std::vector<NDArray>> partial;
+    /** \brief the value reduced */
+    NDArray merged;
+  };
+
+  CommDevice direct_;
+  CommDeviceTree tree_;
+  /** \brief keys inited before the topology is probed */
+  std::vector<KeyAttrs> pending_;
+  std::unordered_map<int, Algo> algo_;
+  std::unordered_map<int, RingBufferEntry> ring_buf_;
+  std::vector<Context> devs_;
+  /** \brief order of the devices along the ring, as indices in devs_ */
+  std::vector<int> ring_;
+  bool probed_{false};
+  bool tree_started_{false};
+  bool nvlink_tree_{false};
+  bool nvlink_ring_{false};
+  Algo forced_{kAuto};
+  size_t tree_bound_;
+  size_t ring_bound_;
+  size_t chunk_size_;
+};
+
+}  // namespace kvstore
+}  // namespace mxnet
+#endif  // MXNET_KVSTORE_COMM_AUTO_H_
@@ -1166,6 +1166,68 @@ inline void ComputeTrees(const std::vector<T>& W,
     PrintMatrix("Links", adj, num_elements, num_elements);
   }
 }
+
+/**
+ * \brief Find a ring through all GPUs whose slowest link is as fast as possible,
+ *        ties broken by the total weight of the ring
+ * \param W is the link topology matrix
+ * \param num_elements is the number of GPUs
+ * \param ring stores the order of the GPUs along the ring, starting from GPU 0
+ * \return the weight of the slowest link of the ring
+ *
+ * The search is exhaustive up to 8 GPUs, i.e. 5040 rings, and greedy beyond,
+ * following the fastest link to a GPU not yet visited.
+ */
+template <typename T>
+inline T FindRing(const std::vector<T>& W, int num_elements, std::vector<int>* ring) {
+  auto ring_weight = [&](const std::vector<int>& order, T* total) {
+    T slowest = std::numeric_limits<T>::max();
+    *total    = 0;
+    for (int i = 0; i < num_elements; ++i) {
+      const T w = W[order[i] * num_elements + order[(i + 1) % num_elements]];
+      slowest   = std::min(slowest, w);
+      *total += w;
+    }
+    return slowest;
+  };
+  std::vector<int> order(num_elements);
+  for (int i = 0; i < num_elements; ++i)
+    order[i] = i;
+  if (num_elements <= 8) {
+    T best_total;
+    T best_slowest = ring_weight(order, &best_total);
+    *ring          = order;
+    while (std::next_permutation(order.begin() + 1, order.end())) {
+      T total;
+      const T slowest = ring_weight(order, &total);
+      if (slowest > best_slowest || (slowest == best_slowest && total > best_total)) {
+        best_slowest = slowest;
+        best_total   = total;
+        *ring        = order;
+      }
+    }
+  } else {
+    std::vector<bool> visited(num_elements, false);
+    visited[0] = true;
+    for (int i = 1; i < num_elements; ++i) {
+      const int prev = order[i - 1];
+      int next       = -1;
+      for (int j = 0; j < num_elements; ++j) {
+        if (visited[j])
+          continue;
+        if (next == -1 || W[prev * num_elements + j] > W[prev * num_elements + next])
+          next = j;
+      }
+      visited[next] = true;
+      order[i]      = next;
+    }
+    *ring = order;
+  }
+  if (kLogTree)
+    PrintVector("Ring", *ring);
+  T total;
+  return ring_weight(*ring, &total);
+}
 }  // namespace kvstore
 }  // namespace mxnet
 #endif  // MXNET_KVSTORE_GPU_TOPOLOGY_H_
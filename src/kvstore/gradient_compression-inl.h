@@ -44,6 +44,19 @@ void Quantize2BitImpl(mshadow::Stream<mshadow::gpu>* s,
 void Dequantize2BitImpl(mshadow::Stream<mshadow::gpu>* s,
                         const std::vector<mxnet::TBlob>& inputs,
                         const float threshold);
+void QuantizeFP16Impl(mshadow::Stream<mshadow::gpu>* s, const std::vector<mxnet::TBlob>& inputs);
+void DequantizeFP16Impl(mshadow::Stream<mshadow::gpu>* s, const std::vector<mxnet::TBlob>& inputs);
+void QuantizeBF16Impl(mshadow::Stream<mshadow::gpu>* s, const std::vector<mxnet::TBlob>& inputs);
+void DequantizeBF16Impl(mshadow::Stream<mshadow::gpu>* s, const std::vector<mxnet::TBlob>& inputs);
+void QuantizeTopKImpl(mshadow::Stream<mshadow::gpu>* s,
+                      const std::vector<mxnet::TBlob>& inputs,
+                      const int block_size);
+void DequantizeTopKImpl(mshadow::Stream<mshadow::gpu>* s,
+                        const std::vector<mxnet::TBlob>& inputs,
+                        const int block_size);
+void DequantizeAddTopKImpl(mshadow::Stream<mshadow::gpu>* s,
+                           const std::vector<mxnet::TBlob>& inputs,
+                           const int block_size);
 
 struct quantize_1bit {
   MSHADOW_XINLINE static void Map(int out_byte_id,
@@ -232,6 +245,168 @@ void Dequantize2BitKernelLaunch(mshadow::Stream<xpu>* s,
       threshold);               // positive threshold
 }
 
+/*!
+ * \brief casts the gradients to a 16 bit float type, DType is half_t or bf16_t.
+ * The value of position i is stored in the i-th 16 bit word of the compressed array,
+ * and the rounding error is kept in the residual, which is added to the next gradient.
+ * Each position is independent, so that the kernel vectorizes.
+ */
+template <typename DType>
+struct quantize_cast {
+  MSHADOW_XINLINE static void Map(int i, DType* out, const float* grad, float* residual) {
+    const float val = residual[i] + grad[i];
+    out[i]          = DType(val);
+    residual[i]     = val - static_cast<float>(out[i]);
+  }
+};
+
+template <typename DType, typename xpu>
+void QuantizeCastKernelLaunch(mshadow::Stream<xpu>* s, const std::vector<mxnet::TBlob>& inputs) {
+  mxnet::op::mxnet_op::Kernel<quantize_cast<DType>, xpu>::Launch(
+      s,
+      inputs[0].Size(),                           // original size
+      reinterpret_cast<DType*>(inputs[2].dptr_),  // compressed array
+      inputs[0].dptr<float>(),                    // original array
+      inputs[1].dptr<float>());                   // residual array
+}
+
+template <typename DType>
+struct dequantize_cast {
+  MSHADOW_XINLINE static void Map(int i, float* out, const DType* in) {
+    out[i] = static_cast<float>(in[i]);
+  }
+};
+
+template <typename DType, typename xpu>
+void DequantizeCastKernelLaunch(mshadow::Stream<xpu>* s, const std::vector<mxnet::TBlob>& inputs) {
+  mxnet::op::mxnet_op::Kernel<dequantize_cast<DType>, xpu>::Launch(
+      s,
+      inputs[1].Size(),                                  // original size
+      inputs[1].dptr<float>(),                           // out array
+      reinterpret_cast<const DType*>(inputs[0].dptr_));  // compressed array
+}
+
+/*!
+ * \brief top-k sparsification with error feedback, by blocks.
+ * The original array is split into blocks of block_size values, and only the value of
+ * largest magnitude of each block is sent, so that k = size / block_size values are
+ * sent in total. Selecting within blocks, rather than over the whole array, keeps the
+ * compressed array a contiguous image of the original one, which the kvstore needs
+ * to slice it between the servers.
+ * Each block is encoded in 32 bits: the value as half_t in the low 16 bits and its
+ * index in the block in the high 16 bits. The values which are not sent, and the
+ * rounding error of the value sent, stay in the residual.
+ */
+struct quantize_topk {
+  MSHADOW_XINLINE static void Map(int block_id,
+                                  int original_size,
+                                  int block_size,
+                                  uint32_t* out,
+                                  const float* grad,
+                                  float* residual) {
+    // start and end are indices in original grad array
+    const int start = block_id * block_size;
+    const int end   = (start + block_size <= original_size) ? start + block_size : original_size;
+    if (start >= end) {
+      out[block_id] = 0;
+      return;
+    }
+    for (int i = start; i < end; ++i) {
+      residual[i] += grad[i];
+    }
+    int top       = start;
+    float top_mag = -1;
+    for (int i = start; i < end; ++i) {
+      const float mag = residual[i] >= 0 ? residual[i] : -residual[i];
+      if (mag > top_mag) {
+        top_mag = mag;
+        top     = i;
+      }
+    }
+    // values out of the range of half_t are sent in several rounds
+    const float kHalfMax = 65504;
+    const float top_val  = residual[top] > kHalfMax ?
+                              kHalfMax :
+                              (residual[top] < -kHalfMax ? -kHalfMax : residual[top]);
+    const mshadow::half::half_t val(top_val);
+    residual[top] -= static_cast<float>(val);
+    out[block_id] = (static_cast<uint32_t>(top - start) << 16) | val.half_;
+  }
+};
+
+template <typename xpu>
+void QuantizeTopKKernelLaunch(mshadow::Stream<xpu>* s,
+                              const std::vector<mxnet::TBlob>& inputs,
+                              const int block_size) {
+  mxnet::op::mxnet_op::Kernel<quantize_topk, xpu>::Launch(
+      s,
+      inputs[2].Size(),                              // number of blocks
+      inputs[0].Size(),                              // original size
+      block_size,                                    // block size
+      reinterpret_cast<uint32_t*>(inputs[2].dptr_),  // compressed array
+      inputs[0].dptr<float>(),                       // original array
+      inputs[1].dptr<float>());                      // residual array
+}
+
+/*! \brief decodes the value which a top-k block holds for position i, 0 if none */
+MSHADOW_XINLINE float DecodeTopK(const uint32_t* in, int i, int block_size) {
+  const uint32_t code = in[i / block_size];
+  if (static_cast<int>(code >> 16) != i % block_size) {
+    return 0;
+  }
+  return static_cast<float>(mshadow::half::half_t::Binary(code & 0xffff));
+}
+
+struct dequantize_topk {
+  MSHADOW_XINLINE static void Map(int i, float* out, const uint32_t* in, int block_size) {
+    out[i] = DecodeTopK(in, i, block_size);
+  }
+};
+
+template <typename xpu>
+void DequantizeTopKKernelLaunch(mshadow::Stream<xpu>* s,
+                                const std::vector<mxnet::TBlob>& inputs,
+                                const int block_size) {
+  mxnet::op::mxnet_op::Kernel<dequantize_topk, xpu>::Launch(
+      s,
+      inputs[1].Size(),                                    // original size
+      inputs[1].dptr<float>(),                             // out array
+      reinterpret_cast<const uint32_t*>(inputs[0].dptr_),  // compressed array
+      block_size);                                         // block size
+}
+
+/*!
+ * \brief adds the values of the top-k blocks to out, without decompressing them
+ * into a dense array first. There is one value per block, so that this touches
+ * size / block_size positions of out.
+ */
+struct dequantize_add_topk {
+  MSHADOW_XINLINE static void Map(int block_id,
+                                  int original_size,
+                                  int block_size,
+                                  float* out,
+                                  const uint32_t* in) {
+    const uint32_t code = in[block_id];
+    const int pos       = block_id * block_size + static_cast<int>(code >> 16);
+    if (pos < original_size) {
+      out[pos] += static_cast<float>(mshadow::half::half_t::Binary(code & 0xffff));
+    }
+  }
+};
+
+template <typename xpu>
+void DequantizeAddTopKKernelLaunch(mshadow::Stream<xpu>* s,
+                                   const std::vector<mxnet::TBlob>& inputs,
+                                   const int block_size) {
+  mxnet::op::mxnet_op::Kernel<dequantize_add_topk, xpu>::Launch(
+      s,
+      inputs[0].Size(),                                     // number of blocks
+      inputs[1].Size(),                                     // original size
+      block_size,                                           // block size
+      inputs[1].dptr<float>(),                              // out array
+      reinterpret_cast<const uint32_t*>(inputs[0].dptr_));  // compressed array
+}
+
 inline void Quantize1BitImpl(mshadow::Stream<mshadow::cpu>* s,
                              const std::vector<mxnet::TBlob>& inputs,
                              const float threshold) {
@@ -255,6 +430,43 @@ inline void Dequantize2BitImpl(mshadow::Stream<mshadow::cpu>* s,
                                const float threshold) {
   Dequantize2BitKernelLaunch(s, inputs, threshold);
 }
+inline void QuantizeFP16Impl(mshadow::Stream<mshadow::cpu>* s,
+                             const std::vector<mxnet::TBlob>& inputs) {
+  QuantizeCastKernelLaunch<mshadow::half::half_t>(s, inputs);
+}
+
+inline void DequantizeFP16Impl(mshadow::Stream<mshadow::cpu>* s,
+                               const std::vector<mxnet::TBlob>& inputs) {
+  DequantizeCastKernelLaunch<mshadow::half::half_t>(s, inputs);
+}
+
+inline void QuantizeBF16Impl(mshadow::Stream<mshadow::cpu>* s,
+                             const std::vector<mxnet::TBlob>& inputs) {
+  QuantizeCastKernelLaunch<mshadow::bfloat::bf16_t>(s, inputs);
+}
+
+inline void DequantizeBF16Impl(mshadow::Stream<mshadow::cpu>* s,
+                               const std::vector<mxnet::TBlob>& inputs) {
+  DequantizeCastKernelLaunch<mshadow::bfloat::bf16_t>(s, inputs);
+}
+
+inline void QuantizeTopKImpl(mshadow::Stream<mshadow::cpu>* s,
+                             const std::vector<mxnet::TBlob>& inputs,
+                             const int block_size) {
+  QuantizeTopKKernelLaunch(s, inputs, block_size);
+}
+
+inline void DequantizeTopKImpl(mshadow::Stream<mshadow::cpu>* s,
+                               const std::vector<mxnet::TBlob>& inputs,
+                               const int block_size) {
+  DequantizeTopKKernelLaunch(s, inputs, block_size);
+}
+
+inline void DequantizeAddTopKImpl(mshadow::Stream<mshadow::cpu>* s,
+                                  const std::vector<mxnet::TBlob>& inputs,
+                                  const int block_size) {
+  DequantizeAddTopKKernelLaunch(s, inputs, block_size);
+}
 }  // namespace kvstore
 }  // namespace mxnet
 
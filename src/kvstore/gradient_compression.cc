@@ -23,6 +23,7 @@
  * \author Rahul Huilgol
  */
 
+#include <cmath>
 #include <vector>
 #include "kvstore_local.h"
 #include "gradient_compression.h"
@@ -33,6 +34,66 @@ namespace kvstore {
 
 DMLC_REGISTER_PARAMETER(GradientCompressionParam);
 
+namespace {
+
+/*! \brief runs the quantization kernel of a compression type on the device of xpu */
+template <typename xpu>
+void QuantizeImpl(mshadow::Stream<xpu>* s,
+                  const std::vector<mxnet::TBlob>& inputs,
+                  const CompressionType type,
+                  const float threshold,
+                  const int block_size) {
+  switch (type) {
+    case CompressionType::kOneBit:
+      Quantize1BitImpl(s, inputs, threshold);
+      break;
+    case CompressionType::kTwoBit:
+      Quantize2BitImpl(s, inputs, threshold);
+      break;
+    case CompressionType::kFP16:
+      QuantizeFP16Impl(s, inputs);
+      break;
+    case CompressionType::kBF16:
+      QuantizeBF16Impl(s, inputs);
+      break;
+    case CompressionType::kTopK:
+      QuantizeTopKImpl(s, inputs, block_size);
+      break;
+    default:
+      LOG(FATAL) << "Unsupported quantization of type " << static_cast<int>(type);
+  }
+}
+
+/*! \brief runs the dequantization kernel of a compression type on the device of xpu */
+template <typename xpu>
+void DequantizeImpl(mshadow::Stream<xpu>* s,
+                    const std::vector<mxnet::TBlob>& inputs,
+                    const CompressionType type,
+                    const float threshold,
+                    const int block_size) {
+  switch (type) {
+    case CompressionType::kOneBit:
+      Dequantize1BitImpl(s, inputs, threshold);
+      break;
+    case CompressionType::kTwoBit:
+      Dequantize2BitImpl(s, inputs, threshold);
+      break;
+    case CompressionType::kFP16:
+      DequantizeFP16Impl(s, inputs);
+      break;
+    case CompressionType::kBF16:
+      DequantizeBF16Impl(s, inputs);
+      break;
+    case CompressionType::kTopK:
+      DequantizeTopKImpl(s, inputs, block_size);
+      break;
+    default:
+      LOG(FATAL) << "Unsupported dequantization of type " << static_cast<int>(type);
+  }
+}
+
+}  // namespace
+
 GradientCompression::GradientCompression() {
   type_ = CompressionType::kNone;
 }
@@ -46,6 +107,12 @@ void GradientCompression::SetParams(
   } else if (params.type == "2bit") {
     CHECK_GT(params.threshold, 0) << "threshold must be greater than 0 for two bit compression";
     SetTwoBitCompression(params.threshold);
+  } else if (params.type == "fp16") {
+    SetCastCompression(CompressionType::kFP16);
+  } else if (params.type == "bf16") {
+    SetCastCompression(CompressionType::kBF16);
+  } else if (params.type == "topk") {
+    SetTopKCompression(params.ratio);
   } else {
     LOG(FATAL) << "Unknown type for gradient compression " << params.type;
   }
@@ -69,11 +136,26 @@ void GradientCompression::SetTwoBitCompression(const float threshold) {
   threshold_ = threshold;
 }
 
+void GradientCompression::SetCastCompression(const CompressionType type) {
+  CHECK(type == CompressionType::kFP16 || type == CompressionType::kBF16)
+      << "Unsupported cast compression of type " << static_cast<int>(type);
+  type_ = type;
+}
+
+void GradientCompression::SetTopKCompression(const float ratio) {
+  CHECK(ratio > 0 && ratio <= 0.5) << "ratio must be in (0, 0.5] for topk compression";
+  // the index of the value sent is encoded in 16 bits
+  const int block_size = static_cast<int>(std::round(1 / ratio));
+  CHECK_LE(block_size, 1 << 16) << "ratio must be at least 1/65536 for topk compression";
+  type_       = CompressionType::kTopK;
+  block_size_ = block_size;
+}
+
 std::string GradientCompression::EncodeParams() {
   using namespace std;  // to reduce length of next line
   string rval = get_type_str();
   if (type_ != CompressionType::kNone) {
-    rval += "," + to_string(threshold_);
+    rval += "," + to_string(threshold_) + "," + to_string(block_size_);
   }
   return rval;
 }
@@ -87,6 +169,11 @@ void GradientCompression::DecodeParams(const std::string& s) {
       threshold_ = stof(elems[1]);
     }
   }
+  if (elems.size() > 2) {
+    if (!elems[2].empty()) {
+      block_size_ = stoi(elems[2]);
+    }
+  }
 }
 
 int GradientCompression::GetCompressionFactor() {
@@ -94,6 +181,10 @@ int GradientCompression::GetCompressionFactor() {
     return 32;
   } else if (type_ == CompressionType::kTwoBit) {
     return 16;
+  } else if (type_ == CompressionType::kFP16 || type_ == CompressionType::kBF16) {
+    return 2;
+  } else if (type_ == CompressionType::kTopK) {
+    return block_size_;
   } else {
     LOG(FATAL) << "Unsupported compression type: " << get_type_str();
     return 0;
@@ -112,67 +203,37 @@ void GradientCompression::Quantize(const mxnet::NDArray& from,
   CHECK(shape_is_known(from.shape())) << "source operand has undefined shape";
   CHECK(shape_is_known(to->shape())) << "destination operand has undefined shape";
   CHECK(shape_is_known(residual->shape())) << "residual operand has undefined shape";
-  const int a           = from.ctx().dev_mask();
-  const int b           = to->ctx().dev_mask();
-  const float threshold = threshold_;
+  const int a                = from.ctx().dev_mask();
+  const int b                = to->ctx().dev_mask();
+  const CompressionType type = type_;
+  const float threshold      = threshold_;
+  const int block_size       = block_size_;
   if (a == mshadow::cpu::kDevMask && b == mshadow::cpu::kDevMask) {
-    if (type_ == CompressionType::kOneBit) {
-      mxnet::Engine::Get()->PushSync(
-          [from, to, residual, threshold](mxnet::RunContext ctx) {
-            std::vector<mxnet::TBlob> inputs = {from.data(), residual->data(), to->data()};
-            Quantize1BitImpl(ctx.get_stream<mshadow::cpu>(), inputs, threshold);
-          },
-          from.ctx(),
-          {from.var()},
-          {to->var(), residual->var()},
-          mxnet::FnProperty::kNormal,
-          priority,
-          "QuantizeCPU");
-    } else if (type_ == CompressionType::kTwoBit) {
+    mxnet::Engine::Get()->PushSync(
+        [from, to, residual, type, threshold, block_size](mxnet::RunContext ctx) {
+          std::vector<mxnet::TBlob> inputs = {from.data(), residual->data(), to->data()};
+          QuantizeImpl(ctx.get_stream<mshadow::cpu>(), inputs, type, threshold, block_size);
+        },
+        from.ctx(),
+        {from.var()},
+        {to->var(), residual->var()},
+        mxnet::FnProperty::kNormal,
+        priority,
+        "QuantizeCPU");
+  } else {
+    if (a == mshadow::gpu::kDevMask && b == mshadow::gpu::kDevMask) {
+#if MXNET_USE_CUDA
       mxnet::Engine::Get()->PushSync(
-          [from, to, residual, threshold](mxnet::RunContext ctx) {
+          [from, to, residual, type, threshold, block_size](mxnet::RunContext ctx) {
             std::vector<mxnet::TBlob> inputs = {from.data(), residual->data(), to->data()};
-            Quantize2BitImpl(ctx.get_stream<mshadow::cpu>(), inputs, threshold);
+            QuantizeImpl(ctx.get_stream<mshadow::gpu>(), inputs, type, threshold, block_size);
           },
           from.ctx(),
           {from.var()},
           {to->var(), residual->var()},
           mxnet::FnProperty::kNormal,
           priority,
-          "QuantizeCPU");
-    } else {
-      LOG(FATAL) << "Unsupported quantization of type " << get_type_str();
-    }
-  } else {
-    if (a == mshadow::gpu::kDevMask && b == mshadow::gpu::kDevMask) {
-#if MXNET_USE_CUDA
-      if (type_ == CompressionType::kOneBit) {
-        mxnet::Engine::Get()->PushSync(
-            [from, to, residual, threshold](mxnet::RunContext ctx) {
-              std::vector<mxnet::TBlob> inputs = {from.data(), residual->data(), to->data()};
-              Quantize1BitImpl(ctx.get_stream<mshadow::gpu>(), inputs, threshold);
-            },
-            from.ctx(),
-            {from.var()},
-            {to->var(), residual->var()},
-            mxnet::FnProperty::kNormal,
-            priority,
-            "QuantizeGPU");
-      } else if (type_ == CompressionType::kTwoBit) {
-        mxnet::Engine::Get()->PushSync(
-            [from, to, residual, threshold](mxnet::RunContext ctx) {
-              std::vector<mxnet::TBlob> inputs = {from.data(), residual->data(), to->data()};
-              Quantize2BitImpl(ctx.get_stream<mshadow::gpu>(), inputs, threshold);
-            },
-            from.ctx(),
-            {from.var()},
-            {to->var(), residual->var()},
-            mxnet::FnProperty::kNormal,
-            priority,
-            "QuantizeGPU");
-      } else {
-        LOG(FATAL) << "Unsupported quantization of type " << get_type_str();
-      }
+          "QuantizeGPU");
 #else
       LOG(FATAL) << MXNET_GPU_NOT_ENABLED_ERROR;
 #endif
@@ -187,71 +248,89 @@ void GradientCompression::Dequantize(const mxnet::NDArray& from,
                                      const int priority) {
   CHECK(shape_is_known(from.shape())) << "source operand has undefined shape";
   CHECK(shape_is_known(to->shape())) << "destination operand has undefined shape";
-  const int a           = from.ctx().dev_mask();
-  const int b           = to->ctx().dev_mask();
-  const float threshold = threshold_;
+  const int a                = from.ctx().dev_mask();
+  const int b                = to->ctx().dev_mask();
+  const CompressionType type = type_;
+  const float threshold      = threshold_;
+  const int block_size       = block_size_;
   if (a == mshadow::cpu::kDevMask && b == mshadow::cpu::kDevMask) {
-    if (type_ == CompressionType::kOneBit) {
+    mxnet::Engine::Get()->PushSync(
+        [from, to, type, threshold, block_size](mxnet::RunContext ctx) {
+          std::vector<mxnet::TBlob> inputs = {from.data(), to->data()};
+          DequantizeImpl(ctx.get_stream<mshadow::cpu>(), inputs, type, threshold, block_size);
+        },
+        from.ctx(),
+        {from.var()},
+        {to->var()},
+        mxnet::FnProperty::kNormal,
+        priority,
+        "DequantizeCPU");
+  } else {
+    if (a == mshadow::gpu::kDevMask && b == mshadow::gpu::kDevMask) {
+#if MXNET_USE_CUDA
       mxnet::Engine::Get()->PushSync(
-          [from, to, threshold](mxnet::RunContext ctx) {
+          [from, to, type, threshold, block_size](mxnet::RunContext ctx) {
             std::vector<mxnet::TBlob> inputs = {from.data(), to->data()};
-            Dequantize1BitImpl(ctx.get_stream<mshadow::cpu>(), inputs, threshold);
+            DequantizeImpl(ctx.get_stream<mshadow::gpu>(), inputs, type, threshold, block_size);
+            // Wait GPU kernel to complete
+            ctx.get_stream<mshadow::gpu>()->Wait();
           },
           from.ctx(),
           {from.var()},
           {to->var()},
           mxnet::FnProperty::kNormal,
           priority,
-          "DequantizeCPU");
-    } else if (type_ == CompressionType::kTwoBit) {
+          "DequantizeGPU");
+#else
+      LOG(FATAL) << MXNET_GPU_NOT_ENABLED_ERROR;
+#endif
+    } else {
+      LOG(FATAL) << "Unknown device mask, from device mask " << a << " to device mask " << b;
+    }
+  }
+}
+
+bool GradientCompression::SupportsDequantizeAdd() {
+  return type_ == CompressionType::kTopK;
+}
+
+void GradientCompression::DequantizeAdd(const mxnet::NDArray& from,
+                                        mxnet::NDArray* to,
+                                        const int priority) {
+  CHECK(SupportsDequantizeAdd()) << "Unsupported dequantize add of type " << get_type_str();
+  CHECK(shape_is_known(from.shape())) << "source operand has undefined shape";
+  CHECK(shape_is_known(to->shape())) << "destination operand has undefined shape";
+  const int a          = from.ctx().dev_mask();
+  const int b          = to->ctx().dev_mask();
+  const int block_size = block_size_;
+  if (a == mshadow::cpu::kDevMask && b == mshadow::cpu::kDevMask) {
+    mxnet::Engine::Get()->PushSync(
+        [from, to, block_size](mxnet::RunContext ctx) {
+          std::vector<mxnet::TBlob> inputs = {from.data(), to->data()};
+          DequantizeAddTopKImpl(ctx.get_stream<mshadow::cpu>(), inputs, block_size);
+        },
+        from.ctx(),
+        {from.var()},
+        {to->var()},
+        mxnet::FnProperty::kNormal,
+        priority,
+        "DequantizeAddCPU");
+  } else {
+    if (a == mshadow::gpu::kDevMask && b == mshadow::gpu::kDevMask) {
+#if MXNET_USE_CUDA
       mxnet::Engine::Get()->PushSync(
-          [from, to, threshold](mxnet::RunContext ctx) {
+          [from, to, block_size](mxnet::RunContext ctx) {
             std::vector<mxnet::TBlob> inputs = {from.data(), to->data()};
-            Dequantize2BitImpl(ctx.get_stream<mshadow::cpu>(), inputs, threshold);
+            DequantizeAddTopKImpl(ctx.get_stream<mshadow::gpu>(), inputs, block_size);
+            // Wait GPU kernel to complete
+            ctx.get_stream<mshadow::gpu>()->Wait();
           },
           from.ctx(),
           {from.var()},
           {to->var()},
           mxnet::FnProperty::kNormal,
           priority,
-          "DequantizeCPU");
-    } else {
-      LOG(FATAL) << "Unsupported dequantization of type " << get_type_str();
-    }
-  } else {
-    if (a == mshadow::gpu::kDevMask && b == mshadow::gpu::kDevMask) {
-#if MXNET_USE_CUDA
-      if (type_ == CompressionType::kOneBit) {
-        mxnet::Engine::Get()->PushSync(
-            [from, to, threshold](mxnet::RunContext ctx) {
-              std::vector<mxnet::TBlob> inputs = {from.data(), to->data()};
-              Dequantize1BitImpl(ctx.get_stream<mshadow::gpu>(), inputs, threshold);
-              // Wait GPU kernel to complete
-              ctx.get_stream<mshadow::gpu>()->Wait();
-            },
-            from.ctx(),
-            {from.var()},
-            {to->var()},
-            mxnet::FnProperty::kNormal,
-            priority,
-            "DequantizeGPU");
-      } else if (type_ == CompressionType::kTwoBit) {
-        mxnet::Engine::Get()->PushSync(
-            [from, to, threshold](mxnet::RunContext ctx) {
-              std::vector<mxnet::TBlob> inputs = {from.data(), to->data()};
-              Dequantize2BitImpl(ctx.get_stream<mshadow::gpu>(), inputs, threshold);
-              // Wait GPU kernel to completes
-              ctx.get_stream<mshadow::gpu>()->Wait();
-            },
-            from.ctx(),
-            {from.var()},
-            {to->var()},
-            mxnet::FnProperty::kNormal,
-            priority,
-            "DequantizeGPU");
-      } else {
-        LOG(FATAL) << "Unsupported dequantization of type " << get_type_str();
-      }
+          "DequantizeAddGPU");
 #else
       LOG(FATAL) << MXNET_GPU_NOT_ENABLED_ERROR;
 #endif
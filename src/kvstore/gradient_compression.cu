@@ -50,5 +50,39 @@ void Dequantize2BitImpl(mshadow::Stream<gpu>* s,
                         const float threshold) {
   Dequantize2BitKernelLaunch(s, inputs, threshold);
 }
+
+void QuantizeFP16Impl(mshadow::Stream<gpu>* s, const std::vector<TBlob>& inputs) {
+  QuantizeCastKernelLaunch<mshadow::half::half_t>(s, inputs);
+}
+
+void DequantizeFP16Impl(mshadow::Stream<gpu>* s, const std::vector<TBlob>& inputs) {
+  DequantizeCastKernelLaunch<mshadow::half::half_t>(s, inputs);
+}
+
+void QuantizeBF16Impl(mshadow::Stream<gpu>* s, const std::vector<TBlob>& inputs) {
+  QuantizeCastKernelLaunch<mshadow::bfloat::bf16_t>(s, inputs);
+}
+
+void DequantizeBF16Impl(mshadow::Stream<gpu>* s, const std::vector<TBlob>& inputs) {
+  DequantizeCastKernelLaunch<mshadow::bfloat::bf16_t>(s, inputs);
+}
+
+void QuantizeTopKImpl(mshadow::Stream<gpu>* s,
+                      const std::vector<TBlob>& inputs,
+                      const int block_size) {
+  QuantizeTopKKernelLaunch(s, inputs, block_size);
+}
+
+void DequantizeTopKImpl(mshadow::Stream<gpu>* s,
+                        const std::vector<TBlob>& inputs,
+                        const int block_size) {
+  DequantizeTopKKernelLaunch(s, inputs, block_size);
+}
+
+void DequantizeAddTopKImpl(mshadow::Stream<gpu>* s,
+                           const std::vector<TBlob>& inputs,
+                           const int block_size) {
+  DequantizeAddTopKKernelLaunch(s, inputs, block_size);
+}
 }  // namespace kvstore
 }  // namespace mxnet
@@ -34,16 +34,19 @@
 namespace mxnet {
 namespace kvstore {
 
-enum class CompressionType { kNone, kOneBit, kTwoBit };
+enum class CompressionType { kNone, kOneBit, kTwoBit, kFP16, kBF16, kTopK };
 
 struct GradientCompressionParam : public dmlc::Parameter<GradientCompressionParam> {
   std::string type;
   float threshold;
+  float ratio;
   DMLC_DECLARE_PARAMETER(GradientCompressionParam) {
     DMLC_DECLARE_FIELD(type).describe(
         "Type of gradient compression to use, like `2bit` for example");
     DMLC_DECLARE_FIELD(threshold).set_default(0.5).describe(
         "Threshold to use for 2bit gradient compression");
+    DMLC_DECLARE_FIELD(ratio).set_default(0.01).describe(
+        "Fraction of the gradient values sent by topk gradient compression");
   }
 };
 
@@ -82,6 +85,18 @@ class GradientCompression {
    */
   void SetTwoBitCompression(const float threshold);
 
+  /*!
+   * \brief sets gradient compression by casting to a 16 bit float type
+   * \param type kFP16 or kBF16
+   */
+  void SetCastCompression(const CompressionType type);
+
+  /*!
+   * \brief sets top-k gradient compression
+   * \param ratio fraction of the gradient values sent, one per block of 1 / ratio values
+   */
+  void SetTopKCompression(const float ratio);
+
   /*!
    * \brief encodes parameters of gc into a string
    */
@@ -126,6 +141,21 @@ class GradientCompression {
    */
   void Dequantize(const mxnet::NDArray& from, mxnet::NDArray* to, const int priority);
 
+  /*!
+   * \brief returns whether DequantizeAdd can add compressed data to an array without
+   * decompressing it first, i.e. touches only the positions actually sent
+   */
+  bool SupportsDequantizeAdd();
+
+  /*!
+   * \brief Issues operation adding the dequantized data of `from` to `to`
+   * Only supported when SupportsDequantizeAdd returns true
+   * \param from the ndarray containing quantized data
+   * \param to the target ndarray to which the dequantized data is added
+   * \param priority Priority of the action.
+   */
+  void DequantizeAdd(const mxnet::NDArray& from, mxnet::NDArray* to, const int priority);
+
  private:
   /*!
    * \brief denotes the type of gradient compression which has been set
@@ -138,6 +168,11 @@ class GradientCompression {
    * all negative gradients will be thresholded to -1*`threshold_`
    */
   float threshold_ = 0;
+
+  /*!
+   * \brief number of values of a block of top-k compression, of which one is sent
+   */
+  int block_size_ = 0;
 };
 }  // namespace kvstore
 }  // namespace mxnet
@@ -24,6 +24,7 @@
 #include <mxnet/kvstore.h>
 #include <dmlc/logging.h>
 #include "./kvstore_local.h"
+#include "./kvstore_dist_allreduce.h"
 
 #if MXNET_USE_DIST_KVSTORE
 #include "./kvstore_dist.h"
@@ -50,7 +51,10 @@ KVStore* KVStore::Create(const char* type_name) {
     use_device_comm = true;
   }
 
-  if (has("dist")) {
+  if (has("dist") && has("allreduce")) {
+    CHECK(!has("async")) << "Asynchronous update is not supported by allreduce";
+    kv = new kvstore::KVStoreDistAllreduce(use_device_comm);
+  } else if (has("dist")) {
 #if MXNET_USE_DIST_KVSTORE
     auto ps_type = dmlc::GetEnv("DMLC_PS_VAN_TYPE", std::string("none"));
     if (ps_type == "p3") {
@@ -23,13 +23,21 @@
  */
 #ifndef MXNET_KVSTORE_KVSTORE_DIST_H_
 #define MXNET_KVSTORE_KVSTORE_DIST_H_
+#include <atomic>
+#include <cstring>
+#include <functional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <algorithm>
+#include <memory>
 #include <utility>
 #include "./kvstore_local.h"
 #include "mxnet/engine.h"
 #include "ps/ps.h"
+#include "./kvstore_dist_fusion.h"
+#include "./kvstore_dist_row_cache.h"
+#include "./kvstore_dist_scheduler.h"
 #include "./kvstore_dist_server.h"
 namespace mxnet {
 namespace kvstore {
@@ -55,13 +63,37 @@ class KVStoreDist : public KVStoreLocal {
     }
     bigarray_bound_ = dmlc::GetEnv("MXNET_KVSTORE_BIGARRAY_BOUND", 1000 * 1000);
     log_verbose_    = dmlc::GetEnv("MXNET_KVSTORE_DIST_ROW_SPARSE_VERBOSE", false);
+    const size_t fusion_bound = dmlc::GetEnv("MXNET_KVSTORE_FUSION_BOUND", 0);
+    if (IsWorkerNode() && fusion_bound > 0) {
+      fusion_ = std::make_unique<KVStoreDistFusion>(
+          ps_worker_, fusion_bound, dmlc::GetEnv("MXNET_KVSTORE_FUSION_TIMEOUT", 2));
+    }
+    const size_t credit = dmlc::GetEnv("MXNET_KVSTORE_SCHEDULER_CREDIT", 0);
+    if (IsWorkerNode() && credit > 0) {
+      scheduler_ = std::make_unique<KVStoreDistScheduler>(credit);
+    }
+    row_cache_size_      = dmlc::GetEnv("MXNET_KVSTORE_ROW_CACHE_SIZE", 0);
+    row_cache_staleness_ = dmlc::GetEnv("MXNET_KVSTORE_ROW_CACHE_STALENESS", 1);
+    CHECK_GE(row_cache_staleness_, 0) << "MXNET_KVSTORE_ROW_CACHE_STALENESS must be non-negative";
+    elastic_ = dmlc::GetEnv("MXNET_KVSTORE_ELASTIC", false);
+    if (IsWorkerNode() && elastic_ && ps::Postoffice::Get()->is_recovery()) {
+      // a worker restarted in place of a dead one takes part again from the next merges
+      SendCommandToServers(static_cast<int>(CommandType::kWorkerJoin), "");
+    }
   }
 
   virtual ~KVStoreDist() {
     Engine::Get()->WaitForAll();
+    fusion_.reset();
     customer_id_ = 0;
     if (IsWorkerNode()) {
-      if (barrier_before_exit_) {
+      if (barrier_before_exit_ && elastic_) {
+        // rank 0 may have left, the servers stop once the workers left passed this barrier
+        if (!left_) {
+          const bool last = ps_worker_->get_customer()->customer_id() == 0;
+          SendCommandToServers(static_cast<int>(CommandType::kWorkerBarrier), last ? "exit" : "");
+        }
+      } else if (barrier_before_exit_) {
         Barrier();
         if (get_rank() == 0 && ps_worker_->get_customer()->customer_id() == 0) {
           // stop the executor at servers
@@ -100,11 +132,23 @@ class KVStoreDist : public KVStoreLocal {
   }
 
   void Barrier() override {
-    ps::Postoffice::Get()->Barrier(ps_worker_->get_customer()->customer_id(), ps::kWorkerGroup);
+    if (elastic_) {
+      // the barrier of ps-lite waits for all the workers, including those which left
+      SendCommandToServers(static_cast<int>(CommandType::kWorkerBarrier), "");
+    } else {
+      ps::Postoffice::Get()->Barrier(ps_worker_->get_customer()->customer_id(), ps::kWorkerGroup);
+    }
   }
 
   void SendCommandToServers(int cmd_id, const std::string& cmd_body) override {
     CHECK_NOTNULL(ps_worker_);
+    if (cmd_id == static_cast<int>(CommandType::kWorkerLeave) ||
+        cmd_id == static_cast<int>(CommandType::kWorkerJoin)) {
+      CHECK(elastic_) << "workers can only leave or join with MXNET_KVSTORE_ELASTIC=1";
+      // membership changes at iteration boundaries, once the pushes issued are answered
+      Engine::Get()->WaitForAll();
+      left_ = cmd_id == static_cast<int>(CommandType::kWorkerLeave);
+    }
     ps_worker_->Wait(ps_worker_->Request(cmd_id, cmd_body, ps::kServerGroup));
   }
 
@@ -196,7 +240,9 @@ class KVStoreDist : public KVStoreLocal {
     for (size_t i = 0; i < keys.size(); ++i) {
       InitKV(keys[i], values[i]);
     }
-    if (get_rank() == 0 && this->ps_worker_->get_customer()->customer_id() == 0) {
+    // a worker restarted in place of rank 0 pulls the values instead
+    if (get_rank() == 0 && this->ps_worker_->get_customer()->customer_id() == 0 &&
+        !ps::Postoffice::Get()->is_recovery()) {
       Push_(keys, values, 0, false);
       // wait until the push is finished
       for (const int key : keys) {
@@ -322,13 +368,24 @@ class KVStoreDist : public KVStoreLocal {
       }
       auto& target_val_rowids = grouped_val_rowids[i];
       const size_t num_vals   = target_val_rowids.size();
+      // the rows wanted by several devices are pulled once
+      NDArray indices;
+      if (num_vals > 1) {
+        indices = Unique(ConcatRowIds(target_val_rowids, priority), pinned_ctx_, 0);
+      }
       for (size_t i = 0; i < num_vals; i++) {
         auto& row_id                = target_val_rowids[i].second;
         target_val_rowids[i].second = Unique(row_id, pinned_ctx_, 0);
       }
-      CHECK_EQ(num_vals, 1) << "RowSparsePull with multiple values is not supported yet";
-      NDArray& indices = target_val_rowids[0].second;
+      if (num_vals == 1) {
+        indices = target_val_rowids[0].second;
+      }
       PullRowSparse_(key, recv_buf, indices, priority);
+      if (num_vals > 1) {
+        // each device retains its own rows from the union pulled
+        comm_->BroadcastRowSparse(key, recv_buf, target_val_rowids, priority);
+        continue;
+      }
       // The recv_buf contains values pulled from remote server with unique indices.
       // Directly broadcast w/o rowids if num_vals == 1
       auto get_val = [](const std::pair<NDArray*, NDArray>& p) { return p.first; };
@@ -339,6 +396,28 @@ class KVStoreDist : public KVStoreLocal {
     }
   }
 
+  /** \brief concatenate the row ids of several values into an array in pinned memory */
+  NDArray ConcatRowIds(const std::vector<std::pair<NDArray*, NDArray>>& val_rowids,
+                       int priority) {
+    const int dtype = val_rowids[0].second.dtype();
+    size_t total    = 0;
+    for (const auto& val_rowid : val_rowids) {
+      CHECK_EQ(val_rowid.second.dtype(), dtype) << "row_ids of a key must have the same dtype";
+      total += val_rowid.second.shape().Size();
+    }
+    NDArray concat(mxnet::TShape(mshadow::Shape1(total)), pinned_ctx_, true, dtype);
+    size_t begin = 0;
+    for (const auto& val_rowid : val_rowids) {
+      const size_t size = val_rowid.second.shape().Size();
+      if (size == 0)
+        continue;
+      NDArray part = concat.Slice(begin, begin + size).Reshape(val_rowid.second.shape());
+      CopyFromTo(val_rowid.second, &part, priority);
+      begin += size;
+    }
+    return concat;
+  }
+
   void Push_(const std::vector<int>& keys,
              const std::vector<NDArray>& values,
              int priority,
@@ -428,8 +507,13 @@ class KVStoreDist : public KVStoreLocal {
       char* data  = static_cast<char*>(small_buf.data().dptr_);
       // do push. false means no delete
       ps::SArray<char> vals(data, size, false);
-      int cmd = GetCommandType(RequestType::kCompressedPushPull, dtype);
-      CHECK_NOTNULL(ps_worker_)->ZPush(pskv.keys, vals, pskv.lens, cmd, [cb]() { cb(); });
+      int cmd   = GetCommandType(RequestType::kCompressedPushPull, dtype);
+      auto comm = profiler::ProfileComm::Start("KVStorePush", key, size);
+      CHECK_NOTNULL(ps_worker_)->ZPush(pskv.keys, vals, pskv.lens, cmd, [cb, comm]() {
+        if (comm)
+          comm->stop();
+        cb();
+      });
     };
     // acquire locks on both comm_buf and small_buf so that
     // pull (which uses comm_buf) for the same key waits till push finishes
@@ -443,18 +527,30 @@ class KVStoreDist : public KVStoreLocal {
   }
 
   virtual void PushDefault(int key, const NDArray& send_buf, const PSKV& pskv, int priority) {
-    auto push_to_servers = [this, key, pskv, send_buf](RunContext rctx,
-                                                       Engine::CallbackOnStart on_start,
-                                                       Engine::CallbackOnComplete cb) {
+    auto push_to_servers = [this, key, pskv, send_buf, priority](RunContext rctx,
+                                                                 Engine::CallbackOnStart on_start,
+                                                                 Engine::CallbackOnComplete cb) {
       on_start();
       const int dtype = send_buf.dtype();
       // convert to ps keys
       const size_t size = send_buf.shape().Size() * mshadow::mshadow_sizeof(dtype);
       char* data        = static_cast<char*>(send_buf.data().dptr_);
-      // do push. false means no delete
-      ps::SArray<char> vals(data, size, false);
       int cmd = GetCommandType(RequestType::kDefaultPushPull, dtype);
-      CHECK_NOTNULL(ps_worker_)->ZPush(pskv.keys, vals, pskv.lens, cmd, [cb]() { cb(); });
+      if (fusion_ != nullptr && pskv.keys.size() == 1 && fusion_->Fusable(size)) {
+        fusion_->Add(KVStoreDistFusion::Mode::kPush, cmd, {pskv.keys[0], pskv.lens[0], data, cb});
+        return;
+      }
+      auto comm    = profiler::ProfileComm::Start("KVStorePush", key, size);
+      auto request = [this, data, cmd, priority](const ps::SArray<ps::Key>& keys,
+                                                 const ps::SArray<int>& lens,
+                                                 size_t offset,
+                                                 size_t bytes,
+                                                 const std::function<void()>& done) {
+        // do push. false means no delete
+        ps::SArray<char> vals(data + offset, bytes, false);
+        CHECK_NOTNULL(ps_worker_)->ZPush(keys, vals, lens, cmd, done, priority);
+      };
+      Schedule(pskv, priority, cb, comm, request);
     };
     Engine::Get()->PushAsync(push_to_servers,
                              pinned_ctx_,
@@ -487,7 +583,12 @@ class KVStoreDist : public KVStoreLocal {
       }
       ps::SArray<char> vals(data, size * num_bytes, false);
       const int cmd = GetCommandType(RequestType::kRowSparsePushPull, send_buf.dtype());
-      CHECK_NOTNULL(ps_worker_)->ZPush(pskv.keys, vals, pskv.lens, cmd, [cb]() { cb(); });
+      auto comm     = profiler::ProfileComm::Start("KVStorePush", key, size * num_bytes);
+      CHECK_NOTNULL(ps_worker_)->ZPush(pskv.keys, vals, pskv.lens, cmd, [cb, comm]() {
+        if (comm)
+          comm->stop();
+        cb();
+      });
     };
     Engine::Get()->PushAsync(push_to_servers,
                              pinned_ctx_,
@@ -499,9 +600,9 @@ class KVStoreDist : public KVStoreLocal {
   }
 
   virtual void PullDefault(int key, const NDArray& recv_buf, int priority) {
-    auto pull_from_servers = [this, key, recv_buf](RunContext rctx,
-                                                   Engine::CallbackOnStart on_start,
-                                                   Engine::CallbackOnComplete cb) {
+    auto pull_from_servers = [this, key, recv_buf, priority](RunContext rctx,
+                                                             Engine::CallbackOnStart on_start,
+                                                             Engine::CallbackOnComplete cb) {
       on_start();
       // convert to ps keys
       size_t size         = recv_buf.shape().Size();
@@ -511,17 +612,32 @@ class KVStoreDist : public KVStoreLocal {
                        EncodeDefaultKey(key, size, num_bytes) :
                        EncodeCompressedKey(key, size, false, num_bytes);
       char* data = static_cast<char*>(recv_buf.data().dptr_);
-      // false means not to delete data when SArray is deleted
-      auto vals = new ps::SArray<char>(data, size * num_bytes, false);
       // issue pull
       RequestType mode = (gradient_compression_->get_type() != CompressionType::kNone) ?
                              RequestType::kCompressedPushPull :
                              RequestType::kDefaultPushPull;
       const int cmd = GetCommandType(mode, dtype);
-      CHECK_NOTNULL(ps_worker_)->ZPull(pskv.keys, vals, &pskv.lens, cmd, [vals, cb]() {
-        delete vals;
-        cb();
-      });
+      if (fusion_ != nullptr && mode == RequestType::kDefaultPushPull && pskv.keys.size() == 1 &&
+          fusion_->Fusable(size * num_bytes)) {
+        fusion_->Add(KVStoreDistFusion::Mode::kPull, cmd, {pskv.keys[0], pskv.lens[0], data, cb});
+        return;
+      }
+      auto comm    = profiler::ProfileComm::Start("KVStorePull", key, size * num_bytes);
+      auto request = [this, data, cmd, priority](const ps::SArray<ps::Key>& keys,
+                                                 const ps::SArray<int>& lens,
+                                                 size_t offset,
+                                                 size_t bytes,
+                                                 const std::function<void()>& done) {
+        // false means not to delete data when SArray is deleted
+        auto vals     = new ps::SArray<char>(data + offset, bytes, false);
+        auto out_lens = new ps::SArray<int>(lens);
+        CHECK_NOTNULL(ps_worker_)->ZPull(keys, vals, out_lens, cmd, [vals, out_lens, done]() {
+          delete vals;
+          delete out_lens;
+          done();
+        }, priority);
+      };
+      Schedule(pskv, priority, cb, comm, request);
     };
 
     CHECK_NOTNULL(Engine::Get())
@@ -555,6 +671,13 @@ class KVStoreDist : public KVStoreLocal {
       const auto unit_len = recv_buf.shape().ProdShape(1, recv_buf.shape().ndim());
       const int64_t size  = num_rows * unit_len;
       const int num_bytes = mshadow::mshadow_sizeof(dtype);
+      const int cmd       = GetCommandType(RequestType::kRowSparsePushPull, recv_buf.dtype());
+      if (row_cache_size_ > 0) {
+        mshadow::Copy(recv_buf.aux_data(kIdx).FlatTo1D<cpu, int64_t>(),
+                      idx_data.FlatTo1D<cpu, int64_t>());
+        PullCachedRows(key, recv_buf, offsets, num_rows, unit_len, cmd, cb);
+        return;
+      }
       // convert to ps keys in row sparse format
       PSKV& pskv = EncodeRowSparseKey(
           key, size, num_rows, offsets, unit_len, recv_buf.shape()[0], num_bytes);
@@ -562,15 +685,17 @@ class KVStoreDist : public KVStoreLocal {
         LOG(INFO) << "worker " << get_rank() << " pull lens: " << pskv.lens
                   << " keys: " << pskv.keys << " size: " << size;
       }
-      auto vals     = new ps::SArray<char>(data, size * num_bytes, false);
-      const int cmd = GetCommandType(RequestType::kRowSparsePushPull, recv_buf.dtype());
+      auto vals = new ps::SArray<char>(data, size * num_bytes, false);
       // copy indices to recv_buf. this needs to be done before ZPull
       // because after pull is done, the callback function returns and locks are released.
       // at this point, later functions may access the indices variable while copy happens
       mshadow::Copy(recv_buf.aux_data(kIdx).FlatTo1D<cpu, int64_t>(),
                     idx_data.FlatTo1D<cpu, int64_t>());
-      CHECK_NOTNULL(ps_worker_)->ZPull(pskv.keys, vals, &pskv.lens, cmd, [vals, cb]() {
+      auto comm = profiler::ProfileComm::Start("KVStorePull", key, size * num_bytes);
+      CHECK_NOTNULL(ps_worker_)->ZPull(pskv.keys, vals, &pskv.lens, cmd, [vals, cb, comm]() {
         delete vals;
+        if (comm)
+          comm->stop();
         cb();
       });
     };
@@ -584,10 +709,71 @@ class KVStoreDist : public KVStoreLocal {
                     "KVStoreDistRowSparsePull");
   }
 
+  /**
+   * \brief pull the rows of a row_sparse key which are not in its cache, and fill
+   * recv_buf with the cached rows and the rows pulled. Runs in the pull operation.
+   */
+  void PullCachedRows(const int key,
+                      const NDArray& recv_buf,
+                      const int64_t* offsets,
+                      const size_t num_rows,
+                      const size_t unit_len,
+                      const int cmd,
+                      Engine::CallbackOnComplete cb) {
+    const int num_bytes    = mshadow::mshadow_sizeof(recv_buf.dtype());
+    const size_t row_bytes = unit_len * num_bytes;
+    mu_.lock();
+    auto& cache = row_caches_[key];
+    if (!cache) {
+      cache = std::make_unique<RowSparseCache>(row_cache_size_, row_cache_staleness_, row_bytes);
+    }
+    RowSparseCache* row_cache = cache.get();
+    mu_.unlock();
+    row_cache->NextRound();
+    char* data = static_cast<char*>(recv_buf.data().dptr_);
+    // positions in recv_buf, and ids, of the rows not cached
+    auto missed      = std::make_shared<std::vector<size_t>>();
+    auto missed_rows = std::make_shared<std::vector<int64_t>>();
+    for (size_t i = 0; i < num_rows; ++i) {
+      if (!row_cache->Get(offsets[i], data + i * row_bytes)) {
+        missed->push_back(i);
+        missed_rows->push_back(offsets[i]);
+      }
+    }
+    if (missed->empty()) {
+      cb();
+      return;
+    }
+    const size_t num_missed  = missed->size();
+    const int64_t total_rows = recv_buf.shape()[0];
+    PSKV& pskv               = EncodeRowSparseKey(key,
+                                                  num_missed * unit_len,
+                                                  num_missed,
+                                                  missed_rows->data(),
+                                                  unit_len,
+                                                  total_rows,
+                                                  num_bytes);
+    auto vals = new ps::SArray<char>(num_missed * row_bytes);
+    CHECK_NOTNULL(ps_worker_)
+        ->ZPull(pskv.keys,
+                vals,
+                &pskv.lens,
+                cmd,
+                [vals, data, row_bytes, row_cache, missed, missed_rows, cb]() {
+                  for (size_t j = 0; j < missed->size(); ++j) {
+                    const char* row = vals->data() + j * row_bytes;
+                    std::memcpy(data + (*missed)[j] * row_bytes, row, row_bytes);
+                    row_cache->Put((*missed_rows)[j], row);
+                  }
+                  delete vals;
+                  cb();
+                });
+  }
+
   virtual void PushPullDefault(int key, const NDArray& comm_buf, int priority) {
-    auto pushpull = [this, key, comm_buf](RunContext rctx,
-                                          Engine::CallbackOnStart on_start,
-                                          Engine::CallbackOnComplete cb) {
+    auto pushpull = [this, key, comm_buf, priority](RunContext rctx,
+                                                    Engine::CallbackOnStart on_start,
+                                                    Engine::CallbackOnComplete cb) {
       on_start();
       size_t size         = comm_buf.shape().Size();
       const int dtype     = comm_buf.dtype();
@@ -596,12 +782,27 @@ class KVStoreDist : public KVStoreLocal {
 
       PSKV& pskv = EncodeDefaultKey(key, size, num_bytes);
       char* data = static_cast<char*>(comm_buf.data().dptr_);
-      auto vals  = new ps::SArray<char>(data, size * num_bytes, false);
-
-      CHECK_NOTNULL(ps_worker_)->ZPushPull(pskv.keys, *vals, vals, &pskv.lens, cmd, [vals, cb]() {
-        delete vals;
-        cb();
-      });
+      if (fusion_ != nullptr && pskv.keys.size() == 1 && fusion_->Fusable(size * num_bytes)) {
+        fusion_->Add(
+            KVStoreDistFusion::Mode::kPushPull, cmd, {pskv.keys[0], pskv.lens[0], data, cb});
+        return;
+      }
+      auto comm    = profiler::ProfileComm::Start("KVStorePushPull", key, size * num_bytes);
+      auto request = [this, data, cmd, priority](const ps::SArray<ps::Key>& keys,
+                                                 const ps::SArray<int>& lens,
+                                                 size_t offset,
+                                                 size_t bytes,
+                                                 const std::function<void()>& done) {
+        auto vals     = new ps::SArray<char>(data + offset, bytes, false);
+        auto out_lens = new ps::SArray<int>(lens);
+        CHECK_NOTNULL(ps_worker_)->ZPushPull(
+            keys, *vals, vals, out_lens, cmd, [vals, out_lens, done]() {
+              delete vals;
+              delete out_lens;
+              done();
+            }, priority);
+      };
+      Schedule(pskv, priority, cb, comm, request);
     };
 
     CHECK_NOTNULL(Engine::Get())
@@ -614,6 +815,61 @@ class KVStoreDist : public KVStoreLocal {
                     "KVStoreDistDefaultStoragePushPull");
   }
 
+  /**
+   * \brief issues a ps-lite request of the given keys and lengths, on the bytes of the
+   *  value starting at offset, and calls done once it completes
+   */
+  typedef std::function<void(const ps::SArray<ps::Key>& keys,
+                             const ps::SArray<int>& lens,
+                             size_t offset,
+                             size_t bytes,
+                             const std::function<void()>& done)>
+      PSRequest;
+
+  /**
+   * \brief issue the requests of a key. Without a scheduler this is a single request of
+   *  all the parts of the key, which ps-lite slices by server. With a scheduler each
+   *  part is a request queued by priority, so that the parts of a large key of a back
+   *  layer do not hold up the keys of the front layers. comm, if not null, is stopped
+   *  once all the parts are done.
+   */
+  void Schedule(const PSKV& pskv,
+                int priority,
+                const Engine::CallbackOnComplete& cb,
+                const std::shared_ptr<profiler::ProfileComm>& comm,
+                const PSRequest& request) {
+    if (scheduler_ == nullptr) {
+      request(pskv.keys, pskv.lens, 0, pskv.size, [cb, comm]() {
+        if (comm)
+          comm->stop();
+        cb();
+      });
+      return;
+    }
+    const size_t n = pskv.keys.size();
+    auto remaining = std::make_shared<std::atomic<size_t>>(n);
+    size_t offset  = 0;
+    for (size_t i = 0; i < n; ++i) {
+      const ps::SArray<ps::Key> keys = pskv.keys.segment(i, i + 1);
+      const ps::SArray<int> lens     = pskv.lens.segment(i, i + 1);
+      const size_t bytes             = pskv.lens[i];
+      scheduler_->Submit(
+          priority, bytes,
+          [request, keys, lens, offset, bytes, remaining, cb, comm](
+              const std::function<void()>& release) {
+            request(keys, lens, offset, bytes, [release, remaining, cb, comm]() {
+              release();
+              if (--*remaining == 0) {
+                if (comm)
+                  comm->stop();
+                cb();
+              }
+            });
+          });
+      offset += bytes;
+    }
+  }
+
   /**
    * \brief check if the keys are all unique
    */
@@ -869,6 +1125,35 @@ class KVStoreDist : public KVStoreLocal {
    */
   std::unordered_map<int, NDArray> residual_;
   bool log_verbose_;
+  /**
+   * \brief fuses the requests of small keys, set if MXNET_KVSTORE_FUSION_BOUND is positive
+   */
+  std::unique_ptr<KVStoreDistFusion> fusion_;
+  /**
+   * \brief orders the requests by priority, set if MXNET_KVSTORE_SCHEDULER_CREDIT is positive
+   */
+  std::unique_ptr<KVStoreDistScheduler> scheduler_;
+  /**
+   * \brief number of rows cached for each row_sparse key, 0 if MXNET_KVSTORE_ROW_CACHE_SIZE
+   * is not set
+   */
+  size_t row_cache_size_;
+  /**
+   * \brief number of pulls in which a cached row is served before being pulled again
+   */
+  int row_cache_staleness_;
+  /**
+   * \brief rows cached of each row_sparse key
+   */
+  std::unordered_map<int, std::unique_ptr<RowSparseCache>> row_caches_;
+  /**
+   * \brief whether workers may leave and join, set by MXNET_KVSTORE_ELASTIC
+   */
+  bool elastic_;
+  /**
+   * \brief whether this worker left the training
+   */
+  bool left_{false};
 };
 
 }  // namespace kvstore
@@ -0,0 +1,273 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file   kvstore_dist_allreduce.h
+ * @brief  distributed kvstore without servers, based on allreduce between workers
+ */
+#ifndef MXNET_KVSTORE_KVSTORE_DIST_ALLREDUCE_H_
+#define MXNET_KVSTORE_KVSTORE_DIST_ALLREDUCE_H_
+#include <mxnet/engine.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "./kvstore_local.h"
+#include "./ring_allreduce.h"
+
+namespace mxnet {
+namespace kvstore {
+
+/**
+ * \brief distributed kvstore where the workers allreduce the values they push.
+ *
+ * The reduction is hierarchical: the values of the devices of a worker are first
+ * reduced by comm_, on the devices for the "device" types, then the result is
+ * allreduced between the workers over a TCP ring, and pulls broadcast it back to the
+ * devices. Each worker holds a copy of all the values and applies the updater itself,
+ * so that no server process is needed.
+ *
+ * Collectives must run in the same order on all workers. They all write a common
+ * variable, so that the engine runs them in the order they are issued, which is the
+ * order of the calls of the training script, and they run on a thread of their own
+ * since they wait for the other workers.
+ */
+class KVStoreDistAllreduce : public KVStoreLocal {
+ public:
+  explicit KVStoreDistAllreduce(bool use_device_comm) : KVStoreLocal(use_device_comm) {
+    ring_ = std::make_unique<RingAllreduce>(
+        dmlc::GetEnv("DMLC_WORKER_ID", 0),
+        dmlc::GetEnv("DMLC_NUM_WORKER", 1),
+        dmlc::GetEnv("DMLC_PS_ROOT_URI", std::string("127.0.0.1")),
+        dmlc::GetEnv("DMLC_PS_ROOT_PORT", 9091),
+        dmlc::GetEnv("MXNET_KVSTORE_ALLREDUCE_TIMEOUT", 300));
+    ring_var_ = Engine::Get()->NewVariable();
+    thread_   = std::thread([this]() { RunCollectives(); });
+  }
+
+  virtual ~KVStoreDistAllreduce() {
+    Engine::Get()->WaitForAll();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+    Engine::Get()->DeleteVariable([](RunContext) {}, pinned_ctx_, ring_var_);
+  }
+
+  int get_rank() const override {
+    return ring_->rank();
+  }
+
+  int get_group_size() const override {
+    return ring_->size();
+  }
+
+  void Barrier() override {
+    Engine::Get()->PushAsync(
+        [this](RunContext rctx,
+               Engine::CallbackOnStart on_start,
+               Engine::CallbackOnComplete on_complete) {
+          on_start();
+          Enqueue([this]() { ring_->Barrier(kBarrierTag); }, on_complete);
+        },
+        pinned_ctx_,
+        {},
+        {ring_var_},
+        FnProperty::kNormal,
+        0,
+        "KVStoreDistAllreduceBarrier");
+    Engine::Get()->WaitForVar(ring_var_);
+  }
+
+ private:
+  void InitImpl(const std::vector<int>& keys, const std::vector<NDArray>& values) override {
+    for (size_t i = 0; i < keys.size(); ++i) {
+      CHECK(local_.find(keys[i]) == local_.end())
+          << "duplicate init of key " << keys[i]
+          << ". Please double check if you called kv.init or kv.broadcast with this key "
+          << "multiple times";
+      CHECK_EQ(values[i].storage_type(), kDefaultStorage)
+          << "dist_sync_allreduce kvstore only supports the default storage type";
+      local_[keys[i]] = values[i].Copy(pinned_ctx_);
+      comm_->Init(keys[i], values[i].storage_type(), values[i].shape(), values[i].dtype());
+      // all workers start from the values of worker 0
+      Collective(keys[i], local_[keys[i]], 0, false);
+    }
+    comm_->SetGradientCompression(gradient_compression_);
+  }
+
+  void PushImpl(const std::vector<int>& keys,
+                const std::vector<NDArray>& values,
+                int priority) override {
+    std::vector<int> uniq_keys;
+    std::vector<std::vector<NDArray>> grouped_vals;
+    GroupKVPairsPush(keys, values, &uniq_keys, &grouped_vals, false);
+    for (size_t i = 0; i < uniq_keys.size(); ++i) {
+      const int key          = uniq_keys[i];
+      const NDArray& reduced = Allreduce(key, grouped_vals[i], priority);
+      NDArray& local         = local_[key];
+      CHECK(!local.is_none()) << "key " << key << " has not been inited";
+      if (updater_ != nullptr) {
+        // every worker applies the same update to its copy of the value
+        if (key_type_ == kStringKey && str_updater_ != nullptr) {
+          str_updater_(reverse_str_key_dict_[key], reduced, &local);
+        } else {
+          updater_(key, reduced, &local);
+        }
+      } else {
+        CopyFromTo(reduced, &local, priority);
+      }
+    }
+  }
+
+  void PushPullImpl(const std::vector<int>& vkeys,
+                    const std::vector<int>& okeys,
+                    const std::vector<NDArray>& values,
+                    const std::vector<NDArray*>& outputs,
+                    int priority) override {
+    std::vector<int> uniq_vkeys;
+    std::vector<int> uniq_okeys;
+    std::vector<std::vector<NDArray>> grouped_vals;
+    std::vector<std::vector<NDArray*>> grouped_outs;
+
+    GroupKVPairsPush(vkeys, values, &uniq_vkeys, &grouped_vals, false);
+    GroupKVPairsPull(okeys, outputs, &uniq_okeys, &grouped_outs, true);
+    CHECK_EQ(uniq_vkeys.size(), uniq_okeys.size()) << "List of push and pull keys are different";
+
+    for (size_t i = 0; i < uniq_vkeys.size(); ++i) {
+      CHECK_EQ(uniq_vkeys[i], uniq_okeys[i]) << "Mismatch in push and pull key";
+      const int key = uniq_vkeys[i];
+      CHECK_EQ(grouped_vals[i][0].dtype(), grouped_outs[i][0]->dtype())
+          << "Output buffer dtype is different";
+      const NDArray& reduced = Allreduce(key, grouped_vals[i], priority);
+      comm_->Broadcast(key, reduced, grouped_outs[i], priority);
+    }
+  }
+
+  void PullRowSparseImpl(const std::vector<int>& keys,
+                         const std::vector<std::pair<NDArray*, NDArray>>& val_rowids,
+                         int priority = 0) override {
+    LOG(FATAL) << "dist_sync_allreduce kvstore does not support row_sparse_pull";
+  }
+
+  /**
+   * \brief reduce the values of a key over the devices then over the workers
+   * \return the buffer of the key in pinned memory holding the result
+   */
+  const NDArray& Allreduce(int key, const std::vector<NDArray>& vals, int priority) {
+    CHECK(gradient_compression_->get_type() == CompressionType::kNone)
+        << "Gradient compression is not supported by the dist_sync_allreduce kvstore";
+    const NDArray& merged = comm_->Reduce(key, vals, priority);
+    CHECK_EQ(merged.storage_type(), kDefaultStorage)
+        << "dist_sync_allreduce kvstore only supports the default storage type";
+    // the ring works on host memory, and must not modify the values pushed
+    auto& comm_buf = comm_buf_[key];
+    if (comm_buf.is_none()) {
+      comm_buf = NDArray(merged.shape(), pinned_ctx_, true, merged.dtype());
+    }
+    CopyFromTo(merged, &comm_buf, priority);
+    Collective(key, comm_buf, priority, true);
+    return comm_buf;
+  }
+
+  /** \brief allreduce, or broadcast from worker 0, an array in host memory */
+  void Collective(int key, const NDArray& buf, int priority, bool reduce) {
+    Engine::Get()->PushAsync(
+        [this, key, buf, reduce](RunContext rctx,
+                                 Engine::CallbackOnStart on_start,
+                                 Engine::CallbackOnComplete on_complete) {
+          on_start();
+          Enqueue(
+              [this, key, buf, reduce]() {
+                const TBlob& data = buf.data();
+                if (reduce) {
+                  MSHADOW_TYPE_SWITCH(data.type_flag_, DType, {
+                    ring_->Allreduce(key, data.dptr<DType>(), data.Size());
+                  });
+                } else {
+                  ring_->Broadcast(
+                      key, data.dptr_, data.Size() * mshadow::mshadow_sizeof(data.type_flag_));
+                }
+              },
+              on_complete);
+        },
+        pinned_ctx_,
+        {},
+        {buf.var(), ring_var_},
+        FnProperty::kNormal,
+        priority,
+        reduce ? "KVStoreDistAllreduce" : "KVStoreDistAllreduceBroadcast");
+  }
+
+  /** \brief run a collective on the thread of the collectives */
+  void Enqueue(std::function<void()> fn, Engine::CallbackOnComplete on_complete) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.emplace_back(std::move(fn), on_complete);
+    }
+    cv_.notify_one();
+  }
+
+  void RunCollectives() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+      if (queue_.empty())
+        return;
+      auto task = std::move(queue_.front());
+      queue_.pop_front();
+      lock.unlock();
+      try {
+        task.first();
+      } catch (dmlc::Error& err) {
+        task.second(&err);
+        lock.lock();
+        continue;
+      }
+      task.second();
+      lock.lock();
+    }
+  }
+
+  /** \brief tag of the barriers, distinct from the keys */
+  static constexpr uint64_t kBarrierTag = static_cast<uint64_t>(-1);
+
+  std::unique_ptr<RingAllreduce> ring_;
+  /** \brief written by all collectives, to run them in the order they are issued */
+  Engine::VarHandle ring_var_;
+  /** \brief buffer in pinned memory of the values of each key being reduced */
+  std::unordered_map<int, NDArray> comm_buf_;
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::pair<std::function<void()>, Engine::CallbackOnComplete>> queue_;
+  bool stop_{false};
+};
+
+}  // namespace kvstore
+}  // namespace mxnet
+#endif  // MXNET_KVSTORE_KVSTORE_DIST_ALLREDUCE_H_
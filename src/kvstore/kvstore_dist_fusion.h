@@ -0,0 +1,260 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file   kvstore_dist_fusion.h
+ * @brief  fusion of the requests of small keys of the distributed kvstore
+ */
+#ifndef MXNET_KVSTORE_KVSTORE_DIST_FUSION_H_
+#define MXNET_KVSTORE_KVSTORE_DIST_FUSION_H_
+#include <mxnet/engine.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "ps/ps.h"
+
+namespace mxnet {
+namespace kvstore {
+
+/**
+ * \brief packs the requests of small keys into requests of several keys.
+ *
+ * Requests are added by the engine operations of the keys, in the order in which
+ * their values become ready, e.g. the order in which backward completes gradients.
+ * They are gathered into buckets of up to `bound` bytes, and a bucket is sent as a
+ * single ps-lite request, which ps-lite splits into one message per server.
+ *
+ * The keys of a bucket are fixed once it is first sent, so that in the later rounds
+ * a bucket is sent as soon as its last key is added. A bucket waiting longer than
+ * `timeout_ms`, e.g. because one of its keys is not pushed in this round, is sent
+ * with the requests it holds.
+ */
+class KVStoreDistFusion {
+ public:
+  enum class Mode { kPush, kPull, kPushPull };
+
+  /** \brief request of a single ps key */
+  struct Request {
+    ps::Key key;
+    int len;
+    /** \brief values pushed, or destination of the values pulled */
+    char* data;
+    Engine::CallbackOnComplete on_complete;
+  };
+
+  KVStoreDistFusion(ps::KVWorker<char>* worker, size_t bound, int timeout_ms)
+      : worker_(worker), bound_(bound), timeout_(timeout_ms) {
+    flusher_ = std::thread([this]() { FlushExpired(); });
+  }
+
+  ~KVStoreDistFusion() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    flusher_.join();
+  }
+
+  /** \return whether the requests of a key of this many bytes are fused */
+  bool Fusable(size_t bytes) const {
+    return bytes < bound_;
+  }
+
+  /** \brief add a request, sent with the other requests of the same mode and command */
+  void Add(Mode mode, int cmd, const Request& request) {
+    std::vector<std::vector<Request>> ready;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      Group& group = groups_[std::make_pair(static_cast<int>(mode), cmd)];
+      auto it      = group.bucket_of.find(request.key);
+      int id;
+      if (it != group.bucket_of.end()) {
+        id = it->second;
+      } else {
+        if (group.open == -1) {
+          group.open = static_cast<int>(group.num_keys.size());
+          group.num_keys.push_back(0);
+          group.pending.emplace_back();
+        }
+        id                           = group.open;
+        group.bucket_of[request.key] = id;
+        ++group.num_keys[id];
+      }
+      Bucket& bucket = group.pending[id];
+      if (bucket.keys.count(request.key) != 0) {
+        // the key starts the next round before the bucket was complete
+        ready.push_back(Take(&group, id));
+      }
+      if (bucket.requests.empty()) {
+        bucket.start = std::chrono::steady_clock::now();
+      }
+      bucket.requests.push_back(request);
+      bucket.keys.insert(request.key);
+      bucket.bytes += request.len;
+      if (id == group.open ? bucket.bytes >= bound_ :
+                             bucket.requests.size() == group.num_keys[id]) {
+        ready.push_back(Take(&group, id));
+      }
+    }
+    for (auto& requests : ready) {
+      Send(mode, cmd, &requests);
+    }
+  }
+
+ private:
+  struct Bucket {
+    std::vector<Request> requests;
+    std::unordered_set<ps::Key> keys;
+    size_t bytes{0};
+    std::chrono::steady_clock::time_point start;
+  };
+
+  struct Group {
+    /** \brief bucket of each key */
+    std::unordered_map<ps::Key, int> bucket_of;
+    /** \brief number of keys of each bucket */
+    std::vector<size_t> num_keys;
+    /** \brief requests of each bucket waiting to be sent */
+    std::vector<Bucket> pending;
+    /** \brief bucket new keys are added to, -1 if none */
+    int open{-1};
+  };
+
+  /** \brief remove the requests of a bucket, lock is held */
+  static std::vector<Request> Take(Group* group, int id) {
+    if (id == group->open) {
+      group->open = -1;
+    }
+    Bucket& bucket = group->pending[id];
+    std::vector<Request> requests;
+    requests.swap(bucket.requests);
+    bucket.keys.clear();
+    bucket.bytes = 0;
+    return requests;
+  }
+
+  /** \brief body of the thread sending the buckets waiting longer than timeout_ */
+  void FlushExpired() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+      cv_.wait_for(lock, timeout_);
+      const auto now = std::chrono::steady_clock::now();
+      std::vector<std::pair<std::pair<int, int>, std::vector<Request>>> expired;
+      for (auto& kv : groups_) {
+        Group& group = kv.second;
+        for (size_t id = 0; id < group.pending.size(); ++id) {
+          const Bucket& bucket = group.pending[id];
+          if (!bucket.requests.empty() && now - bucket.start >= timeout_) {
+            expired.emplace_back(kv.first, Take(&group, static_cast<int>(id)));
+          }
+        }
+      }
+      if (expired.empty())
+        continue;
+      lock.unlock();
+      for (auto& e : expired) {
+        Send(static_cast<Mode>(e.first.first), e.first.second, &e.second);
+      }
+      lock.lock();
+    }
+  }
+
+  /** \brief send the requests of a bucket as one request of several keys */
+  void Send(Mode mode, int cmd, std::vector<Request>* requests) {
+    // ps-lite slices the keys of a request by server, they must be sorted
+    std::sort(requests->begin(), requests->end(), [](const Request& a, const Request& b) {
+      return a.key < b.key;
+    });
+    const size_t n = requests->size();
+    ps::SArray<ps::Key> keys(n);
+    auto lens    = new ps::SArray<int>(n);
+    size_t total = 0;
+    for (size_t i = 0; i < n; ++i) {
+      keys[i]    = (*requests)[i].key;
+      (*lens)[i] = (*requests)[i].len;
+      total += (*requests)[i].len;
+    }
+    ps::SArray<char> vals;
+    if (mode != Mode::kPull) {
+      vals.resize(total);
+      size_t offset = 0;
+      for (const Request& r : *requests) {
+        std::memcpy(vals.data() + offset, r.data, r.len);
+        offset += r.len;
+      }
+    }
+    if (mode == Mode::kPush) {
+      std::vector<Request> done;
+      done.swap(*requests);
+      CHECK_NOTNULL(worker_)->ZPush(
+          keys, vals, *lens, cmd, [done, vals, lens]() {
+            delete lens;
+            for (const Request& r : done) {
+              r.on_complete();
+            }
+          });
+      return;
+    }
+    // the values pulled are unpacked into the destination of each request
+    std::vector<Request> done;
+    done.swap(*requests);
+    auto out      = new ps::SArray<char>(total);
+    auto callback = [done, vals, out, lens]() {
+      size_t offset = 0;
+      for (const Request& r : done) {
+        std::memcpy(r.data, out->data() + offset, r.len);
+        offset += r.len;
+      }
+      delete out;
+      delete lens;
+      for (const Request& r : done) {
+        r.on_complete();
+      }
+    };
+    if (mode == Mode::kPull) {
+      CHECK_NOTNULL(worker_)->ZPull(keys, out, lens, cmd, callback);
+    } else {
+      CHECK_NOTNULL(worker_)->ZPushPull(keys, vals, out, lens, cmd, callback);
+    }
+  }
+
+  ps::KVWorker<char>* worker_;
+  /** \brief maximum number of bytes of a bucket */
+  size_t bound_;
+  std::chrono::milliseconds timeout_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  /** \brief buckets, by mode and command */
+  std::map<std::pair<int, int>, Group> groups_;
+  bool stop_{false};
+  std::thread flusher_;
+};
+
+}  // namespace kvstore
+}  // namespace mxnet
+#endif  // MXNET_KVSTORE_KVSTORE_DIST_FUSION_H_
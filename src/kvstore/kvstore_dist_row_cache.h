@@ -0,0 +1,114 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file   kvstore_dist_row_cache.h
+ * @brief  worker side cache of the rows pulled from row_sparse keys
+ */
+#ifndef MXNET_KVSTORE_KVSTORE_DIST_ROW_CACHE_H_
+#define MXNET_KVSTORE_KVSTORE_DIST_ROW_CACHE_H_
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace mxnet {
+namespace kvstore {
+
+/**
+ * \brief least recently used cache of the rows of a row_sparse key, of bounded staleness.
+ *
+ * Each pull of the key starts a round. A row pulled from the servers in a round is
+ * served from the cache in the next `staleness` rounds, then pulled again, so that
+ * the rows returned miss at most the updates of the last `staleness` rounds. This
+ * is worth it for embeddings, where a few hot rows are pulled in every iteration.
+ *
+ * The rows of a key are only accessed by the engine operations pulling the key,
+ * which run one at a time, so that the cache is not thread safe.
+ */
+class RowSparseCache {
+ public:
+  RowSparseCache(size_t capacity, int staleness, size_t row_bytes)
+      : capacity_(capacity), staleness_(staleness), row_bytes_(row_bytes) {}
+
+  /** \brief start the next pull of the key */
+  void NextRound() {
+    ++round_;
+  }
+
+  /** \brief copy a row into dst if it is cached and recent enough */
+  bool Get(int64_t row, char* dst) {
+    auto it = index_.find(row);
+    if (it == index_.end()) {
+      return false;
+    }
+    if (round_ - it->second->round > static_cast<uint64_t>(staleness_)) {
+      rows_.erase(it->second);
+      index_.erase(it);
+      return false;
+    }
+    rows_.splice(rows_.begin(), rows_, it->second);
+    std::memcpy(dst, it->second->data.data(), row_bytes_);
+    return true;
+  }
+
+  /** \brief cache a row pulled from the servers in this round */
+  void Put(int64_t row, const char* src) {
+    auto it = index_.find(row);
+    if (it != index_.end()) {
+      rows_.splice(rows_.begin(), rows_, it->second);
+    } else if (rows_.size() < capacity_) {
+      rows_.emplace_front();
+      rows_.front().data.resize(row_bytes_);
+      index_[row] = rows_.begin();
+    } else {
+      // reuse the buffer of the least recently used row
+      rows_.splice(rows_.begin(), rows_, std::prev(rows_.end()));
+      index_.erase(rows_.front().row);
+      index_[row] = rows_.begin();
+    }
+    Entry& entry = rows_.front();
+    entry.row    = row;
+    entry.round  = round_;
+    std::memcpy(entry.data.data(), src, row_bytes_);
+  }
+
+ private:
+  struct Entry {
+    int64_t row;
+    /** \brief round in which the row was pulled from the servers */
+    uint64_t round;
+    std::vector<char> data;
+  };
+
+  /** \brief maximum number of rows cached */
+  size_t capacity_;
+  int staleness_;
+  size_t row_bytes_;
+  uint64_t round_{0};
+  /** \brief rows, most recently used first */
+  std::list<Entry> rows_;
+  std::unordered_map<int64_t, std::list<Entry>::iterator> index_;
+};
+
+}  // namespace kvstore
+}  // namespace mxnet
+#endif  // MXNET_KVSTORE_KVSTORE_DIST_ROW_CACHE_H_
@@ -0,0 +1,114 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file   kvstore_dist_scheduler.h
+ * @brief  priority scheduling of the requests of the distributed kvstore
+ */
+#ifndef MXNET_KVSTORE_KVSTORE_DIST_SCHEDULER_H_
+#define MXNET_KVSTORE_KVSTORE_DIST_SCHEDULER_H_
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace mxnet {
+namespace kvstore {
+
+/**
+ * \brief schedules requests by priority within a budget of bytes in flight.
+ *
+ * ps-lite sends requests as soon as they are issued, so that a large request of a
+ * back layer issued first delays the requests of the front layers, which the next
+ * forward pass needs first. The scheduler instead queues the requests and issues
+ * the one of highest priority whenever the bytes in flight drop below the credit,
+ * so that urgent requests overtake the queued ones. A request larger than the
+ * credit is issued alone.
+ */
+class KVStoreDistScheduler {
+ public:
+  /** \brief a request, which calls the function it is given once it is complete */
+  typedef std::function<void(const std::function<void()>& release)> Task;
+
+  explicit KVStoreDistScheduler(size_t credit) : credit_(credit) {}
+
+  /** \brief queue a request of the given number of bytes, higher priorities first */
+  void Submit(int priority, size_t bytes, Task task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.push(Item{priority, next_seq_++, bytes, std::move(task)});
+    }
+    Dispatch();
+  }
+
+ private:
+  struct Item {
+    int priority;
+    uint64_t seq;
+    size_t bytes;
+    Task task;
+  };
+
+  /** \brief orders by decreasing priority, then by submission */
+  struct Later {
+    bool operator()(const Item& a, const Item& b) const {
+      return a.priority != b.priority ? a.priority < b.priority : a.seq > b.seq;
+    }
+  };
+
+  /** \brief issue the queued requests that fit in the credit */
+  void Dispatch() {
+    std::vector<Item> ready;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      while (!queue_.empty() &&
+             (in_flight_ == 0 || in_flight_ + queue_.top().bytes <= credit_)) {
+        in_flight_ += queue_.top().bytes;
+        ready.push_back(queue_.top());
+        queue_.pop();
+      }
+    }
+    for (Item& item : ready) {
+      const size_t bytes = item.bytes;
+      item.task([this, bytes]() { Release(bytes); });
+    }
+  }
+
+  /** \brief called when a request completes */
+  void Release(size_t bytes) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      in_flight_ -= bytes;
+    }
+    Dispatch();
+  }
+
+  /** \brief maximum number of bytes in flight */
+  size_t credit_;
+  size_t in_flight_{0};
+  uint64_t next_seq_{0};
+  std::mutex mutex_;
+  std::priority_queue<Item, std::vector<Item>, Later> queue_;
+};
+
+}  // namespace kvstore
+}  // namespace mxnet
+#endif  // MXNET_KVSTORE_KVSTORE_DIST_SCHEDULER_H_
@@ -26,13 +26,19 @@
 #include <mxnet/c_api.h>
 #include <mxnet/kvstore.h>
 #include <ps/ps.h>
+#include <atomic>
 #include <queue>
 #include <string>
 #include <mutex>
+#include <thread>
 #include <condition_variable>
 #include <memory>
 #include <functional>
 #include <future>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include "../profiler/profiler.h"
 #include "../operator/tensor/elemwise_binary_op-inl.h"
@@ -48,7 +54,10 @@ enum class CommandType {
   kStopServer,
   kSyncMode,
   kSetGradientCompression,
-  kSetProfilerParams
+  kSetProfilerParams,
+  kWorkerJoin,
+  kWorkerLeave,
+  kWorkerBarrier
 };
 
 enum class RequestType { kDefaultPushPull, kRowSparsePushPull, kCompressedPushPull };
@@ -136,6 +145,16 @@ class Executor {
     fut.wait();
   }
 
+  /**
+   * \brief let the thread called \ref Start to exec a function, without waiting for it. threadsafe
+   */
+  void Post(const Func& func) {
+    CHECK(func);
+    std::lock_guard<std::mutex> lk(mu_);
+    queue_.push(Block(func));
+    cond_.notify_one();
+  }
+
   /**
    * \brief stop the thread, threadsafe
    */
@@ -162,23 +181,38 @@ class KVStoreDistServer {
     static_cast<ps::SimpleApp*>(ps_server_)
         ->set_request_handle(std::bind(&KVStoreDistServer::CommandHandle, this, _1, _2));
     ps_server_->set_request_handle(std::bind(&KVStoreDistServer::DataHandleEx, this, _1, _2, _3));
-    sync_mode_            = false;
     gradient_compression_ = std::make_shared<GradientCompression>();
     log_verbose_          = dmlc::GetEnv("MXNET_KVSTORE_DIST_ROW_SPARSE_VERBOSE", false);
+    elastic_              = dmlc::GetEnv("MXNET_KVSTORE_ELASTIC", false);
+    const int num_threads = dmlc::GetEnv("MXNET_KVSTORE_SERVER_THREADS", 1);
+    CHECK_GT(num_threads, 0) << "MXNET_KVSTORE_SERVER_THREADS must be positive";
+    if (num_threads > 1) {
+      for (int i = 0; i < num_threads; ++i) {
+        shards_.emplace_back(new Executor());
+        Executor* shard = shards_.back().get();
+        shard_threads_.emplace_back([shard]() { shard->Start(); });
+      }
+    }
   }
 
   ~KVStoreDistServer() {
+    StopShards();
     profiler::Profiler::Get()->SetState(profiler::Profiler::ProfilerState(0));
     delete ps_server_;
   }
 
   void set_controller(const KVStore::Controller& controller) {
     CHECK(controller);
+    std::lock_guard<std::mutex> lock(store_mu_);
     controller_ = controller;
   }
 
+  /**
+   * \brief set by the controller on the main thread, while the shards may be handling pushes
+   */
   void set_updater(const KVStore::Updater& updater) {
     CHECK(updater);
+    std::lock_guard<std::mutex> lock(store_mu_);
     updater_ = updater;
   }
 
@@ -195,12 +229,21 @@ class KVStoreDistServer {
     NDArray merged;
     // temp_array is used to cast received values as float32 for computation if required
     NDArray temp_array;
+    /** \brief workers the merge waits for in elastic mode, set when it starts */
+    std::unordered_set<int> expected;
+    /** \brief pushes of workers that joined after the merge started, handled after it */
+    std::vector<std::function<void()>> parked;
+    /** \brief the last push merged, to answer the merge when a worker leaves */
+    DataHandleType type;
+    ps::KVPairs<char> req_data;
   };
 
   void CommandHandle(const ps::SimpleData& recved, ps::SimpleApp* app) {
     CommandType recved_type = static_cast<CommandType>(recved.head);
     switch (recved_type) {
       case CommandType::kStopServer:
+        // the requests queued on the shards may still use the main thread
+        StopShards();
         exec_.Stop();
         break;
       case CommandType::kSyncMode:
@@ -217,33 +260,192 @@ class KVStoreDistServer {
       case CommandType::kSetMultiPrecision:
         // uses value 1 for message id from frontend
         if (!multi_precision_) {
-          multi_precision_ = true;
+          // the shards only use the copies once they exist
           CreateMultiPrecisionCopies();
+          multi_precision_ = true;
         }
         break;
       case CommandType::kController:
         // this uses value 0 for message id from frontend
         // let the main thread to execute ctrl, which is necessary for python
         exec_.Exec([this, recved]() {
-          CHECK(controller_);
-          controller_(recved.head, recved.body);
+          KVStore::Controller controller;
+          {
+            std::lock_guard<std::mutex> lock(store_mu_);
+            controller = controller_;
+          }
+          CHECK(controller);
+          controller(recved.head, recved.body);
         });
         break;
+      case CommandType::kWorkerJoin: {
+        std::lock_guard<std::mutex> lock(members_mu_);
+        Members().insert(recved.sender);
+        break;
+      }
+      case CommandType::kWorkerLeave:
+        RemoveWorker(recved.sender);
+        break;
+      case CommandType::kWorkerBarrier:
+        if (HoldBarrier(recved))
+          return;
+        break;
     }
     app->Response(recved);
   }
 
+  /**
+   * \brief the node ids of the workers taking part in the training, all of them until
+   *  some leave. members_mu_ must be held.
+   */
+  std::unordered_set<int>& Members() {
+    if (!members_inited_) {
+      // the ids are only known once the server has started
+      const auto& ids = ps::Postoffice::Get()->GetNodeIDs(ps::kWorkerGroup);
+      members_.insert(ids.begin(), ids.end());
+      members_inited_ = true;
+    }
+    return members_;
+  }
+
+  /**
+   * \brief stop waiting for a worker which left, in the merges it has not pushed to yet
+   *  and in the barriers
+   */
+  void RemoveWorker(int sender) {
+    {
+      std::lock_guard<std::mutex> lock(members_mu_);
+      Members().erase(sender);
+    }
+    std::vector<int> keys;
+    {
+      std::lock_guard<std::mutex> lock(store_mu_);
+      for (const auto& entry : update_buf_) {
+        keys.push_back(entry.first);
+      }
+    }
+    for (const int key : keys) {
+      Dispatch(key, [this, key, sender]() {
+        UpdateBuf& updates = Lookup(&update_buf_, key);
+        if (updates.request.empty() || updates.expected.count(sender) == 0)
+          return;
+        for (const auto& req : updates.request) {
+          // the worker pushed to the merge before leaving
+          if (req.sender == sender)
+            return;
+        }
+        updates.expected.erase(sender);
+        ApplyUpdates(updates.type, key, updates.req_data, &updates, ps_server_);
+      });
+    }
+    bool stop = false;
+    {
+      std::lock_guard<std::mutex> lock(members_mu_);
+      stop = ReleaseBarrier();
+    }
+    if (stop) {
+      StopShards();
+      exec_.Stop();
+    }
+  }
+
+  /**
+   * \brief hold the barrier request of a worker until all the workers sent theirs
+   * \return false if the worker left, and is not waited for
+   */
+  bool HoldBarrier(const ps::SimpleData& recved) {
+    bool stop = false;
+    {
+      std::lock_guard<std::mutex> lock(members_mu_);
+      if (Members().count(recved.sender) == 0)
+        return false;
+      barrier_.push_back(recved);
+      stop = ReleaseBarrier();
+    }
+    // the last barrier of the workers stops the server, like kStopServer
+    if (stop) {
+      StopShards();
+      exec_.Stop();
+    }
+    return true;
+  }
+
+  /**
+   * \brief answer the barrier requests if all the workers sent one. members_mu_ must be held.
+   * \return whether it was the barrier the workers pass before exiting
+   */
+  bool ReleaseBarrier() {
+    if (barrier_.empty())
+      return false;
+    std::unordered_set<int> arrived;
+    for (const auto& req : barrier_) {
+      arrived.insert(req.sender);
+    }
+    for (const int member : Members()) {
+      if (arrived.count(member) == 0)
+        return false;
+    }
+    const bool exit = barrier_.front().body == "exit";
+    for (const auto& req : barrier_) {
+      static_cast<ps::SimpleApp*>(ps_server_)->Response(req);
+    }
+    barrier_.clear();
+    return exit;
+  }
+
+  /**
+   * \brief defer a push from a worker which joined after the merge of the key started,
+   *  to the next merge
+   * \return whether the push is deferred
+   */
+  bool ParkRequest(UpdateBuf* updates,
+                   const ps::KVMeta& req_meta,
+                   const std::function<void()>& handle) {
+    if (!elastic_ || !sync_mode_ || updates->request.empty() ||
+        updates->expected.count(req_meta.sender) != 0) {
+      return false;
+    }
+    updates->parked.push_back(handle);
+    return true;
+  }
+
+  /** \brief add a push to the merge of its key */
+  void AddRequest(const DataHandleType type,
+                  const ps::KVMeta& req_meta,
+                  const ps::KVPairs<char>& req_data,
+                  UpdateBuf* updates) {
+    if (elastic_) {
+      if (updates->request.empty()) {
+        std::lock_guard<std::mutex> lock(members_mu_);
+        updates->expected = Members();
+      }
+      // a worker which left still counts if it pushes
+      updates->expected.insert(req_meta.sender);
+      updates->type     = type;
+      updates->req_data = req_data;
+    }
+    updates->request.push_back(req_meta);
+  }
+
   /*
    * For keys already initialized, if necessary create stored_realt.
    * This will only be used if by some wrong usage of kvstore,
    * some keys are initialized before optimizer is set.
    */
   void CreateMultiPrecisionCopies() {
-    for (auto const& stored_entry : store_) {
-      const int key         = stored_entry.first;
-      const NDArray& stored = stored_entry.second;
+    // the shards may add keys meanwhile
+    std::vector<int> keys;
+    {
+      std::lock_guard<std::mutex> lock(store_mu_);
+      for (const auto& stored_entry : store_) {
+        keys.push_back(stored_entry.first);
+      }
+    }
+    std::vector<NDArray> copies;
+    for (const int key : keys) {
+      const NDArray& stored = Lookup(&store_, key);
       if (stored.dtype() != mshadow::kFloat32) {
-        auto& stored_realt = store_realt_[key];
+        auto& stored_realt = Lookup(&store_realt_, key);
         if (stored.storage_type() == kRowSparseStorage) {
           stored_realt =
               NDArray(kRowSparseStorage, stored.shape(), stored.ctx(), true, mshadow::kFloat32);
@@ -251,7 +453,7 @@ class KVStoreDistServer {
           stored_realt = NDArray(stored.shape(), stored.ctx(), false, mshadow::kFloat32);
         }
 
-        auto& update = update_buf_[key];
+        auto& update = Lookup(&update_buf_, key);
         if (!update.merged.is_none()) {
           if (update.merged.storage_type() == kRowSparseStorage) {
             update.merged = NDArray(kRowSparseStorage,
@@ -269,10 +471,11 @@ class KVStoreDistServer {
             << "Please set optimizer before pushing keys." << key << " " << update.request.size();
 
         CopyFromTo(stored, stored_realt);
+        copies.push_back(stored_realt);
       }
     }
-    for (auto const& stored_realt_entry : store_realt_) {
-      stored_realt_entry.second.WaitToRead();
+    for (const NDArray& stored_realt : copies) {
+      stored_realt.WaitToRead();
     }
   }
 
@@ -331,17 +534,67 @@ class KVStoreDistServer {
     DataHandleType type = DepairDataHandleType(req_meta.cmd);
     switch (type.requestType) {
       case RequestType::kRowSparsePushPull:
-        DataHandleRowSparse(type, req_meta, req_data, server);
+        // the first key is the master key of the rows
+        Dispatch(DecodeKey(req_data.keys[0]), [=]() {
+          DataHandleRowSparse(type, req_meta, req_data, server);
+        });
         break;
       case RequestType::kCompressedPushPull:
-        DataHandleCompressed(type, req_meta, req_data, server);
+        // pushes start with a dummy key holding the original size
+        Dispatch(DecodeKey(req_data.keys.back()), [=]() {
+          DataHandleCompressed(type, req_meta, req_data, server);
+        });
         break;
       case RequestType::kDefaultPushPull:
-        DataHandleDefault(type, req_meta, req_data, server);
+        if (req_data.keys.size() > 1) {
+          SplitFusedRequest(type, req_meta, req_data, server);
+        } else {
+          Dispatch(DecodeKey(req_data.keys[0]), [=]() {
+            DataHandleDefault(type, req_meta, req_data, server);
+          });
+        }
         break;
     }
   }
 
+  /**
+   * \brief handle a request of a key on the shard of the key, if the server has several
+   *  threads. The requests of a key are handled in order, by the same thread.
+   */
+  void Dispatch(int key, const std::function<void()>& handle) {
+    if (shards_.empty()) {
+      handle();
+    } else {
+      shards_[key % shards_.size()]->Post(handle);
+    }
+  }
+
+  void StopShards() {
+    for (auto& shard : shards_) {
+      shard->Stop();
+    }
+    for (auto& thread : shard_threads_) {
+      thread.join();
+    }
+    shards_.clear();
+    shard_threads_.clear();
+  }
+
+  /**
+   * \brief the value of a key, shards may add keys concurrently. References to the
+   *  values of an unordered_map stay valid when other keys are added.
+   */
+  template <typename V>
+  V& Lookup(std::unordered_map<int, V>* map, int key) {
+    std::lock_guard<std::mutex> lock(store_mu_);
+    return (*map)[key];
+  }
+
+  bool HasUpdater() {
+    std::lock_guard<std::mutex> lock(store_mu_);
+    return static_cast<bool>(updater_);
+  }
+
   inline bool has_multi_precision_copy(const DataHandleType type) {
     return multi_precision_ && type.dtype != mshadow::kFloat32;
   }
@@ -351,11 +604,16 @@ class KVStoreDistServer {
                            const ps::KVPairs<char>& req_data,
                            UpdateBuf* update_buf,
                            ps::KVServer<char>* server) {
-    if (!sync_mode_ || update_buf->request.size() == (size_t)ps::NumWorkers()) {
+    const size_t num_workers =
+        elastic_ ? update_buf->expected.size() : static_cast<size_t>(ps::NumWorkers());
+    if (!sync_mode_ || update_buf->request.size() == num_workers) {
       // let the main thread to execute updater_, which is necessary for python
-      auto& stored = has_multi_precision_copy(type) ? store_realt_[key] : store_[key];
-      auto& update = sync_mode_ ? update_buf->merged : update_buf->temp_array;
-      if (updater_) {
+      auto& stored =
+          has_multi_precision_copy(type) ? Lookup(&store_realt_, key) : Lookup(&store_, key);
+      auto& update       = sync_mode_ ? update_buf->merged : update_buf->temp_array;
+      const size_t bytes = update.shape().Size() * mshadow::mshadow_sizeof(update.dtype());
+      auto comm          = profiler::ProfileComm::Start("KVStoreServerUpdate", key, bytes);
+      if (HasUpdater()) {
         exec_.Exec([this, key, &update, &stored]() {
           CHECK(updater_);
           updater_(key, update, &stored);
@@ -365,6 +623,11 @@ class KVStoreDistServer {
         // if no updater, just copy
         CopyFromTo(update_buf->merged, &stored);
       }
+      if (comm) {
+        // the updater only pushes the operations updating the value
+        stored.WaitToRead();
+        comm->stop();
+      }
 
       if (log_verbose_) {
         LOG(INFO) << "sent response to " << update_buf->request.size() << " workers";
@@ -381,7 +644,7 @@ class KVStoreDistServer {
       if (has_pull) {
         // if there is a pull request, perform WaitToRead() once before DefaultStorageResponse
         if (has_multi_precision_copy(type))
-          CopyFromTo(stored, store_[key]);
+          CopyFromTo(stored, Lookup(&store_, key));
         stored.WaitToRead();
         for (const auto& req : update_buf->request) {
           if (req.pull) {
@@ -392,13 +655,18 @@ class KVStoreDistServer {
       } else {
         // otherwise, send response directly
         for (const auto& req : update_buf->request) {
-          server->Response(req);
+          Respond(req, key, ps::KVPairs<char>(), server);
         }
         update_buf->request.clear();
         if (has_multi_precision_copy(type))
-          CopyFromTo(stored, store_[key]);
+          CopyFromTo(stored, Lookup(&store_, key));
         stored.WaitToRead();
       }
+      std::vector<std::function<void()>> parked;
+      parked.swap(update_buf->parked);
+      for (const auto& handle : parked) {
+        handle();
+      }
     } else {
       update_buf->merged.WaitToRead();
     }
@@ -464,7 +732,7 @@ class KVStoreDistServer {
       server->Response(req_meta, response);
       return;
     }
-    const NDArray& stored = store_[master_key];
+    const NDArray& stored = Lookup(&store_, master_key);
     if (has_multi_precision_copy(type))
       stored.WaitToRead();
     CHECK(!stored.is_none()) << "init " << master_key << " first";
@@ -499,7 +767,8 @@ class KVStoreDistServer {
                            const ps::KVMeta& req_meta,
                            const ps::KVPairs<char>& req_data,
                            ps::KVServer<char>* server) {
-    auto& stored  = has_multi_precision_copy(type) ? store_realt_[master_key] : store_[master_key];
+    auto& stored  = has_multi_precision_copy(type) ? Lookup(&store_realt_, master_key) :
+                                                    Lookup(&store_, master_key);
     int dtype     = type.dtype;
     int num_bytes = mshadow::mshadow_sizeof(dtype);
     auto unit_len = req_data.lens[1] / num_bytes;
@@ -518,7 +787,7 @@ class KVStoreDistServer {
                      true,
                      has_multi_precision_copy(type) ? mshadow::kFloat32 : type.dtype);
     if (has_multi_precision_copy(type)) {
-      store_[master_key] = NDArray(kRowSparseStorage, dshape, Context(), true, type.dtype);
+      Lookup(&store_, master_key) = NDArray(kRowSparseStorage, dshape, Context(), true, type.dtype);
     }
     Engine::Get()->PushAsync(
         [this, recved, stored, type](RunContext ctx,
@@ -546,8 +815,8 @@ class KVStoreDistServer {
         0,
         PROFILER_MESSAGE_FUNCNAME);
     if (has_multi_precision_copy(type)) {
-      CopyFromTo(stored, store_[master_key]);
-      store_[master_key].WaitToRead();
+      CopyFromTo(stored, Lookup(&store_, master_key));
+      Lookup(&store_, master_key).WaitToRead();
     }
     stored.WaitToRead();
     server->Response(req_meta);
@@ -559,7 +828,7 @@ class KVStoreDistServer {
                            ps::KVServer<char>* server) {
     int master_key = DecodeKey(req_data.keys[0]);
     auto num_rows  = req_data.keys.size() - 1;
-    auto& stored   = store_[master_key];
+    auto& stored   = Lookup(&store_, master_key);
     if (req_meta.push) {
       CHECK_GT(req_data.lens.size(), 0) << "req_data.lens cannot be empty";
       CHECK_EQ(req_data.lens[0], 0);
@@ -573,7 +842,12 @@ class KVStoreDistServer {
       } else {
         if (log_verbose_)
           LOG(INFO) << "push: " << master_key << " " << req_data.keys;
-        auto& updates = update_buf_[master_key];
+        auto& updates = Lookup(&update_buf_, master_key);
+        if (ParkRequest(&updates, req_meta, [=]() {
+              DataHandleRowSparse(type, req_meta, req_data, server);
+            })) {
+          return;
+        }
         if (sync_mode_ && updates.merged.is_none()) {
           updates.merged = NDArray(kRowSparseStorage,
                                    stored.shape(),
@@ -594,7 +868,7 @@ class KVStoreDistServer {
               updates.merged =
                   NDArray(kRowSparseStorage, stored.shape(), Context(), true, merged_dtype);
             }  // else nothing to aggregate
-            updates.request.push_back(req_meta);
+            AddRequest(type, req_meta, req_data, &updates);
             ApplyUpdates(type, master_key, req_data, &updates, server);
           } else {
             server->Response(req_meta);
@@ -632,7 +906,7 @@ class KVStoreDistServer {
             CHECK(sync_mode_);
             AccumulateRowSparseGrads(type, recved, &updates);
           }
-          updates.request.push_back(req_meta);
+          AddRequest(type, req_meta, req_data, &updates);
           ApplyUpdates(type, master_key, req_data, &updates, server);
         }
       }
@@ -648,7 +922,7 @@ class KVStoreDistServer {
                               const ps::KVPairs<char>& req_data,
                               ps::KVServer<char>* server) {
     ps::KVPairs<char> response;
-    const NDArray& stored = store_[key];
+    const NDArray& stored = Lookup(&store_, key);
     CHECK(!stored.is_none()) << "init " << key << " first";
 
     // as server returns when store_realt is ready in this case
@@ -660,7 +934,52 @@ class KVStoreDistServer {
     response.lens = {len};
     // TODO(mli) try to remove this CopyFrom
     response.vals.CopyFrom(static_cast<const char*>(stored.data().dptr_), len);
-    server->Response(req_meta, response);
+    Respond(req_meta, key, response, server);
+  }
+
+  /**
+   * \brief respond to the request for key, or record the response if the request
+   *  holds several keys, and respond to it once all of its keys are answered
+   */
+  void Respond(const ps::KVMeta& req_meta,
+               const int key,
+               const ps::KVPairs<char>& response,
+               ps::KVServer<char>* server) {
+    std::unique_lock<std::mutex> lock(fused_mu_);
+    auto it = fused_requests_.find(RequestId(req_meta));
+    if (it == fused_requests_.end()) {
+      lock.unlock();
+      server->Response(req_meta, response);
+      return;
+    }
+    FusedRequest& fused = it->second;
+    if (!response.keys.empty()) {
+      fused.vals[fused.index.at(key)] = response.vals;
+    }
+    if (--fused.pending != 0)
+      return;
+    ps::KVPairs<char> fused_response;
+    if (req_meta.pull) {
+      fused_response.keys = fused.keys;
+      size_t total        = 0;
+      for (const auto& vals : fused.vals) {
+        fused_response.lens.push_back(vals.size());
+        total += vals.size();
+      }
+      fused_response.vals.resize(total);
+      size_t offset = 0;
+      for (const auto& vals : fused.vals) {
+        std::copy(vals.begin(), vals.end(), fused_response.vals.begin() + offset);
+        offset += vals.size();
+      }
+    }
+    fused_requests_.erase(it);
+    lock.unlock();
+    server->Response(req_meta, fused_response);
+  }
+
+  static std::tuple<int, int, int> RequestId(const ps::KVMeta& req_meta) {
+    return std::make_tuple(req_meta.sender, req_meta.customer_id, req_meta.timestamp);
   }
 
   void DataHandleCompressed(const DataHandleType type,
@@ -681,14 +1000,14 @@ class KVStoreDistServer {
 
       int original_size = DecodeKey(req_data.keys[0]);
       int key           = DecodeKey(req_data.keys[1]);
-      auto& stored      = store_[key];
+      auto& stored      = Lookup(&store_, key);
 
       size_t ds[] = {(size_t)req_data.lens[1] / mshadow::mshadow_sizeof(type.dtype)};
       mxnet::TShape dshape(ds, ds + 1);
       TBlob recv_blob(reinterpret_cast<real_t*>(req_data.vals.data()), dshape, cpu::kDevMask);
       NDArray recved = NDArray(recv_blob, 0);
 
-      NDArray decomp_buf = decomp_buf_[key];
+      NDArray decomp_buf = Lookup(&decomp_buf_, key);
       dshape             = mxnet::TShape{(int64_t)original_size};
 
       if (decomp_buf.is_none()) {
@@ -702,17 +1021,25 @@ class KVStoreDistServer {
         stored.WaitToRead();
       } else if (sync_mode_) {
         // synced push
-        auto& merged = update_buf_[key];
+        auto& merged = Lookup(&update_buf_, key);
+        if (ParkRequest(&merged, req_meta, [=]() {
+              DataHandleCompressed(type, req_meta, req_data, server);
+            })) {
+          return;
+        }
         if (merged.merged.is_none()) {
           merged.merged = NDArray(dshape, Context());
         }
         if (merged.request.size() == 0) {
           gradient_compression_->Dequantize(recved, &merged.merged, 0);
+        } else if (gradient_compression_->SupportsDequantizeAdd()) {
+          // adds only the values sent, without decompressing them into decomp_buf
+          gradient_compression_->DequantizeAdd(recved, &merged.merged, 0);
         } else {
           gradient_compression_->Dequantize(recved, &decomp_buf, 0);
           merged.merged += decomp_buf;
         }
-        merged.request.push_back(req_meta);
+        AddRequest(type, req_meta, req_data, &merged);
         ApplyUpdates(type, key, req_data, &merged, server);
       } else {
         // async push
@@ -732,6 +1059,39 @@ class KVStoreDistServer {
     }
   }
 
+  /** \brief handle each key of a request a worker fused from the requests of several keys */
+  void SplitFusedRequest(const DataHandleType type,
+                         const ps::KVMeta& req_meta,
+                         const ps::KVPairs<char>& req_data,
+                         ps::KVServer<char>* server) {
+    const size_t num_keys = req_data.keys.size();
+    if (req_meta.push) {
+      CHECK_EQ(req_data.lens.size(), num_keys);
+    }
+    {
+      std::lock_guard<std::mutex> lock(fused_mu_);
+      FusedRequest& fused = fused_requests_[RequestId(req_meta)];
+      fused.pending       = num_keys;
+      fused.keys          = req_data.keys;
+      fused.vals.resize(num_keys);
+      for (size_t i = 0; i < num_keys; ++i) {
+        fused.index[DecodeKey(req_data.keys[i])] = i;
+      }
+    }
+    // the request is answered, and fused erased, when the last key is handled
+    size_t offset = 0;
+    for (size_t i = 0; i < num_keys; ++i) {
+      ps::KVPairs<char> part;
+      part.keys = ps::SArray<ps::Key>(1, req_data.keys[i]);
+      if (req_meta.push) {
+        part.lens = ps::SArray<int>(1, req_data.lens[i]);
+        part.vals = req_data.vals.segment(offset, offset + req_data.lens[i]);
+        offset += req_data.lens[i];
+      }
+      Dispatch(DecodeKey(part.keys[0]), [=]() { DataHandleDefault(type, req_meta, part, server); });
+    }
+  }
+
   void DataHandleDefault(const DataHandleType type,
                          const ps::KVMeta& req_meta,
                          const ps::KVPairs<char>& req_data,
@@ -743,7 +1103,8 @@ class KVStoreDistServer {
       CHECK_EQ(req_data.vals.size(), (size_t)req_data.lens[0]);
     }
     int key      = DecodeKey(req_data.keys[0]);
-    auto& stored = has_multi_precision_copy(type) ? store_realt_[key] : store_[key];
+    auto& stored =
+        has_multi_precision_copy(type) ? Lookup(&store_realt_, key) : Lookup(&store_, key);
     // there used several WaitToRead, this is because \a recved's memory
     // could be deallocated when this function returns. so we need to make sure
     // the operators with \a NDArray are actually finished
@@ -762,16 +1123,21 @@ class KVStoreDistServer {
                          false,
                          has_multi_precision_copy(type) ? mshadow::kFloat32 : type.dtype);
         CopyFromTo(recved, &stored, 0);
-        server->Response(req_meta);
+        Respond(req_meta, key, ps::KVPairs<char>(), server);
         if (has_multi_precision_copy(type)) {
-          auto& stored_dtype = store_[key];
+          auto& stored_dtype = Lookup(&store_, key);
           stored_dtype       = NDArray(dshape, Context(), false, type.dtype);
           CopyFromTo(stored, stored_dtype);
           stored_dtype.WaitToRead();
         }
         stored.WaitToRead();
       } else {
-        auto& updates = update_buf_[key];
+        auto& updates = Lookup(&update_buf_, key);
+        if (ParkRequest(&updates, req_meta, [=]() {
+              DataHandleDefault(type, req_meta, req_data, server);
+            })) {
+          return;
+        }
         if (sync_mode_ && updates.merged.is_none()) {
           updates.merged = NDArray(dshape,
                                    Context(),
@@ -800,7 +1166,7 @@ class KVStoreDistServer {
             updates.merged += recved;
           }
         }
-        updates.request.push_back(req_meta);
+        AddRequest(type, req_meta, req_data, &updates);
         ApplyUpdates(type, key, req_data, &updates, server);
       }
     } else {
@@ -814,9 +1180,9 @@ class KVStoreDistServer {
   }
 
   /**
-   * \brief user defined mode for push
+   * \brief user defined mode for push, set by a command while the shards may run
    */
-  bool sync_mode_;
+  std::atomic<bool> sync_mode_{false};
   KVStore::Controller controller_;
   KVStore::Updater updater_;
 
@@ -839,18 +1205,60 @@ class KVStoreDistServer {
    */
   std::unordered_map<int, NDArray> decomp_buf_;
 
+  /**
+   * \brief state of a request of several keys, answered once all its keys are
+   */
+  struct FusedRequest {
+    size_t pending;
+    ps::SArray<ps::Key> keys;
+    /** \brief position of each key in the request */
+    std::unordered_map<int, size_t> index;
+    /** \brief values pulled for each key */
+    std::vector<ps::SArray<char>> vals;
+  };
+  /**
+   * \brief fused requests being answered, by sender, customer and timestamp
+   */
+  std::map<std::tuple<int, int, int>, FusedRequest> fused_requests_;
+  std::mutex fused_mu_;
+  /**
+   * \brief guards the maps of values per key, which shards access concurrently
+   */
+  std::mutex store_mu_;
+
   Executor exec_;
+  /**
+   * \brief executors handling the requests of the keys hashed to them, set if
+   *  MXNET_KVSTORE_SERVER_THREADS is greater than 1
+   */
+  std::vector<std::unique_ptr<Executor>> shards_;
+  std::vector<std::thread> shard_threads_;
   ps::KVServer<char>* ps_server_;
 
   // whether to LOG verbose information
   bool log_verbose_;
 
+  /**
+   * \brief whether workers may leave and join, set by MXNET_KVSTORE_ELASTIC
+   */
+  bool elastic_;
+  /**
+   * \brief node ids of the workers taking part in the training
+   */
+  std::unordered_set<int> members_;
+  bool members_inited_{false};
+  /**
+   * \brief barrier requests held until all the workers sent theirs
+   */
+  std::vector<ps::SimpleData> barrier_;
+  std::mutex members_mu_;
+
   /*
    * \brief whether to use multi precision mode.
    * in multi precision mode, all weights are stored as float32.
    * any gradient received will be cast to float32 before accumulation and updating of weights.
    */
-  bool multi_precision_;
+  std::atomic<bool> multi_precision_{false};
 
   /**
    * \brief gradient compression object.
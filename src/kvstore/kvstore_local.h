@@ -33,10 +33,12 @@
 #include <functional>
 #include <algorithm>
 #include "./comm.h"
+#include "./comm_auto.h"
 #include "./comm_tree.h"
 #include "./kvstore_utils.h"
 #include "../ndarray/ndarray_function.h"
 #include "../profiler/profiler.h"
+#include "../profiler/annotation.h"
 
 namespace mxnet {
 namespace kvstore {
@@ -70,8 +72,11 @@ class KVStoreLocal : public KVStore {
   explicit KVStoreLocal(bool use_device_comm) : KVStore() {
     if (use_device_comm) {
       bool tree = dmlc::GetEnv("MXNET_KVSTORE_USETREE", 0) & MXNET_USE_CUDA;
+      bool autos = dmlc::GetEnv("MXNET_KVSTORE_TOPOLOGY_AWARE", 1) & MXNET_USE_CUDA;
       if (tree) {
         comm_ = new CommDeviceTree();
+      } else if (autos) {
+        comm_ = new CommDeviceAuto();
       } else {
         comm_ = new CommDevice();
       }
@@ -111,6 +116,7 @@ class KVStoreLocal : public KVStore {
   void Push(const std::vector<int>& keys,
             const std::vector<NDArray>& values,
             int priority) override {
+    profiler::AnnotationRange range("KVStore::Push");
     SetKeyType(kIntKey);
     PushImpl(keys, values, priority);
   }
@@ -119,6 +125,7 @@ class KVStoreLocal : public KVStore {
             const std::vector<NDArray*>& values,
             int priority,
             bool ignore_sparse) override {
+    profiler::AnnotationRange range("KVStore::Pull");
     SetKeyType(kIntKey);
     PullImpl(keys, values, priority, ignore_sparse);
   }
@@ -128,6 +135,7 @@ class KVStoreLocal : public KVStore {
                  const std::vector<NDArray>& values,
                  const std::vector<NDArray*>& outs,
                  int priority) override {
+    profiler::AnnotationRange range("KVStore::Broadcast");
     SetKeyType(kIntKey);
     BroadcastImpl(vkeys, okeys, values, outs, priority);
   }
@@ -137,6 +145,7 @@ class KVStoreLocal : public KVStore {
                 const std::vector<NDArray>& values,
                 const std::vector<NDArray*>& outs,
                 int priority) override {
+    profiler::AnnotationRange range("KVStore::PushPull");
     SetKeyType(kIntKey);
     PushPullImpl(vkeys, okeys, values, outs, priority);
   }
@@ -144,6 +153,7 @@ class KVStoreLocal : public KVStore {
   void PullRowSparse(const std::vector<int>& keys,
                      const std::vector<std::pair<NDArray*, NDArray>>& val_rowids,
                      int priority = 0) override {
+    profiler::AnnotationRange range("KVStore::PullRowSparse");
     SetKeyType(kIntKey);
     PullRowSparseImpl(keys, val_rowids, priority);
   }
@@ -151,6 +161,7 @@ class KVStoreLocal : public KVStore {
   void Push(const std::vector<std::string>& str_keys,
             const std::vector<NDArray>& values,
             int priority) override {
+    profiler::AnnotationRange range("KVStore::Push");
     SetKeyType(kStringKey);
     std::vector<int> keys(str_keys.size());
     LookupKeys(str_keys, &keys);
@@ -161,6 +172,7 @@ class KVStoreLocal : public KVStore {
             const std::vector<NDArray*>& values,
             int priority,
             bool ignore_sparse) override {
+    profiler::AnnotationRange range("KVStore::Pull");
     SetKeyType(kStringKey);
     std::vector<int> keys(str_keys.size());
     LookupKeys(str_keys, &keys);
@@ -172,6 +184,7 @@ class KVStoreLocal : public KVStore {
                  const std::vector<NDArray>& values,
                  const std::vector<NDArray*>& outs,
                  int priority) override {
+    profiler::AnnotationRange range("KVStore::Broadcast");
     SetKeyType(kStringKey);
     std::vector<int> vkeys(str_vkeys.size());
     std::vector<int> okeys(str_okeys.size());
@@ -194,6 +207,7 @@ class KVStoreLocal : public KVStore {
                 const std::vector<NDArray>& values,
                 const std::vector<NDArray*>& outs,
                 int priority) override {
+    profiler::AnnotationRange range("KVStore::PushPull");
     SetKeyType(kStringKey);
     std::vector<int> vkeys(str_vkeys.size());
     std::vector<int> okeys(str_okeys.size());
@@ -205,6 +219,7 @@ class KVStoreLocal : public KVStore {
   void PullRowSparse(const std::vector<std::string>& str_keys,
                      const std::vector<std::pair<NDArray*, NDArray>>& val_rowids,
                      int priority = 0) override {
+    profiler::AnnotationRange range("KVStore::PullRowSparse");
     SetKeyType(kStringKey);
     std::vector<int> keys(str_keys.size());
     LookupKeys(str_keys, &keys);
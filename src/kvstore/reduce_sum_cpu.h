@@ -0,0 +1,183 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file   reduce_sum_cpu.h
+ * @brief  kernels summing dense arrays on the CPU
+ */
+#ifndef MXNET_KVSTORE_REDUCE_SUM_CPU_H_
+#define MXNET_KVSTORE_REDUCE_SUM_CPU_H_
+#include <mshadow/base.h>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace mxnet {
+namespace kvstore {
+
+/** \brief bytes of the arrays summed at a time, to stay in the L2 cache */
+static constexpr size_t kReduceSumCacheBytes = 256 << 10;
+
+/**
+ * \brief sum dptr[1..] into dptr[0] over [offset, offset + size)
+ *
+ * Each element is accumulated in a register over all the arrays, so that the sum
+ * is stored once, in the order of the arrays whichever the instruction set.
+ */
+template <typename DType>
+inline void ReduceSumChunk(const std::vector<DType*>& dptr, size_t offset, size_t size) {
+  DType* out = dptr[0] + offset;
+  for (size_t j = 0; j < size; ++j) {
+    DType acc = out[j];
+    for (size_t i = 1; i < dptr.size(); ++i)
+      acc += dptr[i][offset + j];
+    out[j] = acc;
+  }
+}
+
+template <>
+inline void ReduceSumChunk<float>(const std::vector<float*>& dptr, size_t offset, size_t size) {
+  float* out = dptr[0] + offset;
+  size_t j   = 0;
+#if defined(__AVX512F__)
+  for (; j + 16 <= size; j += 16) {
+    __m512 acc = _mm512_loadu_ps(out + j);
+    for (size_t i = 1; i < dptr.size(); ++i)
+      acc = _mm512_add_ps(acc, _mm512_loadu_ps(dptr[i] + offset + j));
+    _mm512_storeu_ps(out + j, acc);
+  }
+#elif defined(__AVX__)
+  for (; j + 8 <= size; j += 8) {
+    __m256 acc = _mm256_loadu_ps(out + j);
+    for (size_t i = 1; i < dptr.size(); ++i)
+      acc = _mm256_add_ps(acc, _mm256_loadu_ps(dptr[i] + offset + j));
+    _mm256_storeu_ps(out + j, acc);
+  }
+#endif
+  for (; j < size; ++j) {
+    float acc = out[j];
+    for (size_t i = 1; i < dptr.size(); ++i)
+      acc += dptr[i][offset + j];
+    out[j] = acc;
+  }
+}
+
+/** \brief fp16 is summed in fp32 and rounded once */
+template <>
+inline void ReduceSumChunk<mshadow::half::half_t>(const std::vector<mshadow::half::half_t*>& dptr,
+                                                  size_t offset,
+                                                  size_t size) {
+  using mshadow::half::half_t;
+  half_t* out = dptr[0] + offset;
+  size_t j    = 0;
+#if defined(__AVX512F__)
+  auto load16 = [](const half_t* p) {
+    return _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+  };
+  for (; j + 16 <= size; j += 16) {
+    __m512 acc = load16(out + j);
+    for (size_t i = 1; i < dptr.size(); ++i)
+      acc = _mm512_add_ps(acc, load16(dptr[i] + offset + j));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + j),
+                        _mm512_cvtps_ph(acc, _MM_FROUND_TO_NEAREST_INT));
+  }
+#elif defined(__AVX__) && defined(__F16C__)
+  auto load8 = [](const half_t* p) {
+    return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+  };
+  for (; j + 8 <= size; j += 8) {
+    __m256 acc = load8(out + j);
+    for (size_t i = 1; i < dptr.size(); ++i)
+      acc = _mm256_add_ps(acc, load8(dptr[i] + offset + j));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + j),
+                     _mm256_cvtps_ph(acc, _MM_FROUND_TO_NEAREST_INT));
+  }
+#endif
+  for (; j < size; ++j) {
+    float acc = static_cast<float>(out[j]);
+    for (size_t i = 1; i < dptr.size(); ++i)
+      acc += static_cast<float>(dptr[i][offset + j]);
+    out[j] = half_t(acc);
+  }
+}
+
+/** \brief bf16 is summed in fp32, and truncated once like the conversions of bf16_t */
+template <>
+inline void ReduceSumChunk<mshadow::bfloat::bf16_t>(
+    const std::vector<mshadow::bfloat::bf16_t*>& dptr,
+    size_t offset,
+    size_t size) {
+  using mshadow::bfloat::bf16_t;
+  bf16_t* out = dptr[0] + offset;
+  size_t j    = 0;
+#if defined(__AVX512F__)
+  auto load16 = [](const bf16_t* p) {
+    const __m256i bits = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_cvtepu16_epi32(bits), 16));
+  };
+  for (; j + 16 <= size; j += 16) {
+    __m512 acc = load16(out + j);
+    for (size_t i = 1; i < dptr.size(); ++i)
+      acc = _mm512_add_ps(acc, load16(dptr[i] + offset + j));
+    const __m512i bits = _mm512_srli_epi32(_mm512_castps_si512(acc), 16);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + j), _mm512_cvtepi32_epi16(bits));
+  }
+#elif defined(__AVX2__)
+  auto load8 = [](const bf16_t* p) {
+    const __m128i bits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(bits), 16));
+  };
+  for (; j + 8 <= size; j += 8) {
+    __m256 acc = load8(out + j);
+    for (size_t i = 1; i < dptr.size(); ++i)
+      acc = _mm256_add_ps(acc, load8(dptr[i] + offset + j));
+    const __m256i bits = _mm256_srli_epi32(_mm256_castps_si256(acc), 16);
+    // packus works within each 128 bit lane, gather the two lower halves
+    const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(bits, bits), 0x08);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + j), _mm256_castsi256_si128(packed));
+  }
+#endif
+  for (; j < size; ++j) {
+    float acc = static_cast<float>(out[j]);
+    for (size_t i = 1; i < dptr.size(); ++i)
+      acc += static_cast<float>(dptr[i][offset + j]);
+    out[j] = bf16_t(acc);
+  }
+}
+
+/**
+ * \brief sum dptr[1..] into dptr[0] over [begin, end), in chunks small enough for
+ *        the chunks of all the arrays to stay in the L2 cache
+ */
+template <typename DType>
+inline void ReduceSumRange(const std::vector<DType*>& dptr, size_t begin, size_t end) {
+  size_t step = kReduceSumCacheBytes / (dptr.size() * sizeof(DType));
+  // whole cache lines, and enough elements to amortize the loop over the arrays
+  step = std::max(static_cast<size_t>(1024), step & ~static_cast<size_t>(63));
+  for (size_t k = begin; k < end; k += step) {
+    ReduceSumChunk(dptr, k, std::min(step, end - k));
+  }
+}
+
+}  // namespace kvstore
+}  // namespace mxnet
+#endif  // MXNET_KVSTORE_REDUCE_SUM_CPU_H_
@@ -0,0 +1,399 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file   ring_allreduce.h
+ * @brief  ring allreduce between processes over TCP
+ */
+#ifndef MXNET_KVSTORE_RING_ALLREDUCE_H_
+#define MXNET_KVSTORE_RING_ALLREDUCE_H_
+#include <dmlc/logging.h>
+#if !defined(_WIN32)
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mxnet {
+namespace kvstore {
+
+/**
+ * \brief allreduce between the processes of a group connected in a ring.
+ *
+ * Each process has a TCP connection to the next process of the ring and one from the
+ * previous process. An allreduce of n elements is a reduce-scatter followed by an
+ * allgather, each of size - 1 steps in which every process sends n / size elements to
+ * the next process while it receives as many from the previous one, so that each
+ * process sends 2 * (size - 1) / size * n elements whatever the size of the group.
+ *
+ * The processes find each other through the process of rank 0, which listens on the
+ * root address. All processes must issue the same collectives in the same order.
+ */
+class RingAllreduce {
+ public:
+  /**
+   * \param rank rank of this process in [0, size)
+   * \param size number of processes
+   * \param root_uri host of the process of rank 0
+   * \param root_port port the process of rank 0 listens on to connect the group
+   * \param timeout_sec seconds to wait for the group to connect
+   */
+  RingAllreduce(int rank,
+                int size,
+                const std::string& root_uri,
+                int root_port,
+                int timeout_sec)
+      : rank_(rank), size_(size) {
+    CHECK_GT(size, 0) << "Invalid number of workers " << size;
+    CHECK(rank >= 0 && rank < size) << "Invalid rank " << rank << " of " << size << " workers";
+    if (size == 1)
+      return;
+#if !defined(_WIN32)
+    Connect(root_uri, root_port, std::chrono::seconds(timeout_sec));
+#else
+    LOG(FATAL) << "Ring allreduce is not supported on Windows";
+#endif
+  }
+
+  ~RingAllreduce() {
+#if !defined(_WIN32)
+    if (next_fd_ != -1)
+      close(next_fd_);
+    if (prev_fd_ != -1)
+      close(prev_fd_);
+#endif
+  }
+
+  int rank() const {
+    return rank_;
+  }
+
+  int size() const {
+    return size_;
+  }
+
+  /**
+   * \brief sum data over the group, in place
+   * \param tag identifies the collective, checked to be the same in all processes
+   */
+  template <typename DType>
+  void Allreduce(uint64_t tag, DType* data, size_t count) {
+    if (size_ == 1)
+      return;
+    CheckTag(tag, count * sizeof(DType));
+    std::vector<DType> recv(count / size_ + 1);
+    // reduce-scatter: after it, chunk rank + 1 holds the sum over the group
+    for (int step = 0; step < size_ - 1; ++step) {
+      const int send_chunk = rank_ - step;
+      const int recv_chunk = rank_ - step - 1;
+      const size_t n       = ChunkSize(count, recv_chunk);
+      Exchange(data + ChunkBegin(count, send_chunk),
+               ChunkSize(count, send_chunk) * sizeof(DType),
+               recv.data(),
+               n * sizeof(DType));
+      DType* dst = data + ChunkBegin(count, recv_chunk);
+      for (size_t i = 0; i < n; ++i) {
+        dst[i] += recv[i];
+      }
+    }
+    // allgather: pass the reduced chunks around the ring
+    for (int step = 0; step < size_ - 1; ++step) {
+      const int send_chunk = rank_ + 1 - step;
+      const int recv_chunk = rank_ - step;
+      Exchange(data + ChunkBegin(count, send_chunk),
+               ChunkSize(count, send_chunk) * sizeof(DType),
+               data + ChunkBegin(count, recv_chunk),
+               ChunkSize(count, recv_chunk) * sizeof(DType));
+    }
+  }
+
+  /** \brief copy the bytes of the process of rank 0 to all processes */
+  void Broadcast(uint64_t tag, void* data, size_t bytes) {
+    if (size_ == 1)
+      return;
+    CheckTag(tag, bytes);
+    // rank 0 sends to rank 1, and each rank forwards to the next but the last one
+    if (rank_ != 0) {
+      Exchange(nullptr, 0, data, bytes);
+    }
+    if (rank_ != size_ - 1) {
+      Exchange(data, bytes, nullptr, 0);
+    }
+  }
+
+  /** \brief wait until all processes reach the barrier */
+  void Barrier(uint64_t tag) {
+    std::vector<int32_t> token(size_, 0);
+    Allreduce(tag, token.data(), token.size());
+  }
+
+ private:
+  /** \brief address of a process, as sent at connection */
+  struct Address {
+    char host[64];
+    int32_t port;
+  };
+
+  /** \brief offset of a chunk of an array of count elements, chunks are taken modulo size */
+  size_t ChunkBegin(size_t count, int chunk) const {
+    const int c = (chunk % size_ + size_) % size_;
+    return count * c / size_;
+  }
+
+  size_t ChunkSize(size_t count, int chunk) const {
+    const int c = (chunk % size_ + size_) % size_;
+    return count * (c + 1) / size_ - count * c / size_;
+  }
+
+  /** \brief check that the previous process issues the same collective */
+  void CheckTag(uint64_t tag, uint64_t bytes) {
+    uint64_t mine[2] = {tag, bytes};
+    uint64_t prev[2];
+    Exchange(mine, sizeof(mine), prev, sizeof(prev));
+    CHECK(prev[0] == tag && prev[1] == bytes)
+        << "Collectives issued out of order: worker " << rank_ << " runs key " << tag << " of "
+        << bytes << " bytes while worker " << (rank_ + size_ - 1) % size_ << " runs key "
+        << prev[0] << " of " << prev[1] << " bytes";
+  }
+
+#if !defined(_WIN32)
+  /** \brief connect the ring through the process of rank 0 */
+  void Connect(const std::string& root_uri, int root_port, std::chrono::seconds timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    int listen_port;
+    const int listen_fd = Listen(0, &listen_port);
+    std::vector<Address> table(size_);
+    if (rank_ == 0) {
+      int root_fd = Listen(root_port, nullptr);
+      FillAddress(&table[0], root_uri, listen_port);
+      std::vector<int> fds;
+      for (int i = 1; i < size_; ++i) {
+        const int fd = Accept(root_fd, deadline);
+        int32_t hello[2];
+        RecvAll(fd, hello, sizeof(hello));
+        CHECK(hello[0] > 0 && hello[0] < size_) << "Invalid rank " << hello[0];
+        sockaddr_in peer;
+        socklen_t len = sizeof(peer);
+        CHECK_EQ(getpeername(fd, reinterpret_cast<sockaddr*>(&peer), &len), 0) << strerror(errno);
+        char host[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &peer.sin_addr, host, sizeof(host));
+        FillAddress(&table[hello[0]], host, hello[1]);
+        fds.push_back(fd);
+      }
+      close(root_fd);
+      for (int fd : fds) {
+        SendAll(fd, table.data(), table.size() * sizeof(Address));
+        close(fd);
+      }
+    } else {
+      const int fd     = ConnectTo(root_uri, root_port, deadline);
+      int32_t hello[2] = {rank_, listen_port};
+      SendAll(fd, hello, sizeof(hello));
+      RecvAll(fd, table.data(), table.size() * sizeof(Address));
+      close(fd);
+    }
+    const Address& next = table[(rank_ + 1) % size_];
+    next_fd_            = ConnectTo(next.host, next.port, deadline);
+    SendAll(next_fd_, &rank_, sizeof(rank_));
+    prev_fd_ = Accept(listen_fd, deadline);
+    int32_t prev_rank;
+    RecvAll(prev_fd_, &prev_rank, sizeof(prev_rank));
+    CHECK_EQ(prev_rank, (rank_ + size_ - 1) % size_) << "Unexpected connection to the ring";
+    close(listen_fd);
+    for (int fd : {next_fd_, prev_fd_}) {
+      int one = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      CHECK_NE(fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK), -1) << strerror(errno);
+    }
+  }
+
+  static void FillAddress(Address* address, const std::string& host, int port) {
+    CHECK_LT(host.size(), sizeof(address->host)) << "Host name too long: " << host;
+    std::memset(address->host, 0, sizeof(address->host));
+    std::memcpy(address->host, host.data(), host.size());
+    address->port = port;
+  }
+
+  /** \brief listen on a port, 0 for any, and return the port listened on */
+  static int Listen(int port, int* bound_port) {
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    CHECK_NE(fd, -1) << strerror(errno);
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port        = htons(port);
+    CHECK_EQ(bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0)
+        << "Failed to bind port " << port << ": " << strerror(errno);
+    CHECK_EQ(listen(fd, 128), 0) << strerror(errno);
+    if (bound_port != nullptr) {
+      socklen_t len = sizeof(addr);
+      CHECK_EQ(getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len), 0) << strerror(errno);
+      *bound_port = ntohs(addr.sin_port);
+    }
+    return fd;
+  }
+
+  static int Accept(int listen_fd, std::chrono::steady_clock::time_point deadline) {
+    while (true) {
+      const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+          deadline - std::chrono::steady_clock::now());
+      CHECK_GT(left.count(), 0) << "Timed out waiting for the other workers to connect";
+      pollfd pfd = {listen_fd, POLLIN, 0};
+      const int ret = poll(&pfd, 1, static_cast<int>(left.count()));
+      if (ret < 0 && errno == EINTR)
+        continue;
+      CHECK_GE(ret, 0) << strerror(errno);
+      if (ret == 0)
+        continue;
+      const int fd = accept(listen_fd, nullptr, nullptr);
+      if (fd == -1 && (errno == EINTR || errno == EAGAIN))
+        continue;
+      CHECK_NE(fd, -1) << strerror(errno);
+      return fd;
+    }
+  }
+
+  /** \brief connect to a process, retrying until it listens */
+  static int ConnectTo(const std::string& host,
+                       int port,
+                       std::chrono::steady_clock::time_point deadline) {
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    while (true) {
+      addrinfo* res = nullptr;
+      if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &res) == 0) {
+        const int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+        CHECK_NE(fd, -1) << strerror(errno);
+        const int ret = connect(fd, res->ai_addr, res->ai_addrlen);
+        freeaddrinfo(res);
+        if (ret == 0)
+          return fd;
+        close(fd);
+      }
+      CHECK(std::chrono::steady_clock::now() < deadline)
+          << "Timed out connecting to " << host << ":" << port;
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+  }
+
+  static void SendAll(int fd, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size != 0) {
+      const ssize_t n = send(fd, p, size, kSendFlags);
+      if (n < 0 && errno == EINTR)
+        continue;
+      CHECK_GT(n, 0) << "Failed to send to a worker: " << strerror(errno);
+      p += n;
+      size -= n;
+    }
+  }
+
+  static void RecvAll(int fd, void* data, size_t size) {
+    char* p = static_cast<char*>(data);
+    while (size != 0) {
+      const ssize_t n = recv(fd, p, size, 0);
+      if (n < 0 && errno == EINTR)
+        continue;
+      CHECK_GT(n, 0) << "Failed to receive from a worker: "
+                     << (n == 0 ? "connection closed" : strerror(errno));
+      p += n;
+      size -= n;
+    }
+  }
+
+  /** \brief send to the next process while receiving from the previous one */
+  void Exchange(const void* send_data, size_t send_size, void* recv_data, size_t recv_size) {
+    const char* s = static_cast<const char*>(send_data);
+    char* r       = static_cast<char*>(recv_data);
+    while (send_size != 0 || recv_size != 0) {
+      pollfd pfds[2];
+      int n = 0;
+      if (send_size != 0)
+        pfds[n++] = {next_fd_, POLLOUT, 0};
+      if (recv_size != 0)
+        pfds[n++] = {prev_fd_, POLLIN, 0};
+      const int ret = poll(pfds, n, -1);
+      if (ret < 0 && errno == EINTR)
+        continue;
+      CHECK_GT(ret, 0) << strerror(errno);
+      for (int i = 0; i < n; ++i) {
+        if (pfds[i].revents == 0)
+          continue;
+        if (pfds[i].fd == next_fd_) {
+          const ssize_t k = send(next_fd_, s, send_size, kSendFlags);
+          if (k < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK))
+            continue;
+          CHECK_GT(k, 0) << "Failed to send to worker " << (rank_ + 1) % size_ << ": "
+                         << strerror(errno);
+          s += k;
+          send_size -= k;
+        } else {
+          const ssize_t k = recv(prev_fd_, r, recv_size, 0);
+          if (k < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK))
+            continue;
+          CHECK_GT(k, 0) << "Failed to receive from worker " << (rank_ + size_ - 1) % size_
+                         << ": " << (k == 0 ? "connection closed" : strerror(errno));
+          r += k;
+          recv_size -= k;
+        }
+      }
+    }
+  }
+
+#ifdef MSG_NOSIGNAL
+  static constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+  static constexpr int kSendFlags = 0;
+#endif
+#else
+  void Exchange(const void* send_data, size_t send_size, void* recv_data, size_t recv_size) {
+    LOG(FATAL) << "Ring allreduce is not supported on Windows";
+  }
+#endif  // !defined(_WIN32)
+
+  int rank_;
+  int size_;
+  /** \brief connection to the next process of the ring */
+  int next_fd_{-1};
+  /** \brief connection from the previous process of the ring */
+  int prev_fd_{-1};
+};
+
+}  // namespace kvstore
+}  // namespace mxnet
+#endif  // MXNET_KVSTORE_RING_ALLREDUCE_H_
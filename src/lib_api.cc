@@ -213,6 +213,13 @@ int64_t mxnet::ext::MXTensor::size() const {
   return size;
 }
 
+int64_t mxnet::ext::MXTensorView::size() const {
+  int64_t size = 1;
+  for (int i = 0; i < ndim; ++i)
+    size *= shape[i];
+  return size;
+}
+
 bool mxnet::ext::MXTensor::isSame(const MXTensor& oth) const {
   return data_ptr == oth.data_ptr && dtype == oth.dtype && verID == oth.verID &&
          ctx.dev_type == oth.ctx.dev_type && ctx.dev_id == oth.ctx.dev_id && shape == oth.shape &&
@@ -1394,7 +1401,8 @@ MX_INT_RET _opCallCreateOpState(mxnet::ext::createOpState_t create_op,
                                 int* indims,
                                 int num_in,
                                 const int* intypes,
-                                void** state_op) {
+                                void** state_op,
+                                int* fast_compute) {
   // create map of attributes from list
   std::unordered_map<std::string, std::string> attrs;
   for (int i = 0; i < num; i++) {
@@ -1421,7 +1429,9 @@ MX_INT_RET _opCallCreateOpState(mxnet::ext::createOpState_t create_op,
   // eventually state_op pointer is populated by instance from custom library
   mxnet::ext::CustomStatefulOp** op_ptr =
       reinterpret_cast<mxnet::ext::CustomStatefulOp**>(state_op);
-  return create_op(attrs, ctx, in_shapes, in_types, op_ptr);
+  int retval    = create_op(attrs, ctx, in_shapes, in_types, op_ptr);
+  *fast_compute = retval && *op_ptr != nullptr && (*op_ptr)->supportsFastCompute();
+  return retval;
 }
 
 /*! \brief calls StatefulOp destructor for operator from library */
@@ -1568,6 +1578,39 @@ MX_INT_RET _opCallFStatefulCompute(int is_forward,
   return op_ptr->Backward(&inputs, &outputs, res);
 }
 
+/*! \brief returns status of calling Stateful ForwardFast/BackwardFast for operator from library */
+MX_INT_RET _opCallFStatefulComputeFast(int is_forward,
+                                       void* state_op,
+                                       const mxnet::ext::MXTensorView* inputs,
+                                       int num_in,
+                                       const mxnet::ext::MXTensorView* outputs,
+                                       int num_out,
+                                       mxnet::ext::xpu_malloc_t cpu_malloc,
+                                       void* cpu_alloc,
+                                       mxnet::ext::xpu_malloc_t gpu_malloc,
+                                       void* gpu_alloc,
+                                       void* stream,
+                                       mxnet::ext::sparse_malloc_t sparse_malloc,
+                                       void* sparse_alloc,
+                                       void* rng_cpu_states,
+                                       void* rng_gpu_states) {
+  mxnet::ext::OpResource res(cpu_malloc,
+                             cpu_alloc,
+                             gpu_malloc,
+                             gpu_alloc,
+                             stream,
+                             sparse_malloc,
+                             sparse_alloc,
+                             rng_cpu_states,
+                             rng_gpu_states);
+
+  mxnet::ext::CustomStatefulOp* op_ptr = reinterpret_cast<mxnet::ext::CustomStatefulOp*>(state_op);
+  if (is_forward) {
+    return op_ptr->ForwardFast(inputs, num_in, outputs, num_out, res);
+  }
+  return op_ptr->BackwardFast(inputs, num_in, outputs, num_out, res);
+}
+
 /*! \brief returns number of partitioners registered in this library */
 MX_INT_RET _partRegSize() {
   return mxnet::ext::Registry<mxnet::ext::CustomPartitioner>::get()->size();
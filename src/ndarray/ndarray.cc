@@ -31,6 +31,10 @@
 #include <mxnet/ndarray.h>
 #include <mxnet/resource.h>
 
+#include <functional>
+#include <future>
+#include <utility>
+
 #include "../common/utils.h"
 #include "../operator/nn/dnnl/dnnl_base-inl.h"
 #include "../operator/tensor/init_op.h"
@@ -96,12 +100,14 @@ void NDArray::AssignStorageInfo(const std::string& profiler_scope, const std::st
   }
   ptr_->shandle.profiler_scope = profiler_scope;
   ptr_->shandle.name           = name;
+  profiler::MemoryTimeline::Get()->OnTag(ptr_->shandle);
 #if MXNET_USE_CUDA
   profiler::GpuDeviceStorageProfiler::Get()->UpdateStorageInfo(ptr_->shandle);
 #endif  // MXNET_USE_CUDA
   for (Storage::Handle& aux_handle : ptr_->aux_handles) {
     aux_handle.profiler_scope = profiler_scope;
     aux_handle.name           = name + "_aux_data";
+    profiler::MemoryTimeline::Get()->OnTag(aux_handle);
 #if MXNET_USE_CUDA
     profiler::GpuDeviceStorageProfiler::Get()->UpdateStorageInfo(aux_handle);
 #endif  // MXNET_USE_CUDA
@@ -473,11 +479,10 @@ struct NDArrayDLManager {
   DLManagedTensor tensor;
 };
 
-DLManagedTensor* NDArray::ToDLPack() const {
-  CHECK(!is_none()) << "NDArray is not initialized";
+static DLManagedTensor* MakeDLManagedTensor(const NDArray& array, const TBlob& blob) {
   NDArrayDLManager* dlmanager(new NDArrayDLManager);
-  dlmanager->handle             = *this;
-  dlmanager->tensor.dl_tensor   = dlmanager->handle.data().dltensor();
+  dlmanager->handle             = array;
+  dlmanager->tensor.dl_tensor   = blob.dltensor();
   dlmanager->tensor.manager_ctx = dlmanager;
   dlmanager->tensor.deleter     = [](DLManagedTensor* dlmanager) {
     delete static_cast<NDArrayDLManager*>(dlmanager->manager_ctx);
@@ -485,7 +490,21 @@ DLManagedTensor* NDArray::ToDLPack() const {
   return &(dlmanager->tensor);
 }
 
-NDArray NDArray::FromDLPack(const DLManagedTensor* tensor, bool transient_handle) {
+DLManagedTensor* NDArray::ToDLPack() const {
+  CHECK(!is_none()) << "NDArray is not initialized";
+  return MakeDLManagedTensor(*this, data());
+}
+
+DLManagedTensor* NDArray::AuxToDLPack(size_t i) const {
+  CHECK(!is_none()) << "NDArray is not initialized";
+  CHECK_NE(storage_type(), kDefaultStorage) << "NDArray of default storage has no aux data";
+  return MakeDLManagedTensor(*this, aux_data(i));
+}
+
+// The tensor owned by the NDArray created from it, and the deleter releasing it
+static std::pair<DLManagedTensor*, std::function<void()>> AdoptDLPack(
+    const DLManagedTensor* tensor,
+    bool transient_handle) {
   DLManagedTensor* tensor_copy =
       transient_handle ? new DLManagedTensor(*tensor) : const_cast<DLManagedTensor*>(tensor);
   auto deleter = [tensor_copy, transient_handle]() {
@@ -496,9 +515,45 @@ NDArray NDArray::FromDLPack(const DLManagedTensor* tensor, bool transient_handle
       delete tensor_copy;
     }
   };
+  return {tensor_copy, deleter};
+}
+
+NDArray NDArray::FromDLPack(const DLManagedTensor* tensor, bool transient_handle) {
+  auto [tensor_copy, deleter] = AdoptDLPack(tensor, transient_handle);  // NOLINT
   return NDArray(TBlob(tensor_copy->dl_tensor), tensor_copy->dl_tensor.ctx.device_id, deleter);
 }
 
+NDArray NDArray::FromDLPack(NDArrayStorageType stype,
+                            const mxnet::TShape& shape,
+                            const DLManagedTensor* data,
+                            const std::vector<const DLManagedTensor*>& aux_data,
+                            bool transient_handle) {
+  CHECK_NE(stype, kDefaultStorage) << "NDArray of default storage has no aux data";
+  const size_t num_aux = stype == kCSRStorage ? 2 : 1;
+  CHECK_EQ(aux_data.size(), num_aux) << "Wrong number of aux data for storage type " << stype;
+  std::vector<std::function<void()>> deleters;
+  auto [data_copy, data_deleter] = AdoptDLPack(data, transient_handle);  // NOLINT
+  deleters.push_back(data_deleter);
+  std::vector<TBlob> aux_blobs;
+  for (const DLManagedTensor* aux : aux_data) {
+    auto [aux_copy, aux_deleter] = AdoptDLPack(aux, transient_handle);  // NOLINT
+    CHECK(aux_copy->dl_tensor.ctx.device_type == data_copy->dl_tensor.ctx.device_type &&
+          aux_copy->dl_tensor.ctx.device_id == data_copy->dl_tensor.ctx.device_id)
+        << "The data and aux data of a sparse NDArray are on different devices";
+    deleters.push_back(aux_deleter);
+    aux_blobs.emplace_back(aux_copy->dl_tensor);
+  }
+  return NDArray(stype,
+                 shape,
+                 TBlob(data_copy->dl_tensor),
+                 aux_blobs,
+                 data_copy->dl_tensor.ctx.device_id,
+                 [deleters]() {
+                   for (const auto& deleter : deleters)
+                     deleter();
+                 });
+}
+
 bool NDArray::fresh_out_grad() const {
   if (Imperative::AGInfo::IsNone(*this))
     return false;
@@ -1862,7 +1917,17 @@ static const uint32_t NDARRAY_V2_MAGIC = 0xF993fac9;
 // The ndarray must be saved and loaded within np shape semantics.
 static const uint32_t NDARRAY_V3_MAGIC = 0xF993faca;
 
+NDArray NDArray::StageForSave() const {
+  if (is_none() || ctx().dev_mask() == cpu::kDevMask)
+    return *this;
+  return this->Copy(Context::CPU());
+}
+
 void NDArray::Save(dmlc::Stream* strm) const {
+  Save(strm, StageForSave());
+}
+
+void NDArray::Save(dmlc::Stream* strm, const NDArray& staged) const {
   if (Imperative::Get()->is_np_shape()) {
     CHECK_EQ(storage_type(), kDefaultStorage)
         << "only allow serializing ndarray of default storage type in np shape semantics";
@@ -1894,7 +1959,7 @@ void NDArray::Save(dmlc::Stream* strm) const {
   TBlob save_data;
   NDArray nd_cpu;  // a copy of *this on cpu
   if (ctx.dev_mask() != cpu::kDevMask) {
-    nd_cpu = this->Copy(Context::CPU());
+    nd_cpu = staged;
     nd_cpu.WaitToRead();
     save_data = nd_cpu.data();
   } else {
@@ -2126,6 +2191,8 @@ bool NDArray::Load(dmlc::Stream* strm) {
 }
 
 const uint64_t kMXAPINDArrayListMagic = 0x112;
+// bytes copied to the CPU ahead of the array written when saving a list of arrays
+const size_t kSaveStagingBytes = 256 << 20;
 
 void NDArray::Save(dmlc::Stream* fo,
                    const std::vector<NDArray>& data,
@@ -2133,7 +2200,27 @@ void NDArray::Save(dmlc::Stream* fo,
   uint64_t header = kMXAPINDArrayListMagic, reserved = 0;
   fo->Write(&header, sizeof(header));
   fo->Write(&reserved, sizeof(reserved));
-  fo->Write(data);
+  // same layout as fo->Write(data), with the copies to the CPU of the arrays of other devices
+  // started ahead of the array written, up to kSaveStagingBytes
+  const uint64_t num_arrays = data.size();
+  fo->Write(&num_arrays, sizeof(num_arrays));
+  auto staging_bytes = [](const NDArray& array) -> size_t {
+    if (array.is_none() || array.ctx().dev_mask() == cpu::kDevMask)
+      return 0;
+    return array.shape().Size() * mshadow::mshadow_sizeof(array.dtype());
+  };
+  std::vector<NDArray> staged(data.size());
+  size_t next = 0, staged_bytes = 0;
+  for (size_t i = 0; i < data.size(); ++i) {
+    while (next < data.size() && (next == i || staged_bytes < kSaveStagingBytes)) {
+      staged[next] = data[next].StageForSave();
+      staged_bytes += staging_bytes(data[next]);
+      ++next;
+    }
+    data[i].Save(fo, staged[i]);
+    staged_bytes -= staging_bytes(data[i]);
+    staged[i] = NDArray();
+  }
   fo->Write(names);
 }
 
@@ -2477,60 +2564,47 @@ void NDArray::WaitToWrite() const {
   Engine::Get()->WaitForVar(ptr_->var);
 }
 
-void NDArray::StreamSync(int stream) const {
+void NDArray::StreamSync(int64_t stream) const {
   if (is_none())
     return;
   Imperative::DCInfo::Compute(*this);
 #if MXNET_USE_CUDA
+  CHECK_EQ(ctx().dev_mask(), gpu::kDevMask) << "Only NDArrays on a GPU sync with a stream";
+  cudaStream_t consumer = stream == 1 ? cudaStreamLegacy :
+                          stream == 2 ? cudaStreamPerThread :
+                                        reinterpret_cast<cudaStream_t>(stream);
+  // The op runs once the pending operations on the array are launched, on a stream made to wait
+  // for them: an event recorded there covers them all, without waiting for them on the host.
+  // The op writes the array so that the consumer may write it too.
+  std::promise<void> enqueued;
+  std::future<void> enqueued_future = enqueued.get_future();
+  NDArray array                     = *this;
   Engine::Get()->PushAsync(
-      [this, stream](RunContext ctx,
-                     Engine::CallbackOnStart on_start,
-                     Engine::CallbackOnComplete on_complete) {
+      [array, consumer, &enqueued](RunContext rctx,
+                                   Engine::CallbackOnStart on_start,
+                                   Engine::CallbackOnComplete on_complete) {
         on_start();
-        cudaStream_t consumer = reinterpret_cast<cudaStream_t>(stream);
-        std::unordered_map<cudaStream_t, engine::EventInfo> events_per_stream;
-        auto& sync_obj = this->var()->sync_object;
-        std::lock_guard<std::mutex> l(sync_obj.mutex);
-        auto& reader_events = sync_obj.reader_events;
-        reader_events.erase(
-            std::remove_if(reader_events.begin(),
-                           reader_events.end(),
-                           [&](const engine::EventInfo e_i) { return e_i.event.expired(); }),
-            reader_events.end());
-        for (auto& writer : sync_obj.writer_event) {
-          if (writer.event.expired()) {
-            sync_obj.writer_event.clear();
-            break;
-          }
-          if (writer.stream != consumer) {
-            bool found = false;
-            for (const auto& reader : reader_events) {
-              if (reader.stream == consumer) {
-                found = true;
-                break;
-              }
-            }
-            if (!found) {
-              auto event_stream = writer.stream;
-              if (events_per_stream.count(event_stream) > 0) {
-                if (events_per_stream[event_stream].pool_index < writer.pool_index) {
-                  events_per_stream[event_stream] = writer;
-                }
-              } else {
-                events_per_stream.emplace(event_stream, writer);
-              }
-            }
-          }
-        }
-        for (auto event : events_per_stream) {
-          auto ev = event.second.event.lock();
-          MSHADOW_CUDA_CALL(cudaStreamWaitEvent(consumer, *ev, 0));
+        try {
+          cudaStream_t producer = mshadow::Stream<gpu>::GetStream(rctx.get_stream<gpu>());
+          cudaEvent_t event;
+          MSHADOW_CUDA_CALL(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+          MSHADOW_CUDA_CALL(cudaEventRecord(event, producer));
+          MSHADOW_CUDA_CALL(cudaStreamWaitEvent(consumer, event, 0));
+          // the event is released once it completes
+          MSHADOW_CUDA_CALL(cudaEventDestroy(event));
+          enqueued.set_value();
+        } catch (...) {
+          enqueued.set_exception(std::current_exception());
         }
         on_complete();
       },
       this->ctx(),
       {},
-      {});
+      {this->var()},
+      FnProperty::kNormal,
+      0,
+      "StreamSync");
+  enqueued_future.get();
 #else
   LOG(FATAL) << "GPU is not enabled";
 #endif
@@ -23,6 +23,8 @@
  */
 
 // this will be invoked by gcc and compile CPU version
+#include <algorithm>
+#include <numeric>
 #include "./ndarray_function.h"
 #include "./ndarray_function-inl.h"
 #include "../common/utils.h"
@@ -57,99 +59,112 @@ void Copy<cpu, cpu>(const TBlob& from,
   })
 }
 
-template <typename DType, typename IType>
-void ElementwiseSumRspImpl(mshadow::Stream<cpu>* s,
-                           const std::vector<NDArray>& nds,
-                           const std::vector<IType>& uniq_row_idx,
-                           NDArray* out,
-                           const int nthreads = 4) {
-#pragma omp parallel num_threads(nthreads)
-  {
-    const size_t nnr             = uniq_row_idx.size();
-    const int num_threads        = omp_get_num_threads();
-    size_t row_block_len         = (nnr + num_threads - 1) / num_threads;
-    const size_t row_block_start = omp_get_thread_num() * row_block_len;
-    if (row_block_start < nnr) {
-      const size_t row_block_end = std::min(row_block_start + row_block_len, nnr);
-
-      const size_t row_length = out->data().shape_.ProdShape(1, out->data().shape_.ndim());
-      auto out_values         = out->data().get_with_shape<cpu, 2, DType>(
-          mshadow::Shape2(out->storage_shape()[0], row_length), s);
-      auto out_indices = out->aux_data(rowsparse::kIdx).FlatTo1D<cpu, IType>();
-      for (size_t i = row_block_start; i < row_block_end; ++i) {
-        out_indices[i] = uniq_row_idx[i];
-      }
-      for (const auto& nd : nds) {
-        if (nd.storage_initialized()) {
-          const auto nd_indices = nd.aux_data(rowsparse::kIdx).FlatTo1D<cpu, IType>();
-          const auto nd_values  = nd.data().get_with_shape<cpu, 2, DType>(
-              mshadow::Shape2(nd.storage_shape()[0], row_length), s);
-          const auto nd_num_rows        = nd.aux_shape(rowsparse::kIdx).Size();
-          const IType* nd_indices_start = &nd_indices[0];
-          const IType* nd_indices_end   = nd_indices_start + nd_num_rows;
-          const IType* row_idx_ptr =
-              std::lower_bound(nd_indices_start, nd_indices_end, out_indices[row_block_start]);
-          // skip this nd if all of its row indices are smaller than out_indices[row_block_start]
-          // or current row block is not covered by [*row_idx_ptr, nd_indices_end).
-          if (nd_indices_end == row_idx_ptr || *row_idx_ptr > out_indices[row_block_end - 1]) {
-            continue;
-          }
-          for (size_t irow = row_block_start;
-               irow < row_block_end && row_idx_ptr != nd_indices_end;) {
-            if (out_indices[irow] == *row_idx_ptr) {
-              auto out_value_cur_row = out_values[irow];
-              const auto offset      = row_idx_ptr - nd_indices_start;
-              auto nd_value_cur_row  = nd_values[offset];
-              for (index_t j = 0; j < nd_value_cur_row.shape_[0]; ++j) {
-                out_value_cur_row[j] += nd_value_cur_row[j];
-              }
-              ++irow;
-              ++row_idx_ptr;
-            } else if (out_indices[irow] < *row_idx_ptr) {
-              ++irow;
-            } else {
-              ++row_idx_ptr;
-            }
-          }
-        }
-      }
-    }
-  }
-}
-
 /*!
- * \brief Given a vector of ndarrays, generate a index vector containing
- * all the unique row indices of the ndarrays.
+ * \brief Sum row_sparse ndarrays with a k-way merge of their sorted row indices.
+ *        The row id space is cut into one range per thread at splitters sampled from the
+ *        indices of every input, so each thread merges a disjoint block of output rows:
+ *        a first pass counts the unique rows of every range, a second one writes them.
  */
-template <typename IType>
-void GetUniqueRspRowIdx(const std::vector<NDArray>& nds, std::vector<IType>* uniq_row_idx) {
+template <typename DType, typename IType>
+void ElementwiseSumRspImpl(const std::vector<NDArray>& nds, NDArray* out, const int nthreads) {
   using namespace rowsparse;
-  size_t total_num_rows = 0;
+  std::vector<const IType*> nd_idx;
+  std::vector<const DType*> nd_val;
+  std::vector<size_t> nd_nnr;
+  size_t total_nnr = 0;
   for (const auto& nd : nds) {
     CHECK_EQ(nd.storage_type(), kRowSparseStorage);
-    if (nd.storage_initialized()) {
-      total_num_rows += nd.aux_shape(kIdx).Size();
+    if (nd.storage_initialized() && nd.aux_shape(kIdx).Size() > 0) {
+      nd_idx.push_back(nd.aux_data(kIdx).dptr<IType>());
+      nd_val.push_back(nd.data().dptr<DType>());
+      nd_nnr.push_back(nd.aux_shape(kIdx).Size());
+      total_nnr += nd_nnr.back();
     }
   }
-
-  uniq_row_idx->resize(total_num_rows);
-  int nthreads = omp_get_max_threads();
-  int offset   = 0;
-  for (const auto& nd : nds) {
-    if (nd.storage_initialized()) {
-      const IType* nd_row_idx = nd.aux_data(kIdx).dptr<IType>();
-      const int num_rows      = nd.aux_shape(kIdx).Size();
-#pragma omp parallel for num_threads(nthreads)
-      for (int i = 0; i < num_rows; ++i) {
-        (*uniq_row_idx)[offset + i] = nd_row_idx[i];
+  const size_t k = nd_idx.size();
+  if (k == 0) {
+    out->CheckAndAlloc({mshadow::Shape1(0)});
+    return;
+  }
+  const dim_t row_length = out->shape().ProdShape(1, out->shape().ndim());
+  // a few thousand values per range before another thread is worth it
+  const size_t num_parts = std::max<size_t>(
+      1, std::min<size_t>(nthreads, total_nnr * row_length / 4096));
+  std::vector<IType> splitters;
+  for (size_t j = 0; j < k; ++j) {
+    for (size_t p = 1; p < num_parts; ++p) {
+      splitters.push_back(nd_idx[j][nd_nnr[j] * p / num_parts]);
+    }
+  }
+  std::sort(splitters.begin(), splitters.end());
+  // the part p covers the row ids [lower[p], lower[p + 1])
+  std::vector<IType> lower(num_parts + 1);
+  lower[0]         = 0;
+  lower[num_parts] = static_cast<IType>(out->shape()[0]);
+  for (size_t p = 1; p < num_parts; ++p) {
+    lower[p] = splitters[p * k - 1];
+  }
+  std::vector<size_t> begin(num_parts * k), end(num_parts * k), part_nnr(num_parts + 1, 0);
+  for (size_t p = 0; p < num_parts; ++p) {
+    for (size_t j = 0; j < k; ++j) {
+      const IType* first = nd_idx[j];
+      const IType* last  = nd_idx[j] + nd_nnr[j];
+      begin[p * k + j]   = std::lower_bound(first, last, lower[p]) - first;
+      end[p * k + j]     = std::lower_bound(first, last, lower[p + 1]) - first;
+    }
+  }
+  // Merge the rows of part p in order: visit(i, row, j, pos, first) adds the row pos of
+  // input j to the output row i of the part. Returns the number of output rows.
+  auto merge = [&](const size_t p, auto visit) {
+    std::vector<size_t> cur(begin.begin() + p * k, begin.begin() + (p + 1) * k);
+    const size_t* stop = &end[p * k];
+    size_t nnr         = 0;
+    while (true) {
+      bool done = true;
+      IType row = 0;
+      for (size_t j = 0; j < k; ++j) {
+        if (cur[j] < stop[j] && (done || nd_idx[j][cur[j]] < row)) {
+          row  = nd_idx[j][cur[j]];
+          done = false;
+        }
+      }
+      if (done)
+        return nnr;
+      bool first = true;
+      for (size_t j = 0; j < k; ++j) {
+        if (cur[j] < stop[j] && nd_idx[j][cur[j]] == row) {
+          visit(nnr, row, j, cur[j]++, first);
+          first = false;
+        }
       }
-      offset += num_rows;
+      ++nnr;
     }
+  };
+#pragma omp parallel for num_threads(num_parts)
+  for (index_t p = 0; p < static_cast<index_t>(num_parts); ++p) {
+    part_nnr[p + 1] = merge(p, [](size_t, IType, size_t, size_t, bool) {});
+  }
+  std::partial_sum(part_nnr.begin(), part_nnr.end(), part_nnr.begin());
+  out->CheckAndAlloc({mshadow::Shape1(part_nnr[num_parts])});
+  IType* out_idx = out->aux_data(kIdx).dptr<IType>();
+  DType* out_val = out->data().dptr<DType>();
+#pragma omp parallel for num_threads(num_parts)
+  for (index_t p = 0; p < static_cast<index_t>(num_parts); ++p) {
+    IType* part_idx = out_idx + part_nnr[p];
+    DType* part_val = out_val + part_nnr[p] * row_length;
+    merge(p, [&](size_t i, IType row, size_t j, size_t pos, bool first) {
+      const DType* in = nd_val[j] + pos * row_length;
+      DType* dst      = part_val + i * row_length;
+      if (first) {
+        part_idx[i] = row;
+        std::copy(in, in + row_length, dst);
+      } else {
+        for (dim_t c = 0; c < row_length; ++c) {
+          dst[c] += in[c];
+        }
+      }
+    });
   }
-
-  common::ParallelSort(uniq_row_idx->begin(), uniq_row_idx->end(), nthreads);
-  auto it = std::unique(uniq_row_idx->begin(), uniq_row_idx->end());
-  uniq_row_idx->resize(it - uniq_row_idx->begin());
 }
 
 void ElementwiseSumRsp(mshadow::Stream<cpu>* s,
@@ -164,137 +179,110 @@ void ElementwiseSumRsp(mshadow::Stream<cpu>* s,
 
   MSHADOW_TYPE_SWITCH(out->dtype(), DType, {
     MSHADOW_IDX_TYPE_SWITCH(out->aux_type(kIdx), IType, {
-      // TODO(Jun): Use resource rsc for temporary vector instead of
-      //            allocating it directly in GetUniqueRspRowIdx
-      std::vector<IType> uniq_row_idx;
-      GetUniqueRspRowIdx(nds, &uniq_row_idx);
-      out->CheckAndAlloc({mshadow::Shape1(uniq_row_idx.size())});
-      out->data().FlatTo2D<cpu, DType>() = static_cast<DType>(0);
-      ElementwiseSumRspImpl<DType, IType>(s, nds, uniq_row_idx, out, omp_get_max_threads());
+      ElementwiseSumRspImpl<DType, IType>(
+          nds, out, engine::OpenMP::Get()->GetRecommendedOMPThreadCount());
     });
   });
 }
 
-void ElementwiseSumDnsCsrDnsImpl(mshadow::Stream<cpu>* s,
-                                 const Resource& rsc,
-                                 const std::vector<NDArray>& nds,
-                                 NDArray* out) {
-  using namespace mxnet::op;
-  using namespace mxnet::op::mxnet_op;
-  const TBlob& out_data = out->data();
-  MSHADOW_TYPE_SWITCH(out->dtype(), DType, {  // data type
-    Kernel<Sum, cpu>::Launch(s,
-                             out_data.Size(),
-                             out_data.dptr<DType>(),
-                             kWriteTo,
-                             nds[0].data().dptr<DType>(),
-                             nds[2].data().dptr<DType>());
-    const TBlob& csr_data      = nds[1].data();
-    const TBlob& csr_indices   = nds[1].aux_data(csr::kIdx);
-    const TBlob& csr_indptr    = nds[1].aux_data(csr::kIndPtr);
-    const nnvm::dim_t num_rows = nds[1].shape()[0];
-    const nnvm::dim_t num_cols = nds[1].shape()[1];
-    MSHADOW_IDX_TYPE_SWITCH(csr_indices.type_flag_, IType, {   // indices type
-      MSHADOW_IDX_TYPE_SWITCH(csr_indptr.type_flag_, CType, {  // indptr type
-        if (nds[1].storage_initialized()) {
-          Kernel<ElemwiseDnsCsrDnsKernel<kWriteTo, mshadow_op::plus>, cpu>::Launch(
-              s,
-              num_rows,
-              out_data.dptr<DType>(),
-              out_data.dptr<DType>(),
-              csr_data.dptr<DType>(),
-              csr_indices.dptr<IType>(),
-              csr_indptr.dptr<CType>(),
-              num_rows,
-              num_cols);
+/*!
+ * \brief Add the rows [row_begin, row_end) of nd to the row-major dense buffer out
+ *        of row_length wide rows.
+ */
+template <typename DType>
+inline void AddRowBlock(const NDArray& nd,
+                        DType* out,
+                        const dim_t row_length,
+                        const dim_t row_begin,
+                        const dim_t row_end) {
+  switch (nd.storage_type()) {
+    case kDefaultStorage: {
+      const DType* in = nd.data().dptr<DType>();
+      for (dim_t i = row_begin * row_length; i < row_end * row_length; ++i) {
+        out[i] += in[i];
+      }
+      break;
+    }
+    case kCSRStorage: {
+      if (!nd.storage_initialized())
+        break;
+      const DType* data = nd.data().dptr<DType>();
+      MSHADOW_IDX_TYPE_SWITCH(nd.aux_type(csr::kIdx), IType, {
+        MSHADOW_IDX_TYPE_SWITCH(nd.aux_type(csr::kIndPtr), CType, {
+          const IType* indices = nd.aux_data(csr::kIdx).dptr<IType>();
+          const CType* indptr  = nd.aux_data(csr::kIndPtr).dptr<CType>();
+          for (dim_t row = row_begin; row < row_end; ++row) {
+            DType* out_row = out + row * row_length;
+            for (CType j = indptr[row]; j < indptr[row + 1]; ++j) {
+              out_row[indices[j]] += data[j];
+            }
+          }
+        });
+      });
+      break;
+    }
+    case kRowSparseStorage: {
+      if (!nd.storage_initialized())
+        break;
+      const DType* data = nd.data().dptr<DType>();
+      MSHADOW_IDX_TYPE_SWITCH(nd.aux_type(rowsparse::kIdx), IType, {
+        const IType* first = nd.aux_data(rowsparse::kIdx).dptr<IType>();
+        const IType* last  = first + nd.aux_shape(rowsparse::kIdx).Size();
+        for (const IType* it = std::lower_bound(first, last, row_begin);
+             it != last && *it < row_end;
+             ++it) {
+          const DType* in = data + (it - first) * row_length;
+          DType* out_row  = out + *it * row_length;
+          for (dim_t c = 0; c < row_length; ++c) {
+            out_row[c] += in[c];
+          }
         }
       });
-    });
-  });
+      break;
+    }
+    default:
+      LOG(FATAL) << "unknown storage type " << nd.storage_type() << "encountered...";
+  }
 }
 
+/*!
+ * \brief Sum inputs of any storage type into a dense output. The threads share out the
+ *        output rows in blocks and add every input to their block while it is in cache,
+ *        instead of sweeping the whole output once per input.
+ */
 void ElementwiseSumContainsDnsImpl(mshadow::Stream<cpu>* s,
                                    const Resource& rsc,
                                    const std::vector<NDArray>& nds,
                                    NDArray* out) {
-  using namespace mxnet::op;
-  using namespace mxnet::op::mxnet_op;
   const TBlob& out_data = out->data();
+  if (out_data.Size() == 0)
+    return;
+  const dim_t num_rows   = out_data.shape_[0];
+  const dim_t row_length = out_data.Size() / num_rows;
+  // blocks of about 16kb of float values
+  const dim_t block_rows = std::max<dim_t>(1, 4096 / row_length);
+  const dim_t num_blocks = (num_rows + block_rows - 1) / block_rows;
+  const int nthreads     = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
   MSHADOW_TYPE_SWITCH(out->dtype(), DType, {  // data type
-    // Do not set_zero when output mem inplace with input[0] mem
-    // Now for add_n OP, output mem can be in-placed with the first input
-    if (nds[0].data().dptr<DType>() != out_data.dptr<DType>()) {
-      Kernel<set_zero, cpu>::Launch(s, out_data.Size(), out_data.dptr<DType>());
-    }
-    for (size_t i = 0; i < nds.size(); ++i) {
-      const NDArray& nd    = nds[i];
-      const TBlob& nd_data = nd.data();
-
-      if (i == 0) {
-        if (nd.storage_type() == kDefaultStorage) {
-          Kernel<op_with_req<mshadow_op::identity, kWriteTo>, cpu>::Launch(
-              s, out_data.Size(), out_data.dptr<DType>(), nd_data.dptr<DType>());
-          continue;
-        } else {
-          Kernel<set_zero, cpu>::Launch(s, out_data.Size(), out_data.dptr<DType>());
-        }
+    DType* out_ptr = out_data.dptr<DType>();
+    // the output may be written in place of the first input
+    const bool first_dense = nds[0].storage_type() == kDefaultStorage;
+    const DType* first_ptr = first_dense ? nds[0].data().dptr<DType>() : nullptr;
+#pragma omp parallel for num_threads(nthreads) schedule(dynamic)
+    for (dim_t b = 0; b < num_blocks; ++b) {
+      const dim_t row_begin = b * block_rows;
+      const dim_t row_end   = std::min(row_begin + block_rows, num_rows);
+      DType* block_begin    = out_ptr + row_begin * row_length;
+      DType* block_end      = out_ptr + row_end * row_length;
+      if (!first_dense) {
+        std::fill(block_begin, block_end, DType(0));
+        AddRowBlock(nds[0], out_ptr, row_length, row_begin, row_end);
+      } else if (first_ptr != out_ptr) {
+        std::copy(first_ptr + row_begin * row_length, first_ptr + row_end * row_length,
+                  block_begin);
       }
-
-      switch (nd.storage_type()) {
-        case kDefaultStorage: {
-          Kernel<op_with_req<mshadow_op::plus, kWriteTo>, cpu>::Launch(s,
-                                                                       out_data.Size(),
-                                                                       out_data.dptr<DType>(),
-                                                                       out_data.dptr<DType>(),
-                                                                       nd_data.dptr<DType>());
-          break;
-        }
-        case kCSRStorage: {
-          const TBlob& nd_indices    = nd.aux_data(csr::kIdx);
-          const TBlob& nd_indptr     = nd.aux_data(csr::kIndPtr);
-          const nnvm::dim_t num_rows = nd.shape()[0];
-          const nnvm::dim_t num_cols = nd.shape()[1];
-          MSHADOW_IDX_TYPE_SWITCH(nd_indices.type_flag_, IType, {   // indices type
-            MSHADOW_IDX_TYPE_SWITCH(nd_indptr.type_flag_, CType, {  // indptr type
-              if (nd.storage_initialized()) {
-                Kernel<ElemwiseDnsCsrDnsKernel<kWriteTo, mshadow_op::plus>, cpu>::Launch(
-                    s,
-                    num_rows,
-                    out_data.dptr<DType>(),
-                    out_data.dptr<DType>(),
-                    nd_data.dptr<DType>(),
-                    nd_indices.dptr<IType>(),
-                    nd_indptr.dptr<CType>(),
-                    num_rows,
-                    num_cols);
-              }
-            });
-          });
-          break;
-        }
-        case kRowSparseStorage: {
-          const TBlob& nd_indices    = nd.aux_data(rowsparse::kIdx);
-          const nnvm::dim_t num_rows = nd.shape()[0];
-          const nnvm::dim_t num_cols = nd.shape()[1];
-          MSHADOW_IDX_TYPE_SWITCH(nd_indices.type_flag_, IType, {  // indices type
-            if (nd.storage_initialized()) {
-              const nnvm::dim_t nz_rows = nd_indices.Size();
-              Kernel<ElemwiseDnsRspDnsKernel<kWriteTo, mshadow_op::plus>, cpu>::Launch(
-                  s,
-                  nz_rows * num_cols,
-                  out_data.dptr<DType>(),
-                  out_data.dptr<DType>(),
-                  nd_data.dptr<DType>(),
-                  nd_indices.dptr<IType>(),
-                  num_rows,
-                  nz_rows,
-                  num_cols);
-            }
-          });
-          break;
-        }
-        default:
-          LOG(FATAL) << "unknown storage type " << nd.storage_type() << "encountered...";
+      for (size_t i = 1; i < nds.size(); ++i) {
+        AddRowBlock(nds[i], out_ptr, row_length, row_begin, row_end);
       }
     }
   });
@@ -313,11 +301,9 @@ void ElementwiseSum<cpu>(mshadow::Stream<cpu>* s,
     return;
   if (common::ContainsOnlyStorage(nds, kRowSparseStorage)) {
     ElementwiseSumRsp(s, rsc, nds, out);
-  } else if (nds.size() == 3U && nds[0].storage_type() == kDefaultStorage &&
-             nds[1].storage_type() == kCSRStorage && nds[2].storage_type() == kDefaultStorage &&
-             out->storage_type() == kDefaultStorage) {
-    ElementwiseSumDnsCsrDnsImpl(s, rsc, nds, out);
-  } else if (nds.size() > 4U && common::ContainsStorageType(nds, kDefaultStorage) &&
+  } else if (((nds.size() == 3U && nds[0].storage_type() == kDefaultStorage &&
+                nds[1].storage_type() == kCSRStorage && nds[2].storage_type() == kDefaultStorage) ||
+               (nds.size() > 4U && common::ContainsStorageType(nds, kDefaultStorage))) &&
              out->storage_type() == kDefaultStorage) {
     ElementwiseSumContainsDnsImpl(s, rsc, nds, out);
   } else {
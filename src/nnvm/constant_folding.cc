@@ -0,0 +1,334 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file constant_folding.cc
+ * \brief Graph pass evaluating the subgraphs which only depend on parameters, and folding
+ *        BatchNorm into the preceding Convolution or FullyConnected
+ */
+#include <mxnet/base.h>
+#include <mxnet/imperative.h>
+#include <mxnet/ndarray.h>
+#include <nnvm/graph.h>
+#include <nnvm/pass.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "operator/nn/batch_norm-inl.h"
+#include "operator/nn/convolution-inl.h"
+#include "operator/nn/fully_connected-inl.h"
+
+namespace mxnet {
+namespace {
+
+using nnvm::Graph;
+using nnvm::Node;
+using nnvm::NodeEntry;
+using nnvm::ObjectPtr;
+
+/*!
+ * \brief Adds the arrays given to optimize_for for the inputs of the graph, but for the data
+ *        inputs, which are the inputs given in shape_dict
+ */
+void AddInputArrays(const Graph& g,
+                    const std::string& arrays_attr,
+                    const std::string& names_attr,
+                    const std::unordered_set<std::string>& data_names,
+                    std::unordered_map<std::string, NDArray>* values) {
+  NDArray** arrays  = g.GetAttr<NDArray**>(arrays_attr);
+  const auto& names = g.GetAttr<std::vector<std::string>>(names_attr);
+  for (size_t i = 0; arrays != nullptr && i < names.size(); ++i) {
+    if (arrays[i] != nullptr && !arrays[i]->is_none() && !data_names.count(names[i]))
+      values->emplace(names[i], *arrays[i]);
+  }
+}
+
+/*!
+ * \brief Whether the outputs of an operator only depend on its inputs, which it does not mutate.
+ *        Operators without inputs, e.g. zeros, are left to be computed at runtime.
+ */
+bool IsFoldable(const Node& node) {
+  static const auto& fmutate   = Op::GetAttr<nnvm::FMutateInputs>("FMutateInputs");
+  static const auto& fresource = Op::GetAttr<FResourceRequest>("FResourceRequest");
+  if (fmutate.count(node.op()) || node.inputs.empty())
+    return false;
+  if (fresource.count(node.op())) {
+    for (const ResourceRequest& req : fresource[node.op()](node.attrs)) {
+      if (req.type == ResourceRequest::kRandom || req.type == ResourceRequest::kParallelRandom)
+        return false;
+    }
+  }
+  return true;
+}
+
+std::vector<double> ToHost(const NDArray& array) {
+  std::vector<double> values(array.shape().Size());
+  MSHADOW_TYPE_SWITCH(array.dtype(), DType, {
+    std::vector<DType> host(values.size());
+    array.SyncCopyToCPU(host.data(), host.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+      // half_t only converts through float, which would round the float64 parameters
+      if constexpr (std::is_same<DType, double>::value)
+        values[i] = host[i];
+      else
+        values[i] = static_cast<double>(static_cast<float>(host[i]));
+    }
+  });
+  return values;
+}
+
+NDArray FromHost(const std::vector<double>& values,
+                 const mxnet::TShape& shape,
+                 const Context& ctx,
+                 int dtype) {
+  NDArray array(shape, ctx, false, dtype);
+  MSHADOW_REAL_TYPE_SWITCH(dtype, DType, {
+    std::vector<DType> host(values.size());
+    for (size_t i = 0; i < values.size(); ++i)
+      host[i] = static_cast<DType>(values[i]);
+    array.SyncCopyFromCPU(host.data(), host.size());
+  });
+  return array;
+}
+
+/*!
+ * \brief Folds the BatchNorm node bn into the Convolution or FullyConnected node layer producing
+ *        its input, when all their parameters are known. bn becomes the layer, with the new
+ *        weight and bias variables, and keeps its name: its outputs are those of BatchNorm.
+ */
+void FoldBatchNorm(Node* bn,
+                   const Node& layer,
+                   std::unordered_map<std::string, NDArray>* values,
+                   std::vector<NDArray*>* new_args,
+                   std::vector<std::string>* new_arg_names) {
+  const auto& bn_param = nnvm::get<op::BatchNormParam>(bn->attrs.parsed);
+  if (bn_param.axis != 1)
+    return;
+  bool no_bias;
+  if (layer.op() == Op::Get("Convolution")) {
+    const auto& param = nnvm::get<op::ConvolutionParam>(layer.attrs.parsed);
+    // the output channels are the first axis of the weight in the NC* layouts only
+    if (param.layout.has_value() && param.layout.value() != mshadow::kNCW &&
+        param.layout.value() != mshadow::kNCHW && param.layout.value() != mshadow::kNCDHW)
+      return;
+    no_bias = param.no_bias;
+  } else {
+    const auto& param = nnvm::get<op::FullyConnectedParam>(layer.attrs.parsed);
+    if (!param.flatten)
+      return;
+    no_bias = param.no_bias;
+  }
+  auto value_of = [&](const NodeEntry& e) -> const NDArray* {
+    if (!e.node->is_variable())
+      return nullptr;
+    const auto it = values->find(e.node->attrs.name);
+    return it != values->end() ? &it->second : nullptr;
+  };
+  // the inputs of FullyConnected are in the same order as those of Convolution
+  const NDArray* weight = value_of(layer.inputs[op::conv::kWeight]);
+  const NDArray* bias   = no_bias ? nullptr : value_of(layer.inputs[op::conv::kBias]);
+  std::vector<const NDArray*> stats;
+  for (int i : {op::batchnorm::kGamma,
+                op::batchnorm::kBeta,
+                op::batchnorm::kInMovingMean,
+                op::batchnorm::kInMovingVar})
+    stats.push_back(value_of(bn->inputs[i]));
+  if (weight == nullptr || (!no_bias && bias == nullptr) ||
+      std::count(stats.begin(), stats.end(), nullptr) > 0)
+    return;
+  if (weight->dtype() != mshadow::kFloat32 && weight->dtype() != mshadow::kFloat16 &&
+      weight->dtype() != mshadow::kFloat64)
+    return;
+  const size_t channels = weight->shape()[0];
+  for (const NDArray* stat : stats) {
+    if (stat->shape().Size() != channels)
+      return;
+  }
+
+  std::vector<double> w           = ToHost(*weight);
+  std::vector<double> b           = bias != nullptr ? ToHost(*bias) : std::vector<double>(channels);
+  const std::vector<double> gamma = ToHost(*stats[0]);
+  const std::vector<double> beta  = ToHost(*stats[1]);
+  const std::vector<double> mean  = ToHost(*stats[2]);
+  const std::vector<double> vars  = ToHost(*stats[3]);
+  const size_t row                = w.size() / channels;
+  for (size_t c = 0; c < channels; ++c) {
+    const double scale = (bn_param.fix_gamma ? 1.0 : gamma[c]) / std::sqrt(vars[c] + bn_param.eps);
+    for (size_t j = 0; j < row; ++j)
+      w[c * row + j] *= scale;
+    b[c] = (b[c] - mean[c]) * scale + beta[c];
+  }
+  const NDArray folded[] = {
+      FromHost(w, weight->shape(), weight->ctx(), weight->dtype()),
+      FromHost(b, mxnet::TShape(1, channels), weight->ctx(), weight->dtype())};
+  const char* suffixes[] = {"_folded_weight", "_folded_bias"};
+
+  const std::string name    = bn->attrs.name;
+  bn->attrs                 = layer.attrs;
+  bn->attrs.name            = name;
+  bn->attrs.dict["no_bias"] = "False";
+  bn->op()->attr_parser(&(bn->attrs));
+  bn->inputs = {layer.inputs[op::conv::kData]};
+  for (int i = 0; i < 2; ++i) {
+    ObjectPtr var   = Node::Create();
+    var->attrs.name = layer.attrs.name + suffixes[i];
+    values->emplace(var->attrs.name, folded[i]);
+    // released by the frontend, which takes the handles of the new arguments
+    new_args->push_back(new NDArray(folded[i]));
+    new_arg_names->push_back(var->attrs.name);
+    bn->inputs.emplace_back(var, 0, 0);
+  }
+}
+
+}  // namespace
+
+/*!
+ * \brief Replaces the outputs of the operators which only depend on the arguments and auxiliary
+ *        states given to optimize_for, e.g. transposes or casts of weights, by new arguments
+ *        holding their values, computed once. Then folds BatchNorm into the Convolution or
+ *        FullyConnected producing its input, when it is the only consumer. The graph computes
+ *        the same as the original one in inference mode, for the given parameter values.
+ *        The inputs given in shape_dict are data, whose arrays are never folded.
+ */
+Graph ConstantFoldingPass(Graph&& g) {
+  std::unordered_set<std::string> data_names;
+  if (g.attrs.count("input_shape_names")) {
+    const auto& names = g.GetAttr<std::vector<std::string>>("input_shape_names");
+    data_names.insert(names.begin(), names.end());
+  }
+  std::unordered_map<std::string, NDArray> values;
+  AddInputArrays(g, "in_args", "in_arg_names", data_names, &values);
+  AddInputArrays(g, "in_aux", "in_aux_names", data_names, &values);
+  if (values.empty())
+    LOG(WARNING) << "ConstantFolding needs the parameters given to optimize_for";
+
+  std::vector<NDArray*> new_args;
+  std::vector<std::string> new_arg_names;
+  // the outputs of the constant nodes of the original graph
+  std::unordered_map<const Node*, std::vector<NDArray>> constants;
+  // the variables replacing the constant entries read by the rest of the graph
+  std::unordered_map<std::string, NodeEntry> folded;
+  std::unordered_map<const Node*, ObjectPtr> mirror_map;
+  auto mirror = [&](const NodeEntry& e) {
+    if (e.node->is_variable() || !constants.count(e.node.get()))
+      return NodeEntry{mirror_map.at(e.node.get()), e.index, e.version};
+    const std::string name = e.node->attrs.name + "_const" +
+                             (e.index > 0 ? std::to_string(e.index) : std::string());
+    auto it = folded.find(name);
+    if (it == folded.end()) {
+      const NDArray& value = constants.at(e.node.get())[e.index];
+      ObjectPtr var        = Node::Create();
+      var->attrs.name      = name;
+      values.emplace(name, value);
+      new_args.push_back(new NDArray(value));
+      new_arg_names.push_back(name);
+      it = folded.emplace(name, NodeEntry(var, 0, 0)).first;
+    }
+    return it->second;
+  };
+  DFSVisit(g.outputs, [&](const ObjectPtr& node) {
+    if (node->is_variable()) {
+      mirror_map[node.get()] = node;
+      auto it                = values.find(node->attrs.name);
+      if (it != values.end())
+        constants[node.get()] = {it->second};
+      return;
+    }
+    bool constant = IsFoldable(*node) && node->control_deps.empty();
+    for (const NodeEntry& e : node->inputs)
+      constant = constant && constants.count(e.node.get());
+    if (constant) {
+      std::vector<NDArray> outputs(node->num_outputs());
+      std::vector<NDArray*> input_ptrs, output_ptrs;
+      for (const NodeEntry& e : node->inputs)
+        input_ptrs.push_back(&constants.at(e.node.get())[e.index]);
+      for (NDArray& out : outputs)
+        output_ptrs.push_back(&out);
+      try {
+        Imperative::Get()->Invoke(input_ptrs[0]->ctx(), node->attrs, input_ptrs, output_ptrs);
+        constants[node.get()] = std::move(outputs);
+        return;
+      } catch (const dmlc::Error& e) {
+        LOG(INFO) << "ConstantFolding skips " << node->attrs.name << ": " << e.what();
+      }
+    }
+    ObjectPtr new_node = Node::Create();
+    *new_node          = *node;
+    for (NodeEntry& e : new_node->inputs)
+      e = mirror(e);
+    // the constant nodes are computed ahead of time, their control dependencies are dropped
+    new_node->control_deps.clear();
+    for (const ObjectPtr& dep : node->control_deps) {
+      auto it = mirror_map.find(dep.get());
+      if (it != mirror_map.end())
+        new_node->control_deps.push_back(it->second);
+    }
+    mirror_map[node.get()] = new_node;
+  });
+  for (NodeEntry& e : g.outputs) {
+    if (constants.count(e.node.get())) {
+      LOG(WARNING) << "ConstantFolding computed the output " << e.node->attrs.name
+                   << " ahead of time, give the data inputs in shape_dict so that they are not "
+                   << "taken as parameters";
+    }
+    e = mirror(e);
+  }
+
+  // the entries read from every node
+  std::unordered_map<const Node*, std::vector<uint32_t>> reads;
+  DFSVisit(g.outputs, [&](const ObjectPtr& node) {
+    for (const NodeEntry& e : node->inputs)
+      reads[e.node.get()].push_back(e.index);
+  });
+  for (const NodeEntry& e : g.outputs)
+    reads[e.node.get()].push_back(e.index);
+  const nnvm::Op* bn_op = Op::Get("BatchNorm");
+  DFSVisit(g.outputs, [&](const ObjectPtr& node) {
+    if (node->op() != bn_op)
+      return;
+    // held while node stops reading it
+    const ObjectPtr layer = node->inputs[op::batchnorm::kData].node;
+    if (layer->op() != Op::Get("Convolution") && layer->op() != Op::Get("FullyConnected"))
+      return;
+    // the mean and variance outputs of BatchNorm have no equivalent in the layer
+    const auto& bn_reads = reads[node.get()];
+    if (reads[layer.get()].size() != 1 ||
+        std::any_of(bn_reads.begin(), bn_reads.end(), [](uint32_t i) { return i != 0; }))
+      return;
+    FoldBatchNorm(node.get(), *layer, &values, &new_args, &new_arg_names);
+  });
+
+  g.attrs["new_args"]      = std::make_shared<nnvm::any>(new_args);
+  g.attrs["new_arg_names"] = std::make_shared<nnvm::any>(new_arg_names);
+  g.attrs["new_aux"]       = std::make_shared<nnvm::any>(std::vector<NDArray*>());
+  g.attrs["new_aux_names"] = std::make_shared<nnvm::any>(std::vector<std::string>());
+  return std::move(g);
+}
+
+NNVM_REGISTER_PASS(ConstantFolding)
+    .describe("evaluate the subgraphs only depending on parameters, and fold BatchNorm")
+    .set_body(ConstantFoldingPass)
+    .set_change_graph(true);
+
+}  // namespace mxnet
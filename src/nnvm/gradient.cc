@@ -152,16 +152,25 @@ Graph Gradient(Graph src) {
   }  // for (gnid ∈ gidx.num_nodes())
   // Inference the shapes and data types of the gradient graphs. Those
   // information is needed in later stages to determine whether putting a node
-  // on the mirror path can be beneficial or not.
+  // on the mirror path can be beneficial or not. Without the shapes of the
+  // input arguments, e.g. for graphs built before their inputs are known, all
+  // the nodes that pass the mirroring function are put on the mirror path.
   using mxnet::ShapeVector;
-  ShapeVector in_arg_shapes = src.GetAttr<ShapeVector>("in_arg_shapes");
-  DTypeVector in_arg_dtypes = src.GetAttr<DTypeVector>("in_arg_dtypes");
-  src = mxnet::exec::InferShape(std::move(src), std::move(in_arg_shapes), "__shape__");
-  src = mxnet::exec::InferType(std::move(src), std::move(in_arg_dtypes), "__dtype__");
-  CHECK(src.GetAttr<size_t>("shape_num_unknown_nodes") == 0U);
-  CHECK(src.GetAttr<size_t>("dtype_num_unknown_nodes") == 0U);
-  const ShapeVector& src_shapes = src.GetAttr<ShapeVector>("shape");
-  const DTypeVector& src_dtypes = src.GetAttr<DTypeVector>("dtype");
+  ShapeVector in_arg_shapes        = src.GetAttr<ShapeVector>("in_arg_shapes");
+  DTypeVector in_arg_dtypes        = src.GetAttr<DTypeVector>("in_arg_dtypes");
+  const bool has_storage_estimates = !in_arg_shapes.empty();
+  if (has_storage_estimates) {
+    src = mxnet::exec::InferShape(std::move(src), std::move(in_arg_shapes), "__shape__");
+    src = mxnet::exec::InferType(std::move(src), std::move(in_arg_dtypes), "__dtype__");
+    CHECK(src.GetAttr<size_t>("shape_num_unknown_nodes") == 0U);
+    CHECK(src.GetAttr<size_t>("dtype_num_unknown_nodes") == 0U);
+  }
+  const ShapeVector empty_shapes;
+  const DTypeVector empty_dtypes;
+  const ShapeVector& src_shapes =
+      has_storage_estimates ? src.GetAttr<ShapeVector>("shape") : empty_shapes;
+  const DTypeVector& src_dtypes =
+      has_storage_estimates ? src.GetAttr<DTypeVector>("dtype") : empty_dtypes;
 
   std::queue<const Node*> worklist;
   // initialize the worklist to the output nodes
@@ -322,7 +331,16 @@ Graph Gradient(Graph src) {
     // from the subgraph frontier. The propagation is successful if the amount
     // of storage released by removing the frontier nodes off the mirror path is
     // greater or equal to the storage allocated.
+    for (const Node* const subgraph_node : subgraph) {
+      if (!mirror_fun(*subgraph_node)) {
+        mirror_map[subgraph_node] = nullptr;
+      }
+    }
     do {
+      // without the shapes, all the remaining nodes of the subgraph are mirrored
+      if (!has_storage_estimates) {
+        break;
+      }
       has_subgraph_converged = true;
       // Obtain the subgraph frontier. The subgraph frontier denotes a group of
       // nodes whose inputs satisfy the following conditions:
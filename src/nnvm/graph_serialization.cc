@@ -0,0 +1,564 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file graph_serialization.cc
+ * \brief Single pass JSON reader and binary format of graphs
+ */
+#include "./graph_serialization.h"
+#include <dmlc/logging.h>
+#include <dmlc/registry.h>
+#include <mxnet/base.h>
+#include <nnvm/graph.h>
+#include <nnvm/node.h>
+#include <nnvm/op.h>
+#include <nnvm/symbolic.h>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace mxnet {
+
+using nnvm::Graph;
+using nnvm::Node;
+using nnvm::NodeEntry;
+using nnvm::ObjectPtr;
+using nnvm::Op;
+
+namespace {
+
+/*!
+ * \brief Make the graph of loaded nodes. Their attributes are parsed in a single pass when they
+ *        were saved by the current version, as UpgradeJSON_Parse does, and upgraded otherwise.
+ */
+Graph MakeGraph(std::vector<NodeEntry>&& outputs,
+                const std::vector<ObjectPtr>& nodes,
+                const std::vector<std::pair<std::string, int>>& int_attrs) {
+  Graph g;
+  g.outputs   = std::move(outputs);
+  int version = MXNET_MAKE_VERSION(0, 8, 0);
+  for (const auto& attr : int_attrs) {
+    g.attrs[attr.first] = std::make_shared<nnvm::any>(attr.second);
+    if (attr.first == "mxnet_version")
+      version = attr.second;
+  }
+  if (version != MXNET_VERSION)
+    return UpgradeGraph(std::move(g), version);
+  // the parsed VariableParam is not exposed, copy the one of a new variable
+  static const nnvm::any variable_param =
+      nnvm::Symbol::CreateVariable("var").outputs[0].node->attrs.parsed;
+  for (const ObjectPtr& n : nodes) {
+    if (n->op() != nullptr) {
+      if (n->op()->attr_parser != nullptr)
+        n->op()->attr_parser(&(n->attrs));
+    } else {
+      n->attrs.parsed = variable_param;
+    }
+  }
+  return g;
+}
+
+/*!
+ * \brief Single pass reader of the JSON written by nnvm's SaveJSON, building the nodes as it
+ *        goes. Its methods return false on input it does not handle.
+ */
+class GraphJSONReader {
+ public:
+  explicit GraphJSONReader(const std::string& json)
+      : pos_(json.data()), end_(json.data() + json.size()) {}
+
+  bool Read(Graph* out) {
+    std::vector<NodeEntry> heads;
+    std::vector<int64_t> arg_nodes;
+    std::vector<std::pair<std::string, int>> int_attrs;
+    const bool ok = ReadObject([&](const std::string& key) {
+      if (key == "nodes")
+        return ReadArray([&]() { return ReadNode(); });
+      if (key == "arg_nodes" || key == "node_row_ptr") {
+        return ReadArray([&]() {
+          int64_t nid;
+          if (!ReadInt(&nid))
+            return false;
+          if (key == "arg_nodes")
+            arg_nodes.push_back(nid);
+          return true;
+        });
+      }
+      if (key == "heads") {
+        return ReadArray([&]() {
+          heads.emplace_back();
+          return ReadEntry(&heads.back());
+        });
+      }
+      if (key == "attrs") {
+        // only the integers of mxnet_version and is_np_shape are expected
+        return ReadObject([&](const std::string& name) {
+          std::string type;
+          int64_t value;
+          if (!Expect('[') || !ReadString(&type) || type != "int" || !Expect(',') ||
+              !ReadInt(&value) || !Expect(']'))
+            return false;
+          int_attrs.emplace_back(name, static_cast<int>(value));
+          return true;
+        });
+      }
+      return false;
+    });
+    SkipSpace();
+    if (!ok || pos_ != end_)
+      return false;
+    for (int64_t nid : arg_nodes) {
+      if (nid < 0 || nid >= static_cast<int64_t>(nodes_.size()) || !nodes_[nid]->is_variable())
+        return false;
+    }
+    *out = MakeGraph(std::move(heads), nodes_, int_attrs);
+    return true;
+  }
+
+ private:
+  bool ReadNode() {
+    ObjectPtr node = Node::Create();
+    bool has_dict  = false;
+    const bool ok  = ReadObject([&](const std::string& key) {
+      if (key == "op") {
+        std::string op_name;
+        if (!ReadString(&op_name))
+          return false;
+        if (op_name == "null")
+          return true;
+        auto it = ops_.find(op_name);
+        if (it == ops_.end())
+          it = ops_.emplace(op_name, dmlc::Registry<Op>::Find(op_name)).first;
+        node->attrs.op = it->second;
+        return it->second != nullptr;
+      }
+      if (key == "name")
+        return ReadString(&node->attrs.name);
+      if (key == "attrs" || key == "attr" || key == "param") {
+        // legacy graphs with several dictionaries per node are left to LoadJSON
+        if (has_dict)
+          return false;
+        has_dict = true;
+        return ReadObject(
+            [&](const std::string& name) { return ReadString(&node->attrs.dict[name]); });
+      }
+      if (key == "inputs") {
+        return ReadArray([&]() {
+          node->inputs.emplace_back();
+          return ReadEntry(&node->inputs.back());
+        });
+      }
+      if (key == "control_deps") {
+        return ReadArray([&]() {
+          int64_t nid;
+          if (!ReadInt(&nid) || nid < 0 || nid >= static_cast<int64_t>(nodes_.size()))
+            return false;
+          node->control_deps.push_back(nodes_[nid]);
+          return true;
+        });
+      }
+      if (key == "subgraphs")
+        return ReadArray([]() { return false; });
+      return false;
+    });
+    if (!ok)
+      return false;
+    nodes_.push_back(std::move(node));
+    return true;
+  }
+
+  /*! \brief Entry [node, index] or [node, index, version] of a node read before */
+  bool ReadEntry(NodeEntry* entry) {
+    int64_t values[3] = {0, 0, 0};
+    int num_values    = 0;
+    if (!ReadArray([&]() { return num_values < 3 && ReadInt(&values[num_values++]); }) ||
+        num_values < 2 || values[0] < 0 || values[0] >= static_cast<int64_t>(nodes_.size()) ||
+        values[1] < 0 || values[2] < 0)
+      return false;
+    entry->node    = nodes_[values[0]];
+    entry->index   = static_cast<uint32_t>(values[1]);
+    entry->version = static_cast<uint32_t>(values[2]);
+    return true;
+  }
+
+  template <typename F>
+  bool ReadObject(F read_field) {
+    if (!Expect('{'))
+      return false;
+    if (Expect('}'))
+      return true;
+    std::string key;
+    do {
+      if (!ReadString(&key) || !Expect(':') || !read_field(key))
+        return false;
+    } while (Expect(','));
+    return Expect('}');
+  }
+
+  template <typename F>
+  bool ReadArray(F read_item) {
+    if (!Expect('['))
+      return false;
+    if (Expect(']'))
+      return true;
+    do {
+      if (!read_item())
+        return false;
+    } while (Expect(','));
+    return Expect(']');
+  }
+
+  /*! \brief Strings with the escapes dmlc::JSONReader supports, on a single line */
+  bool ReadString(std::string* str) {
+    if (!Expect('"'))
+      return false;
+    str->clear();
+    const char* begin = pos_;
+    for (; pos_ != end_ && *pos_ != '"'; ++pos_) {
+      if (*pos_ == '\r' || *pos_ == '\n')
+        return false;
+      if (*pos_ != '\\')
+        continue;
+      str->append(begin, pos_);
+      if (++pos_ == end_)
+        return false;
+      switch (*pos_) {
+        case 'r':
+          str->push_back('\r');
+          break;
+        case 'n':
+          str->push_back('\n');
+          break;
+        case 't':
+          str->push_back('\t');
+          break;
+        case '\\':
+        case '"':
+          str->push_back(*pos_);
+          break;
+        default:
+          return false;
+      }
+      begin = pos_ + 1;
+    }
+    if (pos_ == end_)
+      return false;
+    str->append(begin, pos_++);
+    return true;
+  }
+
+  bool ReadInt(int64_t* value) {
+    SkipSpace();
+    const bool negative = pos_ != end_ && *pos_ == '-';
+    if (negative)
+      ++pos_;
+    const char* digits = pos_;
+    int64_t result     = 0;
+    for (; pos_ != end_ && *pos_ >= '0' && *pos_ <= '9' && pos_ - digits < 18; ++pos_)
+      result = result * 10 + (*pos_ - '0');
+    if (pos_ == digits || (pos_ != end_ && std::strchr("0123456789.eE", *pos_) != nullptr))
+      return false;
+    *value = negative ? -result : result;
+    return true;
+  }
+
+  bool Expect(char c) {
+    SkipSpace();
+    if (pos_ == end_ || *pos_ != c)
+      return false;
+    ++pos_;
+    return true;
+  }
+
+  void SkipSpace() {
+    while (pos_ != end_ && (*pos_ == ' ' || *pos_ == '\n' || *pos_ == '\r' || *pos_ == '\t'))
+      ++pos_;
+  }
+
+  const char* pos_;
+  const char* end_;
+  std::vector<ObjectPtr> nodes_;
+  // operators are looked up once per name
+  std::unordered_map<std::string, const Op*> ops_;
+};
+
+/*! \brief Writer of binary graphs, interning the strings and the attribute dictionaries */
+class GraphBinaryWriter {
+ public:
+  std::string Save(const Graph& g) {
+    // the strings are interned in a deterministic order, so that a graph saves the same bytes
+    std::vector<std::pair<uint32_t, int32_t>> int_attrs;
+    int_attrs.emplace_back(Intern("mxnet_version"), MXNET_VERSION);
+    std::map<std::string, int> sorted_attrs;
+    for (const auto& attr : g.attrs) {
+      if (attr.first != "mxnet_version" && attr.second != nullptr &&
+          attr.second->type() == typeid(int))
+        sorted_attrs.emplace(attr.first, nnvm::get<int>(*attr.second));
+    }
+    for (const auto& attr : sorted_attrs)
+      int_attrs.emplace_back(Intern(attr.first), attr.second);
+    std::string graph;
+    WriteGraph(g.outputs, &graph);
+
+    std::string out;
+    Write(&out, kGraphBinaryMagic);
+    Write(&out, kGraphBinaryVersion);
+    Write(&out, static_cast<uint32_t>(strings_.size()));
+    for (const std::string* str : strings_) {
+      Write(&out, static_cast<uint32_t>(str->size()));
+      out.append(*str);
+    }
+    Write(&out, static_cast<uint32_t>(int_attrs.size()));
+    for (const auto& attr : int_attrs) {
+      Write(&out, attr.first);
+      Write(&out, attr.second);
+    }
+    Write(&out, static_cast<uint32_t>(dicts_.size()));
+    for (const std::vector<uint32_t>* dict : dicts_) {
+      Write(&out, static_cast<uint32_t>(dict->size() / 2));
+      for (uint32_t id : *dict)
+        Write(&out, id);
+    }
+    out.append(graph);
+    return out;
+  }
+
+ private:
+  template <typename T>
+  static void Write(std::string* out, T value) {
+    out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  uint32_t Intern(const std::string& str) {
+    auto it = string_ids_.emplace(str, strings_.size()).first;
+    if (it->second == strings_.size())
+      strings_.push_back(&it->first);
+    return it->second;
+  }
+
+  uint32_t InternDict(const std::unordered_map<std::string, std::string>& dict) {
+    std::vector<const std::pair<const std::string, std::string>*> sorted;
+    sorted.reserve(dict.size());
+    for (const auto& kv : dict)
+      sorted.push_back(&kv);
+    std::sort(sorted.begin(), sorted.end(), [](const auto* a, const auto* b) {
+      return a->first < b->first;
+    });
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    pairs.reserve(dict.size());
+    for (const auto* kv : sorted)
+      pairs.emplace_back(Intern(kv->first), Intern(kv->second));
+    std::vector<uint32_t> ids;
+    ids.reserve(2 * pairs.size());
+    for (const auto& pair : pairs) {
+      ids.push_back(pair.first);
+      ids.push_back(pair.second);
+    }
+    auto it = dict_ids_.emplace(std::move(ids), dicts_.size()).first;
+    if (it->second == dicts_.size())
+      dicts_.push_back(&it->first);
+    return it->second;
+  }
+
+  void WriteGraph(const std::vector<NodeEntry>& outputs, std::string* out) {
+    std::unordered_map<const Node*, uint32_t> node_ids;
+    std::vector<ObjectPtr> nodes;
+    nnvm::DFSVisit(outputs, [&](const ObjectPtr& n) {
+      node_ids.emplace(n.get(), nodes.size());
+      nodes.push_back(n);
+    });
+    auto write_entry = [&](const NodeEntry& e) {
+      Write(out, node_ids.at(e.node.get()));
+      Write(out, e.index);
+      Write(out, e.version);
+    };
+    Write(out, static_cast<uint32_t>(nodes.size()));
+    for (const ObjectPtr& n : nodes) {
+      Write(out, n->op() != nullptr ? Intern(n->op()->name) : kGraphBinaryNone);
+      Write(out, Intern(n->attrs.name));
+      Write(out, InternDict(n->attrs.dict));
+      Write(out, static_cast<uint32_t>(n->inputs.size()));
+      for (const NodeEntry& e : n->inputs)
+        write_entry(e);
+      Write(out, static_cast<uint32_t>(n->control_deps.size()));
+      for (const ObjectPtr& dep : n->control_deps)
+        Write(out, node_ids.at(dep.get()));
+      Write(out, static_cast<uint32_t>(n->attrs.subgraphs.size()));
+      for (const auto& subgraph : n->attrs.subgraphs)
+        WriteGraph(subgraph->outputs, out);
+    }
+    Write(out, static_cast<uint32_t>(outputs.size()));
+    for (const NodeEntry& e : outputs)
+      write_entry(e);
+  }
+
+  std::unordered_map<std::string, uint32_t> string_ids_;
+  std::vector<const std::string*> strings_;
+  std::map<std::vector<uint32_t>, uint32_t> dict_ids_;
+  std::vector<const std::vector<uint32_t>*> dicts_;
+};
+
+/*! \brief Bounds checked reader of binary graphs */
+class GraphBinaryReader {
+ public:
+  GraphBinaryReader(const char* data, size_t size) : pos_(data), end_(data + size) {}
+
+  Graph Load() {
+    CHECK(Read<uint32_t>() == kGraphBinaryMagic) << "Invalid binary graph";
+    const uint32_t format = Read<uint32_t>();
+    CHECK_LE(format, kGraphBinaryVersion)
+        << "Binary graph has format version " << format
+        << ", which is newer than the supported version " << kGraphBinaryVersion;
+    strings_.resize(ReadCount(sizeof(uint32_t)));
+    for (std::string& str : strings_) {
+      const uint32_t length = ReadCount(1);
+      str.assign(pos_, length);
+      pos_ += length;
+    }
+    ops_.assign(strings_.size(), nullptr);
+    std::vector<std::pair<std::string, int>> int_attrs(ReadCount(2 * sizeof(uint32_t)));
+    for (auto& attr : int_attrs) {
+      attr.first  = String(Read<uint32_t>());
+      attr.second = Read<int32_t>();
+    }
+    dicts_.resize(ReadCount(sizeof(uint32_t)));
+    for (auto& dict : dicts_) {
+      dict.resize(ReadCount(2 * sizeof(uint32_t)));
+      for (auto& kv : dict) {
+        kv.first  = Read<uint32_t>();
+        kv.second = Read<uint32_t>();
+        CHECK(kv.first < strings_.size() && kv.second < strings_.size())
+            << "Invalid binary graph";
+      }
+    }
+    std::vector<NodeEntry> outputs = ReadGraph();
+    CHECK(pos_ == end_) << "Invalid binary graph";
+    return MakeGraph(std::move(outputs), all_nodes_, int_attrs);
+  }
+
+ private:
+  template <typename T>
+  T Read() {
+    T value;
+    CHECK_LE(sizeof(T), static_cast<size_t>(end_ - pos_)) << "Truncated binary graph";
+    std::memcpy(&value, pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return value;
+  }
+
+  /*! \brief Number of items of at least item_size bytes, checked against the remaining bytes */
+  uint32_t ReadCount(size_t item_size) {
+    const uint32_t count = Read<uint32_t>();
+    CHECK_LE(count, static_cast<size_t>(end_ - pos_) / item_size) << "Truncated binary graph";
+    return count;
+  }
+
+  const std::string& String(uint32_t id) {
+    CHECK_LT(id, strings_.size()) << "Invalid binary graph";
+    return strings_[id];
+  }
+
+  /*! \brief Entry of one of the first num_nodes nodes */
+  NodeEntry ReadEntry(const std::vector<ObjectPtr>& nodes, size_t num_nodes) {
+    const uint32_t nid = Read<uint32_t>();
+    CHECK_LT(nid, num_nodes) << "Invalid binary graph";
+    const uint32_t index   = Read<uint32_t>();
+    const uint32_t version = Read<uint32_t>();
+    return NodeEntry(nodes[nid], index, version);
+  }
+
+  std::vector<NodeEntry> ReadGraph() {
+    std::vector<ObjectPtr> nodes(ReadCount(6 * sizeof(uint32_t)));
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      ObjectPtr n         = Node::Create();
+      const uint32_t op   = Read<uint32_t>();
+      const uint32_t name = Read<uint32_t>();
+      const uint32_t dict = Read<uint32_t>();
+      if (op != kGraphBinaryNone) {
+        CHECK_LT(op, ops_.size()) << "Invalid binary graph";
+        if (ops_[op] == nullptr)
+          ops_[op] = Op::Get(strings_[op]);
+        n->attrs.op = ops_[op];
+      }
+      n->attrs.name = String(name);
+      CHECK_LT(dict, dicts_.size()) << "Invalid binary graph";
+      n->attrs.dict.reserve(dicts_[dict].size());
+      for (const auto& kv : dicts_[dict])
+        n->attrs.dict.emplace(strings_[kv.first], strings_[kv.second]);
+      // inputs and dependencies are nodes written before, in topological order
+      n->inputs.resize(ReadCount(3 * sizeof(uint32_t)));
+      for (NodeEntry& e : n->inputs)
+        e = ReadEntry(nodes, i);
+      n->control_deps.resize(ReadCount(sizeof(uint32_t)));
+      for (ObjectPtr& dep : n->control_deps) {
+        const uint32_t nid = Read<uint32_t>();
+        CHECK_LT(nid, i) << "Invalid binary graph";
+        dep = nodes[nid];
+      }
+      n->attrs.subgraphs.resize(ReadCount(2 * sizeof(uint32_t)));
+      for (auto& subgraph : n->attrs.subgraphs) {
+        subgraph          = std::make_shared<nnvm::Symbol>();
+        subgraph->outputs = ReadGraph();
+      }
+      nodes[i] = n;
+      all_nodes_.push_back(std::move(n));
+    }
+    std::vector<NodeEntry> outputs(ReadCount(3 * sizeof(uint32_t)));
+    for (NodeEntry& e : outputs)
+      e = ReadEntry(nodes, nodes.size());
+    return outputs;
+  }
+
+  const char* pos_;
+  const char* end_;
+  std::vector<std::string> strings_;
+  std::vector<const Op*> ops_;
+  std::vector<std::vector<std::pair<uint32_t, uint32_t>>> dicts_;
+  // all the nodes, of the subgraphs too, whose attributes are parsed once loaded
+  std::vector<ObjectPtr> all_nodes_;
+};
+
+}  // namespace
+
+bool LoadGraphJSON(const std::string& json, Graph* out) {
+  return GraphJSONReader(json).Read(out);
+}
+
+bool IsGraphBinary(const char* data, size_t size) {
+  uint32_t magic;
+  if (size < sizeof(magic))
+    return false;
+  std::memcpy(&magic, data, sizeof(magic));
+  return magic == kGraphBinaryMagic;
+}
+
+std::string SaveGraphBinary(const Graph& g) {
+  return GraphBinaryWriter().Save(g);
+}
+
+Graph LoadGraphBinary(const char* data, size_t size) {
+  return GraphBinaryReader(data, size).Load();
+}
+
+}  // namespace mxnet
@@ -0,0 +1,75 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file graph_serialization.h
+ * \brief Fast loading of graphs: a single pass reader of their JSON and a binary format with
+ *        interned strings and attribute dictionaries.
+ *
+ * Binary layout, in host byte order:
+ *   uint32 magic, uint32 format version,
+ *   uint32 number of strings, per string: uint32 length, characters,
+ *   uint32 number of integer attributes of the graph, such as mxnet_version, per attribute:
+ *   uint32 name string id, int32 value,
+ *   uint32 number of dictionaries, per dictionary: uint32 number of pairs, uint32 key and value
+ *   string ids per pair,
+ *   the graph: uint32 number of nodes, per node in topological order: uint32 op name string id
+ *   or kGraphBinaryNone for a variable, uint32 name string id, uint32 dictionary id,
+ *   uint32 number of inputs, uint32 node, index and version per input, uint32 number of control
+ *   dependencies, uint32 node per dependency, uint32 number of subgraphs, each a graph,
+ *   then uint32 number of outputs, uint32 node, index and version per output.
+ */
+#ifndef MXNET_NNVM_GRAPH_SERIALIZATION_H_
+#define MXNET_NNVM_GRAPH_SERIALIZATION_H_
+
+#include <nnvm/graph.h>
+#include <string>
+
+namespace mxnet {
+
+/*! \brief First bytes of a binary graph, "MXGB" */
+constexpr uint32_t kGraphBinaryMagic   = 0x4247584d;
+constexpr uint32_t kGraphBinaryVersion = 1;
+constexpr uint32_t kGraphBinaryNone    = 0xffffffff;
+
+/*!
+ * \brief Load the JSON of a graph in a single pass, parsing the attributes of its nodes directly
+ *        when it was saved by the current version, and upgrading it otherwise.
+ * \return false, leaving out unchanged, for JSON the reader does not handle, such as nodes with
+ *         subgraphs, legacy fields or invalid JSON, which are left to nnvm's LoadJSON
+ */
+bool LoadGraphJSON(const std::string& json, nnvm::Graph* out);
+
+/*! \brief Whether a buffer holds a binary graph */
+bool IsGraphBinary(const char* data, size_t size);
+
+/*! \brief Save a graph in the binary format */
+std::string SaveGraphBinary(const nnvm::Graph& g);
+
+/*! \brief Load a binary graph, in time linear in its size */
+nnvm::Graph LoadGraphBinary(const char* data, size_t size);
+
+/*!
+ * \brief Run the upgrades of a graph loaded without parsing the attributes of its nodes and
+ *        saved by the given version, parsing them. Defined in legacy_json_util.cc.
+ */
+nnvm::Graph UpgradeGraph(nnvm::Graph g, int version);
+
+}  // namespace mxnet
+#endif  // MXNET_NNVM_GRAPH_SERIALIZATION_H_
@@ -33,6 +33,7 @@
 #include <memory>
 #include <functional>
 #include "../c_api/c_api_common.h"
+#include "./graph_serialization.h"
 
 namespace mxnet {
 using nnvm::FListInputNames;
@@ -194,13 +195,7 @@ static std::vector<std::pair<int, std::function<Graph(Graph)> > > upgrader_list
     {MXNET_MAKE_VERSION(0, 9, 5), UpgradeJSON_000904_000905},
 };
 
-Graph LoadLegacyJSONPass(Graph g) {
-  g.attrs["load_json_no_parse"] = std::make_shared<nnvm::any>(true);
-  Graph load                    = nnvm::ApplyPass(g, "LoadJSON");
-  int version                   = MXNET_MAKE_VERSION(0, 8, 0);
-  if (load.attrs.find("mxnet_version") != load.attrs.end()) {
-    version = nnvm::get<int>(*load.attrs["mxnet_version"]);
-  }
+Graph UpgradeGraph(Graph load, int version) {
   bool upgrading = false;
   if (version > MXNET_VERSION) {
     LOG(INFO) << "Warning: loading symbol saved by MXNet version " << version
@@ -221,6 +216,19 @@ Graph LoadLegacyJSONPass(Graph g) {
   return load;
 }
 
+Graph LoadLegacyJSONPass(Graph g) {
+  Graph load;
+  if (LoadGraphJSON(g.GetAttr<std::string>("json"), &load))
+    return load;
+  g.attrs["load_json_no_parse"] = std::make_shared<nnvm::any>(true);
+  load                          = nnvm::ApplyPass(g, "LoadJSON");
+  int version                   = MXNET_MAKE_VERSION(0, 8, 0);
+  if (load.attrs.find("mxnet_version") != load.attrs.end()) {
+    version = nnvm::get<int>(*load.attrs["mxnet_version"]);
+  }
+  return UpgradeGraph(load, version);
+}
+
 // register pass
 NNVM_REGISTER_PASS(LoadLegacyJSON)
     .describe("Return a new Graph, loaded from src.attrs[\"json\"] and upgraded to current version")
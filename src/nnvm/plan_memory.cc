@@ -26,7 +26,11 @@
 #include <nnvm/graph_attr_types.h>
 #include <nnvm/op_attr_types.h>
 #include <mxnet/base.h>
+#include <algorithm>
+#include <limits>
 #include <memory>
+#include <utility>
+#include <vector>
 #include "graph_algorithm.h"
 #include "../operator/operator_common.h"
 
@@ -83,7 +87,7 @@ class MXGraphAllocator {
     // search memory block in [size / match_range_, size * match_range_)
     size_t size = shape.Size() * MXGetDTypeSize(dtype);
     if (match_range_ == 0)
-      return this->Alloc(dev_id, size);
+      return this->Alloc(dev_id, size, node_id);
     auto begin = free_.lower_bound(size / match_range_);
     auto mid   = free_.lower_bound(size);
     auto end   = free_.upper_bound(size * match_range_);
@@ -115,7 +119,7 @@ class MXGraphAllocator {
       return e->id;
     }
     // cannot find anything return a new one.
-    return this->Alloc(dev_id, size);
+    return this->Alloc(dev_id, size, node_id);
   }
   // release a memory space.
   void Release(StorageID id, uint32_t node_id) {
@@ -124,6 +128,7 @@ class MXGraphAllocator {
       return;
     StorageEntry* e     = data_[id].get();
     e->released_by_node = node_id;
+    e->released         = true;
     free_.insert({e->max_bytes, e});
   }
 
@@ -136,6 +141,68 @@ class MXGraphAllocator {
     return total;
   }
 
+  /*!
+   * \brief Assign the storage entries to blocks shared by the entries of disjoint
+   *  lifetimes, from the largest entry to the smallest, each to the smallest block
+   *  whose entries are all released before it is requested or requested after it is
+   *  released. Intended for entries never reused, i.e. allocated with match range 0,
+   *  whose lifetime is then the one of a single entry of the graph and its inplace
+   *  outputs.
+   * \param block the block of each storage entry
+   * \return the total number of bytes of the blocks
+   */
+  size_t PackByLifetime(std::vector<StorageID>* block) const {
+    struct Block {
+      int device_id;
+      uint32_t color;
+      size_t bytes;
+      std::vector<std::pair<uint32_t, uint32_t> > lifetimes;
+    };
+    std::vector<const StorageEntry*> entries;
+    for (const auto& p : data_) {
+      entries.push_back(p.get());
+    }
+    std::stable_sort(
+        entries.begin(), entries.end(), [](const StorageEntry* a, const StorageEntry* b) {
+          return a->max_bytes > b->max_bytes;
+        });
+    std::vector<Block> blocks;
+    block->assign(data_.size(), kBadStorageID);
+    for (const StorageEntry* e : entries) {
+      const uint32_t begin = e->requested_by_node;
+      const uint32_t end =
+          e->released ? e->released_by_node : std::numeric_limits<uint32_t>::max();
+      const uint32_t color = node_color_.size() != 0 ? node_color_[begin] : 0;
+      // the blocks are at least as large as the entry, the smallest one is the best fit
+      size_t best = blocks.size();
+      for (size_t b = 0; b < blocks.size(); ++b) {
+        if (blocks[b].device_id != e->device_id || blocks[b].color != color)
+          continue;
+        if (best != blocks.size() && blocks[best].bytes <= blocks[b].bytes)
+          continue;
+        bool overlap = false;
+        for (const auto& lifetime : blocks[b].lifetimes) {
+          if (begin <= lifetime.second && lifetime.first <= end) {
+            overlap = true;
+            break;
+          }
+        }
+        if (!overlap)
+          best = b;
+      }
+      if (best == blocks.size()) {
+        blocks.push_back(Block{e->device_id, color, e->max_bytes, {}});
+      }
+      blocks[best].lifetimes.emplace_back(begin, end);
+      (*block)[e->id] = static_cast<StorageID>(best);
+    }
+    size_t total = 0;
+    for (const Block& b : blocks) {
+      total += b.bytes;
+    }
+    return total;
+  }
+
   // constructor
   explicit MXGraphAllocator(const IndexedGraph* idx, const size_t match_range) : idx_(idx) {
     this->Init(match_range, dmlc::GetEnv("NNVM_EXEC_NUM_TEMP", 1));
@@ -157,12 +224,13 @@ class MXGraphAllocator {
     }
   }
 
-  StorageID Alloc(int dev_id, size_t size) {
+  StorageID Alloc(int dev_id, size_t size, uint32_t node_id) {
     StorageID id = static_cast<StorageID>(data_.size());
     std::unique_ptr<StorageEntry> ptr(new StorageEntry());
-    ptr->id        = id;
-    ptr->device_id = dev_id;
-    ptr->max_bytes = size;
+    ptr->id                = id;
+    ptr->device_id         = dev_id;
+    ptr->max_bytes         = size;
+    ptr->requested_by_node = node_id;
     data_.emplace_back(std::move(ptr));
     return id;
   }
@@ -174,8 +242,12 @@ class MXGraphAllocator {
     int device_id;
     // maximum size of storage requested.
     size_t max_bytes{0};
+    // node index that first requested it
+    uint32_t requested_by_node{0};
     // node index that released it last time
     uint32_t released_by_node{0};
+    // whether it was released
+    bool released{false};
   };
   // scale used for rough match
   size_t match_range_;
@@ -408,6 +480,31 @@ Graph MXPlanMemory(Graph ret) {
       break;
     }
   }
+
+  // Plan again by packing the lifetimes of the entries, and keep the smaller plan.
+  if (dmlc::GetEnv("NNVM_EXEC_LIFETIME_PLAN", false)) {
+    StorageVector storage_vec(storage);
+    std::vector<int> storage_inplace_index(idx.num_node_entries(), -1);
+    MXGraphAllocator allocator(&idx, 0);
+    size_t storage_num_not_allocated = MXAllocMemory(
+        ret, idx, node_range, &storage_vec, &storage_inplace_index, ref_count, &allocator);
+    std::vector<MXGraphAllocator::StorageID> block;
+    size_t storage_allocated_bytes = allocator.PackByLifetime(&block);
+    for (auto& sid : storage_vec) {
+      if (sid >= 0)
+        sid = block[sid];
+    }
+    LOG(INFO) << "Memory plan of " << node_range.second - node_range.first << " nodes: "
+              << min_allocated_bytes << " bytes with best-fit reuse, " << storage_allocated_bytes
+              << " bytes with lifetime packing";
+    ret.attrs["storage_bestfit_allocated_bytes"] = std::make_shared<any>(min_allocated_bytes);
+    if (storage_allocated_bytes < min_allocated_bytes) {
+      ret.attrs["storage_id"]            = std::make_shared<any>(std::move(storage_vec));
+      ret.attrs["storage_inplace_index"] = std::make_shared<any>(std::move(storage_inplace_index));
+      ret.attrs["storage_allocated_bytes"]   = std::make_shared<any>(storage_allocated_bytes);
+      ret.attrs["storage_num_not_allocated"] = std::make_shared<any>(storage_num_not_allocated);
+    }
+  }
   return ret;
 }
 
@@ -0,0 +1,211 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file reorder_memory.cc
+ * \brief Reorder the independent nodes of a graph to reduce the memory alive at once.
+ */
+#include <nnvm/graph.h>
+#include <nnvm/pass.h>
+#include <nnvm/graph_attr_types.h>
+#include <nnvm/op_attr_types.h>
+#include <mxnet/base.h>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace nnvm {
+namespace pass {
+
+extern size_t MXGetDTypeSize(const int type_flag);  // defined in plan_memory.cc
+
+namespace {
+
+/*!
+ * \brief Peak number of bytes of the entries alive when the nodes run in the given order.
+ *  An entry is alive from the node computing it to its last reader, the inputs and
+ *  outputs of the graph are not counted.
+ */
+size_t PeakBytes(const IndexedGraph& idx,
+                 const std::vector<uint32_t>& order,
+                 const std::vector<size_t>& bytes,
+                 std::vector<uint32_t> ref_count) {
+  size_t live = 0, peak = 0;
+  for (uint32_t nid : order) {
+    const auto& inode = idx[nid];
+    for (uint32_t i = 0; i < inode.source->num_outputs(); ++i) {
+      live += bytes[idx.entry_id(nid, i)];
+    }
+    peak = std::max(peak, live);
+    for (const auto& e : inode.inputs) {
+      const uint32_t eid = idx.entry_id(e);
+      if (--ref_count[eid] == 0)
+        live -= bytes[eid];
+    }
+    for (uint32_t i = 0; i < inode.source->num_outputs(); ++i) {
+      const uint32_t eid = idx.entry_id(nid, i);
+      if (ref_count[eid] == 0)
+        live -= bytes[eid];
+    }
+  }
+  return peak;
+}
+
+/*!
+ * \brief Reorder the operator nodes of the graph to reduce the peak memory of the
+ *  entries alive at once, given the "shape" and "dtype" of the entries.
+ *
+ * The nodes are scheduled greedily: among the nodes whose inputs are computed, the
+ * node releasing the most bytes in excess of the bytes it allocates runs first, the
+ * node first in the current order on ties. The new order is kept if its peak is lower
+ * than the one of the current order, and enforced with control dependencies between
+ * consecutive nodes, so that the indexed graph of the returned graph follows it.
+ *
+ * Provides "memory_order_changed", whether the order changed, and
+ * "memory_order_peak_bytes", the peaks of the current and of the new order.
+ */
+Graph MXReorderMemory(Graph src) {
+  const IndexedGraph& idx             = src.indexed_graph();
+  const mxnet::ShapeVector& shape_vec = src.GetAttr<mxnet::ShapeVector>("shape");
+  const DTypeVector& dtype_vec        = src.GetAttr<DTypeVector>("dtype");
+
+  std::vector<size_t> bytes(idx.num_node_entries(), 0);
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    if (idx[nid].source->is_variable())
+      continue;
+    for (uint32_t i = 0; i < idx[nid].source->num_outputs(); ++i) {
+      const uint32_t eid = idx.entry_id(nid, i);
+      if (mxnet::shape_is_known(shape_vec[eid]) && dtype_vec[eid] != -1)
+        bytes[eid] = shape_vec[eid].Size() * MXGetDTypeSize(dtype_vec[eid]);
+    }
+  }
+  // the outputs of the graph are never released
+  std::vector<uint32_t> ref_count(idx.num_node_entries(), 0);
+  std::vector<uint32_t> order;
+  std::vector<uint32_t> num_deps(idx.num_nodes(), 0);
+  std::vector<std::vector<uint32_t> > consumers(idx.num_nodes());
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    const auto& inode = idx[nid];
+    if (inode.source->is_variable())
+      continue;
+    order.push_back(nid);
+    std::unordered_set<uint32_t> deps;
+    for (const auto& e : inode.inputs) {
+      ++ref_count[idx.entry_id(e)];
+      deps.insert(e.node_id);
+    }
+    deps.insert(inode.control_deps.begin(), inode.control_deps.end());
+    for (uint32_t dep : deps) {
+      if (idx[dep].source->is_variable())
+        continue;
+      ++num_deps[nid];
+      consumers[dep].push_back(nid);
+    }
+  }
+  for (const auto& e : idx.outputs()) {
+    ++ref_count[idx.entry_id(e)];
+  }
+
+  std::vector<uint32_t> new_order;
+  new_order.reserve(order.size());
+  std::vector<uint32_t> ready;
+  for (uint32_t nid : order) {
+    if (num_deps[nid] == 0)
+      ready.push_back(nid);
+  }
+  std::vector<uint32_t> remaining(ref_count);
+  std::unordered_map<uint32_t, uint32_t> uses;
+  while (!ready.empty()) {
+    size_t best       = 0;
+    int64_t best_gain = 0;
+    for (size_t r = 0; r < ready.size(); ++r) {
+      const auto& inode = idx[ready[r]];
+      int64_t gain      = 0;
+      for (uint32_t i = 0; i < inode.source->num_outputs(); ++i) {
+        const uint32_t eid = idx.entry_id(ready[r], i);
+        // an output nobody reads is released right away
+        if (remaining[eid] != 0)
+          gain -= static_cast<int64_t>(bytes[eid]);
+      }
+      uses.clear();
+      for (const auto& e : inode.inputs) {
+        ++uses[idx.entry_id(e)];
+      }
+      for (const auto& kv : uses) {
+        if (remaining[kv.first] == kv.second)
+          gain += static_cast<int64_t>(bytes[kv.first]);
+      }
+      if (r == 0 || gain > best_gain || (gain == best_gain && ready[r] < ready[best])) {
+        best      = r;
+        best_gain = gain;
+      }
+    }
+    const uint32_t nid = ready[best];
+    ready.erase(ready.begin() + best);
+    new_order.push_back(nid);
+    for (const auto& e : idx[nid].inputs) {
+      --remaining[idx.entry_id(e)];
+    }
+    for (uint32_t consumer : consumers[nid]) {
+      if (--num_deps[consumer] == 0)
+        ready.push_back(consumer);
+    }
+  }
+  CHECK_EQ(new_order.size(), order.size());
+
+  const size_t peak     = PeakBytes(idx, order, bytes, ref_count);
+  const size_t new_peak = PeakBytes(idx, new_order, bytes, ref_count);
+  const bool changed    = new_peak < peak;
+  if (changed) {
+    for (size_t i = 1; i < new_order.size(); ++i) {
+      ObjectPtr node = idx[new_order[i]].weak_ref.lock();
+      ObjectPtr prev = idx[new_order[i - 1]].weak_ref.lock();
+      bool is_dep    = std::find(node->control_deps.begin(), node->control_deps.end(), prev) !=
+                    node->control_deps.end();
+      for (const NodeEntry& e : node->inputs) {
+        is_dep = is_dep || e.node == prev;
+      }
+      if (!is_dep)
+        node->control_deps.push_back(prev);
+    }
+  }
+
+  Graph ret;
+  ret.outputs                          = src.outputs;
+  ret.attrs["memory_order_changed"]    = std::make_shared<any>(changed);
+  ret.attrs["memory_order_peak_bytes"] = std::make_shared<any>(
+      std::make_pair(peak, changed ? new_peak : peak));
+  return ret;
+}
+
+NNVM_REGISTER_PASS(MXReorderMemory)
+    .describe("Reorder the independent nodes to reduce the memory alive at once.")
+    .set_body(MXReorderMemory)
+    .set_change_graph(true)
+    .depend_graph_attr("shape")
+    .depend_graph_attr("dtype")
+    .provide_graph_attr("memory_order_changed")
+    .provide_graph_attr("memory_order_peak_bytes");
+
+}  // namespace
+}  // namespace pass
+}  // namespace nnvm
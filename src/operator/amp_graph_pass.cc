@@ -23,14 +23,22 @@
  * \author Clement Fuji Tsang
  */
 #include <nnvm/graph.h>
+#include <nnvm/graph_attr_types.h>
 #include <nnvm/pass.h>
 #include <mxnet/op_attr_types.h>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "./operator_common.h"
 
 namespace mxnet {
 namespace op {
 
 using nnvm::Graph;
 using nnvm::Node;
+using nnvm::NodeEntry;
 using nnvm::ObjectPtr;
 
 /*
@@ -52,5 +60,152 @@ Graph RemoveAmpCast(Graph&& g) {
 
 NNVM_REGISTER_PASS(RemoveAmpCast).describe("").set_body(RemoveAmpCast).set_change_graph(true);
 
+static bool IsCast(const Node* n) {
+  static const nnvm::Op* amp_cast = Op::Get("amp_cast");
+  static const nnvm::Op* cast     = Op::Get("Cast");
+  return n->op() == amp_cast || n->op() == cast;
+}
+
+/*! \brief Whether every value of dtype `from` is represented exactly in dtype `to` */
+static bool IsExactWidening(const int from, const int to) {
+  if (from == -1 || to == -1)
+    return false;
+  if (from == to)
+    return true;
+  const bool from_half = from == mshadow::kFloat16 || from == mshadow::kBfloat16;
+  return (to == mshadow::kFloat32 && from_half) ||
+         (to == mshadow::kFloat64 && (from_half || from == mshadow::kFloat32));
+}
+
+/*! \brief Whether the node creates its output without inputs and can emit any dtype directly */
+static bool IsDTypeFoldable(const Node* n) {
+  static const std::unordered_set<std::string> creation_ops = {
+      "_zeros", "_ones", "_full", "_npi_zeros", "_npi_ones", "_npi_full"};
+  return !n->is_variable() && n->inputs.empty() && creation_ops.count(n->op()->name) > 0;
+}
+
+/*! \brief Key identifying cast nodes which compute the same value */
+static std::string CastKey(const Node* n) {
+  std::ostringstream key;
+  key << n->op()->name;
+  for (const NodeEntry& e : n->inputs)
+    key << ' ' << e.node.get() << ':' << e.index << ':' << e.version;
+  const std::map<std::string, std::string> dict(n->attrs.dict.begin(), n->attrs.dict.end());
+  for (const auto& [name, value] : dict)
+    key << ' ' << name << '=' << value;
+  return key.str();
+}
+
+/*
+ * \brief Simplify the casts left in a mixed precision graph:
+ * - casts of a tensor to its own dtype are removed and casts reading through a cast that widens
+ *   exactly (e.g. float16 -> float32) read the source of that cast instead,
+ * - casts of the same tensor to the same dtype are merged into one node,
+ * - amp_cast of a constant creation op (zeros, ones, full) becomes that op emitting the dtype,
+ * - with "cast_params_offline", a parameter only read through amp_cast to a single dtype is marked
+ *   with "offline_param_cast_attr" and the cast is removed, so it happens at model load time.
+ * Expects the "dtype" attribute from InferType.
+ */
+Graph OptimizeAmpCast(Graph&& g) {
+  const auto& dtypes            = g.GetAttr<nnvm::DTypeVector>("dtype");
+  const nnvm::IndexedGraph& idx = g.indexed_graph();
+  std::unordered_map<const Node*, int> new_node_dtypes;
+  const auto& dtype_of = [&](const NodeEntry& e) {
+    const auto it = new_node_dtypes.find(e.node.get());
+    if (it != new_node_dtypes.end())
+      return it->second;
+    return idx.exist(e.node.get()) ? dtypes[idx.entry_id(e)] : -1;
+  };
+
+  nnvm::NodeEntryMap<NodeEntry> replaced;
+  std::unordered_map<std::string, ObjectPtr> unique_casts;
+  const auto& replace = [&](NodeEntry* e) {
+    const auto it = replaced.find(*e);
+    if (it != replaced.end())
+      *e = it->second;
+  };
+  DFSVisit(g.outputs, [&](const ObjectPtr& n) {
+    for (NodeEntry& e : n->inputs)
+      replace(&e);
+    if (IsCast(n.get())) {
+      const NodeEntry out{n, 0, 0};
+      const int dtype = dtype_of(out);
+      NodeEntry src   = n->inputs[0];
+      while (IsCast(src.node.get()) &&
+             IsExactWidening(dtype_of(src.node->inputs[0]), dtype_of(src))) {
+        src = src.node->inputs[0];
+      }
+      if (dtype != -1 && dtype_of(src) == dtype) {
+        replaced[out] = src;
+        return;
+      }
+      n->inputs[0] = src;
+      if (dtype != -1 && IsDTypeFoldable(src.node.get())) {
+        ObjectPtr folded            = Node::Create(*src.node);
+        folded->attrs.name          = src.node->attrs.name + "_" + type_string(dtype);
+        folded->attrs.dict["dtype"] = type_string(dtype);
+        folded->op()->attr_parser(&folded->attrs);
+        new_node_dtypes[folded.get()] = dtype;
+        replaced[out]                 = NodeEntry{folded, 0, 0};
+        return;
+      }
+    } else if (n->op() != Op::Get("amp_multicast")) {
+      return;
+    }
+    const auto [it, inserted] = unique_casts.emplace(CastKey(n.get()), n);
+    if (!inserted) {
+      for (uint32_t i = 0; i < n->num_outputs(); ++i)
+        replaced[NodeEntry{n, i, 0}] = NodeEntry{it->second, i, 0};
+    }
+  });
+  for (NodeEntry& e : g.outputs)
+    replace(&e);
+
+  if (g.HasAttr("cast_params_offline") && g.GetAttr<int>("cast_params_offline")) {
+    const auto& input_names             = g.GetAttr<std::unordered_set<std::string>>("input_names");
+    const auto& offline_param_cast_attr = g.GetAttr<std::string>("offline_param_cast_attr");
+    static const nnvm::Op* amp_cast     = Op::Get("amp_cast");
+    // dtypes a parameter is read as, -1 when it is read directly or by any other op
+    std::unordered_map<Node*, int> param_read_dtype;
+    const auto& read_as = [&](const NodeEntry& e, const int dtype) {
+      if (!e.node->is_variable() || input_names.count(e.node->attrs.name) > 0 ||
+          e.node->attrs.dict.count(offline_param_cast_attr) > 0)
+        return;
+      const auto [it, inserted] = param_read_dtype.emplace(e.node.get(), dtype);
+      if (!inserted && it->second != dtype)
+        it->second = -1;
+    };
+    DFSVisit(g.outputs, [&](const ObjectPtr& n) {
+      for (const NodeEntry& e : n->inputs)
+        read_as(e, n->op() == amp_cast ? dtype_of(NodeEntry{n, 0, 0}) : -1);
+    });
+    for (const NodeEntry& e : g.outputs)
+      read_as(e, -1);
+
+    replaced.clear();
+    DFSVisit(g.outputs, [&](const ObjectPtr& n) {
+      for (NodeEntry& e : n->inputs)
+        replace(&e);
+      if (n->op() != amp_cast || !n->inputs[0].node->is_variable())
+        return;
+      Node* param   = n->inputs[0].node.get();
+      const auto it = param_read_dtype.find(param);
+      if (it != param_read_dtype.end() && it->second != -1) {
+        param->attrs.dict[offline_param_cast_attr] = type_string(it->second);
+        replaced[NodeEntry{n, 0, 0}]              = n->inputs[0];
+      }
+    });
+    for (NodeEntry& e : g.outputs)
+      replace(&e);
+  }
+  return std::move(g);
+}
+
+NNVM_REGISTER_PASS(OptimizeAmpCast)
+    .describe("merge, fold and hoist the casts of a mixed precision graph")
+    .set_body(OptimizeAmpCast)
+    .set_change_graph(true)
+    .depend_graph_attr("dtype");
+
 }  // namespace op
 }  // namespace mxnet
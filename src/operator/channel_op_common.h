@@ -26,12 +26,28 @@
 #define MXNET_OPERATOR_CHANNEL_OP_COMMON_H_
 #include <dmlc/logging.h>
 #include <mxnet/operator.h>
+#include <algorithm>
 #include <vector>
 #include "./operator_common.h"
 
 namespace mxnet {
 namespace op {
 
+/*!
+ * \brief Whether every part of a concat or split along `dimension` is one contiguous block
+ *        of the whole tensor, i.e. all the axes before `dimension` have size 1. The parts
+ *        are then copied with one memcpy each instead of a strided slice expression.
+ */
+template <typename xpu, int dim, typename DType>
+inline bool IsContiguousChannel(const mshadow::Tensor<xpu, dim, DType>& whole,
+                                const int dimension) {
+  for (int i = 0; i < dimension; ++i) {
+    if (whole.size(i) != 1)
+      return false;
+  }
+  return whole.CheckContiguous();
+}
+
 template <typename xpu, int dim, int cdim, typename DType>
 inline void concatenate_helper(const std::vector<mshadow::Tensor<xpu, dim, DType> >& input,
                                mshadow::Tensor<xpu, dim, DType>* output,
@@ -66,6 +82,19 @@ inline void Concatenate(const std::vector<mshadow::Tensor<xpu, dim, DType> >& in
     LOG(FATAL) << "dimension (" << dimension << ") must be greater than 0";
   } else if (dimension >= dim) {
     LOG(FATAL) << "dimension (" << dimension << ") must be smaller than dim (" << dim << ")";
+  } else if ((req == kWriteTo || req == kWriteInplace) &&
+             IsContiguousChannel(*output, dimension)) {
+    index_t offset = 0;
+    for (const auto& in : input) {
+      const index_t size = in.shape_.Size();
+      if (size == 0)
+        continue;
+      CHECK(in.CheckContiguous());
+      mshadow::Tensor<xpu, 1, DType> dst(output->dptr_ + offset, mshadow::Shape1(size));
+      mshadow::Tensor<xpu, 1, DType> src(in.dptr_, mshadow::Shape1(size));
+      mshadow::Copy(dst, src, output->stream_);
+      offset += size;
+    }
   } else {
     concatenate_helper<xpu, dim, dim - 1>(input, output, dimension, req);
   }
@@ -105,6 +134,21 @@ void Split(const mshadow::Tensor<xpu, dim, DType>& input,
     LOG(FATAL) << "dimension (" << dimension << ") must be greater than 0";
   } else if (dimension >= dim) {
     LOG(FATAL) << "dimension (" << dimension << ") must be smaller than dim (" << dim << ")";
+  } else if (IsContiguousChannel(input, dimension) &&
+             std::all_of(req.begin(), req.end(), [](const OpReqType r) {
+               return r == kWriteTo || r == kWriteInplace;
+             })) {
+    index_t offset = 0;
+    for (const auto& out : *output) {
+      const index_t size = out.shape_.Size();
+      if (size == 0)
+        continue;
+      CHECK(out.CheckContiguous());
+      mshadow::Tensor<xpu, 1, DType> dst(out.dptr_, mshadow::Shape1(size));
+      mshadow::Tensor<xpu, 1, DType> src(input.dptr_ + offset, mshadow::Shape1(size));
+      mshadow::Copy(dst, src, input.stream_);
+      offset += size;
+    }
   } else {
     split_helper<xpu, dim, dim - 1>(input, output, dimension, req);
   }
@@ -28,6 +28,8 @@
 #include <vector>
 #include "../mshadow_op.h"
 #include "../elemwise_op_common.h"
+#include "../optimizer_op-inl.h"
+#include "./multi_tensor_update-inl.h"
 
 namespace mxnet {
 namespace op {
@@ -41,6 +43,7 @@ struct AdaBeliefParam : public dmlc::Parameter<AdaBeliefParam> {
   float wd;
   float eta;
   float clip_gradient;
+  bool lazy_update;
   DMLC_DECLARE_PARAMETER(AdaBeliefParam) {
     DMLC_DECLARE_FIELD(lr).describe("Learning rate");
     DMLC_DECLARE_FIELD(beta1).set_default(0.9f).describe(
@@ -60,6 +63,9 @@ struct AdaBeliefParam : public dmlc::Parameter<AdaBeliefParam> {
             "Clip gradient to the range of [-clip_gradient, clip_gradient] "
             "If clip_gradient <= 0, gradient clipping is turned off. "
             "grad = max(min(grad, clip_gradient), -clip_gradient).");
+    DMLC_DECLARE_FIELD(lazy_update)
+        .set_default(true)
+        .describe("If true, lazy updates are applied if gradient's stype is row_sparse.");
   }
 };
 
@@ -172,6 +178,42 @@ struct MPAdaBeliefUpdate {
  * \brief adabelief update.
  *
  */
+template <int req>
+struct AdaBeliefKernel {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(int i,
+                                  DType* out_data,
+                                  DType* mean_data,
+                                  DType* var_data,
+                                  const DType* weight_data,
+                                  const DType* grad_data,
+                                  const DType param_clip_gradient,
+                                  const DType param_beta1,
+                                  const DType param_beta2,
+                                  const DType param_eta,
+                                  const DType param_lr,
+                                  const DType param_wd,
+                                  const DType param_rescale_grad,
+                                  const DType param_epsilon) {
+    const DType w     = weight_data[i];
+    DType scaled_grad = param_rescale_grad * grad_data[i] + param_wd * w;
+    if (param_clip_gradient >= 0.0f)
+      scaled_grad = mshadow_op::clip::Map(scaled_grad, param_clip_gradient);
+
+    const DType mean = mean_data[i] =
+        param_beta1 * mean_data[i] + (DType(1.0f) - param_beta1) * scaled_grad;
+    const DType var = var_data[i] = param_beta2 * var_data[i] +
+                                    (DType(1.0f) - param_beta2) *
+                                        mshadow_op::square::Map(scaled_grad - mean) +
+                                    param_epsilon;
+
+    KERNEL_ASSIGN(out_data[i],
+                  req,
+                  w - param_eta * (param_lr * mean /
+                                   (mshadow_op::square_root::Map(var) + param_epsilon)));
+  }
+};
+
 template <typename xpu>
 struct AdaBeliefUpdate {
   static inline void Forward(const nnvm::NodeAttrs& attrs,
@@ -221,6 +263,8 @@ struct MultiAdaBeliefParam : public dmlc::Parameter<MultiAdaBeliefParam> {
   float beta2;
   float epsilon;
   float clip_gradient;
+  float max_grad_norm;
+  bool skip_nonfinite;
   int num_weights;
   DMLC_DECLARE_PARAMETER(MultiAdaBeliefParam) {
     DMLC_DECLARE_FIELD(lrs).describe("Learning rates");
@@ -241,6 +285,14 @@ struct MultiAdaBeliefParam : public dmlc::Parameter<MultiAdaBeliefParam> {
             "Clip gradient to the range of [-clip_gradient, clip_gradient] "
             "If clip_gradient <= 0, gradient clipping is turned off. "
             "grad = max(min(grad, clip_gradient), -clip_gradient).");
+    DMLC_DECLARE_FIELD(max_grad_norm)
+        .set_default(-1.0f)
+        .describe(
+            "Scale the rescaled gradients down so that their global L2 norm over all the weights "
+            "does not exceed max_grad_norm. If max_grad_norm <= 0, the norm is not clipped.");
+    DMLC_DECLARE_FIELD(skip_nonfinite)
+        .set_default(false)
+        .describe("Skip the update of all the weights if a gradient holds an inf or a NaN.");
     DMLC_DECLARE_FIELD(num_weights).set_default(1).describe("Number of updated weights.");
   }
 };
@@ -342,8 +394,8 @@ template <typename DType, typename MPDType>
 struct MultiKernelParam {
   static const int N = 50;
   int count;
-  size_t max_size;
-  size_t sizes[N];
+  size_t total_size;
+  size_t offsets[N + 1];
   DType* weights[N];
   DType* grad_data[N];
   MPDType* mean_data[N];
@@ -362,35 +414,35 @@ struct MultiKernelParam {
 template <typename MPDType, bool has_mixed_precision>
 struct MultiMPAdaBeliefKernel {
   template <typename DType>
-  MSHADOW_XINLINE static void Map(int i,
+  MSHADOW_XINLINE static void Map(index_t i,
                                   const MultiKernelParam<DType, MPDType>& param,
                                   const OpReqType req,
-                                  const float rescale_grad) {
-    for (int index = 0; index < param.count; ++index) {
-      if ((size_t)i < param.sizes[index]) {
-        MPDType w =
-            has_mixed_precision ? param.weights32[index][i] : MPDType(param.weights[index][i]);
-        MPDType scaled_grad =
-            static_cast<MPDType>(rescale_grad) * static_cast<MPDType>(param.grad_data[index][i]);
-
-        scaled_grad += param.wds[index] * w;
-        if (param.clip_gradient >= 0.f)
-          scaled_grad = mshadow_op::clip::Map(scaled_grad, param.clip_gradient);
-
-        const auto mean = param.beta1 * (param.mean_data[index][i] - scaled_grad) + scaled_grad;
-        const auto adj  = mshadow_op::square::Map(mean - scaled_grad);
-        const auto var  = param.beta2 * (param.var_data[index][i] - adj) + adj + param.epsilon;
-
-        param.mean_data[index][i] = mean;
-        param.var_data[index][i]  = var;
-        w                         = w - param.etas[index] *
-                    (param.lrs[index] * mean / (mshadow_op::square_root::Map(var) + param.epsilon));
-        if (has_mixed_precision)
-          param.weights32[index][i] = w;
-
-        KERNEL_ASSIGN(param.out_data[index][i], req, w);
-      }
-    }
+                                  const float* rescale_grad) {
+    const float scale = *rescale_grad;
+    if (scale == 0.f)
+      return;
+    const int index = MultiTensorIndex(param.offsets, param.count, i);
+    const size_t k  = i - param.offsets[index];
+    MPDType w = has_mixed_precision ? param.weights32[index][k] : MPDType(param.weights[index][k]);
+    MPDType scaled_grad =
+        static_cast<MPDType>(scale) * static_cast<MPDType>(param.grad_data[index][k]);
+
+    scaled_grad += param.wds[index] * w;
+    if (param.clip_gradient >= 0.f)
+      scaled_grad = mshadow_op::clip::Map(scaled_grad, param.clip_gradient);
+
+    const auto mean = param.beta1 * (param.mean_data[index][k] - scaled_grad) + scaled_grad;
+    const auto adj  = mshadow_op::square::Map(mean - scaled_grad);
+    const auto var  = param.beta2 * (param.var_data[index][k] - adj) + adj + param.epsilon;
+
+    param.mean_data[index][k] = mean;
+    param.var_data[index][k]  = var;
+    w                         = w - param.etas[index] *
+                (param.lrs[index] * mean / (mshadow_op::square_root::Map(var) + param.epsilon));
+    if (has_mixed_precision)
+      param.weights32[index][k] = w;
+
+    KERNEL_ASSIGN(param.out_data[index][k], req, w);
   }
 };
 
@@ -413,13 +465,11 @@ void FillMultiKernelParam(const nnvm::NodeAttrs& attrs,
   pParam->epsilon = p.epsilon;
 
   pParam->count         = p.num_weights;
-  pParam->max_size      = 0;
+  pParam->offsets[0]    = 0;
   constexpr bool isSame = std::is_same<DType, MPDType>::value;
   for (int i = 0; i < pParam->count; ++i) {
-    const auto idx   = i * input_stride;
-    pParam->sizes[i] = inputs[idx].shape_.Size();
-    if (pParam->max_size < pParam->sizes[i])
-      pParam->max_size = pParam->sizes[i];
+    const auto idx         = i * input_stride;
+    pParam->offsets[i + 1] = pParam->offsets[i] + inputs[idx].shape_.Size();
 
     pParam->weights[i]   = inputs[idx].FlatTo2D<xpu, DType>(s).dptr_;
     pParam->grad_data[i] = inputs[idx + 1].FlatTo2D<xpu, DType>(s).dptr_;
@@ -432,20 +482,31 @@ void FillMultiKernelParam(const nnvm::NodeAttrs& attrs,
 
     pParam->out_data[i] = outputs[i].FlatTo2D<xpu, DType>(s).dptr_;
   }
+  pParam->total_size = pParam->offsets[pParam->count];
   memcpy(pParam->etas, p.etas.begin(), pParam->count * sizeof(p.etas[0]));
   memcpy(pParam->lrs, p.lrs.begin(), pParam->count * sizeof(p.lrs[0]));
   memcpy(pParam->wds, p.wds.begin(), pParam->count * sizeof(p.wds[0]));
 }
 
+/*!
+ * \brief Updates all the weights of the group in a single launch, with the gradient scale, global
+ *        norm clipping and inf/NaN check computed on the device beforehand.
+ */
 template <typename xpu, template <typename> class MPTypeChooser, int input_stride>
 static inline void MultiAdaBeliefUpdate(const nnvm::NodeAttrs& attrs,
                                         const OpContext& ctx,
                                         const std::vector<TBlob>& inputs,
                                         const std::vector<OpReqType>& req,
-                                        const std::vector<TBlob>& outputs,
-                                        const float rescale_grad) {
+                                        const std::vector<TBlob>& outputs) {
   using namespace mxnet_op;
-  Stream<xpu>* s = ctx.get_stream<xpu>();
+  const MultiAdaBeliefParam& p = nnvm::get<MultiAdaBeliefParam>(attrs.parsed);
+  Stream<xpu>* s               = ctx.get_stream<xpu>();
+  std::vector<TBlob> grads;
+  grads.reserve(p.num_weights);
+  for (int i = 0; i < p.num_weights; ++i)
+    grads.emplace_back(inputs[i * input_stride + 1]);
+  const float* scale =
+      MultiUpdateScale<xpu>(ctx, grads, inputs.back(), p.max_grad_norm, p.skip_nonfinite);
   MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, DType, {
     using MPDType = typename MPTypeChooser<DType>::type;
     MultiKernelParam<DType, MPDType> param;
@@ -453,7 +514,7 @@ static inline void MultiAdaBeliefUpdate(const nnvm::NodeAttrs& attrs,
         attrs, ctx, inputs, outputs, &param);
 
     Kernel<MultiMPAdaBeliefKernel<MPDType, !std::is_same<DType, MPDType>::value>, xpu>::Launch(
-        s, param.max_size, param, req[0], rescale_grad);
+        s, param.total_size, param, req[0], scale);
   });
 }
 
@@ -491,22 +552,82 @@ inline void MPUpdate(const nnvm::NodeAttrs& attrs,
   F::Forward(attrs, ctx, inputs_wo_scale, req, outputs, scalef);
 }
 
+/*!
+ * \brief Lazy update of the rows present in a row_sparse gradient, for the single (MP = false)
+ *        and multi-precision (MP = true) AdaBelief updates. Weight and states are either all
+ *        dense or all row_sparse, see LazyOptScaleStorageType.
+ */
+template <typename xpu, bool MP>
+inline void MPUpdateEx(const nnvm::NodeAttrs& attrs,
+                       const OpContext& ctx,
+                       const std::vector<NDArray>& inputs,
+                       const std::vector<OpReqType>& req,
+                       const std::vector<NDArray>& outputs) {
+  const auto& param       = nnvm::get<AdaBeliefParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  float scalef;
+  adabelief::GetScaleFloat<xpu>(s, inputs.back().data(), &scalef);
+  if (!std::isfinite(scalef) || scalef == 0)
+    return;
+
+  const std::vector<NDArray> inputs_wo_scale(inputs.begin(), inputs.end() - 1);
+  const char* op_name = MP ? "MPAdaBeliefUpdate" : "AdaBeliefUpdate";
+  if (!PrepareLazyRowUpdate<xpu>(ctx, inputs_wo_scale, req[0], op_name))
+    return;
+  const NDArray& weight = inputs[0];
+  const NDArray& grad   = inputs[1];
+  MSHADOW_REAL_TYPE_SWITCH(weight.dtype(), DType, {
+    // PrepareLazyRowUpdate only lets kWriteInplace through
+    if constexpr (MP) {
+      LaunchLazyRowUpdate<xpu, MPAdaBeliefKernel<kWriteInplace>, 4>(s,
+                                                               weight.shape(),
+                                                               grad,
+                                                               outputs[0].data().dptr<DType>(),
+                                                               inputs[2].data().dptr<float>(),
+                                                               inputs[3].data().dptr<float>(),
+                                                               weight.data().dptr<DType>(),
+                                                               grad.data().dptr<DType>(),
+                                                               inputs[4].data().dptr<float>(),
+                                                               param.clip_gradient,
+                                                               param.beta1,
+                                                               param.beta2,
+                                                               param.eta,
+                                                               param.lr,
+                                                               param.wd,
+                                                               scalef,
+                                                               param.epsilon);
+    } else {
+      LaunchLazyRowUpdate<xpu, AdaBeliefKernel<kWriteInplace>, 4>(
+          s,
+          weight.shape(),
+          grad,
+          outputs[0].data().dptr<DType>(),
+          inputs[2].data().dptr<DType>(),
+          inputs[3].data().dptr<DType>(),
+          weight.data().dptr<DType>(),
+          grad.data().dptr<DType>(),
+          static_cast<DType>(param.clip_gradient),
+          static_cast<DType>(param.beta1),
+          static_cast<DType>(param.beta2),
+          static_cast<DType>(param.eta),
+          static_cast<DType>(param.lr),
+          static_cast<DType>(param.wd),
+          static_cast<DType>(scalef),
+          static_cast<DType>(param.epsilon));
+    }
+  });
+}
+
 template <typename xpu, bool MP>
 inline void multiMPUpdate(const nnvm::NodeAttrs& attrs,
                           const OpContext& ctx,
                           const std::vector<TBlob>& inputs,
                           const std::vector<OpReqType>& req,
                           const std::vector<TBlob>& outputs) {
-  std::vector<TBlob> inputs_wo_scale;
-  float scalef;
-  if (!PrepareInputBlobs<xpu>(ctx, inputs, &inputs_wo_scale, &scalef))
-    return;
-
   if (!MP)
-    MultiAdaBeliefUpdate<xpu, _type_identity, 4>(attrs, ctx, inputs_wo_scale, req, outputs, scalef);
+    MultiAdaBeliefUpdate<xpu, _type_identity, 4>(attrs, ctx, inputs, req, outputs);
   else
-    MultiAdaBeliefUpdate<xpu, _single_precision, 5>(
-        attrs, ctx, inputs_wo_scale, req, outputs, scalef);
+    MultiAdaBeliefUpdate<xpu, _single_precision, 5>(attrs, ctx, inputs, req, outputs);
 }
 
 }  // namespace adabelief
@@ -55,17 +55,22 @@ It updates the weights using::
 
 Note that gradient is rescaled to grad = rescale_grad * grad. If rescale_grad is NaN, Inf, or 0,
 the update is skipped.
+
+If gradient is of ``row_sparse`` storage type and ``lazy_update`` is True,
+only the row slices whose indices appear in grad.indices are updated (for w, m and v).
 )code" ADD_FILELINE)
     .set_num_inputs(6)
     .set_num_outputs(1)
     .set_attr_parser(ParamParser<AdaBeliefParam>)
     .set_attr<mxnet::FInferShape>("FInferShape", MPUpdateInferShape<2, 1, 6>)
     .set_attr<nnvm::FInferType>("FInferType", MPUpdateInferType<2, 1, 6>)
+    .set_attr<FInferStorageType>("FInferStorageType", LazyOptScaleStorageType<3, AdaBeliefParam>)
     .set_attr<nnvm::FMutateInputs>("FMutateInputs",
                                    [](const nnvm::NodeAttrs& attrs) {
                                      return std::vector<uint32_t>{2, 3, 4};
                                    })
     .set_attr<FCompute>("FCompute<cpu>", MPUpdate<cpu, MPAdaBeliefUpdate<cpu>>)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", MPUpdateEx<cpu, true>)
     .add_argument("weight", "NDArray-or-Symbol", "Weight")
     .add_argument("grad", "NDArray-or-Symbol", "Gradient")
     .add_argument("mean", "NDArray-or-Symbol", "Moving mean")
@@ -101,17 +106,22 @@ It updates the weights using::
 
 Note that gradient is rescaled to grad = rescale_grad * grad. If rescale_grad is NaN, Inf, or 0,
 the update is skipped.
-))code" ADD_FILELINE)
+
+If gradient is of ``row_sparse`` storage type and ``lazy_update`` is True,
+only the row slices whose indices appear in grad.indices are updated (for w, m and v).
+)code" ADD_FILELINE)
     .set_num_inputs(5)
     .set_num_outputs(1)
     .set_attr_parser(ParamParser<AdaBeliefParam>)
     .set_attr<mxnet::FInferShape>("FInferShape", MPUpdateInferShape<4, 1, 5>)
     .set_attr<nnvm::FInferType>("FInferType", MPUpdateInferType<4, 1, 5>)
+    .set_attr<FInferStorageType>("FInferStorageType", LazyOptScaleStorageType<2, AdaBeliefParam>)
     .set_attr<nnvm::FMutateInputs>("FMutateInputs",
                                    [](const nnvm::NodeAttrs& attrs) {
                                      return std::vector<uint32_t>{2, 3};
                                    })
     .set_attr<FCompute>("FCompute<cpu>", MPUpdate<cpu, AdaBeliefUpdate<cpu>>)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", MPUpdateEx<cpu, false>)
     .add_argument("weight", "NDArray-or-Symbol", "Weight")
     .add_argument("grad", "NDArray-or-Symbol", "Gradient")
     .add_argument("mean", "NDArray-or-Symbol", "Moving mean")
@@ -168,8 +178,15 @@ It updates the weights using::
  w -= eta * (learning_rate * m / (sqrt(s) + epsilon))
 
 Note that gradient is rescaled to grad = rescale_grad * grad. If rescale_grad is NaN, Inf, or 0,
-the update is skipped.
-))code" ADD_FILELINE)
+the update is skipped. The rescaled gradients of all the weights are further scaled down to a global
+L2 norm of max_grad_norm when it is positive, and with skip_nonfinite the update of all the weights
+is skipped when a gradient holds an Inf or a NaN. All of it is done on the device, in one pass over
+the gradients before the update of the whole group.
+
+There is no lazy update: row_sparse gradients are updated as dense ones, since the global norm
+and the skip of nonfinite gradients span all the weights. Use _adabelief_update to update a
+weight lazily with a row_sparse gradient.
+)code" ADD_FILELINE)
     .set_num_inputs([](const nnvm::NodeAttrs& attrs) { return num_weights(attrs) * 4 + 1; })
     .set_num_outputs([](const nnvm::NodeAttrs& attrs) { return num_weights(attrs); })
     .set_attr_parser(ParamParser<MultiAdaBeliefParam>)
@@ -195,6 +212,10 @@ the update is skipped.
                                      return ret;
                                    })
 
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
     .set_attr<FCompute>("FCompute<cpu>", multiMPUpdate<cpu, false>)
     .add_argument("data", "NDArray-or-Symbol[]", "data")
     .add_arguments(MultiAdaBeliefParam::__FIELDS__());
@@ -222,8 +243,15 @@ It updates the weights using::
  w -= eta * (learning_rate * m / (sqrt(s) + epsilon))
 
 Note that gradient is rescaled to grad = rescale_grad * grad. If rescale_grad is NaN, Inf, or 0,
-the update is skipped.
-))code" ADD_FILELINE)
+the update is skipped. The rescaled gradients of all the weights are further scaled down to a global
+L2 norm of max_grad_norm when it is positive, and with skip_nonfinite the update of all the weights
+is skipped when a gradient holds an Inf or a NaN. All of it is done on the device, in one pass over
+the gradients before the update of the whole group.
+
+There is no lazy update: row_sparse gradients are updated as dense ones, since the global norm
+and the skip of nonfinite gradients span all the weights. Use _mp_adabelief_update to update a
+weight lazily with a row_sparse gradient.
+)code" ADD_FILELINE)
     .set_num_inputs([](const nnvm::NodeAttrs& attrs) { return num_weights(attrs) * 5 + 1; })
     .set_num_outputs([](const nnvm::NodeAttrs& attrs) { return num_weights(attrs); })
     .set_attr_parser(ParamParser<MultiAdaBeliefParam>)
@@ -252,6 +280,10 @@ the update is skipped.
                                      return ret;
                                    })
 
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
     .set_attr<FCompute>("FCompute<cpu>", multiMPUpdate<cpu, true>)
     .add_argument("data", "NDArray-or-Symbol[]", "data")
     .add_arguments(MultiAdaBeliefParam::__FIELDS__());
@@ -41,11 +41,13 @@ void GetScaleFloat<gpu>(mshadow::Stream<gpu>* s, const TBlob& scale_blob, float*
 }  // namespace adabelief
 
 NNVM_REGISTER_OP(_adabelief_update)
-    .set_attr<FCompute>("FCompute<gpu>", adabelief::MPUpdate<gpu, adabelief::AdaBeliefUpdate<gpu>>);
+    .set_attr<FCompute>("FCompute<gpu>", adabelief::MPUpdate<gpu, adabelief::AdaBeliefUpdate<gpu>>)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", adabelief::MPUpdateEx<gpu, false>);
 
 NNVM_REGISTER_OP(_mp_adabelief_update)
     .set_attr<FCompute>("FCompute<gpu>",
-                        adabelief::MPUpdate<gpu, adabelief::MPAdaBeliefUpdate<gpu>>);
+                        adabelief::MPUpdate<gpu, adabelief::MPAdaBeliefUpdate<gpu>>)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", adabelief::MPUpdateEx<gpu, true>);
 
 NNVM_REGISTER_OP(_multi_adabelief_update)
     .set_attr<FCompute>("FCompute<gpu>", adabelief::multiMPUpdate<gpu, false>);
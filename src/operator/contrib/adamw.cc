@@ -55,17 +55,22 @@ It updates the weights using::
 
 Note that gradient is rescaled to grad = rescale_grad * grad. If rescale_grad is NaN, Inf, or 0,
 the update is skipped.
+
+If gradient is of ``row_sparse`` storage type and ``lazy_update`` is True,
+only the row slices whose indices appear in grad.indices are updated (for w, m and v).
 )code" ADD_FILELINE)
     .set_num_inputs(6)
     .set_num_outputs(1)
     .set_attr_parser(ParamParser<AdamWParam>)
     .set_attr<mxnet::FInferShape>("FInferShape", MPUpdateInferShape<2, 1, 6>)
     .set_attr<nnvm::FInferType>("FInferType", MPUpdateInferType<2, 1, 6>)
+    .set_attr<FInferStorageType>("FInferStorageType", LazyOptScaleStorageType<3, AdamWParam>)
     .set_attr<nnvm::FMutateInputs>("FMutateInputs",
                                    [](const nnvm::NodeAttrs& attrs) {
                                      return std::vector<uint32_t>{2, 3, 4};
                                    })
     .set_attr<FCompute>("FCompute<cpu>", adamw::MPUpdate<cpu, MPAdamWUpdate<cpu>>)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", adamw::MPUpdateEx<cpu, true>)
     .add_argument("weight", "NDArray-or-Symbol", "Weight")
     .add_argument("grad", "NDArray-or-Symbol", "Gradient")
     .add_argument("mean", "NDArray-or-Symbol", "Moving mean")
@@ -99,17 +104,22 @@ It updates the weights using::
 
 Note that gradient is rescaled to grad = rescale_grad * grad. If rescale_grad is NaN, Inf, or 0,
 the update is skipped.
+
+If gradient is of ``row_sparse`` storage type and ``lazy_update`` is True,
+only the row slices whose indices appear in grad.indices are updated (for w, m and v).
 )code" ADD_FILELINE)
     .set_num_inputs(5)
     .set_num_outputs(1)
     .set_attr_parser(ParamParser<AdamWParam>)
     .set_attr<mxnet::FInferShape>("FInferShape", MPUpdateInferShape<4, 1, 5>)
     .set_attr<nnvm::FInferType>("FInferType", MPUpdateInferType<4, 1, 5>)
+    .set_attr<FInferStorageType>("FInferStorageType", LazyOptScaleStorageType<2, AdamWParam>)
     .set_attr<nnvm::FMutateInputs>("FMutateInputs",
                                    [](const nnvm::NodeAttrs& attrs) {
                                      return std::vector<uint32_t>{2, 3};
                                    })
     .set_attr<FCompute>("FCompute<cpu>", adamw::MPUpdate<cpu, AdamWUpdate<cpu>>)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", adamw::MPUpdateEx<cpu, false>)
     .add_argument("weight", "NDArray-or-Symbol", "Weight")
     .add_argument("grad", "NDArray-or-Symbol", "Gradient")
     .add_argument("mean", "NDArray-or-Symbol", "Moving mean")
@@ -166,7 +176,14 @@ It updates the weights using::
  w -= eta * (learning_rate * m / (sqrt(v) + epsilon) + w * wd)
 
 Note that gradient is rescaled to grad = rescale_grad * grad. If rescale_grad is NaN, Inf, or 0,
-the update is skipped.
+the update is skipped. The rescaled gradients of all the weights are further scaled down to a global
+L2 norm of max_grad_norm when it is positive, and with skip_nonfinite the update of all the weights
+is skipped when a gradient holds an Inf or a NaN. All of it is done on the device, in one pass over
+the gradients before the update of the whole group.
+
+There is no lazy update: row_sparse gradients are updated as dense ones, since the global norm
+and the skip of nonfinite gradients span all the weights. Use _adamw_update to update a
+weight lazily with a row_sparse gradient.
 )code" ADD_FILELINE)
     .set_num_inputs([](const nnvm::NodeAttrs& attrs) { return num_weights(attrs) * 4 + 1; })
     .set_num_outputs([](const nnvm::NodeAttrs& attrs) { return num_weights(attrs); })
@@ -192,6 +209,10 @@ the update is skipped.
                                      return ret;
                                    })
 
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
     .set_attr<FCompute>("FCompute<cpu>", adamw::multiMPUpdate<cpu, false>)
     .add_argument("data", "NDArray-or-Symbol[]", "data")
     .add_arguments(MultiAdamWParam::__FIELDS__());
@@ -219,7 +240,14 @@ It updates the weights using::
  w -= eta * (learning_rate * m / (sqrt(v) + epsilon) + w * wd)
 
 Note that gradient is rescaled to grad = rescale_grad * grad. If rescale_grad is NaN, Inf, or 0,
-the update is skipped.
+the update is skipped. The rescaled gradients of all the weights are further scaled down to a global
+L2 norm of max_grad_norm when it is positive, and with skip_nonfinite the update of all the weights
+is skipped when a gradient holds an Inf or a NaN. All of it is done on the device, in one pass over
+the gradients before the update of the whole group.
+
+There is no lazy update: row_sparse gradients are updated as dense ones, since the global norm
+and the skip of nonfinite gradients span all the weights. Use _mp_adamw_update to update a
+weight lazily with a row_sparse gradient.
 )code" ADD_FILELINE)
     .set_num_inputs([](const nnvm::NodeAttrs& attrs) { return num_weights(attrs) * 5 + 1; })
     .set_num_outputs([](const nnvm::NodeAttrs& attrs) { return num_weights(attrs); })
@@ -247,6 +275,10 @@ the update is skipped.
                                      return ret;
                                    })
 
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
     .set_attr<FCompute>("FCompute<cpu>", adamw::multiMPUpdate<cpu, true>)
     .add_argument("data", "NDArray-or-Symbol[]", "data")
     .add_arguments(MultiAdamWParam::__FIELDS__());
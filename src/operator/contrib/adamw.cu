@@ -47,12 +47,14 @@ void GetScaleFloat<gpu>(mshadow::Stream<gpu>* s, const TBlob& scale_blob, float*
 NNVM_REGISTER_OP(_adamw_update)
     .set_attr<FIsCUDAGraphsCompatible>("FIsCUDAGraphsCompatible",
                                        [](const NodeAttrs&, const bool) { return false; })
-    .set_attr<FCompute>("FCompute<gpu>", adamw::MPUpdate<gpu, AdamWUpdate<gpu>>);
+    .set_attr<FCompute>("FCompute<gpu>", adamw::MPUpdate<gpu, AdamWUpdate<gpu>>)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", adamw::MPUpdateEx<gpu, false>);
 
 NNVM_REGISTER_OP(_mp_adamw_update)
     .set_attr<FIsCUDAGraphsCompatible>("FIsCUDAGraphsCompatible",
                                        [](const NodeAttrs&, const bool) { return false; })
-    .set_attr<FCompute>("FCompute<gpu>", adamw::MPUpdate<gpu, MPAdamWUpdate<gpu>>);
+    .set_attr<FCompute>("FCompute<gpu>", adamw::MPUpdate<gpu, MPAdamWUpdate<gpu>>)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", adamw::MPUpdateEx<gpu, true>);
 
 NNVM_REGISTER_OP(_multi_adamw_update)
     .set_attr<FIsCUDAGraphsCompatible>("FIsCUDAGraphsCompatible",
@@ -65,6 +65,7 @@ struct BilinearSampleParam : public dmlc::Parameter<BilinearSampleParam> {
   dmlc::optional<float> scale_width;
   int mode;
   bool align_corners;
+  int layout;
   DMLC_DECLARE_PARAMETER(BilinearSampleParam) {
     DMLC_DECLARE_FIELD(height).set_default(1).set_lower_bound(1).describe(
         "output height (required, but ignored if scale_height is defined or mode is not "
@@ -113,6 +114,11 @@ struct BilinearSampleParam : public dmlc::Parameter<BilinearSampleParam> {
         .describe(
             "With align_corners = True, the interpolating doesn't proportionally align the"
             "output and input pixels, and thus the output values can depend on the input size.");
+    DMLC_DECLARE_FIELD(layout)
+        .add_enum("NCHW", mshadow::kNCHW)
+        .add_enum("NHWC", mshadow::kNHWC)
+        .set_default(mshadow::kNCHW)
+        .describe("Layout of the input and output, and of the \"like\" input.");
   }
 };
 
@@ -172,28 +178,32 @@ template <typename xpu, typename DType, typename AccReal>
 void SpatialUpSamplingBilinearUpdateOutput(mshadow::Stream<cpu>* s,
                                            const std::vector<TBlob>& input,
                                            const std::vector<TBlob>& output,
-                                           bool align_corners);
+                                           bool align_corners,
+                                           int layout);
 
 template <typename xpu, typename DType, typename AccReal>
 void SpatialUpSamplingBilinearUpdateGradInput(mshadow::Stream<cpu>* s,
                                               const std::vector<TBlob>& input,
                                               const std::vector<TBlob>& output,
                                               bool modeLike,
-                                              bool align_corners);
+                                              bool align_corners,
+                                              int layout);
 
 #if MXNET_USE_CUDA
 template <typename xpu, typename DType, typename AccReal>
 void SpatialUpSamplingBilinearUpdateOutput(mshadow::Stream<gpu>* s,
                                            const std::vector<TBlob>& input,
                                            const std::vector<TBlob>& output,
-                                           bool align_corners);
+                                           bool align_corners,
+                                           int layout);
 
 template <typename xpu, typename DType, typename AccReal>
 void SpatialUpSamplingBilinearUpdateGradInput(mshadow::Stream<gpu>* s,
                                               const std::vector<TBlob>& input,
                                               const std::vector<TBlob>& output,
                                               bool modeLike,
-                                              bool align_corners);
+                                              bool align_corners,
+                                              int layout);
 #endif  // MXNET_USE_CUDA
 
 template <typename xpu>
@@ -215,7 +225,8 @@ inline void BilinearSampleOpForward(const nnvm::NodeAttrs& attrs,
   bool align_corners      = param.align_corners;
   mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
   MSHADOW_REAL_TYPE_SWITCH_EX(inputs[0].type_flag_, DType, AccReal, {
-    SpatialUpSamplingBilinearUpdateOutput<xpu, DType, AccReal>(s, inputs, outputs, align_corners);
+    SpatialUpSamplingBilinearUpdateOutput<xpu, DType, AccReal>(
+        s, inputs, outputs, align_corners, param.layout);
   });
 }
 
@@ -238,7 +249,7 @@ inline void BilinearSampleOpBackward(const nnvm::NodeAttrs& attrs,
   }
   MSHADOW_REAL_TYPE_SWITCH_EX(inputs[0].type_flag_, DType, AccReal, {
     SpatialUpSamplingBilinearUpdateGradInput<xpu, DType, AccReal>(
-        s, inputs, outputs, modeLike, align_corners);
+        s, inputs, outputs, modeLike, align_corners, param.layout);
   });
 }
 
@@ -253,57 +264,59 @@ static bool BilinearSampleOpInferShape(const nnvm::NodeAttrs& attrs,
   mxnet::TShape dshape(in_shape->at(0));
   if (mxnet::op::shape_is_none(dshape))
     return false;
+  const int h_axis   = param.layout == mshadow::kNHWC ? 1 : 2;
+  const int w_axis   = h_axis + 1;
   int16_t new_height = -1;
   int16_t new_width  = -1;
   switch (param.mode) {
     case bilinear_resize::simple: {
       if (param.scale_height.has_value()) {
-        new_height = static_cast<int>(param.scale_height.value() * in_shape->at(0)[2]);
+        new_height = static_cast<int>(param.scale_height.value() * dshape[h_axis]);
       } else {
         new_height = param.height;
       }
       if (param.scale_height.has_value()) {
-        new_width = static_cast<int>(param.scale_width.value() * in_shape->at(0)[3]);
+        new_width = static_cast<int>(param.scale_width.value() * dshape[w_axis]);
       } else {
         new_width = param.width;
       }
       break;
     }
     case bilinear_resize::odd_scale: {
-      new_height = ((dshape[2] % 2) == 0) ?
-                       (int16_t)(dshape[2] * param.scale_height.value()) :
-                       (int16_t)((dshape[2] - 1) * param.scale_height.value()) + 1;
-      new_width = ((dshape[3] % 2) == 0) ?
-                      (int16_t)(dshape[3] * param.scale_width.value()) :
-                      (int16_t)((dshape[3] - 1) * param.scale_width.value()) + 1;
+      new_height = ((dshape[h_axis] % 2) == 0) ?
+                       (int16_t)(dshape[h_axis] * param.scale_height.value()) :
+                       (int16_t)((dshape[h_axis] - 1) * param.scale_height.value()) + 1;
+      new_width = ((dshape[w_axis] % 2) == 0) ?
+                      (int16_t)(dshape[w_axis] * param.scale_width.value()) :
+                      (int16_t)((dshape[w_axis] - 1) * param.scale_width.value()) + 1;
       break;
     }
     case bilinear_resize::like: {
       TShape like_shape(in_shape->at(1));
       if (dshape.ndim() == 0)
         return false;
-      new_height = like_shape[2];
-      new_width  = like_shape[3];
+      new_height = like_shape[h_axis];
+      new_width  = like_shape[w_axis];
       break;
     }
     case bilinear_resize::to_even_down: {
-      new_height = ((dshape[2] % 2) == 0) ? dshape[2] : dshape[2] - 1;
-      new_width  = ((dshape[3] % 2) == 0) ? dshape[3] : dshape[3] - 1;
+      new_height = ((dshape[h_axis] % 2) == 0) ? dshape[h_axis] : dshape[h_axis] - 1;
+      new_width  = ((dshape[w_axis] % 2) == 0) ? dshape[w_axis] : dshape[w_axis] - 1;
       break;
     }
     case bilinear_resize::to_even_up: {
-      new_height = ((dshape[2] % 2) == 0) ? dshape[2] : dshape[2] + 1;
-      new_width  = ((dshape[3] % 2) == 0) ? dshape[3] : dshape[3] + 1;
+      new_height = ((dshape[h_axis] % 2) == 0) ? dshape[h_axis] : dshape[h_axis] + 1;
+      new_width  = ((dshape[w_axis] % 2) == 0) ? dshape[w_axis] : dshape[w_axis] + 1;
       break;
     }
     case bilinear_resize::to_odd_down: {
-      new_height = ((dshape[2] % 2) == 1) ? dshape[2] : dshape[2] - 1;
-      new_width  = ((dshape[3] % 2) == 1) ? dshape[3] : dshape[3] - 1;
+      new_height = ((dshape[h_axis] % 2) == 1) ? dshape[h_axis] : dshape[h_axis] - 1;
+      new_width  = ((dshape[w_axis] % 2) == 1) ? dshape[w_axis] : dshape[w_axis] - 1;
       break;
     }
     case bilinear_resize::to_odd_up: {
-      new_height = ((dshape[2] % 2) == 1) ? dshape[2] : dshape[2] + 1;
-      new_width  = ((dshape[3] % 2) == 1) ? dshape[3] : dshape[3] + 1;
+      new_height = ((dshape[h_axis] % 2) == 1) ? dshape[h_axis] : dshape[h_axis] + 1;
+      new_width  = ((dshape[w_axis] % 2) == 1) ? dshape[w_axis] : dshape[w_axis] + 1;
       break;
     }
     default: {
@@ -311,8 +324,8 @@ static bool BilinearSampleOpInferShape(const nnvm::NodeAttrs& attrs,
     }
   }
 
-  dshape[2] = new_height;
-  dshape[3] = new_width;
+  dshape[h_axis] = new_height;
+  dshape[w_axis] = new_width;
 
   out_shape->clear();
   out_shape->push_back(dshape);
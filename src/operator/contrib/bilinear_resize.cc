@@ -22,6 +22,7 @@
  * \author Hang Zhang
  */
 #include "bilinear_resize-inl.h"
+#include <algorithm>
 #include "../elemwise_op_common.h"
 
 namespace mxnet {
@@ -29,74 +30,110 @@ namespace op {
 
 using namespace mshadow;
 
+/*!
+ * \brief Source positions and weights of the output positions along one axis, computed once
+ *        per call instead of once per output pixel.
+ */
+template <typename DType>
+struct BilinearAxisTable {
+  std::vector<int> index0;
+  std::vector<int> index1;
+  std::vector<DType> lambda0;
+  std::vector<DType> lambda1;
+
+  BilinearAxisTable(int input_size, int output_size, bool align_corners)
+      : index0(output_size), index1(output_size), lambda0(output_size), lambda1(output_size) {
+    const float scale = area_pixel_compute_scale<float>(input_size, output_size, align_corners);
+    for (int o = 0; o < output_size; ++o) {
+      const float r = area_pixel_compute_source_index<float>(scale, o, align_corners, false);
+      const int i   = r;
+      index0[o]     = i;
+      index1[o]     = i + ((i < input_size - 1) ? 1 : 0);
+      lambda1[o]    = r - i;
+      lambda0[o]    = (DType)1. - lambda1[o];
+    }
+  }
+};
+
+/*! \brief Number of channel blocks per image which the NHWC backward pass is split in */
+inline int ChannelBlocks(int nbatch, int channels, int nthreads) {
+  return std::max(1, std::min(channels, (nthreads + nbatch - 1) / nbatch));
+}
+
 template <typename xpu, typename DType, typename AccReal>
 void SpatialUpSamplingBilinearUpdateOutput(mshadow::Stream<cpu>* s,
                                            const std::vector<TBlob>& input,
                                            const std::vector<TBlob>& output,
-                                           bool align_corners) {
+                                           bool align_corners,
+                                           int layout) {
   Tensor<xpu, 4, DType> itensor = input[0].get<xpu, 4, DType>(s);
   Tensor<xpu, 4, DType> otensor = output[0].get<xpu, 4, DType>(s);
-  int nbatch                    = otensor.size(0);
-  int channels                  = otensor.size(1);
-  int outputHeight              = otensor.size(2);
-  int outputWidth               = otensor.size(3);
-  int inputHeight               = itensor.size(2);
-  int inputWidth                = itensor.size(3);
+  const bool nhwc               = layout == mshadow::kNHWC;
+  const int nbatch              = otensor.size(0);
+  const int channels            = otensor.size(nhwc ? 3 : 1);
+  const int outputHeight        = otensor.size(nhwc ? 1 : 2);
+  const int outputWidth         = otensor.size(nhwc ? 2 : 3);
+  const int inputHeight         = itensor.size(nhwc ? 1 : 2);
+  const int inputWidth          = itensor.size(nhwc ? 2 : 3);
 
   const auto nthreads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
 
-  DType* idata                       = itensor.dptr_;
-  DType* odata                       = otensor.dptr_;
-  channels                           = nbatch * channels;
-  const int input_elems_per_channel  = inputWidth * inputHeight;
-  const int output_elems_per_channel = outputWidth * outputHeight;
+  const DType* idata = itensor.dptr_;
+  DType* odata       = otensor.dptr_;
 
   // special case: just copy
   if (inputHeight == outputHeight && inputWidth == outputWidth) {
+    const index_t size = otensor.shape_.Size();
 #pragma omp parallel for num_threads(nthreads)
-    for (int index = 0; index < output_elems_per_channel; index++) {
-      const int h2      = index / outputWidth;
-      const int h1      = h2;
-      const int w2      = index % outputWidth;
-      const int w1      = w2;
-      const DType* pos1 = &idata[h1 * inputWidth + w1];
-      DType* pos2       = &odata[index];
-      for (int c = 0; c < channels; ++c) {
-        *pos2 = *pos1;
-        pos1 += input_elems_per_channel;
-        pos2 += output_elems_per_channel;
-      }
+    for (index_t i = 0; i < size; ++i) {
+      odata[i] = idata[i];
     }
     return;
   }
-  const float rheight = area_pixel_compute_scale<float>(inputHeight, outputHeight, align_corners);
-  const float rwidth  = area_pixel_compute_scale<float>(inputWidth, outputWidth, align_corners);
+  const BilinearAxisTable<DType> rows(inputHeight, outputHeight, align_corners);
+  const BilinearAxisTable<DType> cols(inputWidth, outputWidth, align_corners);
+  const int* w0      = cols.index0.data();
+  const int* w1      = cols.index1.data();
+  const DType* w0l   = cols.lambda0.data();
+  const DType* w1l   = cols.lambda1.data();
+  const int num_rows = nbatch * (nhwc ? 1 : channels) * outputHeight;
 
+  // each task is an output row, of a plane for NCHW and of an image for NHWC
 #pragma omp parallel for num_threads(nthreads)
-  for (int index = 0; index < output_elems_per_channel; index++) {
-    const int h2 = index / outputWidth;
-    const int w2 = index % outputWidth;
-
-    const float h1r = area_pixel_compute_source_index<float>(rheight, h2, align_corners, false);
-    const int h1    = h1r;
-    const int h1p   = (h1 < inputHeight - 1) ? 1 : 0;
-    const DType h1lambda = h1r - h1;
-    const DType h0lambda = (DType)1. - h1lambda;
-
-    const float w1r      = area_pixel_compute_source_index<float>(rwidth, w2, align_corners, false);
-    const int w1         = w1r;
-    const int w1p        = (w1 < inputWidth - 1) ? 1 : 0;
-    const DType w1lambda = w1r - w1;
-    const DType w0lambda = (DType)1. - w1lambda;
-    const DType* pos1    = &idata[h1 * inputWidth + w1];
-    DType* pos2          = &odata[index];
-
-    for (int c = 0; c < channels; ++c) {
-      *pos2 = h0lambda * (w0lambda * (*pos1) + w1lambda * *(pos1 + w1p)) +
-              h1lambda * (w0lambda * *(pos1 + h1p * inputWidth) +
-                          w1lambda * *(pos1 + h1p * inputWidth + w1p));
-      pos1 += input_elems_per_channel;
-      pos2 += output_elems_per_channel;
+  for (int task = 0; task < num_rows; ++task) {
+    const int plane      = task / outputHeight;
+    const int h2         = task % outputHeight;
+    const DType h0lambda = rows.lambda0[h2];
+    const DType h1lambda = rows.lambda1[h2];
+    if (nhwc) {
+      const index_t row_elems = static_cast<index_t>(inputWidth) * channels;
+      const DType* image      = idata + static_cast<index_t>(plane) * inputHeight * row_elems;
+      const DType* row0       = image + rows.index0[h2] * row_elems;
+      const DType* row1       = image + rows.index1[h2] * row_elems;
+      DType* out              = odata + static_cast<index_t>(task) * outputWidth * channels;
+      for (int w2 = 0; w2 < outputWidth; ++w2, out += channels) {
+        const DType* p00     = row0 + w0[w2] * channels;
+        const DType* p01     = row0 + w1[w2] * channels;
+        const DType* p10     = row1 + w0[w2] * channels;
+        const DType* p11     = row1 + w1[w2] * channels;
+        const DType w0lambda = w0l[w2];
+        const DType w1lambda = w1l[w2];
+        // contiguous across the channels
+        for (int c = 0; c < channels; ++c) {
+          out[c] = h0lambda * (w0lambda * p00[c] + w1lambda * p01[c]) +
+                   h1lambda * (w0lambda * p10[c] + w1lambda * p11[c]);
+        }
+      }
+    } else {
+      const DType* image = idata + static_cast<index_t>(plane) * inputHeight * inputWidth;
+      const DType* row0  = image + rows.index0[h2] * inputWidth;
+      const DType* row1  = image + rows.index1[h2] * inputWidth;
+      DType* out         = odata + static_cast<index_t>(task) * outputWidth;
+      // across the width, with the source columns gathered through the table
+      for (int w2 = 0; w2 < outputWidth; ++w2) {
+        out[w2] = h0lambda * (w0l[w2] * row0[w0[w2]] + w1l[w2] * row0[w1[w2]]) +
+                  h1lambda * (w0l[w2] * row1[w0[w2]] + w1l[w2] * row1[w1[w2]]);
+      }
     }
   }
 }
@@ -106,92 +143,98 @@ void SpatialUpSamplingBilinearUpdateGradInput(mshadow::Stream<cpu>* s,
                                               const std::vector<TBlob>& input,
                                               const std::vector<TBlob>& output,
                                               bool modeLike,
-                                              bool align_corners) {
+                                              bool align_corners,
+                                              int layout) {
   Tensor<xpu, 4, DType> gradOutput = input[0].get<xpu, 4, DType>(s);
   Tensor<xpu, 4, DType> gradInput  = output[0].get<xpu, 4, DType>(s);
-
-  int nbatch       = gradInput.size(0);
-  int channels     = gradInput.size(1);
-  int outputHeight = gradOutput.size(2);
-  int outputWidth  = gradOutput.size(3);
-  int inputHeight  = gradInput.size(2);
-  int inputWidth   = gradInput.size(3);
+  const bool nhwc                  = layout == mshadow::kNHWC;
+  const int nbatch                 = gradInput.size(0);
+  const int channels               = gradInput.size(nhwc ? 3 : 1);
+  const int outputHeight           = gradOutput.size(nhwc ? 1 : 2);
+  const int outputWidth            = gradOutput.size(nhwc ? 2 : 3);
+  const int inputHeight            = gradInput.size(nhwc ? 1 : 2);
+  const int inputWidth             = gradInput.size(nhwc ? 2 : 3);
 
   const auto nthreads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
 
-  DType* dataInput                   = gradInput.dptr_;
-  DType* dataOutput                  = gradOutput.dptr_;
-  channels                           = nbatch * channels;
-  const int input_elems_per_channel  = inputWidth * inputHeight;
-  const int output_elems_per_channel = outputWidth * outputHeight;
+  DType* dataInput        = gradInput.dptr_;
+  const DType* dataOutput = gradOutput.dptr_;
 
   // special case: same-size matching grids
   if (inputHeight == outputHeight && inputWidth == outputWidth) {
+    const index_t size = gradInput.shape_.Size();
 #pragma omp parallel for num_threads(nthreads)
-    for (int index = 0; index < output_elems_per_channel; index++) {
-      const int h2      = index / outputWidth;
-      const int h1      = h2;
-      const int w2      = index % outputWidth;
-      const int w1      = w2;
-      DType* pos1       = &dataInput[h1 * inputWidth + w1];
-      const DType* pos2 = &dataOutput[index];
-      for (int c = 0; c < channels; ++c) {
-        *pos1 += *pos2;
-        pos1 += input_elems_per_channel;
-        pos2 += output_elems_per_channel;
-      }
+    for (index_t i = 0; i < size; ++i) {
+      dataInput[i] += dataOutput[i];
     }
-    return;
-  }
-  const float rheight = area_pixel_compute_scale<float>(inputHeight, outputHeight, align_corners);
-  const float rwidth  = area_pixel_compute_scale<float>(inputWidth, outputWidth, align_corners);
+  } else {
+    const BilinearAxisTable<DType> rows(inputHeight, outputHeight, align_corners);
+    const BilinearAxisTable<DType> cols(inputWidth, outputWidth, align_corners);
+    const int* w0    = cols.index0.data();
+    const int* w1    = cols.index1.data();
+    const DType* w0l = cols.lambda0.data();
+    const DType* w1l = cols.lambda1.data();
+    // each task scatters into its own input elements, so that no two tasks write to the same:
+    // a plane for NCHW, a block of channels of an image for NHWC
+    const int blocks     = nhwc ? ChannelBlocks(nbatch, channels, nthreads) : 1;
+    const int block_size = (channels + blocks - 1) / blocks;
+    const int num_tasks  = nbatch * (nhwc ? blocks : channels);
 #pragma omp parallel for num_threads(nthreads)
-  for (int index = 0; index < output_elems_per_channel; index++) {
-    const int h2 = index / outputWidth;
-    const int w2 = index % outputWidth;
-
-    const float h1r = area_pixel_compute_source_index<float>(rheight, h2, align_corners, false);
-    const int h1    = h1r;
-    const int h1p   = (h1 < inputHeight - 1) ? 1 : 0;
-    const DType h1lambda = h1r - h1;
-    const DType h0lambda = (DType)1. - h1lambda;
-
-    const float w1r      = area_pixel_compute_source_index<float>(rwidth, w2, align_corners, false);
-    const int w1         = w1r;
-    const int w1p        = (w1 < inputWidth - 1) ? 1 : 0;
-    const DType w1lambda = w1r - w1;
-    const DType w0lambda = (DType)1. - w1lambda;
-
-    DType* posInput        = &dataInput[h1 * inputWidth + w1];
-    const DType* posOutput = &dataOutput[index];
-    for (int c = 0; c < channels; ++c) {
-#pragma omp critical
-      {
-        *posInput += h0lambda * w0lambda * (*posOutput);
-        *(posInput + w1p) += h0lambda * w1lambda * (*posOutput);
-        *(posInput + h1p * inputWidth) += h1lambda * w0lambda * (*posOutput);
-        *(posInput + h1p * inputWidth + w1p) += h1lambda * w1lambda * (*posOutput);
+    for (int task = 0; task < num_tasks; ++task) {
+      if (nhwc) {
+        const int n             = task / blocks;
+        const int c_begin       = (task % blocks) * block_size;
+        const int c_end         = std::min(channels, c_begin + block_size);
+        const index_t row_elems = static_cast<index_t>(inputWidth) * channels;
+        DType* image            = dataInput + static_cast<index_t>(n) * inputHeight * row_elems;
+        const DType* grad       = dataOutput + static_cast<index_t>(n) * outputHeight *
+                                                   outputWidth * channels;
+        for (int h2 = 0; h2 < outputHeight; ++h2) {
+          DType* row0          = image + rows.index0[h2] * row_elems;
+          DType* row1          = image + rows.index1[h2] * row_elems;
+          const DType h0lambda = rows.lambda0[h2];
+          const DType h1lambda = rows.lambda1[h2];
+          for (int w2 = 0; w2 < outputWidth; ++w2, grad += channels) {
+            DType* p00           = row0 + w0[w2] * channels;
+            DType* p01           = row0 + w1[w2] * channels;
+            DType* p10           = row1 + w0[w2] * channels;
+            DType* p11           = row1 + w1[w2] * channels;
+            const DType w0lambda = w0l[w2];
+            const DType w1lambda = w1l[w2];
+            for (int c = c_begin; c < c_end; ++c) {
+              p00[c] += h0lambda * w0lambda * grad[c];
+              p01[c] += h0lambda * w1lambda * grad[c];
+              p10[c] += h1lambda * w0lambda * grad[c];
+              p11[c] += h1lambda * w1lambda * grad[c];
+            }
+          }
+        }
+      } else {
+        DType* image      = dataInput + static_cast<index_t>(task) * inputHeight * inputWidth;
+        const DType* grad = dataOutput + static_cast<index_t>(task) * outputHeight * outputWidth;
+        for (int h2 = 0; h2 < outputHeight; ++h2, grad += outputWidth) {
+          DType* row0          = image + rows.index0[h2] * inputWidth;
+          DType* row1          = image + rows.index1[h2] * inputWidth;
+          const DType h0lambda = rows.lambda0[h2];
+          const DType h1lambda = rows.lambda1[h2];
+          for (int w2 = 0; w2 < outputWidth; ++w2) {
+            row0[w0[w2]] += h0lambda * w0l[w2] * grad[w2];
+            row0[w1[w2]] += h0lambda * w1l[w2] * grad[w2];
+            row1[w0[w2]] += h1lambda * w0l[w2] * grad[w2];
+            row1[w1[w2]] += h1lambda * w1l[w2] * grad[w2];
+          }
+        }
       }
-      posInput += input_elems_per_channel;
-      posOutput += output_elems_per_channel;
     }
   }
 
   if (modeLike) {
     Tensor<xpu, 4, DType> gradInputLike = output[1].get<xpu, 4, DType>(s);
-    int inputHeightLike                 = gradInputLike.size(2);
-    int inputWidthLike                  = gradInputLike.size(3);
     DType* dataInputLike                = gradInputLike.dptr_;
-    int channelsLike                    = nbatch * gradInputLike.size(1);
-
-    const int inputLike_elems_per_channel = inputHeightLike * inputWidthLike;
+    const index_t size                  = gradInputLike.shape_.Size();
 #pragma omp parallel for num_threads(nthreads)
-    for (int index = 0; index < inputLike_elems_per_channel; index++) {
-      DType* posInput = &dataInputLike[index];
-      for (int c = 0; c < channelsLike; ++c) {
-        *posInput = 0;
-        posInput += inputLike_elems_per_channel;
-      }
+    for (index_t i = 0; i < size; ++i) {
+      dataInputLike[i] = 0;
     }
   }
 }
@@ -202,8 +245,8 @@ NNVM_REGISTER_OP(_contrib_BilinearResize2D)
     .describe(R"code(
 Perform 2D resizing (upsampling or downsampling) for 4D input using bilinear interpolation.
 
-Expected input is a 4 dimensional NDArray (NCHW) and the output
-with the shape of (N x C x height x width). 
+Expected input is a 4 dimensional NDArray (NCHW, or NHWC with layout="NHWC") and the output
+with the shape of (N x C x height x width), or (N x height x width x C). 
 The key idea of bilinear interpolation is to perform linear interpolation
 first in one direction, and then again in the other direction. See the wikipedia of
 `Bilinear interpolation  <https://en.wikipedia.org/wiki/Bilinear_interpolation>`_
@@ -168,30 +168,98 @@ __global__ void caffe_gpu_interp2_kernel_backward(const size_t nc,
   }
 }
 
+// Backward (adjoint) operation 1 <- 2 (accumulates) of NHWC data
+template <typename xpu, typename Dtype, typename Acctype>
+__global__ void caffe_gpu_interp2_kernel_backward_nhwc(const size_t n,
+                                                       const int channels,
+                                                       const int height1,
+                                                       const int width1,
+                                                       const int height2,
+                                                       const int width2,
+                                                       const Acctype rheight,
+                                                       const Acctype rwidth,
+                                                       const bool align_corners,
+                                                       Dtype* __restrict__ idata,
+                                                       const Dtype* __restrict__ odata) {
+  const size_t o_numel = n * height2 * width2 * channels;
+  const size_t i_numel = n * height1 * width1 * channels;
+  for (size_t index = blockDim.x * blockIdx.x + threadIdx.x; index < o_numel;
+       index += blockDim.x * gridDim.x) {
+    size_t index_temp = index;
+    const int c       = index_temp % channels;
+    index_temp /= channels;
+    const int w2 = index_temp % width2;
+    index_temp /= width2;
+    const int h2     = index_temp % height2;
+    const size_t img = index_temp / height2;
+
+    const Acctype h1r =
+        cu_area_pixel_compute_source_index<Acctype>(rheight, h2, align_corners, false);
+    const int h1           = h1r;
+    const int h1p          = (h1 < height1 - 1) ? 1 : 0;
+    const Acctype h1lambda = h1r - h1;
+    const Acctype h0lambda = static_cast<Acctype>(1) - h1lambda;
+
+    const Acctype w1r =
+        cu_area_pixel_compute_source_index<Acctype>(rwidth, w2, align_corners, false);
+    const int w1           = w1r;
+    const int w1p          = (w1 < width1 - 1) ? 1 : 0;
+    const Acctype w1lambda = w1r - w1;
+    const Acctype w0lambda = static_cast<Acctype>(1) - w1lambda;
+
+    const Dtype d2val = odata[index];
+    const size_t i00  = idx(img, height1, width1, h1, w1) * channels + c;
+    const size_t i01  = i00 + w1p * channels;
+    const size_t i10  = i00 + h1p * width1 * channels;
+    const size_t i11  = i10 + w1p * channels;
+    fastAtomicAdd(
+        idata, i00, i_numel, ScalarConvert<Acctype, Dtype>::to(h0lambda * w0lambda * d2val), true);
+    fastAtomicAdd(
+        idata, i01, i_numel, ScalarConvert<Acctype, Dtype>::to(h0lambda * w1lambda * d2val), true);
+    fastAtomicAdd(
+        idata, i10, i_numel, ScalarConvert<Acctype, Dtype>::to(h1lambda * w0lambda * d2val), true);
+    fastAtomicAdd(
+        idata, i11, i_numel, ScalarConvert<Acctype, Dtype>::to(h1lambda * w1lambda * d2val), true);
+  }
+}
+
 template <typename xpu, typename DType, typename AccReal>
 void SpatialUpSamplingBilinearUpdateOutput(mshadow::Stream<gpu>* s,
                                            const std::vector<TBlob>& input,
                                            const std::vector<TBlob>& output,
-                                           bool align_corners) {
+                                           bool align_corners,
+                                           int layout) {
   Tensor<xpu, 4, DType> idata = input[0].get<xpu, 4, DType>(s);
   Tensor<xpu, 4, DType> odata = output[0].get<xpu, 4, DType>(s);
-  int outputHeight            = odata.size(2);
-  int outputWidth             = odata.size(3);
+  const bool nhwc             = layout == mshadow::kNHWC;
+  int outputHeight            = odata.size(nhwc ? 1 : 2);
+  int outputWidth             = odata.size(nhwc ? 2 : 3);
   int nbatch                  = idata.size(0);
-  int channels                = idata.size(1);
-  int inputHeight             = idata.size(2);
-  int inputWidth              = idata.size(3);
+  int channels                = idata.size(nhwc ? 3 : 1);
+  int inputHeight             = idata.size(nhwc ? 1 : 2);
+  int inputWidth              = idata.size(nhwc ? 2 : 3);
 
   const AccReal rheight =
       cu_area_pixel_compute_scale<AccReal>(inputHeight, outputHeight, align_corners);
   const AccReal rwidth =
       cu_area_pixel_compute_scale<AccReal>(inputWidth, outputWidth, align_corners);
 
+  cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
+  if (nhwc) {
+    // one thread per output pixel, over the images and the channels
+    const int num_kernels = outputHeight * outputWidth;
+    const int num_threads = getNumThreads(inputHeight * inputWidth, false);
+    dim3 blocks(static_cast<int>(num_kernels / num_threads) + 1);
+    dim3 threads(num_threads);
+    caffe_gpu_interp2_kernel<xpu, DType, AccReal><<<blocks, threads, 0, stream>>>(
+        num_kernels, rheight, rwidth, align_corners, idata, odata);
+    MSHADOW_CUDA_POST_KERNEL_CHECK(SpatialUpSamplingBilinearUpdateOutput);
+    return;
+  }
   const int num_kernels = nbatch * channels * outputHeight * outputWidth;
   const int num_threads = getNumThreads(inputHeight * inputWidth, false);
   dim3 blocks(static_cast<int>(num_kernels / num_threads) + 1);
   dim3 threads(num_threads);
-  cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
   caffe_gpu_interp2_kernel<xpu, DType, AccReal><<<blocks, threads, 0, stream>>>(nbatch * channels,
                                                                                 inputHeight,
                                                                                 inputWidth,
@@ -210,15 +278,17 @@ void SpatialUpSamplingBilinearUpdateGradInput(mshadow::Stream<gpu>* s,
                                               const std::vector<TBlob>& input,
                                               const std::vector<TBlob>& output,
                                               bool modeLike,
-                                              bool align_corners) {
+                                              bool align_corners,
+                                              int layout) {
   Tensor<xpu, 4, DType> gradOutput = input[0].get<xpu, 4, DType>(s);
   Tensor<xpu, 4, DType> gradInput  = output[0].get<xpu, 4, DType>(s);
-  int outputHeight                 = gradOutput.size(2);
-  int outputWidth                  = gradOutput.size(3);
+  const bool nhwc                  = layout == mshadow::kNHWC;
+  int outputHeight                 = gradOutput.size(nhwc ? 1 : 2);
+  int outputWidth                  = gradOutput.size(nhwc ? 2 : 3);
   int nbatch                       = gradInput.size(0);
-  int channels                     = gradInput.size(1);
-  int inputHeight                  = gradInput.size(2);
-  int inputWidth                   = gradInput.size(3);
+  int channels                     = gradInput.size(nhwc ? 3 : 1);
+  int inputHeight                  = gradInput.size(nhwc ? 1 : 2);
+  int inputWidth                   = gradInput.size(nhwc ? 2 : 3);
 
   const AccReal rheight =
       cu_area_pixel_compute_scale<AccReal>(inputHeight, outputHeight, align_corners);
@@ -229,17 +299,32 @@ void SpatialUpSamplingBilinearUpdateGradInput(mshadow::Stream<gpu>* s,
   dim3 blocks(static_cast<int>(num_kernels / num_threads) + 1);
   dim3 threads(num_threads);
   cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
-  caffe_gpu_interp2_kernel_backward<xpu, DType, AccReal>
-      <<<blocks, threads, 0, stream>>>(nbatch * channels,
-                                       inputHeight,
-                                       inputWidth,
-                                       outputHeight,
-                                       outputWidth,
-                                       rheight,
-                                       rwidth,
-                                       align_corners,
-                                       gradInput.dptr_,
-                                       gradOutput.dptr_);
+  if (nhwc) {
+    caffe_gpu_interp2_kernel_backward_nhwc<xpu, DType, AccReal>
+        <<<blocks, threads, 0, stream>>>(nbatch,
+                                         channels,
+                                         inputHeight,
+                                         inputWidth,
+                                         outputHeight,
+                                         outputWidth,
+                                         rheight,
+                                         rwidth,
+                                         align_corners,
+                                         gradInput.dptr_,
+                                         gradOutput.dptr_);
+  } else {
+    caffe_gpu_interp2_kernel_backward<xpu, DType, AccReal>
+        <<<blocks, threads, 0, stream>>>(nbatch * channels,
+                                         inputHeight,
+                                         inputWidth,
+                                         outputHeight,
+                                         outputWidth,
+                                         rheight,
+                                         rwidth,
+                                         align_corners,
+                                         gradInput.dptr_,
+                                         gradOutput.dptr_);
+  }
 
   if (modeLike) {
     Tensor<xpu, 4, DType> dataLike = output[1].get<xpu, 4, DType>(s);
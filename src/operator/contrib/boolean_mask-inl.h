@@ -35,6 +35,7 @@
 #include "../operator_common.h"
 #include "../mxnet_op.h"
 #include "../tensor/init_op.h"
+#include "../tensor/prefix_count-inl.h"
 #include "../mshadow_op.h"
 #include "../elemwise_op_common.h"
 
@@ -49,6 +50,18 @@ struct BooleanMaskParam : public dmlc::Parameter<BooleanMaskParam> {
   }
 };
 
+struct BoundedBooleanMaskParam : public dmlc::Parameter<BoundedBooleanMaskParam> {
+  int axis;
+  double fill_value;
+  DMLC_DECLARE_PARAMETER(BoundedBooleanMaskParam) {
+    DMLC_DECLARE_FIELD(axis).set_default(0).describe(
+        "An integer that represents the axis in NDArray to mask from.");
+    DMLC_DECLARE_FIELD(fill_value)
+        .set_default(0)
+        .describe("Value of the rows of the output past the selected ones.");
+  }
+};
+
 struct BooleanMaskForwardCPUKernel {
   template <typename DType>
   static void Map(int i, DType* out, const DType* data, const int32_t* idx, const size_t col_size) {
@@ -104,6 +117,16 @@ struct BooleanMaskBackwardKernel {
   }
 };
 
+/*! \brief Write the number of selected rows, the last of the inclusive prefix sum */
+struct BooleanMaskValidNumKernel {
+  MSHADOW_XINLINE static void Map(int i,
+                                  int64_t* valid_num,
+                                  const int32_t* prefix_sum,
+                                  const index_t idx_size) {
+    valid_num[0] = idx_size > 0 ? prefix_sum[idx_size - 1] : 0;
+  }
+};
+
 template <typename xpu>
 inline void BooleanMaskForward(const nnvm::NodeAttrs& attrs,
                                const OpContext& ctx,
@@ -118,6 +141,17 @@ inline void BooleanMaskBackward(const nnvm::NodeAttrs& attrs,
                                 const std::vector<OpReqType>& req,
                                 const std::vector<NDArray>& outputs);
 
+/*!
+ * \brief Boolean mask into an output of the shape of the data, with the number of selected rows
+ *        as a second output on the device, so that nothing waits on the mask on the host.
+ */
+template <typename xpu>
+void BoundedBooleanMaskForward(const nnvm::NodeAttrs& attrs,
+                               const OpContext& ctx,
+                               const std::vector<TBlob>& inputs,
+                               const std::vector<OpReqType>& req,
+                               const std::vector<TBlob>& outputs);
+
 }  // namespace op
 }  // namespace mxnet
 
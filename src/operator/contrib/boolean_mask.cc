@@ -26,6 +26,7 @@ namespace mxnet {
 namespace op {
 
 DMLC_REGISTER_PARAMETER(BooleanMaskParam);
+DMLC_REGISTER_PARAMETER(BoundedBooleanMaskParam);
 
 bool BooleanMaskType(const nnvm::NodeAttrs& attrs,
                      std::vector<int>* in_attrs,
@@ -120,12 +121,9 @@ inline void BooleanMaskForward<cpu>(const nnvm::NodeAttrs& attrs,
   size_t valid_num = 0;
   // Calculate prefix sum
   MSHADOW_TYPE_SWITCH_WITH_BOOL(idx.dtype(), DType, {
-    DType* idx_dptr = idx.data().dptr<DType>();
-    for (size_t i = 0; i < idx_size; i++) {
-      prefix_sum[i] = (i == 0) ? 0 : prefix_sum[i - 1];
-      prefix_sum[i] += (idx_dptr[i]) ? 1 : 0;
-    }
-    valid_num = prefix_sum[idx_size - 1];
+    const DType* idx_dptr = idx.data().dptr<DType>();
+    auto is_selected      = [idx_dptr](index_t i) { return idx_dptr[i] ? true : false; };
+    valid_num             = PrefixCountCPU(idx_size, is_selected, prefix_sum.data());
   });
   // set the output shape forcefully
   mxnet::TShape s = data.shape();
@@ -167,11 +165,9 @@ inline void BooleanMaskBackward<cpu>(const nnvm::NodeAttrs& attrs,
       size_t idx_size   = idx.shape()[0];
       size_t col_size   = input_size / idx_size;
       std::vector<int32_t> prefix_sum(idx_size, 0);
-      IType* idx_dptr = idx.data().dptr<IType>();
-      for (size_t i = 0; i < idx_size; i++) {
-        prefix_sum[i] = (i == 0) ? 0 : prefix_sum[i - 1];
-        prefix_sum[i] += (idx_dptr[i]) ? 1 : 0;
-      }
+      const IType* idx_dptr = idx.data().dptr<IType>();
+      auto is_selected      = [idx_dptr](index_t i) { return idx_dptr[i] ? true : false; };
+      PrefixCountCPU(idx_size, is_selected, prefix_sum.data());
       mshadow::Stream<cpu>* stream = ctx.get_stream<cpu>();
       if (req[0] == kAddTo) {
         mxnet_op::Kernel<BooleanMaskBackwardKernel, cpu>::Launch(stream,
@@ -195,6 +191,41 @@ inline void BooleanMaskBackward<cpu>(const nnvm::NodeAttrs& attrs,
   });
 }
 
+template <>
+void BoundedBooleanMaskForward<cpu>(const nnvm::NodeAttrs& attrs,
+                                    const OpContext& ctx,
+                                    const std::vector<TBlob>& inputs,
+                                    const std::vector<OpReqType>& req,
+                                    const std::vector<TBlob>& outputs) {
+  CHECK_EQ(inputs.size(), 2U);
+  CHECK_EQ(outputs.size(), 2U);
+  CHECK(req[0] == kWriteTo || req[0] == kWriteInplace);
+  const BoundedBooleanMaskParam& param = nnvm::get<BoundedBooleanMaskParam>(attrs.parsed);
+  const TBlob& data                    = inputs[0];
+  const TBlob& idx                     = inputs[1];
+  CHECK_EQ(param.axis, 0) << "Not supported yet";
+  mshadow::Stream<cpu>* s = ctx.get_stream<cpu>();
+  const size_t idx_size   = idx.shape_[0];
+  const size_t col_size   = idx_size > 0 ? data.Size() / idx_size : 0;
+  std::vector<int32_t> prefix_sum(idx_size, 0);
+  MSHADOW_TYPE_SWITCH_WITH_BOOL(idx.type_flag_, IType, {
+    const IType* idx_dptr = idx.dptr<IType>();
+    auto is_selected      = [idx_dptr](index_t i) { return idx_dptr[i] ? true : false; };
+    PrefixCountCPU(idx_size, is_selected, prefix_sum.data());
+  });
+  Fill(s, outputs[0], kWriteTo, param.fill_value);
+  MSHADOW_TYPE_SWITCH_EXT_WITH_BOOL(data.type_flag_, DType, {
+    mxnet_op::Kernel<BooleanMaskForwardCPUKernel, cpu>::Launch(s,
+                                                               idx_size,
+                                                               outputs[0].dptr<DType>(),
+                                                               data.dptr<DType>(),
+                                                               prefix_sum.data(),
+                                                               col_size);
+  });
+  mxnet_op::Kernel<BooleanMaskValidNumKernel, cpu>::Launch(
+      s, 1, outputs[1].dptr<int64_t>(), prefix_sum.data(), idx_size);
+}
+
 NNVM_REGISTER_OP(_contrib_boolean_mask)
     .add_alias("_npi_boolean_mask")
     .describe(R"code(
@@ -226,6 +257,84 @@ which stands for the rows in x where the corresonding element in index is non-ze
     .add_argument("index", "NDArray-or-Symbol", "Mask")
     .add_arguments(BooleanMaskParam::__FIELDS__());
 
+NNVM_REGISTER_OP(_contrib_boolean_mask_bounded)
+    .describe(R"code(
+Same selection as boolean_mask, into an output of the shape of data whose rows past the
+selected ones are fill_value, together with the number of selected rows as an int64 array
+of shape (1,).
+
+Both output shapes are known before the mask is computed, so unlike boolean_mask the operator
+never waits on the device for the mask, and the graphs which consume its outputs keep static
+shapes. The exact output is only needed when it is read, e.g. with ``out[:int(num.asscalar())]``.
+
+>>> data = mx.nd.array([[1, 2, 3],[4, 5, 6],[7, 8, 9]])
+>>> index = mx.nd.array([0, 1, 1])
+>>> out, num = mx.nd.contrib.boolean_mask_bounded(data, index)
+>>> out
+
+[[4. 5. 6.]
+ [7. 8. 9.]
+ [0. 0. 0.]]
+<NDArray 3x3 @cpu(0)>
+>>> num
+
+[2]
+<NDArray 1 @cpu(0)>
+
+)code" ADD_FILELINE)
+    .set_attr_parser(ParamParser<BoundedBooleanMaskParam>)
+    .set_num_inputs(2)
+    .set_num_outputs(2)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"data", "index"};
+                                     })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"output", "valid_num"};
+                                      })
+    .set_attr<mxnet::FInferShape>("FInferShape",
+                                  [](const nnvm::NodeAttrs& attrs,
+                                     mxnet::ShapeVector* in_attrs,
+                                     mxnet::ShapeVector* out_attrs) {
+                                    CHECK_EQ(in_attrs->size(), 2U);
+                                    CHECK_EQ(out_attrs->size(), 2U);
+                                    SHAPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(0));
+                                    SHAPE_ASSIGN_CHECK(*in_attrs, 0, out_attrs->at(0));
+                                    SHAPE_ASSIGN_CHECK(*out_attrs, 1, mxnet::TShape(1, 1));
+                                    if (!shape_is_known(in_attrs->at(0)))
+                                      return false;
+                                    SHAPE_ASSIGN_CHECK(
+                                        *in_attrs, 1, mxnet::TShape(1, in_attrs->at(0)[0]));
+                                    return shape_is_known(in_attrs->at(1));
+                                  })
+    .set_attr<nnvm::FInferType>("FInferType",
+                                [](const nnvm::NodeAttrs& attrs,
+                                   std::vector<int>* in_attrs,
+                                   std::vector<int>* out_attrs) {
+                                  CHECK_EQ(in_attrs->size(), 2U);
+                                  CHECK_EQ(out_attrs->size(), 2U);
+                                  TYPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(0));
+                                  TYPE_ASSIGN_CHECK(*in_attrs, 0, out_attrs->at(0));
+                                  TYPE_ASSIGN_CHECK(*out_attrs, 1, mshadow::kInt64);
+                                  return in_attrs->at(0) != -1 && in_attrs->at(1) != -1;
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", BoundedBooleanMaskForward<cpu>)
+    .set_attr<nnvm::FGradient>(
+        "FGradient",
+        [](const nnvm::ObjectPtr& n, const std::vector<nnvm::NodeEntry>& ograds) {
+          // the gradient of the data gathers the selected rows back, the padding is dropped
+          return MakeGradNode("_backward_contrib_boolean_mask",
+                              n,
+                              {ograds[0], n->inputs[0], n->inputs[1]},
+                              {{"axis",
+                                std::to_string(
+                                    nnvm::get<BoundedBooleanMaskParam>(n->attrs.parsed).axis)}});
+        })
+    .add_argument("data", "NDArray-or-Symbol", "Data")
+    .add_argument("index", "NDArray-or-Symbol", "Mask")
+    .add_arguments(BoundedBooleanMaskParam::__FIELDS__());
+
 NNVM_REGISTER_OP(_backward_contrib_boolean_mask)
     .set_num_inputs(3)
     .set_num_outputs(2)
@@ -144,6 +144,56 @@ inline void BooleanMaskBackward<gpu>(const nnvm::NodeAttrs& attrs,
   });
 }
 
+template <>
+void BoundedBooleanMaskForward<gpu>(const nnvm::NodeAttrs& attrs,
+                                    const OpContext& ctx,
+                                    const std::vector<TBlob>& inputs,
+                                    const std::vector<OpReqType>& req,
+                                    const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  CHECK_EQ(inputs.size(), 2U);
+  CHECK_EQ(outputs.size(), 2U);
+  CHECK(req[0] == kWriteTo || req[0] == kWriteInplace);
+  const BoundedBooleanMaskParam& param = nnvm::get<BoundedBooleanMaskParam>(attrs.parsed);
+  const TBlob& data                    = inputs[0];
+  const TBlob& idx                     = inputs[1];
+  CHECK_EQ(param.axis, 0) << "Not supported yet";
+  Stream<gpu>* s            = ctx.get_stream<gpu>();
+  cudaStream_t stream       = Stream<gpu>::GetStream(s);
+  const size_t idx_size     = idx.shape_[0];
+  int32_t* prefix_sum       = nullptr;
+  void* d_temp_storage      = nullptr;
+  size_t temp_storage_bytes = 0;
+  cub::DeviceScan::InclusiveSum(
+      d_temp_storage, temp_storage_bytes, prefix_sum, prefix_sum, idx_size, stream);
+  size_t buffer_size = idx_size * sizeof(int32_t);
+  temp_storage_bytes += buffer_size;
+  Tensor<gpu, 1, char> workspace =
+      ctx.requested[0].get_space_typed<gpu, 1, char>(Shape1(temp_storage_bytes), s);
+  prefix_sum     = reinterpret_cast<int32_t*>(workspace.dptr_);
+  d_temp_storage = workspace.dptr_ + buffer_size;
+  MSHADOW_TYPE_SWITCH_WITH_BOOL(idx.type_flag_, IType, {
+    mxnet_op::Kernel<mshadow_op::identity_with_cast, gpu>::Launch(
+        s, idx_size, prefix_sum, idx.dptr<IType>());
+  });
+  cub::DeviceScan::InclusiveSum(
+      d_temp_storage, temp_storage_bytes, prefix_sum, prefix_sum, idx_size, stream);
+  // unlike boolean_mask, the count stays on the device
+  Fill(s, outputs[0], kWriteTo, param.fill_value);
+  MSHADOW_TYPE_SWITCH_WITH_BOOL(data.type_flag_, DType, {
+    if (data.Size() > 0) {
+      mxnet_op::Kernel<BooleanMaskForwardKernel, gpu>::Launch(s,
+                                                              data.Size(),
+                                                              outputs[0].dptr<DType>(),
+                                                              data.dptr<DType>(),
+                                                              prefix_sum,
+                                                              data.Size() / idx_size);
+    }
+  });
+  mxnet_op::Kernel<BooleanMaskValidNumKernel, gpu>::Launch(
+      s, 1, outputs[1].dptr<int64_t>(), prefix_sum, idx_size);
+}
+
 NNVM_REGISTER_OP(_contrib_boolean_mask)
     .set_attr<FResourceRequest>("FResourceRequest",
                                 [](const NodeAttrs& attrs) {
@@ -152,6 +202,13 @@ NNVM_REGISTER_OP(_contrib_boolean_mask)
     .set_attr<THasDeterministicOutput>("THasDeterministicOutput", true)
     .set_attr<FComputeEx>("FComputeEx<gpu>", BooleanMaskForward<gpu>);
 
+NNVM_REGISTER_OP(_contrib_boolean_mask_bounded)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<gpu>", BoundedBooleanMaskForward<gpu>);
+
 NNVM_REGISTER_OP(_backward_contrib_boolean_mask)
     .set_attr<FResourceRequest>("FResourceRequest",
                                 [](const NodeAttrs& attrs) {
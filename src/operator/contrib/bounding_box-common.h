@@ -126,6 +126,101 @@ struct nms_impl {
   }
 };
 
+/*! \brief Boxes per word of the suppression bitmasks of the parallel nms */
+constexpr int kNMSBitmaskWidth = 64;
+/*! \brief Largest bitmask workspace of the parallel nms, larger inputs fall back to nms_impl */
+constexpr size_t kNMSBitmaskMaxBytes = 128 << 20;
+
+/*!
+ * \brief Words of workspace for the bitmasks of the parallel nms of topk candidates per batch,
+ *        0 when they would take too much memory and nms_impl is used instead
+ */
+inline size_t NMSBitmaskWords(int num_batch, int topk) {
+  const size_t col_blocks = (topk + kNMSBitmaskWidth - 1) / kNMSBitmaskWidth;
+  const size_t words      = static_cast<size_t>(num_batch) * (topk + 1) * col_blocks;
+  const bool fits = num_batch <= 65535 && words * sizeof(uint64_t) <= kNMSBitmaskMaxBytes;
+  return topk > 0 && fits ? words : 0;
+}
+
+/*!
+ * \brief Whether the IoU of two corner boxes is above the nms threshold,
+ *        with the same arithmetic as nms_impl
+ */
+template <typename DType>
+MSHADOW_XINLINE bool NMSOverlap(DType ax1,
+                                DType ay1,
+                                DType ax2,
+                                DType ay2,
+                                DType a_area,
+                                DType bx1,
+                                DType by1,
+                                DType bx2,
+                                DType by2,
+                                DType b_area,
+                                float thresh) {
+  DType w         = (ax2 < bx2 ? ax2 : bx2) - (ax1 > bx1 ? ax1 : bx1);
+  DType h         = (ay2 < by2 ? ay2 : by2) - (ay1 > by1 ? ay1 : by1);
+  DType intersect = (w > 0 ? w : DType(0)) * (h > 0 ? h : DType(0));
+  DType iou       = intersect / (a_area + b_area - intersect);
+  return iou > thresh;
+}
+
+/*!
+ * \brief Gather the nms candidates in sorted order as corner boxes, in one array per field:
+ *        x1, y1, x2, y2, area and class id, each of total elements
+ *
+ * \param i the launched thread index (total num_batch * k)
+ * \param boxes output fields of the candidates, candidate k of batch b at b * k + k
+ * \param index sorted index in descending order
+ * \param batch_start map (b, k) to compact index by indices[batch_start[b] + k]
+ * \param input the input of nms op
+ * \param areas pre-computed box areas
+ * \param k nms topk number
+ * \param total number of candidates of all batches, num_batch * k
+ * \param stride input stride, usually 6 (id-score-x1-y1-x2-y2)
+ * \param offset_box box offset, usually 2
+ * \param offset_id class id offset, negative without class
+ * \param encode box encoding type, corner(0) or center(1)
+ */
+struct nms_gather_boxes {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(int i,
+                                  DType* boxes,
+                                  const int32_t* index,
+                                  const int32_t* batch_start,
+                                  const DType* input,
+                                  const DType* areas,
+                                  int k,
+                                  int total,
+                                  int stride,
+                                  int offset_box,
+                                  int offset_id,
+                                  int encode) {
+    const int b   = i / k;
+    const int pos = static_cast<int>(batch_start[b]) + i % k;
+    if (pos >= static_cast<int>(batch_start[b + 1]))
+      return;
+    const int location = static_cast<int>(index[pos]);
+    const DType* box   = input + location * stride + offset_box;
+    if (box_common_enum::kCorner == encode) {
+      boxes[i]             = box[0];
+      boxes[total + i]     = box[1];
+      boxes[2 * total + i] = box[2];
+      boxes[3 * total + i] = box[3];
+    } else {
+      // the same half widths as Intersect
+      const DType hw       = box[2] / 2;
+      const DType hh       = box[3] / 2;
+      boxes[i]             = box[0] - hw;
+      boxes[total + i]     = box[1] - hh;
+      boxes[2 * total + i] = box[0] + hw;
+      boxes[3 * total + i] = box[1] + hh;
+    }
+    boxes[4 * total + i] = areas[location];
+    boxes[5 * total + i] = offset_id >= 0 ? input[location * stride + offset_id] : DType(0);
+  }
+};
+
 namespace mshadow_op {
 struct less_than : public mxnet_op::tunable {
   template <typename DType>
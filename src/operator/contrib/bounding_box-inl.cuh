@@ -274,6 +274,150 @@ void NMSApply(mshadow::Stream<gpu> *s,
   }
 }
 
+/*!
+ * \brief Suppression bitmasks of the parallel nms, one block per tile of 64 x 64 candidates of
+ *        a batch: each thread writes the word of its row candidate for the column candidates.
+ *        Only the tiles on and above the diagonal are computed.
+ */
+template<typename DType, bool check_class>
+__launch_bounds__(kNMSBitmaskWidth)
+__global__ void nms_bitmask_kernel(uint64_t *mask, const int32_t *batch_start,
+                                   const DType *boxes, const int topk, const int total,
+                                   const int col_blocks, const float threshold) {
+  const int col_block = blockIdx.x;
+  const int row_block = blockIdx.y;
+  const int b = blockIdx.z;
+  if (col_block < row_block) return;
+  const int count = min(topk, batch_start[b + 1] - batch_start[b]);
+  const int rows = min(kNMSBitmaskWidth, count - row_block * kNMSBitmaskWidth);
+  const int cols = min(kNMSBitmaskWidth, count - col_block * kNMSBitmaskWidth);
+  if (rows <= 0 || cols <= 0) return;
+  __shared__ DType col_boxes[6][kNMSBitmaskWidth];
+  const DType *batch_boxes = boxes + b * topk;
+  if (threadIdx.x < cols) {
+    const int col = col_block * kNMSBitmaskWidth + threadIdx.x;
+    for (int f = 0; f < 6; ++f) {
+      col_boxes[f][threadIdx.x] = batch_boxes[f * total + col];
+    }
+  }
+  __syncthreads();
+  if (threadIdx.x >= rows) return;
+  const int row = row_block * kNMSBitmaskWidth + threadIdx.x;
+  DType row_box[6];
+  for (int f = 0; f < 6; ++f) {
+    row_box[f] = batch_boxes[f * total + row];
+  }
+  uint64_t bits = 0;
+  for (int j = col_block == row_block ? threadIdx.x + 1 : 0; j < cols; ++j) {
+    if (check_class &&
+        static_cast<int>(col_boxes[5][j]) != static_cast<int>(row_box[5])) continue;
+    if (NMSOverlap(row_box[0], row_box[1], row_box[2], row_box[3], row_box[4],
+                   col_boxes[0][j], col_boxes[1][j], col_boxes[2][j], col_boxes[3][j],
+                   col_boxes[4][j], threshold)) {
+      bits |= static_cast<uint64_t>(1) << j;
+    }
+  }
+  mask[(static_cast<size_t>(b) * topk + row) * col_blocks + col_block] = bits;
+}
+
+/*!
+ * \brief Greedy pass of the parallel nms, one block per batch. The candidates of a word are
+ *        decided by one thread from their diagonal words, then the kept ones suppress the
+ *        later words in parallel, so the block only synchronizes once per 64 candidates.
+ */
+__launch_bounds__(256)
+__global__ void nms_bitmask_reduce_kernel(int32_t *index, const int32_t *batch_start,
+                                          const uint64_t *mask, uint64_t *removed,
+                                          const int topk, const int col_blocks) {
+  __shared__ uint64_t diagonal[kNMSBitmaskWidth];
+  __shared__ uint64_t kept;
+  const int b = blockIdx.x;
+  const int start = batch_start[b];
+  const int count = min(topk, batch_start[b + 1] - start);
+  const int num_word = (count + kNMSBitmaskWidth - 1) / kNMSBitmaskWidth;
+  const uint64_t *batch_mask = mask + static_cast<size_t>(b) * topk * col_blocks;
+  uint64_t *batch_removed = removed + static_cast<size_t>(b) * col_blocks;
+  for (int w = threadIdx.x; w < num_word; w += blockDim.x) {
+    batch_removed[w] = 0;
+  }
+  __syncthreads();
+  for (int word = 0; word < num_word; ++word) {
+    const int first = word * kNMSBitmaskWidth;
+    const int rows = min(kNMSBitmaskWidth, count - first);
+    if (threadIdx.x < rows) {
+      diagonal[threadIdx.x] = batch_mask[static_cast<size_t>(first + threadIdx.x) * col_blocks +
+                                         word];
+    }
+    __syncthreads();
+    if (threadIdx.x == 0) {
+      uint64_t suppressed = batch_removed[word];
+      uint64_t keep = 0;
+      for (int j = 0; j < rows; ++j) {
+        if (!((suppressed >> j) & 1)) {
+          keep |= static_cast<uint64_t>(1) << j;
+          suppressed |= diagonal[j];
+        }
+      }
+      kept = keep;
+    }
+    __syncthreads();
+    const uint64_t keep = kept;
+    if (threadIdx.x < rows && !((keep >> threadIdx.x) & 1)) {
+      index[start + first + threadIdx.x] = -1;
+    }
+    for (int w = word + 1 + threadIdx.x; w < num_word; w += blockDim.x) {
+      uint64_t suppressed = 0;
+      for (uint64_t bits = keep; bits; bits &= bits - 1) {
+        const int j = __ffsll(static_cast<long long>(bits)) - 1;
+        suppressed |= batch_mask[static_cast<size_t>(first + j) * col_blocks + w];
+      }
+      batch_removed[w] |= suppressed;
+    }
+    __syncthreads();
+  }
+}
+
+/*!
+ * \brief Same suppressions as NMSApply in three launches for all batches and classes,
+ *        instead of a sequential pass over the reference boxes.
+ *
+ * \param mask workspace of num_batch * (topk + 1) * ceil(topk / 64) words
+ * \param boxes workspace of 6 * num_batch * topk elements
+ */
+template<typename DType>
+void NMSApplyBitmask(mshadow::Stream<gpu> *s,
+                     int num_batch, int topk,
+                     mshadow::Tensor<gpu, 1, int32_t>* sorted_index,
+                     mshadow::Tensor<gpu, 1, int32_t>* batch_start,
+                     mshadow::Tensor<gpu, 3, DType>* buffer,
+                     mshadow::Tensor<gpu, 1, DType>* areas,
+                     uint64_t *mask, DType *boxes,
+                     int width_elem, int coord_start, int id_index,
+                     float threshold, bool check_class,
+                     int in_format) {
+  using namespace mxnet_op;
+  const int total = num_batch * topk;
+  const int col_blocks = (topk + kNMSBitmaskWidth - 1) / kNMSBitmaskWidth;
+  Kernel<nms_gather_boxes, gpu>::Launch(s, total, boxes, sorted_index->dptr_,
+                                        batch_start->dptr_, buffer->dptr_, areas->dptr_,
+                                        topk, total, width_elem, coord_start, id_index,
+                                        in_format);
+  auto stream = mshadow::Stream<gpu>::GetStream(s);
+  const dim3 tiles(col_blocks, col_blocks, num_batch);
+  if (check_class) {
+    nms_bitmask_kernel<DType, true><<<tiles, kNMSBitmaskWidth, 0, stream>>>(
+        mask, batch_start->dptr_, boxes, topk, total, col_blocks, threshold);
+  } else {
+    nms_bitmask_kernel<DType, false><<<tiles, kNMSBitmaskWidth, 0, stream>>>(
+        mask, batch_start->dptr_, boxes, topk, total, col_blocks, threshold);
+  }
+  MSHADOW_CUDA_POST_KERNEL_CHECK(nms_bitmask_kernel);
+  nms_bitmask_reduce_kernel<<<num_batch, 256, 0, stream>>>(
+      sorted_index->dptr_, batch_start->dptr_, mask,
+      mask + static_cast<size_t>(total) * col_blocks, topk, col_blocks);
+  MSHADOW_CUDA_POST_KERNEL_CHECK(nms_bitmask_reduce_kernel);
+}
+
 __launch_bounds__(512)
 __global__ void nms_calculate_batch_start_kernel(int32_t * batch_start,
                                                  int32_t * valid_batch_id,
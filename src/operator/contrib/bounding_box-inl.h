@@ -298,6 +298,171 @@ void NMSApply(mshadow::Stream<cpu>* s,
   }
 }
 
+/*!
+ * \brief Suppression bitmask of a candidate of the parallel nms: bit j of word w is set when
+ *        the candidate suppresses the later candidate w * 64 + j of its batch. Words before
+ *        the one of the candidate are not written.
+ *
+ * \param i the launched thread index (total num_batch * k)
+ * \param mask output bitmasks, col_blocks words per candidate
+ * \param batch_start map (b, k) to compact index by indices[batch_start[b] + k]
+ * \param boxes candidates gathered by nms_gather_boxes
+ * \param k nms topk number
+ * \param total number of candidates of all batches, num_batch * k
+ * \param col_blocks words per bitmask, ceil(k / 64)
+ * \param thresh nms threshold
+ * \param check_class only suppress candidates of the same class
+ */
+struct nms_bitmask_row {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(int i,
+                                  uint64_t* mask,
+                                  const int32_t* batch_start,
+                                  const DType* boxes,
+                                  int k,
+                                  int total,
+                                  int col_blocks,
+                                  float thresh,
+                                  bool check_class) {
+    const int b     = i / k;
+    const int row   = i % k;
+    const int size  = static_cast<int>(batch_start[b + 1] - batch_start[b]);
+    const int count = size < k ? size : k;
+    if (row >= count)
+      return;
+    const DType* x1    = boxes + b * k;
+    const DType* y1    = x1 + total;
+    const DType* x2    = y1 + total;
+    const DType* y2    = x2 + total;
+    const DType* area  = y2 + total;
+    const DType* id    = area + total;
+    const int num_word = (count + kNMSBitmaskWidth - 1) / kNMSBitmaskWidth;
+    uint64_t* row_mask = mask + static_cast<size_t>(i) * col_blocks;
+    for (int w = row / kNMSBitmaskWidth; w < num_word; ++w) {
+      const int start = w * kNMSBitmaskWidth;
+      const int end   = start + kNMSBitmaskWidth < count ? start + kNMSBitmaskWidth : count;
+      uint64_t bits   = 0;
+      for (int j = start > row ? start : row + 1; j < end; ++j) {
+        if (check_class && static_cast<int>(id[j]) != static_cast<int>(id[row]))
+          continue;
+        if (NMSOverlap(x1[row],
+                       y1[row],
+                       x2[row],
+                       y2[row],
+                       area[row],
+                       x1[j],
+                       y1[j],
+                       x2[j],
+                       y2[j],
+                       area[j],
+                       thresh))
+          bits |= uint64_t(1) << (j - start);
+      }
+      row_mask[w] = bits;
+    }
+  }
+};
+
+/*!
+ * \brief Greedy pass of the parallel nms over the candidates of a batch in score order,
+ *        marking the suppressed ones with -1 in index
+ *
+ * \param b the launched thread index (total num_batch)
+ * \param index sorted index in descending order
+ * \param batch_start map (b, k) to compact index by indices[batch_start[b] + k]
+ * \param mask bitmasks of nms_bitmask_row
+ * \param removed col_blocks words of scratch per batch
+ * \param k nms topk number
+ * \param col_blocks words per bitmask, ceil(k / 64)
+ */
+struct nms_bitmask_reduce {
+  MSHADOW_XINLINE static void Map(int b,
+                                  int32_t* index,
+                                  const int32_t* batch_start,
+                                  const uint64_t* mask,
+                                  uint64_t* removed,
+                                  int k,
+                                  int col_blocks) {
+    const int start         = static_cast<int>(batch_start[b]);
+    const int size          = static_cast<int>(batch_start[b + 1]) - start;
+    const int count         = size < k ? size : k;
+    const int num_word      = (count + kNMSBitmaskWidth - 1) / kNMSBitmaskWidth;
+    uint64_t* batch_removed = removed + static_cast<size_t>(b) * col_blocks;
+    for (int j = 0; j < num_word; ++j)
+      batch_removed[j] = 0;
+    for (int row = 0; row < count; ++row) {
+      const int w = row / kNMSBitmaskWidth;
+      if ((batch_removed[w] >> (row % kNMSBitmaskWidth)) & 1) {
+        index[start + row] = -1;
+        continue;
+      }
+      const uint64_t* row_mask = mask + (static_cast<size_t>(b) * k + row) * col_blocks;
+      for (int j = w; j < num_word; ++j)
+        batch_removed[j] |= row_mask[j];
+    }
+  }
+};
+
+/*!
+ * \brief Same suppressions as NMSApply, without a pass per reference box: the pairwise
+ *        overlaps of the candidates of all batches and classes are computed at once as bitmasks,
+ *        then reduced greedily per batch.
+ *
+ * \param mask workspace of num_batch * (topk + 1) * ceil(topk / 64) words
+ * \param boxes workspace of 6 * num_batch * topk elements
+ */
+template <typename DType>
+void NMSApplyBitmask(mshadow::Stream<cpu>* s,
+                     int num_batch,
+                     int topk,
+                     mshadow::Tensor<cpu, 1, int32_t>* sorted_index,
+                     mshadow::Tensor<cpu, 1, int32_t>* batch_start,
+                     mshadow::Tensor<cpu, 3, DType>* buffer,
+                     mshadow::Tensor<cpu, 1, DType>* areas,
+                     uint64_t* mask,
+                     DType* boxes,
+                     int width_elem,
+                     int coord_start,
+                     int id_index,
+                     float threshold,
+                     bool check_class,
+                     int in_format) {
+  using namespace mxnet_op;
+  const int total      = num_batch * topk;
+  const int col_blocks = (topk + kNMSBitmaskWidth - 1) / kNMSBitmaskWidth;
+  Kernel<nms_gather_boxes, cpu>::Launch(s,
+                                        total,
+                                        boxes,
+                                        sorted_index->dptr_,
+                                        batch_start->dptr_,
+                                        buffer->dptr_,
+                                        areas->dptr_,
+                                        topk,
+                                        total,
+                                        width_elem,
+                                        coord_start,
+                                        id_index,
+                                        in_format);
+  Kernel<nms_bitmask_row, cpu>::Launch(s,
+                                       total,
+                                       mask,
+                                       batch_start->dptr_,
+                                       boxes,
+                                       topk,
+                                       total,
+                                       col_blocks,
+                                       threshold,
+                                       check_class);
+  Kernel<nms_bitmask_reduce, cpu>::Launch(s,
+                                          num_batch,
+                                          sorted_index->dptr_,
+                                          batch_start->dptr_,
+                                          mask,
+                                          mask + static_cast<size_t>(total) * col_blocks,
+                                          topk,
+                                          col_blocks);
+}
+
 inline void NMSCalculateBatchStart(mshadow::Stream<cpu>* s,
                                    mshadow::Tensor<cpu, 1, int32_t>* batch_start,
                                    mshadow::Tensor<cpu, 1, int32_t>* valid_batch_id,
@@ -406,26 +571,36 @@ void BoxNMSForward(const nnvm::NodeAttrs& attrs,
     Shape<3> buffer_shape      = Shape3(num_batch, num_elem, width_elem);
     Shape<1> batch_start_shape = Shape1(num_batch + 1);
 
+    // the bitmasks of the parallel nms, unless they would take too much memory
+    int topk                = param.topk < 0 ? num_elem : std::min(num_elem, param.topk);
+    const size_t mask_words = NMSBitmaskWords(num_batch, topk);
+    const bool use_bitmask  = mask_words > 0;
+    index_t mask_offset     = mask_words * sizeof(uint64_t) / sizeof(DType);
+
     // index
     index_t int32_size = sort_index_shape.Size() * 3 + batch_start_shape.Size();
     index_t dtype_size = sort_index_shape.Size() * 3;
     if (req[0] == kWriteInplace) {
       dtype_size += buffer_shape.Size();
     }
+    if (use_bitmask) {
+      dtype_size += 6 * num_batch * topk;
+    }
     // ceil up when sizeof(DType) is larger than sizeof(DType)
     index_t int32_offset   = (int32_size * sizeof(int32_t) - 1) / sizeof(DType) + 1;
-    index_t workspace_size = int32_offset + dtype_size;
+    index_t workspace_size = mask_offset + int32_offset + dtype_size;
     Tensor<xpu, 1, DType> workspace =
         ctx.requested[box_nms_enum::kTempSpace].get_space_typed<xpu, 1, DType>(
             Shape1(workspace_size), s);
+    uint64_t* mask = reinterpret_cast<uint64_t*>(workspace.dptr_);
     Tensor<xpu, 1, int32_t> sorted_index(
-        reinterpret_cast<int32_t*>(workspace.dptr_), sort_index_shape, s);
+        reinterpret_cast<int32_t*>(workspace.dptr_ + mask_offset), sort_index_shape, s);
     Tensor<xpu, 1, int32_t> all_sorted_index(
         sorted_index.dptr_ + sorted_index.MSize(), sort_index_shape, s);
     Tensor<xpu, 1, int32_t> batch_id(
         all_sorted_index.dptr_ + all_sorted_index.MSize(), sort_index_shape, s);
     Tensor<xpu, 1, int32_t> batch_start(batch_id.dptr_ + batch_id.MSize(), batch_start_shape, s);
-    Tensor<xpu, 1, DType> scores(workspace.dptr_ + int32_offset, sort_index_shape, s);
+    Tensor<xpu, 1, DType> scores(workspace.dptr_ + mask_offset + int32_offset, sort_index_shape, s);
     Tensor<xpu, 1, DType> areas(scores.dptr_ + scores.MSize(), sort_index_shape, s);
     Tensor<xpu, 1, DType> classes(areas.dptr_ + areas.MSize(), sort_index_shape, s);
     Tensor<xpu, 3, DType> buffer = data;
@@ -434,6 +609,8 @@ void BoxNMSForward(const nnvm::NodeAttrs& attrs,
       buffer = Tensor<xpu, 3, DType>(areas.dptr_ + areas.MSize(), buffer_shape, s);
       buffer = F<mshadow_op::identity>(data);
     }
+    DType* boxes = classes.dptr_ + classes.MSize() +
+                   (req[0] == kWriteInplace ? buffer_shape.Size() : 0);
 
     // indecies
     int score_index = param.score_index;
@@ -441,7 +618,6 @@ void BoxNMSForward(const nnvm::NodeAttrs& attrs,
     int id_index    = param.id_index;
 
     // sort topk
-    int topk = param.topk < 0 ? num_elem : std::min(num_elem, param.topk);
     if (topk < 1) {
       out    = F<mshadow_op::identity>(buffer);
       record = reshape(range<DType>(0, num_batch * num_elem), record.shape_);
@@ -512,20 +688,38 @@ void BoxNMSForward(const nnvm::NodeAttrs& attrs,
                                       param.in_format);
 
     // apply nms
-    mxnet::op::NMSApply(s,
-                        num_batch,
-                        topk,
-                        &sorted_index,
-                        &batch_start,
-                        &buffer,
-                        &areas,
-                        num_elem,
-                        width_elem,
-                        coord_start,
-                        id_index,
-                        param.overlap_thresh,
-                        param.force_suppress,
-                        param.in_format);
+    if (use_bitmask) {
+      mxnet::op::NMSApplyBitmask(s,
+                                 num_batch,
+                                 topk,
+                                 &sorted_index,
+                                 &batch_start,
+                                 &buffer,
+                                 &areas,
+                                 mask,
+                                 boxes,
+                                 width_elem,
+                                 coord_start,
+                                 id_index,
+                                 param.overlap_thresh,
+                                 !param.force_suppress && id_index >= 0,
+                                 param.in_format);
+    } else {
+      mxnet::op::NMSApply(s,
+                          num_batch,
+                          topk,
+                          &sorted_index,
+                          &batch_start,
+                          &buffer,
+                          &areas,
+                          num_elem,
+                          width_elem,
+                          coord_start,
+                          id_index,
+                          param.overlap_thresh,
+                          param.force_suppress,
+                          param.in_format);
+    }
 
     // store the results to output, keep a record for backward
     record = -1;
@@ -1057,6 +1251,47 @@ inline bool BoxDecodeShape(const nnvm::NodeAttrs& attrs,
   return shape_is_known(oshape);
 }
 
+/*!
+ * \brief Decode the normalized center offsets x of an anchor to a corner box in out
+ */
+template <int anchor_encode, bool has_clip, typename DType>
+MSHADOW_XINLINE void DecodeBox(DType* out,
+                               const DType* x,
+                               const DType* anchor,
+                               const DType std0,
+                               const DType std1,
+                               const DType std2,
+                               const DType std3,
+                               const DType clip) {
+  DType a_x      = anchor[0];
+  DType a_y      = anchor[1];
+  DType a_width  = anchor[2];
+  DType a_height = anchor[3];
+  if (box_common_enum::kCorner == anchor_encode) {
+    // a_x = xmin, a_y = ymin, a_width = xmax, a_height = ymax
+    a_width  = a_width - a_x;
+    a_height = a_height - a_y;
+    a_x      = a_x + a_width * 0.5;
+    a_y      = a_y + a_height * 0.5;
+  }
+  DType ox = x[0] * std0 * a_width + a_x;
+  DType oy = x[1] * std1 * a_height + a_y;
+  DType dw = x[2] * std2;
+  DType dh = x[3] * std3;
+  if (has_clip) {
+    dw = dw < clip ? dw : clip;
+    dh = dh < clip ? dh : clip;
+  }
+  dw       = exp(dw);
+  dh       = exp(dh);
+  DType ow = dw * a_width * 0.5;
+  DType oh = dh * a_height * 0.5;
+  out[0]   = ox - ow;
+  out[1]   = oy - oh;
+  out[2]   = ox + ow;
+  out[3]   = oy + oh;
+}
+
 template <int anchor_encode, bool has_clip>
 struct box_decode {
   template <typename DType>
@@ -1070,35 +1305,8 @@ struct box_decode {
                                   const DType std3,
                                   const DType clip,
                                   const int n) {
-    index_t index   = i * 4;
-    index_t a_index = (i % n) * 4;
-    DType a_x       = anchors[a_index + 0];
-    DType a_y       = anchors[a_index + 1];
-    DType a_width   = anchors[a_index + 2];
-    DType a_height  = anchors[a_index + 3];
-    if (box_common_enum::kCorner == anchor_encode) {
-      // a_x = xmin, a_y = ymin, a_width = xmax, a_height = ymax
-      a_width  = a_width - a_x;
-      a_height = a_height - a_y;
-      a_x      = a_x + a_width * 0.5;
-      a_y      = a_y + a_height * 0.5;
-    }
-    DType ox = x[index + 0] * std0 * a_width + a_x;
-    DType oy = x[index + 1] * std1 * a_height + a_y;
-    DType dw = x[index + 2] * std2;
-    DType dh = x[index + 3] * std3;
-    if (has_clip) {
-      dw = dw < clip ? dw : clip;
-      dh = dh < clip ? dh : clip;
-    }
-    dw             = exp(dw);
-    dh             = exp(dh);
-    DType ow       = dw * a_width * 0.5;
-    DType oh       = dh * a_height * 0.5;
-    out[index + 0] = ox - ow;
-    out[index + 1] = oy - oh;
-    out[index + 2] = ox + ow;
-    out[index + 3] = oy + oh;
+    DecodeBox<anchor_encode, has_clip>(
+        out + i * 4, x + i * 4, anchors + (i % n) * 4, std0, std1, std2, std3, clip);
   }
 };
 
@@ -1179,6 +1387,348 @@ void BoxDecodeForward(const nnvm::NodeAttrs& attrs,
   });
 }
 
+namespace box_detection_enum {
+enum BoxDetectionOpInputs { kClsProb, kLocPred, kAnchor };
+enum BoxDetectionOpOutputs { kOut };
+enum BoxDetectionOpResource { kTempSpace };
+}  // namespace box_detection_enum
+
+struct BoxDetectionParam : public dmlc::Parameter<BoxDetectionParam> {
+  float overlap_thresh;
+  float valid_thresh;
+  int nms_topk;
+  int keep_topk;
+  int background_id;
+  bool force_suppress;
+  float std0;
+  float std1;
+  float std2;
+  float std3;
+  float clip;
+  int format;
+  DMLC_DECLARE_PARAMETER(BoxDetectionParam) {
+    DMLC_DECLARE_FIELD(overlap_thresh)
+        .set_default(0.5)
+        .describe("Overlapping(IoU) threshold to suppress object with smaller score.");
+    DMLC_DECLARE_FIELD(valid_thresh)
+        .set_default(0.01)
+        .describe("Filter detections to those whose scores greater than valid_thresh.");
+    DMLC_DECLARE_FIELD(nms_topk).set_default(400).describe(
+        "Apply nms to the nms_topk detections of each batch with descending scores, "
+        "-1 to no restriction.");
+    DMLC_DECLARE_FIELD(keep_topk)
+        .set_default(100)
+        .describe("Number of detections of each batch in the output, padded with -1.");
+    DMLC_DECLARE_FIELD(background_id)
+        .set_default(0)
+        .describe("Id of the background class which will be ignored, -1 to disable.");
+    DMLC_DECLARE_FIELD(force_suppress)
+        .set_default(false)
+        .describe("Optional, if set false, nms will only apply to boxes belongs to the same class");
+    DMLC_DECLARE_FIELD(std0).set_default(1.0).describe(
+        "value to be divided from the 1st encoded values");
+    DMLC_DECLARE_FIELD(std1).set_default(1.0).describe(
+        "value to be divided from the 2nd encoded values");
+    DMLC_DECLARE_FIELD(std2).set_default(1.0).describe(
+        "value to be divided from the 3rd encoded values");
+    DMLC_DECLARE_FIELD(std3).set_default(1.0).describe(
+        "value to be divided from the 4th encoded values");
+    DMLC_DECLARE_FIELD(clip).set_default(-1.0).describe(
+        "If larger than 0, bounding box target will be clipped to this value.");
+    DMLC_DECLARE_FIELD(format)
+        .set_default(box_common_enum::kCenter)
+        .add_enum("corner", box_common_enum::kCorner)
+        .add_enum("center", box_common_enum::kCenter)
+        .describe(
+            "The anchor encoding type. \n"
+            " \"corner\" means boxes are encoded as [xmin, ymin, xmax, ymax],"
+            " \"center\" means boxes are encodes as [x, y, width, height].");
+  }
+};  // BoxDetectionParam
+
+inline bool BoxDetectionShape(const nnvm::NodeAttrs& attrs,
+                              mxnet::ShapeVector* in_attrs,
+                              mxnet::ShapeVector* out_attrs) {
+  const BoxDetectionParam& param = nnvm::get<BoxDetectionParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), 3U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  CHECK(param.nms_topk > 0 || param.nms_topk == -1)
+      << "nms_topk must be positive or -1, " << param.nms_topk << " provided";
+  CHECK_GT(param.keep_topk, 0) << "keep_topk must be positive, " << param.keep_topk
+                               << " provided";
+  const mxnet::TShape& cshape = (*in_attrs)[box_detection_enum::kClsProb];
+  const mxnet::TShape& lshape = (*in_attrs)[box_detection_enum::kLocPred];
+  const mxnet::TShape& ashape = (*in_attrs)[box_detection_enum::kAnchor];
+  if (!shape_is_known(cshape) || !shape_is_known(lshape) || !shape_is_known(ashape))
+    return false;
+  CHECK_EQ(cshape.ndim(), 3) << "cls_prob shape must have dim == 3, " << cshape.ndim()
+                             << " provided";
+  CHECK_EQ(lshape.ndim(), 3) << "loc_pred shape must have dim == 3, " << lshape.ndim()
+                             << " provided";
+  CHECK_EQ(ashape.ndim(), 3) << "anchors shape must have dim == 3, " << ashape.ndim()
+                             << " provided";
+  CHECK_EQ(lshape[0], cshape[0]) << "batch size of loc_pred and cls_prob mismatch";
+  CHECK_EQ(lshape[1], cshape[1]) << "number of anchors of loc_pred and cls_prob mismatch";
+  CHECK_EQ(ashape[1], cshape[1]) << "number of anchors of anchors and cls_prob mismatch";
+  CHECK_EQ(lshape[2], 4) << "last dimension of loc_pred must be 4, " << lshape[2] << " provided";
+  CHECK_EQ(ashape[2], 4) << "last dimension of anchors must be 4, " << ashape[2] << " provided";
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, mxnet::TShape({cshape[0], param.keep_topk, 6}));
+  return true;
+}
+
+/*!
+ * \brief Scores to sort the detection candidates by, the lowest value for the invalid ones
+ *
+ * \param i the launched thread index (total num_batch * num_anchor * num_class)
+ * \param scores output scores
+ * \param cls_prob class scores, (B, N, C)
+ * \param num_class number of classes C
+ * \param valid_thresh score threshold of valid candidates
+ * \param background_id class id of the background, -1 without
+ */
+struct detection_filter {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(int i,
+                                  DType* scores,
+                                  const DType* cls_prob,
+                                  int num_class,
+                                  const DType valid_thresh,
+                                  int background_id) {
+    const DType score = cls_prob[i];
+    const bool valid  = score > valid_thresh && i % num_class != background_id;
+    scores[i]         = valid ? score : mshadow::red::limits::MinValue<DType>();
+  }
+};
+
+/*!
+ * \brief Decode the k best candidates of each batch to rows [id, score, xmin, ymin, xmax, ymax],
+ *        the invalid ones to -1
+ *
+ * \param i the launched thread index (total num_batch * k)
+ * \param dets output rows, (B, k, 6)
+ * \param areas output areas of the rows
+ * \param sorted_index candidates of each batch by descending score
+ * \param cls_prob class scores, (B, N, C)
+ * \param loc_pred predicted bbox offsets, (B, N, 4)
+ * \param anchors anchors, (1, N, 4)
+ * \param k number of candidates of each batch to decode
+ * \param num_anchor number of anchors N
+ * \param num_class number of classes C
+ * \param encode anchor encoding type, corner(0) or center(1)
+ */
+struct detection_gather {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(int i,
+                                  DType* dets,
+                                  DType* areas,
+                                  const int32_t* sorted_index,
+                                  const DType* cls_prob,
+                                  const DType* loc_pred,
+                                  const DType* anchors,
+                                  int k,
+                                  int num_anchor,
+                                  int num_class,
+                                  const DType valid_thresh,
+                                  int background_id,
+                                  const DType std0,
+                                  const DType std1,
+                                  const DType std2,
+                                  const DType std3,
+                                  const DType clip,
+                                  int encode) {
+    const int b        = i / k;
+    const int location = static_cast<int>(sorted_index[b * num_anchor * num_class + i % k]);
+    const int box      = location / num_class;
+    const int class_id = location % num_class;
+    const DType score  = cls_prob[location];
+    DType* det         = dets + i * 6;
+    if (!(score > valid_thresh) || class_id == background_id) {
+      for (int j = 0; j < 6; ++j) {
+        det[j] = DType(-1);
+      }
+      areas[i] = DType(0);
+      return;
+    }
+    det[0]              = static_cast<DType>(class_id);
+    det[1]              = score;
+    const DType* x      = loc_pred + box * 4;
+    const DType* anchor = anchors + (box % num_anchor) * 4;
+    const bool has_clip = clip > 0;
+    if (box_common_enum::kCorner == encode && has_clip) {
+      DecodeBox<box_common_enum::kCorner, true>(det + 2, x, anchor, std0, std1, std2, std3, clip);
+    } else if (box_common_enum::kCorner == encode) {
+      DecodeBox<box_common_enum::kCorner, false>(det + 2, x, anchor, std0, std1, std2, std3, clip);
+    } else if (has_clip) {
+      DecodeBox<box_common_enum::kCenter, true>(det + 2, x, anchor, std0, std1, std2, std3, clip);
+    } else {
+      DecodeBox<box_common_enum::kCenter, false>(det + 2, x, anchor, std0, std1, std2, std3, clip);
+    }
+    areas[i] = BoxArea(det + 2, box_common_enum::kCorner);
+  }
+};
+
+/*!
+ * \brief Copy the detections of a batch which survived nms to the output, padded with -1
+ *
+ * \param b the launched thread index (total num_batch)
+ * \param out output, (B, keep, 6)
+ * \param dets rows of detection_gather, (B, k, 6)
+ * \param index nms result, -1 for the suppressed rows
+ * \param k number of rows of each batch
+ * \param keep number of output detections of each batch
+ */
+struct detection_assign {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(int b,
+                                  DType* out,
+                                  const DType* dets,
+                                  const int32_t* index,
+                                  int k,
+                                  int keep) {
+    int count = 0;
+    for (int j = 0; j < k && count < keep; ++j) {
+      const int pos = b * k + j;
+      if (dets[pos * 6] < 0)
+        break;  // the invalid rows are last
+      if (index[pos] < 0)
+        continue;
+      for (int s = 0; s < 6; ++s) {
+        out[(b * keep + count) * 6 + s] = dets[pos * 6 + s];
+      }
+      ++count;
+    }
+    for (; count < keep; ++count) {
+      for (int s = 0; s < 6; ++s) {
+        out[(b * keep + count) * 6 + s] = DType(-1);
+      }
+    }
+  }
+};
+
+template <typename xpu>
+void BoxDetectionForward(const nnvm::NodeAttrs& attrs,
+                         const OpContext& ctx,
+                         const std::vector<TBlob>& inputs,
+                         const std::vector<OpReqType>& req,
+                         const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mshadow::expr;
+  using namespace mxnet_op;
+  CHECK_EQ(inputs.size(), 3U) << "BoxDetection input: [cls_prob, loc_pred, anchors]";
+  CHECK_EQ(outputs.size(), 1U);
+  const BoxDetectionParam& param = nnvm::get<BoxDetectionParam>(attrs.parsed);
+  Stream<xpu>* s                 = ctx.get_stream<xpu>();
+  const mxnet::TShape& cshape    = inputs[box_detection_enum::kClsProb].shape_;
+  const int num_batch            = cshape[0];
+  const int num_anchor           = cshape[1];
+  const int num_class            = cshape[2];
+  const int num_cand             = num_anchor * num_class;
+  const int topk = param.nms_topk < 0 ? num_cand : std::min(num_cand, param.nms_topk);
+  MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, DType, {
+    const DType* cls_prob = inputs[box_detection_enum::kClsProb].dptr<DType>();
+    const DType* loc_pred = inputs[box_detection_enum::kLocPred].dptr<DType>();
+    const DType* anchors  = inputs[box_detection_enum::kAnchor].dptr<DType>();
+    DType* out            = outputs[box_detection_enum::kOut].dptr<DType>();
+
+    // prepare workspace: the nms bitmasks, then the int32 and DType parts
+    const size_t mask_words = NMSBitmaskWords(num_batch, topk);
+    Shape<1> cand_shape     = Shape1(num_batch * num_cand);
+    Shape<1> topk_shape     = Shape1(num_batch * topk);
+    index_t mask_offset     = mask_words * sizeof(uint64_t) / sizeof(DType);
+    index_t int32_size      = cand_shape.Size() * 2 + topk_shape.Size() + num_batch + 1;
+    // scores, rows and areas, plus the gathered boxes of the parallel nms
+    index_t dtype_size = cand_shape.Size() + topk_shape.Size() * (mask_words > 0 ? 13 : 7);
+    // ceil up when sizeof(DType) is larger than sizeof(DType)
+    index_t int32_offset = (int32_size * sizeof(int32_t) - 1) / sizeof(DType) + 1;
+    Tensor<xpu, 1, DType> workspace =
+        ctx.requested[box_detection_enum::kTempSpace].get_space_typed<xpu, 1, DType>(
+            Shape1(mask_offset + int32_offset + dtype_size), s);
+    uint64_t* mask = reinterpret_cast<uint64_t*>(workspace.dptr_);
+    Tensor<xpu, 1, int32_t> sorted_index(
+        reinterpret_cast<int32_t*>(workspace.dptr_ + mask_offset), cand_shape, s);
+    Tensor<xpu, 1, int32_t> batch_id(sorted_index.dptr_ + sorted_index.MSize(), cand_shape, s);
+    Tensor<xpu, 1, int32_t> nms_index(batch_id.dptr_ + batch_id.MSize(), topk_shape, s);
+    Tensor<xpu, 1, int32_t> batch_start(
+        nms_index.dptr_ + nms_index.MSize(), Shape1(num_batch + 1), s);
+    Tensor<xpu, 1, DType> scores(workspace.dptr_ + mask_offset + int32_offset, cand_shape, s);
+    Tensor<xpu, 3, DType> dets(scores.dptr_ + scores.MSize(), Shape3(num_batch, topk, 6), s);
+    Tensor<xpu, 1, DType> areas(dets.dptr_ + dets.MSize(), topk_shape, s);
+    DType* boxes = areas.dptr_ + areas.MSize();
+
+    // a candidate per anchor and class, sorted by batch then score (stable sort)
+    Kernel<detection_filter, xpu>::Launch(s,
+                                          num_batch * num_cand,
+                                          scores.dptr_,
+                                          cls_prob,
+                                          num_class,
+                                          static_cast<DType>(param.valid_thresh),
+                                          param.background_id);
+    sorted_index = range<int32_t>(0, num_batch * num_cand);
+    mxnet::op::SortByKey(scores, sorted_index, false);
+    batch_id = sorted_index / ScalarExp<int32_t>(num_cand);
+    mxnet::op::SortByKey(batch_id, sorted_index, true);
+
+    // only the topk candidates of each batch are decoded
+    Kernel<detection_gather, xpu>::Launch(s,
+                                          num_batch * topk,
+                                          dets.dptr_,
+                                          areas.dptr_,
+                                          sorted_index.dptr_,
+                                          cls_prob,
+                                          loc_pred,
+                                          anchors,
+                                          topk,
+                                          num_anchor,
+                                          num_class,
+                                          static_cast<DType>(param.valid_thresh),
+                                          param.background_id,
+                                          static_cast<DType>(param.std0),
+                                          static_cast<DType>(param.std1),
+                                          static_cast<DType>(param.std2),
+                                          static_cast<DType>(param.std3),
+                                          static_cast<DType>(param.clip),
+                                          param.format);
+
+    // the invalid rows are after the valid ones, so they never suppress them
+    nms_index   = range<int32_t>(0, num_batch * topk);
+    batch_start = range<int32_t>(0, (num_batch + 1) * topk, topk);
+    if (mask_words > 0) {
+      mxnet::op::NMSApplyBitmask(s,
+                                 num_batch,
+                                 topk,
+                                 &nms_index,
+                                 &batch_start,
+                                 &dets,
+                                 &areas,
+                                 mask,
+                                 boxes,
+                                 6,
+                                 2,
+                                 0,
+                                 param.overlap_thresh,
+                                 !param.force_suppress,
+                                 box_common_enum::kCorner);
+    } else {
+      mxnet::op::NMSApply(s,
+                          num_batch,
+                          topk,
+                          &nms_index,
+                          &batch_start,
+                          &dets,
+                          &areas,
+                          topk,
+                          6,
+                          2,
+                          0,
+                          param.overlap_thresh,
+                          param.force_suppress,
+                          box_common_enum::kCorner);
+    }
+    Kernel<detection_assign, xpu>::Launch(
+        s, num_batch, out, dets.dptr_, nms_index.dptr_, topk, param.keep_topk);
+  });
+}
+
 }  // namespace op
 }  // namespace mxnet
 
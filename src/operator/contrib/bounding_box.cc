@@ -31,6 +31,7 @@ DMLC_REGISTER_PARAMETER(BoxNMSParam);
 DMLC_REGISTER_PARAMETER(BoxOverlapParam);
 DMLC_REGISTER_PARAMETER(BipartiteMatchingParam);
 DMLC_REGISTER_PARAMETER(BoxDecodeParam);
+DMLC_REGISTER_PARAMETER(BoxDetectionParam);
 
 NNVM_REGISTER_OP(_contrib_box_nms)
     .add_alias("_contrib_box_non_maximum_suppression")
@@ -254,5 +255,49 @@ NNVM_REGISTER_OP(_contrib_box_decode)
     .add_argument("anchors", "NDArray-or-Symbol", "(1, N, 4) encoded in corner or center")
     .add_arguments(BoxDecodeParam::__FIELDS__());
 
+NNVM_REGISTER_OP(_contrib_box_detection)
+    .add_alias("_npx_box_detection")
+    .describe(R"doc(Decode, filter and apply non-maximum suppression to the predictions of a
+detection head in a single operator.
+
+Each anchor and class is a candidate, with the score of the class. Candidates whose
+score is not larger than ``valid_thresh`` or whose class is ``background_id`` are ignored.
+The ``nms_topk`` candidates of each batch with the highest scores are decoded as
+``box_decode`` does, then non-maximum suppression is applied to them as ``box_nms`` does.
+Only the selected candidates are decoded, no decoded copy of all anchors is made.
+
+The output is (B, keep_topk, 6), with the remaining detections of each batch as
+[class_id, score, xmin, ymin, xmax, ymax] in descending score order, padded with -1.
+
+Examples::
+
+  cls_prob = mx.nd.softmax(cls_pred, axis=-1)  # (B, N, C), class 0 is the background
+  dets = mx.nd.contrib.box_detection(cls_prob, loc_pred, anchors,
+                                     std0=0.1, std1=0.1, std2=0.2, std3=0.2,
+                                     nms_topk=400, keep_topk=100)
+
+)doc" ADD_FILELINE)
+    .set_num_inputs(3)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<BoxDetectionParam>)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          return std::vector<std::string>{"cls_prob", "loc_pred", "anchors"};
+        })
+    .set_attr<mxnet::FInferShape>("FInferShape", BoxDetectionShape)
+    .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<3, 1>)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<THasDeterministicOutput>("THasDeterministicOutput", true)
+    .set_attr<FCompute>("FCompute<cpu>", BoxDetectionForward<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes)
+    .add_argument("cls_prob", "NDArray-or-Symbol", "(B, N, C) scores of the classes")
+    .add_argument("loc_pred", "NDArray-or-Symbol", "(B, N, 4) predicted bbox offset")
+    .add_argument("anchors", "NDArray-or-Symbol", "(1, N, 4) encoded in corner or center")
+    .add_arguments(BoxDetectionParam::__FIELDS__());
+
 }  // namespace op
 }  // namespace mxnet
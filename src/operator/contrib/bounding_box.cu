@@ -789,5 +789,8 @@ NNVM_REGISTER_OP(_contrib_box_encode).set_attr<FCompute>("FCompute<gpu>", BoxEnc
 
 NNVM_REGISTER_OP(_contrib_box_decode).set_attr<FCompute>("FCompute<gpu>", BoxDecodeForward<gpu>);
 
+NNVM_REGISTER_OP(_contrib_box_detection)
+    .set_attr<FCompute>("FCompute<gpu>", BoxDetectionForward<gpu>);
+
 }  // namespace op
 }  // namespace mxnet
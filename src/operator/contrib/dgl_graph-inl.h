@@ -24,6 +24,8 @@
 #include <dmlc/parameter.h>
 #include <mxnet/operator.h>
 #include <mxnet/ndarray.h>
+#include <cstring>
+#include <functional>
 #include <map>
 #include <algorithm>
 #include <vector>
@@ -37,6 +39,90 @@
 namespace mxnet {
 namespace op {
 
+typedef int64_t dgl_id_t;
+
+struct NeighborSampleParam : public dmlc::Parameter<NeighborSampleParam> {
+  int num_args;
+  dgl_id_t num_hops;
+  dgl_id_t num_neighbor;
+  dgl_id_t max_num_vertices;
+  DMLC_DECLARE_PARAMETER(NeighborSampleParam) {
+    DMLC_DECLARE_FIELD(num_args).set_lower_bound(2).describe("Number of input NDArray.");
+    DMLC_DECLARE_FIELD(num_hops).set_default(1).describe("Number of hops.");
+    DMLC_DECLARE_FIELD(num_neighbor).set_default(2).describe("Number of neighbor.");
+    DMLC_DECLARE_FIELD(max_num_vertices).set_default(100).describe("Max number of vertices.");
+  }
+};
+
+/*!
+ * \brief Random key of the neighbor at position pos of a vertex. A counter-based hash, so the
+ *        samples do not depend on the thread or device drawing them: the neighbors with the
+ *        smallest keys are a uniform sample.
+ */
+MSHADOW_XINLINE uint32_t NeighborSampleKey(uint64_t seed, dgl_id_t vertex, dgl_id_t pos) {
+  uint64_t x = seed + static_cast<uint64_t>(vertex) * 0x9e3779b97f4a7c15ULL +
+               static_cast<uint64_t>(pos) * 0xd1b54a32d192ed03ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return static_cast<uint32_t>((x ^ (x >> 31)) >> 32);
+}
+
+/*!
+ * \brief Key of the neighbor at position pos of a vertex for a sample with probabilities
+ *        proportional to the weights (Efraimidis-Spirakis): an exponential variate of rate
+ *        weight, as the bits of the float, which are ordered like the non-negative floats.
+ */
+MSHADOW_XINLINE uint32_t NeighborSampleWeightedKey(uint64_t seed,
+                                                   dgl_id_t vertex,
+                                                   dgl_id_t pos,
+                                                   float weight) {
+  if (!(weight > 0))
+    return 0x7f800000u;  // infinity, only sampled when there are not enough other neighbors
+  // uniform in (0, 1)
+  const float u   = ((NeighborSampleKey(seed, vertex, pos) >> 9) + 0.5f) * 1.1920929e-7f;
+  const float key = -logf(u) / weight;
+#ifdef __CUDA_ARCH__
+  return __float_as_uint(key);
+#else
+  uint32_t bits;
+  std::memcpy(&bits, &key, sizeof(bits));
+  return bits;
+#endif
+}
+
+/*!
+ * \brief Samples at most num_neighbor neighbors of each of the n vertices of a frontier: the
+ *        ones of frontier[i] go to cols and edges from i * num_neighbor, their number to
+ *        counts[i]. All the buffers are on the host.
+ */
+typedef std::function<void(
+    const dgl_id_t* frontier, size_t n, dgl_id_t* cols, dgl_id_t* edges, dgl_id_t* counts)>
+    NeighborSampler;
+
+/*! \brief Subgraph sampled by SampleSubgraph, on the host */
+struct SampledSubgraph {
+  /*! \brief sampled vertices in ascending order, and the layers they were reached at */
+  std::vector<dgl_id_t> vertices;
+  std::vector<dgl_id_t> layers;
+  /*! \brief sampled edges as a csr of max_num_vertices rows, one per sampled vertex */
+  std::vector<dgl_id_t> indptr;
+  std::vector<dgl_id_t> cols;
+  std::vector<dgl_id_t> edges;
+};
+
+/*!
+ * \brief Breadth-first sampling of the num_hops neighborhood of the seeds, up to
+ *        max_num_vertices vertices. The neighbors of all the vertices of a layer are sampled
+ *        at once by the sampler.
+ */
+void SampleSubgraph(const dgl_id_t* seed,
+                    size_t num_seeds,
+                    const NeighborSampler& sampler,
+                    int num_hops,
+                    size_t num_neighbor,
+                    size_t max_num_vertices,
+                    SampledSubgraph* out);
+
 template <typename xpu>
 void DGLAdjacencyForwardEx(const nnvm::NodeAttrs& attrs,
                            const OpContext& ctx,
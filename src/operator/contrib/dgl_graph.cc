@@ -26,8 +26,10 @@
 #include <dmlc/optional.h>
 #include <algorithm>
 #include <random>
+#include <unordered_set>
 #include <utility>
 
+#include "../../engine/openmp.h"
 #include "../elemwise_op_common.h"
 #include "../../imperative/imperative_utils.h"
 #include "../subgraph_op_common.h"
@@ -36,108 +38,8 @@
 namespace mxnet {
 namespace op {
 
-typedef int64_t dgl_id_t;
-
 ////////////////////////////// Graph Sampling ///////////////////////////////
 
-/*
- * ArrayHeap is used to sample elements from vector
- */
-class ArrayHeap {
- public:
-  explicit ArrayHeap(const std::vector<float>& prob, unsigned int seed) {
-    generator_    = std::mt19937(seed);
-    distribution_ = std::uniform_real_distribution<float>(0.0, 1.0);
-    vec_size_     = prob.size();
-    bit_len_      = ceil(log2(vec_size_));
-    limit_        = 1 << bit_len_;
-    // allocate twice the size
-    heap_.resize(limit_ << 1, 0);
-    // allocate the leaves
-    for (int i = limit_; i < vec_size_ + limit_; ++i) {
-      heap_[i] = prob[i - limit_];
-    }
-    // iterate up the tree (this is O(m))
-    for (int i = bit_len_ - 1; i >= 0; --i) {
-      for (int j = (1 << i); j < (1 << (i + 1)); ++j) {
-        heap_[j] = heap_[j << 1] + heap_[(j << 1) + 1];
-      }
-    }
-  }
-  ~ArrayHeap() = default;
-
-  /*
-   * Remove term from index (this costs O(log m) steps)
-   */
-  void Delete(size_t index) {
-    size_t i = index + limit_;
-    float w  = heap_[i];
-    for (int j = bit_len_; j >= 0; --j) {
-      heap_[i] -= w;
-      i = i >> 1;
-    }
-  }
-
-  /*
-   * Add value w to index (this costs O(log m) steps)
-   */
-  void Add(size_t index, float w) {
-    size_t i = index + limit_;
-    for (int j = bit_len_; j >= 0; --j) {
-      heap_[i] += w;
-      i = i >> 1;
-    }
-  }
-
-  /*
-   * Sample from arrayHeap
-   */
-  size_t Sample() {
-    float xi = heap_[1] * distribution_(generator_);
-    int i    = 1;
-    while (i < limit_) {
-      i = i << 1;
-      if (xi >= heap_[i]) {
-        xi -= heap_[i];
-        i += 1;
-      }
-    }
-    return i - limit_;
-  }
-
-  /*
-   * Sample a vector by given the size n
-   */
-  void SampleWithoutReplacement(size_t n, std::vector<size_t>* samples) {
-    // sample n elements
-    for (size_t i = 0; i < n; ++i) {
-      samples->at(i) = this->Sample();
-      this->Delete(samples->at(i));
-    }
-  }
-
- private:
-  int vec_size_;  // sample size
-  int bit_len_;   // bit size
-  int limit_;
-  std::vector<float> heap_;
-  std::mt19937 generator_;
-  std::uniform_real_distribution<float> distribution_;
-};
-
-struct NeighborSampleParam : public dmlc::Parameter<NeighborSampleParam> {
-  int num_args;
-  dgl_id_t num_hops;
-  dgl_id_t num_neighbor;
-  dgl_id_t max_num_vertices;
-  DMLC_DECLARE_PARAMETER(NeighborSampleParam) {
-    DMLC_DECLARE_FIELD(num_args).set_lower_bound(2).describe("Number of input NDArray.");
-    DMLC_DECLARE_FIELD(num_hops).set_default(1).describe("Number of hops.");
-    DMLC_DECLARE_FIELD(num_neighbor).set_default(2).describe("Number of neighbor.");
-    DMLC_DECLARE_FIELD(max_num_vertices).set_default(100).describe("Max number of vertices.");
-  }
-};
-
 DMLC_REGISTER_PARAMETER(NeighborSampleParam);
 
 /*
@@ -391,150 +293,72 @@ static bool CSRNeighborNonUniformSampleType(const nnvm::NodeAttrs& attrs,
   return success;
 }
 
-static void RandomSample(size_t set_size, size_t num, std::vector<size_t>* out, unsigned int seed) {
-  std::mt19937 generator(seed);
-  std::unordered_set<size_t> sampled_idxs;
-  std::uniform_int_distribution<size_t> distribution(0, set_size - 1);
-  while (sampled_idxs.size() < num) {
-    sampled_idxs.insert(distribution(generator));
-  }
-  out->clear();
-  for (size_t sampled_idx : sampled_idxs) {
-    out->push_back(sampled_idx);
-  }
-}
-
-static void NegateSet(const std::vector<size_t>& idxs, size_t set_size, std::vector<size_t>* out) {
-  // idxs must have been sorted.
-  auto it  = idxs.begin();
-  size_t i = 0;
-  CHECK_GT(set_size, idxs.back());
-  for (; i < set_size && it != idxs.end(); i++) {
-    if (*it == i) {
-      it++;
-      continue;
-    }
-    out->push_back(i);
-  }
-  for (; i < set_size; i++) {
-    out->push_back(i);
-  }
-}
-
 /*
- * Uniform sample
+ * Sample the neighbors of the vertices of a frontier in parallel, with the num_neighbor
+ * smallest keys of NeighborSampleKey or NeighborSampleWeightedKey
  */
-static void GetUniformSample(const dgl_id_t* val_list,
-                             const dgl_id_t* col_list,
-                             const size_t ver_len,
-                             const size_t max_num_neighbor,
-                             std::vector<dgl_id_t>* out_ver,
-                             std::vector<dgl_id_t>* out_edge,
-                             unsigned int seed) {
-  // Copy ver_list to output
-  if (ver_len <= max_num_neighbor) {
-    for (size_t i = 0; i < ver_len; ++i) {
-      out_ver->push_back(col_list[i]);
-      out_edge->push_back(val_list[i]);
-    }
-    return;
-  }
-  // If we just sample a small number of elements from a large neighbor list.
-  std::vector<size_t> sorted_idxs;
-  if (ver_len > max_num_neighbor * 2) {
-    sorted_idxs.reserve(max_num_neighbor);
-    RandomSample(ver_len, max_num_neighbor, &sorted_idxs, seed);
-    std::sort(sorted_idxs.begin(), sorted_idxs.end());
-  } else {
-    std::vector<size_t> negate;
-    negate.reserve(ver_len - max_num_neighbor);
-    RandomSample(ver_len, ver_len - max_num_neighbor, &negate, seed);
-    std::sort(negate.begin(), negate.end());
-    NegateSet(negate, ver_len, &sorted_idxs);
-  }
-  // verify the result.
-  CHECK_EQ(sorted_idxs.size(), max_num_neighbor);
-  for (size_t i = 1; i < sorted_idxs.size(); i++) {
-    CHECK_GT(sorted_idxs[i], sorted_idxs[i - 1]);
-  }
-  for (auto idx : sorted_idxs) {
-    out_ver->push_back(col_list[idx]);
-    out_edge->push_back(val_list[idx]);
-  }
-}
-
-/*
- * Non-uniform sample via ArrayHeap
- */
-static void GetNonUniformSample(const float* probability,
-                                const dgl_id_t* val_list,
-                                const dgl_id_t* col_list,
-                                const size_t ver_len,
-                                const size_t max_num_neighbor,
-                                std::vector<dgl_id_t>* out_ver,
-                                std::vector<dgl_id_t>* out_edge,
-                                unsigned int seed) {
-  // Copy ver_list to output
-  if (ver_len <= max_num_neighbor) {
-    for (size_t i = 0; i < ver_len; ++i) {
-      out_ver->push_back(col_list[i]);
-      out_edge->push_back(val_list[i]);
+static void SampleNeighborsCPU(const NDArray& csr,
+                               const float* probability,
+                               uint64_t seed,
+                               size_t num_neighbor,
+                               const dgl_id_t* frontier,
+                               size_t n,
+                               dgl_id_t* out_cols,
+                               dgl_id_t* out_edges,
+                               dgl_id_t* counts,
+                               int num_threads) {
+  const dgl_id_t* val_list = csr.data().dptr<dgl_id_t>();
+  const dgl_id_t* col_list = csr.aux_data(csr::kIdx).dptr<dgl_id_t>();
+  const dgl_id_t* indptr   = csr.aux_data(csr::kIndPtr).dptr<dgl_id_t>();
+#pragma omp parallel num_threads(num_threads)
+  {
+    // <key, position> of the neighbors of a vertex, reused by the thread
+    std::vector<std::pair<uint32_t, dgl_id_t> > keys;
+#pragma omp for
+    for (int64_t i = 0; i < static_cast<int64_t>(n); ++i) {
+      const dgl_id_t dst_id = frontier[i];
+      const dgl_id_t begin  = indptr[dst_id];
+      const size_t ver_len  = indptr[dst_id + 1] - begin;
+      dgl_id_t* cols        = out_cols + i * num_neighbor;
+      dgl_id_t* edges       = out_edges + i * num_neighbor;
+      if (ver_len <= num_neighbor) {
+        std::copy_n(col_list + begin, ver_len, cols);
+        std::copy_n(val_list + begin, ver_len, edges);
+        counts[i] = ver_len;
+        continue;
+      }
+      keys.resize(ver_len);
+      for (size_t j = 0; j < ver_len; ++j) {
+        keys[j].first =
+            probability == nullptr ?
+                NeighborSampleKey(seed, dst_id, j) :
+                NeighborSampleWeightedKey(seed, dst_id, j, probability[col_list[begin + j]]);
+        keys[j].second = j;
+      }
+      // ties are broken by position, as on GPU
+      std::nth_element(keys.begin(), keys.begin() + num_neighbor - 1, keys.end());
+      std::sort(keys.begin(),
+                keys.begin() + num_neighbor,
+                [](const std::pair<uint32_t, dgl_id_t>& a1,
+                   const std::pair<uint32_t, dgl_id_t>& a2) { return a1.second < a2.second; });
+      for (size_t j = 0; j < num_neighbor; ++j) {
+        cols[j]  = col_list[begin + keys[j].second];
+        edges[j] = val_list[begin + keys[j].second];
+      }
+      counts[i] = num_neighbor;
     }
-    return;
   }
-  // Make sample
-  std::vector<size_t> sp_index(max_num_neighbor);
-  std::vector<float> sp_prob(ver_len);
-  for (size_t i = 0; i < ver_len; ++i) {
-    sp_prob[i] = probability[col_list[i]];
-  }
-  ArrayHeap arrayHeap(sp_prob, seed);
-  arrayHeap.SampleWithoutReplacement(max_num_neighbor, &sp_index);
-  out_ver->resize(max_num_neighbor);
-  out_edge->resize(max_num_neighbor);
-  for (size_t i = 0; i < max_num_neighbor; ++i) {
-    size_t idx      = sp_index[i];
-    out_ver->at(i)  = col_list[idx];
-    out_edge->at(i) = val_list[idx];
-  }
-  sort(out_ver->begin(), out_ver->end());
-  sort(out_edge->begin(), out_edge->end());
 }
 
-/*
- * Used for subgraph sampling
- */
-struct neigh_list {
-  std::vector<dgl_id_t> neighs;
-  std::vector<dgl_id_t> edges;
-  neigh_list(std::vector<dgl_id_t> _neighs, std::vector<dgl_id_t> _edges)
-      : neighs(std::move(_neighs)), edges(std::move(_edges)) {}
-};
-
-/*
- * Sample sub-graph from csr graph
- */
-static void SampleSubgraph(const NDArray& csr,
-                           const NDArray& seed_arr,
-                           const NDArray& sampled_ids,
-                           const NDArray& sub_csr,
-                           float* sub_prob,
-                           const NDArray& sub_layer,
-                           const float* probability,
-                           int num_hops,
-                           size_t num_neighbor,
-                           size_t max_num_vertices,
-                           unsigned int random_seed) {
-  size_t num_seeds = seed_arr.shape().Size();
+void SampleSubgraph(const dgl_id_t* seed,
+                    size_t num_seeds,
+                    const NeighborSampler& sampler,
+                    int num_hops,
+                    size_t num_neighbor,
+                    size_t max_num_vertices,
+                    SampledSubgraph* out) {
   CHECK_GE(max_num_vertices, num_seeds);
 
-  const dgl_id_t* val_list = csr.data().dptr<dgl_id_t>();
-  const dgl_id_t* col_list = csr.aux_data(csr::kIdx).dptr<dgl_id_t>();
-  const dgl_id_t* indptr   = csr.aux_data(csr::kIndPtr).dptr<dgl_id_t>();
-  const dgl_id_t* seed     = seed_arr.data().dptr<dgl_id_t>();
-  dgl_id_t* out            = sampled_ids.data().dptr<dgl_id_t>();
-  dgl_id_t* out_layer      = sub_layer.data().dptr<dgl_id_t>();
-
   // BFS traverse the graph and sample vertices
   // <vertex_id, layer_id>
   std::unordered_set<dgl_id_t> sub_ver_mp;
@@ -548,74 +372,56 @@ static void SampleSubgraph(const NDArray& csr,
       sub_vers.emplace_back(seed[i], 0);
     }
   }
-  std::vector<dgl_id_t> tmp_sampled_src_list;
-  std::vector<dgl_id_t> tmp_sampled_edge_list;
-  // ver_id, position
+  // the frontier and its sampled neighbors, num_neighbor slots per vertex
+  std::vector<dgl_id_t> frontier, level_cols, level_edges, level_counts;
+  // ver_id, position of its neighbors in sampled_cols and sampled_edges
   std::vector<std::pair<dgl_id_t, size_t> > neigh_pos;
   neigh_pos.reserve(num_seeds);
-  std::vector<dgl_id_t> neighbor_list;
-  size_t num_edges = 0;
+  std::vector<dgl_id_t> sampled_cols, sampled_edges;
+  std::vector<size_t> neigh_num;
 
-  // sub_vers is used both as a node collection and a queue.
-  // In the while loop, we iterate over sub_vers and new nodes are added to the vector.
-  // A vertex in the vector only needs to be accessed once. If there is a vertex behind idx
-  // isn't in the last level, we will sample its neighbors. If not, the while loop terminates.
+  // sub_vers is used both as a node collection and a queue, in which a layer follows the
+  // previous one. The neighbors of the whole layer behind idx are sampled at once, then the
+  // vertices are visited in order: the new neighbors are added to the queue until there are
+  // max_num_vertices vertices, and the vertices visited after that are not sampled.
   size_t idx = 0;
   while (idx < sub_vers.size() && sub_ver_mp.size() < max_num_vertices) {
-    dgl_id_t dst_id    = sub_vers[idx].first;
-    int cur_node_level = sub_vers[idx].second;
-    idx++;
-    // If the node is in the last level, we don't need to sample neighbors
-    // from this node.
+    const dgl_id_t cur_node_level = sub_vers[idx].second;
+    // If the nodes are in the last level, we don't need to sample their neighbors.
     if (cur_node_level >= num_hops)
-      continue;
-
-    tmp_sampled_src_list.clear();
-    tmp_sampled_edge_list.clear();
-    dgl_id_t ver_len = *(indptr + dst_id + 1) - *(indptr + dst_id);
-    if (probability == nullptr) {  // uniform-sample
-      GetUniformSample(val_list + *(indptr + dst_id),
-                       col_list + *(indptr + dst_id),
-                       ver_len,
-                       num_neighbor,
-                       &tmp_sampled_src_list,
-                       &tmp_sampled_edge_list,
-                       random_seed);
-    } else {  // non-uniform-sample
-      GetNonUniformSample(probability,
-                          val_list + *(indptr + dst_id),
-                          col_list + *(indptr + dst_id),
-                          ver_len,
-                          num_neighbor,
-                          &tmp_sampled_src_list,
-                          &tmp_sampled_edge_list,
-                          random_seed);
-    }
-    CHECK_EQ(tmp_sampled_src_list.size(), tmp_sampled_edge_list.size());
-    size_t pos = neighbor_list.size();
-    neigh_pos.emplace_back(dst_id, pos);
-    // First we push the size of neighbor vector
-    neighbor_list.push_back(tmp_sampled_edge_list.size());
-    // Then push the vertices
-    for (dgl_id_t& i : tmp_sampled_src_list) {
-      neighbor_list.push_back(i);
-    }
-    // Finally we push the edge list
-    for (dgl_id_t& i : tmp_sampled_edge_list) {
-      neighbor_list.push_back(i);
+      break;
+    frontier.clear();
+    for (size_t i = idx; i < sub_vers.size(); ++i) {
+      frontier.push_back(sub_vers[i].first);
     }
-    num_edges += tmp_sampled_src_list.size();
-    for (dgl_id_t& i : tmp_sampled_src_list) {
-      // If we have sampled the max number of vertices, we have to stop.
-      if (sub_ver_mp.size() >= max_num_vertices)
-        break;
-      // We need to add the neighbor in the hashtable here. This ensures that
-      // the vertex in the queue is unique. If we see a vertex before, we don't
-      // need to add it to the queue again.
-      auto ret = sub_ver_mp.insert(i);
-      // If the sampled neighbor is inserted to the map successfully.
-      if (ret.second)
-        sub_vers.emplace_back(i, cur_node_level + 1);
+    level_cols.resize(frontier.size() * num_neighbor);
+    level_edges.resize(frontier.size() * num_neighbor);
+    level_counts.resize(frontier.size());
+    sampler(frontier.data(),
+            frontier.size(),
+            level_cols.data(),
+            level_edges.data(),
+            level_counts.data());
+    for (size_t i = 0; i < frontier.size() && sub_ver_mp.size() < max_num_vertices; ++i, ++idx) {
+      const dgl_id_t* cols = level_cols.data() + i * num_neighbor;
+      const dgl_id_t* edges = level_edges.data() + i * num_neighbor;
+      const size_t num      = level_counts[i];
+      neigh_pos.emplace_back(frontier[i], sampled_cols.size());
+      neigh_num.push_back(num);
+      sampled_cols.insert(sampled_cols.end(), cols, cols + num);
+      sampled_edges.insert(sampled_edges.end(), edges, edges + num);
+      for (size_t j = 0; j < num; ++j) {
+        // If we have sampled the max number of vertices, we have to stop.
+        if (sub_ver_mp.size() >= max_num_vertices)
+          break;
+        // We need to add the neighbor in the hashtable here. This ensures that
+        // the vertex in the queue is unique. If we see a vertex before, we don't
+        // need to add it to the queue again.
+        auto ret = sub_ver_mp.insert(cols[j]);
+        // If the sampled neighbor is inserted to the map successfully.
+        if (ret.second)
+          sub_vers.emplace_back(cols[j], cur_node_level + 1);
+      }
     }
   }
   // Let's check if there is a vertex that we haven't sampled its neighbors.
@@ -628,73 +434,114 @@ static void SampleSubgraph(const NDArray& csr,
     }
   }
 
-  // Copy sub_ver_mp to output[0]
-  // Copy layer
-  size_t num_vertices = sub_ver_mp.size();
+  // Copy the vertices and their layers
   std::sort(sub_vers.begin(),
             sub_vers.end(),
             [](const std::pair<dgl_id_t, dgl_id_t>& a1, const std::pair<dgl_id_t, dgl_id_t>& a2) {
               return a1.first < a2.first;
             });
+  out->vertices.resize(sub_vers.size());
+  out->layers.resize(sub_vers.size());
   for (size_t i = 0; i < sub_vers.size(); i++) {
-    out[i]       = sub_vers[i].first;
-    out_layer[i] = sub_vers[i].second;
+    out->vertices[i] = sub_vers[i].first;
+    out->layers[i]   = sub_vers[i].second;
+  }
+
+  // Construct sub_csr_graph
+  // Both the vertices and neigh_pos are sorted. By scanning the two arrays, we can see
+  // which vertices have neighbors and which don't.
+  std::vector<size_t> order(neigh_pos.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
   }
+  std::sort(order.begin(), order.end(), [&neigh_pos](size_t a1, size_t a2) {
+    return neigh_pos[a1].first < neigh_pos[a2].first;
+  });
+  out->indptr.assign(max_num_vertices + 1, 0);
+  out->cols.clear();
+  out->edges.clear();
+  out->cols.reserve(sampled_cols.size());
+  out->edges.reserve(sampled_edges.size());
+  size_t idx_with_neigh = 0;
+  for (size_t i = 0; i < out->vertices.size(); i++) {
+    // If a vertex is sampled but not in neigh_pos, this vertex must not have edges.
+    size_t edge_size = 0;
+    if (idx_with_neigh < order.size() &&
+        out->vertices[i] == neigh_pos[order[idx_with_neigh]].first) {
+      const size_t pos = neigh_pos[order[idx_with_neigh]].second;
+      edge_size        = neigh_num[order[idx_with_neigh]];
+      out->cols.insert(out->cols.end(),
+                       sampled_cols.begin() + pos,
+                       sampled_cols.begin() + pos + edge_size);
+      out->edges.insert(out->edges.end(),
+                        sampled_edges.begin() + pos,
+                        sampled_edges.begin() + pos + edge_size);
+      idx_with_neigh++;
+    }
+    out->indptr[i + 1] = out->indptr[i] + edge_size;
+  }
+  for (size_t i = out->vertices.size() + 1; i <= max_num_vertices; ++i) {
+    out->indptr[i] = out->indptr[i - 1];
+  }
+}
+
+/*
+ * Sample sub-graph from csr graph
+ */
+static void SampleSubgraphCPU(const NDArray& csr,
+                              const NDArray& seed_arr,
+                              const NDArray& sampled_ids,
+                              const NDArray& sub_csr,
+                              float* sub_prob,
+                              const NDArray& sub_layer,
+                              const float* probability,
+                              const NeighborSampleParam& params,
+                              uint64_t random_seed,
+                              int num_threads) {
+  const size_t num_neighbor = params.num_neighbor;
+  auto sampler              = [&](const dgl_id_t* frontier,
+                     size_t n,
+                     dgl_id_t* cols,
+                     dgl_id_t* edges,
+                     dgl_id_t* counts) {
+    SampleNeighborsCPU(
+        csr, probability, random_seed, num_neighbor, frontier, n, cols, edges, counts, num_threads);
+  };
+  SampledSubgraph sub;
+  SampleSubgraph(seed_arr.data().dptr<dgl_id_t>(),
+                 seed_arr.shape().Size(),
+                 sampler,
+                 params.num_hops,
+                 num_neighbor,
+                 params.max_num_vertices,
+                 &sub);
+
+  // Copy the vertices and layers to the outputs
+  dgl_id_t* out       = sampled_ids.data().dptr<dgl_id_t>();
+  dgl_id_t* out_layer = sub_layer.data().dptr<dgl_id_t>();
+  std::copy(sub.vertices.begin(), sub.vertices.end(), out);
+  std::copy(sub.layers.begin(), sub.layers.end(), out_layer);
   // The last element stores the actual
   // number of vertices in the subgraph.
-  out[max_num_vertices] = sub_ver_mp.size();
+  out[params.max_num_vertices] = sub.vertices.size();
 
   // Copy sub_probability
   if (sub_prob != nullptr) {
-    for (size_t i = 0; i < sub_ver_mp.size(); ++i) {
-      dgl_id_t idx = out[i];
-      sub_prob[i]  = probability[idx];
+    for (size_t i = 0; i < sub.vertices.size(); ++i) {
+      sub_prob[i] = probability[sub.vertices[i]];
     }
   }
-  // Construct sub_csr_graph
   mxnet::TShape shape_1(1, -1);
   mxnet::TShape shape_2(1, -1);
-  shape_1[0] = num_edges;
-  shape_2[0] = max_num_vertices + 1;
+  shape_1[0] = sub.cols.size();
+  shape_2[0] = params.max_num_vertices + 1;
   sub_csr.CheckAndAllocData(shape_1);
   sub_csr.CheckAndAllocAuxData(csr::kIdx, shape_1);
   sub_csr.CheckAndAllocAuxData(csr::kIndPtr, shape_2);
-  dgl_id_t* val_list_out  = sub_csr.data().dptr<dgl_id_t>();
-  dgl_id_t* col_list_out  = sub_csr.aux_data(1).dptr<dgl_id_t>();
-  dgl_id_t* indptr_out    = sub_csr.aux_data(0).dptr<dgl_id_t>();
-  indptr_out[0]           = 0;
-  size_t collected_nedges = 0;
-
-  // Both the out array and neigh_pos are sorted. By scanning the two arrays, we can see
-  // which vertices have neighbors and which don't.
-  std::sort(neigh_pos.begin(),
-            neigh_pos.end(),
-            [](const std::pair<dgl_id_t, size_t>& a1, const std::pair<dgl_id_t, size_t>& a2) {
-              return a1.first < a2.first;
-            });
-  size_t idx_with_neigh = 0;
-  for (size_t i = 0; i < num_vertices; i++) {
-    dgl_id_t dst_id = *(out + i);
-    // If a vertex is in sub_ver_mp but not in neigh_pos, this vertex must not
-    // have edges.
-    size_t edge_size = 0;
-    if (idx_with_neigh < neigh_pos.size() && dst_id == neigh_pos[idx_with_neigh].first) {
-      size_t pos = neigh_pos[idx_with_neigh].second;
-      CHECK_LT(pos, neighbor_list.size());
-      edge_size = neighbor_list[pos];
-      CHECK_LE(pos + edge_size * 2 + 1, neighbor_list.size());
-
-      std::copy_n(neighbor_list.begin() + pos + 1, edge_size, col_list_out + collected_nedges);
-      std::copy_n(
-          neighbor_list.begin() + pos + edge_size + 1, edge_size, val_list_out + collected_nedges);
-      collected_nedges += edge_size;
-      idx_with_neigh++;
-    }
-    indptr_out[i + 1] = indptr_out[i] + edge_size;
-  }
-  for (size_t i = num_vertices + 1; i <= max_num_vertices; ++i) {
-    indptr_out[i] = indptr_out[i - 1];
-  }
+  std::copy(sub.edges.begin(), sub.edges.end(), sub_csr.data().dptr<dgl_id_t>());
+  std::copy(sub.cols.begin(), sub.cols.end(), sub_csr.aux_data(csr::kIdx).dptr<dgl_id_t>());
+  std::copy(
+      sub.indptr.begin(), sub.indptr.end(), sub_csr.aux_data(csr::kIndPtr).dptr<dgl_id_t>());
 }
 
 /*
@@ -713,24 +560,21 @@ static void CSRNeighborUniformSampleComputeExCPU(const nnvm::NodeAttrs& attrs,
   mshadow::Stream<cpu>* s                  = ctx.get_stream<cpu>();
   mshadow::Random<cpu, unsigned int>* prnd = ctx.requested[0].get_random<cpu, unsigned int>(s);
   unsigned int seed                        = prnd->GetRandInt();
+  const int num_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
 
-#pragma omp parallel for
+  // the neighbors of a single subgraph are sampled in parallel
+#pragma omp parallel for num_threads(num_threads) if (num_subgraphs > 1)
   for (int i = 0; i < num_subgraphs; i++) {
-    SampleSubgraph(inputs[0],                       // graph_csr
-                   inputs[i + 1],                   // seed vector
-                   outputs[i],                      // sample_id
-                   outputs[i + 1 * num_subgraphs],  // sub_csr
-                   nullptr,                         // sample_id_probability
-                   outputs[i + 2 * num_subgraphs],  // sample_id_layer
-                   nullptr,                         // probability
-                   params.num_hops,
-                   params.num_neighbor,
-                   params.max_num_vertices,
-#if defined(_OPENMP)
-                   seed + omp_get_thread_num());
-#else
-                   seed);
-#endif
+    SampleSubgraphCPU(inputs[0],                       // graph_csr
+                      inputs[i + 1],                   // seed vector
+                      outputs[i],                      // sample_id
+                      outputs[i + 1 * num_subgraphs],  // sub_csr
+                      nullptr,                         // sample_id_probability
+                      outputs[i + 2 * num_subgraphs],  // sample_id_layer
+                      nullptr,                         // probability
+                      params,
+                      seed + i,
+                      num_subgraphs > 1 ? 1 : num_threads);
   }
 }
 
@@ -791,7 +635,8 @@ Example:
     .set_attr<FComputeEx>("FComputeEx<cpu>", CSRNeighborUniformSampleComputeExCPU)
     .set_attr<FResourceRequest>("FResourceRequest",
                                 [](const NodeAttrs& attrs) {
-                                  return std::vector<ResourceRequest>{ResourceRequest::kRandom};
+                                  return std::vector<ResourceRequest>{ResourceRequest::kRandom,
+                                                                      ResourceRequest::kTempSpace};
                                 })
     .add_argument("csr_matrix", "NDArray-or-Symbol", "csr matrix")
     .add_argument("seed_arrays", "NDArray-or-Symbol[]", "seed vertices")
@@ -816,25 +661,22 @@ static void CSRNeighborNonUniformSampleComputeExCPU(const nnvm::NodeAttrs& attrs
   mshadow::Stream<cpu>* s                  = ctx.get_stream<cpu>();
   mshadow::Random<cpu, unsigned int>* prnd = ctx.requested[0].get_random<cpu, unsigned int>(s);
   unsigned int seed                        = prnd->GetRandInt();
+  const int num_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
 
-#pragma omp parallel for
+  // the neighbors of a single subgraph are sampled in parallel
+#pragma omp parallel for num_threads(num_threads) if (num_subgraphs > 1)
   for (int i = 0; i < num_subgraphs; i++) {
     float* sub_prob = outputs[i + 2 * num_subgraphs].data().dptr<float>();
-    SampleSubgraph(inputs[0],                       // graph_csr
-                   inputs[i + 2],                   // seed vector
-                   outputs[i],                      // sample_id
-                   outputs[i + 1 * num_subgraphs],  // sub_csr
-                   sub_prob,                        // sample_id_probability
-                   outputs[i + 3 * num_subgraphs],  // sample_id_layer
-                   probability,
-                   params.num_hops,
-                   params.num_neighbor,
-                   params.max_num_vertices,
-#if defined(_OPENMP)
-                   seed + omp_get_thread_num());
-#else
-                   seed);
-#endif
+    SampleSubgraphCPU(inputs[0],                       // graph_csr
+                      inputs[i + 2],                   // seed vector
+                      outputs[i],                      // sample_id
+                      outputs[i + 1 * num_subgraphs],  // sub_csr
+                      sub_prob,                        // sample_id_probability
+                      outputs[i + 3 * num_subgraphs],  // sample_id_layer
+                      probability,
+                      params,
+                      seed + i,
+                      num_subgraphs > 1 ? 1 : num_threads);
   }
 }
 
@@ -900,7 +742,8 @@ Example:
     .set_attr<FComputeEx>("FComputeEx<cpu>", CSRNeighborNonUniformSampleComputeExCPU)
     .set_attr<FResourceRequest>("FResourceRequest",
                                 [](const NodeAttrs& attrs) {
-                                  return std::vector<ResourceRequest>{ResourceRequest::kRandom};
+                                  return std::vector<ResourceRequest>{ResourceRequest::kRandom,
+                                                                      ResourceRequest::kTempSpace};
                                 })
     .add_argument("csr_matrix", "NDArray-or-Symbol", "csr matrix")
     .add_argument("probability", "NDArray-or-Symbol", "probability vector")
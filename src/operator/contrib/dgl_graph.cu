@@ -25,5 +25,341 @@ namespace op {
 NNVM_REGISTER_OP(_contrib_dgl_adjacency)
     .set_attr<FComputeEx>("FComputeEx<gpu>", DGLAdjacencyForwardEx<gpu>);
 
+////////////////////////////// Graph Sampling ///////////////////////////////
+
+constexpr int kSampleWarpSize = 32;
+
+template <bool weighted>
+__device__ __forceinline__ uint32_t sample_key(uint64_t seed,
+                                               dgl_id_t vertex,
+                                               dgl_id_t pos,
+                                               const float* probability,
+                                               const dgl_id_t* cols) {
+  return weighted ? NeighborSampleWeightedKey(seed, vertex, pos, probability[cols[pos]]) :
+                    NeighborSampleKey(seed, vertex, pos);
+}
+
+/*!
+ * \brief A warp samples the neighbors of a vertex of the frontier: the ones with the
+ *        num_neighbor smallest keys, ties broken by position as on CPU, in position order.
+ *        The threshold key is found by a radix select over its bits.
+ */
+template <bool weighted>
+__global__ void SampleNeighborsKernel(const dgl_id_t* indptr,
+                                      const dgl_id_t* col_list,
+                                      const dgl_id_t* val_list,
+                                      const float* probability,
+                                      uint64_t seed,
+                                      int num_neighbor,
+                                      const dgl_id_t* frontier,
+                                      int n,
+                                      dgl_id_t* out_cols,
+                                      dgl_id_t* out_edges,
+                                      dgl_id_t* counts) {
+  const int warp = (blockIdx.x * blockDim.x + threadIdx.x) / kSampleWarpSize;
+  const int lane = threadIdx.x % kSampleWarpSize;
+  if (warp >= n)
+    return;
+  const dgl_id_t vertex = frontier[warp];
+  const dgl_id_t begin  = indptr[vertex];
+  const dgl_id_t degree = indptr[vertex + 1] - begin;
+  const dgl_id_t* cols  = col_list + begin;
+  const dgl_id_t* edges = val_list + begin;
+  dgl_id_t* sampled_cols  = out_cols + static_cast<dgl_id_t>(warp) * num_neighbor;
+  dgl_id_t* sampled_edges = out_edges + static_cast<dgl_id_t>(warp) * num_neighbor;
+  if (degree <= num_neighbor) {
+    for (dgl_id_t j = lane; j < degree; j += kSampleWarpSize) {
+      sampled_cols[j]  = cols[j];
+      sampled_edges[j] = edges[j];
+    }
+    if (lane == 0)
+      counts[warp] = degree;
+    return;
+  }
+
+  // the num_neighbor-th smallest key, and how many of the keys equal to it are sampled
+  uint32_t threshold = 0, mask = 0;
+  dgl_id_t need = num_neighbor;
+  for (int bit = 31; bit >= 0; --bit) {
+    const uint32_t b = 1u << bit;
+    dgl_id_t count   = 0;
+    for (dgl_id_t j = lane; j < degree; j += kSampleWarpSize) {
+      const uint32_t key = sample_key<weighted>(seed, vertex, j, probability, cols);
+      count += (key & mask) == threshold && !(key & b);
+    }
+    for (int offset = kSampleWarpSize / 2; offset > 0; offset /= 2)
+      count += __shfl_xor_sync(0xffffffff, count, offset);
+    if (count < need) {
+      need -= count;
+      threshold |= b;
+    }
+    mask |= b;
+  }
+
+  const unsigned lower_lanes = (1u << lane) - 1;
+  dgl_id_t num_sampled = 0, num_ties = 0;
+  for (dgl_id_t base = 0; base < degree; base += kSampleWarpSize) {
+    const dgl_id_t j   = base + lane;
+    const uint32_t key = j < degree ?
+                             sample_key<weighted>(seed, vertex, j, probability, cols) :
+                             0xffffffffu;
+    const bool tie      = j < degree && key == threshold;
+    const unsigned ties = __ballot_sync(0xffffffff, tie);
+    const bool take =
+        key < threshold || (tie && num_ties + __popc(ties & lower_lanes) < need);
+    const unsigned sampled = __ballot_sync(0xffffffff, take);
+    if (take) {
+      const dgl_id_t pos = num_sampled + __popc(sampled & lower_lanes);
+      sampled_cols[pos]  = cols[j];
+      sampled_edges[pos] = edges[j];
+    }
+    num_sampled += __popc(sampled);
+    num_ties += __popc(ties);
+  }
+  if (lane == 0)
+    counts[warp] = num_neighbor;
+}
+
+struct neighbor_prob_gather {
+  MSHADOW_XINLINE static void Map(int i,
+                                  float* out,
+                                  const float* probability,
+                                  const dgl_id_t* vertices) {
+    out[i] = probability[vertices[i]];
+  }
+};
+
+/*
+ * Sample sub-graph from csr graph. The traversal is on the host, the neighbors of each layer
+ * are sampled by a kernel.
+ */
+static void SampleSubgraphGPU(const OpContext& ctx,
+                              const NDArray& csr,
+                              const NDArray& seed_arr,
+                              const NDArray& sampled_ids,
+                              const NDArray& sub_csr,
+                              float* sub_prob,
+                              const NDArray& sub_layer,
+                              const float* probability,
+                              const NeighborSampleParam& params,
+                              uint64_t random_seed,
+                              dgl_id_t* workspace) {
+  using namespace mshadow;
+  Stream<gpu>* s            = ctx.get_stream<gpu>();
+  cudaStream_t stream       = Stream<gpu>::GetStream(s);
+  const size_t num_neighbor = params.num_neighbor;
+  const size_t max_num_vertices = params.max_num_vertices;
+
+  std::vector<dgl_id_t> seeds(seed_arr.shape().Size());
+  CUDA_CALL(cudaMemcpyAsync(seeds.data(),
+                            seed_arr.data().dptr<dgl_id_t>(),
+                            seeds.size() * sizeof(dgl_id_t),
+                            cudaMemcpyDeviceToHost,
+                            stream));
+  CUDA_CALL(cudaStreamSynchronize(stream));
+
+  // frontier, counts, then num_neighbor slots per vertex for cols and edges
+  dgl_id_t* frontier_dev = workspace;
+  dgl_id_t* counts_dev   = frontier_dev + max_num_vertices;
+  dgl_id_t* cols_dev     = counts_dev + max_num_vertices;
+  dgl_id_t* edges_dev    = cols_dev + max_num_vertices * num_neighbor;
+  const dgl_id_t* indptr   = csr.aux_data(csr::kIndPtr).dptr<dgl_id_t>();
+  const dgl_id_t* col_list = csr.aux_data(csr::kIdx).dptr<dgl_id_t>();
+  const dgl_id_t* val_list = csr.data().dptr<dgl_id_t>();
+  auto sampler             = [&](const dgl_id_t* frontier,
+                     size_t n,
+                     dgl_id_t* cols,
+                     dgl_id_t* edges,
+                     dgl_id_t* counts) {
+    CHECK_LE(n, max_num_vertices);
+    CUDA_CALL(cudaMemcpyAsync(
+        frontier_dev, frontier, n * sizeof(dgl_id_t), cudaMemcpyHostToDevice, stream));
+    const int block_size = 256;
+    const int blocks     = (n * kSampleWarpSize + block_size - 1) / block_size;
+    if (probability == nullptr) {
+      SampleNeighborsKernel<false><<<blocks, block_size, 0, stream>>>(indptr,
+                                                                      col_list,
+                                                                      val_list,
+                                                                      probability,
+                                                                      random_seed,
+                                                                      num_neighbor,
+                                                                      frontier_dev,
+                                                                      n,
+                                                                      cols_dev,
+                                                                      edges_dev,
+                                                                      counts_dev);
+    } else {
+      SampleNeighborsKernel<true><<<blocks, block_size, 0, stream>>>(indptr,
+                                                                     col_list,
+                                                                     val_list,
+                                                                     probability,
+                                                                     random_seed,
+                                                                     num_neighbor,
+                                                                     frontier_dev,
+                                                                     n,
+                                                                     cols_dev,
+                                                                     edges_dev,
+                                                                     counts_dev);
+    }
+    MSHADOW_CUDA_POST_KERNEL_CHECK(SampleNeighborsKernel);
+    CUDA_CALL(cudaMemcpyAsync(
+        cols, cols_dev, n * num_neighbor * sizeof(dgl_id_t), cudaMemcpyDeviceToHost, stream));
+    CUDA_CALL(cudaMemcpyAsync(
+        edges, edges_dev, n * num_neighbor * sizeof(dgl_id_t), cudaMemcpyDeviceToHost, stream));
+    CUDA_CALL(cudaMemcpyAsync(
+        counts, counts_dev, n * sizeof(dgl_id_t), cudaMemcpyDeviceToHost, stream));
+    CUDA_CALL(cudaStreamSynchronize(stream));
+  };
+  SampledSubgraph sub;
+  SampleSubgraph(seeds.data(),
+                 seeds.size(),
+                 sampler,
+                 params.num_hops,
+                 num_neighbor,
+                 max_num_vertices,
+                 &sub);
+
+  // Copy the vertices and layers to the outputs, the last element of sampled_ids stores the
+  // actual number of vertices in the subgraph.
+  const dgl_id_t num_vertices = sub.vertices.size();
+  dgl_id_t* out               = sampled_ids.data().dptr<dgl_id_t>();
+  CUDA_CALL(cudaMemcpyAsync(out,
+                            sub.vertices.data(),
+                            num_vertices * sizeof(dgl_id_t),
+                            cudaMemcpyHostToDevice,
+                            stream));
+  CUDA_CALL(cudaMemcpyAsync(out + max_num_vertices,
+                            &num_vertices,
+                            sizeof(dgl_id_t),
+                            cudaMemcpyHostToDevice,
+                            stream));
+  CUDA_CALL(cudaMemcpyAsync(sub_layer.data().dptr<dgl_id_t>(),
+                            sub.layers.data(),
+                            num_vertices * sizeof(dgl_id_t),
+                            cudaMemcpyHostToDevice,
+                            stream));
+  if (sub_prob != nullptr) {
+    mxnet_op::Kernel<neighbor_prob_gather, gpu>::Launch(
+        s, num_vertices, sub_prob, probability, out);
+  }
+  mxnet::TShape shape_1(1, -1);
+  mxnet::TShape shape_2(1, -1);
+  shape_1[0] = sub.cols.size();
+  shape_2[0] = max_num_vertices + 1;
+  sub_csr.CheckAndAllocData(shape_1);
+  sub_csr.CheckAndAllocAuxData(csr::kIdx, shape_1);
+  sub_csr.CheckAndAllocAuxData(csr::kIndPtr, shape_2);
+  CUDA_CALL(cudaMemcpyAsync(sub_csr.data().dptr<dgl_id_t>(),
+                            sub.edges.data(),
+                            sub.edges.size() * sizeof(dgl_id_t),
+                            cudaMemcpyHostToDevice,
+                            stream));
+  CUDA_CALL(cudaMemcpyAsync(sub_csr.aux_data(csr::kIdx).dptr<dgl_id_t>(),
+                            sub.cols.data(),
+                            sub.cols.size() * sizeof(dgl_id_t),
+                            cudaMemcpyHostToDevice,
+                            stream));
+  CUDA_CALL(cudaMemcpyAsync(sub_csr.aux_data(csr::kIndPtr).dptr<dgl_id_t>(),
+                            sub.indptr.data(),
+                            sub.indptr.size() * sizeof(dgl_id_t),
+                            cudaMemcpyHostToDevice,
+                            stream));
+  // the host buffers are released on return
+  CUDA_CALL(cudaStreamSynchronize(stream));
+}
+
+/*
+ * Draw the random seed of the subgraphs and get the workspace of SampleSubgraphGPU
+ */
+static dgl_id_t* SampleSubgraphWorkspaceGPU(const OpContext& ctx,
+                                            const NeighborSampleParam& params,
+                                            unsigned int* seed) {
+  using namespace mshadow;
+  Stream<gpu>* s = ctx.get_stream<gpu>();
+  const size_t workspace_size =
+      params.max_num_vertices * (2 + 2 * params.num_neighbor) + 1;
+  Tensor<gpu, 1, dgl_id_t> workspace =
+      ctx.requested[1].get_space_typed<gpu, 1, dgl_id_t>(Shape1(workspace_size), s);
+  Tensor<gpu, 1, unsigned int> seed_dev(
+      reinterpret_cast<unsigned int*>(workspace.dptr_ + workspace_size - 1), Shape1(1), s);
+  ctx.requested[0].get_random<gpu, unsigned int>(s)->GetRandInt(seed_dev);
+  CUDA_CALL(cudaMemcpyAsync(seed,
+                            seed_dev.dptr_,
+                            sizeof(unsigned int),
+                            cudaMemcpyDeviceToHost,
+                            Stream<gpu>::GetStream(s)));
+  CUDA_CALL(cudaStreamSynchronize(Stream<gpu>::GetStream(s)));
+  return workspace.dptr_;
+}
+
+/*
+ * Operator: contrib_csr_neighbor_uniform_sample
+ */
+static void CSRNeighborUniformSampleComputeExGPU(const nnvm::NodeAttrs& attrs,
+                                                 const OpContext& ctx,
+                                                 const std::vector<NDArray>& inputs,
+                                                 const std::vector<OpReqType>& req,
+                                                 const std::vector<NDArray>& outputs) {
+  const NeighborSampleParam& params = nnvm::get<NeighborSampleParam>(attrs.parsed);
+
+  int num_subgraphs = inputs.size() - 1;
+  CHECK_EQ(outputs.size(), 3 * num_subgraphs);
+
+  unsigned int seed;
+  dgl_id_t* workspace = SampleSubgraphWorkspaceGPU(ctx, params, &seed);
+  for (int i = 0; i < num_subgraphs; i++) {
+    SampleSubgraphGPU(ctx,
+                      inputs[0],                       // graph_csr
+                      inputs[i + 1],                   // seed vector
+                      outputs[i],                      // sample_id
+                      outputs[i + 1 * num_subgraphs],  // sub_csr
+                      nullptr,                         // sample_id_probability
+                      outputs[i + 2 * num_subgraphs],  // sample_id_layer
+                      nullptr,                         // probability
+                      params,
+                      seed + i,
+                      workspace);
+  }
+}
+
+/*
+ * Operator: contrib_csr_neighbor_non_uniform_sample
+ */
+static void CSRNeighborNonUniformSampleComputeExGPU(const nnvm::NodeAttrs& attrs,
+                                                    const OpContext& ctx,
+                                                    const std::vector<NDArray>& inputs,
+                                                    const std::vector<OpReqType>& req,
+                                                    const std::vector<NDArray>& outputs) {
+  const NeighborSampleParam& params = nnvm::get<NeighborSampleParam>(attrs.parsed);
+
+  int num_subgraphs = inputs.size() - 2;
+  CHECK_EQ(outputs.size(), 4 * num_subgraphs);
+
+  const float* probability = inputs[1].data().dptr<float>();
+
+  unsigned int seed;
+  dgl_id_t* workspace = SampleSubgraphWorkspaceGPU(ctx, params, &seed);
+  for (int i = 0; i < num_subgraphs; i++) {
+    float* sub_prob = outputs[i + 2 * num_subgraphs].data().dptr<float>();
+    SampleSubgraphGPU(ctx,
+                      inputs[0],                       // graph_csr
+                      inputs[i + 2],                   // seed vector
+                      outputs[i],                      // sample_id
+                      outputs[i + 1 * num_subgraphs],  // sub_csr
+                      sub_prob,                        // sample_id_probability
+                      outputs[i + 3 * num_subgraphs],  // sample_id_layer
+                      probability,
+                      params,
+                      seed + i,
+                      workspace);
+  }
+}
+
+NNVM_REGISTER_OP(_contrib_dgl_csr_neighbor_uniform_sample)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", CSRNeighborUniformSampleComputeExGPU);
+
+NNVM_REGISTER_OP(_contrib_dgl_csr_neighbor_non_uniform_sample)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", CSRNeighborNonUniformSampleComputeExGPU);
+
 }  // namespace op
 }  // namespace mxnet
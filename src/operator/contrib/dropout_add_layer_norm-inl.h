@@ -0,0 +1,122 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file dropout_add_layer_norm-inl.h
+ * \brief Fused dropout, residual add and layer normalization of a transformer block
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_DROPOUT_ADD_LAYER_NORM_INL_H_
+#define MXNET_OPERATOR_CONTRIB_DROPOUT_ADD_LAYER_NORM_INL_H_
+
+#include <mxnet/operator_util.h>
+#include <mxnet/random_generator.h>
+#include <cstdint>
+#include <vector>
+#include "../mxnet_op.h"
+#include "../mshadow_op.h"
+#include "../operator_common.h"
+
+namespace mxnet {
+namespace op {
+
+namespace dropout_add_ln {
+enum DropoutAddLayerNormOpInputs { kData, kResidual, kGamma, kBeta };
+enum DropoutAddLayerNormOpOutputs { kOut, kMean, kStd, kSeed };
+enum DropoutAddLayerNormOpInputsBwd {
+  kBwdOutGrad,
+  kBwdData,
+  kBwdResidual,
+  kBwdGamma,
+  kBwdMean,
+  kBwdStd,
+  kBwdSeed
+};
+enum DropoutAddLayerNormOpOutputsBwd {
+  kBwdDataGrad,
+  kBwdResidualGrad,
+  kBwdGammaGrad,
+  kBwdBetaGrad
+};
+enum DropoutAddLayerNormOpMode { kTraining, kAlways };
+// the seed output holds the key of the random stream and whether the dropout was applied
+const int kSeedSize = 2;
+}  // namespace dropout_add_ln
+
+struct DropoutAddLayerNormParam : public dmlc::Parameter<DropoutAddLayerNormParam> {
+  float p;
+  int mode;
+  float eps;
+  DMLC_DECLARE_PARAMETER(DropoutAddLayerNormParam) {
+    DMLC_DECLARE_FIELD(p).set_default(0.5).set_range(0, 1).describe(
+        "Fraction of the input that gets dropped out during training time.");
+    DMLC_DECLARE_FIELD(mode)
+        .add_enum("training", dropout_add_ln::kTraining)
+        .add_enum("always", dropout_add_ln::kAlways)
+        .set_default(dropout_add_ln::kTraining)
+        .describe(
+            "Whether to only turn on dropout during training or to also turn on for inference.");
+    DMLC_DECLARE_FIELD(eps).set_default(1e-5f).describe(
+        "An `epsilon` parameter to prevent division by 0.");
+  }
+};
+
+/*!
+ * \brief Whether the forward drops elements, the same test as the Dropout operator.
+ */
+inline bool DropoutAddLayerNormApplies(const DropoutAddLayerNormParam& param, bool is_train) {
+  return param.p > 0 && (is_train || param.mode == dropout_add_ln::kAlways);
+}
+
+/*!
+ * \brief Elements are kept when their 32 random bits are below this threshold.
+ */
+inline uint32_t DropoutAddLayerNormThreshold(float p) {
+  const double threshold = (1.0 - p) * 4294967296.0;
+  return threshold >= 4294967295.0 ? 4294967295u : static_cast<uint32_t>(threshold);
+}
+
+/*!
+ * \brief Random bits of the 4 columns [4 * group, 4 * group + 4) of a row. The mask is never
+ *        stored: the bits come from a counter-based generator indexed by (row, group), so the
+ *        backward regenerates exactly the forward mask, on any device.
+ */
+MSHADOW_XINLINE void DropoutAddLayerNormBits(const uint32_t seed,
+                                             const index_t row,
+                                             const index_t group,
+                                             uint32_t bits[4]) {
+  const uint32_t counter[4] = {static_cast<uint32_t>(group),
+                               static_cast<uint32_t>(row),
+                               static_cast<uint32_t>(static_cast<uint64_t>(row) >> 32),
+                               static_cast<uint32_t>(static_cast<uint64_t>(group) >> 32)};
+  const uint32_t key[2]     = {seed, 0xCA01F9DDu};
+  common::random::Philox4x32_10(counter, key, bits);
+}
+
+/*!
+ * \brief Marks in the seed output whether the forward applied the dropout.
+ */
+struct dropout_add_ln_set_applied {
+  MSHADOW_XINLINE static void Map(index_t i, int32_t* seed, const int32_t applied) {
+    seed[1] = applied;
+  }
+};
+
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_OPERATOR_CONTRIB_DROPOUT_ADD_LAYER_NORM_INL_H_
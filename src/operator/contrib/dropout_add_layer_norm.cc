@@ -0,0 +1,341 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file dropout_add_layer_norm.cc
+ * \brief CPU implementation of the fused dropout, residual add and layer normalization
+ */
+#include <algorithm>
+#include <cmath>
+#include "./dropout_add_layer_norm-inl.h"
+#include "../elemwise_op_common.h"
+#include "../../engine/openmp.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(DropoutAddLayerNormParam);
+
+static bool DropoutAddLayerNormShape(const nnvm::NodeAttrs& attrs,
+                                     mxnet::ShapeVector* in_shape,
+                                     mxnet::ShapeVector* out_shape) {
+  using namespace dropout_add_ln;
+  CHECK_EQ(in_shape->size(), 4U) << "Input:[data, residual, gamma, beta]";
+  SHAPE_ASSIGN_CHECK(*in_shape, kData, in_shape->at(kResidual));
+  SHAPE_ASSIGN_CHECK(*in_shape, kResidual, in_shape->at(kData));
+  const mxnet::TShape& dshape = in_shape->at(kData);
+  if (!mxnet::ndim_is_known(dshape))
+    return false;
+  CHECK_GE(dshape.ndim(), 1) << "The data of dropout_add_layer_norm must not be a scalar";
+  const int axis = dshape.ndim() - 1;
+  SHAPE_ASSIGN_CHECK(*in_shape, kGamma, mxnet::TShape(1, dshape[axis]));
+  SHAPE_ASSIGN_CHECK(*in_shape, kBeta, mxnet::TShape(1, dshape[axis]));
+  mxnet::TShape moments_shape(dshape);
+  moments_shape[axis] = 1;
+  out_shape->clear();
+  out_shape->push_back(dshape);
+  out_shape->push_back(moments_shape);
+  out_shape->push_back(moments_shape);
+  out_shape->push_back(mxnet::TShape(1, dropout_add_ln::kSeedSize));
+  return true;
+}
+
+static bool DropoutAddLayerNormType(const nnvm::NodeAttrs& attrs,
+                                    std::vector<int>* in_attrs,
+                                    std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 4U);
+  CHECK_EQ(out_attrs->size(), 4U);
+  TYPE_ASSIGN_CHECK(*out_attrs, dropout_add_ln::kSeed, mshadow::kInt32);
+  std::vector<int> dtype_out(out_attrs->begin(), out_attrs->begin() + dropout_add_ln::kSeed);
+  if (!ElemwiseType<4, 3>(attrs, in_attrs, &dtype_out))
+    return false;
+  for (int i = 0; i < dropout_add_ln::kSeed; ++i) {
+    TYPE_ASSIGN_CHECK(*out_attrs, i, dtype_out[i]);
+  }
+  return true;
+}
+
+/*!
+ * \brief Writes residual + dropout(data) of one row into h.
+ */
+template <typename DType, typename AType>
+inline void DropoutAddRowCPU(const DType* data,
+                             const DType* residual,
+                             const index_t row,
+                             const index_t M,
+                             const bool applied,
+                             const uint32_t seed,
+                             const uint32_t threshold,
+                             const AType scale,
+                             AType* h) {
+  if (!applied) {
+    for (index_t j = 0; j < M; ++j) {
+      h[j] = static_cast<AType>(residual[j]) + static_cast<AType>(data[j]);
+    }
+    return;
+  }
+  uint32_t bits[4];
+  for (index_t group = 0; group * 4 < M; ++group) {
+    DropoutAddLayerNormBits(seed, row, group, bits);
+    const index_t begin = group * 4;
+    const index_t end   = std::min(begin + 4, M);
+    for (index_t j = begin; j < end; ++j) {
+      const AType kept = bits[j - begin] < threshold ? static_cast<AType>(data[j]) * scale : 0;
+      h[j]             = static_cast<AType>(residual[j]) + kept;
+    }
+  }
+}
+
+void DropoutAddLayerNormCPU(const nnvm::NodeAttrs& attrs,
+                            const OpContext& ctx,
+                            const std::vector<TBlob>& inputs,
+                            const std::vector<OpReqType>& req,
+                            const std::vector<TBlob>& outputs) {
+  using namespace dropout_add_ln;
+  using namespace mshadow;
+  const DropoutAddLayerNormParam& param = nnvm::get<DropoutAddLayerNormParam>(attrs.parsed);
+  Stream<cpu>* s                        = ctx.get_stream<cpu>();
+  const TBlob& data                     = inputs[kData];
+  const index_t M                       = data.shape_[data.ndim() - 1];
+  const index_t N                       = M > 0 ? data.shape_.Size() / M : 0;
+  const bool applied                    = DropoutAddLayerNormApplies(param, ctx.is_train);
+  int32_t* seed                         = outputs[kSeed].dptr<int32_t>();
+  Random<cpu, unsigned>* prnd           = ctx.requested[1].get_random<cpu, unsigned>(s);
+  seed[0]                               = applied ? static_cast<int32_t>(prnd->GetRandInt()) : 0;
+  seed[1]                               = applied;
+  if (req[kOut] == kNullOp || N == 0)
+    return;
+  const uint32_t threshold = DropoutAddLayerNormThreshold(param.p);
+  const int omp_threads    = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  MSHADOW_REAL_TYPE_SWITCH_EX(data.type_flag_, DType, AType, {
+    const AType scale       = param.p < 1 ? AType(1) / (AType(1) - param.p) : AType(0);
+    const DType* data_ptr   = data.dptr<DType>();
+    const DType* res_ptr    = inputs[kResidual].dptr<DType>();
+    const DType* gamma      = inputs[kGamma].dptr<DType>();
+    const DType* beta       = inputs[kBeta].dptr<DType>();
+    DType* out              = outputs[kOut].dptr<DType>();
+    DType* mean_ptr         = outputs[kMean].dptr<DType>();
+    DType* std_ptr          = outputs[kStd].dptr<DType>();
+    const OpReqType out_req = req[kOut];
+    Tensor<cpu, 1, AType> workspace =
+        ctx.requested[0].get_space_typed<cpu, 1, AType>(Shape1(omp_threads * M), s);
+#pragma omp parallel num_threads(omp_threads)
+    {
+      AType* h = workspace.dptr_ + omp_get_thread_num() * M;
+#pragma omp for
+      for (index_t i = 0; i < N; ++i) {
+        DropoutAddRowCPU(data_ptr + i * M,
+                         res_ptr + i * M,
+                         i,
+                         M,
+                         applied,
+                         static_cast<uint32_t>(seed[0]),
+                         threshold,
+                         scale,
+                         h);
+        AType sum = 0;
+        for (index_t j = 0; j < M; ++j) {
+          sum += h[j];
+        }
+        const AType mean = sum / M;
+        AType sq_sum     = 0;
+        for (index_t j = 0; j < M; ++j) {
+          sq_sum += (h[j] - mean) * (h[j] - mean);
+        }
+        const AType std_dev = std::sqrt(sq_sum / M + param.eps);
+        DType* out_row      = out + i * M;
+        for (index_t j = 0; j < M; ++j) {
+          const AType val = (h[j] - mean) / std_dev * static_cast<AType>(gamma[j]) +
+                            static_cast<AType>(beta[j]);
+          KERNEL_ASSIGN(out_row[j], out_req, static_cast<DType>(val));
+        }
+        mean_ptr[i] = static_cast<DType>(mean);
+        std_ptr[i]  = static_cast<DType>(std_dev);
+      }
+    }
+  });
+}
+
+void BackwardDropoutAddLayerNormCPU(const nnvm::NodeAttrs& attrs,
+                                    const OpContext& ctx,
+                                    const std::vector<TBlob>& inputs,
+                                    const std::vector<OpReqType>& req,
+                                    const std::vector<TBlob>& outputs) {
+  using namespace dropout_add_ln;
+  using namespace mshadow;
+  const DropoutAddLayerNormParam& param = nnvm::get<DropoutAddLayerNormParam>(attrs.parsed);
+  Stream<cpu>* s                        = ctx.get_stream<cpu>();
+  const TBlob& data                     = inputs[kBwdData];
+  const index_t M                       = data.shape_[data.ndim() - 1];
+  const index_t N                       = M > 0 ? data.shape_.Size() / M : 0;
+  const int32_t* seed                   = inputs[kBwdSeed].dptr<int32_t>();
+  const bool applied                    = seed[1] != 0;
+  const uint32_t threshold              = DropoutAddLayerNormThreshold(param.p);
+  const int omp_threads                 = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  MSHADOW_REAL_TYPE_SWITCH_EX(data.type_flag_, DType, AType, {
+    const AType scale         = param.p < 1 ? AType(1) / (AType(1) - param.p) : AType(0);
+    const DType* ograd        = inputs[kBwdOutGrad].dptr<DType>();
+    const DType* data_ptr     = data.dptr<DType>();
+    const DType* res_ptr      = inputs[kBwdResidual].dptr<DType>();
+    const DType* gamma        = inputs[kBwdGamma].dptr<DType>();
+    const DType* mean_ptr     = inputs[kBwdMean].dptr<DType>();
+    const DType* std_ptr      = inputs[kBwdStd].dptr<DType>();
+    DType* data_grad          = outputs[kBwdDataGrad].dptr<DType>();
+    DType* res_grad           = outputs[kBwdResidualGrad].dptr<DType>();
+    DType* gamma_grad         = outputs[kBwdGammaGrad].dptr<DType>();
+    DType* beta_grad          = outputs[kBwdBetaGrad].dptr<DType>();
+    const OpReqType req_data  = req[kBwdDataGrad];
+    const OpReqType req_res   = req[kBwdResidualGrad];
+    const OpReqType req_gamma = req[kBwdGammaGrad];
+    const OpReqType req_beta  = req[kBwdBetaGrad];
+    // per thread: h, then the partial sums of the gamma and beta gradients
+    Tensor<cpu, 1, AType> workspace =
+        ctx.requested[0].get_space_typed<cpu, 1, AType>(Shape1(omp_threads * M * 3), s);
+    std::fill_n(workspace.dptr_, omp_threads * M * 3, AType(0));
+#pragma omp parallel num_threads(omp_threads)
+    {
+      AType* h          = workspace.dptr_ + omp_get_thread_num() * M * 3;
+      AType* gamma_part = h + M;
+      AType* beta_part  = gamma_part + M;
+#pragma omp for
+      for (index_t i = 0; i < N; ++i) {
+        DropoutAddRowCPU(data_ptr + i * M,
+                         res_ptr + i * M,
+                         i,
+                         M,
+                         applied,
+                         static_cast<uint32_t>(seed[0]),
+                         threshold,
+                         scale,
+                         h);
+        const AType mean     = static_cast<AType>(mean_ptr[i]);
+        const AType std_dev  = static_cast<AType>(std_ptr[i]);
+        const DType* dy      = ograd + i * M;
+        AType sum_dxhat      = 0;
+        AType sum_dxhat_xhat = 0;
+        for (index_t j = 0; j < M; ++j) {
+          h[j]              = (h[j] - mean) / std_dev;  // xhat
+          const AType dy_j  = static_cast<AType>(dy[j]);
+          const AType dxhat = dy_j * static_cast<AType>(gamma[j]);
+          sum_dxhat += dxhat;
+          sum_dxhat_xhat += dxhat * h[j];
+          gamma_part[j] += dy_j * h[j];
+          beta_part[j] += dy_j;
+        }
+        sum_dxhat /= M;
+        sum_dxhat_xhat /= M;
+        uint32_t bits[4];
+        for (index_t group = 0; group * 4 < M; ++group) {
+          if (applied) {
+            DropoutAddLayerNormBits(static_cast<uint32_t>(seed[0]), i, group, bits);
+          }
+          const index_t begin = group * 4;
+          const index_t end   = std::min(begin + 4, M);
+          for (index_t j = begin; j < end; ++j) {
+            const AType dxhat = static_cast<AType>(dy[j]) * static_cast<AType>(gamma[j]);
+            const AType dh    = (dxhat - sum_dxhat - h[j] * sum_dxhat_xhat) / std_dev;
+            const AType ddata = !applied ? dh : bits[j - begin] < threshold ? dh * scale : 0;
+            KERNEL_ASSIGN(res_grad[i * M + j], req_res, static_cast<DType>(dh));
+            KERNEL_ASSIGN(data_grad[i * M + j], req_data, static_cast<DType>(ddata));
+          }
+        }
+      }
+    }
+    for (index_t j = 0; j < M; ++j) {
+      AType gamma_sum = 0;
+      AType beta_sum  = 0;
+      for (int t = 0; t < omp_threads; ++t) {
+        gamma_sum += workspace.dptr_[t * M * 3 + M + j];
+        beta_sum += workspace.dptr_[t * M * 3 + 2 * M + j];
+      }
+      KERNEL_ASSIGN(gamma_grad[j], req_gamma, static_cast<DType>(gamma_sum));
+      KERNEL_ASSIGN(beta_grad[j], req_beta, static_cast<DType>(beta_sum));
+    }
+  });
+}
+
+NNVM_REGISTER_OP(_contrib_dropout_add_layer_norm)
+    .add_alias("_npx_dropout_add_layer_norm")
+    .describe(R"code(Computes LayerNorm(residual + Dropout(data)) over the last axis in one pass.
+
+This is the residual block of a transformer. The dropout mask is drawn from a counter-based
+random generator keyed by a seed, so it is neither written by the forward nor read by the
+backward, which regenerates it from the seed. The sum ``residual + Dropout(data)`` is not stored
+either, the backward recomputes it.
+
+``gamma`` and ``beta`` have the size of the last axis of ``data``. ``data`` and ``residual``
+have the same shape. With ``mode='training'`` the dropout only applies when training, like in
+the Dropout operator.
+
+)code" ADD_FILELINE)
+    .set_num_inputs(4)
+    .set_num_outputs(4)
+    .set_attr_parser(ParamParser<DropoutAddLayerNormParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{
+                                           "data", "residual", "gamma", "beta"};
+                                     })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{
+                                            "output", "mean", "std", "seed"};
+                                      })
+    .set_attr<nnvm::FNumVisibleOutputs>("FNumVisibleOutputs",
+                                        [](const NodeAttrs& attrs) { return 1; })
+    .set_attr<mxnet::FInferShape>("FInferShape", DropoutAddLayerNormShape)
+    .set_attr<nnvm::FInferType>("FInferType", DropoutAddLayerNormType)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace,
+                                                                      ResourceRequest::kRandom};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", DropoutAddLayerNormCPU)
+    .set_attr<nnvm::FGradient>(
+        "FGradient",
+        [](const nnvm::ObjectPtr& n, const std::vector<nnvm::NodeEntry>& ograds) {
+          std::vector<nnvm::NodeEntry> heads;
+          heads.push_back(ograds[0]);     // ograd
+          heads.push_back(n->inputs[0]);  // data
+          heads.push_back(n->inputs[1]);  // residual
+          heads.push_back(n->inputs[2]);  // gamma
+          heads.emplace_back(n, 1, 0);    // mean
+          heads.emplace_back(n, 2, 0);    // std
+          heads.emplace_back(n, 3, 0);    // seed
+          return MakeGradNode("_backward_dropout_add_layer_norm", n, heads, n->attrs.dict);
+        })
+    .add_argument("data", "NDArray-or-Symbol", "Input of the dropout")
+    .add_argument("residual", "NDArray-or-Symbol", "Residual added to the dropout output")
+    .add_argument("gamma", "NDArray-or-Symbol", "gamma array")
+    .add_argument("beta", "NDArray-or-Symbol", "beta array")
+    .add_arguments(DropoutAddLayerNormParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_dropout_add_layer_norm)
+    .set_num_inputs(7)
+    .set_num_outputs(4)
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr_parser(ParamParser<DropoutAddLayerNormParam>)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", BackwardDropoutAddLayerNormCPU);
+
+}  // namespace op
+}  // namespace mxnet
@@ -0,0 +1,403 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file dropout_add_layer_norm.cu
+ * \brief GPU implementation of the fused dropout, residual add and layer normalization
+ */
+#include <algorithm>
+#include "./dropout_add_layer_norm-inl.h"
+
+namespace mxnet {
+namespace op {
+
+const int kDropoutAddLNThreads = 256;
+// rows summed by one block of the gamma and beta gradient kernel
+const int kDropoutAddLNRowsPerChunk = 64;
+
+/*!
+ * \brief residual + dropout(data) at (row, j), regenerating the mask bits of j's group.
+ */
+template <typename DType, typename AType>
+__device__ __forceinline__ AType DropoutAddValue(const DType* data,
+                                                 const DType* residual,
+                                                 const index_t row,
+                                                 const index_t M,
+                                                 const index_t j,
+                                                 const int32_t* seed,
+                                                 const uint32_t threshold,
+                                                 const AType scale) {
+  const index_t idx = row * M + j;
+  AType kept        = static_cast<AType>(data[idx]);
+  if (seed[1]) {
+    uint32_t bits[4];
+    DropoutAddLayerNormBits(static_cast<uint32_t>(seed[0]), row, j / 4, bits);
+    kept = bits[j % 4] < threshold ? kept * scale : AType(0);
+  }
+  return static_cast<AType>(residual[idx]) + kept;
+}
+
+/*!
+ * \brief Writes residual + dropout(data) of the 4 columns of a group into h and their mask
+ *        bits into bits, returns how many of the columns are inside the row.
+ */
+template <typename DType, typename AType>
+__device__ __forceinline__ int DropoutAddGroup(const DType* data,
+                                               const DType* residual,
+                                               const index_t row,
+                                               const index_t M,
+                                               const index_t group,
+                                               const int32_t* seed,
+                                               const uint32_t threshold,
+                                               const AType scale,
+                                               AType h[4],
+                                               uint32_t bits[4]) {
+  const index_t begin = group * 4;
+  const int count     = static_cast<int>(min(static_cast<index_t>(4), M - begin));
+  if (seed[1]) {
+    DropoutAddLayerNormBits(static_cast<uint32_t>(seed[0]), row, group, bits);
+  }
+#pragma unroll
+  for (int t = 0; t < 4; ++t) {
+    if (t < count) {
+      const index_t idx = row * M + begin + t;
+      AType kept        = static_cast<AType>(data[idx]);
+      if (seed[1]) {
+        kept = bits[t] < threshold ? kept * scale : AType(0);
+      }
+      h[t] = static_cast<AType>(residual[idx]) + kept;
+    }
+  }
+  return count;
+}
+
+/*!
+ * \brief One block per row: Welford moments of residual + dropout(data) in the first read,
+ *        the normalized output in the second one.
+ */
+template <typename DType, typename AType>
+__global__ void DropoutAddLayerNormKernel(const DType* data,
+                                          const DType* residual,
+                                          const DType* gamma,
+                                          const DType* beta,
+                                          DType* out,
+                                          DType* mean_out,
+                                          DType* std_out,
+                                          const int32_t* seed,
+                                          const index_t M,
+                                          const uint32_t threshold,
+                                          const AType scale,
+                                          const AType eps,
+                                          const OpReqType req) {
+  __shared__ AType s_count[kDropoutAddLNThreads];
+  __shared__ AType s_mean[kDropoutAddLNThreads];
+  __shared__ AType s_m2[kDropoutAddLNThreads];
+  const index_t row    = blockIdx.x;
+  const index_t groups = (M + 3) / 4;
+  AType count          = 0;
+  AType mean           = 0;
+  AType m2             = 0;
+  AType h[4];
+  uint32_t bits[4];
+  for (index_t group = threadIdx.x; group < groups; group += blockDim.x) {
+    const int n = DropoutAddGroup(data, residual, row, M, group, seed, threshold, scale, h, bits);
+    for (int t = 0; t < n; ++t) {
+      count += 1;
+      const AType delta = h[t] - mean;
+      mean += delta / count;
+      m2 += delta * (h[t] - mean);
+    }
+  }
+  s_count[threadIdx.x] = count;
+  s_mean[threadIdx.x]  = mean;
+  s_m2[threadIdx.x]    = m2;
+  __syncthreads();
+  for (int size = blockDim.x / 2; size > 0; size /= 2) {
+    if (threadIdx.x < size) {
+      const AType count_a = s_count[threadIdx.x];
+      const AType count_b = s_count[threadIdx.x + size];
+      const AType total   = count_a + count_b;
+      if (count_b > 0) {
+        const AType delta = s_mean[threadIdx.x + size] - s_mean[threadIdx.x];
+        s_mean[threadIdx.x] += delta * count_b / total;
+        s_m2[threadIdx.x] += s_m2[threadIdx.x + size] + delta * delta * count_a * count_b / total;
+        s_count[threadIdx.x] = total;
+      }
+    }
+    __syncthreads();
+  }
+  const AType row_mean = s_mean[0];
+  const AType row_std  = sqrt(s_m2[0] / M + eps);
+  if (threadIdx.x == 0) {
+    mean_out[row] = static_cast<DType>(row_mean);
+    std_out[row]  = static_cast<DType>(row_std);
+  }
+  for (index_t group = threadIdx.x; group < groups; group += blockDim.x) {
+    const int n = DropoutAddGroup(data, residual, row, M, group, seed, threshold, scale, h, bits);
+    for (int t = 0; t < n; ++t) {
+      const index_t j = group * 4 + t;
+      const AType val = (h[t] - row_mean) / row_std * static_cast<AType>(gamma[j]) +
+                        static_cast<AType>(beta[j]);
+      KERNEL_ASSIGN(out[row * M + j], req, static_cast<DType>(val));
+    }
+  }
+}
+
+/*!
+ * \brief One block per row: the data and residual gradients, recomputing the normalized input.
+ */
+template <typename DType, typename AType>
+__global__ void BackwardDropoutAddLayerNormKernel(const DType* ograd,
+                                                  const DType* data,
+                                                  const DType* residual,
+                                                  const DType* gamma,
+                                                  const DType* mean,
+                                                  const DType* std_dev,
+                                                  const int32_t* seed,
+                                                  DType* data_grad,
+                                                  DType* res_grad,
+                                                  const index_t M,
+                                                  const uint32_t threshold,
+                                                  const AType scale,
+                                                  const OpReqType req_data,
+                                                  const OpReqType req_res) {
+  __shared__ AType s_dxhat[kDropoutAddLNThreads];
+  __shared__ AType s_dxhat_xhat[kDropoutAddLNThreads];
+  const index_t row    = blockIdx.x;
+  const index_t groups = (M + 3) / 4;
+  const AType row_mean = static_cast<AType>(mean[row]);
+  const AType row_std  = static_cast<AType>(std_dev[row]);
+  AType sum_dxhat      = 0;
+  AType sum_dxhat_xhat = 0;
+  AType h[4];
+  uint32_t bits[4];
+  for (index_t group = threadIdx.x; group < groups; group += blockDim.x) {
+    const int n = DropoutAddGroup(data, residual, row, M, group, seed, threshold, scale, h, bits);
+    for (int t = 0; t < n; ++t) {
+      const index_t j   = group * 4 + t;
+      const AType dxhat = static_cast<AType>(ograd[row * M + j]) * static_cast<AType>(gamma[j]);
+      sum_dxhat += dxhat;
+      sum_dxhat_xhat += dxhat * (h[t] - row_mean) / row_std;
+    }
+  }
+  s_dxhat[threadIdx.x]      = sum_dxhat;
+  s_dxhat_xhat[threadIdx.x] = sum_dxhat_xhat;
+  __syncthreads();
+  for (int size = blockDim.x / 2; size > 0; size /= 2) {
+    if (threadIdx.x < size) {
+      s_dxhat[threadIdx.x] += s_dxhat[threadIdx.x + size];
+      s_dxhat_xhat[threadIdx.x] += s_dxhat_xhat[threadIdx.x + size];
+    }
+    __syncthreads();
+  }
+  const AType mean_dxhat      = s_dxhat[0] / M;
+  const AType mean_dxhat_xhat = s_dxhat_xhat[0] / M;
+  for (index_t group = threadIdx.x; group < groups; group += blockDim.x) {
+    const int n = DropoutAddGroup(data, residual, row, M, group, seed, threshold, scale, h, bits);
+    for (int t = 0; t < n; ++t) {
+      const index_t j   = group * 4 + t;
+      const AType xhat  = (h[t] - row_mean) / row_std;
+      const AType dxhat = static_cast<AType>(ograd[row * M + j]) * static_cast<AType>(gamma[j]);
+      const AType dh    = (dxhat - mean_dxhat - xhat * mean_dxhat_xhat) / row_std;
+      const AType ddata = !seed[1] ? dh : bits[t] < threshold ? dh * scale : AType(0);
+      KERNEL_ASSIGN(res_grad[row * M + j], req_res, static_cast<DType>(dh));
+      KERNEL_ASSIGN(data_grad[row * M + j], req_data, static_cast<DType>(ddata));
+    }
+  }
+}
+
+/*!
+ * \brief Partial sums of the gamma and beta gradients over a chunk of rows, one column per
+ *        thread so that the reads of a row are coalesced.
+ */
+template <typename DType, typename AType>
+__global__ void DropoutAddLayerNormParamGradKernel(const DType* ograd,
+                                                   const DType* data,
+                                                   const DType* residual,
+                                                   const DType* mean,
+                                                   const DType* std_dev,
+                                                   const int32_t* seed,
+                                                   AType* gamma_part,
+                                                   AType* beta_part,
+                                                   const index_t N,
+                                                   const index_t M,
+                                                   const uint32_t threshold,
+                                                   const AType scale) {
+  const index_t j = blockIdx.x * blockDim.x + threadIdx.x;
+  if (j >= M)
+    return;
+  const index_t row_begin = blockIdx.y * kDropoutAddLNRowsPerChunk;
+  const index_t row_end   = min(row_begin + kDropoutAddLNRowsPerChunk, N);
+  AType gamma_sum         = 0;
+  AType beta_sum          = 0;
+  for (index_t row = row_begin; row < row_end; ++row) {
+    const AType h    = DropoutAddValue(data, residual, row, M, j, seed, threshold, scale);
+    const AType xhat = (h - static_cast<AType>(mean[row])) / static_cast<AType>(std_dev[row]);
+    const AType dy   = static_cast<AType>(ograd[row * M + j]);
+    gamma_sum += dy * xhat;
+    beta_sum += dy;
+  }
+  gamma_part[blockIdx.y * M + j] = gamma_sum;
+  beta_part[blockIdx.y * M + j]  = beta_sum;
+}
+
+template <typename DType, typename AType>
+__global__ void DropoutAddLayerNormParamGradSumKernel(const AType* gamma_part,
+                                                      const AType* beta_part,
+                                                      DType* gamma_grad,
+                                                      DType* beta_grad,
+                                                      const index_t chunks,
+                                                      const index_t M,
+                                                      const OpReqType req_gamma,
+                                                      const OpReqType req_beta) {
+  const index_t j = blockIdx.x * blockDim.x + threadIdx.x;
+  if (j >= M)
+    return;
+  AType gamma_sum = 0;
+  AType beta_sum  = 0;
+  for (index_t c = 0; c < chunks; ++c) {
+    gamma_sum += gamma_part[c * M + j];
+    beta_sum += beta_part[c * M + j];
+  }
+  KERNEL_ASSIGN(gamma_grad[j], req_gamma, static_cast<DType>(gamma_sum));
+  KERNEL_ASSIGN(beta_grad[j], req_beta, static_cast<DType>(beta_sum));
+}
+
+void DropoutAddLayerNormGPU(const nnvm::NodeAttrs& attrs,
+                            const OpContext& ctx,
+                            const std::vector<TBlob>& inputs,
+                            const std::vector<OpReqType>& req,
+                            const std::vector<TBlob>& outputs) {
+  using namespace dropout_add_ln;
+  using namespace mshadow;
+  const DropoutAddLayerNormParam& param = nnvm::get<DropoutAddLayerNormParam>(attrs.parsed);
+  Stream<gpu>* s                        = ctx.get_stream<gpu>();
+  const TBlob& data                     = inputs[kData];
+  const index_t M                       = data.shape_[data.ndim() - 1];
+  const index_t N                       = M > 0 ? data.shape_.Size() / M : 0;
+  const bool applied                    = DropoutAddLayerNormApplies(param, ctx.is_train);
+  // the seed stays on the device, the kernels read it from there
+  Tensor<gpu, 1, unsigned> seed(
+      reinterpret_cast<unsigned*>(outputs[kSeed].dptr<int32_t>()), Shape1(kSeedSize), s);
+  ctx.requested[1].get_random<gpu, unsigned>(s)->GetRandInt(seed);
+  mxnet_op::Kernel<dropout_add_ln_set_applied, gpu>::Launch(
+      s, 1, outputs[kSeed].dptr<int32_t>(), static_cast<int32_t>(applied));
+  if (req[kOut] == kNullOp || N == 0)
+    return;
+  const uint32_t threshold = DropoutAddLayerNormThreshold(param.p);
+  MSHADOW_REAL_TYPE_SWITCH_EX(data.type_flag_, DType, AType, {
+    const AType scale = param.p < 1 ? AType(1) / (AType(1) - param.p) : AType(0);
+    DropoutAddLayerNormKernel<DType, AType>
+        <<<N, kDropoutAddLNThreads, 0, Stream<gpu>::GetStream(s)>>>(
+            data.dptr<DType>(),
+            inputs[kResidual].dptr<DType>(),
+            inputs[kGamma].dptr<DType>(),
+            inputs[kBeta].dptr<DType>(),
+            outputs[kOut].dptr<DType>(),
+            outputs[kMean].dptr<DType>(),
+            outputs[kStd].dptr<DType>(),
+            outputs[kSeed].dptr<int32_t>(),
+            M,
+            threshold,
+            scale,
+            static_cast<AType>(param.eps),
+            req[kOut]);
+    MSHADOW_CUDA_POST_KERNEL_CHECK(DropoutAddLayerNormKernel);
+  });
+}
+
+void BackwardDropoutAddLayerNormGPU(const nnvm::NodeAttrs& attrs,
+                                    const OpContext& ctx,
+                                    const std::vector<TBlob>& inputs,
+                                    const std::vector<OpReqType>& req,
+                                    const std::vector<TBlob>& outputs) {
+  using namespace dropout_add_ln;
+  using namespace mshadow;
+  const DropoutAddLayerNormParam& param = nnvm::get<DropoutAddLayerNormParam>(attrs.parsed);
+  Stream<gpu>* s                        = ctx.get_stream<gpu>();
+  cudaStream_t stream                   = Stream<gpu>::GetStream(s);
+  const TBlob& data                     = inputs[kBwdData];
+  const index_t M                       = data.shape_[data.ndim() - 1];
+  const index_t N                       = M > 0 ? data.shape_.Size() / M : 0;
+  const uint32_t threshold              = DropoutAddLayerNormThreshold(param.p);
+  if (N == 0)
+    return;
+  MSHADOW_REAL_TYPE_SWITCH_EX(data.type_flag_, DType, AType, {
+    const AType scale    = param.p < 1 ? AType(1) / (AType(1) - param.p) : AType(0);
+    const DType* ograd   = inputs[kBwdOutGrad].dptr<DType>();
+    const DType* mean    = inputs[kBwdMean].dptr<DType>();
+    const DType* std_dev = inputs[kBwdStd].dptr<DType>();
+    const int32_t* seed  = inputs[kBwdSeed].dptr<int32_t>();
+    BackwardDropoutAddLayerNormKernel<DType, AType>
+        <<<N, kDropoutAddLNThreads, 0, stream>>>(ograd,
+                                                 data.dptr<DType>(),
+                                                 inputs[kBwdResidual].dptr<DType>(),
+                                                 inputs[kBwdGamma].dptr<DType>(),
+                                                 mean,
+                                                 std_dev,
+                                                 seed,
+                                                 outputs[kBwdDataGrad].dptr<DType>(),
+                                                 outputs[kBwdResidualGrad].dptr<DType>(),
+                                                 M,
+                                                 threshold,
+                                                 scale,
+                                                 req[kBwdDataGrad],
+                                                 req[kBwdResidualGrad]);
+    MSHADOW_CUDA_POST_KERNEL_CHECK(BackwardDropoutAddLayerNormKernel);
+    if (req[kBwdGammaGrad] != kNullOp || req[kBwdBetaGrad] != kNullOp) {
+      const index_t chunks = (N + kDropoutAddLNRowsPerChunk - 1) / kDropoutAddLNRowsPerChunk;
+      Tensor<gpu, 1, AType> workspace =
+          ctx.requested[0].get_space_typed<gpu, 1, AType>(Shape1(2 * chunks * M), s);
+      const dim3 blocks((M + kDropoutAddLNThreads - 1) / kDropoutAddLNThreads, chunks);
+      DropoutAddLayerNormParamGradKernel<DType, AType>
+          <<<blocks, kDropoutAddLNThreads, 0, stream>>>(ograd,
+                                                        data.dptr<DType>(),
+                                                        inputs[kBwdResidual].dptr<DType>(),
+                                                        mean,
+                                                        std_dev,
+                                                        seed,
+                                                        workspace.dptr_,
+                                                        workspace.dptr_ + chunks * M,
+                                                        N,
+                                                        M,
+                                                        threshold,
+                                                        scale);
+      MSHADOW_CUDA_POST_KERNEL_CHECK(DropoutAddLayerNormParamGradKernel);
+      DropoutAddLayerNormParamGradSumKernel<DType, AType>
+          <<<blocks.x, kDropoutAddLNThreads, 0, stream>>>(workspace.dptr_,
+                                                          workspace.dptr_ + chunks * M,
+                                                          outputs[kBwdGammaGrad].dptr<DType>(),
+                                                          outputs[kBwdBetaGrad].dptr<DType>(),
+                                                          chunks,
+                                                          M,
+                                                          req[kBwdGammaGrad],
+                                                          req[kBwdBetaGrad]);
+      MSHADOW_CUDA_POST_KERNEL_CHECK(DropoutAddLayerNormParamGradSumKernel);
+    }
+  });
+}
+
+NNVM_REGISTER_OP(_contrib_dropout_add_layer_norm)
+    .set_attr<FCompute>("FCompute<gpu>", DropoutAddLayerNormGPU);
+
+NNVM_REGISTER_OP(_backward_dropout_add_layer_norm)
+    .set_attr<FCompute>("FCompute<gpu>", BackwardDropoutAddLayerNormGPU);
+
+}  // namespace op
+}  // namespace mxnet
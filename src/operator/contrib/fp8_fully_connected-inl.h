@@ -0,0 +1,346 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file fp8_fully_connected-inl.h
+ * \brief Fully connected layer with FP8 (E4M3/E5M2) operands and delayed scaling
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_FP8_FULLY_CONNECTED_INL_H_
+#define MXNET_OPERATOR_CONTRIB_FP8_FULLY_CONNECTED_INL_H_
+
+#include <mxnet/operator_util.h>
+#include <cmath>
+#include <vector>
+#include "../mxnet_op.h"
+#include "../mshadow_op.h"
+#include "../operator_common.h"
+#include "../nn/fully_connected-inl.h"
+#include "../tensor/broadcast_reduce_op.h"
+
+namespace mxnet {
+namespace op {
+
+namespace fp8 {
+// E4M3 for the forward operands, E5M2 for the gradients, as in the FP8 training recipes
+enum Fp8Format { kE4M3, kE5M2 };
+// rows of the amax history and entries of the scale input
+enum Fp8ScaledTensors { kDataTensor, kWeightTensor, kNumScaledTensors };
+}  // namespace fp8
+
+namespace fp8fc {
+enum Fp8FullyConnectedOpInputs { kData, kWeight, kBias };
+enum Fp8FullyConnectedOpOutputs { kOut };
+}  // namespace fp8fc
+
+struct Fp8FullyConnectedParam : public dmlc::Parameter<Fp8FullyConnectedParam> {
+  int num_hidden;
+  bool no_bias;
+  bool flatten;
+  int amax_history_len;
+  int margin;
+  DMLC_DECLARE_PARAMETER(Fp8FullyConnectedParam) {
+    DMLC_DECLARE_FIELD(num_hidden)
+        .set_lower_bound(1)
+        .describe("Number of hidden nodes of the output.");
+    DMLC_DECLARE_FIELD(no_bias).set_default(false).describe("Whether to disable bias parameter.");
+    DMLC_DECLARE_FIELD(flatten).set_default(true).describe(
+        "Whether to collapse all but the first axis of the input data tensor.");
+    DMLC_DECLARE_FIELD(amax_history_len)
+        .set_default(16)
+        .set_lower_bound(1)
+        .describe("Number of past iterations whose absolute maximum is kept to derive the scales.");
+    DMLC_DECLARE_FIELD(margin).set_default(0).set_lower_bound(0).describe(
+        "The scales leave 2^margin of headroom below the largest FP8 value.");
+  }
+
+  FullyConnectedParam FCParam() const {
+    FullyConnectedParam param;
+    param.num_hidden = num_hidden;
+    param.no_bias    = no_bias;
+    param.flatten    = flatten;
+    return param;
+  }
+};
+
+/*!
+ * \brief Largest finite value of the FP8 format.
+ */
+template <int format>
+MSHADOW_XINLINE float Fp8MaxValue() {
+  return format == fp8::kE4M3 ? 448.f : 57344.f;
+}
+
+/*!
+ * \brief Rounds x to the nearest value of the FP8 format, ties to even, saturating to the
+ *        largest finite value as the FP8 conversions of the tensor cores do.
+ */
+template <int format>
+MSHADOW_XINLINE float Fp8Round(const float x) {
+  const int mantissa_bits = format == fp8::kE4M3 ? 3 : 2;
+  const int min_exponent  = format == fp8::kE4M3 ? -6 : -14;
+  const float max_value   = Fp8MaxValue<format>();
+  if (x != x)  // NaN
+    return x;
+  const float a = fabsf(x);
+  if (a >= max_value)
+    return copysignf(max_value, x);
+  int exponent;
+  frexpf(a, &exponent);
+  // a is in [2^(exponent - 1), 2^exponent), below the normal range the step stays the subnormal one
+  exponent         = exponent - 1 > min_exponent ? exponent - 1 : min_exponent;
+  const float step = ldexpf(1.f, exponent - mantissa_bits);
+  const float q    = rintf(a / step) * step;
+  return copysignf(q > max_value ? max_value : q, x);
+}
+
+/*!
+ * \brief Delayed scaling: the scale of each tensor maps the largest absolute value seen over the
+ *        history to the largest FP8 value. Tensors without history keep their scale.
+ */
+struct fp8_delayed_scale {
+  MSHADOW_XINLINE static void Map(int i,
+                                  float* scale,
+                                  const float* amax_history,
+                                  const int history_len,
+                                  const float max_value,
+                                  const int margin) {
+    float amax = 0.f;
+    for (int j = 0; j < history_len; ++j) {
+      const float a = amax_history[i * history_len + j];
+      amax          = a > amax ? a : amax;
+    }
+    if (amax > 0.f && amax <= mshadow::red::limits::MaxValue<float>())
+      scale[i] = ldexpf(max_value / amax, -margin);
+  }
+};
+
+/*!
+ * \brief Shifts the amax history of each tensor by one iteration and records the new amax.
+ */
+struct fp8_push_amax_history {
+  MSHADOW_XINLINE static void Map(int i,
+                                  float* amax_history,
+                                  const int history_len,
+                                  const float* amax) {
+    float* row = amax_history + i * history_len;
+    for (int j = history_len - 1; j > 0; --j)
+      row[j] = row[j - 1];
+    row[0] = amax[i];
+  }
+};
+
+/*!
+ * \brief Current scaling from the amax of the tensor itself, used for the gradients.
+ */
+struct fp8_current_scale {
+  MSHADOW_XINLINE static void Map(int i, float* scale, const float* amax, const float max_value) {
+    const bool valid = amax[i] > 0.f && amax[i] <= mshadow::red::limits::MaxValue<float>();
+    scale[i]         = valid ? max_value / amax[i] : 1.f;
+  }
+};
+
+/*!
+ * \brief Value of in once scaled to the FP8 range, converted to FP8 and unscaled.
+ */
+template <int format>
+struct fp8_fake_cast {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i, DType* out, const DType* in, const float* scale) {
+    const float s = *scale;
+    out[i]        = static_cast<DType>(Fp8Round<format>(static_cast<float>(in[i]) * s) / s);
+  }
+};
+
+/*!
+ * \brief Bytes of temporary space to find the largest absolute value of a tensor of this shape.
+ */
+template <typename xpu, typename DType>
+size_t Fp8AbsMaxWorkspaceSize(mshadow::Stream<xpu>* s, const mxnet::TShape& shape) {
+  mxnet::TShape src_shape, dst_shape;
+  BroadcastReduceShapeCompact(shape, mxnet::TShape(1, 1), &src_shape, &dst_shape);
+  return broadcast::ReduceWorkspaceSize(s, dst_shape, kWriteTo, src_shape) + sizeof(DType);
+}
+
+/*!
+ * \brief Writes the largest absolute value of in to amax.
+ */
+template <typename xpu, typename DType>
+void Fp8AbsMax(const OpContext& ctx,
+               const TBlob& in,
+               float* amax,
+               const mshadow::Tensor<xpu, 1, char>& workspace) {
+  using namespace mshadow;
+  Stream<xpu>* s = ctx.get_stream<xpu>();
+  mxnet::TShape src_shape, dst_shape;
+  BroadcastReduceShapeCompact(in.shape_, mxnet::TShape(1, 1), &src_shape, &dst_shape);
+  // the reduction runs in DType, the result is widened to float
+  TBlob out(reinterpret_cast<DType*>(workspace.dptr_), Shape1(1), xpu::kDevMask, in.dev_id());
+  Tensor<xpu, 1, char> reduce_workspace(
+      workspace.dptr_ + sizeof(DType), Shape1(workspace.shape_[0] - sizeof(DType)), s);
+#if !defined(__CUDACC__)
+  broadcast::Reduce<red::maximum, 2, DType, mshadow_op::abs>(
+      s, out.reshape(dst_shape), kWriteTo, reduce_workspace, in.reshape(src_shape));
+#else
+  broadcast::RTCReduce(ctx,
+                       out.reshape(dst_shape),
+                       kWriteTo,
+                       reduce_workspace,
+                       in.reshape(src_shape),
+                       "red::maximum{}",
+                       2,
+                       "abs");
+#endif
+  Tensor<xpu, 1, float> amax_t(amax, Shape1(1), s);
+  amax_t = mshadow::expr::tcast<float>(out.get<xpu, 1, DType>(s));
+}
+
+template <typename xpu>
+void Fp8FullyConnectedForward(const nnvm::NodeAttrs& attrs,
+                              const OpContext& ctx,
+                              const std::vector<TBlob>& inputs,
+                              const std::vector<OpReqType>& req,
+                              const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  const Fp8FullyConnectedParam& param = nnvm::get<Fp8FullyConnectedParam>(attrs.parsed);
+  const size_t num_inputs             = param.no_bias ? 2 : 3;
+  CHECK_EQ(inputs.size(), num_inputs + 2);
+  CHECK_EQ(outputs.size(), 1U);
+  Stream<xpu>* s            = ctx.get_stream<xpu>();
+  const TBlob& amax_history = inputs[num_inputs];
+  const TBlob& scale        = inputs[num_inputs + 1];
+  const int history_len     = amax_history.shape_[1];
+  const float max_value     = Fp8MaxValue<fp8::kE4M3>();
+  MSHADOW_SGL_DBL_TYPE_SWITCH(inputs[fp8fc::kData].type_flag_, DType, {
+    const TBlob& data   = inputs[fp8fc::kData];
+    const TBlob& weight = inputs[fp8fc::kWeight];
+    // FP8 values of data and weight, their amax and the workspace of the amax reduction
+    const size_t fp8_bytes  = (data.Size() + weight.Size()) * sizeof(DType);
+    const size_t amax_bytes = fp8::kNumScaledTensors * sizeof(float);
+    const size_t reduce_bytes =
+        ctx.is_train ? std::max(Fp8AbsMaxWorkspaceSize<xpu, DType>(s, data.shape_),
+                                Fp8AbsMaxWorkspaceSize<xpu, DType>(s, weight.shape_))
+                     : 0;
+    Tensor<xpu, 1, char> temp_space = ctx.requested[0].get_space_typed<xpu, 1, char>(
+        Shape1(fp8_bytes + amax_bytes + reduce_bytes), s);
+    DType* fp8_ptr = reinterpret_cast<DType*>(temp_space.dptr_);
+    float* amax    = reinterpret_cast<float*>(temp_space.dptr_ + fp8_bytes);
+    Tensor<xpu, 1, char> workspace(
+        temp_space.dptr_ + fp8_bytes + amax_bytes, Shape1(reduce_bytes), s);
+    TBlob fp8_data(fp8_ptr, data.shape_, xpu::kDevMask, data.dev_id());
+    TBlob fp8_weight(fp8_ptr + data.Size(), weight.shape_, xpu::kDevMask, data.dev_id());
+
+    Kernel<fp8_delayed_scale, xpu>::Launch(s,
+                                           fp8::kNumScaledTensors,
+                                           scale.dptr<float>(),
+                                           amax_history.dptr<float>(),
+                                           history_len,
+                                           max_value,
+                                           param.margin);
+    Kernel<fp8_fake_cast<fp8::kE4M3>, xpu>::Launch(s,
+                                                   data.Size(),
+                                                   fp8_data.dptr<DType>(),
+                                                   data.dptr<DType>(),
+                                                   scale.dptr<float>() + fp8::kDataTensor);
+    Kernel<fp8_fake_cast<fp8::kE4M3>, xpu>::Launch(s,
+                                                   weight.Size(),
+                                                   fp8_weight.dptr<DType>(),
+                                                   weight.dptr<DType>(),
+                                                   scale.dptr<float>() + fp8::kWeightTensor);
+    if (ctx.is_train) {
+      Fp8AbsMax<xpu, DType>(ctx, data, amax + fp8::kDataTensor, workspace);
+      Fp8AbsMax<xpu, DType>(ctx, weight, amax + fp8::kWeightTensor, workspace);
+      Kernel<fp8_push_amax_history, xpu>::Launch(
+          s, fp8::kNumScaledTensors, amax_history.dptr<float>(), history_len, amax);
+    }
+
+    std::vector<TBlob> fc_inputs{fp8_data, fp8_weight};
+    if (!param.no_bias)
+      fc_inputs.push_back(inputs[fp8fc::kBias]);
+    FCForward<xpu, DType>(ctx, param.FCParam(), fc_inputs, req, outputs);
+  });
+}
+
+template <typename xpu>
+void Fp8FullyConnectedBackward(const nnvm::NodeAttrs& attrs,
+                               const OpContext& ctx,
+                               const std::vector<TBlob>& inputs,
+                               const std::vector<OpReqType>& req,
+                               const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  const Fp8FullyConnectedParam& param = nnvm::get<Fp8FullyConnectedParam>(attrs.parsed);
+  // out_grad, data, weight, scale
+  CHECK_EQ(inputs.size(), 4U);
+  CHECK_EQ(outputs.size(), param.no_bias ? 2U : 3U);
+  Stream<xpu>* s = ctx.get_stream<xpu>();
+  MSHADOW_SGL_DBL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    const TBlob& out_grad = inputs[0];
+    const TBlob& data     = inputs[1];
+    const TBlob& weight   = inputs[2];
+    const float* scale    = inputs[3].dptr<float>();
+    FullyConnectedParam fc_param = param.FCParam();
+    // the bias gradient is reduced from the gradient before its FP8 conversion, it uses the
+    // temporary space on its own
+    if (!param.no_bias) {
+      Tensor<xpu, 2, DType> grad = fc_param.flatten ?
+                                       FlattenAs2DTail<xpu, DType>(out_grad, ctx) :
+                                       FlattenAs2DHead<xpu, DType>(out_grad, ctx);
+      AddBiasGrad(outputs[fullc::kBias], grad, req[fullc::kBias], param.num_hidden, ctx);
+      fc_param.no_bias = true;
+    }
+
+    const size_t fp8_bytes    = (out_grad.Size() + data.Size() + weight.Size()) * sizeof(DType);
+    const size_t scale_bytes  = 2 * sizeof(float);
+    const size_t reduce_bytes = Fp8AbsMaxWorkspaceSize<xpu, DType>(s, out_grad.shape_);
+    Tensor<xpu, 1, char> temp_space = ctx.requested[0].get_space_typed<xpu, 1, char>(
+        Shape1(fp8_bytes + scale_bytes + reduce_bytes), s);
+    DType* fp8_ptr    = reinterpret_cast<DType*>(temp_space.dptr_);
+    float* grad_scale = reinterpret_cast<float*>(temp_space.dptr_ + fp8_bytes);
+    Tensor<xpu, 1, char> workspace(
+        temp_space.dptr_ + fp8_bytes + scale_bytes, Shape1(reduce_bytes), s);
+    TBlob fp8_grad(fp8_ptr, out_grad.shape_, xpu::kDevMask, data.dev_id());
+    TBlob fp8_data(fp8_ptr + out_grad.Size(), data.shape_, xpu::kDevMask, data.dev_id());
+    TBlob fp8_weight(
+        fp8_ptr + out_grad.Size() + data.Size(), weight.shape_, xpu::kDevMask, data.dev_id());
+
+    // the operands are the FP8 values of the forward, recomputed with the scales it used
+    Kernel<fp8_fake_cast<fp8::kE4M3>, xpu>::Launch(
+        s, data.Size(), fp8_data.dptr<DType>(), data.dptr<DType>(), scale + fp8::kDataTensor);
+    Kernel<fp8_fake_cast<fp8::kE4M3>, xpu>::Launch(s,
+                                                   weight.Size(),
+                                                   fp8_weight.dptr<DType>(),
+                                                   weight.dptr<DType>(),
+                                                   scale + fp8::kWeightTensor);
+    // the gradient is cast to E5M2 with a scale from its own amax
+    Fp8AbsMax<xpu, DType>(ctx, out_grad, grad_scale + 1, workspace);
+    Kernel<fp8_current_scale, xpu>::Launch(
+        s, 1, grad_scale, grad_scale + 1, Fp8MaxValue<fp8::kE5M2>());
+    Kernel<fp8_fake_cast<fp8::kE5M2>, xpu>::Launch(
+        s, out_grad.Size(), fp8_grad.dptr<DType>(), out_grad.dptr<DType>(), grad_scale);
+
+    std::vector<TBlob> fc_out_grad{fp8_grad};
+    std::vector<TBlob> fc_in_data{fp8_data, fp8_weight};
+    FCBackward<xpu, DType>(ctx, fc_param, fc_out_grad, fc_in_data, req, outputs);
+  });
+}
+
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_OPERATOR_CONTRIB_FP8_FULLY_CONNECTED_INL_H_
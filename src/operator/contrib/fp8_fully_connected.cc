@@ -0,0 +1,173 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file fp8_fully_connected.cc
+ * \brief Fully connected layer with FP8 (E4M3/E5M2) operands and delayed scaling
+ */
+#include "./fp8_fully_connected-inl.h"
+#include "../elemwise_op_common.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(Fp8FullyConnectedParam);
+
+static bool Fp8FullyConnectedShape(const nnvm::NodeAttrs& attrs,
+                                   mxnet::ShapeVector* in_shape,
+                                   mxnet::ShapeVector* out_shape) {
+  const Fp8FullyConnectedParam& param = nnvm::get<Fp8FullyConnectedParam>(attrs.parsed);
+  const size_t num_inputs             = param.no_bias ? 2 : 3;
+  CHECK_EQ(in_shape->size(), num_inputs + 2);
+  CHECK_EQ(out_shape->size(), 1U);
+  SHAPE_ASSIGN_CHECK(
+      *in_shape, num_inputs, mshadow::Shape2(fp8::kNumScaledTensors, param.amax_history_len));
+  SHAPE_ASSIGN_CHECK(*in_shape, num_inputs + 1, mshadow::Shape1(fp8::kNumScaledTensors));
+  const mxnet::TShape& dshape = (*in_shape)[fp8fc::kData];
+  if (!mxnet::ndim_is_known(dshape))
+    return false;
+  const index_t num_input =
+      param.flatten ? dshape.ProdShape(1, dshape.ndim()) : dshape[dshape.ndim() - 1];
+  SHAPE_ASSIGN_CHECK(*in_shape, fp8fc::kWeight, mshadow::Shape2(param.num_hidden, num_input));
+  if (!param.no_bias) {
+    SHAPE_ASSIGN_CHECK(*in_shape, fp8fc::kBias, mshadow::Shape1(param.num_hidden));
+  }
+  if (param.flatten) {
+    SHAPE_ASSIGN_CHECK(*out_shape, fp8fc::kOut, mshadow::Shape2(dshape[0], param.num_hidden));
+  } else {
+    mxnet::TShape oshape(dshape);
+    oshape[dshape.ndim() - 1] = param.num_hidden;
+    SHAPE_ASSIGN_CHECK(*out_shape, fp8fc::kOut, oshape);
+  }
+  return true;
+}
+
+static bool Fp8FullyConnectedType(const nnvm::NodeAttrs& attrs,
+                                  std::vector<int>* in_type,
+                                  std::vector<int>* out_type) {
+  const Fp8FullyConnectedParam& param = nnvm::get<Fp8FullyConnectedParam>(attrs.parsed);
+  const size_t num_inputs             = param.no_bias ? 2 : 3;
+  CHECK_EQ(in_type->size(), num_inputs + 2);
+  // the scaling state is float32 whatever the type of the layer
+  TYPE_ASSIGN_CHECK(*in_type, num_inputs, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*in_type, num_inputs + 1, mshadow::kFloat32);
+  std::vector<int> layer_in_type(in_type->begin(), in_type->begin() + num_inputs);
+  const bool ret = ElemwiseAttr<int, type_is_none, type_assign, true, type_string>(
+      attrs, &layer_in_type, out_type, -1);
+  std::copy(layer_in_type.begin(), layer_in_type.end(), in_type->begin());
+  return ret;
+}
+
+static std::vector<nnvm::NodeEntry> Fp8FullyConnectedGrad(
+    const nnvm::ObjectPtr& n,
+    const std::vector<nnvm::NodeEntry>& ograds) {
+  const Fp8FullyConnectedParam& param = nnvm::get<Fp8FullyConnectedParam>(n->attrs.parsed);
+  const size_t num_inputs             = param.no_bias ? 2 : 3;
+  std::vector<nnvm::NodeEntry> heads{ograds[fp8fc::kOut],
+                                     n->inputs[fp8fc::kData],
+                                     n->inputs[fp8fc::kWeight],
+                                     n->inputs[num_inputs + 1]};
+  nnvm::ObjectPtr gnode = nnvm::Node::Create();
+  gnode->inputs         = std::move(heads);
+  gnode->control_deps.emplace_back(n);
+  gnode->attrs      = n->attrs;
+  gnode->attrs.op   = nnvm::Op::Get("_backward_contrib_fp8_fully_connected");
+  gnode->attrs.name = n->attrs.name + "_backward";
+  std::vector<nnvm::NodeEntry> in_grad;
+  for (size_t i = 0; i < num_inputs; ++i)
+    in_grad.emplace_back(gnode, i, 0);
+  // no gradient for the amax history and the scales
+  nnvm::ObjectPtr ng = nnvm::Node::Create();
+  ng->attrs.op       = Op::Get("_NoGradient");
+  ng->attrs.name     = "NoGradient";
+  in_grad.emplace_back(ng);
+  in_grad.emplace_back(ng);
+  return in_grad;
+}
+
+NNVM_REGISTER_OP(_contrib_fp8_fully_connected)
+    .add_alias("_npx_fp8_fully_connected")
+    .describe(R"code(Fully connected layer whose matrix product runs on FP8 operands.
+
+The data and the weight are converted to FP8 E4M3 and the gradient of the output to FP8 E5M2,
+the products are accumulated in the precision of the layer. The E4M3 conversions use delayed
+scaling: the scale of each tensor maps the largest absolute value recorded in ``amax_history``
+over the last ``amax_history_len`` training iterations to the largest E4M3 value. Both
+``amax_history`` (2, amax_history_len), with one row for the data and one for the weight, and
+``scale`` (2,) are updated in place by the forward pass, the history only in training. Initialize
+the history to zeros and the scales to ones. The gradient uses the scale of its own absolute
+maximum.
+
+The operands are rounded to the values representable in FP8, so the results match the ones of
+FP8 matrix engines with a wider accumulation.
+)code" ADD_FILELINE)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      const Fp8FullyConnectedParam& params = nnvm::get<Fp8FullyConnectedParam>(attrs.parsed);
+      return params.no_bias ? 4 : 5;
+    })
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<Fp8FullyConnectedParam>)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          const Fp8FullyConnectedParam& params = nnvm::get<Fp8FullyConnectedParam>(attrs.parsed);
+          if (params.no_bias)
+            return std::vector<std::string>{"data", "weight", "amax_history", "scale"};
+          return std::vector<std::string>{"data", "weight", "bias", "amax_history", "scale"};
+        })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     const Fp8FullyConnectedParam& params =
+                                         nnvm::get<Fp8FullyConnectedParam>(attrs.parsed);
+                                     const uint32_t num_inputs = params.no_bias ? 2 : 3;
+                                     return std::vector<uint32_t>{num_inputs, num_inputs + 1};
+                                   })
+    .set_attr<mxnet::FInferShape>("FInferShape", Fp8FullyConnectedShape)
+    .set_attr<nnvm::FInferType>("FInferType", Fp8FullyConnectedType)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", Fp8FullyConnectedForward<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient", Fp8FullyConnectedGrad)
+    .add_argument("data", "NDArray-or-Symbol", "Input data.")
+    .add_argument("weight", "NDArray-or-Symbol", "Weight matrix.")
+    .add_argument("bias", "NDArray-or-Symbol", "Bias parameter.")
+    .add_argument("amax_history",
+                  "NDArray-or-Symbol",
+                  "float32 absolute maximums of data and weight over the last iterations.")
+    .add_argument("scale", "NDArray-or-Symbol", "float32 scales of data and weight.")
+    .add_arguments(Fp8FullyConnectedParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_contrib_fp8_fully_connected)
+    .set_num_inputs(4)
+    .set_num_outputs([](const NodeAttrs& attrs) {
+      const Fp8FullyConnectedParam& params = nnvm::get<Fp8FullyConnectedParam>(attrs.parsed);
+      return params.no_bias ? 2 : 3;
+    })
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr_parser(ParamParser<Fp8FullyConnectedParam>)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", Fp8FullyConnectedBackward<cpu>);
+
+}  // namespace op
+}  // namespace mxnet
@@ -69,6 +69,15 @@ void IndexCopyForward<cpu>(const nnvm::NodeAttrs& attrs,
   // index copy
   MSHADOW_TYPE_SWITCH(out.type_flag_, DType, {
     MSHADOW_TYPE_SWITCH(idx_vector.type_flag_, IType, {
+      // check the indices once, so that the kernel only copies rows
+      const IType* idx       = idx_vector.dptr<IType>();
+      const index_t num_rows = out.shape_[0];
+      for (index_t i = 0; i < static_cast<index_t>(idx_vector.Size()); ++i) {
+        const index_t row = static_cast<index_t>(idx[i]);
+        CHECK(row >= 0 && row < num_rows)
+            << "IndexError: index " << row << " is out of bounds for axis 0 with size "
+            << num_rows;
+      }
       Kernel<index_copy_fwd_cpu, cpu>::Launch(s,
                                               idx_vector.Size(),
                                               copied_tensor.dptr<DType>(),
@@ -60,15 +60,19 @@ void IndexCopyForward<gpu>(const nnvm::NodeAttrs& attrs,
   int dim_size                 = inputs[2].Size() / inputs[1].Size();
   // copy original tensor to output
   copy(s, out, original_tensor);
-  // index copy
+  // index copy, moving the rows in the widest load type which divides them
   MSHADOW_TYPE_SWITCH(out.type_flag_, DType, {
     MSHADOW_TYPE_SWITCH(idx_vector.type_flag_, IType, {
-      Kernel<index_copy_fwd_gpu, gpu>::Launch(s,
-                                              copied_tensor.Size(),
-                                              copied_tensor.dptr<DType>(),
-                                              idx_vector.dptr<IType>(),
-                                              out.dptr<DType>(),
-                                              dim_size);
+      const size_t bytes = dim_size * sizeof(DType) |
+                           reinterpret_cast<uintptr_t>(copied_tensor.dptr<DType>()) |
+                           reinterpret_cast<uintptr_t>(out.dptr<DType>());
+      MXNET_LOAD_TYPE_SWITCH(common::cuda::get_load_type(bytes), LType, {
+        const int row_size   = dim_size * sizeof(DType) / sizeof(LType);
+        const LType* new_ptr = reinterpret_cast<const LType*>(copied_tensor.dptr<DType>());
+        LType* out_ptr       = reinterpret_cast<LType*>(out.dptr<DType>());
+        Kernel<index_copy_fwd_gpu, gpu>::Launch(
+            s, idx_vector.Size() * row_size, new_ptr, idx_vector.dptr<IType>(), out_ptr, row_size);
+      });
     });
   });
 }
@@ -0,0 +1,122 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file multi_tensor_stats.cc
+ * \brief statistics of multiple arrays in one reduction, for monitoring
+ */
+
+#include "./multi_tensor_stats-inl.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(MultiTensorStatsParam);
+
+NNVM_REGISTER_OP(multi_tensor_stats)
+    .describe(R"code(Compute statistics of multiple arrays for monitoring, in one pass.
+
+The output has one row per array, of float32 values:
+(min, max, mean, l2 norm, number of non-finite elements).
+The min, max, mean and norm are over the finite elements, NaN and infinities are only counted.
+The min, max and mean of an array without finite element are NaN.
+
+Like every operator the statistics are computed asynchronously, on the device of the arrays,
+and only reading them waits for their computation. Pushing them every N steps and reading them
+a few steps later monitors the arrays without stalling training.
+
+Example::
+
+  stats = multi_tensor_stats(*activations, num_arrays=len(activations))
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
+      return static_cast<uint32_t>(dmlc::get<MultiTensorStatsParam>(attrs.parsed).num_arrays);
+    })
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<MultiTensorStatsParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", MultiTensorStatsShape)
+    .set_attr<nnvm::FInferType>("FInferType", MultiTensorStatsType)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          const auto& param       = dmlc::get<MultiTensorStatsParam>(attrs.parsed);
+          const uint32_t num_args = param.num_arrays;
+          std::vector<std::string> ret;
+          for (uint32_t i = 0; i < num_args; ++i) {
+            ret.push_back(std::string("array_") + std::to_string(i));
+          }
+          return ret;
+        })
+    .set_attr<FCompute>("FCompute<cpu>", MultiTensorStats<cpu>)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .add_argument("data", "NDArray-or-Symbol[]", "Arrays")
+    .add_arguments(MultiTensorStatsParam::__FIELDS__());
+
+template <typename DType>
+inline void CalcTensorStats(const std::vector<TBlob>& inputs,
+                            float* out_ptr,
+                            mshadow::Stream<cpu>* s) {
+  const int n_inputs = inputs.size();
+#pragma omp parallel for
+  for (int i = 0; i < n_inputs; ++i) {  // array index in inputs
+    float vmin         = std::numeric_limits<float>::infinity();
+    float vmax         = -std::numeric_limits<float>::infinity();
+    float sum          = 0, sum_sq = 0;
+    size_t num_finite  = 0;
+    const auto address = inputs[i].FlatTo2D<cpu, DType>(s).dptr_;
+    const size_t j_max = inputs[i].shape_.Size();
+    for (size_t j = 0; j < j_max; ++j) {
+      const auto val = static_cast<float>(address[j]);
+      if (std::isfinite(val)) {
+        vmin = std::min(vmin, val);
+        vmax = std::max(vmax, val);
+        sum += val;
+        sum_sq += val * val;
+        ++num_finite;
+      }
+    }
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    float* stats    = out_ptr + i * multi_tensor_stats::kNumStats;
+
+    stats[multi_tensor_stats::kMin]       = num_finite > 0 ? vmin : nan;
+    stats[multi_tensor_stats::kMax]       = num_finite > 0 ? vmax : nan;
+    stats[multi_tensor_stats::kMean]      = num_finite > 0 ? sum / num_finite : nan;
+    stats[multi_tensor_stats::kNorm]      = std::sqrt(sum_sq);
+    stats[multi_tensor_stats::kNonFinite] = j_max - num_finite;
+  }
+}
+
+template <>
+void MultiTensorStatsRun<cpu>(const std::vector<TBlob>& inputs,
+                              float* out_ptr,
+                              const OpContext& ctx) {
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_,
+                           DType,
+                           CalcTensorStats<DType>(inputs, out_ptr, ctx.get_stream<cpu>());)
+}
+
+}  // namespace op
+}  // namespace mxnet
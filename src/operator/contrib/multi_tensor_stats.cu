@@ -0,0 +1,215 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file multi_tensor_stats.cu
+ * \brief statistics of multiple arrays in one reduction, for monitoring
+ */
+#include "./multi_tensor_stats-inl.h"
+#include <cub/cub.cuh>
+#include <algorithm>
+
+namespace mxnet {
+namespace op {
+
+// the arrays are split in chunks reduced by one block each, batched over kernel launches of at
+// most kStatsBlockLimit blocks and kStatsArrayLimit arrays as in multi_sum_sq
+constexpr int kStatsChunkSize  = 32768;
+constexpr int kStatsBlockSize  = 512;
+constexpr int kStatsBlockLimit = 320;
+constexpr int kStatsArrayLimit = 110;
+
+/*! \brief Partial statistics of each chunk, before the final reduction */
+enum MultiTensorStatsPartial {
+  kPartMin,
+  kPartMax,
+  kPartSum,
+  kPartSumSq,
+  kPartFinite,
+  kPartCount,
+  kNumParts
+};
+
+template <typename DType>
+struct MultiTensorStatsKernelParam {
+  const DType* addresses[kStatsArrayLimit];
+  int sizes[kStatsArrayLimit];
+  unsigned char block_to_tensor[kStatsBlockLimit];
+  int block_to_chunk[kStatsBlockLimit];
+};
+
+template <typename DType>
+__global__ void MultiTensorStatsKernel(MultiTensorStatsKernelParam<DType> param,
+                                       float* partials,
+                                       int n_inputs,
+                                       int max_chunks_per_tensor,
+                                       int start_tensor_id) {
+  typedef cub::BlockReduce<float, kStatsBlockSize> BlockReduce;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+  const int tensor_loc = param.block_to_tensor[blockIdx.x];
+  const int chunk      = param.block_to_chunk[blockIdx.x];
+  const int n          = param.sizes[tensor_loc] - chunk * kStatsChunkSize;
+  const DType* x       = param.addresses[tensor_loc] + chunk * kStatsChunkSize;
+  const int i_max      = n <= kStatsChunkSize ? n : kStatsChunkSize;
+
+  float vmin = INFINITY, vmax = -INFINITY, sum = 0, sum_sq = 0, num_finite = 0;
+  for (int i = threadIdx.x; i < i_max; i += blockDim.x) {
+    const float val = static_cast<float>(x[i]);
+    if (isfinite(val)) {
+      vmin = fminf(vmin, val);
+      vmax = fmaxf(vmax, val);
+      sum += val;
+      sum_sq += val * val;
+      num_finite += 1;
+    }
+  }
+  // the temporary storage is reused after a barrier
+  float part[kNumParts];
+  part[kPartMin] = BlockReduce(temp_storage).Reduce(vmin, cub::Min());
+  __syncthreads();
+  part[kPartMax] = BlockReduce(temp_storage).Reduce(vmax, cub::Max());
+  __syncthreads();
+  part[kPartSum] = BlockReduce(temp_storage).Sum(sum);
+  __syncthreads();
+  part[kPartSumSq] = BlockReduce(temp_storage).Sum(sum_sq);
+  __syncthreads();
+  part[kPartFinite] = BlockReduce(temp_storage).Sum(num_finite);
+  part[kPartCount]  = i_max;
+
+  if (threadIdx.x == 0) {
+    const int tensor = start_tensor_id + tensor_loc;
+    for (int k = 0; k < kNumParts; ++k)
+      partials[(k * n_inputs + tensor) * max_chunks_per_tensor + chunk] = part[k];
+  }
+}
+
+__global__ void MultiTensorStatsGlobalKernel(const float* partials,
+                                             int n_inputs,
+                                             int max_chunks_per_tensor,
+                                             float* output) {
+  typedef cub::BlockReduce<float, kStatsBlockSize> BlockReduce;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+  const int tensor = blockIdx.x;
+  float part[kNumParts];
+  for (int k = 0; k < kNumParts; ++k) {
+    const float* p = partials + (k * n_inputs + tensor) * max_chunks_per_tensor;
+    const float* c = partials + (kPartCount * n_inputs + tensor) * max_chunks_per_tensor;
+    float val      = k == kPartMin ? INFINITY : (k == kPartMax ? -INFINITY : 0);
+    // the chunks past the end of the array are zeros, of count 0
+    for (int i = threadIdx.x; i < max_chunks_per_tensor; i += blockDim.x) {
+      if (k == kPartMin)
+        val = c[i] > 0 ? fminf(val, p[i]) : val;
+      else if (k == kPartMax)
+        val = c[i] > 0 ? fmaxf(val, p[i]) : val;
+      else
+        val += p[i];
+    }
+    if (k == kPartMin)
+      part[k] = BlockReduce(temp_storage).Reduce(val, cub::Min());
+    else if (k == kPartMax)
+      part[k] = BlockReduce(temp_storage).Reduce(val, cub::Max());
+    else
+      part[k] = BlockReduce(temp_storage).Sum(val);
+    __syncthreads();
+  }
+
+  if (threadIdx.x == 0) {
+    using namespace multi_tensor_stats;
+    const float num_finite = part[kPartFinite];
+    float* stats           = output + tensor * kNumStats;
+
+    stats[kMin]       = num_finite > 0 ? part[kPartMin] : NAN;
+    stats[kMax]       = num_finite > 0 ? part[kPartMax] : NAN;
+    stats[kMean]      = num_finite > 0 ? part[kPartSum] / num_finite : NAN;
+    stats[kNorm]      = sqrtf(part[kPartSumSq]);
+    stats[kNonFinite] = part[kPartCount] - num_finite;
+  }
+}
+
+template <>
+void MultiTensorStatsRun<gpu>(const std::vector<TBlob>& inputs,
+                              float* out_ptr,
+                              const OpContext& ctx) {
+  using namespace mshadow;
+  auto s             = ctx.get_stream<gpu>();
+  auto stream        = Stream<gpu>::GetStream(s);
+  const int n_inputs = inputs.size();
+
+  int max_chunks_per_tensor = 1;
+  std::vector<int> sizes(n_inputs);
+  for (int t = 0; t < n_inputs; ++t) {
+    sizes[t]              = inputs[t].shape_.Size();
+    max_chunks_per_tensor =
+        std::max(max_chunks_per_tensor, (sizes[t] + kStatsChunkSize - 1) / kStatsChunkSize);
+  }
+  // the partials of every chunk of every array, by kind of partial
+  const size_t partials_bytes = kNumParts * n_inputs * max_chunks_per_tensor * sizeof(float);
+  Tensor<gpu, 1, char> workspace =
+      ctx.requested[multi_tensor_stats::kTempSpace].get_space_typed<gpu, 1, char>(
+          Shape1(partials_bytes), s);
+  float* partials = reinterpret_cast<float*>(workspace.dptr_);
+  CUDA_CALL(cudaMemsetAsync(partials, 0, partials_bytes, stream));
+
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    MultiTensorStatsKernelParam<DType> param;
+    int loc_block_info  = 0;  // position in param.block_to_tensor and param.block_to_chunk
+    int loc_tensor_info = 0;  // position in param.sizes and param.addresses
+    int start_tensor_id = 0;
+    for (int t = 0; t < n_inputs; t++, loc_tensor_info++) {  // array index in inputs
+      param.sizes[loc_tensor_info]     = sizes[t];
+      param.addresses[loc_tensor_info] = inputs[t].FlatTo2D<gpu, DType>(s).dptr_;
+      const int last_chunk_this_tensor = sizes[t] > 0 ? (sizes[t] - 1) / kStatsChunkSize : 0;
+      for (int chunk = 0; chunk <= last_chunk_this_tensor; ++chunk) {  // array chunk index
+        param.block_to_tensor[loc_block_info] = loc_tensor_info;
+        param.block_to_chunk[loc_block_info]  = chunk;
+        loc_block_info++;
+
+        const bool last_curr_chunk = chunk == last_chunk_this_tensor;
+        const bool tensors_full =
+            last_curr_chunk && loc_tensor_info == (kStatsArrayLimit - 1);
+        const bool blocks_full = (loc_block_info == kStatsBlockLimit);
+        const bool last_chunk  = last_curr_chunk && t == n_inputs - 1;
+        if (!(tensors_full || blocks_full || last_chunk))
+          continue;
+        MultiTensorStatsKernel<<<loc_block_info, kStatsBlockSize, 0, stream>>>(
+            param, partials, n_inputs, max_chunks_per_tensor, start_tensor_id);
+        MSHADOW_CUDA_POST_KERNEL_CHECK(MultiTensorStatsKernel);
+
+        loc_block_info = 0;
+        if (last_curr_chunk) {  // if you start from a new tensor
+          loc_tensor_info = -1;
+          start_tensor_id = t + 1;
+        } else {  // if you start from the same tensor
+          param.sizes[0]     = param.sizes[loc_tensor_info];
+          param.addresses[0] = param.addresses[loc_tensor_info];
+          loc_tensor_info    = 0;
+          start_tensor_id    = t;
+        }
+      }
+    }
+  });
+  MultiTensorStatsGlobalKernel<<<n_inputs, kStatsBlockSize, 0, stream>>>(
+      partials, n_inputs, max_chunks_per_tensor, out_ptr);
+  MSHADOW_CUDA_POST_KERNEL_CHECK(MultiTensorStatsGlobalKernel);
+}
+
+NNVM_REGISTER_OP(multi_tensor_stats).set_attr<FCompute>("FCompute<gpu>", MultiTensorStats<gpu>);
+
+}  // namespace op
+}  // namespace mxnet
@@ -0,0 +1,127 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file multi_tensor_update-inl.h
+ * \brief Helpers of the fused multi-tensor optimizer updates: the gradient scale computed on the
+ *        device and the lookup of the tensor of an element of the whole group
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_MULTI_TENSOR_UPDATE_INL_H_
+#define MXNET_OPERATOR_CONTRIB_MULTI_TENSOR_UPDATE_INL_H_
+
+#include <vector>
+#include "../mxnet_op.h"
+#include "../mshadow_op.h"
+#include "./multi_sum_sq-inl.h"
+
+namespace mxnet {
+namespace op {
+
+/*!
+ * \brief Index of the tensor holding the element i of a group of count tensors laid end to end,
+ *        offsets[t] being the position of the first element of tensor t. Launching one work item
+ *        per element of the group keeps the work balanced whatever the sizes of the tensors.
+ */
+MSHADOW_XINLINE int MultiTensorIndex(const size_t* offsets, const int count, const size_t i) {
+  int lo = 0, hi = count - 1;
+  while (lo < hi) {
+    const int mid = (lo + hi + 1) / 2;
+    if (offsets[mid] <= i) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return lo;
+}
+
+/*!
+ * \brief Writes the factor applied to the gradients: rescale_grad, times
+ *        max_grad_norm / norm(rescale_grad * grads) when that norm is larger than max_grad_norm.
+ *        It is 0 when rescale_grad is 0, inf or NaN or, with skip_nonfinite, when a gradient
+ *        holds an inf or a NaN, which shows in the sum of its squares.
+ */
+struct multi_update_scale {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(int i,
+                                  float* scale,
+                                  const DType* rescale_grad,
+                                  const float* sum_sq,
+                                  const int num_sum_sq,
+                                  const float max_grad_norm,
+                                  const bool skip_nonfinite) {
+    float s     = static_cast<float>(*rescale_grad);
+    float total = 0.f;
+    for (int j = 0; j < num_sum_sq; ++j) {
+      total += sum_sq[j];
+    }
+    if (!mshadow_op::isfinite::Map(s) || (skip_nonfinite && !mshadow_op::isfinite::Map(total))) {
+      *scale = 0.f;
+      return;
+    }
+    if (max_grad_norm > 0.f) {
+      const float norm = fabsf(s) * sqrtf(total);
+      if (norm > max_grad_norm)
+        s *= max_grad_norm / norm;
+    }
+    *scale = s;
+  }
+};
+
+/*!
+ * \brief Computes the gradient scale of a multi-tensor update into the temporary space
+ *        ctx.requested[0] and returns its device pointer. The sums of squares of the gradients
+ *        are only computed when the global norm is clipped or the non finite gradients skipped.
+ */
+template <typename xpu>
+float* MultiUpdateScale(const OpContext& ctx,
+                        const std::vector<TBlob>& grads,
+                        const TBlob& rescale_grad,
+                        const float max_grad_norm,
+                        const bool skip_nonfinite) {
+  using namespace mxnet_op;
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  const bool need_sum_sq  = max_grad_norm > 0.f || skip_nonfinite;
+  const int num_sum_sq    = need_sum_sq ? static_cast<int>(grads.size()) : 0;
+  // [storage of MultiSumSqRun | sum of squares of every gradient | scale]
+  const size_t sum_sq_storage = need_sum_sq ? GetRequiredStorageMultiSumSq<xpu>(grads) : 0;
+  mshadow::Tensor<xpu, 1, char> workspace =
+      ctx.requested[multi_sum_sq::kTempSpace].get_space_typed<xpu, 1, char>(
+          mshadow::Shape1(sum_sq_storage + (num_sum_sq + 1) * sizeof(float)), s);
+  float* sum_sq = reinterpret_cast<float*>(workspace.dptr_ + sum_sq_storage);
+  float* scale  = sum_sq + num_sum_sq;
+  if (need_sum_sq)
+    MultiSumSqRun<xpu>(grads, num_sum_sq, sum_sq, ctx);
+  MSHADOW_REAL_TYPE_SWITCH(rescale_grad.type_flag_, DType, {
+    Kernel<multi_update_scale, xpu>::Launch(s,
+                                            1,
+                                            scale,
+                                            rescale_grad.dptr<DType>(),
+                                            sum_sq,
+                                            num_sum_sq,
+                                            max_grad_norm,
+                                            skip_nonfinite);
+  });
+  return scale;
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_CONTRIB_MULTI_TENSOR_UPDATE_INL_H_
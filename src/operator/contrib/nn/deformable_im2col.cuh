@@ -227,12 +227,13 @@ __global__ void deformable_im2col_gpu_kernel(const index_t n, const DType* data_
                                              const index_t dilation_h, const index_t dilation_w,
                                              const index_t channel_per_group,
                                              const index_t height_col, const index_t width_col,
+                                             const index_t row_begin, const index_t num_rows,
                                              DType* data_col) {
   CUDA_KERNEL_LOOP(index, n) {
     // index index of output matrix
     const index_t w_col = index % width_col;
-    const index_t h_col = (index / width_col) % height_col;
-    const index_t c_im = (index / width_col) / height_col;
+    const index_t h_col = (index / width_col) % num_rows + row_begin;
+    const index_t c_im = (index / width_col) / num_rows;
     const index_t c_col = c_im * kernel_h * kernel_w;
 
     const index_t group_index = c_im / channel_per_group;
@@ -240,7 +241,7 @@ __global__ void deformable_im2col_gpu_kernel(const index_t n, const DType* data_
 
     const index_t h_in = h_col * stride_h - pad_h;
     const index_t w_in = w_col * stride_w - pad_w;
-    DType* data_col_ptr = data_col + (c_col * height_col + h_col) * width_col + w_col;
+    DType* data_col_ptr = data_col + (c_col * num_rows + h_col - row_begin) * width_col + w_col;
     const DType* data_im_ptr = data_im + (c_im * height + h_in) * width + w_in;
     const DType* data_offset_ptr = data_offset + group_index * group_offset_step;
 
@@ -263,7 +264,7 @@ __global__ void deformable_im2col_gpu_kernel(const index_t n, const DType* data_
           val = deformable_im2col_bilinear(data_im_ptr, width, cur_height, cur_width, map_h, map_w);
         }
         *data_col_ptr = val;
-        data_col_ptr += height_col * width_col;
+        data_col_ptr += num_rows * width_col;
       }
     }
   }
@@ -277,6 +278,8 @@ __global__ void deformable_im2col_gpu_kernel(const index_t n, const DType* data_
  * \param data_offset pointer of offset (C, H, W, ...) in the offset batch
  * \param im_shape input image shape in dimensions (N, C, H, W,)
  * \param col_shape column buffer shape (#channels, output_im_height, output_im_width, ...)
+ * \param row_begin first output row held by the column buffer
+ * \param num_rows number of output rows held by the column buffer
  * \param kernel_shape kernel filter shape
  * \param pad pad shape
  * \param stride stride shape
@@ -290,6 +293,8 @@ inline void deformable_im2col(mshadow::Stream<gpu>* s,
                               const DType* data_offset,
                               const mxnet::TShape& im_shape,
                               const mxnet::TShape& col_shape,
+                              const index_t row_begin,
+                              const index_t num_rows,
                               const mxnet::TShape& kernel_shape,
                               const mxnet::TShape& pad,
                               const mxnet::TShape& stride,
@@ -300,7 +305,7 @@ inline void deformable_im2col(mshadow::Stream<gpu>* s,
   const int num_spatial_axes = kernel_shape.ndim();
   CHECK_LT(num_spatial_axes, mshadow::cuda::kBaseThreadNum);
   index_t channel_per_group = im_shape[1] / deformable_group;
-  index_t num_kernels = im_shape[1] * col_shape.ProdShape(1, col_shape.ndim());
+  index_t num_kernels = im_shape[1] * num_rows * col_shape[2];
   using namespace mxnet_op;
   switch (num_spatial_axes) {
   case 2:
@@ -312,7 +317,8 @@ inline void deformable_im2col(mshadow::Stream<gpu>* s,
                                                     pad[0], pad[1], stride[0], stride[1],
                                                     dilation[0], dilation[1],
                                                     channel_per_group,
-                                                    col_shape[1], col_shape[2], data_col);
+                                                    col_shape[1], col_shape[2],
+                                                    row_begin, num_rows, data_col);
     MSHADOW_CUDA_POST_KERNEL_CHECK(deformable_im2col_gpu_kernel);
     break;
   default:
@@ -336,18 +342,19 @@ __global__ void deformable_col2im_gpu_kernel(const index_t n, const DType* data_
                                              const index_t dilation_h, const index_t dilation_w,
                                              const index_t channel_per_group,
                                              const index_t height_col, const index_t width_col,
+                                             const index_t row_begin, const index_t num_rows,
                                              DType* grad_im) {
   CUDA_KERNEL_LOOP(index, n) {
-    const index_t j = (index / width_col / height_col) % kernel_w;
-    const index_t i = (index / width_col / height_col / kernel_w) % kernel_h;
-    const index_t c = index / width_col / height_col / kernel_w / kernel_h;
+    const index_t j = (index / width_col / num_rows) % kernel_w;
+    const index_t i = (index / width_col / num_rows / kernel_w) % kernel_h;
+    const index_t c = index / width_col / num_rows / kernel_w / kernel_h;
     // compute the start and end of the output
 
     const index_t group_index = c / channel_per_group;
     const index_t group_offset_step = 2 * kernel_h * kernel_w * height_col * width_col;
 
     index_t w_col = index % width_col;
-    index_t h_col = (index / width_col) % height_col;
+    index_t h_col = (index / width_col) % num_rows + row_begin;
     index_t w_in = w_col * stride_w - pad_w;
     index_t h_in = h_col * stride_h - pad_h;
 
@@ -388,6 +395,8 @@ __global__ void deformable_col2im_gpu_kernel(const index_t n, const DType* data_
  * \param data_offset pointer of offset (C, H, W, ...) in the offset batch
  * \param im_shape input image shape in dimensions (N, C, H, W,)
  * \param col_shape column buffer shape
+ * \param row_begin first output row held by the column buffer
+ * \param num_rows number of output rows held by the column buffer
  * \param kernel_shape kernel filter shape
  * \param pad pad shape
  * \param stride stride shape
@@ -401,6 +410,8 @@ inline void deformable_col2im(mshadow::Stream<gpu>* s,
                               const DType* data_offset,
                               const mxnet::TShape& im_shape,
                               const mxnet::TShape& col_shape,
+                              const index_t row_begin,
+                              const index_t num_rows,
                               const mxnet::TShape& kernel_shape,
                               const mxnet::TShape& pad,
                               const mxnet::TShape& stride,
@@ -410,7 +421,7 @@ inline void deformable_col2im(mshadow::Stream<gpu>* s,
   const int num_spatial_axes = kernel_shape.ndim();
   index_t im_size = im_shape.ProdShape(1, im_shape.ndim());
   index_t channel_per_group = im_shape[1] / deformable_group;
-  index_t num_kernels = col_shape.ProdShape(0, col_shape.ndim());
+  index_t num_kernels = col_shape[0] * num_rows * col_shape[2];
   // num_axes should be smaller than block size
   CHECK_LT(num_spatial_axes, mshadow::cuda::kBaseThreadNum);
   using namespace mxnet_op;
@@ -427,7 +438,8 @@ inline void deformable_col2im(mshadow::Stream<gpu>* s,
                                                pad[0], pad[1], stride[0], stride[1],
                                                dilation[0], dilation[1],
                                                channel_per_group,
-                                               col_shape[1], col_shape[2], grad_im);
+                                               col_shape[1], col_shape[2],
+                                               row_begin, num_rows, grad_im);
     MSHADOW_CUDA_POST_KERNEL_CHECK(deformable_col2im_gpu_kernel);
     break;
   default:
@@ -453,16 +465,17 @@ __global__ void deformable_col2im_coord_gpu_kernel(const index_t n, const DType*
                                                    const index_t dilation_h, const index_t dilation_w,
                                                    const index_t channel_per_group,
                                                    const index_t height_col, const index_t width_col,
+                                                   const index_t row_begin, const index_t num_rows,
                                                    DType* grad_offset) {
   CUDA_KERNEL_LOOP(index, n) {
     DType val = 0;
     index_t w = index % width_col;
-    index_t h = (index / width_col) % height_col;
-    index_t c = index / width_col / height_col;
+    index_t h = (index / width_col) % num_rows;
+    index_t c = index / width_col / num_rows;
     // compute the start and end of the output
 
     const index_t group_index = c / (2 * kernel_h * kernel_w);
-    const index_t group_col_step = channel_per_group * width_col * height_col;
+    const index_t group_col_step = channel_per_group * width_col * num_rows;
     const index_t group_im_step = channel_per_group / kernel_h / kernel_w * height * width;
     const index_t group_offset_step = 2 * kernel_h * kernel_w * height_col * width_col;
     const index_t col_step = kernel_h * kernel_w;
@@ -474,13 +487,13 @@ __global__ void deformable_col2im_coord_gpu_kernel(const index_t n, const DType*
     const index_t offset_c = c - group_index * 2 * kernel_h * kernel_w;
 
     for (index_t col_c = (offset_c / 2); col_c < channel_per_group; col_c += col_step) {
-      const index_t col_pos = ((col_c * height_col) + h) * width_col + w;
+      const index_t col_pos = ((col_c * num_rows) + h) * width_col + w;
       const index_t bp_dir = offset_c % 2;
 
-      index_t j = (col_pos / width_col / height_col) % kernel_w;
-      index_t i = (col_pos / width_col / height_col / kernel_w) % kernel_h;
+      index_t j = (col_pos / width_col / num_rows) % kernel_w;
+      index_t i = (col_pos / width_col / num_rows / kernel_w) % kernel_h;
       index_t w_col = col_pos % width_col;
-      index_t h_col = (col_pos / width_col) % height_col;
+      index_t h_col = (col_pos / width_col) % num_rows + row_begin;
       index_t w_in = w_col * stride_w - pad_w;
       index_t h_in = h_col * stride_h - pad_h;
       const index_t data_offset_h_ptr = ((2 * (i * kernel_w + j)) *
@@ -500,7 +513,7 @@ __global__ void deformable_col2im_coord_gpu_kernel(const index_t n, const DType*
       cnt += 1;
     }
 
-    grad_offset[index] = val;
+    grad_offset[(c * height_col + h + row_begin) * width_col + w] = val;
   }
 }
 
@@ -513,6 +526,8 @@ __global__ void deformable_col2im_coord_gpu_kernel(const index_t n, const DType*
  * \param data_offset pointer of offset (C, H, W, ...) in the offset batch
  * \param im_shape input image shape in dimensions (N, C, H, W,)
  * \param col_shape column buffer shape
+ * \param row_begin first output row held by the column buffer
+ * \param num_rows number of output rows held by the column buffer
  * \param kernel_shape kernel filter shape
  * \param pad pad shape
  * \param stride stride shape
@@ -527,6 +542,8 @@ inline void deformable_col2im_coord(mshadow::Stream<gpu>* s,
                                     const DType* data_offset,
                                     const mxnet::TShape& im_shape,
                                     const mxnet::TShape& col_shape,
+                                    const index_t row_begin,
+                                    const index_t num_rows,
                                     const mxnet::TShape& kernel_shape,
                                     const mxnet::TShape& pad,
                                     const mxnet::TShape& stride,
@@ -534,7 +551,7 @@ inline void deformable_col2im_coord(mshadow::Stream<gpu>* s,
                                     const index_t deformable_group,
                                     DType* grad_offset) {
   const int num_spatial_axes = kernel_shape.ndim();
-  index_t num_kernels = col_shape[1] * col_shape[2] * 2 *
+  index_t num_kernels = num_rows * col_shape[2] * 2 *
     kernel_shape[0] * kernel_shape[1] * deformable_group;
   index_t channel_per_group = col_shape[0] / deformable_group;
   // num_axes should be smaller than block size
@@ -553,7 +570,8 @@ inline void deformable_col2im_coord(mshadow::Stream<gpu>* s,
                                                pad[0], pad[1], stride[0], stride[1],
                                                dilation[0], dilation[1],
                                                channel_per_group,
-                                               col_shape[1], col_shape[2], grad_offset);
+                                               col_shape[1], col_shape[2],
+                                               row_begin, num_rows, grad_offset);
     MSHADOW_CUDA_POST_KERNEL_CHECK(deformable_col2im_coord_gpu_kernel);
     break;
   default:
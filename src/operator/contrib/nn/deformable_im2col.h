@@ -234,6 +234,8 @@ inline void deformable_im2col_cpu(const DType* data_im,
                                   const index_t deformable_group,
                                   const index_t height_col,
                                   const index_t width_col,
+                                  const index_t row_begin,
+                                  const index_t num_rows,
                                   DType* data_col) {
   const index_t channel_size      = height * width;
   const index_t offset_size       = 2 * kernel_h * kernel_w * height_col * width_col;
@@ -244,8 +246,8 @@ inline void deformable_im2col_cpu(const DType* data_im,
     }
     for (index_t i = 0; i < kernel_h; i++) {
       for (index_t j = 0; j < kernel_w; j++) {
-        index_t input_row = -pad_h + i * dilation_h;
-        for (index_t h_col = 0; h_col < height_col; h_col++) {
+        index_t input_row = -pad_h + i * dilation_h + row_begin * stride_h;
+        for (index_t h_col = row_begin; h_col < row_begin + num_rows; h_col++) {
           index_t input_col = -pad_w + j * dilation_w;
           for (index_t w_col = 0; w_col < width_col; w_col++) {
             index_t offset_h_ptr =
@@ -274,6 +276,8 @@ inline void deformable_im2col_cpu(const DType* data_im,
  * \param data_offset pointer of offset (C, H, W, ...) in the offset batch
  * \param im_shape input image shape in dimensions (N, C, H, W,)
  * \param col_shape column buffer shape (#channels, output_im_height, output_im_width, ...)
+ * \param row_begin first output row held by the column buffer
+ * \param num_rows number of output rows held by the column buffer
  * \param kernel_shape kernel filter shape
  * \param pad pad shape
  * \param stride stride shape
@@ -287,6 +291,8 @@ inline void deformable_im2col(mshadow::Stream<cpu>* s,
                               const DType* data_offset,
                               const mxnet::TShape& im_shape,
                               const mxnet::TShape& col_shape,
+                              const index_t row_begin,
+                              const index_t num_rows,
                               const mxnet::TShape& kernel_shape,
                               const mxnet::TShape& pad,
                               const mxnet::TShape& stride,
@@ -310,6 +316,8 @@ inline void deformable_im2col(mshadow::Stream<cpu>* s,
                           deformable_group,
                           col_shape[1],
                           col_shape[2],
+                          row_begin,
+                          num_rows,
                           data_col);
   } else {
     LOG(FATAL) << "not implemented";
@@ -338,20 +346,22 @@ inline void deformable_col2im_cpu(const DType* data_col,
                                   const index_t deformable_group,
                                   const index_t height_col,
                                   const index_t width_col,
+                                  const index_t row_begin,
+                                  const index_t num_rows,
                                   DType* grad_im) {
   index_t channel_per_group = channels / deformable_group;
-  index_t count             = channels * kernel_h * kernel_w * height_col * width_col;
+  index_t count             = channels * kernel_h * kernel_w * num_rows * width_col;
   for (index_t index = 0; index < count; ++index) {
-    const index_t j = (index / width_col / height_col) % kernel_w;
-    const index_t i = (index / width_col / height_col / kernel_w) % kernel_h;
-    const index_t c = index / width_col / height_col / kernel_w / kernel_h;
+    const index_t j = (index / width_col / num_rows) % kernel_w;
+    const index_t i = (index / width_col / num_rows / kernel_w) % kernel_h;
+    const index_t c = index / width_col / num_rows / kernel_w / kernel_h;
     // compute the start and end of the output
 
     const index_t group_index       = c / channel_per_group;
     const index_t group_offset_step = 2 * kernel_h * kernel_w * height_col * width_col;
 
     index_t w_col = index % width_col;
-    index_t h_col = (index / width_col) % height_col;
+    index_t h_col = (index / width_col) % num_rows + row_begin;
     index_t w_in  = w_col * stride_w - pad_w;
     index_t h_in  = h_col * stride_h - pad_h;
 
@@ -389,6 +399,8 @@ inline void deformable_col2im_cpu(const DType* data_col,
  * \param data_offset pointer of offset (C, H, W, ...) in the offset batch
  * \param im_shape input image shape in dimensions (N, C, H, W,)
  * \param col_shape column buffer shape
+ * \param row_begin first output row held by the column buffer
+ * \param num_rows number of output rows held by the column buffer
  * \param kernel_shape kernel filter shape
  * \param pad pad shape
  * \param stride stride shape
@@ -402,6 +414,8 @@ inline void deformable_col2im(mshadow::Stream<cpu>* s,
                               const DType* data_offset,
                               const mxnet::TShape& im_shape,
                               const mxnet::TShape& col_shape,
+                              const index_t row_begin,
+                              const index_t num_rows,
                               const mxnet::TShape& kernel_shape,
                               const mxnet::TShape& pad,
                               const mxnet::TShape& stride,
@@ -425,6 +439,8 @@ inline void deformable_col2im(mshadow::Stream<cpu>* s,
                           deformable_group,
                           col_shape[1],
                           col_shape[2],
+                          row_begin,
+                          num_rows,
                           grad_im);
   } else {
     LOG(FATAL) << "not implemented";
@@ -454,18 +470,20 @@ inline void deformable_col2im_coord_cpu(const DType* data_col,
                                         const index_t deformable_group,
                                         const index_t height_col,
                                         const index_t width_col,
+                                        const index_t row_begin,
+                                        const index_t num_rows,
                                         DType* grad_offset) {
   index_t channel_per_group = channels * kernel_h * kernel_w / deformable_group;
-  index_t count             = height_col * width_col * 2 * kernel_h * kernel_w * deformable_group;
+  index_t count             = num_rows * width_col * 2 * kernel_h * kernel_w * deformable_group;
   for (index_t index = 0; index < count; ++index) {
     DType val = 0;
     index_t w = index % width_col;
-    index_t h = (index / width_col) % height_col;
-    index_t c = index / width_col / height_col;
+    index_t h = (index / width_col) % num_rows;
+    index_t c = index / width_col / num_rows;
     // compute the start and end of the output
 
     const index_t group_index       = c / (2 * kernel_h * kernel_w);
-    const index_t group_col_step    = channel_per_group * width_col * height_col;
+    const index_t group_col_step    = channel_per_group * width_col * num_rows;
     const index_t group_im_step     = channel_per_group / kernel_h / kernel_w * height * width;
     const index_t group_offset_step = 2 * kernel_h * kernel_w * height_col * width_col;
     const index_t col_step          = kernel_h * kernel_w;
@@ -477,13 +495,13 @@ inline void deformable_col2im_coord_cpu(const DType* data_col,
     const index_t offset_c = c - group_index * 2 * kernel_h * kernel_w;
 
     for (index_t col_c = (offset_c / 2); col_c < channel_per_group; col_c += col_step) {
-      const index_t col_pos = ((col_c * height_col) + h) * width_col + w;
+      const index_t col_pos = ((col_c * num_rows) + h) * width_col + w;
       const index_t bp_dir  = offset_c % 2;
 
-      index_t j     = (col_pos / width_col / height_col) % kernel_w;
-      index_t i     = (col_pos / width_col / height_col / kernel_w) % kernel_h;
+      index_t j     = (col_pos / width_col / num_rows) % kernel_w;
+      index_t i     = (col_pos / width_col / num_rows / kernel_w) % kernel_h;
       index_t w_col = col_pos % width_col;
-      index_t h_col = (col_pos / width_col) % height_col;
+      index_t h_col = (col_pos / width_col) % num_rows + row_begin;
       index_t w_in  = w_col * stride_w - pad_w;
       index_t h_in  = h_col * stride_h - pad_h;
       const index_t data_offset_h_ptr =
@@ -502,7 +520,7 @@ inline void deformable_col2im_coord_cpu(const DType* data_col,
       cnt += 1;
     }
 
-    grad_offset[index] = val;
+    grad_offset[(c * height_col + h + row_begin) * width_col + w] = val;
   }
 }
 
@@ -514,6 +532,8 @@ inline void deformable_col2im_coord_cpu(const DType* data_col,
  * \param data_offset pointer of offset (C, H, W, ...) in the offset batch
  * \param im_shape input image shape in dimensions (N, C, H, W,)
  * \param col_shape column buffer shape
+ * \param row_begin first output row held by the column buffer
+ * \param num_rows number of output rows held by the column buffer
  * \param kernel_shape kernel filter shape
  * \param pad pad shape
  * \param stride stride shape
@@ -528,6 +548,8 @@ inline void deformable_col2im_coord(mshadow::Stream<cpu>* s,
                                     const DType* data_offset,
                                     const mxnet::TShape& im_shape,
                                     const mxnet::TShape& col_shape,
+                                    const index_t row_begin,
+                                    const index_t num_rows,
                                     const mxnet::TShape& kernel_shape,
                                     const mxnet::TShape& pad,
                                     const mxnet::TShape& stride,
@@ -552,6 +574,8 @@ inline void deformable_col2im_coord(mshadow::Stream<cpu>* s,
                                 deformable_group,
                                 col_shape[1],
                                 col_shape[2],
+                                row_begin,
+                                num_rows,
                                 grad_offset);
   } else {
     LOG(FATAL) << "not implemented";
@@ -209,13 +209,14 @@ __global__ void modulated_deformable_im2col_gpu_kernel(const int n,
   const int channel_per_deformable_group,
   const int batch_size, const int num_channels, const int deformable_group,
   const int height_col, const int width_col,
+  const int row_begin, const int num_rows,
   DType* data_col) {
   CUDA_KERNEL_LOOP(index, n) {
     // index index of output matrix
     const int w_col = index % width_col;
-    const int h_col = (index / width_col) % height_col;
-    const int b_col = (index / width_col / height_col) % batch_size;
-    const int c_im = (index / width_col / height_col) / batch_size;
+    const int h_col = (index / width_col) % num_rows + row_begin;
+    const int b_col = (index / width_col / num_rows) % batch_size;
+    const int c_im = (index / width_col / num_rows) / batch_size;
     const int c_col = c_im * kernel_h * kernel_w;
 
     // compute deformable group index
@@ -224,7 +225,7 @@ __global__ void modulated_deformable_im2col_gpu_kernel(const int n,
     const int h_in = h_col * stride_h - pad_h;
     const int w_in = w_col * stride_w - pad_w;
 
-    DType* data_col_ptr = data_col + ((c_col * batch_size + b_col) * height_col + h_col) * width_col + w_col;
+    DType* data_col_ptr = data_col + ((c_col * batch_size + b_col) * num_rows + h_col - row_begin) * width_col + w_col;
     //const DType* data_im_ptr = data_im + ((b_col * num_channels + c_im) * height + h_in) * width + w_in;
     const DType* data_im_ptr = data_im + (b_col * num_channels + c_im) * height * width;
     const DType* data_offset_ptr = data_offset + (b_col * deformable_group + deformable_group_index) * 2 * kernel_h * kernel_w * height_col * width_col;
@@ -252,7 +253,7 @@ __global__ void modulated_deformable_im2col_gpu_kernel(const int n,
           val = dmcn_im2col_bilinear(data_im_ptr, width, height, width, h_im, w_im);
         }
         *data_col_ptr = val * mask;
-        data_col_ptr += batch_size * height_col * width_col;
+        data_col_ptr += batch_size * num_rows * width_col;
         //data_col_ptr += height_col * width_col;
       }
     }
@@ -268,6 +269,8 @@ __global__ void modulated_deformable_im2col_gpu_kernel(const int n,
  * \param data_offset pointer of offset (N, deformable_group*kernel_h*kernel_w*2, H, W, ...) in the offset batch
  * \param im_shape input image shape in dimensions (N, C, H, W,)
  * \param col_shape column buffer shape (#channels, N, output_im_height, output_im_width, ...)
+ * \param row_begin first output row held by the column buffer
+ * \param num_rows number of output rows held by the column buffer
  * \param kernel_shape kernel filter shape
  * \param pad pad shape
  * \param stride stride shape
@@ -278,14 +281,15 @@ __global__ void modulated_deformable_im2col_gpu_kernel(const int n,
 template <typename DType>
 inline void modulated_deformable_im2col(mshadow::Stream<gpu>* s,
   const DType* data_im, const DType* data_offset, const DType* data_mask,
-  const TShape& im_shape, const TShape& col_shape, const TShape& kernel_shape,
+  const TShape& im_shape, const TShape& col_shape,
+  const index_t row_begin, const index_t num_rows, const TShape& kernel_shape,
   const TShape& pad, const TShape& stride, const TShape& dilation,
   const uint32_t deformable_group, DType* data_col) {
   // num_axes should be smaller than block size
   index_t num_spatial_axes = kernel_shape.ndim();
   CHECK_LT(num_spatial_axes, mshadow::cuda::kBaseThreadNum);
   index_t channel_per_deformable_group = im_shape[1] / deformable_group;
-  index_t num_kernels = im_shape[1] * col_shape.ProdShape(1, col_shape.ndim());
+  index_t num_kernels = im_shape[1] * col_shape[1] * num_rows * col_shape[3];
   using namespace mxnet_op;
   switch (num_spatial_axes) {
   case 2:
@@ -294,7 +298,8 @@ inline void modulated_deformable_im2col(mshadow::Stream<gpu>* s,
            0, mshadow::Stream<gpu>::GetStream(s)>>>(
         num_kernels, data_im, data_offset, data_mask, im_shape[2], im_shape[3], kernel_shape[0], kernel_shape[1],
         pad[0], pad[1], stride[0], stride[1], dilation[0], dilation[1], channel_per_deformable_group,
-        col_shape[1], im_shape[1], deformable_group, col_shape[2], col_shape[3], data_col);
+        col_shape[1], im_shape[1], deformable_group, col_shape[2], col_shape[3],
+        row_begin, num_rows, data_col);
     MSHADOW_CUDA_POST_KERNEL_CHECK(modulated_deformable_im2col_gpu_kernel);
     break;
   default:
@@ -319,18 +324,19 @@ __global__ void modulated_deformable_col2im_gpu_kernel(const int n,
   const int channel_per_deformable_group,
   const int batch_size, const int deformable_group,
   const int height_col, const int width_col,
+  const int row_begin, const int num_rows,
   DType* grad_im, OpReqType req) {
   CUDA_KERNEL_LOOP(index, n) {
-    const int j = (index / width_col / height_col / batch_size) % kernel_w;
-    const int i = (index / width_col / height_col / batch_size / kernel_w) % kernel_h;
-    const int c = index / width_col / height_col / batch_size / kernel_w / kernel_h;
+    const int j = (index / width_col / num_rows / batch_size) % kernel_w;
+    const int i = (index / width_col / num_rows / batch_size / kernel_w) % kernel_h;
+    const int c = index / width_col / num_rows / batch_size / kernel_w / kernel_h;
     // compute the start and end of the output
 
     const int deformable_group_index = c / channel_per_deformable_group;
 
     int w_out = index % width_col;
-    int h_out = (index / width_col) % height_col;
-    int b = (index / width_col / height_col) % batch_size;
+    int h_out = (index / width_col) % num_rows + row_begin;
+    int b = (index / width_col / num_rows) % batch_size;
     int w_in = w_out * stride_w - pad_w;
     int h_in = h_out * stride_h - pad_h;
 
@@ -372,6 +378,8 @@ __global__ void modulated_deformable_col2im_gpu_kernel(const int n,
  * \param data_offset pointer of offset (N, deformable_group*kernel_h*kernel_w*2, H, W, ...) in the offset batch
  * \param im_shape input image shape in dimensions (N, C, H, W,)
  * \param col_shape column buffer shape
+ * \param row_begin first output row held by the column buffer
+ * \param num_rows number of output rows held by the column buffer
  * \param kernel_shape kernel filter shape
  * \param pad pad shape
  * \param stride stride shape
@@ -382,14 +390,15 @@ __global__ void modulated_deformable_col2im_gpu_kernel(const int n,
 template <typename DType>
 inline void modulated_deformable_col2im(mshadow::Stream<gpu>* s,
   const DType* data_col, const DType* data_offset, const DType* data_mask,
-  const TShape& im_shape, const TShape& col_shape, const TShape& kernel_shape,
+  const TShape& im_shape, const TShape& col_shape,
+  const index_t row_begin, const index_t num_rows, const TShape& kernel_shape,
   const TShape& pad, const TShape& stride,
   const TShape& dilation, const uint32_t deformable_group,
   DType* grad_im, OpReqType req) {
   index_t num_spatial_axes = kernel_shape.ndim();
   index_t im_size = im_shape.ProdShape(1, im_shape.ndim());
   index_t channel_per_deformable_group = im_shape[1] / deformable_group;
-  index_t num_kernels = col_shape.ProdShape(0, col_shape.ndim());
+  index_t num_kernels = col_shape[0] * col_shape[1] * num_rows * col_shape[3];
   // num_axes should be smaller than block size
   CHECK_LT(num_spatial_axes, mshadow::cuda::kBaseThreadNum);
   using namespace mxnet_op;
@@ -403,7 +412,8 @@ inline void modulated_deformable_col2im(mshadow::Stream<gpu>* s,
         num_kernels, data_col, data_offset, data_mask, im_shape[1], im_shape[2], im_shape[3],
         kernel_shape[0], kernel_shape[1], pad[0], pad[1], stride[0], stride[1],
         dilation[0], dilation[1], channel_per_deformable_group,
-        col_shape[1], deformable_group, col_shape[2], col_shape[3], grad_im, req);
+        col_shape[1], deformable_group, col_shape[2], col_shape[3],
+        row_begin, num_rows, grad_im, req);
     MSHADOW_CUDA_POST_KERNEL_CHECK(modulated_deformable_col2im_gpu_kernel);
     break;
   default:
@@ -429,19 +439,20 @@ __global__ void modulated_deformable_col2im_coord_gpu_kernel(const int n,
   const int channel_per_deformable_group,
   const int batch_size, const int offset_channels, const int deformable_group,
   const int height_col, const int width_col,
+  const int row_begin, const int num_rows,
   DType* grad_offset, DType* grad_mask, OpReqType offset_req, OpReqType mask_req) {
   CUDA_KERNEL_LOOP(index, n) {
     DType val = 0, mval = 0;
     int w = index % width_col;
-    int h = (index / width_col) % height_col;
-    int c = (index / width_col / height_col) % offset_channels;
-    int b = (index / width_col / height_col) / offset_channels;
+    int h = (index / width_col) % num_rows;
+    int c = (index / width_col / num_rows) % offset_channels;
+    int b = (index / width_col / num_rows) / offset_channels;
     // compute the start and end of the output
 
     const int deformable_group_index = c / (2 * kernel_h * kernel_w);
     const int col_step = kernel_h * kernel_w;
     int cnt = 0;
-    const DType* data_col_ptr = data_col + deformable_group_index * channel_per_deformable_group * batch_size * width_col * height_col;
+    const DType* data_col_ptr = data_col + deformable_group_index * channel_per_deformable_group * batch_size * width_col * num_rows;
     const DType* data_im_ptr = data_im + (b * deformable_group + deformable_group_index) * channel_per_deformable_group / kernel_h / kernel_w * height * width;
     const DType* data_offset_ptr = data_offset + (b * deformable_group + deformable_group_index) * 2 * kernel_h * kernel_w * height_col * width_col;
     const DType* data_mask_ptr = data_mask + (b * deformable_group + deformable_group_index) * kernel_h * kernel_w * height_col * width_col;
@@ -449,13 +460,13 @@ __global__ void modulated_deformable_col2im_coord_gpu_kernel(const int n,
     const int offset_c = c - deformable_group_index * 2 * kernel_h * kernel_w;
 
     for (int col_c = (offset_c / 2); col_c < channel_per_deformable_group; col_c += col_step) {
-      const int col_pos = (((col_c * batch_size + b) * height_col) + h) * width_col + w;
+      const int col_pos = (((col_c * batch_size + b) * num_rows) + h) * width_col + w;
       const int bp_dir = offset_c % 2;
 
-      int j = (col_pos / width_col / height_col / batch_size) % kernel_w;
-      int i = (col_pos / width_col / height_col / batch_size / kernel_w) % kernel_h;
+      int j = (col_pos / width_col / num_rows / batch_size) % kernel_w;
+      int i = (col_pos / width_col / num_rows / batch_size / kernel_w) % kernel_h;
       int w_out = col_pos % width_col;
-      int h_out = (col_pos / width_col) % height_col;
+      int h_out = (col_pos / width_col) % num_rows + row_begin;
       int w_in = w_out * stride_w - pad_w;
       int h_in = h_out * stride_h - pad_h;
       const int data_offset_h_ptr = (((2 * (i * kernel_w + j)) * height_col + h_out) * width_col + w_out);
@@ -478,8 +489,8 @@ __global__ void modulated_deformable_col2im_coord_gpu_kernel(const int n,
       cnt  += 1;
     }
 
-    //grad_offset[index] = val;
-    KERNEL_ASSIGN(grad_offset[index], offset_req, val);
+    h += row_begin;
+    KERNEL_ASSIGN(grad_offset[((b * offset_channels + c) * height_col + h) * width_col + w], offset_req, val);
     if (offset_c % 2 == 0)
         KERNEL_ASSIGN(grad_mask[(((b * deformable_group + deformable_group_index) * kernel_h * kernel_w + offset_c / 2) * height_col + h) * width_col + w], mask_req, mval);
   }
@@ -493,6 +504,8 @@ __global__ void modulated_deformable_col2im_coord_gpu_kernel(const int n,
  * \param data_offset pointer of offset (N, deformable_group*kernel_h*kernel_w*2, H, W, ...) in the offset batch
  * \param im_shape input image shape in dimensions (N, C, H, W,)
  * \param col_shape column buffer shape
+ * \param row_begin first output row held by the column buffer
+ * \param num_rows number of output rows held by the column buffer
  * \param kernel_shape kernel filter shape
  * \param pad pad shape
  * \param stride stride shape
@@ -503,12 +516,13 @@ __global__ void modulated_deformable_col2im_coord_gpu_kernel(const int n,
 template <typename DType>
 inline void modulated_deformable_col2im_coord(mshadow::Stream<gpu>* s,
   const DType* data_col, const DType* data_im, const DType* data_offset, const DType* data_mask,
-  const TShape& im_shape, const TShape& col_shape, const TShape& kernel_shape,
+  const TShape& im_shape, const TShape& col_shape,
+  const index_t row_begin, const index_t num_rows, const TShape& kernel_shape,
   const TShape& pad, const TShape& stride,
   const TShape& dilation, const uint32_t deformable_group,
   DType* grad_offset, DType* grad_mask, OpReqType offset_req, OpReqType mask_req) {
   index_t num_spatial_axes = kernel_shape.ndim();
-  index_t num_kernels = col_shape[1] * col_shape[2] * col_shape[3] * 2 * kernel_shape[0] * kernel_shape[1] * deformable_group;
+  index_t num_kernels = col_shape[1] * num_rows * col_shape[3] * 2 * kernel_shape[0] * kernel_shape[1] * deformable_group;
   index_t channel_per_deformable_group = col_shape[0] / deformable_group;
   // num_axes should be smaller than block size
   CHECK_LT(num_spatial_axes, mshadow::cuda::kBaseThreadNum);
@@ -525,7 +539,7 @@ inline void modulated_deformable_col2im_coord(mshadow::Stream<gpu>* s,
         kernel_shape[0], kernel_shape[1], pad[0], pad[1], stride[0], stride[1],
         dilation[0], dilation[1], channel_per_deformable_group,
         col_shape[1], 2 * kernel_shape[0] * kernel_shape[1] * deformable_group, deformable_group, col_shape[2], col_shape[3],
-        grad_offset, grad_mask, offset_req, mask_req);
+        row_begin, num_rows, grad_offset, grad_mask, offset_req, mask_req);
     MSHADOW_CUDA_POST_KERNEL_CHECK(modulated_deformable_col2im_coord_gpu_kernel);
     break;
   default:
@@ -151,12 +151,14 @@ struct modulated_deformable_col2im_cpu_kernel {
                                   const int deformable_group,
                                   const int height_col,
                                   const int width_col,
+                                  const int row_begin,
+                                  const int num_rows,
                                   DType* data_col) {
     // index index of output matrix
     const int w_col = index % width_col;
-    const int h_col = (index / width_col) % height_col;
-    const int b_col = (index / width_col / height_col) % batch_size;
-    const int c_im  = (index / width_col / height_col) / batch_size;
+    const int h_col = (index / width_col) % num_rows + row_begin;
+    const int b_col = (index / width_col / num_rows) % batch_size;
+    const int c_im  = (index / width_col / num_rows) / batch_size;
     const int c_col = c_im * kernel_h * kernel_w;
 
     // compute deformable group index
@@ -165,8 +167,9 @@ struct modulated_deformable_col2im_cpu_kernel {
     const int h_in = h_col * stride_h - pad_h;
     const int w_in = w_col * stride_w - pad_w;
 
+    const int row_col   = h_col - row_begin;
     DType* data_col_ptr =
-        data_col + ((c_col * batch_size + b_col) * height_col + h_col) * width_col + w_col;
+        data_col + ((c_col * batch_size + b_col) * num_rows + row_col) * width_col + w_col;
     // const DType* data_im_ptr = data_im +
     //  ((b_col * num_channels + c_im) * height + h_in) * width + w_in;
     const DType* data_im_ptr = data_im + (b_col * num_channels + c_im) * height * width;
@@ -201,7 +204,7 @@ struct modulated_deformable_col2im_cpu_kernel {
           val = dmcn_im2col_bilinear_cpu(data_im_ptr, width, height, width, h_im, w_im);
         }
         *data_col_ptr = val * mask;
-        data_col_ptr += batch_size * height_col * width_col;
+        data_col_ptr += batch_size * num_rows * width_col;
         // data_col_ptr += height_col * width_col;
       }
     }
@@ -215,6 +218,8 @@ struct modulated_deformable_col2im_cpu_kernel {
  * \param data_offset pointer of offset (C, H, W, ...) in the offset batch
  * \param im_shape input image shape in dimensions (N, C, H, W,)
  * \param col_shape column buffer shape (#channels, output_im_height, output_im_width, ...)
+ * \param row_begin first output row held by the column buffer
+ * \param num_rows number of output rows held by the column buffer
  * \param kernel_shape kernel filter shape
  * \param pad pad shape
  * \param stride stride shape
@@ -229,6 +234,8 @@ inline void modulated_deformable_im2col(mshadow::Stream<cpu>* s,
                                         const DType* data_mask,
                                         const TShape& im_shape,
                                         const TShape& col_shape,
+                                        const index_t row_begin,
+                                        const index_t num_rows,
                                         const TShape& kernel_shape,
                                         const TShape& pad,
                                         const TShape& stride,
@@ -238,7 +245,7 @@ inline void modulated_deformable_im2col(mshadow::Stream<cpu>* s,
   // num_axes should be smaller than block size
   index_t num_spatial_axes             = kernel_shape.ndim();
   index_t channel_per_deformable_group = im_shape[1] / deformable_group;
-  index_t num_kernels                  = im_shape[1] * col_shape.ProdShape(1, col_shape.ndim());
+  index_t num_kernels                  = im_shape[1] * col_shape[1] * num_rows * col_shape[3];
   using namespace mxnet_op;
   if (2 == num_spatial_axes) {
     Kernel<modulated_deformable_col2im_cpu_kernel, cpu>::Launch(s,
@@ -262,6 +269,8 @@ inline void modulated_deformable_im2col(mshadow::Stream<cpu>* s,
                                                                 deformable_group,
                                                                 col_shape[2],
                                                                 col_shape[3],
+                                                                row_begin,
+                                                                num_rows,
                                                                 data_col);
   } else {
     LOG(FATAL) << "not implemented";
@@ -275,6 +284,8 @@ inline void modulated_deformable_im2col(mshadow::Stream<cpu>* s,
  * \param data_offset pointer of offset (C, H, W, ...) in the offset batch
  * \param im_shape input image shape in dimensions (N, C, H, W,)
  * \param col_shape column buffer shape
+ * \param row_begin first output row held by the column buffer
+ * \param num_rows number of output rows held by the column buffer
  * \param kernel_shape kernel filter shape
  * \param pad pad shape
  * \param stride stride shape
@@ -289,6 +300,8 @@ inline void modulated_deformable_col2im(mshadow::Stream<cpu>* s,
                                         const DType* data_mask,
                                         const TShape& im_shape,
                                         const TShape& col_shape,
+                                        const index_t row_begin,
+                                        const index_t num_rows,
                                         const TShape& kernel_shape,
                                         const TShape& pad,
                                         const TShape& stride,
@@ -307,6 +320,8 @@ inline void modulated_deformable_col2im(mshadow::Stream<cpu>* s,
  * \param data_offset pointer of offset (C, H, W, ...) in the offset batch
  * \param im_shape input image shape in dimensions (N, C, H, W,)
  * \param col_shape column buffer shape
+ * \param row_begin first output row held by the column buffer
+ * \param num_rows number of output rows held by the column buffer
  * \param kernel_shape kernel filter shape
  * \param pad pad shape
  * \param stride stride shape
@@ -323,6 +338,8 @@ inline void modulated_deformable_col2im_coord(mshadow::Stream<cpu>* s,
                                               const DType* data_mask,
                                               const TShape& im_shape,
                                               const TShape& col_shape,
+                                              const index_t row_begin,
+                                              const index_t num_rows,
                                               const TShape& kernel_shape,
                                               const TShape& pad,
                                               const TShape& stride,
@@ -38,6 +38,9 @@ It updates the weights using::
 
  weight = weight - learning_rate * (gradient + wd * weight)
 
+The learning rates and weight decays are read on the device, and there is no lazy update: a
+row_sparse gradient is updated as a dense one. Use multi_sgd_update for a lazy update of
+row_sparse gradients.
 )code" ADD_FILELINE)
     .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
       const PreloadedMultiSGDParam& param = dmlc::get<PreloadedMultiSGDParam>(attrs.parsed);
@@ -90,6 +93,9 @@ It updates the weights using::
 
 Where the parameter ``momentum`` is the decay rate of momentum estimates at each epoch.
 
+The learning rates and weight decays are read on the device, and there is no lazy update: a
+row_sparse gradient is updated as a dense one. Use multi_sgd_mom_update for a lazy update of
+row_sparse gradients.
 )code" ADD_FILELINE)
     .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
       const PreloadedMultiSGDMomParam& param = dmlc::get<PreloadedMultiSGDMomParam>(attrs.parsed);
@@ -145,6 +151,9 @@ It updates the weights using::
 
  weight = weight - learning_rate * (gradient + wd * weight)
 
+The learning rates and weight decays are read on the device, and there is no lazy update: a
+row_sparse gradient is updated as a dense one. Use multi_mp_sgd_update for a lazy update of
+row_sparse gradients.
 )code" ADD_FILELINE)
     .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
       const PreloadedMultiSGDParam& param = dmlc::get<PreloadedMultiSGDParam>(attrs.parsed);
@@ -211,6 +220,9 @@ It updates the weights using::
 
 Where the parameter ``momentum`` is the decay rate of momentum estimates at each epoch.
 
+The learning rates and weight decays are read on the device, and there is no lazy update: a
+row_sparse gradient is updated as a dense one. Use multi_mp_sgd_mom_update for a lazy update of
+row_sparse gradients.
 )code" ADD_FILELINE)
     .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
       const PreloadedMultiSGDMomParam& param = dmlc::get<PreloadedMultiSGDMomParam>(attrs.parsed);
@@ -25,6 +25,7 @@
 #ifndef MXNET_OPERATOR_CONTRIB_ROI_ALIGN_INL_H_
 #define MXNET_OPERATOR_CONTRIB_ROI_ALIGN_INL_H_
 
+#include <cmath>
 #include <vector>
 #include <utility>
 #include "../mshadow_op.h"
@@ -71,6 +72,65 @@ struct ROIAlignParam : public dmlc::Parameter<ROIAlignParam> {
   }
 };
 
+/*! \brief Maximum number of pyramid levels of MultiLevelROIAlign */
+constexpr int kMaxROIAlignLevels = 8;
+
+struct MultiLevelROIAlignParam : public dmlc::Parameter<MultiLevelROIAlignParam> {
+  mxnet::TShape pooled_size;
+  mxnet::Tuple<float> spatial_scales;
+  int sample_ratio;
+  bool aligned;
+  float canonical_scale;
+  int canonical_level;
+  DMLC_DECLARE_PARAMETER(MultiLevelROIAlignParam) {
+    DMLC_DECLARE_FIELD(pooled_size)
+        .set_expect_ndim(2)
+        .enforce_nonzero()
+        .describe("ROI Align output roi feature map height and width: (h, w)");
+    DMLC_DECLARE_FIELD(spatial_scales)
+        .describe(
+            "Spatial scale of each feature map, from the finest level, e.g. "
+            "(0.25, 0.125, 0.0625, 0.03125) for the levels 2 to 5 of an FPN.");
+    DMLC_DECLARE_FIELD(sample_ratio)
+        .set_default(-1)
+        .describe("Optional sampling ratio of ROI align, using adaptive size by default.");
+    DMLC_DECLARE_FIELD(aligned).set_default(false).describe(
+        "Center-aligned ROIAlign introduced in Detectron2. "
+        "To enable, set aligned to True.");
+    DMLC_DECLARE_FIELD(canonical_scale)
+        .set_default(224)
+        .describe("Size of the ROIs which are assigned to canonical_level.");
+    DMLC_DECLARE_FIELD(canonical_level)
+        .set_default(4)
+        .describe("Level of the ROIs of size canonical_scale.");
+  }
+};
+
+/*! \brief Pyramid level of the finest feature map, e.g. 2 for a spatial scale of 1/4 */
+inline int ROIAlignFirstLevel(const MultiLevelROIAlignParam& param) {
+  return static_cast<int>(std::round(-std::log2(param.spatial_scales[0])));
+}
+
+/*!
+ * \brief Index of the feature map of an ROI (x1, y1, x2, y2), with the assignment of the FPN
+ *        paper: level floor(canonical_level + log2(sqrt(area) / canonical_scale)), clipped to
+ *        the levels of the pyramid.
+ */
+template <typename T>
+MSHADOW_XINLINE int ROIAlignFPNLevel(const T* box,
+                                     const int num_levels,
+                                     const int first_level,
+                                     const float canonical_scale,
+                                     const int canonical_level) {
+  const float w     = static_cast<float>(box[2]) - static_cast<float>(box[0]);
+  const float h     = static_cast<float>(box[3]) - static_cast<float>(box[1]);
+  const float scale = sqrtf(w > 0 && h > 0 ? w * h : 0.f);
+  const int level   =
+      static_cast<int>(floorf(canonical_level + log2f(scale / canonical_scale + 1e-6f)));
+  const int index   = level - first_level;
+  return index < 0 ? 0 : (index >= num_levels ? num_levels - 1 : index);
+}
+
 }  // namespace op
 }  // namespace mxnet
 
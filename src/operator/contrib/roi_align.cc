@@ -526,7 +526,60 @@ void ROIAlignBackwardCompute(const nnvm::NodeAttrs& attrs,
   })
 }
 
+template <typename xpu>
+void MultiLevelROIAlignForwardCompute(const nnvm::NodeAttrs& attrs,
+                                      const OpContext& ctx,
+                                      const std::vector<TBlob>& in_data,
+                                      const std::vector<OpReqType>& req,
+                                      const std::vector<TBlob>& out_data) {
+  const MultiLevelROIAlignParam& param = nnvm::get<MultiLevelROIAlignParam>(attrs.parsed);
+  const int num_levels                 = param.spatial_scales.ndim();
+  CHECK_EQ(in_data.size(), num_levels + 1);
+  CHECK_EQ(out_data.size(), 1U);
+  const TBlob& rois = in_data[0];
+  const TBlob& out  = out_data[0];
+
+  const int num_rois      = rois.size(0);
+  const int channels      = out.size(1);
+  const int pooled_height = out.size(2);
+  const int pooled_width  = out.size(3);
+  const int roi_size      = channels * pooled_height * pooled_width;
+  const int first_level   = ROIAlignFirstLevel(param);
+
+  MSHADOW_REAL_TYPE_SWITCH(out.type_flag_, DType, {
+    const DType* bottom_rois = rois.dptr<DType>();
+    DType* top_data          = out.dptr<DType>();
+    // each ROI is pooled from its level, into its rows of the output
+#pragma omp parallel for num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
+    for (int n = 0; n < num_rois; ++n) {
+      const DType* roi = bottom_rois + n * 5;
+      if (roi[0] < 0) {
+        std::fill(top_data + n * roi_size, top_data + (n + 1) * roi_size, DType(0));
+        continue;
+      }
+      const int l = ROIAlignFPNLevel(
+          roi + 1, num_levels, first_level, param.canonical_scale, param.canonical_level);
+      const TBlob& level = in_data[l + 1];
+      ROIAlignForward<DType>(roi_size,
+                             level.dptr<DType>(),
+                             param.spatial_scales[l],
+                             false,
+                             param.aligned,
+                             channels,
+                             level.size(2),
+                             level.size(3),
+                             pooled_height,
+                             pooled_width,
+                             param.sample_ratio,
+                             roi,
+                             5,
+                             top_data + n * roi_size);
+    }
+  })
+}
+
 DMLC_REGISTER_PARAMETER(ROIAlignParam);
+DMLC_REGISTER_PARAMETER(MultiLevelROIAlignParam);
 
 NNVM_REGISTER_OP(_contrib_ROIAlign)
     .describe(R"code(
@@ -622,6 +675,110 @@ He, Kaiming, et al. "Mask R-CNN." ICCV, 2017
                   "if batchid is less than 0, it will be ignored.")
     .add_arguments(ROIAlignParam::__FIELDS__());
 
+NNVM_REGISTER_OP(_contrib_MultiLevelROIAlign)
+    .describe(R"code(
+ROIAlign over the levels of a feature pyramid, for FPN based detectors such as Mask R-CNN.
+
+Each ROI is assigned to a level as in the FPN paper, the level
+floor(canonical_level + log2(sqrt(w * h) / canonical_scale)) clipped to the levels given,
+and pooled from the feature map of that level. All the ROIs are pooled in one pass into one
+output of shape (num_rois, channels, pooled_size[0], pooled_size[1]), in the order of the
+ROIs, so that the ROIs need not be split and gathered by level around several ROIAlign.
+ROIs of negative batch index give zeros.
+
+The inputs are the ROIs, a 2D array of shape (num_rois, 5) in image coordinates, then the
+feature maps from the finest level, one for each of ``spatial_scales``, which must be
+consecutive levels, e.g. (0.25, 0.125, 0.0625, 0.03125). The feature maps share the batch size
+and the number of channels.
+
+>>> out = mx.nd.contrib.MultiLevelROIAlign(rois, p2, p3, p4, p5, pooled_size=(7, 7),
+...                                        spatial_scales=(0.25, 0.125, 0.0625, 0.03125))
+
+References
+----------
+
+Lin, Tsung-Yi, et al. "Feature Pyramid Networks for Object Detection." CVPR, 2017
+)code" ADD_FILELINE)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      const MultiLevelROIAlignParam& param = nnvm::get<MultiLevelROIAlignParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.spatial_scales.ndim() + 1);
+    })
+    .set_num_outputs(1)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          const MultiLevelROIAlignParam& param = nnvm::get<MultiLevelROIAlignParam>(attrs.parsed);
+          std::vector<std::string> names{"rois"};
+          for (int l = 0; l < param.spatial_scales.ndim(); ++l)
+            names.push_back("data" + std::to_string(l));
+          return names;
+        })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"output"};
+                                      })
+    .set_attr_parser([](nnvm::NodeAttrs* attrs) {
+      ParamParser<MultiLevelROIAlignParam>(attrs);
+      const MultiLevelROIAlignParam& param = nnvm::get<MultiLevelROIAlignParam>(attrs->parsed);
+      const int num_levels                 = param.spatial_scales.ndim();
+      CHECK(num_levels >= 1 && num_levels <= kMaxROIAlignLevels)
+          << "MultiLevelROIAlign supports 1 to " << kMaxROIAlignLevels << " levels";
+      for (int l = 0; l < num_levels; ++l) {
+        CHECK_GT(param.spatial_scales[l], 0.f);
+        CHECK_LE(param.spatial_scales[l], 1.f);
+        if (l > 0) {
+          CHECK_EQ(param.spatial_scales[l - 1], 2 * param.spatial_scales[l])
+              << "spatial_scales should be of consecutive levels, halving from the finest";
+        }
+      }
+    })
+    .set_attr<mxnet::FInferShape>(
+        "FInferShape",
+        [](const nnvm::NodeAttrs& attrs,
+           mxnet::ShapeVector* in_shape,
+           mxnet::ShapeVector* out_shape) {
+          using namespace mshadow;
+          const MultiLevelROIAlignParam& param = nnvm::get<MultiLevelROIAlignParam>(attrs.parsed);
+          CHECK_EQ(in_shape->size(), param.spatial_scales.ndim() + 1)
+              << "Input:[rois, data0, data1, ...]";
+          // rois: [num_rois, 5]
+          const mxnet::TShape& bshape = in_shape->at(0);
+          CHECK_EQ(bshape.ndim(), 2) << "rois should be a 2D tensor of shape [num_rois, 5]";
+          CHECK_EQ(bshape[1], 5) << "rois should be a 2D tensor of shape [num_rois, 5]";
+          // data: [batch_size, c, h, w] for each level
+          const mxnet::TShape& dshape = in_shape->at(1);
+          for (size_t i = 1; i < in_shape->size(); ++i) {
+            const mxnet::TShape& lshape = in_shape->at(i);
+            CHECK_EQ(lshape.ndim(), 4) << "data should be 4D tensors";
+            CHECK(lshape[0] == dshape[0] && lshape[1] == dshape[1])
+                << "The feature maps of all levels should have the same batch size and "
+                   "number of channels";
+          }
+          // out: [num_rois, c, pooled_h, pooled_w]
+          out_shape->clear();
+          out_shape->push_back(
+              Shape4(bshape[0], dshape[1], param.pooled_size[0], param.pooled_size[1]));
+          return true;
+        })
+    .set_attr<nnvm::FInferType>("FInferType",
+                                [](const nnvm::NodeAttrs& attrs,
+                                   std::vector<int>* in_type,
+                                   std::vector<int>* out_type) {
+                                  int dtype = (*in_type)[0];
+                                  CHECK_NE(dtype, -1) << "Input must have specified type";
+                                  for (int t : *in_type)
+                                    CHECK_EQ(dtype, t);
+                                  out_type->clear();
+                                  out_type->push_back(dtype);
+                                  return true;
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", MultiLevelROIAlignForwardCompute<cpu>)
+    .add_argument("data",
+                  "NDArray-or-Symbol[]",
+                  "The ROIs, a 2D array of shape (num_rois, 5), followed by the 4D feature maps "
+                  "of the levels, from the finest.")
+    .add_arguments(MultiLevelROIAlignParam::__FIELDS__());
+
 NNVM_REGISTER_OP(_backward_ROIAlign)
     .set_num_inputs(2)
     .set_num_outputs(2)
@@ -97,6 +97,64 @@ __device__ T bilinear_interpolate(const T* bottom_data,
   return val;
 }
 
+/*!
+ * \brief Average of the bilinear samples of the bin (ph, pw) of the box (x1, y1, x2, y2) of an
+ *        ROI, in one channel of the feature map.
+ */
+template <typename T>
+__device__ T roi_align_bin(const T* bottom_data,
+                           const T* box,
+                           const T spatial_scale,
+                           const bool continuous_coordinate,
+                           const int height,
+                           const int width,
+                           const int ph,
+                           const int pw,
+                           const int pooled_height,
+                           const int pooled_width,
+                           const int sampling_ratio,
+                           const int index) {
+  // Do not using rounding; this implementation detail is critical
+  T roi_offset  = continuous_coordinate ? static_cast<T>(0.5) : static_cast<T>(0);
+  T roi_start_w = box[0] * spatial_scale - roi_offset;
+  T roi_start_h = box[1] * spatial_scale - roi_offset;
+  T roi_end_w   = box[2] * spatial_scale - roi_offset;
+  T roi_end_h   = box[3] * spatial_scale - roi_offset;
+
+  T roi_width  = roi_end_w - roi_start_w;
+  T roi_height = roi_end_h - roi_start_h;
+  if (!continuous_coordinate) {  // backward compatiblity
+    // Force malformed ROIs to be 1x1
+    roi_width  = max(roi_width, (T)1.);
+    roi_height = max(roi_height, (T)1.);
+  }
+  T bin_size_h = static_cast<T>(roi_height) / static_cast<T>(pooled_height);
+  T bin_size_w = static_cast<T>(roi_width) / static_cast<T>(pooled_width);
+
+  // We use roi_bin_grid to sample the grid and mimic integral
+  int roi_bin_grid_h =
+      (sampling_ratio > 0) ? sampling_ratio : ceil(roi_height / pooled_height);  // e.g., = 2
+  int roi_bin_grid_w = (sampling_ratio > 0) ? sampling_ratio : ceil(roi_width / pooled_width);
+
+  // We do average (integral) pooling inside a bin
+  const T count = roi_bin_grid_h * roi_bin_grid_w;  // e.g. = 4
+
+  T output_val = 0.;
+  for (int iy = 0; iy < roi_bin_grid_h; iy++) {  // e.g., iy = 0, 1
+    const T y =
+        roi_start_h + ph * bin_size_h +
+        static_cast<T>(iy + .5f) * bin_size_h / static_cast<T>(roi_bin_grid_h);  // e.g., 0.5, 1.5
+    for (int ix = 0; ix < roi_bin_grid_w; ix++) {
+      const T x = roi_start_w + pw * bin_size_w +
+                  static_cast<T>(ix + .5f) * bin_size_w / static_cast<T>(roi_bin_grid_w);
+
+      T val = bilinear_interpolate(bottom_data, height, width, y, x, index);
+      output_val += val;
+    }
+  }
+  return output_val / count;
+}
+
 template <typename T>
 __global__ void RoIAlignForwardKernel(const int nthreads,
                                       const T* bottom_data,
@@ -126,23 +184,6 @@ __global__ void RoIAlignForwardKernel(const int nthreads,
       continue;
     }
 
-    // Do not using rounding; this implementation detail is critical
-    T roi_offset  = continuous_coordinate ? static_cast<T>(0.5) : static_cast<T>(0);
-    T roi_start_w = offset_bottom_rois[1] * spatial_scale - roi_offset;
-    T roi_start_h = offset_bottom_rois[2] * spatial_scale - roi_offset;
-    T roi_end_w   = offset_bottom_rois[3] * spatial_scale - roi_offset;
-    T roi_end_h   = offset_bottom_rois[4] * spatial_scale - roi_offset;
-
-    T roi_width  = roi_end_w - roi_start_w;
-    T roi_height = roi_end_h - roi_start_h;
-    if (!continuous_coordinate) {  // backward compatiblity
-      // Force malformed ROIs to be 1x1
-      roi_width  = max(roi_width, (T)1.);
-      roi_height = max(roi_height, (T)1.);
-    }
-    T bin_size_h = static_cast<T>(roi_height) / static_cast<T>(pooled_height);
-    T bin_size_w = static_cast<T>(roi_width) / static_cast<T>(pooled_width);
-
     int c_unpooled        = c;
     int channels_unpooled = channels;
     if (position_sensitive) {
@@ -152,30 +193,78 @@ __global__ void RoIAlignForwardKernel(const int nthreads,
     const T* offset_bottom_data =
         bottom_data + (roi_batch_ind * channels_unpooled + c_unpooled) * height * width;
 
-    // We use roi_bin_grid to sample the grid and mimic integral
-    int roi_bin_grid_h =
-        (sampling_ratio > 0) ? sampling_ratio : ceil(roi_height / pooled_height);  // e.g., = 2
-    int roi_bin_grid_w = (sampling_ratio > 0) ? sampling_ratio : ceil(roi_width / pooled_width);
+    top_data[index] = roi_align_bin(offset_bottom_data,
+                                    offset_bottom_rois + 1,
+                                    spatial_scale,
+                                    continuous_coordinate,
+                                    height,
+                                    width,
+                                    ph,
+                                    pw,
+                                    pooled_height,
+                                    pooled_width,
+                                    sampling_ratio,
+                                    index);
+  }
+}
 
-    // We do average (integral) pooling inside a bin
-    const T count = roi_bin_grid_h * roi_bin_grid_w;  // e.g. = 4
+/*! \brief Feature maps of the levels of a pyramid, passed to the kernel by value */
+template <typename T>
+struct ROIAlignLevels {
+  const T* data[kMaxROIAlignLevels];
+  int height[kMaxROIAlignLevels];
+  int width[kMaxROIAlignLevels];
+  T spatial_scale[kMaxROIAlignLevels];
+};
 
-    T output_val = 0.;
-    for (int iy = 0; iy < roi_bin_grid_h; iy++) {  // e.g., iy = 0, 1
-      const T y =
-          roi_start_h + ph * bin_size_h +
-          static_cast<T>(iy + .5f) * bin_size_h / static_cast<T>(roi_bin_grid_h);  // e.g., 0.5, 1.5
-      for (int ix = 0; ix < roi_bin_grid_w; ix++) {
-        const T x = roi_start_w + pw * bin_size_w +
-                    static_cast<T>(ix + .5f) * bin_size_w / static_cast<T>(roi_bin_grid_w);
+template <typename T>
+__global__ void MultiLevelRoIAlignForwardKernel(const int nthreads,
+                                                const ROIAlignLevels<T> levels,
+                                                const int num_levels,
+                                                const int first_level,
+                                                const float canonical_scale,
+                                                const int canonical_level,
+                                                const bool continuous_coordinate,
+                                                const int channels,
+                                                const int pooled_height,
+                                                const int pooled_width,
+                                                const int sampling_ratio,
+                                                const T* bottom_rois,
+                                                T* top_data) {
+  CUDA_KERNEL_LOOP(index, nthreads) {
+    // (n, c, ph, pw) is an element in the pooled output
+    int pw = index % pooled_width;
+    int ph = (index / pooled_width) % pooled_height;
+    int c  = (index / pooled_width / pooled_height) % channels;
+    int n  = index / pooled_width / pooled_height / channels;
 
-        T val = bilinear_interpolate(offset_bottom_data, height, width, y, x, index);
-        output_val += val;
-      }
+    const T* offset_bottom_rois = bottom_rois + n * 5;
+    int roi_batch_ind           = offset_bottom_rois[0];
+
+    if (roi_batch_ind < 0) {
+      top_data[index] = 0.;
+      continue;
     }
-    output_val /= count;
 
-    top_data[index] = output_val;
+    const int l = ROIAlignFPNLevel(
+        offset_bottom_rois + 1, num_levels, first_level, canonical_scale, canonical_level);
+    const int height = levels.height[l];
+    const int width  = levels.width[l];
+    const T* offset_bottom_data =
+        levels.data[l] + (roi_batch_ind * channels + c) * height * width;
+
+    top_data[index] = roi_align_bin(offset_bottom_data,
+                                    offset_bottom_rois + 1,
+                                    levels.spatial_scale[l],
+                                    continuous_coordinate,
+                                    height,
+                                    width,
+                                    ph,
+                                    pw,
+                                    pooled_height,
+                                    pooled_width,
+                                    sampling_ratio,
+                                    index);
   }
 }
 
@@ -439,9 +528,61 @@ void ROIAlignBackwardCompute(const nnvm::NodeAttrs& attrs,
   })
 }
 
+template <typename xpu>
+void MultiLevelROIAlignForwardCompute(const nnvm::NodeAttrs& attrs,
+                                      const OpContext& ctx,
+                                      const std::vector<TBlob>& in_data,
+                                      const std::vector<OpReqType>& req,
+                                      const std::vector<TBlob>& out_data) {
+  using namespace mshadow;
+  const MultiLevelROIAlignParam& param = nnvm::get<MultiLevelROIAlignParam>(attrs.parsed);
+  const int num_levels                 = param.spatial_scales.ndim();
+  CHECK_EQ(in_data.size(), num_levels + 1);
+  CHECK_EQ(out_data.size(), 1U);
+  const TBlob& rois = in_data[0];
+  const TBlob& out  = out_data[0];
+
+  const int count         = out.Size();
+  const int channels      = out.size(1);
+  const int pooled_height = out.size(2);
+  const int pooled_width  = out.size(3);
+  if (count == 0)
+    return;
+
+  Stream<gpu>* s      = ctx.get_stream<gpu>();
+  cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
+  MSHADOW_REAL_TYPE_SWITCH(out.type_flag_, DType, {
+    ROIAlignLevels<DType> levels;
+    for (int l = 0; l < num_levels; ++l) {
+      levels.data[l]          = in_data[l + 1].dptr<DType>();
+      levels.height[l]        = in_data[l + 1].size(2);
+      levels.width[l]         = in_data[l + 1].size(3);
+      levels.spatial_scale[l] = param.spatial_scales[l];
+    }
+    MultiLevelRoIAlignForwardKernel<DType>
+        <<<ROI_GET_BLOCKS(count), kMaxThreadsPerBlock, 0, stream>>>(
+            count,
+            levels,
+            num_levels,
+            ROIAlignFirstLevel(param),
+            param.canonical_scale,
+            param.canonical_level,
+            param.aligned,
+            channels,
+            pooled_height,
+            pooled_width,
+            param.sample_ratio,
+            rois.dptr<DType>(),
+            out.dptr<DType>());
+  })
+}
+
 NNVM_REGISTER_OP(_contrib_ROIAlign)
     .set_attr<FCompute>("FCompute<gpu>", ROIAlignForwardCompute<gpu>);
 
+NNVM_REGISTER_OP(_contrib_MultiLevelROIAlign)
+    .set_attr<FCompute>("FCompute<gpu>", MultiLevelROIAlignForwardCompute<gpu>);
+
 NNVM_REGISTER_OP(_backward_ROIAlign)
     .set_attr<FCompute>("FCompute<gpu>", ROIAlignBackwardCompute<gpu>);
 
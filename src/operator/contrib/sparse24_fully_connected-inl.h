@@ -0,0 +1,230 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file sparse24_fully_connected-inl.h
+ * \brief Fully connected layer with a 2:4 structured sparse weight, stored compressed as the two
+ *        kept values and their positions in every group of four input columns
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_SPARSE24_FULLY_CONNECTED_INL_H_
+#define MXNET_OPERATOR_CONTRIB_SPARSE24_FULLY_CONNECTED_INL_H_
+
+#include <mxnet/operator_util.h>
+#include <cmath>
+#include <vector>
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+#include "../nn/fully_connected-inl.h"
+
+namespace mxnet {
+namespace op {
+
+namespace sparse24 {
+enum Sparse24CompressOpOutputs { kCompressedValues, kCompressedMeta };
+enum Sparse24FullyConnectedOpInputs { kData, kValues, kMeta, kBias };
+enum Sparse24FullyConnectedOpOutputs { kOut };
+// a group of kGroupSize consecutive input columns keeps kKept of them
+constexpr index_t kGroupSize = 4;
+constexpr index_t kKept      = 2;
+}  // namespace sparse24
+
+// above this number of rows of data the weight is decompressed once and multiplied with the GEMM of
+// FullyConnected, below the layer is bound by the weight reads and skips the pruned half
+constexpr index_t kSparse24GemvMaxRows = 32;
+
+struct Sparse24FullyConnectedParam : public dmlc::Parameter<Sparse24FullyConnectedParam> {
+  int num_hidden;
+  bool no_bias;
+  bool flatten;
+  DMLC_DECLARE_PARAMETER(Sparse24FullyConnectedParam) {
+    DMLC_DECLARE_FIELD(num_hidden)
+        .set_lower_bound(1)
+        .describe("Number of hidden nodes of the output.");
+    DMLC_DECLARE_FIELD(no_bias).set_default(false).describe("Whether to disable bias parameter.");
+    DMLC_DECLARE_FIELD(flatten).set_default(true).describe(
+        "Whether to collapse all but the first axis of the input data tensor.");
+  }
+
+  FullyConnectedParam FCParam() const {
+    FullyConnectedParam param;
+    param.num_hidden = num_hidden;
+    param.no_bias    = no_bias;
+    param.flatten    = flatten;
+    return param;
+  }
+};
+
+/*! \brief Position in its group of the j-th kept value, from the metadata byte of the group */
+MSHADOW_XINLINE int Sparse24Index(const uint8_t meta, const int j) {
+  return (meta >> (2 * j)) & 0x3;
+}
+
+/*!
+ * \brief Compresses one group of four weights: keeps the two of largest magnitude, in column order,
+ *        and stores their positions as two 2-bit fields of the metadata byte, the first one low.
+ *        This prunes the weight if it is not already 2:4 sparse.
+ */
+struct sparse24_compress {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t g, DType* values, uint8_t* meta, const DType* weight) {
+    const DType* w = weight + g * sparse24::kGroupSize;
+    // the two largest magnitudes, the lower column wins ties
+    int first = 0, second = 1;
+    float a0 = fabsf(static_cast<float>(w[0])), a1 = fabsf(static_cast<float>(w[1]));
+    if (a1 > a0) {
+      first  = 1;
+      second = 0;
+      const float t = a0;
+      a0            = a1;
+      a1            = t;
+    }
+    for (int k = 2; k < sparse24::kGroupSize; ++k) {
+      const float a = fabsf(static_cast<float>(w[k]));
+      if (a > a0) {
+        second = first;
+        a1     = a0;
+        first  = k;
+        a0     = a;
+      } else if (a > a1) {
+        second = k;
+        a1     = a;
+      }
+    }
+    const int lo                    = first < second ? first : second;
+    const int hi                    = first < second ? second : first;
+    values[g * sparse24::kKept]     = w[lo];
+    values[g * sparse24::kKept + 1] = w[hi];
+    meta[g]                         = static_cast<uint8_t>(lo | (hi << 2));
+  }
+};
+
+struct sparse24_decompress {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t g,
+                                  DType* weight,
+                                  const DType* values,
+                                  const uint8_t* meta) {
+    DType* w = weight + g * sparse24::kGroupSize;
+    for (int k = 0; k < sparse24::kGroupSize; ++k)
+      w[k] = DType(0);
+    w[Sparse24Index(meta[g], 0)] = values[g * sparse24::kKept];
+    w[Sparse24Index(meta[g], 1)] = values[g * sparse24::kKept + 1];
+  }
+};
+
+/*!
+ * \brief out = data * decompress(values, meta)^T (+ bias) for few rows of data, only the kept half
+ *        of the weight is read and multiplied. Implemented in the .cc/.cu.
+ */
+template <typename DType>
+void Sparse24Gemv(mshadow::Stream<cpu>* s,
+                  const DType* data,
+                  const DType* values,
+                  const uint8_t* meta,
+                  const DType* bias,
+                  DType* out,
+                  const OpReqType req,
+                  const index_t num_rows,
+                  const index_t num_hidden,
+                  const index_t num_input);
+
+template <typename DType>
+void Sparse24Gemv(mshadow::Stream<gpu>* s,
+                  const DType* data,
+                  const DType* values,
+                  const uint8_t* meta,
+                  const DType* bias,
+                  DType* out,
+                  const OpReqType req,
+                  const index_t num_rows,
+                  const index_t num_hidden,
+                  const index_t num_input);
+
+template <typename xpu>
+void Sparse24CompressCompute(const nnvm::NodeAttrs& attrs,
+                             const OpContext& ctx,
+                             const std::vector<TBlob>& inputs,
+                             const std::vector<OpReqType>& req,
+                             const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  CHECK_EQ(inputs.size(), 1U);
+  CHECK_EQ(outputs.size(), 2U);
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    Kernel<sparse24_compress, xpu>::Launch(s,
+                                           outputs[sparse24::kCompressedMeta].Size(),
+                                           outputs[sparse24::kCompressedValues].dptr<DType>(),
+                                           outputs[sparse24::kCompressedMeta].dptr<uint8_t>(),
+                                           inputs[0].dptr<DType>());
+  });
+}
+
+template <typename xpu>
+void Sparse24FullyConnectedForward(const nnvm::NodeAttrs& attrs,
+                                   const OpContext& ctx,
+                                   const std::vector<TBlob>& inputs,
+                                   const std::vector<OpReqType>& req,
+                                   const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  const Sparse24FullyConnectedParam& param = nnvm::get<Sparse24FullyConnectedParam>(attrs.parsed);
+  CHECK_EQ(inputs.size(), param.no_bias ? 3U : 4U);
+  CHECK_EQ(outputs.size(), 1U);
+  if (req[sparse24::kOut] == kNullOp)
+    return;
+  Stream<xpu>* s           = ctx.get_stream<xpu>();
+  const TBlob& values      = inputs[sparse24::kValues];
+  const TBlob& meta        = inputs[sparse24::kMeta];
+  const index_t num_hidden = param.num_hidden;
+  MSHADOW_REAL_TYPE_SWITCH(inputs[sparse24::kData].type_flag_, DType, {
+    Tensor<xpu, 2, DType> data = param.flatten ?
+                                     FlattenAs2DTail<xpu, DType>(inputs[sparse24::kData], ctx) :
+                                     FlattenAs2DHead<xpu, DType>(inputs[sparse24::kData], ctx);
+    Tensor<xpu, 2, DType> out  = param.flatten ?
+                                    FlattenAs2DTail<xpu, DType>(outputs[sparse24::kOut], ctx) :
+                                    FlattenAs2DHead<xpu, DType>(outputs[sparse24::kOut], ctx);
+    const index_t num_input    = data.shape_[1];
+    if (data.shape_[0] <= kSparse24GemvMaxRows) {
+      Sparse24Gemv(s,
+                   data.dptr_,
+                   values.dptr<DType>(),
+                   meta.dptr<uint8_t>(),
+                   param.no_bias ? nullptr : inputs[sparse24::kBias].dptr<DType>(),
+                   out.dptr_,
+                   req[sparse24::kOut],
+                   data.shape_[0],
+                   num_hidden,
+                   num_input);
+      return;
+    }
+    // large batches are compute bound, the weight is decompressed into the temporary space
+    Tensor<xpu, 2, DType> weight =
+        ctx.requested[0].get_space_typed<xpu, 2, DType>(Shape2(num_hidden, num_input), s);
+    Kernel<sparse24_decompress, xpu>::Launch(
+        s, meta.Size(), weight.dptr_, values.dptr<DType>(), meta.dptr<uint8_t>());
+    std::vector<TBlob> fc_inputs{inputs[sparse24::kData], TBlob(weight)};
+    if (!param.no_bias)
+      fc_inputs.push_back(inputs[sparse24::kBias]);
+    FCForward<xpu, DType>(ctx, param.FCParam(), fc_inputs, req, outputs);
+  });
+}
+
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_OPERATOR_CONTRIB_SPARSE24_FULLY_CONNECTED_INL_H_
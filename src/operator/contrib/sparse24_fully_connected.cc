@@ -0,0 +1,381 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file sparse24_fully_connected.cc
+ * \brief Fully connected layer with a 2:4 structured sparse weight, and the Sparse24 graph pass
+ *        compressing the weights of FullyConnected for optimize_for
+ */
+#include <mxnet/ndarray.h>
+#include <nnvm/graph.h>
+#include <nnvm/pass.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "./sparse24_fully_connected-inl.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(Sparse24FullyConnectedParam);
+
+template <typename DType>
+void Sparse24Gemv(mshadow::Stream<cpu>* s,
+                  const DType* data,
+                  const DType* values,
+                  const uint8_t* meta,
+                  const DType* bias,
+                  DType* out,
+                  const OpReqType req,
+                  const index_t num_rows,
+                  const index_t num_hidden,
+                  const index_t num_input) {
+  const int nthreads       = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  const index_t num_groups = num_input / sparse24::kGroupSize;
+  // each thread multiplies the compressed rows of its outputs with all the data rows
+#pragma omp parallel for num_threads(nthreads)
+  for (index_t n = 0; n < num_hidden; ++n) {
+    const DType* v    = values + n * num_groups * sparse24::kKept;
+    const uint8_t* mt = meta + n * num_groups;
+    for (index_t m = 0; m < num_rows; ++m) {
+      const DType* x = data + m * num_input;
+      float acc      = bias ? static_cast<float>(bias[n]) : 0.f;
+      for (index_t g = 0; g < num_groups; ++g) {
+        const DType* xg = x + g * sparse24::kGroupSize;
+        acc += static_cast<float>(v[2 * g]) * static_cast<float>(xg[Sparse24Index(mt[g], 0)]);
+        acc += static_cast<float>(v[2 * g + 1]) * static_cast<float>(xg[Sparse24Index(mt[g], 1)]);
+      }
+      KERNEL_ASSIGN(out[m * num_hidden + n], req, static_cast<DType>(acc));
+    }
+  }
+}
+
+static bool Sparse24CompressShape(const nnvm::NodeAttrs& attrs,
+                                  mxnet::ShapeVector* in_shape,
+                                  mxnet::ShapeVector* out_shape) {
+  CHECK_EQ(in_shape->size(), 1U);
+  CHECK_EQ(out_shape->size(), 2U);
+  const mxnet::TShape& wshape = (*in_shape)[0];
+  if (!mxnet::ndim_is_known(wshape))
+    return false;
+  CHECK_EQ(wshape.ndim(), 2U) << "sparse24_compress expects a (num_hidden, num_input) weight";
+  if (!mxnet::shape_is_known(wshape))
+    return false;
+  CHECK_EQ(wshape[1] % sparse24::kGroupSize, 0)
+      << "sparse24_compress needs a number of input columns divisible by 4, got " << wshape[1];
+  const index_t num_groups = wshape[1] / sparse24::kGroupSize;
+  SHAPE_ASSIGN_CHECK(*out_shape,
+                     sparse24::kCompressedValues,
+                     mshadow::Shape2(wshape[0], num_groups * sparse24::kKept));
+  SHAPE_ASSIGN_CHECK(*out_shape, sparse24::kCompressedMeta, mshadow::Shape2(wshape[0], num_groups));
+  return true;
+}
+
+static bool Sparse24CompressType(const nnvm::NodeAttrs& attrs,
+                                 std::vector<int>* in_type,
+                                 std::vector<int>* out_type) {
+  CHECK_EQ(in_type->size(), 1U);
+  CHECK_EQ(out_type->size(), 2U);
+  TYPE_ASSIGN_CHECK(*out_type, sparse24::kCompressedMeta, mshadow::kUint8);
+  const int dtype = (*in_type)[0];
+  if (dtype == -1)
+    return false;
+  TYPE_ASSIGN_CHECK(*out_type, sparse24::kCompressedValues, dtype);
+  return true;
+}
+
+static bool Sparse24FullyConnectedShape(const nnvm::NodeAttrs& attrs,
+                                        mxnet::ShapeVector* in_shape,
+                                        mxnet::ShapeVector* out_shape) {
+  const Sparse24FullyConnectedParam& param = nnvm::get<Sparse24FullyConnectedParam>(attrs.parsed);
+  CHECK_EQ(in_shape->size(), param.no_bias ? 3U : 4U);
+  CHECK_EQ(out_shape->size(), 1U);
+  const mxnet::TShape& dshape = (*in_shape)[sparse24::kData];
+  if (!mxnet::shape_is_known(dshape))
+    return false;
+  const index_t num_input =
+      param.flatten ? dshape.ProdShape(1, dshape.ndim()) : dshape[dshape.ndim() - 1];
+  CHECK_EQ(num_input % sparse24::kGroupSize, 0)
+      << "sparse24_fully_connected needs a number of input columns divisible by 4, got "
+      << num_input;
+  const index_t num_groups = num_input / sparse24::kGroupSize;
+  SHAPE_ASSIGN_CHECK(*in_shape,
+                     sparse24::kValues,
+                     mshadow::Shape2(param.num_hidden, num_groups * sparse24::kKept));
+  SHAPE_ASSIGN_CHECK(*in_shape, sparse24::kMeta, mshadow::Shape2(param.num_hidden, num_groups));
+  if (!param.no_bias) {
+    SHAPE_ASSIGN_CHECK(*in_shape, sparse24::kBias, mshadow::Shape1(param.num_hidden));
+  }
+  if (param.flatten) {
+    SHAPE_ASSIGN_CHECK(*out_shape, sparse24::kOut, mshadow::Shape2(dshape[0], param.num_hidden));
+  } else {
+    mxnet::TShape oshape(dshape);
+    oshape[dshape.ndim() - 1] = param.num_hidden;
+    SHAPE_ASSIGN_CHECK(*out_shape, sparse24::kOut, oshape);
+  }
+  return true;
+}
+
+static bool Sparse24FullyConnectedType(const nnvm::NodeAttrs& attrs,
+                                       std::vector<int>* in_type,
+                                       std::vector<int>* out_type) {
+  const Sparse24FullyConnectedParam& param = nnvm::get<Sparse24FullyConnectedParam>(attrs.parsed);
+  CHECK_EQ(in_type->size(), param.no_bias ? 3U : 4U);
+  CHECK_EQ(out_type->size(), 1U);
+  TYPE_ASSIGN_CHECK(*in_type, sparse24::kMeta, mshadow::kUint8);
+  int dtype = (*in_type)[sparse24::kData];
+  if (dtype == -1)
+    dtype = (*out_type)[sparse24::kOut];
+  if (dtype == -1)
+    return false;
+  TYPE_ASSIGN_CHECK(*in_type, sparse24::kData, dtype);
+  TYPE_ASSIGN_CHECK(*in_type, sparse24::kValues, dtype);
+  if (!param.no_bias) {
+    TYPE_ASSIGN_CHECK(*in_type, sparse24::kBias, dtype);
+  }
+  TYPE_ASSIGN_CHECK(*out_type, sparse24::kOut, dtype);
+  return true;
+}
+
+NNVM_REGISTER_OP(_contrib_sparse24_compress)
+    .add_alias("_npx_sparse24_compress")
+    .describe(R"code(Compresses a fully connected weight to the 2:4 structured sparse format.
+
+Every group of 4 consecutive columns of the (num_hidden, num_input) weight keeps its 2 values of
+largest magnitude, which prunes the weight if it is not already 2:4 sparse. Outputs the kept
+values, of shape (num_hidden, num_input / 2), and one uint8 per group holding the positions of the
+two values in the group, of shape (num_hidden, num_input / 4).
+)code" ADD_FILELINE)
+    .set_num_inputs(1)
+    .set_num_outputs(2)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"weight"};
+                                     })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"values", "meta"};
+                                      })
+    .set_attr<mxnet::FInferShape>("FInferShape", Sparse24CompressShape)
+    .set_attr<nnvm::FInferType>("FInferType", Sparse24CompressType)
+    .set_attr<FCompute>("FCompute<cpu>", Sparse24CompressCompute<cpu>)
+    .add_argument("weight", "NDArray-or-Symbol", "Weight matrix to compress.");
+
+NNVM_REGISTER_OP(_contrib_sparse24_fully_connected)
+    .add_alias("_npx_sparse24_fully_connected")
+    .describe(R"code(Fully connected layer with a weight compressed by sparse24_compress.
+
+Only the kept half of the weight is read and multiplied, with the metadata gathering the matching
+data columns, so the layer reads about half the weight bytes of FullyConnected. This is where the
+time goes at small batch sizes. Above 32 rows of data the weight is decompressed once and
+multiplied with the GEMM of FullyConnected.
+
+The ``Sparse24`` backend of ``optimize_for`` replaces FullyConnected layers with this operator and
+compresses their weights.
+
+Inference only.
+)code" ADD_FILELINE)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      const Sparse24FullyConnectedParam& params =
+          nnvm::get<Sparse24FullyConnectedParam>(attrs.parsed);
+      return params.no_bias ? 3 : 4;
+    })
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<Sparse24FullyConnectedParam>)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          const Sparse24FullyConnectedParam& params =
+              nnvm::get<Sparse24FullyConnectedParam>(attrs.parsed);
+          if (params.no_bias)
+            return std::vector<std::string>{"data", "values", "meta"};
+          return std::vector<std::string>{"data", "values", "meta", "bias"};
+        })
+    .set_attr<mxnet::FInferShape>("FInferShape", Sparse24FullyConnectedShape)
+    .set_attr<nnvm::FInferType>("FInferType", Sparse24FullyConnectedType)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", Sparse24FullyConnectedForward<cpu>)
+    .add_argument("data", "NDArray-or-Symbol", "Input data.")
+    .add_argument("values", "NDArray-or-Symbol", "Kept values of the weight.")
+    .add_argument("meta", "NDArray-or-Symbol", "uint8 positions of the kept values.")
+    .add_argument("bias", "NDArray-or-Symbol", "Bias parameter.")
+    .add_arguments(Sparse24FullyConnectedParam::__FIELDS__());
+
+/*!
+ * \brief Compresses a weight on the cpu, returns false without writing anything when it is not
+ *        2:4 sparse and prune is not set.
+ */
+template <typename DType>
+static bool Sparse24CompressWeight(const DType* weight,
+                                   const index_t num_groups,
+                                   const bool prune,
+                                   DType* values,
+                                   uint8_t* meta) {
+  if (!prune) {
+    for (index_t g = 0; g < num_groups; ++g) {
+      int nonzeros = 0;
+      for (index_t k = 0; k < sparse24::kGroupSize; ++k)
+        nonzeros += static_cast<float>(weight[g * sparse24::kGroupSize + k]) != 0.f;
+      if (nonzeros > sparse24::kKept)
+        return false;
+    }
+  }
+  for (index_t g = 0; g < num_groups; ++g)
+    sparse24_compress::Map(g, values, meta, weight);
+  return true;
+}
+
+/*!
+ * \brief Compresses the weight argument of optimize_for named weight_name into two new arguments
+ *        on its context, and returns the variables of the values and the metadata.
+ */
+static bool Sparse24CompressArg(const std::string& weight_name,
+                                const NDArray& weight,
+                                const bool prune,
+                                std::vector<nnvm::NodeEntry>* vars,
+                                std::vector<NDArray*>* new_args,
+                                std::vector<std::string>* new_arg_names) {
+  if (weight.shape().ndim() != 2 || weight.shape()[1] % sparse24::kGroupSize != 0)
+    return false;
+  if (weight.dtype() != mshadow::kFloat32 && weight.dtype() != mshadow::kFloat16 &&
+      weight.dtype() != mshadow::kFloat64)
+    return false;
+  const index_t num_hidden = weight.shape()[0];
+  const index_t num_groups = weight.shape()[1] / sparse24::kGroupSize;
+  NDArray values(mshadow::Shape2(num_hidden, num_groups * sparse24::kKept),
+                 weight.ctx(),
+                 false,
+                 weight.dtype());
+  NDArray meta(mshadow::Shape2(num_hidden, num_groups), weight.ctx(), false, mshadow::kUint8);
+  bool compressed = false;
+  MSHADOW_REAL_TYPE_SWITCH(weight.dtype(), DType, {
+    std::vector<DType> w(weight.shape().Size());
+    std::vector<DType> v(values.shape().Size());
+    std::vector<uint8_t> mt(meta.shape().Size());
+    weight.SyncCopyToCPU(w.data(), w.size());
+    compressed = Sparse24CompressWeight(w.data(), num_hidden * num_groups, prune, v.data(),
+                                        mt.data());
+    if (compressed) {
+      values.SyncCopyFromCPU(v.data(), v.size());
+      meta.SyncCopyFromCPU(mt.data(), mt.size());
+    }
+  });
+  if (!compressed)
+    return false;
+  for (const auto& arg : {std::make_pair(std::string("_sparse24_values"), values),
+                          std::make_pair(std::string("_sparse24_meta"), meta)}) {
+    nnvm::ObjectPtr var = nnvm::Node::Create();
+    var->attrs.name     = weight_name + arg.first;
+    vars->emplace_back(var, 0, 0);
+    // released by the frontend, which takes the handles of the new arguments
+    new_args->push_back(new NDArray(arg.second));
+    new_arg_names->push_back(var->attrs.name);
+  }
+  return true;
+}
+
+/*!
+ * \brief Replaces the FullyConnected nodes whose weight is an argument given to optimize_for, of a
+ *        number of columns divisible by 4, with _contrib_sparse24_fully_connected. The compressed
+ *        weights are returned as new arguments named <weight>_sparse24_values/_meta. Only the
+ *        weights already 2:4 sparse are converted, unless the option prune is True.
+ */
+nnvm::Graph Sparse24Pass(nnvm::Graph&& g) {
+  using nnvm::NodeEntry;
+  using nnvm::ObjectPtr;
+  const auto& options = g.GetAttr<std::unordered_map<std::string, std::string>>("options_map");
+  const auto it_prune = options.find("prune");
+  const bool prune    = it_prune != options.end() && it_prune->second == "True";
+  NDArray** in_args   = g.GetAttr<NDArray**>("in_args");
+  const auto& in_arg_names = g.GetAttr<std::vector<std::string>>("in_arg_names");
+  std::unordered_map<std::string, NDArray*> args;
+  for (size_t i = 0; in_args != nullptr && i < in_arg_names.size(); ++i)
+    args[in_arg_names[i]] = in_args[i];
+  if (args.empty())
+    LOG(WARNING) << "Sparse24 needs the arguments of optimize_for to compress the weights";
+
+  std::vector<NDArray*> new_args;
+  std::vector<std::string> new_arg_names;
+  // variables of the compressed weights, shared by the layers sharing a weight
+  std::unordered_map<std::string, std::vector<NodeEntry>> compressed;
+  const nnvm::Op* fc_op = Op::Get("FullyConnected");
+  // the graph is copied, the nodes belong to the symbol optimize_for was called on
+  std::unordered_map<nnvm::Node*, ObjectPtr> mirror_map;
+  auto mirror = [&](const NodeEntry& e) {
+    return NodeEntry{mirror_map.at(e.node.get()), e.index, e.version};
+  };
+  DFSVisit(g.outputs, [&](const ObjectPtr& node) {
+    ObjectPtr new_node = nnvm::Node::Create();
+    *new_node          = *node;
+    for (NodeEntry& e : new_node->inputs)
+      e = mirror(e);
+    for (ObjectPtr& dep : new_node->control_deps)
+      dep = mirror_map.at(dep.get());
+    mirror_map[node.get()] = new_node;
+    if (node->op() != fc_op || !node->inputs[fullc::kWeight].node->is_variable())
+      return;
+    const std::string& weight_name = node->inputs[fullc::kWeight].node->attrs.name;
+    const auto it_weight           = args.find(weight_name);
+    if (it_weight == args.end())
+      return;
+    auto it_compressed = compressed.find(weight_name);
+    if (it_compressed == compressed.end()) {
+      std::vector<NodeEntry> vars;
+      if (!Sparse24CompressArg(weight_name, *it_weight->second, prune, &vars, &new_args,
+                               &new_arg_names)) {
+        LOG(INFO) << "Sparse24 skips " << node->attrs.name << ", its weight " << weight_name
+                  << " is not a floating point matrix of a number of columns divisible by 4, "
+                  << "or is not 2:4 sparse (pass prune=True to prune it)";
+        return;
+      }
+      it_compressed = compressed.emplace(weight_name, std::move(vars)).first;
+    }
+    const FullyConnectedParam& fc_param = nnvm::get<FullyConnectedParam>(node->attrs.parsed);
+    new_node->attrs.op                  = Op::Get("_contrib_sparse24_fully_connected");
+    new_node->attrs.dict.clear();
+    new_node->attrs.dict["num_hidden"] = std::to_string(fc_param.num_hidden);
+    new_node->attrs.dict["no_bias"]    = fc_param.no_bias ? "True" : "False";
+    new_node->attrs.dict["flatten"]    = fc_param.flatten ? "True" : "False";
+    new_node->op()->attr_parser(&(new_node->attrs));
+    std::vector<NodeEntry> inputs{new_node->inputs[fullc::kData]};
+    inputs.insert(inputs.end(), it_compressed->second.begin(), it_compressed->second.end());
+    if (!fc_param.no_bias)
+      inputs.push_back(new_node->inputs[fullc::kBias]);
+    new_node->inputs = std::move(inputs);
+  });
+  for (NodeEntry& e : g.outputs)
+    e = mirror(e);
+
+  g.attrs["new_args"]      = std::make_shared<nnvm::any>(new_args);
+  g.attrs["new_arg_names"] = std::make_shared<nnvm::any>(new_arg_names);
+  g.attrs["new_aux"]       = std::make_shared<nnvm::any>(std::vector<NDArray*>());
+  g.attrs["new_aux_names"] = std::make_shared<nnvm::any>(std::vector<std::string>());
+  return std::move(g);
+}
+
+NNVM_REGISTER_PASS(Sparse24)
+    .describe("replace FullyConnected with a 2:4 structured sparse fully connected")
+    .set_body(Sparse24Pass)
+    .set_change_graph(true);
+
+}  // namespace op
+}  // namespace mxnet
@@ -0,0 +1,113 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file sparse24_fully_connected.cu
+ * \brief Fully connected layer with a 2:4 structured sparse weight, stored compressed as the two
+ *        kept values and their positions in every group of four input columns
+ */
+#include "./sparse24_fully_connected-inl.h"
+#include "../../common/cuda/utils.h"
+
+namespace mxnet {
+namespace op {
+
+constexpr int kSparse24WarpsPerBlock = 4;
+// rows of data accumulated by a warp, each compressed row is read ceil(num_rows / kRows) times
+constexpr int kSparse24RowsPerWarp = 8;
+
+// one warp per output column n, its lanes stride over the groups of the compressed row of n and
+// gather the two data columns of each group for kSparse24RowsPerWarp rows of data
+template <typename DType>
+__global__ void Sparse24GemvKernel(const DType* data,
+                                   const DType* values,
+                                   const uint8_t* meta,
+                                   const DType* bias,
+                                   DType* out,
+                                   const OpReqType req,
+                                   const index_t num_rows,
+                                   const index_t num_hidden,
+                                   const index_t num_input) {
+  using common::cuda::warp_size;
+  const index_t n =
+      static_cast<index_t>(blockIdx.x) * kSparse24WarpsPerBlock + threadIdx.x / warp_size;
+  const int lane     = threadIdx.x % warp_size;
+  const index_t row0 = static_cast<index_t>(blockIdx.y) * kSparse24RowsPerWarp;
+  if (n >= num_hidden)
+    return;
+  const index_t num_groups = num_input / sparse24::kGroupSize;
+  const DType* v           = values + n * num_groups * sparse24::kKept;
+  const uint8_t* mt        = meta + n * num_groups;
+  const DType* x           = data + row0 * num_input;
+  const index_t nrows      = min(static_cast<index_t>(kSparse24RowsPerWarp), num_rows - row0);
+  float acc[kSparse24RowsPerWarp];
+#pragma unroll
+  for (int r = 0; r < kSparse24RowsPerWarp; ++r)
+    acc[r] = 0.f;
+  for (index_t g = lane; g < num_groups; g += warp_size) {
+    const float v0   = static_cast<float>(v[g * sparse24::kKept]);
+    const float v1   = static_cast<float>(v[g * sparse24::kKept + 1]);
+    const index_t k0 = g * sparse24::kGroupSize + Sparse24Index(mt[g], 0);
+    const index_t k1 = g * sparse24::kGroupSize + Sparse24Index(mt[g], 1);
+#pragma unroll
+    for (int r = 0; r < kSparse24RowsPerWarp; ++r) {
+      if (r < nrows) {
+        acc[r] += static_cast<float>(x[r * num_input + k0]) * v0 +
+                  static_cast<float>(x[r * num_input + k1]) * v1;
+      }
+    }
+  }
+#pragma unroll
+  for (int r = 0; r < kSparse24RowsPerWarp; ++r) {
+    const float sum = common::cuda::warp_reduce(acc[r], [](float a, float b) { return a + b; });
+    if (lane == 0 && r < nrows) {
+      const float val = bias ? sum + static_cast<float>(bias[n]) : sum;
+      KERNEL_ASSIGN(out[(row0 + r) * num_hidden + n], req, static_cast<DType>(val));
+    }
+  }
+}
+
+template <typename DType>
+void Sparse24Gemv(mshadow::Stream<gpu>* s,
+                  const DType* data,
+                  const DType* values,
+                  const uint8_t* meta,
+                  const DType* bias,
+                  DType* out,
+                  const OpReqType req,
+                  const index_t num_rows,
+                  const index_t num_hidden,
+                  const index_t num_input) {
+  cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
+  const dim3 blocks((num_hidden + kSparse24WarpsPerBlock - 1) / kSparse24WarpsPerBlock,
+                    (num_rows + kSparse24RowsPerWarp - 1) / kSparse24RowsPerWarp);
+  const int threads = kSparse24WarpsPerBlock * common::cuda::warp_size;
+  Sparse24GemvKernel<<<blocks, threads, 0, stream>>>(
+      data, values, meta, bias, out, req, num_rows, num_hidden, num_input);
+  MSHADOW_CUDA_POST_KERNEL_CHECK(Sparse24GemvKernel);
+}
+
+NNVM_REGISTER_OP(_contrib_sparse24_compress)
+    .set_attr<FCompute>("FCompute<gpu>", Sparse24CompressCompute<gpu>);
+
+NNVM_REGISTER_OP(_contrib_sparse24_fully_connected)
+    .set_attr<FCompute>("FCompute<gpu>", Sparse24FullyConnectedForward<gpu>);
+
+}  // namespace op
+}  // namespace mxnet
@@ -45,6 +45,24 @@ enum BatchNormOpAuxiliary { kMovingMean, kMovingVar };
 enum BatchNormBackResource { kTempSpace };
 }  // namespace syncbatchnorm
 
+/*!
+ * \brief Whether the statistics are summed across the group with NCCL on the stream of the
+ *        operator, instead of on the host by the threads of the devices of this process.
+ */
+template <typename xpu>
+bool UseNCCLSync();
+
+/*!
+ * \brief Sum the packed statistics in place across the devices of the group of the layer key, the
+ *        ndev devices of this process or of every node with MXNET_SYNC_BN_NUM_NODES > 1, on the
+ *        operator stream.
+ */
+template <typename xpu>
+void NCCLAllReduceStats(const OpContext& ctx,
+                        const std::string& key,
+                        int ndev,
+                        mshadow::Tensor<xpu, 1, real_t> stats);
+
 struct SyncBatchNormParam : public dmlc::Parameter<SyncBatchNormParam> {
   float eps;
   float momentum;
@@ -302,34 +320,28 @@ class SyncBatchNorm : public Operator {
 
     // whether use global statistics
     if (ctx.is_train && !param_.use_global_stats) {
-      // get my rank
-      Barrier* global_barrier = global_shared_barrier_forward.Register(param_.key, param_.ndev);
-      int myRank              = global_shared_rank_forward.Register(param_.key, param_.ndev);
       // get the mean and var
       Tensor<xpu, 1> mean = out_data[syncbatchnorm::kMean].get<xpu, 1, real_t>(s);
       Tensor<xpu, 1> var  = out_data[syncbatchnorm::kVar].get<xpu, 1, real_t>(s);
       CHECK(req[syncbatchnorm::kMean] == kNullOp || req[syncbatchnorm::kMean] == kWriteTo);
       CHECK(req[syncbatchnorm::kVar] == kNullOp || req[syncbatchnorm::kVar] == kWriteTo);
-      // E(x) and E(x^2)
-      mean = scale * sumall_except_dim<1>(data);
-      var  = scale * sumall_except_dim<1>(F<mshadow_op::square>(data));
-      SharedND<mshadow::Tensor<cpu, 1, real_t>>* sharedMean =
-          global_shared_mean.Register(param_.key, param_.ndev);
-      SharedND<mshadow::Tensor<cpu, 1, real_t>>* sharedVar =
-          global_shared_var.Register(param_.key, param_.ndev);
-      // copy to cpu, push and pull
-      Tensor<cpu, 1, real_t>* mean_cpu_ptr = sharedMean->Retrieve(mean.shape_, myRank);
-      Tensor<cpu, 1, real_t>* var_cpu_ptr  = sharedVar->Retrieve(mean.shape_, myRank);
-      mshadow::Copy(*mean_cpu_ptr, mean, s);
-      mshadow::Copy(*var_cpu_ptr, var, s);
-      sharedMean->SetReady(myRank);
-      sharedVar->SetReady(myRank);
-      global_barrier->Wait();
-      Tensor<cpu, 1, real_t> mean_cpu = sharedMean->Pop(myRank);
-      Tensor<cpu, 1, real_t> var_cpu  = sharedVar->Pop(myRank);
-      // copy back to gpu
-      mshadow::Copy(mean, mean_cpu, s);
-      mshadow::Copy(var, var_cpu, s);
+      if (UseNCCLSync<xpu>()) {
+        // one allreduce of (sum, sum of squares, count), devices may have different batch sizes
+        const index_t channels = mean.shape_[0];
+        Tensor<xpu, 1> stats   = ctx.requested[syncbatchnorm::kTempSpace].get_space<xpu>(
+            Shape1(2 * channels + 1), s);
+        Tensor<xpu, 1> sum    = stats.Slice(0, channels);
+        Tensor<xpu, 1> sum_sq = stats.Slice(channels, 2 * channels);
+        Tensor<xpu, 1> count  = stats.Slice(2 * channels, 2 * channels + 1);
+        sum                   = sumall_except_dim<1>(data);
+        sum_sq                = sumall_except_dim<1>(F<mshadow_op::square>(data));
+        count                 = 1.0f / scale;
+        NCCLAllReduceStats(ctx, param_.key, param_.ndev, stats);
+        mean = sum / broadcast_scalar(count, mean.shape_);
+        var  = sum_sq / broadcast_scalar(count, var.shape_);
+      } else {
+        SyncMeanOnHost(s, &mean, &var, scale, data);
+      }
 
       var = var - F<mshadow_op::square>(mean);
       Assign(out,
@@ -397,12 +409,9 @@ class SyncBatchNorm : public Operator {
       slope = 1.f;
 
     if (ctx.is_train && !param_.use_global_stats) {
-      // get my rank
-      Barrier* global_barrier = global_shared_barrier_backward.Register(param_.key, param_.ndev);
-      int myRank              = global_shared_rank_backward.Register(param_.key, param_.ndev);
       // get requested temp space
       Tensor<xpu, 2> workspace = ctx.requested[syncbatchnorm::kTempSpace].get_space<xpu>(
-          mshadow::Shape2(5, mean.shape_[0]), s);
+          mshadow::Shape2(6, mean.shape_[0]), s);
       Tensor<xpu, 1> gmean = workspace[0];
       Tensor<xpu, 1> gvar  = workspace[1];
 
@@ -413,23 +422,21 @@ class SyncBatchNorm : public Operator {
       Tensor<xpu, 1> sumProd = workspace[4];
       sumGrad                = sumall_except_dim<1>(grad);
       sumProd = sumall_except_dim<1>(grad * (data - broadcast<1>(mean, data.shape_)));
-      SharedND<mshadow::Tensor<cpu, 1, real_t>>* sharedGrad =
-          global_shared_grad.Register(param_.key, param_.ndev);
-      SharedND<mshadow::Tensor<cpu, 1, real_t>>* sharedProd =
-          global_shared_prod.Register(param_.key, param_.ndev);
-      // copy to cpu, push and pull
-      Tensor<cpu, 1, real_t>* grad_cpu_ptr = sharedGrad->Retrieve(sumGrad.shape_, myRank);
-      Tensor<cpu, 1, real_t>* prod_cpu_ptr = sharedProd->Retrieve(sumGrad.shape_, myRank);
-      mshadow::Copy(*grad_cpu_ptr, sumGrad, s);
-      mshadow::Copy(*prod_cpu_ptr, sumProd, s);
-      sharedGrad->SetReady(myRank);
-      sharedProd->SetReady(myRank);
-      global_barrier->Wait();
-      Tensor<cpu, 1, real_t> grad_cpu = sharedGrad->Pop(myRank);
-      Tensor<cpu, 1, real_t> prod_cpu = sharedProd->Pop(myRank);
-      // copy back to gpu
-      mshadow::Copy(sumGrad, grad_cpu, s);
-      mshadow::Copy(sumProd, prod_cpu, s);
+      if (UseNCCLSync<xpu>()) {
+        // rows 3 and 4 and the count after them are allreduced together
+        Tensor<xpu, 1> count = workspace[5].Slice(0, 1);
+        count                = 1.0f / scale;
+        NCCLAllReduceStats(ctx,
+                           param_.key,
+                           param_.ndev,
+                           Tensor<xpu, 1>(sumGrad.dptr_, Shape1(2 * sumGrad.size(0) + 1), s));
+        sumGrad /= broadcast_scalar(count, sumGrad.shape_);
+        sumProd /= broadcast_scalar(count, sumProd.shape_);
+      } else {
+        SyncGradOnHost(s, &sumGrad, &sumProd);
+        sumGrad *= scale;
+        sumProd *= scale;
+      }
 
       gvar  = -1.0f * sumProd * slope * F<mshadow_op::power>(var + param_.eps, -1.5f);
       gmean = sumGrad * slope;
@@ -449,8 +456,8 @@ class SyncBatchNorm : public Operator {
           req[syncbatchnorm::kData],
           (grad * broadcast<1>(slope, data.shape_)) *
                   broadcast<1>(1.0f / F<mshadow_op::square_root>(var + param_.eps), data.shape_) +
-              broadcast<1>(gvar, data.shape_) * scale * (data - broadcast<1>(mean, data.shape_)) +
-              broadcast<1>(gmean, data.shape_) * scale);
+              broadcast<1>(gvar, data.shape_) * (data - broadcast<1>(mean, data.shape_)) +
+              broadcast<1>(gmean, data.shape_));
       Assign(gbias, req[syncbatchnorm::kBeta], sumall_except_dim<1>(grad));
     } else {
       // use global statistics with freeze moving mean and var.
@@ -473,6 +480,70 @@ class SyncBatchNorm : public Operator {
   }
 
  private:
+  /*! \brief E(x) and E(x^2) averaged over the devices of this process by their threads */
+  void SyncMeanOnHost(mshadow::Stream<xpu>* s,
+                      mshadow::Tensor<xpu, 1>* p_mean,
+                      mshadow::Tensor<xpu, 1>* p_var,
+                      const real_t scale,
+                      const mshadow::Tensor<xpu, 4>& data) {
+    using namespace mshadow;
+    using namespace mshadow::expr;
+    Tensor<xpu, 1>& mean = *p_mean;
+    Tensor<xpu, 1>& var  = *p_var;
+    // get my rank
+    Barrier* global_barrier = global_shared_barrier_forward.Register(param_.key, param_.ndev);
+    int myRank              = global_shared_rank_forward.Register(param_.key, param_.ndev);
+    // E(x) and E(x^2)
+    mean = scale * sumall_except_dim<1>(data);
+    var  = scale * sumall_except_dim<1>(F<mshadow_op::square>(data));
+    SharedND<mshadow::Tensor<cpu, 1, real_t>>* sharedMean =
+        global_shared_mean.Register(param_.key, param_.ndev);
+    SharedND<mshadow::Tensor<cpu, 1, real_t>>* sharedVar =
+        global_shared_var.Register(param_.key, param_.ndev);
+    // copy to cpu, push and pull
+    Tensor<cpu, 1, real_t>* mean_cpu_ptr = sharedMean->Retrieve(mean.shape_, myRank);
+    Tensor<cpu, 1, real_t>* var_cpu_ptr  = sharedVar->Retrieve(mean.shape_, myRank);
+    mshadow::Copy(*mean_cpu_ptr, mean, s);
+    mshadow::Copy(*var_cpu_ptr, var, s);
+    sharedMean->SetReady(myRank);
+    sharedVar->SetReady(myRank);
+    global_barrier->Wait();
+    Tensor<cpu, 1, real_t> mean_cpu = sharedMean->Pop(myRank);
+    Tensor<cpu, 1, real_t> var_cpu  = sharedVar->Pop(myRank);
+    // copy back to gpu
+    mshadow::Copy(mean, mean_cpu, s);
+    mshadow::Copy(var, var_cpu, s);
+  }
+
+  /*! \brief Gradient sums averaged over the devices of this process by their threads */
+  void SyncGradOnHost(mshadow::Stream<xpu>* s,
+                      mshadow::Tensor<xpu, 1>* p_sum_grad,
+                      mshadow::Tensor<xpu, 1>* p_sum_prod) {
+    using namespace mshadow;
+    Tensor<xpu, 1>& sumGrad = *p_sum_grad;
+    Tensor<xpu, 1>& sumProd = *p_sum_prod;
+    // get my rank
+    Barrier* global_barrier = global_shared_barrier_backward.Register(param_.key, param_.ndev);
+    int myRank              = global_shared_rank_backward.Register(param_.key, param_.ndev);
+    SharedND<mshadow::Tensor<cpu, 1, real_t>>* sharedGrad =
+        global_shared_grad.Register(param_.key, param_.ndev);
+    SharedND<mshadow::Tensor<cpu, 1, real_t>>* sharedProd =
+        global_shared_prod.Register(param_.key, param_.ndev);
+    // copy to cpu, push and pull
+    Tensor<cpu, 1, real_t>* grad_cpu_ptr = sharedGrad->Retrieve(sumGrad.shape_, myRank);
+    Tensor<cpu, 1, real_t>* prod_cpu_ptr = sharedProd->Retrieve(sumGrad.shape_, myRank);
+    mshadow::Copy(*grad_cpu_ptr, sumGrad, s);
+    mshadow::Copy(*prod_cpu_ptr, sumProd, s);
+    sharedGrad->SetReady(myRank);
+    sharedProd->SetReady(myRank);
+    global_barrier->Wait();
+    Tensor<cpu, 1, real_t> grad_cpu = sharedGrad->Pop(myRank);
+    Tensor<cpu, 1, real_t> prod_cpu = sharedProd->Pop(myRank);
+    // copy back to gpu
+    mshadow::Copy(sumGrad, grad_cpu, s);
+    mshadow::Copy(sumProd, prod_cpu, s);
+  }
+
   SyncBatchNormParam param_;
 };  // class SyncBatchNorm
 
@@ -566,6 +637,10 @@ class SyncBatchNormProp : public OperatorProperty {
             in_data[syncbatchnorm::kGamma]};
   }
 
+  std::vector<ResourceRequest> ForwardResource(const mxnet::ShapeVector& in_shape) const override {
+    return {ResourceRequest::kTempSpace};
+  }
+
   std::vector<ResourceRequest> BackwardResource(const mxnet::ShapeVector& in_shape) const override {
     return {ResourceRequest::kTempSpace};
   }
@@ -27,6 +27,19 @@
 
 namespace mxnet {
 namespace op {
+template <>
+bool UseNCCLSync<cpu>() {
+  return false;
+}
+
+template <>
+void NCCLAllReduceStats<cpu>(const OpContext& ctx,
+                             const std::string& key,
+                             int ndev,
+                             mshadow::Tensor<cpu, 1, real_t> stats) {
+  LOG(FATAL) << "SyncBatchNorm synchronizes CPU devices on the host";
+}
+
 template <>
 Operator* CreateOp<cpu>(SyncBatchNormParam param, int dtype) {
   return new SyncBatchNorm<cpu>(param);
@@ -89,6 +102,12 @@ the output. It is often used during inference.
 Both ``gamma`` and ``beta`` are learnable parameters. But if ``fix_gamma`` is true,
 then set ``gamma`` to 1 and its gradient to 0.
 
+On GPUs of a build with NCCL, the per channel sums of the data and of its squares, and the number
+of elements summed, are allreduced in one collective on the stream of the operator, so the devices
+may hold batches of different sizes. The group is the ``ndev`` GPUs of this process, or of every
+process with ``MXNET_SYNC_BN_NUM_NODES`` > 1. Otherwise the devices of this process are
+synchronized on the host.
+
 Reference:
   .. [1] Ioffe, Sergey, and Christian Szegedy. "Batch normalization: Accelerating \
     deep network training by reducing internal covariate shift." *ICML 2015*
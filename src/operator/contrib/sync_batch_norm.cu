@@ -23,11 +23,159 @@
  */
 
 #include "sync_batch_norm-inl.h"
+#if MXNET_USE_NCCL
+#include <nccl.h>
+#include <mxnet/storage.h>
+#include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../../common/cuda/utils.h"
+#include "../../kvstore/ring_allreduce.h"
+#endif  // MXNET_USE_NCCL
 
 namespace mxnet {
 namespace op {
+
+#if MXNET_USE_NCCL
+namespace {
+
+/*!
+ * \brief NCCL communicators of the SyncBatchNorm groups of this process, by layer key. Each layer
+ *        has its own communicators, so that the allreduces of layers which run concurrently, and
+ *        may be issued in a different order on each device, are never matched with each other.
+ *        The local devices of a group rank in the order of their ids, after the devices of the
+ *        nodes of lower rank. Across nodes, the groups are set up in the order in which the
+ *        layers first run, which has to be the same on every node.
+ */
+class SyncBatchNormComms {
+ public:
+  static SyncBatchNormComms* Get() {
+    static SyncBatchNormComms inst;
+    return &inst;
+  }
+
+  /*!
+   * \brief Communicator of the device in the group of the ndev local devices of the layer key.
+   *        The first call of each device blocks until the ndev devices made theirs, so that they
+   *        initialize together.
+   */
+  ncclComm_t Comm(const std::string& key, int dev_id, int ndev) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    Group& group = groups_[key];
+    if (!group.ready) {
+      if (std::find(group.devs.begin(), group.devs.end(), dev_id) == group.devs.end())
+        group.devs.push_back(dev_id);
+      CHECK_LE(group.devs.size(), ndev) << "SyncBatchNorm " << key << " runs on more than ndev="
+                                        << ndev << " devices, give each model its own keys";
+      if (group.devs.size() == static_cast<size_t>(ndev)) {
+        InitGroup(&group);
+        cv_.notify_all();
+      } else {
+        cv_.wait(lock, [&group]() { return group.ready; });
+      }
+    }
+    auto it = group.comms.find(dev_id);
+    CHECK(it != group.comms.end()) << "SyncBatchNorm " << key << " runs on more than ndev="
+                                   << ndev << " devices, give each model its own keys";
+    return it->second;
+  }
+
+ private:
+  struct Group {
+    std::vector<int> devs;
+    std::map<int, ncclComm_t> comms;
+    bool ready = false;
+  };
+
+  void InitGroup(Group* group) {
+    const int ndev      = group->devs.size();
+    const int num_nodes = dmlc::GetEnv("MXNET_SYNC_BN_NUM_NODES", 1);
+    const int node_rank =
+        dmlc::GetEnv("MXNET_SYNC_BN_NODE_RANK", dmlc::GetEnv("DMLC_WORKER_ID", 0));
+    ncclUniqueId id;
+    if (num_nodes == 1 || node_rank == 0)
+      ncclGetUniqueId(&id);
+    if (num_nodes > 1) {
+      // the nodes meet once, over TCP, to share the id of the group
+      kvstore::RingAllreduce ring(
+          node_rank,
+          num_nodes,
+          dmlc::GetEnv("MXNET_SYNC_BN_ROOT_URI",
+                       dmlc::GetEnv("DMLC_PS_ROOT_URI", std::string("127.0.0.1"))),
+          dmlc::GetEnv("MXNET_SYNC_BN_ROOT_PORT", dmlc::GetEnv("DMLC_PS_ROOT_PORT", 9091) + 1),
+          dmlc::GetEnv("MXNET_KVSTORE_ALLREDUCE_TIMEOUT", 300));
+      ring.Broadcast(ndev, &id, sizeof(id));
+    }
+    std::sort(group->devs.begin(), group->devs.end());
+    // NCCL allocates device memory, as for the nccl kvstore
+    std::lock_guard<std::mutex> l(Storage::Get()->GetMutex(Context::kGPU));
+    std::vector<ncclComm_t> comms(ndev);
+    mxnet::common::cuda::DeviceStore device_store;
+    ncclGroupStart();
+    for (int i = 0; i < ndev; ++i) {
+      device_store.SetDevice(group->devs[i]);
+      ncclCommInitRank(&comms[i], num_nodes * ndev, id, node_rank * ndev + i);
+    }
+    ncclGroupEnd();
+    for (int i = 0; i < ndev; ++i)
+      group->comms[group->devs[i]] = comms[i];
+    group->ready = true;
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::map<std::string, Group> groups_;
+};
+
+}  // namespace
+
+template <>
+bool UseNCCLSync<gpu>() {
+  static const bool use_nccl = dmlc::GetEnv("MXNET_SYNC_BN_NCCL", true);
+  return use_nccl;
+}
+
+template <>
+void NCCLAllReduceStats<gpu>(const OpContext& ctx,
+                             const std::string& key,
+                             int ndev,
+                             mshadow::Tensor<gpu, 1, real_t> stats) {
+  const int dev_id = ctx.run_ctx.ctx.dev_id;
+  ncclComm_t comm  = SyncBatchNormComms::Get()->Comm(key, dev_id, ndev);
+  // launched under the lock of the allocations, as for the nccl kvstore, which also serializes
+  // the launches of the worker threads of each device
+  std::lock_guard<std::mutex> l(Storage::Get()->GetMutex(Context::kGPU));
+  ncclAllReduce(stats.dptr_,
+                stats.dptr_,
+                stats.size(0),
+                ncclFloat,
+                ncclSum,
+                comm,
+                mshadow::Stream<gpu>::GetStream(ctx.get_stream<gpu>()));
+}
+#else
+template <>
+bool UseNCCLSync<gpu>() {
+  return false;
+}
+
+template <>
+void NCCLAllReduceStats<gpu>(const OpContext& ctx,
+                             const std::string& key,
+                             int ndev,
+                             mshadow::Tensor<gpu, 1, real_t> stats) {
+  LOG(FATAL) << "Compile with USE_NCCL=1 to synchronize SyncBatchNorm with NCCL";
+}
+#endif  // MXNET_USE_NCCL
+
 template <>
 Operator* CreateOp<gpu>(SyncBatchNormParam param, int dtype) {
+  if (dmlc::GetEnv("MXNET_SYNC_BN_NUM_NODES", 1) > 1) {
+    CHECK(UseNCCLSync<gpu>()) << "SyncBatchNorm across nodes needs NCCL";
+  }
   return new SyncBatchNorm<gpu>(param);
 }
 
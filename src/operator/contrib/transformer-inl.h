@@ -25,6 +25,7 @@
 #define MXNET_OPERATOR_CONTRIB_TRANSFORMER_INL_H_
 
 #include <mxnet/operator_util.h>
+#include <type_traits>
 #include <vector>
 #include "../mxnet_op.h"
 #include "../mshadow_op.h"
@@ -40,6 +41,35 @@ struct InterleavedMatMulParam : public dmlc::Parameter<InterleavedMatMulParam> {
   }
 };
 
+struct InterleavedFusedSelfAttParam : public dmlc::Parameter<InterleavedFusedSelfAttParam> {
+  int heads;
+  bool causal;
+  bool use_length;
+  DMLC_DECLARE_PARAMETER(InterleavedFusedSelfAttParam) {
+    DMLC_DECLARE_FIELD(heads).describe("Set number of heads");
+    DMLC_DECLARE_FIELD(causal).set_default(false).describe(
+        "If true, each token will only attend to itself and the previous tokens.");
+    DMLC_DECLARE_FIELD(use_length)
+        .set_default(false)
+        .describe("If true, the keys past the valid length of each sequence are masked out.");
+  }
+};
+
+/*!
+ * \brief Number of keys visible from query q in the fused self attention.
+ *        Both the padding and the causal mask keep a prefix of the keys, so the
+ *        visible keys are always [0, end).
+ */
+MSHADOW_XINLINE index_t FusedSelfAttKeyEnd(const index_t q,
+                                           const index_t seq_len,
+                                           const index_t valid_len,
+                                           const bool causal) {
+  index_t end = valid_len < seq_len ? valid_len : seq_len;
+  if (causal && q + 1 < end)
+    end = q + 1;
+  return end > 0 ? end : 0;
+}
+
 template <typename xpu>
 static void DivSqrtDimForward_(const nnvm::NodeAttrs& attrs,
                                const OpContext& ctx,
@@ -187,6 +217,25 @@ struct DiagMM {
   }
 };
 
+/*!
+ * \brief Blocked CPU version of DiagMM: each task handles a block of neighbouring rows of one
+ *        head, whose windows overlap, and the inner products are vectorized.
+ *        Defined in transformer.cc.
+ */
+void DiagMMCPU(const float* lhs,
+               const float* rhs,
+               const int32_t* dilation,
+               float* out,
+               int batch_size,
+               int seq_length,
+               int num_heads,
+               int out_last_dim,
+               int lhs_last_dim,
+               int w,
+               int w_right,
+               bool diagonal_lhs,
+               bool transpose_lhs);
+
 template <typename xpu>
 void DiagMMImpl(const OpContext& ctx,
                 const TBlob& out,
@@ -216,6 +265,22 @@ void DiagMMImpl(const OpContext& ctx,
   int out_last_dim = out.shape_[3];
   int num_threads  = out.Size();
 
+  if (std::is_same<xpu, cpu>::value) {
+    DiagMMCPU(lhs_data,
+              rhs_data,
+              dilation_data,
+              out_data,
+              batch_size,
+              seq_length,
+              num_heads,
+              out_last_dim,
+              lhs_last_dim,
+              w,
+              w_right,
+              diagonal_lhs,
+              transpose_lhs);
+    return;
+  }
   mxnet_op::Kernel<DiagMM, xpu>::Launch(s,
                                         num_threads,
                                         out_data,
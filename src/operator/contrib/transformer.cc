@@ -22,13 +22,18 @@
  * \brief CPU implementation of the operators used in Transformer
  */
 #include <mxnet/base.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include "./transformer-inl.h"
+#include "../../engine/openmp.h"
 #include "../tensor/elemwise_unary_op.h"
 
 namespace mxnet {
 namespace op {
 
 DMLC_REGISTER_PARAMETER(InterleavedMatMulParam);
+DMLC_REGISTER_PARAMETER(InterleavedFusedSelfAttParam);
 
 static bool InterleavedMatMulSelfAttQKShape(const NodeAttrs& attrs,
                                             mxnet::ShapeVector* in_shape,
@@ -672,6 +677,496 @@ void BackwardInterleavedMatMulEncDecValAttCPU(const nnvm::NodeAttrs& attrs,
   }
 }
 
+static bool InterleavedFusedSelfAttShape(const NodeAttrs& attrs,
+                                         mxnet::ShapeVector* in_shape,
+                                         mxnet::ShapeVector* out_shape) {
+  const auto& params = nnvm::get<InterleavedFusedSelfAttParam>(attrs.parsed);
+  CHECK_EQ(in_shape->size(), params.use_length ? 2U : 1U);
+  auto qkv_shape = in_shape->at(0);
+  if (!mxnet::ndim_is_known(qkv_shape))
+    return false;
+  CHECK_EQ(qkv_shape.ndim(), 3U)
+      << "Input queries_keys_values should be 3D in seq_length-batch-3*proj_dim, "
+      << "currently is: " << qkv_shape.ndim() << "D";
+  CHECK_EQ(qkv_shape[2] % (3 * params.heads), 0)
+      << "queries_keys_values.shape[2] should be a multiple of 3 * heads, "
+      << "currently is " << qkv_shape[2];
+  if (params.use_length) {
+    SHAPE_ASSIGN_CHECK(*in_shape, 1, mxnet::TShape({qkv_shape[1]}));
+  }
+  out_shape->resize(2);
+  SHAPE_ASSIGN_CHECK(*out_shape, 0, mxnet::TShape({qkv_shape[0], qkv_shape[1], qkv_shape[2] / 3}));
+  SHAPE_ASSIGN_CHECK(*out_shape, 1, mxnet::TShape({params.heads * qkv_shape[1], qkv_shape[0]}));
+  return true;
+}
+
+static bool InterleavedFusedSelfAttType(const NodeAttrs& attrs,
+                                        std::vector<int>* in_attrs,
+                                        std::vector<int>* out_attrs) {
+  const auto& params = nnvm::get<InterleavedFusedSelfAttParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), params.use_length ? 2U : 1U);
+  CHECK_EQ(out_attrs->size(), 2U);
+  if (params.use_length) {
+    TYPE_ASSIGN_CHECK(*in_attrs, 1, mshadow::kInt32);
+  }
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(0));
+  TYPE_ASSIGN_CHECK(*in_attrs, 0, out_attrs->at(0));
+  TYPE_ASSIGN_CHECK(*out_attrs, 1, mshadow::kFloat32);
+  return out_attrs->at(0) != -1;
+}
+
+// keys scored at once before the running max and sum of a query are rescaled
+static constexpr index_t kFusedSelfAttKeyBlock = 64;
+
+/*!
+ * \brief Online softmax of one (pre-scaled) query against the keys [0, end).
+ *        acc receives the sum of the values weighted by exp(score - row_max) and row_sum
+ *        the sum of the weights, so the output is acc / row_sum.
+ *        key_row(k) and value_row(k) return the projections of position k.
+ */
+template <typename AType, typename KeyRow, typename ValueRow>
+static void OnlineSoftmaxRowCPU(const AType* query,
+                                const index_t end,
+                                const index_t head_dim,
+                                KeyRow key_row,
+                                ValueRow value_row,
+                                AType* acc,
+                                AType* score,
+                                AType* row_max,
+                                AType* row_sum) {
+  const AType neg_inf = -std::numeric_limits<AType>::infinity();
+  AType max = neg_inf, sum = 0;
+  std::fill(acc, acc + head_dim, AType(0));
+  for (index_t k0 = 0; k0 < end; k0 += kFusedSelfAttKeyBlock) {
+    const index_t k1 = std::min(k0 + kFusedSelfAttKeyBlock, end);
+    AType block_max  = neg_inf;
+    for (index_t k = k0; k < k1; ++k) {
+      const auto* k_proj = key_row(k);
+      AType s            = 0;
+      for (index_t d = 0; d < head_dim; ++d)
+        s += query[d] * static_cast<AType>(k_proj[d]);
+      score[k - k0] = s;
+      block_max     = std::max(block_max, s);
+    }
+    const AType new_max    = std::max(max, block_max);
+    const AType correction = std::exp(max - new_max);
+    sum *= correction;
+    for (index_t d = 0; d < head_dim; ++d)
+      acc[d] *= correction;
+    for (index_t k = k0; k < k1; ++k) {
+      const auto* v_proj = value_row(k);
+      const AType p      = std::exp(score[k - k0] - new_max);
+      sum += p;
+      for (index_t d = 0; d < head_dim; ++d)
+        acc[d] += p * static_cast<AType>(v_proj[d]);
+    }
+    max = new_max;
+  }
+  *row_max = max;
+  *row_sum = sum;
+}
+
+template <typename DType, typename AType>
+static void InterleavedFusedSelfAttCPUImpl(const DType* queries_keys_values,
+                                           const int32_t* valid_length,
+                                           DType* output,
+                                           float* logsumexp,
+                                           const index_t qkv_seq_len,
+                                           const index_t sequences,
+                                           const index_t heads,
+                                           const index_t head_dim,
+                                           const bool causal,
+                                           const OpReqType req) {
+  const index_t attn_batches = heads * sequences;
+  const index_t lead_dim     = attn_batches * 3 * head_dim;
+  const index_t out_lead_dim = attn_batches * head_dim;
+  const AType scale          = 1.0 / std::sqrt(static_cast<AType>(head_dim));
+  const int omp_threads      = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel num_threads(omp_threads)
+  {
+    std::vector<AType> query(head_dim), acc(head_dim), score(kFusedSelfAttKeyBlock);
+#pragma omp for
+    for (index_t row = 0; row < attn_batches * qkv_seq_len; ++row) {
+      const index_t i     = row / qkv_seq_len;
+      const index_t q     = row % qkv_seq_len;
+      const index_t len   = valid_length ? valid_length[i / heads] : qkv_seq_len;
+      const index_t end   = FusedSelfAttKeyEnd(q, qkv_seq_len, len, causal);
+      const DType* qkv_i  = queries_keys_values + i * 3 * head_dim;
+      const DType* q_proj = qkv_i + q * lead_dim;
+      for (index_t d = 0; d < head_dim; ++d)
+        query[d] = static_cast<AType>(q_proj[d]) * scale;
+      AType row_max, row_sum;
+      OnlineSoftmaxRowCPU(
+          query.data(),
+          end,
+          head_dim,
+          [&](index_t k) { return qkv_i + k * lead_dim + head_dim; },
+          [&](index_t k) { return qkv_i + k * lead_dim + 2 * head_dim; },
+          acc.data(),
+          score.data(),
+          &row_max,
+          &row_sum);
+      DType* out     = output + q * out_lead_dim + i * head_dim;
+      const AType rs = end > 0 ? 1 / row_sum : 0;
+      for (index_t d = 0; d < head_dim; ++d) {
+        KERNEL_ASSIGN(out[d], req, static_cast<DType>(acc[d] * rs));
+      }
+      // fully masked rows attend to nothing and output zeros
+      logsumexp[row] = end > 0 ? static_cast<float>(row_max + std::log(row_sum)) :
+                                 -std::numeric_limits<float>::infinity();
+    }
+  }
+}
+
+template <typename DType, typename AType>
+static void BackwardInterleavedFusedSelfAttCPUImpl(const DType* output_grads,
+                                                   const DType* queries_keys_values,
+                                                   const int32_t* valid_length,
+                                                   const DType* output,
+                                                   const float* logsumexp,
+                                                   DType* queries_keys_values_grads,
+                                                   const index_t qkv_seq_len,
+                                                   const index_t sequences,
+                                                   const index_t heads,
+                                                   const index_t head_dim,
+                                                   const bool causal,
+                                                   const OpReqType req) {
+  const index_t attn_batches = heads * sequences;
+  const index_t lead_dim     = attn_batches * 3 * head_dim;
+  const index_t out_lead_dim = attn_batches * head_dim;
+  const AType scale          = 1.0 / std::sqrt(static_cast<AType>(head_dim));
+  const int omp_threads      = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel num_threads(omp_threads)
+  {
+    // gradients of one attention batch, the probabilities are recomputed from logsumexp
+    std::vector<AType> grads(qkv_seq_len * 3 * head_dim), delta(qkv_seq_len);
+#pragma omp for
+    for (index_t i = 0; i < attn_batches; ++i) {
+      const index_t len     = valid_length ? valid_length[i / heads] : qkv_seq_len;
+      const DType* qkv_i    = queries_keys_values + i * 3 * head_dim;
+      const DType* ograds_i = output_grads + i * head_dim;
+      const DType* out_i    = output + i * head_dim;
+      const float* lse_i    = logsumexp + i * qkv_seq_len;
+      std::fill(grads.begin(), grads.end(), AType(0));
+      for (index_t q = 0; q < qkv_seq_len; ++q) {
+        AType sum = 0;
+        for (index_t d = 0; d < head_dim; ++d) {
+          sum += static_cast<AType>(ograds_i[q * out_lead_dim + d]) *
+                 static_cast<AType>(out_i[q * out_lead_dim + d]);
+        }
+        delta[q] = sum;
+      }
+      for (index_t q = 0; q < qkv_seq_len; ++q) {
+        const index_t end   = FusedSelfAttKeyEnd(q, qkv_seq_len, len, causal);
+        const DType* q_proj = qkv_i + q * lead_dim;
+        const DType* ograd  = ograds_i + q * out_lead_dim;
+        AType* q_grad       = grads.data() + q * 3 * head_dim;
+        for (index_t k = 0; k < end; ++k) {
+          const DType* k_proj = qkv_i + k * lead_dim + head_dim;
+          const DType* v_proj = k_proj + head_dim;
+          AType s = 0, dp = 0;
+          for (index_t d = 0; d < head_dim; ++d) {
+            s += static_cast<AType>(q_proj[d]) * static_cast<AType>(k_proj[d]);
+            dp += static_cast<AType>(ograd[d]) * static_cast<AType>(v_proj[d]);
+          }
+          const AType p  = std::exp(s * scale - static_cast<AType>(lse_i[q]));
+          const AType ds = p * (dp - delta[q]) * scale;
+          AType* k_grad  = grads.data() + k * 3 * head_dim + head_dim;
+          AType* v_grad  = k_grad + head_dim;
+          for (index_t d = 0; d < head_dim; ++d) {
+            q_grad[d] += ds * static_cast<AType>(k_proj[d]);
+            k_grad[d] += ds * static_cast<AType>(q_proj[d]);
+            v_grad[d] += p * static_cast<AType>(ograd[d]);
+          }
+        }
+      }
+      for (index_t t = 0; t < qkv_seq_len; ++t) {
+        DType* dst = queries_keys_values_grads + t * lead_dim + i * 3 * head_dim;
+        for (index_t c = 0; c < 3 * head_dim; ++c) {
+          KERNEL_ASSIGN(dst[c], req, static_cast<DType>(grads[t * 3 * head_dim + c]));
+        }
+      }
+    }
+  }
+}
+
+void InterleavedFusedSelfAttCPU(const nnvm::NodeAttrs& attrs,
+                                const OpContext& ctx,
+                                const std::vector<TBlob>& inputs,
+                                const std::vector<OpReqType>& req,
+                                const std::vector<TBlob>& outputs) {
+  const auto& params          = nnvm::get<InterleavedFusedSelfAttParam>(attrs.parsed);
+  const index_t qkv_seq_len   = inputs[0].shape_[0];
+  const index_t sequences     = inputs[0].shape_[1];
+  const index_t head_dim      = inputs[0].shape_[2] / 3 / params.heads;
+  const int32_t* valid_length =
+      params.use_length ? inputs[1].dptr<int32_t>() : static_cast<int32_t*>(nullptr);
+  MSHADOW_REAL_TYPE_SWITCH_EX(inputs[0].type_flag_, DType, AType, {
+    InterleavedFusedSelfAttCPUImpl<DType, AType>(inputs[0].dptr<DType>(),
+                                                 valid_length,
+                                                 outputs[0].dptr<DType>(),
+                                                 outputs[1].dptr<float>(),
+                                                 qkv_seq_len,
+                                                 sequences,
+                                                 params.heads,
+                                                 head_dim,
+                                                 params.causal,
+                                                 req[0]);
+  });
+}
+
+void BackwardInterleavedFusedSelfAttCPU(const nnvm::NodeAttrs& attrs,
+                                        const OpContext& ctx,
+                                        const std::vector<TBlob>& inputs,
+                                        const std::vector<OpReqType>& req,
+                                        const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const auto& params = nnvm::get<InterleavedFusedSelfAttParam>(attrs.parsed);
+  // inputs: output_grads, queries_keys_values, [valid_length], output, logsumexp
+  const TBlob& qkv            = inputs[1];
+  const TBlob& output         = inputs[params.use_length ? 3 : 2];
+  const TBlob& logsumexp      = inputs[params.use_length ? 4 : 3];
+  const int32_t* valid_length =
+      params.use_length ? inputs[2].dptr<int32_t>() : static_cast<int32_t*>(nullptr);
+  if (params.use_length && req[1] != kNullOp) {
+    Kernel<set_zero, cpu>::Launch(
+        ctx.get_stream<cpu>(), outputs[1].Size(), outputs[1].dptr<int32_t>());
+  }
+  if (req[0] == kNullOp)
+    return;
+
+  const index_t qkv_seq_len = qkv.shape_[0];
+  const index_t sequences   = qkv.shape_[1];
+  const index_t head_dim    = qkv.shape_[2] / 3 / params.heads;
+  MSHADOW_REAL_TYPE_SWITCH_EX(qkv.type_flag_, DType, AType, {
+    BackwardInterleavedFusedSelfAttCPUImpl<DType, AType>(inputs[0].dptr<DType>(),
+                                                         qkv.dptr<DType>(),
+                                                         valid_length,
+                                                         output.dptr<DType>(),
+                                                         logsumexp.dptr<float>(),
+                                                         outputs[0].dptr<DType>(),
+                                                         qkv_seq_len,
+                                                         sequences,
+                                                         params.heads,
+                                                         head_dim,
+                                                         params.causal,
+                                                         req[0]);
+  });
+}
+
+static bool InterleavedDecodeSelfAttShape(const NodeAttrs& attrs,
+                                          mxnet::ShapeVector* in_shape,
+                                          mxnet::ShapeVector* out_shape) {
+  const auto& params = nnvm::get<InterleavedMatMulParam>(attrs.parsed);
+  CHECK_EQ(in_shape->size(), 4U)
+      << "Input:[queries_keys_values, kv_cache, page_table, cache_length] currently have, "
+      << in_shape->size() << " inputs";
+  auto qkv_shape   = in_shape->at(0);
+  auto cache_shape = in_shape->at(1);
+  auto table_shape = in_shape->at(2);
+  if (!mxnet::ndim_is_known(qkv_shape) || !mxnet::ndim_is_known(cache_shape) ||
+      !mxnet::ndim_is_known(table_shape))
+    return false;
+  CHECK_EQ(qkv_shape.ndim(), 3U)
+      << "Input queries_keys_values should be 3D in 1-batch-3*proj_dim, "
+      << "currently is: " << qkv_shape.ndim() << "D";
+  CHECK_EQ(qkv_shape[0], 1) << "Only one token per sequence is decoded at each step";
+  CHECK_EQ(qkv_shape[2] % (3 * params.heads), 0)
+      << "queries_keys_values.shape[2] should be a multiple of 3 * heads, "
+      << "currently is " << qkv_shape[2];
+  CHECK_EQ(cache_shape.ndim(), 4U)
+      << "Input kv_cache should be 4D in num_pages-2-page_size-proj_dim, "
+      << "currently is: " << cache_shape.ndim() << "D";
+  CHECK_EQ(cache_shape[1], 2) << "kv_cache.shape[1] should be 2 (keys and values), "
+                              << "currently is " << cache_shape[1];
+  CHECK_EQ(cache_shape[3], qkv_shape[2] / 3)
+      << "kv_cache.shape[3] and queries_keys_values.shape[2] / 3 should be the same, "
+      << "currently are " << cache_shape[3] << " and " << qkv_shape[2] / 3;
+  CHECK_EQ(table_shape.ndim(), 2U) << "Input page_table should be 2D in batch-max_pages, "
+                                   << "currently is: " << table_shape.ndim() << "D";
+  CHECK_EQ(table_shape[0], qkv_shape[1])
+      << "page_table.shape[0] and queries_keys_values.shape[1] should be the same, "
+      << "currently are " << table_shape[0] << " and " << qkv_shape[1];
+  SHAPE_ASSIGN_CHECK(*in_shape, 3, mxnet::TShape({qkv_shape[1]}));
+  SHAPE_ASSIGN_CHECK(*out_shape, 0, mxnet::TShape({1, qkv_shape[1], qkv_shape[2] / 3}));
+  return true;
+}
+
+static bool InterleavedDecodeSelfAttType(const NodeAttrs& attrs,
+                                         std::vector<int>* in_attrs,
+                                         std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 4U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  TYPE_ASSIGN_CHECK(*in_attrs, 2, mshadow::kInt32);
+  TYPE_ASSIGN_CHECK(*in_attrs, 3, mshadow::kInt32);
+  std::vector<int> data_attrs{in_attrs->at(0), in_attrs->at(1)};
+  if (!ElemwiseType<2, 1>(attrs, &data_attrs, out_attrs))
+    return false;
+  TYPE_ASSIGN_CHECK(*in_attrs, 0, data_attrs[0]);
+  TYPE_ASSIGN_CHECK(*in_attrs, 1, data_attrs[1]);
+  return true;
+}
+
+template <typename DType, typename AType>
+static void InterleavedDecodeSelfAttCPUImpl(const DType* queries_keys_values,
+                                            DType* kv_cache,
+                                            const int32_t* page_table,
+                                            const int32_t* cache_length,
+                                            DType* output,
+                                            const index_t sequences,
+                                            const index_t heads,
+                                            const index_t head_dim,
+                                            const index_t page_size,
+                                            const index_t max_pages,
+                                            const OpReqType req) {
+  const index_t embed_dim   = heads * head_dim;
+  const index_t page_stride = 2 * page_size * embed_dim;
+  const AType scale         = 1.0 / std::sqrt(static_cast<AType>(head_dim));
+  const int omp_threads     = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel num_threads(omp_threads)
+  {
+    std::vector<AType> query(head_dim), acc(head_dim), score(kFusedSelfAttKeyBlock);
+#pragma omp for
+    for (index_t i = 0; i < sequences * heads; ++i) {
+      const index_t b      = i / heads;
+      const index_t h      = i % heads;
+      const index_t pos    = cache_length[b];
+      const int32_t* pages = page_table + b * max_pages;
+      const DType* qkv_i   = queries_keys_values + i * 3 * head_dim;
+      auto key_row         = [&](index_t t) {
+        return kv_cache + pages[t / page_size] * page_stride + (t % page_size) * embed_dim +
+               h * head_dim;
+      };
+      auto value_row = [&](index_t t) { return key_row(t) + page_size * embed_dim; };
+      // append the new token to the cache in place, then attend over the whole prefix
+      std::copy(qkv_i + head_dim, qkv_i + 2 * head_dim, key_row(pos));
+      std::copy(qkv_i + 2 * head_dim, qkv_i + 3 * head_dim, value_row(pos));
+      for (index_t d = 0; d < head_dim; ++d)
+        query[d] = static_cast<AType>(qkv_i[d]) * scale;
+      AType row_max, row_sum;
+      OnlineSoftmaxRowCPU(query.data(),
+                          pos + 1,
+                          head_dim,
+                          key_row,
+                          value_row,
+                          acc.data(),
+                          score.data(),
+                          &row_max,
+                          &row_sum);
+      DType* out = output + i * head_dim;
+      for (index_t d = 0; d < head_dim; ++d) {
+        KERNEL_ASSIGN(out[d], req, static_cast<DType>(acc[d] / row_sum));
+      }
+    }
+  }
+}
+
+void InterleavedDecodeSelfAttCPU(const nnvm::NodeAttrs& attrs,
+                                 const OpContext& ctx,
+                                 const std::vector<TBlob>& inputs,
+                                 const std::vector<OpReqType>& req,
+                                 const std::vector<TBlob>& outputs) {
+  const auto& params            = nnvm::get<InterleavedMatMulParam>(attrs.parsed);
+  const index_t sequences       = inputs[0].shape_[1];
+  const index_t head_dim        = inputs[0].shape_[2] / 3 / params.heads;
+  const index_t num_pages       = inputs[1].shape_[0];
+  const index_t page_size       = inputs[1].shape_[2];
+  const index_t max_pages       = inputs[2].shape_[1];
+  const int32_t* page_table     = inputs[2].dptr<int32_t>();
+  const int32_t* cache_length   = inputs[3].dptr<int32_t>();
+  for (index_t b = 0; b < sequences; ++b) {
+    const index_t pos = cache_length[b];
+    CHECK(pos >= 0 && pos < max_pages * page_size)
+        << "cache_length[" << b << "] = " << pos << " is out of the " << max_pages * page_size
+        << " positions of its pages";
+    for (index_t p = 0; p <= pos / page_size; ++p) {
+      const index_t page = page_table[b * max_pages + p];
+      CHECK(page >= 0 && page < num_pages)
+          << "page_table[" << b << ", " << p << "] = " << page << " is not a page of kv_cache";
+    }
+  }
+  MSHADOW_REAL_TYPE_SWITCH_EX(inputs[0].type_flag_, DType, AType, {
+    InterleavedDecodeSelfAttCPUImpl<DType, AType>(inputs[0].dptr<DType>(),
+                                                  inputs[1].dptr<DType>(),
+                                                  page_table,
+                                                  cache_length,
+                                                  outputs[0].dptr<DType>(),
+                                                  sequences,
+                                                  params.heads,
+                                                  head_dim,
+                                                  page_size,
+                                                  max_pages,
+                                                  req[0]);
+  });
+}
+
+void DiagMMCPU(const float* lhs,
+               const float* rhs,
+               const int32_t* dilation,
+               float* out,
+               int batch_size,
+               int seq_length,
+               int num_heads,
+               int out_last_dim,
+               int lhs_last_dim,
+               int w,
+               int w_right,
+               bool diagonal_lhs,
+               bool transpose_lhs) {
+  // rows of a block share most of their windows, which then stay in cache
+  const index_t kRowBlock    = 16;
+  const index_t rhs_last_dim = diagonal_lhs ? out_last_dim : lhs_last_dim;
+  const index_t row_blocks   = (seq_length + kRowBlock - 1) / kRowBlock;
+  const index_t tasks        = static_cast<index_t>(batch_size) * num_heads * row_blocks;
+  const int omp_threads      = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  auto row_offset            = [&](index_t b, index_t t, index_t h) {
+    return (b * seq_length + t) * num_heads + h;
+  };
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t task = 0; task < tasks; ++task) {
+    const index_t b   = task / (num_heads * row_blocks);
+    const index_t h   = task / row_blocks % num_heads;
+    const index_t i0  = task % row_blocks * kRowBlock;
+    const index_t i1  = std::min<index_t>(i0 + kRowBlock, seq_length);
+    const index_t dil = dilation[h];
+    for (index_t i = i0; i < i1; ++i) {
+      float* out_row = out + row_offset(b, i, h) * out_last_dim;
+      if (!diagonal_lhs) {
+        // score[i, j] = <lhs[i], rhs[i + dil * (j - w)]>
+        const float* lhs_row = lhs + row_offset(b, i, h) * lhs_last_dim;
+        for (index_t j = 0; j < out_last_dim; ++j) {
+          const index_t t = i + dil * (j - w);
+          float sum       = 0;
+          if (t >= 0 && t < seq_length) {
+            const float* rhs_row = rhs + row_offset(b, t, h) * rhs_last_dim;
+#pragma omp simd reduction(+ : sum)
+            for (index_t c = 0; c < lhs_last_dim; ++c)
+              sum += lhs_row[c] * rhs_row[c];
+          }
+          out_row[j] = sum;
+        }
+      } else {
+        // out[i] = sum_j weight[i, j] * rhs[t], with the weights of the transposed band
+        // read from row t when transpose_lhs
+        std::fill(out_row, out_row + out_last_dim, 0.f);
+        const index_t shift = transpose_lhs ? w_right : w;
+        for (index_t j = 0; j < lhs_last_dim; ++j) {
+          const index_t t = i + dil * (j - shift);
+          if (t < 0 || t >= seq_length)
+            continue;
+          const float weight =
+              transpose_lhs ? lhs[row_offset(b, t, h) * lhs_last_dim + w + w_right - j] :
+                              lhs[row_offset(b, i, h) * lhs_last_dim + j];
+          const float* rhs_row = rhs + row_offset(b, t, h) * rhs_last_dim;
+#pragma omp simd
+          for (index_t d = 0; d < out_last_dim; ++d)
+            out_row[d] += weight * rhs_row[d];
+        }
+      }
+    }
+  }
+}
+
 NNVM_REGISTER_OP(_contrib_interleaved_matmul_selfatt_qk)
     .add_alias("_npx_interleaved_matmul_selfatt_qk")
     .describe(R"code(Compute the matrix multiplication between the projections of
@@ -872,6 +1367,138 @@ NNVM_REGISTER_OP(_backward_interleaved_matmul_encdec_valatt)
     .set_attr_parser(ParamParser<InterleavedMatMulParam>)
     .set_attr<FCompute>("FCompute<cpu>", BackwardInterleavedMatMulEncDecValAttCPU);
 
+NNVM_REGISTER_OP(_contrib_interleaved_fused_selfatt)
+    .add_alias("_npx_interleaved_fused_selfatt")
+    .describe(R"code(Compute multihead self attention in a single pass, without materializing
+the attention weights.
+
+the input must be a single tensor of interleaved projections
+of queries, keys and values following the layout:
+(seq_length, batch_size, num_heads * head_dim * 3)
+
+The keys are visited in blocks while a running maximum and sum of the scores are kept for
+every query (online softmax), so the memory used is linear in seq_length. The backward pass
+recomputes the attention weights from the log-sum-exp of the scores saved by the forward pass.
+
+Keys past *valid_length* of their sequence are masked out when *use_length* is set, and keys
+after the query are masked out when *causal* is set. Queries which see no key output zeros.
+
+the equivalent code would be::
+
+    att = mx.nd.contrib.interleaved_matmul_selfatt_qk(queries_keys_values, heads=num_heads)
+    att = mx.nd.softmax(att + mask, axis=-1)
+    output = mx.nd.contrib.interleaved_matmul_selfatt_valatt(queries_keys_values, att,
+                                                             heads=num_heads)
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      const auto& params = nnvm::get<InterleavedFusedSelfAttParam>(attrs.parsed);
+      return params.use_length ? 2 : 1;
+    })
+    .set_num_outputs(2)
+    .set_attr<nnvm::FNumVisibleOutputs>("FNumVisibleOutputs",
+                                        [](const NodeAttrs& attrs) { return 1; })
+    .set_attr_parser(ParamParser<InterleavedFusedSelfAttParam>)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          const auto& params = nnvm::get<InterleavedFusedSelfAttParam>(attrs.parsed);
+          return params.use_length ?
+                     std::vector<std::string>{"queries_keys_values", "valid_length"} :
+                     std::vector<std::string>{"queries_keys_values"};
+        })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"output", "logsumexp"};
+                                      })
+    .set_attr<mxnet::FInferShape>("FInferShape", InterleavedFusedSelfAttShape)
+    .set_attr<nnvm::FInferType>("FInferType", InterleavedFusedSelfAttType)
+    .set_attr<FCompute>("FCompute<cpu>", InterleavedFusedSelfAttCPU)
+    .set_attr<nnvm::FGradient>(
+        "FGradient",
+        [](const nnvm::ObjectPtr& n, const std::vector<nnvm::NodeEntry>& ograds) {
+          const auto& params = nnvm::get<InterleavedFusedSelfAttParam>(n->attrs.parsed);
+          std::vector<nnvm::NodeEntry> heads{ograds[0], n->inputs[0]};
+          if (params.use_length)
+            heads.push_back(n->inputs[1]);
+          heads.emplace_back(n, 0, 0);
+          heads.emplace_back(n, 1, 0);
+          return MakeGradNode("_backward_interleaved_fused_selfatt", n, heads, n->attrs.dict);
+        })
+    .add_argument("queries_keys_values",
+                  "NDArray-or-Symbol",
+                  "Interleaved queries, keys and values")
+    .add_argument("valid_length", "NDArray-or-Symbol", "Valid length of each sequence, in int32")
+    .add_arguments(InterleavedFusedSelfAttParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_interleaved_fused_selfatt)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      const auto& params = nnvm::get<InterleavedFusedSelfAttParam>(attrs.parsed);
+      return params.use_length ? 5 : 4;
+    })
+    .set_num_outputs([](const NodeAttrs& attrs) {
+      const auto& params = nnvm::get<InterleavedFusedSelfAttParam>(attrs.parsed);
+      return params.use_length ? 2 : 1;
+    })
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr_parser(ParamParser<InterleavedFusedSelfAttParam>)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", BackwardInterleavedFusedSelfAttCPU);
+
+NNVM_REGISTER_OP(_contrib_interleaved_decode_selfatt)
+    .add_alias("_npx_interleaved_decode_selfatt")
+    .describe(R"code(Compute one step of autoregressive self attention against a paged
+key/value cache.
+
+The key and value of the new token of every sequence are written into *kv_cache* in place,
+at position *cache_length* of the sequence, and its query then attends over the positions
+[0, cache_length] of the sequence. No copy of the cache is made, so the cost of a step only
+grows with the length of the attended prefix. The caller increments *cache_length* after
+each step.
+
+The shapes of the inputs are:
+
+- *queries_keys_values* : (1, batch_size, num_heads * head_dim * 3), interleaved like the
+  input of interleaved_matmul_selfatt_qk
+- *kv_cache* : (num_pages, 2, page_size, num_heads * head_dim), keys then values of every page
+- *page_table* : (batch_size, max_pages) in int32, the pages of kv_cache holding the positions
+  [p * page_size, (p + 1) * page_size) of each sequence
+- *cache_length* : (batch_size,) in int32, the number of tokens already cached per sequence
+
+The shape of the output is (1, batch_size, num_heads * head_dim).
+
+)code" ADD_FILELINE)
+    .set_num_inputs(4)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<InterleavedMatMulParam>)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          return std::vector<std::string>{
+              "queries_keys_values", "kv_cache", "page_table", "cache_length"};
+        })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"output"};
+                                      })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     return std::vector<uint32_t>{1};
+                                   })
+    .set_attr<mxnet::FInferShape>("FInferShape", InterleavedDecodeSelfAttShape)
+    .set_attr<nnvm::FInferType>("FInferType", InterleavedDecodeSelfAttType)
+    .set_attr<FCompute>("FCompute<cpu>", InterleavedDecodeSelfAttCPU)
+    .add_argument("queries_keys_values",
+                  "NDArray-or-Symbol",
+                  "Interleaved queries, keys and values of the new tokens")
+    .add_argument("kv_cache", "NDArray-or-Symbol", "Paged key/value cache, updated in place")
+    .add_argument("page_table", "NDArray-or-Symbol", "Pages of kv_cache used by each sequence")
+    .add_argument("cache_length", "NDArray-or-Symbol", "Number of cached tokens of each sequence")
+    .add_arguments(InterleavedMatMulParam::__FIELDS__());
+
 // relu
 MXNET_OPERATOR_REGISTER_UNARY(_contrib_div_sqrt_dim)
     .describe(R"code(Rescale the input by the square root of the channel dimension.
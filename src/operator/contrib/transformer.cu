@@ -26,6 +26,7 @@
 #include <cuda_runtime.h>
 #include <cuda_fp16.h>
 #include <cuda_profiler_api.h>
+#include <algorithm>
 
 #include <mxnet/base.h>
 #include "./transformer-inl.h"
@@ -751,6 +752,559 @@ void BackwardInterleavedMatMulEncDecValAttGPU(const nnvm::NodeAttrs& attrs,
   })
 }
 
+// Fused self attention: every warp owns one row (a query, or a key in the backward pass of
+// the keys and values) and keeps it in registers, kPerLane elements per lane, while the
+// block stages tiles of the other rows in shared memory.
+constexpr int kFusedSelfAttWarps = 4;
+
+#define FUSED_SELFATT_HEAD_DIM_SWITCH(head_dim, kPerLane, ...)               \
+  if ((head_dim) <= 32) {                                                    \
+    constexpr int kPerLane = 1;                                              \
+    { __VA_ARGS__ }                                                          \
+  } else if ((head_dim) <= 64) {                                             \
+    constexpr int kPerLane = 2;                                              \
+    { __VA_ARGS__ }                                                          \
+  } else if ((head_dim) <= 128) {                                            \
+    constexpr int kPerLane = 4;                                              \
+    { __VA_ARGS__ }                                                          \
+  } else if ((head_dim) <= 256) {                                            \
+    constexpr int kPerLane = 8;                                              \
+    { __VA_ARGS__ }                                                          \
+  } else {                                                                   \
+    LOG(FATAL) << "Fused self attention supports head_dim up to 256";        \
+  }
+
+template <typename AType>
+__device__ __forceinline__ AType FusedSelfAttWarpSum(AType value) {
+  return common::cuda::grouped_warp_allreduce(
+      value, [](AType x, AType y) { return x + y; }, common::cuda::warp_size);
+}
+
+template <int kPerLane, typename DType, typename AType>
+__device__ __forceinline__ void FusedSelfAttLoadRow(const DType* row,
+                                                    const int head_dim,
+                                                    const AType scale,
+                                                    AType (&dst)[kPerLane]) {
+  const int lane = threadIdx.x % common::cuda::warp_size;
+#pragma unroll
+  for (int j = 0; j < kPerLane; ++j) {
+    const int d = lane + j * common::cuda::warp_size;
+    dst[j]      = d < head_dim ? static_cast<AType>(row[d]) * scale : AType(0);
+  }
+}
+
+template <int kPerLane, typename AType, typename RType>
+__device__ __forceinline__ AType FusedSelfAttDot(const AType (&lhs)[kPerLane],
+                                                 const RType* rhs,
+                                                 const int head_dim) {
+  const int lane = threadIdx.x % common::cuda::warp_size;
+  AType sum      = 0;
+#pragma unroll
+  for (int j = 0; j < kPerLane; ++j) {
+    const int d = lane + j * common::cuda::warp_size;
+    if (d < head_dim)
+      sum += lhs[j] * static_cast<AType>(rhs[d]);
+  }
+  return FusedSelfAttWarpSum(sum);
+}
+
+template <int kPerLane, typename DType, typename AType>
+__global__ void InterleavedFusedSelfAttKernel(const DType* queries_keys_values,
+                                              const int32_t* valid_length,
+                                              DType* output,
+                                              float* logsumexp,
+                                              const int qkv_seq_len,
+                                              const int heads,
+                                              const int head_dim,
+                                              const int tile,
+                                              const bool causal,
+                                              const OpReqType req) {
+  extern __shared__ char fused_selfatt_smem[];
+  AType* keys   = reinterpret_cast<AType*>(fused_selfatt_smem);
+  AType* values = keys + tile * head_dim;
+
+  const int lane             = threadIdx.x % common::cuda::warp_size;
+  const int i                = blockIdx.y;
+  const index_t lead_dim     = static_cast<index_t>(gridDim.y) * 3 * head_dim;
+  const index_t out_lead_dim = static_cast<index_t>(gridDim.y) * head_dim;
+  const int len              = valid_length ? valid_length[i / heads] : qkv_seq_len;
+  const int q_begin          = blockIdx.x * kFusedSelfAttWarps;
+  const int q                = q_begin + threadIdx.x / common::cuda::warp_size;
+  const int q_last           = min(q_begin + kFusedSelfAttWarps, qkv_seq_len) - 1;
+  // the visible keys only grow with the query, so the last query of the block sees them all
+  const int block_end = FusedSelfAttKeyEnd(q_last, qkv_seq_len, len, causal);
+  const int end       = q < qkv_seq_len ? FusedSelfAttKeyEnd(q, qkv_seq_len, len, causal) : 0;
+  const DType* qkv_i  = queries_keys_values + i * 3 * head_dim;
+  const AType scale   = 1.0 / sqrt(static_cast<AType>(head_dim));
+
+  AType query[kPerLane], acc[kPerLane];
+  if (q < qkv_seq_len)
+    FusedSelfAttLoadRow(qkv_i + q * lead_dim, head_dim, scale, query);
+#pragma unroll
+  for (int j = 0; j < kPerLane; ++j)
+    acc[j] = 0;
+  AType row_max = -INFINITY, row_sum = 0;
+  for (int k0 = 0; k0 < block_end; k0 += tile) {
+    const int k1 = min(k0 + tile, block_end);
+    __syncthreads();
+    for (int e = threadIdx.x; e < (k1 - k0) * head_dim; e += blockDim.x) {
+      const DType* k_proj = qkv_i + (k0 + e / head_dim) * lead_dim + head_dim + e % head_dim;
+      keys[e]             = static_cast<AType>(k_proj[0]);
+      values[e]           = static_cast<AType>(k_proj[head_dim]);
+    }
+    __syncthreads();
+    for (int k = k0; k < min(k1, end); ++k) {
+      const AType s = FusedSelfAttDot(query, keys + (k - k0) * head_dim, head_dim);
+      if (s > row_max) {
+        const AType correction = exp(row_max - s);
+        row_sum *= correction;
+#pragma unroll
+        for (int j = 0; j < kPerLane; ++j)
+          acc[j] *= correction;
+        row_max = s;
+      }
+      const AType p       = exp(s - row_max);
+      const AType* v_proj = values + (k - k0) * head_dim;
+      row_sum += p;
+#pragma unroll
+      for (int j = 0; j < kPerLane; ++j) {
+        const int d = lane + j * common::cuda::warp_size;
+        if (d < head_dim)
+          acc[j] += p * v_proj[d];
+      }
+    }
+  }
+  if (q >= qkv_seq_len)
+    return;
+  DType* out     = output + q * out_lead_dim + i * head_dim;
+  const AType rs = end > 0 ? 1 / row_sum : 0;
+#pragma unroll
+  for (int j = 0; j < kPerLane; ++j) {
+    const int d = lane + j * common::cuda::warp_size;
+    if (d < head_dim)
+      KERNEL_ASSIGN(out[d], req, static_cast<DType>(acc[j] * rs));
+  }
+  if (lane == 0)
+    logsumexp[i * qkv_seq_len + q] = end > 0 ? row_max + log(row_sum) : -INFINITY;
+}
+
+template <int kPerLane, typename DType, typename AType>
+__global__ void BackwardInterleavedFusedSelfAttQKernel(const DType* output_grads,
+                                                       const DType* queries_keys_values,
+                                                       const int32_t* valid_length,
+                                                       const DType* output,
+                                                       const float* logsumexp,
+                                                       float* delta,
+                                                       DType* queries_keys_values_grads,
+                                                       const int qkv_seq_len,
+                                                       const int heads,
+                                                       const int head_dim,
+                                                       const int tile,
+                                                       const bool causal,
+                                                       const OpReqType req) {
+  extern __shared__ char fused_selfatt_smem[];
+  AType* keys   = reinterpret_cast<AType*>(fused_selfatt_smem);
+  AType* values = keys + tile * head_dim;
+
+  const int lane             = threadIdx.x % common::cuda::warp_size;
+  const int i                = blockIdx.y;
+  const index_t lead_dim     = static_cast<index_t>(gridDim.y) * 3 * head_dim;
+  const index_t out_lead_dim = static_cast<index_t>(gridDim.y) * head_dim;
+  const int len              = valid_length ? valid_length[i / heads] : qkv_seq_len;
+  const int q_begin          = blockIdx.x * kFusedSelfAttWarps;
+  const int q                = q_begin + threadIdx.x / common::cuda::warp_size;
+  const int q_last           = min(q_begin + kFusedSelfAttWarps, qkv_seq_len) - 1;
+  const int block_end        = FusedSelfAttKeyEnd(q_last, qkv_seq_len, len, causal);
+  const int end = q < qkv_seq_len ? FusedSelfAttKeyEnd(q, qkv_seq_len, len, causal) : 0;
+  const DType* qkv_i         = queries_keys_values + i * 3 * head_dim;
+  const AType scale          = 1.0 / sqrt(static_cast<AType>(head_dim));
+
+  AType query[kPerLane], ograd[kPerLane], out[kPerLane], grad[kPerLane];
+  AType row_lse = 0, row_delta = 0;
+  if (q < qkv_seq_len) {
+    FusedSelfAttLoadRow(qkv_i + q * lead_dim, head_dim, scale, query);
+    FusedSelfAttLoadRow(output_grads + q * out_lead_dim + i * head_dim, head_dim, AType(1), ograd);
+    FusedSelfAttLoadRow(output + q * out_lead_dim + i * head_dim, head_dim, AType(1), out);
+#pragma unroll
+    for (int j = 0; j < kPerLane; ++j)
+      row_delta += ograd[j] * out[j];
+    row_delta = FusedSelfAttWarpSum(row_delta);
+    row_lse   = logsumexp[i * qkv_seq_len + q];
+    if (lane == 0)
+      delta[i * qkv_seq_len + q] = row_delta;
+  }
+#pragma unroll
+  for (int j = 0; j < kPerLane; ++j)
+    grad[j] = 0;
+  for (int k0 = 0; k0 < block_end; k0 += tile) {
+    const int k1 = min(k0 + tile, block_end);
+    __syncthreads();
+    for (int e = threadIdx.x; e < (k1 - k0) * head_dim; e += blockDim.x) {
+      const DType* k_proj = qkv_i + (k0 + e / head_dim) * lead_dim + head_dim + e % head_dim;
+      keys[e]             = static_cast<AType>(k_proj[0]);
+      values[e]           = static_cast<AType>(k_proj[head_dim]);
+    }
+    __syncthreads();
+    for (int k = k0; k < min(k1, end); ++k) {
+      const AType* k_proj = keys + (k - k0) * head_dim;
+      const AType p       = exp(FusedSelfAttDot(query, k_proj, head_dim) - row_lse);
+      const AType dp      = FusedSelfAttDot(ograd, values + (k - k0) * head_dim, head_dim);
+      const AType ds      = p * (dp - row_delta);
+#pragma unroll
+      for (int j = 0; j < kPerLane; ++j) {
+        const int d = lane + j * common::cuda::warp_size;
+        if (d < head_dim)
+          grad[j] += ds * k_proj[d];
+      }
+    }
+  }
+  if (q >= qkv_seq_len)
+    return;
+  DType* q_grad = queries_keys_values_grads + q * lead_dim + i * 3 * head_dim;
+#pragma unroll
+  for (int j = 0; j < kPerLane; ++j) {
+    const int d = lane + j * common::cuda::warp_size;
+    if (d < head_dim)
+      KERNEL_ASSIGN(q_grad[d], req, static_cast<DType>(grad[j] * scale));
+  }
+}
+
+template <int kPerLane, typename DType, typename AType>
+__global__ void BackwardInterleavedFusedSelfAttKVKernel(const DType* output_grads,
+                                                        const DType* queries_keys_values,
+                                                        const int32_t* valid_length,
+                                                        const float* logsumexp,
+                                                        const float* delta,
+                                                        DType* queries_keys_values_grads,
+                                                        const int qkv_seq_len,
+                                                        const int heads,
+                                                        const int head_dim,
+                                                        const int tile,
+                                                        const bool causal,
+                                                        const OpReqType req) {
+  extern __shared__ char fused_selfatt_smem[];
+  AType* queries    = reinterpret_cast<AType*>(fused_selfatt_smem);
+  AType* ograds     = queries + tile * head_dim;
+  AType* tile_lse   = ograds + tile * head_dim;
+  AType* tile_delta = tile_lse + tile;
+
+  const int lane             = threadIdx.x % common::cuda::warp_size;
+  const int i                = blockIdx.y;
+  const index_t lead_dim     = static_cast<index_t>(gridDim.y) * 3 * head_dim;
+  const index_t out_lead_dim = static_cast<index_t>(gridDim.y) * head_dim;
+  const int len              = valid_length ? valid_length[i / heads] : qkv_seq_len;
+  const int k_begin          = blockIdx.x * kFusedSelfAttWarps;
+  const int k                = k_begin + threadIdx.x / common::cuda::warp_size;
+  // key k is seen by the queries q with k < FusedSelfAttKeyEnd(q), i.e. q >= k when causal
+  const bool visible   = k < min(len, qkv_seq_len);
+  const int q_start    = causal ? k_begin : 0;
+  const int block_keys = min(k_begin + kFusedSelfAttWarps, min(len, qkv_seq_len));
+  const DType* qkv_i   = queries_keys_values + i * 3 * head_dim;
+  const AType scale    = 1.0 / sqrt(static_cast<AType>(head_dim));
+
+  AType key[kPerLane], value[kPerLane], k_grad[kPerLane], v_grad[kPerLane];
+  if (k < qkv_seq_len) {
+    FusedSelfAttLoadRow(qkv_i + k * lead_dim + head_dim, head_dim, AType(1), key);
+    FusedSelfAttLoadRow(qkv_i + k * lead_dim + 2 * head_dim, head_dim, AType(1), value);
+  }
+#pragma unroll
+  for (int j = 0; j < kPerLane; ++j) {
+    k_grad[j] = 0;
+    v_grad[j] = 0;
+  }
+  for (int q0 = block_keys > k_begin ? q_start : qkv_seq_len; q0 < qkv_seq_len; q0 += tile) {
+    const int q1 = min(q0 + tile, qkv_seq_len);
+    __syncthreads();
+    for (int e = threadIdx.x; e < (q1 - q0) * head_dim; e += blockDim.x) {
+      const int t = q0 + e / head_dim;
+      const int d = e % head_dim;
+      queries[e]  = static_cast<AType>(qkv_i[t * lead_dim + d]) * scale;
+      ograds[e]   = static_cast<AType>(output_grads[t * out_lead_dim + i * head_dim + d]);
+    }
+    for (int t = threadIdx.x; t < q1 - q0; t += blockDim.x) {
+      tile_lse[t]   = logsumexp[i * qkv_seq_len + q0 + t];
+      tile_delta[t] = delta[i * qkv_seq_len + q0 + t];
+    }
+    __syncthreads();
+    if (!visible)
+      continue;
+    for (int q = max(q0, causal ? k : 0); q < q1; ++q) {
+      const AType* q_proj = queries + (q - q0) * head_dim;
+      const AType* ograd  = ograds + (q - q0) * head_dim;
+      const AType p       = exp(FusedSelfAttDot(key, q_proj, head_dim) - tile_lse[q - q0]);
+      const AType dp      = FusedSelfAttDot(value, ograd, head_dim);
+      const AType ds      = p * (dp - tile_delta[q - q0]);
+#pragma unroll
+      for (int j = 0; j < kPerLane; ++j) {
+        const int d = lane + j * common::cuda::warp_size;
+        if (d < head_dim) {
+          k_grad[j] += ds * q_proj[d];
+          v_grad[j] += p * ograd[d];
+        }
+      }
+    }
+  }
+  if (k >= qkv_seq_len)
+    return;
+  DType* grads = queries_keys_values_grads + k * lead_dim + i * 3 * head_dim + head_dim;
+#pragma unroll
+  for (int j = 0; j < kPerLane; ++j) {
+    const int d = lane + j * common::cuda::warp_size;
+    if (d < head_dim) {
+      KERNEL_ASSIGN(grads[d], req, static_cast<DType>(k_grad[j]));
+      KERNEL_ASSIGN(grads[head_dim + d], req, static_cast<DType>(v_grad[j]));
+    }
+  }
+}
+
+// Decoding attention: a block per (sequence, head), whose warps split the cached positions
+// and keep their own running max and sum, merged through shared memory at the end.
+constexpr int kDecodeSelfAttWarps = 8;
+
+template <int kPerLane, typename DType, typename AType>
+__global__ void InterleavedDecodeSelfAttKernel(const DType* queries_keys_values,
+                                               DType* kv_cache,
+                                               const int32_t* page_table,
+                                               const int32_t* cache_length,
+                                               DType* output,
+                                               const int heads,
+                                               const int head_dim,
+                                               const int page_size,
+                                               const int max_pages,
+                                               const OpReqType req) {
+  extern __shared__ char decode_selfatt_smem[];
+  AType* warp_acc = reinterpret_cast<AType*>(decode_selfatt_smem);
+  AType* warp_max = warp_acc + kDecodeSelfAttWarps * head_dim;
+  AType* warp_sum = warp_max + kDecodeSelfAttWarps;
+
+  const int lane              = threadIdx.x % common::cuda::warp_size;
+  const int warp              = threadIdx.x / common::cuda::warp_size;
+  const int b                 = blockIdx.x / heads;
+  const int h                 = blockIdx.x % heads;
+  const int embed_dim         = heads * head_dim;
+  const index_t page_stride   = static_cast<index_t>(2) * page_size * embed_dim;
+  const int pos               = cache_length[b];
+  const int32_t* pages        = page_table + b * max_pages;
+  const DType* qkv_i          = queries_keys_values + blockIdx.x * 3 * head_dim;
+  const AType scale           = 1.0 / sqrt(static_cast<AType>(head_dim));
+  auto key_row                = [&](int t) {
+    return kv_cache + pages[t / page_size] * page_stride + (t % page_size) * embed_dim +
+           h * head_dim;
+  };
+
+  // the new key and value are appended before any warp reads position pos
+  DType* slot = key_row(pos);
+  for (int d = threadIdx.x; d < head_dim; d += blockDim.x) {
+    slot[d]                         = qkv_i[head_dim + d];
+    slot[page_size * embed_dim + d] = qkv_i[2 * head_dim + d];
+  }
+  __syncthreads();
+
+  AType query[kPerLane], acc[kPerLane];
+  FusedSelfAttLoadRow(qkv_i, head_dim, scale, query);
+#pragma unroll
+  for (int j = 0; j < kPerLane; ++j)
+    acc[j] = 0;
+  AType row_max = -INFINITY, row_sum = 0;
+  for (int t = warp; t <= pos; t += kDecodeSelfAttWarps) {
+    const DType* k_proj = key_row(t);
+    const AType s       = FusedSelfAttDot(query, k_proj, head_dim);
+    if (s > row_max) {
+      const AType correction = exp(row_max - s);
+      row_sum *= correction;
+#pragma unroll
+      for (int j = 0; j < kPerLane; ++j)
+        acc[j] *= correction;
+      row_max = s;
+    }
+    const AType p       = exp(s - row_max);
+    const DType* v_proj = k_proj + page_size * embed_dim;
+    row_sum += p;
+#pragma unroll
+    for (int j = 0; j < kPerLane; ++j) {
+      const int d = lane + j * common::cuda::warp_size;
+      if (d < head_dim)
+        acc[j] += p * static_cast<AType>(v_proj[d]);
+    }
+  }
+#pragma unroll
+  for (int j = 0; j < kPerLane; ++j) {
+    const int d = lane + j * common::cuda::warp_size;
+    if (d < head_dim)
+      warp_acc[warp * head_dim + d] = acc[j];
+  }
+  if (lane == 0) {
+    warp_max[warp] = row_max;
+    warp_sum[warp] = row_sum;
+  }
+  __syncthreads();
+
+  // position 0 is always attended, so the max over the warps is finite
+  AType max = -INFINITY;
+  for (int w = 0; w < kDecodeSelfAttWarps; ++w)
+    max = warp_max[w] > max ? warp_max[w] : max;
+  AType sum = 0;
+  for (int w = 0; w < kDecodeSelfAttWarps; ++w)
+    sum += exp(warp_max[w] - max) * warp_sum[w];
+  DType* out = output + blockIdx.x * head_dim;
+  for (int d = threadIdx.x; d < head_dim; d += blockDim.x) {
+    AType value = 0;
+    for (int w = 0; w < kDecodeSelfAttWarps; ++w)
+      value += exp(warp_max[w] - max) * warp_acc[w * head_dim + d];
+    KERNEL_ASSIGN(out[d], req, static_cast<DType>(value / sum));
+  }
+}
+
+// rows staged per tile so that a block stays within 48kb of shared memory
+template <typename AType>
+inline int FusedSelfAttTile(const int head_dim) {
+  const int rows = 48 * 1024 / ((2 * head_dim + 2) * static_cast<int>(sizeof(AType)));
+  return std::max(1, std::min(32, rows));
+}
+
+void InterleavedFusedSelfAttGPU(const nnvm::NodeAttrs& attrs,
+                                const OpContext& ctx,
+                                const std::vector<TBlob>& inputs,
+                                const std::vector<OpReqType>& req,
+                                const std::vector<TBlob>& outputs) {
+  const auto& params          = nnvm::get<InterleavedFusedSelfAttParam>(attrs.parsed);
+  mshadow::Stream<gpu>* s     = ctx.get_stream<gpu>();
+  const int32_t qkv_seq_len   = inputs[0].shape_[0];
+  const int32_t sequences     = inputs[0].shape_[1];
+  const int32_t head_dim      = inputs[0].shape_[2] / 3 / params.heads;
+  const int32_t attn_batches  = params.heads * sequences;
+  const int32_t* valid_length =
+      params.use_length ? inputs[1].dptr<int32_t>() : static_cast<int32_t*>(nullptr);
+  CHECK_LE(attn_batches, 65535) << "Fused self attention supports up to 65535 heads * batch";
+  if (qkv_seq_len == 0 || attn_batches == 0)
+    return;
+  const dim3 grid((qkv_seq_len + kFusedSelfAttWarps - 1) / kFusedSelfAttWarps, attn_batches);
+  const int threads = kFusedSelfAttWarps * common::cuda::warp_size;
+  MSHADOW_REAL_TYPE_SWITCH_EX(inputs[0].type_flag_, DType, AType, {
+    const int tile = FusedSelfAttTile<AType>(head_dim);
+    FUSED_SELFATT_HEAD_DIM_SWITCH(head_dim, kPerLane, {
+      InterleavedFusedSelfAttKernel<kPerLane, DType, AType>
+          <<<grid, threads, 2 * tile * head_dim * sizeof(AType), s->stream_>>>(
+              inputs[0].dptr<DType>(),
+              valid_length,
+              outputs[0].dptr<DType>(),
+              outputs[1].dptr<float>(),
+              qkv_seq_len,
+              params.heads,
+              head_dim,
+              tile,
+              params.causal,
+              req[0]);
+    });
+  });
+  MSHADOW_CUDA_POST_KERNEL_CHECK(InterleavedFusedSelfAttKernel);
+}
+
+void BackwardInterleavedFusedSelfAttGPU(const nnvm::NodeAttrs& attrs,
+                                        const OpContext& ctx,
+                                        const std::vector<TBlob>& inputs,
+                                        const std::vector<OpReqType>& req,
+                                        const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const auto& params      = nnvm::get<InterleavedFusedSelfAttParam>(attrs.parsed);
+  mshadow::Stream<gpu>* s = ctx.get_stream<gpu>();
+  // inputs: output_grads, queries_keys_values, [valid_length], output, logsumexp
+  const TBlob& qkv            = inputs[1];
+  const TBlob& output         = inputs[params.use_length ? 3 : 2];
+  const TBlob& logsumexp      = inputs[params.use_length ? 4 : 3];
+  const int32_t* valid_length =
+      params.use_length ? inputs[2].dptr<int32_t>() : static_cast<int32_t*>(nullptr);
+  if (params.use_length && req[1] != kNullOp) {
+    Kernel<set_zero, gpu>::Launch(s, outputs[1].Size(), outputs[1].dptr<int32_t>());
+  }
+  if (req[0] == kNullOp)
+    return;
+
+  const int32_t qkv_seq_len  = qkv.shape_[0];
+  const int32_t sequences    = qkv.shape_[1];
+  const int32_t head_dim     = qkv.shape_[2] / 3 / params.heads;
+  const int32_t attn_batches = params.heads * sequences;
+  CHECK_LE(attn_batches, 65535) << "Fused self attention supports up to 65535 heads * batch";
+  if (qkv_seq_len == 0 || attn_batches == 0)
+    return;
+  float* delta = ctx.requested[0]
+                     .get_space_typed<gpu, 1, float>(mshadow::Shape1(attn_batches * qkv_seq_len), s)
+                     .dptr_;
+  const dim3 grid((qkv_seq_len + kFusedSelfAttWarps - 1) / kFusedSelfAttWarps, attn_batches);
+  const int threads = kFusedSelfAttWarps * common::cuda::warp_size;
+  MSHADOW_REAL_TYPE_SWITCH_EX(qkv.type_flag_, DType, AType, {
+    const int tile = FusedSelfAttTile<AType>(head_dim);
+    FUSED_SELFATT_HEAD_DIM_SWITCH(head_dim, kPerLane, {
+      BackwardInterleavedFusedSelfAttQKernel<kPerLane, DType, AType>
+          <<<grid, threads, 2 * tile * head_dim * sizeof(AType), s->stream_>>>(
+              inputs[0].dptr<DType>(),
+              qkv.dptr<DType>(),
+              valid_length,
+              output.dptr<DType>(),
+              logsumexp.dptr<float>(),
+              delta,
+              outputs[0].dptr<DType>(),
+              qkv_seq_len,
+              params.heads,
+              head_dim,
+              tile,
+              params.causal,
+              req[0]);
+      MSHADOW_CUDA_POST_KERNEL_CHECK(BackwardInterleavedFusedSelfAttQKernel);
+      BackwardInterleavedFusedSelfAttKVKernel<kPerLane, DType, AType>
+          <<<grid, threads, (2 * head_dim + 2) * tile * sizeof(AType), s->stream_>>>(
+              inputs[0].dptr<DType>(),
+              qkv.dptr<DType>(),
+              valid_length,
+              logsumexp.dptr<float>(),
+              delta,
+              outputs[0].dptr<DType>(),
+              qkv_seq_len,
+              params.heads,
+              head_dim,
+              tile,
+              params.causal,
+              req[0]);
+      MSHADOW_CUDA_POST_KERNEL_CHECK(BackwardInterleavedFusedSelfAttKVKernel);
+    });
+  });
+}
+
+void InterleavedDecodeSelfAttGPU(const nnvm::NodeAttrs& attrs,
+                                 const OpContext& ctx,
+                                 const std::vector<TBlob>& inputs,
+                                 const std::vector<OpReqType>& req,
+                                 const std::vector<TBlob>& outputs) {
+  const auto& params       = nnvm::get<InterleavedMatMulParam>(attrs.parsed);
+  mshadow::Stream<gpu>* s  = ctx.get_stream<gpu>();
+  const int32_t sequences  = inputs[0].shape_[1];
+  const int32_t head_dim   = inputs[0].shape_[2] / 3 / params.heads;
+  const int32_t page_size  = inputs[1].shape_[2];
+  const int32_t max_pages  = inputs[2].shape_[1];
+  const int32_t num_blocks = sequences * params.heads;
+  if (num_blocks == 0)
+    return;
+  // cache_length and page_table live on the device and are not validated here
+  const int threads = kDecodeSelfAttWarps * common::cuda::warp_size;
+  MSHADOW_REAL_TYPE_SWITCH_EX(inputs[0].type_flag_, DType, AType, {
+    const size_t smem = (head_dim + 2) * kDecodeSelfAttWarps * sizeof(AType);
+    FUSED_SELFATT_HEAD_DIM_SWITCH(head_dim, kPerLane, {
+      InterleavedDecodeSelfAttKernel<kPerLane, DType, AType>
+          <<<num_blocks, threads, smem, s->stream_>>>(inputs[0].dptr<DType>(),
+                                                      inputs[1].dptr<DType>(),
+                                                      inputs[2].dptr<int32_t>(),
+                                                      inputs[3].dptr<int32_t>(),
+                                                      outputs[0].dptr<DType>(),
+                                                      params.heads,
+                                                      head_dim,
+                                                      page_size,
+                                                      max_pages,
+                                                      req[0]);
+    });
+  });
+  MSHADOW_CUDA_POST_KERNEL_CHECK(InterleavedDecodeSelfAttKernel);
+}
+
 NNVM_REGISTER_OP(_contrib_interleaved_matmul_selfatt_qk)
     .set_attr<FCompute>("FCompute<gpu>", InterleavedMatMulSelfAttQKGPU);
 
@@ -775,6 +1329,15 @@ NNVM_REGISTER_OP(_backward_interleaved_matmul_encdec_qk)
 NNVM_REGISTER_OP(_backward_interleaved_matmul_encdec_valatt)
     .set_attr<FCompute>("FCompute<gpu>", BackwardInterleavedMatMulEncDecValAttGPU);
 
+NNVM_REGISTER_OP(_contrib_interleaved_fused_selfatt)
+    .set_attr<FCompute>("FCompute<gpu>", InterleavedFusedSelfAttGPU);
+
+NNVM_REGISTER_OP(_backward_interleaved_fused_selfatt)
+    .set_attr<FCompute>("FCompute<gpu>", BackwardInterleavedFusedSelfAttGPU);
+
+NNVM_REGISTER_OP(_contrib_interleaved_decode_selfatt)
+    .set_attr<FCompute>("FCompute<gpu>", InterleavedDecodeSelfAttGPU);
+
 // relu
 NNVM_REGISTER_OP(_contrib_div_sqrt_dim)
     .set_attr<FCompute>("FCompute<gpu>", DivSqrtDimForward_<gpu>);
@@ -0,0 +1,329 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file weight_only_fully_connected-inl.h
+ * \brief Fully connected layer with int8/int4 weights and group-wise scales, dequantized on the
+ *        fly, for memory bound inference
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_WEIGHT_ONLY_FULLY_CONNECTED_INL_H_
+#define MXNET_OPERATOR_CONTRIB_WEIGHT_ONLY_FULLY_CONNECTED_INL_H_
+
+#include <mxnet/operator_util.h>
+#include <cmath>
+#include <vector>
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+#include "../nn/fully_connected-inl.h"
+
+namespace mxnet {
+namespace op {
+
+namespace woq {
+enum WeightOnlyQuantizeOpOutputs { kQuantizedWeight, kScale };
+enum WeightOnlyFullyConnectedOpInputs { kData, kWeight, kScale, kBias };
+enum WeightOnlyFullyConnectedOpOutputs { kOut };
+}  // namespace woq
+
+// above this number of rows of data the weight is dequantized once and multiplied with the GEMM of
+// FullyConnected, below the layer is bound by the weight reads and dequantizes inside the product
+constexpr index_t kWeightOnlyGemvMaxRows = 32;
+
+struct WeightOnlyQuantizeParam : public dmlc::Parameter<WeightOnlyQuantizeParam> {
+  int bits;
+  int group_size;
+  DMLC_DECLARE_PARAMETER(WeightOnlyQuantizeParam) {
+    DMLC_DECLARE_FIELD(bits).set_default(4).describe(
+        "Bits of the quantized weight, 8 or 4. Two int4 values are packed in each int8, the one of "
+        "the even input column in the low half.");
+    DMLC_DECLARE_FIELD(group_size)
+        .set_default(128)
+        .set_lower_bound(0)
+        .describe(
+            "Number of consecutive input columns sharing a scale, 0 for one scale per output "
+            "row. It must be even for int4.");
+  }
+};
+
+struct WeightOnlyFullyConnectedParam : public dmlc::Parameter<WeightOnlyFullyConnectedParam> {
+  int num_hidden;
+  bool no_bias;
+  bool flatten;
+  int bits;
+  int group_size;
+  DMLC_DECLARE_PARAMETER(WeightOnlyFullyConnectedParam) {
+    DMLC_DECLARE_FIELD(num_hidden)
+        .set_lower_bound(1)
+        .describe("Number of hidden nodes of the output.");
+    DMLC_DECLARE_FIELD(no_bias).set_default(false).describe("Whether to disable bias parameter.");
+    DMLC_DECLARE_FIELD(flatten).set_default(true).describe(
+        "Whether to collapse all but the first axis of the input data tensor.");
+    DMLC_DECLARE_FIELD(bits).set_default(4).describe("Bits of the quantized weight, 8 or 4.");
+    DMLC_DECLARE_FIELD(group_size)
+        .set_default(128)
+        .set_lower_bound(0)
+        .describe("Number of consecutive input columns sharing a scale, 0 for one per row.");
+  }
+
+  FullyConnectedParam FCParam() const {
+    FullyConnectedParam param;
+    param.num_hidden = num_hidden;
+    param.no_bias    = no_bias;
+    param.flatten    = flatten;
+    return param;
+  }
+};
+
+inline void WeightOnlyCheckParam(const int bits, const int group_size) {
+  CHECK(bits == 4 || bits == 8) << "weight only quantization supports 4 and 8 bits, got " << bits;
+  CHECK(bits == 8 || group_size % 2 == 0)
+      << "int4 weights need an even group_size, so that no packed int8 straddles two groups";
+}
+
+/*! \brief Number of int8 holding a row of num_input quantized weights */
+MSHADOW_XINLINE index_t WeightOnlyPackedRowSize(const index_t num_input, const int bits) {
+  return bits == 4 ? (num_input + 1) / 2 : num_input;
+}
+
+/*! \brief Number of scales of a row of num_input weights */
+MSHADOW_XINLINE index_t WeightOnlyNumGroups(const index_t num_input, const int group_size) {
+  return group_size == 0 ? 1 : (num_input + group_size - 1) / group_size;
+}
+
+/*! \brief Quantized value of input column k of a packed row */
+template <int bits>
+MSHADOW_XINLINE int WeightOnlyLoad(const int8_t* row, const index_t k) {
+  if (bits == 8)
+    return row[k];
+  const int8_t packed = row[k >> 1];
+  // the shifts of the signed byte extend the sign of the nibble
+  return (k & 1) ? (packed >> 4) : (static_cast<int8_t>(packed << 4) >> 4);
+}
+
+/*!
+ * \brief Symmetric quantization of a group of a weight row: the scale maps the absolute maximum of
+ *        the group to the largest quantized value.
+ */
+template <int bits>
+struct weight_only_quantize {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  int8_t* qweight,
+                                  float* scale,
+                                  const DType* weight,
+                                  const index_t num_input,
+                                  const index_t group_size,
+                                  const index_t num_groups) {
+    const float qmax    = bits == 4 ? 7.f : 127.f;
+    const index_t row   = i / num_groups;
+    const index_t begin = (i % num_groups) * group_size;
+    const index_t end   = begin + group_size < num_input ? begin + group_size : num_input;
+    const DType* w      = weight + row * num_input;
+    float amax          = 0.f;
+    for (index_t k = begin; k < end; ++k) {
+      const float a = fabsf(static_cast<float>(w[k]));
+      amax          = a > amax ? a : amax;
+    }
+    const float s = amax / qmax;
+    scale[i]      = s;
+    int8_t* q     = qweight + row * WeightOnlyPackedRowSize(num_input, bits);
+    for (index_t k = begin; k < end; ++k) {
+      float v = s > 0.f ? rintf(static_cast<float>(w[k]) / s) : 0.f;
+      v       = v > qmax ? qmax : (v < -qmax ? -qmax : v);
+      if (bits == 8) {
+        q[k] = static_cast<int8_t>(v);
+      } else if (k & 1) {
+        q[k >> 1] = static_cast<int8_t>((q[k >> 1] & 0x0F) | ((static_cast<int>(v) & 0x0F) << 4));
+      } else {
+        // the even column comes first and clears the odd half, left as zero past an odd num_input
+        q[k >> 1] = static_cast<int8_t>(static_cast<int>(v) & 0x0F);
+      }
+    }
+  }
+};
+
+template <int bits>
+struct weight_only_dequantize {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* weight,
+                                  const int8_t* qweight,
+                                  const float* scale,
+                                  const index_t num_input,
+                                  const index_t group_size,
+                                  const index_t num_groups) {
+    const index_t row = i / num_input;
+    const index_t k   = i % num_input;
+    const int8_t* q   = qweight + row * WeightOnlyPackedRowSize(num_input, bits);
+    const float s     = scale[row * num_groups + k / group_size];
+    weight[i]         = static_cast<DType>(WeightOnlyLoad<bits>(q, k) * s);
+  }
+};
+
+/*!
+ * \brief out = data * dequantize(qweight)^T (+ bias) for few rows of data, each weight is read and
+ *        dequantized once. Implemented in the .cc/.cu.
+ */
+template <typename DType>
+void WeightOnlyGemv(mshadow::Stream<cpu>* s,
+                    const OpContext& ctx,
+                    const DType* data,
+                    const int8_t* qweight,
+                    const float* scale,
+                    const DType* bias,
+                    DType* out,
+                    const OpReqType req,
+                    const index_t num_rows,
+                    const index_t num_hidden,
+                    const index_t num_input,
+                    const int bits,
+                    const index_t group_size,
+                    const index_t num_groups);
+
+template <typename DType>
+void WeightOnlyGemv(mshadow::Stream<gpu>* s,
+                    const OpContext& ctx,
+                    const DType* data,
+                    const int8_t* qweight,
+                    const float* scale,
+                    const DType* bias,
+                    DType* out,
+                    const OpReqType req,
+                    const index_t num_rows,
+                    const index_t num_hidden,
+                    const index_t num_input,
+                    const int bits,
+                    const index_t group_size,
+                    const index_t num_groups);
+
+template <typename xpu>
+void WeightOnlyQuantizeCompute(const nnvm::NodeAttrs& attrs,
+                               const OpContext& ctx,
+                               const std::vector<TBlob>& inputs,
+                               const std::vector<OpReqType>& req,
+                               const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const WeightOnlyQuantizeParam& param = nnvm::get<WeightOnlyQuantizeParam>(attrs.parsed);
+  CHECK_EQ(inputs.size(), 1U);
+  CHECK_EQ(outputs.size(), 2U);
+  mshadow::Stream<xpu>* s  = ctx.get_stream<xpu>();
+  const TBlob& weight      = inputs[0];
+  const index_t num_input  = weight.shape_[1];
+  const index_t group_size = param.group_size == 0 ? num_input : param.group_size;
+  const index_t num_groups = WeightOnlyNumGroups(num_input, param.group_size);
+  MSHADOW_REAL_TYPE_SWITCH(weight.type_flag_, DType, {
+    if (param.bits == 4) {
+      Kernel<weight_only_quantize<4>, xpu>::Launch(s,
+                                                   outputs[woq::kScale].Size(),
+                                                   outputs[woq::kQuantizedWeight].dptr<int8_t>(),
+                                                   outputs[woq::kScale].dptr<float>(),
+                                                   weight.dptr<DType>(),
+                                                   num_input,
+                                                   group_size,
+                                                   num_groups);
+    } else {
+      Kernel<weight_only_quantize<8>, xpu>::Launch(s,
+                                                   outputs[woq::kScale].Size(),
+                                                   outputs[woq::kQuantizedWeight].dptr<int8_t>(),
+                                                   outputs[woq::kScale].dptr<float>(),
+                                                   weight.dptr<DType>(),
+                                                   num_input,
+                                                   group_size,
+                                                   num_groups);
+    }
+  });
+}
+
+template <typename xpu>
+void WeightOnlyFullyConnectedForward(const nnvm::NodeAttrs& attrs,
+                                     const OpContext& ctx,
+                                     const std::vector<TBlob>& inputs,
+                                     const std::vector<OpReqType>& req,
+                                     const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  const WeightOnlyFullyConnectedParam& param =
+      nnvm::get<WeightOnlyFullyConnectedParam>(attrs.parsed);
+  CHECK_EQ(inputs.size(), param.no_bias ? 3U : 4U);
+  CHECK_EQ(outputs.size(), 1U);
+  if (req[woq::kOut] == kNullOp)
+    return;
+  Stream<xpu>* s           = ctx.get_stream<xpu>();
+  const TBlob& qweight     = inputs[woq::kWeight];
+  const TBlob& scale       = inputs[woq::kScale];
+  const index_t num_hidden = param.num_hidden;
+  const index_t num_groups = scale.shape_[1];
+  MSHADOW_REAL_TYPE_SWITCH(inputs[woq::kData].type_flag_, DType, {
+    Tensor<xpu, 2, DType> data = param.flatten ?
+                                     FlattenAs2DTail<xpu, DType>(inputs[woq::kData], ctx) :
+                                     FlattenAs2DHead<xpu, DType>(inputs[woq::kData], ctx);
+    Tensor<xpu, 2, DType> out  = param.flatten ?
+                                    FlattenAs2DTail<xpu, DType>(outputs[woq::kOut], ctx) :
+                                    FlattenAs2DHead<xpu, DType>(outputs[woq::kOut], ctx);
+    const index_t num_input  = data.shape_[1];
+    const index_t group_size = param.group_size == 0 ? num_input : param.group_size;
+    if (data.shape_[0] <= kWeightOnlyGemvMaxRows) {
+      WeightOnlyGemv(s,
+                     ctx,
+                     data.dptr_,
+                     qweight.dptr<int8_t>(),
+                     scale.dptr<float>(),
+                     param.no_bias ? nullptr : inputs[woq::kBias].dptr<DType>(),
+                     out.dptr_,
+                     req[woq::kOut],
+                     data.shape_[0],
+                     num_hidden,
+                     num_input,
+                     param.bits,
+                     group_size,
+                     num_groups);
+      return;
+    }
+    // large batches are compute bound, the weight is dequantized into the temporary space
+    Tensor<xpu, 2, DType> weight =
+        ctx.requested[0].get_space_typed<xpu, 2, DType>(Shape2(num_hidden, num_input), s);
+    if (param.bits == 4) {
+      Kernel<weight_only_dequantize<4>, xpu>::Launch(s,
+                                                     weight.shape_.Size(),
+                                                     weight.dptr_,
+                                                     qweight.dptr<int8_t>(),
+                                                     scale.dptr<float>(),
+                                                     num_input,
+                                                     group_size,
+                                                     num_groups);
+    } else {
+      Kernel<weight_only_dequantize<8>, xpu>::Launch(s,
+                                                     weight.shape_.Size(),
+                                                     weight.dptr_,
+                                                     qweight.dptr<int8_t>(),
+                                                     scale.dptr<float>(),
+                                                     num_input,
+                                                     group_size,
+                                                     num_groups);
+    }
+    std::vector<TBlob> fc_inputs{inputs[woq::kData], TBlob(weight)};
+    if (!param.no_bias)
+      fc_inputs.push_back(inputs[woq::kBias]);
+    FCForward<xpu, DType>(ctx, param.FCParam(), fc_inputs, req, outputs);
+  });
+}
+
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_OPERATOR_CONTRIB_WEIGHT_ONLY_FULLY_CONNECTED_INL_H_
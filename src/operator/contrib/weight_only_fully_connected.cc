@@ -0,0 +1,248 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file weight_only_fully_connected.cc
+ * \brief Fully connected layer with int8/int4 weights and group-wise scales, dequantized on the
+ *        fly, for memory bound inference
+ */
+#include <algorithm>
+#include "./weight_only_fully_connected-inl.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(WeightOnlyQuantizeParam);
+DMLC_REGISTER_PARAMETER(WeightOnlyFullyConnectedParam);
+
+template <int bits>
+static void WeightOnlyDequantizeRow(float* w,
+                                    const int8_t* q,
+                                    const float* scale,
+                                    const index_t num_input,
+                                    const index_t group_size) {
+  for (index_t begin = 0, g = 0; begin < num_input; begin += group_size, ++g) {
+    const index_t end = std::min(begin + group_size, num_input);
+    for (index_t k = begin; k < end; ++k)
+      w[k] = WeightOnlyLoad<bits>(q, k) * scale[g];
+  }
+}
+
+template <typename DType>
+void WeightOnlyGemv(mshadow::Stream<cpu>* s,
+                    const OpContext& ctx,
+                    const DType* data,
+                    const int8_t* qweight,
+                    const float* scale,
+                    const DType* bias,
+                    DType* out,
+                    const OpReqType req,
+                    const index_t num_rows,
+                    const index_t num_hidden,
+                    const index_t num_input,
+                    const int bits,
+                    const index_t group_size,
+                    const index_t num_groups) {
+  const int nthreads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  const index_t packed_row_size = WeightOnlyPackedRowSize(num_input, bits);
+  // each thread dequantizes one weight row at a time and multiplies it with all the data rows
+  mshadow::Tensor<cpu, 1, float> rows = ctx.requested[0].get_space_typed<cpu, 1, float>(
+      mshadow::Shape1(static_cast<index_t>(nthreads) * num_input), s);
+#pragma omp parallel num_threads(nthreads)
+  {
+    float* w = rows.dptr_ + static_cast<index_t>(omp_get_thread_num()) * num_input;
+#pragma omp for
+    for (index_t n = 0; n < num_hidden; ++n) {
+      const int8_t* q = qweight + n * packed_row_size;
+      if (bits == 4) {
+        WeightOnlyDequantizeRow<4>(w, q, scale + n * num_groups, num_input, group_size);
+      } else {
+        WeightOnlyDequantizeRow<8>(w, q, scale + n * num_groups, num_input, group_size);
+      }
+      for (index_t m = 0; m < num_rows; ++m) {
+        const DType* x = data + m * num_input;
+        float acc      = bias ? static_cast<float>(bias[n]) : 0.f;
+        for (index_t k = 0; k < num_input; ++k)
+          acc += static_cast<float>(x[k]) * w[k];
+        KERNEL_ASSIGN(out[m * num_hidden + n], req, static_cast<DType>(acc));
+      }
+    }
+  }
+}
+
+static bool WeightOnlyQuantizeShape(const nnvm::NodeAttrs& attrs,
+                                    mxnet::ShapeVector* in_shape,
+                                    mxnet::ShapeVector* out_shape) {
+  const WeightOnlyQuantizeParam& param = nnvm::get<WeightOnlyQuantizeParam>(attrs.parsed);
+  CHECK_EQ(in_shape->size(), 1U);
+  CHECK_EQ(out_shape->size(), 2U);
+  WeightOnlyCheckParam(param.bits, param.group_size);
+  const mxnet::TShape& wshape = (*in_shape)[0];
+  if (!mxnet::ndim_is_known(wshape))
+    return false;
+  CHECK_EQ(wshape.ndim(), 2U) << "weight_only_quantize expects a (num_hidden, num_input) weight";
+  if (!mxnet::shape_is_known(wshape))
+    return false;
+  SHAPE_ASSIGN_CHECK(*out_shape,
+                     woq::kQuantizedWeight,
+                     mshadow::Shape2(wshape[0], WeightOnlyPackedRowSize(wshape[1], param.bits)));
+  SHAPE_ASSIGN_CHECK(*out_shape,
+                     woq::kScale,
+                     mshadow::Shape2(wshape[0], WeightOnlyNumGroups(wshape[1], param.group_size)));
+  return true;
+}
+
+static bool WeightOnlyQuantizeType(const nnvm::NodeAttrs& attrs,
+                                   std::vector<int>* in_type,
+                                   std::vector<int>* out_type) {
+  CHECK_EQ(in_type->size(), 1U);
+  CHECK_EQ(out_type->size(), 2U);
+  TYPE_ASSIGN_CHECK(*out_type, woq::kQuantizedWeight, mshadow::kInt8);
+  TYPE_ASSIGN_CHECK(*out_type, woq::kScale, mshadow::kFloat32);
+  return (*in_type)[0] != -1;
+}
+
+static bool WeightOnlyFullyConnectedShape(const nnvm::NodeAttrs& attrs,
+                                          mxnet::ShapeVector* in_shape,
+                                          mxnet::ShapeVector* out_shape) {
+  const WeightOnlyFullyConnectedParam& param =
+      nnvm::get<WeightOnlyFullyConnectedParam>(attrs.parsed);
+  CHECK_EQ(in_shape->size(), param.no_bias ? 3U : 4U);
+  CHECK_EQ(out_shape->size(), 1U);
+  WeightOnlyCheckParam(param.bits, param.group_size);
+  const mxnet::TShape& dshape = (*in_shape)[woq::kData];
+  if (!mxnet::shape_is_known(dshape))
+    return false;
+  const index_t num_input =
+      param.flatten ? dshape.ProdShape(1, dshape.ndim()) : dshape[dshape.ndim() - 1];
+  SHAPE_ASSIGN_CHECK(*in_shape,
+                     woq::kWeight,
+                     mshadow::Shape2(param.num_hidden,
+                                     WeightOnlyPackedRowSize(num_input, param.bits)));
+  SHAPE_ASSIGN_CHECK(*in_shape,
+                     woq::kScale,
+                     mshadow::Shape2(param.num_hidden,
+                                     WeightOnlyNumGroups(num_input, param.group_size)));
+  if (!param.no_bias) {
+    SHAPE_ASSIGN_CHECK(*in_shape, woq::kBias, mshadow::Shape1(param.num_hidden));
+  }
+  if (param.flatten) {
+    SHAPE_ASSIGN_CHECK(*out_shape, woq::kOut, mshadow::Shape2(dshape[0], param.num_hidden));
+  } else {
+    mxnet::TShape oshape(dshape);
+    oshape[dshape.ndim() - 1] = param.num_hidden;
+    SHAPE_ASSIGN_CHECK(*out_shape, woq::kOut, oshape);
+  }
+  return true;
+}
+
+static bool WeightOnlyFullyConnectedType(const nnvm::NodeAttrs& attrs,
+                                         std::vector<int>* in_type,
+                                         std::vector<int>* out_type) {
+  const WeightOnlyFullyConnectedParam& param =
+      nnvm::get<WeightOnlyFullyConnectedParam>(attrs.parsed);
+  CHECK_EQ(in_type->size(), param.no_bias ? 3U : 4U);
+  CHECK_EQ(out_type->size(), 1U);
+  TYPE_ASSIGN_CHECK(*in_type, woq::kWeight, mshadow::kInt8);
+  TYPE_ASSIGN_CHECK(*in_type, woq::kScale, mshadow::kFloat32);
+  int dtype = (*in_type)[woq::kData];
+  if (dtype == -1)
+    dtype = (*out_type)[woq::kOut];
+  if (dtype == -1)
+    return false;
+  TYPE_ASSIGN_CHECK(*in_type, woq::kData, dtype);
+  if (!param.no_bias) {
+    TYPE_ASSIGN_CHECK(*in_type, woq::kBias, dtype);
+  }
+  TYPE_ASSIGN_CHECK(*out_type, woq::kOut, dtype);
+  return true;
+}
+
+NNVM_REGISTER_OP(_contrib_weight_only_quantize)
+    .add_alias("_npx_weight_only_quantize")
+    .describe(R"code(Quantizes a fully connected weight for weight_only_fully_connected.
+
+Each row of the (num_hidden, num_input) weight is split in groups of ``group_size`` consecutive
+columns, each group is quantized symmetrically to int8 or int4 with its own float32 scale:
+``weight[n, k] ~ quantized[n, k] * scale[n, k // group_size]``.
+
+Outputs the int8 quantized weight, of shape (num_hidden, num_input) for 8 bits and
+(num_hidden, ceil(num_input / 2)) for 4 bits with two values packed per int8, and the scales of
+shape (num_hidden, ceil(num_input / group_size)).
+)code" ADD_FILELINE)
+    .set_num_inputs(1)
+    .set_num_outputs(2)
+    .set_attr_parser(ParamParser<WeightOnlyQuantizeParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"weight"};
+                                     })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"quantized_weight",
+                                                                        "scale"};
+                                      })
+    .set_attr<mxnet::FInferShape>("FInferShape", WeightOnlyQuantizeShape)
+    .set_attr<nnvm::FInferType>("FInferType", WeightOnlyQuantizeType)
+    .set_attr<FCompute>("FCompute<cpu>", WeightOnlyQuantizeCompute<cpu>)
+    .add_argument("weight", "NDArray-or-Symbol", "Weight matrix to quantize.")
+    .add_arguments(WeightOnlyQuantizeParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_contrib_weight_only_fully_connected)
+    .add_alias("_npx_weight_only_fully_connected")
+    .describe(R"code(Fully connected layer with a weight quantized by weight_only_quantize.
+
+The data stays in floating point, the weight is dequantized on the fly inside the product, so the
+layer reads 4 (int8) or 8 (int4) times fewer weight bytes than FullyConnected. This is where the
+time goes at small batch sizes, e.g. for autoregressive decoding. Above 32 rows of data the weight
+is dequantized once and multiplied with the GEMM of FullyConnected.
+
+Inference only, ``bits`` and ``group_size`` must be the ones of the quantization.
+)code" ADD_FILELINE)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      const WeightOnlyFullyConnectedParam& params =
+          nnvm::get<WeightOnlyFullyConnectedParam>(attrs.parsed);
+      return params.no_bias ? 3 : 4;
+    })
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<WeightOnlyFullyConnectedParam>)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          const WeightOnlyFullyConnectedParam& params =
+              nnvm::get<WeightOnlyFullyConnectedParam>(attrs.parsed);
+          if (params.no_bias)
+            return std::vector<std::string>{"data", "weight", "scale"};
+          return std::vector<std::string>{"data", "weight", "scale", "bias"};
+        })
+    .set_attr<mxnet::FInferShape>("FInferShape", WeightOnlyFullyConnectedShape)
+    .set_attr<nnvm::FInferType>("FInferType", WeightOnlyFullyConnectedType)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", WeightOnlyFullyConnectedForward<cpu>)
+    .add_argument("data", "NDArray-or-Symbol", "Input data.")
+    .add_argument("weight", "NDArray-or-Symbol", "int8 quantized weight.")
+    .add_argument("scale", "NDArray-or-Symbol", "float32 scales of the weight groups.")
+    .add_argument("bias", "NDArray-or-Symbol", "Bias parameter.")
+    .add_arguments(WeightOnlyFullyConnectedParam::__FIELDS__());
+
+}  // namespace op
+}  // namespace mxnet
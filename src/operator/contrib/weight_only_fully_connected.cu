@@ -0,0 +1,136 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file weight_only_fully_connected.cu
+ * \brief Fully connected layer with int8/int4 weights and group-wise scales, dequantized on the
+ *        fly, for memory bound inference
+ */
+#include "./weight_only_fully_connected-inl.h"
+#include "../../common/cuda/utils.h"
+
+namespace mxnet {
+namespace op {
+
+constexpr int kWeightOnlyWarpsPerBlock = 4;
+// rows of data accumulated by a warp, each weight row is read ceil(num_rows / kRows) times
+constexpr int kWeightOnlyRowsPerWarp = 8;
+
+// one warp per output column n, its lanes stride over the weight row of n, dequantize each weight
+// once and accumulate it against kWeightOnlyRowsPerWarp rows of data
+template <int bits, typename DType>
+__global__ void WeightOnlyGemvKernel(const DType* data,
+                                     const int8_t* qweight,
+                                     const float* scale,
+                                     const DType* bias,
+                                     DType* out,
+                                     const OpReqType req,
+                                     const index_t num_rows,
+                                     const index_t num_hidden,
+                                     const index_t num_input,
+                                     const index_t group_size,
+                                     const index_t num_groups) {
+  using common::cuda::warp_size;
+  const index_t n =
+      static_cast<index_t>(blockIdx.x) * kWeightOnlyWarpsPerBlock + threadIdx.x / warp_size;
+  const int lane     = threadIdx.x % warp_size;
+  const index_t row0 = static_cast<index_t>(blockIdx.y) * kWeightOnlyRowsPerWarp;
+  if (n >= num_hidden)
+    return;
+  const int8_t* q     = qweight + n * WeightOnlyPackedRowSize(num_input, bits);
+  const float* sc     = scale + n * num_groups;
+  const DType* x      = data + row0 * num_input;
+  const index_t nrows = min(static_cast<index_t>(kWeightOnlyRowsPerWarp), num_rows - row0);
+  float acc[kWeightOnlyRowsPerWarp];
+#pragma unroll
+  for (int r = 0; r < kWeightOnlyRowsPerWarp; ++r)
+    acc[r] = 0.f;
+  for (index_t k = lane; k < num_input; k += warp_size) {
+    const float w = WeightOnlyLoad<bits>(q, k) * sc[k / group_size];
+#pragma unroll
+    for (int r = 0; r < kWeightOnlyRowsPerWarp; ++r) {
+      if (r < nrows)
+        acc[r] += static_cast<float>(x[r * num_input + k]) * w;
+    }
+  }
+#pragma unroll
+  for (int r = 0; r < kWeightOnlyRowsPerWarp; ++r) {
+    const float sum = common::cuda::warp_reduce(acc[r], [](float a, float b) { return a + b; });
+    if (lane == 0 && r < nrows) {
+      const float val = bias ? sum + static_cast<float>(bias[n]) : sum;
+      KERNEL_ASSIGN(out[(row0 + r) * num_hidden + n], req, static_cast<DType>(val));
+    }
+  }
+}
+
+template <typename DType>
+void WeightOnlyGemv(mshadow::Stream<gpu>* s,
+                    const OpContext& ctx,
+                    const DType* data,
+                    const int8_t* qweight,
+                    const float* scale,
+                    const DType* bias,
+                    DType* out,
+                    const OpReqType req,
+                    const index_t num_rows,
+                    const index_t num_hidden,
+                    const index_t num_input,
+                    const int bits,
+                    const index_t group_size,
+                    const index_t num_groups) {
+  cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
+  const dim3 blocks((num_hidden + kWeightOnlyWarpsPerBlock - 1) / kWeightOnlyWarpsPerBlock,
+                    (num_rows + kWeightOnlyRowsPerWarp - 1) / kWeightOnlyRowsPerWarp);
+  const int threads = kWeightOnlyWarpsPerBlock * common::cuda::warp_size;
+  if (bits == 4) {
+    WeightOnlyGemvKernel<4><<<blocks, threads, 0, stream>>>(data,
+                                                            qweight,
+                                                            scale,
+                                                            bias,
+                                                            out,
+                                                            req,
+                                                            num_rows,
+                                                            num_hidden,
+                                                            num_input,
+                                                            group_size,
+                                                            num_groups);
+  } else {
+    WeightOnlyGemvKernel<8><<<blocks, threads, 0, stream>>>(data,
+                                                            qweight,
+                                                            scale,
+                                                            bias,
+                                                            out,
+                                                            req,
+                                                            num_rows,
+                                                            num_hidden,
+                                                            num_input,
+                                                            group_size,
+                                                            num_groups);
+  }
+  MSHADOW_CUDA_POST_KERNEL_CHECK(WeightOnlyGemvKernel);
+}
+
+NNVM_REGISTER_OP(_contrib_weight_only_quantize)
+    .set_attr<FCompute>("FCompute<gpu>", WeightOnlyQuantizeCompute<gpu>);
+
+NNVM_REGISTER_OP(_contrib_weight_only_fully_connected)
+    .set_attr<FCompute>("FCompute<gpu>", WeightOnlyFullyConnectedForward<gpu>);
+
+}  // namespace op
+}  // namespace mxnet
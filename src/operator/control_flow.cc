@@ -61,7 +61,7 @@ class ForeachState : public LoopState {
   ForeachParam params;
   int num_iterations;
 
-  ForeachState(const nnvm::Symbol& g, const ForeachParam& params) : LoopState(g, false) {
+  ForeachState(const nnvm::Symbol& g, const ForeachParam& params) : LoopState(g, false, true) {
     this->params = params;
   }
 };
@@ -120,6 +120,20 @@ static void ForeachComputeExCPU(const OpStatePtr& state_ptr,
         inputs[j + params.in_data_locs.ndim() + params.in_state_locs.ndim()];
   }
 
+  // When recording for backward computation, the states of all the iterations but the last
+  // are kept. They are allocated at once, as a buffer per state with a row per iteration.
+  std::vector<NDArray> step_states;
+  if (ctx.need_grad && len > 1) {
+    for (size_t j = params.num_out_data; j < outputs.size(); j++) {
+      const mxnet::TShape& state_shape = outputs[j].shape();
+      mxnet::TShape shape(state_shape.ndim() + 1, -1);
+      shape[0] = len - 1;
+      for (int k = 0; k < state_shape.ndim(); k++)
+        shape[k + 1] = state_shape[k];
+      step_states.emplace_back(shape, outputs[j].ctx(), true, outputs[j].dtype());
+    }
+  }
+
   // Here we iterate over the first dimension of the first input array.
   for (size_t i = 0; i < len; i++) {
     // Initialize outputs for the subgraph.
@@ -131,8 +145,8 @@ static void ForeachComputeExCPU(const OpStatePtr& state_ptr,
     // that output arrays are actually different in each iteration.
     if (ctx.need_grad && i < len - 1) {
       for (size_t j = params.num_out_data; j < subg_out_curr->size(); j++)
-        (*subg_out_curr)[j] =
-            NDArray(outputs[j].shape(), outputs[j].ctx(), true, outputs[j].dtype());
+        (*subg_out_curr)[j] = step_states[j - params.num_out_data].Slice(i, i + 1).Reshape(
+            outputs[j].shape());
     } else if (ctx.need_grad && i == len - 1) {
       // For the last iteration, we need to write data to the output array
       // directly.
@@ -188,6 +202,11 @@ static void ForeachGradComputeExCPU(const OpStatePtr& state_ptr,
   std::vector<OpReqType> subg_req(req.size());
   for (auto r : req)
     CHECK_NE(r, kWriteInplace);
+  // The gradients of the intermediate states alternate between two buffers per state:
+  // the gradient computed by an iteration is only read by the previous one.
+  std::vector<NDArray> state_igrads[2];
+  state_igrads[0].resize(params.in_state_locs.ndim());
+  state_igrads[1].resize(params.in_state_locs.ndim());
 
   // There are three types of arrays in igrads.
   // * data gradients.
@@ -227,9 +246,12 @@ static void ForeachGradComputeExCPU(const OpStatePtr& state_ptr,
       size_t loc            = params.in_state_locs[i];
       const NDArray& output = outputs[i + params.in_data_locs.ndim()];
       if (iter_num != 0) {
-        // For state gradients, we need to allocate new NDArrays
+        // For state gradients, we need separate NDArrays
         // because intermediate state gradients won't be returned to the users.
-        subg_igrads[loc] = NDArray(output.shape(), output.ctx(), true, output.dtype());
+        NDArray& igrad = state_igrads[iter_num % 2][i];
+        if (igrad.is_none())
+          igrad = NDArray(output.shape(), output.ctx(), true, output.dtype());
+        subg_igrads[loc] = igrad;
       } else {
         subg_igrads[loc] = output;
       }
@@ -536,7 +558,9 @@ class WhileLoopState : public LoopState {
         params(params),
         n_iterations(0U),
         cond_op(LoopState::MakeSharedOp(cond)),
-        oi_map(params.func_var_locs.ndim(), -1) {
+        oi_map(params.func_var_locs.ndim(), -1),
+        cond_sym(cond),
+        static_cond(false) {
     const mxnet::Tuple<dim_t>& func_input_locs = params.func_input_locs;
     const mxnet::Tuple<dim_t>& func_var_locs   = params.func_var_locs;
     const mxnet::Tuple<dim_t>& cond_input_locs = params.cond_input_locs;
@@ -550,6 +574,19 @@ class WhileLoopState : public LoopState {
       }
     }
   }
+
+  // Plan cond and func once for the next steps, whose shapes are those of the last one.
+  void UseStaticShape() {
+    if (!static_cond) {
+      static_cond = true;
+      cond_op     = LoopState::MakeSharedOp(cond_sym, false, true);
+    }
+    LoopState::UseStaticShape();
+  }
+
+ private:
+  nnvm::Symbol cond_sym;
+  bool static_cond;
 };
 
 static void WhileLoopComputeExCPU(const OpStatePtr& state_ptr,
@@ -585,6 +622,14 @@ static void WhileLoopComputeExCPU(const OpStatePtr& state_ptr,
   // construct inputs and outputs for func
   std::vector<NDArray> func_inputs, func_outputs(outputs.size());
   extract_by_loc(inputs, params.func_input_locs, &func_inputs);
+  // When the loop variables keep their shapes at the first step, the next steps run with
+  // static memory: their outputs are preallocated, the outputs at each step are written in
+  // place, and without backward the loop variables alternate between two buffers.
+  bool static_steps = false;
+  std::vector<mxnet::TShape> step_shapes(outputs.size());
+  std::vector<NDArray> var_bufs[2];
+  var_bufs[0].resize(outputs.size() - params.num_out_data);
+  var_bufs[1].resize(outputs.size() - params.num_out_data);
   for (size_t& step = state.n_iterations = 0; step < (size_t)params.max_iterations; ++step) {
     CHECK(inputs.size() > 0) << "while loop forward requires at least 1 input";
     Context default_ctx = inputs[0].ctx();
@@ -594,7 +639,18 @@ static void WhileLoopComputeExCPU(const OpStatePtr& state_ptr,
     }
     // we create func_outputs for the current step:
     for (size_t i = 0; i < outputs.size(); ++i) {
-      func_outputs[i] = NDArray(outputs[i].ctx(), outputs[i].dtype());
+      if (!static_steps) {
+        func_outputs[i] = NDArray(outputs[i].ctx(), outputs[i].dtype());
+      } else if (i < (size_t)params.num_out_data) {
+        func_outputs[i] = outputs[i].Slice(step, step + 1).Reshape(step_shapes[i]);
+      } else if (ctx.need_grad) {
+        func_outputs[i] = NDArray(step_shapes[i], outputs[i].ctx(), true, outputs[i].dtype());
+      } else {
+        NDArray& buf = var_bufs[step % 2][i - params.num_out_data];
+        if (buf.is_none())
+          buf = NDArray(step_shapes[i], outputs[i].ctx(), true, outputs[i].dtype());
+        func_outputs[i] = buf;
+      }
     }
     state.Forward(step, func_inputs, req, func_outputs, ctx.need_grad);
     if (step == 0) {
@@ -610,11 +666,32 @@ static void WhileLoopComputeExCPU(const OpStatePtr& state_ptr,
           shape[j + 1] = step_shape[j];
         }
         const_cast<NDArray&>(outputs[i]).Init(shape);
+        step_shapes[i] = step_shape;
+      }
+      bool same_shapes = true;
+      for (size_t i = params.num_out_data; i < outputs.size(); ++i) {
+        if (!shape_is_known(func_outputs[i].shape())) {
+          func_outputs[i].WaitToRead();
+          func_outputs[i].SetShapeFromChunk();
+        }
+        const NDArray& var = func_inputs[params.func_var_locs[i - params.num_out_data]];
+        same_shapes        = same_shapes && func_outputs[i].shape() == var.shape() &&
+                      func_outputs[i].dtype() == var.dtype();
+        step_shapes[i] = func_outputs[i].shape();
+      }
+      if (same_shapes && params.max_iterations > 1) {
+        state.UseStaticShape();
+      }
+      for (int i = 0; i < params.num_out_data; ++i) {
+        NDArray first_slot = outputs[i].At(step);
+        mxnet::CopyFromTo(func_outputs[i], &first_slot);
+      }
+      static_steps = same_shapes;
+    } else if (!static_steps) {
+      for (int i = 0; i < params.num_out_data; ++i) {
+        NDArray first_slot = outputs[i].At(step);
+        mxnet::CopyFromTo(func_outputs[i], &first_slot);
       }
-    }
-    for (int i = 0; i < params.num_out_data; ++i) {
-      NDArray first_slot = outputs[i].At(step);
-      mxnet::CopyFromTo(func_outputs[i], &first_slot);
     }
     // func_inputs on the next step:
     // the output (new_loop_vars) will become the new inputs (loop_vars)
@@ -29,7 +29,9 @@
 
 #include <dmlc/parameter.h>
 
+#include <cstdio>
 #include <cstdlib>
+#include <fstream>
 #include <iomanip>
 #include <iterator>
 #include <limits>
@@ -538,6 +540,93 @@ Storage::Handle AllocWorkspace(std::vector<Descriptor>* plans, size_t* workspace
   return workspace;
 }
 
+// Global engine index and knob choices of an execution plan
+struct PlanConfig {
+  int64_t engine;
+  std::vector<std::pair<int64_t, int64_t>> knobs;
+};
+
+struct PlanCache {
+  std::mutex mutex;
+  std::unordered_map<std::string, PlanConfig> configs;
+
+  static PlanCache* Get() {
+    static PlanCache inst;
+    return &inst;
+  }
+};
+
+constexpr char kPlanCacheMagic[] = "mxnet-cudnn-plans-v1";
+
+std::string PlanKey(const OpContext& ctx,
+                    const ConvParam& param,
+                    int tune,
+                    const std::string& op_str,
+                    const std::vector<mxnet::TShape>& shapes) {
+  std::ostringstream ss;
+  ss << "sm_" << SMArch(ctx.run_ctx.ctx.dev_id) << " cudnn_" << cudnnGetVersion() << " tune_"
+     << tune << " add_to_" << param.add_to << " " << op_str;
+  for (const auto& shape : shapes)
+    ss << " " << shape;
+  return ss.str();
+}
+
+PlanConfig GetPlanConfig(const Descriptor& plan) {
+  auto cfg =
+      GetAttr(plan, CUDNN_ATTR_EXECUTION_PLAN_ENGINE_CONFIG, CUDNN_BACKEND_ENGINECFG_DESCRIPTOR);
+  auto engine = GetAttr(cfg, CUDNN_ATTR_ENGINECFG_ENGINE, CUDNN_BACKEND_ENGINE_DESCRIPTOR);
+  PlanConfig config{GetAttr<int64_t>(engine, CUDNN_ATTR_ENGINE_GLOBAL_INDEX), {}};
+  auto choices = GetSomeAttrs(CUDNN_KNOB_TYPE_COUNTS,
+                              cfg,
+                              CUDNN_ATTR_ENGINECFG_KNOB_CHOICES,
+                              CUDNN_BACKEND_KNOB_CHOICE_DESCRIPTOR);
+  for (const auto& choice : choices) {
+    auto type = GetAttr<cudnnBackendKnobType_t>(choice, CUDNN_ATTR_KNOB_CHOICE_KNOB_TYPE);
+    auto val  = GetAttr<int64_t>(choice, CUDNN_ATTR_KNOB_CHOICE_KNOB_VALUE);
+    config.knobs.emplace_back(static_cast<int64_t>(type), val);
+  }
+  return config;
+}
+
+// Returns an empty descriptor if the configuration does not apply to the op graph
+Descriptor MakePlan(cudnnHandle_t handle, const Descriptor& op_graph, const PlanConfig& config) {
+  try {
+    std::vector<Descriptor> choices;
+    for (const auto& knob : config.knobs) {
+      choices.push_back(MakeFinalized(CUDNN_BACKEND_KNOB_CHOICE_DESCRIPTOR,
+                                      CUDNN_ATTR_KNOB_CHOICE_KNOB_TYPE,
+                                      static_cast<cudnnBackendKnobType_t>(knob.first),
+                                      CUDNN_ATTR_KNOB_CHOICE_KNOB_VALUE,
+                                      knob.second));
+    }
+    auto engine = MakeFinalized(CUDNN_BACKEND_ENGINE_DESCRIPTOR,
+                                CUDNN_ATTR_ENGINE_GLOBAL_INDEX,
+                                config.engine,
+                                CUDNN_ATTR_ENGINE_OPERATION_GRAPH,
+                                op_graph);
+
+    auto cfg = MakeFinalized(CUDNN_BACKEND_ENGINECFG_DESCRIPTOR,
+                             CUDNN_ATTR_ENGINECFG_ENGINE,
+                             engine,
+                             CUDNN_ATTR_ENGINECFG_KNOB_CHOICES,
+                             choices);
+    return MakeFinalized(CUDNN_BACKEND_EXECUTION_PLAN_DESCRIPTOR,
+                         CUDNN_ATTR_EXECUTION_PLAN_HANDLE,
+                         handle,
+                         CUDNN_ATTR_EXECUTION_PLAN_ENGINE_CONFIG,
+                         cfg);
+  } catch (const dmlc::Error&) {
+    return Descriptor();
+  }
+}
+
+Descriptor RememberPlan(const std::string& key, Descriptor plan) {
+  auto cache = PlanCache::Get();
+  std::lock_guard<std::mutex> lock(cache->mutex);
+  cache->configs[key] = GetPlanConfig(plan);
+  return plan;
+}
+
 std::unordered_set<int64_t> ExcludeEngines(const std::string& env_var) {
   std::string engines = dmlc::GetEnv(env_var.c_str(), std::string());
   std::replace(engines.begin(), engines.end(), ',', ' ');
@@ -551,6 +640,7 @@ Descriptor SelectPlan(const OpContext& ctx,
                       Descriptor op,
                       size_t n_fallbacks,
                       const std::function<std::string()>& make_op_str,
+                      const std::vector<mxnet::TShape>& shapes,
                       const std::vector<int64_t>& ids,
                       const std::vector<void*>& tensor_ptrs,
                       int64_t out_size,
@@ -565,6 +655,30 @@ Descriptor SelectPlan(const OpContext& ctx,
   auto tune = param.cudnn_tune ?
                   param.cudnn_tune.value() :
                   dmlc::GetEnv("MXNET_CUDNN_AUTOTUNE_DEFAULT", static_cast<int>(conv::kLimited));
+
+  // a configuration selected before, possibly by another process, skips the selection
+  const std::string key = PlanKey(ctx, param, tune, make_op_str(), shapes);
+  PlanConfig config;
+  bool cached = false;
+  {
+    auto cache = PlanCache::Get();
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    auto it = cache->configs.find(key);
+    if (it != cache->configs.end()) {
+      config = it->second;
+      cached = true;
+    }
+  }
+  if (cached) {
+    auto plan = MakePlan(s->dnn_handle_, op_graph, config);
+    if (plan) {
+      if (verbose > 0)
+        LOG(INFO) << " cached " << PlanStr(plan);
+      return plan;
+    }
+    LOG(WARNING) << "Ignoring the cached cuDNN plan of " << make_op_str();
+  }
+
   size_t workspace_size = 0;
   size_t workspace_limit =
       tune != conv::kFastest ? param.workspace << 20 : std::numeric_limits<size_t>::max();
@@ -629,7 +743,7 @@ Descriptor SelectPlan(const OpContext& ctx,
       LOG(INFO) << " " << PlanStr(plans[0]);
     Storage::Get()->DirectFree(out_space);
     Storage::Get()->DirectFree(workspace);
-    return std::move(plans[0]);
+    return RememberPlan(key, std::move(plans[0]));
   }
 
   TuneWarnOnce();
@@ -655,7 +769,7 @@ Descriptor SelectPlan(const OpContext& ctx,
     ss << prefix << top[i].heur_i << ") " << str_time(top[i].time) << "ms " << PlanStr(top[i].plan);
     LOG(INFO) << ss.str();
   }
-  return std::move(top[0].plan);
+  return RememberPlan(key, std::move(top[0].plan));
 }
 
 size_t Size(const TBlob& t) {
@@ -686,6 +800,7 @@ cudnn_cxx::Descriptor Conv::Make(const OpContext& ctx,
                     std::move(conv_fwd),
                     kMaxConvFallbacks,
                     make_op_str,
+                    {x.shape_, w.shape_, y.shape_},
                     ids,
                     ptrs,
                     Size(y),
@@ -747,6 +862,7 @@ cudnn_cxx::Descriptor ConvDgrad::Make(const OpContext& ctx,
                     std::move(conv_dgrad),
                     kMaxDgradFallbacks,
                     make_op_str,
+                    {w.shape_, dy.shape_, dx.shape_},
                     ids,
                     ptrs,
                     Size(dx),
@@ -808,6 +924,7 @@ cudnn_cxx::Descriptor ConvWgrad::Make(const OpContext& ctx,
                     std::move(conv_wgrad),
                     kMaxWgradFallbacks,
                     make_op_str,
+                    {x.shape_, dy.shape_, dw.shape_},
                     ids,
                     ptrs,
                     Size(dw),
@@ -951,6 +1068,53 @@ bool LegacyBiasGrad(const OpContext& ctx,
   return true;
 }
 
+size_t SavePlanCache(const std::string& fname) {
+  auto cache = PlanCache::Get();
+  std::lock_guard<std::mutex> lock(cache->mutex);
+  // written aside and renamed, so that a concurrent load never sees a partial file
+  const std::string tmp_name = fname + ".tmp";
+  {
+    std::ofstream fo(tmp_name);
+    CHECK(fo) << "Cannot open " << tmp_name << " to save the cuDNN plans";
+    fo << kPlanCacheMagic << "\n";
+    for (const auto& kv : cache->configs) {
+      fo << kv.second.engine << " " << kv.second.knobs.size();
+      for (const auto& knob : kv.second.knobs)
+        fo << " " << knob.first << " " << knob.second;
+      fo << " " << kv.first << "\n";
+    }
+    CHECK(fo) << "Failed to save the cuDNN plans to " << tmp_name;
+  }
+  CHECK_EQ(std::rename(tmp_name.c_str(), fname.c_str()), 0)
+      << "Failed to rename " << tmp_name << " to " << fname;
+  return cache->configs.size();
+}
+
+size_t LoadPlanCache(const std::string& fname) {
+  std::ifstream fi(fname);
+  CHECK(fi) << "Cannot open the cuDNN plans " << fname;
+  std::string line;
+  CHECK(std::getline(fi, line) && line == kPlanCacheMagic) << "Invalid cuDNN plans " << fname;
+  auto cache = PlanCache::Get();
+  std::lock_guard<std::mutex> lock(cache->mutex);
+  size_t num_plans = 0;
+  while (std::getline(fi, line)) {
+    std::istringstream ss(line);
+    PlanConfig config;
+    size_t num_knobs = 0;
+    ss >> config.engine >> num_knobs;
+    config.knobs.resize(num_knobs);
+    for (auto& knob : config.knobs)
+      ss >> knob.first >> knob.second;
+    std::string key;
+    CHECK(ss.get() == ' ' && std::getline(ss, key) && !key.empty())
+        << "Invalid cuDNN plans " << fname;
+    cache->configs[key] = std::move(config);
+    ++num_plans;
+  }
+  return num_plans;
+}
+
 }  // namespace cudnn
 }  // namespace op
 }  // namespace mxnet
@@ -32,6 +32,7 @@
 #include <algorithm>
 #include <mutex>
 #include <numeric>
+#include <string>
 #include <tuple>
 #include <unordered_map>
 #include <utility>
@@ -121,6 +122,13 @@ cudnn_cxx::Descriptor ClonePlan(cudnnHandle_t handle,
 
 TShape ExpandChannelDims(mshadow::LayoutFlag layout, int c);
 
+// The engine configurations selected for the convolutions are kept by operator, shapes, tuning
+// mode, GPU architecture and cuDNN version. Saved with a compiled model, they let the process
+// which loads it build the same plans without running the heuristics or autotuning again.
+// Both return the number of configurations written or read.
+size_t SavePlanCache(const std::string& fname);
+size_t LoadPlanCache(const std::string& fname);
+
 void MaybeLogSelectedPlan(const cudnn_cxx::Descriptor& plan);
 
 // To support cached lookup and execution an operation Op must define:
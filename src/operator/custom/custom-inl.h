@@ -81,7 +81,8 @@ class CustomOperator {
             const std::vector<int>& tags,
             const std::unordered_set<int>& output_tags,
             const std::vector<NDArray>& outputs,
-            const std::string op_type = "") {
+            const std::string op_type = "",
+            int priority              = 0) {
     if (naive_engine_) {
       if (profiler::Profiler::Get()->IsProfiling(profiler::Profiler::kImperative)) {
         profiler::CustomOpProfiler::Get()->OnCustomBegin(op_type);
@@ -103,7 +104,7 @@ class CustomOperator {
       return;
     }
     std::unique_lock<std::mutex> lock(mutex_);
-    q_.push([=]() mutable {
+    Enqueue(priority, [=]() mutable {
       bool prev_recording = Imperative::Get()->set_is_recording(recording);
       bool prev_training  = Imperative::Get()->set_is_training(training);
 
@@ -162,13 +163,32 @@ class CustomOperator {
           vars,
           vars2,
           FnProperty::kNoSkip,
-          0,
+          priority,
           "CustomOperatorWait");
     });
-    // increase num_threads if there is not enough threads to execute custom operator
-    if (q_.size() > num_free_threads_)
-      CreateThreads(q_.size() - num_free_threads_);
-    cv_.notify_all();
+  }
+
+  /*!
+   * \brief Run a native callback, which needs neither the frontend nor the recording and
+   *        training states, on the workers and complete the asynchronous operator with it.
+   *        The engine thread which pushed it is free in the meantime.
+   */
+  void PushNative(const std::function<void(void)>& func, const OpContext& ctx, int priority = 0) {
+    if (naive_engine_) {
+      func();
+      ctx.async_on_complete();
+      return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    Enqueue(priority, [func, ctx]() {
+      try {
+        func();
+      } catch (dmlc::Error& e) {
+        ctx.async_on_complete(&e);
+        return;
+      }
+      ctx.async_on_complete();
+    });
   }
 
   static CustomOperator* Get() {
@@ -208,16 +228,34 @@ class CustomOperator {
   }
 
  private:
+  /*! \brief a callback queued for the workers, by decreasing priority then in order */
+  struct Task {
+    int priority;
+    uint64_t seq;
+    std::function<void(void)> fn;
+    bool operator<(const Task& other) const {
+      return priority != other.priority ? priority < other.priority : seq > other.seq;
+    }
+  };
+
   CustomOperator() {
     this->Start();
   }
+  // requires mutex_
+  void Enqueue(int priority, std::function<void(void)> fn) {
+    q_.push(Task{priority, next_seq_++, std::move(fn)});
+    // increase num_threads if there is not enough threads to execute custom operator
+    if (q_.size() > num_free_threads_)
+      CreateThreads(q_.size() - num_free_threads_);
+    cv_.notify_all();
+  }
   void ThreadTarget() {
     std::unique_lock<std::mutex> lock(mutex_);
     while (!q_.empty() || !destructing_) {
       cv_.wait(lock, [&] { return !q_.empty() || destructing_; });
       while (!q_.empty()) {
         --num_free_threads_;
-        auto fn = q_.front();
+        auto fn = q_.top().fn;
         q_.pop();
         lock.unlock();
         fn();
@@ -241,7 +279,8 @@ class CustomOperator {
   std::condition_variable cv_;
   std::vector<std::thread> workers_;
   std::atomic<uint32_t> num_free_threads_;
-  std::queue<std::function<void(void)> > q_;
+  std::priority_queue<Task> q_;
+  uint64_t next_seq_ = 0;
   std::shared_ptr<std::exception_ptr> exception_;
   bool naive_engine_;
   bool destructing_;
@@ -35,6 +35,8 @@ namespace custom {
 
 struct CustomParam {
   std::string op_type;
+  // priority of the callbacks among the queued ones, from the __priority__ attribute
+  int priority = 0;
   size_t num_args, num_outs, num_auxs;
   std::vector<int> bwd_idx;
   std::shared_ptr<MXCallbackList> info;
@@ -81,6 +83,11 @@ void AttrParser(NodeAttrs* attrs) {
   for (auto& p : attrs->dict) {
     if (p.first == "op_type") {
       params.op_type = p.second;
+    } else if (p.first == "__priority__") {
+      std::istringstream is(p.second);
+      CHECK(is >> params.priority && (is >> std::ws).eof())
+          << "__priority__ of custom operator " << attrs->name << " must be an integer, got \""
+          << p.second << "\"";
     } else {
       keys.push_back(p.first.c_str());
       vals.push_back(p.second.c_str());
@@ -346,7 +353,8 @@ void ForwardEx(const OpStatePtr& state,
       tags,
       output_tags,
       outputs,
-      params.op_type);
+      params.op_type,
+      params.priority);
 }
 
 void BackwardEx(const OpStatePtr& state,
@@ -427,7 +435,8 @@ void BackwardEx(const OpStatePtr& state,
       tags,
       output_tags,
       outputs,
-      "_backward_" + params.op_type);
+      "_backward_" + params.op_type,
+      params.priority);
 }
 
 // infer storage backward function for custom op which assigns kDefaultStorage for
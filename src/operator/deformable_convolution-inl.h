@@ -108,43 +108,49 @@ class DeformableConvolutionOp : public Operator {
     // allocate workspace for col_buffer
     Tensor<xpu, 1, DType> workspace =
         ctx.requested[conv::kTempSpace].get_space_typed<xpu, 1, DType>(Shape1(col_buffer_size_), s);
-    // calculate the shape of col_buffer
+    // calculate the shape of the whole column matrix, of which col_buffer holds bands of rows
     mxnet::TShape col_buffer_shape(num_spatial_axes_ + 1, -1);
     col_buffer_shape[0] = conv_in_channels_ * param_.kernel.Size();
     for (int i = 1; i < col_buffer_shape.ndim(); ++i) {
       col_buffer_shape[i] = out_data[0].shape_[i + 1];
     }
-    // create a column buffer using workspace and col_buffer_shape
-    TBlob col_buffer(workspace.dptr_, col_buffer_shape, xpu::kDevMask, DataType<DType>::kFlag);
+    const index_t height_col = col_buffer_shape[1];
+    const index_t width_col  = col_buffer_shape[2];
 
-    // initialize weight and col_buffer 3D tensors for using gemm
+    // initialize weight and output tensors for using gemm
     index_t M = conv_out_channels_ / group_;
     index_t N = conv_out_spatial_dim_;
     index_t K = kernel_dim_;
     Tensor<xpu, 3, DType> weight_3d =
         in_data[conv::kWeight].get_with_shape<xpu, 3, DType>(Shape3(group_, M, K), s);
-    Tensor<xpu, 3, DType> col_buffer_3d =
-        col_buffer.get_with_shape<xpu, 3, DType>(Shape3(group_, K, N), s);
     Tensor<xpu, 4, DType> output_4d =
         out_data[conv::kOut].get_with_shape<xpu, 4, DType>(Shape4(num_, group_, M, N), s);
     for (index_t n = 0; n < num_; ++n) {
-      // transform image to col_buffer in order to use gemm
-      deformable_im2col(s,
-                        in_data[conv::kData].dptr<DType>() + n * input_dim_,
-                        in_data[conv::kOffset].dptr<DType>() + n * input_offset_dim_,
-                        in_data[conv::kData].shape_,
-                        col_buffer.shape_,
-                        param_.kernel,
-                        param_.pad,
-                        param_.stride,
-                        param_.dilate,
-                        param_.num_deformable_group,
-                        col_buffer.dptr<DType>());
       Tensor<xpu, 3, DType> output_3d = output_4d[n];
-      for (index_t g = 0; g < group_; ++g) {
-        // Legacy approach shown here for comparison:
-        //   Assign(output_3d[g], req[conv::kOut], dot(weight_3d[g], col_buffer_3d[g]));
-        linalg_gemm(weight_3d[g], col_buffer_3d[g], output_3d[g], false, false, s, req[conv::kOut]);
+      for (index_t row_begin = 0; row_begin < height_col; row_begin += col_rows_) {
+        const index_t num_rows = std::min(col_rows_, height_col - row_begin);
+        const index_t band     = num_rows * width_col;
+        // transform a band of output rows of the image to col_buffer in order to use gemm
+        deformable_im2col(s,
+                          in_data[conv::kData].dptr<DType>() + n * input_dim_,
+                          in_data[conv::kOffset].dptr<DType>() + n * input_offset_dim_,
+                          in_data[conv::kData].shape_,
+                          col_buffer_shape,
+                          row_begin,
+                          num_rows,
+                          param_.kernel,
+                          param_.pad,
+                          param_.stride,
+                          param_.dilate,
+                          param_.num_deformable_group,
+                          workspace.dptr_);
+        Tensor<xpu, 3, DType> col_buffer_3d(workspace.dptr_, Shape3(group_, K, band), s);
+        for (index_t g = 0; g < group_; ++g) {
+          Tensor<xpu, 2, DType> output_band(
+              output_3d[g].dptr_ + row_begin * width_col, Shape2(M, band), N, s);
+          linalg_gemm(
+              weight_3d[g], col_buffer_3d[g], output_band, false, false, s, req[conv::kOut]);
+        }
       }
     }
     if (bias_term_) {
@@ -176,16 +182,16 @@ class DeformableConvolutionOp : public Operator {
     // allocate workspace for col_buffer
     Tensor<xpu, 1, DType> workspace =
         ctx.requested[conv::kTempSpace].get_space_typed<xpu, 1, DType>(Shape1(col_buffer_size_), s);
-    // calculate the shape of col_buffer
+    // calculate the shape of the whole column matrix, of which col_buffer holds bands of rows
     mxnet::TShape col_buffer_shape(num_spatial_axes_ + 1, -1);
     col_buffer_shape[0] = conv_in_channels_ * param_.kernel.Size();
     for (index_t i = 1; i < col_buffer_shape.ndim(); ++i) {
       col_buffer_shape[i] = out_grad[conv::kData].shape_[i + 1];
     }
-    // create a column buffer using workspace and col_buffer_shape
-    TBlob col_buffer(workspace.dptr_, col_buffer_shape, xpu::kDevMask, DataType<DType>::kFlag);
+    const index_t height_col = col_buffer_shape[1];
+    const index_t width_col  = col_buffer_shape[2];
 
-    // initialize weight and col_buffer 3D tensors for using gemm
+    // initialize weight and out_grad tensors for using gemm
     // For computing dLoss/d(in_data[kData])
     index_t M = kernel_dim_;
     index_t N = conv_out_spatial_dim_;
@@ -194,8 +200,6 @@ class DeformableConvolutionOp : public Operator {
         in_data[conv::kWeight].get_with_shape<xpu, 3, DType>(Shape3(group_, K, M), s);
     Tensor<xpu, 4, DType> out_grad_4d =
         out_grad[conv::kOut].get_with_shape<xpu, 4, DType>(Shape4(num_, group_, K, N), s);
-    Tensor<xpu, 3, DType> col_buffer_3d =
-        col_buffer.get_with_shape<xpu, 3, DType>(Shape3(group_, M, N), s);
     // For computing dLoss/dWeight
     Tensor<xpu, 3, DType> dweight_3d =
         in_grad[conv::kWeight].get_with_shape<xpu, 3, DType>(Shape3(group_, K, M), s);
@@ -205,57 +209,68 @@ class DeformableConvolutionOp : public Operator {
 
     for (index_t n = 0; n < num_; ++n) {
       Tensor<xpu, 3, DType> out_grad_3d = out_grad_4d[n];
-      for (index_t g = 0; g < group_; ++g) {
-        // Legacy approach shown here for comparison:
-        //   col_buffer_3d[g] = dot(weight_3d[g].T(), out_grad_3d[g]);
-        linalg_gemm(weight_3d[g], out_grad_3d[g], col_buffer_3d[g], true, false, s);
-      }
-
-      // gradient w.r.t. input coordinate data
-      deformable_col2im_coord(s,
-                              col_buffer.dptr<DType>(),
-                              in_data[conv::kData].dptr<DType>() + n * input_dim_,
-                              in_data[conv::kOffset].dptr<DType>() + n * input_offset_dim_,
-                              in_grad[conv::kData].shape_,
-                              col_buffer.shape_,
-                              param_.kernel,
-                              param_.pad,
-                              param_.stride,
-                              param_.dilate,
-                              param_.num_deformable_group,
-                              in_grad[conv::kOffset].dptr<DType>() + n * input_offset_dim_);
-
-      // gradient w.r.t. input data
-      deformable_col2im(s,
-                        col_buffer.dptr<DType>(),
-                        in_data[conv::kOffset].dptr<DType>() + n * input_offset_dim_,
-                        in_grad[conv::kData].shape_,
-                        col_buffer.shape_,
-                        param_.kernel,
-                        param_.pad,
-                        param_.stride,
-                        param_.dilate,
-                        param_.num_deformable_group,
-                        in_grad[conv::kData].dptr<DType>() + n * input_dim_);
-
-      // gradient w.r.t. weight, dWeight should accumulate across the batch and group
-      deformable_im2col(s,
-                        in_data[conv::kData].dptr<DType>() + n * input_dim_,
-                        in_data[conv::kOffset].dptr<DType>() + n * input_offset_dim_,
-                        in_data[conv::kData].shape_,
-                        col_buffer.shape_,
-                        param_.kernel,
-                        param_.pad,
-                        param_.stride,
-                        param_.dilate,
-                        param_.num_deformable_group,
-                        col_buffer.dptr<DType>());
-
-      for (index_t g = 0; g < group_; ++g) {
-        auto request = (n == 0) ? req[conv::kWeight] : kAddTo;
-        // Legacy approach shown here for comparison:
-        //   Assign(dweight_3d[g], request, dot(out_grad_3d[g], col_buffer_3d[g].T()));
-        linalg_gemm(out_grad_3d[g], col_buffer_3d[g], dweight_3d[g], false, true, s, request);
+      for (index_t row_begin = 0; row_begin < height_col; row_begin += col_rows_) {
+        const index_t num_rows = std::min(col_rows_, height_col - row_begin);
+        const index_t band     = num_rows * width_col;
+        Tensor<xpu, 3, DType> col_buffer_3d(workspace.dptr_, Shape3(group_, M, band), s);
+        for (index_t g = 0; g < group_; ++g) {
+          Tensor<xpu, 2, DType> out_grad_band(
+              out_grad_3d[g].dptr_ + row_begin * width_col, Shape2(K, band), N, s);
+          linalg_gemm(weight_3d[g], out_grad_band, col_buffer_3d[g], true, false, s);
+        }
+
+        // gradient w.r.t. input coordinate data
+        deformable_col2im_coord(s,
+                                workspace.dptr_,
+                                in_data[conv::kData].dptr<DType>() + n * input_dim_,
+                                in_data[conv::kOffset].dptr<DType>() + n * input_offset_dim_,
+                                in_grad[conv::kData].shape_,
+                                col_buffer_shape,
+                                row_begin,
+                                num_rows,
+                                param_.kernel,
+                                param_.pad,
+                                param_.stride,
+                                param_.dilate,
+                                param_.num_deformable_group,
+                                in_grad[conv::kOffset].dptr<DType>() + n * input_offset_dim_);
+
+        // gradient w.r.t. input data
+        deformable_col2im(s,
+                          workspace.dptr_,
+                          in_data[conv::kOffset].dptr<DType>() + n * input_offset_dim_,
+                          in_grad[conv::kData].shape_,
+                          col_buffer_shape,
+                          row_begin,
+                          num_rows,
+                          param_.kernel,
+                          param_.pad,
+                          param_.stride,
+                          param_.dilate,
+                          param_.num_deformable_group,
+                          in_grad[conv::kData].dptr<DType>() + n * input_dim_);
+
+        // gradient w.r.t. weight, dWeight should accumulate across the batch, bands and group
+        deformable_im2col(s,
+                          in_data[conv::kData].dptr<DType>() + n * input_dim_,
+                          in_data[conv::kOffset].dptr<DType>() + n * input_offset_dim_,
+                          in_data[conv::kData].shape_,
+                          col_buffer_shape,
+                          row_begin,
+                          num_rows,
+                          param_.kernel,
+                          param_.pad,
+                          param_.stride,
+                          param_.dilate,
+                          param_.num_deformable_group,
+                          workspace.dptr_);
+
+        for (index_t g = 0; g < group_; ++g) {
+          auto request = (n == 0 && row_begin == 0) ? req[conv::kWeight] : kAddTo;
+          Tensor<xpu, 2, DType> out_grad_band(
+              out_grad_3d[g].dptr_ + row_begin * width_col, Shape2(K, band), N, s);
+          linalg_gemm(out_grad_band, col_buffer_3d[g], dweight_3d[g], false, true, s, request);
+        }
       }
     }
 
@@ -296,8 +311,12 @@ class DeformableConvolutionOp : public Operator {
     conv_out_spatial_dim_ = oshape.ProdShape(2, oshape.ndim());
     col_offset_           = kernel_dim_ * conv_out_spatial_dim_;
     output_offset_        = conv_out_channels_ * conv_out_spatial_dim_ / group_;
-    // size of the column buffer used for storing im2col-ed pixels
-    col_buffer_size_ = kernel_dim_ * group_ * conv_out_spatial_dim_;
+    // size of the column buffer used for storing im2col-ed pixels, which holds as many output
+    // rows as fit in the workspace
+    const index_t col_row_size = kernel_dim_ * group_ * oshape[3];
+    const index_t max_rows     = col_row_size > 0 ? param_.workspace / col_row_size : oshape[2];
+    col_rows_                  = std::max<index_t>(1, std::min<index_t>(oshape[2], max_rows));
+    col_buffer_size_           = col_row_size * col_rows_;
     // input/output image size (#channels * height * width)
     input_dim_          = ishape.ProdShape(1, ishape.ndim());
     input_offset_dim_   = offset_shape.ProdShape(1, offset_shape.ndim());
@@ -320,6 +339,7 @@ class DeformableConvolutionOp : public Operator {
   index_t weight_offset_;         // number of output channels per group * kernel_dim_
   index_t col_offset_;
   index_t output_offset_;
+  index_t col_rows_;
   index_t col_buffer_size_;
   index_t input_dim_;
   index_t input_offset_dim_;
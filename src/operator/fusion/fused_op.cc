@@ -17,14 +17,21 @@
  * under the License.
  */
 
+#include <algorithm>
+#include <string>
 #include <tuple>
+#include <type_traits>
+#include <unordered_map>
 
 #include "./fused_op.h"
 #include "../operator_common.h"
+#include "../mshadow_op.h"
+#include "../mxnet_op.h"
+#include "../tensor/elemwise_binary_scalar_op.h"
+#include "../tensor/matrix_op-inl.h"
+#include "../../engine/openmp.h"
 #include "../../imperative/exec_pass.h"
 
-#if MXNET_USE_CUDA
-
 namespace mxnet {
 
 DMLC_REGISTER_PARAMETER(FusedOpConfig);
@@ -170,6 +177,426 @@ std::tuple<const nnvm::ObjectPtr, std::vector<Attr>, std::vector<Attr>> FusedOp:
   return std::make_tuple(node.weak_ref.lock(), inputs, outputs);
 }
 
+namespace fusion {
+namespace {
+
+// number of elements evaluated by all the nodes of the subgraph in turn,
+// small enough for the intermediate values to stay in cache
+constexpr size_t kCPUChunkSize = 1024;
+
+enum CPUKernelKind { kCPUElemwise, kCPUScalar, kCPUClip };
+
+template <typename OP, typename CType>
+void UnaryKernel(const CType* const* inputs, CType* output, size_t n, const CType* params) {
+  const CType* a = inputs[0];
+  for (size_t i = 0; i < n; ++i) {
+    output[i] = OP::Map(a[i]);
+  }
+}
+
+template <typename OP, typename CType>
+void BinaryKernel(const CType* const* inputs, CType* output, size_t n, const CType* params) {
+  const CType* a = inputs[0];
+  const CType* b = inputs[1];
+  for (size_t i = 0; i < n; ++i) {
+    output[i] = OP::Map(a[i], b[i]);
+  }
+}
+
+template <typename OP, typename CType>
+void ScalarKernel(const CType* const* inputs, CType* output, size_t n, const CType* params) {
+  const CType* a     = inputs[0];
+  const CType scalar = params[0];
+  for (size_t i = 0; i < n; ++i) {
+    output[i] = OP::Map(a[i], scalar);
+  }
+}
+
+template <typename OP, typename CType>
+void ClipKernel(const CType* const* inputs, CType* output, size_t n, const CType* params) {
+  const CType* a    = inputs[0];
+  const CType a_min = params[0];
+  const CType a_max = params[1];
+  for (size_t i = 0; i < n; ++i) {
+    output[i] = OP::Map(a[i], a_min, a_max);
+  }
+}
+
+struct CPUKernelInfo {
+  CPUKernelKind kind;
+  CPUFusedStep::Kernel<float> kernel_float;
+  CPUFusedStep::Kernel<double> kernel_double;
+};
+
+#define MXNET_CPU_FUSED_KERNEL(kind, Kernel, OP) \
+  CPUKernelInfo {                                \
+    kind, Kernel<OP, float>, Kernel<OP, double>  \
+  }
+#define MXNET_CPU_FUSED_UNARY(OP) \
+  MXNET_CPU_FUSED_KERNEL(kCPUElemwise, UnaryKernel, op::mshadow_op::OP)
+#define MXNET_CPU_FUSED_BINARY(OP) \
+  MXNET_CPU_FUSED_KERNEL(kCPUElemwise, BinaryKernel, op::mshadow_op::OP)
+#define MXNET_CPU_FUSED_BACKWARD(GRAD_OP) \
+  MXNET_CPU_FUSED_KERNEL(                 \
+      kCPUElemwise, BinaryKernel, op::mxnet_op::backward_grad<op::mshadow_op::GRAD_OP>)
+#define MXNET_CPU_FUSED_SCALAR(OP) \
+  MXNET_CPU_FUSED_KERNEL(kCPUScalar, ScalarKernel, op::mshadow_op::OP)
+
+/*!
+ * \brief The kernels of the ops the CPU fused op evaluates, by op name, or by
+ *  "Activation:<act_type>" for Activation. The casts and the ops only changing
+ *  the shape copy their input, the values are then rounded to the type of their output.
+ */
+const std::unordered_map<std::string, CPUKernelInfo>& CPUKernels() {
+  static const std::unordered_map<std::string, CPUKernelInfo> kernels = {
+      {"elemwise_add", MXNET_CPU_FUSED_BINARY(plus)},
+      {"_plus", MXNET_CPU_FUSED_BINARY(plus)},
+      {"_Plus", MXNET_CPU_FUSED_BINARY(plus)},
+      {"_add", MXNET_CPU_FUSED_BINARY(plus)},
+      {"elemwise_sub", MXNET_CPU_FUSED_BINARY(minus)},
+      {"_minus", MXNET_CPU_FUSED_BINARY(minus)},
+      {"_Minus", MXNET_CPU_FUSED_BINARY(minus)},
+      {"_sub", MXNET_CPU_FUSED_BINARY(minus)},
+      {"elemwise_mul", MXNET_CPU_FUSED_BINARY(mul)},
+      {"_mul", MXNET_CPU_FUSED_BINARY(mul)},
+      {"_Mul", MXNET_CPU_FUSED_BINARY(mul)},
+      {"elemwise_div", MXNET_CPU_FUSED_BINARY(div)},
+      {"_div", MXNET_CPU_FUSED_BINARY(div)},
+      {"_Div", MXNET_CPU_FUSED_BINARY(div)},
+      {"_Power", MXNET_CPU_FUSED_BINARY(power)},
+      {"_power", MXNET_CPU_FUSED_BINARY(power)},
+      {"_Maximum", MXNET_CPU_FUSED_BINARY(maximum)},
+      {"_maximum", MXNET_CPU_FUSED_BINARY(maximum)},
+      {"_Minimum", MXNET_CPU_FUSED_BINARY(minimum)},
+      {"_minimum", MXNET_CPU_FUSED_BINARY(minimum)},
+      {"_mod", MXNET_CPU_FUSED_BINARY(mod)},
+      {"amp_cast", MXNET_CPU_FUSED_UNARY(identity)},
+      {"Cast", MXNET_CPU_FUSED_UNARY(identity)},
+      {"cast", MXNET_CPU_FUSED_UNARY(identity)},
+      {"_copy", MXNET_CPU_FUSED_UNARY(identity)},
+      {"squeeze", MXNET_CPU_FUSED_UNARY(identity)},
+      {"flatten", MXNET_CPU_FUSED_UNARY(identity)},
+      {"Reshape", MXNET_CPU_FUSED_UNARY(identity)},
+      {"reshape", MXNET_CPU_FUSED_UNARY(identity)},
+      {"_backward_reshape", MXNET_CPU_FUSED_UNARY(identity)},
+      {"expand_dims", MXNET_CPU_FUSED_UNARY(identity)},
+      {"relu", MXNET_CPU_FUSED_UNARY(relu)},
+      {"sigmoid", MXNET_CPU_FUSED_UNARY(sigmoid)},
+      {"log_sigmoid", MXNET_CPU_FUSED_UNARY(log_sigmoid)},
+      {"mish", MXNET_CPU_FUSED_UNARY(mish)},
+      {"softsign", MXNET_CPU_FUSED_UNARY(softsign)},
+      {"exp", MXNET_CPU_FUSED_UNARY(exp)},
+      {"expm1", MXNET_CPU_FUSED_UNARY(expm1)},
+      {"log", MXNET_CPU_FUSED_UNARY(log)},
+      {"log10", MXNET_CPU_FUSED_UNARY(log10)},
+      {"log2", MXNET_CPU_FUSED_UNARY(log2)},
+      {"log1p", MXNET_CPU_FUSED_UNARY(log1p)},
+      {"degrees", MXNET_CPU_FUSED_UNARY(degrees)},
+      {"radians", MXNET_CPU_FUSED_UNARY(radians)},
+      {"sin", MXNET_CPU_FUSED_UNARY(sin)},
+      {"cos", MXNET_CPU_FUSED_UNARY(cos)},
+      {"tan", MXNET_CPU_FUSED_UNARY(tan)},
+      {"arcsin", MXNET_CPU_FUSED_UNARY(arcsin)},
+      {"arccos", MXNET_CPU_FUSED_UNARY(arccos)},
+      {"arctan", MXNET_CPU_FUSED_UNARY(arctan)},
+      {"sinh", MXNET_CPU_FUSED_UNARY(sinh)},
+      {"cosh", MXNET_CPU_FUSED_UNARY(cosh)},
+      {"tanh", MXNET_CPU_FUSED_UNARY(tanh)},
+      {"arcsinh", MXNET_CPU_FUSED_UNARY(arcsinh)},
+      {"arccosh", MXNET_CPU_FUSED_UNARY(arccosh)},
+      {"arctanh", MXNET_CPU_FUSED_UNARY(arctanh)},
+      {"sqrt", MXNET_CPU_FUSED_UNARY(square_root)},
+      {"rsqrt", MXNET_CPU_FUSED_UNARY(reciprocal_square_root)},
+      {"cbrt", MXNET_CPU_FUSED_UNARY(cube_root)},
+      {"rcbrt", MXNET_CPU_FUSED_UNARY(reciprocal_cube_root)},
+      {"square", MXNET_CPU_FUSED_UNARY(square)},
+      {"round", MXNET_CPU_FUSED_UNARY(round)},
+      {"rint", MXNET_CPU_FUSED_UNARY(rint)},
+      {"fix", MXNET_CPU_FUSED_UNARY(fix)},
+      {"floor", MXNET_CPU_FUSED_UNARY(floor)},
+      {"ceil", MXNET_CPU_FUSED_UNARY(ceil)},
+      {"trunc", MXNET_CPU_FUSED_UNARY(trunc)},
+      {"sign", MXNET_CPU_FUSED_UNARY(sign)},
+      {"reciprocal", MXNET_CPU_FUSED_UNARY(reciprocal)},
+      {"abs", MXNET_CPU_FUSED_UNARY(abs)},
+      {"gamma", MXNET_CPU_FUSED_UNARY(gamma)},
+      {"gammaln", MXNET_CPU_FUSED_UNARY(gammaln)},
+      {"erf", MXNET_CPU_FUSED_UNARY(erf)},
+      {"negative", MXNET_CPU_FUSED_UNARY(negation)},
+      {"Activation:relu", MXNET_CPU_FUSED_UNARY(relu)},
+      {"Activation:sigmoid", MXNET_CPU_FUSED_UNARY(sigmoid)},
+      {"Activation:log_sigmoid", MXNET_CPU_FUSED_UNARY(log_sigmoid)},
+      {"Activation:tanh", MXNET_CPU_FUSED_UNARY(tanh)},
+      {"Activation:softrelu", MXNET_CPU_FUSED_UNARY(softrelu)},
+      {"Activation:softsign", MXNET_CPU_FUSED_UNARY(softsign)},
+      {"_backward_relu", MXNET_CPU_FUSED_BACKWARD(relu_grad)},
+      {"_backward_sigmoid", MXNET_CPU_FUSED_BACKWARD(sigmoid_grad)},
+      {"_backward_tanh", MXNET_CPU_FUSED_BACKWARD(tanh_grad)},
+      {"_backward_log", MXNET_CPU_FUSED_BACKWARD(log_grad)},
+      {"_backward_square", MXNET_CPU_FUSED_BACKWARD(square_grad)},
+      {"_plus_scalar", MXNET_CPU_FUSED_SCALAR(plus)},
+      {"_PlusScalar", MXNET_CPU_FUSED_SCALAR(plus)},
+      {"_minus_scalar", MXNET_CPU_FUSED_SCALAR(minus)},
+      {"_MinusScalar", MXNET_CPU_FUSED_SCALAR(minus)},
+      {"_rminus_scalar", MXNET_CPU_FUSED_SCALAR(rminus)},
+      {"_RMinusScalar", MXNET_CPU_FUSED_SCALAR(rminus)},
+      {"_mul_scalar", MXNET_CPU_FUSED_SCALAR(mul)},
+      {"_MulScalar", MXNET_CPU_FUSED_SCALAR(mul)},
+      {"_div_scalar", MXNET_CPU_FUSED_SCALAR(div)},
+      {"_DivScalar", MXNET_CPU_FUSED_SCALAR(div)},
+      {"_rdiv_scalar", MXNET_CPU_FUSED_SCALAR(rdiv)},
+      {"_RDivScalar", MXNET_CPU_FUSED_SCALAR(rdiv)},
+      {"_power_scalar", MXNET_CPU_FUSED_SCALAR(power)},
+      {"_PowerScalar", MXNET_CPU_FUSED_SCALAR(power)},
+      {"_rpower_scalar", MXNET_CPU_FUSED_SCALAR(rpower)},
+      {"_RPowerScalar", MXNET_CPU_FUSED_SCALAR(rpower)},
+      {"_mod_scalar", MXNET_CPU_FUSED_SCALAR(mod)},
+      {"_rmod_scalar", MXNET_CPU_FUSED_SCALAR(rmod)},
+      {"_maximum_scalar", MXNET_CPU_FUSED_SCALAR(maximum)},
+      {"_minimum_scalar", MXNET_CPU_FUSED_SCALAR(minimum)},
+      {"clip", MXNET_CPU_FUSED_KERNEL(kCPUClip, ClipKernel, op::mshadow_op::clip)}};
+  return kernels;
+}
+
+#undef MXNET_CPU_FUSED_SCALAR
+#undef MXNET_CPU_FUSED_BACKWARD
+#undef MXNET_CPU_FUSED_BINARY
+#undef MXNET_CPU_FUSED_UNARY
+#undef MXNET_CPU_FUSED_KERNEL
+
+std::string CPUKernelKey(const nnvm::NodeAttrs& attrs) {
+  if (attrs.op->name == "Activation")
+    return "Activation:" + attrs.dict.at("act_type");
+  return attrs.op->name;
+}
+
+template <typename CType>
+CPUFusedStep::Kernel<CType> StepKernel(const CPUFusedStep& step);
+
+template <>
+CPUFusedStep::Kernel<float> StepKernel<float>(const CPUFusedStep& step) {
+  return step.kernel_float;
+}
+
+template <>
+CPUFusedStep::Kernel<double> StepKernel<double>(const CPUFusedStep& step) {
+  return step.kernel_double;
+}
+
+template <typename DType, typename CType>
+void LoadChunk(const void* src, size_t begin, size_t n, CType* dst) {
+  const DType* data = static_cast<const DType*>(src) + begin;
+  for (size_t i = 0; i < n; ++i) {
+    dst[i] = static_cast<CType>(data[i]);
+  }
+}
+
+template <typename DType, typename CType>
+void StoreChunk(const CType* src, size_t begin, size_t n, bool add, void* dst) {
+  DType* data = static_cast<DType*>(dst) + begin;
+  if (add) {
+    for (size_t i = 0; i < n; ++i) {
+      data[i] = static_cast<DType>(static_cast<CType>(data[i]) +
+                                   static_cast<CType>(static_cast<DType>(src[i])));
+    }
+  } else {
+    for (size_t i = 0; i < n; ++i) {
+      data[i] = static_cast<DType>(src[i]);
+    }
+  }
+}
+
+// rounds the values computed in CType to the values of DType
+template <typename DType, typename CType>
+void RoundChunk(CType* data, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    data[i] = static_cast<CType>(static_cast<DType>(data[i]));
+  }
+}
+
+}  // namespace
+
+bool IsCPUFusionCompatible(const nnvm::NodeAttrs& attrs) {
+  if (attrs.op == nullptr)
+    return false;
+  if (attrs.op->name == "Activation" && !attrs.dict.count("act_type"))
+    return false;
+  return CPUKernels().count(CPUKernelKey(attrs)) != 0;
+}
+
+}  // namespace fusion
+
+void FusedOp::BuildCPUSteps() {
+  const auto& g = subgraph_.indexed_graph();
+  cpu_steps_.clear();
+  for (uint32_t nid = 0; nid < g.num_nodes(); ++nid) {
+    const auto& node = g[nid];
+    if (node.source->is_variable())
+      continue;
+    const nnvm::NodeAttrs& attrs = node.source->attrs;
+    CHECK(fusion::IsCPUFusionCompatible(attrs))
+        << "Operator " << attrs.op->name << " cannot be fused on CPU";
+    const auto& info = fusion::CPUKernels().at(fusion::CPUKernelKey(attrs));
+    fusion::CPUFusedStep step;
+    step.kernel_float  = info.kernel_float;
+    step.kernel_double = info.kernel_double;
+    for (const auto& e : node.inputs) {
+      step.inputs.push_back(g.entry_id(e));
+    }
+    step.output = g.entry_id(nid, 0);
+    if (info.kind == fusion::kCPUScalar) {
+      step.params.push_back(nnvm::get<op::NumpyBinaryScalarParam>(attrs.parsed).scalar);
+    } else if (info.kind == fusion::kCPUClip) {
+      const auto& param = nnvm::get<op::ClipParam>(attrs.parsed);
+      step.params.push_back(param.a_min);
+      step.params.push_back(param.a_max);
+    }
+    cpu_steps_.push_back(std::move(step));
+  }
+}
+
+template <typename CType>
+void FusedOp::ForwardCPU(const OpContext& ctx,
+                         const std::vector<TBlob>& inputs,
+                         const std::vector<OpReqType>& req,
+                         const std::vector<TBlob>& outputs,
+                         const std::vector<int>& node_dtypes) {
+  using LoadFn  = void (*)(const void*, size_t, size_t, CType*);
+  using StoreFn = void (*)(const CType*, size_t, size_t, bool, void*);
+  using RoundFn = void (*)(CType*, size_t);
+  const auto& g  = subgraph_.indexed_graph();
+  const size_t n = outputs[0].Size();
+
+  std::vector<uint32_t> input_eids;
+  std::vector<LoadFn> loads;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    CHECK_EQ(inputs[i].Size(), n) << "The inputs and outputs of a fused op on CPU need the "
+                                  << "same number of elements";
+    input_eids.push_back(g.entry_id(g.input_nodes()[i], 0));
+    MSHADOW_TYPE_SWITCH_EXT_WITH_BOOL(
+        inputs[i].type_flag_, DType, { loads.push_back(fusion::LoadChunk<DType, CType>); });
+  }
+  std::vector<uint32_t> output_eids;
+  std::vector<StoreFn> stores;
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    CHECK_EQ(outputs[i].Size(), n) << "The inputs and outputs of a fused op on CPU need the "
+                                   << "same number of elements";
+    output_eids.push_back(g.entry_id(g.outputs()[i]));
+    MSHADOW_TYPE_SWITCH_EXT_WITH_BOOL(
+        outputs[i].type_flag_, DType, { stores.push_back(fusion::StoreChunk<DType, CType>); });
+  }
+  std::vector<fusion::CPUFusedStep::Kernel<CType>> kernels;
+  std::vector<std::vector<CType>> params;
+  std::vector<RoundFn> rounds;
+  for (const auto& step : cpu_steps_) {
+    kernels.push_back(fusion::StepKernel<CType>(step));
+    params.emplace_back(step.params.begin(), step.params.end());
+    MSHADOW_TYPE_SWITCH_EXT_WITH_BOOL(node_dtypes[step.output], DType, {
+      rounds.push_back(std::is_same<DType, CType>::value ? nullptr :
+                                                           fusion::RoundChunk<DType, CType>);
+    });
+  }
+
+  const int64_t num_chunks = (n + fusion::kCPUChunkSize - 1) / fusion::kCPUChunkSize;
+  const int omp_threads    = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel num_threads(omp_threads)
+  {
+    // the chunk of every entry of the subgraph
+    std::vector<CType> buffers(g.num_node_entries() * fusion::kCPUChunkSize);
+    std::vector<const CType*> step_inputs;
+#pragma omp for
+    for (int64_t c = 0; c < num_chunks; ++c) {
+      const size_t begin = c * fusion::kCPUChunkSize;
+      const size_t len   = std::min(fusion::kCPUChunkSize, n - begin);
+      for (size_t i = 0; i < inputs.size(); ++i) {
+        loads[i](inputs[i].dptr_, begin, len, &buffers[input_eids[i] * fusion::kCPUChunkSize]);
+      }
+      for (size_t s = 0; s < cpu_steps_.size(); ++s) {
+        step_inputs.clear();
+        for (uint32_t eid : cpu_steps_[s].inputs) {
+          step_inputs.push_back(&buffers[eid * fusion::kCPUChunkSize]);
+        }
+        CType* output = &buffers[cpu_steps_[s].output * fusion::kCPUChunkSize];
+        kernels[s](step_inputs.data(), output, len, params[s].data());
+        if (rounds[s] != nullptr)
+          rounds[s](output, len);
+      }
+      for (size_t i = 0; i < outputs.size(); ++i) {
+        if (req[i] == kNullOp)
+          continue;
+        stores[i](&buffers[output_eids[i] * fusion::kCPUChunkSize],
+                  begin,
+                  len,
+                  req[i] == kAddTo,
+                  outputs[i].dptr_);
+      }
+    }
+  }
+}
+
+template <>
+void FusedOp::Forward<cpu>(const nnvm::NodeAttrs& attrs,
+                           const OpContext& ctx,
+                           const std::vector<TBlob>& inputs,
+                           const std::vector<OpReqType>& req,
+                           const std::vector<TBlob>& outputs) {
+  std::lock_guard<std::mutex> lock(my_mutex_);
+  CHECK_GE(outputs.size(), 1) << "There needs to be at least 1 output.";
+  CHECK_EQ(inputs.size(), inputs_.size());
+  CHECK_EQ(outputs.size(), outputs_.size());
+
+  std::vector<int> in_dtypes;
+  std::vector<int> out_dtypes;
+  for (const auto& blob : inputs) {
+    in_dtypes.push_back(blob.type_flag_);
+  }
+  for (const auto& blob : outputs) {
+    out_dtypes.push_back(blob.type_flag_);
+  }
+  for (auto it = intermediate_dtypes_.begin(); it != intermediate_dtypes_.end(); ++it) {
+    if (it->input_attr == in_dtypes && it->output_attr == out_dtypes) {
+      intermediate_dtypes_.erase(intermediate_dtypes_.begin(), it);
+      break;
+    }
+  }
+  CHECK(!intermediate_dtypes_.empty()) << "The types of the fused op " << attrs.name
+                                       << " were not inferred";
+  // the shapes are not needed on CPU, only the last ones are kept
+  if (intermediate_shapes_.size() > 1)
+    intermediate_shapes_.erase(intermediate_shapes_.begin(), intermediate_shapes_.end() - 1);
+  const auto& node_dtypes = intermediate_dtypes_[0].internal_attr;
+
+  if (!initialized_) {
+    BuildCPUSteps();
+    initialized_ = true;
+  }
+  // float16 and bfloat16 are computed in float, with the intermediate values rounded
+  bool use_double = false;
+  for (const auto& step : cpu_steps_) {
+    const int dtype = node_dtypes[step.output];
+    use_double = use_double || (dtype != mshadow::kFloat32 && dtype != mshadow::kFloat16 &&
+                                dtype != mshadow::kBfloat16);
+  }
+  for (int dtype : in_dtypes) {
+    use_double = use_double || (dtype != mshadow::kFloat32 && dtype != mshadow::kFloat16 &&
+                                dtype != mshadow::kBfloat16);
+  }
+  if (use_double) {
+    ForwardCPU<double>(ctx, inputs, req, outputs, node_dtypes);
+  } else {
+    ForwardCPU<float>(ctx, inputs, req, outputs, node_dtypes);
+  }
+}
+
+void FusedOpForwardCPU(const nnvm::NodeAttrs& attrs,
+                       const OpContext& ctx,
+                       const std::vector<TBlob>& inputs,
+                       const std::vector<OpReqType>& req,
+                       const std::vector<TBlob>& outputs) {
+  const FusedOpPtr& op = nnvm::get<FusedOpPtr>(attrs.parsed);
+  op->Forward<cpu>(attrs, ctx, inputs, req, outputs);
+}
+
 bool FusedOpInferShape(const nnvm::NodeAttrs& attrs,
                        std::vector<mxnet::TShape>* in_attrs,
                        std::vector<mxnet::TShape>* out_attrs) {
@@ -234,6 +661,7 @@ NNVM_REGISTER_OP(_FusedOp)
                                                  FusedOpProvideStorageType)
     .set_attr<mxnet::FInferShape>("FInferShape", FusedOpInferShape)
     .set_attr<nnvm::FInferType>("FInferType", FusedOpInferType)
+    .set_attr<FCompute>("FCompute<cpu>", FusedOpForwardCPU)
     .set_attr_parser(FusedOpParamParser)
     .add_argument("data", "NDArray-or-Symbol[]", "Data");
 
@@ -286,5 +714,3 @@ NNVM_REGISTER_OP(_FusedOpOutHelper)
     .set_attr<exec::FAccessSubgraphType>("FAccessSubgraphType", FusedOpOutHelperType);
 
 }  // namespace mxnet
-
-#endif  // MXNET_USE_CUDA
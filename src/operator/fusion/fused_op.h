@@ -28,8 +28,6 @@
 #include <mutex>
 #include <tuple>
 
-#if MXNET_USE_CUDA
-
 namespace mxnet {
 
 namespace fusion {
@@ -38,7 +36,25 @@ enum KernelVariants {
   kShapeOptimized,
   kNumKernelVariants  // Not a variant- leave this at the end
 };
-}
+
+/*!
+ * \brief Whether the CPU implementation of the fused op can evaluate the node,
+ *  i.e. whether it is an elementwise op with a single output of the size of its inputs.
+ */
+bool IsCPUFusionCompatible(const nnvm::NodeAttrs& attrs);
+
+/*! \brief One node of the subgraph evaluated by the CPU implementation of the fused op */
+struct CPUFusedStep {
+  template <typename CType>
+  using Kernel = void (*)(const CType* const* inputs, CType* output, size_t n, const CType* params);
+
+  Kernel<float> kernel_float;
+  Kernel<double> kernel_double;
+  std::vector<uint32_t> inputs;
+  uint32_t output;
+  std::vector<double> params;
+};
+}  // namespace fusion
 
 struct FusedOpConfig : public dmlc::Parameter<FusedOpConfig> {
   int num_inputs;
@@ -115,6 +131,18 @@ class FusedOp {
   }
 
  private:
+  /*! \brief build the steps evaluating the subgraph on CPU */
+  void BuildCPUSteps();
+
+  /*! \brief evaluate the subgraph on CPU, computing in CType */
+  template <typename CType>
+  void ForwardCPU(const OpContext& ctx,
+                  const std::vector<TBlob>& inputs,
+                  const std::vector<OpReqType>& req,
+                  const std::vector<TBlob>& outputs,
+                  const std::vector<int>& node_dtypes);
+
+#if MXNET_USE_CUDA
   std::string GenerateCode(const std::vector<OpReqType>& req,
                            const std::vector<int>& in_dtypes,
                            const std::vector<int>& out_dtypes,
@@ -135,6 +163,7 @@ class FusedOp {
                            std::vector<int>* out_dtypes,
                            std::vector<int>* out_ndims,
                            int* nvec);
+#endif  // MXNET_USE_CUDA
 
   std::vector<FusedOpEntry> inputs_;
   std::vector<FusedOpEntry> outputs_;
@@ -166,9 +195,13 @@ class FusedOp {
   std::vector<uint32_t> extra_shape_args_;
   std::vector<uint32_t> check_shape_args_;
 
+#if MXNET_USE_CUDA
   CUfunction kernel_functions_[fusion::kNumKernelVariants];
+#endif  // MXNET_USE_CUDA
   bool initialized_;
   int kernel_function_dev_id_;
+  // the nodes of the subgraph in topological order, evaluated on CPU
+  std::vector<fusion::CPUFusedStep> cpu_steps_;
 
   static std::mutex mutex_;
   std::mutex my_mutex_;
@@ -187,6 +220,4 @@ using FusedOpHelperParamPtr = std::shared_ptr<FusedOpHelperParam>;
 
 }  // namespace mxnet
 
-#endif  // MXNET_USE_CUDA
-
 #endif  // MXNET_OPERATOR_FUSION_FUSED_OP_H_
@@ -0,0 +1,275 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file batch_preprocess-inl.h
+ * \brief resize, crop, flip and normalize a batch of images of different sizes in one kernel
+ */
+#ifndef MXNET_OPERATOR_IMAGE_BATCH_PREPROCESS_INL_H_
+#define MXNET_OPERATOR_IMAGE_BATCH_PREPROCESS_INL_H_
+
+#include <mxnet/base.h>
+#include <string>
+#include <vector>
+
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+#include "image_utils.h"
+
+namespace mxnet {
+namespace op {
+namespace image {
+
+using namespace mshadow;
+
+struct BatchPreprocessParam : public dmlc::Parameter<BatchPreprocessParam> {
+  int num_images;
+  mxnet::Tuple<int> size;
+  int resize_short;
+  mxnet::Tuple<int> flip;
+  mxnet::Tuple<float> mean;
+  mxnet::Tuple<float> std;
+  DMLC_DECLARE_PARAMETER(BatchPreprocessParam) {
+    DMLC_DECLARE_FIELD(num_images).set_lower_bound(1).describe("Number of input images.");
+    DMLC_DECLARE_FIELD(size).describe(
+        "Size of the output images. Could be (width, height) or (size)");
+    DMLC_DECLARE_FIELD(resize_short)
+        .set_default(0)
+        .describe(
+            "If positive, the short edge of each image is resized to this length, keeping "
+            "its aspect ratio, and the center of the resized image is cropped to `size`. "
+            "Otherwise each image is resized to `size`.");
+    DMLC_DECLARE_FIELD(flip)
+        .set_default(mxnet::Tuple<int>())
+        .describe(
+            "Whether to flip each image left to right, one value per image. "
+            "By default no image is flipped.");
+    DMLC_DECLARE_FIELD(mean)
+        .set_default(mxnet::Tuple<float>{0.0f})
+        .describe(
+            "Sequence of means for each channel, or one mean for all of them. "
+            "Default value is 0.");
+    DMLC_DECLARE_FIELD(std)
+        .set_default(mxnet::Tuple<float>{1.0f})
+        .describe(
+            "Sequence of standard deviations for each channel, or one for all of them. "
+            "Default value is 1.");
+  }
+};
+
+/*! \brief source of an output image: the image, its resized size and the crop in it */
+template <typename DType>
+struct BatchImage {
+  const DType* data;
+  int height;
+  int width;
+  // source pixels per resized pixel
+  float scale_y;
+  float scale_x;
+  // top left corner of the crop in the resized image
+  int offset_y;
+  int offset_x;
+  int flip;
+};
+
+inline SizeParam GetBatchOutputSize(const BatchPreprocessParam& param) {
+  CHECK(param.size.ndim() == 1 || param.size.ndim() == 2)
+      << "Output size dimension must be 1 or 2, but got " << param.size.ndim();
+  const int width  = param.size[0];
+  const int height = param.size.ndim() == 1 ? param.size[0] : param.size[1];
+  CHECK(width > 0 && height > 0) << "Output size should be greater than 0, but got " << width
+                                 << "x" << height;
+  return SizeParam(height, width);
+}
+
+inline bool BatchPreprocessShape(const nnvm::NodeAttrs& attrs,
+                                 mxnet::ShapeVector* in_attrs,
+                                 mxnet::ShapeVector* out_attrs) {
+  const BatchPreprocessParam& param = nnvm::get<BatchPreprocessParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), static_cast<size_t>(param.num_images));
+  CHECK(param.flip.ndim() == 0 || param.flip.ndim() == param.num_images)
+      << "flip must have one value per image, got " << param.flip.ndim() << " for "
+      << param.num_images << " images";
+  int channels = -1;
+  for (const mxnet::TShape& shape : *in_attrs) {
+    if (!shape_is_known(shape))
+      return false;
+    CHECK_EQ(shape.ndim(), 3) << "Input images should be of shape (H x W x C), but got " << shape;
+    CHECK(channels == -1 || channels == shape[C])
+        << "Input images should have the same number of channels";
+    channels = shape[C];
+  }
+  CHECK(param.mean.ndim() == 1 || param.mean.ndim() == channels)
+      << "Invalid mean for input with " << channels << " channels";
+  CHECK(param.std.ndim() == 1 || param.std.ndim() == channels)
+      << "Invalid std for input with " << channels << " channels";
+  const SizeParam size = GetBatchOutputSize(param);
+  SHAPE_ASSIGN_CHECK(
+      *out_attrs, 0, mxnet::TShape({param.num_images, channels, size.height, size.width}));
+  return true;
+}
+
+inline bool BatchPreprocessType(const nnvm::NodeAttrs& attrs,
+                                std::vector<int>* in_attrs,
+                                std::vector<int>* out_attrs) {
+  int dtype = -1;
+  for (int type : *in_attrs) {
+    if (type == -1)
+      continue;
+    CHECK(dtype == -1 || dtype == type) << "Input images should have the same type";
+    dtype = type;
+  }
+  for (size_t i = 0; i < in_attrs->size(); ++i)
+    TYPE_ASSIGN_CHECK(*in_attrs, i, dtype);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, mshadow::kFloat32);
+  return dtype != -1;
+}
+
+template <typename DType>
+inline BatchImage<DType> MakeBatchImage(const BatchPreprocessParam& param,
+                                        const TBlob& image,
+                                        const SizeParam& size,
+                                        int index) {
+  const int height = image.shape_[H];
+  const int width  = image.shape_[W];
+  int resized_h    = size.height;
+  int resized_w    = size.width;
+  if (param.resize_short > 0) {
+    if (height < width) {
+      resized_h = param.resize_short;
+      resized_w = static_cast<int>(static_cast<int64_t>(width) * resized_h / height);
+    } else {
+      resized_w = param.resize_short;
+      resized_h = static_cast<int>(static_cast<int64_t>(height) * resized_w / width);
+    }
+    CHECK(resized_h >= size.height && resized_w >= size.width)
+        << "Image " << index << " of size " << width << "x" << height << " resized to "
+        << resized_w << "x" << resized_h << " is smaller than the crop " << size.width << "x"
+        << size.height;
+  }
+  BatchImage<DType> ret;
+  ret.data     = image.dptr<DType>();
+  ret.height   = height;
+  ret.width    = width;
+  ret.scale_y  = static_cast<float>(height) / resized_h;
+  ret.scale_x  = static_cast<float>(width) / resized_w;
+  ret.offset_y = (resized_h - size.height) / 2;
+  ret.offset_x = (resized_w - size.width) / 2;
+  ret.flip     = param.flip.ndim() > 0 && param.flip[index] != 0;
+  return ret;
+}
+
+/*!
+ * \brief One output pixel of one channel: bilinear sample of the source with half pixel
+ *        centers, as _image_resize on GPU, divided by 255 and normalized.
+ */
+template <int req>
+struct batch_preprocess_forward {
+  MSHADOW_XINLINE static float Clamp(float v, float lo, float hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+  }
+
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  float* out,
+                                  const BatchImage<DType>* images,
+                                  const float* mean,
+                                  const float* std,
+                                  const int channels,
+                                  const int height,
+                                  const int width) {
+    const int x                    = i % width;
+    const int y                    = (i / width) % height;
+    const int c                    = (i / width / height) % channels;
+    const BatchImage<DType>& image = images[i / width / height / channels];
+    const int rx                   = (image.flip ? width - 1 - x : x) + image.offset_x;
+    const int ry                   = y + image.offset_y;
+    const float sy = Clamp((ry + 0.5f) * image.scale_y - 0.5f, 0.0f, image.height - 1.0f);
+    const float sx = Clamp((rx + 0.5f) * image.scale_x - 0.5f, 0.0f, image.width - 1.0f);
+    const int y0   = static_cast<int>(sy);
+    const int x0   = static_cast<int>(sx);
+    const int y1   = y0 + 1 < image.height ? y0 + 1 : y0;
+    const int x1   = x0 + 1 < image.width ? x0 + 1 : x0;
+    const float ly = sy - y0;
+    const float lx = sx - x0;
+    const index_t stride = static_cast<index_t>(image.width) * channels;
+    const DType* row0    = image.data + y0 * stride + c;
+    const DType* row1    = image.data + y1 * stride + c;
+    const float top      = (1 - lx) * static_cast<float>(row0[x0 * channels]) +
+                      lx * static_cast<float>(row0[x1 * channels]);
+    const float bottom = (1 - lx) * static_cast<float>(row1[x0 * channels]) +
+                         lx * static_cast<float>(row1[x1 * channels]);
+    const float value = (1 - ly) * top + ly * bottom;
+    KERNEL_ASSIGN(out[i], req, (value / 255.0f - mean[c]) / std[c]);
+  }
+};
+
+template <typename xpu>
+void BatchPreprocess(const nnvm::NodeAttrs& attrs,
+                     const OpContext& ctx,
+                     const std::vector<TBlob>& inputs,
+                     const std::vector<OpReqType>& req,
+                     const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  CHECK_EQ(outputs.size(), 1U);
+  if (req[0] == kNullOp)
+    return;
+  const BatchPreprocessParam& param = nnvm::get<BatchPreprocessParam>(attrs.parsed);
+  Stream<xpu>* s                    = ctx.get_stream<xpu>();
+  const TBlob& out                  = outputs[0];
+  const int channels                = out.shape_[1];
+  const SizeParam size(out.shape_[2], out.shape_[3]);
+  MSHADOW_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    // the sources of all the images and the normalization are copied to the device at once
+    const size_t images_bytes = sizeof(BatchImage<DType>) * inputs.size();
+    const size_t nbytes       = images_bytes + 2 * channels * sizeof(float);
+    std::vector<char> host(nbytes);
+    auto* images = reinterpret_cast<BatchImage<DType>*>(host.data());
+    float* mean  = reinterpret_cast<float*>(host.data() + images_bytes);
+    float* std   = mean + channels;
+    for (size_t i = 0; i < inputs.size(); ++i)
+      images[i] = MakeBatchImage<DType>(param, inputs[i], size, i);
+    for (int c = 0; c < channels; ++c) {
+      mean[c] = param.mean[param.mean.ndim() == 1 ? 0 : c];
+      std[c]  = param.std[param.std.ndim() == 1 ? 0 : c];
+    }
+    Tensor<xpu, 1, char> workspace =
+        ctx.requested[0].get_space_typed<xpu, 1, char>(Shape1(nbytes), s);
+    Copy(workspace, Tensor<cpu, 1, char>(host.data(), Shape1(nbytes)), s);
+    const float* dev_mean = reinterpret_cast<const float*>(workspace.dptr_ + images_bytes);
+    MXNET_ASSIGN_REQ_SWITCH(req[0], Req, {
+      Kernel<batch_preprocess_forward<Req>, xpu>::Launch(
+          s,
+          out.Size(),
+          out.dptr<float>(),
+          reinterpret_cast<const BatchImage<DType>*>(workspace.dptr_),
+          dev_mean,
+          dev_mean + channels,
+          channels,
+          size.height,
+          size.width);
+    });
+  });
+}
+
+}  // namespace image
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_IMAGE_BATCH_PREPROCESS_INL_H_
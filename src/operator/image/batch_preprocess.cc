@@ -0,0 +1,82 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file batch_preprocess.cc
+ * \brief batched image preprocessing operator cpu
+ */
+#include "./batch_preprocess-inl.h"
+
+namespace mxnet {
+namespace op {
+namespace image {
+
+DMLC_REGISTER_PARAMETER(BatchPreprocessParam);
+
+NNVM_REGISTER_OP(_image_batch_preprocess)
+    .add_alias("_npx__image_batch_preprocess")
+    .describe(R"code(Preprocess a batch of images of different sizes, each of shape (H x W x C),
+into one float32 tensor of shape (N x C x H x W), in one kernel launch.
+
+Each image is resized with bilinear interpolation, to `size` or with its short edge to
+`resize_short` followed by a center crop to `size`. It is then optionally flipped left to
+right, divided by 255 and normalized by `mean` and `std`. The result is that of
+`resize`, `center_crop`, `flip_left_right`, `to_tensor` and `normalize` applied to each
+image and stacked, without a kernel launch per image and operator.
+
+Example:
+
+.. code-block:: python
+
+    images = [mx.nd.random.uniform(0, 255, (480, 640, 3)).astype('uint8'),
+              mx.nd.random.uniform(0, 255, (375, 500, 3)).astype('uint8')]
+    mx.nd.image.batch_preprocess(*images, size=224, resize_short=256, flip=(0, 1),
+                                 mean=(0.485, 0.456, 0.406), std=(0.229, 0.224, 0.225))
+        <NDArray 2x3x224x224 @cpu(0)>
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      return static_cast<uint32_t>(nnvm::get<BatchPreprocessParam>(attrs.parsed).num_images);
+    })
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<BatchPreprocessParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       const BatchPreprocessParam& param =
+                                           nnvm::get<BatchPreprocessParam>(attrs.parsed);
+                                       std::vector<std::string> ret;
+                                       for (int i = 0; i < param.num_images; ++i)
+                                         ret.push_back(std::string("data") + std::to_string(i));
+                                       return ret;
+                                     })
+    .set_attr<mxnet::FInferShape>("FInferShape", BatchPreprocessShape)
+    .set_attr<nnvm::FInferType>("FInferType", BatchPreprocessType)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", BatchPreprocess<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes)
+    .set_attr<std::string>("key_var_num_args", "num_images")
+    .add_argument("data", "NDArray-or-Symbol[]", "The images, of shape (H x W x C).")
+    .add_arguments(BatchPreprocessParam::__FIELDS__());
+
+}  // namespace image
+}  // namespace op
+}  // namespace mxnet
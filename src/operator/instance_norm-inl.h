@@ -34,6 +34,7 @@
 #include <utility>
 #include "./operator_common.h"
 #include "./mshadow_op.h"
+#include "./nn/welford-inl.h"
 
 namespace mxnet {
 namespace op {
@@ -80,7 +81,6 @@ void InstanceNormForward(const nnvm::NodeAttrs& attrs,
   int c              = dshape[1];
   int rest_dim       = static_cast<int>(in_data[instance_norm::kData].Size() / n / c);
   Shape<2> s2        = Shape2(n * c, rest_dim);
-  const real_t scale = static_cast<real_t>(1) / static_cast<real_t>(rest_dim);
   // Get Inputs
   Tensor<xpu, 2> data  = in_data[instance_norm::kData].get_with_shape<xpu, 2, real_t>(s2, s);
   Tensor<xpu, 1> gamma = in_data[instance_norm::kGamma].get<xpu, 1, real_t>(s);
@@ -89,9 +89,14 @@ void InstanceNormForward(const nnvm::NodeAttrs& attrs,
   Tensor<xpu, 2> out  = out_data[instance_norm::kOut].get_with_shape<xpu, 2, real_t>(s2, s);
   Tensor<xpu, 1> var  = out_data[instance_norm::kVar].FlatTo1D<xpu, real_t>(s);
   Tensor<xpu, 1> mean = out_data[instance_norm::kMean].FlatTo1D<xpu, real_t>(s);
-  // Calculate mean + var
-  mean = scale * sumall_except_dim<0>(data);
-  var = scale * sumall_except_dim<0>(F<mshadow_op::square>(data - broadcast<0>(mean, data.shape_)));
+  // Calculate mean + var in one pass over the data
+  const mxnet::TShape moments_shape = Shape2(n * c, 1);
+  WelfordMomentsCompute<xpu>(ctx,
+                             in_data[instance_norm::kData].reshape(s2),
+                             out_data[instance_norm::kMean].reshape(moments_shape),
+                             out_data[instance_norm::kVar].reshape(moments_shape),
+                             kWriteTo,
+                             kWriteTo);
   Assign(out,
          req[instance_norm::kOut],
          broadcast<0>(reshape(repmat(gamma, n), Shape1(n * c)), out.shape_) *
@@ -119,6 +119,10 @@ Examples::
                                         [](const NodeAttrs& attrs) { return 1; })
     .set_attr_parser(ParamParser<InstanceNormParam>)
     .set_attr<mxnet::FInferShape>("FInferShape", InstanceNormShape)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
     .set_attr<THasDeterministicOutput>("THasDeterministicOutput", true)
     .set_attr<nnvm::FGradient>("FGradient", InstanceNormGrad{"_backward_instance_norm"})
     .set_attr<FCompute>("FCompute<cpu>", InstanceNormForward<cpu>);
@@ -28,8 +28,10 @@
 #include <mxnet/op_attr_types.h>
 
 #include <algorithm>
+#include <cmath>
 
 #include "../common/cuda/utils.h"
+#include "../engine/openmp.h"
 #include "mxnet_op.h"
 
 // Convenience functions.
@@ -987,6 +989,171 @@ LINALG_XPU_BATCH_TRMM(gpu, double)
 
 #endif  // __CUDACC__
 
+//////////////////////////////// SMALL MATRICES ////////////////////////////////////
+
+// Batches of matrices up to this size are factored on cpu by the loops below, one matrix per
+// OpenMP thread, instead of by one LAPACK call per matrix whose overhead dominates for them.
+// They follow the LAPACK conventions of the functions they replace, including the layout of
+// the results and of the pivots.
+const int kLinalgSmallMatrix = 32;
+
+// Cholesky factor of the row-major n x n matrix a in its lower (upper) triangle, as potrf.
+// Returns false when the matrix is not positive definite.
+template <typename DType>
+inline bool linalg_small_potrf(DType* a, int n, int lda, bool lower) {
+  // element (i, j) of the factor stored as a lower triangular matrix
+  auto at = [&](int i, int j) -> DType& { return lower ? a[i * lda + j] : a[j * lda + i]; };
+  for (int j = 0; j < n; ++j) {
+    DType d = at(j, j);
+    for (int k = 0; k < j; ++k) {
+      d -= at(j, k) * at(j, k);
+    }
+    if (!(d > DType(0))) {
+      return false;
+    }
+    at(j, j) = std::sqrt(d);
+    for (int i = j + 1; i < n; ++i) {
+      DType x = at(i, j);
+      for (int k = 0; k < j; ++k) {
+        x -= at(i, k) * at(j, k);
+      }
+      at(i, j) = x / at(j, j);
+    }
+  }
+  return true;
+}
+
+// Inverse of L * L^T from the Cholesky factor L of potrf, as potri. Only the triangle holding
+// the factor is written. Returns false when the factor is singular.
+template <typename DType>
+inline bool linalg_small_potri(DType* a, int n, int lda, bool lower) {
+  auto at = [&](int i, int j) -> DType& { return lower ? a[i * lda + j] : a[j * lda + i]; };
+  // inverse of L, which is lower triangular as well
+  DType inv[kLinalgSmallMatrix * kLinalgSmallMatrix];
+  for (int j = 0; j < n; ++j) {
+    if (at(j, j) == DType(0)) {
+      return false;
+    }
+    inv[j * n + j] = DType(1) / at(j, j);
+    for (int i = j + 1; i < n; ++i) {
+      DType x = DType(0);
+      for (int k = j; k < i; ++k) {
+        x -= at(i, k) * inv[k * n + j];
+      }
+      inv[i * n + i] = DType(1) / at(i, i);
+      inv[i * n + j] = x * inv[i * n + i];
+    }
+  }
+  // (L * L^T)^-1 = L^-T * L^-1
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j <= i; ++j) {
+      DType x = DType(0);
+      for (int k = i; k < n; ++k) {
+        x += inv[k * n + i] * inv[k * n + j];
+      }
+      at(i, j) = x;
+    }
+  }
+  return true;
+}
+
+// LU factorization with partial pivoting of the column-major m x n matrix a, as getrf.
+// ipiv holds the 1-based row interchanges. Returns 0, or j + 1 when U(j, j) is exactly zero.
+template <typename DType, typename IndexT>
+inline int linalg_small_getrf(DType* a, int m, int n, int lda, IndexT* ipiv) {
+  auto at  = [&](int i, int j) -> DType& { return a[j * lda + i]; };
+  int info = 0;
+  for (int j = 0; j < std::min(m, n); ++j) {
+    int p = j;
+    for (int i = j + 1; i < m; ++i) {
+      if (std::abs(at(i, j)) > std::abs(at(p, j))) {
+        p = i;
+      }
+    }
+    ipiv[j] = p + 1;
+    if (at(p, j) != DType(0)) {
+      if (p != j) {
+        for (int k = 0; k < n; ++k) {
+          std::swap(at(j, k), at(p, k));
+        }
+      }
+      for (int i = j + 1; i < m; ++i) {
+        at(i, j) /= at(j, j);
+      }
+    } else if (info == 0) {
+      info = j + 1;
+    }
+    for (int k = j + 1; k < n; ++k) {
+      const DType u = at(j, k);
+      for (int i = j + 1; i < m; ++i) {
+        at(i, k) -= at(i, j) * u;
+      }
+    }
+  }
+  return info;
+}
+
+// Inverse of the column-major n x n matrix from its LU factorization by getrf, as getri.
+// Returns false when U is singular.
+template <typename DType, typename IndexT>
+inline bool linalg_small_getri(DType* a, int n, int lda, const IndexT* ipiv) {
+  auto at = [&](int i, int j) -> DType& { return a[j * lda + i]; };
+  // invert U in place, column by column
+  for (int j = 0; j < n; ++j) {
+    if (at(j, j) == DType(0)) {
+      return false;
+    }
+    at(j, j)       = DType(1) / at(j, j);
+    const DType dj = -at(j, j);
+    for (int i = 0; i < j; ++i) {
+      DType x = DType(0);
+      for (int k = i; k < j; ++k) {
+        x += at(i, k) * at(k, j);
+      }
+      at(i, j) = x * dj;
+    }
+  }
+  // solve inv(A) * L = inv(U) for inv(A)
+  DType work[kLinalgSmallMatrix];
+  for (int j = n - 1; j >= 0; --j) {
+    for (int i = j + 1; i < n; ++i) {
+      work[i]  = at(i, j);
+      at(i, j) = DType(0);
+    }
+    for (int k = j + 1; k < n; ++k) {
+      for (int i = 0; i < n; ++i) {
+        at(i, j) -= at(i, k) * work[k];
+      }
+    }
+  }
+  // undo the row interchanges of getrf on the columns
+  for (int j = n - 2; j >= 0; --j) {
+    const int p = ipiv[j] - 1;
+    if (p != j) {
+      for (int i = 0; i < n; ++i) {
+        std::swap(at(i, j), at(i, p));
+      }
+    }
+  }
+  return true;
+}
+
+// Run f(i) over the batch of small matrices in parallel, f returns false on failure.
+// Returns the index of a matrix for which f failed, or -1.
+template <typename F>
+inline index_t linalg_small_batch(index_t batch, const F& f) {
+  index_t failed = -1;
+  const int omp_threads = mxnet::engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t i = 0; i < batch; ++i) {
+    if (!f(i)) {
+#pragma omp critical
+      failed = i;
+    }
+  }
+  return failed;
+}
+
 //////////////////////////////// POTRF ////////////////////////////////////////////
 
 // CPU/GPU-versions of LAPACK function "potrf". Please refer to the LAPACK-documentation
@@ -1014,17 +1181,40 @@ inline void check_potrf(const Tensor<xpu, 2, DType>& A, bool lower) {
 LINALG_CPU_POTRF(spotrf, float)
 LINALG_CPU_POTRF(dpotrf, double)
 
-#define LINALG_CPU_BATCH_POTRF(DType)                               \
-  template <>                                                       \
-  inline void linalg_batch_potrf<cpu, DType>(                       \
-      const Tensor<cpu, 3, DType>& A, bool lower, Stream<cpu>* s) { \
-    for (index_t i = 0; i < A.size(0); ++i) {                       \
-      linalg_potrf(A[i], lower);                                    \
-    }                                                               \
+#define LINALG_CPU_BATCH_POTRF(DType)                                                  \
+  template <>                                                                          \
+  inline void linalg_batch_potrf<cpu, DType>(                                          \
+      const Tensor<cpu, 3, DType>& A, bool lower, Stream<cpu>* s) {                    \
+    if (A.size(1) <= kLinalgSmallMatrix) {                                             \
+      check_potrf(A[0], lower);                                                        \
+      index_t failed = linalg_small_batch(A.size(0), [&](index_t i) {                  \
+        return linalg_small_potrf(A[i].dptr_, A.size(1), A.stride_, lower);            \
+      });                                                                              \
+      CHECK_EQ(failed, -1) << "potrf failed on cpu for matrix " << failed              \
+                           << " of the batch. " << potrf_errstr;                       \
+      return;                                                                          \
+    }                                                                                  \
+    for (index_t i = 0; i < A.size(0); ++i) {                                          \
+      linalg_potrf(A[i], lower);                                                       \
+    }                                                                                  \
   }
 LINALG_CPU_BATCH_POTRF(float)
 LINALG_CPU_BATCH_POTRF(double)
 
+#ifdef __CUDACC__
+
+// "potrfBatched" in cuSolver and "getrfBatched" and "getriBatched" in cuBLAS must have
+// DType *matrices[] as input to store the pointers of each batch matrix. This kernel is
+// used to build the pointer array.
+struct set_matrix {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(int i, DType** p, DType* m, int step) {
+    p[i] = m + i * step;
+  }
+};
+
+#endif  // __CUDACC__
+
 #if defined(__CUDACC__) && MXNET_USE_CUSOLVER == 1
 
 #define LINALG_GPU_BUFFSIZE_POTRF(fname, DType)                                                  \
@@ -1069,6 +1259,38 @@ LINALG_GPU_BUFFSIZE_POTRF(DnDpotrf_bufferSize, double)
 LINALG_GPU_POTRF(DnSpotrf, float)
 LINALG_GPU_POTRF(DnDpotrf, double)
 
+// potrfBatched factors all matrices of the batch with one call, which is only available
+// with cuda 9.1 or higher.
+#if CUDA_VERSION >= 9010
+
+#define LINALG_GPU_BATCH_POTRF(fname, DType)                                                   \
+  template <>                                                                                  \
+  inline void linalg_batch_potrf<gpu, DType>(                                                  \
+      const Tensor<gpu, 3, DType>& A, bool lower, Stream<gpu>* s) {                            \
+    using namespace mxnet;                                                                     \
+    using namespace mxnet::op::mxnet_op;                                                       \
+    using mshadow::gpu;                                                                        \
+    CHECK_NOTNULL(s);                                                                          \
+    CHECK_GT(A.size(0), 0);                                                                    \
+    check_potrf(A[0], lower);                                                                  \
+    EPHEMERAL_GPU_STORAGE_ALLOC(linalg_batch_potrf, info, int, A.size(0));                     \
+    EPHEMERAL_GPU_STORAGE_ALLOC(linalg_batch_potrf, A_ptr_buf, DType*, A.size(0));             \
+    DType** A_ptr = static_cast<DType**>(A_ptr_buf.dptr);                                      \
+    Kernel<set_matrix, gpu>::Launch(s, A.size(0), A_ptr, A.dptr_, A.size(1) * A.stride_);      \
+    CUSOLVER_CALL(cusolver##fname##Batched(                                                    \
+        Stream<gpu>::GetSolverHandle(s),                                                       \
+        (lower ? CUBLAS_FILL_MODE_UPPER : CUBLAS_FILL_MODE_LOWER),                             \
+        A.size(1),                                                                             \
+        A_ptr,                                                                                 \
+        A.stride_,                                                                             \
+        static_cast<int*>(info.dptr),                                                          \
+        A.size(0)));                                                                           \
+    Storage::Get()->Free(info);                                                                \
+    Storage::Get()->Free(A_ptr_buf);                                                           \
+  }
+
+#else
+
 #define LINALG_GPU_BATCH_POTRF(fname, DType)                                                   \
   template <>                                                                                  \
   inline void linalg_batch_potrf<gpu, DType>(                                                  \
@@ -1094,6 +1316,9 @@ LINALG_GPU_POTRF(DnDpotrf, double)
     Storage::Get()->Free(buffer);                                                              \
     Storage::Get()->Free(info);                                                                \
   }
+
+#endif  // CUDA_VERSION >= 9010
+
 LINALG_GPU_BATCH_POTRF(DnSpotrf, float)
 LINALG_GPU_BATCH_POTRF(DnDpotrf, double)
 
@@ -1127,13 +1352,22 @@ inline void check_potri(const Tensor<xpu, 2, DType>& A, bool lower) {
 LINALG_CPU_POTRI(spotri, float)
 LINALG_CPU_POTRI(dpotri, double)
 
-#define LINALG_CPU_BATCH_POTRI(DType)                               \
-  template <>                                                       \
-  inline void linalg_batch_potri<cpu, DType>(                       \
-      const Tensor<cpu, 3, DType>& A, bool lower, Stream<cpu>* s) { \
-    for (index_t i = 0; i < A.size(0); ++i) {                       \
-      linalg_potri(A[i], lower);                                    \
-    }                                                               \
+#define LINALG_CPU_BATCH_POTRI(DType)                                                  \
+  template <>                                                                          \
+  inline void linalg_batch_potri<cpu, DType>(                                          \
+      const Tensor<cpu, 3, DType>& A, bool lower, Stream<cpu>* s) {                    \
+    if (A.size(1) <= kLinalgSmallMatrix) {                                             \
+      check_potri(A[0], lower);                                                        \
+      index_t failed = linalg_small_batch(A.size(0), [&](index_t i) {                  \
+        return linalg_small_potri(A[i].dptr_, A.size(1), A.stride_, lower);            \
+      });                                                                              \
+      CHECK_EQ(failed, -1) << "potri failed on cpu for matrix " << failed              \
+                           << " of the batch. " << potri_errstr;                       \
+      return;                                                                          \
+    }                                                                                  \
+    for (index_t i = 0; i < A.size(0); ++i) {                                          \
+      linalg_potri(A[i], lower);                                                       \
+    }                                                                                  \
   }
 LINALG_CPU_BATCH_POTRI(float)
 LINALG_CPU_BATCH_POTRI(double)
@@ -1844,6 +2078,15 @@ LINALG_CPU_GETRF(dgetrf, double)
                                              const Tensor<cpu, 2, IndexT>& pivot, \
                                              bool check_singular,                 \
                                              Stream<cpu>* s) {                    \
+    if (A.size(1) <= kLinalgSmallMatrix && A.size(2) <= kLinalgSmallMatrix) {     \
+      index_t failed = linalg_small_batch(A.size(0), [&](index_t i) {             \
+        const int info = linalg_small_getrf(                                      \
+            A[i].dptr_, A.size(2), A.size(1), A.stride_, pivot[i].dptr_);         \
+        return !check_singular || info == 0;                                      \
+      });                                                                         \
+      CHECK_EQ(failed, -1) << "the input matrix is non-convertible";              \
+      return;                                                                     \
+    }                                                                             \
     for (IndexT i = 0; i < A.size(0); ++i) {                                      \
       linalg_getrf(A[i], pivot[i], check_singular);                               \
     }                                                                             \
@@ -1854,16 +2097,6 @@ LINALG_CPU_BATCH_GETRF(dgetrf, double, LapackIndex<cpu>::IndexT)
 
 #ifdef __CUDACC__
 
-// "getrfBatched" and "getriBatched" in cuBLAS must have DType *matrices[] as input
-// to store the pointers of each batch matrix. This kernel is used to build the
-// pointer array.
-struct set_matrix {
-  template <typename DType>
-  MSHADOW_XINLINE static void Map(int i, DType** p, DType* m, int step) {
-    p[i] = m + i * step;
-  }
-};
-
 // GETRF only available with cuda8 or higher.
 #if CUDA_VERSION >= 8000
 
@@ -2026,6 +2259,17 @@ LINALG_GPU_BATCH_GETRI(DgetriBatched, double)
                                                const Tensor<xpu, 3, DType>& B,                     \
                                                const mxnet::OpContext& ctx) {                      \
     Stream<xpu>* s = ctx.get_stream<xpu>();                                                        \
+    if (A.size(1) <= kLinalgSmallMatrix) {                                                         \
+      if (A.dptr_ != B.dptr_)                                                                      \
+        Copy(A, B, s);                                                                             \
+      index_t failed = linalg_small_batch(A.size(0), [&](index_t i) {                              \
+        lapack_index_t pivot[kLinalgSmallMatrix];                                                  \
+        return linalg_small_getrf(A[i].dptr_, A.size(1), A.size(1), A.stride_, pivot) == 0 &&      \
+               linalg_small_getri(A[i].dptr_, A.size(1), A.stride_, pivot);                        \
+      });                                                                                          \
+      CHECK_EQ(failed, -1) << "the input matrix is non-convertible";                               \
+      return;                                                                                      \
+    }                                                                                              \
     lapack_index_t lwork(linalg_getri_workspace_query(A[0], s));                                   \
     lapack_index_t workspace_size =                                                                \
         (sizeof(lapack_index_t) * A.size(1) + sizeof(DType) * lwork + sizeof(DType) - 1) /         \
@@ -2101,6 +2345,14 @@ LINALG_GPU_BATCH_INVERSE(gpu, double)
                                                            const DType zero_det,                \
                                                            const mxnet::OpContext& ctx) {       \
     Stream<xpu>* s = ctx.get_stream<xpu>();                                                     \
+    if (LU.size(1) <= kLinalgSmallMatrix) {                                                     \
+      index_t failed = linalg_small_batch(LU.size(0), [&](index_t i) {                          \
+        return det[i] == zero_det ||                                                            \
+               linalg_small_getri(LU[i].dptr_, LU.size(1), LU.stride_, pivot[i].dptr_);         \
+      });                                                                                       \
+      CHECK_EQ(failed, -1) << "getri failed on cpu.";                                           \
+      return;                                                                                   \
+    }                                                                                           \
     lapack_index_t lwork(linalg_getri_workspace_query(LU[0], s));                               \
     Tensor<xpu, 1, DType> work =                                                                \
         ctx.requested[0].get_space_typed<xpu, 1, DType>(Shape1(lwork), s);                      \
@@ -27,6 +27,8 @@
 #include <mxnet/operator_util.h>
 #include <vector>
 #include "./mshadow_op.h"
+#include "./mxnet_op.h"
+#include "./math_functions-inl.h"
 #include "./elemwise_op_common.h"
 
 namespace mxnet {
@@ -44,6 +46,140 @@ inline bool SoftmaxCrossEntropyShape(const nnvm::NodeAttrs& attrs,
   return true;
 }
 
+/*!
+ * \brief Log-sum-exp of one row of the data, read once with an online normalizer: the running
+ *        sum of exp is rescaled whenever the running max grows.
+ */
+struct softmax_cross_entropy_lse {
+  template <typename DType, typename AType>
+  MSHADOW_XINLINE static void Map(index_t i, AType* lse, const DType* data, const index_t M) {
+    const DType* row = data + i * M;
+    AType mmax       = static_cast<AType>(row[0]);
+    AType sum        = AType(1);
+    for (index_t j = 1; j < M; ++j) {
+      const AType val = static_cast<AType>(row[j]);
+      if (mmax < val) {
+        sum  = sum * math::exp(mmax - val) + AType(1);
+        mmax = val;
+      } else {
+        sum += val == mmax ? AType(1) : math::exp(val - mmax);
+      }
+    }
+    lse[i] = mmax + math::log(sum);
+  }
+};
+
+/*!
+ * \brief Per row loss -log(max(softmax(data)[label], 1e-8)) from the row's log-sum-exp.
+ */
+struct softmax_cross_entropy_loss {
+  template <typename DType, typename AType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* loss,
+                                  const AType* lse,
+                                  const DType* data,
+                                  const DType* label,
+                                  const index_t M) {
+    const AType picked = static_cast<AType>(data[i * M + static_cast<index_t>(label[i])]);
+    // -log(1e-8)
+    const AType max_loss = AType(18.420680743952367);
+    const AType row_loss = lse[i] - picked;
+    loss[i]              = static_cast<DType>(row_loss < max_loss ? row_loss : max_loss);
+  }
+};
+
+/*!
+ * \brief Gradient ograd * (softmax(data) - one_hot(label)), with the softmax recomputed from
+ *        the row's log-sum-exp instead of being stored.
+ */
+template <int req>
+struct softmax_cross_entropy_grad {
+  template <typename DType, typename AType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* igrad,
+                                  const DType* ograd,
+                                  const AType* lse,
+                                  const DType* data,
+                                  const DType* label,
+                                  const index_t M) {
+    const index_t row = i / M;
+    AType grad        = math::exp(static_cast<AType>(data[i]) - lse[row]);
+    if (i - row * M == static_cast<index_t>(label[row])) {
+      grad -= AType(1);
+    }
+    KERNEL_ASSIGN(igrad[i], req, static_cast<DType>(static_cast<AType>(ograd[0]) * grad));
+  }
+};
+
+template <typename DType, typename AType>
+inline void SoftmaxCrossEntropyLogSumExp(mshadow::Stream<cpu>* s,
+                                         const DType* data,
+                                         AType* lse,
+                                         const index_t N,
+                                         const index_t M) {
+  mxnet_op::Kernel<softmax_cross_entropy_lse, cpu>::Launch(s, N, lse, data, M);
+}
+
+#ifdef __CUDACC__
+const int softmax_cross_entropy_threads = 256;
+
+/*!
+ * \brief One block per row: every thread keeps a running max and a sum of exp rescaled to it,
+ *        then the (max, sum) pairs of the block are merged in shared memory.
+ */
+template <typename DType, typename AType>
+__global__ void softmax_cross_entropy_lse_kernel(const DType* data,
+                                                 AType* lse,
+                                                 const index_t M) {
+  __shared__ AType smax[softmax_cross_entropy_threads];
+  __shared__ AType ssum[softmax_cross_entropy_threads];
+  const DType* row = data + blockIdx.x * M;
+  AType mmax       = static_cast<AType>(row[0]);
+  AType sum        = AType(0);
+  for (index_t j = threadIdx.x; j < M; j += blockDim.x) {
+    const AType val = static_cast<AType>(row[j]);
+    if (mmax < val) {
+      sum  = sum * math::exp(mmax - val) + AType(1);
+      mmax = val;
+    } else {
+      sum += val == mmax ? AType(1) : math::exp(val - mmax);
+    }
+  }
+  smax[threadIdx.x] = mmax;
+  ssum[threadIdx.x] = sum;
+  __syncthreads();
+  for (int size = blockDim.x / 2; size > 0; size /= 2) {
+    if (threadIdx.x < size) {
+      const AType max1  = smax[threadIdx.x];
+      const AType max2  = smax[threadIdx.x + size];
+      const AType m     = max1 < max2 ? max2 : max1;
+      ssum[threadIdx.x] = (max1 == m ? ssum[threadIdx.x]
+                                     : ssum[threadIdx.x] * math::exp(max1 - m)) +
+                          (max2 == m ? ssum[threadIdx.x + size]
+                                     : ssum[threadIdx.x + size] * math::exp(max2 - m));
+      smax[threadIdx.x] = m;
+    }
+    __syncthreads();
+  }
+  if (threadIdx.x == 0) {
+    lse[blockIdx.x] = smax[0] + math::log(ssum[0]);
+  }
+}
+
+template <typename DType, typename AType>
+inline void SoftmaxCrossEntropyLogSumExp(mshadow::Stream<gpu>* s,
+                                         const DType* data,
+                                         AType* lse,
+                                         const index_t N,
+                                         const index_t M) {
+  softmax_cross_entropy_lse_kernel<<<N,
+                                     softmax_cross_entropy_threads,
+                                     0,
+                                     mshadow::Stream<gpu>::GetStream(s)>>>(data, lse, M);
+  MSHADOW_CUDA_POST_KERNEL_CHECK(softmax_cross_entropy_lse_kernel);
+}
+#endif  // __CUDACC__
+
 template <typename xpu>
 void SoftmaxCrossEntropyForward(const nnvm::NodeAttrs& attrs,
                                 const OpContext& ctx,
@@ -51,28 +187,30 @@ void SoftmaxCrossEntropyForward(const nnvm::NodeAttrs& attrs,
                                 const std::vector<OpReqType>& req,
                                 const std::vector<TBlob>& outputs) {
   using namespace mshadow::expr;
+  using namespace mxnet_op;
   mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
   CHECK_EQ(outputs[0].type_flag_, inputs[0].type_flag_)
       << "Binary function only support input/output with the same type";
   CHECK_EQ(outputs[0].type_flag_, inputs[1].type_flag_)
       << "Binary function only support input/output with the same type";
-  MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, DType, {
-    mshadow::Tensor<xpu, 1, DType> out       = outputs[0].get<xpu, 1, DType>(s);
-    mshadow::Tensor<xpu, 1, DType> mlabel    = inputs[1].get<xpu, 1, DType>(s);
-    mshadow::Tensor<xpu, 2, DType> mdata     = inputs[0].get<xpu, 2, DType>(s);
-    mshadow::Tensor<xpu, 1, DType> workspace = ctx.requested[0].get_space_typed<xpu, 1, DType>(
-        mshadow::Shape1(mdata.shape_.Size() + mlabel.size(0)), s);
-    mshadow::Tensor<xpu, 2, DType> temp1(workspace.dptr_, mdata.shape_, s);
-    mshadow::Tensor<xpu, 2, DType> temp2(
-        workspace.dptr_ + mdata.shape_.Size(), mshadow::Shape2(1, mlabel.size(0)), s);
-    // calculate softmax on temp
-    // TODO(tqchen): change to SoftmaxLog later
-    mshadow::Softmax(temp1, mdata);
-    // choose the softmax rows
-    mshadow::Tensor<xpu, 1, DType> tdst = temp2[0];
-    tdst                                = F<mshadow_op::negation>(F<mshadow_op::log>(
-        F<mshadow_op::maximum>(mat_choose_row_element(temp1, mlabel), scalar<DType>(1e-8f))));
-    ASSIGN_DISPATCH(out, req[0], sumall_except_dim<0>(temp2));
+  MSHADOW_REAL_TYPE_SWITCH_EX(outputs[0].type_flag_, DType, AType, {
+    mshadow::Tensor<xpu, 1, DType> out    = outputs[0].get<xpu, 1, DType>(s);
+    mshadow::Tensor<xpu, 1, DType> mlabel = inputs[1].get<xpu, 1, DType>(s);
+    mshadow::Tensor<xpu, 2, DType> mdata  = inputs[0].get<xpu, 2, DType>(s);
+    const index_t N                       = mdata.size(0);
+    const index_t M                       = mdata.size(1);
+    // The softmax is never materialized: only the log-sum-exp and the loss of each row are.
+    mshadow::Tensor<xpu, 1, char> workspace = ctx.requested[0].get_space_typed<xpu, 1, char>(
+        mshadow::Shape1(N * (sizeof(AType) + sizeof(DType))), s);
+    AType* lse = reinterpret_cast<AType*>(workspace.dptr_);
+    mshadow::Tensor<xpu, 2, DType> temp(
+        reinterpret_cast<DType*>(workspace.dptr_ + N * sizeof(AType)), mshadow::Shape2(1, N), s);
+    if (N > 0 && M > 0) {
+      SoftmaxCrossEntropyLogSumExp(s, mdata.dptr_, lse, N, M);
+      Kernel<softmax_cross_entropy_loss, xpu>::Launch(
+          s, N, temp.dptr_, lse, mdata.dptr_, mlabel.dptr_, M);
+    }
+    ASSIGN_DISPATCH(out, req[0], sumall_except_dim<0>(temp));
   });
 }
 
@@ -82,19 +220,33 @@ void SoftmaxCrossEntropyBackward(const nnvm::NodeAttrs& attrs,
                                  const std::vector<TBlob>& inputs,
                                  const std::vector<OpReqType>& req,
                                  const std::vector<TBlob>& outputs) {
-  using namespace mshadow::expr;
+  using namespace mxnet_op;
   mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
   CHECK_EQ(req[1], kNullOp) << "SoftmaxCrossEntropy: Cannot take gradient wrt label";
-  MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, DType, {
+  if (req[0] == kNullOp)
+    return;
+  MSHADOW_REAL_TYPE_SWITCH_EX(outputs[0].type_flag_, DType, AType, {
     mshadow::Tensor<xpu, 1, DType> mlabel     = inputs[2].get<xpu, 1, DType>(s);
     mshadow::Tensor<xpu, 2, DType> mdata      = inputs[1].get<xpu, 2, DType>(s);
     mshadow::Tensor<xpu, 2, DType> mdata_grad = outputs[0].get<xpu, 2, DType>(s);
     mshadow::Tensor<xpu, 1, DType> mscale     = inputs[0].get<xpu, 1, DType>(s);
-    mshadow::Tensor<xpu, 2, DType> temp =
-        ctx.requested[0].get_space_typed<xpu, 2, DType>(mdata.shape_, s);
-    mshadow::Softmax(temp, mdata);
-    mshadow::SoftmaxGrad(temp, temp, mlabel);
-    ASSIGN_DISPATCH(mdata_grad, req[0], broadcast_scalar(mscale, temp.shape_) * temp);
+    const index_t N                           = mdata.size(0);
+    const index_t M                           = mdata.size(1);
+    if (N == 0 || M == 0)
+      return;
+    mshadow::Tensor<xpu, 1, AType> lse =
+        ctx.requested[0].get_space_typed<xpu, 1, AType>(mshadow::Shape1(N), s);
+    SoftmaxCrossEntropyLogSumExp(s, mdata.dptr_, lse.dptr_, N, M);
+    MXNET_ASSIGN_REQ_SWITCH(req[0], Req, {
+      Kernel<softmax_cross_entropy_grad<Req>, xpu>::Launch(s,
+                                                           N * M,
+                                                           mdata_grad.dptr_,
+                                                           mscale.dptr_,
+                                                           lse.dptr_,
+                                                           mdata.dptr_,
+                                                           mlabel.dptr_,
+                                                           M);
+    });
   });
 }
 
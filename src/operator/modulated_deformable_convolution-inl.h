@@ -120,17 +120,15 @@ class ModulatedDeformableConvolutionOp : public Operator {
     Tensor<xpu, 1, DType> workspace =
         ctx.requested[dmconv::kTempSpace].get_space_typed<xpu, 1, DType>(
             Shape1(col_buffer_size_ + num_ * output_dim_), s);
-    // calculate the shape of col_buffer
+    // calculate the shape of the whole column matrix, of which col_buffer holds bands of rows
     mxnet::TShape col_buffer_shape(num_spatial_axes_ + 2, -1);
     col_buffer_shape[0] = conv_in_channels_ * param_.kernel.Size();
-    //  for (index_t i = 1; i < col_buffer_shape.ndim(); ++i) {
-    //  col_buffer_shape[i] = out_data[0].shape_[i + 1];
     col_buffer_shape[1] = im2col_step_;
     for (index_t i = 2; i < col_buffer_shape.ndim(); ++i) {
       col_buffer_shape[i] = out_data[0].shape_[i];
     }
-    // create a column buffer using workspace and col_buffer_shape
-    TBlob col_buffer(workspace.dptr_, col_buffer_shape, xpu::kDevMask, DataType<DType>::kFlag);
+    const index_t height_col = col_buffer_shape[2];
+    const index_t width_col  = col_buffer_shape[3];
     mxnet::TShape output_buffer_shape(1, -1);
     output_buffer_shape[0] = num_ * output_dim_;
     TBlob output_buffer(workspace.dptr_ + col_buffer_size_,
@@ -138,36 +136,42 @@ class ModulatedDeformableConvolutionOp : public Operator {
                         xpu::kDevMask,
                         DataType<DType>::kFlag);
 
-    // initialize weight and col_buffer 3D tensors for using gemm
+    // initialize weight and output tensors for using gemm
     index_t M = conv_out_channels_ / group_;
     index_t N = im2col_step_ * conv_out_spatial_dim_;
     index_t K = kernel_dim_;
     Tensor<xpu, 3, DType> weight_3d =
         in_data[dmconv::kWeight].get_with_shape<xpu, 3, DType>(Shape3(group_, M, K), s);
-    Tensor<xpu, 3, DType> col_buffer_3d =
-        col_buffer.get_with_shape<xpu, 3, DType>(Shape3(group_, K, N), s);
     Tensor<xpu, 4, DType> output_4d =
         output_buffer.get_with_shape<xpu, 4, DType>(Shape4(num_ / im2col_step_, group_, M, N), s);
     for (index_t n = 0; n < num_ / im2col_step_; ++n) {
-      // transform image to col_buffer in order to use gemm
-      modulated_deformable_im2col(
-          s,
-          in_data[dmconv::kData].dptr<DType>() + n * im2col_step_ * input_dim_,
-          in_data[dmconv::kOffset].dptr<DType>() + n * im2col_step_ * input_offset_dim_,
-          in_data[dmconv::kMask].dptr<DType>() + n * im2col_step_ * input_mask_dim_,
-          in_data[dmconv::kData].shape_,
-          col_buffer.shape_,
-          param_.kernel,
-          param_.pad,
-          param_.stride,
-          param_.dilate,
-          param_.num_deformable_group,
-          col_buffer.dptr<DType>());
       Tensor<xpu, 3, DType> output_3d = output_4d[n];
-      for (index_t g = 0; g < group_; ++g) {
-        // Legacy approach shown here for comparison:
-        //   Assign(output_3d[g], req[dmconv::kOut], dot(weight_3d[g], col_buffer_3d[g]));
-        linalg_gemm(weight_3d[g], col_buffer_3d[g], output_3d[g], false, false, s, kWriteTo);
+      // bands are shorter than the images only for one image per step, see LayerSetUp
+      for (index_t row_begin = 0; row_begin < height_col; row_begin += col_rows_) {
+        const index_t num_rows = std::min(col_rows_, height_col - row_begin);
+        const index_t band     = im2col_step_ * num_rows * width_col;
+        // transform a band of output rows of the images to col_buffer in order to use gemm
+        modulated_deformable_im2col(
+            s,
+            in_data[dmconv::kData].dptr<DType>() + n * im2col_step_ * input_dim_,
+            in_data[dmconv::kOffset].dptr<DType>() + n * im2col_step_ * input_offset_dim_,
+            in_data[dmconv::kMask].dptr<DType>() + n * im2col_step_ * input_mask_dim_,
+            in_data[dmconv::kData].shape_,
+            col_buffer_shape,
+            row_begin,
+            num_rows,
+            param_.kernel,
+            param_.pad,
+            param_.stride,
+            param_.dilate,
+            param_.num_deformable_group,
+            workspace.dptr_);
+        Tensor<xpu, 3, DType> col_buffer_3d(workspace.dptr_, Shape3(group_, K, band), s);
+        for (index_t g = 0; g < group_; ++g) {
+          Tensor<xpu, 2, DType> output_band(
+              output_3d[g].dptr_ + row_begin * width_col, Shape2(M, band), N, s);
+          linalg_gemm(weight_3d[g], col_buffer_3d[g], output_band, false, false, s, kWriteTo);
+        }
       }
     }
     Tensor<xpu, 4, DType> trans_output_4d = output_buffer.get_with_shape<xpu, 4, DType>(
@@ -208,15 +212,15 @@ class ModulatedDeformableConvolutionOp : public Operator {
     Tensor<xpu, 1, DType> workspace =
         ctx.requested[dmconv::kTempSpace].get_space_typed<xpu, 1, DType>(
             Shape1(col_buffer_size_ + num_ * output_dim_), s);
-    // calculate the shape of col_buffer
+    // calculate the shape of the whole column matrix, of which col_buffer holds bands of rows
     mxnet::TShape col_buffer_shape(num_spatial_axes_ + 2, -1);
     col_buffer_shape[0] = conv_in_channels_ * param_.kernel.Size();
     col_buffer_shape[1] = im2col_step_;
     for (index_t i = 2; i < col_buffer_shape.ndim(); ++i) {
       col_buffer_shape[i] = out_grad[dmconv::kData].shape_[i];
     }
-    // create a column buffer using workspace and col_buffer_shape
-    TBlob col_buffer(workspace.dptr_, col_buffer_shape, xpu::kDevMask, DataType<DType>::kFlag);
+    const index_t height_col = col_buffer_shape[2];
+    const index_t width_col  = col_buffer_shape[3];
     mxnet::TShape output_buffer_shape(1, -1);
     output_buffer_shape[0] = num_ * output_dim_;
     TBlob output_buffer(workspace.dptr_ + col_buffer_size_,
@@ -230,7 +234,7 @@ class ModulatedDeformableConvolutionOp : public Operator {
         Shape4(num_ / im2col_step_, im2col_step_, conv_out_channels_, conv_out_spatial_dim_), s);
     trans_output_4d = swapaxis<2, 1>(original_output_4d);
 
-    // initialize weight and col_buffer 3D tensors for using gemm
+    // initialize weight and out_grad tensors for using gemm
     // For computing dLoss/d(in_data[kData])
     index_t M = kernel_dim_;
     index_t N = im2col_step_ * conv_out_spatial_dim_;
@@ -239,8 +243,6 @@ class ModulatedDeformableConvolutionOp : public Operator {
         in_data[dmconv::kWeight].get_with_shape<xpu, 3, DType>(Shape3(group_, K, M), s);
     Tensor<xpu, 4, DType> out_grad_4d =
         output_buffer.get_with_shape<xpu, 4, DType>(Shape4(num_ / im2col_step_, group_, K, N), s);
-    Tensor<xpu, 3, DType> col_buffer_3d =
-        col_buffer.get_with_shape<xpu, 3, DType>(Shape3(group_, M, N), s);
     // For computing dLoss/dWeight
     Tensor<xpu, 3, DType> dweight_3d =
         in_grad[dmconv::kWeight].get_with_shape<xpu, 3, DType>(Shape3(group_, K, M), s);
@@ -251,67 +253,78 @@ class ModulatedDeformableConvolutionOp : public Operator {
 
     for (index_t n = 0; n < num_ / im2col_step_; ++n) {
       Tensor<xpu, 3, DType> out_grad_3d = out_grad_4d[n];
-      for (index_t g = 0; g < group_; ++g) {
-        // Legacy approach shown here for comparison:
-        //   col_buffer_3d[g] = dot(weight_3d[g].T(), out_grad_3d[g]);
-        linalg_gemm(weight_3d[g], out_grad_3d[g], col_buffer_3d[g], true, false, s);
-      }
-
-      // gradient w.r.t. input coordinate data
-      modulated_deformable_col2im_coord(
-          s,
-          col_buffer.dptr<DType>(),
-          in_data[dmconv::kData].dptr<DType>() + n * im2col_step_ * input_dim_,
-          in_data[dmconv::kOffset].dptr<DType>() + n * im2col_step_ * input_offset_dim_,
-          in_data[dmconv::kMask].dptr<DType>() + n * im2col_step_ * input_mask_dim_,
-          in_grad[dmconv::kData].shape_,
-          col_buffer.shape_,
-          param_.kernel,
-          param_.pad,
-          param_.stride,
-          param_.dilate,
-          param_.num_deformable_group,
-          in_grad[dmconv::kOffset].dptr<DType>() + n * im2col_step_ * input_offset_dim_,
-          in_grad[dmconv::kMask].dptr<DType>() + n * im2col_step_ * input_mask_dim_,
-          req[dmconv::kOffset],
-          req[dmconv::kMask]);
-
-      // gradient w.r.t. input data
-      modulated_deformable_col2im(
-          s,
-          col_buffer.dptr<DType>(),
-          in_data[dmconv::kOffset].dptr<DType>() + n * im2col_step_ * input_offset_dim_,
-          in_data[dmconv::kMask].dptr<DType>() + n * im2col_step_ * input_mask_dim_,
-          in_grad[dmconv::kData].shape_,
-          col_buffer.shape_,
-          param_.kernel,
-          param_.pad,
-          param_.stride,
-          param_.dilate,
-          param_.num_deformable_group,
-          in_grad[dmconv::kData].dptr<DType>() + n * im2col_step_ * input_dim_,
-          req[dmconv::kData]);
-
-      // gradient w.r.t. weight, dWeight should accumulate across the batch and group
-      modulated_deformable_im2col(
-          s,
-          in_data[dmconv::kData].dptr<DType>() + n * im2col_step_ * input_dim_,
-          in_data[dmconv::kOffset].dptr<DType>() + n * im2col_step_ * input_offset_dim_,
-          in_data[dmconv::kMask].dptr<DType>() + n * im2col_step_ * input_mask_dim_,
-          in_data[dmconv::kData].shape_,
-          col_buffer.shape_,
-          param_.kernel,
-          param_.pad,
-          param_.stride,
-          param_.dilate,
-          param_.num_deformable_group,
-          col_buffer.dptr<DType>());
-
-      for (index_t g = 0; g < group_; ++g) {
-        auto request = (n == 0) ? req[dmconv::kWeight] : kAddTo;
-        // Legacy approach shown here for comparison:
-        //   Assign(dweight_3d[g], request, dot(out_grad_3d[g], col_buffer_3d[g].T()));
-        linalg_gemm(out_grad_3d[g], col_buffer_3d[g], dweight_3d[g], false, true, s, request);
+      for (index_t row_begin = 0; row_begin < height_col; row_begin += col_rows_) {
+        const index_t num_rows = std::min(col_rows_, height_col - row_begin);
+        const index_t band     = im2col_step_ * num_rows * width_col;
+        Tensor<xpu, 3, DType> col_buffer_3d(workspace.dptr_, Shape3(group_, M, band), s);
+        for (index_t g = 0; g < group_; ++g) {
+          Tensor<xpu, 2, DType> out_grad_band(
+              out_grad_3d[g].dptr_ + row_begin * width_col, Shape2(K, band), N, s);
+          linalg_gemm(weight_3d[g], out_grad_band, col_buffer_3d[g], true, false, s);
+        }
+
+        // gradient w.r.t. input coordinate data and mask
+        modulated_deformable_col2im_coord(
+            s,
+            workspace.dptr_,
+            in_data[dmconv::kData].dptr<DType>() + n * im2col_step_ * input_dim_,
+            in_data[dmconv::kOffset].dptr<DType>() + n * im2col_step_ * input_offset_dim_,
+            in_data[dmconv::kMask].dptr<DType>() + n * im2col_step_ * input_mask_dim_,
+            in_grad[dmconv::kData].shape_,
+            col_buffer_shape,
+            row_begin,
+            num_rows,
+            param_.kernel,
+            param_.pad,
+            param_.stride,
+            param_.dilate,
+            param_.num_deformable_group,
+            in_grad[dmconv::kOffset].dptr<DType>() + n * im2col_step_ * input_offset_dim_,
+            in_grad[dmconv::kMask].dptr<DType>() + n * im2col_step_ * input_mask_dim_,
+            req[dmconv::kOffset],
+            req[dmconv::kMask]);
+
+        // gradient w.r.t. input data
+        modulated_deformable_col2im(
+            s,
+            workspace.dptr_,
+            in_data[dmconv::kOffset].dptr<DType>() + n * im2col_step_ * input_offset_dim_,
+            in_data[dmconv::kMask].dptr<DType>() + n * im2col_step_ * input_mask_dim_,
+            in_grad[dmconv::kData].shape_,
+            col_buffer_shape,
+            row_begin,
+            num_rows,
+            param_.kernel,
+            param_.pad,
+            param_.stride,
+            param_.dilate,
+            param_.num_deformable_group,
+            in_grad[dmconv::kData].dptr<DType>() + n * im2col_step_ * input_dim_,
+            req[dmconv::kData]);
+
+        // gradient w.r.t. weight, dWeight should accumulate across the batch, bands and group
+        modulated_deformable_im2col(
+            s,
+            in_data[dmconv::kData].dptr<DType>() + n * im2col_step_ * input_dim_,
+            in_data[dmconv::kOffset].dptr<DType>() + n * im2col_step_ * input_offset_dim_,
+            in_data[dmconv::kMask].dptr<DType>() + n * im2col_step_ * input_mask_dim_,
+            in_data[dmconv::kData].shape_,
+            col_buffer_shape,
+            row_begin,
+            num_rows,
+            param_.kernel,
+            param_.pad,
+            param_.stride,
+            param_.dilate,
+            param_.num_deformable_group,
+            workspace.dptr_);
+
+        for (index_t g = 0; g < group_; ++g) {
+          auto request = (n == 0 && row_begin == 0) ? req[dmconv::kWeight] : kAddTo;
+          Tensor<xpu, 2, DType> out_grad_band(
+              out_grad_3d[g].dptr_ + row_begin * width_col, Shape2(K, band), N, s);
+          linalg_gemm(out_grad_band, col_buffer_3d[g], dweight_3d[g], false, true, s, request);
+        }
       }
     }
 
@@ -353,9 +366,18 @@ class ModulatedDeformableConvolutionOp : public Operator {
     conv_out_spatial_dim_ = oshape.ProdShape(2, oshape.ndim());
     col_offset_           = kernel_dim_ * conv_out_spatial_dim_;
     output_offset_        = conv_out_channels_ * conv_out_spatial_dim_ / group_;
-    // size of the column buffer used for storing im2col-ed pixels
-    im2col_step_     = std::min(param_.im2col_step, static_cast<uint32_t>(num_));
-    col_buffer_size_ = kernel_dim_ * group_ * im2col_step_ * conv_out_spatial_dim_;
+    // size of the column buffer used for storing im2col-ed pixels. When the columns of
+    // im2col_step_ images do not fit in the workspace, the buffer holds as many output rows of
+    // one image as fit.
+    const index_t col_row_size = kernel_dim_ * group_ * oshape[3];
+    im2col_step_               = std::min(param_.im2col_step, static_cast<uint32_t>(num_));
+    col_rows_                  = oshape[2];
+    if (col_row_size * im2col_step_ * col_rows_ > static_cast<index_t>(param_.workspace)) {
+      const index_t max_rows = param_.workspace / col_row_size;
+      im2col_step_           = 1;
+      col_rows_              = std::max<index_t>(1, std::min<index_t>(oshape[2], max_rows));
+    }
+    col_buffer_size_ = col_row_size * im2col_step_ * col_rows_;
     // input/output image size (#channels * height * width)
     input_dim_          = ishape.ProdShape(1, ishape.ndim());
     input_offset_dim_   = offset_shape.ProdShape(1, offset_shape.ndim());
@@ -387,6 +409,7 @@ class ModulatedDeformableConvolutionOp : public Operator {
   index_t num_kernels_im2col_;
   index_t num_kernels_col2im_;
   index_t im2col_step_;
+  index_t col_rows_;
   bool bias_term_;  // has bias term?
   bool is_1x1_;
 };  // class ModulatedDeformableConvolutionOp
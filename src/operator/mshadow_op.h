@@ -31,6 +31,7 @@
 #include "math_functions-inl.h"
 #include "special_functions-inl.h"
 #include "./operator_tune.h"
+#include "./vectorized_math-inl.h"
 #include "./contrib/erfinv-inl.h"
 
 #ifdef __CUDACC__
@@ -2133,6 +2134,43 @@ struct lcm : public mxnet_op::tunable {
 #pragma GCC diagnostic pop
 
 }  // namespace mshadow_op
+
+namespace vmath {
+
+#define MXNET_VECTORIZED_UNARY_OP(name)     \
+  template <>                               \
+  struct vectorized_op<mshadow_op::name> {  \
+    static constexpr bool value     = true; \
+    static constexpr int num_inputs = 1;    \
+    template <bool fast>                    \
+    static float Map(float a) {             \
+      return vmath::name<fast>(a);          \
+    }                                       \
+  }
+
+MXNET_VECTORIZED_UNARY_OP(exp);
+
+MXNET_VECTORIZED_UNARY_OP(log);
+
+MXNET_VECTORIZED_UNARY_OP(tanh);
+
+MXNET_VECTORIZED_UNARY_OP(sigmoid);
+
+MXNET_VECTORIZED_UNARY_OP(erf);
+
+MXNET_VECTORIZED_UNARY_OP(gelu_erf);
+
+template <>
+struct vectorized_op<mshadow_op::gelu_erf_grad> {
+  static constexpr bool value     = true;
+  static constexpr int num_inputs = 2;
+  template <bool fast>
+  static float Map(float a, float b) {
+    return vmath::gelu_erf_grad<fast>(a, b);
+  }
+};
+
+}  // namespace vmath
 }  // namespace op
 }  // namespace mxnet
 #endif  // MXNET_OPERATOR_MSHADOW_OP_H_
@@ -32,6 +32,7 @@
 #include <algorithm>
 #include <limits>
 #include "./operator_tune.h"
+#include "./vectorized_math-inl.h"
 #include "../engine/openmp.h"
 
 #ifdef __CUDACC__
@@ -294,6 +295,45 @@ struct AccType<mshadow::half::half_t> {
   using type = float;
 };
 
+template <>
+struct AccType<mshadow::bfloat::bf16_t> {
+  using type = float;
+};
+
+/*!
+ * \brief bfloat16 case of the accumulation type switches, bfloat16 data is accumulated in float.
+ *        As in the mshadow type switches, bfloat16 kernels are only built for the CPU.
+ */
+#ifndef __NVCC__
+#define MXNET_BFLOAT16_ACC_TYPE_CASE(DType, AType, ...) \
+  case mshadow::kBfloat16: {                            \
+    typedef mshadow::bfloat::bf16_t DType;              \
+    typedef float AType;                                \
+    { __VA_ARGS__ }                                     \
+  } break;
+#else
+#define MXNET_BFLOAT16_ACC_TYPE_CASE(DType, AType, ...)           \
+  case mshadow::kBfloat16: {                                      \
+    LOG(FATAL) << "This operation only supports bfloat16 on CPU"; \
+  } break;
+#endif
+
+/*!
+ * \brief Adds bfloat16 on CPU to a type switch SWITCH without it, e.g.
+ *        MXNET_WITH_BFLOAT16_TYPE_SWITCH(MSHADOW_REAL_TYPE_SWITCH, type, DType, {...})
+ */
+#ifndef __NVCC__
+#define MXNET_WITH_BFLOAT16_TYPE_SWITCH(SWITCH, type, DType, ...) \
+  if ((type) == mshadow::kBfloat16) {                             \
+    typedef mshadow::bfloat::bf16_t DType;                        \
+    { __VA_ARGS__ }                                               \
+  } else {                                                        \
+    SWITCH(type, DType, __VA_ARGS__)                              \
+  }
+#else
+#define MXNET_WITH_BFLOAT16_TYPE_SWITCH(SWITCH, type, DType, ...) SWITCH(type, DType, __VA_ARGS__)
+#endif
+
 #define MXNET_REAL_ACC_TYPE_SWITCH(type, DType, AType, ...) \
   switch (type) {                                           \
     case mshadow::kFloat32: {                               \
@@ -311,6 +351,7 @@ struct AccType<mshadow::half::half_t> {
       typedef float AType;                                  \
       { __VA_ARGS__ }                                       \
     } break;                                                \
+    MXNET_BFLOAT16_ACC_TYPE_CASE(DType, AType, __VA_ARGS__) \
     case mshadow::kUint8: {                                 \
       LOG(FATAL) << "This operation only support "          \
                     "floating point types not uint8";       \
@@ -335,50 +376,51 @@ struct AccType<mshadow::half::half_t> {
       LOG(FATAL) << "Unknown type enum " << type;           \
   }
 
-#define MXNET_ACC_TYPE_SWITCH(type, DType, AType, ...) \
-  switch (type) {                                      \
-    case mshadow::kFloat32: {                          \
-      typedef float DType;                             \
-      typedef double AType;                            \
-      { __VA_ARGS__ }                                  \
-    } break;                                           \
-    case mshadow::kFloat64: {                          \
-      typedef double DType;                            \
-      typedef double AType;                            \
-      { __VA_ARGS__ }                                  \
-    } break;                                           \
-    case mshadow::kFloat16: {                          \
-      typedef mshadow::half::half_t DType;             \
-      typedef float AType;                             \
-      { __VA_ARGS__ }                                  \
-    } break;                                           \
-    case mshadow::kUint8: {                            \
-      typedef uint8_t DType;                           \
-      typedef uint32_t AType;                          \
-      { __VA_ARGS__ }                                  \
-    } break;                                           \
-    case mshadow::kInt8: {                             \
-      typedef int8_t DType;                            \
-      typedef int32_t AType;                           \
-      { __VA_ARGS__ }                                  \
-    } break;                                           \
-    case mshadow::kInt32: {                            \
-      typedef int32_t DType;                           \
-      typedef int64_t AType;                           \
-      { __VA_ARGS__ }                                  \
-    } break;                                           \
-    case mshadow::kInt64: {                            \
-      typedef int64_t DType;                           \
-      typedef int64_t AType;                           \
-      { __VA_ARGS__ }                                  \
-    } break;                                           \
-    case mshadow::kBool: {                             \
-      typedef bool DType;                              \
-      typedef int64_t AType;                           \
-      { __VA_ARGS__ }                                  \
-    } break;                                           \
-    default:                                           \
-      LOG(FATAL) << "Unknown type enum " << type;      \
+#define MXNET_ACC_TYPE_SWITCH(type, DType, AType, ...)      \
+  switch (type) {                                           \
+    case mshadow::kFloat32: {                               \
+      typedef float DType;                                  \
+      typedef double AType;                                 \
+      { __VA_ARGS__ }                                       \
+    } break;                                                \
+    case mshadow::kFloat64: {                               \
+      typedef double DType;                                 \
+      typedef double AType;                                 \
+      { __VA_ARGS__ }                                       \
+    } break;                                                \
+    case mshadow::kFloat16: {                               \
+      typedef mshadow::half::half_t DType;                  \
+      typedef float AType;                                  \
+      { __VA_ARGS__ }                                       \
+    } break;                                                \
+    MXNET_BFLOAT16_ACC_TYPE_CASE(DType, AType, __VA_ARGS__) \
+    case mshadow::kUint8: {                                 \
+      typedef uint8_t DType;                                \
+      typedef uint32_t AType;                               \
+      { __VA_ARGS__ }                                       \
+    } break;                                                \
+    case mshadow::kInt8: {                                  \
+      typedef int8_t DType;                                 \
+      typedef int32_t AType;                                \
+      { __VA_ARGS__ }                                       \
+    } break;                                                \
+    case mshadow::kInt32: {                                 \
+      typedef int32_t DType;                                \
+      typedef int64_t AType;                                \
+      { __VA_ARGS__ }                                       \
+    } break;                                                \
+    case mshadow::kInt64: {                                 \
+      typedef int64_t DType;                                \
+      typedef int64_t AType;                                \
+      { __VA_ARGS__ }                                       \
+    } break;                                                \
+    case mshadow::kBool: {                                  \
+      typedef bool DType;                                   \
+      typedef int64_t AType;                                \
+      { __VA_ARGS__ }                                       \
+    } break;                                                \
+    default:                                                \
+      LOG(FATAL) << "Unknown type enum " << type;           \
   }
 
 #define MXNET_INT_TYPE_SWITCH(type, DType, ...)    \
@@ -825,6 +867,25 @@ struct backward_grad_tuned : public backward_grad<GRAD_OP>, public tunable {
   using backward_grad<GRAD_OP>::Map;
 };
 
+}  // namespace mxnet_op
+
+namespace vmath {
+
+/*! \brief Backward of a vectorized gradient function */
+template <typename GRAD_OP>
+struct vectorized_op<mxnet_op::backward_grad_tuned<GRAD_OP>> {
+  static constexpr bool value     = vectorized_op<GRAD_OP>::value;
+  static constexpr int num_inputs = vectorized_op<GRAD_OP>::num_inputs + 1;
+  template <bool fast, typename... Args>
+  static float Map(float a, Args... args) {
+    return a * vectorized_op<GRAD_OP>::template Map<fast>(args...);
+  }
+};
+
+}  // namespace vmath
+
+namespace mxnet_op {
+
 /*! \brief Select assignment operation based upon the req value
  * Also useful for mapping mshadow Compute (F<OP>) to Kernel<OP>::Launch
  */
@@ -992,6 +1053,30 @@ struct op_with_req {
   }
 };
 
+/*! \brief Request of an op_with_req kernel, -1 for other kernels */
+template <typename T>
+struct op_req {
+  static constexpr int value = -1;
+};
+
+template <typename OP, int req>
+struct op_req<op_with_req<OP, req>> {
+  static constexpr int value = req;
+};
+
+/*!
+ * \brief Whether a CPU launch of the kernel with these arguments runs with the vectorized
+ *        implementation of its op, see vectorized_math-inl.h
+ */
+template <typename OP, typename DType, typename... Args>
+struct vectorized_kernel {
+  static constexpr bool value =
+      op_req<OP>::value != -1 && std::is_same<DType, float>::value &&
+      vmath::vectorized_op<typename OP::Operation>::value &&
+      vmath::vectorized_op<typename OP::Operation>::num_inputs == sizeof...(Args) &&
+      vmath::all_float_pointers<Args...>::value;
+};
+
 template <typename OP, typename xpu>
 struct Kernel;
 
@@ -1076,9 +1161,20 @@ struct Kernel<OP, cpu> {
   template <typename PRIMITIVE_OP, typename DType, typename... Args>
   static void LaunchTuned(mshadow::Stream<cpu>*, const size_t N, Args... args) {
 #ifdef _OPENMP
-    const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
-    if (omp_threads < 2 ||
-        !tuned_op<PRIMITIVE_OP, DType>::UseOMP(N, static_cast<size_t>(omp_threads))) {
+    const int max_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+    const bool use_omp =
+        max_threads >= 2 &&
+        tuned_op<PRIMITIVE_OP, DType>::UseOMP(N, static_cast<size_t>(max_threads));
+    const int omp_threads =
+        use_omp ? static_cast<int>(OperatorTuneByType<DType>::GetOMPThreadCount(
+                      N,
+                      static_cast<size_t>(max_threads),
+                      static_cast<uint64_t>(N * tuned_op<PRIMITIVE_OP, DType>::workload_[0]))) :
+                  1;
+    const bool sample = OperatorTuneBase::SampleLaunch(N);
+    const OperatorTuneBase::Tick start =
+        sample ? OperatorTuneBase::Now() : OperatorTuneBase::Tick();
+    if (!use_omp) {
       for (size_t i = 0; i < N; ++i) {
         OP::Map(i, args...);
       }
@@ -1088,6 +1184,12 @@ struct Kernel<OP, cpu> {
         OP::Map(i, args...);
       }
     }
+    if (sample) {
+      OperatorTuneBase::RefineWorkload(&tuned_op<PRIMITIVE_OP, DType>::workload_[0],
+                                       N,
+                                       use_omp ? static_cast<size_t>(omp_threads) : 1,
+                                       OperatorTuneBase::GetDurationInNanoseconds(start));
+    }
 #else
     for (size_t i = 0; i < N; ++i) {
       OP::Map(i, args...);
@@ -1151,47 +1253,123 @@ struct Kernel<OP, cpu> {
   static MSHADOW_CINLINE
       typename std::enable_if<std::is_base_of<tunable, typename T::Operation>::value, bool>::type
       Launch(mshadow::Stream<cpu>* s, const size_t N, DType* dest, Args... args) {
-    LaunchTuned<typename T::Operation, DType>(s, N, dest, args...);
+    if (!LaunchVectorized(N, dest, args...))
+      LaunchTuned<typename T::Operation, DType>(s, N, dest, args...);
+    return true;
+  }
+
+  /*!
+   * \brief Launch an op_with_req kernel of float tensors with the vectorized implementation of
+   *        its op from vectorized_math-inl.h. The range is split in chunks among the OMP threads
+   *        and each chunk is run by a SIMD loop.
+   * \return Whether the kernel was launched, false when the op has no vectorized implementation
+   *         for these arguments or MXNET_CPU_VECTORIZED_MATH disables them
+   */
+  template <typename DType, typename... Args>
+  static typename std::enable_if<!vectorized_kernel<OP, DType, Args...>::value, bool>::type
+  LaunchVectorized(const size_t, DType*, Args...) {
+    return false;
+  }
+
+  template <typename DType, typename... Args>
+  static typename std::enable_if<vectorized_kernel<OP, DType, Args...>::value, bool>::type
+  LaunchVectorized(const size_t N, DType* dest, Args... inputs) {
+    const int mode = vmath::GetMode();
+    if (mode == vmath::kOff)
+      return false;
+    if (mode == vmath::kFast) {
+      LaunchVectorizedChunks<true>(N, dest, inputs...);
+    } else {
+      LaunchVectorizedChunks<false>(N, dest, inputs...);
+    }
     return true;
   }
+
+  template <bool fast, typename... Args>
+  static void LaunchVectorizedChunks(const size_t N, float* dest, Args... inputs) {
+    const index_t num_chunks = (N + vmath::kChunkSize - 1) / vmath::kChunkSize;
+#ifdef _OPENMP
+    const int omp_threads = static_cast<int>(std::min<index_t>(
+        num_chunks, engine::OpenMP::Get()->GetRecommendedOMPThreadCount()));
+#pragma omp parallel for num_threads(omp_threads) if (omp_threads > 1)
+#endif
+    for (index_t c = 0; c < num_chunks; ++c) {
+      const index_t begin = c * vmath::kChunkSize;
+      const index_t end   = std::min<index_t>(N, begin + vmath::kChunkSize);
+#if !defined(_MSC_VER)
+#pragma omp simd
+#endif
+      for (index_t i = begin; i < end; ++i) {
+        KERNEL_ASSIGN(dest[i],
+                      op_req<OP>::value,
+                      vmath::vectorized_op<typename OP::Operation>::template Map<fast>(
+                          inputs[i]...));
+      }
+    }
+  }
 };
 
+/*!
+ * \brief Largest number of iterations of a GPU kernel run with 32-bit indices, leaving room for
+ *        the grid-stride increment of the last iterations.
+ */
+constexpr size_t kMaxInt32KernelSize = std::numeric_limits<int>::max() / 2;
+
 #ifdef __CUDACC__
-template <typename OP, typename... Args>
-__global__ void mxnet_generic_kernel(int N, Args... args) {
-  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < N; i += blockDim.x * gridDim.x) {
+template <typename OP, typename IndexType, typename... Args>
+__global__ void mxnet_generic_kernel(IndexType N, Args... args) {
+  for (IndexType i = blockIdx.x * blockDim.x + threadIdx.x; i < N; i += blockDim.x * gridDim.x) {
     OP::Map(i, args...);
   }
 }
 
-template <typename OP, typename... Args>
-__global__ void mxnet_generic_kernel_ex(int N, Args... args) {
-  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < N; i += blockDim.x * gridDim.x) {
+template <typename OP, typename IndexType, typename... Args>
+__global__ void mxnet_generic_kernel_ex(IndexType N, Args... args) {
+  for (IndexType i = blockIdx.x * blockDim.x + threadIdx.x; i < N; i += blockDim.x * gridDim.x) {
     OP::Map(i, 1, args...);
   }
 }
 
 template <typename OP>
 struct Kernel<OP, gpu> {
-  /*! \brief Launch GPU kernel */
+  /*!
+   * \brief Launch GPU kernel. With 64-bit index_t, the loop indices are 32-bit unless N is too
+   *        large for them, which avoids the slower 64-bit arithmetic for most tensors.
+   */
   template <typename... Args>
-  inline static void Launch(mshadow::Stream<gpu>* s, int N, Args... args) {
+  inline static void Launch(mshadow::Stream<gpu>* s, const size_t N, Args... args) {
     if (0 == N)
       return;
     using namespace mshadow::cuda;
-    int ngrid = std::min(kMaxGridNum, (N + kBaseThreadNum - 1) / kBaseThreadNum);
-    mxnet_generic_kernel<OP, Args...>
+    const int ngrid = std::min<size_t>(kMaxGridNum, (N + kBaseThreadNum - 1) / kBaseThreadNum);
+#if MSHADOW_INT64_TENSOR_SIZE == 1
+    if (N > kMaxInt32KernelSize) {
+      mxnet_generic_kernel<OP, index_t, Args...>
+          <<<ngrid, kBaseThreadNum, 0, mshadow::Stream<gpu>::GetStream(s)>>>(N, args...);
+      MSHADOW_CUDA_POST_KERNEL_CHECK(mxnet_generic_kernel);
+      return;
+    }
+#endif
+    mxnet_generic_kernel<OP, int, Args...>
         <<<ngrid, kBaseThreadNum, 0, mshadow::Stream<gpu>::GetStream(s)>>>(N, args...);
     MSHADOW_CUDA_POST_KERNEL_CHECK(mxnet_generic_kernel);
   }
 
   template <typename... Args>
-  inline static void LaunchEx(mshadow::Stream<gpu>* s, const int N, Args... args) {
+  inline static void LaunchEx(mshadow::Stream<gpu>* s, const size_t N, Args... args) {
     if (0 == N)
       return;
     using namespace mshadow::cuda;
-    int ngrid = std::min(kMaxGridNum, (N + kBaseThreadNum - 1) / kBaseThreadNum);
-    mxnet_generic_kernel_ex<OP, Args...>
+    const int ngrid = std::min<size_t>(kMaxGridNum, (N + kBaseThreadNum - 1) / kBaseThreadNum);
+#if MSHADOW_INT64_TENSOR_SIZE == 1
+    if (N > kMaxInt32KernelSize) {
+      mxnet_generic_kernel_ex<OP, index_t, Args...>
+          <<<ngrid, kBaseThreadNum, 0, mshadow::Stream<gpu>::GetStream(s)>>>(N, args...);
+      MSHADOW_CUDA_POST_KERNEL_CHECK(mxnet_generic_kernel_ex);
+      return;
+    }
+#endif
+    mxnet_generic_kernel_ex<OP, int, Args...>
         <<<ngrid, kBaseThreadNum, 0, mshadow::Stream<gpu>::GetStream(s)>>>(N, args...);
     MSHADOW_CUDA_POST_KERNEL_CHECK(mxnet_generic_kernel_ex);
   }
@@ -190,6 +190,7 @@ The following activation functions are supported:
     .set_attr<FComputeEx>("FComputeEx<cpu>", ActivationComputeExCPU)
 #endif
     .set_attr<nnvm::FGradient>("FGradient", ActivationGrad{"_backward_Activation"})
+    .set_attr<mxnet::alm::FChangeLayout>("FChangeLayout", ElemwiseChangeLayout)
     .add_arguments(ActivationParam::__FIELDS__());
 
 NNVM_REGISTER_OP(_backward_Activation)
@@ -38,9 +38,11 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include "../operator_common.h"
 #include "../linalg.h"
+#include "./convolution_cpu.h"
 #include "./im2col.h"
 
 namespace mxnet {
@@ -303,8 +305,10 @@ class ConvolutionOp {
     Tensor<xpu, 4, DType> output_4d =
         out_data.get_with_shape<xpu, 4, DType>(Shape4(num_, group_, M, N), s);
 
-    // no need to allocating memory and reordering in memory
-    if (is_1x1_) {
+    if (_ForwardNativeCPU(ctx, in_data, in_weights, req, out_data)) {
+      // the workspace stays empty: it is not an im2col buffer that the backward could reuse
+    } else if (is_1x1_) {
+      // no need to allocating memory and reordering in memory
       Tensor<xpu, 4, DType> input_4d =
           in_data.get_with_shape<xpu, 4, DType>(Shape4(num_, group_, K, N), s);
       for (index_t n = 0; n < num_; ++n) {
@@ -359,6 +363,81 @@ class ConvolutionOp {
     return workspace;
   }
 
+  /*!
+   * \brief Runs the 2D convolutions of convolution_cpu.h, which avoid the im2col buffer, when
+   *        the shape allows it: direct loops for depthwise convolutions and Winograd for 3x3
+   *        stride 1 ones. Returns false when the im2col + gemm path has to be used.
+   */
+  bool _ForwardNativeCPU(const OpContext& ctx,
+                         const TBlob& in_data,
+                         const TBlob& in_weights,
+                         const OpReqType req,
+                         const TBlob& out_data) {
+    if constexpr (!std::is_same<xpu, cpu>::value || !std::is_floating_point<DType>::value) {
+      return false;
+    } else {
+      if (num_spatial_axes_ != 2 || req == kNullOp)
+        return false;
+      Stream<cpu>* s       = ctx.get_stream<cpu>();
+      const index_t height = in_data.shape_[2];
+      const index_t width  = in_data.shape_[3];
+      const index_t out_h  = out_data.shape_[2];
+      const index_t out_w  = out_data.shape_[3];
+      if (group_ == channels_ && channels_ > 1) {
+        DepthwiseConvolutionCPU(in_data.dptr<DType>(),
+                                in_weights.dptr<DType>(),
+                                out_data.dptr<DType>(),
+                                num_,
+                                channels_,
+                                height,
+                                width,
+                                conv_out_channels_,
+                                out_h,
+                                out_w,
+                                param_.kernel,
+                                param_.stride,
+                                param_.pad,
+                                param_.dilate,
+                                req);
+        return true;
+      }
+      const index_t in_channels_per_group  = channels_ / group_;
+      const index_t out_channels_per_group = conv_out_channels_ / group_;
+
+      const int m = WinogradTileSize(param_.kernel,
+                                     param_.stride,
+                                     param_.dilate,
+                                     in_channels_per_group,
+                                     out_channels_per_group,
+                                     out_h,
+                                     out_w);
+      if (m == 0)
+        return false;
+      const index_t size = ConvolutionWinogradWorkspaceSize(
+          m, in_channels_per_group, conv_out_channels_, out_channels_per_group, out_h, out_w);
+      Tensor<cpu, 1, DType> workspace =
+          ctx.requested[conv::kTempSpace].get_space_typed<cpu, 1, DType>(Shape1(size), s);
+      auto winograd = m == 4 ? ConvolutionWinogradCPU<4, DType> : ConvolutionWinogradCPU<2, DType>;
+      winograd(s,
+               in_data.dptr<DType>(),
+               in_weights.dptr<DType>(),
+               out_data.dptr<DType>(),
+               num_,
+               channels_,
+               height,
+               width,
+               conv_out_channels_,
+               group_,
+               out_h,
+               out_w,
+               param_.pad[0],
+               param_.pad[1],
+               req,
+               workspace.dptr_);
+      return true;
+    }
+  }
+
   // Computes dLoss/dData
   Tensor<xpu, 1, DType> _BackwardData(const OpContext& ctx,
                                       const TBlob& out_grad,
@@ -334,6 +334,20 @@ static bool ConvolutionType(const nnvm::NodeAttrs& attrs,
   return true;
 }
 
+static OpCost ConvolutionCost(const nnvm::NodeAttrs& attrs,
+                              const std::vector<TBlob>& inputs,
+                              const std::vector<TBlob>& outputs) {
+  const ConvolutionParam& param = nnvm::get<ConvolutionParam>(attrs.parsed);
+  // every output element is a dot product with the weights of its filter, the weight
+  // holds num_filter filters whatever the layout
+  const TShape& wshape   = inputs[conv::kWeight].shape_;
+  const uint64_t num_out = outputs[conv::kOut].shape_.Size();
+  OpCost cost;
+  cost.flops = 2 * num_out * (wshape.Size() / param.num_filter) + (param.no_bias ? 0 : num_out);
+  cost.bytes = OpCostBytes(inputs, outputs);
+  return cost;
+}
+
 #if MXNET_USE_ONEDNN == 1
 inline static bool ConvStorageType(const nnvm::NodeAttrs& attrs,
                                    const int dev_mask,
@@ -528,6 +542,7 @@ There are other options to tune the performance.
                                       })
     .set_attr<mxnet::FInferShape>("FInferShape", ConvolutionShape)
     .set_attr<nnvm::FInferType>("FInferType", ConvolutionType)
+    .set_attr<FOpCost>("FOpCost", ConvolutionCost)
     .set_attr<mxnet::alm::FChangeLayout>("FChangeLayout", ConvChangeLayout)
 #if MXNET_USE_ONEDNN == 1
     .set_attr<FInferStorageType>("FInferStorageType", ConvStorageType)
@@ -0,0 +1,334 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file convolution_cpu.h
+ * \brief Native CPU 2D convolutions used instead of im2col + gemm when the shape allows it:
+ *        Winograd F(2x2, 3x3) and F(4x4, 3x3) for 3x3 stride 1 convolutions and a direct
+ *        loop for depthwise convolutions.
+ */
+#ifndef MXNET_OPERATOR_NN_CONVOLUTION_CPU_H_
+#define MXNET_OPERATOR_NN_CONVOLUTION_CPU_H_
+
+#include <mxnet/base.h>
+#include <mxnet/engine.h>
+#include <algorithm>
+#include <vector>
+#include "../linalg.h"
+#include "../mxnet_op.h"
+
+namespace mxnet {
+namespace op {
+
+// Winograd pays off only when the gemms over the channels dominate the transforms
+const index_t kWinogradMinChannels = 8;
+
+/*!
+ * \brief Transform matrices of Winograd F(m x m, 3 x 3) (Lavin and Gray, "Fast Algorithms for
+ *        Convolutional Neural Networks"): Y = AT [(G g GT) . (BT d B)] A on tiles of
+ *        alpha = m + 2 input pixels.
+ */
+template <int m>
+struct WinogradF3;
+
+template <>
+struct WinogradF3<2> {
+  static const int kAlpha = 4;
+
+  static constexpr double BT[4][4] = {{1, 0, -1, 0}, {0, 1, 1, 0}, {0, -1, 1, 0}, {0, 1, 0, -1}};
+  static constexpr double G[4][3]  = {{1, 0, 0}, {0.5, 0.5, 0.5}, {0.5, -0.5, 0.5}, {0, 0, 1}};
+  static constexpr double AT[2][4] = {{1, 1, 1, 0}, {0, 1, -1, -1}};
+};
+
+template <>
+struct WinogradF3<4> {
+  static const int kAlpha = 6;
+
+  static constexpr double BT[6][6] = {{4, 0, -5, 0, 1, 0},
+                                      {0, -4, -4, 1, 1, 0},
+                                      {0, 4, -4, -1, 1, 0},
+                                      {0, -2, -1, 2, 1, 0},
+                                      {0, 2, -1, -2, 1, 0},
+                                      {0, 4, 0, -5, 0, 1}};
+  static constexpr double G[6][3]  = {{1.0 / 4, 0, 0},
+                                     {-1.0 / 6, -1.0 / 6, -1.0 / 6},
+                                     {-1.0 / 6, 1.0 / 6, -1.0 / 6},
+                                     {1.0 / 24, 1.0 / 12, 1.0 / 6},
+                                     {1.0 / 24, -1.0 / 12, 1.0 / 6},
+                                     {0, 0, 1}};
+  static constexpr double AT[4][6] = {{1, 1, 1, 1, 1, 0},
+                                      {0, 1, -1, 2, -2, 0},
+                                      {0, 1, 1, 4, 4, 0},
+                                      {0, 1, -1, 8, -8, 1}};
+};
+
+/*!
+ * \brief Whether a 2D convolution runs with Winograd, and with which output tile size.
+ * \return the output tile size m, or 0 for im2col + gemm
+ */
+inline int WinogradTileSize(const mxnet::TShape& kernel,
+                            const mxnet::TShape& stride,
+                            const mxnet::TShape& dilate,
+                            const index_t in_channels_per_group,
+                            const index_t out_channels_per_group,
+                            const index_t out_h,
+                            const index_t out_w) {
+  if (kernel.ndim() != 2 || kernel[0] != 3 || kernel[1] != 3 || stride[0] != 1 ||
+      stride[1] != 1 || dilate[0] != 1 || dilate[1] != 1 ||
+      in_channels_per_group < kWinogradMinChannels ||
+      out_channels_per_group < kWinogradMinChannels)
+    return 0;
+  // the 4x4 tiles do fewer multiplications but waste more of their padding on small maps
+  return std::min(out_h, out_w) >= 8 ? 4 : 2;
+}
+
+/*!
+ * \brief Size of the workspace of ConvolutionWinogradCPU, in elements.
+ */
+inline index_t ConvolutionWinogradWorkspaceSize(const int m,
+                                                const index_t in_channels_per_group,
+                                                const index_t out_channels,
+                                                const index_t out_channels_per_group,
+                                                const index_t out_h,
+                                                const index_t out_w) {
+  const index_t alpha  = m + 2;
+  const index_t tiles  = ((out_h + m - 1) / m) * ((out_w + m - 1) / m);
+  const index_t weight = alpha * alpha * out_channels * in_channels_per_group;
+  const index_t input  = alpha * alpha * in_channels_per_group * tiles;
+  const index_t output = alpha * alpha * out_channels_per_group * tiles;
+  return weight + input + output;
+}
+
+/*!
+ * \brief Winograd F(m x m, 3 x 3) convolution with stride 1 of NCHW data. The filters are
+ *        transformed once per call, then every image goes through the input transform, alpha^2
+ *        batched gemms over the channels and the output transform. The transformed input is
+ *        (alpha / m)^2 times the input, instead of 9 times the output for im2col.
+ * \param workspace at least ConvolutionWinogradWorkspaceSize elements
+ */
+template <int m, typename DType>
+void ConvolutionWinogradCPU(mshadow::Stream<cpu>* s,
+                            const DType* in,
+                            const DType* weight,
+                            DType* out,
+                            const index_t num,
+                            const index_t channels,
+                            const index_t height,
+                            const index_t width,
+                            const index_t num_filter,
+                            const index_t num_group,
+                            const index_t out_h,
+                            const index_t out_w,
+                            const index_t pad_h,
+                            const index_t pad_w,
+                            const OpReqType req,
+                            DType* workspace) {
+  using mshadow::Shape3;
+  using mshadow::Tensor;
+  typedef WinogradF3<m> T;
+  const int alpha       = T::kAlpha;
+  const index_t Cg      = channels / num_group;
+  const index_t Kg      = num_filter / num_group;
+  const index_t hw      = height * width;
+  const index_t ohw     = out_h * out_w;
+  const index_t th      = (out_h + m - 1) / m;
+  const index_t tw      = (out_w + m - 1) / m;
+  const index_t tiles   = th * tw;
+  DType* U              = workspace;
+  DType* V              = U + alpha * alpha * num_filter * Cg;
+  DType* M              = V + alpha * alpha * Cg * tiles;
+  const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+
+  // U[g][xi][nu][k][c] = (G w[g * Kg + k][c] GT)[xi][nu]
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t kc = 0; kc < num_filter * Cg; ++kc) {
+    const index_t k = kc / Cg;
+    const index_t c = kc % Cg;
+    const DType* w  = weight + kc * 9;
+    DType tmp[alpha][3];
+    for (int i = 0; i < alpha; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        DType acc = 0;
+        for (int l = 0; l < 3; ++l) {
+          acc += static_cast<DType>(T::G[i][l]) * w[l * 3 + j];
+        }
+        tmp[i][j] = acc;
+      }
+    }
+    DType* u = U + (k / Kg) * alpha * alpha * Kg * Cg + (k % Kg) * Cg + c;
+    for (int i = 0; i < alpha; ++i) {
+      for (int j = 0; j < alpha; ++j) {
+        DType acc = 0;
+        for (int l = 0; l < 3; ++l) {
+          acc += tmp[i][l] * static_cast<DType>(T::G[j][l]);
+        }
+        u[(i * alpha + j) * Kg * Cg] = acc;
+      }
+    }
+  }
+
+  for (index_t n = 0; n < num; ++n) {
+    for (index_t g = 0; g < num_group; ++g) {
+      const DType* in_g = in + (n * channels + g * Cg) * hw;
+      DType* out_g      = out + (n * num_filter + g * Kg) * ohw;
+      // V[xi][nu][c][p] = (BT d BT^T)[xi][nu] for the tile p of channel c
+#pragma omp parallel for num_threads(omp_threads)
+      for (index_t cp = 0; cp < Cg * tiles; ++cp) {
+        const index_t c  = cp / tiles;
+        const index_t p  = cp % tiles;
+        const index_t y0 = (p / tw) * m - pad_h;
+        const index_t x0 = (p % tw) * m - pad_w;
+        DType d[alpha][alpha];
+        for (int i = 0; i < alpha; ++i) {
+          for (int j = 0; j < alpha; ++j) {
+            const index_t y = y0 + i;
+            const index_t x = x0 + j;
+            d[i][j] = (y >= 0 && y < height && x >= 0 && x < width) ? in_g[c * hw + y * width + x]
+                                                                    : DType(0);
+          }
+        }
+        DType tmp[alpha][alpha];
+        for (int i = 0; i < alpha; ++i) {
+          for (int j = 0; j < alpha; ++j) {
+            DType acc = 0;
+            for (int l = 0; l < alpha; ++l) {
+              acc += static_cast<DType>(T::BT[i][l]) * d[l][j];
+            }
+            tmp[i][j] = acc;
+          }
+        }
+        for (int i = 0; i < alpha; ++i) {
+          for (int j = 0; j < alpha; ++j) {
+            DType acc = 0;
+            for (int l = 0; l < alpha; ++l) {
+              acc += tmp[i][l] * static_cast<DType>(T::BT[j][l]);
+            }
+            V[(i * alpha + j) * Cg * tiles + cp] = acc;
+          }
+        }
+      }
+      // M[xi][nu] = U[g][xi][nu] V[xi][nu], (Kg x Cg) (Cg x tiles) for every xi, nu
+      Tensor<cpu, 3, DType> u_3d(U + g * alpha * alpha * Kg * Cg, Shape3(alpha * alpha, Kg, Cg), s);
+      Tensor<cpu, 3, DType> v_3d(V, Shape3(alpha * alpha, Cg, tiles), s);
+      Tensor<cpu, 3, DType> m_3d(M, Shape3(alpha * alpha, Kg, tiles), s);
+      linalg_batch_gemm(u_3d, v_3d, m_3d, DType(1), DType(0), false, false, s);
+      // Y = AT M A, cropped to the output
+#pragma omp parallel for num_threads(omp_threads)
+      for (index_t kp = 0; kp < Kg * tiles; ++kp) {
+        const index_t k  = kp / tiles;
+        const index_t p  = kp % tiles;
+        const index_t y0 = (p / tw) * m;
+        const index_t x0 = (p % tw) * m;
+        DType tmp[m][alpha];
+        for (int i = 0; i < m; ++i) {
+          for (int j = 0; j < alpha; ++j) {
+            DType acc = 0;
+            for (int l = 0; l < alpha; ++l) {
+              acc += static_cast<DType>(T::AT[i][l]) * M[(l * alpha + j) * Kg * tiles + kp];
+            }
+            tmp[i][j] = acc;
+          }
+        }
+        for (int i = 0; i < m && y0 + i < out_h; ++i) {
+          for (int j = 0; j < m && x0 + j < out_w; ++j) {
+            DType acc = 0;
+            for (int l = 0; l < alpha; ++l) {
+              acc += tmp[i][l] * static_cast<DType>(T::AT[j][l]);
+            }
+            KERNEL_ASSIGN(out_g[k * ohw + (y0 + i) * out_w + x0 + j], req, acc);
+          }
+        }
+      }
+    }
+  }
+}
+
+/*!
+ * \brief Direct depthwise 2D convolution of NCHW data, one output channel uses one input
+ *        channel (num_group == channels). Each output row is accumulated from the valid kernel
+ *        taps over the contiguous range of output columns they reach, without im2col and without
+ *        bound checks in the inner loop.
+ */
+template <typename DType>
+void DepthwiseConvolutionCPU(const DType* in,
+                             const DType* weight,
+                             DType* out,
+                             const index_t num,
+                             const index_t channels,
+                             const index_t height,
+                             const index_t width,
+                             const index_t num_filter,
+                             const index_t out_h,
+                             const index_t out_w,
+                             const mxnet::TShape& kernel,
+                             const mxnet::TShape& stride,
+                             const mxnet::TShape& pad,
+                             const mxnet::TShape& dilate,
+                             const OpReqType req) {
+  const index_t kh         = kernel[0];
+  const index_t kw         = kernel[1];
+  const index_t sh         = stride[0];
+  const index_t sw         = stride[1];
+  const index_t ph         = pad[0];
+  const index_t pw         = pad[1];
+  const index_t dh         = dilate[0];
+  const index_t dw         = dilate[1];
+  const index_t multiplier = num_filter / channels;
+  const int omp_threads    = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel num_threads(omp_threads)
+  {
+    std::vector<DType> row(out_w);
+#pragma omp for
+    for (index_t nk = 0; nk < num * num_filter; ++nk) {
+      const index_t n   = nk / num_filter;
+      const index_t k   = nk % num_filter;
+      const DType* in_c = in + (n * channels + k / multiplier) * height * width;
+      const DType* w    = weight + k * kh * kw;
+      DType* out_k      = out + nk * out_h * out_w;
+      for (index_t oh = 0; oh < out_h; ++oh) {
+        std::fill(row.begin(), row.end(), DType(0));
+        for (index_t i = 0; i < kh; ++i) {
+          const index_t ih = oh * sh - ph + i * dh;
+          if (ih < 0 || ih >= height)
+            continue;
+          const DType* in_row = in_c + ih * width;
+          for (index_t j = 0; j < kw; ++j) {
+            // output columns whose input column ow * sw - pw + j * dw is inside the row
+            const index_t offset = j * dw - pw;
+            const index_t lo     = offset >= 0 ? 0 : (-offset + sw - 1) / sw;
+            const index_t hi     = std::min(out_w, (width - offset + sw - 1) / sw);
+            const DType wij      = w[i * kw + j];
+            DType* acc           = row.data();
+#pragma omp simd
+            for (index_t ow = lo; ow < hi; ++ow) {
+              acc[ow] += wij * in_row[ow * sw + offset];
+            }
+          }
+        }
+        for (index_t ow = 0; ow < out_w; ++ow) {
+          KERNEL_ASSIGN(out_k[oh * out_w + ow], req, row[ow]);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_OPERATOR_NN_CONVOLUTION_CPU_H_
@@ -43,12 +43,12 @@ enum CTCLossOpInputs { kData, kLabel };
 enum CTCLossOpOutputs { kOut, kGrad };
 }  // namespace ctc_loss
 
+// Workspace of the warp-ctc CPU implementation
 template <typename T>
 inline void get_workspace_size(const std::vector<int>* label_lengths,
                                const std::vector<int>* data_lengths,
                                int alphabet_size,
                                int minibatch,
-                               bool isGPU,
                                size_t* size_bytes) {
   // This is the max of all S and T for all examples in the minibatch.
   int maxL = *std::max_element(label_lengths->data(), label_lengths->data() + minibatch);
@@ -56,65 +56,29 @@ inline void get_workspace_size(const std::vector<int>* label_lengths,
 
   const int S = 2 * maxL + 1;
 
-  *size_bytes = 0;
+  // cpu can eventually replace all minibatch with
+  // max number of concurrent threads if memory is
+  // really tight
 
-  if (isGPU) {
-    // GPU storage
-    // nll_forward, nll_backward
-    *size_bytes += 2 * sizeof(T) * minibatch;
+  // per minibatch memory
+  size_t per_minibatch_bytes = 0;
 
-    // repeats
-    *size_bytes += sizeof(int) * minibatch;
+  // output
+  per_minibatch_bytes += sizeof(T) * alphabet_size;
 
-    // label offsets
-    *size_bytes += sizeof(int) * minibatch;
+  // alphas
+  per_minibatch_bytes += sizeof(T) * S * maxT;
 
-    // utt_length
-    *size_bytes += sizeof(int) * minibatch;
+  // betas
+  per_minibatch_bytes += sizeof(T) * S;
 
-    // label lengths
-    *size_bytes += sizeof(int) * minibatch;
+  // labels w/blanks, e_inc, s_inc
+  per_minibatch_bytes += 3 * sizeof(int) * S;
 
-    // labels without blanks - overallocate for now
-    *size_bytes += sizeof(int) * maxL * minibatch;
+  *size_bytes = per_minibatch_bytes * minibatch;
 
-    // labels with blanks
-    *size_bytes += sizeof(int) * S * minibatch;
-
-    // alphas
-    *size_bytes += sizeof(T) * S * maxT * minibatch;
-
-    // denoms
-    *size_bytes += sizeof(T) * maxT * minibatch;
-
-    // probs (since we will pass in activations)
-    *size_bytes += sizeof(T) * alphabet_size * maxT * minibatch;
-
-  } else {
-    // cpu can eventually replace all minibatch with
-    // max number of concurrent threads if memory is
-    // really tight
-
-    // per minibatch memory
-    size_t per_minibatch_bytes = 0;
-
-    // output
-    per_minibatch_bytes += sizeof(T) * alphabet_size;
-
-    // alphas
-    per_minibatch_bytes += sizeof(T) * S * maxT;
-
-    // betas
-    per_minibatch_bytes += sizeof(T) * S;
-
-    // labels w/blanks, e_inc, s_inc
-    per_minibatch_bytes += 3 * sizeof(int) * S;
-
-    *size_bytes = per_minibatch_bytes * minibatch;
-
-    // probs
-    *size_bytes += sizeof(T) * alphabet_size * maxT * minibatch;
-  }
+  // probs
+  *size_bytes += sizeof(T) * alphabet_size * maxT * minibatch;
 }
 
 // Takes a tensor of labels, and interprets 0-elements at the end of the vector
@@ -317,14 +281,11 @@ void CTCLossOpForward(const nnvm::NodeAttrs& attrs,
 
   Stream<xpu>* s = ctx.get_stream<xpu>();
   MSHADOW_TYPE_SWITCH(inputs[ctc_loss::kLabel].type_flag_, DType, {
-    Tensor<xpu, 3, real_t> data  = in_data.get<xpu, 3, real_t>(s);
     Tensor<xpu, 2, DType> labels = in_label.get<xpu, 2, DType>(s);
-    Tensor<xpu, 1, real_t> costs = out_data.get<xpu, 1, real_t>(s);
-    Tensor<xpu, 3, real_t> grad  = out_grad.get<xpu, 3, real_t>(s);
 
-    int max_seq_len   = data.size(0);
-    int batch_size    = data.size(1);
-    int alphabet_size = data.size(2);
+    int max_seq_len   = in_data.size(0);
+    int batch_size    = in_data.size(1);
+    int alphabet_size = in_data.size(2);
 
     // data_lengths
     std::vector<int> data_lengths(batch_size, max_seq_len);
@@ -346,37 +307,18 @@ void CTCLossOpForward(const nnvm::NodeAttrs& attrs,
           labels, param.blank_label == 0 ? 0 : -1, &packed_labels, &label_lengths);
     }
 
-    size_t size_bytes;
-    get_workspace_size<real_t>(&label_lengths,
-                               &data_lengths,
-                               alphabet_size,
-                               batch_size,
-                               data.kDevCPU ? false : true,
-                               &size_bytes);
-
-    // round-up so there are enough elems in memory
-    size_t num_tmp_elems = (size_bytes + sizeof(real_t) - 1) / sizeof(real_t);
-    Tensor<xpu, 1, real_t> workspace =
-        ctx.requested[0].get_space_typed<xpu, 1, real_t>(Shape1(num_tmp_elems), s);
-
-    compute_ctc_cost(data,
-                     costs.dptr_,
-                     grad.dptr_,
-                     packed_labels.data(),
-                     label_lengths.data(),
-                     data_lengths.data(),
-                     workspace.dptr_,
-                     req[ctc_loss::kGrad] != mxnet::kNullOp,
-                     param.blank_label == 0 ? 0 : (alphabet_size - 1));
-
-    if (param.use_data_lengths) {
-      // baidu warp CTC implementation sometimes includes undefined gradients
-      // for data outside of length mask. Setting to 0 to make it consistent
-      // with CPU implementation.
-      int kInputLength = 2;
-      mxnet_op::SequenceMask(
-          grad, inputs[kInputLength].get<xpu, 1, real_t>(s), static_cast<real_t>(0));
-    }
+    // the gradient of the steps past data_lengths is zero
+    MSHADOW_REAL_TYPE_SWITCH(in_data.type_flag_, RType, {
+      compute_ctc_cost(ctx,
+                       in_data.get<xpu, 3, RType>(s),
+                       out_data.get<xpu, 1, RType>(s),
+                       out_grad.get<xpu, 3, RType>(s),
+                       packed_labels,
+                       label_lengths,
+                       data_lengths,
+                       req[ctc_loss::kGrad] != mxnet::kNullOp,
+                       param.blank_label == 0 ? 0 : (alphabet_size - 1));
+    });
   });
 }
 
@@ -394,13 +336,15 @@ void CTCLossOpBackward(const nnvm::NodeAttrs& attrs,
   const TBlob& out_grad      = inputs[0];
   const TBlob& grad_computed = inputs[3];  // grad computed in the forward step
 
-  Tensor<xpu, 3, real_t> igrad_data         = in_grad.get<xpu, 3, real_t>(s);
-  Tensor<xpu, 1, real_t> ograd_data         = out_grad.get<xpu, 1, real_t>(s);
-  Tensor<xpu, 3, real_t> computed_grad_data = grad_computed.get<xpu, 3, real_t>(s);
+  MSHADOW_REAL_TYPE_SWITCH(in_grad.type_flag_, DType, {
+    Tensor<xpu, 3, DType> igrad_data         = in_grad.get<xpu, 3, DType>(s);
+    Tensor<xpu, 1, DType> ograd_data         = out_grad.get<xpu, 1, DType>(s);
+    Tensor<xpu, 3, DType> computed_grad_data = grad_computed.get<xpu, 3, DType>(s);
 
-  Assign(igrad_data,
-         req[0],
-         mshadow::expr::broadcast<1>(ograd_data, computed_grad_data.shape_) * computed_grad_data);
+    Assign(igrad_data,
+           req[0],
+           mshadow::expr::broadcast<1>(ograd_data, computed_grad_data.shape_) * computed_grad_data);
+  });
 }
 
 }  // namespace op
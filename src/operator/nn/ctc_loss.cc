@@ -26,22 +26,51 @@
 
 namespace mshadow {
 template <typename DType>
-ctcStatus_t compute_ctc_cost(const Tensor<cpu, 3, DType> activations,
-                             DType* costs,
-                             DType* grads,
-                             int* labels,
-                             int* label_lengths,
-                             int* data_lengths,
-                             void* workspace,
-                             bool isTraining,
-                             int blank_label) {
-  int minibatch     = static_cast<int>(activations.size(1));
-  int alphabet_size = static_cast<int>(activations.size(2));
-  mxnet_warpctc::CpuCTC<DType> ctc(alphabet_size, minibatch, workspace, blank_label);
-  if (isTraining) {
-    return ctc.cost_and_grad(activations.dptr_, grads, costs, labels, label_lengths, data_lengths);
+void compute_ctc_cost(const mxnet::OpContext& ctx,
+                      const Tensor<cpu, 3, DType> activations,
+                      Tensor<cpu, 1, DType> costs,
+                      Tensor<cpu, 3, DType> grads,
+                      const std::vector<int>& labels,
+                      const std::vector<int>& label_lengths,
+                      const std::vector<int>& data_lengths,
+                      bool isTraining,
+                      int blank_label) {
+  if constexpr (!std::is_same<DType, float>::value) {
+    LOG(FATAL) << "CTCLoss on CPU only supports float32 data";
   } else {
-    return ctc.score_forward(activations.dptr_, costs, labels, label_lengths, data_lengths);
+    int max_seq_len   = static_cast<int>(activations.size(0));
+    int minibatch     = static_cast<int>(activations.size(1));
+    int alphabet_size = static_cast<int>(activations.size(2));
+
+    size_t size_bytes;
+    mxnet::op::get_workspace_size<DType>(
+        &label_lengths, &data_lengths, alphabet_size, minibatch, &size_bytes);
+    // round-up so there are enough elems in memory
+    size_t num_tmp_elems     = (size_bytes + sizeof(DType) - 1) / sizeof(DType);
+    Tensor<cpu, 1, DType> ws = ctx.requested[0].get_space_typed<cpu, 1, DType>(
+        Shape1(num_tmp_elems), ctx.get_stream<cpu>());
+
+    mxnet_warpctc::CpuCTC<DType> ctc(alphabet_size, minibatch, ws.dptr_, blank_label);
+    if (isTraining) {
+      ctc.cost_and_grad(activations.dptr_,
+                        grads.dptr_,
+                        costs.dptr_,
+                        labels.data(),
+                        label_lengths.data(),
+                        data_lengths.data());
+      if (*std::min_element(data_lengths.begin(), data_lengths.end()) < max_seq_len) {
+        // baidu warp CTC implementation leaves undefined gradients
+        // for data outside of length mask.
+        Tensor<cpu, 1, int> lengths(const_cast<int*>(data_lengths.data()), Shape1(minibatch));
+        mxnet::op::mxnet_op::SequenceMask(grads, lengths, static_cast<DType>(0));
+      }
+    } else {
+      ctc.score_forward(activations.dptr_,
+                        costs.dptr_,
+                        labels.data(),
+                        label_lengths.data(),
+                        data_lengths.data());
+    }
   }
 }
 }  // namespace mshadow
@@ -97,6 +126,9 @@ The resulting `label` tensor should be padded to be::
 
 ``out`` is a list of CTC loss values, one per example in the batch.
 
+On GPU, ``data`` can also be float16 or float64, float16 being accumulated in float32. On CPU it must
+be float32.
+
 See *Connectionist Temporal Classification: Labelling Unsegmented
 Sequence Data with Recurrent Neural Networks*, A. Graves *et al*. for more
 information on the definition and the algorithm.
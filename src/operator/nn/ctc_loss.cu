@@ -20,31 +20,383 @@
 /*!
  * \file ctc_loss.cu
  * \brief GPU Implementation of ctc_loss op
+ *
+ * The loss is computed in log space by three kernels:
+ *  - the log of the softmax normalizer of every (time, sequence) row, one warp per row,
+ *  - the alpha (forward) and beta (backward) recursions, one block per sequence and direction,
+ *    the threads of a block sharing the label positions and the previous step staying in shared
+ *    memory, so that both recursions of all the sequences run concurrently,
+ *  - the gradient, one block per (time, sequence) row.
+ * Half precision data is accumulated in float.
  */
 
+#include <algorithm>
+#include <type_traits>
+#include <unordered_map>
 #include "./ctc_loss-inl.h"
-#include "../../../3rdparty/ctc_include/detail/gpu_ctc.h"
+#include "../../common/cuda/utils.h"
+
+namespace mxnet {
+namespace op {
+
+namespace ctc_loss {
+// threads of the normalizer and gradient kernels
+const int kRowThreads = 128;
+// maximum number of threads of the recursion kernel
+const int kMaxRecursionThreads = 256;
+// maximum shared memory of the recursion kernel
+const size_t kMaxRecursionSharedBytes = 48 * 1024;
+}  // namespace ctc_loss
+
+template <typename AType>
+__device__ inline AType CTCLogAdd(const AType a, const AType b) {
+  const AType neg_inf = mshadow::red::limits::NegInfValue<AType>();
+  if (a == neg_inf)
+    return b;
+  if (b == neg_inf)
+    return a;
+  return a > b ? a + log1p(exp(b - a)) : b + log1p(exp(a - b));
+}
+
+/*!
+ * \brief Label of the position s of the sequence extended with blanks: blank, l0, blank, l1, ...
+ */
+__device__ inline int CTCExtendedLabel(const int* labels, const int s, const int blank_label) {
+  return (s & 1) ? labels[s >> 1] : blank_label;
+}
+
+/*!
+ * \brief Log of the softmax normalizer of every row of the (T, N, alphabet) data, each warp reads
+ *        its row once with an online max and sum.
+ */
+template <typename DType, typename AType>
+__global__ void CTCLogNormalizerKernel(const DType* data,
+                                       AType* log_norm,
+                                       const int* data_lengths,
+                                       const int num_rows,
+                                       const int batch_size,
+                                       const int alphabet_size) {
+  using common::cuda::warp_size;
+  const AType neg_inf = mshadow::red::limits::NegInfValue<AType>();
+  const int row       = blockIdx.x * (blockDim.x / warp_size) + threadIdx.x / warp_size;
+  const int lane      = threadIdx.x % warp_size;
+  if (row >= num_rows || row / batch_size >= data_lengths[row % batch_size])
+    return;
+  const DType* x = data + static_cast<index_t>(row) * alphabet_size;
+  AType max_val  = neg_inf;
+  AType sum      = 0;
+  for (int k = lane; k < alphabet_size; k += warp_size) {
+    const AType val = static_cast<AType>(x[k]);
+    if (val > max_val) {
+      sum     = sum * exp(max_val - val) + 1;
+      max_val = val;
+    } else {
+      sum += exp(val - max_val);
+    }
+  }
+#pragma unroll
+  for (int i = warp_size / 2; i >= 1; i /= 2) {
+    const AType other_max = __shfl_xor_sync(0xffffffff, max_val, i);
+    const AType other_sum = __shfl_xor_sync(0xffffffff, sum, i);
+    const AType new_max   = max(max_val, other_max);
+    sum = (max_val == neg_inf ? 0 : sum * exp(max_val - new_max)) +
+          (other_max == neg_inf ? 0 : other_sum * exp(other_max - new_max));
+    max_val = new_max;
+  }
+  if (lane == 0)
+    log_norm[row] = max_val + log(sum);
+}
+
+/*!
+ * \brief Alpha (blockIdx.y == 0) or beta (blockIdx.y == 1) recursion of the sequence blockIdx.x
+ *        over the S = 2 * L + 1 positions of its labels extended with blanks. alpha(t, s) and
+ *        beta(t, s) both include the emission at t. The loss is written by the alpha block.
+ */
+template <typename DType, typename AType>
+__global__ void CTCAlphaBetaKernel(const DType* data,
+                                   const AType* log_norm,
+                                   const int* label_offsets,
+                                   const int* label_lengths,
+                                   const int* data_lengths,
+                                   const int* feasible,
+                                   const int* labels,
+                                   AType* alphas,
+                                   AType* betas,
+                                   AType* nll,
+                                   DType* costs,
+                                   const bool store,
+                                   const int batch_size,
+                                   const int alphabet_size,
+                                   const int max_seq_len,
+                                   const int max_s,
+                                   const int blank_label) {
+  const AType neg_inf = mshadow::red::limits::NegInfValue<AType>();
+  const int b         = blockIdx.x;
+  const bool backward = blockIdx.y == 1;
+  const int T         = data_lengths[b];
+  const int S         = 2 * label_lengths[b] + 1;
+  if (!feasible[b]) {
+    if (!backward && threadIdx.x == 0) {
+      nll[b]   = 0;
+      costs[b] = DType(0);
+    }
+    return;
+  }
+  extern __shared__ char ctc_shared[];
+  AType* prev       = reinterpret_cast<AType*>(ctc_shared);
+  AType* cur        = prev + max_s;
+  const int* label  = labels + label_offsets[b];
+  AType* out        = (backward ? betas : alphas) + static_cast<index_t>(b) * max_seq_len * max_s;
+  const DType* x    = data + static_cast<index_t>(b) * alphabet_size;
+  const index_t row = static_cast<index_t>(batch_size) * alphabet_size;
+
+  const int t0 = backward ? T - 1 : 0;
+  for (int s = threadIdx.x; s < S; s += blockDim.x) {
+    const bool start = backward ? s >= S - 2 : s < 2;
+    const int l      = CTCExtendedLabel(label, s, blank_label);
+    prev[s] = start ? static_cast<AType>(x[t0 * row + l]) - log_norm[t0 * batch_size + b] : neg_inf;
+    if (store)
+      out[t0 * max_s + s] = prev[s];
+  }
+  __syncthreads();
+  for (int i = 1; i < T; ++i) {
+    const int t      = backward ? T - 1 - i : i;
+    const AType norm = log_norm[t * batch_size + b];
+    for (int s = threadIdx.x; s < S; s += blockDim.x) {
+      const int l = CTCExtendedLabel(label, s, blank_label);
+      AType sum   = prev[s];
+      if (backward) {
+        if (s + 1 < S)
+          sum = CTCLogAdd(sum, prev[s + 1]);
+        if (l != blank_label && s + 2 < S && l != label[(s >> 1) + 1])
+          sum = CTCLogAdd(sum, prev[s + 2]);
+      } else {
+        if (s >= 1)
+          sum = CTCLogAdd(sum, prev[s - 1]);
+        if (l != blank_label && s >= 2 && l != label[(s >> 1) - 1])
+          sum = CTCLogAdd(sum, prev[s - 2]);
+      }
+      cur[s] = sum == neg_inf ? neg_inf : sum + static_cast<AType>(x[t * row + l]) - norm;
+      if (store)
+        out[t * max_s + s] = cur[s];
+    }
+    __syncthreads();
+    AType* tmp = prev;
+    prev       = cur;
+    cur        = tmp;
+  }
+  if (!backward && threadIdx.x == 0) {
+    const AType log_likelihood = S > 1 ? CTCLogAdd(prev[S - 1], prev[S - 2]) : prev[S - 1];
+    nll[b]                     = -log_likelihood;
+    costs[b]                   = DType(-log_likelihood);
+  }
+}
+
+/*!
+ * \brief Gradient with respect to the activations of the row (t, b) = (blockIdx.x / N, blockIdx.x
+ *        % N): softmax(x) minus the posterior of the label over the positions s it occupies.
+ *        Repeated labels are summed by the thread of their first occurrence along next_same.
+ */
+template <typename DType, typename AType>
+__global__ void CTCGradKernel(const DType* data,
+                              const AType* log_norm,
+                              const int* label_offsets,
+                              const int* label_lengths,
+                              const int* data_lengths,
+                              const int* feasible,
+                              const int* labels,
+                              const int* next_same,
+                              const int* is_first,
+                              const AType* alphas,
+                              const AType* betas,
+                              const AType* nll,
+                              DType* grads,
+                              const int batch_size,
+                              const int alphabet_size,
+                              const int max_seq_len,
+                              const int max_s,
+                              const int blank_label) {
+  const int t = blockIdx.x / batch_size;
+  const int b = blockIdx.x % batch_size;
+  DType* grad = grads + static_cast<index_t>(blockIdx.x) * alphabet_size;
+  if (t >= data_lengths[b] || !feasible[b]) {
+    for (int k = threadIdx.x; k < alphabet_size; k += blockDim.x)
+      grad[k] = DType(0);
+    return;
+  }
+  const DType* x        = data + static_cast<index_t>(blockIdx.x) * alphabet_size;
+  const AType norm      = log_norm[blockIdx.x];
+  const int L           = label_lengths[b];
+  const int offset      = label_offsets[b];
+  const index_t base    = (static_cast<index_t>(b) * max_seq_len + t) * max_s;
+  const AType* alpha    = alphas + base;
+  const AType* beta     = betas + base;
+  const AType log_scale = nll[b] + norm;
+  for (int k = threadIdx.x; k < alphabet_size; k += blockDim.x)
+    grad[k] = DType(exp(static_cast<AType>(x[k]) - norm));
+
+  // the emission at t is counted by both alpha and beta
+  AType blank_sum         = 0;
+  const AType blank_scale = log_scale - static_cast<AType>(x[blank_label]);
+  for (int s = 2 * threadIdx.x; s <= 2 * L; s += 2 * blockDim.x)
+    blank_sum += exp(alpha[s] + beta[s] + blank_scale);
+  blank_sum = common::cuda::reduce<ctc_loss::kRowThreads, false>(
+      blank_sum, [](AType a, AType b) { return a + b; });
+  // reduce synchronizes the block, the softmax is written
+  if (threadIdx.x == 0)
+    grad[blank_label] = DType(exp(static_cast<AType>(x[blank_label]) - norm) - blank_sum);
+  for (int i = threadIdx.x; i < L; i += blockDim.x) {
+    if (!is_first[offset + i])
+      continue;
+    const int l       = labels[offset + i];
+    const AType val   = static_cast<AType>(x[l]);
+    const AType scale = log_scale - val;
+    AType sum         = 0;
+    for (int j = i; j >= 0; j = next_same[offset + j])
+      sum += exp(alpha[2 * j + 1] + beta[2 * j + 1] + scale);
+    grad[l] = DType(exp(val - norm) - sum);
+  }
+}
+
+}  // namespace op
+}  // namespace mxnet
 
 namespace mshadow {
 
 template <typename DType>
-ctcStatus_t compute_ctc_cost(const Tensor<gpu, 3, DType> activations,
-                             DType* costs,
-                             DType* grads,
-                             int* labels,
-                             int* label_lengths,
-                             int* input_lengths,
-                             void* workspace,
-                             int train,
-                             int blank_label) {
-  int minibatch     = static_cast<int>(activations.size(1));
-  int alphabet_size = static_cast<int>(activations.size(2));
-  mxnet_warpctc::GpuCTC<DType> ctc(
-      alphabet_size, minibatch, workspace, activations.stream_->stream_, blank_label);
-  if (train)
-    return ctc.cost_and_grad(activations.dptr_, grads, costs, labels, label_lengths, input_lengths);
-  else
-    return ctc.score_forward(activations.dptr_, costs, labels, label_lengths, input_lengths);
+void compute_ctc_cost(const mxnet::OpContext& ctx,
+                      const Tensor<gpu, 3, DType> activations,
+                      Tensor<gpu, 1, DType> costs,
+                      Tensor<gpu, 3, DType> grads,
+                      const std::vector<int>& labels,
+                      const std::vector<int>& label_lengths,
+                      const std::vector<int>& data_lengths,
+                      bool train,
+                      int blank_label) {
+  using namespace mxnet::op;
+  typedef typename std::conditional<std::is_same<DType, double>::value, double, float>::type
+      AType;
+  Stream<gpu>* s          = ctx.get_stream<gpu>();
+  cudaStream_t stream     = Stream<gpu>::GetStream(s);
+  const int max_seq_len   = static_cast<int>(activations.size(0));
+  const int batch_size    = static_cast<int>(activations.size(1));
+  const int alphabet_size = static_cast<int>(activations.size(2));
+  if (batch_size == 0 || max_seq_len == 0)
+    return;
+  const int max_s      = 2 * *std::max_element(label_lengths.begin(), label_lengths.end()) + 1;
+  const int num_labels = labels.size();
+
+  // per sequence metadata, built on the host and copied at once
+  std::vector<int> meta(4 * batch_size + 3 * num_labels);
+  int* label_offsets = meta.data();
+  int* lengths       = label_offsets + batch_size;
+  int* seq_lengths   = lengths + batch_size;
+  int* feasible      = seq_lengths + batch_size;
+  int* flat_labels   = feasible + batch_size;
+  int* next_same     = flat_labels + num_labels;
+  int* is_first      = next_same + num_labels;
+  std::copy(labels.begin(), labels.end(), flat_labels);
+  std::unordered_map<int, int> last_occurrence;
+  for (int b = 0, offset = 0; b < batch_size; ++b) {
+    const int L = label_lengths[b];
+    const int T = data_lengths[b];
+    CHECK_LE(T, max_seq_len) << "data_lengths cannot exceed the sequence length of the data";
+    int repeats = 0;
+    last_occurrence.clear();
+    for (int i = 0; i < L; ++i) {
+      const int l = labels[offset + i];
+      repeats += i > 0 && l == labels[offset + i - 1];
+      next_same[offset + i] = -1;
+      auto it               = last_occurrence.find(l);
+      is_first[offset + i]  = it == last_occurrence.end();
+      if (it != last_occurrence.end())
+        next_same[offset + it->second] = i;
+      last_occurrence[l] = i;
+    }
+    label_offsets[b] = offset;
+    lengths[b]       = L;
+    seq_lengths[b]   = T;
+    feasible[b]      = T > 0 && L + repeats <= T;
+    offset += L;
+  }
+
+  const int num_rows      = max_seq_len * batch_size;
+  const size_t ab_size    = train ? static_cast<size_t>(num_rows) * max_s : 0;
+  const size_t real_bytes = (num_rows + batch_size + 2 * ab_size) * sizeof(AType);
+  Tensor<gpu, 1, char> workspace = ctx.requested[0].get_space_typed<gpu, 1, char>(
+      Shape1(real_bytes + meta.size() * sizeof(int)), s);
+  AType* log_norm = reinterpret_cast<AType*>(workspace.dptr_);
+  AType* nll      = log_norm + num_rows;
+  AType* alphas   = nll + batch_size;
+  AType* betas    = alphas + ab_size;
+  int* meta_gpu   = reinterpret_cast<int*>(workspace.dptr_ + real_bytes);
+  Copy(Tensor<gpu, 1, int>(meta_gpu, Shape1(meta.size()), s),
+       Tensor<cpu, 1, int>(meta.data(), Shape1(meta.size())),
+       s);
+  const int* label_offsets_gpu = meta_gpu;
+  const int* lengths_gpu       = label_offsets_gpu + batch_size;
+  const int* seq_lengths_gpu   = lengths_gpu + batch_size;
+  const int* feasible_gpu      = seq_lengths_gpu + batch_size;
+  const int* labels_gpu        = feasible_gpu + batch_size;
+  const int* next_same_gpu     = labels_gpu + num_labels;
+  const int* is_first_gpu      = next_same_gpu + num_labels;
+
+  const int rows_per_block = ctc_loss::kRowThreads / mxnet::common::cuda::warp_size;
+  CTCLogNormalizerKernel<<<(num_rows + rows_per_block - 1) / rows_per_block,
+                           ctc_loss::kRowThreads,
+                           0,
+                           stream>>>(
+      activations.dptr_, log_norm, seq_lengths_gpu, num_rows, batch_size, alphabet_size);
+  MSHADOW_CUDA_POST_KERNEL_CHECK(CTCLogNormalizerKernel);
+
+  const size_t shared_bytes = 2 * max_s * sizeof(AType);
+  CHECK_LE(shared_bytes, ctc_loss::kMaxRecursionSharedBytes)
+      << "CTCLoss on GPU supports label sequences of up to "
+      << (ctc_loss::kMaxRecursionSharedBytes / (2 * sizeof(AType)) - 1) / 2 << " labels";
+  const int threads = std::min(ctc_loss::kMaxRecursionThreads,
+                               (max_s + mxnet::common::cuda::warp_size - 1) /
+                                   mxnet::common::cuda::warp_size * mxnet::common::cuda::warp_size);
+  CTCAlphaBetaKernel<<<dim3(batch_size, train ? 2 : 1), threads, shared_bytes, stream>>>(
+      activations.dptr_,
+      log_norm,
+      label_offsets_gpu,
+      lengths_gpu,
+      seq_lengths_gpu,
+      feasible_gpu,
+      labels_gpu,
+      alphas,
+      betas,
+      nll,
+      costs.dptr_,
+      train,
+      batch_size,
+      alphabet_size,
+      max_seq_len,
+      max_s,
+      blank_label);
+  MSHADOW_CUDA_POST_KERNEL_CHECK(CTCAlphaBetaKernel);
+
+  if (train) {
+    CTCGradKernel<<<num_rows, ctc_loss::kRowThreads, 0, stream>>>(activations.dptr_,
+                                                                  log_norm,
+                                                                  label_offsets_gpu,
+                                                                  lengths_gpu,
+                                                                  seq_lengths_gpu,
+                                                                  feasible_gpu,
+                                                                  labels_gpu,
+                                                                  next_same_gpu,
+                                                                  is_first_gpu,
+                                                                  alphas,
+                                                                  betas,
+                                                                  nll,
+                                                                  grads.dptr_,
+                                                                  batch_size,
+                                                                  alphabet_size,
+                                                                  max_seq_len,
+                                                                  max_s,
+                                                                  blank_label);
+    MSHADOW_CUDA_POST_KERNEL_CHECK(CTCGradKernel);
+  }
 }
 }  // namespace mshadow
 
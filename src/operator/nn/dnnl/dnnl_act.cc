@@ -127,9 +127,11 @@ DNNLActForward& GetActForward(const DNNLActParam& param,
                               const NDArray& in_data,
                               const dnnl::memory& in_mem) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLActSignature, DNNLActForward, OpHash> fwds;
+  static thread_local DNNLPrimitiveCache<DNNLActSignature, DNNLActForward, OpHash>
+      fwds("Activation");
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLActSignature, DNNLActForward, OpHash> fwds;
+  static MX_THREAD_LOCAL DNNLPrimitiveCache<DNNLActSignature, DNNLActForward, OpHash>
+      fwds("Activation");
 #endif
   DNNLActSignature key(param);
   key.AddSign(ctx.is_train);
@@ -213,9 +215,11 @@ static inline DNNLActBackward& GetActBackward(const DNNLActParam& param,
                                               const NDArray& out_grad,
                                               const dnnl::memory& in_mem) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLActSignature, DNNLActBackward, OpHash> bwds;
+  static thread_local DNNLPrimitiveCache<DNNLActSignature, DNNLActBackward, OpHash>
+      bwds("Activation backward");
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLActSignature, DNNLActBackward, OpHash> bwds;
+  static MX_THREAD_LOCAL DNNLPrimitiveCache<DNNLActSignature, DNNLActBackward, OpHash>
+      bwds("Activation backward");
 #endif
   DNNLActSignature key(param);
   key.AddSign(in_data);
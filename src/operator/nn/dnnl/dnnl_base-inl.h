@@ -29,8 +29,14 @@
 
 #if MXNET_USE_ONEDNN == 1
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <iterator>
+#include <limits>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -38,6 +44,7 @@
 #include <map>
 #include <set>
 
+#include "dmlc/omp.h"
 #include "dnnl.hpp"
 #include "mxnet/graph_attr_types.h"
 #include "mxnet/ndarray.h"
@@ -69,6 +76,10 @@
 
 namespace mxnet {
 
+namespace profiler {
+struct ProfileCounter;
+}  // namespace profiler
+
 // =====  CpuEngine =======================================
 // cpu_engine singleton
 class CpuEngine {
@@ -232,6 +243,170 @@ static typename std::unordered_map<S, I, H>::iterator AddToCache(std::unordered_
   return ins_return.first;
 }
 
+/*!
+ * \brief Hits, misses, evictions and creation time of the primitive caches of an operator,
+ *  summed over the threads. They are sent to the profiler as counters of the
+ *  "oneDNN primitive cache" domain while it runs.
+ */
+struct DNNLCacheStats {
+  std::atomic<uint64_t> hits{0};
+  std::atomic<uint64_t> misses{0};
+  std::atomic<uint64_t> evictions{0};
+  std::atomic<uint64_t> create_us{0};
+
+  /*! \brief Statistics of the caches of the operator name, created on first use */
+  static DNNLCacheStats* Get(const std::string& name);
+
+  explicit DNNLCacheStats(const std::string& name);
+
+  void OnHit() {
+    // the counters are refreshed every few hits to keep the lookups cheap
+    if ((++hits & 1023) == 0)
+      Report();
+  }
+  void OnMiss() {
+    ++misses;
+  }
+  void OnEvict() {
+    ++evictions;
+    Report();
+  }
+  void OnCreate(uint64_t us) {
+    create_us += us;
+    Report();
+  }
+
+ private:
+  /*! \brief Sends the statistics to the profiler counters if the profiler runs */
+  void Report();
+
+  profiler::ProfileCounter* hit_counter_;
+  profiler::ProfileCounter* miss_counter_;
+  profiler::ProfileCounter* eviction_counter_;
+  profiler::ProfileCounter* create_us_counter_;
+};
+
+/*! \brief Interface of the primitive caches to the per-thread cache manager */
+class DNNLCacheBase {
+ public:
+  virtual ~DNNLCacheBase() {}
+  /*! \brief Use tick of the least recently used entry, the max tick when empty */
+  virtual uint64_t OldestTick() const = 0;
+  /*! \brief Erases the least recently used entry */
+  virtual void EvictOldest() = 0;
+};
+
+/*!
+ * \brief Bounds the number of entries of all the primitive caches of a thread, set by
+ *  MXNET_ONEDNN_CACHE_CAPACITY. Inserting past the bound evicts the entries least recently
+ *  used by any operator.
+ */
+class DNNLCacheManager {
+ public:
+  static DNNLCacheManager* Get();
+
+  void Register(DNNLCacheBase* cache);
+  void Unregister(DNNLCacheBase* cache);
+  /*! \brief Tick ordering the uses of the entries of all the caches */
+  uint64_t Tick() {
+    return ++tick_;
+  }
+  void OnInsert();
+  void OnErase() {
+    --num_entries_;
+  }
+
+ private:
+  std::vector<DNNLCacheBase*> caches_;
+  size_t num_entries_ = 0;
+  uint64_t tick_      = 0;
+};
+
+/*!
+ * \brief Thread-local LRU cache of the primitives of an operator. It has the find / end
+ *  interface of the std::unordered_map it replaces, entries are added by AddToCache.
+ *  MXNET_ONEDNN_CACHE_NUM bounds each cache, MXNET_ONEDNN_CACHE_CAPACITY all the caches of the
+ *  thread together.
+ */
+template <typename S, typename I, typename H>
+class DNNLPrimitiveCache : public DNNLCacheBase {
+ public:
+  using iterator = typename std::list<std::pair<S, I>>::iterator;
+
+  explicit DNNLPrimitiveCache(const std::string& name)
+      : stats_(DNNLCacheStats::Get(name)), manager_(DNNLCacheManager::Get()) {
+    manager_->Register(this);
+  }
+
+  ~DNNLPrimitiveCache() {
+    manager_->Unregister(this);
+  }
+
+  iterator end() {
+    return entries_.end();
+  }
+
+  /*! \brief Finds the entry of the key and marks it as the most recently used */
+  iterator find(const S& key) {
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+      stats_->OnMiss();
+      miss_time_ = std::chrono::steady_clock::now();
+      return entries_.end();
+    }
+    stats_->OnHit();
+    entries_.splice(entries_.begin(), entries_, it->second.first);
+    it->second.second = manager_->Tick();
+    return it->second.first;
+  }
+
+  /*! \brief Inserts the entry created since the last miss */
+  iterator Add(const S& key, const I& item) {
+    const int dnnl_cache_size = GetDNNLCacheSize();
+    if (dnnl_cache_size != -1 && static_cast<int>(index_.size()) > dnnl_cache_size)
+      EvictOldest();
+    entries_.emplace_front(key, item);
+    auto ins_return = index_.emplace(key, std::make_pair(entries_.begin(), manager_->Tick()));
+    CHECK(ins_return.second);
+    stats_->OnCreate(std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::steady_clock::now() - miss_time_)
+                         .count());
+    manager_->OnInsert();
+    return entries_.begin();
+  }
+
+  uint64_t OldestTick() const override {
+    return entries_.empty() ? std::numeric_limits<uint64_t>::max() :
+                              index_.find(entries_.back().first)->second.second;
+  }
+
+  void EvictOldest() override {
+    if (entries_.empty())
+      return;
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+    stats_->OnEvict();
+    manager_->OnErase();
+  }
+
+ private:
+  /*! \brief Entries from the most to the least recently used */
+  std::list<std::pair<S, I>> entries_;
+  /*! \brief Position and use tick of the entry of each key */
+  std::unordered_map<S, std::pair<iterator, uint64_t>, H> index_;
+  DNNLCacheStats* stats_;
+  DNNLCacheManager* manager_;
+  std::chrono::steady_clock::time_point miss_time_;
+};
+
+template <typename S, typename I, typename H>
+static typename DNNLPrimitiveCache<S, I, H>::iterator AddToCache(
+    DNNLPrimitiveCache<S, I, H>* cache,
+    const S& key,
+    const I& item) {
+  return cache->Add(key, item);
+}
+
 /*
  * This is to align address to a certain alignment.
  */
@@ -251,7 +426,9 @@ struct SoftmaxOutputParam;
 bool SupportDNNLAct(const ActivationParam& param);
 bool SupportDNNLAct(const ActivationParam& param, const NDArray& input);
 bool SupportDNNLBatchDot(const std::vector<NDArray>& inputs);
-bool SupportDNNLBinary(const std::vector<NDArray>& inputs, const std::vector<NDArray>& outputs);
+bool SupportDNNLBinary(const std::vector<NDArray>& inputs,
+                       const std::vector<NDArray>& outputs,
+                       const dnnl::algorithm alg);
 bool SupportDNNLConcat(const std::vector<NDArray>& arrs);
 bool SupportDNNLConv(const ConvolutionParam& params, const NDArray& input);
 bool SupportDNNLDeconv(const DeconvolutionParam& params, const NDArray& input);
@@ -498,19 +675,43 @@ class TmpMemMgr {
 };
 
 typedef std::unordered_map<int, dnnl::memory> dnnl_args_map_t;
+/*!
+ * \brief Records the implementation of the primitive in the operator dispatch report of the
+ *  profiler, when a profiled operator runs on the calling thread
+ */
+void RecordDNNLDispatch(const dnnl::primitive& prim);
+
 class DNNLStream {
   std::vector<std::pair<dnnl::primitive, dnnl_args_map_t>> net_prim_args;
   // Here we hold all memory related to the operators in the stream.
   std::vector<std::shared_ptr<const dnnl::memory>> mem_holder;
   dnnl::stream s;
+  // OpenMP threads the primitives run with, 0 for the ones of the calling thread
+  int num_threads;
 
  public:
   static DNNLStream* Get();
 
-  DNNLStream() : s(CpuEngine::Get()->get_engine()) {}
+  DNNLStream()
+      : s(CpuEngine::Get()->get_engine()),
+        num_threads(dmlc::GetEnv("MXNET_ONEDNN_STREAM_THREADS", 0)) {}
+
+  /*!
+   * \brief Sets the number of threads the primitives of the stream run with. As the stream of
+   *  each thread is its own, the concurrent requests of a server can each get a share of the cores.
+   */
+  void SetNumThreads(int n) {
+    CHECK_GE(n, 0) << "The number of threads of a oneDNN stream can not be negative";
+    num_threads = n;
+  }
+
+  int GetNumThreads() const {
+    return num_threads;
+  }
 
   void RegisterPrimArgs(const dnnl::primitive& prim, const dnnl_args_map_t& args) {
     net_prim_args.emplace_back(prim, args);
+    RecordDNNLDispatch(prim);
   }
 
   void RegisterMem(std::shared_ptr<const dnnl::memory> mem) {
@@ -528,10 +729,20 @@ class DNNLStream {
    */
   void Submit(bool cleanup = true) {
     if (!net_prim_args.empty()) {
+#ifdef _OPENMP
+      // oneDNN on the OpenMP runtime parallelizes on the threads of the calling thread
+      const int prev_threads = omp_get_max_threads();
+      if (num_threads > 0)
+        omp_set_num_threads(num_threads);
+#endif
       for (auto& v : net_prim_args) {
         v.first.execute(s, v.second);
       }
       net_prim_args.clear();
+#ifdef _OPENMP
+      if (num_threads > 0)
+        omp_set_num_threads(prev_threads);
+#endif
     }
     if (cleanup)
       Cleanup();
@@ -543,6 +754,34 @@ class DNNLStream {
   }
 };
 
+/*!
+ * \brief Sets the threads of the oneDNN stream of the calling thread for its lifetime, and
+ *  the OpenMP threads of the calling thread too, so that the operators which are not
+ *  oneDNN primitives run with the same number of threads.
+ */
+class DNNLStreamThreadsScope {
+ public:
+  explicit DNNLStreamThreadsScope(int num_threads)
+      : prev_threads_(DNNLStream::Get()->GetNumThreads()),
+        prev_omp_threads_(omp_get_max_threads()),
+        num_threads_(num_threads) {
+    if (num_threads_ > 0) {
+      DNNLStream::Get()->SetNumThreads(num_threads_);
+      omp_set_num_threads(num_threads_);
+    }
+  }
+  ~DNNLStreamThreadsScope() {
+    DNNLStream::Get()->SetNumThreads(prev_threads_);
+    if (num_threads_ > 0)
+      omp_set_num_threads(prev_omp_threads_);
+  }
+
+ private:
+  const int prev_threads_;
+  const int prev_omp_threads_;
+  const int num_threads_;
+};
+
 enum OutDataOp {
   Noop,
   CopyBack,
@@ -709,6 +948,66 @@ class DNNLMemory {
 // reorder dnnl src to dst format dtype
 void ReorderTo(const dnnl::memory* src, const dnnl::memory* dst);
 
+/*!
+ * \brief Keeps the constant operands of a primitive, e.g. the weights of a matmul, reordered to
+ *  the format the primitive picked for them, as the blocked formats of the AMX kernels. An operand
+ *  is taken as constant when it is read again with the same data and version. A cached operand is
+ *  held, so that another array cannot get its variable and memory and be taken for it.
+ */
+class DNNLConstOperandCache {
+ public:
+  /*! \brief Whether the operand is unchanged since its previous read */
+  bool IsConst(const NDArray& arr);
+  /*!
+   * \brief Returns the constant operand in the format of desc, the plain memory given by
+   *  get_plain is reordered on the stream only when the operand is not cached yet
+   */
+  const dnnl::memory& Get(const NDArray& arr,
+                          const dnnl::memory::desc& desc,
+                          const std::function<dnnl::memory()>& get_plain);
+
+ private:
+  struct Entry {
+    size_t version;
+    const void* dptr;
+    std::shared_ptr<dnnl::memory> mem;
+    /*! \brief The operand, held while mem caches it */
+    NDArray src;
+  };
+  std::map<std::pair<Engine::VarHandle, size_t>, Entry> entries_;
+};
+
+/*!
+ * \brief Weights and bias of the fused oneDNN ops prepacked for their primitives, shared by all
+ *  the ops which pack the same parameter arrays the same way. The graphs of the replicas of a
+ *  model bound to one set of parameters, e.g. cached ops serving it from several threads, then
+ *  hold a single packed copy instead of one each. An entry lives as long as an op holds it.
+ *  The packings and the reuses are counted by the "packed weights" counters of the profiler.
+ */
+class DNNLPackedWeights {
+ public:
+  struct Packed {
+    /*! \brief The parameters packed, held so that their variables are not reused meanwhile */
+    std::vector<NDArray> sources;
+    NDArray weight;
+    NDArray bias;
+  };
+
+  static DNNLPackedWeights* Get();
+
+  /*!
+   * \brief Returns the packing described by sign of the sources at their current versions. When
+   *  no op shares it yet, it is made by pack, which may register its reorders on the stream.
+   */
+  std::shared_ptr<const Packed> GetOrPack(OpSignature sign,
+                                          const std::vector<NDArray>& sources,
+                                          const std::function<void(Packed*)>& pack);
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<OpSignature, std::weak_ptr<const Packed>, OpHash> entries_;
+};
+
 template <typename Compute, typename AttrState>
 void FallBackCompute(Compute fn,
                      const AttrState& attrs,
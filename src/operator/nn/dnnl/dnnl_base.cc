@@ -20,9 +20,13 @@
 #if MXNET_USE_ONEDNN == 1
 
 #include <atomic>
+#include <cstring>
+#include <mutex>
+#include <sstream>
 
 #include "../../../common/exec_utils.h"
 #include "operator/operator_common.h"
+#include "profiler/profiler.h"
 #include "dnnl_base-inl.h"
 
 namespace mxnet {
@@ -36,6 +40,89 @@ DNNLStream* DNNLStream::Get() {
   return &stream;
 }
 
+void RecordDNNLDispatch(const dnnl::primitive& prim) {
+  profiler::OprDispatchInfo* info = profiler::OprDispatchInfo::Get();
+  if (!info->active_)
+    return;
+  // reorders only convert the layouts of the operands of the main primitive
+  if (prim.get_kind() == dnnl::primitive::kind::reorder && info->impl_.c_str()[0] != '\0')
+    return;
+  const char* impl = nullptr;
+  dnnl_primitive_desc_query(prim.get_primitive_desc(), dnnl_query_impl_info_str, 0, &impl);
+  info->impl_.set(impl ? impl : "");
+  const bool is_subgraph = strncmp(info->op_name_.c_str(), "_sg_onednn", 10) == 0;
+  info->backend_.set(is_subgraph ? "onednn_subgraph" : "onednn");
+}
+
+static profiler::ProfileDomain* DNNLCacheDomain() {
+  static profiler::ProfileDomain domain("oneDNN primitive cache");
+  return &domain;
+}
+
+DNNLCacheStats* DNNLCacheStats::Get(const std::string& name) {
+  // the statistics are shared by the threads and live as long as the process
+  static std::mutex mutex;
+  static std::unordered_map<std::string, DNNLCacheStats*> stats;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = stats.find(name);
+  if (it == stats.end())
+    it = stats.emplace(name, new DNNLCacheStats(name)).first;
+  return it->second;
+}
+
+DNNLCacheStats::DNNLCacheStats(const std::string& name)
+    : hit_counter_(new profiler::ProfileCounter((name + " hits").c_str(), DNNLCacheDomain())),
+      miss_counter_(new profiler::ProfileCounter((name + " misses").c_str(), DNNLCacheDomain())),
+      eviction_counter_(
+          new profiler::ProfileCounter((name + " evictions").c_str(), DNNLCacheDomain())),
+      create_us_counter_(
+          new profiler::ProfileCounter((name + " creation us").c_str(), DNNLCacheDomain())) {}
+
+void DNNLCacheStats::Report() {
+  if (profiler::Profiler::Get()->GetState() != profiler::Profiler::kRunning)
+    return;
+  *hit_counter_       = hits;
+  *miss_counter_      = misses;
+  *eviction_counter_  = evictions;
+  *create_us_counter_ = create_us;
+}
+
+DNNLCacheManager* DNNLCacheManager::Get() {
+#if DMLC_CXX11_THREAD_LOCAL
+  static thread_local DNNLCacheManager manager;
+#else
+  static MX_THREAD_LOCAL DNNLCacheManager manager;
+#endif
+  return &manager;
+}
+
+void DNNLCacheManager::Register(DNNLCacheBase* cache) {
+  caches_.push_back(cache);
+}
+
+void DNNLCacheManager::Unregister(DNNLCacheBase* cache) {
+  caches_.erase(std::remove(caches_.begin(), caches_.end(), cache), caches_.end());
+}
+
+void DNNLCacheManager::OnInsert() {
+  static const size_t capacity = dmlc::GetEnv("MXNET_ONEDNN_CACHE_CAPACITY", 4096);
+  ++num_entries_;
+  while (capacity > 0 && num_entries_ > capacity) {
+    DNNLCacheBase* oldest = nullptr;
+    uint64_t oldest_tick  = std::numeric_limits<uint64_t>::max();
+    for (DNNLCacheBase* cache : caches_) {
+      const uint64_t tick = cache->OldestTick();
+      if (tick < oldest_tick) {
+        oldest      = cache;
+        oldest_tick = tick;
+      }
+    }
+    if (oldest == nullptr)
+      break;
+    oldest->EvictOldest();
+  }
+}
+
 namespace op {
 void DNNLMemorySum(const dnnl::memory& arr1, const dnnl::memory& arr2, const dnnl::memory& out) {
   std::vector<dnnl::memory::desc> input_pds(2);
@@ -449,6 +536,101 @@ void ReorderTo(const dnnl::memory* src, const dnnl::memory* dst) {
   dnnl::reorder(new_src, new_dst).execute(s, new_src, new_dst);
 }
 
+bool DNNLConstOperandCache::IsConst(const NDArray& arr) {
+  // every buffer of the activations adds an entry, the bound drops them from time to time
+  static constexpr size_t kMaxEntries = 64;
+  static const bool enabled           = dmlc::GetEnv("MXNET_ONEDNN_CACHE_CONST_OPERANDS", true);
+  if (!enabled)
+    return false;
+  const auto key   = std::make_pair(arr.var(), arr.byte_offset());
+  const void* dptr = arr.storage_handle().dptr;
+  auto it          = entries_.find(key);
+  if (it != entries_.end() && it->second.version == arr.version() && it->second.dptr == dptr)
+    return true;
+  if (it == entries_.end() && entries_.size() >= kMaxEntries)
+    entries_.clear();
+  entries_[key] = Entry{arr.version(), dptr, nullptr, NDArray()};
+  return false;
+}
+
+const dnnl::memory& DNNLConstOperandCache::Get(const NDArray& arr,
+                                               const dnnl::memory::desc& desc,
+                                               const std::function<dnnl::memory()>& get_plain) {
+  Entry& entry = entries_.at(std::make_pair(arr.var(), arr.byte_offset()));
+  if (!entry.mem || entry.mem->get_desc() != desc) {
+    const dnnl::memory plain = get_plain();
+    entry.mem                = std::make_shared<dnnl::memory>(desc, CpuEngine::Get()->get_engine());
+    entry.src                = arr;
+    DNNLStream::Get()->RegisterPrimArgs(dnnl::reorder(plain, *entry.mem),
+                                        {{DNNL_ARG_FROM, plain}, {DNNL_ARG_TO, *entry.mem}});
+  }
+  return *entry.mem;
+}
+
+DNNLPackedWeights* DNNLPackedWeights::Get() {
+  static DNNLPackedWeights inst;
+  return &inst;
+}
+
+std::shared_ptr<const DNNLPackedWeights::Packed> DNNLPackedWeights::GetOrPack(
+    OpSignature sign,
+    const std::vector<NDArray>& sources,
+    const std::function<void(Packed*)>& pack) {
+  static DNNLCacheStats* stats = DNNLCacheStats::Get("packed weights");
+  for (const NDArray& src : sources) {
+    sign.AddSign(reinterpret_cast<uint64_t>(src.var()));
+    sign.AddSign(static_cast<uint64_t>(src.byte_offset()));
+    sign.AddSign(static_cast<uint64_t>(src.version()));
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(sign);
+    if (it != entries_.end()) {
+      if (auto shared = it->second.lock()) {
+        stats->OnHit();
+        return shared;
+      }
+    }
+  }
+  stats->OnMiss();
+  const auto start = std::chrono::steady_clock::now();
+  auto packed      = std::make_shared<Packed>();
+  packed->sources  = sources;
+  pack(packed.get());
+  // the other ops may read it as soon as it is shared
+  DNNLStream::Get()->Submit();
+  stats->OnCreate(std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count());
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = entries_.begin(); it != entries_.end();)
+    it = it->second.expired() ? entries_.erase(it) : std::next(it);
+  auto& entry = entries_[sign];
+  // another thread packed the same weights meanwhile
+  if (auto shared = entry.lock())
+    return shared;
+  entry = packed;
+  return packed;
+}
+
+// Records in the operator dispatch report of the profiler that the operator runs its native
+// kernel, with the inputs oneDNN did not accept
+static void RecordDNNLFallback(const std::vector<NDArray>& inputs) {
+  profiler::OprDispatchInfo* info = profiler::OprDispatchInfo::Get();
+  if (!info->active_)
+    return;
+  std::ostringstream reason;
+  reason << "unsupported inputs";
+  for (const NDArray& input : inputs) {
+    reason << " " << mshadow::dtype_string(input.dtype()) << input.shape();
+    if (input.IsDNNLData())
+      reason << "(onednn layout)";
+  }
+  info->backend_.set("native");
+  info->impl_.set("");
+  info->fallback_reason_.set(reason.str().c_str());
+}
+
 template <typename Compute, typename AttrState>
 void FallBackCompute(Compute fn,
                      const AttrState& attrs_states,
@@ -522,6 +704,7 @@ void FallBackCompute(Compute fn,
       mxnet::common::CastNonDefaultStorage(temp_src, temp_dst, ctx, false);
     }
   }
+  RecordDNNLFallback(inputs);
 }
 
 template <typename DType>
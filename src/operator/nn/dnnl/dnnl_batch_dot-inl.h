@@ -99,6 +99,10 @@ class DNNLBatchDotFwd {
  private:
   std::shared_ptr<batch_dot_fwd_t> fwd;
   std::shared_ptr<batch_dot_fwd_pd_t> fwd_pd;
+  // primitive reading a constant rhs in the format of choice, created at its first use
+  std::shared_ptr<batch_dot_fwd_t> const_fwd;
+  std::shared_ptr<batch_dot_fwd_pd_t> const_fwd_pd;
+  DNNLConstOperandCache const_rhs;
 };
 
 template <bool subgraph = true>
@@ -25,6 +25,7 @@
 #if MXNET_USE_ONEDNN == 1
 
 #include "dnnl_batch_dot-inl.h"
+#include "dnnl_dot-inl.h"
 #include "operator/quantization/quantization_utils.h"
 
 namespace mxnet {
@@ -41,11 +42,11 @@ bool SupportDNNLBatchDot(const std::vector<NDArray>& inputs) {
 DNNLBatchDotFwd& DNNLBatchDotFwd::GetCached(const DNNLDotParam& param,
                                             const std::vector<NDArray>& inputs,
                                             const std::vector<NDArray>& outputs) {
-  using batch_dot_fwd_map = std::unordered_map<BatchDotSignature, DNNLBatchDotFwd, OpHash>;
+  using batch_dot_fwd_map = DNNLPrimitiveCache<BatchDotSignature, DNNLBatchDotFwd, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local batch_dot_fwd_map fwds;
+  static thread_local batch_dot_fwd_map fwds("batch_dot");
 #else
-  static MX_THREAD_LOCAL batch_dot_fwd_map fwds;
+  static MX_THREAD_LOCAL batch_dot_fwd_map fwds("batch_dot");
 #endif
 
   BatchDotSignature key(param);
@@ -97,6 +98,7 @@ DNNLBatchDotFwd::DNNLBatchDotFwd(const DNNLDotParam& param,
     bigDim *= lhs_shape[i];
   }
 
+  // the inputs are read in their plain format, which the AMX kernels would not pick for `any`
   auto GetMemoryDesc = [&ndim, &bigDim](const NDArray& tensor, const bool transpose) {
     auto shape = tensor.shape();
     if (transpose) {
@@ -106,7 +108,7 @@ DNNLBatchDotFwd::DNNLBatchDotFwd(const DNNLDotParam& param,
     } else {
       return dnnl::memory::desc(dnnl::memory::dims{bigDim, shape[ndim - 2], shape[ndim - 1]},
                                 get_dnnl_type(tensor.dtype()),
-                                dnnl::memory::format_tag::any);
+                                dnnl::memory::format_tag::abc);
     }
   };
 
@@ -142,12 +144,23 @@ void DNNLBatchDotFwd::Execute(const OpContext& ctx,
   if (rhs.IsDNNLData())
     rhs = rhs.Reorder2Default();
 
-  auto lhs_mem =
-      dnnl::memory(fwd_pd->src_desc(), engine, reinterpret_cast<void*>(lhs.data().dptr_));
-  auto rhs_mem =
-      dnnl::memory(fwd_pd->weights_desc(), engine, reinterpret_cast<void*>(rhs.data().dptr_));
-  dnnl_output_t out_mem = CreateDNNLMem(
-      outputs[DotOut::out], fwd_pd->dst_desc(), req[DotOut::out], &inputs[DotIn::lhs]);
+  // A constant rhs of the inference, e.g. weights, is reordered only once to the format picked by
+  // oneDNN, which saves the reorders of the AMX kernels at every call.
+  const bool const_rhs_used = !ctx.is_train && !ctx.need_grad && const_rhs.IsConst(rhs);
+  if (const_rhs_used && !const_fwd) {
+    const_fwd_pd = std::make_shared<batch_dot_fwd_pd_t>(GetConstWeightsMatmulPd(*fwd_pd));
+    const_fwd    = std::make_shared<batch_dot_fwd_t>(*const_fwd_pd);
+  }
+  const batch_dot_fwd_pd_t& pd = const_rhs_used ? *const_fwd_pd : *fwd_pd;
+
+  auto lhs_mem = dnnl::memory(pd.src_desc(), engine, reinterpret_cast<void*>(lhs.data().dptr_));
+  auto get_rhs = [&]() {
+    return dnnl::memory(fwd_pd->weights_desc(), engine, reinterpret_cast<void*>(rhs.data().dptr_));
+  };
+  const dnnl::memory rhs_mem =
+      const_rhs_used ? const_rhs.Get(rhs, pd.weights_desc(), get_rhs) : get_rhs();
+  dnnl_output_t out_mem =
+      CreateDNNLMem(outputs[DotOut::out], pd.dst_desc(), req[DotOut::out], &inputs[DotIn::lhs]);
 
   dnnl_args_map_t args = {
       {DNNL_ARG_SRC, lhs_mem},
@@ -155,7 +168,7 @@ void DNNLBatchDotFwd::Execute(const OpContext& ctx,
       {DNNL_ARG_DST, *out_mem.second},
   };
 
-  DNNLStream::Get()->RegisterPrimArgs(*fwd, args);
+  DNNLStream::Get()->RegisterPrimArgs(const_rhs_used ? *const_fwd : *fwd, args);
   CommitOutput(outputs[0], out_mem);
   DNNLStream::Get()->Submit();
 
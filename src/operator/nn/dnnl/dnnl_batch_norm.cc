@@ -64,9 +64,10 @@ DNNLBNForward& DNNLBNForward::GetCached(const BatchNormParam& param,
                                         bool fuse_relu,
                                         dnnl::normalization_flags flags) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLBNSignature, DNNLBNForward, OpHash> fwds;
+  static thread_local DNNLPrimitiveCache<DNNLBNSignature, DNNLBNForward, OpHash> fwds("BatchNorm");
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLBNSignature, DNNLBNForward, OpHash> fwds;
+  static MX_THREAD_LOCAL DNNLPrimitiveCache<DNNLBNSignature, DNNLBNForward, OpHash>
+      fwds("BatchNorm");
 #endif
 
   DNNLBNSignature key(param);
@@ -215,9 +216,11 @@ DNNLBNBackward& DNNLBNBackward::GetCached(const BatchNormParam& param,
                                           const dnnl::memory& diff_mem,
                                           dnnl::normalization_flags flags) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLBNSignature, DNNLBNBackward, OpHash> bwds;
+  static thread_local DNNLPrimitiveCache<DNNLBNSignature, DNNLBNBackward, OpHash>
+      bwds("BatchNorm backward");
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLBNSignature, DNNLBNBackward, OpHash> bwds;
+  static MX_THREAD_LOCAL DNNLPrimitiveCache<DNNLBNSignature, DNNLBNBackward, OpHash>
+      bwds("BatchNorm backward");
 #endif
   DNNLBNSignature key(param);
   key.AddSign(in_data);
@@ -55,14 +55,25 @@ class DNNLBinaryOpFwd {
   std::shared_ptr<binary_fwd_pd_t> fwd_pd;
 };
 
+/*!
+ * \brief Folds adjacent axes that have the same broadcast pattern and drops axes of size 1.
+ * Unlike BinaryBroadcastShapeCompact, the result is not limited to broadcast::MAX_DIM axes.
+ */
+void DNNLBinaryCompactShapes(const mxnet::TShape& lshape,
+                             const mxnet::TShape& rshape,
+                             const mxnet::TShape& oshape,
+                             mxnet::TShape* new_lshape,
+                             mxnet::TShape* new_rshape,
+                             mxnet::TShape* new_oshape);
+
 template <dnnl::algorithm alg>
 DNNLBinaryOpFwd& DNNLBinaryOpFwd::GetBinaryOpForward(const std::vector<NDArray>& inputs,
                                                      const std::vector<NDArray>& outputs) {
-  using binary_op_fwd_map = std::unordered_map<OpSignature, DNNLBinaryOpFwd, OpHash>;
+  using binary_op_fwd_map = DNNLPrimitiveCache<OpSignature, DNNLBinaryOpFwd, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local binary_op_fwd_map fwds;
+  static thread_local binary_op_fwd_map fwds("Binary");
 #else
-  static MX_THREAD_LOCAL binary_op_fwd_map fwds;
+  static MX_THREAD_LOCAL binary_op_fwd_map fwds("Binary");
 #endif
   OpSignature key;
   key.AddSign(static_cast<int>(alg));
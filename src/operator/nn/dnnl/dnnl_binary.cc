@@ -23,6 +23,8 @@
  */
 
 #if MXNET_USE_ONEDNN == 1
+#include <utility>
+
 #include "./dnnl_binary-inl.h"
 
 namespace mxnet {
@@ -63,17 +65,81 @@ void DNNLBinaryOpFwd::Execute(const std::vector<NDArray>& inputs,
   DNNLStream::Get()->Submit();
 }
 
+void DNNLBinaryCompactShapes(const mxnet::TShape& lshape,
+                             const mxnet::TShape& rshape,
+                             const mxnet::TShape& oshape,
+                             mxnet::TShape* new_lshape,
+                             mxnet::TShape* new_rshape,
+                             mxnet::TShape* new_oshape) {
+  const int lpad = oshape.ndim() - lshape.ndim();
+  const int rpad = oshape.ndim() - rshape.ndim();
+  std::vector<dim_t> ldims, rdims, odims;
+  // broadcast pattern of the last folded axis: {lhs broadcast, rhs broadcast}
+  std::pair<bool, bool> last_pattern;
+  for (int i = 0; i < oshape.ndim(); ++i) {
+    const dim_t o = oshape[i];
+    if (o == 1)
+      continue;
+    const dim_t l                      = i >= lpad ? lshape[i - lpad] : 1;
+    const dim_t r                      = i >= rpad ? rshape[i - rpad] : 1;
+    const std::pair<bool, bool> pattern = {l != o, r != o};
+    if (odims.empty() || pattern != last_pattern) {
+      ldims.push_back(1);
+      rdims.push_back(1);
+      odims.push_back(1);
+      last_pattern = pattern;
+    }
+    ldims.back() *= l;
+    rdims.back() *= r;
+    odims.back() *= o;
+  }
+  if (odims.empty()) {
+    // oneDNN needs at least one dimension, also for tensors of shape (1, 1, ..., 1)
+    ldims.push_back(1);
+    rdims.push_back(1);
+    odims.push_back(1);
+  }
+  *new_lshape = mxnet::TShape(ldims.begin(), ldims.end());
+  *new_rshape = mxnet::TShape(rdims.begin(), rdims.end());
+  *new_oshape = mxnet::TShape(odims.begin(), odims.end());
+}
+
 // Support for https://oneapi-src.github.io/oneDNN/v2.6/dev_guide_binary.html
-bool SupportDNNLBinary(const std::vector<NDArray>& inputs, const std::vector<NDArray>& outputs) {
+// The native broadcast kernels are used when:
+//  - an input or the output is not fp32/bf16,
+//  - the output is smaller than the size threshold and no tensor is in a oneDNN layout,
+//  - more than 12 dimensions are left after folding adjacent axes with the same broadcast
+//    pattern,
+//  - the lhs is broadcast and the operation is not commutative, or both inputs are broadcast.
+//    oneDNN only broadcasts its second source, so commutative operations swap the inputs.
+bool SupportDNNLBinary(const std::vector<NDArray>& inputs,
+                       const std::vector<NDArray>& outputs,
+                       const dnnl::algorithm alg) {
   // threshold value selected experimentally basing on performance results - PR-21106
   constexpr size_t optimal_size_threshold = 2 << 13;
   const bool threshold_condition          = outputs[0].shape().Size() >= optimal_size_threshold;
   const bool is_any_dnnl_data =
       inputs[0].IsDNNLData() || inputs[1].IsDNNLData() || outputs[0].IsDNNLData();
 
-  return SupportDNNL<DNNLTypeMode::FloatTypes>(inputs[0]) &&
-         SupportDNNL<DNNLTypeMode::FloatTypes>(inputs[1]) &&
-         (threshold_condition || is_any_dnnl_data);
+  if (!SupportDNNLType<DNNLTypeMode::FloatTypes>(inputs[0].dtype()) ||
+      !SupportDNNLType<DNNLTypeMode::FloatTypes>(inputs[1].dtype()) ||
+      !SupportDNNLType<DNNLTypeMode::FloatTypes>(outputs[0].dtype()) ||
+      !(threshold_condition || is_any_dnnl_data))
+    return false;
+
+  const mxnet::TShape& lshape = inputs[0].shape();
+  const mxnet::TShape& rshape = inputs[1].shape();
+  const mxnet::TShape& oshape = outputs[0].shape();
+  if (lshape == rshape)
+    return SupportDNNL<DNNLTypeMode::FloatTypes>(inputs[0]);
+
+  mxnet::TShape new_lshape, new_rshape, new_oshape;
+  DNNLBinaryCompactShapes(lshape, rshape, oshape, &new_lshape, &new_rshape, &new_oshape);
+  if (!SupportDNNLShape<1, 12>(new_oshape))
+    return false;
+  const bool is_commutative =
+      alg == dnnl::algorithm::binary_add || alg == dnnl::algorithm::binary_mul;
+  return new_lshape == new_oshape || (is_commutative && new_rshape == new_oshape);
 }
 
 }  // namespace op
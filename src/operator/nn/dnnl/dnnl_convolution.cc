@@ -432,11 +432,11 @@ DNNLConvForward& GetConvFwd(const DNNLConvFullParam& param,
                             const NDArray& weight,
                             const NDArray* bias,
                             const NDArray& output) {
-  using conv_fwd_map = std::unordered_map<DNNLConvSignature, DNNLConvForward, OpHash>;
+  using conv_fwd_map = DNNLPrimitiveCache<DNNLConvSignature, DNNLConvForward, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local conv_fwd_map fwds;
+  static thread_local conv_fwd_map fwds("Convolution");
 #else
-  static MX_THREAD_LOCAL conv_fwd_map fwds;
+  static MX_THREAD_LOCAL conv_fwd_map fwds("Convolution");
 #endif
   // TODO(zhennan): Hash conv_param for now, need to hash full param if we want to enable cache for
   // fused conv
@@ -550,11 +550,11 @@ static inline DNNLConvBackward& GetConvBwd(const DNNLConvFullParam& param,
                                            const NDArray& weight,
                                            const NDArray* bias,
                                            const NDArray& output) {
-  using dnnl_conv_bwd_map = std::unordered_map<DNNLConvSignature, DNNLConvBackward, OpHash>;
+  using dnnl_conv_bwd_map = DNNLPrimitiveCache<DNNLConvSignature, DNNLConvBackward, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local dnnl_conv_bwd_map bwds;
+  static thread_local dnnl_conv_bwd_map bwds("Convolution backward");
 #else
-  static MX_THREAD_LOCAL dnnl_conv_bwd_map bwds;
+  static MX_THREAD_LOCAL dnnl_conv_bwd_map bwds("Convolution backward");
 #endif
   // TODO(zhennan): Hash conv_param for now, need to hash full param if we want to enable cache for
   // fused conv
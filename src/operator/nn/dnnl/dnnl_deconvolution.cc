@@ -80,11 +80,11 @@ DNNLDeconvFwd::DNNLDeconvFwd(const DeconvolutionParam& param, const Tensors& ten
 }
 
 DNNLDeconvFwd& DNNLDeconvFwd::GetCached(const DeconvolutionParam& param, const Tensors& tensors) {
-  using deconv_fwd_map = std::unordered_map<DeconvSignature, DNNLDeconvFwd, OpHash>;
+  using deconv_fwd_map = DNNLPrimitiveCache<DeconvSignature, DNNLDeconvFwd, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local deconv_fwd_map fwds;
+  static thread_local deconv_fwd_map fwds("Deconvolution");
 #else
-  static MX_THREAD_LOCAL deconv_fwd_map fwds;
+  static MX_THREAD_LOCAL deconv_fwd_map fwds("Deconvolution");
 #endif
   DeconvSignature key(param);
   key.AddSign(tensors.data);
@@ -223,11 +223,11 @@ DNNLDeconvBwd::DNNLDeconvBwd(const DeconvolutionParam& param, const ReadTensors&
 
 DNNLDeconvBwd& DNNLDeconvBwd::GetCached(const DeconvolutionParam& param,
                                         const ReadTensors& read_tensors) {
-  using deconv_bwd_map = std::unordered_map<DeconvSignature, DNNLDeconvBwd, OpHash>;
+  using deconv_bwd_map = DNNLPrimitiveCache<DeconvSignature, DNNLDeconvBwd, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local deconv_bwd_map bwds;
+  static thread_local deconv_bwd_map bwds("Deconvolution backward");
 #else
-  static MX_THREAD_LOCAL deconv_bwd_map bwds;
+  static MX_THREAD_LOCAL deconv_bwd_map bwds("Deconvolution backward");
 #endif
   DeconvSignature key(param);
   key.AddSign(read_tensors.data);
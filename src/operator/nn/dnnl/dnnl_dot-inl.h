@@ -40,6 +40,12 @@ using dot_fwd_pd_t = dnnl::matmul::primitive_desc;
 
 typedef ParamOpSign<DotParam> DotSignature;
 
+/*!
+ * \brief Returns the matmul primitive descriptor equal to pd with its weights in the format of
+ *  choice of oneDNN, the blocked formats the AMX kernels read without reordering
+ */
+dnnl::matmul::primitive_desc GetConstWeightsMatmulPd(const dnnl::matmul::primitive_desc& pd);
+
 class DNNLDotFwd {
  public:
   static DNNLDotFwd& GetCached(const DotParam& param,
@@ -61,6 +67,10 @@ class DNNLDotFwd {
  private:
   std::shared_ptr<dot_fwd_t> fwd;
   std::shared_ptr<dot_fwd_pd_t> fwd_pd;
+  // primitive reading a constant rhs in the format of choice, created at its first use
+  std::shared_ptr<dot_fwd_t> const_fwd;
+  std::shared_ptr<dot_fwd_pd_t> const_fwd_pd;
+  DNNLConstOperandCache const_rhs;
 };
 
 template <bool isNumpy>
@@ -45,11 +45,11 @@ DNNLDotFwd& DNNLDotFwd::GetCached(const DotParam& param,
                                   const std::vector<NDArray>& inputs,
                                   const std::vector<NDArray>& outputs,
                                   const bool isNumpy) {
-  using dot_fwd_map = std::unordered_map<DotSignature, DNNLDotFwd, OpHash>;
+  using dot_fwd_map = DNNLPrimitiveCache<DotSignature, DNNLDotFwd, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local dot_fwd_map fwds;
+  static thread_local dot_fwd_map fwds("dot");
 #else
-  static MX_THREAD_LOCAL dot_fwd_map fwds;
+  static MX_THREAD_LOCAL dot_fwd_map fwds("dot");
 #endif
 
   DotSignature key(param);
@@ -105,40 +105,63 @@ DNNLDotFwd::DNNLDotFwd(const DotParam& param,
   fwd    = std::make_shared<dot_fwd_t>(*fwd_pd);
 }
 
+dnnl::matmul::primitive_desc GetConstWeightsMatmulPd(const dnnl::matmul::primitive_desc& pd) {
+  const dnnl::memory::desc weights_md = pd.weights_desc();
+  const dnnl::memory::desc any_md(
+      weights_md.dims(), weights_md.data_type(), dnnl::memory::format_tag::any);
+  dnnl::matmul::desc fwd_desc(pd.src_desc(), any_md, pd.dst_desc());
+  return dnnl::matmul::primitive_desc(
+      fwd_desc, pd.get_primitive_attr(), mxnet::CpuEngine::Get()->get_engine());
+}
+
 void DNNLDotFwd::Execute(const OpContext& ctx,
                          const std::vector<NDArray>& inputs,
                          const std::vector<OpReqType>& req,
                          const std::vector<NDArray>& outputs,
                          const bool isNumpy) {
-  auto engine = mxnet::CpuEngine::Get()->get_engine();
-  auto lhs    = dnnl::memory(
-      fwd_pd->src_desc(), engine, reinterpret_cast<void*>(inputs[DotIn::lhs].data().dptr_));
-  auto ndimRhs                = inputs[DotIn::rhs].shape().ndim();
+  auto engine                 = mxnet::CpuEngine::Get()->get_engine();
+  const NDArray& rhsArr       = inputs[DotIn::rhs];
+  auto ndimRhs                = rhsArr.shape().ndim();
   const bool specialNumpyCase = isNumpy && ndimRhs > 2;
-  auto rhsMemPointer =
-      specialNumpyCase ?
-          reinterpret_cast<void*>(
-              ctx.requested[0]
-                  .get_space<cpu>(mshadow::Shape1(inputs[DotIn::rhs].shape().Size() *
-                                                  GetTypeSize(inputs[DotIn::rhs].dtype())),
-                                  ctx.get_stream<cpu>())
-                  .dptr_) :
-          reinterpret_cast<void*>(inputs[DotIn::rhs].data().dptr_);
-  dnnl::memory rhs(fwd_pd->weights_desc(), engine, rhsMemPointer);
-  if (specialNumpyCase) {
-    // Necessity of this reorder is described in DNNLDotFwd constructor.
-    auto tmp_rhs = inputs[DotIn::rhs].GetDNNLData();
-    dnnl::memory::desc rhs_md(
-        dnnl::memory::dims(inputs[DotIn::rhs].shape().begin(), inputs[DotIn::rhs].shape().end()),
-        get_dnnl_type(inputs[DotIn::rhs].dtype()),
-        static_cast<dnnl::memory::format_tag>(GetPermutedFormat(ndimRhs)));
-    dnnl::memory tmp_rhs_dst(rhs_md, engine, rhs.get_data_handle());
-    const auto rhs_reorder_pd = dnnl::reorder::primitive_desc(*tmp_rhs, tmp_rhs_dst);
-    DNNLStream::Get()->RegisterPrimArgs(dnnl::reorder(rhs_reorder_pd),
-                                        {{DNNL_ARG_FROM, *tmp_rhs}, {DNNL_ARG_TO, tmp_rhs_dst}});
+  auto getRhs                 = [&]() {
+    auto rhsMemPointer =
+        specialNumpyCase ?
+            reinterpret_cast<void*>(
+                ctx.requested[0]
+                    .get_space<cpu>(
+                        mshadow::Shape1(rhsArr.shape().Size() * GetTypeSize(rhsArr.dtype())),
+                        ctx.get_stream<cpu>())
+                    .dptr_) :
+            reinterpret_cast<void*>(rhsArr.data().dptr_);
+    dnnl::memory rhs(fwd_pd->weights_desc(), engine, rhsMemPointer);
+    if (specialNumpyCase) {
+      // Necessity of this reorder is described in DNNLDotFwd constructor.
+      auto tmp_rhs = rhsArr.GetDNNLData();
+      dnnl::memory::desc rhs_md(dnnl::memory::dims(rhsArr.shape().begin(), rhsArr.shape().end()),
+                                get_dnnl_type(rhsArr.dtype()),
+                                static_cast<dnnl::memory::format_tag>(GetPermutedFormat(ndimRhs)));
+      dnnl::memory tmp_rhs_dst(rhs_md, engine, rhs.get_data_handle());
+      const auto rhs_reorder_pd = dnnl::reorder::primitive_desc(*tmp_rhs, tmp_rhs_dst);
+      DNNLStream::Get()->RegisterPrimArgs(dnnl::reorder(rhs_reorder_pd),
+                                          {{DNNL_ARG_FROM, *tmp_rhs}, {DNNL_ARG_TO, tmp_rhs_dst}});
+    }
+    return rhs;
+  };
+  // A constant rhs of the inference, e.g. weights, is reordered only once to the format picked by
+  // oneDNN, which saves the reorders of the AMX kernels at every call.
+  const bool isConstRhs = !ctx.is_train && !ctx.need_grad && const_rhs.IsConst(rhsArr);
+  if (isConstRhs && !const_fwd) {
+    const_fwd_pd = std::make_shared<dot_fwd_pd_t>(GetConstWeightsMatmulPd(*fwd_pd));
+    const_fwd    = std::make_shared<dot_fwd_t>(*const_fwd_pd);
   }
-  dnnl_output_t out_mem = CreateDNNLMem(
-      outputs[DotOut::out], fwd_pd->dst_desc(), req[DotOut::out], &inputs[DotIn::lhs]);
+  const dot_fwd_pd_t& pd = isConstRhs ? *const_fwd_pd : *fwd_pd;
+
+  auto lhs = dnnl::memory(
+      pd.src_desc(), engine, reinterpret_cast<void*>(inputs[DotIn::lhs].data().dptr_));
+  const dnnl::memory rhs =
+      isConstRhs ? const_rhs.Get(rhsArr, pd.weights_desc(), getRhs) : getRhs();
+  dnnl_output_t out_mem =
+      CreateDNNLMem(outputs[DotOut::out], pd.dst_desc(), req[DotOut::out], &inputs[DotIn::lhs]);
 
   dnnl_args_map_t args = {
       {DNNL_ARG_SRC, lhs},
@@ -146,7 +169,7 @@ void DNNLDotFwd::Execute(const OpContext& ctx,
       {DNNL_ARG_DST, *out_mem.second},
   };
 
-  DNNLStream::Get()->RegisterPrimArgs(*fwd, args);
+  DNNLStream::Get()->RegisterPrimArgs(isConstRhs ? *const_fwd : *fwd, args);
   CommitOutput(outputs[DotOut::out], out_mem);
   DNNLStream::Get()->Submit();
 }
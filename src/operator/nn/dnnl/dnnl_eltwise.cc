@@ -37,9 +37,11 @@ DNNLEltwiseFwd& DNNLEltwiseFwd::GetCached(const NDArray& input,
                                           const NDArray& output,
                                           const dnnl::algorithm algorithm) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLEltwiseSignature, DNNLEltwiseFwd, OpHash> fwds;
+  static thread_local DNNLPrimitiveCache<DNNLEltwiseSignature, DNNLEltwiseFwd, OpHash>
+      fwds("Eltwise");
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLEltwiseSignature, DNNLEltwiseFwd, OpHash> fwds;
+  static MX_THREAD_LOCAL DNNLPrimitiveCache<DNNLEltwiseSignature, DNNLEltwiseFwd, OpHash>
+      fwds("Eltwise");
 #endif
 
   DNNLEltwiseSignature key;
@@ -87,14 +87,16 @@ struct DNNLFCFullParam : public dmlc::Parameter<DNNLFCFullParam> {
   FullyConnectedParam default_param;
   DNNLFCParam dnnl_param;
   DNNLPostEltwiseParam eltwise_param;
+  // post-ops following eltwise_param in a chain of float post-ops
+  std::vector<DNNLPostEltwiseParam> eltwise_tail;
   float sum_scale                  = {1.0f};
   std::vector<float> output_scales = {0.0f};
   DMLC_DECLARE_PARAMETER(DNNLFCFullParam) {}
 
   bool operator==(const DNNLFCFullParam& other) const {
     return this->default_param == other.default_param && this->dnnl_param == other.dnnl_param &&
-           this->eltwise_param == other.eltwise_param && this->sum_scale == other.sum_scale &&
-           this->output_scales == other.output_scales;
+           this->eltwise_param == other.eltwise_param && this->eltwise_tail == other.eltwise_tail &&
+           this->sum_scale == other.sum_scale && this->output_scales == other.output_scales;
   }
 };
 
@@ -272,7 +274,9 @@ struct hash<mxnet::op::DNNLFCFullParam> {
     ret        = dmlc::HashCombine(ret, val.default_param);
     ret        = dmlc::HashCombine(ret, val.dnnl_param);
     ret        = dmlc::HashCombine(ret, val.eltwise_param);
-    ret        = dmlc::HashCombine(ret, val.sum_scale);
+    for (const auto& v : val.eltwise_tail)
+      ret = dmlc::HashCombine(ret, v);
+    ret = dmlc::HashCombine(ret, val.sum_scale);
     for (const auto& v : val.output_scales)
       ret = dmlc::HashCombine(ret, v);
     return ret;
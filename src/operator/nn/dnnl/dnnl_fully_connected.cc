@@ -52,6 +52,9 @@ dnnl::inner_product_forward::primitive_desc GetFCFwdImpl(const DNNLFCFullParam&
                        full_param.eltwise_param.alg,
                        full_param.eltwise_param.alpha,
                        full_param.eltwise_param.beta);
+    for (const auto& step : full_param.eltwise_tail) {
+      ops.append_eltwise(step.scale, step.alg, step.alpha, step.beta);
+    }
   }
   if (full_param.dnnl_param.with_sum) {
     ops.append_sum(full_param.sum_scale);
@@ -130,12 +133,12 @@ DNNLFullyConnectedForward& GetFCFwd(const DNNLFCFullParam& param,
                                     const NDArray* bias,
                                     const dnnl::memory::desc& out_md) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLFullyconSignature, DNNLFullyConnectedForward, OpHash>
-      fcFwds;
+  static thread_local DNNLPrimitiveCache<DNNLFullyconSignature, DNNLFullyConnectedForward, OpHash>
+      fcFwds("FullyConnected");
 #else
   static MX_THREAD_LOCAL
-      std::unordered_map<DNNLFullyconSignature, DNNLFullyConnectedForward, OpHash>
-          fcFwds;
+      DNNLPrimitiveCache<DNNLFullyconSignature, DNNLFullyConnectedForward, OpHash>
+          fcFwds("FullyConnected");
 #endif
   DNNLFullyconSignature key(param);
   key.AddSign(is_train);
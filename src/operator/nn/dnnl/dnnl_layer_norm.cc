@@ -60,11 +60,11 @@ void DNNLLayerNormForward(const nnvm::NodeAttrs& attrs,
 DNNLLayerNormFwd& DNNLLayerNormFwd::GetCached(const LayerNormParam& param,
                                               const OpContext& ctx,
                                               const NDArray& data) {
-  using layernorm_fwd_map = std::unordered_map<LayerNormSignature, DNNLLayerNormFwd, OpHash>;
+  using layernorm_fwd_map = DNNLPrimitiveCache<LayerNormSignature, DNNLLayerNormFwd, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local layernorm_fwd_map layer_norm_fwds;
+  static thread_local layernorm_fwd_map layer_norm_fwds("LayerNorm");
 #else
-  static MX_THREAD_LOCAL layernorm_fwd_map layer_norm_fwds;
+  static MX_THREAD_LOCAL layernorm_fwd_map layer_norm_fwds("LayerNorm");
 #endif
 
   LayerNormSignature key(param);
@@ -219,11 +219,11 @@ void DNNLLayerNormBwd::Execute(const std::vector<NDArray>& inputs,
 
 DNNLLayerNormBwd& DNNLLayerNormBwd::GetCached(const LayerNormParam& param,
                                               const std::vector<NDArray>& inputs) {
-  using layernorm_bwd_map = std::unordered_map<LayerNormSignature, DNNLLayerNormBwd, OpHash>;
+  using layernorm_bwd_map = DNNLPrimitiveCache<LayerNormSignature, DNNLLayerNormBwd, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local layernorm_bwd_map layer_norm_bwds;
+  static thread_local layernorm_bwd_map layer_norm_bwds("LayerNorm backward");
 #else
-  static MX_THREAD_LOCAL layernorm_bwd_map layer_norm_bwds;
+  static MX_THREAD_LOCAL layernorm_bwd_map layer_norm_bwds("LayerNorm backward");
 #endif
   LayerNormSignature key(param);
   key.AddSign(inputs[layernorm::kBwdOutGrad]);
@@ -87,9 +87,11 @@ static DNNLLogSoftmaxFwd& GetLogSoftmaxFwd(const SoftmaxParam& param,
                                            const NDArray& data,
                                            const NDArray& output) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLSoftmaxSignature, DNNLLogSoftmaxFwd, OpHash> fwds;
+  static thread_local DNNLPrimitiveCache<DNNLSoftmaxSignature, DNNLLogSoftmaxFwd, OpHash>
+      fwds("log_softmax");
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLSoftmaxSignature, DNNLLogSoftmaxFwd, OpHash> fwds;
+  static MX_THREAD_LOCAL DNNLPrimitiveCache<DNNLSoftmaxSignature, DNNLLogSoftmaxFwd, OpHash>
+      fwds("log_softmax");
 #endif
 
   DNNLSoftmaxSignature key(param);
@@ -153,9 +155,11 @@ static DNNLLogSoftmaxBwd& GetLogSoftmaxBwd(const SoftmaxParam& param,
                                            const std::vector<NDArray>& data,
                                            const std::vector<NDArray>& output) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLSoftmaxSignature, DNNLLogSoftmaxBwd, OpHash> bwds;
+  static thread_local DNNLPrimitiveCache<DNNLSoftmaxSignature, DNNLLogSoftmaxBwd, OpHash>
+      bwds("log_softmax backward");
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLSoftmaxSignature, DNNLLogSoftmaxBwd, OpHash> bwds;
+  static MX_THREAD_LOCAL DNNLPrimitiveCache<DNNLSoftmaxSignature, DNNLLogSoftmaxBwd, OpHash>
+      bwds("log_softmax backward");
 #endif
 
   DNNLSoftmaxSignature key(param);
@@ -53,11 +53,11 @@ DNNLMaskedSoftmaxFwd& DNNLMaskedSoftmaxFwd::GetCached(
     const MaskedSoftmaxParam& param,
     const DNNLMaskedSoftmaxFwd::Tensors& tensors) {
   using maskedsoftmax_fwd_map =
-      std::unordered_map<MaskedSoftmaxSignature, DNNLMaskedSoftmaxFwd, OpHash>;
+      DNNLPrimitiveCache<MaskedSoftmaxSignature, DNNLMaskedSoftmaxFwd, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local maskedsoftmax_fwd_map fwds;
+  static thread_local maskedsoftmax_fwd_map fwds("masked_softmax");
 #else
-  static MX_THREAD_LOCAL maskedsoftmax_fwd_map fwds;
+  static MX_THREAD_LOCAL maskedsoftmax_fwd_map fwds("masked_softmax");
 #endif
   MaskedSoftmaxSignature key(param);
   key.AddSign(tensors.input);
@@ -276,10 +276,11 @@ DNNLPoolingFwd& GetPoolingFwd(const PoolingParam& param,
                               const NDArray& output,
                               const bool use_adaptive_pooling) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLPoolingSignature, DNNLPoolingFwd, OpHash> pooling_fwds;
+  static thread_local DNNLPrimitiveCache<DNNLPoolingSignature, DNNLPoolingFwd, OpHash>
+      pooling_fwds("Pooling");
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLPoolingSignature, DNNLPoolingFwd, OpHash>
-      pooling_fwds;
+  static MX_THREAD_LOCAL DNNLPrimitiveCache<DNNLPoolingSignature, DNNLPoolingFwd, OpHash>
+      pooling_fwds("Pooling");
 #endif
 
   const bool with_workspace = is_train && DNNLRequireWorkspace(param);
@@ -339,10 +340,11 @@ DNNLPoolingBwd& GetPoolingBwd(const PoolingParam& param,
                               const NDArray& out_grad,
                               const bool use_adaptive_pooling) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLPoolingSignature, DNNLPoolingBwd, OpHash> pooling_bwds;
+  static thread_local DNNLPrimitiveCache<DNNLPoolingSignature, DNNLPoolingBwd, OpHash>
+      pooling_bwds("Pooling backward");
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLPoolingSignature, DNNLPoolingBwd, OpHash>
-      pooling_bwds;
+  static MX_THREAD_LOCAL DNNLPrimitiveCache<DNNLPoolingSignature, DNNLPoolingBwd, OpHash>
+      pooling_bwds("Pooling backward");
 #endif
 
   const bool with_workspace = DNNLRequireWorkspace(param);
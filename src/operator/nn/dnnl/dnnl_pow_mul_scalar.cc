@@ -34,11 +34,11 @@ DNNLPowMulScalarFwd& DNNLPowMulScalarFwd::GetCached(const DNNLPowMulScalarParam&
                                                     const NDArray& input,
                                                     const NDArray& output) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLPowMulScalarSignature, DNNLPowMulScalarFwd, OpHash>
-      fwds;
+  static thread_local DNNLPrimitiveCache<DNNLPowMulScalarSignature, DNNLPowMulScalarFwd, OpHash>
+      fwds("Scalar");
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLPowMulScalarSignature, DNNLPowMulScalarFwd, OpHash>
-      fwds;
+  static MX_THREAD_LOCAL DNNLPrimitiveCache<DNNLPowMulScalarSignature, DNNLPowMulScalarFwd, OpHash>
+      fwds("Scalar");
 #endif
   DNNLPowMulScalarSignature key(param);
   key.AddSign(input);
@@ -35,6 +35,7 @@ namespace op {
 using reduce_fwd_t    = dnnl::reduction;
 using reduce_fwd_pd_t = dnnl::reduction::primitive_desc;
 struct NumpyReduceAxesParam;
+struct NumpyReduceAxesNoDTypeParam;
 struct ReduceAxesParam;
 class DNNLReduceFwd {
  public:
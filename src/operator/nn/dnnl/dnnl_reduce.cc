@@ -24,6 +24,8 @@
 
 #if MXNET_USE_ONEDNN == 1
 
+#include <algorithm>
+
 #include "./dnnl_reduce-inl.h"
 #include "../../numpy/np_broadcast_reduce_op.h"
 
@@ -61,6 +63,19 @@ NumpyReduceAxesParam ConvertReduceParamsToNumpy<ReduceAxesParam>(
   return numpy_param;
 }
 
+template <>
+NumpyReduceAxesParam ConvertReduceParamsToNumpy<NumpyReduceAxesNoDTypeParam>(
+    const NumpyReduceAxesNoDTypeParam& original_param,
+    const NDArray& input,
+    const NDArray& output) {
+  NumpyReduceAxesParam numpy_param;
+  numpy_param.axis     = original_param.axis;
+  numpy_param.keepdims = original_param.keepdims;
+  numpy_param.initial  = original_param.initial;
+  numpy_param.dtype    = dmlc::optional<int>(output.dtype());
+  return numpy_param;
+}
+
 template <>
 NumpyReduceAxesParam ConvertReduceParamsToNumpy<NumpyReduceAxesParam>(
     const NumpyReduceAxesParam& original_param,
@@ -83,35 +98,98 @@ mxnet::Tuple<int> CanonicalizeAndSortAxes(const NDArray& input,
   return axes;
 }
 
+// Marks the axes of `input` that `param` reduces; all of them for a global reduction.
+static std::vector<bool> GetReducedAxes(const NumpyReduceAxesParam& param, const NDArray& input) {
+  const int in_ndim = input.shape().ndim();
+  std::vector<bool> reduced(in_ndim, !param.axis.has_value());
+  if (param.axis.has_value()) {
+    for (const int axis : CanonicalizeAndSortAxes(input, param, param.axis.value()))
+      reduced[axis] = true;
+  }
+  return reduced;
+}
+
+// Folds every run of adjacent axes that are all reduced or all kept into a single axis and
+// drops axes of size 1, so that oneDNN gets the smallest equivalent problem. E.g. axes (1, 2)
+// of a (N, H, W) tensor become axis 1 of a (N, H * W) tensor. Only valid for plain layouts.
+static void CompactReduceShape(const mxnet::TShape& shape,
+                               const std::vector<bool>& reduced,
+                               mxnet::TShape* new_ishape,
+                               mxnet::TShape* new_oshape,
+                               std::vector<bool>* new_reduced) {
+  std::vector<dim_t> in_dims, out_dims;
+  new_reduced->clear();
+  for (int i = 0; i < shape.ndim(); ++i) {
+    if (shape[i] == 1)
+      continue;
+    if (new_reduced->empty() || new_reduced->back() != reduced[i]) {
+      in_dims.push_back(1);
+      out_dims.push_back(1);
+      new_reduced->push_back(reduced[i]);
+    }
+    in_dims.back() *= shape[i];
+    out_dims.back() *= reduced[i] ? 1 : shape[i];
+  }
+  if (in_dims.empty()) {
+    in_dims.push_back(1);
+    out_dims.push_back(1);
+    new_reduced->push_back(true);
+  }
+  *new_ishape = mxnet::TShape(in_dims.begin(), in_dims.end());
+  *new_oshape = mxnet::TShape(out_dims.begin(), out_dims.end());
+}
+
+// oneDNN only has optimized kernels for reductions over the innermost axes. Other layouts
+// run on its reference implementation, which is slower than the native broadcast_reduce
+// kernels.
+static bool IsTrailingReduction(const std::vector<bool>& reduced) {
+  const auto first_reduced = std::find(reduced.begin(), reduced.end(), true);
+  return first_reduced != reduced.end() &&
+         std::all_of(first_reduced, reduced.end(), [](bool r) { return r; });
+}
+
+// Whether the plain-layout tensors can be reshaped to the folded problem before execution.
+static bool CanCompactReduce(const NDArray& input, const NDArray& output) {
+  return !input.IsDNNLData() && !output.IsDNNLData();
+}
+
 // Support for https://oneapi-src.github.io/oneDNN/v2.6/dev_guide_reduction.html
+// The native kernels are used when:
+//  - the input or output is not fp32/bf16 or has more than 12 dimensions,
+//  - `initial` is set or `axis = ()` (identity), or the input has a single element,
+//  - after folding adjacent axes and dropping axes of size 1, some kept axis is inner to a
+//    reduced one, e.g. reducing axis 0 of a (N, C) tensor,
+//  - the input is in a oneDNN blocked layout and one of the reduced axes has size 1.
 bool SupportDNNLReduceImpl(const NumpyReduceAxesParam& param,
                            const NDArray& input,
                            const NDArray& output) {
-  bool param_supported = true;
-  if (param.axis.has_value()) {
-    auto axes    = CanonicalizeAndSortAxes(input, param, param.axis.value());
-    int last_dim = *(axes.end() - 1);
-    if (last_dim != input.shape().ndim() - 1) {
-      // oneDNN (v2.3.2) not optimized case
-      return false;
-    } else {
-      for (int i = 0; i < axes.ndim(); i++) {
-        // oneDNN doesnt support reduction of axes with dimension 1
-        // use oneDNN implementation only when dealing with consecutive trailing dimensions
-        if (input.shape()[axes[i]] == 1 || (last_dim - axes[i]) != (axes.ndim() - 1 - i)) {
-          return false;
-        }
-      }
-    }
-
-    // if `axis = ()` it is identity op and it is not supported by oneDNN
-    param_supported = param.axis.value().ndim() > 0;
-  }
+  if (!SupportDNNL<DNNLTypeMode::FloatTypes>(input) ||
+      !SupportDNNLType<DNNLTypeMode::FloatTypes>(output.dtype()))
+    return false;
   // initial value not supported by oneDNN
-  param_supported = param_supported && !param.initial.has_value();
+  if (param.initial.has_value())
+    return false;
+  // if `axis = ()` it is identity op and it is not supported by oneDNN
+  if (param.axis.has_value() && param.axis.value().ndim() == 0)
+    return false;
   // oneDNN does not support reduction of tensors with size equal to 1
-  return param_supported && input.shape().Size() > 1 &&
-         SupportDNNL<DNNLTypeMode::FloatTypes>(input);
+  if (input.shape().Size() <= 1)
+    return false;
+
+  const std::vector<bool> reduced = GetReducedAxes(param, input);
+  if (CanCompactReduce(input, output)) {
+    mxnet::TShape new_ishape, new_oshape;
+    std::vector<bool> new_reduced;
+    CompactReduceShape(input.shape(), reduced, &new_ishape, &new_oshape, &new_reduced);
+    return IsTrailingReduction(new_reduced);
+  }
+  // blocked layouts cannot be reshaped, so the reduction runs on the original axes
+  for (int i = 0; i < input.shape().ndim(); i++) {
+    // oneDNN doesnt support reduction of axes with dimension 1
+    if (reduced[i] && input.shape()[i] == 1)
+      return false;
+  }
+  return IsTrailingReduction(reduced);
 }
 
 void DNNLReduceForwardImpl(const NumpyReduceAxesParam& param,
@@ -125,9 +203,21 @@ void DNNLReduceForwardImpl(const NumpyReduceAxesParam& param,
   CHECK_NE(req, kAddTo);
 
   const bool is_train = ctx.is_train;
-  const auto tensors  = DNNLReduceFwd::Tensors(in_data, out_data);
-  const auto fwd      = DNNLReduceFwd::GetCached(param, tensors, is_train, reduction_alg);
-  fwd.Execute(tensors);
+  if (CanCompactReduce(in_data, out_data)) {
+    mxnet::TShape new_ishape, new_oshape;
+    std::vector<bool> new_reduced;
+    CompactReduceShape(
+        in_data.shape(), GetReducedAxes(param, in_data), &new_ishape, &new_oshape, &new_reduced);
+    const NDArray data = in_data.Reshape(new_ishape);
+    const NDArray out  = out_data.Reshape(new_oshape);
+    const auto tensors = DNNLReduceFwd::Tensors(data, out);
+    const auto fwd     = DNNLReduceFwd::GetCached(param, tensors, is_train, reduction_alg);
+    fwd.Execute(tensors);
+  } else {
+    const auto tensors = DNNLReduceFwd::Tensors(in_data, out_data);
+    const auto fwd     = DNNLReduceFwd::GetCached(param, tensors, is_train, reduction_alg);
+    fwd.Execute(tensors);
+  }
 }
 
 DNNLReduceFwd::Tensors::Tensors(const NDArray& data, const NDArray& output)
@@ -139,9 +229,10 @@ DNNLReduceFwd DNNLReduceFwd::GetCached(const NumpyReduceAxesParam& param,
                                        const bool is_train,
                                        const dnnl::algorithm reduction_alg) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLReduceSignature, DNNLReduceFwd, OpHash> fwds;
+  static thread_local DNNLPrimitiveCache<DNNLReduceSignature, DNNLReduceFwd, OpHash> fwds("Reduce");
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLReduceSignature, DNNLReduceFwd, OpHash> fwds;
+  static MX_THREAD_LOCAL DNNLPrimitiveCache<DNNLReduceSignature, DNNLReduceFwd, OpHash>
+      fwds("Reduce");
 #endif
 
   DNNLReduceSignature key(param);
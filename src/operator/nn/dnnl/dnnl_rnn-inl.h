@@ -559,8 +559,10 @@ class DNNLRnnOp {
 };
 
 // Support for https://oneapi-src.github.io/oneDNN/v2.6/dev_guide_rnn.html
+// bfloat16 is supported for inference only.
 inline bool SupportDNNLRnn(const int input_dtype) {
-  if (input_dtype == mshadow::kFloat32 && dmlc::GetEnv("MXNET_USE_ONEDNN_RNN", 1)) {
+  if ((input_dtype == mshadow::kFloat32 || input_dtype == mshadow::kBfloat16) &&
+      dmlc::GetEnv("MXNET_USE_ONEDNN_RNN", 1)) {
     return true;
   }
   return false;
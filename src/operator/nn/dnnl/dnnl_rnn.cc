@@ -205,14 +205,16 @@ RnnPrimitive GetRnnFwdPrim(const DNNLRnnLayerParam& layer_param,
   using namespace dnnl;
   using tag                         = dnnl::memory::format_tag;
   const int mode                    = layer_param.mode;
+  // the states of the int8 RNN stay in float32, the ones of the bfloat16 RNN are in bfloat16
+  const int float_dtype             = layer_param.quantized ? mshadow::kFloat32 : data.dtype();
   memory::data_type src_layer_dtype = get_dnnl_type(data.dtype());
-  memory::data_type iter_dtype      = get_dnnl_type(mshadow::kFloat32);
+  memory::data_type iter_dtype      = get_dnnl_type(float_dtype);
   memory::data_type weight_dtype =
       get_dnnl_type(layer_param.quantized ? mshadow::kInt8 : params.dtype());
   memory::data_type bias_dtype = get_dnnl_type(mshadow::kFloat32);
   memory::data_type dst_layer_dtype =
       get_dnnl_type((layer_param.quantized && layer_param.enable_u8_output) ? mshadow::kUint8 :
-                                                                              mshadow::kFloat32);
+                                                                              float_dtype);
 
   const prop_kind prop = is_train ? prop_kind::forward_training : prop_kind::forward_inference;
   const rnn_direction dnnl_rnn_direction = layer_param.bidirectional ?
@@ -511,9 +513,11 @@ void DNNLRnnForward::SetNewDataMem(void* x,
 
 inline void DNNLMemoryReorder(const dnnl::memory& src, const dnnl::memory& dst) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<OpSignature, dnnl::reorder, OpHash> reorderPrimitives;
+  static thread_local DNNLPrimitiveCache<OpSignature, dnnl::reorder, OpHash>
+      reorderPrimitives("RNN reorder");
 #else
-  static MX_THREAD_LOCAL std::unordered_map<OpSignature, dnnl::reorder, OpHash> reorderPrimitives;
+  static MX_THREAD_LOCAL DNNLPrimitiveCache<OpSignature, dnnl::reorder, OpHash>
+      reorderPrimitives("RNN reorder");
 #endif
   OpSignature key{};
   key.AddSign(src);
@@ -570,10 +574,11 @@ void AdjustGruGateOrder(char* weight,
 }
 
 /*
- * Fuse uni-directional bias among single layer.
+ * Fuse uni-directional bias among single layer. The fused bias is in float32 whatever the type
+ * of the native one, as the oneDNN RNN primitives expect.
  */
 template <typename DType>
-void FuseBias(DType* fuse_bias, DType* native_bias, const int mode, const size_t state_size) {
+void FuseBias(float* fuse_bias, DType* native_bias, const int mode, const size_t state_size) {
   const size_t ngates   = GetRnnGatesNum(mode);
   const int omp_threads = mxnet::engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
   const size_t nbias    = mode == rnn_enum::kGru ? ngates + 1 : ngates;
@@ -590,18 +595,19 @@ void FuseBias(DType* fuse_bias, DType* native_bias, const int mode, const size_t
 #pragma omp parallel for num_threads(omp_threads)
     for (int j = 0; j < state_size_; j++) {
       // Swap summed reset, update bias
-      fuse_bias[j + state_size] = bx[j] + bh[j];
-      fuse_bias[j]              = bx[j + state_size] + bh[j + state_size];
+      fuse_bias[j + state_size] = static_cast<float>(bx[j]) + static_cast<float>(bh[j]);
+      fuse_bias[j] =
+          static_cast<float>(bx[j + state_size]) + static_cast<float>(bh[j + state_size]);
 
       // Memcpy two new gates
-      fuse_bias[j + 2 * state_size] = bx[j + 2 * state_size];
-      fuse_bias[j + 3 * state_size] = bh[j + 2 * state_size];
+      fuse_bias[j + 2 * state_size] = static_cast<float>(bx[j + 2 * state_size]);
+      fuse_bias[j + 3 * state_size] = static_cast<float>(bh[j + 2 * state_size]);
     }
   } else {
 #pragma omp parallel for num_threads(omp_threads)
     for (int j = 0; j < single_b_sz; ++j) {
       // Sum two bias
-      fuse_bias[j] = bx[j] + bh[j];
+      fuse_bias[j] = static_cast<float>(bx[j]) + static_cast<float>(bh[j]);
     }
   }
 }
@@ -635,10 +641,12 @@ void DNNLRnnForward::SetWeightsMem(void* w_ptr, void* b_ptr, const bool is_train
   const size_t buffer_bytes =
       this->GetSize()  // byte number of the buffer
       + (param_.workspace_size + param_.reserve_size) * dtype_bytes +
-      kDNNLAlign * 7;  // Add margin for alignment of seven times allocation for the
-                       // dnnl memory handlers, i.e. weights_layer_, weights_iter_,
-                       // weights_proj_, bias_, weights_layer_r_, weights_iter_r_,
-                       // and weights_proj_r_.
+      param_.single_b_size * param_.num_layer * (param_.bidirectional + 1) *
+          sizeof(float) +  // the fused bias is in float32
+      kDNNLAlign * 7;      // Add margin for alignment of seven times allocation for the
+                           // dnnl memory handlers, i.e. weights_layer_, weights_iter_,
+                           // weights_proj_, bias_, weights_layer_r_, weights_iter_r_,
+                           // and weights_proj_r_.
   if (mem_mgr_.Size() < buffer_bytes)
     mem_mgr_.Init(buffer_bytes, this->ctx_);
 
@@ -654,7 +662,7 @@ void DNNLRnnForward::SetWeightsMem(void* w_ptr, void* b_ptr, const bool is_train
     weights_proj_ = mem_mgr_.Alloc(fwd_inf_.GetProjDesc());
   }
   if (bias_ == nullptr) {
-    bias_ = mem_mgr_.Alloc({param_.bias_dims, dnnl_dtype, format_tag::ldgo});
+    bias_ = mem_mgr_.Alloc({param_.bias_dims, dnnl::memory::data_type::f32, format_tag::ldgo});
   }
 
   // Get the intermediate memory for weights concat & reorder
@@ -734,9 +742,9 @@ void DNNLRnnForward::SetWeightsMem(void* w_ptr, void* b_ptr, const bool is_train
   }
 
   // Process bias
-  MSHADOW_REAL_TYPE_SWITCH(dtype, DType, {
+  DNNL_REAL_TYPE_SWITCH(dtype, DType, {
     DType* native_b_ptr = static_cast<DType*>(b_ptr);
-    DType* fused_bias   = static_cast<DType*>(bias_->get_data_handle());
+    float* fused_bias   = static_cast<float*>(bias_->get_data_handle());
     for (int lyr = 0; lyr < param_.num_layer; ++lyr) {
       for (int d = 0; d < param_.bidirectional + 1; ++d) {
         FuseBias<DType>(fused_bias, native_b_ptr, param_.mode, param_.state_size);
@@ -1151,6 +1159,8 @@ void DNNLRnnOp::Forward(const OpContext& ctx,
   const RNNParam& default_param = full_param_.default_param;
   if (is_training && default_param.projection_size.has_value())
     LOG(FATAL) << "Backward/Training mode is not implemented!";
+  CHECK(!is_training || inputs[rnn_enum::kData].dtype() != mshadow::kBfloat16)
+      << "oneDNN RNN only supports bfloat16 for inference";
 
   // Initialize weights version
   if (!initialized_ && weights_version_ == 0) {
@@ -67,9 +67,11 @@ DNNLSoftmaxFwd& DNNLSoftmaxFwd::GetCached(const SoftmaxParam& param,
                                           const Tensors& tensors,
                                           const bool is_train) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLSoftmaxSignature, DNNLSoftmaxFwd, OpHash> fwds;
+  static thread_local DNNLPrimitiveCache<DNNLSoftmaxSignature, DNNLSoftmaxFwd, OpHash>
+      fwds("softmax");
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLSoftmaxSignature, DNNLSoftmaxFwd, OpHash> fwds;
+  static MX_THREAD_LOCAL DNNLPrimitiveCache<DNNLSoftmaxSignature, DNNLSoftmaxFwd, OpHash>
+      fwds("softmax");
 #endif
 
   DNNLSoftmaxSignature key(param);
@@ -188,9 +190,11 @@ DNNLSoftmaxBwd::Tensors::Tensors(const std::vector<NDArray>& inputs,
 
 DNNLSoftmaxBwd& DNNLSoftmaxBwd::GetCached(const SoftmaxParam& param, const Tensors& tensors) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLSoftmaxSignature, DNNLSoftmaxBwd, OpHash> bwds;
+  static thread_local DNNLPrimitiveCache<DNNLSoftmaxSignature, DNNLSoftmaxBwd, OpHash>
+      bwds("softmax backward");
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLSoftmaxSignature, DNNLSoftmaxBwd, OpHash> bwds;
+  static MX_THREAD_LOCAL DNNLPrimitiveCache<DNNLSoftmaxSignature, DNNLSoftmaxBwd, OpHash>
+      bwds("softmax backward");
 #endif
 
   const float temperature = param.temperature.has_value() ? param.temperature.value() : 1.0f;
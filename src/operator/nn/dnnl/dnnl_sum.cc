@@ -37,9 +37,9 @@ namespace op {
 DNNLSumFwd& DNNLSumFwd::GetCached(const std::vector<NDArray>& inputs,
                                   const std::vector<NDArray>& outputs) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLSumSignature, DNNLSumFwd, OpHash> fwds;
+  static thread_local DNNLPrimitiveCache<DNNLSumSignature, DNNLSumFwd, OpHash> fwds("Sum");
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLSumSignature, DNNLSumFwd, OpHash> fwds;
+  static MX_THREAD_LOCAL DNNLPrimitiveCache<DNNLSumSignature, DNNLSumFwd, OpHash> fwds("Sum");
 #endif
   DNNLSumSignature key;
   key.AddSign(inputs);
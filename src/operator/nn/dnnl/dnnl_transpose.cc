@@ -96,9 +96,11 @@ void DNNLTransposeFwd::Execute() const {
 
 DNNLTransposeFwd& GetTransposeForward(const NumpyTransposeParam& param, const NDArray& data) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLTransposeSignature, DNNLTransposeFwd, OpHash> fwds;
+  static thread_local DNNLPrimitiveCache<DNNLTransposeSignature, DNNLTransposeFwd, OpHash>
+      fwds("transpose");
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLTransposeSignature, DNNLTransposeFwd, OpHash> fwds;
+  static MX_THREAD_LOCAL DNNLPrimitiveCache<DNNLTransposeSignature, DNNLTransposeFwd, OpHash>
+      fwds("transpose");
 #endif
   DNNLTransposeSignature key(param);
   key.AddSign(data);
@@ -61,11 +61,11 @@ DNNLWhereFwd::Tensors::Tensors(const std::vector<NDArray>& inputs,
     : condition(inputs[0]), left(inputs[1]), right(inputs[2]), output(outputs[0]) {}
 
 DNNLWhereFwd DNNLWhereFwd::GetCached(const Tensors& tensors) {
-  using where_op_fwd_map = std::unordered_map<OpSignature, DNNLWhereFwd, OpHash>;
+  using where_op_fwd_map = DNNLPrimitiveCache<OpSignature, DNNLWhereFwd, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local where_op_fwd_map fwds;
+  static thread_local where_op_fwd_map fwds("where");
 #else
-  static MX_THREAD_LOCAL where_op_fwd_map fwds;
+  static MX_THREAD_LOCAL where_op_fwd_map fwds("where");
 #endif
 
   OpSignature key;
@@ -33,6 +33,7 @@
 #include <string>
 #include <utility>
 #include <algorithm>
+#include <type_traits>
 #include "../mxnet_op.h"
 #include "../mshadow_op.h"
 #include "../random/sampler.h"
@@ -63,6 +64,14 @@ namespace op {
 
 const int MAX_DIM = 5;
 
+/*!
+ * \brief Number of bytes of the mask of an element-wise dropout of size elements: one bit per
+ *        element, rounded up to 16 bytes like the reserve space of the cuDNN dropout.
+ */
+inline index_t DropoutBitMaskBytes(const index_t size) {
+  return (size + 127) / 128 * 16;
+}
+
 struct DropoutParam : public dmlc::Parameter<DropoutParam> {
   float p;
   int mode;
@@ -137,57 +146,32 @@ class DropoutOp {
       }
     }
   }
-  static inline bool MKLAvailable() {
-    // BernoulliGenerate expects an array int, so for types smaller than int, the mask buffer
-    // will be too small, so we can;t use MKL in those cases
-    return sizeof(DType) >= sizeof(int);
-  }
-
-  // MKL forward pass
+  // MKL forward pass, the Bernoulli draws go through a temporary buffer before being packed
   inline void MKLForward(const OpContext& ctx,
-                         const std::vector<TBlob>& in_data,
-                         const std::vector<TBlob>& out_data) {
+                         const TBlob& in,
+                         const TBlob& mask,
+                         const TBlob& out) {
     Stream<xpu>* s                  = ctx.get_stream<xpu>();
     RandGenerator<xpu, DType>* pgen = ctx.requested[0].get_parallel_random<xpu, DType>();
     CHECK_NOTNULL(pgen);
-    Tensor<xpu, 2, DType> mask = out_data[dropout::kMask].FlatTo2D<xpu, DType>(s);
-    Tensor<xpu, 2, DType> data = in_data[dropout::kData].FlatTo2D<xpu, DType>(s);
-    Tensor<xpu, 2, DType> out  = out_data[dropout::kOut].FlatTo2D<xpu, DType>(s);
-    DType* outptr              = out.dptr_;
-    DType* dataptr             = data.dptr_;
-    auto maskptr               = reinterpret_cast<int*>(mask.dptr_);
-    int count                  = mask.shape_[0] * mask.shape_[1];
-    if (sizeof(DType) > sizeof(int)) {
-      // allocating new buffer to avoiding memory overlapping between `mask.dptr_` and `maskptr`
-      Tensor<xpu, 1, int> temp = ctx.requested[1].get_space_typed<xpu, 1, int>(Shape1(count), s);
-      maskptr                  = temp.dptr_;
-    }
-    BernoulliGenerate(*pgen, count, this->pkeep_, maskptr);
+    const int count          = out.Size();
+    Tensor<xpu, 1, int> temp = ctx.requested[1].get_space_typed<xpu, 1, int>(Shape1(count), s);
+    const int* maskptr       = temp.dptr_;
+    const DType* dataptr     = in.dptr<DType>();
+    DType* outptr            = out.dptr<DType>();
+    uint8_t* bitptr          = mask.dptr<uint8_t>();
+    BernoulliGenerate(*pgen, count, this->pkeep_, temp.dptr_);
     const float pk_1 = 1.0f / this->pkeep_;
+    const int nbytes = (count + 7) / 8;
 #pragma omp parallel for num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
-    for (int i = 0; i < count; ++i) {
-      const DType maskVal = static_cast<DType>(maskptr[i]) * pk_1;
-      outptr[i]           = dataptr[i] * maskVal;
-      mask.dptr_[i]       = maskVal;
-    }
-  }
-
-  // MKL backward pass
-  inline void MKLBackward(const OpContext& ctx,
-                          const std::vector<TBlob>& in_grad,
-                          const std::vector<TBlob>& out_data,
-                          const std::vector<TBlob>& out_grad) {
-    Stream<xpu>* s              = ctx.get_stream<xpu>();
-    Tensor<xpu, 2, DType> grad  = out_grad[dropout::kOut].FlatTo2D<xpu, DType>(s);
-    Tensor<xpu, 2, DType> mask  = out_data[dropout::kMask].FlatTo2D<xpu, DType>(s);
-    Tensor<xpu, 2, DType> gdata = in_grad[dropout::kData].FlatTo2D<xpu, DType>(s);
-    DType* ingradptr            = gdata.dptr_;
-    const DType* outgradptr     = grad.dptr_;
-    const DType* maskptr        = mask.dptr_;
-    const int count             = mask.shape_[0] * mask.shape_[1];
-#pragma omp parallel for num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
-    for (int i = 0; i < count; ++i) {
-      ingradptr[i] = outgradptr[i] * maskptr[i];
+    for (int b = 0; b < nbytes; ++b) {
+      const int end = std::min(b * 8 + 8, count);
+      uint8_t bits  = 0;
+      for (int i = b * 8; i < end; ++i) {
+        outptr[i] = dataptr[i] * static_cast<DType>(maskptr[i] * pk_1);
+        bits |= static_cast<uint8_t>(maskptr[i] << (i - b * 8));
+      }
+      bitptr[b] = bits;
     }
   }
 
@@ -195,18 +179,19 @@ class DropoutOp {
 
  public:
   /*!
-   * \brief Dropout kernel, compute dropout tensor
+   * \brief Dropout kernel, compute dropout tensor and its bit mask
    */
   struct DropoutKernel {
     /*!
-     * \brief Dropout kernel function
+     * \brief Dropout kernel function, one byte of the mask per iteration
      * \param id Thread number (0-based representing count)
      * \param gen Random number generator
-     * \param N Total number of items in the output
-     * \param step Step between items, related to parallelism
+     * \param N Total number of bytes in the mask
+     * \param step Step between bytes, related to parallelism
      * \param dropout_out Output dropout values
-     * \param mask_out  Output mask (is multiplied to create dropout output, may be 0)
+     * \param mask_out Output mask, bit k of byte i is set when element 8 * i + k is kept
      * \param input_data Input data to perform the dropout on
+     * \param size Total number of items in the output
      * \param pkeep Dropout rate (keep when the generated random number is less than this value)
      */
     MSHADOW_XINLINE static void Map(index_t id,
@@ -214,16 +199,38 @@ class DropoutOp {
                                     const index_t N,
                                     const index_t step,
                                     DType* dropout_out,
-                                    DType* mask_out,
+                                    uint8_t* mask_out,
                                     const DType* input_data,
+                                    const index_t size,
                                     const real_t pkeep) {
       RNG_KERNEL_LOOP(xpu, DType, id, gen, N, step, {
-        const real_t rand_num = static_cast<real_t>(genImpl.uniform());
-        mask_out[i]    = mshadow_op::threshold_eq::Map<real_t>(rand_num, pkeep) * (1.0f / pkeep);
-        dropout_out[i] = input_data[i] * mask_out[i];
+        const index_t begin = i * 8;
+        const index_t end   = begin + 8 < size ? begin + 8 : size;
+        uint8_t bits        = 0;
+        for (index_t j = begin; j < end; ++j) {
+          const real_t rand_num = static_cast<real_t>(genImpl.uniform());
+          const real_t keep     = mshadow_op::threshold_eq::Map<real_t>(rand_num, pkeep);
+          dropout_out[j]        = input_data[j] * static_cast<DType>(keep * (1.0f / pkeep));
+          bits |= static_cast<uint8_t>(keep) << (j - begin);
+        }
+        mask_out[i] = bits;
       });
     }
   };
+  /*!
+   * \brief Dropout backward with the bit mask
+   */
+  struct DropoutGradKernel {
+    MSHADOW_XINLINE static void Map(index_t i,
+                                    DType* in_grad,
+                                    const DType* out_grad,
+                                    const uint8_t* mask,
+                                    const real_t pkeep,
+                                    const OpReqType req) {
+      const real_t keep = (mask[i >> 3] >> (i & 7)) & 1;
+      KERNEL_ASSIGN(in_grad[i], req, out_grad[i] * static_cast<DType>(keep * (1.0f / pkeep)));
+    }
+  };
   struct BernoulliKernel {
     /*! \brief Bernoulli kernel for generating mask */
     MSHADOW_XINLINE static void Map(index_t id,
@@ -239,6 +246,67 @@ class DropoutOp {
     }
   };
 
+  /*!
+   * \brief Element-wise dropout writing the bit mask. On CPU the bits come from a Philox stream
+   *        seeded by the parallel generator, generated for 16 counters at a time so that the
+   *        rounds vectorize; the state-based generators would serialize every element.
+   */
+  inline void BitMaskForward(const OpContext& ctx,
+                             const TBlob& in,
+                             const TBlob& mask,
+                             const TBlob& out) {
+    Stream<xpu>* s                  = ctx.get_stream<xpu>();
+    RandGenerator<xpu, DType>* pgen = ctx.requested[0].get_parallel_random<xpu, DType>();
+    CHECK_NOTNULL(pgen);
+    const index_t size = out.Size();
+    if constexpr (std::is_same<xpu, cpu>::value) {
+      typename RandGenerator<cpu, DType>::Impl genImpl(pgen, 0);
+      const uint32_t key_lo    = static_cast<uint32_t>(genImpl.rand());
+      const uint32_t key_hi    = static_cast<uint32_t>(genImpl.rand());
+      const uint32_t key[2]    = {key_lo, key_hi};
+      const double threshold   = std::min(this->pkeep_ * 4294967296.0, 4294967295.0);
+      const uint32_t keep_bits = static_cast<uint32_t>(threshold);
+      const DType scale        = static_cast<DType>(1.0f / this->pkeep_);
+      // 0 * (1 / pkeep) like the mask values of the other paths, NaN when p = 1
+      const DType dropped      = static_cast<DType>(0.0f * (1.0f / this->pkeep_));
+      const DType* dataptr     = in.dptr<DType>();
+      DType* outptr            = out.dptr<DType>();
+      uint8_t* bitptr          = mask.dptr<uint8_t>();
+      const index_t nblocks    = (size + 63) / 64;
+#pragma omp parallel for num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
+      for (index_t b = 0; b < nblocks; ++b) {
+        uint32_t rand_bits[64];
+#pragma omp simd
+        for (int l = 0; l < 16; ++l) {
+          const uint64_t ctr        = static_cast<uint64_t>(b) * 16 + l;
+          const uint32_t counter[4] = {
+              static_cast<uint32_t>(ctr), static_cast<uint32_t>(ctr >> 32), 0, 0};
+          common::random::Philox4x32_10(counter, key, rand_bits + 4 * l);
+        }
+        const index_t begin = b * 64;
+        const int n         = static_cast<int>(std::min<index_t>(64, size - begin));
+        uint64_t bits       = 0;
+        for (int k = 0; k < n; ++k) {
+          const bool keep   = rand_bits[k] < keep_bits;
+          outptr[begin + k] = dataptr[begin + k] * (keep ? scale : dropped);
+          bits |= static_cast<uint64_t>(keep) << k;
+        }
+        for (int byte = 0; byte * 8 < n; ++byte) {
+          bitptr[b * 8 + byte] = static_cast<uint8_t>(bits >> (8 * byte));
+        }
+      }
+    } else {
+      LaunchRNG<DropoutKernel, xpu>(s,
+                                    pgen,
+                                    (size + 7) / 8,
+                                    out.dptr<DType>(),
+                                    mask.dptr<uint8_t>(),
+                                    in.dptr<DType>(),
+                                    size,
+                                    this->pkeep_);
+    }
+  }
+
   explicit DropoutOp(const DropoutParam& param, Context ctx) {
     this->pkeep_               = 1.0f - param.p;
     this->mode_                = static_cast<dropout::DropoutOpMode>(param.mode);
@@ -301,7 +369,7 @@ class DropoutOp {
     CUDNN_CALL(cudnnDropoutGetReserveSpaceSize(x_desc_, &dropout_reserve_byte_));
     // cudnn uses bits to record the positions that are dropped, so reserve bytes is always
     // 1/8 of input size.
-    CHECK_GE(mask.Size() * sizeof(DType), dropout_reserve_byte_)
+    CHECK_GE(mask.Size(), dropout_reserve_byte_)
         << "The size of the mask space is smaller than the required cudnn reserved space.";
     CUDNN_CALL(cudnnDropoutForward(s->dnn_handle_,
                                    dropout_desc_,
@@ -309,7 +377,7 @@ class DropoutOp {
                                    in.dptr<DType>(),
                                    y_desc_,
                                    out.dptr<DType>(),
-                                   mask.dptr<DType>(),
+                                   mask.dptr<uint8_t>(),
                                    dropout_reserve_byte_));
   }
 
@@ -339,7 +407,7 @@ class DropoutOp {
                                     out_grad.dptr<DType>(),
                                     dx_desc_,
                                     in_grad.dptr<DType>(),
-                                    mask.dptr<DType>(),
+                                    mask.dptr<uint8_t>(),
                                     dropout_reserve_byte_));
   }
 #endif  // MXNET_USE_CUDNN_DROPOUT && defined(__CUDACC__)
@@ -362,10 +430,8 @@ class DropoutOp {
         this->dropout_passthrough_ = false;
         if (this->axes_.ndim() == 0) {
 #if MXNET_USE_MKL_DROPOUT
-          if (MKLAvailable()) {
-            MKLForward(ctx, in_data, out_data);
-            return;
-          }
+          MKLForward(ctx, in, mask, out);
+          return;
 #endif  // MXNET_USE_MKL_DROPOUT
 #if MXNET_USE_CUDNN_DROPOUT && defined(__CUDACC__)
           if (CuDNNAvailable()) {
@@ -373,16 +439,8 @@ class DropoutOp {
             return;
           }
 #endif  // MXNET_USE_CUDNN_DROPOUT && defined(__CUDACC__)
-          RandGenerator<xpu, DType>* pgen = ctx.requested[0].get_parallel_random<xpu, DType>();
-          CHECK_NOTNULL(pgen);
           CHECK(req[dropout::kOut] != kAddTo);
-          LaunchRNG<DropoutKernel, xpu>(s,
-                                        pgen,
-                                        out.Size(),
-                                        out.dptr<DType>(),
-                                        mask.dptr<DType>(),
-                                        in.dptr<DType>(),
-                                        this->pkeep_);
+          BitMaskForward(ctx, in, mask, out);
           return;
         } else {
           RandGenerator<xpu, DType>* pgen = ctx.requested[0].get_parallel_random<xpu, DType>();
@@ -441,12 +499,6 @@ class DropoutOp {
       const TBlob& grad          = out_grad[dropout::kOut];
       const TBlob& mask          = out_data[dropout::kMask];
       if (this->axes_.ndim() == 0) {
-#if MXNET_USE_MKL_DROPOUT
-        if (MKLAvailable()) {
-          MKLBackward(ctx, in_grad, out_data, out_grad);
-          return;
-        }
-#endif  // MXNET_USE_MKL_DROPOUT
 #if MXNET_USE_CUDNN_DROPOUT && defined(__CUDACC__)
         if (CuDNNAvailable()) {
           CuDNNBackward(ctx, grad, mask, gdata);
@@ -454,11 +506,14 @@ class DropoutOp {
         }
 #endif  // MXNET_USE_CUDNN_DROPOUT && defined(__CUDACC__)
         // standard case for dropout
-        CHECK_EQ(grad.Size(), mask.Size());
-        MXNET_ASSIGN_REQ_SWITCH(req[dropout::kData], Req, {
-          mxnet_op::Kernel<mxnet_op::op_with_req<mshadow_op::mul, Req>, xpu>::Launch(
-              s, gdata.Size(), gdata.dptr<DType>(), grad.dptr<DType>(), mask.dptr<DType>());
-        });
+        CHECK_GE(mask.Size() * 8, grad.Size());
+        mxnet_op::Kernel<DropoutGradKernel, xpu>::Launch(s,
+                                                         gdata.Size(),
+                                                         gdata.dptr<DType>(),
+                                                         grad.dptr<DType>(),
+                                                         mask.dptr<uint8_t>(),
+                                                         this->pkeep_,
+                                                         req[dropout::kData]);
         return;
       } else {
         // broardcast mul
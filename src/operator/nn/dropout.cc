@@ -119,6 +119,15 @@ Example::
                                       return false;
                                     out_shape->clear();
                                     out_shape->push_back(dshape);
+                                    if (param.axes.ndim() == 0) {
+                                      // one bit per element
+                                      const dim_t mask_bytes =
+                                          mxnet::shape_is_known(dshape)
+                                              ? DropoutBitMaskBytes(dshape.Size())
+                                              : -1;
+                                      out_shape->push_back(mxnet::TShape(1, mask_bytes));
+                                      return true;
+                                    }
                                     for (int i = 0; i < param.axes.ndim(); ++i) {
                                       dshape[param.axes[i]] = 1;
                                     }
@@ -137,10 +146,13 @@ Example::
                                     return false;
                                   }
 
-                                  size_t nout = 2;
+                                  const DropoutParam& param =
+                                      nnvm::get<DropoutParam>(attrs.parsed);
                                   out_type->clear();
-                                  for (size_t i = 0; i < nout; ++i)
-                                    out_type->push_back(dtype);
+                                  out_type->push_back(dtype);
+                                  // the mask of the element-wise dropout is packed in bytes
+                                  out_type->push_back(param.axes.ndim() == 0 ? mshadow::kUint8
+                                                                             : dtype);
                                   return true;
                                 })
     .set_attr<FCreateOpState>("FCreateOpState", CreateDropoutState)
@@ -250,6 +250,18 @@ static bool BackwardFCStorageType(const nnvm::NodeAttrs& attrs,
   return dispatched;
 }
 
+static OpCost FullyConnectedCost(const nnvm::NodeAttrs& attrs,
+                                 const std::vector<TBlob>& inputs,
+                                 const std::vector<TBlob>& outputs) {
+  const FullyConnectedParam& param = nnvm::get<FullyConnectedParam>(attrs.parsed);
+  // a multiply-add per element of the output and column of the weight, plus the bias
+  const uint64_t num_out = outputs[fullc::kOut].shape_.Size();
+  OpCost cost;
+  cost.flops = 2 * num_out * inputs[fullc::kWeight].shape_[1] + (param.no_bias ? 0 : num_out);
+  cost.bytes = OpCostBytes(inputs, outputs);
+  return cost;
+}
+
 DMLC_REGISTER_PARAMETER(FullyConnectedParam);
 
 NNVM_REGISTER_OP(FullyConnected)
@@ -317,6 +329,7 @@ If ``no_bias`` is set to be true, then the ``bias`` term is ignored.
     .set_attr<THasDeterministicOutput>("THasDeterministicOutput", true)
     .set_attr<mxnet::FInferShape>("FInferShape", FullyConnectedShape)
     .set_attr<nnvm::FInferType>("FInferType", FullyConnectedType)
+    .set_attr<FOpCost>("FOpCost", FullyConnectedCost)
     .set_attr<FCompute>("FCompute<cpu>", FullyConnectedCompute<cpu>)
     .set_attr<FComputeEx>("FComputeEx<cpu>", FullyConnectedComputeExCPU)
     .set_attr<nnvm::FGradient>("FGradient", FullyConnectedGrad{"_backward_FullyConnected"})
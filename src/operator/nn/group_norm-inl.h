@@ -87,7 +87,6 @@ void GroupNormCompute(const nnvm::NodeAttrs& attrs,
     return;
   CHECK_NE(req[0], kAddTo);
 
-  Stream<xpu>* s                  = ctx.get_stream<xpu>();
   const TBlob& data               = inputs[groupnorm::kData];
   const TBlob& mean               = outputs[groupnorm::kMean];
   const TBlob& std                = outputs[groupnorm::kStd];
@@ -109,43 +108,15 @@ void GroupNormCompute(const nnvm::NodeAttrs& attrs,
     moments_shape[i] = (i < mean.shape_.ndim()) ? mean.shape_[i] : 1;
   }
 
-  mxnet::TShape red_src_shape, red_dst_shape;
-  BroadcastReduceShapeCompact(temp_data_shape, moments_shape, &red_src_shape, &red_dst_shape);
-  int channel_size = red_src_shape.Size() / red_dst_shape.Size();
-
-  TBlob data_        = data.reshape(red_src_shape);
-  const TBlob& mean_ = mean.reshape(red_dst_shape);
-  const TBlob& std_  = std.reshape(red_dst_shape);
-
-  Tensor<xpu, 1, char> workspace;
-
-  size_t workspace_size = broadcast::ReduceWorkspaceSize(s, red_dst_shape, req[0], red_src_shape);
-
-  workspace = ctx.requested[0].get_space_typed<xpu, 1, char>(Shape1(workspace_size), s);
-
-  // Calculate mean
-#if !defined(__CUDACC__)
-  MSHADOW_REAL_TYPE_SWITCH(data.type_flag_, DType, {
-    BROADCAST_NDIM_SWITCH(red_dst_shape.ndim(), NDim, {
-      broadcast::Reduce<mshadow_op::sum, NDim, DType, mshadow_op::identity, true>(
-          s, mean_, req[0], workspace, data_);
-    });
-  });
-#else
-  BROADCAST_NDIM_SWITCH(red_dst_shape.ndim(), NDim, {
-    broadcast::RTCReduce(ctx, mean_, req[0], workspace, data_, "red::sum{}", NDim, "identity");
-  });
-#endif  // !defined(__CUDACC__)
-  MSHADOW_REAL_TYPE_SWITCH(data.type_flag_, DType, {
-    Tensor<xpu, 1, DType> mean_data_tensor = mean_.FlatTo1D<xpu, DType>(s);
-    mean_data_tensor /= scalar<DType>(channel_size);
-  });
-
   TBlob data_grp          = data.reshape(temp_data_shape);
   const TBlob& mean_grp   = mean.reshape(moments_shape);
   const TBlob& std_grp    = std.reshape(moments_shape);
   const TBlob& output_grp = outputs[groupnorm::kOut].reshape(temp_data_shape);
 
+  // Calculate mean and std in one pass over the data
+  WelfordMomentsCompute<xpu>(
+      ctx, data_grp, mean_grp, std_grp, req[0], req[0], 0, param.eps, true);
+
   // Calculate data = data - mean
 #if !defined(__CUDACC__)
   BinaryBroadcastCompute<xpu, op::mshadow_op::minus>(
@@ -159,26 +130,6 @@ void GroupNormCompute(const nnvm::NodeAttrs& attrs,
       {output_grp});
 #endif  // !defined(__CUDACC__)
 
-  // Calculate std
-  const TBlob centered_out = outputs[groupnorm::kOut].reshape(red_src_shape);
-#if !defined(__CUDACC__)
-  MSHADOW_REAL_TYPE_SWITCH(output_grp.type_flag_, DType, {
-    BROADCAST_NDIM_SWITCH(red_dst_shape.ndim(), NDim, {
-      broadcast::Reduce<mshadow_op::sum, NDim, DType, mshadow_op::square, true>(
-          s, std_, req[0], workspace, centered_out);
-    });
-  });
-#else
-  BROADCAST_NDIM_SWITCH(red_dst_shape.ndim(), NDim, {
-    broadcast::RTCReduce(ctx, std_, req[0], workspace, centered_out, "red::sum{}", NDim, "square");
-  });
-#endif
-  MSHADOW_REAL_TYPE_SWITCH(output_grp.type_flag_, DType, {
-    Tensor<xpu, 1, DType> std_data_tensor = std_.FlatTo1D<xpu, DType>(s);
-    std_data_tensor = F<mshadow_op::square_root>(std_data_tensor / scalar<DType>(channel_size) +
-                                                 scalar<DType>(param.eps));
-  });
-
   // Calculate data = data / std
 #if !defined(__CUDACC__)
   BinaryBroadcastCompute<xpu, mshadow_op::div>(
@@ -37,6 +37,7 @@
 #include "../operator_common.h"
 #include "../mxnet_op.h"
 #include "../tensor/broadcast_reduce_op.h"
+#include "./welford-inl.h"
 #include "mxnet/tuple.h"
 
 namespace mxnet {
@@ -106,7 +107,6 @@ void LayerNormComputeGeneral(const nnvm::NodeAttrs& attrs,
   int axis = GetRealAxis(param.axis, inputs[0].ndim());
   CHECK(axis >= 0 && axis < inputs[0].ndim()) << "Channel axis out of range: " << param.axis;
   CHECK_EQ(inputs.size(), 3U);
-  Stream<xpu>* s = ctx.get_stream<xpu>();
   // Reshape gamma and beta to be broadcastable
   mxnet::TShape new_param_shape(inputs[0].shape_.begin(), inputs[0].shape_.end());
   for (int i = 0; i < inputs[0].ndim(); i++) {
@@ -116,62 +116,20 @@ void LayerNormComputeGeneral(const nnvm::NodeAttrs& attrs,
   }
   const TBlob gamma = inputs[1].reshape(new_param_shape);
   const TBlob beta  = inputs[2].reshape(new_param_shape);
-  // Compute necessary data for the reduce operation.
-  mxnet::TShape red_src_shape, red_dst_shape;
-  BroadcastReduceShapeCompact(
-      inputs[0].shape_, outputs[layernorm::kMean].shape_, &red_src_shape, &red_dst_shape);
-  const TBlob in_data   = inputs[0].reshape(red_src_shape);
-  const TBlob mean_data = outputs[layernorm::kMean].reshape(red_dst_shape);
-  const TBlob std_data  = outputs[layernorm::kStd].reshape(red_dst_shape);
-  int channel_size      = red_src_shape.Size() / red_dst_shape.Size();
-  // Initialize the workspace
-  Tensor<xpu, 1, char> workspace;
-  size_t workspace_size =
-      broadcast::ReduceWorkspaceSize(s, mean_data.shape_, req[0], in_data.shape_);
-  workspace = ctx.requested[0].get_space_typed<xpu, 1, char>(Shape1(workspace_size), s);
-
+  // Calculate mean and std in one pass over the data
+  WelfordMomentsCompute<xpu>(ctx,
+                             inputs[0],
+                             outputs[layernorm::kMean],
+                             outputs[layernorm::kStd],
+                             req[0],
+                             req[0],
+                             0,
+                             param.eps,
+                             true);
 #if !defined(__CUDACC__)
-  bool safe_acc = dmlc::GetEnv("MXNET_SAFE_ACCUMULATION", true);
-  if (!safe_acc && inputs[0].type_flag_ == mshadow::kFloat16) {
-    common::LogOnce(
-        "MXNET_SAFE_ACCUMULATION=1 is recommended for float16 inputs for LayerNorm. "
-        "See https://mxnet.apache.org/api/faq/env_var "
-        "for more details.");
-  }
-
-  // Calculate mean
-  MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, DType, {
-    BROADCAST_NDIM_SWITCH(red_dst_shape.ndim(), NDim, {
-      if (!safe_acc) {
-        broadcast::Reduce<mshadow_op::sum, NDim, DType, mshadow_op::identity, false>(
-            s, mean_data, req[0], workspace, in_data);
-      } else {
-        broadcast::Reduce<mshadow_op::sum, NDim, DType, mshadow_op::identity, true>(
-            s, mean_data, req[0], workspace, in_data);
-      }
-      Tensor<xpu, 1, DType> mean_data_tensor = mean_data.FlatTo1D<xpu, DType>(s);
-      mean_data_tensor /= scalar<DType>(channel_size);
-    });
-  });
   // Calculate data = data - mean
   BinaryBroadcastCompute<xpu, op::mshadow_op::minus>(
       attrs, ctx, {inputs[0], outputs[layernorm::kMean]}, {kWriteTo}, {outputs[0]});
-  // Calculate std
-  const TBlob centered_out = outputs[0].reshape(red_src_shape);
-  MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, DType, {
-    BROADCAST_NDIM_SWITCH(red_dst_shape.ndim(), NDim, {
-      if (!safe_acc) {
-        broadcast::Reduce<mshadow_op::sum, NDim, DType, mshadow_op::square, false>(
-            s, std_data, req[0], workspace, centered_out);
-      } else {
-        broadcast::Reduce<mshadow_op::sum, NDim, DType, mshadow_op::square, true>(
-            s, std_data, req[0], workspace, centered_out);
-      }
-      Tensor<xpu, 1, DType> std_data_tensor = std_data.FlatTo1D<xpu, DType>(s);
-      std_data_tensor = F<mshadow_op::square_root>(std_data_tensor / scalar<DType>(channel_size) +
-                                                   scalar<DType>(param.eps));
-    });
-  });
   // Calculate data = data / std
   BinaryBroadcastCompute<xpu, mshadow_op::div>(
       attrs, ctx, {outputs[0], outputs[layernorm::kStd]}, {kWriteTo}, {outputs[0]});
@@ -182,15 +140,6 @@ void LayerNormComputeGeneral(const nnvm::NodeAttrs& attrs,
   BinaryBroadcastCompute<xpu, mshadow_op::plus>(
       attrs, ctx, {outputs[0], beta}, {kWriteTo}, {outputs[0]});
 #else
-  // Calculate mean
-  BROADCAST_NDIM_SWITCH(red_dst_shape.ndim(), NDim, {
-    broadcast::RTCReduce(
-        ctx, mean_data, req[0], workspace, in_data, "red::sum{}", NDim, "identity");
-  });
-  MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, DType, {
-    Tensor<xpu, 1, DType> mean_data_tensor = mean_data.FlatTo1D<xpu, DType>(s);
-    mean_data_tensor /= scalar<DType>(channel_size);
-  });
   // Calculate data = data - mean
   BinaryBroadcastRTCCompute{"sub"}(  // NOLINT
       attrs,
@@ -198,17 +147,6 @@ void LayerNormComputeGeneral(const nnvm::NodeAttrs& attrs,
       {inputs[0], outputs[layernorm::kMean]},
       {kWriteTo},
       {outputs[0]});
-  // Calculate std
-  const TBlob centered_out = outputs[0].reshape(red_src_shape);
-  BROADCAST_NDIM_SWITCH(red_dst_shape.ndim(), NDim, {
-    broadcast::RTCReduce(
-        ctx, std_data, req[0], workspace, centered_out, "red::sum{}", NDim, "square");
-  });
-  MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, DType, {
-    Tensor<xpu, 1, DType> std_data_tensor = std_data.FlatTo1D<xpu, DType>(s);
-    std_data_tensor = F<mshadow_op::square_root>(std_data_tensor / scalar<DType>(channel_size) +
-                                                 scalar<DType>(param.eps));
-  });
   // Calculate data = data / std
   BinaryBroadcastRTCCompute{"div"}(  // NOLINT
       attrs,
@@ -32,6 +32,8 @@
 #ifndef MXNET_OPERATOR_NN_LAYER_NORM_CPU_H_
 #define MXNET_OPERATOR_NN_LAYER_NORM_CPU_H_
 
+#include "./welford-inl.h"
+
 namespace mxnet {
 namespace op {
 
@@ -75,24 +77,13 @@ void LayerNormCPUKernel(size_t width,
   for (nnvm::dim_t j = 0; j < signed_instances; ++j) {
     const Data* from = data + j * width;
 
-    // Sum the values to compute mean.
-    Accum sum = 0.f;
-#pragma omp simd reduction(+ : sum)
-    for (size_t i = 0; i < width; ++i) {
-      sum += from[i];
-    }
-    Accum mean_value = sum / width;
+    // Mean and variance in one pass over the row.
+    welford::State<Accum> moments;
+    welford::PushContiguous(&moments, from, static_cast<mshadow::index_t>(width));
+    Accum mean_value = moments.mean;
     mean[j]          = static_cast<Data>(mean_value);
-
-    // Sum squares from mean to compute stddev.
-    Accum squares = 0.f;
-#pragma omp simd reduction(+ : squares)
-    for (size_t i = 0; i < width; ++i) {
-      Accum off = from[i] - mean_value;
-      squares += off * off;
-    }
-    Accum sigma = std::sqrt(squares / width + eps);
-    std[j]      = static_cast<Data>(sigma);
+    Accum sigma      = std::sqrt(moments.m2 / width + eps);
+    std[j]           = static_cast<Data>(sigma);
 
     // Write normalized values.
     Data* to = out + j * width;
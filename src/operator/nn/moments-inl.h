@@ -28,6 +28,7 @@
 
 #include <vector>
 #include "../tensor/broadcast_reduce_op.h"
+#include "./welford-inl.h"
 
 namespace mxnet {
 namespace op {
@@ -74,33 +75,6 @@ inline bool MomentsType(const nnvm::NodeAttrs& attrs,
   return out_attrs->at(0) != -1 && out_attrs->at(1) != -1;
 }
 
-struct VarBroadcastKernel {
-  template <typename DType>
-  MSHADOW_XINLINE static void Map(index_t i,
-                                  DType* out,
-                                  const DType* data,
-                                  const DType* mean,
-                                  mshadow::Shape<6> data_shape,
-                                  mshadow::Shape<6> mean_shape) {
-    index_t data_idx    = i;
-    index_t mean_idx    = i;
-    index_t data_stride = 1;
-    index_t mean_stride = 1;
-    for (int axis = 5; axis >= 0; --axis) {
-      index_t axis_idx = data_idx % data_shape[axis];
-      mean_idx -= axis_idx * data_stride;
-      if (mean_shape[axis] != 1) {
-        mean_idx += axis_idx * mean_stride;
-      }
-      data_idx /= data_shape[axis];
-      data_stride *= data_shape[axis];
-      mean_stride *= mean_shape[axis];
-    }
-    DType res = (data[i] - mean[mean_idx]);
-    out[i]    = res * res;
-  }
-};
-
 template <typename xpu>
 inline void MomentsForwardImpl(const OpContext& ctx,
                                const std::vector<TBlob>& inputs,
@@ -108,15 +82,7 @@ inline void MomentsForwardImpl(const OpContext& ctx,
                                const std::vector<TBlob>& outputs,
                                const dmlc::optional<mxnet::TShape>& axes,
                                const bool keepdims) {
-  using namespace mshadow;
-  using namespace mshadow_op;
-  using namespace mxnet_op;
-
-  Stream<xpu>* s = ctx.get_stream<xpu>();
-
   const TBlob& data = inputs[0];
-  const TBlob& mean = outputs[0];
-  const TBlob& var  = outputs[1];
 
   mxnet::TShape small;
   if (keepdims) {
@@ -125,37 +91,8 @@ inline void MomentsForwardImpl(const OpContext& ctx,
     small = ReduceAxesShapeImpl(inputs[0].shape_, axes, true, false);
   }
 
-#if !defined(__CUDACC__)
-  ReduceAxesComputeImpl<xpu, mshadow_op::sum, true, true>(ctx, {data}, {req[0]}, {mean}, small);
-#else
-  ReduceAxesRTCComputeImpl(ctx, {data}, {req[0]}, {mean}, small, "red::sum{}", nullptr, true);
-#endif
-  TBlob temp;
-  MSHADOW_TYPE_SWITCH(data.type_flag_, DType, {
-    Shape<6> data_shape, mean_shape;
-    for (int i = 0; i < 6; ++i) {
-      data_shape[i] = (i < data.shape_.ndim()) ? data.shape_[i] : 1;
-      mean_shape[i] = (i < small.ndim()) ? small[i] : 1;
-    }
-    Tensor<xpu, 1, DType> temp_data =
-        ctx.requested[0].get_space_typed<xpu, 1, DType>(Shape1(data.shape_.Size()), s);
-
-    Kernel<VarBroadcastKernel, xpu>::Launch(s,
-                                            data.shape_.Size(),
-                                            temp_data.dptr_,
-                                            data.dptr<DType>(),
-                                            mean.dptr<DType>(),
-                                            data_shape,
-                                            mean_shape);
-    temp = TBlob(temp_data);
-  });
-#if !defined(__CUDACC__)
-  ReduceAxesComputeImpl<xpu, mshadow_op::sum, true, true>(
-      ctx, {temp.reshape(data.shape_)}, {kWriteTo}, {var}, small);
-#else
-  ReduceAxesRTCComputeImpl(
-      ctx, {temp.reshape(data.shape_)}, {kWriteTo}, {var}, small, "red::sum{}", nullptr, true);
-#endif
+  WelfordMomentsCompute<xpu>(
+      ctx, data, outputs[0].reshape(small), outputs[1].reshape(small), req[0], req[1]);
 }
 
 template <typename xpu>
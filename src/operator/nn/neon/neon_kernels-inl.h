@@ -0,0 +1,170 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file neon_kernels-inl.h
+ * \brief NEON float kernels of the CPU fallback operators on AArch64. They are used when
+ *        the CPU reports Advanced SIMD and MXNET_USE_NEON_KERNELS is not 0. Each one returns
+ *        false for the arguments it does not handle, so that the generic kernel runs instead.
+ */
+#ifndef MXNET_OPERATOR_NN_NEON_NEON_KERNELS_INL_H_
+#define MXNET_OPERATOR_NN_NEON_NEON_KERNELS_INL_H_
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define MXNET_USE_NEON 1
+#else
+#define MXNET_USE_NEON 0
+#endif
+
+#if MXNET_USE_NEON
+#include <arm_neon.h>
+#if defined(__linux__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+#include <dmlc/parameter.h>
+#include <mxnet/base.h>
+#include <algorithm>
+#include <limits>
+#include "../../vectorized_math-inl.h"
+
+namespace mxnet {
+namespace op {
+namespace neon {
+
+/*! \brief Whether the NEON kernels run: the CPU has Advanced SIMD and they are not disabled */
+inline bool Enabled() {
+#if defined(__linux__)
+  static const bool has_asimd = (getauxval(AT_HWCAP) & HWCAP_ASIMD) != 0;
+#else
+  static const bool has_asimd = true;
+#endif
+  static const bool enabled = has_asimd && dmlc::GetEnv("MXNET_USE_NEON_KERNELS", true);
+  return enabled;
+}
+
+/*! \brief vmath::exp<false> on 4 lanes */
+inline float32x4_t Exp(float32x4_t x) {
+  const float32x4_t hi = vdupq_n_f32(88.7228393f);
+  const float32x4_t lo = vdupq_n_f32(-104.0f);
+  // NaN lanes are restored at the end
+  const float32x4_t xc = vminq_f32(vmaxq_f32(x, lo), hi);
+  const float32x4_t n  = vrndnq_f32(vmulq_f32(xc, vdupq_n_f32(1.44269504088896341f)));
+  float32x4_t r        = vfmsq_f32(xc, n, vdupq_n_f32(0.693359375f));
+  r                    = vfmsq_f32(r, n, vdupq_n_f32(-2.12194440e-4f));
+  float32x4_t p        = vdupq_n_f32(1.9875691500e-4f);
+  p                    = vfmaq_f32(vdupq_n_f32(1.3981999507e-3f), p, r);
+  p                    = vfmaq_f32(vdupq_n_f32(8.3334519073e-3f), p, r);
+  p                    = vfmaq_f32(vdupq_n_f32(4.1665795894e-2f), p, r);
+  p                    = vfmaq_f32(vdupq_n_f32(1.6666665459e-1f), p, r);
+  p                    = vfmaq_f32(vdupq_n_f32(5.0000001201e-1f), p, r);
+  p                    = vfmaq_f32(vaddq_f32(r, vdupq_n_f32(1.0f)), vmulq_f32(p, r), r);
+
+  // 2^n in two steps to reach the denormals
+  const int32x4_t k     = vcvtq_s32_f32(n);
+  const int32x4_t h     = vshrq_n_s32(k, 1);
+  const int32x4_t bias  = vdupq_n_s32(127);
+  const float32x4_t s1  = vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(h, bias), 23));
+  const float32x4_t s2  = vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(vsubq_s32(k, h), bias), 23));
+  const float32x4_t inf = vdupq_n_f32(std::numeric_limits<float>::infinity());
+  const float32x4_t ret = vbslq_f32(vcgtq_f32(x, hi), inf, vmulq_f32(vmulq_f32(p, s1), s2));
+  return vbslq_f32(vceqq_f32(x, x), ret, x);
+}
+
+/*!
+ * \brief Softmax, or log softmax, of a contiguous row of len values, in three passes: the max,
+ *        the sum of the exponentials, stored in out for softmax, and the normalization.
+ */
+template <bool negate, bool log, typename DType, typename OType>
+inline bool SoftmaxRow(const DType*, OType*, const index_t, const DType) {
+  return false;
+}
+
+template <bool negate, bool log>
+inline bool SoftmaxRow(const float* in, float* out, const index_t len, const float temperature) {
+  if (len == 0)
+    return true;
+  const float sign  = negate ? -1.0f : 1.0f;
+  const float scale = sign / temperature;
+  // max of sign * x, from which the max of the scaled values follows
+  float32x4_t vmax = vdupq_n_f32(sign * in[0]);
+  index_t j        = 0;
+  for (; j + 4 <= len; j += 4)
+    vmax = vmaxq_f32(vmax, vmulq_n_f32(vld1q_f32(in + j), sign));
+  float mmax = vmaxvq_f32(vmax);
+  for (; j < len; ++j)
+    mmax = std::max(mmax, sign * in[j]);
+  // exp((sign * x - max) / temperature) = exp(x * scale - max / temperature)
+  const float shift     = -mmax / temperature;
+  const float32x4_t vs  = vdupq_n_f32(scale);
+  const float32x4_t vsh = vdupq_n_f32(shift);
+  float32x4_t vsum      = vdupq_n_f32(0.0f);
+  for (j = 0; j + 4 <= len; j += 4) {
+    const float32x4_t e = Exp(vfmaq_f32(vsh, vld1q_f32(in + j), vs));
+    if (!log)
+      vst1q_f32(out + j, e);
+    vsum = vaddq_f32(vsum, e);
+  }
+  float sum = vaddvq_f32(vsum);
+  for (; j < len; ++j) {
+    const float e = vmath::exp<false>(in[j] * scale + shift);
+    if (!log)
+      out[j] = e;
+    sum += e;
+  }
+  if (log) {
+    const float offset     = shift - vmath::log<false>(sum);
+    const float32x4_t voff = vdupq_n_f32(offset);
+    for (j = 0; j + 4 <= len; j += 4)
+      vst1q_f32(out + j, vfmaq_f32(voff, vld1q_f32(in + j), vs));
+    for (; j < len; ++j)
+      out[j] = in[j] * scale + offset;
+  } else {
+    const float inv = 1.0f / sum;
+    for (j = 0; j + 4 <= len; j += 4)
+      vst1q_f32(out + j, vmulq_n_f32(vld1q_f32(out + j), inv));
+    for (; j < len; ++j)
+      out[j] *= inv;
+  }
+  return true;
+}
+
+/*!
+ * \brief max_vals[c] = max(max_vals[c], in[c]) over n channels. NaN inputs are skipped, as by
+ *        the comparison of the generic kernel.
+ */
+template <typename DType>
+inline bool MaxChannels(DType*, const DType*, const index_t) {
+  return false;
+}
+
+inline bool MaxChannels(float* max_vals, const float* in, const index_t n) {
+  index_t c = 0;
+  for (; c + 4 <= n; c += 4)
+    vst1q_f32(max_vals + c, vmaxnmq_f32(vld1q_f32(max_vals + c), vld1q_f32(in + c)));
+  for (; c < n; ++c)
+    max_vals[c] = in[c] > max_vals[c] ? in[c] : max_vals[c];
+  return true;
+}
+
+}  // namespace neon
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_USE_NEON
+#endif  // MXNET_OPERATOR_NN_NEON_NEON_KERNELS_INL_H_
@@ -63,6 +63,7 @@
 #include <vector>
 #include <algorithm>
 #include "./pool_utils.h"
+#include "./neon/neon_kernels-inl.h"
 #include "../mxnet_op.h"
 #include "../mshadow_op.h"
 
@@ -145,6 +146,10 @@ inline void pool_max_1d_nwc_cpu(const DType* in_data,
       wstart     = std::max(wstart, 0);
       std::fill(max_vals.begin(), max_vals.end(), MinValue<DType>());
       for (int w = wstart; w < wend; ++w) {
+#if MXNET_USE_NEON
+        if (neon::Enabled() && neon::MaxChannels(max_vals.data(), in_data + w * features, features))
+          continue;
+#endif
         for (index_t c = 0; c < features; ++c) {
           if (in_data[w * features + c] > max_vals[c]) {
             max_vals[c] = in_data[w * features + c];
@@ -159,9 +164,27 @@ inline void pool_max_1d_nwc_cpu(const DType* in_data,
   }
 }
 
+/*!
+ * \brief Range [begin, end) of the output columns pw of which the column pw * stride - pad + k
+ *        of the window is in the input, with k a column of the kernel.
+ */
+inline void pool_window_columns(const int k,
+                                const int pad,
+                                const int stride,
+                                const int width,
+                                const int pooled_width,
+                                int* begin,
+                                int* end) {
+  *begin = k >= pad ? 0 : (pad - k + stride - 1) / stride;
+  *end   = width - 1 + pad - k < 0 ? 0 : std::min((width - 1 + pad - k) / stride + 1, pooled_width);
+  *begin = std::min(*begin, *end);
+}
+
 /*!
  * \brief max pooling cpu function for 2-D images in 'nchw' layout.
  * Do not call this kernel directly. Use the interface pool().
+ * It runs by output rows, with the inner loop over the output columns for each cell of the
+ * kernel, so that it vectorizes across the width.
  */
 template <typename DType>
 inline void pool_max_2d_nchw_cpu(const DType* in_data,
@@ -182,24 +205,21 @@ inline void pool_max_2d_nchw_cpu(const DType* in_data,
   for (index_t n = 0; n < oshape[0]; ++n) {
     for (index_t c = 0; c < oshape[1]; ++c) {
       for (int ph = 0; ph < pooled_height; ++ph) {
-        for (int pw = 0; pw < pooled_width; ++pw) {
-          int hstart           = ph * stride_h - pad_h;
-          int wstart           = pw * stride_w - pad_w;
-          int hend             = std::min(hstart + kernel_h, height);
-          int wend             = std::min(wstart + kernel_w, width);
-          hstart               = std::max(hstart, 0);
-          wstart               = std::max(wstart, 0);
-          const int pool_index = ph * pooled_width + pw;
-          DType max_val        = MinValue<DType>();
-          for (int h = hstart; h < hend; ++h) {
-            for (int w = wstart; w < wend; ++w) {
-              const int in_index = h * width + w;
-              if (in_data[in_index] > max_val) {
-                max_val = in_data[in_index];
-              }
+        int hstart     = ph * stride_h - pad_h;
+        const int hend = std::min(hstart + kernel_h, height);
+        hstart         = std::max(hstart, 0);
+        DType* out_row = out_data + ph * pooled_width;
+        std::fill(out_row, out_row + pooled_width, MinValue<DType>());
+        for (int h = hstart; h < hend; ++h) {
+          for (int k = 0; k < kernel_w; ++k) {
+            int begin, end;
+            pool_window_columns(k, pad_w, stride_w, width, pooled_width, &begin, &end);
+            const DType* in_row = in_data + h * width + k - pad_w;
+            for (int pw = begin; pw < end; ++pw) {
+              const DType val = in_row[pw * stride_w];
+              out_row[pw]     = val > out_row[pw] ? val : out_row[pw];
             }
           }
-          out_data[pool_index] = max_val;
         }
       }
       in_data += in_data_offset;
@@ -244,6 +264,11 @@ inline void pool_max_2d_nhwc_cpu(const DType* in_data,
         for (int h = hstart; h < hend; ++h) {
           for (int w = wstart; w < wend; ++w) {
             const int in_index = h * width + w;
+#if MXNET_USE_NEON
+            if (neon::Enabled() &&
+                neon::MaxChannels(max_vals.data(), in_data + in_index * features, features))
+              continue;
+#endif
             for (index_t c = 0; c < features; ++c) {
               if (in_data[in_index * features + c] > max_vals[c]) {
                 max_vals[c] = in_data[in_index * features + c];
@@ -357,6 +382,11 @@ inline void pool_max_3d_ndhwc_cpu(const DType* in_data,
             for (int h = hstart; h < hend; ++h) {
               for (int w = wstart; w < wend; ++w) {
                 const int in_index = (d * height + h) * width + w;
+#if MXNET_USE_NEON
+                if (neon::Enabled() &&
+                    neon::MaxChannels(max_vals.data(), in_data + in_index * features, features))
+                  continue;
+#endif
                 for (index_t c = 0; c < features; ++c) {
                   if (in_data[in_index * features + c] > max_vals[c]) {
                     max_vals[c] = in_data[in_index * features + c];
@@ -471,6 +501,7 @@ inline void pool_sum_1d_nwc_cpu(const DType* in_data,
 /*!
  * \brief avg/sum pooling cpu function for 2-D images in 'nchw' layout.
  * Do not call this kernel directly. Use the interface pool().
+ * It runs by output rows, as pool_max_2d_nchw_cpu.
  */
 template <typename DType, int p = 1>
 inline void pool_sum_2d_nchw_cpu(const DType* in_data,
@@ -490,29 +521,44 @@ inline void pool_sum_2d_nchw_cpu(const DType* in_data,
   const int stride_h = stride[0], stride_w = stride[1];
   const index_t in_data_offset  = ishape[2] * ishape[3];
   const index_t out_data_offset = oshape[2] * oshape[3];
+  // widths of the windows of the output columns, with and without the padding
+  std::vector<int> pad_widths(pooled_width), widths(pooled_width);
+  for (int pw = 0; pw < pooled_width; ++pw) {
+    const int wstart = pw * stride_w - pad_w;
+    const int wend   = std::min(wstart + kernel_w, width + pad_w);
+    pad_widths[pw]   = wend - wstart;
+    widths[pw]       = std::min(wend, width) - std::max(wstart, 0);
+  }
+  std::vector<int> pool_sizes(pooled_width);
+  std::vector<AccType> sums(pooled_width);
   for (index_t n = 0; n < oshape[0]; ++n) {
     for (index_t c = 0; c < oshape[1]; ++c) {
       for (int ph = 0; ph < pooled_height; ++ph) {
+        int hstart = ph * stride_h - pad_h;
+        int hend   = std::min(hstart + kernel_h, height + pad_h);
         for (int pw = 0; pw < pooled_width; ++pw) {
-          int hstart    = ph * stride_h - pad_h;
-          int wstart    = pw * stride_w - pad_w;
-          int hend      = std::min(hstart + kernel_h, height + pad_h);
-          int wend      = std::min(wstart + kernel_w, width + pad_w);
-          int pool_size = (get_avg ? (hend - hstart) * (wend - wstart) : 1);
-          hstart        = std::max(hstart, 0);
-          wstart        = std::max(wstart, 0);
-          hend          = std::min(hend, height);
-          wend          = std::min(wend, width);
-          if (get_avg && !count_include_pad) {
-            pool_size = (hend - hstart) * (wend - wstart);
+          pool_sizes[pw] = get_avg ? (hend - hstart) * pad_widths[pw] : 1;
+        }
+        hstart = std::max(hstart, 0);
+        hend   = std::min(hend, height);
+        if (get_avg && !count_include_pad) {
+          for (int pw = 0; pw < pooled_width; ++pw) {
+            pool_sizes[pw] = (hend - hstart) * widths[pw];
           }
-          AccType sum = 0;
-          for (int h = hstart; h < hend; ++h) {
-            for (int w = wstart; w < wend; ++w) {
-              sum += a_pow_p<AccType, p>::Map(in_data[h * width + w]) / pool_size;
+        }
+        std::fill(sums.begin(), sums.end(), 0);
+        for (int h = hstart; h < hend; ++h) {
+          for (int k = 0; k < kernel_w; ++k) {
+            int begin, end;
+            pool_window_columns(k, pad_w, stride_w, width, pooled_width, &begin, &end);
+            const DType* in_row = in_data + h * width + k - pad_w;
+            for (int pw = begin; pw < end; ++pw) {
+              sums[pw] += a_pow_p<AccType, p>::Map(in_row[pw * stride_w]) / pool_sizes[pw];
             }
           }
-          out_data[ph * pooled_width + pw] = a_root_p<AccType, p>::Map(sum);
+        }
+        for (int pw = 0; pw < pooled_width; ++pw) {
+          out_data[ph * pooled_width + pw] = a_root_p<AccType, p>::Map(sums[pw]);
         }
       }
       in_data += in_data_offset;
@@ -812,6 +858,8 @@ inline void unpool_max_1d_nwc_cpu(const DType* out_grad,
 /*!
  * \brief max unpooling cpu function for 2-D images in 'nchw' layout.
  * Do not call this kernel directly. Use the interface unpool().
+ * The positions of the maxima of an output row are found first, in one pass vectorized across
+ * the width as the forward, and the gradient is then scattered to them.
  */
 template <typename DType>
 inline void unpool_max_2d_nchw_cpu(const DType* out_grad,
@@ -823,6 +871,7 @@ inline void unpool_max_2d_nchw_cpu(const DType* out_grad,
                                    const mxnet::TShape& pad,
                                    const mxnet::TShape& stride,
                                    DType* in_grad) {
+  using mshadow::red::limits::MinValue;
   const int height = ishape[2], width = ishape[3];
   const int pooled_height = oshape[2], pooled_width = oshape[3];
   const int kernel_h = kernel[0], kernel_w = kernel[1];
@@ -830,35 +879,38 @@ inline void unpool_max_2d_nchw_cpu(const DType* out_grad,
   const int stride_h = stride[0], stride_w = stride[1];
   const index_t in_offset  = ishape[2] * ishape[3];
   const index_t out_offset = oshape[2] * oshape[3];
+  std::vector<DType> max_vals(pooled_width);
+  std::vector<int> max_idxs(pooled_width);
   for (index_t n = 0; n < oshape[0]; ++n) {
     for (index_t c = 0; c < oshape[1]; ++c) {
       for (int ph = 0; ph < pooled_height; ++ph) {
-        for (int pw = 0; pw < pooled_width; ++pw) {
-          int hstart           = ph * stride_h - pad_h;
-          int wstart           = pw * stride_w - pad_w;
-          int hend             = std::min(hstart + kernel_h, height);
-          int wend             = std::min(wstart + kernel_w, width);
-          hstart               = std::max(hstart, 0);
-          wstart               = std::max(wstart, 0);
-          const int pool_index = ph * pooled_width + pw;
-          int max_idx          = -1;
-          bool found           = false;
-          for (int h = hstart; h < hend; ++h) {
-            for (int w = wstart; w < wend; ++w) {
-              const int idx = h * width + w;
-              if (in_data[idx] == out_data[pool_index]) {
-                max_idx = idx;
-                found   = true;
-                break;
-              }
+        int hstart     = ph * stride_h - pad_h;
+        const int hend = std::min(hstart + kernel_h, height);
+        hstart         = std::max(hstart, 0);
+        std::fill(max_vals.begin(), max_vals.end(), MinValue<DType>());
+        // In the case where pad > 0 and kernel = 1, for example,
+        // max_idx can be -1 after the search.
+        std::fill(max_idxs.begin(), max_idxs.end(), -1);
+        // the first input equal to the output, in the order of the forward
+        for (int h = hstart; h < hend; ++h) {
+          for (int k = 0; k < kernel_w; ++k) {
+            int begin, end;
+            pool_window_columns(k, pad_w, stride_w, width, pooled_width, &begin, &end);
+            const int row_idx   = h * width + k - pad_w;
+            const DType* in_row = in_data + row_idx;
+            for (int pw = begin; pw < end; ++pw) {
+              const DType val  = in_row[pw * stride_w];
+              const bool above =
+                  val > max_vals[pw] || (max_idxs[pw] < 0 && val == max_vals[pw]);
+              max_vals[pw]     = above ? val : max_vals[pw];
+              max_idxs[pw]     = above ? row_idx + pw * stride_w : max_idxs[pw];
             }
-            if (found)
-              break;
           }
-          // In the case where pad > 0 and kernel = 1, for example,
-          // max_idx can be -1 reaching this step.
-          if (max_idx >= 0) {
-            in_grad[max_idx] += out_grad[pool_index];
+        }
+        const DType* grad_row = out_grad + ph * pooled_width;
+        for (int pw = 0; pw < pooled_width; ++pw) {
+          if (max_idxs[pw] >= 0) {
+            in_grad[max_idxs[pw]] += grad_row[pw];
           }
         }
       }
@@ -873,6 +925,8 @@ inline void unpool_max_2d_nchw_cpu(const DType* out_grad,
 /*!
  * \brief max unpooling cpu function for 2-D images in 'nhwc' layout.
  * Do not call this kernel directly. Use the interface unpool().
+ * The positions of the maxima of a window are found for all the channels in one pass vectorized
+ * across the channels, and the gradient is then scattered to them.
  */
 template <typename DType>
 inline void unpool_max_2d_nhwc_cpu(const DType* out_grad,
@@ -884,6 +938,7 @@ inline void unpool_max_2d_nhwc_cpu(const DType* out_grad,
                                    const mxnet::TShape& pad,
                                    const mxnet::TShape& stride,
                                    DType* in_grad) {
+  using mshadow::red::limits::MinValue;
   const int height = ishape[1], width = ishape[2];
   const int pooled_height = oshape[1], pooled_width = oshape[2];
   const int kernel_h = kernel[0], kernel_w = kernel[1];
@@ -892,6 +947,7 @@ inline void unpool_max_2d_nhwc_cpu(const DType* out_grad,
   const int features       = oshape[3];
   const index_t in_offset  = ishape[1] * ishape[2] * features;
   const index_t out_offset = oshape[1] * oshape[2] * features;
+  std::vector<DType> max_vals(features);
   std::vector<int> max_idxs(features);
   for (index_t n = 0; n < oshape[0]; ++n) {
     for (int ph = 0; ph < pooled_height; ++ph) {
@@ -903,20 +959,18 @@ inline void unpool_max_2d_nhwc_cpu(const DType* out_grad,
         hstart               = std::max(hstart, 0);
         wstart               = std::max(wstart, 0);
         const int pool_index = ph * pooled_width + pw;
+        std::fill(max_vals.begin(), max_vals.end(), MinValue<DType>());
         std::fill(max_idxs.begin(), max_idxs.end(), -1);
-        for (index_t c = 0; c < features; ++c) {
-          bool found = false;
-          for (int h = hstart; h < hend; ++h) {
-            for (int w = wstart; w < wend; ++w) {
-              const int idx = h * width + w;
-              if (in_data[idx * features + c] == out_data[pool_index * features + c]) {
-                max_idxs[c] = idx;
-                found       = true;
-                break;
-              }
+        for (int h = hstart; h < hend; ++h) {
+          for (int w = wstart; w < wend; ++w) {
+            const int idx       = h * width + w;
+            const DType* in_pix = in_data + idx * features;
+            for (index_t c = 0; c < features; ++c) {
+              const bool above =
+                  in_pix[c] > max_vals[c] || (max_idxs[c] < 0 && in_pix[c] == max_vals[c]);
+              max_vals[c]      = above ? in_pix[c] : max_vals[c];
+              max_idxs[c]      = above ? idx : max_idxs[c];
             }
-            if (found)
-              break;
           }
         }
         // In the case where pad > 0 and kernel = 1, for example,
@@ -1431,33 +1485,54 @@ inline void unpool_sum_3d_ndhwc_cpu(const DType* out_grad,
 }
 
 /*!
- * \brief This function serves as an interface for 1/2/3-D pooling operations.
- * \param s context stream defining the device in use is cpu
- * \param in_data pointer of the input tensor data in the format of NCW, NCHW, or NCDHW
- * \param ishape input tensor shape
- * \param oshape output tensor shape
- * \param kernel kernel shape
- * \param pad pad shape
- * \param stride stride shape
- * \param pool_type supported pooling type: max, avg, sum
- * \param req_type operator request type, only support kWriteTo for now
- * \param out_data pointer of the output tensor data in the format of NCW, NCHW, or NCDHW
- * \param p_value value of p for Lp pooling
+ * \brief Runs fn(in_offset, out_offset, ishape, oshape), a pooling function of whole tensors, on
+ *        contiguous ranges of the planes in parallel, or of the images for the channel-last
+ *        layouts. Neither the ranges of the input nor those of the output overlap.
+ */
+template <typename Fn>
+inline void pool_parallel_cpu(const mxnet::TShape& ishape,
+                              const mxnet::TShape& oshape,
+                              const int layout,
+                              Fn fn) {
+  const bool channel_last =
+      layout == mshadow::kNWC || layout == mshadow::kNHWC || layout == mshadow::kNDHWC;
+  const index_t parts = channel_last ? ishape[0] : ishape[0] * ishape[1];
+  if (parts == 0)
+    return;
+  const index_t in_part_size  = ishape.Size() / parts;
+  const index_t out_part_size = oshape.Size() / parts;
+  const int nthreads          = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  const index_t ranges        = std::min<index_t>(parts, nthreads);
+#pragma omp parallel for num_threads(nthreads)
+  for (index_t i = 0; i < ranges; ++i) {
+    const index_t begin = parts * i / ranges;
+    const index_t end   = parts * (i + 1) / ranges;
+    mxnet::TShape irange(ishape), orange(oshape);
+    if (channel_last) {
+      irange[0] = orange[0] = end - begin;
+    } else {
+      irange[0] = orange[0] = 1;
+      irange[1] = orange[1] = end - begin;
+    }
+    fn(begin * in_part_size, begin * out_part_size, irange, orange);
+  }
+}
+
+/*!
+ * \brief Pooling of a range of the planes or images, see pool_parallel_cpu.
+ * Do not call this kernel directly. Use the interface pool().
  */
 template <typename DType, int p>
-inline void pool(mshadow::Stream<cpu>* s,
-                 const DType* in_data,
-                 const mxnet::TShape& ishape,
-                 const mxnet::TShape& oshape,
-                 const mxnet::TShape& kernel,
-                 const mxnet::TShape& pad,
-                 const mxnet::TShape& stride,
-                 const int pool_type,
-                 OpReqType req_type,
-                 DType* out_data,
-                 const bool count_include_pad,
-                 int layout) {
-  CHECK_EQ(req_type, kWriteTo) << "Only support req=kWriteTo in pooling operations";
+inline void pool_cpu(const DType* in_data,
+                     const mxnet::TShape& ishape,
+                     const mxnet::TShape& oshape,
+                     const mxnet::TShape& kernel,
+                     const mxnet::TShape& pad,
+                     const mxnet::TShape& stride,
+                     const int pool_type,
+                     DType* out_data,
+                     const bool count_include_pad,
+                     int layout) {
   if (kernel.ndim() == 1) {
     if (layout == mshadow::kNWC) {
       if (pool_enum::kMaxPooling == pool_type) {
@@ -1554,41 +1629,71 @@ inline void pool(mshadow::Stream<cpu>* s,
 }
 
 /*!
- * \brief This function serves as an interface for 1/2/3-D unpooling operations.
+ * \brief This function serves as an interface for 1/2/3-D pooling operations.
  * \param s context stream defining the device in use is cpu
- * \param out_grad pointer of the gradient of operator's output tensor
- * \param in_data pointer of the input tensor in the format of NCW, NCHW, or NCDHW
- * \param out_data pointer of the output tensor in the format of NCW, NCHW, or NCDHW
+ * \param in_data pointer of the input tensor data in the format of NCW, NCHW, or NCDHW
  * \param ishape input tensor shape
  * \param oshape output tensor shape
  * \param kernel kernel shape
  * \param pad pad shape
  * \param stride stride shape
  * \param pool_type supported pooling type: max, avg, sum
- * \param req_type operator request type: kNullOp, kNullWriteInplace, kNullWriteTo, kNullAddTo
- * \param in_grad pointer of the gradient of the operator's input tensor
+ * \param req_type operator request type, only support kWriteTo for now
+ * \param out_data pointer of the output tensor data in the format of NCW, NCHW, or NCDHW
  * \param p_value value of p for Lp pooling
  */
 template <typename DType, int p>
-inline void unpool(mshadow::Stream<cpu>* s,
-                   const DType* out_grad,
-                   const DType* in_data,
-                   const DType* out_data,
-                   const mxnet::TShape& ishape,
-                   const mxnet::TShape& oshape,
-                   const mxnet::TShape& kernel,
-                   const mxnet::TShape& pad,
-                   const mxnet::TShape& stride,
-                   const int pool_type,
-                   OpReqType req_type,
-                   DType* in_grad,
-                   const bool count_include_pad,
-                   int layout) {
-  if (mxnet::kNullOp == req_type)
-    return;
-  if (mxnet::kAddTo != req_type) {
-    mxnet_op::Kernel<mxnet_op::set_zero, cpu>::Launch(s, ishape.Size(), in_grad);
-  }
+inline void pool(mshadow::Stream<cpu>* s,
+                 const DType* in_data,
+                 const mxnet::TShape& ishape,
+                 const mxnet::TShape& oshape,
+                 const mxnet::TShape& kernel,
+                 const mxnet::TShape& pad,
+                 const mxnet::TShape& stride,
+                 const int pool_type,
+                 OpReqType req_type,
+                 DType* out_data,
+                 const bool count_include_pad,
+                 int layout) {
+  CHECK_EQ(req_type, kWriteTo) << "Only support req=kWriteTo in pooling operations";
+  pool_parallel_cpu(
+      ishape,
+      oshape,
+      layout,
+      [&](index_t in_offset,
+          index_t out_offset,
+          const mxnet::TShape& irange,
+          const mxnet::TShape& orange) {
+        pool_cpu<DType, p>(in_data + in_offset,
+                           irange,
+                           orange,
+                           kernel,
+                           pad,
+                           stride,
+                           pool_type,
+                           out_data + out_offset,
+                           count_include_pad,
+                           layout);
+      });
+}
+
+/*!
+ * \brief Unpooling of a range of the planes or images, see pool_parallel_cpu.
+ * Do not call this kernel directly. Use the interface unpool().
+ */
+template <typename DType, int p>
+inline void unpool_cpu(const DType* out_grad,
+                       const DType* in_data,
+                       const DType* out_data,
+                       const mxnet::TShape& ishape,
+                       const mxnet::TShape& oshape,
+                       const mxnet::TShape& kernel,
+                       const mxnet::TShape& pad,
+                       const mxnet::TShape& stride,
+                       const int pool_type,
+                       DType* in_grad,
+                       const bool count_include_pad,
+                       int layout) {
   if (kernel.ndim() == 1) {
     if (layout == mshadow::kNWC) {
       if (pool_enum::kMaxPooling == pool_type) {
@@ -1756,6 +1861,65 @@ inline void unpool(mshadow::Stream<cpu>* s,
   }
 }
 
+/*!
+ * \brief This function serves as an interface for 1/2/3-D unpooling operations.
+ * \param s context stream defining the device in use is cpu
+ * \param out_grad pointer of the gradient of operator's output tensor
+ * \param in_data pointer of the input tensor in the format of NCW, NCHW, or NCDHW
+ * \param out_data pointer of the output tensor in the format of NCW, NCHW, or NCDHW
+ * \param ishape input tensor shape
+ * \param oshape output tensor shape
+ * \param kernel kernel shape
+ * \param pad pad shape
+ * \param stride stride shape
+ * \param pool_type supported pooling type: max, avg, sum
+ * \param req_type operator request type: kNullOp, kNullWriteInplace, kNullWriteTo, kNullAddTo
+ * \param in_grad pointer of the gradient of the operator's input tensor
+ * \param p_value value of p for Lp pooling
+ */
+template <typename DType, int p>
+inline void unpool(mshadow::Stream<cpu>* s,
+                   const DType* out_grad,
+                   const DType* in_data,
+                   const DType* out_data,
+                   const mxnet::TShape& ishape,
+                   const mxnet::TShape& oshape,
+                   const mxnet::TShape& kernel,
+                   const mxnet::TShape& pad,
+                   const mxnet::TShape& stride,
+                   const int pool_type,
+                   OpReqType req_type,
+                   DType* in_grad,
+                   const bool count_include_pad,
+                   int layout) {
+  if (mxnet::kNullOp == req_type)
+    return;
+  if (mxnet::kAddTo != req_type) {
+    mxnet_op::Kernel<mxnet_op::set_zero, cpu>::Launch(s, ishape.Size(), in_grad);
+  }
+  pool_parallel_cpu(
+      ishape,
+      oshape,
+      layout,
+      [&](index_t in_offset,
+          index_t out_offset,
+          const mxnet::TShape& irange,
+          const mxnet::TShape& orange) {
+        unpool_cpu<DType, p>(out_grad + out_offset,
+                             in_data + in_offset,
+                             out_data + out_offset,
+                             irange,
+                             orange,
+                             kernel,
+                             pad,
+                             stride,
+                             pool_type,
+                             in_grad + in_offset,
+                             count_include_pad,
+                             layout);
+      });
+}
+
 }  // namespace op
 }  // namespace mxnet
 #ifdef __CUDACC__
@@ -33,6 +33,7 @@
 #include "../mxnet_op.h"
 #include "../operator_common.h"
 #include "../tensor/broadcast_reduce_op.h"
+#include "./neon/neon_kernels-inl.h"
 
 using mshadow::red::limits::MinValue;
 
@@ -64,6 +65,48 @@ struct log_softmax_fwd {
   }
 };
 
+/*!
+ * \brief Computes the max of a row and the sum of exp((x - max) / temperature) over it in a
+ *        single read: the running sum is rescaled whenever the running max grows, so large
+ *        rows are streamed from memory once before the normalization pass instead of twice.
+ */
+template <bool negate, typename AType, typename DType>
+inline void SoftmaxOnlineNormalizer(const DType* in,
+                                    const index_t len,
+                                    const index_t stride,
+                                    const DType temperature,
+                                    DType* row_max,
+                                    AType* row_sum) {
+  // The row's first element seeds the max with a contribution of exp(0) = 1. Elements equal to
+  // the running max are counted the same way, which keeps rows that start with -inf finite.
+  DType mmax = negate ? -in[0] : in[0];
+  AType sum  = AType(1);
+  DType val;
+  if (temperature == 1.0) {
+    for (index_t j = 1; j < len; ++j) {
+      val = negate ? -in[j * stride] : in[j * stride];
+      if (mmax < val) {
+        sum  = sum * std::exp(mmax - val) + AType(1);
+        mmax = val;
+      } else {
+        sum += val == mmax ? AType(1) : AType(std::exp(val - mmax));
+      }
+    }
+  } else {
+    for (index_t j = 1; j < len; ++j) {
+      val = negate ? -in[j * stride] : in[j * stride];
+      if (mmax < val) {
+        sum  = sum * std::exp((mmax - val) / temperature) + AType(1);
+        mmax = val;
+      } else {
+        sum += val == mmax ? AType(1) : AType(std::exp((val - mmax) / temperature));
+      }
+    }
+  }
+  *row_max = mmax;
+  *row_sum = sum;
+}
+
 template <typename OP,
           bool negate,
           typename AType,
@@ -86,87 +129,43 @@ inline void Softmax(Stream<cpu>* s,
   Shape<ndim> sshape = shape;
   sshape[axis]       = 1;
   index_t sa         = stride[axis];
+#if MXNET_USE_NEON
+  // contiguous float rows of softmax and log_softmax
+  constexpr bool log_softmax = std::is_same<OP, log_softmax_fwd>::value;
 
-  if (length == nullptr) {
-#pragma omp parallel for
-    for (index_t i = 0; i < N; ++i) {
-      index_t base = unravel_dot(i, sshape, stride);
-
-      DType mmax = negate ? -in[base] : in[base];
-      DType val;
-      for (index_t j = 1; j < M; ++j) {
-        val = negate ? -in[base + j * sa] : in[base + j * sa];
-        if (mmax < val)
-          mmax = val;
-      }
-
-      AType sum = AType(0);
-      DType in_val;
-      // By default temperature is 1.0.
-      // Adding a branch here to save the CPU 'divide-by-1' computation at runtime
-      if (temperature == 1.0) {
-        for (index_t j = 0; j < M; ++j) {
-          in_val = negate ? -in[base + j * sa] : in[base + j * sa];
-          sum += std::exp(in_val - mmax);
-        }
-
-        for (index_t j = 0; j < M; ++j) {
-          in_val             = negate ? -in[base + j * sa] : in[base + j * sa];
-          out[base + j * sa] = OP::Map(in_val - mmax, sum);
-        }
-      } else {
-        for (index_t j = 0; j < M; ++j) {
-          in_val = negate ? -in[base + j * sa] : in[base + j * sa];
-          sum += std::exp((in_val - mmax) / temperature);
-        }
+  const bool use_neon = (std::is_same<OP, softmax_fwd>::value || log_softmax) &&
+                        std::is_same<AType, float>::value && sa == 1 && neon::Enabled();
+#endif
 
-        for (index_t j = 0; j < M; ++j) {
-          in_val             = negate ? -in[base + j * sa] : in[base + j * sa];
-          out[base + j * sa] = OP::Map((in_val - mmax) / temperature, sum);
-        }
-      }
-    }
-  } else {
 #pragma omp parallel for
-    for (index_t i = 0; i < N; ++i) {
-      index_t len  = static_cast<index_t>(length[i]);
-      index_t base = unravel_dot(i, sshape, stride);
-
-      DType mmax = negate ? -in[base] : in[base];
-      DType val;
-      for (index_t j = 1; j < len; ++j) {
-        val = negate ? -in[base + j * sa] : in[base + j * sa];
-        if (mmax < val)
-          mmax = val;
-      }
-      for (index_t j = len; j < M; ++j) {
-        out[base + j * sa] = OType(0.0f);
-      }
-
-      AType sum = AType(0);
-      DType in_val;
-      // By default temperature is 1.0.
-      // Adding a branch here to save the CPU 'divide-by-1' computation at runtime
-      if (temperature == 1.0) {
-        for (index_t j = 0; j < len; ++j) {
-          in_val = negate ? -in[base + j * sa] : in[base + j * sa];
-          sum += std::exp(in_val - mmax);
-        }
+  for (index_t i = 0; i < N; ++i) {
+    const index_t len  = length == nullptr ? M : static_cast<index_t>(length[i]);
+    const index_t base = unravel_dot(i, sshape, stride);
+    for (index_t j = len; j < M; ++j) {
+      out[base + j * sa] = OType(0.0f);
+    }
+#if MXNET_USE_NEON
+    if (use_neon &&
+        neon::SoftmaxRow<negate, log_softmax>(in + base, out + base, len, temperature))
+      continue;
+#endif
 
-        for (index_t j = 0; j < len; ++j) {
-          in_val             = negate ? -in[base + j * sa] : in[base + j * sa];
-          out[base + j * sa] = OP::Map(in_val - mmax, sum);
-        }
-      } else {
-        for (index_t j = 0; j < len; ++j) {
-          in_val = negate ? -in[base + j * sa] : in[base + j * sa];
-          sum += std::exp((in_val - mmax) / temperature);
-        }
+    DType mmax;
+    AType sum;
+    SoftmaxOnlineNormalizer<negate>(in + base, len, sa, temperature, &mmax, &sum);
 
-        for (index_t j = 0; j < len; ++j) {
-          in_val             = negate ? -in[base + j * sa] : in[base + j * sa];
-          out[base + j * sa] = OP::Map((in_val - mmax) / temperature, sum);
-        }
+    DType in_val;
+    // By default temperature is 1.0.
+    // Adding a branch here to save the CPU 'divide-by-1' computation at runtime
+    if (temperature == 1.0) {
+      for (index_t j = 0; j < len; ++j) {
+        in_val             = negate ? -in[base + j * sa] : in[base + j * sa];
+        out[base + j * sa] = OP::Map(in_val - mmax, sum);
+      }
+    } else {
+      for (index_t j = 0; j < len; ++j) {
+        in_val             = negate ? -in[base + j * sa] : in[base + j * sa];
+        out[base + j * sa] = OP::Map((in_val - mmax) / temperature, sum);
       }
     }
   }
@@ -1270,8 +1269,8 @@ void SoftmaxCompute(const nnvm::NodeAttrs& attrs,
   }
 
   MXNET_REAL_ACC_TYPE_SWITCH(inputs[0].type_flag_, DType, AType, {
-    MSHADOW_REAL_TYPE_SWITCH(
-        outputs[0].type_flag_, OType, {
+    MXNET_WITH_BFLOAT16_TYPE_SWITCH(
+        MSHADOW_REAL_TYPE_SWITCH, outputs[0].type_flag_, OType, {
           int type = kInt32;
           if (param.use_length.value()) {
             CHECK(inputs.size() > 1)
@@ -1431,7 +1430,7 @@ void SoftmaxGradCompute(const nnvm::NodeAttrs& attrs,
   bool safe_acc = dmlc::GetEnv("MXNET_SAFE_ACCUMULATION", true);
 
   MXNET_REAL_ACC_TYPE_SWITCH(inputs[0].type_flag_, OType, AType, {
-    MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, DType, {
+    MXNET_WITH_BFLOAT16_TYPE_SWITCH(MSHADOW_REAL_TYPE_SWITCH, outputs[0].type_flag_, DType, {
       MXNET_ASSIGN_REQ_SWITCH(req[0], Req, {
         MXNET_INT32_INT64_TYPE_SWITCH(itype, IType, {
           IType* length_ptr = nullptr;
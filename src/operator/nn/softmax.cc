@@ -162,6 +162,8 @@ Example::
     })
     .set_num_outputs(1)
     .set_attr<mxnet::FInferShape>("FInferShape", SoftmaxOpShape)
+    // max, subtract, exp, sum and divide for every element
+    .set_attr<FOpCost>("FOpCost", ElemwiseOpCost<5>)
     .set_attr<nnvm::FInplaceOption>("FInplaceOption",
                                     [](const NodeAttrs& attrs) {
                                       return std::vector<std::pair<int, int> >{{0, 0}};
@@ -101,56 +101,43 @@ __global__ void simple_softmax_kernel(const softmax_params param,
   using OType = AccType<OutputType0>;
   using AType = type_util::mixed_type<typename IType::type,
                                       typename OType::type>;
+  // Online normalizer: every thread keeps a running max and a sum of exp rescaled to it,
+  // so the row is read once for both statistics; the pairs are merged the same way.
   __shared__ AType smem[kRTCMaxThreadsPerBlock];
+  __shared__ AType ssum[kRTCMaxThreadsPerBlock];
+  const AType temperature = static_cast<AType>(param.temperature);
   AType max;
+  AType sum;
   red::maximum::SetInitValue(max);
+  red::sum::SetInitValue(sum);
   for (index_t i = my_id; i < len; i += threads_per_row) {
     auto val = IType::from(input[base + i * param.stride]);
-    max = op::max(max, negate ? -val : val);
+    val = negate ? -val : val;
+    if (max < val) {
+      sum = sum * op::exp((max - val) / temperature) + 1;
+      max = val;
+    } else {
+      sum += (val == max) ? 1 : op::exp((val - max) / temperature);
+    }
   }
   smem[threadIdx.x] = max;
+  ssum[threadIdx.x] = sum;
   __syncthreads();
-  for (int size = blockDim.x / 2; size >= warp_size; size /= 2) {
+  for (int size = blockDim.x / 2; size >= param.rows_per_block; size /= 2) {
     if (threadIdx.x < size) {
-      smem[threadIdx.x] = op::max(smem[threadIdx.x], smem[threadIdx.x + size]);
+      const AType max1 = smem[threadIdx.x];
+      const AType max2 = smem[threadIdx.x + size];
+      const AType smax = op::max(max1, max2);
+      const AType sum1 = ssum[threadIdx.x];
+      const AType sum2 = ssum[threadIdx.x + size];
+      ssum[threadIdx.x] = (max1 == smax ? sum1 : sum1 * op::exp((max1 - smax) / temperature)) +
+                          (max2 == smax ? sum2 : sum2 * op::exp((max2 - smax) / temperature));
+      smem[threadIdx.x] = smax;
     }
     __syncthreads();
   }
-  if (threadIdx.x < warp_size) {
-    AType my_value = util::strided_grouped_warp_reduce(smem[threadIdx.x],
-                                                       [](AType x, AType y)
-                                                         { return op::max(x, y); },
-                                                       param.rows_per_block);
-    smem[threadIdx.x] = my_value;
-  }
-  __syncthreads();
   AType smax = smem[my_row];
-  __syncthreads();
-
-  AType sum;
-  red::sum::SetInitValue(sum);
-  for (index_t i = my_id; i < len; i += threads_per_row) {
-    auto val = IType::from(input[base + i * param.stride]);
-    val = negate ? -val :val;
-    sum += op::exp((val - smax) / static_cast<AType>(param.temperature));
-  }
-  smem[threadIdx.x] = sum;
-  __syncthreads();
-  for (int size = blockDim.x / 2; size >= warp_size; size /= 2) {
-    if (threadIdx.x < size) {
-      smem[threadIdx.x] = op::add(smem[threadIdx.x], smem[threadIdx.x + size]);
-    }
-    __syncthreads();
-  }
-  if (threadIdx.x < warp_size) {
-    AType my_value = util::strided_grouped_warp_reduce(smem[threadIdx.x],
-                                                       [](AType x, AType y)
-                                                         { return op::add(x, y); },
-                                                       param.rows_per_block);
-    smem[threadIdx.x] = my_value;
-  }
-  __syncthreads();
-  sum = smem[my_row];
+  sum = ssum[my_row];
   __syncthreads();
 
   OutputType0* output = reinterpret_cast<OutputType0*>(param.outputs[0]);
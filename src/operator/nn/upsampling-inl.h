@@ -32,7 +32,9 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <type_traits>
 #include <utility>
+#include "../mxnet_op.h"
 #include "../operator_common.h"
 #include "./deconvolution-inl.h"
 
@@ -83,6 +85,92 @@ struct UpSamplingParam : public dmlc::Parameter<UpSamplingParam> {
   }
 };  // struct UpSamplingParam
 
+/*!
+ * \brief Nearest neighbor upsampling by scale of the planes of data, of height x width, into the
+ *        channels [begin, begin + channels) of out, which has out_channels per image. It runs by
+ *        input rows: each one is widened once and copied to the other scale - 1 output rows.
+ */
+template <typename DType>
+void UpSamplingNearestForwardCPU(const DType* data,
+                                 DType* out,
+                                 const index_t num,
+                                 const index_t channels,
+                                 const index_t out_channels,
+                                 const index_t begin,
+                                 const index_t height,
+                                 const index_t width,
+                                 const int scale,
+                                 const bool add) {
+  const index_t out_width = width * scale;
+  const index_t out_plane = height * scale * out_width;
+  const index_t num_rows  = num * channels * height;
+  const int nthreads      = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(nthreads)
+  for (index_t row = 0; row < num_rows; ++row) {
+    const index_t plane     = row / height;
+    const index_t h         = row % height;
+    const index_t out_index = (plane / channels) * out_channels + begin + plane % channels;
+    const DType* in_row     = data + row * width;
+    DType* out_row          = out + out_index * out_plane + h * scale * out_width;
+    if (add) {
+      for (int r = 0; r < scale; ++r, out_row += out_width) {
+        for (index_t w = 0; w < width; ++w) {
+          for (int j = 0; j < scale; ++j) {
+            out_row[w * scale + j] += in_row[w];
+          }
+        }
+      }
+    } else {
+      for (index_t w = 0; w < width; ++w) {
+        for (int j = 0; j < scale; ++j) {
+          out_row[w * scale + j] = in_row[w];
+        }
+      }
+      for (int r = 1; r < scale; ++r) {
+        std::copy(out_row, out_row + out_width, out_row + r * out_width);
+      }
+    }
+  }
+}
+
+/*!
+ * \brief Gradient of UpSamplingNearestForwardCPU: the sums of the scale x scale blocks of the
+ *        channels [begin, begin + channels) of grad, which has grad_channels per image.
+ */
+template <typename DType>
+void UpSamplingNearestBackwardCPU(const DType* grad,
+                                  DType* in_grad,
+                                  const index_t num,
+                                  const index_t channels,
+                                  const index_t grad_channels,
+                                  const index_t begin,
+                                  const index_t height,
+                                  const index_t width,
+                                  const int scale,
+                                  const bool add) {
+  const index_t out_width = width * scale;
+  const index_t out_plane = height * scale * out_width;
+  const index_t num_rows  = num * channels * height;
+  const int nthreads      = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(nthreads)
+  for (index_t row = 0; row < num_rows; ++row) {
+    const index_t plane      = row / height;
+    const index_t h          = row % height;
+    const index_t grad_index = (plane / channels) * grad_channels + begin + plane % channels;
+    DType* in_row            = in_grad + row * width;
+    const DType* g           = grad + grad_index * out_plane + h * scale * out_width;
+    for (index_t w = 0; w < width; ++w) {
+      DType sum(0);
+      for (int r = 0; r < scale; ++r) {
+        for (int j = 0; j < scale; ++j) {
+          sum += g[r * out_width + w * scale + j];
+        }
+      }
+      in_row[w] = add ? in_row[w] + sum : sum;
+    }
+  }
+}
+
 template <typename xpu, typename DType>
 void UpSamplingForward(const OpContext& ctx,
                        const UpSamplingParam& param,
@@ -96,6 +184,29 @@ void UpSamplingForward(const OpContext& ctx,
   if (req[up_enum::kOut] == kNullOp) {
     return;
   }
+  if constexpr (std::is_same<xpu, cpu>::value) {
+    const TBlob& out = out_data[up_enum::kOut];
+    index_t begin    = 0;
+    for (int i = 0; i < param.num_args; ++i) {
+      const TBlob& data = in_data[i];
+      // the inputs after the first one are added to it in sum mode
+      const bool add = req[up_enum::kOut] == kAddTo ||
+                       (param.multi_input_mode == up_enum::kSum && i > 0);
+      UpSamplingNearestForwardCPU(data.dptr<DType>(),
+                                  out.dptr<DType>(),
+                                  data.size(0),
+                                  data.size(1),
+                                  out.size(1),
+                                  begin,
+                                  data.size(2),
+                                  data.size(3),
+                                  out.size(2) / data.size(2),
+                                  add);
+      if (param.multi_input_mode != up_enum::kSum)
+        begin += data.size(1);
+    }
+    return;
+  }
   Stream<xpu>* s            = ctx.get_stream<xpu>();
   Tensor<xpu, 4, DType> out = out_data[up_enum::kOut].get<xpu, 4, DType>(s);
   if (param.num_args > 1) {
@@ -130,6 +241,27 @@ void UpSamplingBackward(const OpContext& ctx,
   using namespace mshadow;
   using namespace mshadow::expr;
   CHECK_EQ(in_grad.size(), static_cast<size_t>(param.num_args));
+  if constexpr (std::is_same<xpu, cpu>::value) {
+    index_t begin = 0;
+    for (int i = 0; i < param.num_args; ++i) {
+      const TBlob& input_grad = in_grad[i];
+      if (req[i] != kNullOp) {
+        UpSamplingNearestBackwardCPU(out_grad.dptr<DType>(),
+                                     input_grad.dptr<DType>(),
+                                     input_grad.size(0),
+                                     input_grad.size(1),
+                                     out_grad.size(1),
+                                     begin,
+                                     input_grad.size(2),
+                                     input_grad.size(3),
+                                     out_grad.size(2) / input_grad.size(2),
+                                     req[i] == kAddTo);
+      }
+      if (param.multi_input_mode != up_enum::kSum)
+        begin += input_grad.size(1);
+    }
+    return;
+  }
   Stream<xpu>* s             = ctx.get_stream<xpu>();
   Tensor<xpu, 4, DType> grad = out_grad.get<xpu, 4, DType>(s);
   if (param.num_args > 1) {
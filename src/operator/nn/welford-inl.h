@@ -0,0 +1,325 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file welford-inl.h
+ * \brief Single-pass mean and variance shared by the moments and normalization operators
+ */
+#ifndef MXNET_OPERATOR_NN_WELFORD_INL_H_
+#define MXNET_OPERATOR_NN_WELFORD_INL_H_
+
+#include <algorithm>
+#include <type_traits>
+#include "../math_functions-inl.h"
+#include "../tensor/broadcast_reduce_op.h"
+
+namespace mxnet {
+namespace op {
+namespace welford {
+
+/*! \brief Accumulation type: double for double and integer inputs, float otherwise */
+template <typename DType>
+using AccType = typename std::conditional<std::is_same<DType, double>::value ||
+                                              std::is_integral<DType>::value,
+                                          double,
+                                          float>::type;
+
+/*! \brief Number of contiguous values summed together before being merged into a State */
+const index_t kBlock = 64;
+
+/*!
+ * \brief Running count, mean and sum of squared deviations (M2) of a set of values.
+ *        The count is an integer, a float one stops increasing at 2^24 values.
+ */
+template <typename AType>
+struct State {
+  AType mean;
+  AType m2;
+  index_t count;
+
+  MSHADOW_XINLINE State() : mean(0), m2(0), count(0) {}
+
+  /*! \brief Add one value (Welford's update) */
+  MSHADOW_XINLINE void Push(const AType x) {
+    count += 1;
+    const AType delta = x - mean;
+    mean += delta / static_cast<AType>(count);
+    m2 += delta * (x - mean);
+  }
+
+  /*! \brief Add the moments of a disjoint set of values (Chan et al.) */
+  MSHADOW_XINLINE void Merge(const AType b_mean, const AType b_m2, const index_t b_count) {
+    if (b_count == 0)
+      return;
+    const index_t n   = count + b_count;
+    const AType delta = b_mean - mean;
+    const AType w     = static_cast<AType>(b_count) / static_cast<AType>(n);
+    mean += delta * w;
+    m2 += b_m2 + delta * delta * static_cast<AType>(count) * w;
+    count = n;
+  }
+
+  MSHADOW_XINLINE void Merge(const State& b) {
+    Merge(b.mean, b.m2, b.count);
+  }
+};
+
+/*!
+ * \brief Add len contiguous values. Each block of kBlock values is summed relative to its
+ *        first value, which vectorizes and keeps the sums small even in half precision,
+ *        and the block is then merged into the state.
+ */
+template <typename AType, typename DType>
+MSHADOW_XINLINE void PushContiguous(State<AType>* st, const DType* x, const index_t len) {
+  for (index_t b = 0; b < len; b += kBlock) {
+    const index_t n     = len - b < kBlock ? len - b : kBlock;
+    const AType shift   = static_cast<AType>(x[b]);
+    AType s1 = 0, s2 = 0;
+#if !defined(__CUDA_ARCH__)
+#pragma omp simd reduction(+ : s1, s2)
+#endif
+    for (index_t i = 0; i < n; ++i) {
+      const AType d = static_cast<AType>(x[b + i]) - shift;
+      s1 += d;
+      s2 += d * d;
+    }
+    const AType block_mean = s1 / n;
+    st->Merge(shift + block_mean, s2 - s1 * block_mean, n);
+  }
+}
+
+/*!
+ * \brief Moments of the piece c out of nchunk of the reduction of output i.
+ *        rshape and rstride come from broadcast::diff, so the innermost reduced axis is
+ *        run_axis and the axes after it have extent 1.
+ *        With interleave the piece takes every nchunk-th value, so that neighbouring GPU
+ *        threads read neighbouring addresses. Otherwise it is a contiguous range of the
+ *        reduction, which is read run by run along run_axis.
+ */
+template <bool interleave, int ndim, typename AType, typename DType>
+MSHADOW_XINLINE State<AType> PartialMoments(const index_t i,
+                                            const index_t c,
+                                            const index_t nchunk,
+                                            const index_t M,
+                                            const DType* big,
+                                            const Shape<ndim>& bshape,
+                                            const Shape<ndim>& sshape,
+                                            const Shape<ndim>& rshape,
+                                            const Shape<ndim>& rstride,
+                                            const int run_axis) {
+  const index_t base = mxnet_op::ravel(mxnet_op::unravel(i, sshape), bshape);
+  State<AType> st;
+  if (interleave) {
+    for (index_t m = c; m < M; m += nchunk) {
+      const index_t k = base + mxnet_op::dot(mxnet_op::unravel(m, rshape), rstride);
+      st.Push(static_cast<AType>(big[k]));
+    }
+    return st;
+  }
+  const index_t len  = (M + nchunk - 1) / nchunk;
+  const index_t end  = c * len + len < M ? c * len + len : M;
+  const index_t run  = rshape[run_axis];
+  const index_t step = rstride[run_axis];
+  for (index_t m = c * len; m < end;) {
+    const index_t n = run - m % run < end - m ? run - m % run : end - m;
+    const DType* x  = big + base + mxnet_op::dot(mxnet_op::unravel(m, rshape), rstride);
+    if (step == 1) {
+      PushContiguous(&st, x, n);
+    } else {
+      for (index_t j = 0; j < n; ++j)
+        st.Push(static_cast<AType>(x[j * step]));
+    }
+    m += n;
+  }
+  return st;
+}
+
+/*!
+ * \brief Write the mean and the variance with ddof delta degrees of freedom,
+ *        or sqrt(variance + eps) with take_sqrt.
+ */
+template <typename AType, typename MType, typename VType>
+MSHADOW_XINLINE void Finalize(const State<AType>& st,
+                              MType* mean,
+                              VType* var,
+                              const OpReqType mean_req,
+                              const OpReqType var_req,
+                              const AType ddof,
+                              const AType eps,
+                              const bool take_sqrt) {
+  AType v = st.m2 / (static_cast<AType>(st.count) - ddof);
+  if (take_sqrt)
+    v = math::sqrt(v + eps);
+  KERNEL_ASSIGN(*mean, mean_req, static_cast<MType>(st.mean));
+  KERNEL_ASSIGN(*var, var_req, static_cast<VType>(v));
+}
+
+/*! \brief Moments of output i, when the reduction is not split */
+template <bool interleave, int ndim>
+struct moments_kernel {
+  template <typename AType, typename DType, typename VType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  const DType* big,
+                                  DType* mean,
+                                  VType* var,
+                                  const OpReqType mean_req,
+                                  const OpReqType var_req,
+                                  const index_t M,
+                                  const Shape<ndim> bshape,
+                                  const Shape<ndim> sshape,
+                                  const Shape<ndim> rshape,
+                                  const Shape<ndim> rstride,
+                                  const int run_axis,
+                                  const AType ddof,
+                                  const AType eps,
+                                  const bool take_sqrt) {
+    const State<AType> st = PartialMoments<interleave, ndim, AType>(
+        i, 0, 1, M, big, bshape, sshape, rshape, rstride, run_axis);
+    Finalize(st, mean + i, var + i, mean_req, var_req, ddof, eps, take_sqrt);
+  }
+};
+
+/*! \brief Moments of the piece u % nchunk of output u / nchunk */
+template <bool interleave, int ndim>
+struct partial_moments_kernel {
+  template <typename AType, typename DType>
+  MSHADOW_XINLINE static void Map(index_t u,
+                                  State<AType>* partial,
+                                  const DType* big,
+                                  const index_t nchunk,
+                                  const index_t M,
+                                  const Shape<ndim> bshape,
+                                  const Shape<ndim> sshape,
+                                  const Shape<ndim> rshape,
+                                  const Shape<ndim> rstride,
+                                  const int run_axis) {
+    partial[u] = PartialMoments<interleave, ndim, AType>(
+        u / nchunk, u % nchunk, nchunk, M, big, bshape, sshape, rshape, rstride, run_axis);
+  }
+};
+
+/*! \brief Merge the nchunk pieces of output i in order */
+struct merge_moments_kernel {
+  template <typename AType, typename DType, typename VType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  const State<AType>* partial,
+                                  DType* mean,
+                                  VType* var,
+                                  const OpReqType mean_req,
+                                  const OpReqType var_req,
+                                  const index_t nchunk,
+                                  const AType ddof,
+                                  const AType eps,
+                                  const bool take_sqrt) {
+    State<AType> st = partial[i * nchunk];
+    for (index_t c = 1; c < nchunk; ++c)
+      st.Merge(partial[i * nchunk + c]);
+    Finalize(st, mean + i, var + i, mean_req, var_req, ddof, eps, take_sqrt);
+  }
+};
+
+/*!
+ * \brief Number of pieces the reduction of each of the N outputs over M values is split
+ *        into, so that small outputs counts still fill the CPU threads or the GPU.
+ */
+template <typename xpu>
+inline index_t NumChunks(const index_t N, const index_t M) {
+  if (std::is_same<xpu, mshadow::cpu>::value) {
+    const index_t threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+    if (N >= threads)
+      return 1;
+    return std::max<index_t>(1, std::min((threads + N - 1) / N, M / 4096));
+  }
+  const index_t target = 1 << 16;
+  if (N >= target)
+    return 1;
+  return std::max<index_t>(1, std::min(target / N, M / 256));
+}
+
+}  // namespace welford
+
+/*!
+ * \brief Mean and variance of data over the axes where mean and var have extent 1,
+ *        reading data only once. The values are accumulated in float for half precision
+ *        and float inputs, and in double for double and integer inputs.
+ * \param mean      output of the same type as data and the same ndim (keepdims shape)
+ * \param var       output of the same shape as mean, of any type
+ * \param ddof      delta degrees of freedom: the variance is M2 / (count - ddof)
+ * \param eps       added to the variance before the square root with take_sqrt
+ * \param take_sqrt write sqrt(variance + eps), i.e. the standard deviation, into var
+ */
+template <typename xpu>
+void WelfordMomentsCompute(const OpContext& ctx,
+                           const TBlob& data,
+                           const TBlob& mean,
+                           const TBlob& var,
+                           const OpReqType mean_req,
+                           const OpReqType var_req,
+                           const double ddof     = 0,
+                           const double eps      = 0,
+                           const bool take_sqrt = false) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  using welford::State;
+  if (mean_req == kNullOp && var_req == kNullOp)
+    return;
+  CHECK_EQ(mean.type_flag_, data.type_flag_) << "the mean must have the type of the data";
+  CHECK_EQ(mean.shape_, var.shape_);
+  Stream<xpu>* s = ctx.get_stream<xpu>();
+  mxnet::TShape src_shape, dst_shape;
+  BroadcastReduceShapeCompact(data.shape_, mean.shape_, &src_shape, &dst_shape);
+  const index_t N = dst_shape.Size();
+  if (N == 0)
+    return;
+  const index_t M          = src_shape.Size() / N;
+  const index_t nchunk     = welford::NumChunks<xpu>(N, M);
+  constexpr bool interleave = !std::is_same<xpu, cpu>::value;
+  MSHADOW_TYPE_SWITCH(data.type_flag_, DType, {
+    MSHADOW_TYPE_SWITCH(var.type_flag_, VType, {
+      typedef welford::AccType<DType> AType;
+      BROADCAST_NDIM_SWITCH(dst_shape.ndim(), NDim, {
+        const Shape<NDim> bshape = src_shape.get<NDim>();
+        const Shape<NDim> sshape = dst_shape.get<NDim>();
+        Shape<NDim> rshape, rstride;
+        const int run_axis = std::max(0, broadcast::diff(sshape, bshape, &rshape, &rstride) - 1);
+        if (nchunk == 1) {
+          Kernel<welford::moments_kernel<interleave, NDim>, xpu>::Launch(
+              s, N, data.dptr<DType>(), mean.dptr<DType>(), var.dptr<VType>(), mean_req,
+              var_req, M, bshape, sshape, rshape, rstride, run_axis, static_cast<AType>(ddof),
+              static_cast<AType>(eps), take_sqrt);
+        } else {
+          Tensor<xpu, 1, char> workspace = ctx.requested[0].get_space_typed<xpu, 1, char>(
+              Shape1(N * nchunk * sizeof(State<AType>)), s);
+          State<AType>* partial = reinterpret_cast<State<AType>*>(workspace.dptr_);
+          Kernel<welford::partial_moments_kernel<interleave, NDim>, xpu>::Launch(
+              s, N * nchunk, partial, data.dptr<DType>(), nchunk, M, bshape, sshape, rshape,
+              rstride, run_axis);
+          Kernel<welford::merge_moments_kernel, xpu>::Launch(
+              s, N, partial, mean.dptr<DType>(), var.dptr<VType>(), mean_req, var_req, nchunk,
+              static_cast<AType>(ddof), static_cast<AType>(eps), take_sqrt);
+        }
+      });
+    });
+  });
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_NN_WELFORD_INL_H_
@@ -23,6 +23,7 @@
  */
 
 #include "./np_bincount_op-inl.h"
+#include "../tensor/bin_count-inl.h"
 
 namespace mxnet {
 namespace op {
@@ -31,36 +32,31 @@ void BinNumberCount(const NDArray& data,
                     const int& minlength,
                     const NDArray& out,
                     const size_t& N) {
-  int bin = minlength;
+  const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  const index_t n       = N;
+  const index_t nblocks = std::max<index_t>(1, std::min<index_t>(omp_threads, n / 16384));
+  const index_t block   = (n + nblocks - 1) / nblocks;
+  std::vector<int64_t> lo(nblocks, 0), hi(nblocks, minlength - 1);
   MSHADOW_TYPE_SWITCH(data.dtype(), DType, {
-    DType* data_ptr = data.data().dptr<DType>();
-    for (size_t i = 0; i < N; i++) {
-      CHECK_GE(data_ptr[i], 0) << "input should be nonnegative number";
-      if (data_ptr[i] + 1 > bin) {
-        bin = data_ptr[i] + 1;
+    const DType* data_ptr = data.data().dptr<DType>();
+#pragma omp parallel for num_threads(omp_threads)
+    for (index_t b = 0; b < nblocks; ++b) {
+      const index_t end = std::min(n, (b + 1) * block);
+      int64_t min_val   = lo[b], max_val = hi[b];
+      for (index_t i = b * block; i < end; ++i) {
+        min_val = std::min<int64_t>(min_val, data_ptr[i]);
+        max_val = std::max<int64_t>(max_val, data_ptr[i]);
       }
+      lo[b] = min_val;
+      hi[b] = max_val;
     }
-  });  // bin number = max(max(data) + 1, minlength)
-  mxnet::TShape s(1, bin);
+  });
+  CHECK_GE(*std::min_element(lo.begin(), lo.end()), 0) << "input should be nonnegative number";
+  // bin number = max(max(data) + 1, minlength)
+  mxnet::TShape s(1, *std::max_element(hi.begin(), hi.end()) + 1);
   const_cast<NDArray&>(out).Init(s);  // set the output shape forcefully
 }
 
-template <typename DType, typename OType>
-void BincountCpuWeights(const DType* data, const OType* weights, OType* out, const size_t& data_n) {
-  for (size_t i = 0; i < data_n; i++) {
-    int target = data[i];
-    out[target] += weights[i];
-  }
-}
-
-template <typename DType, typename OType>
-void BincountCpu(const DType* data, OType* out, const size_t& data_n) {
-  for (size_t i = 0; i < data_n; i++) {
-    int target = data[i];
-    out[target] += 1;
-  }
-}
-
 template <>
 void NumpyBincountForwardImpl<cpu>(const OpContext& ctx,
                                    const NDArray& data,
@@ -68,17 +64,17 @@ void NumpyBincountForwardImpl<cpu>(const OpContext& ctx,
                                    const NDArray& out,
                                    const size_t& data_n,
                                    const int& minlength) {
-  using namespace mxnet_op;
   BinNumberCount(data, minlength, out, data_n);
-  mshadow::Stream<cpu>* s = ctx.get_stream<cpu>();
   MSHADOW_TYPE_SWITCH(data.dtype(), DType, {
     MSHADOW_TYPE_SWITCH(weights.dtype(), OType, {
-      size_t out_size = out.shape()[0];
-      Kernel<set_zero, cpu>::Launch(s, out_size, out.data().dptr<OType>());
-      BincountCpuWeights(data.data().dptr<DType>(),
-                         weights.data().dptr<OType>(),
-                         out.data().dptr<OType>(),
-                         data_n);
+      const DType* data_ptr    = data.data().dptr<DType>();
+      const OType* weights_ptr = weights.data().dptr<OType>();
+      BinCountCPU(
+          data_n,
+          out.shape()[0],
+          [&](index_t i) { return static_cast<index_t>(data_ptr[i]); },
+          [&](index_t i) { return weights_ptr[i]; },
+          out.data().dptr<OType>());
     });
   });
 }
@@ -89,14 +85,16 @@ void NumpyBincountForwardImpl<cpu>(const OpContext& ctx,
                                    const NDArray& out,
                                    const size_t& data_n,
                                    const int& minlength) {
-  using namespace mxnet_op;
   BinNumberCount(data, minlength, out, data_n);
-  mshadow::Stream<cpu>* s = ctx.get_stream<cpu>();
   MSHADOW_TYPE_SWITCH(data.dtype(), DType, {
     MSHADOW_TYPE_SWITCH(out.dtype(), OType, {
-      size_t out_size = out.shape()[0];
-      Kernel<set_zero, cpu>::Launch(s, out_size, out.data().dptr<OType>());
-      BincountCpu(data.data().dptr<DType>(), out.data().dptr<OType>(), data_n);
+      const DType* data_ptr = data.data().dptr<DType>();
+      BinCountCPU(
+          data_n,
+          out.shape()[0],
+          [&](index_t i) { return static_cast<index_t>(data_ptr[i]); },
+          [](index_t i) { return OType(1); },
+          out.data().dptr<OType>());
     });
   });
 }
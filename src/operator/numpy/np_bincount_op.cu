@@ -27,17 +27,12 @@
 #include <thrust/extrema.h>
 #include "../tensor/util/tensor_util-inl.cuh"
 #include "../tensor/util/tensor_util-inl.h"
+#include "../tensor/bin_count-inl.cuh"
 
 namespace mxnet {
 namespace op {
 
 struct BincountFusedKernel {
-  template <typename DType, typename OType>
-  static MSHADOW_XINLINE void Map(int i, const DType* data, OType* out) {
-    int idx = data[i];
-    atomicAdd(&out[idx], 1);
-  }
-
   template <typename DType, typename OType>
   static MSHADOW_XINLINE void Map(int i, const DType* data, const OType* weights, OType* out) {
     int idx = data[i];
@@ -45,6 +40,16 @@ struct BincountFusedKernel {
   }
 };
 
+/*! \brief Bin of data[i], which is the value itself */
+template <typename DType>
+struct BincountIndex {
+  const DType* data;
+
+  __device__ index_t operator()(const index_t i) const {
+    return static_cast<index_t>(data[i]);
+  }
+};
+
 struct is_valid_check {
   template <typename DType>
   MSHADOW_XINLINE static void Map(int i, char* invalid_ptr, const DType* data) {
@@ -71,6 +76,31 @@ bool CheckInvalidInput(mshadow::Stream<gpu>* s,
   return is_valid == 0;
 }
 
+/*!
+ * \brief Check that the data is nonnegative and set the output shape to
+ *        max(max(data) + 1, minlength) bins
+ */
+inline void BinNumberCount(const OpContext& ctx,
+                           const NDArray& data,
+                           const int& minlength,
+                           const NDArray& out,
+                           const size_t& data_n) {
+  mshadow::Stream<gpu>* s = ctx.get_stream<gpu>();
+  MXNET_NO_FLOAT16_TYPE_SWITCH(data.dtype(), DType, {
+    DType* d_ptr                   = data.data().dptr<DType>();
+    Tensor<gpu, 1, char> workspace = ctx.requested[0].get_space_typed<gpu, 1, char>(Shape1(1), s);
+    char* is_valid_ptr             = reinterpret_cast<char*>(workspace.dptr_);
+    bool is_valid                  = CheckInvalidInput(s, d_ptr, data_n, is_valid_ptr);
+    CHECK(is_valid) << "Input should be nonnegative number";  // check invalid input
+
+    thrust::device_ptr<DType> data_begin(d_ptr);
+    const DType max_val = *thrust::max_element(
+        thrust::cuda::par.on(mshadow::Stream<gpu>::GetStream(s)), data_begin, data_begin + data_n);
+    mxnet::TShape shape(1, std::max<int64_t>(static_cast<int64_t>(max_val) + 1, minlength));
+    const_cast<NDArray&>(out).Init(shape);  // set the output shape forcefully
+  });
+}
+
 template <>
 void NumpyBincountForwardImpl<gpu>(const OpContext& ctx,
                                    const NDArray& data,
@@ -81,31 +111,7 @@ void NumpyBincountForwardImpl<gpu>(const OpContext& ctx,
   using namespace mxnet_op;
   mshadow::Stream<gpu>* s = ctx.get_stream<gpu>();
 
-  MXNET_NO_FLOAT16_TYPE_SWITCH(data.dtype(), DType, {
-    DType* h_ptr;
-    DType* d_ptr;
-    int bin                        = minlength;
-    d_ptr                          = data.data().dptr<DType>();
-    Tensor<gpu, 1, char> workspace = ctx.requested[0].get_space_typed<gpu, 1, char>(Shape1(1), s);
-    char* is_valid_ptr             = reinterpret_cast<char*>(workspace.dptr_);
-    bool is_valid                  = CheckInvalidInput(s, d_ptr, data_n, is_valid_ptr);
-    CHECK(is_valid) << "Input should be nonnegative number";  // check invalid input
-
-    h_ptr = reinterpret_cast<DType*>(malloc(data_n * sizeof(DType)));
-    CUDA_CALL(cudaMemcpyAsync(h_ptr,
-                              d_ptr,
-                              data_n * sizeof(DType),
-                              cudaMemcpyDeviceToHost,
-                              mshadow::Stream<gpu>::GetStream(s)));
-    CUDA_CALL(cudaStreamSynchronize(mshadow::Stream<gpu>::GetStream(s)));
-    for (size_t i = 0; i < data_n; i++) {
-      if (h_ptr[i] + 1 > bin)
-        bin = h_ptr[i] + 1;
-    }
-    free(h_ptr);
-    mxnet::TShape s(1, bin);
-    const_cast<NDArray&>(out).Init(s);  // set the output shape forcefully
-  });
+  BinNumberCount(ctx, data, minlength, out, data_n);
 
   MSHADOW_TYPE_SWITCH(data.dtype(), DType, {
     MSHADOW_TYPE_SWITCH(weights.dtype(), OType, {
@@ -129,38 +135,17 @@ void NumpyBincountForwardImpl<gpu>(const OpContext& ctx,
   using namespace mxnet_op;
   mshadow::Stream<gpu>* s = ctx.get_stream<gpu>();
 
-  MXNET_NO_FLOAT16_TYPE_SWITCH(data.dtype(), DType, {
-    DType* h_ptr;
-    DType* d_ptr;
-    int bin                        = minlength;
-    d_ptr                          = data.data().dptr<DType>();
-    Tensor<gpu, 1, char> workspace = ctx.requested[0].get_space_typed<gpu, 1, char>(Shape1(1), s);
-    char* is_valid_ptr             = reinterpret_cast<char*>(workspace.dptr_);
-    bool is_valid                  = CheckInvalidInput(s, d_ptr, data_n, is_valid_ptr);
-    CHECK(is_valid) << "Input should be nonnegative number";  // check invalid input
-
-    h_ptr = reinterpret_cast<DType*>(malloc(data_n * sizeof(DType)));
-    CUDA_CALL(cudaMemcpyAsync(h_ptr,
-                              d_ptr,
-                              data_n * sizeof(DType),
-                              cudaMemcpyDeviceToHost,
-                              mshadow::Stream<gpu>::GetStream(s)));
-    CUDA_CALL(cudaStreamSynchronize(mshadow::Stream<gpu>::GetStream(s)));
-    for (size_t i = 0; i < data_n; i++) {
-      if (h_ptr[i] + 1 > bin)
-        bin = h_ptr[i] + 1;
-    }
-    free(h_ptr);
-    mxnet::TShape s(1, bin);
-    const_cast<NDArray&>(out).Init(s);  // set the output shape forcefully
-  });
+  BinNumberCount(ctx, data, minlength, out, data_n);
 
   MSHADOW_TYPE_SWITCH(data.dtype(), DType, {
     MSHADOW_TYPE_SWITCH(out.dtype(), OType, {
-      size_t out_size = out.shape().Size();
-      Kernel<set_zero, gpu>::Launch(s, out_size, out.data().dptr<OType>());
-      Kernel<BincountFusedKernel, gpu>::Launch(
-          s, data_n, data.data().dptr<DType>(), out.data().dptr<OType>());
+      BincountIndex<DType> bin{data.data().dptr<DType>()};
+      BinCountGPU(s,
+                  ctx.run_ctx.ctx.dev_id,
+                  data_n,
+                  out.shape().Size(),
+                  bin,
+                  out.data().dptr<OType>());
     });
   });
 }
@@ -1116,8 +1116,6 @@ void NumpyMomentsForward(const nnvm::NodeAttrs& attrs,
 
   const NumpyMomentsParam& param = nnvm::get<NumpyMomentsParam>(attrs.parsed);
 
-  Stream<xpu>* s = ctx.get_stream<xpu>();
-
   const TBlob& data   = inputs[0];
   const TBlob& moment = outputs[0];
   const TBlob& mean   = outputs[1];
@@ -1129,79 +1127,8 @@ void NumpyMomentsForward(const nnvm::NodeAttrs& attrs,
     small = NumpyReduceAxesShapeImpl(data.shape_, param.axis, true);
   }
 
-  mxnet::TShape src_shape, dst_shape;
-  BroadcastReduceShapeCompact(data.shape_, small, &src_shape, &dst_shape);
-
-  // Get workspace and temp space for data - mean
-  size_t workspace_size = broadcast::ReduceWorkspaceSize(s, dst_shape, req[0], src_shape);
-  size_t temp_data_size = data.shape_.Size() * common::mshadow_type_info(inputs[0].type_flag_).size;
-  size_t temp_mem_size  = temp_data_size + workspace_size;
-  Tensor<xpu, 1, char> temp_mem =
-      ctx.requested[0].get_space_typed<xpu, 1, char>(Shape1(temp_mem_size), s);
-  char* workspace_ptr = temp_mem.dptr_ + temp_data_size;
-  Tensor<xpu, 1, char> workspace(workspace_ptr, Shape1(workspace_size), s);
-  // Compute mean
-#if !defined(__CUDACC__)
-  ReduceAxesComputeImpl<xpu, mshadow_op::sum, true, true>(
-      ctx, inputs, {kWriteTo}, {mean}, small, &workspace);
-#else
-  ReduceAxesRTCComputeImpl(
-      ctx, inputs, {kWriteTo}, {mean}, small, "red::sum{}", &workspace, true, "identity");
-#endif
-  // Compute data - mean
-  Shape<6> data_shape, mean_shape;
-  for (int i = 0; i < 6; ++i) {
-    data_shape[i] = (i < data.shape_.ndim()) ? data.shape_[i] : 1;
-    mean_shape[i] = (i < small.ndim()) ? small[i] : 1;
-  }
-#if !defined(__CUDACC__)
-  MSHADOW_TYPE_SWITCH(inputs[0].type_flag_, DType, {
-    MSHADOW_TYPE_SWITCH(outputs[0].type_flag_, OType, {
-      DType* temp_data_ptr = reinterpret_cast<DType*>(temp_mem.dptr_);
-      Kernel<VarBroadcastKernel, xpu>::Launch(s,
-                                              data_shape.Size(),
-                                              temp_data_ptr,
-                                              data.dptr<DType>(),
-                                              mean.dptr<DType>(),
-                                              data_shape,
-                                              mean_shape);
-      Tensor<xpu, 1, DType> temp_data_tensor(temp_data_ptr, Shape1(data.shape_.Size()), s);
-      TBlob temp_data_blob = TBlob(temp_data_tensor).reshape(data.shape_);
-      ReduceAxesComputeImpl<xpu, mshadow_op::sum, true, true>(
-          ctx, {temp_data_blob}, {req[0]}, {moment}, small, &workspace, param.ddof);
-      if (sqrt && req[0] != kNullOp) {
-        Tensor<xpu, 1, OType> moment_tensor = moment.FlatTo1D<xpu, OType>(s);
-        moment_tensor                       = F<mshadow_op::square_root>(moment_tensor);
-      }
-    });
-  });
-#else
-  MSHADOW_TYPE_SWITCH(inputs[0].type_flag_, DType, {
-    DType* temp_data_ptr = reinterpret_cast<DType*>(temp_mem.dptr_);
-    Kernel<VarBroadcastKernel, xpu>::Launch(s,
-                                            data_shape.Size(),
-                                            temp_data_ptr,
-                                            data.dptr<DType>(),
-                                            mean.dptr<DType>(),
-                                            data_shape,
-                                            mean_shape);
-    Tensor<xpu, 1, DType> temp_data_tensor(temp_data_ptr, Shape1(data.shape_.Size()), s);
-    TBlob temp_data_blob = TBlob(temp_data_tensor).reshape(data.shape_);
-    ReduceAxesRTCComputeImpl(ctx,
-                             {temp_data_blob},
-                             {req[0]},
-                             {moment},
-                             small,
-                             "red::sum{}",
-                             &workspace,
-                             true,
-                             "identity",
-                             param.ddof);
-    if (sqrt && req[0] != kNullOp) {
-      UnaryRTCCompute{"sqrt"}({}, ctx, {moment}, {kWriteInplace}, {moment});  // NOLINT
-    }
-  });
-#endif
+  WelfordMomentsCompute<xpu>(
+      ctx, data, mean.reshape(small), moment.reshape(small), req[1], req[0], param.ddof, 0, sqrt);
 }
 
 template <typename xpu>
@@ -231,11 +231,42 @@ inline static bool NumpyReduceAxesStorageType(const nnvm::NodeAttrs& attrs,
 
   bool onednn_disptach = true;
   if (param.dtype.has_value()) {
-    onednn_disptach = param.dtype.value() == mshadow::kFloat32;
+    onednn_disptach = SupportDNNLType<DNNLTypeMode::FloatTypes>(param.dtype.value());
   }
 
   return DNNLStorageType(attrs, dev_mask, onednn_disptach, dispatch_mode, in_attrs, out_attrs);
 }
+
+template <typename reducer, dnnl::algorithm reduction_alg>
+static void DNNLReduceNoDTypeEx(const nnvm::NodeAttrs& attrs,
+                                const OpContext& ctx,
+                                const std::vector<NDArray>& inputs,
+                                const std::vector<OpReqType>& req,
+                                const std::vector<NDArray>& outputs) {
+  CHECK_EQ(inputs.size(), 1U);
+  CHECK_EQ(outputs.size(), 1U);
+
+  if (SupportDNNLReduce<NumpyReduceAxesNoDTypeParam>(attrs, inputs[0], outputs[0])) {
+    DNNLRun(DNNLReduceForward<NumpyReduceAxesNoDTypeParam, reduction_alg>,
+            attrs,
+            ctx,
+            inputs[0],
+            req[0],
+            outputs[0]);
+  } else {
+    FallBackCompute(NumpyReduceAxesNoDTypeCompute<cpu, reducer>, attrs, ctx, inputs, req, outputs);
+  }
+}
+
+inline static bool NumpyReduceAxesNoDTypeStorageType(const nnvm::NodeAttrs& attrs,
+                                                     const int dev_mask,
+                                                     DispatchMode* dispatch_mode,
+                                                     std::vector<int>* in_attrs,
+                                                     std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 1);
+  CHECK_EQ(out_attrs->size(), 1);
+  return DNNLStorageType(attrs, dev_mask, true, dispatch_mode, in_attrs, out_attrs);
+}
 #endif
 
 }  // namespace op
@@ -27,12 +27,14 @@
 
 #include <mxnet/base.h>
 #include <mxnet/operator_util.h>
+#include <algorithm>
 #include <vector>
 #include <string>
 #include "../mxnet_op.h"
 #include "../operator_common.h"
 #include "../elemwise_op_common.h"
 #include "../../api/operator/op_utils.h"
+#include "../../engine/openmp.h"
 
 namespace mxnet {
 namespace op {
@@ -73,24 +75,225 @@ struct CumsumParam : public dmlc::Parameter<CumsumParam> {
   }
 };
 
-struct cumsum_forward {
+/*!
+ * \brief Sum of every chunk of rows of every lane, the first pass of a chunked scan.
+ *        Thread i handles the lane i % lanes, i.e. column i % trailing of line
+ *        i / trailing % outer, within the chunk of rows i / lanes. Rows are taken from the
+ *        end of the axis when reverse is set.
+ */
+template <bool reverse>
+struct cumsum_chunk_sum {
+  template <typename IType, typename OType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  OType* sums,
+                                  const IType* in,
+                                  const index_t lanes,
+                                  const index_t middle,
+                                  const index_t trailing,
+                                  const index_t chunk) {
+    const index_t lane = i % lanes, k = i / lanes;
+    const index_t left = lane / trailing, right = lane % trailing;
+    const IType* lane_in = in + left * middle * trailing + right;
+    const index_t end    = (k + 1) * chunk < middle ? (k + 1) * chunk : middle;
+    OType sum            = OType(0);
+    for (index_t r = k * chunk; r < end; ++r) {
+      sum += OType(lane_in[(reverse ? middle - 1 - r : r) * trailing]);
+    }
+    sums[i] = sum;
+  }
+};
+
+/*!
+ * \brief Turn the chunk sums of every lane into the exclusive offsets of the chunks.
+ */
+struct cumsum_chunk_offset {
+  template <typename OType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  OType* sums,
+                                  const index_t lanes,
+                                  const index_t nchunks) {
+    OType offset = OType(0);
+    for (index_t k = 0; k < nchunks; ++k) {
+      const OType sum     = sums[k * lanes + i];
+      sums[k * lanes + i] = offset;
+      offset += sum;
+    }
+  }
+};
+
+/*!
+ * \brief Scan every chunk of rows of every lane from its offset, or from zero when there
+ *        are no offsets, laid out as in cumsum_chunk_sum. With a single chunk this is a serial
+ *        scan of every lane.
+ */
+template <bool reverse>
+struct cumsum_chunk_scan {
   template <typename IType, typename OType>
   MSHADOW_XINLINE static void Map(index_t i,
                                   OType* out,
                                   const IType* in,
+                                  const OType* offsets,
+                                  const index_t lanes,
                                   const index_t middle,
-                                  const index_t trailing) {
-    index_t left = i / trailing, right = i % trailing;
-    index_t offset       = left * middle * trailing + right;
+                                  const index_t trailing,
+                                  const index_t chunk) {
+    const index_t lane = i % lanes, k = i / lanes;
+    const index_t left = lane / trailing, right = lane % trailing;
+    const index_t offset = left * middle * trailing + right;
     const IType* lane_in = in + offset;
     OType* lane_out      = out + offset;
-    lane_out[0]          = OType(lane_in[0]);
-    for (index_t j = 1; j < middle; ++j) {
-      lane_out[j * trailing] = lane_out[(j - 1) * trailing] + OType(lane_in[j * trailing]);
+    const index_t end    = (k + 1) * chunk < middle ? (k + 1) * chunk : middle;
+    OType sum            = offsets == nullptr ? OType(0) : offsets[i];
+    for (index_t r = k * chunk; r < end; ++r) {
+      const index_t j = (reverse ? middle - 1 - r : r) * trailing;
+      sum += OType(lane_in[j]);
+      lane_out[j] = sum;
     }
   }
 };
 
+/*!
+ * \brief Cumulative sum of the outer x middle x trailing array in along middle, from the end
+ *        of the axis when reverse is set. Every column of every line is one lane. When there
+ *        are too few lanes to fill the device, the lanes are cut into chunks of rows which are
+ *        summed, offset by the sums of the chunks before them and scanned in parallel.
+ */
+template <bool reverse, typename xpu, typename IType, typename OType>
+inline void CumsumLanes(const OpContext& ctx,
+                        mshadow::Stream<xpu>* s,
+                        OType* out,
+                        const IType* in,
+                        const index_t outer,
+                        const index_t middle,
+                        const index_t trailing) {
+  using namespace mxnet_op;
+  // threads to keep the device busy, and rows below which a chunk is not worth a thread
+  const index_t kMinThreads = 65536, kMinChunk = 64;
+  const index_t lanes       = outer * trailing;
+  const index_t nchunks     = std::max<index_t>(
+      1, std::min((kMinThreads + lanes - 1) / lanes, middle / kMinChunk));
+  const index_t chunk = (middle + nchunks - 1) / nchunks;
+  if (nchunks == 1) {
+    Kernel<cumsum_chunk_scan<reverse>, xpu>::Launch(
+        s, lanes, out, in, static_cast<OType*>(nullptr), lanes, middle, trailing, middle);
+    return;
+  }
+  OType* sums = ctx.requested[0]
+                    .get_space_typed<xpu, 1, OType>(mshadow::Shape1(lanes * nchunks), s)
+                    .dptr_;
+  Kernel<cumsum_chunk_sum<reverse>, xpu>::Launch(
+      s, lanes * nchunks, sums, in, lanes, middle, trailing, chunk);
+  Kernel<cumsum_chunk_offset, xpu>::Launch(s, lanes, sums, lanes, nchunks);
+  Kernel<cumsum_chunk_scan<reverse>, xpu>::Launch(
+      s, lanes * nchunks, out, in, sums, lanes, middle, trailing, chunk);
+}
+
+/*!
+ * \brief The CPU version of CumsumLanes. The lanes are scanned a block of contiguous columns
+ *        at a time, so that the innermost loop runs over the columns and vectorizes. When
+ *        there are fewer blocks than threads, e.g. for one long axis, the rows are also cut
+ *        into chunks: the first pass sums every chunk, the chunk sums are scanned serially and
+ *        the second pass scans every chunk from its offset.
+ */
+template <bool reverse, typename IType, typename OType>
+inline void CumsumLanes(const OpContext& ctx,
+                        mshadow::Stream<cpu>* s,
+                        OType* out,
+                        const IType* in,
+                        const index_t outer,
+                        const index_t middle,
+                        const index_t trailing) {
+  // columns of a block, and elements below which a chunk is not worth a thread
+  const index_t kColBlock = 256, kMinChunk = 16384;
+  const int omp_threads   = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  const index_t cblocks   = (trailing + kColBlock - 1) / kColBlock;
+  const index_t blocks    = outer * cblocks;
+  const index_t width     = std::min(trailing, kColBlock);
+  index_t nchunks         = 1;
+  if (blocks < omp_threads) {
+    nchunks = std::max<index_t>(
+        1, std::min((omp_threads + blocks - 1) / blocks, middle * width / kMinChunk));
+  }
+  const index_t chunk = (middle + nchunks - 1) / nchunks;
+  // offsets of chunk k of line o in offsets[(o * nchunks + k) * trailing, ...)
+  std::vector<OType> offsets(nchunks > 1 ? outer * nchunks * trailing : 0, OType(0));
+  auto row = [&](const index_t o, const index_t r) {
+    return (o * middle + (reverse ? middle - 1 - r : r)) * trailing;
+  };
+  if (nchunks > 1) {
+#pragma omp parallel for num_threads(omp_threads)
+    for (index_t task = 0; task < blocks * (nchunks - 1); ++task) {
+      const index_t o = task / cblocks / (nchunks - 1), k = task / cblocks % (nchunks - 1);
+      const index_t c0 = task % cblocks * kColBlock, c1 = std::min(c0 + kColBlock, trailing);
+      // chunk k is summed into the offsets of chunk k + 1
+      OType* sum = offsets.data() + (o * nchunks + k + 1) * trailing;
+      for (index_t r = k * chunk; r < std::min((k + 1) * chunk, middle); ++r) {
+        const IType* src = in + row(o, r);
+        for (index_t c = c0; c < c1; ++c) {
+          sum[c] += OType(src[c]);
+        }
+      }
+    }
+    for (index_t o = 0; o < outer; ++o) {
+      for (index_t k = 2; k < nchunks; ++k) {
+        OType* offset     = offsets.data() + (o * nchunks + k) * trailing;
+        const OType* prev = offset - trailing;
+        for (index_t c = 0; c < trailing; ++c) {
+          offset[c] += prev[c];
+        }
+      }
+    }
+  }
+#pragma omp parallel for num_threads(omp_threads) if (outer * middle * trailing > kMinChunk)
+  for (index_t task = 0; task < blocks * nchunks; ++task) {
+    const index_t o = task / cblocks / nchunks, k = task / cblocks % nchunks;
+    const index_t c0 = task % cblocks * kColBlock, c1 = std::min(c0 + kColBlock, trailing);
+    const index_t r0 = k * chunk, r1 = std::min(r0 + chunk, middle);
+    if (r0 >= r1)
+      continue;
+    const OType* prev = k == 0 ? nullptr : offsets.data() + (o * nchunks + k) * trailing;
+    for (index_t r = r0; r < r1; ++r) {
+      const IType* src = in + row(o, r);
+      OType* dst       = out + row(o, r);
+      if (prev == nullptr) {
+        for (index_t c = c0; c < c1; ++c) {
+          dst[c] = OType(src[c]);
+        }
+      } else {
+        for (index_t c = c0; c < c1; ++c) {
+          dst[c] = prev[c] + OType(src[c]);
+        }
+      }
+      prev = dst;
+    }
+  }
+}
+
+/*!
+ * \brief Normalized axis and the outer x middle x trailing view of shape for a scan along
+ *        axis, or along the flattened array when there is no axis.
+ */
+inline void CumsumDims(const mxnet::TShape& shape,
+                       const dmlc::optional<int>& axis,
+                       index_t* outer,
+                       index_t* middle,
+                       index_t* trailing) {
+  *outer    = 1;
+  *middle   = shape.Size();
+  *trailing = 1;
+  if (!axis.has_value())
+    return;
+  const int ndim = shape.ndim();
+  const int ax   = axis.value() < 0 ? axis.value() + ndim : axis.value();
+  *middle        = shape[ax];
+  for (int i = 0; i < ax; ++i) {
+    *outer *= shape[i];
+  }
+  for (int i = ax + 1; i < ndim; ++i) {
+    *trailing *= shape[i];
+  }
+}
+
 template <typename xpu>
 void CumsumForwardImpl(const OpContext& ctx,
                        const TBlob& in,
@@ -103,21 +306,15 @@ void CumsumForwardImpl(const OpContext& ctx,
         ((axis.value() >= -out.shape_.ndim()) && axis.value() < out.shape_.ndim()))
       << "axis value " << axis.value() << " out of range";
 
-  size_t middle = axis.has_value() ? out.shape_[axis.value()] : out.Size();
+  index_t outer, middle, trailing;
+  CumsumDims(out.shape_, axis, &outer, &middle, &trailing);
   if (middle == 0 || out.Size() == 0)
     return;
-  size_t trailing = 1;
-  if (axis.has_value()) {
-    for (index_t i = axis.value() + 1; i < out.shape_.ndim(); ++i) {
-      trailing *= out.shape_[i];
-    }
-  }
 
   Stream<xpu>* s = ctx.get_stream<xpu>();
   MSHADOW_TYPE_SWITCH_WITH_BOOL(in.type_flag_, IType, {
     MSHADOW_TYPE_SWITCH(out.type_flag_, OType, {
-      Kernel<cumsum_forward, xpu>::Launch(
-          s, out.Size() / middle, out.dptr<OType>(), in.dptr<IType>(), middle, trailing);
+      CumsumLanes<false>(ctx, s, out.dptr<OType>(), in.dptr<IType>(), outer, middle, trailing);
     });
   });
 }
@@ -138,24 +335,6 @@ void CumsumForward(const nnvm::NodeAttrs& attrs,
   CumsumForwardImpl<xpu>(ctx, inputs[0], outputs[0], param.axis);
 }
 
-struct cumsum_backward {
-  template <typename IType, typename OType>
-  MSHADOW_XINLINE static void Map(index_t i,
-                                  IType* igrad,
-                                  const OType* ograd,
-                                  const index_t middle,
-                                  const index_t trailing) {
-    index_t left = i / trailing, right = i % trailing;
-    index_t offset                      = left * middle * trailing + right;
-    const OType* lane_ograd             = ograd + offset;
-    IType* lane_igrad                   = igrad + offset;
-    lane_igrad[(middle - 1) * trailing] = IType(lane_ograd[(middle - 1) * trailing]);
-    for (index_t j = middle - 2; j >= 0; --j) {
-      lane_igrad[j * trailing] = lane_igrad[(j + 1) * trailing] + IType(lane_ograd[j * trailing]);
-    }
-  }
-};
-
 template <typename xpu>
 void CumsumBackwardImpl(const OpContext& ctx,
                         const TBlob& ograd,
@@ -163,20 +342,15 @@ void CumsumBackwardImpl(const OpContext& ctx,
                         const dmlc::optional<int>& axis) {
   using namespace mshadow;
   using namespace mxnet_op;
-  size_t middle = axis.has_value() ? igrad.shape_[axis.value()] : igrad.Size();
+  index_t outer, middle, trailing;
+  CumsumDims(igrad.shape_, axis, &outer, &middle, &trailing);
   if (middle == 0 || igrad.Size() == 0)
     return;
-  size_t trailing = 1;
-  if (axis.has_value()) {
-    for (index_t i = axis.value() + 1; i < igrad.shape_.ndim(); ++i) {
-      trailing *= igrad.shape_[i];
-    }
-  }
   Stream<xpu>* s = ctx.get_stream<xpu>();
   MSHADOW_TYPE_SWITCH_WITH_BOOL(igrad.type_flag_, IType, {
     MSHADOW_TYPE_SWITCH(ograd.type_flag_, OType, {
-      Kernel<cumsum_backward, xpu>::Launch(
-          s, igrad.Size() / middle, igrad.dptr<IType>(), ograd.dptr<OType>(), middle, trailing);
+      CumsumLanes<true>(
+          ctx, s, igrad.dptr<IType>(), ograd.dptr<OType>(), outer, middle, trailing);
     });
   });
 }
@@ -79,6 +79,10 @@ NNVM_REGISTER_OP(_npi_cumsum)
     .set_attr<mxnet::FInferShape>("FInferShape", CumsumShape)
     .set_attr<nnvm::FInferType>("FInferType", CumsumType)
     .set_attr<FCompute>("FCompute<cpu>", CumsumForward<cpu>)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
     .set_attr<nnvm::FGradient>("FGradient", ElemwiseGradUseNone{"_backward_npi_cumsum"})
     .set_attr<nnvm::FInplaceOption>("FInplaceOption",
                                     [](const NodeAttrs& attrs) {
@@ -92,6 +96,10 @@ NNVM_REGISTER_OP(_backward_npi_cumsum)
     .set_num_inputs(1)
     .set_num_outputs(1)
     .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
     .set_attr<FCompute>("FCompute<cpu>", CumsumBackward<cpu>);
 
 }  // namespace op
@@ -46,6 +46,8 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <sstream>
+#include <unordered_map>
 #include "./np_tensordot_op-inl.h"
 #include "./np_einsum_path_op-inl.h"
 #include "../../common/static_array.h"
@@ -760,6 +762,217 @@ inline void NumpyEinsumProcess(const std::vector<TBlob>& inputs,
   }
 }
 
+/*!
+ * \brief Contraction path of einsum for the given operands. Finding the path is a greedy
+ *        search with string handling at every step, so it is cached per subscripts,
+ *        operand shapes, type and device.
+ */
+inline const std::vector<Step>& CachedEinsumPath(const std::string& subscripts,
+                                                 const std::vector<TBlob>& operands,
+                                                 const RunContext& run_ctx) {
+  static thread_local std::unordered_map<std::string, std::vector<Step> > cache;
+  std::ostringstream os;
+  os << subscripts << '|' << run_ctx.ctx.dev_mask() << '|' << operands[0].type_flag_;
+  for (const TBlob& operand : operands) {
+    os << '|' << operand.shape_;
+  }
+  const std::string key = os.str();
+  auto it               = cache.find(key);
+  if (it == cache.end()) {
+    if (cache.size() >= 1024) {
+      cache.clear();
+    }
+    it = cache.emplace(key, einsum_path(subscripts, operands, true, run_ctx, nullptr, nullptr))
+             .first;
+  }
+  return it->second;
+}
+
+/*!
+ * \brief A pairwise contraction "lhs,rhs->out" lowered to one batched GEMM
+ *        out[b, m, n] = sum_k lhs[b, m, k] * rhs[b, k, n], where b, m, n and k each group
+ *        the labels found in both operands and the output, in lhs and the output only, in rhs
+ *        and the output only, and in both operands only. b, m and n follow the output order
+ *        and k the lhs order. An operand whose axes can not be read as such a matrix batch,
+ *        possibly transposed, is transposed into the workspace first, and so is the result
+ *        when the output is neither [b, m, n] nor [b, n, m]. Size-1 axes are ignored when
+ *        comparing layouts.
+ */
+struct EinsumGemmPlan {
+  index_t batch, m, n, k;
+  bool lhs_t, rhs_t;
+  bool transpose_lhs, transpose_rhs;
+  // 0: out is [b, m, n], 1: out is [b, n, m], 2: out is transposed from the workspace
+  int out_mode;
+  mxnet::TShape lhs_axes, rhs_axes, out_axes;
+  mxnet::TShape lhs_tshape, rhs_tshape, out_tshape;
+  // number of elements of workspace
+  size_t workspace;
+
+  /*!
+   * \return false when the contraction does not map to a batched GEMM with these shapes,
+   *         e.g. when an operand is broadcast along a label
+   */
+  bool Init(const std::string& einsum_str,
+            const mxnet::TShape& lshape,
+            const mxnet::TShape& rshape) {
+    const size_t comma = einsum_str.find(',');
+    const size_t arrow = einsum_str.find("->");
+    if (comma == std::string::npos || arrow == std::string::npos)
+      return false;
+    const std::string lhs = einsum_str.substr(0, comma);
+    const std::string rhs = einsum_str.substr(comma + 1, arrow - comma - 1);
+    const std::string out = einsum_str.substr(arrow + 2);
+    if (lhs.size() != static_cast<size_t>(lshape.ndim()) ||
+        rhs.size() != static_cast<size_t>(rshape.ndim()) || lhs.size() > 6 || rhs.size() > 6 ||
+        out.size() > 6)
+      return false;
+    dim_t size[128];
+    std::fill(size, size + 128, -1);
+    for (size_t i = 0; i < lhs.size(); ++i) {
+      size[static_cast<int>(lhs[i])] = lshape[i];
+    }
+    for (size_t i = 0; i < rhs.size(); ++i) {
+      const int c = static_cast<int>(rhs[i]);
+      if (size[c] != -1 && size[c] != rshape[i])
+        return false;
+      size[c] = rshape[i];
+    }
+    std::string b_labels, m_labels, n_labels, k_labels;
+    for (const char& c : out) {
+      const bool in_lhs = lhs.find(c) != std::string::npos;
+      const bool in_rhs = rhs.find(c) != std::string::npos;
+      if (in_lhs && in_rhs) {
+        b_labels += c;
+      } else if (in_lhs) {
+        m_labels += c;
+      } else if (in_rhs) {
+        n_labels += c;
+      } else {
+        return false;
+      }
+    }
+    for (const char& c : lhs) {
+      if (out.find(c) == std::string::npos)
+        k_labels += c;
+    }
+    auto prod = [&](const std::string& labels) {
+      index_t ret = 1;
+      for (const char& c : labels) {
+        ret *= size[static_cast<int>(c)];
+      }
+      return ret;
+    };
+    batch = prod(b_labels);
+    m     = prod(m_labels);
+    n     = prod(n_labels);
+    k     = prod(k_labels);
+    if (batch == 0 || m == 0 || n == 0 || k == 0)
+      return false;
+    auto squeeze = [&](std::string labels) {
+      auto is_one = [&](const char& c) { return size[static_cast<int>(c)] == 1; };
+      labels.erase(std::remove_if(labels.begin(), labels.end(), is_one), labels.end());
+      return labels;
+    };
+    auto same = [&](const std::string& a, const std::string& b) {
+      return squeeze(a) == squeeze(b);
+    };
+    auto permute = [&](const std::string& from, const std::string& to, mxnet::TShape* axes,
+                       mxnet::TShape* shape) {
+      *axes  = mxnet::TShape(to.size(), -1);
+      *shape = mxnet::TShape(to.size(), -1);
+      for (size_t i = 0; i < to.size(); ++i) {
+        (*axes)[i]  = from.find(to[i]);
+        (*shape)[i] = size[static_cast<int>(to[i])];
+      }
+    };
+    workspace = 0;
+    lhs_t =
+        same(lhs, b_labels + k_labels + m_labels) && !same(lhs, b_labels + m_labels + k_labels);
+    transpose_lhs = !lhs_t && !same(lhs, b_labels + m_labels + k_labels);
+    if (transpose_lhs) {
+      permute(lhs, b_labels + m_labels + k_labels, &lhs_axes, &lhs_tshape);
+      workspace += batch * m * k;
+    }
+    rhs_t =
+        same(rhs, b_labels + n_labels + k_labels) && !same(rhs, b_labels + k_labels + n_labels);
+    transpose_rhs = !rhs_t && !same(rhs, b_labels + k_labels + n_labels);
+    if (transpose_rhs) {
+      permute(rhs, b_labels + k_labels + n_labels, &rhs_axes, &rhs_tshape);
+      workspace += batch * k * n;
+    }
+    if (same(out, b_labels + m_labels + n_labels)) {
+      out_mode = 0;
+    } else if (same(out, b_labels + n_labels + m_labels)) {
+      out_mode = 1;
+    } else {
+      out_mode = 2;
+      // the workspace result is transposed from the [b, m, n] label order
+      mxnet::TShape inverse_axes;
+      permute(b_labels + m_labels + n_labels, out, &out_axes, &out_tshape);
+      permute(out, b_labels + m_labels + n_labels, &inverse_axes, &out_tshape);
+      workspace += batch * m * n;
+    }
+    return true;
+  }
+};
+
+/*!
+ * \brief Run a contraction planned by EinsumGemmPlan. workspace holds at least
+ *        plan.workspace elements of the output type.
+ */
+template <typename xpu>
+inline void EinsumBatchGemm(const EinsumGemmPlan& plan,
+                            const OpContext& ctx,
+                            const TBlob& lhs,
+                            const TBlob& rhs,
+                            const TBlob& out,
+                            const OpReqType req,
+                            char* workspace) {
+  using namespace mshadow;
+  if (req == kNullOp)
+    return;
+  Stream<xpu>* s = ctx.get_stream<xpu>();
+  MSHADOW_SGL_DBL_TYPE_SWITCH(out.type_flag_, DType, {
+    DType* ws = reinterpret_cast<DType*>(workspace);
+    TBlob a   = lhs;
+    TBlob b   = rhs;
+    if (plan.transpose_lhs) {
+      a = TBlob(ws, plan.lhs_tshape, xpu::kDevMask);
+      ws += a.Size();
+      TransposeImpl<xpu>(ctx.run_ctx, lhs, a, plan.lhs_axes);
+    }
+    if (plan.transpose_rhs) {
+      b = TBlob(ws, plan.rhs_tshape, xpu::kDevMask);
+      ws += b.Size();
+      TransposeImpl<xpu>(ctx.run_ctx, rhs, b, plan.rhs_axes);
+    }
+    const index_t batch = plan.batch, m = plan.m, n = plan.n, k = plan.k;
+    Shape<3> a_shape        = plan.lhs_t ? Shape3(batch, k, m) : Shape3(batch, m, k);
+    Shape<3> b_shape        = plan.rhs_t ? Shape3(batch, n, k) : Shape3(batch, k, n);
+    Tensor<xpu, 3, DType> A = a.get_with_shape<xpu, 3, DType>(a_shape, s);
+    Tensor<xpu, 3, DType> B = b.get_with_shape<xpu, 3, DType>(b_shape, s);
+    const DType beta = req == kAddTo ? DType(1) : DType(0);
+    if (plan.out_mode == 0) {
+      Tensor<xpu, 3, DType> C = out.get_with_shape<xpu, 3, DType>(Shape3(batch, m, n), s);
+      linalg_batch_gemm(A, B, C, DType(1), beta, plan.lhs_t, plan.rhs_t, s);
+    } else if (plan.out_mode == 1) {
+      // out^T = rhs^T lhs^T
+      Tensor<xpu, 3, DType> C = out.get_with_shape<xpu, 3, DType>(Shape3(batch, n, m), s);
+      linalg_batch_gemm(B, A, C, DType(1), beta, !plan.rhs_t, !plan.lhs_t, s);
+    } else {
+      TBlob tmp               = TBlob(ws, plan.out_tshape, xpu::kDevMask);
+      Tensor<xpu, 3, DType> C = tmp.get_with_shape<xpu, 3, DType>(Shape3(batch, m, n), s);
+      linalg_batch_gemm(A, B, C, DType(1), DType(0), plan.lhs_t, plan.rhs_t, s);
+      if (req == kAddTo) {
+        TransposeImpl<xpu, true>(ctx.run_ctx, tmp, out, plan.out_axes);
+      } else {
+        TransposeImpl<xpu>(ctx.run_ctx, tmp, out, plan.out_axes);
+      }
+    }
+  });
+}
+
 template <typename xpu>
 inline void NumpyEinsumForward(const OpStatePtr& state_ptr,
                                const OpContext& ctx,
@@ -780,10 +993,8 @@ inline void NumpyEinsumForward(const OpStatePtr& state_ptr,
     return;
   }
   std::vector<Step>& paths = state.paths;
-  std::vector<std::vector<int> > pos;
-  std::string string_repr;
-  paths         = einsum_path(state.subscripts, inputs, true, ctx.run_ctx, &pos, &string_repr);
-  int paths_len = paths.size();
+  paths                    = CachedEinsumPath(state.subscripts, inputs, ctx.run_ctx);
+  int paths_len            = paths.size();
   size_t temp_space_size = 0, max_temp_space_size = 0;
   std::vector<TBlob> operands(inputs), tmp_operands, temp_space_vec(paths_len - 1);
   for (int i = 0; i + 1 < paths_len; ++i) {
@@ -812,8 +1023,20 @@ inline void NumpyEinsumForward(const OpStatePtr& state_ptr,
         operands.erase(operands.begin() + p);
       }
       bool handle_out = (i == paths_len - 1);
+      EinsumGemmPlan plan;
       // Call tensordot if still possible
-      if (paths[i].do_blas) {
+      if (paths[i].do_batch_gemm &&
+          plan.Init(paths[i].einsum_str, tmp_operands[0].shape_, tmp_operands[1].shape_)) {
+        Tensor<xpu, 1, char> workspace = ctx.requested[0].get_space_typed<xpu, 1, char>(
+            Shape1(std::max<size_t>(plan.workspace * sizeof(DType), 1)), s);
+        EinsumBatchGemm<xpu>(plan,
+                             ctx,
+                             tmp_operands[0],
+                             tmp_operands[1],
+                             handle_out ? outputs[0] : temp_space_vec[i],
+                             handle_out ? req[0] : kWriteTo,
+                             workspace.dptr_);
+      } else if (paths[i].do_blas) {
         // Contract!
         if (paths[i].do_einsum || handle_out) {
           TBlob max_temp_space = TBlob(temp_space.Slice(0, paths[i].tshape.Size()));
@@ -929,6 +1152,8 @@ inline void NumpyEinsumBackward(const OpStatePtr& state_ptr,
   std::vector<TBlob> temp_inputs, temp_outputs;
   std::vector<OpReqType> temp_req;
   std::vector<size_t> tensordot_tempspace_size;
+  std::vector<bool> use_batch_gemm(paths_len, false);
+  std::vector<EinsumGemmPlan> lhs_grad_plans(paths_len), rhs_grad_plans(paths_len);
   MSHADOW_TYPE_SWITCH(outputs[0].type_flag_, DType, {
     for (int i = 0; i < paths_len; ++i) {
       temp_inputs.clear();
@@ -957,7 +1182,27 @@ inline void NumpyEinsumBackward(const OpStatePtr& state_ptr,
         }
       }
       size_t cur_tensordot_tempspace_size = 0;
-      if (paths[i].do_blas) {
+      if (paths[i].do_batch_gemm) {
+        // dlhs = "out,rhs->lhs" and drhs = "lhs,out->rhs"
+        const std::string& str = paths[i].einsum_str;
+        const size_t comma = str.find(','), arrow = str.find("->");
+        const std::string lhs = str.substr(0, comma);
+        const std::string rhs = str.substr(comma + 1, arrow - comma - 1);
+        const std::string out = str.substr(arrow + 2);
+        use_batch_gemm[i] =
+            lhs_grad_plans[i].Init(out + "," + rhs + "->" + lhs,
+                                   temp_inputs[0].shape_,
+                                   temp_inputs[2].shape_) &&
+            rhs_grad_plans[i].Init(lhs + "," + out + "->" + rhs,
+                                   temp_inputs[1].shape_,
+                                   temp_inputs[0].shape_);
+        if (use_batch_gemm[i]) {
+          cur_tensordot_tempspace_size =
+              std::max(lhs_grad_plans[i].workspace, rhs_grad_plans[i].workspace);
+          cur_tensordot_tempspace_size *= sizeof(DType);
+        }
+      }
+      if (!use_batch_gemm[i] && paths[i].do_blas) {
         if (paths[i].do_einsum) {
           cur_tensordot_tempspace_size = TensordotBackwardWorkspaceSize<xpu>(
               paths[i].left_pos,
@@ -1032,7 +1277,23 @@ inline void NumpyEinsumBackward(const OpStatePtr& state_ptr,
           temp_req.push_back(OpReqType::kWriteTo);
         }
       }
-      if (paths[i].do_blas) {
+      if (use_batch_gemm[i]) {
+        char* workspace = reinterpret_cast<char*>(temp_space.dptr_ + begin_tensordot_tempspace);
+        EinsumBatchGemm<xpu>(lhs_grad_plans[i],
+                             ctx,
+                             temp_inputs[0],
+                             temp_inputs[2],
+                             temp_outputs[0],
+                             temp_req[0],
+                             workspace);
+        EinsumBatchGemm<xpu>(rhs_grad_plans[i],
+                             ctx,
+                             temp_inputs[1],
+                             temp_inputs[0],
+                             temp_outputs[1],
+                             temp_req[1],
+                             workspace);
+      } else if (paths[i].do_blas) {
         CHECK_EQ(temp_inputs.size(), 3U);
         CHECK_EQ(temp_outputs.size(), 2U);
         CHECK_EQ(temp_req.size(), 2U);
@@ -499,9 +499,7 @@ class EinsumOpGPU {
             const OpContext& ctx,
             bool is_backward) {
     if (!is_backward) {
-      std::vector<std::vector<int>> pos;
-      std::string string_repr;
-      mypaths   = einsum_path(state.subscripts, inputs, true, ctx.run_ctx, &pos, &string_repr);
+      mypaths   = CachedEinsumPath(state.subscripts, inputs, ctx.run_ctx);
       paths_len = mypaths.size();
       max_workspace_cutensor = 0;
       mxnet::ShapeVector operands_shape(in_shape);
@@ -542,9 +540,7 @@ class EinsumOpGPU {
       for (int i = 1; i < inputs.size(); ++i) {
         temp_inputs.push_back(inputs[i]);
       }
-      std::vector<std::vector<int>> pos;
-      std::string string_repr;
-      mypaths = einsum_path(state.subscripts, temp_inputs, true, ctx.run_ctx, &pos, &string_repr);
+      mypaths = CachedEinsumPath(state.subscripts, temp_inputs, ctx.run_ctx);
       max_workspace_cutensor     = 0;
       size_t pos_cutensor_bwd_op = 0;
       paths_len                  = mypaths.size();
@@ -71,7 +71,7 @@ struct Step {
   std::bitset<MAXAXIS> idx_removed;
   std::string einsum_str, blas2einsum_str, einsum2blas_str;
   std::vector<std::string> input_list;
-  bool do_blas, do_cutensor, do_einsum;
+  bool do_blas, do_cutensor, do_einsum, do_batch_gemm;
   TShape oshape, tshape;
   Tuple<int> left_pos, right_pos;
 };
@@ -708,6 +708,47 @@ inline std::vector<std::string> _parse_einsum_input(std::string subscripts,
   return ret;
 }
 
+/*!
+ * \brief Whether a pairwise contraction that BLAS dot can not handle because some labels
+ *        stay in both operands and in the result, e.g. "bij,bjk->bik", maps to a batched
+ *        GEMM: no label is repeated within a term or summed away from a single operand.
+ */
+inline bool _can_batch_gemm(const std::vector<std::string>& inputs, const std::string& result) {
+  if (inputs.size() != 2) {
+    return false;
+  }
+  auto has = [](const std::string& term, const char c) {
+    return term.find(c) != std::string::npos;
+  };
+  const std::string& left  = inputs[0];
+  const std::string& right = inputs[1];
+  for (const std::string* term : {&left, &right, &result}) {
+    for (const char& c : *term) {
+      if (std::count(term->begin(), term->end(), c) > 1) {
+        return false;
+      }
+    }
+  }
+  bool has_batch = false;
+  for (const char& c : left) {
+    if (!has(right, c) && !has(result, c)) {
+      return false;
+    }
+    has_batch |= has(right, c) && has(result, c);
+  }
+  for (const char& c : right) {
+    if (!has(left, c) && !has(result, c)) {
+      return false;
+    }
+  }
+  for (const char& c : result) {
+    if (!has(left, c) && !has(right, c)) {
+      return false;
+    }
+  }
+  return has_batch;
+}
+
 inline bool _tensordot_type_check(int type_flag_, const RunContext& run_ctx) {
   return type_flag_ == kFloat32 || type_flag_ == kFloat64 ||
          (type_flag_ == kFloat16 && run_ctx.ctx.dev_mask() == mshadow::gpu::kDevMask);
@@ -946,6 +987,10 @@ inline std::vector<Step> einsum_path(const std::string& subscripts,
     ret[i].idx_removed   = contract.idx_removed;
     ret[i].input_list    = input_list;
     ret[i].do_blas       = do_blas;
+    ret[i].do_batch_gemm =
+        !do_blas &&
+        (operands[0].type_flag_ == kFloat32 || operands[0].type_flag_ == kFloat64) &&
+        _can_batch_gemm(tmp_inputs, idx_result);
   }
 
   if (ret_path == nullptr || ret_string_repr == nullptr) {
@@ -910,8 +910,8 @@ void NumpyBinaryOperatorComputeExCPU(const nnvm::NodeAttrs& attrs,
                                      const std::vector<mxnet::NDArray>& inputs,
                                      const std::vector<OpReqType>& req,
                                      const std::vector<mxnet::NDArray>& outputs) {
-  if (SupportDNNLBinary(inputs, outputs)) {
-    const dnnl::algorithm alg = DNNLAlgorithm<OP>::value;
+  const dnnl::algorithm alg = DNNLAlgorithm<OP>::value;
+  if (SupportDNNLBinary(inputs, outputs, alg)) {
     DNNLRun(DNNLBinaryOpForward<alg>, attrs, ctx, inputs, req, outputs);
     return;
   }
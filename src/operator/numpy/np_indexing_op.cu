@@ -411,17 +411,16 @@ void AdvancedIndexingMultipleForwardGPU(const nnvm::NodeAttrs& attrs,
             ctx.requested[0].get_space_typed<gpu, 1, IType>(Shape1(M), s);
         IType* is_valid_dim_ptr = reinterpret_cast<IType*>(workspace.dptr_);
         GatherNDCheckBoundGPU(s, idx_ptr, N, M, mshape, is_valid_dim_ptr);
-        Kernel<gather_nd, gpu>::Launch(s,
-                                       N,
-                                       req[0],
-                                       N,
-                                       M,
-                                       K,
-                                       strides,
-                                       mshape,
-                                       outputs[0].dptr<DType>(),
-                                       inputs[0].dptr<DType>(),
-                                       inputs[1].dptr<IType>());
+        LaunchIndexNDRowsGPU<gather_nd_elem>(s,
+                                             req[0],
+                                             N,
+                                             M,
+                                             K,
+                                             strides,
+                                             mshape,
+                                             outputs[0].dptr<DType>(),
+                                             inputs[0].dptr<DType>(),
+                                             inputs[1].dptr<IType>());
       });
     });
   } else {
@@ -50,6 +50,18 @@ inline bool MatmulNeedBroadcast(const mxnet::TShape& ashape, const mxnet::TShape
   return need_bcast;
 }
 
+/*!
+ * \brief Whether matmul(a, b) is a single GEMM: b has no batch axes other than size-1 ones and
+ *        a is not broadcast, so the batch of a folds into the rows of one a-by-b product,
+ *        as for a dense layer applied to a batch of sequences.
+ */
+inline bool MatmulFoldBatch(const mxnet::TShape& a_shape,
+                            const mxnet::TShape& b_shape,
+                            const size_t batch_size) {
+  return b_shape.ProdShape(0, b_shape.ndim() - 2) == 1 &&
+         a_shape.ProdShape(0, a_shape.ndim() - 2) == batch_size;
+}
+
 /*!
  * \brief Get mshadow::Shape from mxnet::TShape.
  * \note fill ndim = 1 into extra ndims if outshape.ndim > input.ndim
@@ -161,65 +173,49 @@ inline void MatmulImpl(const OpContext& ctx,
         GetBroadcastKernelShape<MXNET_SPECIAL_MAX_NDIM>(k_a_shape, k_out_shape, 0, ndim - 2);
     const mshadow::Shape<MXNET_SPECIAL_MAX_NDIM> k_b_shape_bc =
         GetBroadcastKernelShape<MXNET_SPECIAL_MAX_NDIM>(k_b_shape, k_out_shape, 0, ndim - 2);
-    DType* bc_a_ptr = reinterpret_cast<DType*>(temp_mem.dptr_);
-    DType* bc_b_ptr = bc_a_ptr + bc_size_a;
-    MSHADOW_TYPE_SWITCH_WITH_BOOL(input_a.type_flag_, IType, {
-      MSHADOW_TYPE_SWITCH_WITH_BOOL(input_b.type_flag_, OType, {
-        struct ShapeAndStride aux_data_a, aux_data_b;
-        PrepareAUXData(&aux_data_a, k_a_shape, k_a_shape_bc, ndim);
-        PrepareAUXData(&aux_data_b, k_b_shape, k_b_shape_bc, ndim);
-        if (isCPU) {
-          if (!aux_data_a.shape_changed) {
-            Kernel<direct_copy<mshadow_op::identity>, xpu>::Launch(
-                s, bc_size_a, input_a.dptr<IType>(), bc_a_ptr, OpReqType::kWriteTo);
-            Kernel<broadcast_kernel_cpu<mshadow_op::identity>, xpu>::Launch(s,
-                                                                            input_b.Size(),
-                                                                            input_b.dptr<IType>(),
-                                                                            bc_b_ptr,
-                                                                            aux_data_b,
-                                                                            OpReqType::kWriteTo,
-                                                                            ndim);
-          } else if (!aux_data_b.shape_changed) {
-            Kernel<direct_copy<mshadow_op::identity>, xpu>::Launch(
-                s, bc_size_b, input_b.dptr<IType>(), bc_b_ptr, OpReqType::kWriteTo);
-            Kernel<broadcast_kernel_cpu<mshadow_op::identity>, xpu>::Launch(s,
-                                                                            input_a.Size(),
-                                                                            input_a.dptr<IType>(),
-                                                                            bc_a_ptr,
-                                                                            aux_data_a,
-                                                                            OpReqType::kWriteTo,
-                                                                            ndim);
-          } else {
-            Kernel<broadcast_kernel_cpu<mshadow_op::identity>, xpu>::Launch(s,
-                                                                            input_a.Size(),
-                                                                            input_a.dptr<IType>(),
-                                                                            bc_a_ptr,
-                                                                            aux_data_a,
-                                                                            OpReqType::kWriteTo,
-                                                                            ndim);
-            Kernel<broadcast_kernel_cpu<mshadow_op::identity>, xpu>::Launch(s,
-                                                                            input_b.Size(),
-                                                                            input_b.dptr<IType>(),
-                                                                            bc_b_ptr,
-                                                                            aux_data_b,
-                                                                            OpReqType::kWriteTo,
-                                                                            ndim);
-          }
-        } else {
-          Kernel<broadcast_kernel_gpu<mshadow_op::identity>, xpu>::Launch(
-              s, bc_size_a, input_a.dptr<IType>(), bc_a_ptr, aux_data_a, OpReqType::kWriteTo, ndim);
-          Kernel<broadcast_kernel_gpu<mshadow_op::identity>, xpu>::Launch(
-              s, bc_size_b, input_b.dptr<IType>(), bc_b_ptr, aux_data_b, OpReqType::kWriteTo, ndim);
-        }
-      });
-    });
+    struct ShapeAndStride aux_data_a, aux_data_b;
+    PrepareAUXData(&aux_data_a, k_a_shape, k_a_shape_bc, ndim);
+    PrepareAUXData(&aux_data_b, k_b_shape, k_b_shape_bc, ndim);
+    // only the operand which is broadcast is expanded, the other one is multiplied in place
+    DType* temp_ptr = reinterpret_cast<DType*>(temp_mem.dptr_);
+    DType* bc_a_ptr = aux_data_a.shape_changed ? temp_ptr : input_a.dptr<DType>();
+    DType* bc_b_ptr = aux_data_b.shape_changed ? temp_ptr + bc_size_a : input_b.dptr<DType>();
+    if (isCPU) {
+      if (aux_data_a.shape_changed) {
+        Kernel<broadcast_kernel_cpu<mshadow_op::identity>, xpu>::Launch(s,
+                                                                        input_a.Size(),
+                                                                        input_a.dptr<DType>(),
+                                                                        bc_a_ptr,
+                                                                        aux_data_a,
+                                                                        OpReqType::kWriteTo,
+                                                                        ndim);
+      }
+      if (aux_data_b.shape_changed) {
+        Kernel<broadcast_kernel_cpu<mshadow_op::identity>, xpu>::Launch(s,
+                                                                        input_b.Size(),
+                                                                        input_b.dptr<DType>(),
+                                                                        bc_b_ptr,
+                                                                        aux_data_b,
+                                                                        OpReqType::kWriteTo,
+                                                                        ndim);
+      }
+    } else {
+      if (aux_data_a.shape_changed) {
+        Kernel<broadcast_kernel_gpu<mshadow_op::identity>, xpu>::Launch(
+            s, bc_size_a, input_a.dptr<DType>(), bc_a_ptr, aux_data_a, OpReqType::kWriteTo, ndim);
+      }
+      if (aux_data_b.shape_changed) {
+        Kernel<broadcast_kernel_gpu<mshadow_op::identity>, xpu>::Launch(
+            s, bc_size_b, input_b.dptr<DType>(), bc_b_ptr, aux_data_b, OpReqType::kWriteTo, ndim);
+      }
+    }
     ans = mshadow::Tensor<xpu, 3, DType>(
         output.dptr<DType>(), Shape3(batch_size, k_out_shape[ndim - 2], k_out_shape[ndim - 1]), s);
     mlhs = mshadow::Tensor<xpu, 3, DType>(
         bc_a_ptr, Shape3(batch_size, k_a_shape_bc[ndim - 2], k_a_shape_bc[ndim - 1]), s);
     mrhs = mshadow::Tensor<xpu, 3, DType>(
         bc_b_ptr, Shape3(batch_size, k_b_shape_bc[ndim - 2], k_b_shape_bc[ndim - 1]), s);
-    DType** workspace_ptr = reinterpret_cast<DType**>(bc_b_ptr + bc_size_b);
+    DType** workspace_ptr = reinterpret_cast<DType**>(temp_ptr + bc_size_a + bc_size_b);
     workspace = mshadow::Tensor<xpu, 1, DType*>(workspace_ptr, Shape1(3 * ans.size(0)), s);
   } else {
     ans = output.get_with_shape<xpu, 3, DType>(
@@ -313,6 +309,13 @@ void NumpyMatmulForward(const nnvm::NodeAttrs& attrs,
   }
   MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, DType, {
     size_t batch_size = out_shape.ProdShape(0, ndim - 2);
+    if (MatmulFoldBatch(a_shape, b_shape, batch_size)) {
+      const index_t m = batch_size * a_shape[a_shape.ndim() - 2];
+      const index_t k = a_shape[a_shape.ndim() - 1];
+      const index_t n = b_shape[b_shape.ndim() - 1];
+      MatrixDot<xpu>(ctx, a, b, out, req[0], m, k, k, n);
+      return;
+    }
     size_t bc_size_a  = batch_size * a_shape[a_shape.ndim() - 2] * a_shape[a_shape.ndim() - 1];
     size_t bc_size_b  = batch_size * b_shape[b_shape.ndim() - 2] * b_shape[b_shape.ndim() - 1];
     size_t temp_mem_size =
@@ -435,6 +438,15 @@ void NumpyMatmulBackward(const nnvm::NodeAttrs& attrs,
   mxnet::TShape grad_b_shape = mxnet::TShape(vec_grad_b_shape.begin(), vec_grad_b_shape.end());
   MSHADOW_REAL_TYPE_SWITCH(ograd.type_flag_, DType, {
     size_t batch_size = out_shape.ProdShape(0, ndim - 2);
+    if (MatmulFoldBatch(a_shape, b_shape, batch_size)) {
+      // the sum of grad[b] over the batch is the product of the folded matrices itself
+      const index_t m = batch_size * a_shape[a_shape.ndim() - 2];
+      const index_t k = a_shape[a_shape.ndim() - 1];
+      const index_t n = b_shape[b_shape.ndim() - 1];
+      MatrixDot<xpu>(ctx, ograd, b, grad_a, req[0], m, n, k, n, false, true);
+      MatrixDot<xpu>(ctx, a, ograd, grad_b, req[1], m, k, m, n, true, false);
+      return;
+    }
     size_t bc_size_a  = batch_size * a_shape[a_shape.ndim() - 2] * a_shape[a_shape.ndim() - 1];
     size_t bc_size_b  = batch_size * b_shape[b_shape.ndim() - 2] * b_shape[b_shape.ndim() - 1];
     size_t bc_size_out =
@@ -35,6 +35,7 @@
 #include "../operator_common.h"
 #include "../mxnet_op.h"
 #include "../tensor/init_op.h"
+#include "../tensor/prefix_count-inl.h"
 #include "../mshadow_op.h"
 #include "../elemwise_op_common.h"
 
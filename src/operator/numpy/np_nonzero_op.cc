@@ -91,11 +91,9 @@ void NonzeroForwardCPU(const nnvm::NodeAttrs& attrs,
   size_t valid_num = 0;
   // Calculate prefix sum
   MSHADOW_TYPE_SWITCH_WITH_BOOL(in.dtype(), DType, {
-    DType* in_dptr = in.data().dptr<DType>();
-    for (size_t i = 0; i < in_size; i++) {
-      valid_num += (in_dptr[i] != 0);
-      prefix_sum[i] = valid_num;
-    }
+    const DType* in_dptr = in.data().dptr<DType>();
+    auto is_nonzero      = [in_dptr](index_t i) { return in_dptr[i] != 0; };
+    valid_num            = PrefixCountCPU(in_size, is_nonzero, prefix_sum.data());
   });
   // set the output shape forcefully
   mxnet::TShape s(2, in.shape().ndim());
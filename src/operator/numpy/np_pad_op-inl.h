@@ -36,6 +36,7 @@
 #include "../operator_common.h"
 #include "../elemwise_op_common.h"
 #include "../tensor/broadcast_reduce_op.h"
+#include "../tensor/copy_plan-inl.h"
 
 namespace mxnet {
 namespace op {
@@ -566,6 +567,104 @@ struct pad_grad {
   }
 };
 
+/*!
+ * \brief Copy plan of pad on cpu: every output row of the innermost axis is the matching input
+ *        row between two runs of border, which are filled with value when fill is set and
+ *        left to the mode kernels otherwise.
+ * \return false on gpu, which uses the element-wise kernels instead
+ */
+template <typename xpu, typename DType, int ndim>
+inline bool PadCopyRows(mshadow::Stream<xpu>* s,
+                        const TBlob& in_data,
+                        const TBlob& out_data,
+                        const mshadow::Shape<ndim>& ishape,
+                        const mshadow::Shape<ndim>& oshape,
+                        const mshadow::Shape<ndim * 2>& width,
+                        const bool fill,
+                        const DType value,
+                        const OpReqType req) {
+  return false;
+}
+
+template <typename DType, int ndim>
+inline bool PadCopyRows(mshadow::Stream<cpu>* s,
+                        const TBlob& in_data,
+                        const TBlob& out_data,
+                        const mshadow::Shape<ndim>& ishape,
+                        const mshadow::Shape<ndim>& oshape,
+                        const mshadow::Shape<ndim * 2>& width,
+                        const bool fill,
+                        const DType value,
+                        const OpReqType req) {
+  const index_t ilen   = ishape[ndim - 1];
+  const index_t olen   = oshape[ndim - 1];
+  const index_t before = width[2 * ndim - 2];
+  const DType* in      = in_data.dptr<DType>();
+  DType* out           = out_data.dptr<DType>();
+  if (out_data.Size() == 0)
+    return true;
+  ForEachRowCPU(out_data.Size() / olen, olen, [&](const index_t row) {
+    const mshadow::Shape<ndim> coord = mxnet_op::unravel(row * olen, oshape);
+    DType* dst                       = out + row * olen;
+    index_t src                      = 0;
+    bool inside                      = true;
+    for (int k = 0; k < ndim - 1; ++k) {
+      const index_t c = coord[k] - width[2 * k];
+      inside          = inside && c >= 0 && c < ishape[k];
+      src             = src * ishape[k] + c;
+    }
+    if (!inside) {
+      if (fill)
+        FillRunCPU(dst, olen, value, req);
+      return;
+    }
+    if (fill) {
+      FillRunCPU(dst, before, value, req);
+      FillRunCPU(dst + before + ilen, olen - before - ilen, value, req);
+    }
+    CopyRunCPU(in + src * ilen, dst + before, ilen, req);
+  });
+  return true;
+}
+
+/*!
+ * \brief Copy plan of the pad gradient on cpu: every row of the input gradient is a contiguous
+ *        run of the output gradient.
+ * \return false on gpu, which uses pad_grad instead
+ */
+template <typename DType, typename xpu, int ndim>
+inline bool PadGradRows(mshadow::Stream<xpu>* s,
+                        const TBlob& ograd,
+                        const TBlob& igrad,
+                        const mshadow::Shape<ndim>& oshape,
+                        const mshadow::Shape<ndim>& ishape,
+                        const mshadow::Shape<ndim * 2>& width,
+                        const OpReqType req) {
+  return false;
+}
+
+template <typename DType, int ndim>
+inline bool PadGradRows(mshadow::Stream<cpu>* s,
+                        const TBlob& ograd,
+                        const TBlob& igrad,
+                        const mshadow::Shape<ndim>& oshape,
+                        const mshadow::Shape<ndim>& ishape,
+                        const mshadow::Shape<ndim * 2>& width,
+                        const OpReqType req) {
+  const index_t ilen = ishape[ndim - 1];
+  const DType* in    = ograd.dptr<DType>();
+  DType* out         = igrad.dptr<DType>();
+  if (igrad.Size() == 0)
+    return true;
+  ForEachRowCPU(igrad.Size() / ilen, ilen, [&](const index_t row) {
+    mshadow::Shape<ndim> coord = mxnet_op::unravel(row * ilen, ishape);
+    for (int k = 0; k < ndim; ++k)
+      coord[k] += width[2 * k];
+    CopyRunCPU(in + mxnet_op::ravel(coord, oshape), out + row * ilen, ilen, req);
+  });
+  return true;
+}
+
 template <typename xpu>
 void NumpyPadOpImpl(const TBlob& in_data,
                     const TBlob& out_data,
@@ -592,31 +691,39 @@ void NumpyPadOpImpl(const TBlob& in_data,
         width[dimcounter * 2 + 1] = param.pad_width[dimcounter][1];
       }
     }
-    index_t* idptr = reinterpret_cast<index_t*>(ishape);
+    index_t* idptr                     = reinterpret_cast<index_t*>(ishape);
+    const mshadow::Shape<NDim> ishape_ = in_data.shape_.get<NDim>();
+    const mshadow::Shape<NDim> oshape_ = out_data.shape_.get<NDim>();
     switch (mode) {
       case pad_enum::kConstant: {
         // constant padding start
         MSHADOW_TYPE_SWITCH_WITH_BOOL(out_data.type_flag_, DType, {
-          MXNET_ASSIGN_REQ_SWITCH(req[0], req_type, {
-            Kernel<constant_pad<xpu, req_type, NDim>, xpu>::Launch(s,
-                                                                   dsize,
-                                                                   out_data.dptr<DType>(),
-                                                                   in_data.dptr<DType>(),
-                                                                   idptr,
-                                                                   odptr,
-                                                                   width,
-                                                                   param.constant_values);
-          });
+          const DType value = static_cast<DType>(param.constant_values);
+          if (!PadCopyRows(s, in_data, out_data, ishape_, oshape_, width, true, value, req[0])) {
+            MXNET_ASSIGN_REQ_SWITCH(req[0], req_type, {
+              Kernel<constant_pad<xpu, req_type, NDim>, xpu>::Launch(s,
+                                                                     dsize,
+                                                                     out_data.dptr<DType>(),
+                                                                     in_data.dptr<DType>(),
+                                                                     idptr,
+                                                                     odptr,
+                                                                     width,
+                                                                     param.constant_values);
+            });
+          }
         });
         // constant padding end
         break;
       }
       case pad_enum::kSymmetric: {
         MSHADOW_TYPE_SWITCH_WITH_BOOL(out_data.type_flag_, DType, {
-          MXNET_ASSIGN_REQ_SWITCH(req[0], req_type, {
-            Kernel<pad_copy<xpu, req_type, NDim>, xpu>::Launch(
-                s, dsize, out_data.dptr<DType>(), in_data.dptr<DType>(), idptr, odptr, width);
-          });
+          if (!PadCopyRows(
+                  s, in_data, out_data, ishape_, oshape_, width, false, DType(0), req[0])) {
+            MXNET_ASSIGN_REQ_SWITCH(req[0], req_type, {
+              Kernel<pad_copy<xpu, req_type, NDim>, xpu>::Launch(
+                  s, dsize, out_data.dptr<DType>(), in_data.dptr<DType>(), idptr, odptr, width);
+            });
+          }
         });
         index_t index;
         index_t dim = ndim;
@@ -640,10 +747,13 @@ void NumpyPadOpImpl(const TBlob& in_data,
       }
       case pad_enum::kReflect: {
         MSHADOW_TYPE_SWITCH_WITH_BOOL(out_data.type_flag_, DType, {
-          MXNET_ASSIGN_REQ_SWITCH(req[0], req_type, {
-            Kernel<pad_copy<xpu, req_type, NDim>, xpu>::Launch(
-                s, dsize, out_data.dptr<DType>(), in_data.dptr<DType>(), idptr, odptr, width);
-          });
+          if (!PadCopyRows(
+                  s, in_data, out_data, ishape_, oshape_, width, false, DType(0), req[0])) {
+            MXNET_ASSIGN_REQ_SWITCH(req[0], req_type, {
+              Kernel<pad_copy<xpu, req_type, NDim>, xpu>::Launch(
+                  s, dsize, out_data.dptr<DType>(), in_data.dptr<DType>(), idptr, odptr, width);
+            });
+          }
         });
         index_t index;
         index_t dim = ndim;
@@ -667,10 +777,13 @@ void NumpyPadOpImpl(const TBlob& in_data,
       }
       case pad_enum::kEdge: {
         MSHADOW_TYPE_SWITCH_WITH_BOOL(out_data.type_flag_, DType, {
-          MXNET_ASSIGN_REQ_SWITCH(req[0], req_type, {
-            Kernel<pad_copy<xpu, req_type, NDim>, xpu>::Launch(
-                s, dsize, out_data.dptr<DType>(), in_data.dptr<DType>(), idptr, odptr, width);
-          });
+          if (!PadCopyRows(
+                  s, in_data, out_data, ishape_, oshape_, width, false, DType(0), req[0])) {
+            MXNET_ASSIGN_REQ_SWITCH(req[0], req_type, {
+              Kernel<pad_copy<xpu, req_type, NDim>, xpu>::Launch(
+                  s, dsize, out_data.dptr<DType>(), in_data.dptr<DType>(), idptr, odptr, width);
+            });
+          }
         });
         index_t index;
         index_t dim = ndim;
@@ -694,10 +807,13 @@ void NumpyPadOpImpl(const TBlob& in_data,
       }
       case pad_enum::kMinimum: {
         MSHADOW_TYPE_SWITCH_WITH_BOOL(out_data.type_flag_, DType, {
-          MXNET_ASSIGN_REQ_SWITCH(req[0], req_type, {
-            Kernel<pad_copy<xpu, req_type, NDim>, xpu>::Launch(
-                s, dsize, out_data.dptr<DType>(), in_data.dptr<DType>(), idptr, odptr, width);
-          });
+          if (!PadCopyRows(
+                  s, in_data, out_data, ishape_, oshape_, width, false, DType(0), req[0])) {
+            MXNET_ASSIGN_REQ_SWITCH(req[0], req_type, {
+              Kernel<pad_copy<xpu, req_type, NDim>, xpu>::Launch(
+                  s, dsize, out_data.dptr<DType>(), in_data.dptr<DType>(), idptr, odptr, width);
+            });
+          }
         });
         index_t index;
         index_t dim = ndim;
@@ -721,10 +837,13 @@ void NumpyPadOpImpl(const TBlob& in_data,
       }
       case pad_enum::kMaximum: {
         MSHADOW_TYPE_SWITCH_WITH_BOOL(out_data.type_flag_, DType, {
-          MXNET_ASSIGN_REQ_SWITCH(req[0], req_type, {
-            Kernel<pad_copy<xpu, req_type, NDim>, xpu>::Launch(
-                s, dsize, out_data.dptr<DType>(), in_data.dptr<DType>(), idptr, odptr, width);
-          });
+          if (!PadCopyRows(
+                  s, in_data, out_data, ishape_, oshape_, width, false, DType(0), req[0])) {
+            MXNET_ASSIGN_REQ_SWITCH(req[0], req_type, {
+              Kernel<pad_copy<xpu, req_type, NDim>, xpu>::Launch(
+                  s, dsize, out_data.dptr<DType>(), in_data.dptr<DType>(), idptr, odptr, width);
+            });
+          }
         });
         index_t index;
         index_t dim = ndim;
@@ -783,10 +902,18 @@ void NumpyPadOpBackImpl(const TBlob& in_data,
     }
     index_t* idptr = reinterpret_cast<index_t*>(ishape);
     MSHADOW_TYPE_SWITCH_WITH_BOOL(out_data.type_flag_, DType, {
-      MXNET_ASSIGN_REQ_SWITCH(req[0], req_type, {
-        Kernel<pad_grad<xpu, req_type, NDim>, xpu>::Launch(
-            s, dsize, out_data.dptr<DType>(), in_data.dptr<DType>(), idptr, odptr, width);
-      });
+      if (!PadGradRows<DType>(s,
+                              in_data,
+                              out_data,
+                              in_data.shape_.get<NDim>(),
+                              out_data.shape_.get<NDim>(),
+                              width,
+                              req[0])) {
+        MXNET_ASSIGN_REQ_SWITCH(req[0], req_type, {
+          Kernel<pad_grad<xpu, req_type, NDim>, xpu>::Launch(
+              s, dsize, out_data.dptr<DType>(), in_data.dptr<DType>(), idptr, odptr, width);
+        });
+      }
     });
   })
 }
@@ -23,11 +23,13 @@
 #ifndef MXNET_OPERATOR_NUMPY_NP_PERCENTILE_OP_INL_H_
 #define MXNET_OPERATOR_NUMPY_NP_PERCENTILE_OP_INL_H_
 
+#include <algorithm>
 #include <vector>
 #include <string>
 #include "../tensor/ordering_op-inl.h"
 #include "../tensor/matrix_op-inl.h"
 #include "../../common/utils.h"
+#include "../../engine/openmp.h"
 #include "../mshadow_op.h"
 #include "../operator_common.h"
 #include "../elemwise_op_common.h"
@@ -82,6 +84,39 @@ struct NumpyPercentileParam : public dmlc::Parameter<NumpyPercentileParam> {
   }
 };
 
+/*!
+ * \brief Ranks of the sorted elements which make up the percentile at fractional index idx
+ *        of n elements.
+ * \return true when the percentile is the single element idx_below, otherwise it is
+ *         interpolated between idx_below and idx_above with weight_above
+ */
+MSHADOW_XINLINE bool PercentileRank(float idx,
+                                    const index_t n,
+                                    const int interpolation,
+                                    int* idx_below,
+                                    int* idx_above,
+                                    float* weight_above) {
+  int integral_idx = -1;
+  if (interpolation == percentile_enum::kLower) {
+    integral_idx = floor(idx);
+  } else if (interpolation == percentile_enum::kHigher) {
+    integral_idx = ceil(idx);
+  } else if (interpolation == percentile_enum::kMidpoint) {
+    idx = (floor(idx) + ceil(idx)) / 2;
+  } else if (interpolation == percentile_enum::kNearest) {
+    integral_idx = round(idx);
+  }
+  if (integral_idx >= 0) {
+    *idx_below = integral_idx;
+    *idx_above = integral_idx;
+    return true;
+  }
+  *idx_below    = floor(idx);
+  *idx_above    = *idx_below + 1 > n - 1 ? n - 1 : *idx_below + 1;
+  *weight_above = idx - *idx_below;
+  return false;
+}
+
 template <int NDim>
 struct percentile_take {
   template <typename DType, typename QType, typename OType>
@@ -104,37 +139,107 @@ struct percentile_take {
       t_coord[j] = r_coord[j + 1];
     }
 
-    float idx        = q[q_idx] * (t_shape[NDim - 1] - 1) / 100.0;
-    int integral_idx = -1;
-    if (interpolation == percentile_enum::kLower) {
-      integral_idx = floor(idx);
-    } else if (interpolation == percentile_enum::kHigher) {
-      integral_idx = ceil(idx);
-    } else if (interpolation == percentile_enum::kMidpoint) {
-      idx = (floor(idx) + ceil(idx)) / 2;
-    } else if (interpolation == percentile_enum::kNearest) {
-      integral_idx = round(idx);
+    int idx_below, idx_above;
+    float weight_above;
+    const float idx = q[q_idx] * (t_shape[NDim - 1] - 1) / 100.0;
+    const bool exact =
+        PercentileRank(idx, t_shape[NDim - 1], interpolation, &idx_below, &idx_above, &weight_above);
+    t_coord[NDim - 1] = idx_below;
+    size_t t_idx1     = ravel(t_coord, t_shape);
+    if (exact) {
+      out[i] = static_cast<OType>(a_sort[t_idx1]);
+    } else {
+      size_t t_idx2 = t_idx1 + (idx_above - idx_below);
+      OType x1      = static_cast<OType>(a_sort[t_idx1] * (1 - weight_above));
+      OType x2      = static_cast<OType>(a_sort[t_idx2] * weight_above);
+      out[i]        = x1 + x2;
     }
+  }
+};
 
-    if (integral_idx >= 0) {
-      t_coord[NDim - 1] = integral_idx;
-      size_t t_idx      = ravel(t_coord, t_shape);
-      out[i]            = static_cast<OType>(a_sort[t_idx]);
+/*!
+ * \brief Sort a lane only where the ranks are, i.e. afterwards a[r] holds the element of
+ *        rank r for every r in [rank_begin, rank_end) and the lane is partitioned around it.
+ *        The middle rank is selected first so the ranks on either side work on its halves.
+ */
+template <typename DType>
+inline void MultiSelect(DType* a,
+                        index_t begin,
+                        index_t end,
+                        const index_t* rank_begin,
+                        const index_t* rank_end) {
+  while (rank_begin != rank_end) {
+    const index_t* mid = rank_begin + (rank_end - rank_begin) / 2;
+    std::nth_element(a + begin, a + *mid, a + end);
+    MultiSelect(a, begin, *mid, rank_begin, mid);
+    begin      = *mid + 1;
+    rank_begin = mid + 1;
+  }
+}
+
+/*!
+ * \brief Pick the percentiles of lanes x len elements, which get reordered, without sorting
+ *        them. The elements of all the requested ranks are selected in O(len) per rank
+ *        (introselect) and the lanes are spread over the OpenMP threads.
+ * \return false when the device has no selection path and the lanes have to be sorted
+ */
+template <typename DType, typename QType, typename OType, typename xpu>
+inline bool PercentileSelect(mshadow::Stream<xpu>* s,
+                             DType* a,
+                             index_t lanes,
+                             index_t len,
+                             const QType* q,
+                             index_t nq,
+                             int interpolation,
+                             OType* out) {
+  return false;
+}
+
+template <typename DType, typename QType, typename OType>
+inline bool PercentileSelect(mshadow::Stream<cpu>* s,
+                             DType* a,
+                             index_t lanes,
+                             index_t len,
+                             const QType* q,
+                             index_t nq,
+                             int interpolation,
+                             OType* out) {
+  std::vector<int> below(nq), above(nq);
+  std::vector<float> weight(nq);
+  std::vector<char> exact(nq);
+  std::vector<index_t> ranks;
+  for (index_t j = 0; j < nq; ++j) {
+    const float idx = q[j] * (len - 1) / 100.0;
+    exact[j]        = PercentileRank(idx, len, interpolation, &below[j], &above[j], &weight[j]);
+    ranks.push_back(below[j]);
+    if (!exact[j])
+      ranks.push_back(above[j]);
+  }
+  std::sort(ranks.begin(), ranks.end());
+  ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+  // past a rank every few elements the selections cost more than one sort of the lane
+  const bool sort_lane  = static_cast<index_t>(ranks.size()) * 16 > len;
+  const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(omp_threads) if (lanes > 1 && lanes * len > 4096)
+  for (index_t l = 0; l < lanes; ++l) {
+    DType* lane = a + l * len;
+    if (sort_lane) {
+      std::sort(lane, lane + len);
     } else {
-      int idx_below      = floor(idx);
-      int idx_above      = idx_below + 1;
-      idx_above          = idx_above > t_shape[NDim - 1] - 1 ? t_shape[NDim - 1] - 1 : idx_above;
-      float weight_above = idx - idx_below;
-      float weight_below = 1 - weight_above;
-      t_coord[NDim - 1]  = idx_below;
-      size_t t_idx1      = ravel(t_coord, t_shape);
-      size_t t_idx2      = t_idx1 + (idx_above - idx_below);
-      OType x1           = static_cast<OType>(a_sort[t_idx1] * weight_below);
-      OType x2           = static_cast<OType>(a_sort[t_idx2] * weight_above);
-      out[i]             = x1 + x2;
+      MultiSelect(lane, 0, len, ranks.data(), ranks.data() + ranks.size());
+    }
+    for (index_t j = 0; j < nq; ++j) {
+      if (exact[j]) {
+        out[j * lanes + l] = static_cast<OType>(lane[below[j]]);
+      } else {
+        OType x1           = static_cast<OType>(lane[below[j]] * (1 - weight[j]));
+        OType x2           = static_cast<OType>(lane[above[j]] * weight[j]);
+        out[j * lanes + l] = x1 + x2;
+      }
     }
   }
-};
+  return true;
+}
 
 template <typename QType, typename xpu>
 bool CheckInvalidInput(mshadow::Stream<xpu>* s,
@@ -279,6 +384,21 @@ void NumpyPercentileForward(const nnvm::NodeAttrs& attrs,
 
     TBlob a_trans = TBlob(trans_ptr, t_shape_ex, xpu::kDevMask);
     TransposeImpl<xpu>(ctx.run_ctx, data, a_trans, t_axes);
+    bool selected = false;
+    MSHADOW_TYPE_SWITCH(percentile.type_flag_, QType, {
+      MSHADOW_SGL_DBL_TYPE_SWITCH(out.type_flag_, OType, {
+        selected = PercentileSelect(s,
+                                    trans_ptr,
+                                    static_cast<index_t>(small.Size()),
+                                    static_cast<index_t>(red_size),
+                                    percentile.dptr<QType>(),
+                                    static_cast<index_t>(r_shape[0]),
+                                    interpolation,
+                                    out.dptr<OType>());
+      })
+    })
+    if (selected)
+      return;
     TBlob a_sort                    = TBlob(sort_ptr, t_shape, xpu::kDevMask);
     TBlob a_idx                     = TBlob(idx_ptr, t_shape, xpu::kDevMask);
     std::vector<OpReqType> req_TopK = {kWriteTo, kNullOp};
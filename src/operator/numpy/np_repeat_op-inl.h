@@ -37,7 +37,7 @@
 #include "operator/channel_op_common.h"
 #include "operator/mxnet_op.h"
 #include "common/static_array.h"
-#include "operator/swapaxis-inl.h"
+#include "operator/tensor/copy_plan-inl.h"
 
 namespace mxnet {
 namespace op {
@@ -135,114 +135,67 @@ inline bool RepeatsOpShape(const nnvm::NodeAttrs& attrs,
   return shape_is_known(out_attrs->at(0));
 }
 
-struct repeat_noaxis_fwd {
-  template <typename IType, typename OType>
-  MSHADOW_XINLINE static void Map(index_t i, OType* out, IType* input, const int* indx) {
-    using namespace mxnet_op;
-    int ind = 0;
-    while (i >= indx[ind])
-      ind++;
-    out[i] = input[ind];
-  }
-};
-
+/*!
+ * \brief out viewed as (outer, total, inner) takes its row r of the repeated axis from the
+ *        input row j with cumsum[j - 1] <= r < cumsum[j], found by binary search
+ */
 struct repeat_axis_fwd {
-  template <typename IType, typename OType>
+  template <typename DType>
   MSHADOW_XINLINE static void Map(index_t i,
-                                  OType* out,
-                                  IType* input,
-                                  const int* indx,
-                                  int stride) {
-    using namespace mxnet_op;
-    int ind_row = i / stride, ind_col = i % stride;
-    int ind = 0;
-    while (ind_row >= indx[ind])
-      ind++;
-    out[i] = input[ind * stride + ind_col];
+                                  DType* out,
+                                  const DType* input,
+                                  const int* cumsum,
+                                  const index_t len,
+                                  const index_t inner) {
+    const index_t total = cumsum[len - 1];
+    const index_t col   = i % inner;
+    const index_t row   = i / inner % total;
+    const index_t o     = i / inner / total;
+    index_t lo = 0, hi = len - 1;
+    while (lo < hi) {
+      const index_t mid = (lo + hi) / 2;
+      if (row < cumsum[mid]) {
+        hi = mid;
+      } else {
+        lo = mid + 1;
+      }
+    }
+    out[i] = input[(o * len + lo) * inner + col];
   }
 };
 
 /*!
- * \brief Function that performs elements repetition along 0th axis.
- * \param ind pointer to the allocated memory which is needed for calculations.
- * \note When one wants to use repeat operator, they must specify axis for that repetition.
- * If this target axis is not equal to 0, then it must be swapped with 0th axis. So basically
- * repeats operator always repeats elements on 0th axis (this is the goal of this function),
- * but it uses swapaxis operator in order to perform repeating on other axes.
+ * \brief Copy plan of repeat on cpu: every input row of inner elements is copied to each of
+ *        its repetitions, and a single element is filled.
  */
-template <typename xpu>
-void NumpyRepeatsAxisZeroOpForward(const nnvm::NodeAttrs& attrs,
-                                   const OpContext& ctx,
-                                   const std::vector<TBlob>& inputs,
-                                   const std::vector<OpReqType>& req,
-                                   const std::vector<TBlob>& outputs,
-                                   int* ind) {
-  using namespace mshadow;
-  const TBlob& iTBlob         = inputs[0];
-  const mxnet::TShape& ishape = iTBlob.shape_;
-  int repeats                 = 0;
-  dmlc::optional<int> axisOpt;
-  // axis is always set to zero, because before calling this function target axis of the repeat
-  // function is swapped with 0th axis
-  const int axis                           = 0;
-  const RepeatsParam& param                = nnvm::get<RepeatsParam>(attrs.parsed);
-  mxnet::Tuple<int> increasing_repetitions = param.repeats.value();
-  for (int i = 0; i < increasing_repetitions.ndim(); i++) {
-    CHECK_GE(increasing_repetitions[i], 0) << "repeats cannot be a negative number";
-    repeats += increasing_repetitions[i];
-  }
-  axisOpt = param.axis;
-  if (increasing_repetitions.ndim() == 1) {
-    int len = static_cast<bool>(axisOpt) ? ishape[axis] : ishape.Size();
-    std::vector<int> temp(len, repeats);
-    increasing_repetitions = mxnet::Tuple<int>(temp);
-  }
-  for (int i = 1; i < increasing_repetitions.ndim(); i++) {
-    increasing_repetitions[i] += increasing_repetitions[i - 1];
-  }
-
-  if (ctx.run_ctx.ctx.dev_mask() == gpu::kDevMask) {
-#if MXNET_USE_CUDA
-    cudaMemcpyAsync(ind,
-                    increasing_repetitions.begin(),
-                    increasing_repetitions.ndim() * sizeof(int),
-                    cudaMemcpyHostToDevice,
-                    Stream<gpu>::GetStream(ctx.get_stream<gpu>()));
-#else
-    LOG(FATAL) << "Illegal attempt to use GPU in a CPU-only build";
-#endif
-  } else {
-    std::memcpy(ind, increasing_repetitions.begin(), increasing_repetitions.ndim() * sizeof(int));
-  }
-
-  if (!param.axis.has_value()) {
-    mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
-    const TBlob& in_data    = inputs[0];
-    const TBlob& out_data   = outputs[0];
-    MSHADOW_TYPE_SWITCH(inputs[0].type_flag_, IType, {
-      MSHADOW_TYPE_SWITCH(outputs[0].type_flag_, OType, {
-        mxnet_op::Kernel<repeat_noaxis_fwd, xpu>::Launch(
-            s, out_data.Size(), out_data.dptr<OType>(), in_data.dptr<IType>(), ind);
-      });
-    });
-  } else {
-    mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
-    const TBlob& in_data    = inputs[0];
-    const TBlob& out_data   = outputs[0];
-    int stride              = 1;
-    for (int i = 1; i < ishape.ndim(); i++) {
-      stride *= ishape[i];
+template <typename DType>
+inline void NumpyRepeatsCopyCPU(const DType* in,
+                                DType* out,
+                                const index_t outer,
+                                const index_t len,
+                                const index_t inner,
+                                const std::vector<int>& cumsum) {
+  const index_t total = cumsum[len - 1];
+  ForEachRowCPU(outer * len, inner * total / len, [&](const index_t row) {
+    const index_t o     = row / len;
+    const index_t j     = row % len;
+    const index_t begin = j == 0 ? 0 : cumsum[j - 1];
+    const DType* src    = in + row * inner;
+    DType* dst          = out + (o * total + begin) * inner;
+    if (inner == 1) {
+      FillRunCPU(dst, cumsum[j] - begin, src[0], kWriteTo);
+      return;
     }
-
-    MSHADOW_TYPE_SWITCH_EXT_WITH_BOOL(inputs[0].type_flag_, IType, {
-      MSHADOW_TYPE_SWITCH_EXT_WITH_BOOL(outputs[0].type_flag_, OType, {
-        mxnet_op::Kernel<repeat_axis_fwd, xpu>::Launch(
-            s, out_data.Size(), out_data.dptr<OType>(), in_data.dptr<IType>(), ind, stride);
-      });
-    });
-  }
+    for (index_t r = begin; r < cumsum[j]; ++r, dst += inner)
+      CopyRunCPU(src, dst, inner, kWriteTo);
+  });
 }
 
+/*!
+ * \brief Repeat the elements of the input along one axis, or of the flattened input when no
+ *        axis is given. The input is viewed as (outer, len, inner) around the repeated axis,
+ *        so that any axis is repeated in place without swapping it to the front.
+ */
 template <typename xpu>
 void NumpyRepeatsOpForward(const nnvm::NodeAttrs& attrs,
                            const OpContext& ctx,
@@ -257,61 +210,50 @@ void NumpyRepeatsOpForward(const nnvm::NodeAttrs& attrs,
   const RepeatsParam& param = nnvm::get<RepeatsParam>(attrs.parsed);
   GetRepeatsParams(param, ishape, &repeats, &axisOpt, &axis);
 
-  if (!shape_is_known(ishape) || repeats == 0)
+  if (!shape_is_known(ishape) || repeats == 0 || outputs[0].Size() == 0)
     return;
 
-  mxnet::Tuple<int> tuple_with_repetitions = param.repeats.value();
-  if (tuple_with_repetitions.ndim() == 1) {
-    int len = static_cast<bool>(axisOpt) ? ishape[axis] : ishape.Size();
-    std::vector<int> temp(len, repeats);
-    tuple_with_repetitions = mxnet::Tuple<int>(temp);
+  index_t outer = 1, len = ishape.Size(), inner = 1;
+  if (axisOpt.has_value()) {
+    len = ishape[axis];
+    for (int i = 0; i < axis; ++i)
+      outer *= ishape[i];
+    for (int i = axis + 1; i < ishape.ndim(); ++i)
+      inner *= ishape[i];
+  }
+  const mxnet::Tuple<int>& tuple_with_repetitions = param.repeats.value();
+  std::vector<int> cumsum(len);
+  for (index_t j = 0; j < len; ++j) {
+    const int rep = tuple_with_repetitions.ndim() == 1 ? repeats : tuple_with_repetitions[j];
+    cumsum[j]     = (j == 0 ? 0 : cumsum[j - 1]) + rep;
   }
 
-  // If axis was specified then perform swapaxis before and after calling repeat function
-  if (axisOpt.has_value() && axisOpt.value() != 0) {
-    int type_size          = mshadow_sizeof(inputs[0].type_flag_);
-    size_t total_temp_size = inputs[0].shape_.Size() * type_size +
-                             outputs[0].shape_.Size() * type_size +
-                             tuple_with_repetitions.ndim() * sizeof(int);
-    Tensor<xpu, 1, char> temp_space = ctx.requested[0].get_space_typed<xpu, 1, char>(
-        Shape1(total_temp_size), ctx.get_stream<xpu>());
-    void* swap_output_tmp_dptr   = temp_space.dptr_;
-    void* repeat_output_tmp_dptr = temp_space.dptr_ + inputs[0].shape_.Size() * type_size;
-    int* repeat_tmp_dptr =
-        reinterpret_cast<int*>(temp_space.dptr_ + inputs[0].shape_.Size() * type_size +
-                               outputs[0].shape_.Size() * type_size);
-
-    // Specify parameters for swapaxis function
-    SwapAxisParam swap_axis_param{};
-    NodeAttrs swap_attrs;
-    swap_axis_param.dim1 = 0;
-    swap_axis_param.dim2 = axis;
-    swap_attrs.parsed    = swap_axis_param;
-
-    // Create TBlob that will store first swapaxis function output and then trigger swapaxis
-    // function
-    TShape swap_output_shape = inputs[0].shape_;
-    std::swap(swap_output_shape[0], swap_output_shape[axis]);
-    TBlob swap_output(swap_output_tmp_dptr, swap_output_shape, xpu::kDevMask, inputs[0].type_flag_);
-    SwapAxisCompute<xpu>(swap_attrs, ctx, inputs, req, {swap_output});
-
-    // Create TBlob that will store repeat function output and then trigger repeat function
-    TShape repeat_output_shape = outputs[0].shape_;
-    std::swap(repeat_output_shape[0], repeat_output_shape[axis]);
-    TBlob repeat_output(
-        repeat_output_tmp_dptr, repeat_output_shape, xpu::kDevMask, inputs[0].type_flag_);
-    NumpyRepeatsAxisZeroOpForward<xpu>(
-        attrs, ctx, {swap_output}, req, {repeat_output}, repeat_tmp_dptr);
-
-    // "reswap" previously swapped axes
-    SwapAxisCompute<xpu>(swap_attrs, ctx, {repeat_output}, req, outputs);
+  Stream<xpu>* s = ctx.get_stream<xpu>();
+  if (ctx.run_ctx.ctx.dev_mask() == gpu::kDevMask) {
+#if MXNET_USE_CUDA
+    Tensor<xpu, 1, int> cumsum_dev = ctx.requested[0].get_space_typed<xpu, 1, int>(Shape1(len), s);
+    CUDA_CALL(cudaMemcpyAsync(cumsum_dev.dptr_,
+                              cumsum.data(),
+                              len * sizeof(int),
+                              cudaMemcpyHostToDevice,
+                              Stream<gpu>::GetStream(ctx.get_stream<gpu>())));
+    MSHADOW_TYPE_SWITCH_EXT_WITH_BOOL(outputs[0].type_flag_, DType, {
+      mxnet_op::Kernel<repeat_axis_fwd, xpu>::Launch(s,
+                                                     outputs[0].Size(),
+                                                     outputs[0].dptr<DType>(),
+                                                     inputs[0].dptr<DType>(),
+                                                     cumsum_dev.dptr_,
+                                                     len,
+                                                     inner);
+    });
+#else
+    LOG(FATAL) << "Illegal attempt to use GPU in a CPU-only build";
+#endif
   } else {
-    // axis was not specified, so there is no need to call swapaxis
-    size_t total_temp_size          = tuple_with_repetitions.ndim() * sizeof(int);
-    Tensor<xpu, 1, char> temp_space = ctx.requested[0].get_space_typed<xpu, 1, char>(
-        Shape1(total_temp_size), ctx.get_stream<xpu>());
-    int* repeat_tmp_dptr = reinterpret_cast<int*>(temp_space.dptr_);
-    NumpyRepeatsAxisZeroOpForward<xpu>(attrs, ctx, inputs, req, outputs, repeat_tmp_dptr);
+    MSHADOW_TYPE_SWITCH_EXT_WITH_BOOL(outputs[0].type_flag_, DType, {
+      NumpyRepeatsCopyCPU(
+          inputs[0].dptr<DType>(), outputs[0].dptr<DType>(), outer, len, inner, cumsum);
+    });
   }
 }
 
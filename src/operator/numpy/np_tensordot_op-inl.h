@@ -192,6 +192,93 @@ void MatrixDot(const OpContext& ctx,
   });
 }
 
+/**
+ * A tensor read as a rows-by-cols matrix, stored as the transposed matrix if trans is set.
+ */
+struct MatrixView {
+  TBlob data;
+  index_t rows;
+  index_t cols;
+  bool trans;
+
+  MatrixView T() const {
+    return {data, cols, rows, !trans};
+  }
+};
+
+/**
+ * Calculates matrix dot out = a * b on matrix views, so that no operand needs a transpose copy.
+ */
+template <typename xpu>
+void MatrixViewDot(const OpContext& ctx,
+                   const MatrixView& a,
+                   const MatrixView& b,
+                   const MatrixView& out,
+                   const OpReqType req) {
+  if (out.trans) {
+    // out is stored as its transpose: (a * b)^T = b^T * a^T
+    MatrixViewDot<xpu>(ctx, b.T(), a.T(), out.T(), req);
+    return;
+  }
+  MatrixDot<xpu>(ctx,
+                 a.data,
+                 b.data,
+                 out.data,
+                 req,
+                 a.trans ? a.cols : a.rows,
+                 a.trans ? a.rows : a.cols,
+                 b.trans ? b.cols : b.rows,
+                 b.trans ? b.rows : b.cols,
+                 a.trans,
+                 b.trans);
+}
+
+/**
+ * Checks whether axes first followed by axes second are all axes of a tensor in order.
+ */
+inline bool IsAxesInOrder(const mxnet::Tuple<int>& first, const mxnet::Tuple<int>& second) {
+  int k = 0;
+  for (const int i : first) {
+    if (i != k++)
+      return false;
+  }
+  for (const int i : second) {
+    if (i != k++)
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Gets tensor x as the matrix whose rows run over row_axes and columns over col_axes. A tensor
+ * whose layout already is this matrix or its transpose is used in place, any other one is
+ * transposed into buf (if copy is set, otherwise buf is only reserved for the matrix).
+ */
+template <typename xpu>
+MatrixView GetMatrixView(const OpContext& ctx,
+                         const TBlob& x,
+                         const mxnet::Tuple<int>& row_axes,
+                         const mxnet::Tuple<int>& col_axes,
+                         const index_t rows,
+                         const index_t cols,
+                         void* buf,
+                         const bool copy) {
+  if (IsAxesInOrder(row_axes, col_axes)) {
+    return {x, rows, cols, false};
+  }
+  if (IsAxesInOrder(col_axes, row_axes)) {
+    return {x, rows, cols, true};
+  }
+  std::vector<int> axes(row_axes.begin(), row_axes.end());
+  axes.insert(axes.end(), col_axes.begin(), col_axes.end());
+  const mxnet::Tuple<int> res_axes(axes);
+  TBlob res(buf, GetReorderedShape(x.shape_, res_axes), xpu::kDevMask, x.type_flag_);
+  if (copy) {
+    mxnet::op::TransposeImpl<xpu>(ctx.run_ctx, x, res, mxnet::TShape(axes.begin(), axes.end()));
+  }
+  return {res, rows, cols, false};
+}
+
 /**
  * Scalar multiply.
  */
@@ -284,20 +371,13 @@ void TensordotImpl(const Tuple<int>& a_axes_summed,
                           a_shape,
                           b_shape);
 
-      mxnet::TShape a_temp_shape = GetReorderedShape(a_shape, a_axes);
-      mxnet::TShape b_temp_shape = GetReorderedShape(b_shape, b_axes);
-
       DType* a_ptr = reinterpret_cast<DType*>(workspace.dptr_);
       DType* b_ptr = reinterpret_cast<DType*>(workspace.dptr_ + a.Size() * sizeof(DType));
-      TBlob a_res  = TBlob(a_ptr, a_temp_shape, xpu::kDevMask);
-      TBlob b_res  = TBlob(b_ptr, b_temp_shape, xpu::kDevMask);
-
-      mxnet::op::TransposeImpl<xpu>(
-          ctx.run_ctx, a, a_res, mxnet::TShape(a_axes.begin(), a_axes.end()));
-      mxnet::op::TransposeImpl<xpu>(
-          ctx.run_ctx, b, b_res, mxnet::TShape(b_axes.begin(), b_axes.end()));
-
-      MatrixDot<xpu>(ctx, a_res, b_res, out, req[0], ad1, ad2, bd1, bd2);
+      MatrixView a_mat =
+          GetMatrixView<xpu>(ctx, a, a_axes_remained, a_axes_summed, ad1, ad2, a_ptr, true);
+      MatrixView b_mat =
+          GetMatrixView<xpu>(ctx, b, b_axes_summed, b_axes_remained, bd1, bd2, b_ptr, true);
+      MatrixViewDot<xpu>(ctx, a_mat, b_mat, {out, ad1, bd2, false}, req[0]);
     }
   });
 }
@@ -474,50 +554,37 @@ void TensordotBackwardImpl(const Tuple<int>& a_axes_summed,
                           a_shape,
                           b_shape);
 
-      std::vector<int> a_T_axes;
-      for (int i = 0; i < a_axes_summed.ndim(); i++) {
-        a_T_axes.push_back(a_axes_summed[i]);
-      }
-      for (int i = 0; i < a_axes_remained.ndim(); i++) {
-        a_T_axes.push_back(a_axes_remained[i]);
-      }
-      mxnet::TShape a_temp_shape(GetReorderedShape(a_shape, a_axes));
-      mxnet::TShape a_T_temp_shape(GetReorderedShape(a_shape, a_T_axes));
-
-      std::vector<int> b_T_axes;
-      for (int i = 0; i < b_axes_remained.ndim(); i++) {
-        b_T_axes.push_back(b_axes_remained[i]);
-      }
-      for (int i = 0; i < b_axes_summed.ndim(); i++) {
-        b_T_axes.push_back(b_axes_summed[i]);
-      }
-      mxnet::TShape b_temp_shape(GetReorderedShape(b_shape, b_axes));
-      mxnet::TShape b_T_temp_shape(GetReorderedShape(b_shape, b_T_axes));
-
       DType* a_ptr  = reinterpret_cast<DType*>(workspace.dptr_);
       DType* a_ptr2 = reinterpret_cast<DType*>(workspace.dptr_ + a.Size() * sizeof(DType));
       DType* b_ptr  = reinterpret_cast<DType*>(workspace.dptr_ + 2 * a.Size() * sizeof(DType));
       DType* b_ptr2 =
           reinterpret_cast<DType*>(workspace.dptr_ + (2 * a.Size() + b.Size()) * sizeof(DType));
 
-      TBlob a_res  = TBlob(a_ptr, a_temp_shape, xpu::kDevMask);
-      TBlob b_res  = TBlob(b_ptr, b_temp_shape, xpu::kDevMask);
-      TBlob a_res2 = TBlob(a_ptr2, a_T_temp_shape, xpu::kDevMask);
-      TBlob b_res2 = TBlob(b_ptr2, b_T_temp_shape, xpu::kDevMask);
-
-      mxnet::op::TransposeImpl<xpu>(
-          ctx.run_ctx, a, a_res2, mxnet::TShape(a_T_axes.begin(), a_T_axes.end()));
-      mxnet::op::TransposeImpl<xpu>(
-          ctx.run_ctx, b, b_res2, mxnet::TShape(b_T_axes.begin(), b_T_axes.end()));
-      mxnet::op::TransposeImpl<xpu>(
-          ctx.run_ctx, grad_a, a_res, mxnet::TShape(a_axes.begin(), a_axes.end()));
-      mxnet::op::TransposeImpl<xpu>(
-          ctx.run_ctx, grad_b, b_res, mxnet::TShape(b_axes.begin(), b_axes.end()));
-      MatrixDot<xpu>(ctx, a_res2, out_grad, b_res, req[1], ad2, ad1, ad1, bd2);
-      MatrixDot<xpu>(ctx, out_grad, b_res2, a_res, req[0], ad1, bd2, bd2, bd1);
-
-      mxnet::op::TransposeImpl<xpu>(ctx.run_ctx, a_res, grad_a, GetReverseShape(a_axes));
-      mxnet::op::TransposeImpl<xpu>(ctx.run_ctx, b_res, grad_b, GetReverseShape(b_axes));
+      // the gradients have the layouts of a and b, so they are written in place whenever the
+      // inputs are read in place
+      MatrixView a_mat =
+          GetMatrixView<xpu>(ctx, a, a_axes_remained, a_axes_summed, ad1, ad2, a_ptr, true);
+      MatrixView b_mat =
+          GetMatrixView<xpu>(ctx, b, b_axes_summed, b_axes_remained, bd1, bd2, b_ptr, true);
+      MatrixView out_grad_mat = {out_grad, ad1, bd2, false};
+      if (req[0] != kNullOp) {
+        MatrixView grad_a_mat = GetMatrixView<xpu>(
+            ctx, grad_a, a_axes_remained, a_axes_summed, ad1, ad2, a_ptr2, req[0] == kAddTo);
+        MatrixViewDot<xpu>(ctx, out_grad_mat, b_mat.T(), grad_a_mat, req[0]);
+        if (grad_a_mat.data.dptr_ != grad_a.dptr_) {
+          mxnet::op::TransposeImpl<xpu>(
+              ctx.run_ctx, grad_a_mat.data, grad_a, GetReverseShape(a_axes));
+        }
+      }
+      if (req[1] != kNullOp) {
+        MatrixView grad_b_mat = GetMatrixView<xpu>(
+            ctx, grad_b, b_axes_summed, b_axes_remained, bd1, bd2, b_ptr2, req[1] == kAddTo);
+        MatrixViewDot<xpu>(ctx, a_mat.T(), out_grad_mat, grad_b_mat, req[1]);
+        if (grad_b_mat.data.dptr_ != grad_b.dptr_) {
+          mxnet::op::TransposeImpl<xpu>(
+              ctx.run_ctx, grad_b_mat.data, grad_b, GetReverseShape(b_axes));
+        }
+      }
     }
   });
 }
@@ -94,6 +94,38 @@ struct UniqueComputeMaskCPUKernel {
   }
 };
 
+struct UniqueComputeRunStartCPUKernel {
+  // idx[k] is the position in the sorted data where the k-th unique value starts
+  MSHADOW_XINLINE static void Map(dim_t i,
+                                  dim_t* idx,
+                                  const dim_t* mask,
+                                  const int32_t* prefix_sum) {
+    if (mask[i]) {
+      idx[prefix_sum[i] - 1] = i;
+    }
+  }
+};
+
+/*!
+ * \brief Hash and equality of the values of unique, half and bfloat16 go through float
+ *        since they have no std::hash or operator==.
+ */
+template <typename DType>
+struct UniqueValueHash {
+  using Key = typename std::conditional<std::is_arithmetic<DType>::value, DType, float>::type;
+  size_t operator()(const DType& value) const {
+    return std::hash<Key>()(static_cast<Key>(value));
+  }
+};
+
+template <typename DType>
+struct UniqueValueEqual {
+  using Key = typename UniqueValueHash<DType>::Key;
+  bool operator()(const DType& lhs, const DType& rhs) const {
+    return static_cast<Key>(lhs) == static_cast<Key>(rhs);
+  }
+};
+
 void NumpyUniqueCPUNoneAxisImpl(const NumpyUniqueParam& param,
                                 const OpContext& ctx,
                                 const std::vector<NDArray>& inputs,
@@ -121,12 +153,9 @@ void NumpyUniqueCPUNoneAxisImpl(const NumpyUniqueParam& param,
           stream, input_size, mask.data(), aux.data(), 1);
       // Calculate prefix sum
       std::vector<int32_t> prefix_sum(input_size, 0);
-      int32_t valid_num = 0;
-      for (dim_t i = 0; i < input_size; i++) {
-        prefix_sum[i] = (i == 0) ? 0 : prefix_sum[i - 1];
-        prefix_sum[i] += (mask[i]) ? 1 : 0;
-      }
-      valid_num = prefix_sum[input_size - 1];
+      const dim_t* mask_dptr = mask.data();
+      auto is_start          = [mask_dptr](index_t i) { return mask_dptr[i] != 0; };
+      int32_t valid_num      = PrefixCountCPU(input_size, is_start, prefix_sum.data());
       // set the output shape forcefully
       mxnet::TShape s(1, valid_num);
       const_cast<NDArray&>(outputs[0]).Init(s);
@@ -153,24 +182,24 @@ void NumpyUniqueCPUNoneAxisImpl(const NumpyUniqueParam& param,
       if (param.return_counts) {
         output_flag += 1;
         std::vector<dim_t> idx(valid_num + 1);
-        auto iter = idx.begin();
-        for (dim_t i = 0; i < input_size; ++i) {
-          if (mask[i]) {
-            *iter = i;
-            ++iter;
-          }
-        }
-        *iter = input_size;
+        mxnet_op::Kernel<UniqueComputeRunStartCPUKernel, cpu>::Launch(
+            stream, input_size, idx.data(), mask.data(), prefix_sum.data());
+        idx[valid_num] = input_size;
         const_cast<NDArray&>(outputs[output_flag]).Init(s);
         dim_t* unique_counts = outputs[output_flag].data().dptr<dim_t>();
         mxnet_op::Kernel<UniqueReturnCountsKernel, cpu>::Launch(
             stream, valid_num, unique_counts, idx.data());
       }
     } else {
-      std::set<DType> set(input_data, input_data + input_size);
+      // only the distinct values are sorted, which is much less work than sorting the whole
+      // input when values repeat
+      std::unordered_set<DType, UniqueValueHash<DType>, UniqueValueEqual<DType> > set(
+          input_data, input_data + input_size);
       mxnet::TShape s(1, set.size());
       const_cast<NDArray&>(outputs[0]).Init(s);
-      std::copy(set.begin(), set.end(), outputs[0].data().dptr<DType>());
+      DType* out_data = outputs[0].data().dptr<DType>();
+      std::copy(set.begin(), set.end(), out_data);
+      std::sort(out_data, out_data + set.size());
     }
   });
 }
@@ -230,12 +259,9 @@ void NumpyUniqueCPUImpl(const NumpyUniqueParam& param,
         stream, temp_shape[0], mask.data(), aux.dptr_, numel);
     // calculate prefix sum
     std::vector<int32_t> prefix_sum(temp_shape[0], 0);
-    int32_t valid_num = 0;
-    for (dim_t i = 0; i < temp_shape[0]; i++) {
-      prefix_sum[i] = (i == 0) ? 0 : prefix_sum[i - 1];
-      prefix_sum[i] += (mask[i]) ? 1 : 0;
-    }
-    valid_num = prefix_sum[temp_shape[0] - 1];
+    const dim_t* mask_dptr = mask.data();
+    auto is_start          = [mask_dptr](index_t i) { return mask_dptr[i] != 0; };
+    int32_t valid_num      = PrefixCountCPU(temp_shape[0], is_start, prefix_sum.data());
     // store the temp output data, reuse the space of 'input_tensor'
     Tensor<cpu, 3, DType> temp_tensor(
         workspace.dptr_, Shape3(valid_num, temp_shape[1], temp_shape[2]), stream);
@@ -269,14 +295,9 @@ void NumpyUniqueCPUImpl(const NumpyUniqueParam& param,
     if (param.return_counts) {
       output_flag += 1;
       std::vector<dim_t> idx(valid_num + 1);
-      auto iter = idx.begin();
-      for (dim_t i = 0; i < temp_shape[0]; ++i) {
-        if (mask[i]) {
-          *iter = i;
-          ++iter;
-        }
-      }
-      *iter = temp_shape[0];
+      mxnet_op::Kernel<UniqueComputeRunStartCPUKernel, cpu>::Launch(
+          stream, temp_shape[0], idx.data(), mask.data(), prefix_sum.data());
+      idx[valid_num] = temp_shape[0];
       const_cast<NDArray&>(outputs[output_flag]).Init(mxnet::TShape(1, valid_num));
       dim_t* unique_counts = outputs[output_flag].data().dptr<dim_t>();
       mxnet_op::Kernel<UniqueReturnCountsKernel, cpu>::Launch(
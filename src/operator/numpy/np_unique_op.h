@@ -30,10 +30,13 @@
 #include <numeric>
 #include <set>
 #include <string>
+#include <type_traits>
+#include <unordered_set>
 #include "../mxnet_op.h"
 #include "../operator_common.h"
 #include "../mshadow_op.h"
 #include "../contrib/boolean_mask-inl.h"
+#include "../tensor/prefix_count-inl.h"
 #ifdef __CUDACC__
 #include <thrust/device_ptr.h>
 #include <thrust/device_vector.h>
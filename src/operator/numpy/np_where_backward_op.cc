@@ -31,6 +31,10 @@ NNVM_REGISTER_OP(_backward_np_where)
     .set_num_inputs(2)
     .set_num_outputs(2)
     .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<nnvm::FInplaceOption>("FInplaceOption",
+                                    [](const NodeAttrs& attrs) {
+                                      return std::vector<std::pair<int, int> >{{0, 0}};
+                                    })
     .set_attr<FCompute>("FCompute<cpu>", NumpyWhereOpBackward<cpu>)
     .set_attr<FResourceRequest>("FResourceRequest", [](const NodeAttrs& attrs) {
       return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
@@ -40,6 +44,10 @@ NNVM_REGISTER_OP(_backward_np_where_lscalar)
     .set_num_inputs(2)
     .set_num_outputs(1)
     .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<nnvm::FInplaceOption>("FInplaceOption",
+                                    [](const NodeAttrs& attrs) {
+                                      return std::vector<std::pair<int, int> >{{0, 0}};
+                                    })
     .set_attr<FCompute>("FCompute<cpu>", NumpyWhereScalarOpBackward<cpu, true>)
     .set_attr<FResourceRequest>("FResourceRequest", [](const NodeAttrs& attrs) {
       return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
@@ -49,6 +57,10 @@ NNVM_REGISTER_OP(_backward_np_where_rscalar)
     .set_num_inputs(2)
     .set_num_outputs(1)
     .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<nnvm::FInplaceOption>("FInplaceOption",
+                                    [](const NodeAttrs& attrs) {
+                                      return std::vector<std::pair<int, int> >{{0, 0}};
+                                    })
     .set_attr<FCompute>("FCompute<cpu>", NumpyWhereScalarOpBackward<cpu, false>)
     .set_attr<FResourceRequest>("FResourceRequest", [](const NodeAttrs& attrs) {
       return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
@@ -109,6 +109,28 @@ struct numpy_where_backward_kernel {
   }
 };
 
+template <int ndim>
+struct numpy_where_backward_fused_kernel {
+  template <typename CType, typename DType>
+  MSHADOW_XINLINE static void Map(index_t base,
+                                  OpReqType req_x,
+                                  OpReqType req_y,
+                                  const Shape<ndim>& cstride,
+                                  const Shape<ndim>& oshape,
+                                  CType* datac,
+                                  DType* datao,
+                                  DType* grad_x,
+                                  DType* grad_y) {
+    Shape<ndim> coord = mxnet_op::unravel(base, oshape);
+    auto cidx         = static_cast<index_t>(mxnet_op::dot(coord, cstride));
+    // ograd is read before either gradient is written, so grad[x] may overwrite it
+    const DType ograd = datao[base];
+    const bool take_x = datac[cidx] != CType(0);
+    KERNEL_ASSIGN(grad_x[base], req_x, take_x ? ograd : DType(0));
+    KERNEL_ASSIGN(grad_y[base], req_y, take_x ? DType(0) : ograd);
+  }
+};
+
 template <int ndim, bool is_left>
 struct numpy_where_scalar_kernel {
   template <typename CType, typename DType>
@@ -180,6 +202,21 @@ inline void NumpyWhereOpForward(const nnvm::NodeAttrs& attrs,
   Shape<broadcast::MAX_DIM> oshape = expanded_oshape.get<broadcast::MAX_DIM>();
   MSHADOW_TYPE_SWITCH_WITH_BOOL(out.type_flag_, DType, {
     MSHADOW_TYPE_SWITCH_WITH_BOOL(cond.type_flag_, CType, {
+      if (cond.shape_ == out.shape_ && x.shape_ == out.shape_ && y.shape_ == out.shape_) {
+        // nothing is broadcast, every operand is read at the output index
+        mxnet_op::Kernel<numpy_where_kernel<1>, xpu>::Launch(s,
+                                                             out.Size(),
+                                                             req[0],
+                                                             Shape1(1),
+                                                             Shape1(1),
+                                                             Shape1(1),
+                                                             Shape1(out.Size()),
+                                                             cond.dptr<CType>(),
+                                                             x.dptr<DType>(),
+                                                             y.dptr<DType>(),
+                                                             out.dptr<DType>());
+        return;
+      }
       mxnet_op::Kernel<numpy_where_kernel<broadcast::MAX_DIM>, xpu>::Launch(s,
                                                                             out.Size(),
                                                                             req[0],
@@ -259,17 +296,32 @@ inline void NumpyWhereOpBackward(const nnvm::NodeAttrs& attrs,
             broadcast::ReduceWorkspaceSize(s, expanded_rshape, req[1], expanded_oshape);
         ws_size = std::max(ws_size1, ws_size2);
       }
-      // process left output
-      if (ograd.shape_ == dx.shape_) {
-        mxnet_op::Kernel<numpy_where_backward_kernel<broadcast::MAX_DIM, true>, xpu>::Launch(
+      if (ograd.shape_ == dx.shape_ && ograd.shape_ == dy.shape_) {
+        // both gradients in one pass over ograd and condition
+        mxnet_op::Kernel<numpy_where_backward_fused_kernel<broadcast::MAX_DIM>, xpu>::Launch(
             s,
             ograd.Size(),
             req[0],
+            req[1],
             cstride,
             oshape,
             cond.dptr<CType>(),
             ograd.dptr<DType>(),
-            dx.dptr<DType>());
+            dx.dptr<DType>(),
+            dy.dptr<DType>());
+        return;
+      }
+      // process right output
+      if (ograd.shape_ == dy.shape_) {
+        mxnet_op::Kernel<numpy_where_backward_kernel<broadcast::MAX_DIM, false>, xpu>::Launch(
+            s,
+            ograd.Size(),
+            req[1],
+            cstride,
+            oshape,
+            cond.dptr<CType>(),
+            ograd.dptr<DType>(),
+            dy.dptr<DType>());
       } else {
         largespace = ctx.requested[0].get_space_typed<xpu, 1, char>(
             Shape1(ograd.shape_.Size() * sizeof(DType) + ws_size), s);
@@ -277,42 +329,42 @@ inline void NumpyWhereOpBackward(const nnvm::NodeAttrs& attrs,
             reinterpret_cast<DType*>(largespace.dptr_ + ws_size),
             expanded_oshape.get<broadcast::MAX_DIM>(),
             s);
-        mxnet_op::Kernel<numpy_where_backward_kernel<broadcast::MAX_DIM, true>, xpu>::Launch(
+        mxnet_op::Kernel<numpy_where_backward_kernel<broadcast::MAX_DIM, false>, xpu>::Launch(
             s,
             ograd.Size(),
-            req[0],
+            req[1],
             cstride,
             oshape,
             cond.dptr<CType>(),
             ograd.dptr<DType>(),
             workspace.dptr_);
-        if (NeedSafeAcc<true>(dx.type_flag_, dx.type_flag_)) {
+        if (NeedSafeAcc<true>(dy.type_flag_, dy.type_flag_)) {
           NP_WHERE_REDUCE_AXES(true,
                                ctx,
                                {TBlob(workspace)},
-                               {req[0]},
-                               {dx.reshape(expanded_lshape)},
-                               expanded_lshape);
+                               {req[1]},
+                               {dy.reshape(expanded_rshape)},
+                               expanded_rshape);
         } else {
           NP_WHERE_REDUCE_AXES(false,
                                ctx,
                                {TBlob(workspace)},
-                               {req[0]},
-                               {dx.reshape(expanded_lshape)},
-                               expanded_lshape);
+                               {req[1]},
+                               {dy.reshape(expanded_rshape)},
+                               expanded_rshape);
         }
       }
-      // process right output
-      if (ograd.shape_ == dy.shape_) {
-        mxnet_op::Kernel<numpy_where_backward_kernel<broadcast::MAX_DIM, false>, xpu>::Launch(
+      // process left output last, it may share its memory with ograd
+      if (ograd.shape_ == dx.shape_) {
+        mxnet_op::Kernel<numpy_where_backward_kernel<broadcast::MAX_DIM, true>, xpu>::Launch(
             s,
             ograd.Size(),
-            req[1],
+            req[0],
             cstride,
             oshape,
             cond.dptr<CType>(),
             ograd.dptr<DType>(),
-            dy.dptr<DType>());
+            dx.dptr<DType>());
       } else {
         largespace = ctx.requested[0].get_space_typed<xpu, 1, char>(
             Shape1(ograd.shape_.Size() * sizeof(DType) + ws_size), s);
@@ -320,29 +372,29 @@ inline void NumpyWhereOpBackward(const nnvm::NodeAttrs& attrs,
             reinterpret_cast<DType*>(largespace.dptr_ + ws_size),
             expanded_oshape.get<broadcast::MAX_DIM>(),
             s);
-        mxnet_op::Kernel<numpy_where_backward_kernel<broadcast::MAX_DIM, false>, xpu>::Launch(
+        mxnet_op::Kernel<numpy_where_backward_kernel<broadcast::MAX_DIM, true>, xpu>::Launch(
             s,
             ograd.Size(),
-            req[1],
+            req[0],
             cstride,
             oshape,
             cond.dptr<CType>(),
             ograd.dptr<DType>(),
             workspace.dptr_);
-        if (NeedSafeAcc<true>(dy.type_flag_, dy.type_flag_)) {
+        if (NeedSafeAcc<true>(dx.type_flag_, dx.type_flag_)) {
           NP_WHERE_REDUCE_AXES(true,
                                ctx,
                                {TBlob(workspace)},
-                               {req[1]},
-                               {dy.reshape(expanded_rshape)},
-                               expanded_rshape);
+                               {req[0]},
+                               {dx.reshape(expanded_lshape)},
+                               expanded_lshape);
         } else {
           NP_WHERE_REDUCE_AXES(false,
                                ctx,
                                {TBlob(workspace)},
-                               {req[1]},
-                               {dy.reshape(expanded_rshape)},
-                               expanded_rshape);
+                               {req[0]},
+                               {dx.reshape(expanded_lshape)},
+                               expanded_lshape);
         }
       }
     });
@@ -385,6 +437,19 @@ inline void NumpyWhereScalarOpForward(const nnvm::NodeAttrs& attrs,
   Shape<broadcast::MAX_DIM> oshape = expanded_oshape.get<broadcast::MAX_DIM>();
   MSHADOW_TYPE_SWITCH_WITH_BOOL(out.type_flag_, DType, {
     MSHADOW_TYPE_SWITCH_WITH_BOOL(cond.type_flag_, CType, {
+      if (cond.shape_ == out.shape_ && y.shape_ == out.shape_) {
+        mxnet_op::Kernel<numpy_where_scalar_kernel<1, is_left>, xpu>::Launch(s,
+                                                                             out.Size(),
+                                                                             req[0],
+                                                                             Shape1(1),
+                                                                             Shape1(1),
+                                                                             Shape1(out.Size()),
+                                                                             cond.dptr<CType>(),
+                                                                             DType(param.scalar),
+                                                                             y.dptr<DType>(),
+                                                                             out.dptr<DType>());
+        return;
+      }
       mxnet_op::Kernel<numpy_where_scalar_kernel<broadcast::MAX_DIM, is_left>, xpu>::Launch(
           s,
           out.Size(),
@@ -516,6 +516,44 @@ inline void LogUnimplementedOp(const nnvm::NodeAttrs& attrs,
   LOG(FATAL) << "Not implemented: " << operator_string(attrs, ctx, inputs, req, outputs);
 }
 
+/*! \brief Bytes moved by an operator that reads every input and writes every output once */
+inline uint64_t OpCostBytes(const std::vector<TBlob>& inputs, const std::vector<TBlob>& outputs) {
+  uint64_t bytes = 0;
+  for (const TBlob& blob : inputs)
+    bytes += blob.shape_.Size() * mshadow::mshadow_sizeof(blob.type_flag_);
+  for (const TBlob& blob : outputs)
+    bytes += blob.shape_.Size() * mshadow::mshadow_sizeof(blob.type_flag_);
+  return bytes;
+}
+
+/*!
+ * \brief FOpCost of an operator doing flops_per_element operations for every element of its
+ *        first output
+ */
+template <int flops_per_element>
+inline OpCost ElemwiseOpCost(const nnvm::NodeAttrs& attrs,
+                             const std::vector<TBlob>& inputs,
+                             const std::vector<TBlob>& outputs) {
+  OpCost cost;
+  cost.flops = outputs.empty() ? 0 : outputs[0].shape_.Size() * flops_per_element;
+  cost.bytes = OpCostBytes(inputs, outputs);
+  return cost;
+}
+
+/*!
+ * \brief FOpCost of a reduction doing flops_per_element operations for every element of its
+ *        first input
+ */
+template <int flops_per_element>
+inline OpCost ReduceOpCost(const nnvm::NodeAttrs& attrs,
+                           const std::vector<TBlob>& inputs,
+                           const std::vector<TBlob>& outputs) {
+  OpCost cost;
+  cost.flops = inputs.empty() ? 0 : inputs[0].shape_.Size() * flops_per_element;
+  cost.bytes = OpCostBytes(inputs, outputs);
+  return cost;
+}
+
 class OpSignature {
   std::vector<int64_t> eles;
   uint64_t hash;
@@ -660,6 +698,11 @@ class OpSignature {
     eles.push_back(val);
   }
 
+  void AddSign(uint64_t val) {
+    hash = dmlc::HashCombine(hash, val);
+    eles.push_back(static_cast<int64_t>(val));
+  }
+
   void AddSign(const std::vector<float>& vec) {
     for (auto& val : vec) {
       AddSign(val);
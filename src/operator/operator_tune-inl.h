@@ -160,6 +160,10 @@ class OperatorTune : public OperatorTuneByType<DType> {
 
       OperatorTuneBase::tuning_weight_scale_ = dmlc::GetEnv("MXNET_TUNING_WEIGHT_SCALE", 0.0);
 
+      OperatorTuneBase::online_tuning_ = dmlc::GetEnv("MXNET_OPERATOR_TUNING_ONLINE", false);
+
+      OperatorTuneBase::adaptive_threads_ = dmlc::GetEnv("MXNET_OPERATOR_TUNING_THREADS", true);
+
       // This isn't actually supposed to be multithreaded init, but just to be sure the change is
       // seen everywhere, using atomic bool.
       if (!OperatorTuneBase::calculated_.load()) {
@@ -171,7 +175,7 @@ class OperatorTune : public OperatorTuneByType<DType> {
         // disabled
         if (!config.empty() && ::isdigit(config[0]) && std::atoi(config.c_str()) == 0) {
           OperatorTuneBase::omp_overhead_ns_ = INT_MAX;
-        } else {
+        } else if (!OperatorTuneBase::LookupOMPOverhead()) {
           OperatorTuneBase::omp_overhead_ns_ = GetOMPLoopOverhead();
         }
         ParseEnablerConfig(config);
@@ -242,6 +246,7 @@ class OperatorTune : public OperatorTuneByType<DType> {
     }
     CHECK_EQ(size_save, tl->size()) << "Tuning list size should not have changed while tuning";
     tl->clear();
+    OperatorTuneBase::SaveTuningCache();
     return true;
   }
 
@@ -255,6 +260,21 @@ class OperatorTune : public OperatorTuneByType<DType> {
   }
 
  protected:
+  /*!
+   * \brief Set the workload of a tuned kernel from the per-host tuning cache, or measure it
+   *        if the cache does not hold it yet
+   * \tparam TunedOP tuned_op<> type of the kernel
+   * \param measure Function returning the workload of the kernel (nanoseconds for WORKLOAD_COUNT
+   *        calls)
+   */
+  template <typename TunedOP, typename Function>
+  static void SetWorkload(Function measure) {
+    float* workload = &TunedOP::workload_[0];
+    if (!OperatorTuneBase::LookupTuningCache(type_name<TunedOP>(), workload)) {
+      *workload = measure();
+    }
+  }
+
   /*!
    * \brief Get the list of tuning function calls for the operators
    * \return Pointer to list of tuning function calls
@@ -647,7 +667,7 @@ class UnaryOpTune : public OperatorTune<DType> {
    */
   template <typename OP>
   static void TuneBlankOperator() {
-    mxnet::op::mxnet_op::tuned_op<OP, DType>::workload_[0] = GetBlankWorkload<OP>();
+    Super::template SetWorkload<mxnet::op::mxnet_op::tuned_op<OP, DType>>(GetBlankWorkload<OP>);
     if (Super::output_tuning_data_) {
       std::cout << "IMPLEMENT_UNARY_WORKLOAD_FWD(" << Super::template type_name<OP>()
                 << ");  // NOLINT()" << std::endl
@@ -663,7 +683,7 @@ class UnaryOpTune : public OperatorTune<DType> {
    */
   template <typename OP>
   static void TuneUnaryOperator() {
-    mxnet::op::mxnet_op::tuned_op<OP, DType>::workload_[0] = GetUnaryWorkload<OP>();
+    Super::template SetWorkload<mxnet::op::mxnet_op::tuned_op<OP, DType>>(GetUnaryWorkload<OP>);
     if (Super::output_tuning_data_) {
       std::cout << "IMPLEMENT_UNARY_WORKLOAD_FWD(" << Super::template type_name<OP>()
                 << ");  // NOLINT()" << std::endl
@@ -679,8 +699,9 @@ class UnaryOpTune : public OperatorTune<DType> {
    */
   template <typename OP>
   static void TuneUnaryBackwardOperator() {
-    mxnet::op::mxnet_op::tuned_op<mxnet_op::backward_grad_tuned<OP>, DType>::workload_[0] =
-        GetBinaryWorkload<mxnet::op::mxnet_op::backward_grad_tuned<OP>>();
+    Super::template SetWorkload<
+        mxnet::op::mxnet_op::tuned_op<mxnet_op::backward_grad_tuned<OP>, DType>>(
+        GetBinaryWorkload<mxnet::op::mxnet_op::backward_grad_tuned<OP>>);
     if (Super::output_tuning_data_) {
       std::cout << "IMPLEMENT_UNARY_WORKLOAD_BWD(" << Super::template type_name<OP>()
                 << ");  // NOLINT()" << std::endl
@@ -697,7 +718,8 @@ class UnaryOpTune : public OperatorTune<DType> {
    */
   template <typename OP>
   static void TuneBlankOperatorEx() {
-    mxnet::op::mxnet_op::tuned_op<OP, DType>::workload_[0] = GetBlankWorkloadEx<OP>();
+    Super::template SetWorkload<mxnet::op::mxnet_op::tuned_op<OP, DType>>(
+        GetBlankWorkloadEx<OP>);
     if (Super::output_tuning_data_) {
       std::cout << "IMPLEMENT_BLANK_WORKLOAD_FWD(" << Super::template type_name<OP>()
                 << ");  // NOLINT()" << std::endl
@@ -736,7 +758,8 @@ class BinaryOpTune : public UnaryOpTune<DType> {
    */
   template <typename OP>
   static void TuneBinaryOperator() {
-    mxnet_op::tuned_op<OP, DType>::workload_[0] = Super::template GetBinaryWorkload<OP>();
+    Super::Super::template SetWorkload<mxnet_op::tuned_op<OP, DType>>(
+        Super::template GetBinaryWorkload<OP>);
     if (Super::Super::output_tuning_data_) {
       std::cout << "IMPLEMENT_BINARY_WORKLOAD_FWD(" << Super::template type_name<OP>()
                 << ");  // NOLINT()" << std::endl
@@ -750,8 +773,9 @@ class BinaryOpTune : public UnaryOpTune<DType> {
    */
   template <typename OP>
   static void TuneBinaryBackwardOperator() {
-    mxnet::op::mxnet_op::tuned_op<mxnet_op::backward_grad_tuned<OP>, DType>::workload_[0] =
-        Super::template GetTertiaryWorkload<mxnet::op::mxnet_op::backward_grad_tuned<OP>>();
+    Super::Super::template SetWorkload<
+        mxnet::op::mxnet_op::tuned_op<mxnet_op::backward_grad_tuned<OP>, DType>>(
+        Super::template GetTertiaryWorkload<mxnet::op::mxnet_op::backward_grad_tuned<OP>>);
     if (Super::Super::output_tuning_data_) {
       std::cout << "IMPLEMENT_BINARY_WORKLOAD_BWD(" << Super::template type_name<OP>()
                 << ");  // NOLINT()" << std::endl
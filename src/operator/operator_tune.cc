@@ -16,13 +16,22 @@
  * specific language governing permissions and limitations
  * under the License.
  */
+#include <dmlc/parameter.h>
+#if !(defined(_WIN32) || defined(_WIN64) || defined(__WINDOWS__))
+#include <sys/stat.h>
+#endif
 #include <cfloat>
 #include <atomic>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <unordered_map>
 #include "./mxnet_op.h"
 #include "./mshadow_op.h"
 #include "./tensor/init_op.h"
 #include "./operator_tune-inl.h"
 #include "./tensor/elemwise_binary_broadcast_op.h"
+#include "../common/utils.h"
 
 namespace mxnet {
 namespace op {
@@ -33,6 +42,196 @@ namespace op {
 std::atomic<bool> OperatorTuneBase::calculated_(false);
 bool OperatorTuneBase::verbose_tuning_info_   = false;
 double OperatorTuneBase::tuning_weight_scale_ = 0.0;
+bool OperatorTuneBase::online_tuning_         = false;
+bool OperatorTuneBase::adaptive_threads_      = false;
+
+namespace {
+
+/*!
+ * \brief Tuning data persisted per host, so that a process started on a machine which was tuned
+ *        before skips the timing at static initialization.
+ *        It lives in the file <MXNET_OPERATOR_TUNING_CACHE>/<cpu model>-<cores>.tune, with each
+ *        line holding a kernel name and its workload separated by a tab.
+ */
+struct TuningCache {
+  /*! \brief Path of the cache file, empty if the cache is disabled */
+  std::string path;
+  /*! \brief Header line identifying the host, a file with another header is ignored */
+  std::string host;
+  /*! \brief Workloads read from the file */
+  std::unordered_map<std::string, float> loaded;
+  /*! \brief Workloads to write, sorted by name so that the file diffs well */
+  std::map<std::string, float*> live;
+  /*! \brief Whether a value was measured or refined since the file was read or written */
+  bool dirty = false;
+  /*! \brief Number of launches refined online since the file was written */
+  size_t refined = 0;
+  std::mutex mutex;
+
+  TuningCache() {
+    std::string dir = dmlc::GetEnv("MXNET_OPERATOR_TUNING_CACHE", std::string());
+    if (dir == "0") {
+      return;
+    }
+    if (dir.empty()) {
+      const char* home = getenv("MXNET_HOME");
+      if (home) {
+        dir = home;
+      } else if ((home = getenv("HOME")) != nullptr) {
+        dir = std::string(home) + "/.mxnet";
+      } else {
+        return;
+      }
+      dir += "/operator_tune";
+    }
+    const std::string model = CPUModel();
+    if (model.empty()) {
+      return;
+    }
+    const int cores = omp_get_num_procs();
+    host            = "# " + model + ", " + std::to_string(cores) + " cores";
+    std::string name;
+    for (const char c : model) {
+      name += ::isalnum(c) ? c : '_';
+    }
+    path = dir + "/" + name + "-" + std::to_string(cores) + ".tune";
+    Load();
+  }
+
+  /*!
+   * \brief CPU model name of the host
+   * \return The model name, empty if it is unknown
+   */
+  static std::string CPUModel() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+      if (line.compare(0, 10, "model name") == 0) {
+        const size_t colon = line.find(':');
+        if (colon != std::string::npos) {
+          line = line.substr(colon + 1);
+          line.erase(0, line.find_first_not_of(" \t"));
+          return line;
+        }
+      }
+    }
+    return std::string();
+  }
+
+  void Load() {
+    std::ifstream is(path);
+    std::string line;
+    if (!std::getline(is, line) || line != host) {
+      return;
+    }
+    while (std::getline(is, line)) {
+      const size_t tab = line.rfind('\t');
+      if (tab != std::string::npos) {
+        loaded[line.substr(0, tab)] = std::strtof(line.c_str() + tab + 1, nullptr);
+      }
+    }
+  }
+
+  void Save() {
+    const OperatorTuneBase::duration_t omp_overhead_ns = OperatorTuneBase::omp_overhead_ns();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!dirty || path.empty()) {
+      return;
+    }
+    dirty   = false;
+    refined = 0;
+#if !(defined(_WIN32) || defined(_WIN64) || defined(__WINDOWS__))
+    mkdir(path.substr(0, path.rfind('/')).c_str(), 0755);
+#endif
+    // write to a temporary file first, processes started concurrently could be reading the cache
+    const std::string tmp = path + "." + std::to_string(common::current_process_id());
+    {
+      std::ofstream os(tmp);
+      os << host << std::endl;
+      // INT_MAX when tuning is disabled or with a single core, which is not worth caching
+      if (omp_overhead_ns < INT_MAX) {
+        os << "omp_overhead_ns\t" << omp_overhead_ns << std::endl;
+      }
+      for (const auto& kv : live) {
+        os << kv.first << "\t" << *kv.second << std::endl;
+      }
+      if (!os.good()) {
+        LOG(WARNING) << "Could not write the operator tuning cache " << path;
+        return;
+      }
+    }
+    std::rename(tmp.c_str(), path.c_str());
+  }
+
+  static TuningCache* Get() {
+    // never destroyed, kernels may still be launched during static destruction
+    static TuningCache* cache = new TuningCache();
+    return cache;
+  }
+};
+
+}  // namespace
+
+bool OperatorTuneBase::LookupTuningCache(const std::string& key, float* workload) {
+  TuningCache* cache = TuningCache::Get();
+  std::lock_guard<std::mutex> lock(cache->mutex);
+  cache->live[key] = workload;
+  const auto it    = cache->loaded.find(key);
+  if (it != cache->loaded.end()) {
+    *workload = it->second;
+    return true;
+  }
+  cache->dirty = true;
+  return false;
+}
+
+bool OperatorTuneBase::LookupOMPOverhead() {
+  TuningCache* cache = TuningCache::Get();
+  std::lock_guard<std::mutex> lock(cache->mutex);
+  const auto it = cache->loaded.find("omp_overhead_ns");
+  if (it != cache->loaded.end()) {
+    omp_overhead_ns_ = static_cast<duration_t>(it->second);
+    return true;
+  }
+  cache->dirty = true;
+  return false;
+}
+
+void OperatorTuneBase::SaveTuningCache() {
+  TuningCache::Get()->Save();
+}
+
+void OperatorTuneBase::RefineWorkload(float* workload,
+                                      size_t N,
+                                      size_t thread_count,
+                                      duration_t duration_ns) {
+  // exponential moving average, a single launch may have been preempted
+  constexpr float kWeight = 0.125f;
+  // launches refined between two writes of the cache
+  constexpr size_t kSavePeriod = 1 << 14;
+  TuningCache* cache           = TuningCache::Get();
+  {
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    if (thread_count < 2) {
+      const float measured = static_cast<float>(duration_ns) * WORKLOAD_COUNT / N;
+      *workload += kWeight * (measured - *workload);
+    } else {
+      // what the launch took beyond its share of the serial work is the OMP overhead
+      const duration_t compute_ns =
+          static_cast<duration_t>(*workload * N / thread_count) / WORKLOAD_COUNT;
+      if (duration_ns <= compute_ns) {
+        return;
+      }
+      omp_overhead_ns_ += static_cast<duration_t>(
+          kWeight * static_cast<float>(duration_ns - compute_ns - omp_overhead_ns_));
+    }
+    cache->dirty = true;
+    if (++cache->refined < kSavePeriod) {
+      return;
+    }
+  }
+  cache->Save();
+}
 
 /*!
  * \brief Instantiate static variables for OperatorTune<DType>, where 'DType' is specified
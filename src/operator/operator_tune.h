@@ -21,6 +21,7 @@
 
 #include <mshadow/base.h>
 #include <mshadow/tensor.h>
+#include <algorithm>
 #include <vector>
 #include <set>
 #include <atomic>
@@ -76,6 +77,10 @@ class OperatorTuneBase {
   static bool verbose_tuning_info_;
   /*! \brief Tuning scale factor */
   static double tuning_weight_scale_;
+  /*! \brief Refine the workloads from the timed kernel launches (MXNET_OPERATOR_TUNING_ONLINE) */
+  static bool online_tuning_;
+  /*! \brief Size the OMP team of a launch from its workload (MXNET_OPERATOR_TUNING_THREADS) */
+  static bool adaptive_threads_;
 
  public:
   typedef std::chrono::high_resolution_clock::time_point Tick;
@@ -111,6 +116,59 @@ class OperatorTuneBase {
   /*! \brief Loop size to be timed (single op nanos may be too small to store accurately) */
   static constexpr duration_t WORKLOAD_COUNT = (1 << WORKLOAD_COUNT_SHIFT);
 
+  /*! \brief Smallest kernel launch timed for the online re-tune, the clock is too coarse below */
+  static constexpr size_t ONLINE_TUNING_MIN_N = 4096;
+
+  /*!
+   * \brief Whether to time a kernel launch of N iterations for the online re-tune
+   * \param N Number of iterations of the launch
+   * \return true if the launch should be timed and passed to RefineWorkload()
+   */
+  static MSHADOW_CINLINE bool SampleLaunch(const size_t N) {
+    return online_tuning_ && N >= ONLINE_TUNING_MIN_N;
+  }
+
+  /*!
+   * \brief Time in nanoseconds for OMP overhead
+   * \return The OMP overhead the tuning decisions use
+   */
+  static duration_t omp_overhead_ns() {
+    return omp_overhead_ns_;
+  }
+
+  /*!
+   * \brief Online re-tune: fold the measured duration of a kernel launch into the tuning data.
+   *        A serial launch refines the workload of the kernel, a parallel one the OMP overhead.
+   * \param workload Workload of the launched kernel (tuned_op::workload_[0])
+   * \param N Number of iterations of the launch
+   * \param thread_count Number of OMP threads of the launch, 1 if it ran serially
+   * \param duration_ns Measured duration of the launch in nanoseconds
+   */
+  static void RefineWorkload(float* workload,
+                             size_t N,
+                             size_t thread_count,
+                             duration_t duration_ns);
+
+  /*!
+   * \brief Look up a workload in the per-host tuning cache (MXNET_OPERATOR_TUNING_CACHE), and
+   *        keep track of it so that it is written when the cache is saved
+   * \param key Unique name of the tuned kernel and data type
+   * \param workload Workload to set from the cache
+   * \return true if the cache held the workload, false if it still needs to be measured
+   */
+  static bool LookupTuningCache(const std::string& key, float* workload);
+
+  /*!
+   * \brief Look up the OMP overhead in the per-host tuning cache
+   * \return true if the cache held the OMP overhead, which was then set
+   */
+  static bool LookupOMPOverhead();
+
+  /*!
+   * \brief Write the per-host tuning cache if any of its values were measured or refined
+   */
+  static void SaveTuningCache();
+
   /*!
    * \brief Timer convenience class, sets start time as "now" in the constructor
    */
@@ -153,6 +211,27 @@ class OperatorTuneBase {
     }
     return false;
   }
+
+  /*!
+   * \brief Number of OMP threads worth waking for a parallel loop: each one gets at least as much
+   *        work as the OMP overhead, so that small loops do not pay the fork/join of all the cores
+   * \param N - Number of iterations desired
+   * \param thread_count - Number of OMP threads available to perform the iterations
+   * \returns Number of threads to use, between 2 and thread_count, and at most N
+   */
+  inline static size_t GetOMPThreadCount(size_t N,
+                                         size_t thread_count,
+                                         const uint64_t serial_workload) {
+    size_t threads = thread_count;
+    if (adaptive_threads_) {
+      const uint64_t total_serial_time_ns = serial_workload >> WORKLOAD_COUNT_SHIFT;
+      const uint64_t min_thread_time_ns   = std::max<duration_t>(omp_overhead_ns_, 1);
+      threads                             = static_cast<size_t>(std::max<uint64_t>(
+          2, std::min<uint64_t>(thread_count, total_serial_time_ns / min_thread_time_ns)));
+    }
+    // no thread without an iteration
+    return std::max<size_t>(std::min(threads, N), 1);
+  }
 };
 
 namespace tune {
@@ -208,6 +287,22 @@ class OperatorTuneByType : public OperatorTuneBase {
 #endif
   }
 
+  /*!
+   * \brief Number of OMP threads to use once UseOMP() chose a parallel loop
+   * \param N - Number of iterations desired
+   * \param thread_count - Number of OMP threads available to perform the iterations
+   * \returns Number of threads to use, between 2 and thread_count, and at most N
+   */
+  inline static size_t GetOMPThreadCount(size_t N,
+                                         size_t thread_count,
+                                         const uint64_t serial_workload) {
+#ifdef MXNET_USE_OPERATOR_TUNING
+    if (tuning_mode() == tune::kAuto)
+      return OperatorTuneBase::GetOMPThreadCount(N, thread_count, serial_workload);
+#endif
+    return std::max<size_t>(std::min(thread_count, N), 1);
+  }
+
  protected:
   /*! \brief Tuning mode */
   static volatile tune::TuningMode tuning_mode_;
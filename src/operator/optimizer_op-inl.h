@@ -31,6 +31,8 @@
 #include <mshadow/base.h>
 #include <nnvm/op.h>
 #include <nnvm/op_attr_types.h>
+#include <string>
+#include <utility>
 #include <vector>
 #include "./operator_common.h"
 #include "./mshadow_op.h"
@@ -87,6 +89,7 @@ struct MultiSGDParam : public dmlc::Parameter<MultiSGDParam> {
   float rescale_grad;
   float clip_gradient;
   int num_weights;
+  bool lazy_update;
   DMLC_DECLARE_PARAMETER(MultiSGDParam) {
     DMLC_DECLARE_FIELD(lrs).describe("Learning rates.");
     DMLC_DECLARE_FIELD(wds).describe(
@@ -103,6 +106,10 @@ struct MultiSGDParam : public dmlc::Parameter<MultiSGDParam> {
             "If clip_gradient <= 0, gradient clipping is turned off. "
             "grad = max(min(grad, clip_gradient), -clip_gradient).");
     DMLC_DECLARE_FIELD(num_weights).set_default(1).describe("Number of updated weights.");
+    DMLC_DECLARE_FIELD(lazy_update)
+        .set_default(true)
+        .describe("If true, lazy updates are applied to the weights whose gradient's stype "
+                  "is row_sparse.");
   }
 };
 
@@ -113,6 +120,7 @@ struct MultiSGDMomParam : public dmlc::Parameter<MultiSGDMomParam> {
   float rescale_grad;
   float clip_gradient;
   int num_weights;
+  bool lazy_update;
   DMLC_DECLARE_PARAMETER(MultiSGDMomParam) {
     DMLC_DECLARE_FIELD(lrs).describe("Learning rates.");
     DMLC_DECLARE_FIELD(wds).describe(
@@ -131,6 +139,10 @@ struct MultiSGDMomParam : public dmlc::Parameter<MultiSGDMomParam> {
             "If clip_gradient <= 0, gradient clipping is turned off. "
             "grad = max(min(grad, clip_gradient), -clip_gradient).");
     DMLC_DECLARE_FIELD(num_weights).set_default(1).describe("Number of updated weights.");
+    DMLC_DECLARE_FIELD(lazy_update)
+        .set_default(true)
+        .describe("If true, lazy updates are applied to the weights whose gradient's stype "
+                  "is row_sparse.");
   }
 };
 
@@ -324,7 +336,7 @@ inline void MultiSGDUpdate(const nnvm::NodeAttrs& attrs,
                            const std::vector<TBlob>& outputs) {
   using namespace mxnet_op;
   Stream<xpu>* s = ctx.get_stream<xpu>();
-  MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, DType, {
+  MXNET_WITH_BFLOAT16_TYPE_SWITCH(MSHADOW_REAL_TYPE_SWITCH, outputs[0].type_flag_, DType, {
     using MPDType = typename MPTypeChooser<DType>::type;
     MultiSGDKernelParam<DType, MPDType> param =
         FillMultiSGDKernelParam<xpu, DType, MPDType, MultiSGDParam, input_stride>(
@@ -342,7 +354,7 @@ inline void MultiSGDMomUpdate(const nnvm::NodeAttrs& attrs,
                               const std::vector<TBlob>& outputs) {
   using namespace mxnet_op;
   Stream<xpu>* s = ctx.get_stream<xpu>();
-  MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, DType, {
+  MXNET_WITH_BFLOAT16_TYPE_SWITCH(MSHADOW_REAL_TYPE_SWITCH, outputs[0].type_flag_, DType, {
     using MPDType = typename MPTypeChooser<DType>::type;
     MultiSGDKernelParam<DType, MPDType> param =
         FillMultiSGDMomKernelParam<xpu, DType, MPDType, input_stride>(attrs, ctx, inputs, outputs);
@@ -696,7 +708,7 @@ inline void MP_SGDUpdate(const nnvm::NodeAttrs& attrs,
   using namespace mxnet_op;
   const SGDParam& param = nnvm::get<SGDParam>(attrs.parsed);
   Stream<xpu>* s        = ctx.get_stream<xpu>();
-  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+  MXNET_WITH_BFLOAT16_TYPE_SWITCH(MSHADOW_REAL_TYPE_SWITCH, inputs[0].type_flag_, DType, {
     Tensor<xpu, 2, DType> weight   = inputs[0].FlatTo2D<xpu, DType>(s);
     Tensor<xpu, 2, DType> grad     = inputs[1].FlatTo2D<xpu, DType>(s);
     Tensor<xpu, 2, float> weight32 = inputs[2].FlatTo2D<xpu, float>(s);
@@ -754,7 +766,7 @@ inline void MP_SGDMomUpdate(const nnvm::NodeAttrs& attrs,
   using namespace mxnet_op;
   SGDMomParam param = nnvm::get<SGDMomParam>(attrs.parsed);
   Stream<xpu>* s    = ctx.get_stream<xpu>();
-  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+  MXNET_WITH_BFLOAT16_TYPE_SWITCH(MSHADOW_REAL_TYPE_SWITCH, inputs[0].type_flag_, DType, {
     Tensor<xpu, 2, DType> weight   = inputs[0].FlatTo2D<xpu, DType>(s);
     Tensor<xpu, 2, DType> grad     = inputs[1].FlatTo2D<xpu, DType>(s);
     Tensor<xpu, 2, float> mom      = inputs[2].FlatTo2D<xpu, float>(s);
@@ -974,6 +986,173 @@ inline bool StdOptStorageType(const nnvm::NodeAttrs& attrs,
   return dispatched;
 }
 
+/*!
+ * \brief Storage type inference function for optimizers whose only sparse update is the
+ *        lazy one: with a row_sparse gradient, weight and states of the same stype (dense or
+ *        row_sparse), only the rows present in the gradient are updated.
+ *        Other combinations, and lazy_update = false, fall back to the dense update.
+ * \param num_states The number of states, which follow weight and grad in the inputs
+ */
+template <size_t num_states, typename ParamType>
+inline bool LazyOptStorageType(const nnvm::NodeAttrs& attrs,
+                               const int dev_mask,
+                               DispatchMode* dispatch_mode,
+                               std::vector<int>* in_attrs,
+                               std::vector<int>* out_attrs) {
+  using namespace common;
+  const ParamType& param = nnvm::get<ParamType>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), 2 + num_states);
+  CHECK_EQ(out_attrs->size(), 1U);
+  const int weight_stype = in_attrs->at(0);
+  const int grad_stype   = in_attrs->at(1);
+  bool states_match      = true;
+  for (size_t i = 2; i < 2 + num_states; i++) {
+    states_match = states_match && in_attrs->at(i) == weight_stype;
+  }
+  bool dispatched = false;
+  if (!dispatched && ContainsOnlyStorage(*in_attrs, kDefaultStorage)) {
+    // dns, ... -> dns
+    dispatched =
+        storage_type_assign(out_attrs, kDefaultStorage, dispatch_mode, DispatchMode::kFCompute);
+  }
+  if (!dispatched && param.lazy_update && grad_stype == kRowSparseStorage &&
+      (weight_stype == kRowSparseStorage || weight_stype == kDefaultStorage) && states_match) {
+    // weight, rsp grad and states of the weight's stype -> weight, lazy update
+    dispatched = storage_type_assign(out_attrs,
+                                     static_cast<NDArrayStorageType>(weight_stype),
+                                     dispatch_mode,
+                                     DispatchMode::kFComputeEx);
+    if (dispatched)
+      LogLazyUpdate();
+  }
+  if (!dispatched) {
+    dispatched = dispatch_fallback(out_attrs, dispatch_mode);
+  }
+  return dispatched;
+}
+
+/*!
+ * \brief LazyOptStorageType for the optimizers whose last input is a dense scalar scaling the
+ *        gradient (rescale_grad), after weight, grad and the states.
+ */
+template <size_t num_states, typename ParamType>
+inline bool LazyOptScaleStorageType(const nnvm::NodeAttrs& attrs,
+                                    const int dev_mask,
+                                    DispatchMode* dispatch_mode,
+                                    std::vector<int>* in_attrs,
+                                    std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 3 + num_states);
+  if (in_attrs->back() != kDefaultStorage)
+    return dispatch_fallback(out_attrs, dispatch_mode);
+  std::vector<int> update_attrs(in_attrs->begin(), in_attrs->end() - 1);
+  return LazyOptStorageType<num_states, ParamType>(
+      attrs, dev_mask, dispatch_mode, &update_attrs, out_attrs);
+}
+
+/*!
+ * \brief Pass an argument of an element-wise update kernel through to one row of the weight.
+ *        Pointers are moved to the row, the rsp gradient's values to the row of the
+ *        gradient and every other array to the row of the weight. Scalars are unchanged.
+ */
+template <bool is_grad>
+struct LazyRowShift {
+  template <typename T>
+  MSHADOW_XINLINE static T Get(T arg, const nnvm::dim_t weight_offset, const nnvm::dim_t grad_offset) {
+    return arg;
+  }
+  template <typename DType>
+  MSHADOW_XINLINE static DType* Get(DType* ptr,
+                                    const nnvm::dim_t weight_offset,
+                                    const nnvm::dim_t grad_offset) {
+    return ptr + (is_grad ? grad_offset : weight_offset);
+  }
+};
+
+/*!
+ * \brief Lazy update of the rows of the weight present in a row_sparse gradient, with the
+ *        element-wise kernel OP of the dense update. OP indexes all its arrays with the same
+ *        element id, so each row is updated by moving the arrays to the row.
+ *        On CPU each thread updates a row, on GPU an element.
+ * \tparam grad_pos position of the gradient in the arguments of OP, after the element id
+ */
+template <typename OP, int grad_pos, typename xpu>
+struct LazyRowUpdateKernel {
+  template <typename IType, typename... Args>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  const nnvm::dim_t row_length,
+                                  const IType* grad_idx,
+                                  Args... args) {
+    MapRow(i, row_length, grad_idx, std::index_sequence_for<Args...>(), args...);
+  }
+
+  template <typename IType, size_t... pos, typename... Args>
+  MSHADOW_XINLINE static void MapRow(index_t i,
+                                     const nnvm::dim_t row_length,
+                                     const IType* grad_idx,
+                                     std::index_sequence<pos...>,
+                                     Args... args) {
+    using nnvm::dim_t;
+    if (std::is_same<xpu, cpu>::value) {
+      const dim_t weight_offset = static_cast<dim_t>(grad_idx[i]) * row_length;
+      for (dim_t j = 0; j < row_length; ++j) {
+        OP::Map(j,
+                LazyRowShift<pos == static_cast<size_t>(grad_pos)>::Get(
+                    args, weight_offset, i * row_length)...);
+      }
+    } else {
+      const dim_t row = i / row_length;
+      OP::Map(i % row_length,
+              LazyRowShift<pos == static_cast<size_t>(grad_pos)>::Get(
+                  args, static_cast<dim_t>(grad_idx[row]) * row_length, row * row_length)...);
+    }
+  }
+};
+
+/*!
+ * \brief Check the inputs (weight, grad, states...) of a lazy update, and fill the
+ *        row_sparse states which were never written with zeros.
+ * \return false when the gradient is empty and there is nothing to update
+ */
+template <typename xpu>
+inline bool PrepareLazyRowUpdate(const OpContext& ctx,
+                                 const std::vector<NDArray>& inputs,
+                                 const OpReqType req,
+                                 const std::string& op_name) {
+  if (req == kNullOp || !inputs[1].storage_initialized())
+    return false;
+  CHECK_EQ(req, kWriteInplace) << "kWriteInplace is expected for the lazy " << op_name;
+  CheckAllRowsPresent(inputs[0], op_name, "weights");
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  for (size_t i = 2; i < inputs.size(); ++i) {
+    if (inputs[i].storage_type() == kRowSparseStorage && !inputs[i].storage_initialized()) {
+      NDArray state = inputs[i];
+      FillDnsZerosRspImpl(s, &state);
+    }
+    CheckAllRowsPresent(inputs[i], op_name, "states");
+  }
+  return true;
+}
+
+/*!
+ * \brief Launch the lazy update of the rows of a weight present in the row_sparse gradient
+ *        grad with the element-wise kernel OP, args being the arguments of OP::Map.
+ */
+template <typename xpu, typename OP, int grad_pos, typename... Args>
+inline void LaunchLazyRowUpdate(mshadow::Stream<xpu>* s,
+                                const mxnet::TShape& weight_shape,
+                                const NDArray& grad,
+                                Args... args) {
+  using namespace rowsparse;
+  const nnvm::dim_t num_rows   = grad.aux_shape(kIdx)[0];
+  const nnvm::dim_t row_length = weight_shape.ProdShape(1, weight_shape.ndim());
+  const size_t num_threads =
+      std::is_same<xpu, cpu>::value ? num_rows : num_rows * row_length;
+  MSHADOW_IDX_TYPE_SWITCH(grad.aux_type(kIdx), IType, {
+    mxnet_op::Kernel<LazyRowUpdateKernel<OP, grad_pos, xpu>, xpu>::Launch(
+        s, num_threads, row_length, grad.aux_data(kIdx).dptr<IType>(), args...);
+  });
+}
+
 /*
  * \brief kernel for standard momentum update for dense weight, sparse grad and dense state.
  */
@@ -1053,6 +1232,183 @@ inline void SGDMomUpdateEx(const nnvm::NodeAttrs& attrs,
   }
 }
 
+template <typename xpu>
+inline void MP_SGDUpdateEx(const nnvm::NodeAttrs& attrs,
+                           const OpContext& ctx,
+                           const std::vector<NDArray>& inputs,
+                           const std::vector<OpReqType>& req,
+                           const std::vector<NDArray>& outputs) {
+  const SGDParam& param = nnvm::get<SGDParam>(attrs.parsed);
+  if (!PrepareLazyRowUpdate<xpu>(ctx, inputs, req[0], "MP_SGDUpdate"))
+    return;
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].dtype(), DType, {
+    LaunchLazyRowUpdate<xpu, MP_SGDKernel, 2>(s,
+                                              inputs[0].shape(),
+                                              inputs[1],
+                                              outputs[0].data().dptr<DType>(),
+                                              inputs[0].data().dptr<DType>(),
+                                              inputs[1].data().dptr<DType>(),
+                                              inputs[2].data().dptr<float>(),
+                                              param.clip_gradient,
+                                              param.lr,
+                                              param.wd,
+                                              param.rescale_grad,
+                                              req[0]);
+  });
+}
+
+template <typename xpu>
+inline void MP_SGDMomUpdateEx(const nnvm::NodeAttrs& attrs,
+                              const OpContext& ctx,
+                              const std::vector<NDArray>& inputs,
+                              const std::vector<OpReqType>& req,
+                              const std::vector<NDArray>& outputs) {
+  const SGDMomParam& param = nnvm::get<SGDMomParam>(attrs.parsed);
+  if (!PrepareLazyRowUpdate<xpu>(ctx, inputs, req[0], "MP_SGDMomUpdate"))
+    return;
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].dtype(), DType, {
+    LaunchLazyRowUpdate<xpu, MP_SGDMomKernel, 3>(s,
+                                                 inputs[0].shape(),
+                                                 inputs[1],
+                                                 outputs[0].data().dptr<DType>(),
+                                                 inputs[2].data().dptr<float>(),
+                                                 inputs[0].data().dptr<DType>(),
+                                                 inputs[1].data().dptr<DType>(),
+                                                 inputs[3].data().dptr<float>(),
+                                                 param.clip_gradient,
+                                                 param.momentum,
+                                                 param.lr,
+                                                 param.wd,
+                                                 param.rescale_grad,
+                                                 req[0]);
+  });
+}
+
+/*!
+ * \brief Storage type inference function for the multi-tensor sgd updates.
+ *        With dense weights and states, the row_sparse gradients are applied lazily
+ *        while the tensors with a dense gradient keep the fused dense update.
+ */
+template <typename ParamType, int input_stride>
+inline bool MultiSGDStorageType(const nnvm::NodeAttrs& attrs,
+                                const int dev_mask,
+                                DispatchMode* dispatch_mode,
+                                std::vector<int>* in_attrs,
+                                std::vector<int>* out_attrs) {
+  using namespace common;
+  const ParamType& param = nnvm::get<ParamType>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), input_stride * param.num_weights);
+  CHECK_EQ(out_attrs->size(), param.num_weights);
+  bool dispatched = false;
+  if (!dispatched && ContainsOnlyStorage(*in_attrs, kDefaultStorage)) {
+    // dns, ... -> dns
+    dispatched =
+        storage_type_assign(out_attrs, kDefaultStorage, dispatch_mode, DispatchMode::kFCompute);
+  }
+  bool lazy = param.lazy_update;
+  for (size_t i = 0; i < in_attrs->size(); ++i) {
+    const int stype    = in_attrs->at(i);
+    const bool is_grad = i % input_stride == 1;
+    lazy = lazy && (stype == kDefaultStorage || (is_grad && stype == kRowSparseStorage));
+  }
+  if (!dispatched && lazy) {
+    // dns weights and states, dns or rsp grads -> dns, lazy update of the rsp grads
+    dispatched =
+        storage_type_assign(out_attrs, kDefaultStorage, dispatch_mode, DispatchMode::kFComputeEx);
+    if (dispatched)
+      LogLazyUpdate();
+  }
+  if (!dispatched) {
+    dispatched = dispatch_fallback(out_attrs, dispatch_mode);
+  }
+  return dispatched;
+}
+
+/*!
+ * \brief Multi-tensor sgd update with some row_sparse gradients. Each tensor with a
+ *        row_sparse gradient gets a lazy update with the kernel of the matching single
+ *        tensor op, the others are gathered into one fused dense update.
+ */
+template <typename xpu, template <typename> class MPTypeChooser, int input_stride, bool has_momentum>
+inline void MultiSGDUpdateEx(const nnvm::NodeAttrs& attrs,
+                             const OpContext& ctx,
+                             const std::vector<NDArray>& inputs,
+                             const std::vector<OpReqType>& req,
+                             const std::vector<NDArray>& outputs) {
+  using ParamType =
+      typename std::conditional<has_momentum, MultiSGDMomParam, MultiSGDParam>::type;
+  const ParamType& param  = nnvm::get<ParamType>(attrs.parsed);
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  std::vector<TBlob> dense_inputs, dense_outputs;
+  std::vector<float> dense_lrs, dense_wds;
+  for (int i = 0; i < param.num_weights; ++i) {
+    const NDArray* in = &inputs[i * input_stride];
+    if (in[1].storage_type() == kDefaultStorage) {
+      for (int j = 0; j < input_stride; ++j)
+        dense_inputs.push_back(in[j].data());
+      dense_outputs.push_back(outputs[i].data());
+      dense_lrs.push_back(param.lrs[i]);
+      dense_wds.push_back(param.wds[i]);
+      continue;
+    }
+    if (req[i] == kNullOp || !in[1].storage_initialized())
+      continue;
+    CHECK_EQ(req[i], kWriteInplace) << "kWriteInplace is expected for the lazy multi sgd update";
+    MSHADOW_REAL_TYPE_SWITCH(in[0].dtype(), DType, {
+      using MPDType    = typename MPTypeChooser<DType>::type;
+      DType* out       = outputs[i].data().dptr<DType>();
+      DType* weight    = in[0].data().dptr<DType>();
+      DType* grad      = in[1].data().dptr<DType>();
+      const float lr   = param.lrs[i];
+      const float wd   = param.wds[i];
+      const float clip = param.clip_gradient;
+      if constexpr (!std::is_same<DType, MPDType>::value) {
+        float* weight32 = in[input_stride - 1].data().dptr<float>();
+        if constexpr (has_momentum) {
+          LaunchLazyRowUpdate<xpu, MP_SGDMomKernel, 3>(s, in[0].shape(), in[1], out,
+                                                       in[2].data().dptr<float>(), weight, grad,
+                                                       weight32, clip, param.momentum, lr, wd,
+                                                       param.rescale_grad, req[i]);
+        } else {
+          LaunchLazyRowUpdate<xpu, MP_SGDKernel, 2>(s, in[0].shape(), in[1], out, weight, grad,
+                                                    weight32, clip, lr, wd, param.rescale_grad,
+                                                    req[i]);
+        }
+      } else if constexpr (has_momentum) {
+        LaunchLazyRowUpdate<xpu, SGDMomKernel, 3>(s, in[0].shape(), in[1], out,
+                                                  in[2].data().dptr<DType>(), weight, grad,
+                                                  static_cast<DType>(clip),
+                                                  static_cast<DType>(param.momentum),
+                                                  static_cast<DType>(lr),
+                                                  static_cast<DType>(wd),
+                                                  static_cast<DType>(param.rescale_grad), req[i]);
+      } else {
+        LaunchLazyRowUpdate<xpu, SGDKernel, 2>(s, in[0].shape(), in[1], out, weight, grad,
+                                               static_cast<DType>(clip), static_cast<DType>(lr),
+                                               static_cast<DType>(wd),
+                                               static_cast<DType>(param.rescale_grad), req[i]);
+      }
+    });
+  }
+  if (dense_outputs.empty())
+    return;
+  ParamType dense_param   = param;
+  dense_param.num_weights = dense_outputs.size();
+  dense_param.lrs         = mxnet::Tuple<float>(dense_lrs.begin(), dense_lrs.end());
+  dense_param.wds         = mxnet::Tuple<float>(dense_wds.begin(), dense_wds.end());
+  nnvm::NodeAttrs dense_attrs = attrs;
+  dense_attrs.parsed          = dense_param;
+  if constexpr (has_momentum) {
+    MultiSGDMomUpdate<xpu, MPTypeChooser, input_stride>(
+        dense_attrs, ctx, dense_inputs, req, dense_outputs);
+  } else {
+    MultiSGDUpdate<xpu, MPTypeChooser, input_stride>(
+        dense_attrs, ctx, dense_inputs, req, dense_outputs);
+  }
+}
+
 struct NAGParam : public dmlc::Parameter<NAGParam> {
   float lr;
   float wd;
@@ -1083,6 +1439,7 @@ struct NAGMomParam : public dmlc::Parameter<NAGMomParam> {
   float wd;
   float rescale_grad;
   float clip_gradient;
+  bool lazy_update;
   DMLC_DECLARE_PARAMETER(NAGMomParam) {
     DMLC_DECLARE_FIELD(lr).describe("Learning rate");
     DMLC_DECLARE_FIELD(momentum).set_default(0.0f).describe(
@@ -1101,6 +1458,9 @@ struct NAGMomParam : public dmlc::Parameter<NAGMomParam> {
             "Clip gradient to the range of [-clip_gradient, clip_gradient] "
             "If clip_gradient <= 0, gradient clipping is turned off. "
             "grad = max(min(grad, clip_gradient), -clip_gradient).");
+    DMLC_DECLARE_FIELD(lazy_update)
+        .set_default(true)
+        .describe("If true, lazy updates are applied if gradient's stype is row_sparse and mom has the same stype as weight.");
   }
 };
 
@@ -1159,6 +1519,33 @@ inline void NAGMomUpdate(const nnvm::NodeAttrs& attrs,
   });
 }
 
+template <typename xpu>
+inline void NAGMomUpdateEx(const nnvm::NodeAttrs& attrs,
+                           const OpContext& ctx,
+                           const std::vector<NDArray>& inputs,
+                           const std::vector<OpReqType>& req,
+                           const std::vector<NDArray>& outputs) {
+  const NAGMomParam& param = nnvm::get<NAGMomParam>(attrs.parsed);
+  if (!PrepareLazyRowUpdate<xpu>(ctx, inputs, req[0], "NAGMomUpdate"))
+    return;
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].dtype(), DType, {
+    LaunchLazyRowUpdate<xpu, NAGMomKernel, 3>(s,
+                                              inputs[0].shape(),
+                                              inputs[1],
+                                              outputs[0].data().dptr<DType>(),
+                                              inputs[2].data().dptr<DType>(),
+                                              inputs[0].data().dptr<DType>(),
+                                              inputs[1].data().dptr<DType>(),
+                                              static_cast<DType>(param.clip_gradient),
+                                              static_cast<DType>(param.momentum),
+                                              static_cast<DType>(param.lr),
+                                              static_cast<DType>(param.wd),
+                                              static_cast<DType>(param.rescale_grad),
+                                              req[0]);
+  });
+}
+
 struct MP_NAGMomKernel {
   template <typename DType>
   MSHADOW_XINLINE static void Map(index_t i,
@@ -1196,7 +1583,7 @@ inline void MP_NAGMomUpdate(const nnvm::NodeAttrs& attrs,
   using namespace mxnet_op;
   NAGMomParam param = nnvm::get<NAGMomParam>(attrs.parsed);
   Stream<xpu>* s    = ctx.get_stream<xpu>();
-  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+  MXNET_WITH_BFLOAT16_TYPE_SWITCH(MSHADOW_REAL_TYPE_SWITCH, inputs[0].type_flag_, DType, {
     Tensor<xpu, 2, DType> weight   = inputs[0].FlatTo2D<xpu, DType>(s);
     Tensor<xpu, 2, DType> grad     = inputs[1].FlatTo2D<xpu, DType>(s);
     Tensor<xpu, 2, float> mom      = inputs[2].FlatTo2D<xpu, float>(s);
@@ -1218,6 +1605,34 @@ inline void MP_NAGMomUpdate(const nnvm::NodeAttrs& attrs,
   });
 }
 
+template <typename xpu>
+inline void MP_NAGMomUpdateEx(const nnvm::NodeAttrs& attrs,
+                              const OpContext& ctx,
+                              const std::vector<NDArray>& inputs,
+                              const std::vector<OpReqType>& req,
+                              const std::vector<NDArray>& outputs) {
+  const NAGMomParam& param = nnvm::get<NAGMomParam>(attrs.parsed);
+  if (!PrepareLazyRowUpdate<xpu>(ctx, inputs, req[0], "MP_NAGMomUpdate"))
+    return;
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].dtype(), DType, {
+    LaunchLazyRowUpdate<xpu, MP_NAGMomKernel, 3>(s,
+                                                 inputs[0].shape(),
+                                                 inputs[1],
+                                                 outputs[0].data().dptr<DType>(),
+                                                 inputs[2].data().dptr<float>(),
+                                                 inputs[0].data().dptr<DType>(),
+                                                 inputs[1].data().dptr<DType>(),
+                                                 inputs[3].data().dptr<float>(),
+                                                 param.clip_gradient,
+                                                 param.momentum,
+                                                 param.lr,
+                                                 param.wd,
+                                                 param.rescale_grad,
+                                                 req[0]);
+  });
+}
+
 struct FTMLParam : public dmlc::Parameter<FTMLParam> {
   float lr;
   float beta1;
@@ -1227,6 +1642,7 @@ struct FTMLParam : public dmlc::Parameter<FTMLParam> {
   float wd;
   float rescale_grad;
   float clip_grad;
+  bool lazy_update;
   DMLC_DECLARE_PARAMETER(FTMLParam) {
     DMLC_DECLARE_FIELD(lr).describe("Learning rate.");
     DMLC_DECLARE_FIELD(beta1)
@@ -1250,6 +1666,9 @@ struct FTMLParam : public dmlc::Parameter<FTMLParam> {
         "Clip gradient to the range of [-clip_gradient, clip_gradient] "
         "If clip_gradient <= 0, gradient clipping is turned off. "
         "grad = max(min(grad, clip_gradient), -clip_gradient).");
+    DMLC_DECLARE_FIELD(lazy_update)
+        .set_default(true)
+        .describe("If true, lazy updates are applied if gradient's stype is row_sparse and all of w, d, v and z have the same stype.");
   }
 };
 
@@ -1320,6 +1739,38 @@ inline void FTMLUpdate(const nnvm::NodeAttrs& attrs,
   });
 }
 
+template <typename xpu>
+inline void FTMLUpdateEx(const nnvm::NodeAttrs& attrs,
+                         const OpContext& ctx,
+                         const std::vector<NDArray>& inputs,
+                         const std::vector<OpReqType>& req,
+                         const std::vector<NDArray>& outputs) {
+  const FTMLParam& param = nnvm::get<FTMLParam>(attrs.parsed);
+  if (!PrepareLazyRowUpdate<xpu>(ctx, inputs, req[0], "FTMLUpdate"))
+    return;
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].dtype(), DType, {
+    LaunchLazyRowUpdate<xpu, FTMLKernel, 2>(s,
+                                            inputs[0].shape(),
+                                            inputs[1],
+                                            outputs[0].data().dptr<DType>(),
+                                            inputs[0].data().dptr<DType>(),
+                                            inputs[1].data().dptr<DType>(),
+                                            inputs[2].data().dptr<DType>(),
+                                            inputs[3].data().dptr<DType>(),
+                                            inputs[4].data().dptr<DType>(),
+                                            static_cast<DType>(param.lr),
+                                            static_cast<DType>(param.beta1),
+                                            static_cast<DType>(param.beta2),
+                                            static_cast<DType>(param.epsilon),
+                                            static_cast<DType>(param.t),
+                                            static_cast<DType>(param.wd),
+                                            static_cast<DType>(param.rescale_grad),
+                                            static_cast<DType>(param.clip_grad),
+                                            req[0]);
+  });
+}
+
 struct AdamParam : public dmlc::Parameter<AdamParam> {
   float lr;
   float beta1;
@@ -1969,7 +2420,7 @@ inline void MPLambUpdatePhaseOne(const nnvm::NodeAttrs& attrs,
   using namespace mxnet_op;
   const LambUpdatePhaseOneParam& param = nnvm::get<LambUpdatePhaseOneParam>(attrs.parsed);
   Stream<xpu>* s                       = ctx.get_stream<xpu>();
-  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+  MXNET_WITH_BFLOAT16_TYPE_SWITCH(MSHADOW_REAL_TYPE_SWITCH, inputs[0].type_flag_, DType, {
     float beta1_t                  = std::pow(param.beta1, param.t);
     float beta2_t                  = std::pow(param.beta2, param.t);
     Tensor<xpu, 2, DType> weight   = inputs[0].FlatTo2D<xpu, DType>(s);
@@ -2075,7 +2526,7 @@ inline void MPLambUpdatePhaseTwo(const nnvm::NodeAttrs& attrs,
   using namespace mxnet_op;
   const LambUpdatePhaseTwoParam& param = nnvm::get<LambUpdatePhaseTwoParam>(attrs.parsed);
   Stream<xpu>* s                       = ctx.get_stream<xpu>();
-  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+  MXNET_WITH_BFLOAT16_TYPE_SWITCH(MSHADOW_REAL_TYPE_SWITCH, inputs[0].type_flag_, DType, {
     Tensor<xpu, 2, DType> weight   = inputs[0].FlatTo2D<xpu, DType>(s);
     Tensor<xpu, 2, float> g        = inputs[1].FlatTo2D<xpu, float>(s);
     Tensor<xpu, 2, float> r1       = inputs[2].FlatTo2D<xpu, float>(s);
@@ -2110,6 +2561,7 @@ struct RMSPropAlexParam : public dmlc::Parameter<RMSPropAlexParam> {
   float rescale_grad;
   float clip_gradient;
   float clip_weights;
+  bool lazy_update;
   DMLC_DECLARE_PARAMETER(RMSPropAlexParam) {
     DMLC_DECLARE_FIELD(lr).describe("Learning rate");
     DMLC_DECLARE_FIELD(rho).set_default(0.95f).describe("Decay rate.");
@@ -2135,6 +2587,9 @@ struct RMSPropAlexParam : public dmlc::Parameter<RMSPropAlexParam> {
             "Clip weights to the range of [-clip_weights, clip_weights] "
             "If clip_weights <= 0, weight clipping is turned off. "
             "weights = max(min(weights, clip_weights), -clip_weights).");
+    DMLC_DECLARE_FIELD(lazy_update)
+        .set_default(true)
+        .describe("If true, lazy updates are applied if gradient's stype is row_sparse and all of w, n, g and delta have the same stype.");
   }
 };
 
@@ -2216,6 +2671,38 @@ inline void RMSPropAlexUpdate(const nnvm::NodeAttrs& attrs,
   });
 }
 
+template <typename xpu>
+inline void RMSPropAlexUpdateEx(const nnvm::NodeAttrs& attrs,
+                                const OpContext& ctx,
+                                const std::vector<NDArray>& inputs,
+                                const std::vector<OpReqType>& req,
+                                const std::vector<NDArray>& outputs) {
+  const RMSPropAlexParam& param = nnvm::get<RMSPropAlexParam>(attrs.parsed);
+  if (!PrepareLazyRowUpdate<xpu>(ctx, inputs, req[0], "RMSPropAlexUpdate"))
+    return;
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].dtype(), DType, {
+    LaunchLazyRowUpdate<xpu, RMSPropAlexUpdateKernel, 5>(s,
+                                                         inputs[0].shape(),
+                                                         inputs[1],
+                                                         outputs[0].data().dptr<DType>(),
+                                                         inputs[3].data().dptr<DType>(),
+                                                         inputs[2].data().dptr<DType>(),
+                                                         inputs[4].data().dptr<DType>(),
+                                                         inputs[0].data().dptr<DType>(),
+                                                         inputs[1].data().dptr<DType>(),
+                                                         static_cast<DType>(param.clip_gradient),
+                                                         static_cast<DType>(param.rescale_grad),
+                                                         static_cast<DType>(param.rho),
+                                                         static_cast<DType>(param.momentum),
+                                                         static_cast<DType>(param.lr),
+                                                         static_cast<DType>(param.wd),
+                                                         static_cast<DType>(param.clip_weights),
+                                                         static_cast<DType>(param.epsilon),
+                                                         req[0]);
+  });
+}
+
 // This RMSProp code follows the version in
 // http://www.cs.toronto.edu/~tijmen/csc321/slides/lecture_slides_lec6.pdf
 // by Tieleman & Hinton, 2012
@@ -2227,6 +2714,7 @@ struct RMSPropParam : public dmlc::Parameter<RMSPropParam> {
   float rescale_grad;
   float clip_gradient;
   float clip_weights;
+  bool lazy_update;
   DMLC_DECLARE_PARAMETER(RMSPropParam) {
     DMLC_DECLARE_FIELD(lr).describe("Learning rate");
     DMLC_DECLARE_FIELD(rho).set_default(0.95f).describe("The decay rate of momentum estimates.");
@@ -2251,6 +2739,9 @@ struct RMSPropParam : public dmlc::Parameter<RMSPropParam> {
             "Clip weights to the range of [-clip_weights, clip_weights] "
             "If clip_weights <= 0, weight clipping is turned off. "
             "weights = max(min(weights, clip_weights), -clip_weights).");
+    DMLC_DECLARE_FIELD(lazy_update)
+        .set_default(true)
+        .describe("If true, lazy updates are applied if gradient's stype is row_sparse and n has the same stype as weight.");
   }
 };
 
@@ -2320,6 +2811,35 @@ inline void RMSPropUpdate(const nnvm::NodeAttrs& attrs,
   });
 }
 
+template <typename xpu>
+inline void RMSPropUpdateEx(const nnvm::NodeAttrs& attrs,
+                            const OpContext& ctx,
+                            const std::vector<NDArray>& inputs,
+                            const std::vector<OpReqType>& req,
+                            const std::vector<NDArray>& outputs) {
+  const RMSPropParam& param = nnvm::get<RMSPropParam>(attrs.parsed);
+  if (!PrepareLazyRowUpdate<xpu>(ctx, inputs, req[0], "RMSPropUpdate"))
+    return;
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].dtype(), DType, {
+    LaunchLazyRowUpdate<xpu, RMSPropUpdateKernel, 3>(s,
+                                                     inputs[0].shape(),
+                                                     inputs[1],
+                                                     outputs[0].data().dptr<DType>(),
+                                                     inputs[2].data().dptr<DType>(),
+                                                     inputs[0].data().dptr<DType>(),
+                                                     inputs[1].data().dptr<DType>(),
+                                                     static_cast<DType>(param.clip_gradient),
+                                                     static_cast<DType>(param.rescale_grad),
+                                                     static_cast<DType>(param.rho),
+                                                     static_cast<DType>(param.lr),
+                                                     static_cast<DType>(param.wd),
+                                                     static_cast<DType>(param.clip_weights),
+                                                     static_cast<DType>(param.epsilon),
+                                                     req[0]);
+  });
+}
+
 struct FtrlParam : public dmlc::Parameter<FtrlParam> {
   float lr;
   float lamda1;
@@ -2570,6 +3090,7 @@ struct SignSGDParam : public dmlc::Parameter<SignSGDParam> {
   float wd;
   float rescale_grad;
   float clip_gradient;
+  bool lazy_update;
   DMLC_DECLARE_PARAMETER(SignSGDParam) {
     DMLC_DECLARE_FIELD(lr).describe("Learning rate");
     DMLC_DECLARE_FIELD(wd).set_default(0.0f).describe(
@@ -2585,6 +3106,9 @@ struct SignSGDParam : public dmlc::Parameter<SignSGDParam> {
             "Clip gradient to the range of [-clip_gradient, clip_gradient] "
             "If clip_gradient <= 0, gradient clipping is turned off. "
             "grad = max(min(grad, clip_gradient), -clip_gradient).");
+    DMLC_DECLARE_FIELD(lazy_update)
+        .set_default(true)
+        .describe("If true, lazy updates are applied if gradient's stype is row_sparse.");
   }
 };
 
@@ -2633,6 +3157,31 @@ inline void SignSGDUpdate(const nnvm::NodeAttrs& attrs,
   });
 }
 
+template <typename xpu>
+inline void SignSGDUpdateEx(const nnvm::NodeAttrs& attrs,
+                            const OpContext& ctx,
+                            const std::vector<NDArray>& inputs,
+                            const std::vector<OpReqType>& req,
+                            const std::vector<NDArray>& outputs) {
+  const SignSGDParam& param = nnvm::get<SignSGDParam>(attrs.parsed);
+  if (!PrepareLazyRowUpdate<xpu>(ctx, inputs, req[0], "SignSGDUpdate"))
+    return;
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].dtype(), DType, {
+    LaunchLazyRowUpdate<xpu, SignSGDKernel, 2>(s,
+                                               inputs[0].shape(),
+                                               inputs[1],
+                                               outputs[0].data().dptr<DType>(),
+                                               inputs[0].data().dptr<DType>(),
+                                               inputs[1].data().dptr<DType>(),
+                                               static_cast<DType>(param.clip_gradient),
+                                               static_cast<DType>(param.lr),
+                                               static_cast<DType>(param.wd),
+                                               static_cast<DType>(param.rescale_grad),
+                                               req[0]);
+  });
+}
+
 struct SignumParam : public dmlc::Parameter<SignumParam> {
   float lr;
   float momentum;
@@ -2640,6 +3189,7 @@ struct SignumParam : public dmlc::Parameter<SignumParam> {
   float rescale_grad;
   float clip_gradient;
   float wd_lh;  // the amount of algorithmic weight decay by Loshchilov and Frank Hutter
+  bool lazy_update;
   DMLC_DECLARE_PARAMETER(SignumParam) {
     DMLC_DECLARE_FIELD(lr).describe("Learning rate");
     DMLC_DECLARE_FIELD(momentum).set_default(0.0f).describe(
@@ -2660,6 +3210,9 @@ struct SignumParam : public dmlc::Parameter<SignumParam> {
     DMLC_DECLARE_FIELD(wd_lh).set_default(0.0f).describe(
         "The amount of weight decay that does not go into gradient/momentum calculations"
         "otherwise do weight decay algorithmically only.");
+    DMLC_DECLARE_FIELD(lazy_update)
+        .set_default(true)
+        .describe("If true, lazy updates are applied if gradient's stype is row_sparse and mom has the same stype as weight.");
   }
 };
 
@@ -2721,6 +3274,34 @@ inline void SignumUpdate(const nnvm::NodeAttrs& attrs,
   });
 }
 
+template <typename xpu>
+inline void SignumUpdateEx(const nnvm::NodeAttrs& attrs,
+                           const OpContext& ctx,
+                           const std::vector<NDArray>& inputs,
+                           const std::vector<OpReqType>& req,
+                           const std::vector<NDArray>& outputs) {
+  const SignumParam& param = nnvm::get<SignumParam>(attrs.parsed);
+  if (!PrepareLazyRowUpdate<xpu>(ctx, inputs, req[0], "SignumUpdate"))
+    return;
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].dtype(), DType, {
+    LaunchLazyRowUpdate<xpu, SignumKernel, 3>(s,
+                                              inputs[0].shape(),
+                                              inputs[1],
+                                              outputs[0].data().dptr<DType>(),
+                                              inputs[2].data().dptr<DType>(),
+                                              inputs[0].data().dptr<DType>(),
+                                              inputs[1].data().dptr<DType>(),
+                                              static_cast<DType>(param.clip_gradient),
+                                              static_cast<DType>(param.momentum),
+                                              static_cast<DType>(param.lr),
+                                              static_cast<DType>(param.wd),
+                                              static_cast<DType>(param.rescale_grad),
+                                              static_cast<DType>(param.wd_lh),
+                                              req[0]);
+  });
+}
+
 struct AdagradParam : public dmlc::Parameter<AdagradParam> {
   float lr;
   float epsilon;
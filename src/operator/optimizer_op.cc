@@ -57,15 +57,17 @@ It updates the weights using::
 
  weight = weight - learning_rate * sign(gradient)
 
-.. note::
-   - sparse ndarray not supported for this optimizer yet.
+If gradient is of ``row_sparse`` storage type and ``lazy_update`` is True,
+only the row slices whose indices appear in grad.indices are updated.
 )code" ADD_FILELINE)
     .set_num_inputs(2)
     .set_num_outputs(1)
     .set_attr_parser(ParamParser<SignSGDParam>)
     .set_attr<mxnet::FInferShape>("FInferShape", ElemwiseShape<2, 1>)
     .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<2, 1>)
+    .set_attr<FInferStorageType>("FInferStorageType", LazyOptStorageType<0, SignSGDParam>)
     .set_attr<FCompute>("FCompute<cpu>", SignSGDUpdate<cpu>)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", SignSGDUpdateEx<cpu>)
     .add_argument("weight", "NDArray-or-Symbol", "Weight")
     .add_argument("grad", "NDArray-or-Symbol", "Gradient")
     .add_arguments(SignSGDParam::__FIELDS__());
@@ -85,8 +87,8 @@ It updates the weights using::
 
 Where the parameter ``momentum`` is the decay rate of momentum estimates at each epoch.
 
-.. note::
-   - sparse ndarray not supported for this optimizer yet.
+If gradient is of ``row_sparse`` storage type and ``lazy_update`` is True,
+only the row slices whose indices appear in grad.indices are updated.
 )code" ADD_FILELINE)
     .set_num_inputs(3)
     .set_num_outputs(1)
@@ -97,7 +99,9 @@ Where the parameter ``momentum`` is the decay rate of momentum estimates at each
                                    [](const nnvm::NodeAttrs& attrs) {
                                      return std::vector<uint32_t>{2};
                                    })
+    .set_attr<FInferStorageType>("FInferStorageType", LazyOptStorageType<1, SignumParam>)
     .set_attr<FCompute>("FCompute<cpu>", SignumUpdate<cpu>)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", SignumUpdateEx<cpu>)
     .add_argument("weight", "NDArray-or-Symbol", "Weight")
     .add_argument("grad", "NDArray-or-Symbol", "Gradient")
     .add_argument("mom", "NDArray-or-Symbol", "Momentum")
@@ -379,7 +383,9 @@ It updates the weights using::
                                        }
                                        return ret;
                                      })
+    .set_attr<FInferStorageType>("FInferStorageType", MultiSGDStorageType<MultiSGDParam, 2>)
     .set_attr<FCompute>("FCompute<cpu>", MultiSGDUpdate<cpu, type_identity, 2>)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", MultiSGDUpdateEx<cpu, type_identity, 2, false>)
     .add_argument("data", "NDArray-or-Symbol[]", "Weights")
     .add_arguments(MultiSGDParam::__FIELDS__());
 
@@ -437,7 +443,9 @@ Where the parameter ``momentum`` is the decay rate of momentum estimates at each
                                      }
                                      return ret;
                                    })
+    .set_attr<FInferStorageType>("FInferStorageType", MultiSGDStorageType<MultiSGDMomParam, 3>)
     .set_attr<FCompute>("FCompute<cpu>", MultiSGDMomUpdate<cpu, type_identity, 3>)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", MultiSGDUpdateEx<cpu, type_identity, 3, true>)
     .add_argument("data", "NDArray-or-Symbol[]", "Weights, gradients and momentum")
     .add_arguments(MultiSGDMomParam::__FIELDS__());
 
@@ -485,7 +493,9 @@ It updates the weights using::
                                      }
                                      return ret;
                                    })
+    .set_attr<FInferStorageType>("FInferStorageType", MultiSGDStorageType<MultiSGDParam, 3>)
     .set_attr<FCompute>("FCompute<cpu>", MultiSGDUpdate<cpu, single_precision, 3>)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", MultiSGDUpdateEx<cpu, single_precision, 3, false>)
     .add_argument("data", "NDArray-or-Symbol[]", "Weights")
     .add_arguments(MultiSGDParam::__FIELDS__());
 
@@ -546,7 +556,9 @@ Where the parameter ``momentum`` is the decay rate of momentum estimates at each
                                      }
                                      return ret;
                                    })
+    .set_attr<FInferStorageType>("FInferStorageType", MultiSGDStorageType<MultiSGDMomParam, 4>)
     .set_attr<FCompute>("FCompute<cpu>", MultiSGDMomUpdate<cpu, single_precision, 4>)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", MultiSGDUpdateEx<cpu, single_precision, 4, true>)
     .add_argument("data", "NDArray-or-Symbol[]", "Weights")
     .add_arguments(MultiSGDMomParam::__FIELDS__());
 
@@ -640,7 +652,9 @@ NNVM_REGISTER_OP(mp_sgd_update)
     .set_attr_parser(ParamParser<SGDParam>)
     .set_attr<mxnet::FInferShape>("FInferShape", ElemwiseShape<3, 1>)
     .set_attr<nnvm::FInferType>("FInferType", MP_InferType<2, 1, 3>)
+    .set_attr<FInferStorageType>("FInferStorageType", LazyOptStorageType<1, SGDParam>)
     .set_attr<FCompute>("FCompute<cpu>", MP_SGDUpdate<cpu>)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", MP_SGDUpdateEx<cpu>)
     .set_attr<nnvm::FMutateInputs>("FMutateInputs",
                                    [](const nnvm::NodeAttrs& attrs) {
                                      return std::vector<uint32_t>{2};
@@ -661,7 +675,9 @@ NNVM_REGISTER_OP(mp_sgd_mom_update)
                                    [](const nnvm::NodeAttrs& attrs) {
                                      return std::vector<uint32_t>{2, 3};
                                    })
+    .set_attr<FInferStorageType>("FInferStorageType", LazyOptStorageType<2, SGDMomParam>)
     .set_attr<FCompute>("FCompute<cpu>", MP_SGDMomUpdate<cpu>)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", MP_SGDMomUpdateEx<cpu>)
     .add_argument("weight", "NDArray-or-Symbol", "Weight")
     .add_argument("grad", "NDArray-or-Symbol", "Gradient")
     .add_argument("mom", "NDArray-or-Symbol", "Momentum")
@@ -692,7 +708,9 @@ available at http://proceedings.mlr.press/v70/zheng17a/zheng17a.pdf.
                                    [](const nnvm::NodeAttrs& attrs) {
                                      return std::vector<uint32_t>{2, 3, 4};
                                    })
+    .set_attr<FInferStorageType>("FInferStorageType", LazyOptStorageType<3, FTMLParam>)
     .set_attr<FCompute>("FCompute<cpu>", FTMLUpdate<cpu>)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", FTMLUpdateEx<cpu>)
     .add_argument("weight", "NDArray-or-Symbol", "Weight")
     .add_argument("grad", "NDArray-or-Symbol", "Gradient")
     .add_argument("d", "NDArray-or-Symbol", "Internal state ``d_t``")
@@ -777,7 +795,9 @@ Where
                                    [](const nnvm::NodeAttrs& attrs) {
                                      return std::vector<uint32_t>{2};
                                    })
+    .set_attr<FInferStorageType>("FInferStorageType", LazyOptStorageType<1, NAGMomParam>)
     .set_attr<FCompute>("FCompute<cpu>", NAGMomUpdate<cpu>)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", NAGMomUpdateEx<cpu>)
     .add_argument("weight", "NDArray-or-Symbol", "Weight")
     .add_argument("grad", "NDArray-or-Symbol", "Gradient")
     .add_argument("mom", "NDArray-or-Symbol", "Momentum")
@@ -796,7 +816,9 @@ NNVM_REGISTER_OP(mp_nag_mom_update)
                                    [](const nnvm::NodeAttrs& attrs) {
                                      return std::vector<uint32_t>{2, 3};
                                    })
+    .set_attr<FInferStorageType>("FInferStorageType", LazyOptStorageType<2, NAGMomParam>)
     .set_attr<FCompute>("FCompute<cpu>", MP_NAGMomUpdate<cpu>)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", MP_NAGMomUpdateEx<cpu>)
     .add_argument("weight", "NDArray-or-Symbol", "Weight")
     .add_argument("grad", "NDArray-or-Symbol", "Gradient")
     .add_argument("mom", "NDArray-or-Symbol", "Momentum")
@@ -847,7 +869,9 @@ Hinton suggests the momentum term :math:`\rho` to be 0.9 and the learning rate
                                    [](const nnvm::NodeAttrs& attrs) {
                                      return std::vector<uint32_t>{2};
                                    })
+    .set_attr<FInferStorageType>("FInferStorageType", LazyOptStorageType<1, RMSPropParam>)
     .set_attr<FCompute>("FCompute<cpu>", RMSPropUpdate<cpu>)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", RMSPropUpdateEx<cpu>)
     .add_argument("weight", "NDArray-or-Symbol", "Weight")
     .add_argument("grad", "NDArray-or-Symbol", "Gradient")
     .add_argument("n", "NDArray-or-Symbol", "n")
@@ -886,7 +910,9 @@ to be 0.9 and the learning rate :math:`\eta` to be 0.0001.
                                    [](const nnvm::NodeAttrs& attrs) {
                                      return std::vector<uint32_t>{2, 3, 4};
                                    })
+    .set_attr<FInferStorageType>("FInferStorageType", LazyOptStorageType<3, RMSPropAlexParam>)
     .set_attr<FCompute>("FCompute<cpu>", RMSPropAlexUpdate<cpu>)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", RMSPropAlexUpdateEx<cpu>)
     .add_argument("weight", "NDArray-or-Symbol", "Weight")
     .add_argument("grad", "NDArray-or-Symbol", "Gradient")
     .add_argument("n", "NDArray-or-Symbol", "n")
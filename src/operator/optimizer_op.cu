@@ -257,9 +257,13 @@ void AdamStdUpdateDnsRspDnsImpl<gpu>(const AdamParam& param,
   });
 }
 
-NNVM_REGISTER_OP(signsgd_update).set_attr<FCompute>("FCompute<gpu>", SignSGDUpdate<gpu>);
+NNVM_REGISTER_OP(signsgd_update)
+    .set_attr<FCompute>("FCompute<gpu>", SignSGDUpdate<gpu>)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", SignSGDUpdateEx<gpu>);
 
-NNVM_REGISTER_OP(signum_update).set_attr<FCompute>("FCompute<gpu>", SignumUpdate<gpu>);
+NNVM_REGISTER_OP(signum_update)
+    .set_attr<FCompute>("FCompute<gpu>", SignumUpdate<gpu>)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", SignumUpdateEx<gpu>);
 
 NNVM_REGISTER_OP(sgd_update)
     .set_attr<FCompute>("FCompute<gpu>", SGDUpdate<gpu>)
@@ -269,32 +273,50 @@ NNVM_REGISTER_OP(sgd_mom_update)
     .set_attr<FCompute>("FCompute<gpu>", SGDMomUpdate<gpu>)
     .set_attr<FComputeEx>("FComputeEx<gpu>", SGDMomUpdateEx<gpu>);
 
-NNVM_REGISTER_OP(mp_sgd_update).set_attr<FCompute>("FCompute<gpu>", MP_SGDUpdate<gpu>);
+NNVM_REGISTER_OP(mp_sgd_update)
+    .set_attr<FCompute>("FCompute<gpu>", MP_SGDUpdate<gpu>)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", MP_SGDUpdateEx<gpu>);
 
-NNVM_REGISTER_OP(mp_sgd_mom_update).set_attr<FCompute>("FCompute<gpu>", MP_SGDMomUpdate<gpu>);
+NNVM_REGISTER_OP(mp_sgd_mom_update)
+    .set_attr<FCompute>("FCompute<gpu>", MP_SGDMomUpdate<gpu>)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", MP_SGDMomUpdateEx<gpu>);
 
 NNVM_REGISTER_OP(multi_sgd_update)
-    .set_attr<FCompute>("FCompute<gpu>", MultiSGDUpdate<gpu, type_identity, 2>);
+    .set_attr<FCompute>("FCompute<gpu>", MultiSGDUpdate<gpu, type_identity, 2>)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", MultiSGDUpdateEx<gpu, type_identity, 2, false>);
 NNVM_REGISTER_OP(multi_sgd_mom_update)
-    .set_attr<FCompute>("FCompute<gpu>", MultiSGDMomUpdate<gpu, type_identity, 3>);
+    .set_attr<FCompute>("FCompute<gpu>", MultiSGDMomUpdate<gpu, type_identity, 3>)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", MultiSGDUpdateEx<gpu, type_identity, 3, true>);
 NNVM_REGISTER_OP(multi_mp_sgd_update)
-    .set_attr<FCompute>("FCompute<gpu>", MultiSGDUpdate<gpu, single_precision, 3>);
+    .set_attr<FCompute>("FCompute<gpu>", MultiSGDUpdate<gpu, single_precision, 3>)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", MultiSGDUpdateEx<gpu, single_precision, 3, false>);
 NNVM_REGISTER_OP(multi_mp_sgd_mom_update)
-    .set_attr<FCompute>("FCompute<gpu>", MultiSGDMomUpdate<gpu, single_precision, 4>);
+    .set_attr<FCompute>("FCompute<gpu>", MultiSGDMomUpdate<gpu, single_precision, 4>)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", MultiSGDUpdateEx<gpu, single_precision, 4, true>);
 
-NNVM_REGISTER_OP(nag_mom_update).set_attr<FCompute>("FCompute<gpu>", NAGMomUpdate<gpu>);
+NNVM_REGISTER_OP(nag_mom_update)
+    .set_attr<FCompute>("FCompute<gpu>", NAGMomUpdate<gpu>)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", NAGMomUpdateEx<gpu>);
 
-NNVM_REGISTER_OP(mp_nag_mom_update).set_attr<FCompute>("FCompute<gpu>", MP_NAGMomUpdate<gpu>);
+NNVM_REGISTER_OP(mp_nag_mom_update)
+    .set_attr<FCompute>("FCompute<gpu>", MP_NAGMomUpdate<gpu>)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", MP_NAGMomUpdateEx<gpu>);
 
-NNVM_REGISTER_OP(ftml_update).set_attr<FCompute>("FCompute<gpu>", FTMLUpdate<gpu>);
+NNVM_REGISTER_OP(ftml_update)
+    .set_attr<FCompute>("FCompute<gpu>", FTMLUpdate<gpu>)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", FTMLUpdateEx<gpu>);
 
 NNVM_REGISTER_OP(adam_update)
     .set_attr<FCompute>("FCompute<gpu>", AdamUpdate<gpu>)
     .set_attr<FComputeEx>("FComputeEx<gpu>", AdamUpdateEx<gpu>);
 
-NNVM_REGISTER_OP(rmsprop_update).set_attr<FCompute>("FCompute<gpu>", RMSPropUpdate<gpu>);
+NNVM_REGISTER_OP(rmsprop_update)
+    .set_attr<FCompute>("FCompute<gpu>", RMSPropUpdate<gpu>)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", RMSPropUpdateEx<gpu>);
 
-NNVM_REGISTER_OP(rmspropalex_update).set_attr<FCompute>("FCompute<gpu>", RMSPropAlexUpdate<gpu>);
+NNVM_REGISTER_OP(rmspropalex_update)
+    .set_attr<FCompute>("FCompute<gpu>", RMSPropAlexUpdate<gpu>)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", RMSPropAlexUpdateEx<gpu>);
 
 NNVM_REGISTER_OP(ftrl_update)
     .set_attr<FCompute>("FCompute<gpu>", FtrlUpdate<gpu>)
@@ -28,6 +28,7 @@
 #include <vector>
 #include "../mxnet_op.h"
 #include "./quantization_utils.h"
+#include "../tensor/broadcast_reduce_op.h"
 
 namespace mxnet {
 namespace op {
@@ -41,6 +42,169 @@ struct CalibrateEntropyParam : public dmlc::Parameter<CalibrateEntropyParam> {
   }
 };
 
+namespace calib_observe {
+enum CalibrateObserveOpInputs { kData, kHist, kStats };
+// the stats input holds the running min, max and the histogram range [-th, th]
+enum CalibrateObserveStats { kMin, kMax, kThreshold };
+const int kNumStats = 3;
+}  // namespace calib_observe
+
+/*!
+ * \brief Folds the min/max of a new batch into the running stats. When the batch does not fit in
+ *        the histogram range, the range grows by the smallest power of two that covers it and the
+ *        growth factor is written for the rebinning, 1 otherwise.
+ */
+struct calib_observe_range {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(int i,
+                                  float* stats,
+                                  float* growth,
+                                  const DType* batch_min,
+                                  const DType* batch_max) {
+    const float mn = static_cast<float>(*batch_min);
+    const float mx = static_cast<float>(*batch_max);
+    stats[calib_observe::kMin] = mn < stats[calib_observe::kMin] ? mn : stats[calib_observe::kMin];
+    stats[calib_observe::kMax] = mx > stats[calib_observe::kMax] ? mx : stats[calib_observe::kMax];
+    const float th = MaxAbs(mn, mx);
+    float factor   = 1.f;
+    if (stats[calib_observe::kThreshold] == 0.f) {
+      // so far everything was 0, the mass sits in the center bin for any range
+      stats[calib_observe::kThreshold] = th;
+    } else {
+      while (stats[calib_observe::kThreshold] * factor < th)
+        factor *= 2.f;
+      stats[calib_observe::kThreshold] *= factor;
+    }
+    *growth = factor;
+  }
+};
+
+/*!
+ * \brief Rebins a histogram of num_bins = 2 * half + 1 bins centered on 0 after its range grew by
+ *        the power of two growth factor. With an even factor the borders of the new bins cut old
+ *        bins in their middle, those are split evenly between both neighbours.
+ */
+struct calib_observe_rebin {
+  MSHADOW_XINLINE static void Map(int j,
+                                  double* hist,
+                                  const double* old_hist,
+                                  const int half,
+                                  const float* growth) {
+    if (*growth == 1.f) {
+      hist[j] = old_hist[j];
+      return;
+    }
+    // past 2 * num_bins everything lands in the center bin, larger factors change nothing
+    const int64_t factor = *growth < 4.f * half + 2.f ? static_cast<int64_t>(*growth) : 4 * half + 2;
+    // bin offsets relative to the center bin, in units of the old bins
+    const int64_t lo = (2 * (j - half) - 1) * (factor / 2);
+    const int64_t hi = (2 * (j - half) + 1) * (factor / 2);
+    double sum       = 0;
+    for (int64_t o = (lo + 1 > -half ? lo + 1 : -half); o <= (hi - 1 < half ? hi - 1 : half); ++o)
+      sum += old_hist[o + half];
+    if (lo >= -half && lo <= half)
+      sum += 0.5 * old_hist[lo + half];
+    if (hi >= -half && hi <= half)
+      sum += 0.5 * old_hist[hi + half];
+    hist[j] = sum;
+  }
+};
+
+/*!
+ * \brief Bin of x in a histogram of num_bins bins over [-th, th], the last edge included as in
+ *        numpy.histogram.
+ */
+MSHADOW_XINLINE int CalibrateObserveBin(const float x, const float th, const int num_bins) {
+  if (th == 0.f)
+    return num_bins / 2;
+  const int bin = static_cast<int>((x + th) / (2.f * th) * num_bins);
+  return bin < 0 ? 0 : (bin >= num_bins ? num_bins - 1 : bin);
+}
+
+/*!
+ * \brief Adds the n values of data to hist, binned over the range in stats.
+ */
+template <typename DType>
+void CalibrateObserveAccumulate(mshadow::Stream<cpu>* s,
+                                const DType* data,
+                                const index_t n,
+                                double* hist,
+                                const int num_bins,
+                                const float* stats);
+
+template <typename DType>
+void CalibrateObserveAccumulate(mshadow::Stream<gpu>* s,
+                                const DType* data,
+                                const index_t n,
+                                double* hist,
+                                const int num_bins,
+                                const float* stats);
+
+template <typename xpu>
+void CalibrateObserveCompute(const nnvm::NodeAttrs& attrs,
+                             const OpContext& ctx,
+                             const std::vector<TBlob>& inputs,
+                             const std::vector<OpReqType>& req,
+                             const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  Stream<xpu>* s      = ctx.get_stream<xpu>();
+  const TBlob& data   = inputs[calib_observe::kData];
+  const TBlob& hist   = inputs[calib_observe::kHist];
+  const TBlob& stats  = inputs[calib_observe::kStats];
+  const int num_bins  = hist.Size();
+  CHECK_EQ(num_bins % 2, 1) << "calibrate_observe needs an odd number of bins, got " << num_bins;
+  if (data.Size() == 0)
+    return;
+  MSHADOW_REAL_TYPE_SWITCH(data.type_flag_, DType, {
+    mxnet::TShape src_shape, dst_shape;
+    const size_t temp_reduce_size =
+        ConfigReduce<xpu, DType>(s, data.shape_, mxnet::TShape(1, 1), &src_shape, &dst_shape);
+    // old histogram, batch min/max and growth factor, then the reduction workspace
+    const size_t temp_bytes = num_bins * sizeof(double) + 2 * sizeof(DType) + sizeof(float);
+    Tensor<xpu, 1, char> temp_space = ctx.requested[0].get_space_typed<xpu, 1, char>(
+        Shape1(temp_bytes + temp_reduce_size), s);
+    double* old_hist = reinterpret_cast<double*>(temp_space.dptr_);
+    DType* batch_min = reinterpret_cast<DType*>(old_hist + num_bins);
+    float* growth    = reinterpret_cast<float*>(batch_min + 2);
+    const int dev_id = ctx.run_ctx.ctx.dev_id;
+    TBlob batch_min_t(batch_min, Shape1(1), xpu::kDevMask, dev_id);
+    TBlob batch_max_t(batch_min + 1, Shape1(1), xpu::kDevMask, dev_id);
+    Tensor<xpu, 1, char> workspace(temp_space.dptr_ + temp_bytes, Shape1(temp_reduce_size), s);
+#if !defined(__CUDACC__)
+    broadcast::Reduce<red::minimum, 2, DType, mshadow::op::identity>(
+        s, batch_min_t.reshape(dst_shape), kWriteTo, workspace, data.reshape(src_shape));
+    broadcast::Reduce<red::maximum, 2, DType, mshadow::op::identity>(
+        s, batch_max_t.reshape(dst_shape), kWriteTo, workspace, data.reshape(src_shape));
+#else
+    broadcast::RTCReduce(ctx,
+                         batch_min_t.reshape(dst_shape),
+                         kWriteTo,
+                         workspace,
+                         data.reshape(src_shape),
+                         "red::minimum{}",
+                         2,
+                         "identity");
+    broadcast::RTCReduce(ctx,
+                         batch_max_t.reshape(dst_shape),
+                         kWriteTo,
+                         workspace,
+                         data.reshape(src_shape),
+                         "red::maximum{}",
+                         2,
+                         "identity");
+#endif
+    Kernel<calib_observe_range, xpu>::Launch(
+        s, 1, stats.dptr<float>(), growth, batch_min, batch_min + 1);
+    Tensor<xpu, 1, double> old_hist_t(old_hist, Shape1(num_bins), s);
+    Copy(old_hist_t, hist.get<xpu, 1, double>(s), s);
+    Kernel<calib_observe_rebin, xpu>::Launch(
+        s, num_bins, hist.dptr<double>(), old_hist, num_bins / 2, growth);
+    CalibrateObserveAccumulate(
+        s, data.dptr<DType>(), data.Size(), hist.dptr<double>(), num_bins, stats.dptr<float>());
+  });
+}
+
 }  // namespace op
 }  // namespace mxnet
 #endif  // MXNET_OPERATOR_QUANTIZATION_CALIBRATE_INL_H_
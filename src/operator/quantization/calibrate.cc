@@ -22,7 +22,9 @@
  * \brief
  */
 
+#include <algorithm>
 #include <numeric>
+#include <vector>
 #include "./calibrate-inl.h"
 
 namespace mxnet {
@@ -86,6 +88,71 @@ static float ComputeEntropy(std::vector<float>* p_ptr, std::vector<float>* q_ptr
   return ret;
 }
 
+// KL divergence between the histogram clipped to its 2 * i + 1 center bins and its quantization
+// to num_quantized_bins bins, the clipping threshold is returned in threshold.
+static float ComputeDivergence(const float* hist_ptr,
+                               const float* hist_edges_ptr,
+                               const size_t num_bins,
+                               const int num_quantized_bins,
+                               const index_t i,
+                               float* threshold) {
+  const int zero_bin_idx       = num_bins / 2;
+  const size_t p_bin_idx_start = zero_bin_idx - i;
+  const size_t p_bin_idx_stop  = zero_bin_idx + i + 1;
+  *threshold                   = hist_edges_ptr[p_bin_idx_stop];
+
+  std::vector<size_t> sliced_nd_hist(p_bin_idx_stop - p_bin_idx_start);
+  std::vector<float> p(p_bin_idx_stop - p_bin_idx_start);
+  p[0]     = 0;
+  p.back() = 0;
+  for (size_t j = 0; j < num_bins; j++) {
+    if (j <= p_bin_idx_start) {
+      p[0] += hist_ptr[j];
+    } else if (j >= p_bin_idx_stop) {
+      p.back() += hist_ptr[j];
+    } else {
+      sliced_nd_hist[j - p_bin_idx_start] = hist_ptr[j];
+      p[j - p_bin_idx_start]              = hist_ptr[j];
+    }
+  }
+  // calculate how many bins should be merged to generate quantized distribution q
+  const auto num_merged_bins = sliced_nd_hist.size() / num_quantized_bins;
+  // merge hist into num_quantized_bins bins
+  std::vector<float> quantized_bins(num_quantized_bins, 0);
+  for (index_t j = 0; j < num_quantized_bins; j++) {
+    const int start = j * num_merged_bins;
+    const int stop  = (j + 1) * num_merged_bins;
+    quantized_bins[j] =
+        std::accumulate(sliced_nd_hist.begin() + start, sliced_nd_hist.begin() + stop, 0);
+  }
+  quantized_bins.back() += std::accumulate(
+      sliced_nd_hist.begin() + static_cast<int>(num_quantized_bins * num_merged_bins),
+      sliced_nd_hist.end(),
+      0);
+  // expand quantized_bins into p.size bins
+  std::vector<float> q(sliced_nd_hist.size(), 0);
+  for (index_t j = 0; j < num_quantized_bins; j++) {
+    const int start = j * num_merged_bins;
+    const int stop  = (j == num_quantized_bins - 1) ? q.size() : ((j + 1) * num_merged_bins);
+    int norm        = std::count_if(sliced_nd_hist.begin() + start,
+                             sliced_nd_hist.begin() + stop,
+                             [](size_t i) { return i != 0; });
+    if (norm) {
+      for (index_t k = start; k < stop; k++) {
+        if (p[k])
+          q[k] = quantized_bins[j] / norm;
+      }
+    }
+  }
+  p = SmoothDistribution(p);
+  q = SmoothDistribution(q);
+
+  if (!q.size()) {
+    return std::numeric_limits<float>::infinity();
+  }
+  return ComputeEntropy(&p, &q);
+}
+
 void CalibrateComputeCPU(const nnvm::NodeAttrs& attrs,
                          const OpContext& ctx,
                          const std::vector<TBlob>& inputs,
@@ -98,83 +165,40 @@ void CalibrateComputeCPU(const nnvm::NodeAttrs& attrs,
   const auto& hist_edges_ptr  = hist_edges.dptr<float>();
   float* const out_threshold  = outputs[0].dptr<float>();
   float* const out_divergence = outputs[1].dptr<float>();
-  const auto num_bins         = hist.Size();
-  CHECK_EQ(num_bins + 1, hist_edges.Size());
+  // a 2D input holds one histogram per row, all of them are searched in the same parallel loop
+  const index_t num_hists = hist.ndim() == 1 ? 1 : hist.shape_[0];
+  const auto num_bins     = hist.shape_[hist.ndim() - 1];
+  CHECK_EQ(num_bins + 1, hist_edges.shape_[hist_edges.ndim() - 1]);
+  CHECK_EQ(num_hists * (num_bins + 1), hist_edges.Size());
   int num_quantized_bins = param.num_quantized_bins;
 
-  const int zero_bin_idx            = num_bins / 2;
   const int num_half_quantized_bins = num_quantized_bins / 2;
-  std::vector<float> thresholds(num_bins / 2 + 1 - num_quantized_bins / 2, 0.f);
+  const index_t num_thresholds      = num_bins / 2 + 1 - num_quantized_bins / 2;
+  std::vector<float> thresholds(num_hists * num_thresholds, 0.f);
   std::vector<float> divergence(thresholds.size(), 0.f);
 #pragma omp parallel for num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
-  for (index_t i = num_quantized_bins / 2; i <= zero_bin_idx; i++) {
-    const size_t p_bin_idx_start            = zero_bin_idx - i;
-    const size_t p_bin_idx_stop             = zero_bin_idx + i + 1;
-    thresholds[i - num_half_quantized_bins] = hist_edges_ptr[p_bin_idx_stop];
-
-    std::vector<size_t> sliced_nd_hist(p_bin_idx_stop - p_bin_idx_start);
-    std::vector<float> p(p_bin_idx_stop - p_bin_idx_start);
-    p[0]     = 0;
-    p.back() = 0;
-    for (size_t j = 0; j < num_bins; j++) {
-      if (j <= p_bin_idx_start) {
-        p[0] += hist_ptr[j];
-      } else if (j >= p_bin_idx_stop) {
-        p.back() += hist_ptr[j];
-      } else {
-        sliced_nd_hist[j - p_bin_idx_start] = hist_ptr[j];
-        p[j - p_bin_idx_start]              = hist_ptr[j];
-      }
-    }
-    // calculate how many bins should be merged to generate quantized distribution q
-    const auto num_merged_bins = sliced_nd_hist.size() / num_quantized_bins;
-    // merge hist into num_quantized_bins bins
-    std::vector<float> quantized_bins(num_quantized_bins, 0);
-    for (index_t j = 0; j < num_quantized_bins; j++) {
-      const int start = j * num_merged_bins;
-      const int stop  = (j + 1) * num_merged_bins;
-      quantized_bins[j] =
-          std::accumulate(sliced_nd_hist.begin() + start, sliced_nd_hist.begin() + stop, 0);
-    }
-    quantized_bins.back() += std::accumulate(
-        sliced_nd_hist.begin() + static_cast<int>(num_quantized_bins * num_merged_bins),
-        sliced_nd_hist.end(),
-        0);
-    // expand quantized_bins into p.size bins
-    std::vector<float> q(sliced_nd_hist.size(), 0);
-    for (index_t j = 0; j < num_quantized_bins; j++) {
-      const int start = j * num_merged_bins;
-      const int stop  = (j == num_quantized_bins - 1) ? q.size() : ((j + 1) * num_merged_bins);
-      int norm        = std::count_if(sliced_nd_hist.begin() + start,
-                               sliced_nd_hist.begin() + stop,
-                               [](size_t i) { return i != 0; });
-      if (norm) {
-        for (index_t k = start; k < stop; k++) {
-          if (p[k])
-            q[k] = quantized_bins[j] / norm;
-        }
-      }
-    }
-    p = SmoothDistribution(p);
-    q = SmoothDistribution(q);
-
-    if (!q.size()) {
-      divergence[i - num_half_quantized_bins] = std::numeric_limits<float>::infinity();
-    } else {
-      divergence[i - num_half_quantized_bins] = ComputeEntropy(&p, &q);
-    }
+  for (index_t n = 0; n < num_hists * num_thresholds; n++) {
+    const index_t h = n / num_thresholds;
+    divergence[n]   = ComputeDivergence(hist_ptr + h * num_bins,
+                                      hist_edges_ptr + h * (num_bins + 1),
+                                      num_bins,
+                                      num_quantized_bins,
+                                      n % num_thresholds + num_half_quantized_bins,
+                                      &thresholds[n]);
   }
 
-  size_t min_divergence_idx = 0;
-  float min_divergence      = mshadow::red::limits::MaxValue<float>();
-  for (size_t i = 0; i < divergence.size(); i++) {
-    if (divergence[i] < min_divergence) {
-      min_divergence     = divergence[i];
-      min_divergence_idx = i;
+  for (index_t h = 0; h < num_hists; h++) {
+    size_t min_divergence_idx = 0;
+    float min_divergence      = mshadow::red::limits::MaxValue<float>();
+    for (index_t i = 0; i < num_thresholds; i++) {
+      if (divergence[h * num_thresholds + i] < min_divergence) {
+        min_divergence     = divergence[h * num_thresholds + i];
+        min_divergence_idx = i;
+      }
     }
+    out_divergence[h] = min_divergence;
+    out_threshold[h]  = thresholds[h * num_thresholds + min_divergence_idx];
   }
-  *out_divergence = min_divergence;
-  *out_threshold  = thresholds[min_divergence_idx];
 }
 
 static inline bool CalibrateShape(const nnvm::NodeAttrs& attrs,
@@ -182,8 +206,13 @@ static inline bool CalibrateShape(const nnvm::NodeAttrs& attrs,
                                   std::vector<TShape>* out_attrs) {
   CHECK_EQ(in_attrs->size(), 2U);
   CHECK_EQ(out_attrs->size(), 2U);
-  SHAPE_ASSIGN_CHECK(*out_attrs, 0, TShape(1, 1));
-  SHAPE_ASSIGN_CHECK(*out_attrs, 1, TShape(1, 1));
+  const TShape& hshape = in_attrs->at(0);
+  if (!shape_is_known(hshape))
+    return false;
+  CHECK_LE(hshape.ndim(), 2) << "calibrate_entropy takes one histogram or a batch of them";
+  const index_t num_hists = hshape.ndim() == 1 ? 1 : hshape[0];
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, TShape(1, num_hists));
+  SHAPE_ASSIGN_CHECK(*out_attrs, 1, TShape(1, num_hists));
   return (!shape_is_none(in_attrs->at(0))) && (!shape_is_none(in_attrs->at(1)));
 }
 
@@ -223,5 +252,89 @@ NNVM_REGISTER_OP(_contrib_calibrate_entropy)
     .add_argument("hist_edges", "NDArray-or-Symbol", "A ndarray/symbol of type `float32`")
     .add_arguments(CalibrateEntropyParam::__FIELDS__());
 
+template <typename DType>
+void CalibrateObserveAccumulate(mshadow::Stream<cpu>* s,
+                                const DType* data,
+                                const index_t n,
+                                double* hist,
+                                const int num_bins,
+                                const float* stats) {
+  const float th = stats[calib_observe::kThreshold];
+  const int nthreads =
+      std::min<index_t>(engine::OpenMP::Get()->GetRecommendedOMPThreadCount(), n / 4096 + 1);
+  // one private histogram per thread, merged once at the end
+  std::vector<double> local(static_cast<size_t>(nthreads) * num_bins, 0.0);
+#pragma omp parallel num_threads(nthreads)
+  {
+    double* my_hist = local.data() + static_cast<size_t>(omp_get_thread_num()) * num_bins;
+#pragma omp for
+    for (index_t i = 0; i < n; i++) {
+      my_hist[CalibrateObserveBin(static_cast<float>(data[i]), th, num_bins)] += 1.0;
+    }
+  }
+  for (int t = 0; t < nthreads; t++) {
+    for (int b = 0; b < num_bins; b++) {
+      hist[b] += local[static_cast<size_t>(t) * num_bins + b];
+    }
+  }
+}
+
+static inline bool CalibrateObserveShape(const nnvm::NodeAttrs& attrs,
+                                         std::vector<TShape>* in_attrs,
+                                         std::vector<TShape>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 3U);
+  CHECK_EQ(out_attrs->size(), 0U);
+  SHAPE_ASSIGN_CHECK(*in_attrs, calib_observe::kStats, TShape(1, calib_observe::kNumStats));
+  const TShape& hshape = in_attrs->at(calib_observe::kHist);
+  if (shape_is_known(hshape)) {
+    CHECK_EQ(hshape.ndim(), 1U) << "calibrate_observe accumulates into a 1D histogram";
+  }
+  return shape_is_known(in_attrs->at(calib_observe::kData)) && shape_is_known(hshape);
+}
+
+static inline bool CalibrateObserveType(const nnvm::NodeAttrs& attrs,
+                                        std::vector<int>* in_attrs,
+                                        std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 3U);
+  CHECK_EQ(out_attrs->size(), 0U);
+  TYPE_ASSIGN_CHECK(*in_attrs, calib_observe::kHist, mshadow::kFloat64);
+  TYPE_ASSIGN_CHECK(*in_attrs, calib_observe::kStats, mshadow::kFloat32);
+  return in_attrs->at(calib_observe::kData) != -1;
+}
+
+NNVM_REGISTER_OP(_contrib_calibrate_observe)
+    .add_alias("_npx_contrib_calibrate_observe")
+    .describe(R"code(Accumulates the statistics of a layer output for the calibration of a
+quantized model, directly on the device of the output.
+
+`stats` holds the running min, max and the range `th` of `hist`, a histogram of an odd number
+of bins over [-th, th]. Initialize it to [inf, -inf, 0] and `hist` to zeros. When a batch does
+not fit in the range, the range grows by a power of two and the collected counts are rebinned.
+Both `hist` and `stats` are updated in place.
+
+.. Note::
+    This operator only supports forward propagation. DO NOT use it in training.)code" ADD_FILELINE)
+    .set_num_inputs(3)
+    .set_num_outputs(0)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"data", "hist", "stats"};
+                                     })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     return std::vector<uint32_t>{calib_observe::kHist,
+                                                                  calib_observe::kStats};
+                                   })
+    .set_attr<mxnet::FInferShape>("FInferShape", CalibrateObserveShape)
+    .set_attr<nnvm::FInferType>("FInferType", CalibrateObserveType)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", CalibrateObserveCompute<cpu>)
+    .add_argument("data", "NDArray-or-Symbol", "The layer output to observe")
+    .add_argument("hist", "NDArray-or-Symbol", "The float64 histogram, updated in place")
+    .add_argument("stats", "NDArray-or-Symbol", "The float32 min, max and range, updated in place");
+
 }  // namespace op
 }  // namespace mxnet
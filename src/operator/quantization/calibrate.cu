@@ -0,0 +1,100 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file calibrate.cu
+ * \brief On device accumulation of the calibration histograms
+ */
+#include "./calibrate-inl.h"
+#include "../../common/cuda/utils.h"
+
+namespace mxnet {
+namespace op {
+
+constexpr int kCalibObserveThreads = 256;
+// each block bins this many elements per thread before its histogram is flushed
+constexpr int kCalibObserveItemsPerThread = 16;
+
+// each block counts its part of the data in a shared memory histogram, flushed once to the global
+// one, so the atomics on the global histogram do not pile up on the bins around 0
+template <typename DType>
+__global__ void CalibrateObserveSharedKernel(const DType* data,
+                                             const index_t n,
+                                             double* hist,
+                                             const int num_bins,
+                                             const float* stats) {
+  extern __shared__ unsigned int block_hist[];
+  for (int b = threadIdx.x; b < num_bins; b += blockDim.x)
+    block_hist[b] = 0;
+  __syncthreads();
+  const float th = stats[calib_observe::kThreshold];
+  for (index_t i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += static_cast<index_t>(gridDim.x) * blockDim.x) {
+    atomicAdd(&block_hist[CalibrateObserveBin(static_cast<float>(data[i]), th, num_bins)], 1u);
+  }
+  __syncthreads();
+  for (int b = threadIdx.x; b < num_bins; b += blockDim.x) {
+    if (block_hist[b] != 0)
+      atomicAdd(&hist[b], static_cast<double>(block_hist[b]));
+  }
+}
+
+template <typename DType>
+__global__ void CalibrateObserveGlobalKernel(const DType* data,
+                                             const index_t n,
+                                             double* hist,
+                                             const int num_bins,
+                                             const float* stats) {
+  const float th = stats[calib_observe::kThreshold];
+  for (index_t i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += static_cast<index_t>(gridDim.x) * blockDim.x) {
+    atomicAdd(&hist[CalibrateObserveBin(static_cast<float>(data[i]), th, num_bins)], 1.0);
+  }
+}
+
+template <typename DType>
+void CalibrateObserveAccumulate(mshadow::Stream<gpu>* s,
+                                const DType* data,
+                                const index_t n,
+                                double* hist,
+                                const int num_bins,
+                                const float* stats) {
+  using namespace mxnet_op;
+  cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
+  const int nblocks   = std::min<index_t>(
+      kMaxGridNum,
+      (n + kCalibObserveThreads * kCalibObserveItemsPerThread - 1) /
+          (kCalibObserveThreads * kCalibObserveItemsPerThread));
+  const size_t shared_bytes = num_bins * sizeof(unsigned int);
+  if (shared_bytes <= 48 * 1024) {
+    CalibrateObserveSharedKernel<<<nblocks, kCalibObserveThreads, shared_bytes, stream>>>(
+        data, n, hist, num_bins, stats);
+    MSHADOW_CUDA_POST_KERNEL_CHECK(CalibrateObserveSharedKernel);
+  } else {
+    CalibrateObserveGlobalKernel<<<nblocks, kCalibObserveThreads, 0, stream>>>(
+        data, n, hist, num_bins, stats);
+    MSHADOW_CUDA_POST_KERNEL_CHECK(CalibrateObserveGlobalKernel);
+  }
+}
+
+NNVM_REGISTER_OP(_contrib_calibrate_observe)
+    .set_attr<FCompute>("FCompute<gpu>", CalibrateObserveCompute<gpu>);
+
+}  // namespace op
+}  // namespace mxnet
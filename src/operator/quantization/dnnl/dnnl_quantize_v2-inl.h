@@ -48,8 +48,6 @@ class SgDNNLQuantizeOperator {
  private:
   bool initalized_{false};
   QuantizeV2Param param_;
-  float cached_data_min_{0.f};
-  float cached_data_max_{0.f};
   dnnl::memory::desc o_desc_;
   dnnl_args_map_t args_;
   std::shared_ptr<dnnl::reorder> fwd_pd_;
@@ -61,8 +59,6 @@ void SgDNNLQuantizeOperator::Forward(const OpContext& ctx,
                                      const std::vector<NDArray>& outputs) {
   float quantized_range = 0.0;
   NDArray in_buffer     = inputs[0];
-  float data_min        = mshadow::red::limits::MaxValue<float>();
-  float data_max        = mshadow::red::limits::MinValue<float>();
 
   // Pass through quantized data
   if (inputs[0].dtype() == mshadow::kUint8 || inputs[0].dtype() == mshadow::kInt8) {
@@ -82,39 +78,24 @@ void SgDNNLQuantizeOperator::Forward(const OpContext& ctx,
       const_cast<NDArray&>(outputs[0]).CopyFrom(*inputs[0].GetDNNLData());
       DNNLStream::Get()->Submit();
     }
+  } else if (!param_.min_calib_range.has_value() || !param_.max_calib_range.has_value()) {
+    // the range changes with every batch, a reorder would be rebuilt for each of its scales,
+    // find the range and quantize in one kernel instead
+    if (in_buffer.IsDNNLData())
+      in_buffer = inputs[0].Reorder2Default();
+    const_cast<NDArray&>(outputs[0]).InvalidateDNNLData();
+    QuantizeV2Dynamic(ctx.get_stream<cpu>(),
+                      ctx,
+                      in_buffer.data(),
+                      outputs[0].data(),
+                      outputs[1].data().dptr<float>(),
+                      outputs[2].data().dptr<float>());
   } else {
     if (in_buffer.IsView() && in_buffer.IsDNNLData())
       in_buffer = inputs[0].Reorder2Default();
-    auto i_mem = in_buffer.GetDNNLData();
-
-    if (param_.min_calib_range.has_value() && param_.max_calib_range.has_value()) {
-      data_min = param_.min_calib_range.value();
-      data_max = param_.max_calib_range.value();
-    } else {
-      // no calib info
-      in_buffer     = inputs[0].Reorder2Default();
-      auto in_ptr   = in_buffer.data().dptr<float>();
-      auto nthreads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
-      std::vector<float> data_maxs(nthreads, data_max);
-      std::vector<float> data_mins(nthreads, data_min);
-#pragma omp parallel for num_threads(nthreads)
-      for (index_t i = 0; i < static_cast<index_t>(in_buffer.shape().Size()); i++) {
-        int tid = omp_get_thread_num();
-        if (in_ptr[i] > data_maxs[tid])
-          data_maxs[tid] = in_ptr[i];
-        if (in_ptr[i] < data_mins[tid])
-          data_mins[tid] = in_ptr[i];
-      }
-      for (index_t i = 0; i < nthreads; i++) {
-        if (data_maxs[i] > data_max)
-          data_max = data_maxs[i];
-        if (data_mins[i] < data_min)
-          data_min = data_mins[i];
-      }
-
-      if (initalized_ && (cached_data_min_ != data_min || cached_data_max_ != data_max))
-        initalized_ = false;
-    }
+    auto i_mem           = in_buffer.GetDNNLData();
+    const float data_min = param_.min_calib_range.value();
+    const float data_max = param_.max_calib_range.value();
 
     // Write output min/max
     auto out_type = GetQuantizeOutputType(param_);
@@ -132,8 +113,6 @@ void SgDNNLQuantizeOperator::Forward(const OpContext& ctx,
     }
 
     if (!initalized_) {
-      cached_data_min_ = data_min;
-      cached_data_max_ = data_max;
       float real_range = MaxAbs(data_min, data_max);
       float scale      = quantized_range / real_range;
       dnnl::primitive_attr attr;
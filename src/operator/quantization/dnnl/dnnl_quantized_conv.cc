@@ -42,6 +42,8 @@ static void DNNLQuantizedConvForward(const nnvm::NodeAttrs& attrs,
   TmpMemMgr::Get()->Init(ctx.requested[conv::kTempSpace]);
   NDArray weight         = in_data[conv::kWeight];
   ConvolutionParam param = nnvm::get<ConvolutionParam>(attrs.parsed);
+  CHECK_EQ(in_data[param.no_bias ? 4 : 5].shape().Size(), 1U)
+      << "quantized_conv on CPU does not support per output channel weight ranges";
   DNNLConvFullParam full_param;
   full_param.conv_param = param;
   full_param.dnnl_param.Init(std::unordered_map<std::string, std::string>());
@@ -61,9 +61,11 @@ DNNLQuantizedSumFwd& DNNLQuantizedSumFwd::GetCached(
     const std::vector<float>& scales,
     const std::vector<dnnl::memory::desc>& inputs_md) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<OpSignature, DNNLQuantizedSumFwd, OpHash> fwds;
+  static thread_local DNNLPrimitiveCache<OpSignature, DNNLQuantizedSumFwd, OpHash>
+      fwds("quantized_elemwise_add");
 #else
-  static MX_THREAD_LOCAL std::unordered_map<OpSignature, DNNLQuantizedSumFwd, OpHash> fwds;
+  static MX_THREAD_LOCAL DNNLPrimitiveCache<OpSignature, DNNLQuantizedSumFwd, OpHash>
+      fwds("quantized_elemwise_add");
 #endif
   OpSignature key;
   key.AddSign(output_md);
@@ -110,9 +112,11 @@ DNNLQuantizedBinAddFwd& DNNLQuantizedBinAddFwd::GetCached(
     const std::vector<float>& scales,
     const std::vector<dnnl::memory::desc>& inputs_md) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<OpSignature, DNNLQuantizedBinAddFwd, OpHash> fwds;
+  static thread_local DNNLPrimitiveCache<OpSignature, DNNLQuantizedBinAddFwd, OpHash>
+      fwds("quantized binary add");
 #else
-  static MX_THREAD_LOCAL std::unordered_map<OpSignature, DNNLQuantizedBinAddFwd, OpHash> fwds;
+  static MX_THREAD_LOCAL DNNLPrimitiveCache<OpSignature, DNNLQuantizedBinAddFwd, OpHash>
+      fwds("quantized binary add");
 #endif
   OpSignature key;
   key.AddSign(output_md);
@@ -44,6 +44,8 @@ void DNNLQuantizedFullyConnectedForward(const nnvm::NodeAttrs& attrs,
 
   CHECK_EQ(in_data.size(), static_cast<size_t>(num_inputs * 3));
   CHECK_EQ(out_data.size(), 3U);
+  CHECK_EQ(in_data[num_inputs + quantized_fullc::kWeightMin].shape().Size(), 1U)
+      << "quantized_fully_connected on CPU does not support per output channel weight ranges";
 
   NDArray data   = in_data[fullc::kData];
   NDArray weight = in_data[fullc::kWeight];
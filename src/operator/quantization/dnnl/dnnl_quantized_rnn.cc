@@ -25,92 +25,78 @@
 
 #if MXNET_USE_ONEDNN == 1
 
+#include <utility>
+#include <vector>
+
 #include "operator/quantization/quantization_utils.h"
 #include "operator/quantization/dnnl/dnnl_quantized_rnn-inl.h"
 
 namespace mxnet {
 namespace op {
 
-std::vector<float> GetDNNLRnnWeightsQParams(const DNNLRnnFullParam& full_param, float* w_ptr) {
+/*
+ * oneDNN quantizes the weights of an LSTM with one scale per gate and output channel, shared by
+ * the layers, the directions and both the layer and iter weights. The projection has one scale
+ * per output channel, returned in proj_scales.
+ */
+std::vector<float> GetDNNLRnnWeightsQParams(const DNNLRnnFullParam& full_param,
+                                            const float* w_ptr,
+                                            std::vector<float>* proj_scales) {
   const int nthreads            = mxnet::engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
   const int num_gates           = 4;
   const RNNParam& default_param = full_param.default_param;
-  const LayerParamVector& layer_params = full_param.layer_params;
-
-  const DNNLRnnLayerParam& layer_param0 = layer_params.at(0);
-  const size_t w_size0                  = layer_param0.single_w_size;
-  const size_t wx_size0 = num_gates * layer_param0.state_size * layer_param0.input_size;
-  const size_t wh_size0 = num_gates * layer_param0.state_size * layer_param0.state_size;
-
-  int directions = 1;
-  float* wx      = w_ptr;
-  float* wh      = wx + wx_size0;
-  float* fake_wx = wx;
-  float* fake_wh = wh;
-
-  std::vector<float> wx_goi_max;
-  std::vector<float> wh_goi_max;
-  if (default_param.bidirectional) {
-    directions = 2;
-    wx_goi_max.resize(wx_size0);
-    wh_goi_max.resize(wh_size0);
-    fake_wx = wx_goi_max.data();
-    fake_wh = wh_goi_max.data();
-#pragma omp parallel for num_threads(nthreads)
-    for (index_t i = 0; i < static_cast<index_t>(wx_size0); ++i) {
-      fake_wx[i] = MaxAbs(wx[i], wx[i + w_size0]);
-    }
-#pragma omp parallel for num_threads(nthreads)
-    for (index_t i = 0; i < static_cast<index_t>(wh_size0); ++i) {
-      fake_wh[i] = MaxAbs(wh[i], wh[i + w_size0]);
-    }
-  }
-  std::vector<float> w_max(num_gates * layer_param0.state_size, 0.0);
-  const index_t input_size  = layer_param0.input_size;              // input
-  const index_t state_size  = layer_param0.state_size;              // state
-  const index_t gates_nblks = num_gates * layer_param0.state_size;  // gates * state
-  for (index_t go = 0; go < gates_nblks; ++go) {
-    float tmp_max = w_max[go];
-    for (index_t i = 0; i < input_size; ++i) {
-      tmp_max = MaxAbs(fake_wx[go * input_size + i], tmp_max);
-    }
-    for (index_t i = 0; i < state_size; ++i) {
-      tmp_max = MaxAbs(fake_wh[go * state_size + i], tmp_max);
-    }
-    w_max[go] = tmp_max;
-  }
-  wx += layer_param0.single_w_size * directions;
-  wh += layer_param0.single_w_size * directions;
-
-  std::vector<float> goi_max(wh_size0, 0.0);
-  for (size_t lyr = 1; lyr < layer_params.size(); ++lyr) {
-    const DNNLRnnLayerParam& layer_param = layer_params.at(lyr);
-    const int weight_nblks               = layer_param.num_layer * directions;
-    for (int blk = 0; blk < weight_nblks; ++blk) {
+  const bool use_proj           = default_param.projection_size.has_value();
+  const index_t state_size      = default_param.state_size;
+  const index_t iter_size       = use_proj ? default_param.projection_size.value() : state_size;
+  const index_t gates_nblks     = num_gates * state_size;  // gates * state
+  const int directions          = default_param.bidirectional ? 2 : 1;
+
+  /* native weights layout of each layer and direction is:
+          | wx (gates * state x input) | wh (gates * state x iter) | wr (iter x state) |
+     wr, the projection, only exists with a projection_size.
+  */
+  std::vector<float> w_max(gates_nblks, 0.0f);
+  std::vector<float> proj_max(use_proj ? iter_size : 0, 0.0f);
+  const float* w = w_ptr;
+  for (const DNNLRnnLayerParam& layer_param : full_param.layer_params) {
+    const index_t input_size = layer_param.input_size;
+    for (int blk = 0; blk < layer_param.num_layer * directions; ++blk) {
+      const float* wx = w;
+      const float* wh = wx + gates_nblks * input_size;
+      const float* wr = wh + gates_nblks * iter_size;
 #pragma omp parallel for num_threads(nthreads)
-      for (index_t i = 0; i < static_cast<index_t>(wh_size0); ++i) {
-        goi_max[i] = MaxAbs(wx[i], wh[i]);
-      }
       for (index_t go = 0; go < gates_nblks; ++go) {
         float tmp = w_max[go];
-// NOTES: min/max reductions were supported since OpenMP 3.1, which was
-// released in Jul 2011 (hence the version number).
-#if _OPENMP >= 201107
-#pragma omp parallel for reduction(max : tmp) num_threads(nthreads)
-#endif
-        for (index_t i = 0; i < state_size; ++i) {
-          tmp = Max(goi_max[go * state_size + i], tmp);
+        for (index_t i = 0; i < input_size; ++i) {
+          tmp = MaxAbs(wx[go * input_size + i], tmp);
+        }
+        for (index_t i = 0; i < iter_size; ++i) {
+          tmp = MaxAbs(wh[go * iter_size + i], tmp);
         }
         w_max[go] = tmp;
       }
+      if (use_proj) {
+#pragma omp parallel for num_threads(nthreads)
+        for (index_t o = 0; o < iter_size; ++o) {
+          float tmp = proj_max[o];
+          for (index_t i = 0; i < state_size; ++i) {
+            tmp = MaxAbs(wr[o * state_size + i], tmp);
+          }
+          proj_max[o] = tmp;
+        }
+      }
+      w += layer_param.single_w_size;
     }
-    wx += layer_param.single_w_size * directions;
-    wh = wx + wh_size0;
   }
-#pragma omp parallel for num_threads(nthreads)
-  for (index_t i = 0; i < static_cast<index_t>(w_max.size()); ++i) {
-    w_max[i] = mshadow::red::limits::MaxValue<int8_t>() / w_max[i];
+
+  const float int8_max = mshadow::red::limits::MaxValue<int8_t>();
+  for (float& m : w_max) {
+    m = int8_max / m;
   }
+  for (float& m : proj_max) {
+    m = int8_max / m;
+  }
+  *proj_scales = std::move(proj_max);
   return w_max;
 }
 
@@ -220,9 +206,15 @@ void DNNLQuantizedRnnOp::Forward(const OpContext& op_ctx,
     cached_data_scale_ = data_scale;
     cached_data_shift_ = data_shift;
     rnn_attr_->set_rnn_data_qparams(data_scale, data_shift);
-    if (need_reset_weight || fwd_inf_vec_.empty())
-      rnn_attr_->set_rnn_weights_qparams(0 + (1 << 3) + (1 << 4),
-                                         GetDNNLRnnWeightsQParams(full_param_, weights_ptr));
+    if (need_reset_weight || fwd_inf_vec_.empty()) {
+      std::vector<float> proj_scales;
+      const std::vector<float> scales =
+          GetDNNLRnnWeightsQParams(full_param_, weights_ptr, &proj_scales);
+      rnn_attr_->set_rnn_weights_qparams(0 + (1 << 3) + (1 << 4), scales);
+      // the projection weights are ldio, quantized per output channel
+      if (!proj_scales.empty())
+        rnn_attr_->set_rnn_weights_projection_qparams(1 << 3, proj_scales);
+    }
   }
 
   // Initialize weights version
@@ -261,13 +253,19 @@ void DNNLQuantizedRnnOp::Forward(const OpContext& op_ctx,
   const int seq_length = default_param.seq_length_;
   const int batch_size = default_param.batch_size_;
   const int state_size = default_param.state_size;
+  const int iter_size  = default_param.projection_size.has_value() ?
+                            default_param.projection_size.value() :
+                            default_param.state_size;
   const int directions = default_param.bidirectional ? 2 : 1;
-  dnnl::memory::desc dst_desc({seq_length, batch_size, directions * state_size},
+  dnnl::memory::desc dst_desc({seq_length, batch_size, directions * iter_size},
                               get_dnnl_type(data_dtype),
                               dnnl::memory::format_tag::tnc);
-  dnnl::memory::desc state_desc({num_layers, directions, batch_size, state_size},
+  dnnl::memory::desc state_desc({num_layers, directions, batch_size, iter_size},
                                 get_dnnl_type(data_dtype),
                                 dnnl::memory::format_tag::ldnc);
+  dnnl::memory::desc cell_desc({num_layers, directions, batch_size, state_size},
+                               get_dnnl_type(data_dtype),
+                               dnnl::memory::format_tag::ldnc);
   auto out_mem = CreateDNNLMem(outputs[rnn_enum::kOut], dst_desc, req[rnn_enum::kOut]);
   dnnl_output_t stateout_mem;
   dnnl_output_t statecellout_mem;
@@ -290,7 +288,7 @@ void DNNLQuantizedRnnOp::Forward(const OpContext& op_ctx,
     src_state_cell = static_cast<char*>(inputs[rnn_enum::kStateCell].data().dptr_);
     if (default_param.state_outputs && req[rnn_enum::kStateCellOut] != kNullOp) {
       statecellout_mem =
-          CreateDNNLMem(outputs[rnn_enum::kStateCellOut], state_desc, req[rnn_enum::kStateCellOut]);
+          CreateDNNLMem(outputs[rnn_enum::kStateCellOut], cell_desc, req[rnn_enum::kStateCellOut]);
       dst_state_cell = static_cast<char*>(statecellout_mem.second->get_data_handle());
     }
   }
@@ -300,8 +298,10 @@ void DNNLQuantizedRnnOp::Forward(const OpContext& op_ctx,
         src, src_state, src_state_cell, dst, dst_state, dst_state_cell, data_dtype);
   } else {
     CHECK_EQ(fwd_inf_vec_.size(), dst_.size() + 1) << "Output memory error.";
-    size_t cell_bytes = (default_param.bidirectional + 1) * default_param.batch_size_ *
-                        default_param.state_size * mshadow::mshadow_sizeof(data_dtype);
+    size_t state_bytes = (default_param.bidirectional + 1) * default_param.batch_size_ * iter_size *
+                         mshadow::mshadow_sizeof(data_dtype);
+    size_t cell_bytes  = (default_param.bidirectional + 1) * default_param.batch_size_ *
+                        state_size * mshadow::mshadow_sizeof(data_dtype);
 
     // Set input data memory for the first layer. This stores intermediate
     // output results in this->xxx, used as the source input of the next layer.
@@ -314,11 +314,11 @@ void DNNLQuantizedRnnOp::Forward(const OpContext& op_ctx,
                                        data_dtype);
     // 1st_lyr -> dst_handle -> next_lyr -> dst_handle -> next_lyr -> ...
     for (size_t lyr = 1; lyr < fwd_inf_vec_.size() - 1; ++lyr) {
-      src_state += cell_bytes;
+      src_state += state_bytes;
       if (src_state_cell)
         src_state_cell += cell_bytes;
       if (dst_state)
-        dst_state += cell_bytes;
+        dst_state += state_bytes;
       if (dst_state_cell)
         dst_state_cell += cell_bytes;
       fwd_inf_vec_.at(lyr).SetNewDataMem(this->dst_.at(lyr - 1)->get_data_handle(),
@@ -330,11 +330,11 @@ void DNNLQuantizedRnnOp::Forward(const OpContext& op_ctx,
                                          data_dtype);
     }
     // Set output data memory for the last layer.
-    src_state += cell_bytes;
+    src_state += state_bytes;
     if (src_state_cell)
       src_state_cell += cell_bytes;
     if (dst_state)
-      dst_state += cell_bytes;
+      dst_state += state_bytes;
     if (dst_state_cell)
       dst_state_cell += cell_bytes;
     fwd_inf_vec_.back().SetNewDataMem(this->dst_.back()->get_data_handle(),
@@ -138,6 +138,31 @@ MSHADOW_XINLINE float FloatForOneQuantizedLevel(float range_min, float range_max
   return range_data / range_T;
 }
 
+/*!
+ * \brief Stores v as int8 in the symmetric range [-threshold, threshold], a float output keeps v.
+ */
+MSHADOW_XINLINE void StoreSymmetricQuantized(int8_t* out, float v, float threshold) {
+  *out = threshold > 0.f ? FloatToQuantized<int8_t>(v, -threshold, threshold) : 0;
+}
+
+MSHADOW_XINLINE void StoreSymmetricQuantized(float* out, float v, float threshold) {
+  *out = v;
+}
+
+/*!
+ * \brief Writes the range [-threshold, threshold] of an output stored by StoreSymmetricQuantized.
+ */
+struct quantized_symmetric_range {
+  MSHADOW_XINLINE static void Map(int i, float* out_min, float* out_max, const float threshold) {
+    *out_min = -threshold;
+    *out_max = threshold;
+  }
+  MSHADOW_XINLINE static void Map(int i, float* out_min, float* out_max, const float* threshold) {
+    *out_min = -*threshold;
+    *out_max = *threshold;
+  }
+};
+
 template <typename TA, typename TB, typename TC>
 MSHADOW_XINLINE void QuantizationRangeForMultiplication(float min_a,
                                                         float max_a,
@@ -182,6 +207,71 @@ struct QuantizationRangeForS8U8MultiplicationStruct {
   }
 };
 
+/*!
+ * \brief Symmetric range covering the per output channel ranges of a weight.
+ */
+struct QuantizationWidestRangeStruct {
+  MSHADOW_XINLINE static void Map(int i,
+                                  float* min_range,
+                                  float* max_range,
+                                  const float* min_ranges,
+                                  const float* max_ranges,
+                                  const int num_ranges) {
+    float range = 0.f;
+    for (int c = 0; c < num_ranges; ++c)
+      range = Max(range, MaxAbs(min_ranges[c], max_ranges[c]));
+    *min_range = -range;
+    *max_range = range;
+  }
+};
+
+/*!
+ * \brief int32 output of the channel c of a quantized convolution or fully connected layer from
+ *        its accumulator. With per output channel weight ranges, the accumulator is rescaled from
+ *        the range of the weights of the channel to the widest one, which the output range is
+ *        computed from. The bias, if any, is added in the output scale.
+ */
+MSHADOW_XINLINE int32_t QuantizedOutputEpilogue(float acc,
+                                                const int c,
+                                                const int8_t* bias,
+                                                const float* min_out,
+                                                const float* max_out,
+                                                const float* min_bias,
+                                                const float* max_bias,
+                                                const float* min_weight,
+                                                const float* max_weight,
+                                                const int num_weight_ranges,
+                                                const float* widest_weight_range) {
+  using mshadow::red::limits::MaxValue;
+  if (num_weight_ranges > 1) {
+    const float widest = *widest_weight_range;
+    acc *= widest > 0.f ? MaxAbs(min_weight[c], max_weight[c]) / widest : 0.f;
+  }
+  if (bias != nullptr) {
+    const float float_for_one_out_quant =
+        MaxAbs(*min_out, *max_out) / static_cast<double>(MaxValue<int32_t>());
+    const float float_for_one_bias_quant =
+        MaxAbs(*min_bias, *max_bias) / static_cast<double>(MaxValue<int8_t>());
+    acc += bias[c] * float_for_one_bias_quant / float_for_one_out_quant;
+  }
+  return static_cast<int32_t>(acc < 0.f ? acc - 0.5f : acc + 0.5f);
+}
+
+/*!
+ * \brief Checks the shape of the min/max range input i of a quantized layer, (1,) or, for the
+ *        weight ranges, one value per output channel.
+ */
+inline void QuantizedRangeShapeAssign(mxnet::ShapeVector* in_shape,
+                                      const size_t i,
+                                      const bool weight_range,
+                                      const index_t num_channels) {
+  const mxnet::TShape& shape = (*in_shape)[i];
+  if (weight_range && mxnet::shape_is_known(shape) && shape.ndim() == 1 &&
+      shape[0] == num_channels)
+    return;
+  SHAPE_ASSIGN_CHECK(*in_shape, i, mxnet::TShape(1, 1));
+}
+
 template <typename xpu, typename DType>
 inline size_t ConfigReduce(mshadow::Stream<xpu>* s,
                            const mxnet::TShape& data_shape,
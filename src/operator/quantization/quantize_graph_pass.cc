@@ -297,11 +297,6 @@ Graph QuantizeGraph(Graph&& src) {
   const auto quantize_granularity = src.GetAttr<std::string>("quantize_granularity");
   const auto dev_type             = src.GetAttr<int>("target_ctx");
 
-  if (dev_type == Context::kGPU && quantize_granularity == "channel-wise") {
-    LOG(FATAL) << "`channel-wise` quantization option is not supported yet by GPU,"
-               << " please set quantize_granularity to `tensor-wise` when quantizing model.";
-  }
-
   std::unordered_map<ObjectPtr, ObjectPtr> quantized_node_map;
   MarkQuantizedNodes(src, &quantized_node_map);
 
@@ -126,6 +126,68 @@ struct quantize_v2_zero_centered {
   }
 };
 
+// scale and rounding of QuantizeV2Dynamic, the same as the ones of the calibrated kernels above
+MSHADOW_XINLINE float QuantizeV2DynamicScale(int8_t*, const float data_min, const float data_max) {
+  const float real_range = MaxAbs(data_min, data_max);
+  return real_range > 0.f ? MinAbs(MaxValue<int8_t>(), MinValue<int8_t>()) / real_range : 0.f;
+}
+
+MSHADOW_XINLINE float QuantizeV2DynamicScale(uint8_t*, const float data_min, const float data_max) {
+  return data_max > data_min ? MaxValue<uint8_t>() / (data_max - data_min) : 0.f;
+}
+
+MSHADOW_XINLINE void QuantizeV2DynamicStore(int8_t* out,
+                                            const float x,
+                                            const float data_min,
+                                            const float scale) {
+  *out = static_cast<int8_t>(Sign(x) * Min(Abs(x) * scale + 0.5f, 127.f));
+}
+
+MSHADOW_XINLINE void QuantizeV2DynamicStore(uint8_t* out,
+                                            const float x,
+                                            const float data_min,
+                                            const float scale) {
+  *out = static_cast<uint8_t>((x - data_min) * scale + 0.5f);
+}
+
+MSHADOW_XINLINE void QuantizeV2DynamicRange(int8_t*,
+                                            const float data_min,
+                                            const float data_max,
+                                            float* omin_range,
+                                            float* omax_range) {
+  const float real_range = MaxAbs(data_min, data_max);
+  *omin_range            = -real_range;
+  *omax_range            = real_range;
+}
+
+MSHADOW_XINLINE void QuantizeV2DynamicRange(uint8_t*,
+                                            const float data_min,
+                                            const float data_max,
+                                            float* omin_range,
+                                            float* omax_range) {
+  *omin_range = data_min;
+  *omax_range = data_max;
+}
+
+/*!
+ * \brief Quantizes float data with its own range, to int8 zero-centered or to uint8. The minimum
+ *        and the maximum are found together in one pass over the data, which the quantization
+ *        reads again right after, instead of two reductions and a quantization.
+ */
+void QuantizeV2Dynamic(mshadow::Stream<cpu>* s,
+                       const OpContext& ctx,
+                       const TBlob& in,
+                       const TBlob& out,
+                       float* omin_range,
+                       float* omax_range);
+
+void QuantizeV2Dynamic(mshadow::Stream<gpu>* s,
+                       const OpContext& ctx,
+                       const TBlob& in,
+                       const TBlob& out,
+                       float* omin_range,
+                       float* omax_range);
+
 static inline bool QuantizeV2Shape(const nnvm::NodeAttrs& attrs,
                                    std::vector<TShape>* in_attrs,
                                    std::vector<TShape>* out_attrs) {
@@ -242,67 +304,11 @@ class QuantizeV2Operator {
           LOG(FATAL) << "quantize op only supports int8 and uint8 as output type";
         }
       } else {  // model is not calibrated
-        mxnet::TShape src_shape, dst_shape;
-        const size_t actual_float_size = sizeof(float);
-        const size_t temp_reduce_size  = ConfigReduce<xpu, SrcDType>(
-            s, inputs[0].shape_, mxnet::TShape(1, 1), &src_shape, &dst_shape);
-        Tensor<xpu, 1, char> temp_space = ctx.requested[0].get_space_typed<xpu, 1, char>(
-            Shape1(2 * actual_float_size + temp_reduce_size), s);
-        const int dev_id = ctx.run_ctx.ctx.dev_id;
-        TBlob in_min_t(
-            reinterpret_cast<SrcDType*>(temp_space.dptr_), Shape1(1), xpu::kDevMask, dev_id);
-        TBlob in_max_t(
-            reinterpret_cast<SrcDType*>(temp_space.dptr_) + 1, Shape1(1), xpu::kDevMask, dev_id);
-        Tensor<xpu, 1, char> workspace(
-            temp_space.dptr_ + 2 * actual_float_size, Shape1(temp_reduce_size), s);
-#if !defined(__CUDACC__)
-        broadcast::Reduce<red::minimum, 2, SrcDType, mshadow::op::identity>(
-            s, in_min_t.reshape(dst_shape), kWriteTo, workspace, inputs[0].reshape(src_shape));
-        broadcast::Reduce<red::maximum, 2, SrcDType, mshadow::op::identity>(
-            s, in_max_t.reshape(dst_shape), kWriteTo, workspace, inputs[0].reshape(src_shape));
-#else
-        broadcast::RTCReduce(ctx,
-                             in_min_t.reshape(dst_shape),
-                             kWriteTo,
-                             workspace,
-                             inputs[0].reshape(src_shape),
-                             "red::minimum{}",
-                             2,
-                             "identity");
-        broadcast::RTCReduce(ctx,
-                             in_max_t.reshape(dst_shape),
-                             kWriteTo,
-                             workspace,
-                             inputs[0].reshape(src_shape),
-                             "red::maximum{}",
-                             2,
-                             "identity");
-#endif
-        if (out_type == mshadow::kUint8) {
-          Kernel<quantize_v2_unsigned, xpu>::Launch(s,
-                                                    outputs[0].Size(),
-                                                    outputs[0].dptr<uint8_t>(),
-                                                    outputs[1].dptr<float>(),
-                                                    outputs[2].dptr<float>(),
-                                                    inputs[0].dptr<SrcDType>(),
-                                                    in_min_t.dptr<float>(),
-                                                    in_max_t.dptr<float>(),
-                                                    MinValue<uint8_t>(),
-                                                    MaxValue<uint8_t>());
-        } else if (out_type == mshadow::kInt8) {  // zero-centered quantization
-          Kernel<quantize_v2_zero_centered, xpu>::Launch(
-              s,
-              outputs[0].Size(),
-              outputs[0].dptr<int8_t>(),
-              outputs[1].dptr<float>(),
-              outputs[2].dptr<float>(),
-              inputs[0].dptr<SrcDType>(),
-              in_min_t.dptr<float>(),
-              in_max_t.dptr<float>(),
-              MinAbs(MaxValue<int8_t>(), MinValue<int8_t>()));
-        } else {
+        if (out_type != mshadow::kUint8 && out_type != mshadow::kInt8) {
           LOG(FATAL) << "quantize op only supports int8 and uint8 as output type";
         }
+        QuantizeV2Dynamic(
+            s, ctx, inputs[0], outputs[0], outputs[1].dptr<float>(), outputs[2].dptr<float>());
       }
     }
   }
@@ -22,6 +22,8 @@
  * \brief
  */
 
+#include <algorithm>
+#include <vector>
 #include "./quantize_v2-inl.h"
 #if MXNET_USE_ONEDNN == 1
 #include "./dnnl/dnnl_quantize_v2-inl.h"
@@ -31,6 +33,63 @@ namespace mxnet {
 namespace op {
 DMLC_REGISTER_PARAMETER(QuantizeV2Param);
 
+template <typename DstDType>
+static void QuantizeV2DynamicCPU(const float* data,
+                                 const index_t n,
+                                 DstDType* out,
+                                 float* omin_range,
+                                 float* omax_range) {
+  const int nthreads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  std::vector<float> mins(nthreads), maxs(nthreads);
+  // every thread finds the range of its chunk, then quantizes the same chunk, still in its cache
+  // for activations of usual sizes
+#pragma omp parallel num_threads(nthreads)
+  {
+    const int tid       = omp_get_thread_num();
+    const int nt        = omp_get_num_threads();
+    const index_t chunk = (n + nt - 1) / nt;
+    const index_t begin = std::min(n, tid * chunk);
+    const index_t end   = std::min(n, begin + chunk);
+    float lo            = MaxValue<float>();
+    float hi            = MinValue<float>();
+    for (index_t i = begin; i < end; ++i) {
+      const float v = data[i];
+      lo            = v < lo ? v : lo;
+      hi            = v > hi ? v : hi;
+    }
+    mins[tid] = lo;
+    maxs[tid] = hi;
+#pragma omp barrier
+    float data_min = mins[0];
+    float data_max = maxs[0];
+    for (int t = 1; t < nt; ++t) {
+      data_min = std::min(data_min, mins[t]);
+      data_max = std::max(data_max, maxs[t]);
+    }
+    const float scale = QuantizeV2DynamicScale(out, data_min, data_max);
+    for (index_t i = begin; i < end; ++i) {
+      QuantizeV2DynamicStore(out + i, data[i], data_min, scale);
+    }
+    if (tid == 0) {
+      QuantizeV2DynamicRange(out, data_min, data_max, omin_range, omax_range);
+    }
+  }
+}
+
+void QuantizeV2Dynamic(mshadow::Stream<cpu>* s,
+                       const OpContext& ctx,
+                       const TBlob& in,
+                       const TBlob& out,
+                       float* omin_range,
+                       float* omax_range) {
+  if (out.type_flag_ == mshadow::kUint8) {
+    QuantizeV2DynamicCPU(
+        in.dptr<float>(), in.Size(), out.dptr<uint8_t>(), omin_range, omax_range);
+  } else {
+    QuantizeV2DynamicCPU(in.dptr<float>(), in.Size(), out.dptr<int8_t>(), omin_range, omax_range);
+  }
+}
+
 static bool QuantizeV2StorageType(const nnvm::NodeAttrs& attrs,
                                   const int dev_mask,
                                   DispatchMode* dispatch_mode,
@@ -22,10 +22,89 @@
  * \brief
  */
 #include "./quantize_v2-inl.h"
+#include "../../common/cuda/utils.h"
 
 namespace mxnet {
 namespace op {
 
+constexpr int kQuantizeDynamicThreads = 256;
+// the quantization kernel reduces the partial ranges with one value per thread
+constexpr int kQuantizeDynamicMaxBlocks = kQuantizeDynamicThreads;
+
+// each block writes the minimum and the maximum of its part of the data
+__global__ void QuantizeV2RangeKernel(const float* data, const index_t n, float* partial) {
+  float lo = MaxValue<float>();
+  float hi = MinValue<float>();
+  for (index_t i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += static_cast<index_t>(gridDim.x) * blockDim.x) {
+    const float v = data[i];
+    lo            = fminf(lo, v);
+    hi            = fmaxf(hi, v);
+  }
+  lo = common::cuda::reduce<kQuantizeDynamicThreads, false>(
+      lo, [](float a, float b) { return fminf(a, b); });
+  hi = common::cuda::reduce<kQuantizeDynamicThreads, false>(
+      hi, [](float a, float b) { return fmaxf(a, b); });
+  if (threadIdx.x == 0) {
+    partial[2 * blockIdx.x]     = lo;
+    partial[2 * blockIdx.x + 1] = hi;
+  }
+}
+
+// every block combines the partial ranges before quantizing its part of the data
+template <typename DstDType>
+__global__ void QuantizeV2DynamicKernel(const float* data,
+                                        const index_t n,
+                                        DstDType* out,
+                                        const float* partial,
+                                        const int num_partials,
+                                        float* omin_range,
+                                        float* omax_range) {
+  const bool has_partial = threadIdx.x < num_partials;
+  const float data_min   = common::cuda::reduce<kQuantizeDynamicThreads>(
+      has_partial ? partial[2 * threadIdx.x] : MaxValue<float>(),
+      [](float a, float b) { return fminf(a, b); });
+  const float data_max = common::cuda::reduce<kQuantizeDynamicThreads>(
+      has_partial ? partial[2 * threadIdx.x + 1] : MinValue<float>(),
+      [](float a, float b) { return fmaxf(a, b); });
+  const float scale = QuantizeV2DynamicScale(out, data_min, data_max);
+  for (index_t i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += static_cast<index_t>(gridDim.x) * blockDim.x) {
+    QuantizeV2DynamicStore(out + i, data[i], data_min, scale);
+  }
+  if (blockIdx.x == 0 && threadIdx.x == 0) {
+    QuantizeV2DynamicRange(out, data_min, data_max, omin_range, omax_range);
+  }
+}
+
+void QuantizeV2Dynamic(mshadow::Stream<gpu>* s,
+                       const OpContext& ctx,
+                       const TBlob& in,
+                       const TBlob& out,
+                       float* omin_range,
+                       float* omax_range) {
+  cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
+  const index_t n     = in.Size();
+  const int nblocks   = std::max<index_t>(
+      1,
+      std::min<index_t>(kQuantizeDynamicMaxBlocks,
+                        (n + kQuantizeDynamicThreads - 1) / kQuantizeDynamicThreads));
+  float* partial = ctx.requested[0]
+                       .get_space_typed<gpu, 1, float>(mshadow::Shape1(2 * nblocks), s)
+                       .dptr_;
+  QuantizeV2RangeKernel<<<nblocks, kQuantizeDynamicThreads, 0, stream>>>(
+      in.dptr<float>(), n, partial);
+  MSHADOW_CUDA_POST_KERNEL_CHECK(QuantizeV2RangeKernel);
+  if (out.type_flag_ == mshadow::kUint8) {
+    QuantizeV2DynamicKernel<<<nblocks, kQuantizeDynamicThreads, 0, stream>>>(
+        in.dptr<float>(), n, out.dptr<uint8_t>(), partial, nblocks, omin_range, omax_range);
+  } else {
+    QuantizeV2DynamicKernel<<<nblocks, kQuantizeDynamicThreads, 0, stream>>>(
+        in.dptr<float>(), n, out.dptr<int8_t>(), partial, nblocks, omin_range, omax_range);
+  }
+  MSHADOW_CUDA_POST_KERNEL_CHECK(QuantizeV2DynamicKernel);
+}
+
 NNVM_REGISTER_OP(_contrib_quantize_v2)
     .set_attr<FStatefulCompute>("FStatefulCompute<gpu>", QuantizeV2Forward<gpu>);
 
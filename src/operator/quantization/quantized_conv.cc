@@ -23,6 +23,7 @@
  * \author Ziheng Jiang, Jun Wu
  */
 #include "../nn/convolution-inl.h"
+#include "./quantization_utils.h"
 
 namespace mxnet {
 namespace op {
@@ -121,7 +122,8 @@ bool QuantizedConvShape(const nnvm::NodeAttrs& attrs,
   const int start = param.no_bias ? 2 : 3;
   const int end   = param.no_bias ? 6 : 9;
   for (int i = start; i < end; ++i) {
-    SHAPE_ASSIGN_CHECK(*in_shape, i, mxnet::TShape{1});
+    const bool weight_range = i == start + 2 || i == start + 3;
+    QuantizedRangeShapeAssign(in_shape, i, weight_range, param.num_filter);
   }
   if (!param.no_bias) {
     SHAPE_ASSIGN_CHECK(*in_shape, 2, Shape1(param.num_filter));
@@ -29,26 +29,37 @@
 namespace mxnet {
 namespace op {
 
-// value + bias_value * (range1 / limit_range1) * (limit_range2 / range2)
-struct QuantizedBiasAddKernel {
-  MSHADOW_XINLINE static void Map(int i,
-                                  size_t bias_size,
+// casts the NHWC float output of cuDNN to the int32 NCHW output, with the per channel rescaling
+// of the weight ranges and the bias add folded in
+struct QuantizedConvEpilogueKernel {
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  const index_t channels,
+                                  const index_t spatial_size,
                                   int32_t* out,
+                                  const float* out_nhwc,
                                   const int8_t* bias,
                                   const float* min_out,
                                   const float* max_out,
                                   const float* min_bias,
                                   const float* max_bias,
-                                  const size_t spatial_size) {
-    using mshadow::red::limits::MaxValue;
-    using mshadow::red::limits::MinValue;
-    float float_for_one_out_quant =
-        MaxAbs(*min_out, *max_out) / static_cast<double>(MaxValue<int32_t>());
-    float float_for_one_bias_quant =
-        MaxAbs(*min_bias, *max_bias) / static_cast<double>(MaxValue<int8_t>());
-    const size_t channel_id = (i / spatial_size) % bias_size;
-    out[i] = (out[i] * float_for_one_out_quant + bias[channel_id] * float_for_one_bias_quant) /
-             float_for_one_out_quant;
+                                  const float* min_weight,
+                                  const float* max_weight,
+                                  const int num_weight_ranges,
+                                  const float* widest_weight_range) {
+    const index_t hw = i % spatial_size;
+    const index_t c  = (i / spatial_size) % channels;
+    const index_t n  = i / (spatial_size * channels);
+    out[i]           = QuantizedOutputEpilogue(out_nhwc[(n * spatial_size + hw) * channels + c],
+                                     c,
+                                     bias,
+                                     min_out,
+                                     max_out,
+                                     min_bias,
+                                     max_bias,
+                                     min_weight,
+                                     max_weight,
+                                     num_weight_ranges,
+                                     widest_weight_range);
   }
 };
 
@@ -124,11 +135,14 @@ class QuantizedCuDNNConvOp {
       const size_t data_size   = dshape.Size();
       const size_t weight_size = fshape.Size();
       const size_t output_size = oshape.Size();
-      size_t total_temp_bytes  = (workspace_ + data_size + weight_size) * sizeof(SrcType) +
-                                output_size * (sizeof(DstType) + sizeof(int32_t));
+      size_t total_temp_bytes  = 2 * sizeof(float) +
+                                (workspace_ + data_size + weight_size) * sizeof(SrcType) +
+                                output_size * sizeof(DstType);
       Tensor<gpu, 1, char> temp_space =
           ctx.requested[0].get_space_typed<gpu, 1, char>(mshadow::Shape1(total_temp_bytes), s);
       char* temp_dptr = temp_space.dptr_;
+      float* widest_weight_range = reinterpret_cast<float*>(temp_dptr);
+      temp_dptr += 2 * sizeof(float);
       TBlob data_(reinterpret_cast<SrcType*>(temp_dptr),
                   mxnet::TShape({dshape[N], dshape[H], dshape[W], dshape[C]}),
                   dev_mask,
@@ -152,12 +166,6 @@ class QuantizedCuDNNConvOp {
                  DataType<DstType>::kFlag,
                  dev_id);
       temp_dptr += output_size * sizeof(DstType);
-      TBlob out_tcast(reinterpret_cast<int32_t*>(temp_dptr),
-                      mxnet::TShape({oshape[N], oshape[H], oshape[W], oshape[C]}),
-                      dev_mask,
-                      DataType<int32_t>::kFlag,
-                      dev_id);
-      temp_dptr += output_size * sizeof(int32_t);
       // input:  [NHWC](batch, in_height, in_width, in_channels)
       // filter: [HWNC](out_channels, filter_height, filter_width, in_channels)
       // output: [NHWC](batch, out_height, out_width, out_channels)
@@ -176,46 +184,54 @@ class QuantizedCuDNNConvOp {
                                          out_desc_,
                                          out_.dptr_));
 
-      Tensor<gpu, 1, DstType> out_tensor       = out_.FlatTo1D<gpu, DstType>(s);
-      Tensor<gpu, 1, int32_t> out_tcast_tensor = out_tcast.FlatTo1D<gpu, int32_t>(s);
-      Assign(out_tcast_tensor, kWriteTo, mshadow::expr::tcast<int32_t>(out_tensor));
-      // output: [NHWC](batch, out_height, out_width, out_channels) => [NCHW]
-      TransposeImpl<gpu>(ctx.run_ctx, out_tcast, out, mxnet::TShape({0, 3, 1, 2}));
+      // calculate the min/max range for out_data as it's a multiplication
+      // of in_data[0] and in_data[1]. Need to rescale the min/max range of out_data
+      // based on the min/max ranges of in_data[0] and in_data[1]. With one weight range
+      // per output channel, the output range is the one of the widest channel.
+      const size_t num_inputs     = param_.no_bias ? 2 : 3;
+      const int num_weight_ranges = in_data[num_inputs + 2].Size();
+      const float* min_weight     = in_data[num_inputs + 2].dptr<float>();
+      const float* max_weight     = in_data[num_inputs + 3].dptr<float>();
+      if (num_weight_ranges > 1) {
+        mxnet_op::Kernel<QuantizationWidestRangeStruct, gpu>::Launch(s,
+                                                                     1,
+                                                                     widest_weight_range,
+                                                                     widest_weight_range + 1,
+                                                                     min_weight,
+                                                                     max_weight,
+                                                                     num_weight_ranges);
+      }
+      mxnet_op::Kernel<QuantizationRangeForS8S8MultiplicationStruct, gpu>::Launch(
+          s,
+          1,
+          out_data[1].dptr<float>(),
+          out_data[2].dptr<float>(),
+          in_data[num_inputs].dptr<float>(),
+          in_data[num_inputs + 1].dptr<float>(),
+          num_weight_ranges > 1 ? widest_weight_range : min_weight,
+          num_weight_ranges > 1 ? widest_weight_range + 1 : max_weight);
+
+      // output: [NHWC](batch, out_height, out_width, out_channels) => [NCHW] int32, rescaled
+      // and with the bias in the same pass
+      mxnet_op::Kernel<QuantizedConvEpilogueKernel, gpu>::Launch(
+          s,
+          output_size,
+          oshape[C],
+          oshape[H] * oshape[W],
+          out.dptr<int32_t>(),
+          out_.dptr<DstType>(),
+          param_.no_bias ? nullptr : in_data[2].dptr<int8_t>(),
+          out_data[1].dptr<float>(),
+          out_data[2].dptr<float>(),
+          param_.no_bias ? nullptr : in_data[7].dptr<float>(),
+          param_.no_bias ? nullptr : in_data[8].dptr<float>(),
+          min_weight,
+          max_weight,
+          num_weight_ranges,
+          widest_weight_range + 1);
     } else {
       LOG(FATAL) << "quantized_conv only supports NCHW for now";
     }
-
-    // calculate the min/max range for out_data as it's a multiplication
-    // of in_data[0] and in_data[1]. Need to rescale the min/max range of out_data
-    // based on the min/max ranges of in_data[0] and in_data[1].
-    const size_t num_inputs = param_.no_bias ? 2 : 3;
-    mxnet_op::Kernel<QuantizationRangeForS8S8MultiplicationStruct, gpu>::Launch(
-        s,
-        1,
-        out_data[1].dptr<float>(),
-        out_data[2].dptr<float>(),
-        in_data[num_inputs].dptr<float>(),
-        in_data[num_inputs + 1].dptr<float>(),
-        in_data[num_inputs + 2].dptr<float>(),
-        in_data[num_inputs + 3].dptr<float>());
-
-    if (!param_.no_bias) {
-      if (param_.layout.has_value()) {
-        CHECK_EQ(param_.layout.value(), mshadow::kNCHW)
-            << "quantized_conv only supports NCHW when there is a bias";
-      }
-      const TBlob& bias = in_data[2];
-      mxnet_op::Kernel<QuantizedBiasAddKernel, gpu>::Launch(s,
-                                                            out.Size(),
-                                                            bias.Size(),
-                                                            out.dptr<int32_t>(),
-                                                            bias.dptr<int8_t>(),
-                                                            out_data[1].dptr<float>(),
-                                                            out_data[2].dptr<float>(),
-                                                            in_data[7].dptr<float>(),
-                                                            in_data[8].dptr<float>(),
-                                                            oshape[2] * oshape[3]);
-    }
   }
 
   void InitDescriptors(const mxnet::ShapeVector& in_shape, const mxnet::ShapeVector& out_shape) {
@@ -66,7 +66,8 @@ bool QuantizedFullyConnectedShape(const nnvm::NodeAttrs& attrs,
   }
 
   for (size_t i = num_inputs; i < 3 * num_inputs; ++i) {
-    SHAPE_ASSIGN_CHECK(*in_shape, i, mxnet::TShape(1, 1));
+    const bool weight_range = i == num_inputs + 2 || i == num_inputs + 3;
+    QuantizedRangeShapeAssign(in_shape, i, weight_range, param.num_hidden);
   }
 
   if (!param.flatten) {
@@ -186,6 +187,8 @@ void QuantizedFullyConnectedForwardCPU(const nnvm::NodeAttrs& attrs,
   size_t num_inputs = param.no_bias ? 2 : 3;
   CHECK_EQ(in_data.size(), num_inputs * 3);
   CHECK_EQ(out_data.size(), 3U);
+  CHECK_EQ(in_data[num_inputs + 2].Size(), 1U)
+      << "QuantizedFullyConnectedForwardCPU does not support per output channel weight ranges";
 
   const mxnet::TShape& dshape = in_data[fullc::kData].shape_;
   const mxnet::TShape& wshape = in_data[fullc::kWeight].shape_;
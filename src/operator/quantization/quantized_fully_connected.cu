@@ -30,26 +30,30 @@ namespace mxnet {
 namespace op {
 
 #if CUDA_VERSION >= 8000
-// value + bias_value * (range1 / limit_range1) * (limit_range2 / range2)
-struct QuantizedBiasAddKernel {
+struct QuantizedFCEpilogueKernel {
   MSHADOW_XINLINE static void Map(int i,
-                                  size_t k,
+                                  int k,
                                   int32_t* out,
                                   const int8_t* bias,
                                   const float* min_out,
                                   const float* max_out,
                                   const float* min_bias,
-                                  const float* max_bias) {
-    typedef int32_t T1;
-    typedef int8_t T2;
-    using mshadow::red::limits::MaxValue;
-    using mshadow::red::limits::MinValue;
-    float float_for_one_out_quant =
-        MaxAbs(*min_out, *max_out) / static_cast<double>(MaxValue<T1>());
-    float float_for_one_bias_quant =
-        MaxAbs(*min_bias, *max_bias) / static_cast<double>(MaxValue<T2>());
-    out[i] = (out[i] * float_for_one_out_quant + bias[i % k] * float_for_one_bias_quant) /
-             float_for_one_out_quant;
+                                  const float* max_bias,
+                                  const float* min_weight,
+                                  const float* max_weight,
+                                  const int num_weight_ranges,
+                                  const float* widest_weight_range) {
+    out[i] = QuantizedOutputEpilogue(out[i],
+                                     i % k,
+                                     bias,
+                                     min_out,
+                                     max_out,
+                                     min_bias,
+                                     max_bias,
+                                     min_weight,
+                                     max_weight,
+                                     num_weight_ranges,
+                                     widest_weight_range);
   }
 };
 #endif  // CUDA_VERSION >= 8000
@@ -110,6 +114,21 @@ void QuantizedFullyConnectedForwardGPU(const nnvm::NodeAttrs& attrs,
                            cmp_type,
                            CUBLAS_GEMM_DFALT));
 
+  // the weight can have one range per output channel, the output range is the one of the widest
+  const int num_weight_ranges = inputs[num_inputs + 2].Size();
+  const float* min_weight     = inputs[num_inputs + 2].dptr<float>();
+  const float* max_weight     = inputs[num_inputs + 3].dptr<float>();
+  Tensor<gpu, 1, float> widest_weight_range =
+      ctx.requested[0].get_space_typed<gpu, 1, float>(Shape1(2), s);
+  if (num_weight_ranges > 1) {
+    Kernel<QuantizationWidestRangeStruct, gpu>::Launch(s,
+                                                       1,
+                                                       widest_weight_range.dptr_,
+                                                       widest_weight_range.dptr_ + 1,
+                                                       min_weight,
+                                                       max_weight,
+                                                       num_weight_ranges);
+  }
   Kernel<QuantizationRangeForS8S8MultiplicationStruct, gpu>::Launch(
       s,
       1,
@@ -117,20 +136,25 @@ void QuantizedFullyConnectedForwardGPU(const nnvm::NodeAttrs& attrs,
       outputs[2].dptr<float>(),
       inputs[num_inputs].dptr<float>(),
       inputs[num_inputs + 1].dptr<float>(),
-      inputs[num_inputs + 2].dptr<float>(),
-      inputs[num_inputs + 3].dptr<float>());
+      num_weight_ranges > 1 ? widest_weight_range.dptr_ : min_weight,
+      num_weight_ranges > 1 ? widest_weight_range.dptr_ + 1 : max_weight);
 
-  if (!param.no_bias) {
-    const TBlob& bias = inputs[2];
-    Kernel<QuantizedBiasAddKernel, gpu>::Launch(s,
-                                                out.Size(),
-                                                k,
-                                                out.dptr<int32_t>(),
-                                                bias.dptr<int8_t>(),
-                                                outputs[1].dptr<float>(),
-                                                outputs[2].dptr<float>(),
-                                                inputs[7].dptr<float>(),
-                                                inputs[8].dptr<float>());
+  // per channel rescaling and bias in a single pass over the output
+  if (!param.no_bias || num_weight_ranges > 1) {
+    Kernel<QuantizedFCEpilogueKernel, gpu>::Launch(
+        s,
+        out.Size(),
+        k,
+        out.dptr<int32_t>(),
+        param.no_bias ? nullptr : inputs[2].dptr<int8_t>(),
+        outputs[1].dptr<float>(),
+        outputs[2].dptr<float>(),
+        param.no_bias ? nullptr : inputs[7].dptr<float>(),
+        param.no_bias ? nullptr : inputs[8].dptr<float>(),
+        min_weight,
+        max_weight,
+        num_weight_ranges,
+        widest_weight_range.dptr_ + 1);
   }
 #else
   LOG(FATAL) << "QuantizedFullyConnectedForwardGPU only supports CUDA >= 8.0";
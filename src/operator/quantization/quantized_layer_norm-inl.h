@@ -0,0 +1,213 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file quantized_layer_norm-inl.h
+ * \brief Layer normalization over the last axis of int8/uint8 data
+ */
+#ifndef MXNET_OPERATOR_QUANTIZATION_QUANTIZED_LAYER_NORM_INL_H_
+#define MXNET_OPERATOR_QUANTIZATION_QUANTIZED_LAYER_NORM_INL_H_
+
+#include <mxnet/operator_util.h>
+#include <cmath>
+#include <vector>
+#include "../mxnet_op.h"
+#include "../mshadow_op.h"
+#include "../operator_common.h"
+#include "../tensor/broadcast_reduce_op.h"
+#include "./quantization_utils.h"
+
+namespace mxnet {
+namespace op {
+
+namespace qlayernorm {
+enum QuantizedLayerNormInputs { kData, kGamma, kBeta, kMinData, kMaxData };
+enum QuantizedLayerNormOutputs { kOut, kMin, kMax };
+}  // namespace qlayernorm
+
+struct QuantizedLayerNormParam : public dmlc::Parameter<QuantizedLayerNormParam> {
+  int axis;
+  float eps;
+  bool output_mean_var;
+  dmlc::optional<float> min_calib_range;
+  dmlc::optional<float> max_calib_range;
+  dmlc::optional<int> enabled_float_output;
+  DMLC_DECLARE_PARAMETER(QuantizedLayerNormParam) {
+    DMLC_DECLARE_FIELD(axis).set_default(-1).describe(
+        "The axis to perform layer normalization, only the last axis is supported.");
+    DMLC_DECLARE_FIELD(eps).set_default(1e-5f).describe(
+        "An `epsilon` parameter to prevent division by 0.");
+    DMLC_DECLARE_FIELD(output_mean_var)
+        .set_default(false)
+        .describe("Output the mean and std, not supported by the quantized operator.");
+    DMLC_DECLARE_FIELD(min_calib_range)
+        .set_default(dmlc::optional<float>())
+        .describe(
+            "The minimum scalar value in the form of float32 obtained "
+            "through calibration. If present, it will be used to quantize the output. "
+            "Otherwise the output range is found at runtime.");
+    DMLC_DECLARE_FIELD(max_calib_range)
+        .set_default(dmlc::optional<float>())
+        .describe(
+            "The maximum scalar value in the form of float32 obtained "
+            "through calibration. If present, it will be used to quantize the output. "
+            "Otherwise the output range is found at runtime.");
+    DMLC_DECLARE_FIELD(enabled_float_output)
+        .set_default(dmlc::optional<int>())
+        .add_enum("float32", mshadow::kFloat32)
+        .describe("Write the output in float32 instead of int8, set when a dequantize is fused.");
+  }
+};
+
+/*!
+ * \brief Normalizes one row of quantized data per work item. The moments are computed on the
+ *        integer levels, which is exact, and scaled to float once.
+ */
+template <typename SrcType>
+struct quantized_layer_norm_fwd {
+  template <typename OType>
+  MSHADOW_XINLINE static void Map(int row,
+                                  OType* out,
+                                  const SrcType* data,
+                                  const float* gamma,
+                                  const float* beta,
+                                  const float* min_data,
+                                  const float* max_data,
+                                  const index_t axis_size,
+                                  const float eps,
+                                  const float out_threshold) {
+    const float in_scale = FloatForOneQuantizedLevel<SrcType>(*min_data, *max_data, false);
+    const SrcType* x     = data + static_cast<index_t>(row) * axis_size;
+    OType* y             = out + static_cast<index_t>(row) * axis_size;
+    int64_t sum = 0, sum_sq = 0;
+    for (index_t j = 0; j < axis_size; ++j) {
+      const int64_t q = x[j];
+      sum += q;
+      sum_sq += q * q;
+    }
+    const double mean_q = static_cast<double>(sum) / axis_size;
+    const double var_q  = static_cast<double>(sum_sq) / axis_size - mean_q * mean_q;
+    const float mean    = static_cast<float>(mean_q) * in_scale;
+    const float rstd    = 1.f / math::sqrt(static_cast<float>(var_q) * in_scale * in_scale + eps);
+    for (index_t j = 0; j < axis_size; ++j) {
+      const float v = (static_cast<float>(x[j]) * in_scale - mean) * rstd * gamma[j] + beta[j];
+      StoreSymmetricQuantized(y + j, v, out_threshold);
+    }
+  }
+};
+
+/*! \brief Quantizes float data with a threshold computed on the device. */
+struct quantize_symmetric_by_threshold {
+  MSHADOW_XINLINE static void Map(int i, int8_t* out, const float* in, const float* threshold) {
+    StoreSymmetricQuantized(out + i, in[i], *threshold);
+  }
+};
+
+template <typename xpu, typename SrcType>
+void QuantizedLayerNormCompute(const QuantizedLayerNormParam& param,
+                               const OpContext& ctx,
+                               const std::vector<TBlob>& inputs,
+                               const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  Stream<xpu>* s          = ctx.get_stream<xpu>();
+  const TBlob& data       = inputs[qlayernorm::kData];
+  const index_t axis_size = data.shape_[data.ndim() - 1];
+  const index_t num_rows  = data.shape_.Size() / axis_size;
+  float* out_min          = outputs[qlayernorm::kMin].dptr<float>();
+  float* out_max          = outputs[qlayernorm::kMax].dptr<float>();
+  const bool calibrated = param.min_calib_range.has_value() && param.max_calib_range.has_value();
+  const float threshold =
+      calibrated ? MaxAbs(param.min_calib_range.value(), param.max_calib_range.value()) : 0.f;
+  auto launch = [&](auto* out) {
+    Kernel<quantized_layer_norm_fwd<SrcType>, xpu>::Launch(
+        s,
+        num_rows,
+        out,
+        data.dptr<SrcType>(),
+        inputs[qlayernorm::kGamma].dptr<float>(),
+        inputs[qlayernorm::kBeta].dptr<float>(),
+        inputs[qlayernorm::kMinData].dptr<float>(),
+        inputs[qlayernorm::kMaxData].dptr<float>(),
+        axis_size,
+        param.eps,
+        threshold);
+  };
+  if (param.enabled_float_output.has_value() || calibrated) {
+    if (param.enabled_float_output.has_value()) {
+      launch(outputs[qlayernorm::kOut].dptr<float>());
+    } else {
+      launch(outputs[qlayernorm::kOut].dptr<int8_t>());
+    }
+    Kernel<quantized_symmetric_range, xpu>::Launch(s, 1, out_min, out_max, threshold);
+    return;
+  }
+  // without a calibrated range normalize into float, then quantize with its absolute maximum
+  mxnet::TShape src_shape, dst_shape;
+  BroadcastReduceShapeCompact(data.shape_, mxnet::TShape(1, 1), &src_shape, &dst_shape);
+  const size_t float_bytes  = (data.shape_.Size() + 1) * sizeof(float);
+  const size_t reduce_bytes = broadcast::ReduceWorkspaceSize(s, dst_shape, kWriteTo, src_shape);
+  Tensor<xpu, 1, char> temp_space =
+      ctx.requested[0].get_space_typed<xpu, 1, char>(Shape1(float_bytes + reduce_bytes), s);
+  float* normalized = reinterpret_cast<float*>(temp_space.dptr_);
+  float* amax       = normalized + data.shape_.Size();
+  Tensor<xpu, 1, char> workspace(temp_space.dptr_ + float_bytes, Shape1(reduce_bytes), s);
+  launch(normalized);
+  TBlob normalized_blob(normalized, data.shape_, xpu::kDevMask, data.dev_id());
+  TBlob amax_blob(amax, Shape1(1), xpu::kDevMask, data.dev_id());
+#if !defined(__CUDACC__)
+  broadcast::Reduce<red::maximum, 2, float, mshadow_op::abs>(
+      s, amax_blob.reshape(dst_shape), kWriteTo, workspace, normalized_blob.reshape(src_shape));
+#else
+  broadcast::RTCReduce(ctx,
+                       amax_blob.reshape(dst_shape),
+                       kWriteTo,
+                       workspace,
+                       normalized_blob.reshape(src_shape),
+                       "red::maximum{}",
+                       2,
+                       "abs");
+#endif
+  Kernel<quantize_symmetric_by_threshold, xpu>::Launch(
+      s, data.shape_.Size(), outputs[qlayernorm::kOut].dptr<int8_t>(), normalized, amax);
+  Kernel<quantized_symmetric_range, xpu>::Launch(s, 1, out_min, out_max, amax);
+}
+
+template <typename xpu>
+void QuantizedLayerNormForward(const nnvm::NodeAttrs& attrs,
+                               const OpContext& ctx,
+                               const std::vector<TBlob>& inputs,
+                               const std::vector<OpReqType>& req,
+                               const std::vector<TBlob>& outputs) {
+  const QuantizedLayerNormParam& param = nnvm::get<QuantizedLayerNormParam>(attrs.parsed);
+  CHECK_EQ(inputs.size(), 5U);
+  CHECK_EQ(outputs.size(), 3U);
+  CHECK_EQ(req[qlayernorm::kOut], kWriteTo) << "_contrib_quantized_layer_norm only supports "
+                                            << "req=kWriteTo";
+  if (inputs[qlayernorm::kData].type_flag_ == mshadow::kUint8) {
+    QuantizedLayerNormCompute<xpu, uint8_t>(param, ctx, inputs, outputs);
+  } else {
+    QuantizedLayerNormCompute<xpu, int8_t>(param, ctx, inputs, outputs);
+  }
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_QUANTIZATION_QUANTIZED_LAYER_NORM_INL_H_
@@ -0,0 +1,151 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file quantized_layer_norm.cc
+ * \brief Layer normalization over the last axis of int8/uint8 data
+ */
+#include "./quantized_layer_norm-inl.h"
+#include "../nn/layer_norm-inl.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(QuantizedLayerNormParam);
+
+static bool QuantizedLayerNormShape(const nnvm::NodeAttrs& attrs,
+                                    mxnet::ShapeVector* in_shape,
+                                    mxnet::ShapeVector* out_shape) {
+  const QuantizedLayerNormParam& param = nnvm::get<QuantizedLayerNormParam>(attrs.parsed);
+  CHECK_EQ(in_shape->size(), 5U);
+  CHECK_EQ(out_shape->size(), 3U);
+  SHAPE_ASSIGN_CHECK(*in_shape, qlayernorm::kMinData, mxnet::TShape(1, 1));
+  SHAPE_ASSIGN_CHECK(*in_shape, qlayernorm::kMaxData, mxnet::TShape(1, 1));
+  SHAPE_ASSIGN_CHECK(*out_shape, qlayernorm::kMin, mxnet::TShape(1, 1));
+  SHAPE_ASSIGN_CHECK(*out_shape, qlayernorm::kMax, mxnet::TShape(1, 1));
+  const mxnet::TShape& dshape = (*in_shape)[qlayernorm::kData];
+  if (!mxnet::ndim_is_known(dshape))
+    return false;
+  const int axis = param.axis < 0 ? param.axis + dshape.ndim() : param.axis;
+  CHECK_EQ(axis, dshape.ndim() - 1)
+      << "_contrib_quantized_layer_norm only supports the last axis, while axis=" << param.axis;
+  CHECK(!param.output_mean_var) << "_contrib_quantized_layer_norm does not output mean and std";
+  SHAPE_ASSIGN_CHECK(*in_shape, qlayernorm::kGamma, mxnet::TShape(1, dshape[axis]));
+  SHAPE_ASSIGN_CHECK(*in_shape, qlayernorm::kBeta, mxnet::TShape(1, dshape[axis]));
+  SHAPE_ASSIGN_CHECK(*out_shape, qlayernorm::kOut, dshape);
+  return true;
+}
+
+static bool QuantizedLayerNormType(const nnvm::NodeAttrs& attrs,
+                                   std::vector<int>* in_type,
+                                   std::vector<int>* out_type) {
+  const QuantizedLayerNormParam& param = nnvm::get<QuantizedLayerNormParam>(attrs.parsed);
+  CHECK_EQ(in_type->size(), 5U);
+  CHECK_EQ(out_type->size(), 3U);
+  const int dtype = (*in_type)[qlayernorm::kData];
+  CHECK(dtype == -1 || dtype == mshadow::kInt8 || dtype == mshadow::kUint8)
+      << "_contrib_quantized_layer_norm only supports int8/uint8 input, while " << dtype
+      << " is given.";
+  for (size_t i = qlayernorm::kGamma; i < in_type->size(); ++i) {
+    TYPE_ASSIGN_CHECK(*in_type, i, mshadow::kFloat32);
+  }
+  TYPE_ASSIGN_CHECK(*out_type,
+                    qlayernorm::kOut,
+                    param.enabled_float_output.has_value() ? mshadow::kFloat32 : mshadow::kInt8);
+  TYPE_ASSIGN_CHECK(*out_type, qlayernorm::kMin, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*out_type, qlayernorm::kMax, mshadow::kFloat32);
+  return dtype != -1;
+}
+
+NNVM_REGISTER_OP(_contrib_quantized_layer_norm)
+    .add_alias("_npx_quantized_layer_norm")
+    .describe(R"code(LayerNorm operator for int8/uint8 input data and int8 output data.
+The input and output data comes with min and max thresholds for quantizing
+the float32 data into int8. The mean and the variance are computed on the integer levels of
+the input, gamma and beta stay in float32.
+
+The output is quantized with the calibrated range when ``min_calib_range`` and
+``max_calib_range`` are set, otherwise with the absolute maximum of the normalized data found
+at runtime. ``enabled_float_output`` writes the normalized data in float32 instead.
+
+.. Note::
+    This operator only supports forward propagation over the last axis. DO NOT use it in
+    training.
+)code" ADD_FILELINE)
+    .set_num_inputs(5)
+    .set_num_outputs(3)
+    .set_attr_parser(ParamParser<QuantizedLayerNormParam>)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          return std::vector<std::string>{"data", "gamma", "beta", "min_data", "max_data"};
+        })
+    .set_attr<nnvm::FListOutputNames>(
+        "FListOutputNames",
+        [](const NodeAttrs& attrs) {
+          return std::vector<std::string>{"output", "min_output", "max_output"};
+        })
+    .set_attr<mxnet::FInferShape>("FInferShape", QuantizedLayerNormShape)
+    .set_attr<nnvm::FInferType>("FInferType", QuantizedLayerNormType)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", QuantizedLayerNormForward<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes)
+    .set_attr<FNeedRequantize>("FNeedRequantize", [](const NodeAttrs& attrs) { return false; })
+    .set_attr<FNeedCalibrateInput>("FNeedCalibrateOutput",
+                                   [](const NodeAttrs& attrs) { return std::vector<int>{0}; })
+    .add_argument("data", "NDArray-or-Symbol", "Input data.")
+    .add_argument("gamma", "NDArray-or-Symbol", "gamma array.")
+    .add_argument("beta", "NDArray-or-Symbol", "beta array.")
+    .add_argument("min_data", "NDArray-or-Symbol", "Minimum value of data.")
+    .add_argument("max_data", "NDArray-or-Symbol", "Maximum value of data.")
+    .add_arguments(QuantizedLayerNormParam::__FIELDS__());
+
+NNVM_REGISTER_OP(LayerNorm)
+    .set_attr<FQuantizedOp>("FQuantizedOp",
+                            [](const NodeAttrs& attrs) {
+                              const LayerNormParam& param =
+                                  nnvm::get<LayerNormParam>(attrs.parsed);
+                              nnvm::ObjectPtr node = nnvm::Node::Create();
+                              if (param.axis == -1 && !param.output_mean_var) {
+                                node->attrs.op   = Op::Get("_contrib_quantized_layer_norm");
+                                node->attrs.name = "quantized_" + attrs.name;
+                              } else {
+                                LOG(INFO) << "Quantized LayerNorm only supports axis=-1 without "
+                                          << "output_mean_var, exclude " << attrs.name;
+                                node->attrs.op   = nullptr;
+                                node->attrs.name = attrs.name;
+                              }
+                              node->attrs.dict = attrs.dict;
+                              if (node->op() != nullptr && node->op()->attr_parser != nullptr) {
+                                node->op()->attr_parser(&(node->attrs));
+                              }
+                              return node;
+                            })
+    .set_attr<FAvoidQuantizeInput>("FAvoidQuantizeInput",
+                                   [](const NodeAttrs& attrs,
+                                      const size_t index,
+                                      const std::string quantize_granularity) {
+                                     return (index != 0);
+                                   });
+
+}  // namespace op
+}  // namespace mxnet
@@ -0,0 +1,215 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file quantized_leaky_relu-inl.h
+ * \brief GELU, ELU, SELU and leaky ReLU of int8/uint8 data through a table of the 256 levels
+ */
+#ifndef MXNET_OPERATOR_QUANTIZATION_QUANTIZED_LEAKY_RELU_INL_H_
+#define MXNET_OPERATOR_QUANTIZATION_QUANTIZED_LEAKY_RELU_INL_H_
+
+#include <mxnet/operator_util.h>
+#include <vector>
+#include "../mxnet_op.h"
+#include "../mshadow_op.h"
+#include "../operator_common.h"
+#include "../leaky_relu-inl.h"
+#include "./quantization_utils.h"
+
+namespace mxnet {
+namespace op {
+
+namespace qleakyrelu {
+enum QuantizedLeakyReLUInputs { kData, kMinData, kMaxData };
+enum QuantizedLeakyReLUOutputs { kOut, kMin, kMax };
+// one entry per level of an 8 bit type
+constexpr int kTableSize = 256;
+}  // namespace qleakyrelu
+
+struct QuantizedLeakyReLUParam : public dmlc::Parameter<QuantizedLeakyReLUParam> {
+  int act_type;
+  float slope;
+  dmlc::optional<float> min_calib_range;
+  dmlc::optional<float> max_calib_range;
+  dmlc::optional<int> enabled_float_output;
+  DMLC_DECLARE_PARAMETER(QuantizedLeakyReLUParam) {
+    DMLC_DECLARE_FIELD(act_type)
+        .set_default(leakyrelu::kLeakyReLU)
+        .add_enum("leaky", leakyrelu::kLeakyReLU)
+        .add_enum("elu", leakyrelu::kELU)
+        .add_enum("selu", leakyrelu::kSELU)
+        .add_enum("gelu_erf", leakyrelu::kGELU_ERF)
+        .add_enum("gelu_tanh", leakyrelu::kGELU_TANH)
+        .describe("Activation function to be applied, rrelu and prelu are not supported.");
+    DMLC_DECLARE_FIELD(slope).set_default(0.25f).describe(
+        "Init slope for the activation. (For leaky and elu only)");
+    DMLC_DECLARE_FIELD(min_calib_range)
+        .set_default(dmlc::optional<float>())
+        .describe(
+            "The minimum scalar value in the form of float32 obtained "
+            "through calibration. If present, it will be used to quantize the output. "
+            "Otherwise the output is quantized with the range of the table.");
+    DMLC_DECLARE_FIELD(max_calib_range)
+        .set_default(dmlc::optional<float>())
+        .describe(
+            "The maximum scalar value in the form of float32 obtained "
+            "through calibration. If present, it will be used to quantize the output. "
+            "Otherwise the output is quantized with the range of the table.");
+    DMLC_DECLARE_FIELD(enabled_float_output)
+        .set_default(dmlc::optional<int>())
+        .add_enum("float32", mshadow::kFloat32)
+        .describe("Write the output in float32 instead of int8, set when a dequantize is fused.");
+  }
+};
+
+MSHADOW_XINLINE float QuantizedLeakyReLUEval(const int act_type, const float x, const float slope) {
+  switch (act_type) {
+    case leakyrelu::kELU:
+      return mshadow_op::elu::Map(x, slope);
+    case leakyrelu::kSELU:
+      return mshadow_op::selu::Map(x);
+    case leakyrelu::kGELU_ERF:
+      return mshadow_op::gelu_erf::Map(x);
+    case leakyrelu::kGELU_TANH:
+      return mshadow_op::gelu_tanh::Map(x);
+    default:
+      return mshadow_op::xelu::Map(x, slope);
+  }
+}
+
+/*! \brief Evaluates the activation at every level of the input type. */
+template <typename SrcType>
+struct quantized_leaky_relu_table {
+  MSHADOW_XINLINE static void Map(int i,
+                                  float* table,
+                                  const float* min_data,
+                                  const float* max_data,
+                                  const int act_type,
+                                  const float slope) {
+    const float scale = FloatForOneQuantizedLevel<SrcType>(*min_data, *max_data, false);
+    const int level   = i + static_cast<int>(MinValue<SrcType>());
+    table[i]          = QuantizedLeakyReLUEval(act_type, level * scale, slope);
+  }
+};
+
+/*!
+ * \brief Writes the calibrated output threshold, or the largest absolute value of the table,
+ *        which bounds every output, when there is none.
+ */
+struct quantized_leaky_relu_threshold {
+  MSHADOW_XINLINE static void Map(int i,
+                                  float* threshold,
+                                  const float* table,
+                                  const float calib_threshold) {
+    float t = calib_threshold;
+    if (t <= 0.f) {
+      for (int j = 0; j < qleakyrelu::kTableSize; ++j) {
+        t = Max(t, Abs(table[j]));
+      }
+    }
+    *threshold = t;
+  }
+};
+
+template <typename SrcType>
+struct quantized_leaky_relu_lookup {
+  template <typename OType>
+  MSHADOW_XINLINE static void Map(int i,
+                                  OType* out,
+                                  const SrcType* data,
+                                  const float* table,
+                                  const float* threshold) {
+    const int index = static_cast<int>(data[i]) - static_cast<int>(MinValue<SrcType>());
+    StoreSymmetricQuantized(out + i, table[index], *threshold);
+  }
+};
+
+template <typename xpu, typename SrcType>
+void QuantizedLeakyReLUCompute(const QuantizedLeakyReLUParam& param,
+                               const OpContext& ctx,
+                               const std::vector<TBlob>& inputs,
+                               const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  Stream<xpu>* s = ctx.get_stream<xpu>();
+  // the table and the output threshold
+  Tensor<xpu, 1, float> workspace =
+      ctx.requested[0].get_space_typed<xpu, 1, float>(Shape1(qleakyrelu::kTableSize + 1), s);
+  float* table     = workspace.dptr_;
+  float* threshold = table + qleakyrelu::kTableSize;
+  Kernel<quantized_leaky_relu_table<SrcType>, xpu>::Launch(
+      s,
+      qleakyrelu::kTableSize,
+      table,
+      inputs[qleakyrelu::kMinData].dptr<float>(),
+      inputs[qleakyrelu::kMaxData].dptr<float>(),
+      param.act_type,
+      param.slope);
+  const float calib_threshold =
+      param.min_calib_range.has_value() && param.max_calib_range.has_value() ?
+          MaxAbs(param.min_calib_range.value(), param.max_calib_range.value()) :
+          0.f;
+  Kernel<quantized_leaky_relu_threshold, xpu>::Launch(s, 1, threshold, table, calib_threshold);
+  const TBlob& data = inputs[qleakyrelu::kData];
+  if (param.enabled_float_output.has_value()) {
+    Kernel<quantized_leaky_relu_lookup<SrcType>, xpu>::Launch(
+        s,
+        data.Size(),
+        outputs[qleakyrelu::kOut].dptr<float>(),
+        data.dptr<SrcType>(),
+        table,
+        threshold);
+  } else {
+    Kernel<quantized_leaky_relu_lookup<SrcType>, xpu>::Launch(
+        s,
+        data.Size(),
+        outputs[qleakyrelu::kOut].dptr<int8_t>(),
+        data.dptr<SrcType>(),
+        table,
+        threshold);
+  }
+  Kernel<quantized_symmetric_range, xpu>::Launch(s,
+                                                 1,
+                                                 outputs[qleakyrelu::kMin].dptr<float>(),
+                                                 outputs[qleakyrelu::kMax].dptr<float>(),
+                                                 threshold);
+}
+
+template <typename xpu>
+void QuantizedLeakyReLUForward(const nnvm::NodeAttrs& attrs,
+                               const OpContext& ctx,
+                               const std::vector<TBlob>& inputs,
+                               const std::vector<OpReqType>& req,
+                               const std::vector<TBlob>& outputs) {
+  const QuantizedLeakyReLUParam& param = nnvm::get<QuantizedLeakyReLUParam>(attrs.parsed);
+  CHECK_EQ(inputs.size(), 3U);
+  CHECK_EQ(outputs.size(), 3U);
+  CHECK_EQ(req[qleakyrelu::kOut], kWriteTo) << "_contrib_quantized_leaky_relu only supports "
+                                            << "req=kWriteTo";
+  if (inputs[qleakyrelu::kData].type_flag_ == mshadow::kUint8) {
+    QuantizedLeakyReLUCompute<xpu, uint8_t>(param, ctx, inputs, outputs);
+  } else {
+    QuantizedLeakyReLUCompute<xpu, int8_t>(param, ctx, inputs, outputs);
+  }
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_QUANTIZATION_QUANTIZED_LEAKY_RELU_INL_H_
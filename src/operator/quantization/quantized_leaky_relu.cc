@@ -0,0 +1,133 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file quantized_leaky_relu.cc
+ * \brief GELU, ELU, SELU and leaky ReLU of int8/uint8 data through a table of the 256 levels
+ */
+#include "./quantized_leaky_relu-inl.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(QuantizedLeakyReLUParam);
+
+static bool QuantizedLeakyReLUShape(const nnvm::NodeAttrs& attrs,
+                                    mxnet::ShapeVector* in_shape,
+                                    mxnet::ShapeVector* out_shape) {
+  CHECK_EQ(in_shape->size(), 3U);
+  CHECK_EQ(out_shape->size(), 3U);
+  SHAPE_ASSIGN_CHECK(*in_shape, qleakyrelu::kMinData, mxnet::TShape(1, 1));
+  SHAPE_ASSIGN_CHECK(*in_shape, qleakyrelu::kMaxData, mxnet::TShape(1, 1));
+  SHAPE_ASSIGN_CHECK(*out_shape, qleakyrelu::kMin, mxnet::TShape(1, 1));
+  SHAPE_ASSIGN_CHECK(*out_shape, qleakyrelu::kMax, mxnet::TShape(1, 1));
+  if (!mxnet::ndim_is_known((*in_shape)[qleakyrelu::kData]))
+    return false;
+  SHAPE_ASSIGN_CHECK(*out_shape, qleakyrelu::kOut, (*in_shape)[qleakyrelu::kData]);
+  return true;
+}
+
+static bool QuantizedLeakyReLUType(const nnvm::NodeAttrs& attrs,
+                                   std::vector<int>* in_type,
+                                   std::vector<int>* out_type) {
+  const QuantizedLeakyReLUParam& param = nnvm::get<QuantizedLeakyReLUParam>(attrs.parsed);
+  CHECK_EQ(in_type->size(), 3U);
+  CHECK_EQ(out_type->size(), 3U);
+  const int dtype = (*in_type)[qleakyrelu::kData];
+  CHECK(dtype == -1 || dtype == mshadow::kInt8 || dtype == mshadow::kUint8)
+      << "_contrib_quantized_leaky_relu only supports int8/uint8 input, while " << dtype
+      << " is given.";
+  TYPE_ASSIGN_CHECK(*in_type, qleakyrelu::kMinData, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*in_type, qleakyrelu::kMaxData, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*out_type,
+                    qleakyrelu::kOut,
+                    param.enabled_float_output.has_value() ? mshadow::kFloat32 : mshadow::kInt8);
+  TYPE_ASSIGN_CHECK(*out_type, qleakyrelu::kMin, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*out_type, qleakyrelu::kMax, mshadow::kFloat32);
+  return dtype != -1;
+}
+
+NNVM_REGISTER_OP(_contrib_quantized_leaky_relu)
+    .add_alias("_npx_quantized_leaky_relu")
+    .describe(R"code(LeakyReLU operator for int8/uint8 input data and int8 output data.
+The input and output data comes with min and max thresholds for quantizing
+the float32 data into int8.
+
+The activation is evaluated once for each of the 256 levels of the input type, every element
+is then a lookup in that table, which makes GELU as cheap as ReLU. The output is quantized with
+the calibrated range when ``min_calib_range`` and ``max_calib_range`` are set, otherwise with
+the largest absolute value of the table. ``enabled_float_output`` writes the activations in
+float32 instead.
+
+.. Note::
+    This operator only supports forward propagation. DO NOT use it in training.
+    This operator supports `leaky`, `elu`, `selu`, `gelu_erf` and `gelu_tanh`.
+)code" ADD_FILELINE)
+    .set_num_inputs(3)
+    .set_num_outputs(3)
+    .set_attr_parser(ParamParser<QuantizedLeakyReLUParam>)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          return std::vector<std::string>{"data", "min_data", "max_data"};
+        })
+    .set_attr<nnvm::FListOutputNames>(
+        "FListOutputNames",
+        [](const NodeAttrs& attrs) {
+          return std::vector<std::string>{"output", "min_output", "max_output"};
+        })
+    .set_attr<mxnet::FInferShape>("FInferShape", QuantizedLeakyReLUShape)
+    .set_attr<nnvm::FInferType>("FInferType", QuantizedLeakyReLUType)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", QuantizedLeakyReLUForward<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes)
+    .set_attr<FNeedRequantize>("FNeedRequantize", [](const NodeAttrs& attrs) { return false; })
+    .set_attr<FNeedCalibrateInput>("FNeedCalibrateOutput",
+                                   [](const NodeAttrs& attrs) { return std::vector<int>{0}; })
+    .add_argument("data", "NDArray-or-Symbol", "Input data.")
+    .add_argument("min_data", "NDArray-or-Symbol", "Minimum value of data.")
+    .add_argument("max_data", "NDArray-or-Symbol", "Maximum value of data.")
+    .add_arguments(QuantizedLeakyReLUParam::__FIELDS__());
+
+NNVM_REGISTER_OP(LeakyReLU).set_attr<FQuantizedOp>("FQuantizedOp", [](const NodeAttrs& attrs) {
+  const LeakyReLUParam& param = nnvm::get<LeakyReLUParam>(attrs.parsed);
+  nnvm::ObjectPtr node        = nnvm::Node::Create();
+  if (param.act_type != leakyrelu::kRReLU && param.act_type != leakyrelu::kPReLU) {
+    node->attrs.op   = Op::Get("_contrib_quantized_leaky_relu");
+    node->attrs.name = "quantized_" + attrs.name;
+  } else {
+    LOG(INFO) << "Quantized LeakyReLU does not support rrelu and prelu, exclude " << attrs.name;
+    node->attrs.op   = nullptr;
+    node->attrs.name = attrs.name;
+  }
+  node->attrs.dict = attrs.dict;
+  // the bounds only apply to rrelu
+  node->attrs.dict.erase("lower_bound");
+  node->attrs.dict.erase("upper_bound");
+  if (node->op() != nullptr && node->op()->attr_parser != nullptr) {
+    node->op()->attr_parser(&(node->attrs));
+  }
+  return node;
+});
+
+}  // namespace op
+}  // namespace mxnet
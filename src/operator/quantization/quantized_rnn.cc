@@ -99,7 +99,9 @@ bool QuantizedRnnShape(const nnvm::NodeAttrs& attrs,
   const dim_t directions = param.bidirectional ? 2 : 1;
   const dim_t total_lyrs = directions * param.num_layers;
   const dim_t state_size = param.state_size;
-  SHAPE_ASSIGN_CHECK(*in_shape, quantized_rnn::kState, Shape3(total_lyrs, batch_size, state_size));
+  const dim_t iter_size =
+      param.projection_size.has_value() ? param.projection_size.value() : state_size;
+  SHAPE_ASSIGN_CHECK(*in_shape, quantized_rnn::kState, Shape3(total_lyrs, batch_size, iter_size));
   if (param.mode == rnn_enum::kLstm)
     SHAPE_ASSIGN_CHECK(
         *in_shape, quantized_rnn::kStateCell, Shape3(total_lyrs, batch_size, state_size));
@@ -112,9 +114,9 @@ bool QuantizedRnnShape(const nnvm::NodeAttrs& attrs,
     SHAPE_ASSIGN_CHECK(*in_shape, i, Shape1(1));
 
   out_shape->clear();
-  out_shape->push_back({dshape[0], batch_size, directions * state_size});  // output dim: [T, N, C]
+  out_shape->push_back({dshape[0], batch_size, directions * iter_size});  // output dim: [T, N, C]
   if (param.state_outputs) {
-    out_shape->push_back({total_lyrs, batch_size, state_size});  // state dim: [L*D, N, C]
+    out_shape->push_back({total_lyrs, batch_size, iter_size});  // state dim: [L*D, N, C]
     if (param.mode == rnn_enum::kLstm)
       out_shape->push_back({total_lyrs, batch_size, state_size});  // cell dim: [L*D, N, C]
   }
@@ -295,7 +297,7 @@ gates is converted to int8, while bias is accumulated in type float32.
 The hidden state and cell state are in type float32. For the input data, two more arguments
 of type float32 must be provided representing the thresholds of quantizing argument from
 data type float32 to uint8. The final outputs contain the recurrent result in float32.
-It only supports quantization for Vanilla LSTM network.
+It only supports quantization for LSTM networks, with or without projection.
 
 .. Note::
     This operator only supports forward propagation. DO NOT use it in training.)code" ADD_FILELINE)
@@ -331,8 +333,7 @@ NNVM_REGISTER_OP(RNN)
                               const RNNParam& param = nnvm::get<RNNParam>(attrs.parsed);
                               if (param.mode != rnn_enum::kLstm)
                                 LOG(INFO) << "Quantized RNN only supports LSTM mode.";
-                              if (param.mode == rnn_enum::kLstm &&
-                                  !param.projection_size.has_value()) {
+                              if (param.mode == rnn_enum::kLstm) {
                                 return QuantizeType::kMust;
                               } else {
                                 return QuantizeType::kNone;
@@ -0,0 +1,169 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file quantized_softmax-inl.h
+ * \brief Softmax over the last axis of int8/uint8 data
+ */
+#ifndef MXNET_OPERATOR_QUANTIZATION_QUANTIZED_SOFTMAX_INL_H_
+#define MXNET_OPERATOR_QUANTIZATION_QUANTIZED_SOFTMAX_INL_H_
+
+#include <mxnet/operator_util.h>
+#include <vector>
+#include "../mxnet_op.h"
+#include "../mshadow_op.h"
+#include "../operator_common.h"
+#include "./quantization_utils.h"
+
+namespace mxnet {
+namespace op {
+
+namespace qsoftmax {
+enum QuantizedSoftmaxInputs { kData, kMinData, kMaxData };
+enum QuantizedSoftmaxOutputs { kOut, kMin, kMax };
+}  // namespace qsoftmax
+
+struct QuantizedSoftmaxParam : public dmlc::Parameter<QuantizedSoftmaxParam> {
+  int axis;
+  dmlc::optional<double> temperature;
+  dmlc::optional<float> min_calib_range;
+  dmlc::optional<float> max_calib_range;
+  dmlc::optional<int> enabled_float_output;
+  DMLC_DECLARE_PARAMETER(QuantizedSoftmaxParam) {
+    DMLC_DECLARE_FIELD(axis).set_default(-1).describe(
+        "The axis along which to compute softmax, only the last axis is supported.");
+    DMLC_DECLARE_FIELD(temperature)
+        .set_default(dmlc::optional<double>())
+        .describe("Temperature parameter in softmax");
+    DMLC_DECLARE_FIELD(min_calib_range)
+        .set_default(dmlc::optional<float>())
+        .describe(
+            "The minimum scalar value in the form of float32 obtained "
+            "through calibration. If present, it will be used to quantize the output. "
+            "Otherwise the output is quantized in [-1, 1].");
+    DMLC_DECLARE_FIELD(max_calib_range)
+        .set_default(dmlc::optional<float>())
+        .describe(
+            "The maximum scalar value in the form of float32 obtained "
+            "through calibration. If present, it will be used to quantize the output. "
+            "Otherwise the output is quantized in [-1, 1].");
+    DMLC_DECLARE_FIELD(enabled_float_output)
+        .set_default(dmlc::optional<int>())
+        .add_enum("float32", mshadow::kFloat32)
+        .describe("Write the output in float32 instead of int8, set when a dequantize is fused.");
+  }
+};
+
+/*!
+ * \brief Computes the softmax of one row of quantized data per work item, the largest level of
+ *        the row is subtracted before the exponential as in the float operator.
+ */
+template <typename SrcType>
+struct quantized_softmax_fwd {
+  template <typename OType>
+  MSHADOW_XINLINE static void Map(int row,
+                                  OType* out,
+                                  const SrcType* data,
+                                  const float* min_data,
+                                  const float* max_data,
+                                  const index_t axis_size,
+                                  const float temperature,
+                                  const float out_threshold) {
+    const float scale =
+        FloatForOneQuantizedLevel<SrcType>(*min_data, *max_data, false) / temperature;
+    const SrcType* x = data + static_cast<index_t>(row) * axis_size;
+    OType* y         = out + static_cast<index_t>(row) * axis_size;
+    int max_q        = x[0];
+    for (index_t j = 1; j < axis_size; ++j) {
+      max_q = x[j] > max_q ? x[j] : max_q;
+    }
+    float sum = 0.f;
+    for (index_t j = 0; j < axis_size; ++j) {
+      sum += math::exp(static_cast<float>(x[j] - max_q) * scale);
+    }
+    const float inv_sum = 1.f / sum;
+    for (index_t j = 0; j < axis_size; ++j) {
+      const float v = math::exp(static_cast<float>(x[j] - max_q) * scale) * inv_sum;
+      StoreSymmetricQuantized(y + j, v, out_threshold);
+    }
+  }
+};
+
+template <typename xpu, typename SrcType>
+void QuantizedSoftmaxCompute(const QuantizedSoftmaxParam& param,
+                             const OpContext& ctx,
+                             const std::vector<TBlob>& inputs,
+                             const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  const TBlob& data       = inputs[qsoftmax::kData];
+  const index_t axis_size = data.shape_[data.ndim() - 1];
+  const index_t num_rows  = data.shape_.Size() / axis_size;
+  const float temperature =
+      param.temperature.has_value() ? static_cast<float>(param.temperature.value()) : 1.f;
+  // the probabilities are in [0, 1], which is the output range without calibration
+  const float threshold =
+      param.min_calib_range.has_value() && param.max_calib_range.has_value() ?
+          MaxAbs(param.min_calib_range.value(), param.max_calib_range.value()) :
+          1.f;
+  auto launch = [&](auto* out) {
+    Kernel<quantized_softmax_fwd<SrcType>, xpu>::Launch(s,
+                                                        num_rows,
+                                                        out,
+                                                        data.dptr<SrcType>(),
+                                                        inputs[qsoftmax::kMinData].dptr<float>(),
+                                                        inputs[qsoftmax::kMaxData].dptr<float>(),
+                                                        axis_size,
+                                                        temperature,
+                                                        threshold);
+  };
+  if (param.enabled_float_output.has_value()) {
+    launch(outputs[qsoftmax::kOut].dptr<float>());
+  } else {
+    launch(outputs[qsoftmax::kOut].dptr<int8_t>());
+  }
+  Kernel<quantized_symmetric_range, xpu>::Launch(s,
+                                                 1,
+                                                 outputs[qsoftmax::kMin].dptr<float>(),
+                                                 outputs[qsoftmax::kMax].dptr<float>(),
+                                                 threshold);
+}
+
+template <typename xpu>
+void QuantizedSoftmaxForward(const nnvm::NodeAttrs& attrs,
+                             const OpContext& ctx,
+                             const std::vector<TBlob>& inputs,
+                             const std::vector<OpReqType>& req,
+                             const std::vector<TBlob>& outputs) {
+  const QuantizedSoftmaxParam& param = nnvm::get<QuantizedSoftmaxParam>(attrs.parsed);
+  CHECK_EQ(inputs.size(), 3U);
+  CHECK_EQ(outputs.size(), 3U);
+  CHECK_EQ(req[qsoftmax::kOut], kWriteTo) << "_contrib_quantized_softmax only supports "
+                                          << "req=kWriteTo";
+  if (inputs[qsoftmax::kData].type_flag_ == mshadow::kUint8) {
+    QuantizedSoftmaxCompute<xpu, uint8_t>(param, ctx, inputs, outputs);
+  } else {
+    QuantizedSoftmaxCompute<xpu, int8_t>(param, ctx, inputs, outputs);
+  }
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_QUANTIZATION_QUANTIZED_SOFTMAX_INL_H_
@@ -0,0 +1,134 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file quantized_softmax.cc
+ * \brief Softmax over the last axis of int8/uint8 data
+ */
+#include "./quantized_softmax-inl.h"
+#include "../nn/softmax-inl.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(QuantizedSoftmaxParam);
+
+static bool QuantizedSoftmaxShape(const nnvm::NodeAttrs& attrs,
+                                  mxnet::ShapeVector* in_shape,
+                                  mxnet::ShapeVector* out_shape) {
+  const QuantizedSoftmaxParam& param = nnvm::get<QuantizedSoftmaxParam>(attrs.parsed);
+  CHECK_EQ(in_shape->size(), 3U);
+  CHECK_EQ(out_shape->size(), 3U);
+  SHAPE_ASSIGN_CHECK(*in_shape, qsoftmax::kMinData, mxnet::TShape(1, 1));
+  SHAPE_ASSIGN_CHECK(*in_shape, qsoftmax::kMaxData, mxnet::TShape(1, 1));
+  SHAPE_ASSIGN_CHECK(*out_shape, qsoftmax::kMin, mxnet::TShape(1, 1));
+  SHAPE_ASSIGN_CHECK(*out_shape, qsoftmax::kMax, mxnet::TShape(1, 1));
+  const mxnet::TShape& dshape = (*in_shape)[qsoftmax::kData];
+  if (!mxnet::ndim_is_known(dshape))
+    return false;
+  const int axis = param.axis < 0 ? param.axis + dshape.ndim() : param.axis;
+  CHECK_EQ(axis, dshape.ndim() - 1)
+      << "_contrib_quantized_softmax only supports the last axis, while axis=" << param.axis;
+  SHAPE_ASSIGN_CHECK(*out_shape, qsoftmax::kOut, dshape);
+  return true;
+}
+
+static bool QuantizedSoftmaxType(const nnvm::NodeAttrs& attrs,
+                                 std::vector<int>* in_type,
+                                 std::vector<int>* out_type) {
+  const QuantizedSoftmaxParam& param = nnvm::get<QuantizedSoftmaxParam>(attrs.parsed);
+  CHECK_EQ(in_type->size(), 3U);
+  CHECK_EQ(out_type->size(), 3U);
+  const int dtype = (*in_type)[qsoftmax::kData];
+  CHECK(dtype == -1 || dtype == mshadow::kInt8 || dtype == mshadow::kUint8)
+      << "_contrib_quantized_softmax only supports int8/uint8 input, while " << dtype
+      << " is given.";
+  TYPE_ASSIGN_CHECK(*in_type, qsoftmax::kMinData, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*in_type, qsoftmax::kMaxData, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*out_type,
+                    qsoftmax::kOut,
+                    param.enabled_float_output.has_value() ? mshadow::kFloat32 : mshadow::kInt8);
+  TYPE_ASSIGN_CHECK(*out_type, qsoftmax::kMin, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*out_type, qsoftmax::kMax, mshadow::kFloat32);
+  return dtype != -1;
+}
+
+NNVM_REGISTER_OP(_contrib_quantized_softmax)
+    .add_alias("_npx_quantized_softmax")
+    .describe(R"code(Softmax operator for int8/uint8 input data and int8 output data.
+The input and output data comes with min and max thresholds for quantizing
+the float32 data into int8.
+
+The output is quantized with the calibrated range when ``min_calib_range`` and
+``max_calib_range`` are set, otherwise in [-1, 1]. ``enabled_float_output`` writes the
+probabilities in float32 instead.
+
+.. Note::
+    This operator only supports forward propagation over the last axis. DO NOT use it in
+    training.
+)code" ADD_FILELINE)
+    .set_num_inputs(3)
+    .set_num_outputs(3)
+    .set_attr_parser(ParamParser<QuantizedSoftmaxParam>)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          return std::vector<std::string>{"data", "min_data", "max_data"};
+        })
+    .set_attr<nnvm::FListOutputNames>(
+        "FListOutputNames",
+        [](const NodeAttrs& attrs) {
+          return std::vector<std::string>{"output", "min_output", "max_output"};
+        })
+    .set_attr<mxnet::FInferShape>("FInferShape", QuantizedSoftmaxShape)
+    .set_attr<nnvm::FInferType>("FInferType", QuantizedSoftmaxType)
+    .set_attr<FCompute>("FCompute<cpu>", QuantizedSoftmaxForward<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes)
+    .set_attr<FNeedRequantize>("FNeedRequantize", [](const NodeAttrs& attrs) { return false; })
+    .set_attr<FNeedCalibrateInput>("FNeedCalibrateOutput",
+                                   [](const NodeAttrs& attrs) { return std::vector<int>{0}; })
+    .add_argument("data", "NDArray-or-Symbol", "Input data.")
+    .add_argument("min_data", "NDArray-or-Symbol", "Minimum value of data.")
+    .add_argument("max_data", "NDArray-or-Symbol", "Maximum value of data.")
+    .add_arguments(QuantizedSoftmaxParam::__FIELDS__());
+
+NNVM_REGISTER_OP(softmax).set_attr<FQuantizedOp>("FQuantizedOp", [](const NodeAttrs& attrs) {
+  const SoftmaxParam& param = nnvm::get<SoftmaxParam>(attrs.parsed);
+  nnvm::ObjectPtr node      = nnvm::Node::Create();
+  if (param.axis == -1 && !param.dtype.has_value() && !softmax_use_length(attrs)) {
+    node->attrs.op   = Op::Get("_contrib_quantized_softmax");
+    node->attrs.name = "quantized_" + attrs.name;
+  } else {
+    LOG(INFO) << "Quantized softmax only supports axis=-1 without dtype and use_length, exclude "
+              << attrs.name;
+    node->attrs.op   = nullptr;
+    node->attrs.name = attrs.name;
+  }
+  node->attrs.dict = attrs.dict;
+  // the quantized operator has no dtype and length input
+  node->attrs.dict.erase("dtype");
+  node->attrs.dict.erase("use_length");
+  if (node->op() != nullptr && node->op()->attr_parser != nullptr) {
+    node->op()->attr_parser(&(node->attrs));
+  }
+  return node;
+});
+
+}  // namespace op
+}  // namespace mxnet
@@ -0,0 +1,105 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file sample_candidates_op.cc
+ * \brief CPU implementation of the candidate sampling operators
+ */
+#include "./sample_candidates_op.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(SampleCandidatesParam);
+
+NNVM_REGISTER_OP(_alias_table)
+    .describe(R"code(Builds the alias table of the unigram distribution proportional to *weights*,
+for drawing candidates from it in constant time with `_sample_candidates`.
+
+*weights* is a 1-D array of the non-negative weights of the *range_max* classes. The outputs
+are three arrays of length *range_max*: the acceptance probabilities (float32) and the aliases
+(int64) of the columns of the table, and the normalized distribution (float32).
+
+The table is built in linear time, on CPU. It is meant to be built once and reused, copied to
+the device of the sampling if needed.
+
+Example::
+
+   accept, alias, dist = _alias_table([1, 1, 2])
+   dist = [0.25, 0.25, 0.5]
+
+)code" ADD_FILELINE)
+    .set_num_inputs(1)
+    .set_num_outputs(3)
+    .set_attr<mxnet::FInferShape>("FInferShape", AliasTableShape)
+    .set_attr<nnvm::FInferType>("FInferType", AliasTableType)
+    .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"weights"};
+                                     })
+    .set_attr<FCompute>("FCompute<cpu>", AliasTableForward)
+    .add_argument("weights", "NDArray-or-Symbol", "Non-negative weights of the classes");
+
+NNVM_REGISTER_OP(_sample_candidates)
+    .describe(R"code(Draws *num_sampled* candidate classes with replacement from the unigram
+distribution of an alias table built by `_alias_table`, for sampled softmax.
+
+Each candidate takes two uniform draws and no rejection, so that the cost does not depend on
+the number of classes nor on the distribution, and the candidates are drawn in parallel.
+
+Additionally, it returns the number of times each of the true classes and each of the
+candidates is expected to occur among the candidates, *num_sampled* times their probability.
+The true classes out of the range of the table have an expected count of 0.
+
+Example::
+
+   accept, alias, dist = _alias_table([1, 1, 2])
+   samples, expected_count_true, expected_count_sampled =
+       _sample_candidates(accept, alias, dist, [2], num_sampled=4)
+   samples = [2, 0, 2, 1]
+   expected_count_true = [2.]
+   expected_count_sampled = [2., 1., 2., 1.]
+
+)code" ADD_FILELINE)
+    .set_num_inputs(4)
+    .set_num_outputs(3)
+    .set_attr_parser(ParamParser<SampleCandidatesParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", SampleCandidatesShape)
+    .set_attr<nnvm::FInferType>("FInferType", SampleCandidatesType)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const nnvm::NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{
+                                      ResourceRequest::kParallelRandom};
+                                })
+    .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          return std::vector<std::string>{"accept", "alias", "dist", "true_classes"};
+        })
+    .set_attr<FCompute>("FCompute<cpu>", SampleCandidatesForward<cpu>)
+    .add_argument("accept", "NDArray-or-Symbol", "Acceptance probabilities of the alias table")
+    .add_argument("alias", "NDArray-or-Symbol", "Aliases of the alias table")
+    .add_argument("dist", "NDArray-or-Symbol", "Normalized distribution of the alias table")
+    .add_argument("true_classes", "NDArray-or-Symbol", "Target classes")
+    .add_arguments(SampleCandidatesParam::__FIELDS__());
+
+}  // namespace op
+}  // namespace mxnet
@@ -0,0 +1,235 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file sample_candidates_op.h
+ * \brief Candidate sampling from arbitrary unigram distributions by the alias method
+ */
+#ifndef MXNET_OPERATOR_RANDOM_SAMPLE_CANDIDATES_OP_H_
+#define MXNET_OPERATOR_RANDOM_SAMPLE_CANDIDATES_OP_H_
+
+#include <mxnet/operator_util.h>
+#include <vector>
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+#include "./sampler.h"
+
+namespace mxnet {
+namespace op {
+
+struct SampleCandidatesParam : public dmlc::Parameter<SampleCandidatesParam> {
+  int num_sampled;
+  DMLC_DECLARE_PARAMETER(SampleCandidatesParam) {
+    DMLC_DECLARE_FIELD(num_sampled)
+        .set_lower_bound(0)
+        .describe("The number of candidates to sample.");
+  }
+};
+
+inline bool AliasTableShape(const nnvm::NodeAttrs& attrs,
+                            mxnet::ShapeVector* in_attrs,
+                            mxnet::ShapeVector* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 1U);
+  CHECK_EQ(out_attrs->size(), 3U);
+  const mxnet::TShape& wshape = (*in_attrs)[0];
+  if (!ndim_is_known(wshape))
+    return false;
+  CHECK_EQ(wshape.ndim(), 1) << "The weights of the classes must be 1-D";
+  for (int i = 0; i < 3; ++i)
+    SHAPE_ASSIGN_CHECK(*out_attrs, i, wshape);
+  return shape_is_known(wshape);
+}
+
+inline bool AliasTableType(const nnvm::NodeAttrs& attrs,
+                           std::vector<int>* in_attrs,
+                           std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 1U);
+  CHECK_EQ(out_attrs->size(), 3U);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*out_attrs, 1, mshadow::kInt64);
+  TYPE_ASSIGN_CHECK(*out_attrs, 2, mshadow::kFloat32);
+  return (*in_attrs)[0] != -1;
+}
+
+inline bool SampleCandidatesShape(const nnvm::NodeAttrs& attrs,
+                                  mxnet::ShapeVector* in_attrs,
+                                  mxnet::ShapeVector* out_attrs) {
+  const SampleCandidatesParam& param = nnvm::get<SampleCandidatesParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), 4U);
+  CHECK_EQ(out_attrs->size(), 3U);
+  // the three arrays of the table have the same shape
+  for (int i = 1; i < 3; ++i) {
+    SHAPE_ASSIGN_CHECK(*in_attrs, i, (*in_attrs)[0]);
+    SHAPE_ASSIGN_CHECK(*in_attrs, 0, (*in_attrs)[i]);
+  }
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, mshadow::Shape1(param.num_sampled));
+  SHAPE_ASSIGN_CHECK(*out_attrs, 1, (*in_attrs)[3]);
+  SHAPE_ASSIGN_CHECK(*out_attrs, 2, mshadow::Shape1(param.num_sampled));
+  return shape_is_known((*in_attrs)[0]) && shape_is_known((*in_attrs)[3]);
+}
+
+inline bool SampleCandidatesType(const nnvm::NodeAttrs& attrs,
+                                 std::vector<int>* in_attrs,
+                                 std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 4U);
+  CHECK_EQ(out_attrs->size(), 3U);
+  TYPE_ASSIGN_CHECK(*in_attrs, 0, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*in_attrs, 1, mshadow::kInt64);
+  TYPE_ASSIGN_CHECK(*in_attrs, 2, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, mshadow::kInt64);
+  TYPE_ASSIGN_CHECK(*out_attrs, 1, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*out_attrs, 2, mshadow::kFloat32);
+  return (*in_attrs)[3] != -1;
+}
+
+/*!
+ * \brief Builds the alias table of the distribution proportional to the weights, by Vose's
+ *        algorithm: column k is drawn uniformly, then k is kept with probability accept[k] and
+ *        replaced by alias[k] otherwise. dist holds the normalized distribution.
+ */
+inline void AliasTableForward(const nnvm::NodeAttrs& attrs,
+                              const OpContext& ctx,
+                              const std::vector<TBlob>& inputs,
+                              const std::vector<OpReqType>& req,
+                              const std::vector<TBlob>& outputs) {
+  const index_t K = inputs[0].Size();
+  float* accept   = outputs[0].dptr<float>();
+  int64_t* alias  = outputs[1].dptr<int64_t>();
+  float* dist     = outputs[2].dptr<float>();
+  double total    = 0;
+  std::vector<double> scaled(K);
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    const DType* weights = inputs[0].dptr<DType>();
+    for (index_t k = 0; k < K; ++k) {
+      scaled[k] = static_cast<double>(weights[k]);
+      CHECK_GE(scaled[k], 0) << "The weights of the classes must be non-negative";
+      total += scaled[k];
+    }
+  });
+  CHECK_GT(total, 0) << "The weights of the classes must not all be zero";
+
+  std::vector<index_t> small, large;
+  for (index_t k = 0; k < K; ++k) {
+    dist[k] = static_cast<float>(scaled[k] / total);
+    scaled[k] *= K / total;
+    (scaled[k] < 1.0 ? small : large).push_back(k);
+  }
+  while (!small.empty() && !large.empty()) {
+    const index_t s = small.back();
+    const index_t l = large.back();
+    small.pop_back();
+    accept[s] = static_cast<float>(scaled[s]);
+    alias[s]  = l;
+    // l gives the rest of the column of s
+    scaled[l] -= 1.0 - scaled[s];
+    if (scaled[l] < 1.0) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+  // the columns left are full, up to rounding
+  for (const std::vector<index_t>* rest : {&small, &large}) {
+    for (const index_t k : *rest) {
+      accept[k] = 1.0f;
+      alias[k]  = k;
+    }
+  }
+}
+
+template <typename xpu>
+struct SampleCandidatesKernel {
+  MSHADOW_XINLINE static void Map(index_t id,
+                                  RandGenerator<xpu, float> gen,
+                                  const index_t N,
+                                  const index_t step,
+                                  const index_t K,
+                                  const float* accept,
+                                  const int64_t* alias,
+                                  const float* dist,
+                                  int64_t* samples,
+                                  float* expected_count) {
+    RNG_KERNEL_LOOP(xpu, float, id, gen, N, step, {
+      // the draw of the column may round up to K
+      const index_t column = static_cast<index_t>(genImpl.uniform() * K);
+      const index_t k      = column < K ? column : K - 1;
+      const int64_t c      = genImpl.uniform() < accept[k] ? k : alias[k];
+
+      samples[i]        = c;
+      expected_count[i] = dist[c] * N;
+    });
+  }
+};
+
+struct CandidatesExpectedCountKernel {
+  template <typename IType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  const IType* classes,
+                                  const index_t K,
+                                  const float* dist,
+                                  const float num_sampled,
+                                  float* expected_count) {
+    const index_t c   = static_cast<index_t>(classes[i]);
+    expected_count[i] = c >= 0 && c < K ? dist[c] * num_sampled : 0.0f;
+  }
+};
+
+/*!
+ * \brief Draws the candidates with replacement from an alias table, in parallel, along with the
+ *        expected counts of the true classes and of the candidates.
+ */
+template <typename xpu>
+void SampleCandidatesForward(const nnvm::NodeAttrs& attrs,
+                             const OpContext& ctx,
+                             const std::vector<TBlob>& inputs,
+                             const std::vector<OpReqType>& req,
+                             const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const SampleCandidatesParam& param = nnvm::get<SampleCandidatesParam>(attrs.parsed);
+  Stream<xpu>* s                     = ctx.get_stream<xpu>();
+  const index_t K                    = inputs[0].Size();
+  const float* accept                = inputs[0].dptr<float>();
+  const int64_t* alias               = inputs[1].dptr<int64_t>();
+  const float* dist                  = inputs[2].dptr<float>();
+  CHECK_GT(K, 0) << "The alias table must not be empty";
+
+  RandGenerator<xpu, float>* pgen = ctx.requested[0].get_parallel_random<xpu, float>();
+  LaunchRNG<SampleCandidatesKernel<xpu>, xpu>(s,
+                                              pgen,
+                                              param.num_sampled,
+                                              K,
+                                              accept,
+                                              alias,
+                                              dist,
+                                              outputs[0].dptr<int64_t>(),
+                                              outputs[2].dptr<float>());
+  MSHADOW_TYPE_SWITCH(inputs[3].type_flag_, IType, {
+    Kernel<CandidatesExpectedCountKernel, xpu>::Launch(s,
+                                                       inputs[3].Size(),
+                                                       inputs[3].dptr<IType>(),
+                                                       K,
+                                                       dist,
+                                                       static_cast<float>(param.num_sampled),
+                                                       outputs[1].dptr<float>());
+  });
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_RANDOM_SAMPLE_CANDIDATES_OP_H_
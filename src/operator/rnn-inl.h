@@ -239,9 +239,12 @@ inline size_t GetRNNWorkspaceSize(index_t seq_length,
   size_t size = 0;
   switch (mode) {
     case rnn_enum::kLstm:
-      size = seq_length * batch_size * hidden_size * (4 + direction) +  // wx*x + inter-y
-             batch_size * hidden_size * 6 +                             // wh*h + h + c
-             seq_length * hidden_size * 8 +  // Used in Backward, Δbx, Δbh
+      // wx*x + wh*h + h + c (+ projected h) for each direction, computed in lockstep
+      size = LstmInferenceDirectionWorkspaceSize(seq_length, batch_size, hidden_size,
+                                                 projection_size) *
+                 direction +
+             seq_length * batch_size * hidden_size * direction +  // inter-y
+             seq_length * hidden_size * 8 +                       // Used in Backward, Δbx, Δbh
              // temporary dy in backward computation for bidirectional layers
              seq_length * batch_size * hidden_size * (direction - 1 ? direction : 0);
       break;
@@ -801,18 +804,12 @@ class RNNOp {
     }
 #endif
 
-    if (param_.use_sequence_length) {
+    size_t seq_len_input_idx = rnn_enum::kSequenceLength;
+    if (param_.mode != rnn_enum::kLstm) {
+      seq_len_input_idx -= 1;
+    }
+    if (param_.use_sequence_length && ctx_.dev_type == kGPU) {
 #if MXNET_USE_CUDNN_GE_7200
-      if (ctx_.dev_type == kCPU) {
-        LOG(FATAL) << "RNN use_sequence_length option is only available for cuDNN at the moment."
-                   << " Not supported on CPU";
-      }
-
-      // We can assume we are on GPU for now
-      size_t seq_len_input_idx = rnn_enum::kSequenceLength;
-      if (param_.mode != rnn_enum::kLstm) {
-        seq_len_input_idx -= 1;
-      }
       IType* sequence_length_ptr_gpu = (in_data[seq_len_input_idx].get<xpu, 1, IType>(s)).dptr_;
 
       // Need to copy from GPU -> CPU, becuase cuDNN API requires this array on CPU memory.
@@ -1028,13 +1025,26 @@ class RNNOp {
         projection_size = param_.projection_size.value();
       }
 
+      if (param_.use_sequence_length) {
+        CHECK(param_.mode == rnn_enum::kLstm && projection_size == 0)
+            << "RNN use_sequence_length option is only supported by LSTM without projection on CPU";
+        CHECK(!ctx.is_train && !ctx.need_grad)
+            << "RNN use_sequence_length option only supports inference on CPU";
+      }
+
       // allocate temp space
-      const size_t work_cpu_space_size = GetRNNWorkspaceSize(param_.seq_length_,
-                                                             param_.batch_size_,
-                                                             param_.state_size,
-                                                             projection_size,
-                                                             direction,
-                                                             param_.mode);
+      const size_t work_cpu_space_size =
+          param_.use_sequence_length ? LstmPackedInferenceWorkspaceSize(direction,
+                                                                        param_.seq_length_,
+                                                                        param_.batch_size_,
+                                                                        param_.input_size_,
+                                                                        param_.state_size) :
+                                       GetRNNWorkspaceSize(param_.seq_length_,
+                                                           param_.batch_size_,
+                                                           param_.state_size,
+                                                           projection_size,
+                                                           direction,
+                                                           param_.mode);
       if (!temp_init_space_ || temp_cpu_space_size_ < work_cpu_space_size) {
         temp_cpu_space_size_ = work_cpu_space_size;
         temp_cpu_space_      = NDArray(TShape({static_cast<dim_t>(temp_cpu_space_size_)}),
@@ -1090,6 +1100,25 @@ class RNNOp {
                                   param_.p,
                                   param_.mode,
                                   rnd_engine);
+      } else if (param_.use_sequence_length) {
+        // the padded steps of the batch are skipped
+        LstmForwardInferencePacked<DType, IType>(work_cpu_space,
+                                                 param_.state_outputs,
+                                                 param_.num_layers,
+                                                 direction,
+                                                 param_.seq_length_,
+                                                 param_.batch_size_,
+                                                 param_.input_size_,
+                                                 param_.state_size,
+                                                 in_data[seq_len_input_idx].dptr<IType>(),
+                                                 x.dptr_,
+                                                 hx.dptr_,
+                                                 cx_ptr,
+                                                 w.dptr_,
+                                                 b_ptr,
+                                                 y.dptr_,
+                                                 hy_ptr,
+                                                 cy_ptr);
       } else {
         RNNForwardInference<DType>(work_cpu_space,
                                    param_.state_outputs,
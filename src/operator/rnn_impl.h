@@ -29,6 +29,7 @@
 #include <dmlc/parameter.h>
 #include <mxnet/operator.h>
 #include <algorithm>
+#include <cmath>
 #include <random>
 #include <map>
 #include <vector>
@@ -53,6 +54,42 @@ inline DType relu(DType x) {
   return x > 0.0f ? static_cast<float>(x) : 0.0f;
 }
 
+/*!
+ * \brief Gate nonlinearities of the fused inference cells. The float versions use the tanh of
+ *        vectorized_math-inl.h, which has no calls into libm and therefore vectorizes inside the
+ *        gate loops. Other types use the exact ones.
+ */
+template <typename DType>
+inline DType fast_tanh(DType x) {
+  return tanh(x);
+}
+
+template <>
+inline float fast_tanh<float>(float x) {
+  return vmath::tanh<false>(x);
+}
+
+template <typename DType>
+inline DType fast_sigmoid(DType x) {
+  return sigmoid<DType>(x);
+}
+
+template <>
+inline float fast_sigmoid<float>(float x) {
+  return 0.5f + 0.5f * fast_tanh<float>(0.5f * x);
+}
+
+// Number of hidden units handled by one task of the fused gate loops.
+const int kRnnGateBlock = 64;
+
+/*!
+ * \brief Workspace of one direction of LstmForwardInferenceSingleLayer:
+ *        wx * x [T, N, 4, H], wh * h [N, 4, H], h [N, H], c [N, H] and projected h [N, P].
+ */
+inline index_t LstmInferenceDirectionWorkspaceSize(index_t T, index_t N, int H, int P) {
+  return (T + 1) * N * H * 4 + N * H * 2 + N * P;
+}
+
 template <typename DType>
 void LstmForwardTrainingSingleLayer(DType* ws,
                                     DType* rs,
@@ -230,82 +267,118 @@ void LstmForwardTraining(DType* ws,
 template <typename DType>
 void LstmForwardInferenceSingleLayer(DType* ws,
                                      bool state_outputs,
-                                     bool bid,
+                                     const int D,
                                      const index_t T,
                                      const index_t N,
                                      const index_t I,
                                      const int H,
                                      const int P,
                                      const Tensor<cpu, 2, DType>& x,
-                                     const Tensor<cpu, 2, DType>& hx,
-                                     const Tensor<cpu, 2, DType>& cx,
+                                     const Tensor<cpu, 3, DType>& hx,
+                                     const Tensor<cpu, 3, DType>& cx,
                                      const Tensor<cpu, 3, DType>& y,
                                      DType* w_ptr,
+                                     const index_t w_size,
                                      DType* b_ptr,
                                      DType* hy_ptr,
                                      DType* cy_ptr) {
   using namespace mshadow;
-  const Tensor<cpu, 2, DType> wx(w_ptr, Shape2(H * 4, I));
-  const Tensor<cpu, 2, DType> wh(w_ptr + I * H * 4, Shape2(H * 4, (P ? P : H)));
-  Tensor<cpu, 2, DType> whr(w_ptr, Shape2(1, 1));
-  if (P > 0)
-    whr = Tensor<cpu, 2, DType>(wh.dptr_ + P * 4 * H, Shape2(P, H));
-  const Tensor<cpu, 2, DType> bx(b_ptr, Shape2(4, H));
-  const Tensor<cpu, 2, DType> bh(b_ptr + H * 4, Shape2(4, H));
-  Tensor<cpu, 2, DType> yx_flat(ws, Shape2(T * N, H * 4));
-  Tensor<cpu, 2, DType> yh_flat(ws + T * N * H * 4, Shape2(N, H * 4));
-  const Tensor<cpu, 4, DType> yx(yx_flat.dptr_, Shape4(T, N, 4, H));
-  const Tensor<cpu, 3, DType> yh(yh_flat.dptr_, Shape3(N, 4, H));
-  Tensor<cpu, 2, DType> h(yh_flat.dptr_ + N * H * 4, Shape2(N, H));
-  Tensor<cpu, 2, DType> c(h.dptr_ + N * H, Shape2(N, H));
-  Tensor<cpu, 2, DType> r(hy_ptr, Shape2(1, 1));
-  if (P > 0)
-    r = Tensor<cpu, 2, DType>(hy_ptr, Shape2(N, P));
-  const int offset        = bid ? H : 0;
-  const int proj_offset   = bid ? P : 0;
-  const DType alpha       = 1.0;
-  const DType beta        = 0.0;
-  const index_t cell_size = N * H;
-  linalg_gemm(x, wx, yx_flat, alpha, beta, false, true);
+  // Both directions advance in lockstep: the gemms of a step are issued back to back and a
+  // single parallel loop then runs the fused gate update of every direction, so the reverse
+  // direction no longer waits for the whole forward pass. Each direction owns a workspace
+  // block laid out as yx [T, N, 4, H] | yh [N, 4, H] | h [N, H] | c [N, H] | r [N, P].
+  const int R                   = P ? P : H;
+  const index_t b_size          = 2 * H * 4;
+  const index_t cell_size       = N * H;
+  const index_t projection_size = N * R;
+  const index_t dir_ws_size     = LstmInferenceDirectionWorkspaceSize(T, N, H, P);
+  const index_t num_blocks      = (H + kRnnGateBlock - 1) / kRnnGateBlock;
+  const DType alpha             = 1.0;
+  const DType beta              = 0.0;
+  const int omp_threads         = mxnet::engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  for (int d = 0; d < D; ++d) {
+    const Tensor<cpu, 2, DType> wx(w_ptr + d * w_size, Shape2(H * 4, I));
+    Tensor<cpu, 2, DType> yx_flat(ws + d * dir_ws_size, Shape2(T * N, H * 4));
+    linalg_gemm(x, wx, yx_flat, alpha, beta, false, true);
+  }
 
-  const int omp_threads = mxnet::engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
   for (index_t i = 0; i < T; ++i) {
-    index_t t = bid ? T - 1 - i : i;
-    if (P > 0) {
-      linalg_gemm(i ? r : hx, wh, yh_flat, alpha, beta, false, true);
-    } else {
-      linalg_gemm(i ? h : hx, wh, yh_flat, alpha, beta, false, true);
-    }
-#pragma omp parallel for num_threads(omp_threads)
-    for (index_t jk = 0; jk < cell_size; ++jk) {
-      int j    = jk / H;
-      int k    = jk % H;
-      DType it = sigmoid<DType>(yx[t][j][0][k] + yh[j][0][k] + bx[0][k] + bh[0][k]);
-      DType ft = sigmoid<DType>(yx[t][j][1][k] + yh[j][1][k] + bx[1][k] + bh[1][k]);
-      DType gt = tanh(yx[t][j][2][k] + yh[j][2][k] + bx[2][k] + bh[2][k]);
-      DType ot = sigmoid<DType>(yx[t][j][3][k] + yh[j][3][k] + bx[3][k] + bh[3][k]);
-      DType ct = (i ? c[j][k] : cx[j][k]) * ft + it * gt;
-      DType ht = ot * tanh(ct);
-      if (P == 0)
-        y[t][j][k + offset] = ht;
-      if (i == T - 1 && state_outputs) {
-        if (P == 0)
-          hy_ptr[jk] = ht;
-        cy_ptr[jk] = ct;
+    for (int d = 0; d < D; ++d) {
+      DType* dir_ws = ws + d * dir_ws_size;
+      const Tensor<cpu, 2, DType> wh(w_ptr + d * w_size + I * H * 4, Shape2(H * 4, R));
+      Tensor<cpu, 2, DType> yh_flat(dir_ws + T * N * H * 4, Shape2(N, H * 4));
+      const Tensor<cpu, 2, DType> h(yh_flat.dptr_ + N * H * 4, Shape2(N, H));
+      const Tensor<cpu, 2, DType> r(h.dptr_ + N * H * 2, Shape2(N, P));
+      if (P > 0) {
+        linalg_gemm(i ? r : hx[d], wh, yh_flat, alpha, beta, false, true);
       } else {
-        c[j][k] = ct;
+        linalg_gemm(i ? h : hx[d], wh, yh_flat, alpha, beta, false, true);
+      }
+    }
+    const bool last_step = i == T - 1 && state_outputs;
+#pragma omp parallel for num_threads(omp_threads)
+    for (index_t task = 0; task < D * N * num_blocks; ++task) {
+      const int d        = task / (N * num_blocks);
+      const index_t j    = task / num_blocks % N;
+      const int k_begin  = task % num_blocks * kRnnGateBlock;
+      const int k_end    = std::min(k_begin + kRnnGateBlock, H);
+      const index_t t    = d ? T - 1 - i : i;
+      DType* dir_ws      = ws + d * dir_ws_size;
+      const DType* gx    = dir_ws + (t * N + j) * H * 4;
+      const DType* gh    = dir_ws + T * N * H * 4 + j * H * 4;
+      const DType* bx    = b_ptr + d * b_size;
+      const DType* bh    = bx + H * 4;
+      DType* h_row       = dir_ws + (T + 1) * N * H * 4 + j * H;
+      DType* c_row       = h_row + cell_size;
+      const DType* c_in  = i ? c_row : cx[d][j].dptr_;
+      DType* c_out       = last_step ? cy_ptr + d * cell_size + j * H : c_row;
+#pragma omp simd
+      for (int k = k_begin; k < k_end; ++k) {
+        const DType it = fast_sigmoid<DType>(gx[k] + gh[k] + bx[k] + bh[k]);
+        const DType ft = fast_sigmoid<DType>(gx[H + k] + gh[H + k] + bx[H + k] + bh[H + k]);
+        const DType gt = fast_tanh<DType>(gx[2 * H + k] + gh[2 * H + k] + bx[2 * H + k] +
+                                          bh[2 * H + k]);
+        const DType ot = fast_sigmoid<DType>(gx[3 * H + k] + gh[3 * H + k] + bx[3 * H + k] +
+                                             bh[3 * H + k]);
+        const DType ct = c_in[k] * ft + it * gt;
+        c_out[k]       = ct;
+        h_row[k]       = ot * fast_tanh<DType>(ct);
+      }
+      if (P == 0) {
+        DType* y_row = y[t][j].dptr_ + d * H;
+        for (int k = k_begin; k < k_end; ++k) {
+          y_row[k] = h_row[k];
+        }
+        if (last_step) {
+          DType* hy_row = hy_ptr + d * cell_size + j * H;
+          for (int k = k_begin; k < k_end; ++k) {
+            hy_row[k] = h_row[k];
+          }
+        }
       }
-      h[j][k] = ht;
     }
     if (P > 0) {
-      linalg_gemm(h, whr, r, alpha, beta, false, true);
+      for (int d = 0; d < D; ++d) {
+        DType* dir_ws = ws + d * dir_ws_size;
+        const Tensor<cpu, 2, DType> whr(w_ptr + d * w_size + I * H * 4 + P * H * 4, Shape2(P, H));
+        const Tensor<cpu, 2, DType> h(dir_ws + (T + 1) * N * H * 4, Shape2(N, H));
+        Tensor<cpu, 2, DType> r(h.dptr_ + N * H * 2, Shape2(N, P));
+        linalg_gemm(h, whr, r, alpha, beta, false, true);
+      }
 #pragma GCC diagnostic push
 #if __GNUC__ >= 8
 #pragma GCC diagnostic ignored "-Wclass-memaccess"
 #endif
 #pragma omp parallel for num_threads(omp_threads)
-      for (int j = 0; j < N; ++j) {
-        std::memcpy(y[t][j].dptr_ + proj_offset, r[j].dptr_, P * sizeof(DType));
+      for (index_t task = 0; task < D * N; ++task) {
+        const int d       = task / N;
+        const index_t j   = task % N;
+        const index_t t   = d ? T - 1 - i : i;
+        const DType* r_in = ws + d * dir_ws_size + (T + 1) * N * H * 4 + N * H * 2 + j * P;
+        std::memcpy(y[t][j].dptr_ + d * P, r_in, P * sizeof(DType));
+        if (last_step) {
+          std::memcpy(hy_ptr + d * projection_size + j * P, r_in, P * sizeof(DType));
+        }
       }
 #pragma GCC diagnostic pop
     }
@@ -336,7 +409,7 @@ void LstmForwardInference(DType* ws,
   const index_t b_size          = 2 * H * 4;
   const index_t cell_size       = N * H;
   const index_t projection_size = (P ? P : H) * N;
-  DType* y_tmp_ptr              = ws + (T + 1) * cell_size * 4 + cell_size * 2;
+  DType* y_tmp_ptr              = ws + D * LstmInferenceDirectionWorkspaceSize(T, N, H, P);
   DType* y_cur_ptr              = y_ptr;
   int idx                       = 0;  // state & cell state's idx;
   bool flag                     = L % 2 ? false : true;
@@ -355,55 +428,278 @@ void LstmForwardInference(DType* ws,
     Tensor<cpu, 3, DType> y(y_cur_ptr, Shape3(T, N, (P ? P : H) * D));
     LstmForwardInferenceSingleLayer<DType>(ws,
                                            state_outputs,
-                                           false,
+                                           D,
                                            T,
                                            N,
                                            input_size,
                                            H,
                                            P,
                                            x,
-                                           hx[idx],
-                                           cx[idx],
+                                           hx.Slice(idx, idx + D),
+                                           cx.Slice(idx, idx + D),
                                            y,
                                            w_ptr,
+                                           w_size,
                                            b_ptr,
                                            hy_ptr,
                                            cy_ptr);
-    // If bidirectional, then calculate the reverse direction's forward result.
-    if (D == 2) {
-      w_ptr += w_size;
-      b_ptr += b_size;
-      ++idx;
-      if (state_outputs) {
-        hy_ptr += projection_size;
-        cy_ptr += cell_size;
-      }
-      LstmForwardInferenceSingleLayer<DType>(ws,
-                                             state_outputs,
-                                             true,
-                                             T,
-                                             N,
-                                             input_size,
-                                             H,
-                                             P,
-                                             x,
-                                             hx[idx],
-                                             cx[idx],
-                                             y,
-                                             w_ptr,
-                                             b_ptr,
-                                             hy_ptr,
-                                             cy_ptr);
-    }
     // Don't need to move pointer in the last layer.
     if (i != L - 1) {
-      w_ptr += w_size;
-      b_ptr += b_size;
+      w_ptr += D * w_size;
+      b_ptr += D * b_size;
       x_ptr = y_cur_ptr;
-      ++idx;
+      idx += D;
       if (state_outputs) {
-        hy_ptr += projection_size;
-        cy_ptr += cell_size;
+        hy_ptr += D * projection_size;
+        cy_ptr += D * cell_size;
+      }
+    }
+  }
+}
+
+/*!
+ * \brief Length-sorted layout of a batch of variable-length sequences. The rows of the batch are
+ *        ordered by decreasing length, so the sequences still running at step t are the first
+ *        batch_sizes[t] rows, and the rows of step t start at offsets[t] in the packed arrays.
+ */
+struct RnnPackedLayout {
+  /*! \brief batch element of each sorted row */
+  std::vector<index_t> order;
+  /*! \brief running sequences of each step, batch_sizes[T] is 0 */
+  std::vector<index_t> batch_sizes;
+  /*! \brief first packed row of each step, offsets[T] is the number of packed rows */
+  std::vector<index_t> offsets;
+
+  template <typename IType>
+  RnnPackedLayout(const IType* seq_len, const index_t T, const index_t N)
+      : order(N), batch_sizes(T + 1, 0), offsets(T + 1, 0) {
+    std::vector<index_t> len(N);
+    for (index_t j = 0; j < N; ++j) {
+      len[j] = static_cast<index_t>(seq_len[j]);
+      CHECK(len[j] >= 0 && len[j] <= T) << "Sequence length " << len[j] << " of batch element "
+                                        << j << " is out of range [0, " << T << "]";
+      order[j] = j;
+    }
+    std::stable_sort(
+        order.begin(), order.end(), [&len](index_t a, index_t b) { return len[a] > len[b]; });
+    for (index_t j = 0; j < N; ++j) {
+      for (index_t t = 0; t < len[j]; ++t) {
+        ++batch_sizes[t];
+      }
+    }
+    for (index_t t = 0; t < T; ++t) {
+      offsets[t + 1] = offsets[t] + batch_sizes[t];
+    }
+  }
+
+  index_t total() const {
+    return offsets.back();
+  }
+};
+
+/*!
+ * \brief Workspace of LstmForwardInferencePacked: the packed input [T * N, I], two packed layer
+ *        outputs [T * N, D * H] and, per direction, wx * x [T * N, 4, H], wh * h [N, 4, H],
+ *        h [N, H] and c [N, H].
+ */
+inline index_t LstmPackedInferenceWorkspaceSize(int D, index_t T, index_t N, index_t I, int H) {
+  return T * N * (I + 2 * D * H) + D * ((T + 1) * N * H * 4 + N * H * 2);
+}
+
+template <typename DType>
+void LstmForwardInferencePackedSingleLayer(DType* ws,
+                                           bool state_outputs,
+                                           const int D,
+                                           const index_t T,
+                                           const index_t N,
+                                           const index_t I,
+                                           const int H,
+                                           const RnnPackedLayout& layout,
+                                           const Tensor<cpu, 2, DType>& x,
+                                           const Tensor<cpu, 3, DType>& hx,
+                                           const Tensor<cpu, 3, DType>& cx,
+                                           const Tensor<cpu, 2, DType>& y,
+                                           DType* w_ptr,
+                                           const index_t w_size,
+                                           DType* b_ptr,
+                                           DType* hy_ptr,
+                                           DType* cy_ptr) {
+  using namespace mshadow;
+  // Same lockstep scheme as LstmForwardInferenceSingleLayer, on packed rows: the gemms and the
+  // gate update of step t only cover the batch_sizes[t] running sequences. The reverse direction
+  // of a sequence starts at its own last step, from the initial state.
+  const std::vector<index_t>& batch_sizes = layout.batch_sizes;
+  const std::vector<index_t>& offsets     = layout.offsets;
+  const std::vector<index_t>& order       = layout.order;
+  const index_t b_size                    = 2 * H * 4;
+  const index_t cell_size                 = N * H;
+  const index_t dir_ws_size               = (T + 1) * N * H * 4 + N * H * 2;
+  const index_t num_blocks                = (H + kRnnGateBlock - 1) / kRnnGateBlock;
+  const DType alpha                       = 1.0;
+  const DType beta                        = 0.0;
+
+  const int omp_threads = mxnet::engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  if (layout.total() > 0) {
+    for (int d = 0; d < D; ++d) {
+      const Tensor<cpu, 2, DType> wx(w_ptr + d * w_size, Shape2(H * 4, I));
+      Tensor<cpu, 2, DType> yx_flat(ws + d * dir_ws_size, Shape2(layout.total(), H * 4));
+      linalg_gemm(x, wx, yx_flat, alpha, beta, false, true);
+    }
+  }
+
+  for (index_t i = 0; i < T; ++i) {
+    for (int d = 0; d < D; ++d) {
+      const index_t t = d ? T - 1 - i : i;
+      const index_t n = batch_sizes[t];
+      if (n == 0) {
+        continue;
+      }
+      DType* dir_ws = ws + d * dir_ws_size;
+      DType* h_ptr  = dir_ws + (T + 1) * N * H * 4;
+      DType* c_ptr  = h_ptr + cell_size;
+      // the sequences starting at this step are the rows [begin, n)
+      const index_t begin = d ? batch_sizes[t + 1] : (i ? n : 0);
+      for (index_t j = begin; j < n; ++j) {
+        std::copy(hx[d][order[j]].dptr_, hx[d][order[j]].dptr_ + H, h_ptr + j * H);
+        std::copy(cx[d][order[j]].dptr_, cx[d][order[j]].dptr_ + H, c_ptr + j * H);
+      }
+      const Tensor<cpu, 2, DType> wh(w_ptr + d * w_size + I * H * 4, Shape2(H * 4, H));
+      const Tensor<cpu, 2, DType> h(h_ptr, Shape2(n, H));
+      Tensor<cpu, 2, DType> yh_flat(dir_ws + T * N * H * 4, Shape2(n, H * 4));
+      linalg_gemm(h, wh, yh_flat, alpha, beta, false, true);
+    }
+#pragma omp parallel for num_threads(omp_threads)
+    for (index_t task = 0; task < D * N * num_blocks; ++task) {
+      const int d     = task / (N * num_blocks);
+      const index_t j = task / num_blocks % N;
+      const index_t t = d ? T - 1 - i : i;
+      if (j >= batch_sizes[t]) {
+        continue;
+      }
+      const int k_begin = task % num_blocks * kRnnGateBlock;
+      const int k_end   = std::min(k_begin + kRnnGateBlock, H);
+      DType* dir_ws     = ws + d * dir_ws_size;
+      const DType* gx   = dir_ws + (offsets[t] + j) * H * 4;
+      const DType* gh   = dir_ws + T * N * H * 4 + j * H * 4;
+      const DType* bx   = b_ptr + d * b_size;
+      const DType* bh   = bx + H * 4;
+      DType* h_row      = dir_ws + (T + 1) * N * H * 4 + j * H;
+      DType* c_row      = h_row + cell_size;
+#pragma omp simd
+      for (int k = k_begin; k < k_end; ++k) {
+        const DType it = fast_sigmoid<DType>(gx[k] + gh[k] + bx[k] + bh[k]);
+        const DType ft = fast_sigmoid<DType>(gx[H + k] + gh[H + k] + bx[H + k] + bh[H + k]);
+        const DType gt = fast_tanh<DType>(gx[2 * H + k] + gh[2 * H + k] + bx[2 * H + k] +
+                                          bh[2 * H + k]);
+        const DType ot = fast_sigmoid<DType>(gx[3 * H + k] + gh[3 * H + k] + bx[3 * H + k] +
+                                             bh[3 * H + k]);
+        const DType ct = c_row[k] * ft + it * gt;
+        c_row[k]       = ct;
+        h_row[k]       = ot * fast_tanh<DType>(ct);
+      }
+      std::copy(h_row + k_begin, h_row + k_end, y[offsets[t] + j].dptr_ + d * H + k_begin);
+      // the forward direction of a sequence ends at its last step, the reverse one at step 0
+      if (state_outputs && (d ? t == 0 : j >= batch_sizes[t + 1])) {
+        const index_t state_offset = d * cell_size + order[j] * H;
+        std::copy(h_row + k_begin, h_row + k_end, hy_ptr + state_offset + k_begin);
+        std::copy(c_row + k_begin, c_row + k_end, cy_ptr + state_offset + k_begin);
+      }
+    }
+  }
+  // empty sequences keep their initial state
+  if (state_outputs) {
+    for (int d = 0; d < D; ++d) {
+      for (index_t j = batch_sizes[0]; j < N; ++j) {
+        const index_t state_offset = d * cell_size + order[j] * H;
+        std::copy(hx[d][order[j]].dptr_, hx[d][order[j]].dptr_ + H, hy_ptr + state_offset);
+        std::copy(cx[d][order[j]].dptr_, cx[d][order[j]].dptr_ + H, cy_ptr + state_offset);
+      }
+    }
+  }
+}
+
+/*!
+ * \brief LSTM inference over sequences of different lengths, seq_len holding the length of each
+ *        batch element. The running rows of every step are packed once in length-sorted order,
+ *        the layers only compute those rows and the outputs of the padded steps are zero.
+ */
+template <typename DType, typename IType>
+void LstmForwardInferencePacked(DType* ws,
+                                bool state_outputs,
+                                const int L,
+                                const int D,
+                                const index_t T,
+                                const index_t N,
+                                const index_t I,
+                                const int H,
+                                const IType* seq_len,
+                                DType* x_ptr,
+                                DType* hx_ptr,
+                                DType* cx_ptr,
+                                DType* w_ptr,
+                                DType* b_ptr,
+                                DType* y_ptr,
+                                DType* hy_ptr,
+                                DType* cy_ptr) {
+  const RnnPackedLayout layout(seq_len, T, N);
+  const std::vector<index_t>& batch_sizes = layout.batch_sizes;
+  const std::vector<index_t>& offsets     = layout.offsets;
+  const std::vector<index_t>& order       = layout.order;
+  Tensor<cpu, 3, DType> hx(hx_ptr, Shape3(D * L, N, H));
+  Tensor<cpu, 3, DType> cx(cx_ptr, Shape3(D * L, N, H));
+  const index_t b_size    = 2 * H * 4;
+  const index_t cell_size = N * H;
+  DType* x_packed         = ws;
+  DType* y_packed[2]      = {x_packed + T * N * I, x_packed + T * N * (I + D * H)};
+  DType* layer_ws         = x_packed + T * N * (I + 2 * D * H);
+  const int omp_threads   = mxnet::engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t t = 0; t < T; ++t) {
+    for (index_t j = 0; j < batch_sizes[t]; ++j) {
+      const DType* x_row = x_ptr + (t * N + order[j]) * I;
+      std::copy(x_row, x_row + I, x_packed + (offsets[t] + j) * I);
+    }
+  }
+  for (int l = 0; l < L; ++l) {
+    const index_t input_size = l ? D * H : I;
+    const index_t w_size     = (input_size + H) * H * 4;
+    Tensor<cpu, 2, DType> x(l ? y_packed[(l - 1) % 2] : x_packed,
+                            Shape2(layout.total(), input_size));
+    Tensor<cpu, 2, DType> y(y_packed[l % 2], Shape2(layout.total(), D * H));
+    LstmForwardInferencePackedSingleLayer<DType>(layer_ws,
+                                                 state_outputs,
+                                                 D,
+                                                 T,
+                                                 N,
+                                                 input_size,
+                                                 H,
+                                                 layout,
+                                                 x,
+                                                 hx.Slice(l * D, (l + 1) * D),
+                                                 cx.Slice(l * D, (l + 1) * D),
+                                                 y,
+                                                 w_ptr,
+                                                 w_size,
+                                                 b_ptr,
+                                                 hy_ptr,
+                                                 cy_ptr);
+    w_ptr += D * w_size;
+    b_ptr += D * b_size;
+    if (state_outputs) {
+      hy_ptr += D * cell_size;
+      cy_ptr += D * cell_size;
+    }
+  }
+  const DType* y_last = y_packed[(L - 1) % 2];
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t t = 0; t < T; ++t) {
+    for (index_t j = 0; j < N; ++j) {
+      DType* y_row = y_ptr + (t * N + order[j]) * D * H;
+      if (j < batch_sizes[t]) {
+        const DType* y_in = y_last + (offsets[t] + j) * D * H;
+        std::copy(y_in, y_in + D * H, y_row);
+      } else {
+        std::fill(y_row, y_row + D * H, DType(0));
       }
     }
   }
@@ -739,25 +1035,20 @@ void GruForwardInferenceSingleLayer(DType* ws,
   DType* back_ht     = back_ht_1;
   DType* gemmC1      = ws;                          // [D, T, N, 3 * H]
   DType* gemmC2      = gemmC1 + D * T * N * 3 * H;  // N * 3 * H
-  DType* rt          = gemmC2 + N * 3 * H;
-  DType* zt          = rt + N * H;
-  DType* nt          = zt + N * H;
+  // The gates are fused into the state update, so the gate buffers hold back_gemmC2 instead.
+  DType* back_gemmC2 = gemmC2 + N * 3 * H;  // N * 3 * H
   DType* back_wx_ptr = wx_ptr + I * 3 * H + H * 3 * H;
   DType* back_wh_ptr = wh_ptr + I * 3 * H + H * 3 * H;
   DType* back_bx_ptr = (bx_ptr != nullptr) ? bx_ptr + 3 * H * 2 : nullptr;
   DType* back_bh_ptr = (bh_ptr != nullptr) ? bh_ptr + 3 * H * 2 : nullptr;
   DType* back_gemmC1 = gemmC1 + T * N * 3 * H;
-  DType* gemmC1_t    = gemmC1;
 
   const Tensor<cpu, 2, DType> wx(wx_ptr, Shape2(H * 3, I));
   const Tensor<cpu, 2, DType> wh(wh_ptr, Shape2(H * 3, H));
-  const Tensor<cpu, 2, DType> bx(bx_ptr, Shape2(3, H));
-  const Tensor<cpu, 2, DType> bh(bh_ptr, Shape2(3, H));
   const Tensor<cpu, 2, DType> back_wx(back_wx_ptr, Shape2(H * 3, I));
   const Tensor<cpu, 2, DType> back_wh(back_wh_ptr, Shape2(H * 3, H));
-  const Tensor<cpu, 2, DType> back_bx(back_bx_ptr, Shape2(3, H));
-  const Tensor<cpu, 2, DType> back_bh(back_bh_ptr, Shape2(3, H));
-  const int omp_threads = mxnet::engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  const index_t num_blocks = (H + kRnnGateBlock - 1) / kRnnGateBlock;
+  const int omp_threads    = mxnet::engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
   if (D == 1) {
 #pragma omp parallel for num_threads(omp_threads)
     for (index_t i = 0; i < N; i++)
@@ -775,6 +1066,7 @@ void GruForwardInferenceSingleLayer(DType* ws,
   Tensor<cpu, 2, DType> dgemmC1(ws, Shape2(T * N, 3 * H));
   Tensor<cpu, 2, DType> dgemmC2(gemmC2, Shape2(N, 3 * H));
   Tensor<cpu, 2, DType> dback_gemmC1(back_gemmC1, Shape2(T * N, 3 * H));
+  Tensor<cpu, 2, DType> dback_gemmC2(back_gemmC2, Shape2(N, 3 * H));
 
   // x * wx.T : [T * N, I] * [I, 3 * H]
   DType alpha = 1.0;
@@ -796,48 +1088,40 @@ void GruForwardInferenceSingleLayer(DType* ws,
       dht_1_tmp = reshape(dht_1.T(), Shape3(D, H, N));
       linalg_gemm(dht_1_tmp[0], wh, dgemmC2, alpha, beta, true, true);
     }
-    gemmC1_t = gemmC1 + t * N * 3 * H;
-#pragma omp parallel for num_threads(omp_threads)
-    for (index_t i = 0; i < N; ++i) {
-      for (int j = 0; j < H; ++j) {
-        index_t rtb   = i * 3 * H;
-        index_t ztb   = i * 3 * H + H;
-        index_t ntb   = i * 3 * H + 2 * H;
-        rt[i * H + j] = sigmoid(gemmC1_t[rtb + j] + gemmC2[rtb + j] + bx[0][j] + bh[0][j]);
-        zt[i * H + j] = sigmoid(gemmC1_t[ztb + j] + gemmC2[ztb + j] + bx[1][j] + bh[1][j]);
-        nt[i * H + j] =
-            tanh(gemmC1_t[ntb + j] + bx[2][j] + rt[i * H + j] * (gemmC2[ntb + j] + bh[2][j]));
-        ht[i * D * H + j] =
-            (1 - zt[i * H + j]) * nt[i * H + j] + zt[i * H + j] * ht_1[i * D * H + j];
-      }
-    }
-    ht_1 = ht;
-    ht   = ht + D * H * N;
-    //  perform the second direction
+    //  perform the second direction's recurrent gemm, both directions then update together
     if (D == 2) {
-      gemmC1_t = back_gemmC1 + (T - 1 - t) * N * 3 * H;
       Tensor<cpu, 2, DType> dback_ht_1(back_ht_1 - H, Shape2(N, D * H));
       Tensor<cpu, 3, DType> dback_ht_1_tmp =
           Tensor<cpu, 3, DType>(reinterpret_cast<DType*>(tmp_buf), Shape3(D, H, N));
       dback_ht_1_tmp = reshape(dback_ht_1.T(), Shape3(D, H, N));
-      linalg_gemm(dback_ht_1_tmp[1], back_wh, dgemmC2, alpha, beta, true, true);
-
-#pragma omp parallel for num_threads(omp_threads)
-      for (index_t i = 0; i < N; ++i) {
-        for (int j = 0; j < H; ++j) {
-          index_t rtb = i * 3 * H;
-          index_t ztb = i * 3 * H + H;
-          index_t ntb = i * 3 * H + 2 * H;
-          rt[i * H + j] =
-              sigmoid(gemmC1_t[rtb + j] + gemmC2[rtb + j] + back_bx[0][j] + back_bh[0][j]);
-          zt[i * H + j] =
-              sigmoid(gemmC1_t[ztb + j] + gemmC2[ztb + j] + back_bx[1][j] + back_bh[1][j]);
-          nt[i * H + j] = tanh(gemmC1_t[ntb + j] + back_bx[2][j] +
-                               rt[i * H + j] * (gemmC2[ntb + j] + back_bh[2][j]));
-          back_ht[i * D * H + j] =
-              (1 - zt[i * H + j]) * nt[i * H + j] + zt[i * H + j] * back_ht_1[i * D * H + j];
-        }
+      linalg_gemm(dback_ht_1_tmp[1], back_wh, dback_gemmC2, alpha, beta, true, true);
+    }
+#pragma omp parallel for num_threads(omp_threads)
+    for (index_t task = 0; task < D * N * num_blocks; ++task) {
+      const int d         = task / (N * num_blocks);
+      const index_t i     = task / num_blocks % N;
+      const int j_begin   = task % num_blocks * kRnnGateBlock;
+      const int j_end     = std::min(j_begin + kRnnGateBlock, H);
+      const DType* c1     = d ? back_gemmC1 + (T - 1 - t) * N * 3 * H : gemmC1 + t * N * 3 * H;
+      const DType* c2     = d ? back_gemmC2 : gemmC2;
+      const DType* bx     = d ? back_bx_ptr : bx_ptr;
+      const DType* bh     = d ? back_bh_ptr : bh_ptr;
+      const DType* h_prev = (d ? back_ht_1 : ht_1) + i * D * H;
+      DType* h_next       = (d ? back_ht : ht) + i * D * H;
+      c1 += i * 3 * H;
+      c2 += i * 3 * H;
+#pragma omp simd
+      for (int j = j_begin; j < j_end; ++j) {
+        const DType rt = fast_sigmoid<DType>(c1[j] + c2[j] + bx[j] + bh[j]);
+        const DType zt = fast_sigmoid<DType>(c1[H + j] + c2[H + j] + bx[H + j] + bh[H + j]);
+        const DType nt =
+            fast_tanh<DType>(c1[2 * H + j] + bx[2 * H + j] + rt * (c2[2 * H + j] + bh[2 * H + j]));
+        h_next[j] = (1 - zt) * nt + zt * h_prev[j];
       }
+    }
+    ht_1 = ht;
+    ht   = ht + D * H * N;
+    if (D == 2) {
       back_ht_1 = back_ht;
       back_ht   = back_ht - D * H * N;
     }
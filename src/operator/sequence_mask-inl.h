@@ -112,8 +112,9 @@ class SequenceMaskOp : public Operator {
     Shape<3> s3                = Shape3(d0, d1, rest_size);
     Tensor<xpu, 3, DType> data = in_data[seq_mask::kData].get_with_shape<xpu, 3, DType>(s3, s);
     Tensor<xpu, 3, DType> out  = out_data[seq_mask::kOut].get_with_shape<xpu, 3, DType>(s3, s);
-    // Actual implementation of masking
-    Assign(out, req[seq_mask::kOut], F<mshadow_op::identity>(data));
+    // Actual implementation of masking, in place only the padded steps are touched
+    if (req[seq_mask::kOut] != kWriteInplace)
+      Assign(out, req[seq_mask::kOut], F<mshadow_op::identity>(data));
     if (param_.use_sequence_length) {
       Tensor<xpu, 1, IType> indices = in_data[seq_mask::kSequenceLength].get<xpu, 1, IType>(s);
       SequenceMaskExec<DType, IType>(
@@ -159,7 +160,8 @@ class SequenceMaskOp : public Operator {
         SequenceMaskExec<DType, IType>(out_g, indices, kWriteInplace, s, param_.axis, DType(0.));
         Assign(data_g, kAddTo, F<mshadow_op::identity>(out_g));
       } else {
-        Assign(data_g, req[seq_mask::kData], F<mshadow_op::identity>(out_g));
+        if (req[seq_mask::kData] != kWriteInplace)
+          Assign(data_g, req[seq_mask::kData], F<mshadow_op::identity>(out_g));
         SequenceMaskExec<DType, IType>(
             data_g, indices, req[seq_mask::kData], s, param_.axis, DType(0.));
       }
@@ -21,8 +21,13 @@
  * \file build_subgraph.cc
  * \brief
  */
+#include <dmlc/json.h>
 #include <nnvm/graph.h>
 #include <nnvm/pass.h>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
 #include <unordered_set>
 #include <stack>
 #include <queue>
@@ -656,6 +661,155 @@ void CutGraphInputs(const std::vector<nnvm::NodeEntry*>& input_entries,
  * by CutGraphInputs. This function is used when subgraphs are rejected, it
  * reattaches the subgraph back to the main graph where it was cut earlier.
  */
+/*!
+ * \brief Evaluates the candidate subgraphs with the cost model. Candidates whose node gain does
+ * not exceed the cost of their boundary entries are rejected, the worst first, entries exchanged
+ * with accepted candidates being free. Then regions of neighbouring accepted candidates with
+ * less nodes than the minimum subgraph size are rejected.
+ * \param accepted whether each candidate is kept
+ * \param report JSON array with the decision on each candidate
+ */
+void EvaluateSubgraphs(const nnvm::Graph& g,
+                       const SubgraphCostModel& cost_model,
+                       const std::vector<std::vector<BiDirectedNode*>>& subgraph_nodes,
+                       std::vector<bool>* accepted,
+                       std::string* report) {
+  using EntryKey             = std::pair<const nnvm::Node*, uint32_t>;
+  const size_t num_subgraphs = subgraph_nodes.size();
+  std::unordered_map<const nnvm::Node*, int> subgraph_of;
+  for (size_t i = 0; i < num_subgraphs; ++i) {
+    for (const BiDirectedNode* sn : subgraph_nodes[i])
+      subgraph_of[sn->node] = i;
+  }
+  // -1 stands for the rest of the graph
+  auto subgraph_id = [&](const nnvm::Node* node) {
+    auto it = subgraph_of.find(node);
+    return it == subgraph_of.end() ? -1 : it->second;
+  };
+
+  // boundary entries of every candidate, with the candidates on their other side
+  struct Boundary {
+    double cost;
+    std::vector<int> peers;
+  };
+  std::vector<std::vector<Boundary>> boundaries(num_subgraphs);
+  std::vector<double> gains(num_subgraphs, 0.0);
+  std::vector<std::unordered_set<int>> neighbours(num_subgraphs);
+  for (size_t i = 0; i < num_subgraphs; ++i) {
+    const int id = i;
+    std::map<EntryKey, std::pair<nnvm::NodeEntry, std::vector<int>>> entries;
+    auto add_entry = [&](const nnvm::Node* node, const nnvm::NodeEntry& e, int peer) {
+      auto& entry = entries[EntryKey(node, e.index)];
+      entry.first = e;
+      entry.second.push_back(peer);
+      if (peer != -1)
+        neighbours[id].insert(peer);
+    };
+    for (const BiDirectedNode* sn : subgraph_nodes[i]) {
+      gains[i] += cost_model.NodeGain(*sn->node);
+      for (const auto& e : sn->node->inputs) {
+        const int peer = subgraph_id(e.node.get());
+        if (peer != id)
+          add_entry(e.node.get(), e, peer);
+      }
+      for (const auto& kv : sn->outputs) {
+        const int peer = subgraph_id(kv.first);
+        if (peer == id)
+          continue;
+        for (size_t idx : kv.second)
+          add_entry(sn->node, kv.first->inputs[idx], peer);
+      }
+    }
+    for (const auto& e : g.outputs) {
+      if (subgraph_id(e.node.get()) == id)
+        add_entry(e.node.get(), e, -1);
+    }
+    for (const auto& kv : entries)
+      boundaries[i].push_back({cost_model.TransitionCost(kv.second.first), kv.second.second});
+  }
+
+  // an entry is free when everything on its other side is in accepted subgraphs
+  accepted->assign(num_subgraphs, true);
+  std::vector<double> costs(num_subgraphs, 0.0);
+  std::vector<std::string> reasons(num_subgraphs, "accepted");
+  auto update_cost = [&](int i) {
+    costs[i] = 0.0;
+    for (const auto& b : boundaries[i]) {
+      for (int peer : b.peers) {
+        if (peer == -1 || !accepted->at(peer)) {
+          costs[i] += b.cost;
+          break;
+        }
+      }
+    }
+  };
+  for (size_t i = 0; i < num_subgraphs; ++i)
+    update_cost(i);
+  while (true) {
+    int worst = -1;
+    for (size_t i = 0; i < num_subgraphs; ++i) {
+      if (accepted->at(i) && gains[i] <= costs[i] &&
+          (worst == -1 || gains[i] - costs[i] < gains[worst] - costs[worst]))
+        worst = i;
+    }
+    if (worst == -1)
+      break;
+    (*accepted)[worst] = false;
+    reasons[worst]     = "gain does not exceed transition cost";
+    for (int peer : neighbours[worst])
+      update_cost(peer);
+  }
+
+  std::vector<int> regions(num_subgraphs, -1);
+  std::vector<size_t> region_sizes;
+  for (size_t i = 0; i < num_subgraphs; ++i) {
+    if (!accepted->at(i) || regions[i] != -1)
+      continue;
+    const int region = region_sizes.size();
+    region_sizes.push_back(0);
+    std::vector<int> stack{static_cast<int>(i)};
+    regions[i] = region;
+    while (!stack.empty()) {
+      const int cur = stack.back();
+      stack.pop_back();
+      region_sizes[region] += subgraph_nodes[cur].size();
+      for (int peer : neighbours[cur]) {
+        if (accepted->at(peer) && regions[peer] == -1) {
+          regions[peer] = region;
+          stack.push_back(peer);
+        }
+      }
+    }
+  }
+  for (size_t i = 0; i < num_subgraphs; ++i) {
+    if (accepted->at(i) && region_sizes[regions[i]] < cost_model.MinSubgraphSize()) {
+      (*accepted)[i] = false;
+      reasons[i]     = "region smaller than the minimum subgraph size";
+    }
+  }
+
+  std::ostringstream os;
+  dmlc::JSONWriter writer(&os);
+  writer.BeginArray();
+  for (size_t i = 0; i < num_subgraphs; ++i) {
+    std::vector<std::string> names;
+    for (const BiDirectedNode* sn : subgraph_nodes[i])
+      names.push_back(sn->node->attrs.name);
+    writer.WriteArraySeperator();
+    writer.BeginObject();
+    writer.WriteObjectKeyValue("id", static_cast<int>(i));
+    writer.WriteObjectKeyValue("nodes", names);
+    writer.WriteObjectKeyValue("region", regions[i]);
+    writer.WriteObjectKeyValue("gain", gains[i]);
+    writer.WriteObjectKeyValue("transition_cost", costs[i]);
+    writer.WriteObjectKeyValue("decision", std::string(accepted->at(i) ? "accepted" : "rejected"));
+    writer.WriteObjectKeyValue("reason", reasons[i]);
+    writer.EndObject();
+  }
+  writer.EndArray();
+  *report = os.str();
+}
+
 void ReattachGraphInputs(const std::vector<nnvm::NodeEntry*>& input_entries,
                          std::vector<nnvm::NodeEntry>* orig_entries) {
   for (size_t i = 0; i < input_entries.size(); ++i) {
@@ -880,7 +1034,30 @@ nnvm::Graph BuildSubgraph(nnvm::Graph&& g) {
   std::vector<SubgraphSelectorV2Ptr> subgraph_selectors;
   FindSubgraphs(&g, *subg_prop, simple_nodes, &subgraph_nodes, &subgraph_selectors);
   CHECK_EQ(subgraph_nodes.size(), subgraph_selectors.size());
+  std::vector<bool> accepted(subgraph_nodes.size(), true);
+  SubgraphCostModelPtr cost_model = subg_prop->CreateSubgraphCostModel(g);
+  if (cost_model) {
+    std::string report;
+    EvaluateSubgraphs(g, *cost_model, subgraph_nodes, &accepted, &report);
+    subg_prop->SetAttr("partition_report", report);
+    if (verbose > 0) {
+      LOG(INFO) << "Accepted " << std::count(accepted.begin(), accepted.end(), true) << " of "
+                << accepted.size() << " candidate subgraphs";
+    }
+    if (verbose > 1)
+      LOG(INFO) << "Partition report: " << report;
+    if (g.HasAttr("options_map")) {
+      const auto& options = g.GetAttr<std::unordered_map<std::string, std::string>>("options_map");
+      if (options.count("partition_report") > 0) {
+        std::ofstream fo(options.at("partition_report"), std::ios::app);
+        CHECK(fo) << "Cannot open partition report " << options.at("partition_report");
+        fo << report << "\n";
+      }
+    }
+  }
   for (size_t i = 0; i < subgraph_nodes.size(); ++i) {
+    if (!accepted[i])
+      continue;
 #if DEBUG_SUBGRAPH
     std::set<BiDirectedNode*> simple_node_set(subgraph_nodes[i].begin(), subgraph_nodes[i].end());
     CHECK_EQ(simple_node_set.size(), subgraph_nodes[i].size());
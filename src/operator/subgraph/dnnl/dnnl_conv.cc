@@ -109,6 +109,7 @@ class SgDNNLConvOperator {
   dnnl_args_map_t args_;
   NDArray cached_weight_;
   NDArray cached_bias_;
+  std::shared_ptr<const DNNLPackedWeights::Packed> packed_weights_;
   float cached_data_min_;
   float cached_data_max_;
   float cached_sum_min_;
@@ -336,14 +337,36 @@ void SgDNNLConvOperator::Forward(const OpContext& ctx,
     dnnl::memory::desc bias_md;
     if (has_bias)
       bias_md = fwd_->GetPd().bias_desc();
-    ConvertWeightBias2DNNL(&cached_weight_,
-                           &cached_bias_,
-                           has_bias,
-                           fwd_->GetPd().weights_desc(),
-                           has_bias ? &bias_md : nullptr,
-                           conv_param.num_group,
-                           data_scale_,
-                           weight_scales_);
+    // the packing follows from the parameters, the batch norm folded into them and the scales
+    DNNLConvSignature key(conv_param);
+    key.AddSign(fwd_->GetPd().weights_desc());
+    key.AddSign(data_scale_);
+    key.AddSign(weight_scales_);
+    std::vector<NDArray> sources{inputs[in_weight]};
+    if (!conv_param.no_bias)
+      sources.push_back(inputs[in_bias]);
+    if (dnnl_param.with_bn) {
+      key.AddSign(static_cast<float>(bn_param->eps));
+      key.AddSign(static_cast<int>(bn_param->fix_gamma));
+      sources.insert(sources.end(),
+                     {inputs[in_gamma], inputs[in_beta], inputs[in_mean], inputs[in_var]});
+    }
+    packed_weights_ = DNNLPackedWeights::Get()->GetOrPack(
+        key, sources, [&](DNNLPackedWeights::Packed* packed) {
+          packed->weight = cached_weight_;
+          packed->bias   = cached_bias_;
+          ConvertWeightBias2DNNL(&packed->weight,
+                                 &packed->bias,
+                                 has_bias,
+                                 fwd_->GetPd().weights_desc(),
+                                 has_bias ? &bias_md : nullptr,
+                                 conv_param.num_group,
+                                 data_scale_,
+                                 weight_scales_,
+                                 false);
+        });
+    cached_weight_ = packed_weights_->weight;
+    cached_bias_   = packed_weights_->bias;
     args_[DNNL_ARG_SRC]     = *data.GetDNNLData();
     args_[DNNL_ARG_WEIGHTS] = *cached_weight_.GetDNNLData();
     if (has_bias)
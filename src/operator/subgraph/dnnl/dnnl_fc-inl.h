@@ -22,11 +22,16 @@
 
 #if MXNET_USE_ONEDNN == 1
 
+#include <cmath>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "operator/nn/dnnl/dnnl_act-inl.h"
 #include "operator/nn/dnnl/dnnl_fully_connected-inl.h"
+#include "operator/tensor/elemwise_binary_scalar_op.h"
+#include "operator/tensor/matrix_op-inl.h"
 #include "dnnl.hpp"
 
 namespace mxnet {
@@ -58,6 +63,89 @@ static inline dnnl::algorithm GetDNNLEltwiseAlgo(const std::string op_name) {
   return dnnl::algorithm::undef;
 }
 
+/*!
+ * \brief Appends the post-op computing the node to a chain of float post-ops of FullyConnected,
+ *  the arithmetic with a scalar is a linear step folded into the linear step before it. Returns
+ *  false if oneDNN has no post-op for the node.
+ */
+static inline bool AppendDNNLFCPostEltwise(const nnvm::Node& n,
+                                           std::vector<DNNLPostEltwiseParam>* chain) {
+  if (!n.op() || n.num_inputs() != 1)
+    return false;
+  const std::string& name = n.op()->name;
+  DNNLPostEltwiseParam step;
+  if (name == "Activation") {
+    const ActivationParam& param = nnvm::get<ActivationParam>(n.attrs.parsed);
+    if (!SupportDNNLAct(param))
+      return false;
+    step.alg = GetDNNLActAlgo(param);
+  } else if (name == "LeakyReLU") {
+    const LeakyReLUParam& param = nnvm::get<LeakyReLUParam>(n.attrs.parsed);
+    if (!SupportDNNLLeakyRelu(param))
+      return false;
+    step.alg   = GetDNNLActAlgo(param);
+    step.alpha = param.slope;
+  } else if (name == "clip") {
+    const ClipParam& param = nnvm::get<ClipParam>(n.attrs.parsed);
+    step.alg               = dnnl::algorithm::eltwise_clip;
+    step.alpha             = param.a_min;
+    step.beta              = param.a_max;
+  } else if (name == "square" || name == "_npi_square" || name == "sqrt" || name == "_npi_sqrt" ||
+             name == "exp" || name == "_npi_exp" || name == "abs" || name == "_npi_absolute") {
+    step.alg = GetDNNLEltwiseAlgo(name);
+  } else if (name == "tanh" || name == "_npi_tanh") {
+    step.alg = dnnl::algorithm::eltwise_tanh;
+  } else if (name == "sigmoid") {
+    step.alg = dnnl::algorithm::eltwise_logistic;
+  } else if (name == "log" || name == "_npi_log") {
+    step.alg = dnnl::algorithm::eltwise_log;
+  } else {
+    static const std::unordered_set<std::string> scalar_ops = {"_plus_scalar",
+                                                               "_npi_add_scalar",
+                                                               "_minus_scalar",
+                                                               "_npi_subtract_scalar",
+                                                               "_rminus_scalar",
+                                                               "_npi_rsubtract_scalar",
+                                                               "_mul_scalar",
+                                                               "_npi_multiply_scalar",
+                                                               "_div_scalar",
+                                                               "_npi_true_divide_scalar"};
+    if (!scalar_ops.count(name))
+      return false;
+    const float scalar = nnvm::get<NumpyBinaryScalarParam>(n.attrs.parsed).scalar;
+    step.alg           = dnnl::algorithm::eltwise_linear;
+    step.alpha         = 1.f;
+    step.beta          = 0.f;
+    if (name == "_plus_scalar" || name == "_npi_add_scalar") {
+      step.beta = scalar;
+    } else if (name == "_minus_scalar" || name == "_npi_subtract_scalar") {
+      step.beta = -scalar;
+    } else if (name == "_rminus_scalar" || name == "_npi_rsubtract_scalar") {
+      step.alpha = -1.f;
+      step.beta  = scalar;
+    } else if (name == "_mul_scalar" || name == "_npi_multiply_scalar") {
+      step.alpha = scalar;
+    } else {
+      step.alpha = 1.f / scalar;
+    }
+    if (!std::isfinite(step.alpha) || !std::isfinite(step.beta))
+      return false;
+    if (!chain->empty() && chain->back().alg == dnnl::algorithm::eltwise_linear) {
+      chain->back().beta  = step.alpha * chain->back().beta + step.beta;
+      chain->back().alpha = step.alpha * chain->back().alpha;
+      return true;
+    }
+  }
+  chain->push_back(step);
+  return true;
+}
+
+/*! \brief Whether the node can be a step of a chain of float post-ops of FullyConnected */
+static inline bool SupportDNNLFCPostEltwise(const nnvm::Node& n) {
+  std::vector<DNNLPostEltwiseParam> chain;
+  return AppendDNNLFCPostEltwise(n, &chain);
+}
+
 static inline bool IsOutputUint8(const DNNLFCFullParam& full_param) {
   auto alg = full_param.eltwise_param.alg;
   // TODO(ciyong): some alg doesn't support int8 so far.
@@ -79,8 +79,8 @@ class SgDNNLFCOp {
                            const std::vector<float>& min_max_vec);
   dnnl::memory::desc CreateOutputMemoryDesc(const mxnet::TShape& oshape, int out_dtype);
   void GetCachedWeightsAndBias(const NDArray& weight,
-                               bool support_channelwise_scale,
-                               bool has_bias);
+                               const NDArray* bias,
+                               bool support_channelwise_scale);
   nnvm::Symbol subgraph_sym_;
   nnvm::NodeAttrs attrs;
   DNNLFCFullParam full_param_;
@@ -93,6 +93,7 @@ class SgDNNLFCOp {
   std::shared_ptr<dnnl::memory> cached_out_mem_;
   NDArray cached_weight_;
   NDArray cached_bias_;
+  std::shared_ptr<const DNNLPackedWeights::Packed> packed_weights_;
   float cached_data_min_;
   float cached_data_max_;
   float cached_weight_min_;
@@ -210,7 +211,8 @@ void SgDNNLFCOp::Forward(const OpContext& ctx,
                                              cached_weight_,
                                              (has_bias ? &cached_bias_ : nullptr),
                                              out_md));
-    GetCachedWeightsAndBias(weight, support_channelwise_scale, has_bias);
+    GetCachedWeightsAndBias(
+        weight, has_bias ? &in_data[idx.bias] : nullptr, support_channelwise_scale);
 
     const auto data_mem = static_cast<const dnnl::memory*>(data.GetDNNLData());
     cached_data_mem_    = std::make_shared<dnnl::memory>(data_mem->get_desc(), engine);
@@ -505,46 +507,21 @@ bool SgDNNLFCOp::PrepareQuantization(const OpContext& ctx,
 }
 
 void SgDNNLFCOp::GetCachedWeightsAndBias(const NDArray& weight,
-                                         bool support_channelwise_scale,
-                                         bool has_bias) {
-#if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLFullyconSignature, std::pair<NDArray, NDArray>, OpHash>
-      fcWeightsAndBias;
-#else
-  static MX_THREAD_LOCAL
-      std::unordered_map<DNNLFullyconSignature, std::pair<NDArray, NDArray>, OpHash>
-          fcWeightsAndBias;
-#endif
+                                         const NDArray* bias,
+                                         bool support_channelwise_scale) {
   static const bool use_cache = !(dmlc::GetEnv("MXNET_ONEDNN_DISABLE_FC_CACHE", 0));
-  const bool has_id           = attrs.dict.count("__identifier__");
-  bool read_from_cache        = false;
+  const bool has_bias         = bias != nullptr;
 
-  DNNLFullyconSignature key(full_param_);
-  if (use_cache && has_id) {
-    key.AddSign(fwd_->fwd_pd.weights_desc());
-    key.AddSign(attrs.dict["__identifier__"]);
-    key.AddSign(attrs.name);
-
-    auto it = fcWeightsAndBias.find(key);
-    if (it != fcWeightsAndBias.end()) {
-      cached_weight_  = it->second.first;
-      cached_bias_    = it->second.second;
-      read_from_cache = true;
-      common::LogOnce(
-          "oneDNN optimized version of FullyConnected for inference is being used. Weights and "
-          "bias are cached and can not be dynamically changed during runtime. To disable caching "
-          "mechanism use MXNET_ONEDNN_DISABLE_FC_CACHE=1.");
-    }
-  }
-
-  if (!read_from_cache) {
+  auto pack = [&](DNNLPackedWeights::Packed* packed) {
+    packed->weight = cached_weight_;
+    packed->bias   = cached_bias_;
     // convert weight and bias to the format that oneDNN requires
     if (!full_param_.dnnl_param.quantized || support_channelwise_scale) {
       dnnl::memory::desc bias_md;
       if (has_bias)
         bias_md = fwd_->fwd_pd.bias_desc();
-      ConvertWeightBias2DNNL(&cached_weight_,
-                             &cached_bias_,
+      ConvertWeightBias2DNNL(&packed->weight,
+                             &packed->bias,
                              has_bias,
                              fwd_->fwd_pd.weights_desc(),
                              has_bias ? &bias_md : nullptr,
@@ -556,17 +533,34 @@ void SgDNNLFCOp::GetCachedWeightsAndBias(const NDArray& weight,
       const auto def_weight_mem = weight.GetDNNLData();
       if (def_weight_mem->get_desc() != fwd_->fwd_pd.weights_desc()) {
         auto weight_desc       = fwd_->fwd_pd.weights_desc();
-        cached_weight_         = NDArray(&weight_desc);
-        auto cached_weight_mem = cached_weight_.GetDNNLData();
+        packed->weight         = NDArray(&weight_desc);
+        auto cached_weight_mem = packed->weight.GetDNNLData();
         std::unordered_map<int, dnnl::memory> args(
             {{DNNL_ARG_FROM, *def_weight_mem}, {DNNL_ARG_TO, *cached_weight_mem}});
         DNNLStream::Get()->RegisterPrimArgs(dnnl::reorder(*def_weight_mem, *cached_weight_mem),
                                             args);
       }
     }
-    if (use_cache && has_id)
-      AddToCache(&fcWeightsAndBias, key, {cached_weight_, cached_bias_});
+  };
+
+  if (!use_cache) {
+    DNNLPackedWeights::Packed packed;
+    pack(&packed);
+    cached_weight_ = packed.weight;
+    cached_bias_   = packed.bias;
+    return;
   }
+  // the packing follows from the parameters and the scales derived from them and from the data
+  DNNLFullyconSignature key(full_param_);
+  key.AddSign(fwd_->fwd_pd.weights_desc());
+  key.AddSign(data_scale_);
+  key.AddSign(weight_scales_);
+  std::vector<NDArray> sources{weight};
+  if (has_bias)
+    sources.push_back(*bias);
+  packed_weights_ = DNNLPackedWeights::Get()->GetOrPack(key, sources, pack);
+  cached_weight_  = packed_weights_->weight;
+  cached_bias_    = packed_weights_->bias;
 }
 
 static void SgDNNLFCParamParser(nnvm::NodeAttrs* attrs) {
@@ -592,12 +586,20 @@ static void SgDNNLFCParamParser(nnvm::NodeAttrs* attrs) {
     throw dmlc::ParamError(os.str());
   }
   auto subgraph_sym = attrs->subgraphs[0];
+  // the float FullyConnected runs any chain of post-ops, the quantized one no more than one
+  std::vector<DNNLPostEltwiseParam> chain;
   DFSVisit(subgraph_sym->outputs, [&](const nnvm::ObjectPtr& node) {
     if (node->is_variable())
       return;
     auto& op_name = node->op()->name;
     if (op_name == "FullyConnected") {
       full_param.default_param = nnvm::get<FullyConnectedParam>(node->attrs.parsed);
+    } else if (!full_param.dnnl_param.quantized) {
+      // the add of the sum is the only binary node
+      if (node->num_inputs() == 1) {
+        CHECK(AppendDNNLFCPostEltwise(*node, &chain))
+            << "Unexpected node " << node->attrs.name << " after the FullyConnected";
+      }
     } else if (SupportDNNLFCEltwiseFusion(op_name)) {
       if (op_name == "Activation") {
         const ActivationParam act_param = nnvm::get<ActivationParam>(node->attrs.parsed);
@@ -615,6 +617,10 @@ static void SgDNNLFCParamParser(nnvm::NodeAttrs* attrs) {
       }
     }
   });
+  if (!chain.empty()) {
+    full_param.eltwise_param = chain[0];
+    full_param.eltwise_tail.assign(chain.begin() + 1, chain.end());
+  }
   attrs->parsed = std::move(full_param);
 }
 
@@ -827,6 +833,26 @@ static void SgDNNLFCForward(const OpStatePtr& state_pointer,
   op.Forward(ctx, inputs, req, outputs);
 }
 
+static QuantizeType SgDNNLFCQuantizable(const NodeAttrs& attrs) {
+  // the quantized FullyConnected fuses one of its own post-ops at most
+  size_t num_eltwise = 0;
+  bool supported     = true;
+  DFSVisit(attrs.subgraphs[0]->outputs, [&](const nnvm::ObjectPtr& node) {
+    if (node->is_variable() || node->op()->name == "FullyConnected" || node->num_inputs() != 1)
+      return;
+    const std::string& name = node->op()->name;
+    ++num_eltwise;
+    if (name == "Activation") {
+      supported &= SupportDNNLQuantizedAct(nnvm::get<ActivationParam>(node->attrs.parsed));
+    } else if (name == "clip") {
+      supported &= nnvm::get<ClipParam>(node->attrs.parsed).a_min == 0.f;
+    } else {
+      supported &= SupportDNNLFCEltwiseFusion(name);
+    }
+  });
+  return supported && num_eltwise <= 1 ? QuantizeType::kMust : QuantizeType::kNone;
+}
+
 nnvm::ObjectPtr SgDNNLFCQuantizedOp(const NodeAttrs& attrs) {
   nnvm::ObjectPtr node          = nnvm::Node::Create();
   node->attrs.op                = Op::Get("_sg_onednn_fully_connected");
@@ -893,8 +919,7 @@ NNVM_REGISTER_OP(_sg_onednn_fully_connected)
     .set_attr<nnvm::FMutateInputs>("FMutateInputs", DefaultSubgraphOpMutableInputs)
     .set_attr<std::string>("key_var_num_args", "num_args")
     .set_attr<nnvm::FInplaceOption>("FInplaceOption", SgDNNLFCInplaceOption)
-    .set_attr<FQuantizable>("FQuantizable",
-                            [](const NodeAttrs& attrs) { return QuantizeType::kMust; })
+    .set_attr<FQuantizable>("FQuantizable", SgDNNLFCQuantizable)
     .set_attr<FQuantizedOp>("FQuantizedOp", SgDNNLFCQuantizedOp)
     .set_attr<FNeedRequantize>("FNeedRequantize", [](const NodeAttrs& attrs) { return true; })
     .set_attr<FAvoidQuantizeInput>("FAvoidQuantizeInput", SgDNNLAvoidFCQuantizeInput);
@@ -83,6 +83,15 @@ class SgDNNLFCSelector : public SubgraphSelector {
 
     switch (status_) {
       case kStart:
+        // The float FC folds any chain of the eltwise and scalar ops oneDNN has post-ops for.
+        if (!quantized_) {
+          if (SupportDNNLFCPostEltwise(new_node)) {
+            matched_list_.push_back(&new_node);
+            return true;
+          }
+          status_ = kSuccess;
+          return false;
+        }
         // Currently, For INT8 FC fusion, only supports relu/bounded_relu(clip)/abs.
         if (new_node.op() == Op::Get("Activation")) {
           const ActivationParam& param = nnvm::get<ActivationParam>(new_node.attrs.parsed);
@@ -136,7 +145,8 @@ class SgDNNLFCSelector : public SubgraphSelector {
           ret.push_back(non_const_i);
         }
       }
-      return candidates;
+      // the nodes popped out at an internal branch of the chain are not fused
+      return ret;
     }
   }
 
@@ -167,9 +177,7 @@ class SgDNNLFCProperty : public SubgraphProperty {
 
   nnvm::ObjectPtr CreateSubgraphNode(const nnvm::Symbol& sym,
                                      const int subgraph_id = 0) const override {
-    // distingush between exactly same node in different networks - for caching weights
-    static unsigned int node_identifier = 0;
-    nnvm::ObjectPtr n                   = nnvm::Node::Create();
+    nnvm::ObjectPtr n = nnvm::Node::Create();
     // This op has single output, remove duplicated.
     auto last_node = sym.outputs[0].node;
     nnvm::Symbol new_sym;
@@ -182,7 +190,7 @@ class SgDNNLFCProperty : public SubgraphProperty {
       auto& sub_name = node->op()->name;
       if (sub_name == "FullyConnected") {
         node_name << "fully_connected_";
-      } else if (SupportDNNLFCEltwiseFusion(sub_name)) {
+      } else if (!n->attrs.dict.count("with_eltwise")) {
         node_name << "eltwise_";
         n->attrs.dict["with_eltwise"] = "True";
       }
@@ -191,7 +199,6 @@ class SgDNNLFCProperty : public SubgraphProperty {
     n->attrs.name = node_name.str();
     n->attrs.op   = Op::Get("_sg_onednn_fully_connected");
     CHECK(n->attrs.op);
-    n->attrs.dict["__identifier__"] = std::to_string(node_identifier++);
     n->attrs.subgraphs.emplace_back(std::make_shared<nnvm::Symbol>(new_sym));
     n->op()->attr_parser(&(n->attrs));
     return n;
@@ -0,0 +1,83 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file dnnl_layout-inl.h
+ * \brief Elementwise operator keeping the oneDNN layout of its input
+ */
+
+#ifndef MXNET_OPERATOR_SUBGRAPH_DNNL_DNNL_LAYOUT_INL_H_
+#define MXNET_OPERATOR_SUBGRAPH_DNNL_DNNL_LAYOUT_INL_H_
+
+#if MXNET_USE_ONEDNN == 1
+
+#include <memory>
+#include <vector>
+
+#include "operator/nn/dnnl/dnnl_base-inl.h"
+
+namespace mxnet {
+namespace op {
+
+namespace layout_eltwise {
+/*! \brief Steps of _sg_onednn_layout_eltwise, alpha * x + beta or clip(x, alpha, beta) */
+enum LayoutEltwiseAlgo { kLinear = 0, kClip = 1 };
+}  // namespace layout_eltwise
+
+struct DNNLLayoutEltwiseParam : public dmlc::Parameter<DNNLLayoutEltwiseParam> {
+  mxnet::Tuple<int> algos;
+  mxnet::Tuple<float> alphas;
+  mxnet::Tuple<float> betas;
+
+  DMLC_DECLARE_PARAMETER(DNNLLayoutEltwiseParam) {
+    DMLC_DECLARE_FIELD(algos)
+        .set_default(mxnet::Tuple<int>())
+        .describe("Algorithm of each step, 0 for linear and 1 for clip.");
+    DMLC_DECLARE_FIELD(alphas)
+        .set_default(mxnet::Tuple<float>())
+        .describe("Scale of the linear steps and lower bound of the clip steps.");
+    DMLC_DECLARE_FIELD(betas)
+        .set_default(mxnet::Tuple<float>())
+        .describe("Shift of the linear steps and upper bound of the clip steps.");
+  }
+};
+
+using eltwise_fwd_t    = dnnl::eltwise_forward;
+using eltwise_fwd_pd_t = dnnl::eltwise_forward::primitive_desc;
+
+class DNNLLayoutEltwiseFwd {
+ public:
+  static DNNLLayoutEltwiseFwd& GetCached(const DNNLLayoutEltwiseParam& param,
+                                         const NDArray& input,
+                                         const NDArray& output);
+
+  DNNLLayoutEltwiseFwd(const DNNLLayoutEltwiseParam& param, const NDArray& input);
+
+  void Execute(const NDArray& input, const OpReqType& req, const NDArray& output);
+
+ private:
+  std::vector<std::shared_ptr<eltwise_fwd_t>> fwds;
+  std::vector<std::shared_ptr<eltwise_fwd_pd_t>> fwd_pds;
+};
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_USE_ONEDNN == 1
+#endif  // MXNET_OPERATOR_SUBGRAPH_DNNL_DNNL_LAYOUT_INL_H_
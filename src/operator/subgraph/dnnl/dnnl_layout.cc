@@ -0,0 +1,216 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file dnnl_layout.cc
+ * \brief DNNL layout preserving elementwise operator based on subgraph
+ */
+
+#if MXNET_USE_ONEDNN == 1
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "operator/mxnet_op.h"
+#include "operator/subgraph/common.h"
+#include "dnnl_layout-inl.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(DNNLLayoutEltwiseParam);
+
+DNNLLayoutEltwiseFwd& DNNLLayoutEltwiseFwd::GetCached(const DNNLLayoutEltwiseParam& param,
+                                                      const NDArray& input,
+                                                      const NDArray& output) {
+#if DMLC_CXX11_THREAD_LOCAL
+  static thread_local DNNLPrimitiveCache<OpSignature, DNNLLayoutEltwiseFwd, OpHash>
+      fwds("Layout eltwise");
+#else
+  static MX_THREAD_LOCAL DNNLPrimitiveCache<OpSignature, DNNLLayoutEltwiseFwd, OpHash>
+      fwds("Layout eltwise");
+#endif
+  OpSignature key;
+  for (int i = 0; i < param.algos.ndim(); ++i) {
+    key.AddSign(param.algos[i]);
+    key.AddSign(param.alphas[i]);
+    key.AddSign(param.betas[i]);
+  }
+  key.AddSign(input);
+  key.AddSign(output);
+
+  auto it = fwds.find(key);
+  if (it == fwds.end()) {
+    const DNNLLayoutEltwiseFwd fwd(param, input);
+    it = AddToCache(&fwds, key, fwd);
+  }
+  return it->second;
+}
+
+DNNLLayoutEltwiseFwd::DNNLLayoutEltwiseFwd(const DNNLLayoutEltwiseParam& param,
+                                           const NDArray& input) {
+  // every step runs on the memory descriptor of the input, whatever its layout
+  auto src_desc     = input.GetDNNLData()->get_desc();
+  const auto engine = mxnet::CpuEngine::Get()->get_engine();
+  auto add_step     = [&](const dnnl::algorithm alg, const float alpha, const float beta) {
+    dnnl::eltwise_forward::desc fwd_desc(
+        dnnl::prop_kind::forward_scoring, alg, src_desc, alpha, beta);
+    fwd_pds.push_back(std::make_shared<eltwise_fwd_pd_t>(fwd_desc, engine));
+    fwds.push_back(std::make_shared<eltwise_fwd_t>(*fwd_pds.back()));
+  };
+  for (int i = 0; i < param.algos.ndim(); ++i) {
+    add_step(param.algos[i] == layout_eltwise::kLinear ? dnnl::algorithm::eltwise_linear :
+                                                         dnnl::algorithm::eltwise_clip,
+             param.alphas[i],
+             param.betas[i]);
+  }
+  // a chain of identities is a copy keeping the layout
+  if (fwds.empty())
+    add_step(dnnl::algorithm::eltwise_linear, 1.f, 0.f);
+}
+
+void DNNLLayoutEltwiseFwd::Execute(const NDArray& input,
+                                   const OpReqType& req,
+                                   const NDArray& output) {
+  auto src              = input.GetDNNLData();
+  dnnl_output_t out_mem = CreateDNNLMem(output, fwd_pds[0]->dst_desc(), req, &input);
+
+  DNNLStream::Get()->RegisterPrimArgs(*fwds[0],
+                                      {{DNNL_ARG_SRC, *src}, {DNNL_ARG_DST, *out_mem.second}});
+  // the following steps run in place on the output
+  for (size_t i = 1; i < fwds.size(); ++i) {
+    DNNLStream::Get()->RegisterPrimArgs(
+        *fwds[i], {{DNNL_ARG_SRC, *out_mem.second}, {DNNL_ARG_DST, *out_mem.second}});
+  }
+  CommitOutput(output, out_mem);
+  DNNLStream::Get()->Submit();
+}
+
+struct LayoutEltwiseKernel {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  const DType* in,
+                                  const OpReqType req,
+                                  const int* algos,
+                                  const float* alphas,
+                                  const float* betas,
+                                  const int num_steps) {
+    DType val = in[i];
+    for (int s = 0; s < num_steps; ++s) {
+      const DType alpha = DType(alphas[s]);
+      const DType beta  = DType(betas[s]);
+      if (algos[s] == layout_eltwise::kLinear) {
+        val = alpha * val + beta;
+      } else {
+        val = val < alpha ? alpha : (val > beta ? beta : val);
+      }
+    }
+    KERNEL_ASSIGN(out[i], req, val);
+  }
+};
+
+static void LayoutEltwiseCompute(const nnvm::NodeAttrs& attrs,
+                                 const OpContext& ctx,
+                                 const std::vector<TBlob>& inputs,
+                                 const std::vector<OpReqType>& req,
+                                 const std::vector<TBlob>& outputs) {
+  CHECK_EQ(inputs.size(), 1U);
+  CHECK_EQ(outputs.size(), 1U);
+  if (req[0] == kNullOp)
+    return;
+  const DNNLLayoutEltwiseParam& param = nnvm::get<DNNLLayoutEltwiseParam>(attrs.parsed);
+  mshadow::Stream<cpu>* s             = ctx.get_stream<cpu>();
+  MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, DType, {
+    mxnet_op::Kernel<LayoutEltwiseKernel, cpu>::Launch(s,
+                                                      outputs[0].Size(),
+                                                      outputs[0].dptr<DType>(),
+                                                      inputs[0].dptr<DType>(),
+                                                      req[0],
+                                                      param.algos.begin(),
+                                                      param.alphas.begin(),
+                                                      param.betas.begin(),
+                                                      param.algos.ndim());
+  });
+}
+
+static void DNNLLayoutEltwiseForward(const nnvm::NodeAttrs& attrs,
+                                     const OpContext& ctx,
+                                     const NDArray& input,
+                                     const OpReqType& req,
+                                     const NDArray& output) {
+  if (req == kNullOp)
+    return;
+  const DNNLLayoutEltwiseParam& param = nnvm::get<DNNLLayoutEltwiseParam>(attrs.parsed);
+  DNNLLayoutEltwiseFwd& fwd           = DNNLLayoutEltwiseFwd::GetCached(param, input, output);
+  fwd.Execute(input, req, output);
+}
+
+static void LayoutEltwiseComputeEx(const nnvm::NodeAttrs& attrs,
+                                   const OpContext& ctx,
+                                   const std::vector<NDArray>& inputs,
+                                   const std::vector<OpReqType>& req,
+                                   const std::vector<NDArray>& outputs) {
+  if (SupportDNNL<DNNLTypeMode::FloatTypes>(inputs[0])) {
+    DNNL_OPCHECK_INIT(false, outputs.size(), inputs, outputs);
+    DNNLRun(DNNLLayoutEltwiseForward, attrs, ctx, inputs[0], req[0], outputs[0]);
+    DNNL_OPCHECK_RUN(LayoutEltwiseCompute, attrs, ctx, inputs, req, outputs);
+  } else {
+    FallBackCompute(LayoutEltwiseCompute, attrs, ctx, inputs, req, outputs);
+  }
+}
+
+inline static bool LayoutEltwiseStorageType(const nnvm::NodeAttrs& attrs,
+                                            const int dev_mask,
+                                            DispatchMode* dispatch_mode,
+                                            std::vector<int>* in_attrs,
+                                            std::vector<int>* out_attrs) {
+  return DNNLStorageType(attrs, dev_mask, true, dispatch_mode, in_attrs, out_attrs);
+}
+
+NNVM_REGISTER_OP(_sg_onednn_layout_eltwise)
+    .describe(R"code(_sg_onednn_layout_eltwise)code" ADD_FILELINE)
+    .set_num_inputs([](const NodeAttrs& attrs) { return 1; })
+    .set_num_outputs([](const NodeAttrs& attrs) { return 1; })
+    .set_attr_parser(ParamParser<DNNLLayoutEltwiseParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"input"};
+                                     })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"output"};
+                                      })
+    .set_attr<mxnet::FInferShape>("FInferShape", ElemwiseShape<1, 1>)
+    .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<1, 1>)
+    .set_attr<FInferStorageType>("FInferStorageType", LayoutEltwiseStorageType)
+    .set_attr<nnvm::FInplaceOption>("FInplaceOption",
+                                    [](const NodeAttrs& attrs) {
+                                      return std::vector<std::pair<int, int>>{{0, 0}};
+                                    })
+    .set_attr<FCompute>("FCompute<cpu>", LayoutEltwiseCompute)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", LayoutEltwiseComputeEx)
+    .set_attr<bool>("TIsDNNL", true)
+    .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes);
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // if MXNET_USE_ONEDNN == 1
@@ -0,0 +1,276 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file dnnl_layout_property.h
+ * \brief Graph property propagating the oneDNN layouts through the elementwise operators
+ */
+
+#ifndef MXNET_OPERATOR_SUBGRAPH_DNNL_DNNL_LAYOUT_PROPERTY_H_
+#define MXNET_OPERATOR_SUBGRAPH_DNNL_DNNL_LAYOUT_PROPERTY_H_
+#if MXNET_USE_ONEDNN == 1
+
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "operator/subgraph/common.h"
+#include "operator/tensor/elemwise_binary_scalar_op.h"
+#include "operator/tensor/matrix_op-inl.h"
+#include "dnnl_layout-inl.h"
+#include "dnnl_subgraph_base-inl.h"
+
+namespace mxnet {
+namespace op {
+
+/*! \brief Whether the output of the node is usually in a blocked oneDNN layout */
+static inline bool IsDNNLLayoutProducer(const nnvm::Node& n) {
+  static const std::unordered_set<std::string> producers = {"Convolution",
+                                                            "Deconvolution",
+                                                            "Pooling",
+                                                            "BatchNorm",
+                                                            "LRN",
+                                                            "_sg_onednn_conv",
+                                                            "_sg_onednn_batch_norm"};
+  return n.op() && producers.count(n.op()->name);
+}
+
+/*! \brief Whether the node reorders a plain input to the blocked layout it computes in */
+static inline bool IsDNNLLayoutConsumer(const nnvm::Node& n) {
+  static const std::unordered_set<std::string> consumers = {
+      "Convolution", "Deconvolution", "_sg_onednn_conv"};
+  return n.op() && consumers.count(n.op()->name);
+}
+
+/*!
+ * \brief Appends the step computing the node to the steps of a _sg_onednn_layout_eltwise node,
+ *  the linear steps following each other are folded into one. Returns false if the node can not
+ *  run on a blocked layout, the identities add no step.
+ */
+static inline bool AppendLayoutEltwiseStep(const nnvm::Node& n,
+                                           std::vector<int>* algos,
+                                           std::vector<float>* alphas,
+                                           std::vector<float>* betas) {
+  if (!n.op() || n.num_inputs() != 1 || n.num_outputs() != 1)
+    return false;
+  const std::string& name = n.op()->name;
+  if (name == "_copy" || name == "BlockGrad")
+    return true;
+
+  int algo    = layout_eltwise::kLinear;
+  float alpha = 1.f;
+  float beta  = 0.f;
+  if (name == "negative" || name == "_npi_negative") {
+    alpha = -1.f;
+  } else if (name == "clip") {
+    const ClipParam& param = nnvm::get<ClipParam>(n.attrs.parsed);
+    algo                   = layout_eltwise::kClip;
+    alpha                  = param.a_min;
+    beta                   = param.a_max;
+  } else {
+    static const std::unordered_set<std::string> scalar_ops = {"_plus_scalar",
+                                                               "_npi_add_scalar",
+                                                               "_minus_scalar",
+                                                               "_npi_subtract_scalar",
+                                                               "_rminus_scalar",
+                                                               "_npi_rsubtract_scalar",
+                                                               "_mul_scalar",
+                                                               "_npi_multiply_scalar",
+                                                               "_div_scalar",
+                                                               "_npi_true_divide_scalar"};
+    if (!scalar_ops.count(name))
+      return false;
+    const float scalar = nnvm::get<NumpyBinaryScalarParam>(n.attrs.parsed).scalar;
+    if (name == "_plus_scalar" || name == "_npi_add_scalar") {
+      beta = scalar;
+    } else if (name == "_minus_scalar" || name == "_npi_subtract_scalar") {
+      beta = -scalar;
+    } else if (name == "_rminus_scalar" || name == "_npi_rsubtract_scalar") {
+      alpha = -1.f;
+      beta  = scalar;
+    } else if (name == "_mul_scalar" || name == "_npi_multiply_scalar") {
+      alpha = scalar;
+    } else {
+      alpha = 1.f / scalar;
+    }
+  }
+  if (!std::isfinite(alpha) || !std::isfinite(beta))
+    return false;
+
+  if (algo == layout_eltwise::kLinear && !algos->empty() &&
+      algos->back() == layout_eltwise::kLinear) {
+    betas->back()  = alpha * betas->back() + beta;
+    alphas->back() = alpha * alphas->back();
+  } else {
+    algos->push_back(algo);
+    alphas->push_back(alpha);
+    betas->push_back(beta);
+  }
+  return true;
+}
+
+class SgDNNLLayoutSelector : public SubgraphSelectorV2 {
+ private:
+  const std::unordered_set<const nnvm::Node*>* heads_;
+  std::vector<const BiDirectedNode*> matched_list_;
+
+  static bool IsLayoutEltwise(const nnvm::Node& n, const std::shared_ptr<NodeAttr>& node_attr) {
+    // the steps compute in float32 as the blocked layouts of the producers do
+    if (!node_attr || node_attr->itype.size() != 1 || node_attr->itype[0] != mshadow::kFloat32)
+      return false;
+    std::vector<int> algos;
+    std::vector<float> alphas, betas;
+    return AppendLayoutEltwiseStep(n, &algos, &alphas, &betas);
+  }
+
+ public:
+  explicit SgDNNLLayoutSelector(const std::unordered_set<const nnvm::Node*>* heads)
+      : heads_(heads) {}
+
+  bool Select(const BiDirectedNode& seed_node,
+              const std::shared_ptr<NodeAttr>& node_attr) override {
+    const nnvm::Node& n = *seed_node.node;
+    if (IsLayoutEltwise(n, node_attr) && IsDNNLLayoutProducer(*n.inputs[0].node)) {
+      matched_list_.clear();
+      matched_list_.push_back(&seed_node);
+      return true;
+    }
+    return false;
+  }
+
+  bool SelectInput(const BiDirectedNode& n, const BiDirectedNode& input_node) override {
+    return false;
+  }
+
+  bool SelectOutput(const BiDirectedNode& n,
+                    const BiDirectedNode& output_node,
+                    const std::shared_ptr<NodeAttr>& output_node_attr) override {
+    // the chain grows from its last node, which must be read by nothing else
+    if (matched_list_.back() != &n || n.outputs.size() != 1 || heads_->count(n.node))
+      return false;
+    if (!IsLayoutEltwise(*output_node.node, output_node_attr))
+      return false;
+    matched_list_.push_back(&output_node);
+    return true;
+  }
+
+  void Reset() override {
+    CHECK_GE(matched_list_.size(), 1);
+    matched_list_.resize(1);
+  }
+};
+
+class SgDNNLLayoutProperty : public SubgraphProperty {
+ public:
+  SgDNNLLayoutProperty() {}
+
+  static SubgraphPropertyPtr Create() {
+    static const std::string& name = "oneDNN layout propagation optimization pass";
+    auto property                  = std::make_shared<SgDNNLLayoutProperty>();
+    property->SetAttr<std::string>("property_name", name);
+    property->SetAttr<bool>("inference_only", true);
+    if (dmlc::GetEnv("MXNET_DISABLE_ONEDNN_LAYOUT_OPT", 0)) {
+      property->SetAttr<bool>("disable", true);
+    }
+    return property;
+  }
+
+  void PrePartition(const nnvm::Graph& g,
+                    const std::unordered_map<std::string, std::string>& options_map) override {
+    SubgraphProperty::PrePartition(g, options_map);
+    heads_.clear();
+    for (const auto& e : g.outputs) {
+      heads_.insert(e.node.get());
+    }
+  }
+
+  /*!
+   * \brief Reports the reorders removed: the one of the input of each chain to the plain layout
+   *  and the ones of its outputs back to the blocked layouts of the convolutions reading them.
+   */
+  void PostPartition(const nnvm::Graph& g) override {
+    static const Op* layout_op = Op::Get("_sg_onednn_layout_eltwise");
+    size_t num_chains = 0, num_reorders = 0;
+    DFSVisit(g.outputs, [&](const nnvm::ObjectPtr& node) {
+      if (node->op() == layout_op) {
+        ++num_chains;
+        ++num_reorders;
+      }
+      if (IsDNNLLayoutConsumer(*node)) {
+        for (const auto& e : node->inputs) {
+          num_reorders += e.node->op() == layout_op;
+        }
+      }
+    });
+    static int verbose = dmlc::GetEnv("MXNET_SUBGRAPH_VERBOSE", 1);
+    if (verbose > 0 && num_chains > 0) {
+      LOG(INFO) << "oneDNN layout propagation kept the blocked layouts through " << num_chains
+                << " elementwise chains, removing " << num_reorders << " reorders.";
+    }
+  }
+
+  nnvm::ObjectPtr CreateSubgraphNode(const nnvm::Symbol& sym,
+                                     const int subgraph_id = 0) const override {
+    std::vector<int> algos;
+    std::vector<float> alphas, betas;
+    DFSVisit(sym.outputs, [&](const nnvm::ObjectPtr& node) {
+      if (!node->is_variable()) {
+        CHECK(AppendLayoutEltwiseStep(*node, &algos, &alphas, &betas))
+            << "Unexpected node " << node->attrs.name << " in a layout elementwise chain";
+      }
+    });
+
+    nnvm::ObjectPtr n = nnvm::Node::Create();
+    std::ostringstream algos_s, alphas_s, betas_s;
+    alphas_s << std::setprecision(std::numeric_limits<float>::max_digits10);
+    betas_s << std::setprecision(std::numeric_limits<float>::max_digits10);
+    algos_s << mxnet::Tuple<int>(algos.begin(), algos.end());
+    alphas_s << mxnet::Tuple<float>(alphas.begin(), alphas.end());
+    betas_s << mxnet::Tuple<float>(betas.begin(), betas.end());
+    n->attrs.dict["algos"]  = algos_s.str();
+    n->attrs.dict["alphas"] = alphas_s.str();
+    n->attrs.dict["betas"]  = betas_s.str();
+
+    n->attrs.name = "sg_onednn_layout_eltwise_" + std::to_string(subgraph_id);
+    n->attrs.op   = Op::Get("_sg_onednn_layout_eltwise");
+    CHECK(n->attrs.op);
+    n->op()->attr_parser(&(n->attrs));
+    return n;
+  }
+
+  SubgraphSelectorV2Ptr CreateSubgraphSelectorV2() const override {
+    auto selector = std::make_shared<SgDNNLLayoutSelector>(&heads_);
+    return selector;
+  }
+
+ private:
+  std::unordered_set<const nnvm::Node*> heads_;
+};
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // if MXNET_USE_ONEDNN == 1
+#endif  // MXNET_OPERATOR_SUBGRAPH_DNNL_DNNL_LAYOUT_PROPERTY_H_
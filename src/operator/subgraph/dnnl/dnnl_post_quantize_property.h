@@ -51,6 +51,17 @@ bool SupportsRequantizeFusion(const Op* op) {
 
   return support_requantize_fusion_ops.count(op) > 0;
 }
+
+// quantized operators which need no requantize, their int8 output can be written in float32
+// directly instead of through a dequantize
+bool SupportsDequantizeFusion(const Op* op) {
+  static const std::set<const Op*> support_dequantize_fusion_ops = {
+      Op::Get("_contrib_quantized_layer_norm"),
+      Op::Get("_contrib_quantized_leaky_relu"),
+      Op::Get("_contrib_quantized_softmax")};
+
+  return support_dequantize_fusion_ops.count(op) > 0;
+}
 }  // namespace
 
 class SgDNNLPostQuantizeSelector : public SubgraphSelectorV2 {
@@ -81,6 +92,13 @@ class SgDNNLPostQuantizeSelector : public SubgraphSelectorV2 {
       matched_list.emplace_back(&n);
       return true;
     }
+    if (float_output && raw_node->op() && SupportsDequantizeFusion(raw_node->op())) {
+      // the int8 output is final like the one of a requantize, only a dequantize can follow
+      status = SelectStatusPostQuantize::kRequantize;
+      matched_list.clear();
+      matched_list.emplace_back(&n);
+      return true;
+    }
     return false;
   }
 
@@ -127,7 +145,8 @@ class SgDNNLPostQuantizeSelector : public SubgraphSelectorV2 {
         }
       case SelectStatusPostQuantize::kRequantize:
         if (float_output && raw_new_node->op() == Op::Get("_contrib_dequantize")) {
-          CHECK(raw_node->op() == Op::Get("_contrib_requantize"));
+          CHECK(raw_node->op() == Op::Get("_contrib_requantize") ||
+                SupportsDequantizeFusion(raw_node->op()));
           if (n.outputs.size() > 1) {
             // check if requantize have other outputs than dequantize
             // if it has we can't fuse dequantize
@@ -200,7 +219,8 @@ class SgDNNLPostQuantizeProperty : public SubgraphProperty {
     DFSVisit(sym.outputs, [&](const nnvm::ObjectPtr& node) {
       if (node->is_variable())
         return;
-      if (node->op() && SupportsRequantizeFusion(node->op())) {
+      if (node->op() &&
+          (SupportsRequantizeFusion(node->op()) || SupportsDequantizeFusion(node->op()))) {
         fuse_node = node;
       } else if (node->op() == Op::Get("_contrib_requantize")) {
         requantize_node = node;
@@ -210,7 +230,14 @@ class SgDNNLPostQuantizeProperty : public SubgraphProperty {
     });
 
     CHECK_NOTNULL(fuse_node);
-    CHECK_NOTNULL(requantize_node);
+    if (requantize_node == nullptr) {
+      // a quantized operator without requantize only fuses the dequantize after it
+      CHECK(SupportsDequantizeFusion(fuse_node->op()));
+      CHECK_NOTNULL(dequantize_node);
+      fuse_node->attrs.dict["enabled_float_output"] = type_string(mshadow::kFloat32);
+      fuse_node->op()->attr_parser(&(fuse_node->attrs));
+      return fuse_node;
+    }
     auto const& requantize_param = nnvm::get<RequantizeParam>(requantize_node->attrs.parsed);
     CHECK(requantize_param.min_calib_range.has_value());
     CHECK(requantize_param.max_calib_range.has_value());
@@ -53,6 +53,18 @@ struct DNNLSelfAttParam : public dmlc::Parameter<DNNLSelfAttParam> {
   }
 };
 
+struct DNNLSelfAttMaskedParam : public dmlc::Parameter<DNNLSelfAttMaskedParam> {
+  int heads;
+  dmlc::optional<double> temperature;
+
+  DMLC_DECLARE_PARAMETER(DNNLSelfAttMaskedParam) {
+    DMLC_DECLARE_FIELD(heads).describe("Set number of heads.");
+    DMLC_DECLARE_FIELD(temperature)
+        .set_default(dmlc::optional<double>())
+        .describe("Temperature dividing the attention scores before the softmax.");
+  }
+};
+
 }  // namespace op
 }  // namespace mxnet
 #endif  // MXNET_OPERATOR_SUBGRAPH_DNNL_DNNL_TRANSFORMER_INL_H_
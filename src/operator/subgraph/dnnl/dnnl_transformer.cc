@@ -19,6 +19,9 @@
 
 #if MXNET_USE_ONEDNN == 1
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <string>
 #include <utility>
 #include <vector>
@@ -36,6 +39,7 @@ namespace mxnet {
 namespace op {
 
 DMLC_REGISTER_PARAMETER(DNNLSelfAttParam);
+DMLC_REGISTER_PARAMETER(DNNLSelfAttMaskedParam);
 
 template <bool with_split>
 static bool SgDNNLSelfAttShape(const NodeAttrs& attrs,
@@ -901,6 +905,284 @@ NNVM_REGISTER_OP(_sg_onednn_selfatt_valatt)
                   "Queries, keys and values interleaved")
     .add_arguments(DNNLSelfAttParam::__FIELDS__());
 
+/*************************************_sg_onednn_selfatt*************************************/
+
+static bool SgDNNLSelfAttMaskedShape(const NodeAttrs& attrs,
+                                     mxnet::ShapeVector* in_shape,
+                                     mxnet::ShapeVector* out_shape) {
+  const auto& params   = nnvm::get<DNNLSelfAttMaskedParam>(attrs.parsed);
+  const auto qkv_shape = in_shape->at(0);
+  CHECK_EQ(in_shape->size(), 2U) << "Inputs: [queries_keys_values, mask] - currently have "
+                                 << in_shape->size() << " inputs";
+  if (!mxnet::ndim_is_known(qkv_shape))
+    return false;
+  CHECK_EQ(qkv_shape.ndim(), 3U)
+      << "Input queries_keys_values should be 3D in batch-seq_length-proj_dim, "
+      << "but the given tensor is " << qkv_shape.ndim() << "D";
+  CHECK_EQ(qkv_shape[2] % (QKV_NUM * params.heads), 0)
+      << "The projection dimension should be divisible by 3 * heads";
+
+  const auto mask_shape = in_shape->at(1);
+  if (mxnet::ndim_is_known(mask_shape)) {
+    CHECK_EQ(mask_shape.ndim(), 4U)
+        << "Mask should be 4D in batch-heads-seq_length-seq_length, "
+        << "but the given tensor is " << mask_shape.ndim() << "D";
+    const dim_t dims[] = {qkv_shape[0], params.heads, qkv_shape[1], qkv_shape[1]};
+    for (int i = 0; i < 3; ++i) {
+      CHECK(mask_shape[i] == 1 || mask_shape[i] == dims[i])
+          << "Mask of shape " << mask_shape << " can not be broadcast to the attention maps";
+    }
+    CHECK_EQ(mask_shape[3], dims[3]);
+  }
+  out_shape->resize(1);
+  SHAPE_ASSIGN_CHECK(
+      *out_shape, 0, mxnet::TShape({qkv_shape[0], qkv_shape[1], qkv_shape[2] / QKV_NUM}));
+  return true;
+}
+
+static bool SgDNNLSelfAttMaskedInferType(const nnvm::NodeAttrs& attrs,
+                                         std::vector<int>* in_types,
+                                         std::vector<int>* out_types) {
+  CHECK_EQ(in_types->size(), 2U);
+  CHECK_EQ(out_types->size(), 1U);
+  TYPE_ASSIGN_CHECK(*in_types, 0, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*in_types, 1, mshadow::kBool);
+  TYPE_ASSIGN_CHECK(*out_types, 0, mshadow::kFloat32);
+  return true;
+}
+
+/*!
+ * \brief Self attention masked_softmax(Q * K^T / temperature, mask) * V computed a few rows of
+ *  queries at a time. The attention maps of a tile stay in the cache between the two matmuls
+ *  instead of being written to memory and read back by each step.
+ */
+class SgDNNLSelfAttMaskedOp {
+ public:
+  explicit SgDNNLSelfAttMaskedOp(const nnvm::NodeAttrs& attrs)
+      : param_(nnvm::get<DNNLSelfAttMaskedParam>(attrs.parsed)) {}
+
+  void Forward(const OpContext& ctx,
+               const std::vector<NDArray>& inputs,
+               const std::vector<OpReqType>& req,
+               const std::vector<NDArray>& outputs);
+
+  void Backward(const OpContext& ctx,
+                const std::vector<NDArray>& inputs,
+                const std::vector<OpReqType>& req,
+                const std::vector<NDArray>& outputs) {
+    LOG(FATAL) << "Not implemented: subgraph oneDNN self attention only supports "
+                  "inference computation.";
+  }
+
+ private:
+  /*! \brief Bytes of the attention maps of a tile, sized to stay in the L2 cache */
+  static constexpr size_t kTileBytes = 1 << 20;
+
+  struct TilePrimitives {
+    std::shared_ptr<dnnl::matmul> qk;
+    std::shared_ptr<dnnl::matmul> att_v;
+    std::shared_ptr<dnnl::memory> query;
+    std::shared_ptr<dnnl::memory> key;
+    std::shared_ptr<dnnl::memory> scores;
+    std::shared_ptr<dnnl::memory> value;
+    std::shared_ptr<dnnl::memory> out;
+  };
+
+  void Initialize(const NDArray& qkv, const NDArray& mask);
+  TilePrimitives CreateTile(dnnl::memory::dim tile_len);
+  void MaskedSoftmax(const bool* mask, index_t batch, index_t first_row, index_t num_rows);
+
+  DNNLSelfAttMaskedParam param_;
+  mxnet::TShape qkv_shape_;
+  mxnet::TShape mask_shape_;
+  index_t seq_len_;
+  index_t embed_dim_;
+  index_t head_dim_;
+  index_t tile_len_;
+  TilePrimitives full_tile_;
+  TilePrimitives last_tile_;
+  std::vector<float> scores_;
+};
+
+SgDNNLSelfAttMaskedOp::TilePrimitives SgDNNLSelfAttMaskedOp::CreateTile(
+    dnnl::memory::dim tile_len) {
+  using namespace dnnl;
+  const auto engine               = CpuEngine::Get()->get_engine();
+  const memory::dim heads         = param_.heads;
+  const memory::dim seq_len       = seq_len_;
+  const memory::dim head_dim      = head_dim_;
+  const memory::dim embed_dim     = embed_dim_;
+  const memory::dim qkv_row_width = embed_dim * QKV_NUM;
+
+  // queries, keys and values are read in place from the interleaved input, the tile of the
+  // output is written in place to the batch-seq_length-embed_dim output
+  const memory::dims qkv_strides = {head_dim, qkv_row_width, 1};
+  const memory::dims key_strides = {head_dim, 1, qkv_row_width};
+  const memory::dims out_strides = {head_dim, embed_dim, 1};
+  const auto f32                 = memory::data_type::f32;
+  const auto query_md            = memory::desc({heads, tile_len, head_dim}, f32, qkv_strides);
+  const auto key_md              = memory::desc({heads, head_dim, seq_len}, f32, key_strides);
+  const auto scores_md = memory::desc({heads, tile_len, seq_len}, f32, memory::format_tag::abc);
+  const auto value_md  = memory::desc({heads, seq_len, head_dim}, f32, qkv_strides);
+  const auto out_md    = memory::desc({heads, tile_len, head_dim}, f32, out_strides);
+
+  TilePrimitives tile;
+  tile.qk     = std::make_shared<matmul>(
+      matmul::primitive_desc(matmul::desc(query_md, key_md, scores_md), engine));
+  tile.att_v  = std::make_shared<matmul>(
+      matmul::primitive_desc(matmul::desc(scores_md, value_md, out_md), engine));
+  tile.query  = std::make_shared<memory>(query_md, engine, nullptr);
+  tile.key    = std::make_shared<memory>(key_md, engine, nullptr);
+  tile.scores = std::make_shared<memory>(scores_md, engine, scores_.data());
+  tile.value  = std::make_shared<memory>(value_md, engine, nullptr);
+  tile.out    = std::make_shared<memory>(out_md, engine, nullptr);
+  return tile;
+}
+
+void SgDNNLSelfAttMaskedOp::Initialize(const NDArray& qkv, const NDArray& mask) {
+  qkv_shape_  = qkv.shape();
+  mask_shape_ = mask.shape();
+  seq_len_    = qkv_shape_[1];
+  embed_dim_  = qkv_shape_[2] / QKV_NUM;
+  head_dim_   = embed_dim_ / param_.heads;
+  tile_len_   = std::max<index_t>(1, kTileBytes / (sizeof(float) * param_.heads * seq_len_));
+  tile_len_   = std::min(tile_len_, seq_len_);
+
+  scores_.resize(param_.heads * tile_len_ * seq_len_);
+  full_tile_ = CreateTile(tile_len_);
+  if (seq_len_ % tile_len_ != 0)
+    last_tile_ = CreateTile(seq_len_ % tile_len_);
+}
+
+void SgDNNLSelfAttMaskedOp::MaskedSoftmax(const bool* mask,
+                                          index_t batch,
+                                          index_t first_row,
+                                          index_t num_rows) {
+  // the mask is broadcast on its axes of size 1
+  const index_t row_stride   = mask_shape_[2] == 1 ? 0 : seq_len_;
+  const index_t head_stride  = mask_shape_[1] == 1 ? 0 : mask_shape_[2] * seq_len_;
+  const index_t batch_stride = mask_shape_[0] == 1 ? 0 : mask_shape_[1] * mask_shape_[2] * seq_len_;
+  const float inv_temperature =
+      param_.temperature.has_value() ? 1.0f / param_.temperature.value() : 1.0f;
+  const index_t seq_len = seq_len_;
+  const int nthreads    = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  float* scores         = scores_.data();
+
+#pragma omp parallel for num_threads(nthreads)
+  for (index_t r = 0; r < param_.heads * num_rows; ++r) {
+    const index_t head   = r / num_rows;
+    const index_t row    = first_row + r % num_rows;
+    const bool* row_mask = mask + batch * batch_stride + head * head_stride + row * row_stride;
+    float* row_scores    = scores + r * seq_len;
+
+    float max_score = -std::numeric_limits<float>::infinity();
+    for (index_t k = 0; k < seq_len; ++k) {
+      if (row_mask[k])
+        max_score = std::max(max_score, row_scores[k]);
+    }
+    if (max_score == -std::numeric_limits<float>::infinity()) {
+      // a row masked out entirely attends to nothing
+      std::fill(row_scores, row_scores + seq_len, 0.0f);
+      continue;
+    }
+    float sum = 0.0f;
+    for (index_t k = 0; k < seq_len; ++k) {
+      row_scores[k] = row_mask[k] ? std::exp((row_scores[k] - max_score) * inv_temperature) : 0.f;
+      sum += row_scores[k];
+    }
+    const float scale = 1.0f / sum;
+    for (index_t k = 0; k < seq_len; ++k) {
+      row_scores[k] *= scale;
+    }
+  }
+}
+
+void SgDNNLSelfAttMaskedOp::Forward(const OpContext& ctx,
+                                    const std::vector<NDArray>& inputs,
+                                    const std::vector<OpReqType>& req,
+                                    const std::vector<NDArray>& outputs) {
+  NDArray qkv = inputs[0];
+  if (qkv.IsDNNLData())
+    qkv = qkv.Reorder2Default();
+  const NDArray& mask = inputs[1];
+  if (qkv.shape() != qkv_shape_ || mask.shape() != mask_shape_)
+    Initialize(qkv, mask);
+
+  const index_t qkv_row_width = embed_dim_ * QKV_NUM;
+  float* qkv_ptr              = qkv.data().dptr<float>();
+  float* out_ptr              = outputs[0].data().dptr<float>();
+  const bool* mask_ptr        = mask.data().dptr<bool>();
+  DNNLStream* stream          = DNNLStream::Get();
+
+  for (index_t b = 0; b < qkv_shape_[0]; ++b) {
+    float* batch_qkv = qkv_ptr + b * seq_len_ * qkv_row_width;
+    float* batch_out = out_ptr + b * seq_len_ * embed_dim_;
+    for (index_t row = 0; row < seq_len_; row += tile_len_) {
+      const index_t num_rows = std::min(tile_len_, seq_len_ - row);
+      TilePrimitives& tile   = num_rows == tile_len_ ? full_tile_ : last_tile_;
+      tile.query->set_data_handle(batch_qkv + row * qkv_row_width);
+      tile.key->set_data_handle(batch_qkv + embed_dim_);
+      tile.value->set_data_handle(batch_qkv + 2 * embed_dim_);
+      tile.out->set_data_handle(batch_out + row * embed_dim_);
+
+      stream->RegisterPrimArgs(*tile.qk,
+                               {{DNNL_ARG_SRC, *tile.query},
+                                {DNNL_ARG_WEIGHTS, *tile.key},
+                                {DNNL_ARG_DST, *tile.scores}});
+      stream->Submit();
+      MaskedSoftmax(mask_ptr, b, row, num_rows);
+      stream->RegisterPrimArgs(*tile.att_v,
+                               {{DNNL_ARG_SRC, *tile.scores},
+                                {DNNL_ARG_WEIGHTS, *tile.value},
+                                {DNNL_ARG_DST, *tile.out}});
+      stream->Submit();
+    }
+  }
+}
+
+static OpStatePtr CreateSgDNNLSelfAttMaskedState(const nnvm::NodeAttrs& attrs,
+                                                 Context ctx,
+                                                 const mxnet::ShapeVector& in_shapes,
+                                                 const std::vector<int>& in_types) {
+  return OpStatePtr::Create<SgDNNLSelfAttMaskedOp>(attrs);
+}
+
+static void SgDNNLSelfAttMaskedForward(const OpStatePtr& state_pointer,
+                                       const OpContext& ctx,
+                                       const std::vector<NDArray>& inputs,
+                                       const std::vector<OpReqType>& req,
+                                       const std::vector<NDArray>& outputs) {
+  SgDNNLSelfAttMaskedOp& op = state_pointer.get_state<SgDNNLSelfAttMaskedOp>();
+  op.Forward(ctx, inputs, req, outputs);
+}
+
+NNVM_REGISTER_OP(_sg_onednn_selfatt)
+    .describe(R"code(_sg_onednn_selfatt)code" ADD_FILELINE)
+    .set_num_inputs(2)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<DNNLSelfAttMaskedParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"queries_keys_values",
+                                                                       "mask"};
+                                     })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"output"};
+                                      })
+    .set_attr<mxnet::FInferShape>("FInferShape", SgDNNLSelfAttMaskedShape)
+    .set_attr<nnvm::FInferType>("FInferType", SgDNNLSelfAttMaskedInferType)
+    .set_attr<FInferStorageType>("FInferStorageType", SgDNNLSelfAttStorageType)
+    .set_attr<FCreateOpState>("FCreateOpState", CreateSgDNNLSelfAttMaskedState)
+    .set_attr<FStatefulComputeEx>("FStatefulComputeEx<cpu>", SgDNNLSelfAttMaskedForward)
+    .set_attr<bool>("TIsDNNL", true)
+    .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes)
+    .add_argument("queries_keys_values",
+                  "NDArray-or-Symbol",
+                  "Queries, keys and values interleaved")
+    .add_argument("mask", "NDArray-or-Symbol", "Mask of the attention maps")
+    .add_arguments(DNNLSelfAttMaskedParam::__FIELDS__());
+
 }  // namespace op
 }  // namespace mxnet
 
@@ -0,0 +1,201 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef MXNET_OPERATOR_SUBGRAPH_DNNL_DNNL_TRANSFORMER_ATTENTION_PROPERTY_H_
+#define MXNET_OPERATOR_SUBGRAPH_DNNL_DNNL_TRANSFORMER_ATTENTION_PROPERTY_H_
+
+#if MXNET_USE_ONEDNN == 1
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "operator/nn/softmax-inl.h"
+#include "operator/subgraph/common.h"
+#include "dnnl_subgraph_base-inl.h"
+#include "dnnl_transformer-inl.h"
+
+/*
+               custom_op
+                   |
+    _______________|________________
+   |               |                |
+   | _sg_onednn_selfatt_qk_split    |
+   |               |                |
+   |         masked_softmax         |
+   |               |                |
+   |  _sg_onednn_selfatt_valatt     |
+   |________________________________|
+
+  The queries_keys_values input of valatt is the input of qk_split.
+*/
+
+namespace mxnet {
+namespace op {
+
+class SgDNNLTransformerAttentionSelector : public SubgraphSelectorV2 {
+  enum SelectStatus { kFail = 0, kStart, kSoftmax, kSuccess };
+
+ private:
+  SelectStatus status_;
+  std::vector<const BiDirectedNode*> matched_list_;
+
+  static bool IsFloatSelfAtt(const nnvm::Node& n, const char* op_name) {
+    return n.op() == Op::Get(op_name) && !nnvm::get<DNNLSelfAttParam>(n.attrs.parsed).quantized;
+  }
+
+ public:
+  bool Select(const BiDirectedNode& seed_node,
+              const std::shared_ptr<NodeAttr>& node_attr) override {
+    if (IsFloatSelfAtt(*seed_node.node, "_sg_onednn_selfatt_qk_split") && node_attr &&
+        node_attr->itype[0] == mshadow::kFloat32) {
+      status_ = kStart;
+      matched_list_.clear();
+      matched_list_.push_back(&seed_node);
+      return true;
+    }
+    return false;
+  }
+
+  bool SelectInput(const BiDirectedNode& n, const BiDirectedNode& input_node) override {
+    return false;
+  }
+
+  bool SelectOutput(const BiDirectedNode& n,
+                    const BiDirectedNode& output_node,
+                    const std::shared_ptr<NodeAttr>& output_node_attr) override {
+    // the attention maps must be read by nothing else than the next step
+    if (status_ == kFail || status_ == kSuccess || matched_list_.back() != &n ||
+        n.outputs.size() != 1)
+      return false;
+    const nnvm::Node& out = *output_node.node;
+    if (status_ == kStart) {
+      if (out.op() != Op::Get("masked_softmax") || !output_node_attr ||
+          output_node_attr->itype[1] != mshadow::kBool)
+        return false;
+      const auto& param = nnvm::get<MaskedSoftmaxParam>(out.attrs.parsed);
+      if (param.axis != -1 && param.axis != 3)
+        return false;
+      status_ = kSoftmax;
+    } else {
+      // the values are read from the input of the queries and keys
+      const nnvm::NodeEntry& qkv = matched_list_[0]->node->inputs[0];
+      if (!IsFloatSelfAtt(out, "_sg_onednn_selfatt_valatt") || out.inputs[1].node != qkv.node ||
+          out.inputs[1].index != qkv.index)
+        return false;
+      status_ = kSuccess;
+    }
+    matched_list_.push_back(&output_node);
+    return true;
+  }
+
+  std::vector<BiDirectedNode*> Filter(const std::vector<BiDirectedNode*>& candidates) override {
+    if (status_ != kSuccess)
+      return std::vector<BiDirectedNode*>(0);
+    std::vector<BiDirectedNode*> ret;
+    for (auto i : matched_list_) {
+      auto non_const_i = const_cast<BiDirectedNode*>(i);
+      if (std::find(candidates.begin(), candidates.end(), non_const_i) != candidates.end()) {
+        ret.push_back(non_const_i);
+      }
+    }
+    return ret.size() == matched_list_.size() ? ret : std::vector<BiDirectedNode*>(0);
+  }
+
+  void Reset() override {
+    CHECK_GE(matched_list_.size(), 1);
+    matched_list_.resize(1);
+    status_ = kStart;
+  }
+};
+
+class SgDNNLTransformerAttentionProperty : public SubgraphProperty {
+ public:
+  SgDNNLTransformerAttentionProperty() {}
+
+  static SubgraphPropertyPtr Create() {
+    static const std::string& name = "oneDNN Transformer attention optimization pass";
+    auto property                  = std::make_shared<SgDNNLTransformerAttentionProperty>();
+    property->SetAttr<std::string>("property_name", name);
+    property->SetAttr<bool>("inference_only", true);
+    if (dmlc::GetEnv("MXNET_DISABLE_ONEDNN_TRANSFORMER_OPT", 0) ||
+        dmlc::GetEnv("MXNET_DISABLE_ONEDNN_ATTENTION_OPT", 0)) {
+      property->SetAttr<bool>("disable", true);
+    }
+    return property;
+  }
+
+  nnvm::ObjectPtr CreateSubgraphNode(const nnvm::Symbol& sym,
+                                     const int subgraph_id = 0) const override {
+    nnvm::ObjectPtr n = nnvm::Node::Create();
+    DFSVisit(sym.outputs, [&](const nnvm::ObjectPtr& node) {
+      if (node->op() == Op::Get("_sg_onednn_selfatt_qk_split")) {
+        n->attrs.dict["heads"] =
+            std::to_string(nnvm::get<DNNLSelfAttParam>(node->attrs.parsed).heads);
+      } else if (node->op() == Op::Get("masked_softmax")) {
+        const auto& param = nnvm::get<MaskedSoftmaxParam>(node->attrs.parsed);
+        if (param.temperature.has_value()) {
+          std::ostringstream temperature;
+          temperature << std::setprecision(std::numeric_limits<double>::max_digits10)
+                      << param.temperature.value();
+          n->attrs.dict["temperature"] = temperature.str();
+        }
+      }
+    });
+    n->attrs.name = "_sg_onednn_selfatt_" + std::to_string(subgraph_id);
+    n->attrs.op   = Op::Get("_sg_onednn_selfatt");
+    CHECK(n->attrs.op);
+    n->attrs.subgraphs.emplace_back(std::make_shared<nnvm::Symbol>(sym));
+    n->op()->attr_parser(&(n->attrs));
+    return n;
+  }
+
+  void ConnectSubgraphInputs(const nnvm::ObjectPtr subgraph_node,
+                             std::vector<nnvm::NodeEntry*>* input_entries,
+                             std::vector<nnvm::NodeEntry>* orig_input_entries) const override {
+    // keep queries_keys_values, read by qk_split and valatt, once and the mask of masked_softmax
+    subgraph_node->inputs.resize(2);
+    DFSVisit(subgraph_node->attrs.subgraphs[0]->outputs, [&](const nnvm::ObjectPtr& node) {
+      for (size_t i = 0; i < input_entries->size(); ++i) {
+        if (node->op() == Op::Get("_sg_onednn_selfatt_qk_split") &&
+            input_entries->at(i) == &node->inputs[0]) {
+          subgraph_node->inputs[0] = orig_input_entries->at(i);
+        } else if (node->op() == Op::Get("masked_softmax") &&
+                   input_entries->at(i) == &node->inputs[1]) {
+          subgraph_node->inputs[1] = orig_input_entries->at(i);
+        }
+      }
+    });
+  }
+
+  SubgraphSelectorV2Ptr CreateSubgraphSelectorV2() const override {
+    auto selector = std::make_shared<SgDNNLTransformerAttentionSelector>();
+    return selector;
+  }
+};
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // if MXNET_USE_ONEDNN == 1
+#endif  // MXNET_OPERATOR_SUBGRAPH_DNNL_DNNL_TRANSFORMER_ATTENTION_PROPERTY_H_
@@ -21,6 +21,7 @@
 #define MXNET_OPERATOR_SUBGRAPH_SUBGRAPH_PROPERTY_H_
 
 #include <dmlc/base.h>
+#include <dmlc/parameter.h>
 #include <dmlc/thread_local.h>
 #include <mxnet/graph_attr_types.h>
 #include <mxnet/op_attr_types.h>
@@ -257,6 +258,45 @@ class SubgraphSelectorV2Bridge : public SubgraphSelectorV2 {
   SubgraphSelectorPtr ss_ptr_;
 };
 
+/*!
+ * \brief Cost model deciding which candidate subgraphs are worth creating. Running a node in a
+ *        subgraph saves time, every entry crossing the boundary of a subgraph (a cast, a layout
+ *        reorder, a copy to the device) costs time. Entries between two accepted subgraphs are
+ *        free, so neighbouring candidates are evaluated as one region. Candidates whose gain
+ *        does not exceed their transition cost, and regions of less than min_subgraph_size
+ *        nodes, are left to the default executor.
+ */
+class SubgraphCostModel {
+ public:
+  SubgraphCostModel(size_t min_subgraph_size, double transition_cost)
+      : min_subgraph_size_(min_subgraph_size), transition_cost_(transition_cost) {}
+  virtual ~SubgraphCostModel() {}
+  /*!
+   * \brief Time saved by running a node in a subgraph, in the units of TransitionCost.
+   */
+  virtual double NodeGain(const nnvm::Node& node) const {
+    return node.is_variable() ? 0.0 : 1.0;
+  }
+  /*!
+   * \brief Time paid for moving an entry into or out of a subgraph.
+   */
+  virtual double TransitionCost(const nnvm::NodeEntry& entry) const {
+    return transition_cost_;
+  }
+  /*!
+   * \brief Minimum number of nodes of a region of neighbouring subgraphs.
+   */
+  size_t MinSubgraphSize() const {
+    return min_subgraph_size_;
+  }
+
+ protected:
+  size_t min_subgraph_size_;
+  double transition_cost_;
+};
+
+using SubgraphCostModelPtr = std::shared_ptr<SubgraphCostModel>;
+
 /*!
  * \brief This provides a set of properties for partitioning a graph into subgraphs,
  *        reconstructing a new graph from the subgraphs and creating a subgraph
@@ -293,6 +333,37 @@ class SubgraphProperty {
 
   virtual void PostPartition(const nnvm::Graph& g) {}
 
+  /*!
+   * \brief The cost model filtering the candidate subgraphs, nullptr to create all of them.
+   *        By default it is configured by the min_subgraph_size and subgraph_transition_cost
+   *        partitioning options, or the MXNET_SUBGRAPH_MIN_SIZE and
+   *        MXNET_SUBGRAPH_TRANSITION_COST environment variables, and created only if one of
+   *        them, or the partition_report option, is set.
+   * \param g the graph to partition
+   */
+  virtual SubgraphCostModelPtr CreateSubgraphCostModel(const nnvm::Graph& g) const {
+    std::unordered_map<std::string, std::string> options;
+    if (g.HasAttr("options_map"))
+      options = g.GetAttr<std::unordered_map<std::string, std::string>>("options_map");
+    const std::string min_size_env = dmlc::GetEnv("MXNET_SUBGRAPH_MIN_SIZE", std::string());
+    const std::string transition_cost_env =
+        dmlc::GetEnv("MXNET_SUBGRAPH_TRANSITION_COST", std::string());
+    if (options.count("min_subgraph_size") == 0 && !min_size_env.empty())
+      options["min_subgraph_size"] = min_size_env;
+    if (options.count("subgraph_transition_cost") == 0 && !transition_cost_env.empty())
+      options["subgraph_transition_cost"] = transition_cost_env;
+    if (options.count("min_subgraph_size") == 0 &&
+        options.count("subgraph_transition_cost") == 0 && options.count("partition_report") == 0)
+      return nullptr;
+    size_t min_subgraph_size = 1;
+    double transition_cost   = 0.0;
+    if (options.count("min_subgraph_size") > 0)
+      min_subgraph_size = std::stoul(options.at("min_subgraph_size"));
+    if (options.count("subgraph_transition_cost") > 0)
+      transition_cost = std::stod(options.at("subgraph_transition_cost"));
+    return std::make_shared<SubgraphCostModel>(min_subgraph_size, transition_cost);
+  }
+
   virtual SubgraphSelectorV2Ptr CreateSubgraphSelectorV2() const {
     auto v1_ptr = CreateSubgraphSelector();
     return std::make_shared<SubgraphSelectorV2Bridge>(v1_ptr);
@@ -51,6 +51,13 @@ namespace mxnet {
 namespace op {
 namespace nnvm_to_onnx {
 
+// Makes the leading dimension of an input or output of the graph symbolic
+static void SetDynamicBatch(ValueInfoProto* value_info) {
+  auto* shape = value_info->mutable_type()->mutable_tensor_type()->mutable_shape();
+  if (shape->dim_size() > 0)
+    shape->mutable_dim(0)->set_dim_param("batch");
+}
+
 std::string ConvertNnvmGraphToOnnx(const nnvm::Graph& g,
                                    std::unordered_map<std::string, NDArray>* params_map) {
   static std::atomic_ulong subgraph_count = {0};
@@ -143,6 +150,16 @@ std::string ConvertNnvmGraphToOnnx(const nnvm::Graph& g,
     }    // conversion function exists
   }      // loop over i from 0 to num_nodes
 
+  // the range of a dynamic batch size is given to TensorRT by an optimization profile
+  if (g.attrs.count("dynamic_batch") && g.GetAttr<bool>("dynamic_batch")) {
+    for (ValueInfoProto& input : *graph_proto->mutable_input()) {
+      if (placeholder_shapes.count(input.name()))
+        SetDynamicBatch(&input);
+    }
+    for (ValueInfoProto& output : *graph_proto->mutable_output())
+      SetDynamicBatch(&output);
+  }
+
   model_proto.SerializeToString(&serialized_onnx_graph);
 
 #if MXNET_USE_TENSORRT_ONNX_CHECKER
@@ -30,6 +30,7 @@
 #include <onnx/onnx_pb.h>
 
 #include <NvInfer.h>
+#include <cuda_runtime_api.h>
 #include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 #include <google/protobuf/text_format.h>
@@ -37,6 +38,13 @@
 #include <dmlc/logging.h>
 #include <dmlc/parameter.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+#include <map>
+
 using std::cerr;
 using std::cout;
 using std::endl;
@@ -58,17 +66,145 @@ void PrintVersion() {
        << NV_TENSORRT_PATCH << endl;
 }
 
+std::unordered_map<std::string, std::pair<float, float>> ReadCalibTable(const std::string& fname) {
+  std::ifstream is(fname);
+  if (!is) {
+    throw dmlc::Error("Cannot open the calibration table " + fname);
+  }
+  std::unordered_map<std::string, std::pair<float, float>> ranges;
+  std::string name;
+  float min_range, max_range;
+  while (is >> name >> min_range >> max_range) {
+    ranges[name] = {min_range, max_range};
+  }
+  return ranges;
+}
+
+// Key of a cached engine, on one line
+std::string EngineCacheKey(const std::string& onnx_model, const EngineOptions& options) {
+  int device = 0;
+  cudaGetDevice(&device);
+  cudaDeviceProp prop;
+  cudaGetDeviceProperties(&prop, device);
+  // sorted, so that the key does not depend on the order of the hash map
+  std::map<std::string, std::pair<float, float>> ranges(options.dynamic_ranges.begin(),
+                                                        options.dynamic_ranges.end());
+  std::ostringstream ranges_str;
+  for (const auto& r : ranges) {
+    ranges_str << r.first << " " << r.second.first << " " << r.second.second << ";";
+  }
+  std::ostringstream key;
+  key << "tensorrt=" << NV_TENSORRT_MAJOR << "." << NV_TENSORRT_MINOR << "." << NV_TENSORRT_PATCH
+      << " device=" << prop.name << " sm=" << prop.major << prop.minor
+      << " precision=" << options.precision << " batch=" << options.min_batch_size << ","
+      << options.opt_batch_size << "," << options.max_batch_size
+      << " workspace=" << options.max_workspace_size
+      << " ranges=" << std::hash<std::string>()(ranges_str.str())
+      << " model=" << std::hash<std::string>()(onnx_model) << "," << onnx_model.size();
+  return key.str();
+}
+
+// Deserialize the engine cached in a file for the key, null when there is none
+unique_ptr<nvinfer1::ICudaEngine> LoadCachedEngine(const std::string& path,
+                                                   const std::string& key,
+                                                   nvinfer1::IRuntime* runtime) {
+  std::ifstream is(path, std::ios::binary);
+  std::string header;
+  if (!is || !std::getline(is, header) || header != key) {
+    return unique_ptr<nvinfer1::ICudaEngine>();
+  }
+  const std::string blob((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+#if NV_TENSORRT_MAJOR >= 8
+  return unique_ptr<nvinfer1::ICudaEngine>(
+      runtime->deserializeCudaEngine(blob.data(), blob.size()));
+#else
+  return unique_ptr<nvinfer1::ICudaEngine>(
+      runtime->deserializeCudaEngine(blob.data(), blob.size(), nullptr));
+#endif
+}
+
+void SaveCachedEngine(const std::string& path,
+                      const std::string& key,
+                      nvinfer1::ICudaEngine* engine) {
+  auto blob = InferObject(engine->serialize());
+  // written aside and renamed, so that other processes never read a partial engine
+  const std::string tmp_path =
+      path + "." + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+  {
+    std::ofstream os(tmp_path, std::ios::binary);
+    os << key << "\n";
+    os.write(static_cast<const char*>(blob->data()), blob->size());
+    if (!os) {
+      LOG(WARNING) << "Cannot write the TensorRT engine cache " << tmp_path;
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "Cannot write the TensorRT engine cache " << path;
+    std::remove(tmp_path.c_str());
+  }
+}
+
+#if NV_TENSORRT_MAJOR >= 8
+// Set the int8 ranges of the tensors found in the calibration table. MXNet names the outputs of
+// a layer after the layer, with an "_output" suffix.
+void SetDynamicRanges(nvinfer1::INetworkDefinition* network,
+                      const std::unordered_map<std::string, std::pair<float, float>>& ranges) {
+  auto set_range = [&ranges](nvinfer1::ITensor* tensor) {
+    auto it = ranges.find(tensor->getName());
+    if (it == ranges.end())
+      it = ranges.find(std::string(tensor->getName()) + "_output");
+    if (it == ranges.end())
+      return false;
+    const float amax = std::max(std::abs(it->second.first), std::abs(it->second.second));
+    return tensor->setDynamicRange(-amax, amax);
+  };
+  int num_missing = 0;
+  for (int i = 0; i < network->getNbInputs(); ++i) {
+    num_missing += !set_range(network->getInput(i));
+  }
+  for (int i = 0; i < network->getNbLayers(); ++i) {
+    nvinfer1::ILayer* layer = network->getLayer(i);
+    for (int j = 0; j < layer->getNbOutputs(); ++j) {
+      num_missing += !set_range(layer->getOutput(j));
+    }
+  }
+  if (num_missing > 0) {
+    LOG(INFO) << num_missing << " tensors have no range in the calibration table, "
+              << "the layers computing them are not run in int8";
+  }
+}
+#endif
+
 std::tuple<unique_ptr<nvinfer1::ICudaEngine>,
            unique_ptr<nvonnxparser::IParser>,
-           std::unique_ptr<TRT_Logger> >
+           std::unique_ptr<TRT_Logger>,
+           unique_ptr<nvinfer1::IRuntime> >
 onnxToTrtCtx(const std::string& onnx_model,
-             int32_t max_batch_size,
-             size_t max_workspace_size,
+             const EngineOptions& options,
              nvinfer1::ILogger::Severity verbosity,
              bool debug_builder) {
   GOOGLE_PROTOBUF_VERIFY_VERSION;
 
   auto trt_logger  = std::unique_ptr<TRT_Logger>(new TRT_Logger(verbosity));
+  auto trt_runtime = InferObject(nvinfer1::createInferRuntime(*trt_logger));
+  std::string cache_key, cache_path;
+  if (!options.cache_dir.empty()) {
+    cache_key = EngineCacheKey(onnx_model, options);
+    std::ostringstream fname;
+    fname << options.cache_dir << "/trt_" << std::hex << std::hash<std::string>()(cache_key)
+          << ".engine";
+    cache_path  = fname.str();
+    auto cached = LoadCachedEngine(cache_path, cache_key, trt_runtime.get());
+    if (cached) {
+      LOG(INFO) << "Loaded the TensorRT engine cached in " << cache_path;
+      return std::make_tuple(std::move(cached),
+                             unique_ptr<nvonnxparser::IParser>(),
+                             std::move(trt_logger),
+                             std::move(trt_runtime));
+    }
+  }
   auto trt_builder = InferObject(nvinfer1::createInferBuilder(*trt_logger));
   const auto explicitBatch =
       1U << static_cast<uint32_t>(nvinfer1::NetworkDefinitionCreationFlag::kEXPLICIT_BATCH);
@@ -106,7 +242,8 @@ onnxToTrtCtx(const std::string& onnx_model,
 #if NV_TENSORRT_MAJOR >= 8
   auto trt_config = InferObject(trt_builder->createBuilderConfig());
 #endif
-  if (dmlc::GetEnv("MXNET_TENSORRT_USE_FP16", true)) {
+  // layers of an int8 engine without a range run in fp16
+  if (options.precision == "fp16" || options.precision == "int8") {
     if (trt_builder->platformHasFastFp16()) {
 #if NV_TENSORRT_MAJOR >= 8
       trt_config->setFlag(nvinfer1::BuilderFlag::kFP16);
@@ -117,19 +254,51 @@ onnxToTrtCtx(const std::string& onnx_model,
       LOG(WARNING) << "TensorRT can't use fp16 on this platform";
     }
   }
-  trt_builder->setMaxBatchSize(max_batch_size);
+  if (options.precision == "int8") {
 #if NV_TENSORRT_MAJOR >= 8
-  trt_config->setMaxWorkspaceSize(max_workspace_size);
+    if (trt_builder->platformHasFastInt8()) {
+      trt_config->setFlag(nvinfer1::BuilderFlag::kINT8);
+      SetDynamicRanges(trt_network.get(), options.dynamic_ranges);
+    } else {
+      LOG(WARNING) << "TensorRT can't use int8 on this platform";
+    }
+#else
+    LOG(WARNING) << "TensorRT int8 engines need TensorRT 8";
+#endif
+  }
+  trt_builder->setMaxBatchSize(options.max_batch_size);
+#if NV_TENSORRT_MAJOR >= 8
+  if (options.min_batch_size < options.max_batch_size) {
+    nvinfer1::IOptimizationProfile* profile = trt_builder->createOptimizationProfile();
+    for (int i = 0; i < trt_network->getNbInputs(); ++i) {
+      nvinfer1::ITensor* input = trt_network->getInput(i);
+      nvinfer1::Dims dims      = input->getDimensions();
+      dims.d[0]                = options.min_batch_size;
+      profile->setDimensions(input->getName(), nvinfer1::OptProfileSelector::kMIN, dims);
+      dims.d[0] = options.opt_batch_size;
+      profile->setDimensions(input->getName(), nvinfer1::OptProfileSelector::kOPT, dims);
+      dims.d[0] = options.max_batch_size;
+      profile->setDimensions(input->getName(), nvinfer1::OptProfileSelector::kMAX, dims);
+    }
+    trt_config->addOptimizationProfile(profile);
+  }
+  trt_config->setMaxWorkspaceSize(options.max_workspace_size);
   if (debug_builder) {
     trt_config->setFlag(nvinfer1::BuilderFlag::kDEBUG);
   }
   auto trt_engine = InferObject(trt_builder->buildEngineWithConfig(*trt_network, *trt_config));
 #else
-  trt_builder->setMaxWorkspaceSize(max_workspace_size);
+  trt_builder->setMaxWorkspaceSize(options.max_workspace_size);
   trt_builder->setDebugSync(debug_builder);
   auto trt_engine = InferObject(trt_builder->buildCudaEngine(*trt_network));
 #endif
-  return std::make_tuple(std::move(trt_engine), std::move(trt_parser), std::move(trt_logger));
+  if (!cache_path.empty()) {
+    SaveCachedEngine(cache_path, cache_key, trt_engine.get());
+  }
+  return std::make_tuple(std::move(trt_engine),
+                         std::move(trt_parser),
+                         std::move(trt_logger),
+                         std::move(trt_runtime));
 }
 
 }  // namespace onnx_to_tensorrt
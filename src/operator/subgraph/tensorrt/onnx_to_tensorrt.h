@@ -38,6 +38,8 @@
 #include <string>
 #include <ctime>
 #include <tuple>
+#include <unordered_map>
+#include <utility>
 
 namespace onnx_to_tensorrt {
 
@@ -85,12 +87,41 @@ class TRT_Logger : public nvinfer1::ILogger {
   }
 };
 
+/*! \brief Options of the build of an engine */
+struct EngineOptions {
+  /*!
+   * \brief batch sizes of the optimization profile. The batch dimension of the network is
+   *        dynamic when min_batch_size < max_batch_size, opt_batch_size is the tuned one.
+   */
+  int32_t min_batch_size    = 32;
+  int32_t opt_batch_size    = 32;
+  int32_t max_batch_size    = 32;
+  size_t max_workspace_size = 1L << 30;
+  /*! \brief "fp32", "fp16" or "int8" */
+  std::string precision = "fp16";
+  /*! \brief min and max of the tensors of the network by name, for int8 */
+  std::unordered_map<std::string, std::pair<float, float>> dynamic_ranges;
+  /*! \brief directory of the serialized engines, they are not cached when empty */
+  std::string cache_dir;
+};
+
+/*!
+ * \brief Read a calibration table of MXNet: one "name min max" line per layer output, as in the
+ *        min_max_dict of a calibration collector, see mx.contrib.tensorrt.save_calib_table.
+ */
+std::unordered_map<std::string, std::pair<float, float>> ReadCalibTable(const std::string& fname);
+
+/*!
+ * \brief Build the engine of an ONNX model on the current device, or deserialize it from the
+ *        cache directory of the options. Cached engines are keyed by the model, the options, the
+ *        device and the version of TensorRT. The parser is null for a cached engine.
+ */
 std::tuple<unique_ptr<nvinfer1::ICudaEngine>,
            unique_ptr<nvonnxparser::IParser>,
-           std::unique_ptr<TRT_Logger> >
+           std::unique_ptr<TRT_Logger>,
+           unique_ptr<nvinfer1::IRuntime> >
 onnxToTrtCtx(const std::string& onnx_model,
-             int32_t max_batch_size                = 32,
-             size_t max_workspace_size             = 1L << 30,
+             const EngineOptions& options,
              nvinfer1::ILogger::Severity verbosity = nvinfer1::ILogger::Severity::kWARNING,
              bool debug_builder                    = false);
 }  // namespace onnx_to_tensorrt
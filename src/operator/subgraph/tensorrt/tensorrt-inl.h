@@ -62,10 +62,12 @@ struct TRTEngineParam {
   TRTEngineParam(onnx_to_tensorrt::unique_ptr<nvinfer1::ICudaEngine> _trt_engine,
                  onnx_to_tensorrt::unique_ptr<nvonnxparser::IParser> _trt_parser,
                  std::unique_ptr<onnx_to_tensorrt::TRT_Logger> _trt_logger,
+                 onnx_to_tensorrt::unique_ptr<nvinfer1::IRuntime> _trt_runtime,
                  const std::unordered_map<std::string, uint32_t>& input_map,
                  const std::unordered_map<std::string, uint32_t>& output_map) {
-    trt_engine    = std::move(_trt_engine);
     trt_logger    = std::move(_trt_logger);
+    trt_runtime   = std::move(_trt_runtime);
+    trt_engine    = std::move(_trt_engine);
     trt_parser    = std::move(_trt_parser);
     binding_order = std::make_shared<std::vector<std::pair<uint32_t, bool>>>();
     bindings      = std::make_shared<std::vector<void*>>();
@@ -75,6 +77,7 @@ struct TRTEngineParam {
       const std::string& binding_name = trt_engine->getBindingName(b);
       if (trt_engine->bindingIsInput(b)) {
         binding_order->emplace_back(input_map.at(binding_name), true);
+        dynamic_batch = dynamic_batch || trt_engine->getBindingDimensions(b).d[0] == -1;
       } else {
         binding_order->emplace_back(output_map.at(binding_name), false);
       }
@@ -82,12 +85,16 @@ struct TRTEngineParam {
     trt_executor = onnx_to_tensorrt::InferObject(trt_engine->createExecutionContext());
   }
 
+  // the logger and the runtime outlive the engine
+  std::unique_ptr<onnx_to_tensorrt::TRT_Logger> trt_logger;
+  onnx_to_tensorrt::unique_ptr<nvinfer1::IRuntime> trt_runtime;
   onnx_to_tensorrt::unique_ptr<nvinfer1::ICudaEngine> trt_engine;
   onnx_to_tensorrt::unique_ptr<nvinfer1::IExecutionContext> trt_executor;
   onnx_to_tensorrt::unique_ptr<nvonnxparser::IParser> trt_parser;
-  std::unique_ptr<onnx_to_tensorrt::TRT_Logger> trt_logger;
   std::shared_ptr<std::vector<std::pair<uint32_t, bool>>> binding_order;
   std::shared_ptr<std::vector<void*>> bindings;
+  /*! \brief whether the batch size of the inputs is set on each call */
+  bool dynamic_batch = false;
 };
 
 class TensorrtSelector : public SubgraphSelector {
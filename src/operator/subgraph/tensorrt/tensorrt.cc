@@ -27,6 +27,10 @@
 
 #include "./tensorrt-inl.h"
 
+#include <algorithm>
+
+#include "../../../common/cuda/utils.h"
+
 namespace mxnet {
 namespace op {
 
@@ -262,14 +266,38 @@ OpStatePtr TRTCreateState(const nnvm::NodeAttrs& attrs,
                           const std::vector<TShape>& in_shape,
                           const std::vector<int>& in_type) {
   const auto& node_param = nnvm::get<TRTParam>(attrs.parsed);
+  common::cuda::DeviceStore device_store(ctx.dev_id);
   nnvm::Graph graph;
   graph.outputs           = attrs.subgraphs[0]->outputs;
-  uint32_t max_batch_size = dmlc::GetEnv("MXNET_TENSORRT_MAX_BATCH_SIZE", in_shape[0][0]);
-  if (max_batch_size < in_shape[0][0]) {
-    LOG(INFO) << "Warning: max batch size changed to be is: " << in_shape[0][0]
+  const uint32_t batch    = in_shape[0][0];
+  uint32_t max_batch_size = dmlc::GetEnv("MXNET_TENSORRT_MAX_BATCH_SIZE", batch);
+  if (max_batch_size < batch) {
+    LOG(INFO) << "Warning: max batch size changed to be is: " << batch
               << " instead of: " << max_batch_size;
-    max_batch_size = in_shape[0][0];
+    max_batch_size = batch;
+  }
+  onnx_to_tensorrt::EngineOptions options;
+  // the engine runs any batch size between the min and the max ones, tuned for the bound one
+  options.min_batch_size = std::min(dmlc::GetEnv("MXNET_TENSORRT_MIN_BATCH_SIZE", batch), batch);
+  options.opt_batch_size = batch;
+  options.max_batch_size = max_batch_size;
+#if NV_TENSORRT_MAJOR < 8
+  // optimization profiles need TensorRT 8
+  options.min_batch_size = max_batch_size;
+#endif
+  options.max_workspace_size = 1 << 30;
+  options.precision          = dmlc::GetEnv(
+      "MXNET_TENSORRT_PRECISION",
+      std::string(dmlc::GetEnv("MXNET_TENSORRT_USE_FP16", true) ? "fp16" : "fp32"));
+  CHECK(options.precision == "fp32" || options.precision == "fp16" ||
+        options.precision == "int8")
+      << "MXNET_TENSORRT_PRECISION should be fp32, fp16 or int8, not " << options.precision;
+  const std::string calib_table = dmlc::GetEnv("MXNET_TENSORRT_CALIB_TABLE", std::string());
+  if (options.precision == "int8") {
+    CHECK(!calib_table.empty()) << "TensorRT int8 engines need MXNET_TENSORRT_CALIB_TABLE";
+    options.dynamic_ranges = ::onnx_to_tensorrt::ReadCalibTable(calib_table);
   }
+  options.cache_dir = dmlc::GetEnv("MXNET_TENSORRT_ENGINE_CACHE_DIR", std::string());
   std::unordered_map<std::string, NDArray> params_map = node_param.params_map;
   const auto& inputs_to_idx                           = node_param.inputs_to_idx;
   const auto& outputs_to_idx                          = node_param.outputs_to_idx;
@@ -308,11 +336,14 @@ OpStatePtr TRTCreateState(const nnvm::NodeAttrs& attrs,
   graph.attrs["shape_inputs"] = std::make_shared<nnvm::any>(std::move(shape_inputs));
   graph.attrs["dtype"]        = std::make_shared<nnvm::any>(std::move(dtypes));
   graph.attrs["shape"]        = std::make_shared<nnvm::any>(std::move(shapes));
-  auto onnx_graph             = op::nnvm_to_onnx::ConvertNnvmGraphToOnnx(graph, &params_map);
-  auto trt_tuple = ::onnx_to_tensorrt::onnxToTrtCtx(onnx_graph, max_batch_size, 1 << 30);
+  graph.attrs["dynamic_batch"] =
+      std::make_shared<nnvm::any>(options.min_batch_size < options.max_batch_size);
+  auto onnx_graph = op::nnvm_to_onnx::ConvertNnvmGraphToOnnx(graph, &params_map);
+  auto trt_tuple  = ::onnx_to_tensorrt::onnxToTrtCtx(onnx_graph, options);
   return OpStatePtr::Create<TRTEngineParam>(std::move(std::get<0>(trt_tuple)),
                                             std::move(std::get<1>(trt_tuple)),
                                             std::move(std::get<2>(trt_tuple)),
+                                            std::move(std::get<3>(trt_tuple)),
                                             inputs_to_idx,
                                             outputs_to_idx);
 }
@@ -58,6 +58,11 @@ void TRTCompute(const OpStatePtr& state,
     auto& p = param.binding_order->at(i);
     if (p.second == true) {
       param.bindings->at(i) = inputs[p.first].dptr_;
+      if (param.dynamic_batch) {
+        nvinfer1::Dims dims = param.trt_engine->getBindingDimensions(i);
+        dims.d[0]           = static_cast<int32_t>(inputs[p.first].shape_[0]);
+        param.trt_executor->setBindingDimensions(i, dims);
+      }
     } else {
       param.bindings->at(i) = outputs[p.first].dptr_;
     }
@@ -187,10 +187,11 @@ bool is_type_udf(const int& x) {
   return x == -1;
 }
 
-LoopState::LoopState(const nnvm::Symbol& g, bool is_dynamic) {
+LoopState::LoopState(const nnvm::Symbol& g, bool is_dynamic, bool static_shape) {
   this->subgraph_sym     = g;
   this->subgraph.outputs = g.outputs;
-  this->iter_op          = LoopState::MakeSharedOp(g, is_dynamic);
+  this->static_shape     = static_shape;
+  this->iter_op          = LoopState::MakeSharedOp(g, is_dynamic, static_shape);
 }
 
 void LoopState::Forward(int iter_no,
@@ -233,6 +234,7 @@ void LoopState::Forward(int iter_no,
     all_inputs.push_back(cinputs);
     all_outputs.push_back(coutputs);
     all_states.push_back(state);
+    all_ops.push_back(iter_op);
   }
 
   Imperative::Get()->set_is_recording(orig_is_record);
@@ -247,7 +249,7 @@ void LoopState::Backward(int iter_no,
 
   CHECK_GT(all_states.size(), iter_no)
       << "We didn't record the computation for iteration " << iter_no;
-  auto op = iter_op;
+  auto op = all_ops[iter_no];
   std::vector<NDArray*> inputs;
   std::vector<NDArray*> outputs;
   inputs.reserve(op->num_backward_inputs());
@@ -135,12 +135,26 @@ class LoopState {
   // needs to maintain a set of memory buffers for all computation states,
   // which will be used in the backward.
   std::vector<OpStatePtr> all_states;
+  // The cached op each recorded iteration ran with.
+  std::vector<CachedOpPtr> all_ops;
   CachedOpPtr iter_op;
   nnvm::Symbol subgraph_sym;
   nnvm::Graph subgraph;
+  bool static_shape;
 
  public:
-  explicit LoopState(const nnvm::Symbol& g, bool is_dynamic = true);
+  explicit LoopState(const nnvm::Symbol& g, bool is_dynamic = true, bool static_shape = false);
+
+  /*!
+   * \brief Run the next iterations with a cached op whose memory and executors are planned
+   *        once, for a body whose shapes are the same at every iteration.
+   */
+  void UseStaticShape() {
+    if (!static_shape) {
+      static_shape = true;
+      iter_op      = MakeSharedOp(subgraph_sym, false, true);
+    }
+  }
 
   void Forward(int iter_no,
                const std::vector<NDArray>& inputs,
@@ -155,8 +169,11 @@ class LoopState {
     all_outputs.clear();
     all_inputs.clear();
     all_states.clear();
+    all_ops.clear();
   }
-  static CachedOpPtr MakeSharedOp(const nnvm::Symbol& sym, bool is_dynamic = true) {
+  static CachedOpPtr MakeSharedOp(const nnvm::Symbol& sym,
+                                  bool is_dynamic   = true,
+                                  bool static_shape = false) {
     // We turn on static_alloc for two reasons.
     // It avoids the overhead of unnecessary memory allocation.
     // only static_alloc supports nested call of CachedOp.
@@ -167,6 +184,10 @@ class LoopState {
     } else {
       kwargs.push_back({"is_dynamic", "0"});
     }
+    // static_shape also keeps the executors of the body, so that an iteration only binds
+    // its inputs and outputs and pushes the ops.
+    if (static_shape)
+      kwargs.push_back({"static_shape", "1"});
     return std::make_shared<CachedOp>(sym, kwargs);
   }
 };
@@ -35,6 +35,7 @@
 #include <utility>
 #include "./operator_common.h"
 #include "./mshadow_op.h"
+#include "./tensor/transpose_cpu-inl.h"
 
 namespace mxnet {
 namespace op {
@@ -130,6 +131,23 @@ void SwapAxis(const nnvm::NodeAttrs& attrs,
 
   Reshape2Five(&inter_shape, shape_in, axis1, axis2);
 
+  if (std::is_same<xpu, cpu>::value) {
+    // swapping two axes with nothing (or only unit axes) in between is a batched 2D transpose
+    mxnet::TShape merged_shape, merged_axes;
+    MergeTransposeAxes(mxnet::TShape(inter_shape.shape_, inter_shape.shape_ + 5),
+                       mxnet::TShape({0, 3, 2, 1, 4}),
+                       &merged_shape,
+                       &merged_axes);
+    const DType* in_ptr = data_in.dptr<DType>();
+    DType* out_ptr      = data_out.dptr<DType>();
+    const bool done =
+        out_req == kAddTo
+            ? TransposeMergedCPU<DType, true>(in_ptr, out_ptr, merged_shape, merged_axes)
+            : TransposeMergedCPU<DType, false>(in_ptr, out_ptr, merged_shape, merged_axes);
+    if (done)
+      return;
+  }
+
   Tensor<xpu, 5, DType> inter_data_in = data_in.get_with_shape<xpu, 5, DType>(inter_shape, s);
 
   Shape<5> inter_shape2 = inter_shape;
@@ -0,0 +1,106 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file bin_count-inl.cuh
+ * \brief GPU counting of elements into bins, shared by histogram and bincount
+ */
+#ifndef MXNET_OPERATOR_TENSOR_BIN_COUNT_INL_CUH_
+#define MXNET_OPERATOR_TENSOR_BIN_COUNT_INL_CUH_
+
+#include <mxnet/base.h>
+#include <algorithm>
+#include "../../common/cuda/utils.h"
+
+namespace mxnet {
+namespace op {
+
+/*! \brief most bins which are counted in shared memory, 32kb of counters */
+const int kMaxSharedBins = 8192;
+
+/*!
+ * \brief Count the bins of a grid-stride range into counters privatized in shared memory.
+ *        The block adds its counters to out at the end, so that the contended atomics
+ *        stay in shared memory and each block issues one global atomic per bin.
+ */
+template <typename OType, typename BinOp>
+__global__ void BinCountSharedKernel(const index_t n,
+                                     const int nbins,
+                                     const BinOp bin,
+                                     OType* out) {
+  extern __shared__ unsigned int local_bins[];
+  for (int k = threadIdx.x; k < nbins; k += blockDim.x)
+    local_bins[k] = 0;
+  __syncthreads();
+  for (index_t i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += static_cast<index_t>(blockDim.x) * gridDim.x) {
+    const index_t k = bin(i);
+    if (k >= 0)
+      atomicAdd(&local_bins[k], 1U);
+  }
+  __syncthreads();
+  for (int k = threadIdx.x; k < nbins; k += blockDim.x) {
+    if (local_bins[k] > 0)
+      atomicAdd(&out[k], OType(local_bins[k]));
+  }
+}
+
+/*! \brief Count the bins of a grid-stride range with atomics on out directly */
+template <typename OType, typename BinOp>
+__global__ void BinCountGlobalKernel(const index_t n, const BinOp bin, OType* out) {
+  for (index_t i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += static_cast<index_t>(blockDim.x) * gridDim.x) {
+    const index_t k = bin(i);
+    if (k >= 0)
+      atomicAdd(&out[k], OType(1));
+  }
+}
+
+/*!
+ * \brief out[k] = number of i < n with bin(i) == k on GPU, a negative bin(i) drops the element.
+ *        Up to kMaxSharedBins bins are privatized in the shared memory of every block; with
+ *        more bins the atomics on out are spread enough not to contend.
+ */
+template <typename OType, typename BinOp>
+void BinCountGPU(mshadow::Stream<gpu>* s,
+                 const int dev_id,
+                 const index_t n,
+                 const index_t nbins,
+                 const BinOp& bin,
+                 OType* out) {
+  cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
+  CUDA_CALL(cudaMemsetAsync(out, 0, nbins * sizeof(OType), stream));
+  if (n == 0)
+    return;
+  const int threads = mshadow::cuda::kBaseThreadNum;
+  const int blocks  = static_cast<int>(std::min<index_t>(
+      (n + threads - 1) / threads, 8 * MultiprocessorCount(dev_id)));
+  if (nbins <= kMaxSharedBins) {
+    BinCountSharedKernel<<<blocks, threads, nbins * sizeof(unsigned int), stream>>>(
+        n, static_cast<int>(nbins), bin, out);
+  } else {
+    BinCountGlobalKernel<<<blocks, threads, 0, stream>>>(n, bin, out);
+  }
+  MSHADOW_CUDA_POST_KERNEL_CHECK(BinCountGPU);
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_TENSOR_BIN_COUNT_INL_CUH_
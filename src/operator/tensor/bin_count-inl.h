@@ -0,0 +1,132 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file bin_count-inl.h
+ * \brief Parallel accumulation of weights into bins on CPU, shared by histogram and bincount
+ */
+#ifndef MXNET_OPERATOR_TENSOR_BIN_COUNT_INL_H_
+#define MXNET_OPERATOR_TENSOR_BIN_COUNT_INL_H_
+
+#include <mxnet/base.h>
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <utility>
+#include <vector>
+#include "../../engine/openmp.h"
+
+namespace mxnet {
+namespace op {
+
+/*!
+ * \brief out[k] = sum of weight(i) over the i < n with bin(i) == k, for k < nbins.
+ *        A negative bin(i) drops the element.
+ *        The input is cut into one block per thread. With few bins every block counts into
+ *        its own private copy of the bins and the copies are summed at the end. With many
+ *        bins the private copies would not fit in the cache, so the elements are bucket
+ *        sorted by the range of bins each thread owns and every thread accumulates its own
+ *        range, which keeps the serial order of the additions.
+ */
+template <typename OType, typename BinOp, typename WeightOp>
+inline void BinCountCPU(const index_t n,
+                        const index_t nbins,
+                        const BinOp& bin,
+                        const WeightOp& weight,
+                        OType* out) {
+  // below this many elements per block the reduction costs more than it saves
+  const index_t kMinBlock       = 16384;
+  const index_t kMaxPrivateBins = 1 << 16;
+  const int omp_threads         = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+
+  const index_t nblocks = std::max<index_t>(1, std::min<index_t>(omp_threads, n / kMinBlock));
+  const index_t block   = (n + nblocks - 1) / nblocks;
+  if (nblocks == 1) {
+    std::fill(out, out + nbins, OType(0));
+    for (index_t i = 0; i < n; ++i) {
+      const index_t k = bin(i);
+      if (k >= 0)
+        out[k] += weight(i);
+    }
+    return;
+  }
+  if (nbins <= kMaxPrivateBins) {
+    std::unique_ptr<OType[]> bins(new OType[nblocks * nbins]);
+#pragma omp parallel for num_threads(omp_threads)
+    for (index_t b = 0; b < nblocks; ++b) {
+      OType* local      = bins.get() + b * nbins;
+      const index_t end = std::min(n, (b + 1) * block);
+      std::fill(local, local + nbins, OType(0));
+      for (index_t i = b * block; i < end; ++i) {
+        const index_t k = bin(i);
+        if (k >= 0)
+          local[k] += weight(i);
+      }
+    }
+#pragma omp parallel for num_threads(omp_threads)
+    for (index_t k = 0; k < nbins; ++k) {
+      OType sum = bins[k];
+      for (index_t b = 1; b < nblocks; ++b)
+        sum += bins[b * nbins + k];
+      out[k] = sum;
+    }
+    return;
+  }
+  // bucket o holds the bins [o * span, (o + 1) * span) and is filled by the blocks in order,
+  // offsets[o * nblocks + b] is where block b starts writing into bucket o
+  const index_t span = (nbins + nblocks - 1) / nblocks;
+  std::vector<index_t> offsets(nblocks * nblocks + 1, 0);
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t b = 0; b < nblocks; ++b) {
+    const index_t end = std::min(n, (b + 1) * block);
+    for (index_t i = b * block; i < end; ++i) {
+      const index_t k = bin(i);
+      if (k >= 0)
+        ++offsets[1 + k / span * nblocks + b];
+    }
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  std::vector<std::pair<index_t, OType>> sorted(offsets.back());
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t b = 0; b < nblocks; ++b) {
+    const index_t end = std::min(n, (b + 1) * block);
+    std::vector<index_t> pos(nblocks);
+    for (index_t o = 0; o < nblocks; ++o)
+      pos[o] = offsets[o * nblocks + b];
+    for (index_t i = b * block; i < end; ++i) {
+      const index_t k = bin(i);
+      if (k >= 0)
+        sorted[pos[k / span]++] = std::make_pair(k, weight(i));
+    }
+  }
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t o = 0; o < nblocks; ++o) {
+    const index_t lo = o * span;
+    const index_t hi = std::min(nbins, lo + span);
+    if (lo < hi)
+      std::fill(out + lo, out + hi, OType(0));
+    for (index_t j = offsets[o * nblocks]; j < offsets[(o + 1) * nblocks]; ++j)
+      out[sorted[j].first] += sorted[j].second;
+  }
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_TENSOR_BIN_COUNT_INL_H_
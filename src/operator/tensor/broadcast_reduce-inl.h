@@ -406,12 +406,149 @@ inline int fastest_stride(const TShape& small, const TShape& big, const TShape&
 
 }  // namespace
 
+/*!
+ * \brief Layout of a binary broadcast on compacted shapes, classified once per shape pair.
+ *        The output is viewed as rows x cols where cols is its innermost non-unit axis,
+ *        and each operand either walks that axis contiguously or repeats one element:
+ *        - kScalar:  one operand holds a single element, the output is one flat row
+ *        - kRow:     (M, N) op (1, N), e.g. a bias added to every row
+ *        - kColumn:  (M, N) op (M, 1), e.g. a per-row scale
+ *        - kOuter:   (M, 1) op (1, N)
+ *        - kGeneral: any other pattern; the operand offsets are unravelled once per row
+ */
+struct BinaryBroadcastPlan {
+  enum Kind { kScalar, kRow, kColumn, kOuter, kGeneral };
+  Kind kind;
+  index_t rows, cols;
+  /*! \brief whether lhs / rhs advance along cols */
+  bool lcol, rcol;
+  /*! \brief distance between the rows of lhs / rhs, 0 when broadcast over rows (2D kinds) */
+  index_t lrow, rrow;
+
+  template <int ndim>
+  void Init(const Shape<ndim>& lshape, const Shape<ndim>& rshape, const Shape<ndim>& oshape) {
+    lrow = rrow = 0;
+    if (lshape.Size() == 1 || rshape.Size() == 1) {
+      kind = kScalar;
+      rows = 1;
+      cols = oshape.Size();
+      lcol = rshape.Size() == 1;
+      rcol = !lcol;
+      return;
+    }
+    int last = -1, first = -1, axes = 0;
+    for (int i = 0; i < ndim; ++i) {
+      if (oshape[i] > 1) {
+        first = last;
+        last  = i;
+        ++axes;
+      }
+    }
+    cols = oshape[last];
+    rows = oshape.Size() / cols;
+    lcol = lshape[last] > 1;
+    rcol = rshape[last] > 1;
+    if (axes > 2) {
+      kind = kGeneral;
+      return;
+    }
+    lrow = first >= 0 && lshape[first] > 1 ? lshape[last] : 0;
+    rrow = first >= 0 && rshape[first] > 1 ? rshape[last] : 0;
+    if (lcol && rcol) {
+      kind = kRow;
+    } else if (lrow != 0 && rrow != 0) {
+      kind = kColumn;
+    } else {
+      kind = kOuter;
+    }
+  }
+};
+
+/*!
+ * \brief out[i] = OP(lhs[i * lstep], rhs[i * rstep]) for i < n with unit or zero steps,
+ *        so that the compiler can vectorize the loop.
+ */
+template <typename OP, bool lstep, bool rstep, typename DType>
+inline void BinaryBroadcastRow(const DType* lhs,
+                               const DType* rhs,
+                               DType* out,
+                               const index_t n,
+                               const OpReqType req) {
+  const DType lval = lhs[0];
+  const DType rval = rhs[0];
+  if (req == kAddTo) {
+#pragma omp simd
+    for (index_t i = 0; i < n; ++i)
+      out[i] += OP::Map(lstep ? lhs[i] : lval, rstep ? rhs[i] : rval);
+  } else {
+#pragma omp simd
+    for (index_t i = 0; i < n; ++i)
+      out[i] = OP::Map(lstep ? lhs[i] : lval, rstep ? rhs[i] : rval);
+  }
+}
+
+/*!
+ * \brief Run a binary broadcast classified by BinaryBroadcastPlan. The rows are cut into
+ *        chunks spread over the OpenMP threads, so that a single long row is split as well.
+ */
+template <int ndim, typename DType, typename OP>
+void BinaryBroadcastPlanCompute(const BinaryBroadcastPlan& plan,
+                                const OpReqType req,
+                                const TBlob& lhs,
+                                const TBlob& rhs,
+                                const TBlob& out) {
+  const index_t kChunk      = 8192;
+  const index_t chunks      = (plan.cols + kChunk - 1) / kChunk;
+  const index_t tasks       = plan.rows * chunks;
+  const Shape<ndim> oshape  = out.shape_.get<ndim>();
+  const Shape<ndim> lstride = mxnet_op::calc_stride(lhs.shape_.get<ndim>());
+  const Shape<ndim> rstride = mxnet_op::calc_stride(rhs.shape_.get<ndim>());
+  const DType* lptr         = lhs.dptr<DType>();
+  const DType* rptr         = rhs.dptr<DType>();
+  DType* optr               = out.dptr<DType>();
+  const int omp_threads     = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(omp_threads) if (plan.rows * plan.cols >= kChunk)
+  for (index_t t = 0; t < tasks; ++t) {
+    const index_t row = t / chunks;
+    const index_t c0  = t % chunks * kChunk;
+    const index_t n   = std::min(kChunk, plan.cols - c0);
+    index_t loff, roff;
+    if (plan.kind == BinaryBroadcastPlan::kGeneral) {
+      const Shape<ndim> coord = mxnet_op::unravel(row * plan.cols, oshape);
+      loff                    = mxnet_op::dot(coord, lstride);
+      roff                    = mxnet_op::dot(coord, rstride);
+    } else {
+      loff = row * plan.lrow;
+      roff = row * plan.rrow;
+    }
+    if (plan.lcol)
+      loff += c0;
+    if (plan.rcol)
+      roff += c0;
+    DType* dst = optr + row * plan.cols + c0;
+    if (plan.lcol && plan.rcol) {
+      BinaryBroadcastRow<OP, true, true>(lptr + loff, rptr + roff, dst, n, req);
+    } else if (plan.lcol) {
+      BinaryBroadcastRow<OP, true, false>(lptr + loff, rptr + roff, dst, n, req);
+    } else {
+      BinaryBroadcastRow<OP, false, true>(lptr + loff, rptr + roff, dst, n, req);
+    }
+  }
+}
+
 template <int ndim, typename DType, typename OP>
 void BinaryBroadcastComputeImpl(Stream<cpu>* s,
                                 const OpReqType req,
                                 const TBlob& lhs,
                                 const TBlob& rhs,
                                 const TBlob& out) {
+  BinaryBroadcastPlan plan;
+  plan.Init(lhs.shape_.get<ndim>(), rhs.shape_.get<ndim>(), out.shape_.get<ndim>());
+  // narrow rows of a general pattern are left to the kernel which increments coordinates
+  if (plan.kind != BinaryBroadcastPlan::kGeneral || plan.cols >= 16) {
+    BinaryBroadcastPlanCompute<ndim, DType, OP>(plan, req, lhs, rhs, out);
+    return;
+  }
   mshadow::Shape<ndim> oshape  = out.shape_.get<ndim>();
   mshadow::Shape<ndim> lstride = mxnet_op::calc_stride(lhs.shape_.get<ndim>());
   mshadow::Shape<ndim> rstride = mxnet_op::calc_stride(rhs.shape_.get<ndim>());
@@ -427,6 +564,104 @@ void BinaryBroadcastComputeImpl(Stream<cpu>* s,
       out.dptr<DType>());
 }
 
+/*!
+ * \brief Row reduce: the innermost axis of big is reduced. Each output reduces the contiguous
+ *        runs of `inner` elements at every outer reduced coordinate, so that the coordinates
+ *        are unravelled once per run instead of once per element.
+ */
+template <typename Reducer,
+          int ndim,
+          typename AType,
+          typename DType,
+          typename OType,
+          typename OP,
+          typename IndexOP>
+void seq_reduce_rows(const size_t N,
+                     const size_t M,
+                     const index_t inner,
+                     const bool addto,
+                     const DType* __restrict big,
+                     OType* small,
+                     const Shape<ndim>& bshape,
+                     const Shape<ndim>& sshape,
+                     const Shape<ndim>& rshape,
+                     const Shape<ndim>& rstride,
+                     const int thread_count) {
+  const index_t runs = M / inner;
+#pragma omp parallel for num_threads(thread_count)
+  for (index_t idx = 0; idx < static_cast<index_t>(N); ++idx) {
+    const index_t j = mxnet_op::ravel(mxnet_op::unravel(idx, sshape), bshape);
+    AType val, residual;
+    Reducer::SetInitValue(val, residual);
+    for (index_t r = 0; r < runs; ++r) {
+      const DType* run = big + j + mxnet_op::dot(mxnet_op::unravel(r * inner, rshape), rstride);
+      for (index_t t = 0; t < inner; ++t) {
+        AType temp = OP::Map(run[t]);
+        if (IndexOP::do_op)
+          IndexOP::Op(&temp, r * inner + t);
+        Reducer::Reduce(val, temp, residual);
+      }
+    }
+    Reducer::Finalize(val, residual);
+    assign(&small[idx], addto, OType(val));
+  }
+}
+
+/*!
+ * \brief Column reduce: the innermost axis of big is kept. The outputs are cut into chunks of
+ *        at most `chunk` contiguous elements, and each chunk accumulates the matching contiguous
+ *        slice of big at every reduced coordinate, so that big is read row by row rather than
+ *        with the stride of the reduced axes.
+ */
+template <typename Reducer,
+          int ndim,
+          typename AType,
+          typename DType,
+          typename OType,
+          typename OP,
+          typename IndexOP>
+void seq_reduce_columns(const size_t N,
+                        const size_t M,
+                        const index_t inner,
+                        const index_t chunk,
+                        const bool addto,
+                        const DType* __restrict big,
+                        OType* small,
+                        const Shape<ndim>& bshape,
+                        const Shape<ndim>& sshape,
+                        const Shape<ndim>& rshape,
+                        const Shape<ndim>& rstride,
+                        const int thread_count) {
+  const index_t num_chunks = (inner + chunk - 1) / chunk;
+  const index_t units      = static_cast<index_t>(N) / inner * num_chunks;
+#pragma omp parallel num_threads(thread_count)
+  {
+    auto val      = std::make_unique<AType[]>(chunk);
+    auto residual = std::make_unique<AType[]>(chunk);
+#pragma omp for
+    for (index_t u = 0; u < units; ++u) {
+      const index_t first = u / num_chunks * inner + u % num_chunks * chunk;
+      const index_t len   = std::min(chunk, inner - u % num_chunks * chunk);
+      const index_t j     = mxnet_op::ravel(mxnet_op::unravel(first, sshape), bshape);
+      for (index_t t = 0; t < len; ++t)
+        Reducer::SetInitValue(val[t], residual[t]);
+      for (index_t m = 0; m < static_cast<index_t>(M); ++m) {
+        const DType* row = big + j + mxnet_op::dot(mxnet_op::unravel(m, rshape), rstride);
+        for (index_t t = 0; t < len; ++t) {
+          AType temp = OP::Map(row[t]);
+          if (IndexOP::do_op)
+            IndexOP::Op(&temp, m);
+          Reducer::Reduce(val[t], temp, residual[t]);
+        }
+      }
+      for (index_t t = 0; t < len; ++t) {
+        Reducer::Finalize(val[t], residual[t]);
+        assign(&small[first + t], addto, OType(val[t]));
+      }
+    }
+  }
+}
+
 template <typename Reducer,
           int ndim,
           typename AType,
@@ -444,6 +679,32 @@ void seq_reduce_compute(const size_t N,
                         const Shape<ndim> rshape,
                         const Shape<ndim> rstride) {
   const int thread_count = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  // The shapes come compacted by BroadcastReduceShapeCompact, so the innermost axis which is
+  // not 1 is the only contiguous one. With enough outputs to feed all threads, loop over it
+  // innermost, as a row reduce if it is reduced and as a column reduce if it is kept.
+  // Both visit the reduced elements of each output in the same order as seq_reduce_assign.
+  int last = ndim - 1;
+  while (last > 0 && bshape[last] == 1)
+    --last;
+  const index_t inner = bshape[last];
+  if (inner > 1 && M > 1) {
+    if (sshape[last] == 1) {
+      if (N >= static_cast<size_t>(thread_count)) {
+        seq_reduce_rows<Reducer, ndim, AType, DType, OType, OP, IndexOP>(
+            N, M, inner, addto, big, small, bshape, sshape, rshape, rstride, thread_count);
+        return;
+      }
+    } else {
+      // chunks of 16 to 512 outputs, small enough to give every thread some
+      const index_t chunk =
+          std::min<index_t>(inner, std::max<index_t>(16, std::min<index_t>(512, N / thread_count)));
+      if (N / inner * ((inner + chunk - 1) / chunk) >= static_cast<size_t>(thread_count)) {
+        seq_reduce_columns<Reducer, ndim, AType, DType, OType, OP, IndexOP>(
+            N, M, inner, chunk, addto, big, small, bshape, sshape, rshape, rstride, thread_count);
+        return;
+      }
+    }
+  }
   if (N >= thread_count) {
 #pragma omp parallel for num_threads(thread_count)
     for (index_t idx = 0; idx < static_cast<index_t>(N); ++idx) {
@@ -494,7 +755,11 @@ void Reduce(Stream<cpu>* s,
   diff(small.shape_.get<ndim>(), big.shape_.get<ndim>(), &rshape, &rstride);
   size_t N = small.shape_.Size(), M = rshape.Size();
   if (!safe_acc) {
-    seq_reduce_compute<Reducer, ndim, DType, DType, DType, OP>(N,
+    // bfloat16 has 8 bits of mantissa, it is still accumulated in float
+    typedef typename std::conditional<std::is_same<DType, mshadow::bfloat::bf16_t>::value,
+                                      float,
+                                      DType>::type AType;
+    seq_reduce_compute<Reducer, ndim, AType, DType, DType, OP>(N,
                                                                M,
                                                                req == kAddTo,
                                                                big.dptr<DType>(),
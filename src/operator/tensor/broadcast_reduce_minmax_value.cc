@@ -30,6 +30,12 @@ MXNET_OPERATOR_REGISTER_MINMAX_REDUCE(max)
     .add_alias("max_axis")
     .describe(get_reduce_axes_description("max", __LINE__))
     .set_attr<FCompute>("FCompute<cpu>", ReduceAxesCompute<cpu, mshadow::red::maximum>)
+#if MXNET_USE_ONEDNN == 1
+    .set_attr<bool>("TIsDNNL", true)
+    .set_attr<FInferStorageType>("FInferStorageType", ReduceMinMaxAxesStorageType)
+    .set_attr<FComputeEx>("FComputeEx<cpu>",
+                          ReduceMinMaxAxesForwardEx<mshadow::red::maximum, dnnl::algorithm::reduction_max>)
+#endif
     .set_attr<FResourceRequest>("FResourceRequest",
                                 [](const NodeAttrs& attrs) {
                                   return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
@@ -45,6 +51,12 @@ MXNET_OPERATOR_REGISTER_MINMAX_REDUCE(min)
     .add_alias("min_axis")
     .describe(get_reduce_axes_description("min", __LINE__))
     .set_attr<FCompute>("FCompute<cpu>", ReduceAxesCompute<cpu, mshadow::red::minimum>)
+#if MXNET_USE_ONEDNN == 1
+    .set_attr<bool>("TIsDNNL", true)
+    .set_attr<FInferStorageType>("FInferStorageType", ReduceMinMaxAxesStorageType)
+    .set_attr<FComputeEx>("FComputeEx<cpu>",
+                          ReduceMinMaxAxesForwardEx<mshadow::red::minimum, dnnl::algorithm::reduction_min>)
+#endif
     .set_attr<FResourceRequest>("FResourceRequest",
                                 [](const NodeAttrs& attrs) {
                                   return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
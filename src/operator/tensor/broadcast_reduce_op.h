@@ -1066,6 +1066,34 @@ void ReduceAxesOpForwardEx(const nnvm::NodeAttrs& attrs,
   }
 }
 
+#if MXNET_USE_ONEDNN == 1
+inline bool ReduceMinMaxAxesStorageType(const nnvm::NodeAttrs& attrs,
+                                        const int dev_mask,
+                                        DispatchMode* dispatch_mode,
+                                        std::vector<int>* in_attrs,
+                                        std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 1U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  return DNNLStorageType(attrs, dev_mask, true, dispatch_mode, in_attrs, out_attrs);
+}
+
+template <typename reducer, dnnl::algorithm alg>
+void ReduceMinMaxAxesForwardEx(const nnvm::NodeAttrs& attrs,
+                               const OpContext& ctx,
+                               const std::vector<NDArray>& inputs,
+                               const std::vector<OpReqType>& req,
+                               const std::vector<NDArray>& outputs) {
+  CHECK_EQ(inputs.size(), 1U);
+  CHECK_EQ(outputs.size(), 1U);
+  CHECK_EQ(req.size(), 1U);
+  if (SupportDNNLReduce<ReduceAxesParam>(attrs, inputs[0], outputs[0])) {
+    DNNLRun(DNNLReduceForward<ReduceAxesParam, alg>, attrs, ctx, inputs[0], req[0], outputs[0]);
+  } else {
+    FallBackCompute(ReduceAxesCompute<cpu, reducer>, attrs, ctx, inputs, req, outputs);
+  }
+}
+#endif
+
 template <int req, typename OP>
 struct reduce_axes_backward_broadcast {
   template <typename DType, typename OType>
@@ -2117,6 +2145,7 @@ Defined in )code";
       .set_attr_parser(AxesParamParser<ReduceAxesParam>)            \
       .set_attr<mxnet::FInferShape>("FInferShape", ReduceAxesShape) \
       .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<1, 1>) \
+      .set_attr<FOpCost>("FOpCost", ReduceOpCost<1>)                \
       .add_argument("data", "NDArray-or-Symbol", "The input")       \
       .add_arguments(ReduceAxesParam::__FIELDS__())
 
@@ -2127,6 +2156,7 @@ Defined in )code";
       .set_attr_parser(AxesParamParser<ReduceAxesParam>)                  \
       .set_attr<mxnet::FInferShape>("FInferShape", ReduceMinMaxAxesShape) \
       .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<1, 1>)       \
+      .set_attr<FOpCost>("FOpCost", ReduceOpCost<1>)                      \
       .add_argument("data", "NDArray-or-Symbol", "The input")             \
       .add_arguments(ReduceAxesParam::__FIELDS__())
 
@@ -26,8 +26,9 @@
 
 #include <dmlc/timer.h>
 #include <mxnet/ndarray.h>
-#include <vector>
 #include <algorithm>
+#include <cstring>
+#include <vector>
 #include "../mxnet_op.h"
 #include "../operator_common.h"
 #include "./init_op.h"
@@ -42,7 +43,7 @@ namespace mxnet {
 namespace op {
 
 /*!
- * \brief CPU Kernel for marking row_idx of a RSP tensor per row.
+ * \brief CPU Kernel for marking the non-zero rows of a dns tensor.
  */
 struct MarkRspRowIdx {
   // i represents the row index of the tensor data
@@ -67,6 +68,29 @@ struct MarkRspRowIdx {
   }
 };
 
+/*!
+ * \brief CPU kernel for filling the row_idx and the data of a RSP tensor from the inclusive prefix
+ * sum of the marks of the non-zero rows.
+ */
+struct FillRspRowIdxAndData {
+  // i represents the row index of the dns tensor
+  template <typename DType, typename RType>
+  MSHADOW_CINLINE static void Map(int i,
+                                  RType* row_idx,
+                                  DType* rsp_data,
+                                  const nnvm::dim_t* row_pos,
+                                  const DType* dns,
+                                  const nnvm::dim_t row_length) {
+    using nnvm::dim_t;
+    const dim_t pos = row_pos[i];
+    if (pos == (i > 0 ? row_pos[i - 1] : 0))
+      return;  // zero row
+    row_idx[pos - 1] = i;
+    std::memcpy(
+        rsp_data + (pos - 1) * row_length, dns + i * row_length, row_length * sizeof(DType));
+  }
+};
+
 /*!
  * \brief CPU implementation of casting a dns tensor to rsp type.
  */
@@ -86,29 +110,26 @@ inline void CastStorageDnsRspImpl(const OpContext& ctx,
       const dim_t num_rows   = dns.shape_[0];
       const dim_t row_length = dns.shape_.ProdShape(1, dns.shape_.ndim());
       rsp->CheckAndAllocAuxData(kIdx, Shape1(num_rows));
-      TBlob row_idx_blob = rsp->aux_data(kIdx);
-      RType* row_idx     = row_idx_blob.dptr<RType>();
-      dim_t num_threads  = num_rows;
+      RType* row_idx = rsp->aux_data(kIdx).dptr<RType>();
+      // the position of every non-zero row in the rsp tensor, plus one
+      std::vector<dim_t> row_pos(num_rows);
       mxnet_op::Kernel<MarkRspRowIdx, cpu>::Launch(
-          s, num_threads, row_idx, dns.dptr<DType>(), row_length);
-      dim_t nnr = 0;
-      nnr       = common::ParallelAccumulate(row_idx, num_rows, nnr);
+          s, num_rows, row_pos.data(), dns.dptr<DType>(), row_length);
+      common::ParallelInclusiveScan(row_pos.data(), num_rows);
+      const dim_t nnr = num_rows > 0 ? row_pos[num_rows - 1] : 0;
       rsp->set_aux_shape(kIdx, Shape1(nnr));
       if (0 == nnr)
         return;
       auto storage_shape = dns.shape_;
       storage_shape[0]   = nnr;
       rsp->CheckAndAllocData(storage_shape);
-      auto dns_data = dns.get_with_shape<cpu, 2, DType>(Shape2(num_rows, row_length), s);
-      auto rsp_data = rsp->data().get_with_shape<cpu, 2, DType>(Shape2(nnr, row_length), s);
-      dim_t idx     = 0;
-      for (dim_t i = 0; i < num_rows; ++i) {
-        if (row_idx[i] > 0) {
-          row_idx[idx] = i;
-          Copy(rsp_data[idx], dns_data[i], s);
-          ++idx;
-        }
-      }
+      mxnet_op::Kernel<FillRspRowIdxAndData, cpu>::Launch(s,
+                                                          num_rows,
+                                                          row_idx,
+                                                          rsp->data().dptr<DType>(),
+                                                          row_pos.data(),
+                                                          dns.dptr<DType>(),
+                                                          row_length);
     });
   });
 }
@@ -249,12 +270,9 @@ inline void CastStorageDnsCsrImpl(const OpContext& ctx,
         dim_t num_threads = num_rows;
         mxnet_op::Kernel<FillCsrIndPtr, cpu>::Launch(
             s, num_threads, indptr, dns_data, num_rows, num_cols);
-        // single thread to accumulate indptr
         // indptr[num_rows] indicates the number of non-zero elements
         indptr[0] = 0;
-        for (dim_t i = 0; i < num_rows; ++i) {
-          indptr[i + 1] += indptr[i];
-        }
+        common::ParallelInclusiveScan(indptr + 1, num_rows);
         // allocate column idx array and value array
         csr->CheckAndAllocAuxData(csr::kIdx, Shape1(static_cast<index_t>(indptr[num_rows])));
         csr->CheckAndAllocData(Shape1(static_cast<index_t>(indptr[num_rows])));
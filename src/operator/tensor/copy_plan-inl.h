@@ -0,0 +1,74 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file copy_plan-inl.h
+ * \brief CPU copy plans of the ops which rearrange their input (pad, repeat, tile): the output
+ *        is walked row by row, and every row is assembled from contiguous runs of the input
+ *        and of constants, so that the index arithmetic is done once per run
+ */
+#ifndef MXNET_OPERATOR_TENSOR_COPY_PLAN_INL_H_
+#define MXNET_OPERATOR_TENSOR_COPY_PLAN_INL_H_
+
+#include <mxnet/base.h>
+#include <mxnet/op_attr_types.h>
+#include <algorithm>
+#include "../../engine/openmp.h"
+
+namespace mxnet {
+namespace op {
+
+/*! \brief dst[0, len) = src[0, len), or += when req is kAddTo */
+template <typename DType>
+inline void CopyRunCPU(const DType* src, DType* dst, const index_t len, const OpReqType req) {
+  if (req == kAddTo) {
+    for (index_t i = 0; i < len; ++i)
+      dst[i] += src[i];
+  } else {
+    std::copy(src, src + len, dst);
+  }
+}
+
+/*! \brief dst[0, len) = val, or += when req is kAddTo */
+template <typename DType>
+inline void FillRunCPU(DType* dst, const index_t len, const DType val, const OpReqType req) {
+  if (req == kAddTo) {
+    for (index_t i = 0; i < len; ++i)
+      dst[i] += val;
+  } else {
+    std::fill(dst, dst + len, val);
+  }
+}
+
+/*!
+ * \brief Run row_op(r) for the rows r < rows of an output made of rows of row_len elements.
+ *        The rows are spread over the OpenMP threads when there is enough to copy.
+ */
+template <typename RowOp>
+inline void ForEachRowCPU(const index_t rows, const index_t row_len, const RowOp& row_op) {
+  const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(omp_threads) if (rows > 1 && rows * row_len >= 16384)
+  for (index_t r = 0; r < rows; ++r)
+    row_op(r);
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_TENSOR_COPY_PLAN_INL_H_
@@ -29,6 +29,7 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <numeric>
 #include <utility>
 #include <type_traits>
 
@@ -40,6 +41,9 @@
 #ifdef __CUDACC__
 #include "./dot-inl.cuh"
 #endif  // __CUDACC__
+#if defined(__AVX__) && !defined(__CUDACC__)
+#include <immintrin.h>
+#endif
 
 namespace mxnet {
 namespace op {
@@ -820,6 +824,262 @@ struct DotDnsCsrTransDnsByRowBlocks {
   }
 };
 
+/*! \brief bytes of the columns of the dense matrix which dot(csr, dns) computes at a time */
+constexpr size_t kDotCsrDnsColBlockBytes = 2048;
+
+/*!
+ * \brief Whether dot(csr, dns) on CPU uses the kernels balanced by the number of non-zeros,
+ *        rather than the ones parallelized over evenly sized row blocks
+ */
+inline bool DotCsrDnsUseNNZBlocks() {
+  return dmlc::GetEnv("MXNET_CSR_DOT_NNZ_BLOCKS", true);
+}
+
+/*!
+ * \brief Prefix sum of the number of non-zeros of each column of a csr matrix
+ * \param col_nnz col_nnz[c] is the number of non-zeros in the columns before c
+ */
+inline void CountCsrColumnNNZ(const NDArray& csr,
+                              const nnvm::dim_t num_cols,
+                              std::vector<nnvm::dim_t>* col_nnz) {
+  col_nnz->assign(num_cols + 1, 0);
+  const nnvm::dim_t nnz = csr.aux_shape(csr::kIdx)[0];
+  MSHADOW_IDX_TYPE_SWITCH(csr.aux_type(csr::kIdx), CType, {
+    const CType* col_idx = csr.aux_data(csr::kIdx).dptr<CType>();
+    for (nnvm::dim_t k = 0; k < nnz; ++k) {
+      ++(*col_nnz)[col_idx[k] + 1];
+    }
+  });
+  std::partial_sum(col_nnz->begin(), col_nnz->end(), col_nnz->begin());
+}
+
+/*!
+ * \brief Split [0, num_rows) into num_parts ranges of about the same cost, the cost of a row
+ *        being its number of non-zeros plus row_cost. A row is never split, so parts may be empty.
+ * \param indptr     indptr of the csr matrix, or any other prefix sum of the non-zeros per row
+ * \param row_starts first row of each part, followed by num_rows
+ */
+template <typename IType>
+inline void PartitionCsrRowsByNNZ(const IType* indptr,
+                                  const nnvm::dim_t num_rows,
+                                  const nnvm::dim_t num_parts,
+                                  const nnvm::dim_t row_cost,
+                                  std::vector<nnvm::dim_t>* row_starts) {
+  using nnvm::dim_t;
+  auto cost = [&](dim_t j) {
+    return static_cast<dim_t>(indptr[j] - indptr[0]) + j * row_cost;
+  };
+  const dim_t total = cost(num_rows);
+  row_starts->resize(num_parts + 1);
+  (*row_starts)[0] = 0;
+  for (dim_t p = 1; p < num_parts; ++p) {
+    const dim_t target = total / num_parts * p + total % num_parts * p / num_parts;
+    dim_t lo = (*row_starts)[p - 1], hi = num_rows;
+    while (lo < hi) {
+      const dim_t mid = lo + (hi - lo) / 2;
+      if (cost(mid) < target) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    (*row_starts)[p] = lo;
+  }
+  (*row_starts)[num_parts] = num_rows;
+}
+
+/*!
+ * \brief out[c0, c1) += data_l[k] * data_r[col_idx_l[k]][c0, c1) over the non-zeros
+ *        [k_begin, k_end) of one row of the csr matrix
+ */
+template <typename DType, typename IType, typename CType>
+inline void DotCsrRowDns(DType* out,
+                         const DType* data_l,
+                         const CType* col_idx_l,
+                         const IType k_begin,
+                         const IType k_end,
+                         const DType* data_r,
+                         const nnvm::dim_t num_cols,
+                         const nnvm::dim_t c0,
+                         const nnvm::dim_t c1) {
+  for (IType k = k_begin; k < k_end; ++k) {
+    const DType val  = data_l[k];
+    const DType* rhs = data_r + static_cast<nnvm::dim_t>(col_idx_l[k]) * num_cols;
+    for (nnvm::dim_t l = c0; l < c1; ++l) {
+      out[l] += rhs[l] * val;
+    }
+  }
+}
+
+/*!
+ * \brief float version of DotCsrRowDns, which keeps a strip of the output row in
+ *        registers over all the non-zeros of the row. The products are added in the
+ *        same order as the scalar loop.
+ */
+template <typename IType, typename CType>
+inline void DotCsrRowDns(float* out,
+                         const float* data_l,
+                         const CType* col_idx_l,
+                         const IType k_begin,
+                         const IType k_end,
+                         const float* data_r,
+                         const nnvm::dim_t num_cols,
+                         const nnvm::dim_t c0,
+                         const nnvm::dim_t c1) {
+  nnvm::dim_t l = c0;
+#if defined(__AVX512F__) && !defined(__CUDACC__)
+  for (; l + 64 <= c1; l += 64) {
+    __m512 acc0 = _mm512_loadu_ps(out + l);
+    __m512 acc1 = _mm512_loadu_ps(out + l + 16);
+    __m512 acc2 = _mm512_loadu_ps(out + l + 32);
+    __m512 acc3 = _mm512_loadu_ps(out + l + 48);
+    for (IType k = k_begin; k < k_end; ++k) {
+      const __m512 val = _mm512_set1_ps(data_l[k]);
+      const float* rhs = data_r + static_cast<nnvm::dim_t>(col_idx_l[k]) * num_cols + l;
+      acc0             = _mm512_add_ps(acc0, _mm512_mul_ps(_mm512_loadu_ps(rhs), val));
+      acc1             = _mm512_add_ps(acc1, _mm512_mul_ps(_mm512_loadu_ps(rhs + 16), val));
+      acc2             = _mm512_add_ps(acc2, _mm512_mul_ps(_mm512_loadu_ps(rhs + 32), val));
+      acc3             = _mm512_add_ps(acc3, _mm512_mul_ps(_mm512_loadu_ps(rhs + 48), val));
+    }
+    _mm512_storeu_ps(out + l, acc0);
+    _mm512_storeu_ps(out + l + 16, acc1);
+    _mm512_storeu_ps(out + l + 32, acc2);
+    _mm512_storeu_ps(out + l + 48, acc3);
+  }
+  for (; l + 16 <= c1; l += 16) {
+    __m512 acc = _mm512_loadu_ps(out + l);
+    for (IType k = k_begin; k < k_end; ++k) {
+      const float* rhs = data_r + static_cast<nnvm::dim_t>(col_idx_l[k]) * num_cols + l;
+      acc = _mm512_add_ps(acc, _mm512_mul_ps(_mm512_loadu_ps(rhs), _mm512_set1_ps(data_l[k])));
+    }
+    _mm512_storeu_ps(out + l, acc);
+  }
+#elif defined(__AVX__) && !defined(__CUDACC__)
+  for (; l + 32 <= c1; l += 32) {
+    __m256 acc0 = _mm256_loadu_ps(out + l);
+    __m256 acc1 = _mm256_loadu_ps(out + l + 8);
+    __m256 acc2 = _mm256_loadu_ps(out + l + 16);
+    __m256 acc3 = _mm256_loadu_ps(out + l + 24);
+    for (IType k = k_begin; k < k_end; ++k) {
+      const __m256 val = _mm256_set1_ps(data_l[k]);
+      const float* rhs = data_r + static_cast<nnvm::dim_t>(col_idx_l[k]) * num_cols + l;
+      acc0             = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(rhs), val));
+      acc1             = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(rhs + 8), val));
+      acc2             = _mm256_add_ps(acc2, _mm256_mul_ps(_mm256_loadu_ps(rhs + 16), val));
+      acc3             = _mm256_add_ps(acc3, _mm256_mul_ps(_mm256_loadu_ps(rhs + 24), val));
+    }
+    _mm256_storeu_ps(out + l, acc0);
+    _mm256_storeu_ps(out + l + 8, acc1);
+    _mm256_storeu_ps(out + l + 16, acc2);
+    _mm256_storeu_ps(out + l + 24, acc3);
+  }
+  for (; l + 8 <= c1; l += 8) {
+    __m256 acc = _mm256_loadu_ps(out + l);
+    for (IType k = k_begin; k < k_end; ++k) {
+      const float* rhs = data_r + static_cast<nnvm::dim_t>(col_idx_l[k]) * num_cols + l;
+      acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(rhs), _mm256_set1_ps(data_l[k])));
+    }
+    _mm256_storeu_ps(out + l, acc);
+  }
+#endif
+  if (l < c1) {
+    DotCsrRowDns<float, IType, CType>(
+        out, data_l, col_idx_l, k_begin, k_end, data_r, num_cols, l, c1);
+  }
+}
+
+/*!
+ * \brief CPU Kernel of dot(csr, dns1) = dns2
+ * Parallelization by blocks of rows holding about the same number of non-zeros, times
+ * blocks of columns of the dense matrices, so that the rows of dns1 read by a block of
+ * rows stay in cache.
+ */
+struct DotCsrDnsDnsByNNZBlocks {
+  /*!
+   * \brief
+   * \param i              the i-th (row block, column block) pair
+   * \param row_starts     first row of each row block, see PartitionCsrRowsByNNZ
+   * \param col_block      number of columns of a column block
+   * \param num_col_blocks number of column blocks
+   * \param write          whether the output is overwritten rather than added to
+   */
+  template <typename DType, typename IType, typename CType>
+  MSHADOW_CINLINE static void Map(int i,
+                                  DType* out,
+                                  const DType* data_l,
+                                  const IType* indptr_l,
+                                  const CType* col_idx_l,
+                                  const DType* data_r,
+                                  const nnvm::dim_t* row_starts,
+                                  const nnvm::dim_t col_block,
+                                  const nnvm::dim_t num_col_blocks,
+                                  const nnvm::dim_t num_cols,
+                                  const bool write) {
+    using nnvm::dim_t;
+    const dim_t part = i / num_col_blocks;
+    const dim_t c0   = i % num_col_blocks * col_block;
+    const dim_t c1   = std::min(c0 + col_block, num_cols);
+    for (dim_t j = row_starts[part]; j < row_starts[part + 1]; ++j) {
+      DType* out_row = out + j * num_cols;
+      if (write) {
+        std::fill(out_row + c0, out_row + c1, DType(0));
+      }
+      DotCsrRowDns(
+          out_row, data_l, col_idx_l, indptr_l[j], indptr_l[j + 1], data_r, num_cols, c0, c1);
+    }
+  }
+};
+
+/*!
+ * \brief CPU Kernel of dot(csr.T(), dns) = dns or rsp
+ * Parallelization by ranges of columns of the csr matrix holding about the same number of
+ * non-zeros. The column indices of each csr row are sorted, so the non-zeros of a range are
+ * found by binary search instead of scanning every row.
+ */
+struct DotCsrTransDnsByColRanges {
+  /*!
+   * \brief
+   * \param i           the i-th range of columns
+   * \param row_flg_sum prefix sum of the non-zero columns for a rsp output, nullptr for dns
+   * \param col_starts  first column of each range, see PartitionCsrRowsByNNZ
+   */
+  template <typename DType, typename IType, typename CType>
+  MSHADOW_CINLINE static void Map(int i,
+                                  DType* out,
+                                  const nnvm::dim_t* row_flg_sum,
+                                  const DType* data_l,
+                                  const IType* indptr_l,
+                                  const CType* col_idx_l,
+                                  const DType* data_r,
+                                  const nnvm::dim_t* col_starts,
+                                  const nnvm::dim_t num_rows_l,
+                                  const nnvm::dim_t num_cols) {
+    using nnvm::dim_t;
+    const dim_t col_start = col_starts[i];
+    const dim_t col_end   = col_starts[i + 1];
+    if (col_start == col_end)
+      return;
+    // each non-zero (j, col) adds a multiple of the single row data_r[j] to out[col]
+    const CType first_row = 0;
+    for (dim_t j = 0; j < num_rows_l; ++j) {
+      const CType* row_end = col_idx_l + indptr_l[j + 1];
+      const CType* it      = std::lower_bound(col_idx_l + indptr_l[j], row_end, col_start);
+      for (; it != row_end && *it < col_end; ++it) {
+        const dim_t out_row = row_flg_sum ? row_flg_sum[*it] - 1 : static_cast<dim_t>(*it);
+        DotCsrRowDns(out + out_row * num_cols,
+                     data_l + (it - col_idx_l),
+                     &first_row,
+                     0,
+                     1,
+                     data_r + j * num_cols,
+                     num_cols,
+                     0,
+                     num_cols);
+      }
+    }
+  }
+};
+
 /*!
  * \brief CPU Impl of dot(csr, dns1) = dns2 and dot(csr.T, dns1) = dns2
  */
@@ -851,10 +1111,59 @@ inline void DotCsrDnsDnsImpl(const OpContext& ctx,
     MSHADOW_IDX_TYPE_SWITCH(indptr_l.type_flag_, IType, {     // indptr type
       MSHADOW_IDX_TYPE_SWITCH(col_idx_l.type_flag_, CType, {  // col idx type
         dim_t num_threads;
+        if (!trans_lhs && DotCsrDnsUseNNZBlocks()) {
+          const dim_t num_rows = data_out.shape_[0];
+          const dim_t num_cols = data_out.shape_[1];
+          // a few row blocks per thread, scheduled dynamically, absorb the rows too heavy
+          // to be balanced
+          const dim_t num_parts =
+              std::min<dim_t>(num_rows, 4 * mxnet_op::get_num_threads<cpu>(num_rows));
+          const dim_t col_block = std::min<dim_t>(
+              num_cols, std::max<size_t>(64, kDotCsrDnsColBlockBytes / sizeof(DType)));
+          const dim_t col_blocks = (num_cols + col_block - 1) / col_block;
+          std::vector<dim_t> row_starts;
+          // writing a row of the output counts as one more non-zero
+          PartitionCsrRowsByNNZ(indptr_l.dptr<IType>(), num_rows, num_parts, 1, &row_starts);
+          mxnet_op::Kernel<DotCsrDnsDnsByNNZBlocks, cpu>::LaunchDynamic(s,
+                                                                        num_parts * col_blocks,
+                                                                        data_out.dptr<DType>(),
+                                                                        data_l.dptr<DType>(),
+                                                                        indptr_l.dptr<IType>(),
+                                                                        col_idx_l.dptr<CType>(),
+                                                                        data_r.dptr<DType>(),
+                                                                        row_starts.data(),
+                                                                        col_block,
+                                                                        col_blocks,
+                                                                        num_cols,
+                                                                        kWriteTo == req);
+          return;
+        }
         if (kWriteTo == req) {
           num_threads = data_out.Size();
           mxnet_op::Kernel<mxnet_op::set_zero, cpu>::Launch(s, num_threads, data_out.dptr<DType>());
         }
+        if (trans_lhs && DotCsrDnsUseNNZBlocks()) {
+          const dim_t num_rows_l = lhs.shape()[0];
+          const dim_t num_rows   = data_out.shape_[0];
+          num_threads = std::min<dim_t>(num_rows, mxnet_op::get_num_threads<cpu>(num_rows));
+          std::vector<dim_t> col_nnz;
+          CountCsrColumnNNZ(lhs, num_rows, &col_nnz);
+          std::vector<dim_t> col_starts;
+          PartitionCsrRowsByNNZ(col_nnz.data(), num_rows, num_threads, 0, &col_starts);
+          mxnet_op::Kernel<DotCsrTransDnsByColRanges, cpu>::Launch(
+              s,
+              num_threads,
+              data_out.dptr<DType>(),
+              static_cast<const dim_t*>(nullptr),
+              data_l.dptr<DType>(),
+              indptr_l.dptr<IType>(),
+              col_idx_l.dptr<CType>(),
+              data_r.dptr<DType>(),
+              col_starts.data(),
+              num_rows_l,
+              data_out.shape_[1]);
+          return;
+        }
         num_threads                        = mxnet_op::get_num_threads<cpu>(data_out.shape_[0]);
         bool dynamic                       = false;
         const dim_t large_matrix_threshold = 1024 * 10;
@@ -973,7 +1282,25 @@ inline void DotCsrDnsRspImpl(const OpContext& ctx,
           mxnet_op::Kernel<FillRspRowIdxKernel, cpu>::Launch(
               s, num_rows, row_idx_out, prefix_sum, num_rows);
 
-          num_threads   = mxnet_op::get_num_threads<cpu>(nnr);
+          num_threads = mxnet_op::get_num_threads<cpu>(nnr);
+          if (trans_lhs && DotCsrDnsUseNNZBlocks()) {
+            std::vector<dim_t> col_nnz, col_starts;
+            CountCsrColumnNNZ(lhs, num_rows, &col_nnz);
+            num_threads = std::min(num_threads, nnr);
+            PartitionCsrRowsByNNZ(col_nnz.data(), num_rows, num_threads, 0, &col_starts);
+            mxnet_op::Kernel<DotCsrTransDnsByColRanges, cpu>::Launch(s,
+                                                                     num_threads,
+                                                                     data_out.dptr<DType>(),
+                                                                     prefix_sum,
+                                                                     data_l.dptr<DType>(),
+                                                                     indptr_l.dptr<IType>(),
+                                                                     col_idx_l.dptr<CType>(),
+                                                                     data_r.dptr<DType>(),
+                                                                     col_starts.data(),
+                                                                     lhs.shape()[0],
+                                                                     ret->shape()[1]);
+            return;
+          }
           dim_t seg_len = (nnr + num_threads - 1) / num_threads;
           if (trans_lhs) {
             mxnet_op::Kernel<DotCsrTransDnsRspByRowBlocks, cpu>::Launch(s,
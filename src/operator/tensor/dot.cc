@@ -32,6 +32,34 @@ namespace mxnet {
 namespace op {
 DMLC_REGISTER_PARAMETER(DotParam);
 
+// a multiply-add per element of the output and of the contracted axis, sparse inputs count as
+// dense
+static OpCost DotCost(const nnvm::NodeAttrs& attrs,
+                      const std::vector<TBlob>& inputs,
+                      const std::vector<TBlob>& outputs) {
+  const DotParam& param = nnvm::get<DotParam>(attrs.parsed);
+  const TShape& lshape  = inputs[0].shape_;
+  index_t k             = 1;
+  if (lshape.ndim() > 0)
+    k = param.transpose_a ? lshape[0] : lshape[lshape.ndim() - 1];
+  OpCost cost;
+  cost.flops = 2 * outputs[0].shape_.Size() * k;
+  cost.bytes = OpCostBytes(inputs, outputs);
+  return cost;
+}
+
+static OpCost BatchDotCost(const nnvm::NodeAttrs& attrs,
+                           const std::vector<TBlob>& inputs,
+                           const std::vector<TBlob>& outputs) {
+  const DotParam& param = nnvm::get<DotParam>(attrs.parsed);
+  const TShape& lshape  = inputs[0].shape_;
+  const index_t k       = lshape[lshape.ndim() - (param.transpose_a ? 2 : 1)];
+  OpCost cost;
+  cost.flops = 2 * outputs[0].shape_.Size() * k;
+  cost.bytes = OpCostBytes(inputs, outputs);
+  return cost;
+}
+
 NNVM_REGISTER_OP(dot)
 MXNET_ADD_SPARSE_OP_ALIAS(dot)
     .describe(R"doc(Dot product of two arrays.
@@ -88,6 +116,7 @@ above patterns, ``dot`` will fallback and generate output with default storage.
                                      })
     .set_attr<mxnet::FInferShape>("FInferShape", DotShape)
     .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<2, 1>)
+    .set_attr<FOpCost>("FOpCost", DotCost)
     .set_attr<FInferStorageType>("FInferStorageType", DotForwardInferStorageType)
     .set_attr<FResourceRequest>("FResourceRequest",
                                 [](const NodeAttrs& attrs) {
@@ -182,6 +211,7 @@ which is computed by::
                                      })
     .set_attr<mxnet::FInferShape>("FInferShape", BatchDotShape<DotParam>)
     .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<2, 1>)
+    .set_attr<FOpCost>("FOpCost", BatchDotCost)
     .set_attr<FResourceRequest>("FResourceRequest",
                                 [](const NodeAttrs& attrs) {
                                   return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
@@ -56,12 +56,16 @@ struct binary_broadcast_params {
 __launch_bounds__(kRTCMaxThreadsPerBlock)
 __global__ void binary_broadcast_kernel(
     const binary_broadcast_params param,
-    const index_t lead_dim,
-    const index_t other_dim,
-    const index_t N,
-    const index_t num_aligned_elements) {
+    const index_t lead_dim_,
+    const index_t other_dim_,
+    const index_t N_,
+    const index_t num_aligned_elements_) {
   using namespace vector;
-  const index_t M = num_aligned_elements * other_dim;
+  // IdxType is 32-bit unless the tensors are too large for it
+  const IdxType lead_dim = lead_dim_;
+  const IdxType N = N_;
+  const IdxType num_aligned_elements = num_aligned_elements_;
+  const IdxType M = num_aligned_elements * static_cast<IdxType>(other_dim_);
 
   VectorizedLoader<InputType0, nvec, aligned> lloader(
     reinterpret_cast<const InputType0*>(param.inputs[0]), param.size[0]);
@@ -73,34 +77,34 @@ __global__ void binary_broadcast_kernel(
   using OType = AccType<OutputType0>;
 
 
-  for (index_t idx = blockIdx.x * blockDim.x + threadIdx.x;
+  for (IdxType idx = blockIdx.x * blockDim.x + threadIdx.x;
        idx < M;
        idx += gridDim.x * blockDim.x) {
     OutputType0 * current_output_pointer;
-    index_t output_size;
-    index_t output_idx;
+    IdxType output_size;
+    IdxType output_idx;
     if (aligned) {
       // Simplified case
-      index_t lindex, rindex;
-      util::unravel_dot<ndim>(idx * nvec, param.oshape,
-                              param.stride[0], param.stride[1],
-                              &lindex, &rindex);
+      IdxType lindex, rindex;
+      util::unravel_dot_as<IdxType, ndim>(idx * nvec, param.oshape,
+                                          param.stride[0], param.stride[1],
+                                          &lindex, &rindex);
       lloader.load(lindex / nvec, param.size[0]);
       rloader.load(rindex / nvec, param.size[1]);
       current_output_pointer = reinterpret_cast<OutputType0*>(param.outputs[0]);
       output_size = N;
       output_idx = idx;
     } else {
-      const index_t row = idx / num_aligned_elements;
-      const index_t lead_dim_idx = idx - row * num_aligned_elements;
+      const IdxType row = idx / num_aligned_elements;
+      const IdxType lead_dim_idx = idx - row * num_aligned_elements;
 
-      index_t lindex, rindex;
-      const index_t original_idx = max(lead_dim_idx * nvec - lloader.alignment(),
-                                       static_cast<index_t>(0)) +
+      IdxType lindex, rindex;
+      const IdxType original_idx = max(lead_dim_idx * nvec - lloader.alignment(),
+                                       static_cast<IdxType>(0)) +
                                    row * lead_dim;
-      util::unravel_dot<ndim>(original_idx, param.oshape,
-                              param.stride[0], param.stride[1],
-                              &lindex, &rindex);
+      util::unravel_dot_as<IdxType, ndim>(original_idx, param.oshape,
+                                          param.stride[0], param.stride[1],
+                                          &lindex, &rindex);
       lloader.load((lindex + lloader.alignment()) / nvec, param.size[0]);
       rloader.load((rindex + lloader.alignment()) / nvec, param.size[1]);
       current_output_pointer = reinterpret_cast<OutputType0*>(param.outputs[0]) + row * lead_dim;
@@ -141,12 +145,16 @@ struct binary_broadcast_params {
 __launch_bounds__(kRTCMaxThreadsPerBlock)
 __global__ void single_side_binary_broadcast_kernel(
     const binary_broadcast_params param,
-    const index_t lead_dim,
-    const index_t other_dim,
-    const index_t N,
-    const index_t num_aligned_elements) {
+    const index_t lead_dim_,
+    const index_t other_dim_,
+    const index_t N_,
+    const index_t num_aligned_elements_) {
   using namespace vector;
-  const index_t M = num_aligned_elements * other_dim;
+  // IdxType is 32-bit unless the tensors are too large for it
+  const IdxType lead_dim = lead_dim_;
+  const IdxType N = N_;
+  const IdxType num_aligned_elements = num_aligned_elements_;
+  const IdxType M = num_aligned_elements * static_cast<IdxType>(other_dim_);
   constexpr int other_side = 1 - side;
 
   VectorizedLoader<DType, nvec, aligned> lloader(
@@ -157,32 +165,33 @@ __global__ void single_side_binary_broadcast_kernel(
   using OType = AccType<OutputType0>;
 
 
-  for (index_t idx = blockIdx.x * blockDim.x + threadIdx.x;
+  for (IdxType idx = blockIdx.x * blockDim.x + threadIdx.x;
        idx < M;
        idx += gridDim.x * blockDim.x) {
-    index_t original_idx;
+    IdxType original_idx;
     OutputType0 * current_output_pointer;
-    index_t output_size;
-    index_t output_idx;
+    IdxType output_size;
+    IdxType output_idx;
     if (aligned) {
       // Simplified case
       original_idx = idx * nvec;
-      const index_t lindex = util::unravel_dot<ndim>(original_idx, param.oshape,
-                                                     param.stride[side]);
+      const IdxType lindex = util::unravel_dot_as<IdxType, ndim>(original_idx, param.oshape,
+                                                                 param.stride[side]);
       lloader.load(lindex / nvec, param.size[side]);
       current_output_pointer = reinterpret_cast<OutputType0*>(param.outputs[0]);
       output_size = N;
       output_idx = idx;
     } else {
-      const index_t row = idx / num_aligned_elements;
-      const index_t lead_dim_idx = idx - row * num_aligned_elements;
+      const IdxType row = idx / num_aligned_elements;
+      const IdxType lead_dim_idx = idx - row * num_aligned_elements;
       original_idx = lead_dim_idx * nvec -
                      lloader.alignment() + row * lead_dim;
-      const index_t original_idx_clamped = max(lead_dim_idx * nvec - lloader.alignment(),
-                                               static_cast<index_t>(0)) +
+      const IdxType original_idx_clamped = max(lead_dim_idx * nvec - lloader.alignment(),
+                                               static_cast<IdxType>(0)) +
                                            row * lead_dim;
-      const index_t lindex = util::unravel_dot<ndim>(original_idx_clamped, param.oshape,
-                                                     param.stride[side]);
+      const IdxType lindex = util::unravel_dot_as<IdxType, ndim>(original_idx_clamped,
+                                                                 param.oshape,
+                                                                 param.stride[side]);
       lloader.load((lindex + lloader.alignment()) / nvec, param.size[side]);
       current_output_pointer = reinterpret_cast<OutputType0*>(param.outputs[0]) + row * lead_dim;
       output_size = lead_dim;
@@ -195,11 +204,11 @@ __global__ void single_side_binary_broadcast_kernel(
     }
 #pragma unroll
     for (int i = 0; i < nvec; ++i) {
-      const index_t rindex = min(max(util::unravel_dot<ndim>(original_idx + i,
-                                                             param.oshape,
-                                                             param.stride[other_side]),
-                                     static_cast<index_t>(0)),
-                                 param.size[other_side] - 1);
+      const IdxType rindex = min(max(util::unravel_dot_as<IdxType, ndim>(original_idx + i,
+                                                                         param.oshape,
+                                                                         param.stride[other_side]),
+                                     static_cast<IdxType>(0)),
+                                 static_cast<IdxType>(param.size[other_side] - 1));
       const auto rinput = IType2::from(
                             reinterpret_cast<const DType2*>(param.inputs[other_side])
                             [rindex]);
@@ -320,6 +329,9 @@ void BinaryBroadcastRTCCompute::operator()(const nnvm::NodeAttrs& attrs,
                        "\n"
                        "const int ndim = " +
                        std::to_string(ndim) + ";\n";
+    // 64-bit index arithmetic only for the tensors that need it
+    code += output.shape_.Size() > mxnet_op::kMaxInt32KernelSize ? "using IdxType = index_t;\n" :
+                                                                   "using IdxType = int32;\n";
     if (common_shape != 1) {
       VectorizedKernelRTCLauncher(code,
                                   "binary_broadcast_kernel",
@@ -825,6 +825,7 @@ void DNNLBinaryOpForward(const nnvm::NodeAttrs& attrs,
                                        })                                                         \
       .set_attr<mxnet::FInferShape>("FInferShape", BinaryBroadcastShape)                          \
       .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<2, 1>)                               \
+      .set_attr<FOpCost>("FOpCost", ElemwiseOpCost<1>)                                            \
       .set_attr<nnvm::FInplaceOption>("FInplaceOption",                                           \
                                       [](const NodeAttrs& attrs) {                                \
                                         return std::vector<std::pair<int, int> >{{0, 0}, {1, 0}}; \
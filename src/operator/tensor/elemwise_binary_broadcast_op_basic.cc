@@ -46,27 +46,28 @@ void DNNLBinaryOpForward(const nnvm::NodeAttrs& attrs,
   // same.
   const bool same_shape = (input_0_shape == input_1_shape);
 
+  const bool is_any_dnnl_data =
+      inputs[0].IsDNNLData() || inputs[1].IsDNNLData() || outputs[0].IsDNNLData();
+
   if (same_shape && alg == dnnl::algorithm::binary_add) {
     DNNLSumFwd& fwd = DNNLSumFwd::GetCached(inputs, outputs);
     fwd.Execute(ctx, inputs, req, outputs);
+  } else if (same_shape && is_any_dnnl_data) {
+    // tensors in a oneDNN layout cannot be flattened
+    DNNLBinaryOpFwd& fwd = DNNLBinaryOpFwd::GetBinaryOpForward<alg>(inputs, outputs);
+    fwd.Execute(inputs, req, outputs);
   } else {
     mxnet::TShape new_lshape, new_rshape, new_oshape;
-    int ndim_diff = BinaryBroadcastShapeCompact(
+    DNNLBinaryCompactShapes(
         input_0_shape, input_1_shape, output_0_shape, &new_lshape, &new_rshape, &new_oshape);
     std::vector<NDArray> new_inputs;
-    std::vector<NDArray> new_outputs;
-    if (ndim_diff) {
-      new_inputs  = {inputs[0].Reshape(new_lshape), inputs[1].Reshape(new_rshape)};
-      new_outputs = {outputs[0].Reshape(new_oshape)};
-    } else if (input_0_shape.Size() == 1 && input_1_shape.Size() == 1) {
-      // BinaryBroadcastShapeCompact function doesn't reshape tensors of size (1,1,...,1)
-      // into shape (1). It is mandatory for oneDNN primitive to have this reshape done.
-      mxnet::TShape one_shape = mxnet::TShape(1, 1);
-      new_inputs              = {inputs[0].Reshape(one_shape), inputs[1].Reshape(one_shape)};
-      new_outputs             = {outputs[0].Reshape(one_shape)};
+    std::vector<NDArray> new_outputs = {outputs[0].Reshape(new_oshape)};
+    if (new_lshape == new_oshape) {
+      new_inputs = {inputs[0].Reshape(new_lshape), inputs[1].Reshape(new_rshape)};
     } else {
-      new_inputs  = {inputs[0], inputs[1]};
-      new_outputs = {outputs[0]};
+      // oneDNN only broadcasts the second source, SupportDNNLBinary allows this swap only for
+      // commutative operations
+      new_inputs = {inputs[1].Reshape(new_rshape), inputs[0].Reshape(new_lshape)};
     }
 
     DNNLBinaryOpFwd& fwd = DNNLBinaryOpFwd::GetBinaryOpForward<alg>(new_inputs, new_outputs);
@@ -83,8 +84,8 @@ static void BinaryOperatorComputeExCPU(const nnvm::NodeAttrs& attrs,
                                        const std::vector<NDArray>& outputs) {
 #if MXNET_USE_ONEDNN == 1
   if (common::ContainsOnlyStorage(inputs, kDefaultStorage)) {
-    if (SupportDNNLBinary(inputs, outputs)) {
-      const dnnl::algorithm alg = DNNLAlgorithm<OP>::value;
+    const dnnl::algorithm alg = DNNLAlgorithm<OP>::value;
+    if (SupportDNNLBinary(inputs, outputs, alg)) {
       DNNLRun(DNNLBinaryOpForward<alg>, attrs, ctx, inputs, req, outputs);
     } else {
       FallBackCompute(BinaryBroadcastCompute<cpu, OP>, attrs, ctx, inputs, req, outputs);
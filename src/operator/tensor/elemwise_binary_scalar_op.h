@@ -462,6 +462,7 @@ void PowerComputeExCPU(const nnvm::NodeAttrs& attrs,
       .set_attr_parser(ParamParser<NumpyBinaryScalarParam>)                               \
       .set_attr<mxnet::FInferShape>("FInferShape", ElemwiseShape<1, 1>)                   \
       .set_attr<nnvm::FInferType>("FInferType", NumpyBinaryScalarType)                    \
+      .set_attr<FOpCost>("FOpCost", ElemwiseOpCost<1>)                                    \
       .set_attr<mxnet::alm::FChangeLayout>("FChangeLayout", ElemwiseChangeLayout)         \
       .set_attr<nnvm::FInplaceOption>("FInplaceOption",                                   \
                                       [](const NodeAttrs& attrs) {                        \
@@ -937,6 +937,7 @@ void NumpyNanToNumOpBackward(const nnvm::NodeAttrs& attrs,
       .set_num_outputs(1)                                                                 \
       .set_attr<mxnet::FInferShape>("FInferShape", ElemwiseShape<1, 1>)                   \
       .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<1, 1>)                       \
+      .set_attr<FOpCost>("FOpCost", ElemwiseOpCost<1>)                                    \
       .set_attr<mxnet::alm::FChangeLayout>("FChangeLayout", ElemwiseChangeLayout)         \
       .set_attr<nnvm::FInplaceOption>("FInplaceOption",                                   \
                                       [](const NodeAttrs& attrs) {                        \
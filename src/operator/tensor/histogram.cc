@@ -22,57 +22,35 @@
  * \brief CPU implementation of histogram operator
  */
 #include "./histogram-inl.h"
+#include "./bin_count-inl.h"
 
 namespace mxnet {
 namespace op {
 
-struct ComputeBinKernel {
-  template <typename DType>
-  MSHADOW_XINLINE static void Map(index_t i,
-                                  const DType* in_data,
-                                  const DType* bin_bounds,
-                                  int* bin_indices,
-                                  int bin_cnt,
-                                  double min,
-                                  double max) {
-    DType data = in_data[i];
-    int target = -1;
-    if (data >= min && data <= max) {
-      target = (data - min) * bin_cnt / (max - min);
-      target = mshadow_op::minimum::Map(bin_cnt - 1, target);
-      target -= (data < bin_bounds[target]) ? 1 : 0;
-      target += ((data >= bin_bounds[target + 1]) && (target != bin_cnt - 1)) ? 1 : 0;
-    }
-    bin_indices[i] = target;
-  }
-
-  template <typename DType>
-  MSHADOW_XINLINE static void Map(index_t i,
-                                  const DType* in_data,
-                                  int* bin_indices,
-                                  const DType* bin_bounds,
-                                  int num_bins) {
-    DType data = in_data[i];
-    int target = -1;
-    if (data >= bin_bounds[0] && data <= bin_bounds[num_bins]) {
-      target = 0;
-      while ((data - bin_bounds[target]) >= 0) {
-        target += 1;
-      }
-      target = mshadow_op::minimum::Map(target - 1, num_bins - 1);
-    }
-    bin_indices[i] = target;
+/*! \brief Bin of data among bin_cnt uniform bins over [min, max], -1 when out of range */
+template <typename DType>
+inline index_t UniformBinIndex(const DType data,
+                               const DType* bin_bounds,
+                               const int bin_cnt,
+                               const double min,
+                               const double max) {
+  int target = -1;
+  if (data >= min && data <= max) {
+    target = (data - min) * bin_cnt / (max - min);
+    target = std::min(bin_cnt - 1, target);
+    target -= (data < bin_bounds[target]) ? 1 : 0;
+    target += ((data >= bin_bounds[target + 1]) && (target != bin_cnt - 1)) ? 1 : 0;
   }
-};
+  return target;
+}
 
-template <typename CType>
-void ComputeHistogram(const int* bin_indices, CType* out_data, size_t input_size) {
-  for (size_t i = 0; i < input_size; ++i) {
-    int target = bin_indices[i];
-    if (target >= 0) {
-      out_data[target] += 1;
-    }
-  }
+/*! \brief Bin of data among the sorted bin_bounds, -1 when out of range */
+template <typename DType>
+inline index_t BoundedBinIndex(const DType data, const DType* bin_bounds, const int num_bins) {
+  if (!(data >= bin_bounds[0] && data <= bin_bounds[num_bins]))
+    return -1;
+  const index_t target = std::upper_bound(bin_bounds, bin_bounds + num_bins + 1, data) - bin_bounds;
+  return std::min<index_t>(target - 1, num_bins - 1);
 }
 
 template <>
@@ -84,23 +62,21 @@ void HistogramForwardImpl<cpu>(const OpContext& ctx,
   using namespace mshadow;
   using namespace mxnet_op;
   mshadow::Stream<cpu>* s = ctx.get_stream<cpu>();
-  Tensor<cpu, 1, int> bin_indices =
-      ctx.requested[0].get_space_typed<cpu, 1, int>(Shape1(in_data.Size()), s);
-  const int bin_cnt = out_data.Size();
+  const int bin_cnt       = out_data.Size();
 
   MSHADOW_TYPE_SWITCH(in_data.type_flag_, DType, {
-    Kernel<ComputeBinKernel, cpu>::Launch(s,
-                                          in_data.Size(),
-                                          in_data.dptr<DType>(),
-                                          bin_indices.dptr_,
-                                          bin_bounds.dptr<DType>(),
-                                          bin_cnt);
+    const DType* data   = in_data.dptr<DType>();
+    const DType* bounds = bin_bounds.dptr<DType>();
     Kernel<op_with_req<mshadow_op::identity, kWriteTo>, cpu>::Launch(
-        s, bin_bounds.Size(), out_bins.dptr<DType>(), bin_bounds.dptr<DType>());
-  });
-  MSHADOW_TYPE_SWITCH(out_data.type_flag_, CType, {
-    Kernel<set_zero, cpu>::Launch(s, bin_cnt, out_data.dptr<CType>());
-    ComputeHistogram(bin_indices.dptr_, out_data.dptr<CType>(), in_data.Size());
+        s, bin_bounds.Size(), out_bins.dptr<DType>(), bounds);
+    MSHADOW_TYPE_SWITCH(out_data.type_flag_, CType, {
+      BinCountCPU(
+          in_data.Size(),
+          bin_cnt,
+          [&](index_t i) { return BoundedBinIndex(data[i], bounds, bin_cnt); },
+          [](index_t i) { return CType(1); },
+          out_data.dptr<CType>());
+    });
   });
 }
 
@@ -115,24 +91,20 @@ void HistogramForwardImpl<cpu>(const OpContext& ctx,
   using namespace mshadow;
   using namespace mxnet_op;
   mshadow::Stream<cpu>* s = ctx.get_stream<cpu>();
-  Tensor<cpu, 1, int> bin_indices =
-      ctx.requested[0].get_space_typed<cpu, 1, int>(Shape1(in_data.Size()), s);
 
   MSHADOW_TYPE_SWITCH(in_data.type_flag_, DType, {
+    const DType* data   = in_data.dptr<DType>();
+    const DType* bounds = out_bins.dptr<DType>();
     Kernel<FillBinBoundsKernel, cpu>::Launch(
         s, bin_cnt + 1, out_bins.dptr<DType>(), bin_cnt, min, max);
-    Kernel<ComputeBinKernel, cpu>::Launch(s,
-                                          in_data.Size(),
-                                          in_data.dptr<DType>(),
-                                          out_bins.dptr<DType>(),
-                                          bin_indices.dptr_,
-                                          bin_cnt,
-                                          min,
-                                          max);
-  });
-  MSHADOW_TYPE_SWITCH(out_data.type_flag_, CType, {
-    Kernel<set_zero, cpu>::Launch(s, bin_cnt, out_data.dptr<CType>());
-    ComputeHistogram(bin_indices.dptr_, out_data.dptr<CType>(), in_data.Size());
+    MSHADOW_TYPE_SWITCH(out_data.type_flag_, CType, {
+      BinCountCPU(
+          in_data.Size(),
+          bin_cnt,
+          [&](index_t i) { return UniformBinIndex(data[i], bounds, bin_cnt, min, max); },
+          [](index_t i) { return CType(1); },
+          out_data.dptr<CType>());
+    });
   });
 }
 
@@ -165,10 +137,6 @@ Example::
                                                   std::vector<std::string>{"data"} :
                                                   std::vector<std::string>{"data", "bins"};
                                      })
-    .set_attr<FResourceRequest>("FResourceRequest",
-                                [](const NodeAttrs& attrs) {
-                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
-                                })
     .set_attr<THasDeterministicOutput>("THasDeterministicOutput", true)
     .set_attr<mxnet::FInferShape>("FInferShape", HistogramOpShape)
     .set_attr<nnvm::FInferType>("FInferType", HistogramOpType)
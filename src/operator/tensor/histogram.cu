@@ -23,19 +23,20 @@
  */
 #include "./histogram-inl.h"
 #include "./util/tensor_util-inl.cuh"
+#include "./bin_count-inl.cuh"
 
 namespace mxnet {
 namespace op {
 
-struct HistogramFusedKernel {
-  template <typename DType, typename CType>
-  static MSHADOW_XINLINE void Map(int i,
-                                  const DType* in_data,
-                                  const DType* bin_bounds,
-                                  CType* bins,
-                                  const int bin_cnt,
-                                  const double min,
-                                  const double max) {
+/*! \brief Bin of in_data[i] among bin_cnt uniform bins over [min, max] */
+template <typename DType>
+struct UniformBinIndex {
+  const DType* in_data;
+  const DType* bin_bounds;
+  int bin_cnt;
+  double min, max;
+
+  __device__ index_t operator()(const index_t i) const {
     DType data = in_data[i];
     int target = -1;
     if (data >= min && data <= max) {
@@ -44,29 +45,32 @@ struct HistogramFusedKernel {
       target -= (data < bin_bounds[target]) ? 1 : 0;
       target += ((data >= bin_bounds[target + 1]) && (target != bin_cnt - 1)) ? 1 : 0;
     }
-    if (target >= 0) {
-      atomicAdd(&bins[target], CType(1));
-    }
+    return target;
   }
+};
 
-  template <typename DType, typename CType>
-  static MSHADOW_XINLINE void Map(int i,
-                                  const DType* in_data,
-                                  const DType* bin_bounds,
-                                  CType* bins,
-                                  const int bin_cnt) {
+/*! \brief Bin of in_data[i] among the sorted bin_bounds, found by binary search */
+template <typename DType>
+struct BoundedBinIndex {
+  const DType* in_data;
+  const DType* bin_bounds;
+  int bin_cnt;
+
+  __device__ index_t operator()(const index_t i) const {
     DType data = in_data[i];
-    int target = -1;
-    if (data >= bin_bounds[0] && data <= bin_bounds[bin_cnt]) {
-      target = 0;
-      while (data >= bin_bounds[target]) {
-        target += 1;
+    if (!(data >= bin_bounds[0] && data <= bin_bounds[bin_cnt]))
+      return -1;
+    // first bound greater than data
+    int lo = 0, hi = bin_cnt + 1;
+    while (lo < hi) {
+      const int mid = (lo + hi) / 2;
+      if (data < bin_bounds[mid]) {
+        hi = mid;
+      } else {
+        lo = mid + 1;
       }
-      target = min(target - 1, bin_cnt - 1);
-    }
-    if (target >= 0) {
-      atomicAdd(&bins[target], CType(1));
     }
+    return min(lo - 1, bin_cnt - 1);
   }
 };
 
@@ -82,13 +86,9 @@ void HistogramForwardImpl<gpu>(const OpContext& ctx,
   MSHADOW_TYPE_SWITCH(in_data.type_flag_, DType, {
     MSHADOW_IDX_TYPE_SWITCH(out_data.type_flag_, CType, {
       int bin_cnt = out_bins.Size() - 1;
-      Kernel<set_zero, gpu>::Launch(s, bin_cnt, out_data.dptr<CType>());
-      Kernel<HistogramFusedKernel, gpu>::Launch(s,
-                                                in_data.Size(),
-                                                in_data.dptr<DType>(),
-                                                bin_bounds.dptr<DType>(),
-                                                out_data.dptr<CType>(),
-                                                bin_cnt);
+      BoundedBinIndex<DType> bin{in_data.dptr<DType>(), bin_bounds.dptr<DType>(), bin_cnt};
+      BinCountGPU(
+          s, ctx.run_ctx.ctx.dev_id, in_data.Size(), bin_cnt, bin, out_data.dptr<CType>());
       Kernel<op_with_req<mshadow_op::identity, kWriteTo>, gpu>::Launch(
           s, bin_bounds.Size(), out_bins.dptr<DType>(), bin_bounds.dptr<DType>());
     });
@@ -108,17 +108,12 @@ void HistogramForwardImpl<gpu>(const OpContext& ctx,
   mshadow::Stream<gpu>* s = ctx.get_stream<gpu>();
   MSHADOW_TYPE_SWITCH(in_data.type_flag_, DType, {
     MSHADOW_IDX_TYPE_SWITCH(out_data.type_flag_, CType, {
-      Kernel<set_zero, gpu>::Launch(s, bin_cnt, out_data.dptr<CType>());
       Kernel<FillBinBoundsKernel, gpu>::Launch(
           s, bin_cnt + 1, out_bins.dptr<DType>(), bin_cnt, min, max);
-      Kernel<HistogramFusedKernel, gpu>::Launch(s,
-                                                in_data.Size(),
-                                                in_data.dptr<DType>(),
-                                                out_bins.dptr<DType>(),
-                                                out_data.dptr<CType>(),
-                                                bin_cnt,
-                                                min,
-                                                max);
+      UniformBinIndex<DType> bin{
+          in_data.dptr<DType>(), out_bins.dptr<DType>(), bin_cnt, min, max};
+      BinCountGPU(
+          s, ctx.run_ctx.ctx.dev_id, in_data.Size(), bin_cnt, bin, out_data.dptr<CType>());
     });
   });
 }
@@ -23,6 +23,8 @@
  * \author Siyi Li, Chi Zhang
  */
 
+#include <numeric>
+#include <unordered_map>
 #include "./indexing_op.h"
 namespace mxnet {
 namespace op {
@@ -453,16 +455,23 @@ void TakeOpForward<cpu>(const nnvm::NodeAttrs& attrs,
   });
 }
 
+/*!
+ * \brief Row sparse gradient of Embedding on CPU. The indices are not sorted and no buffer of
+ *        the vocabulary size is used: each thread owns the rows r with r % num_parts == part.
+ *        The data positions are first bucketed by owner, keeping their order. Each owner then
+ *        gives a slot to its distinct rows with a hash map and sums their output gradients in
+ *        the order of the data, so the result is the same for any number of threads.
+ */
 template <>
 inline void SparseEmbeddingOpBackwardRspImpl<cpu>(const bool deterministic,
                                                   const OpContext& ctx,
                                                   const TBlob& ograd,
                                                   const TBlob& data,
                                                   const OpReqType req,
-                                                  const NDArray& output) {
+                                                  const NDArray& output,
+                                                  const size_t workspace_offset) {
   using namespace mshadow;
   using namespace mxnet_op;
-  using namespace mshadow::expr;
   using namespace rowsparse;
   using nnvm::dim_t;
   if (req == kNullOp)
@@ -470,70 +479,128 @@ inline void SparseEmbeddingOpBackwardRspImpl<cpu>(const bool deterministic,
   CHECK_EQ(req, kWriteTo) << "SparseEmbedding layer doesn't support "
                           << "weight gradient calculation with req != write";
 
-  // Request temporary storage for marking non-zero rows and prefix sum
-  Stream<cpu>* s        = ctx.get_stream<cpu>();
-  dim_t num_rows        = output.shape()[0];
-  dim_t row_length      = output.shape()[1];
-  size_t workspace_size = num_rows * sizeof(dim_t);
-  Tensor<cpu, 1, char> workspace =
-      ctx.requested[embedding::kTempSpace].get_space_typed<cpu, 1, char>(Shape1(workspace_size), s);
-  dim_t* row_flg = reinterpret_cast<dim_t*>(workspace.dptr_);
-  // prefix sum array re-uses the row_flg array temp space
-  dim_t* prefix_sum = row_flg;
-  dim_t data_size   = static_cast<dim_t>(data.shape_.Size());
+  Stream<cpu>* s         = ctx.get_stream<cpu>();
+  const dim_t row_length = output.shape()[1];
+  const dim_t data_size  = static_cast<dim_t>(data.shape_.Size());
+  const int omp_threads  = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  // below a few rows per thread the bucketing costs more than it saves
+  const int num_parts =
+      static_cast<int>(std::max<dim_t>(1, std::min<dim_t>(omp_threads, data_size / 64)));
 
   MSHADOW_TYPE_SWITCH(data.type_flag_, IType, {
     MSHADOW_SGL_DBL_TYPE_SWITCH(ograd.type_flag_, DType, {
       MSHADOW_IDX_TYPE_SWITCH(output.aux_type(kIdx), RType, {
+        const IType* data_ptr = data.dptr<IType>();
         // check out of bound indices
         {
           IType min = 0;
           IType max = static_cast<IType>(output.shape()[0] - 1);
           // check with single thread is faster since data is small
-          IType* data_ptr = data.dptr<IType>();
-          bool is_valid   = CheckIndexOutOfBound(data_ptr, data.shape_.Size(), min, max);
+          bool is_valid = CheckIndexOutOfBound(data_ptr, data_size, min, max);
           CHECK(is_valid) << "Embedding input contains data out of bound";
         }
-        // mark row flags
-        Fill<false>(s, TBlob(row_flg, Shape1(num_rows), cpu::kDevMask), kWriteTo, 0);
-        Kernel<MarkRowFlgKernel, cpu>::Launch(s, data_size, row_flg, data.dptr<IType>());
-        // calculate inclusive prefix sum
-        // TODO(haibin) ideally this is should be done in parallel
-        prefix_sum[0] = row_flg[0];
-        for (dim_t i = 1; i < num_rows; i++) {
-          prefix_sum[i] = prefix_sum[i - 1] + row_flg[i];
+        // bucket the data positions by owner: chunk c of the data counts its positions of
+        // each owner, the buckets are laid out owner by owner and chunk by chunk
+        const dim_t chunk = (data_size + num_parts - 1) / num_parts;
+        std::vector<dim_t> offsets(num_parts * num_parts + 1, 0);
+#pragma omp parallel for num_threads(num_parts)
+        for (int c = 0; c < num_parts; ++c) {
+          const dim_t end = std::min(data_size, (c + 1) * chunk);
+          for (dim_t i = c * chunk; i < end; ++i) {
+            ++offsets[1 + static_cast<dim_t>(data_ptr[i]) % num_parts * num_parts + c];
+          }
         }
-        // total number of non-zero rows
-        dim_t nnr = prefix_sum[num_rows - 1];
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        std::vector<dim_t> positions(data_size);
+#pragma omp parallel for num_threads(num_parts)
+        for (int c = 0; c < num_parts; ++c) {
+          std::vector<dim_t> next(num_parts);
+          for (int p = 0; p < num_parts; ++p)
+            next[p] = offsets[p * num_parts + c];
+          const dim_t end = std::min(data_size, (c + 1) * chunk);
+          for (dim_t i = c * chunk; i < end; ++i) {
+            positions[next[static_cast<dim_t>(data_ptr[i]) % num_parts]++] = i;
+          }
+        }
+        // distinct rows of each owner, sorted, and the slot of each row in that list
+        std::vector<std::vector<dim_t>> rows(num_parts);
+        std::vector<std::unordered_map<dim_t, dim_t>> slots(num_parts);
+#pragma omp parallel for num_threads(num_parts)
+        for (int p = 0; p < num_parts; ++p) {
+          const dim_t begin = offsets[p * num_parts];
+          const dim_t end   = offsets[(p + 1) * num_parts];
+          slots[p].reserve(end - begin);
+          for (dim_t k = begin; k < end; ++k) {
+            const dim_t row = static_cast<dim_t>(data_ptr[positions[k]]);
+            if (slots[p].emplace(row, 0).second)
+              rows[p].push_back(row);
+          }
+          std::sort(rows[p].begin(), rows[p].end());
+          for (size_t j = 0; j < rows[p].size(); ++j)
+            slots[p][rows[p][j]] = j;
+        }
+        dim_t nnr = 0;
+        for (int p = 0; p < num_parts; ++p)
+          nnr += rows[p].size();
         if (nnr == 0) {
           FillZerosRspImpl(s, output);
           return;
         }
         output.CheckAndAlloc({Shape1(nnr)});
-        RType* grad_row_idx = output.aux_data(kIdx).dptr<RType>();
-        // fill row_idx array of output matrix, using the row_flg values
-        Kernel<FillRspRowIdxKernel, cpu>::Launch(s, num_rows, grad_row_idx, prefix_sum, num_rows);
-        // prefill with zeros
-        DType* grad_data = output.data().dptr<DType>();
-        Fill<false>(s, TBlob(grad_data, Shape1(nnr * row_length), cpu::kDevMask), kWriteTo, 0);
-        // add the final gradients
-        const int num_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
-        dim_t segment_len     = (nnr + num_threads - 1) / num_threads;
-        Kernel<AddTakeGradRspKernel, cpu>::Launch(s,
-                                                  num_threads,
-                                                  grad_data,
-                                                  prefix_sum,
-                                                  ograd.dptr<DType>(),
-                                                  row_length,
-                                                  data.dptr<IType>(),
-                                                  data_size,
-                                                  segment_len,
-                                                  num_rows);
+        RType* grad_row_idx    = output.aux_data(kIdx).dptr<RType>();
+        DType* grad_data       = output.data().dptr<DType>();
+        const DType* ograd_ptr = ograd.dptr<DType>();
+        // merge the sorted rows of all owners into the row indices of the gradient: each owner
+        // ranks its rows among the rows of the others by walking their lists alongside its own,
+        // which takes O(nnr) per owner instead of O(nnr * num_parts) for a serial merge
+        std::vector<std::vector<dim_t>> out_rows(num_parts);
+#pragma omp parallel for num_threads(num_parts)
+        for (int p = 0; p < num_parts; ++p) {
+          std::vector<size_t> heads(num_parts, 0);
+          out_rows[p].resize(rows[p].size());
+          for (size_t j = 0; j < rows[p].size(); ++j) {
+            const dim_t row = rows[p][j];
+            dim_t k         = j;
+            for (int q = 0; q < num_parts; ++q) {
+              if (q == p)
+                continue;
+              while (heads[q] < rows[q].size() && rows[q][heads[q]] < row)
+                ++heads[q];
+              k += heads[q];
+            }
+            grad_row_idx[k] = static_cast<RType>(row);
+            out_rows[p][j]  = k;
+          }
+        }
+        // each owner sums the output gradients of its rows in the order of the data
+#pragma omp parallel for num_threads(num_parts)
+        for (int p = 0; p < num_parts; ++p) {
+          for (const dim_t k : out_rows[p])
+            std::fill(grad_data + k * row_length, grad_data + (k + 1) * row_length, DType(0));
+          const dim_t end = offsets[(p + 1) * num_parts];
+          for (dim_t k = offsets[p * num_parts]; k < end; ++k) {
+            const dim_t i   = positions[k];
+            const dim_t row = out_rows[p][slots[p][static_cast<dim_t>(data_ptr[i])]];
+            DType* dst       = grad_data + row * row_length;
+            const DType* src = ograd_ptr + i * row_length;
+            for (dim_t j = 0; j < row_length; ++j)
+              dst[j] += src[j];
+          }
+        }
       });
     });
   });
 }
 
+template <>
+size_t SparseEmbeddingOpBackwardRspWorkspaceSize<cpu>(const bool deterministic,
+                                                      const OpContext& ctx,
+                                                      const index_t data_size,
+                                                      const index_t num_rows) {
+  // the buckets and the hash maps live on the heap
+  return 0;
+}
+
 /*
  * \brief check if any of the indices is out of bound
  * \param s the stream
@@ -652,6 +719,7 @@ GatherNDBackwardImpl(index_t N,
 }
 
 DMLC_REGISTER_PARAMETER(EmbeddingParam);
+DMLC_REGISTER_PARAMETER(HashedEmbeddingParam);
 DMLC_REGISTER_PARAMETER(TakeParam);
 DMLC_REGISTER_PARAMETER(OneHotParam);
 DMLC_REGISTER_PARAMETER(ScatterNDParam);
@@ -744,11 +812,74 @@ NNVM_REGISTER_OP(_backward_Embedding)
                                 [](const NodeAttrs& attrs) {
                                   return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
                                 })
-    .set_attr<FInferStorageType>("FInferStorageType", EmbeddingOpBackwardStorageType)
+    .set_attr<FInferStorageType>("FInferStorageType",
+                                 EmbeddingOpBackwardStorageType<EmbeddingParam>)
     .set_attr<nnvm::TIsBackward>("TIsBackward", true)
     .set_attr<FCompute>("FCompute<cpu>", EmbeddingOpBackward<cpu>)
     .set_attr<FComputeEx>("FComputeEx<cpu>", EmbeddingOpBackwardEx<cpu>);
 
+NNVM_REGISTER_OP(_contrib_HashedEmbedding)
+    .describe(R"code(Maps raw integer ids of an unbounded id space to embeddings, by hashing them
+to the rows of a weight of input_dim rows.
+
+Each id is hashed by num_hashes hash functions, and its embedding is the sum of the rows it is
+hashed to. The hashing is done in the same pass as the gathering of the rows, so that the ids do
+not need to be hashed beforehand. With several hash functions, two ids only share their embedding
+when all their hashes collide.
+
+For an input array of shape (d1, ..., dK), the shape of an output array is
+(d1, ..., dK, output_dim). The ids may be any integers, negative ones included.
+
+Examples::
+
+  x = [[12345678901, 7],
+       [-3, 12345678901]]
+
+  // the rows of each id are the same in both places
+  HashedEmbedding(x, weight, input_dim=1000, output_dim=16, num_hashes=2).shape = (2, 2, 16)
+
+.. Note::
+
+    If "sparse_grad" is set to True, the gradient w.r.t weights is "row_sparse", with the rows
+    the ids are hashed to, as for Embedding. It can be used with the sparse optimizers and
+    pushed to and pulled from a KVStore by row ids.
+
+)code" ADD_FILELINE)
+    .set_num_inputs(2)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<HashedEmbeddingParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"data", "weight"};
+                                     })
+    .set_attr<mxnet::FInferShape>("FInferShape", EmbeddingOpShape<HashedEmbeddingParam>)
+    .set_attr<nnvm::FInferType>("FInferType", EmbeddingOpType<HashedEmbeddingParam>)
+    .set_attr<THasDeterministicOutput>("THasDeterministicOutput", true)
+    .set_attr<FCompute>("FCompute<cpu>", HashedEmbeddingOpForward<cpu>)
+    .set_attr<nnvm::FGradient>(
+        "FGradient",
+        [](const nnvm::ObjectPtr& n, const std::vector<nnvm::NodeEntry>& ograds) {
+          return MakeNonlossGradNode(
+              "_backward_contrib_HashedEmbedding", n, ograds, {n->inputs[0]}, n->attrs.dict);
+        })
+    .add_argument("data", "NDArray-or-Symbol", "The ids to embed.")
+    .add_argument("weight", "NDArray-or-Symbol", "The embedding weight matrix.")
+    .add_arguments(HashedEmbeddingParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_contrib_HashedEmbedding)
+    .set_num_inputs(2)
+    .set_num_outputs(2)
+    .set_attr_parser(ParamParser<HashedEmbeddingParam>)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FInferStorageType>("FInferStorageType",
+                                 EmbeddingOpBackwardStorageType<HashedEmbeddingParam>)
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<FCompute>("FCompute<cpu>", HashedEmbeddingOpBackward<cpu>)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", HashedEmbeddingOpBackwardEx<cpu>);
+
 NNVM_REGISTER_OP(take)
     .add_alias("_npi_take")
     .describe(R"code(Takes elements from an input array along the given axis.
@@ -145,6 +145,33 @@ struct TakeZeroAxisGPU {
   }
 };
 
+/*!
+ * \brief Launch TakeZeroAxisGPU over num_rows rows of M values. The rows are copied in the
+ *        widest load type which divides both the row size and the addresses.
+ */
+template <bool clip, typename DType, typename IType>
+void TakeRowsGPU(mshadow::Stream<gpu>* s,
+                 DType* out,
+                 const DType* in,
+                 const IType* idx,
+                 const index_t num_rows,
+                 const index_t M,
+                 const index_t K) {
+  using namespace mxnet_op;
+  const size_t bytes =
+      M * sizeof(DType) | reinterpret_cast<uintptr_t>(out) | reinterpret_cast<uintptr_t>(in);
+  MXNET_LOAD_TYPE_SWITCH(common::cuda::get_load_type(bytes), LType, {
+    const index_t m = M * sizeof(DType) / sizeof(LType);
+    Kernel<TakeZeroAxisGPU<clip>, gpu>::Launch(s,
+                                               num_rows * m,
+                                               reinterpret_cast<LType*>(out),
+                                               reinterpret_cast<const LType*>(in),
+                                               idx,
+                                               m,
+                                               K);
+  });
+}
+
 /*
  * \brief returns true if all indices are between [min, max]
  * \param s the stream
@@ -192,8 +219,8 @@ void EmbeddingOpForwardDnsImpl<gpu>(mshadow::Stream<gpu>* s,
       Tensor<gpu, 2, DType> wmat = weight.get<gpu, 2, DType>(s);
       Tensor<gpu, 2, DType> out  = output.get_with_shape<gpu, 2, DType>(
           Shape2(oshape.ProdShape(0, oshape.ndim() - 1), oshape[oshape.ndim() - 1]), s);
-      Kernel<TakeZeroAxisGPU<true>, gpu>::Launch(
-          s, oshape.Size(), out.dptr_, wmat.dptr_, idx.dptr_, wmat.shape_[1], wmat.shape_[0]);
+      TakeRowsGPU<true>(
+          s, out.dptr_, wmat.dptr_, idx.dptr_, out.shape_[0], wmat.shape_[1], wmat.shape_[0]);
     });
   });
 }
@@ -237,12 +264,40 @@ void SparseEmbeddingOpForwardRspImpl<gpu>(const OpContext& ctx,
   }
 }
 
+/*!
+ * \brief Bytes of the temporary space of SparseEmbeddingDeterministicKernelLaunch. The unique
+ *        and sort workspace sizes are returned as well.
+ */
+inline size_t SparseEmbeddingDeterministicWorkspaceSize(mshadow::Stream<gpu>* s,
+                                                        const nnvm::dim_t num_rows,
+                                                        const nnvm::dim_t data_size,
+                                                        size_t* unique_workspace_bytes,
+                                                        size_t* sort_workspace_size) {
+  using nnvm::dim_t;
+  dim_t* sorted_data      = nullptr;
+  size_t* null_ptr        = nullptr;
+  *sort_workspace_size    = SortByKeyWorkspaceSize<dim_t, dim_t, gpu>(data_size);
+  *unique_workspace_bytes = 0;
+  // unique operations will be applied on sorted data
+  cub::DeviceSelect::Unique(nullptr,
+                            *unique_workspace_bytes,
+                            sorted_data,
+                            sorted_data,
+                            null_ptr,
+                            data_size,
+                            mshadow::Stream<gpu>::GetStream(s));
+  // lookup_table, sorted_data, original_idx, temp_storage
+  return num_rows * sizeof(dim_t) + 2 * data_size * sizeof(dim_t) +
+         std::max(*unique_workspace_bytes, *sort_workspace_size);
+}
+
 template <typename IType, typename DType, typename RType>
 void SparseEmbeddingDeterministicKernelLaunch(const OpContext& ctx,
                                               const TBlob& ograd,
                                               const TBlob& data,
                                               const OpReqType req,
-                                              const NDArray& output) {
+                                              const NDArray& output,
+                                              const size_t workspace_offset) {
   using namespace mshadow;
   using namespace mxnet_op;
   using namespace expr;
@@ -261,33 +316,22 @@ void SparseEmbeddingDeterministicKernelLaunch(const OpContext& ctx,
   size_t lookup_table_bytes         = num_rows * sizeof(dim_t);
   size_t sorted_data_storage_bytes  = data_size * sizeof(dim_t);
   size_t original_idx_storage_bytes = data_size * sizeof(dim_t);
-  size_t sort_workspace_size        = SortByKeyWorkspaceSize<dim_t, dim_t, gpu>(data_size);
+  size_t sort_workspace_size        = 0;
   size_t unique_workspace_bytes     = 0;
-  // estimate unique temp space
-  IType* data_ptr  = data.dptr<IType>();
-  size_t* null_ptr = nullptr;
-  // unique operations will be applied on sorted data
-  cub::DeviceSelect::Unique(nullptr,
-                            unique_workspace_bytes,
-                            sorted_data,
-                            sorted_data,
-                            null_ptr,
-                            data_size,
-                            Stream<gpu>::GetStream(s));
-  // One more space reserved for unique count
+  size_t total_storage_bytes        = SparseEmbeddingDeterministicWorkspaceSize(
+      s, num_rows, data_size, &unique_workspace_bytes, &sort_workspace_size);
   size_t temp_workspace_bytes = std::max(unique_workspace_bytes, sort_workspace_size);
-  size_t total_storage_bytes  = lookup_table_bytes + sorted_data_storage_bytes +
-                               original_idx_storage_bytes + temp_workspace_bytes;
 
-  // request resource and split it. layout is:
+  // request resource and split it, after the first workspace_offset bytes. layout is:
   // lookup_table, sorted_data, original_idx, temp_storage
-  Tensor<gpu, 1, char> workspace =
-      ctx.requested[0].get_space_typed<gpu, 1, char>(Shape1(total_storage_bytes), s);
-  lookup_table = reinterpret_cast<dim_t*>(workspace.dptr_);
-  sorted_data  = reinterpret_cast<dim_t*>(workspace.dptr_ + lookup_table_bytes);
+  Tensor<gpu, 1, char> workspace = ctx.requested[0].get_space_typed<gpu, 1, char>(
+      Shape1(workspace_offset + total_storage_bytes), s);
+  char* workspace_ptr = workspace.dptr_ + workspace_offset;
+  lookup_table        = reinterpret_cast<dim_t*>(workspace_ptr);
+  sorted_data         = reinterpret_cast<dim_t*>(workspace_ptr + lookup_table_bytes);
   original_idx =
-      reinterpret_cast<dim_t*>(workspace.dptr_ + lookup_table_bytes + sorted_data_storage_bytes);
-  temp_storage = workspace.dptr_ + total_storage_bytes - temp_workspace_bytes;
+      reinterpret_cast<dim_t*>(workspace_ptr + lookup_table_bytes + sorted_data_storage_bytes);
+  temp_storage = workspace_ptr + total_storage_bytes - temp_workspace_bytes;
 
   // check out-of-bound indices
   {
@@ -363,7 +407,8 @@ inline void SparseEmbeddingOpBackwardDeterministicRspImpl(const OpContext& ctx,
                                                           const TBlob& ograd,
                                                           const TBlob& data,
                                                           const OpReqType req,
-                                                          const NDArray& output) {
+                                                          const NDArray& output,
+                                                          const size_t workspace_offset) {
   using nnvm::dim_t;
   if (req == kNullOp)
     return;
@@ -381,7 +426,7 @@ inline void SparseEmbeddingOpBackwardDeterministicRspImpl(const OpContext& ctx,
     MSHADOW_TYPE_SWITCH(ograd.type_flag_, DType, {
       MSHADOW_IDX_TYPE_SWITCH(output.aux_type(rowsparse::kIdx), RType, {
         SparseEmbeddingDeterministicKernelLaunch<IType, DType, RType>(
-            ctx, ograd, data, req, output);
+            ctx, ograd, data, req, output, workspace_offset);
       });
     });
   });
@@ -393,9 +438,11 @@ inline void SparseEmbeddingOpBackwardRspImpl<gpu>(const bool deterministic,
                                                   const TBlob& ograd,
                                                   const TBlob& data,
                                                   const OpReqType req,
-                                                  const NDArray& output) {
+                                                  const NDArray& output,
+                                                  const size_t workspace_offset) {
   if (deterministic) {
-    SparseEmbeddingOpBackwardDeterministicRspImpl(ctx, ograd, data, req, output);
+    SparseEmbeddingOpBackwardDeterministicRspImpl(
+        ctx, ograd, data, req, output, workspace_offset);
     return;
   }
   using namespace mshadow;
@@ -428,9 +475,9 @@ inline void SparseEmbeddingOpBackwardRspImpl<gpu>(const bool deterministic,
                                       num_rows,
                                       Stream<gpu>::GetStream(s));
         Tensor<gpu, 1, char> workspace = ctx.requested[0].get_space_typed<gpu, 1, char>(
-            Shape1(num_rows * sizeof(dim_t) + temp_storage_bytes), s);
-        prefix_sum     = reinterpret_cast<dim_t*>(workspace.dptr_);
-        d_temp_storage = workspace.dptr_ + num_rows * sizeof(dim_t);
+            Shape1(workspace_offset + num_rows * sizeof(dim_t) + temp_storage_bytes), s);
+        prefix_sum     = reinterpret_cast<dim_t*>(workspace.dptr_ + workspace_offset);
+        d_temp_storage = workspace.dptr_ + workspace_offset + num_rows * sizeof(dim_t);
         num_threads    = num_rows;
         Fill<false>(s, TBlob(prefix_sum, Shape1(num_threads), gpu::kDevMask), kWriteTo, 0);
         Kernel<MarkRowFlgKernel, gpu>::Launch(s, data_size, prefix_sum, data.dptr<IType>());
@@ -473,6 +520,29 @@ inline void SparseEmbeddingOpBackwardRspImpl<gpu>(const bool deterministic,
   });
 }
 
+template <>
+size_t SparseEmbeddingOpBackwardRspWorkspaceSize<gpu>(const bool deterministic,
+                                                      const OpContext& ctx,
+                                                      const index_t data_size,
+                                                      const index_t num_rows) {
+  using nnvm::dim_t;
+  mshadow::Stream<gpu>* s = ctx.get_stream<gpu>();
+  if (deterministic) {
+    size_t unique_workspace_bytes, sort_workspace_size;
+    return SparseEmbeddingDeterministicWorkspaceSize(
+        s, num_rows, data_size, &unique_workspace_bytes, &sort_workspace_size);
+  }
+  dim_t* prefix_sum         = nullptr;
+  size_t temp_storage_bytes = 0;
+  cub::DeviceScan::InclusiveSum(nullptr,
+                                temp_storage_bytes,
+                                prefix_sum,
+                                prefix_sum,
+                                num_rows,
+                                mshadow::Stream<gpu>::GetStream(s));
+  return num_rows * sizeof(dim_t) + temp_storage_bytes;
+}
+
 /*
  * \brief check if any of the indices is out of bound
  * \param s the stream
@@ -539,17 +609,16 @@ void GatherNDForwardGPU(const nnvm::NodeAttrs& attrs,
           ctx.requested[0].get_space_typed<gpu, 1, IType>(Shape1(M), s);
       IType* is_valid_dim_ptr = reinterpret_cast<IType*>(workspace.dptr_);
       GatherNDCheckBoundGPU(s, idx_ptr, N, M, mshape, is_valid_dim_ptr);
-      Kernel<gather_nd, gpu>::Launch(s,
-                                     N,
-                                     req[0],
-                                     N,
-                                     M,
-                                     K,
-                                     strides,
-                                     mshape,
-                                     outputs[0].dptr<DType>(),
-                                     inputs[0].dptr<DType>(),
-                                     inputs[1].dptr<IType>());
+      LaunchIndexNDRowsGPU<gather_nd_elem>(s,
+                                           req[0],
+                                           N,
+                                           M,
+                                           K,
+                                           strides,
+                                           mshape,
+                                           outputs[0].dptr<DType>(),
+                                           inputs[0].dptr<DType>(),
+                                           inputs[1].dptr<IType>());
     });
   });
 }
@@ -626,21 +695,21 @@ void TakeOpForward<gpu>(const nnvm::NodeAttrs& attrs,
       }
       if (actual_axis == 0) {
         if (param.mode == take_::kClip) {
-          Kernel<TakeZeroAxisGPU<true>, gpu>::Launch(s,
-                                                     oshape.Size(),
-                                                     outputs[take_::kOut].dptr<DType>(),
-                                                     inputs[take_::kArr].dptr<DType>(),
-                                                     inputs[take_::kIdx].dptr<IType>(),
-                                                     oshape.Size() / idxshape.Size(),
-                                                     arrshape[0]);
+          TakeRowsGPU<true>(s,
+                            outputs[take_::kOut].dptr<DType>(),
+                            inputs[take_::kArr].dptr<DType>(),
+                            inputs[take_::kIdx].dptr<IType>(),
+                            idxshape.Size(),
+                            oshape.Size() / idxshape.Size(),
+                            arrshape[0]);
         } else {
-          Kernel<TakeZeroAxisGPU<false>, gpu>::Launch(s,
-                                                      oshape.Size(),
-                                                      outputs[take_::kOut].dptr<DType>(),
-                                                      inputs[take_::kArr].dptr<DType>(),
-                                                      inputs[take_::kIdx].dptr<IType>(),
-                                                      oshape.Size() / idxshape.Size(),
-                                                      arrshape[0]);
+          TakeRowsGPU<false>(s,
+                             outputs[take_::kOut].dptr<DType>(),
+                             inputs[take_::kArr].dptr<DType>(),
+                             inputs[take_::kIdx].dptr<IType>(),
+                             idxshape.Size(),
+                             oshape.Size() / idxshape.Size(),
+                             arrshape[0]);
         }
       } else {
         mshadow::Shape<10> in_strides;
@@ -949,6 +1018,13 @@ NNVM_REGISTER_OP(_backward_Embedding)
     .set_attr<FCompute>("FCompute<gpu>", EmbeddingOpBackward<gpu>)
     .set_attr<FComputeEx>("FComputeEx<gpu>", EmbeddingOpBackwardEx<gpu>);
 
+NNVM_REGISTER_OP(_contrib_HashedEmbedding)
+    .set_attr<FCompute>("FCompute<gpu>", HashedEmbeddingOpForward<gpu>);
+
+NNVM_REGISTER_OP(_backward_contrib_HashedEmbedding)
+    .set_attr<FCompute>("FCompute<gpu>", HashedEmbeddingOpBackward<gpu>)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", HashedEmbeddingOpBackwardEx<gpu>);
+
 NNVM_REGISTER_OP(take).set_attr<FCompute>("FCompute<gpu>", TakeOpForward<gpu>);
 
 NNVM_REGISTER_OP(_backward_take).set_attr<FCompute>("FCompute<gpu>", TakeOpBackward<gpu>);
@@ -95,6 +95,35 @@ struct EmbeddingParam : public dmlc::Parameter<EmbeddingParam> {
   }
 };
 
+struct HashedEmbeddingParam : public dmlc::Parameter<HashedEmbeddingParam> {
+  index_t input_dim;
+  index_t output_dim;
+  int num_hashes;
+  int dtype;
+  bool sparse_grad;
+  DMLC_DECLARE_PARAMETER(HashedEmbeddingParam) {
+    DMLC_DECLARE_FIELD(input_dim).set_lower_bound(1).describe(
+        "Number of rows of the weight, which the ids are hashed to.");
+    DMLC_DECLARE_FIELD(output_dim)
+        .set_lower_bound(1)
+        .describe("Dimension of the embedding vectors.");
+    DMLC_DECLARE_FIELD(num_hashes)
+        .set_default(2)
+        .set_lower_bound(1)
+        .describe(
+            "Number of hash functions. The embedding of an id is the sum of the rows it is "
+            "hashed to by each of them, so that two ids only share their embedding when all "
+            "their hashes collide.");
+    DMLC_DECLARE_FIELD(dtype).set_default(mshadow::kFloat32)
+        MXNET_ADD_ALL_TYPES.describe("Data type of weight.");
+    DMLC_DECLARE_FIELD(sparse_grad)
+        .set_default(false)
+        .describe(
+            "Compute row sparse gradient in the backward calculation. If set to True, "
+            "the grad's storage type is row_sparse.");
+  }
+};
+
 /*!
  * \brief CPU/GPU: Return the amount of temporary storage in bytes required by
                    AddTakeGradLargeBatch
@@ -183,6 +212,7 @@ inline bool EmbeddingOpType(const nnvm::NodeAttrs& attrs,
 }
 
 // storage type inference function for _backward_Embedding
+template <typename ParamType>
 inline bool EmbeddingOpBackwardStorageType(const nnvm::NodeAttrs& attrs,
                                            const int dev_mask,
                                            DispatchMode* dispatch_mode,
@@ -190,7 +220,7 @@ inline bool EmbeddingOpBackwardStorageType(const nnvm::NodeAttrs& attrs,
                                            std::vector<int>* out_attrs) {
   CHECK_EQ(in_attrs->size(), 2U);
   CHECK_EQ(out_attrs->size(), 2U);
-  const bool sparse_grad                = nnvm::get<EmbeddingParam>(attrs.parsed).sparse_grad;
+  const bool sparse_grad                = nnvm::get<ParamType>(attrs.parsed).sparse_grad;
   const NDArrayStorageType target_stype = sparse_grad ? kRowSparseStorage : kDefaultStorage;
   const auto target_mode = sparse_grad ? DispatchMode::kFComputeEx : DispatchMode::kFCompute;
 
@@ -464,56 +494,28 @@ void EmbeddingOpBackward(const nnvm::NodeAttrs& attrs,
   });
 }
 
-struct AddTakeGradRspKernel {
-  /*!
-   * \brief Each thread i is responsible for row slices in [segment_start, segment_end)
-            of the result gradient
-   * \param tid             global thread id
-   * \param grad            the gradient to calculate
-   * \param prefix_sum      the inclusive prefix sum of row ids of the gradient
-   * \param ograd           output gradient
-   * \param row_length      the length of the row slices of the gradient
-   * \param data_val        the values of input data
-   * \param data_size       number of values of input data
-   * \param segment_length  the length of row segment to process for each thread
-   * \param nnr             total number of non-zero rows of result gradient
-   */
-  template <typename DType, typename IType>
-  MSHADOW_CINLINE static void Map(int tid,
-                                  DType* grad,
-                                  const nnvm::dim_t* prefix_sum,
-                                  const DType* ograd,
-                                  const nnvm::dim_t row_length,
-                                  const IType* data_val,
-                                  const nnvm::dim_t data_size,
-                                  const nnvm::dim_t segment_length,
-                                  const nnvm::dim_t nnr) {
-    using nnvm::dim_t;
-    dim_t segment_start = tid * segment_length;
-    dim_t segment_end   = std::min(nnr, segment_start + segment_length);
-    // scan all data
-    for (dim_t data_i = 0; data_i < data_size; data_i++) {
-      dim_t data        = static_cast<dim_t>(data_val[data_i]);
-      dim_t grad_row_id = prefix_sum[data] - 1;
-      if (grad_row_id < segment_start || grad_row_id >= segment_end)
-        continue;
-      // no projection is performed
-      dim_t ograd_i = data_i * row_length;
-      dim_t grad_i  = grad_row_id * row_length;
-      for (dim_t offset = 0; offset < row_length; offset++) {
-        grad[grad_i + offset] += ograd[ograd_i + offset];
-      }
-    }
-  }
-};
-
+/*!
+ * \brief Row sparse gradient of Embedding. Its temporary space starts after the first
+ *        workspace_offset bytes of ctx.requested[0], which the caller may keep for itself.
+ */
 template <typename xpu>
 inline void SparseEmbeddingOpBackwardRspImpl(const bool deterministic,
                                              const OpContext& ctx,
                                              const TBlob& ograd,
                                              const TBlob& data,
                                              const OpReqType req,
-                                             const NDArray& output);
+                                             const NDArray& output,
+                                             const size_t workspace_offset = 0);
+
+/*!
+ * \brief Bytes of temporary space which SparseEmbeddingOpBackwardRspImpl uses after its
+ *        workspace_offset, for data_size indices into num_rows rows
+ */
+template <typename xpu>
+size_t SparseEmbeddingOpBackwardRspWorkspaceSize(const bool deterministic,
+                                                 const OpContext& ctx,
+                                                 const index_t data_size,
+                                                 const index_t num_rows);
 
 template <typename xpu>
 void EmbeddingOpBackwardEx(const nnvm::NodeAttrs& attrs,
@@ -540,6 +542,223 @@ void EmbeddingOpBackwardEx(const nnvm::NodeAttrs& attrs,
   }
 }
 
+/*!
+ * \brief Row of the weight which the hash function h maps the id to, by the splitmix64
+ *        finalizer of the id offset by a multiple of the golden ratio per hash function
+ */
+MSHADOW_XINLINE int64_t HashedEmbeddingRow(const int64_t id, const int h, const int64_t num_rows) {
+  uint64_t x = static_cast<uint64_t>(id) + static_cast<uint64_t>(h + 1) * 0x9e3779b97f4a7c15ULL;
+  x          = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x          = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return static_cast<int64_t>((x ^ (x >> 31)) % static_cast<uint64_t>(num_rows));
+}
+
+template <int req>
+struct HashedEmbeddingForwardKernel {
+  /*!
+   * \brief Hashes the id i and sums the rows of the weight it is hashed to
+   * \param i           id index
+   * \param out         output, of num_ids x row_length
+   * \param weight      weight, of num_rows x row_length
+   * \param data        ids
+   * \param row_length  number of elements per row
+   * \param num_rows    number of rows of the weight
+   * \param num_hashes  number of hash functions
+   */
+  template <typename DType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  const DType* weight,
+                                  const IType* data,
+                                  const index_t row_length,
+                                  const int64_t num_rows,
+                                  const int num_hashes) {
+    const int64_t id = static_cast<int64_t>(data[i]);
+    DType* out_row   = out + i * row_length;
+    const DType* row = weight + HashedEmbeddingRow(id, 0, num_rows) * row_length;
+    for (index_t j = 0; j < row_length; ++j) {
+      KERNEL_ASSIGN(out_row[j], req, row[j]);
+    }
+    for (int h = 1; h < num_hashes; ++h) {
+      row = weight + HashedEmbeddingRow(id, h, num_rows) * row_length;
+      for (index_t j = 0; j < row_length; ++j) {
+        out_row[j] += row[j];
+      }
+    }
+  }
+};
+
+struct HashedEmbeddingRowsKernel {
+  /*! \brief rows[h * num_ids + i] = row of data[i] for the hash function h */
+  template <typename IType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  int64_t* rows,
+                                  const IType* data,
+                                  const index_t num_ids,
+                                  const int64_t num_rows) {
+    rows[i] = HashedEmbeddingRow(
+        static_cast<int64_t>(data[i % num_ids]), static_cast<int>(i / num_ids), num_rows);
+  }
+};
+
+template <typename xpu>
+void HashedEmbeddingOpForward(const nnvm::NodeAttrs& attrs,
+                              const OpContext& ctx,
+                              const std::vector<TBlob>& inputs,
+                              const std::vector<OpReqType>& req,
+                              const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  CHECK_EQ(inputs.size(), 2U);
+  CHECK_EQ(outputs.size(), 1U);
+  if (req[embedding::kOut] == kNullOp)
+    return;
+  const HashedEmbeddingParam& param = nnvm::get<HashedEmbeddingParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s           = ctx.get_stream<xpu>();
+  const TBlob& data                 = inputs[embedding::kData];
+  MSHADOW_TYPE_SWITCH(outputs[embedding::kOut].type_flag_, DType, {
+    MSHADOW_TYPE_SWITCH(data.type_flag_, IType, {
+      MXNET_ASSIGN_REQ_SWITCH(req[embedding::kOut], req_t, {
+        Kernel<HashedEmbeddingForwardKernel<req_t>, xpu>::Launch(
+            s,
+            data.Size(),
+            outputs[embedding::kOut].dptr<DType>(),
+            inputs[embedding::kWeight].dptr<DType>(),
+            data.dptr<IType>(),
+            param.output_dim,
+            static_cast<int64_t>(param.input_dim),
+            param.num_hashes);
+      });
+    });
+  });
+}
+
+/*!
+ * \brief Rows of the weight of all the ids for all the hash functions, hash function major, in
+ *        the temporary space
+ */
+template <typename xpu>
+inline mshadow::Tensor<xpu, 1, int64_t> HashedEmbeddingRows(const HashedEmbeddingParam& param,
+                                                            const OpContext& ctx,
+                                                            const TBlob& data,
+                                                            const size_t extra_bytes,
+                                                            char** extra) {
+  using namespace mxnet_op;
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  const index_t num_ids   = data.Size();
+  const size_t rows_bytes = num_ids * param.num_hashes * sizeof(int64_t);
+  mshadow::Tensor<xpu, 1, char> workspace =
+      ctx.requested[0].get_space_typed<xpu, 1, char>(mshadow::Shape1(rows_bytes + extra_bytes), s);
+  int64_t* rows = reinterpret_cast<int64_t*>(workspace.dptr_);
+  MSHADOW_TYPE_SWITCH(data.type_flag_, IType, {
+    Kernel<HashedEmbeddingRowsKernel, xpu>::Launch(s,
+                                                   num_ids * param.num_hashes,
+                                                   rows,
+                                                   data.dptr<IType>(),
+                                                   num_ids,
+                                                   static_cast<int64_t>(param.input_dim));
+  });
+  *extra = workspace.dptr_ + rows_bytes;
+  return mshadow::Tensor<xpu, 1, int64_t>(rows, mshadow::Shape1(num_ids * param.num_hashes), s);
+}
+
+template <typename xpu>
+void HashedEmbeddingOpBackward(const nnvm::NodeAttrs& attrs,
+                               const OpContext& ctx,
+                               const std::vector<TBlob>& inputs,
+                               const std::vector<OpReqType>& req,
+                               const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mshadow::expr;
+  CHECK_EQ(inputs.size(), 2U);
+  CHECK_EQ(outputs.size(), 2U);
+  CHECK_EQ(req[embedding::kData], kNullOp)
+      << "HashedEmbedding layer doesn't support calculate data gradient";
+  if (req[embedding::kWeight] == kNullOp)
+    return;
+  CHECK(req[embedding::kWeight] == kWriteTo || req[embedding::kWeight] == kAddTo)
+      << "wrong req";
+  const HashedEmbeddingParam& param = nnvm::get<HashedEmbeddingParam>(attrs.parsed);
+  Stream<xpu>* s                    = ctx.get_stream<xpu>();
+  const index_t num_ids             = inputs[1].Size();
+  char* unused;
+  Tensor<xpu, 1, int64_t> rows = HashedEmbeddingRows<xpu>(param, ctx, inputs[1], 0, &unused);
+  MSHADOW_REAL_TYPE_SWITCH(outputs[1].type_flag_, DType, {
+    Tensor<xpu, 2, DType> grad_out =
+        inputs[0].get_with_shape<xpu, 2, DType>(Shape2(num_ids, param.output_dim), s);
+    Tensor<xpu, 2, DType> grad_in = outputs[1].get<xpu, 2, DType>(s);
+    if (req[embedding::kWeight] == kWriteTo) {
+      grad_in = scalar<DType>(0.0f);
+    }
+    for (int h = 0; h < param.num_hashes; ++h) {
+      AddTakeGrad(grad_in, rows.Slice(h * num_ids, (h + 1) * num_ids), grad_out);
+    }
+  });
+}
+
+/*!
+ * \brief Row sparse gradient of HashedEmbedding: the gradient of Embedding over the rows of all
+ *        the hash functions, the output gradient being repeated for each of them
+ */
+template <typename xpu>
+void HashedEmbeddingOpBackwardEx(const nnvm::NodeAttrs& attrs,
+                                 const OpContext& ctx,
+                                 const std::vector<NDArray>& inputs,
+                                 const std::vector<OpReqType>& req,
+                                 const std::vector<NDArray>& outputs) {
+  using namespace mshadow;
+  CHECK_EQ(inputs.size(), 2U);
+  CHECK_EQ(outputs.size(), 2U);
+  const NDArray& weight_grad = outputs[1];
+  const NDArray& ograd       = inputs[0];
+  const NDArray& data        = inputs[1];
+  CHECK_EQ(weight_grad.dtype(), ograd.dtype());
+  CHECK_EQ(req[embedding::kData], kNullOp)
+      << "HashedEmbedding layer doesn't support calculate data gradient";
+  if (data.storage_type() != kDefaultStorage || ograd.storage_type() != kDefaultStorage ||
+      weight_grad.storage_type() != kRowSparseStorage) {
+    LogUnimplementedOp(attrs, ctx, inputs, req, outputs);
+    return;
+  }
+  const HashedEmbeddingParam& param = nnvm::get<HashedEmbeddingParam>(attrs.parsed);
+  Stream<xpu>* s                    = ctx.get_stream<xpu>();
+  const index_t num_ids             = data.shape().Size();
+  const index_t num_rows            = num_ids * param.num_hashes;
+  // the replicated output gradients follow the rows, and the gradient of Embedding takes the
+  // rest of the same temporary space: a second temporary space may share its memory
+  size_t ograd_bytes = 0;
+  if (param.num_hashes > 1) {
+    // rounded up to keep the temporary space of the gradient of Embedding aligned
+    const size_t bytes = num_rows * param.output_dim * mshadow_sizeof(ograd.dtype());
+    ograd_bytes        = (bytes + sizeof(int64_t) - 1) / sizeof(int64_t) * sizeof(int64_t);
+  }
+  const size_t rsp_bytes = SparseEmbeddingOpBackwardRspWorkspaceSize<xpu>(
+      true, ctx, num_rows, weight_grad.shape()[0]);
+  char* ograds_ptr;
+  Tensor<xpu, 1, int64_t> rows =
+      HashedEmbeddingRows<xpu>(param, ctx, data.data(), ograd_bytes + rsp_bytes, &ograds_ptr);
+  TBlob ograds = ograd.data();
+  if (param.num_hashes > 1) {
+    MSHADOW_TYPE_SWITCH(ograd.dtype(), DType, {
+      Tensor<xpu, 2, DType> src =
+          ograd.data().get_with_shape<xpu, 2, DType>(Shape2(num_ids, param.output_dim), s);
+      Tensor<xpu, 2, DType> dst(
+          reinterpret_cast<DType*>(ograds_ptr), Shape2(num_rows, param.output_dim), s);
+      for (int h = 0; h < param.num_hashes; ++h) {
+        Copy(dst.Slice(h * num_ids, (h + 1) * num_ids), src, s);
+      }
+      ograds = TBlob(dst);
+    });
+  }
+  const size_t rows_bytes = num_rows * sizeof(int64_t);
+  SparseEmbeddingOpBackwardRspImpl<xpu>(true,
+                                        ctx,
+                                        ograds,
+                                        TBlob(rows),
+                                        req[embedding::kWeight],
+                                        weight_grad,
+                                        rows_bytes + ograd_bytes);
+}
+
 namespace take_ {  // to avoid name conflict
 enum TakeOpInputs { kArr, kIdx };
 enum TakeOpOutputs { kOut };
@@ -1386,12 +1605,45 @@ struct gather_nd {
     for (index_t j = 0; j < M; ++j) {
       offset += strides[j] * (static_cast<index_t>(indices[j * N + i] + mshape[j]) % mshape[j]);
     }
-    for (index_t j = 0; j < K; ++j) {
-      KERNEL_ASSIGN(out[i * K + j], req, data[offset + j]);
+    // the request is resolved once per row, so that the row is a plain copy
+    DType* out_row        = out + i * K;
+    const DType* data_row = data + offset;
+    if (req == kAddTo) {
+      for (index_t j = 0; j < K; ++j)
+        out_row[j] += data_row[j];
+    } else if (req != kNullOp) {
+      for (index_t j = 0; j < K; ++j)
+        out_row[j] = data_row[j];
     }
   }
 };
 
+/*!
+ * \brief gather_nd with one thread per output value instead of one per row, so that
+ *        neighbouring GPU threads copy neighbouring values of the row. For a plain copy
+ *        DType may be a wider load type, with K and strides counted in that type.
+ */
+struct gather_nd_elem {
+  template <typename DType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  OpReqType req,
+                                  index_t N,
+                                  index_t M,
+                                  index_t K,
+                                  const mshadow::Shape<10> strides,
+                                  const mshadow::Shape<10> mshape,
+                                  DType* out,
+                                  const DType* data,
+                                  const IType* indices) {
+    const index_t row = i / K;
+    index_t offset    = i - row * K;
+    for (index_t j = 0; j < M; ++j) {
+      offset += strides[j] * (static_cast<index_t>(indices[j * N + row] + mshape[j]) % mshape[j]);
+    }
+    KERNEL_ASSIGN(out[i], req, data[offset]);
+  }
+};
+
 /*!
  * \brief If any index in a dimension is out of bound,
           then the value in this dimension will be set to be the out-of-bound index
@@ -1525,12 +1777,79 @@ struct scatter_nd {
     for (index_t j = 0; j < M; ++j) {
       offset += strides[j] * static_cast<index_t>(indices[j * N + i]);
     }
-    for (index_t j = 0; j < K; ++j) {
-      KERNEL_ASSIGN(out[offset + j], req, data[i * K + j]);
+    DType* out_row        = out + offset;
+    const DType* data_row = data + i * K;
+    if (req == kAddTo) {
+      for (index_t j = 0; j < K; ++j)
+        out_row[j] += data_row[j];
+    } else if (req != kNullOp) {
+      for (index_t j = 0; j < K; ++j)
+        out_row[j] = data_row[j];
     }
   }
 };
 
+/*! \brief scatter_nd with one thread per input value, see gather_nd_elem */
+struct scatter_nd_elem {
+  template <typename DType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  OpReqType req,
+                                  index_t N,
+                                  index_t M,
+                                  index_t K,
+                                  const mshadow::Shape<10> strides,
+                                  DType* out,
+                                  const DType* data,
+                                  const IType* indices) {
+    const index_t row = i / K;
+    index_t offset    = i - row * K;
+    for (index_t j = 0; j < M; ++j) {
+      offset += strides[j] * static_cast<index_t>(indices[j * N + row]);
+    }
+    KERNEL_ASSIGN(out[offset], req, data[i]);
+  }
+};
+
+#if defined(__CUDACC__)
+/*!
+ * \brief Launch OP, gather_nd_elem or scatter_nd_elem, over the N rows of K values on the GPU.
+ *        Rows which are only copied move in the widest load type which divides both the
+ *        row size and the addresses; K and the strides are then counted in that type.
+ */
+template <typename OP, typename DType, typename IType>
+inline void LaunchIndexNDRowsGPU(mshadow::Stream<gpu>* s,
+                                 const OpReqType req,
+                                 const index_t N,
+                                 const index_t M,
+                                 const index_t K,
+                                 mshadow::Shape<10> strides,
+                                 const mshadow::Shape<10>& mshape,
+                                 DType* out,
+                                 const DType* data,
+                                 const IType* indices) {
+  using mxnet_op::Kernel;
+  auto launch = [&](auto* out_v, const auto* data_v, const index_t k) {
+    if constexpr (std::is_same<OP, gather_nd_elem>::value) {
+      Kernel<OP, gpu>::Launch(s, N * k, req, N, M, k, strides, mshape, out_v, data_v, indices);
+    } else {
+      Kernel<OP, gpu>::Launch(s, N * k, req, N, M, k, strides, out_v, data_v, indices);
+    }
+  };
+  if (req == kAddTo) {
+    launch(out, data, K);
+    return;
+  }
+  const size_t bytes = K * sizeof(DType) | reinterpret_cast<uintptr_t>(out) |
+                       reinterpret_cast<uintptr_t>(data);
+  MXNET_LOAD_TYPE_SWITCH(common::cuda::get_load_type(bytes), LType, {
+    const index_t ratio = sizeof(LType) / sizeof(DType);
+    for (index_t j = 0; j < M; ++j)
+      strides[j] /= ratio;
+    launch(reinterpret_cast<LType*>(out), reinterpret_cast<const LType*>(data), K / ratio);
+  });
+}
+#endif  // defined(__CUDACC__)
+
 template <typename xpu>
 void ScatterNDForward(const nnvm::NodeAttrs& attrs,
                       const OpContext& ctx,
@@ -1557,6 +1876,18 @@ void ScatterNDForward(const nnvm::NodeAttrs& attrs,
   }
   MSHADOW_TYPE_SWITCH_WITH_BOOL(inputs[0].type_flag_, DType, {    // output data type switch
     MSHADOW_TYPE_SWITCH_WITH_BOOL(inputs[1].type_flag_, IType, {  // indices data type switch
+#if defined(__CUDACC__)
+      LaunchIndexNDRowsGPU<scatter_nd_elem>(s,
+                                            req[0],
+                                            N,
+                                            M,
+                                            K,
+                                            strides,
+                                            strides,
+                                            outputs[0].dptr<DType>(),
+                                            inputs[0].dptr<DType>(),
+                                            inputs[1].dptr<IType>());
+#else
       mxnet_op::Kernel<scatter_nd, xpu>::Launch(s,
                                                 N,
                                                 req[0],
@@ -1567,6 +1898,7 @@ void ScatterNDForward(const nnvm::NodeAttrs& attrs,
                                                 outputs[0].dptr<DType>(),
                                                 inputs[0].dptr<DType>(),
                                                 inputs[1].dptr<IType>());
+#endif  // defined(__CUDACC__)
     });
   });
 }
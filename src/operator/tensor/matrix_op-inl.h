@@ -38,6 +38,8 @@
 #include "./init_op.h"
 #include "../../common/static_array.h"
 #include "./slice-inl.h"
+#include "./transpose_cpu-inl.h"
+#include "./copy_plan-inl.h"
 
 #if MXNET_USE_CUDA
 #include <thrust/device_vector.h>
@@ -374,6 +376,26 @@ bool TransposeCommonImpl(RunContext ctx,
     });
     return true;
   }
+  if (std::is_same<xpu, cpu>::value) {
+    // Merge the axes which move together, so that most transposes end up as a
+    // (batched) 2D transpose run by the tiled kernel, and higher ranks fit below 7 dims.
+    mxnet::TShape merged_shape, merged_axes;
+    MergeTransposeAxes(src.shape_, axes, &merged_shape, &merged_axes);
+    bool done = false;
+    MSHADOW_TYPE_SWITCH(ret.type_flag_, DType, {
+      done = TransposeMergedCPU<DType, is_addto>(
+          src.dptr<DType>(), ret.dptr<DType>(), merged_shape, merged_axes);
+    });
+    if (done)
+      return true;
+    if (merged_axes.ndim() < axes.ndim()) {
+      mxnet::TShape merged_out(merged_shape.ndim(), -1);
+      for (int i = 0; i < merged_axes.ndim(); ++i)
+        merged_out[i] = merged_shape[merged_axes[i]];
+      return TransposeCommonImpl<xpu, is_addto>(
+          ctx, src.reshape(merged_shape), ret.reshape(merged_out), merged_axes);
+    }
+  }
   // Handle the general transpose case
   MSHADOW_TYPE_SWITCH(ret.type_flag_, DType, {
     switch (axes.ndim()) {
@@ -440,9 +462,12 @@ bool TransposeCommonImpl(RunContext ctx,
 
 template <typename xpu, bool is_addto = false>
 void TransposeImpl(RunContext ctx, const TBlob& src, const TBlob& ret, const mxnet::TShape& axes) {
-  CHECK_LE(axes.ndim(), 6) << "TransposeImpl supports at most 6 dimensions";
+  if (!std::is_same<xpu, cpu>::value) {
+    CHECK_LE(axes.ndim(), 6) << "TransposeImpl supports at most 6 dimensions";
+  }
   CHECK((TransposeCommonImpl<xpu, is_addto>(ctx, src, ret, axes)))
-      << "Failed to execute TransposeImpl Operator";
+      << "TransposeImpl supports at most 6 dimensions after merging the axes which "
+         "stay adjacent, got axes " << axes;
 }
 
 template <bool is_addto>
@@ -2219,6 +2244,64 @@ inline std::pair<mxnet::TShape, mxnet::TShape> ReshapeInputOutputForTileOp(
   return std::make_pair(rshape, bshape);
 }
 
+/*!
+ * \brief Copy plan of tile on cpu. Axes without repetition are merged into the axis before
+ * them and axes of size 1 fold their repetition into the axis after them. Then every row of
+ * the innermost output axis is the matching input row repeated, which is copied run by run.
+ */
+template <typename DType>
+inline void TileCopyCPU(const DType* in,
+                        DType* out,
+                        const mxnet::TShape& ishape,
+                        const mxnet::Tuple<int>& reps,
+                        const OpReqType req) {
+  const int ndim = std::max(ishape.ndim(), reps.ndim());
+  std::vector<index_t> isize, rsize;
+  for (int k = 0; k < ndim; ++k) {
+    const int ik    = k - (ndim - ishape.ndim());
+    const int rk    = k - (ndim - reps.ndim());
+    const index_t i = ik >= 0 ? ishape[ik] : 1;
+    const index_t r = rk >= 0 ? reps[rk] : 1;
+    if (!isize.empty() && r == 1) {
+      isize.back() *= i;
+    } else if (!isize.empty() && isize.back() == 1) {
+      isize.back() = i;
+      rsize.back() *= r;
+    } else {
+      isize.push_back(i);
+      rsize.push_back(r);
+    }
+  }
+  if (isize.empty()) {
+    isize.push_back(1);
+    rsize.push_back(1);
+  }
+  const int m          = isize.size();
+  const index_t in_len = isize[m - 1];
+  const index_t nrep   = rsize[m - 1];
+  index_t rows         = 1;
+  for (int k = 0; k < m - 1; ++k)
+    rows *= isize[k] * rsize[k];
+  ForEachRowCPU(rows, in_len * nrep, [&](const index_t row) {
+    // the input row has every output coordinate taken modulo the input size
+    index_t src = 0, stride = in_len, rem = row;
+    for (int k = m - 2; k >= 0; --k) {
+      const index_t osize = isize[k] * rsize[k];
+      src += rem % osize % isize[k] * stride;
+      stride *= isize[k];
+      rem /= osize;
+    }
+    DType* dst = out + row * in_len * nrep;
+    for (index_t t = 0; t < nrep; ++t, dst += in_len) {
+      if (in_len == 1) {
+        FillRunCPU(dst, nrep, in[src], req);
+        break;
+      }
+      CopyRunCPU(in + src, dst, in_len, req);
+    }
+  });
+}
+
 /*!
  * \brief Implementation of tiling the input tensor a based
  * on the user-input shape, reps.
@@ -2256,6 +2339,15 @@ void TileOpForward(const nnvm::NodeAttrs& attrs,
       return;
   }
 
+  if (std::is_same<xpu, cpu>::value) {
+    if (req[0] == kNullOp)
+      return;
+    MSHADOW_TYPE_SWITCH_EXT_WITH_BOOL(outputs[0].type_flag_, DType, {
+      TileCopyCPU(inputs[0].dptr<DType>(), outputs[0].dptr<DType>(), ishape, reps, req[0]);
+    });
+    return;
+  }
+
   std::pair<mxnet::TShape, mxnet::TShape> rshapes = ReshapeInputOutputForTileOp(ishape, reps);
 
   // reshaped input tblob
@@ -3267,6 +3359,19 @@ inline void SplitOpForwardImpl(const nnvm::NodeAttrs& attrs,
   if (param.sections == 0) {
     indices.push_back(ishape[real_axis]);
   }
+  if (leading == 1) {
+    // every output is a contiguous block of the input
+    MSHADOW_TYPE_SWITCH(input_data.type_flag_, DType, {
+      for (size_t i = 0; i < outputs.size(); ++i) {
+        if (outputs[i].Size() == 0)
+          continue;
+        Tensor<xpu, 1, DType> out = outputs[i].FlatTo1D<xpu, DType>(s);
+        Tensor<xpu, 1, DType> in(input_data.dptr<DType>() + indices[i] * trailing, out.shape_, s);
+        mshadow::Copy(out, in, s);
+      }
+    });
+    return;
+  }
   workspace_size += indices.size() * sizeof(size_t);
   MSHADOW_TYPE_SWITCH(input_data.type_flag_, DType, {
     std::vector<DType*> output_data;
@@ -3350,6 +3455,20 @@ inline void SplitOpBackwardImpl(const nnvm::NodeAttrs& attrs,
   if (param.sections == 0) {
     indices.push_back(ishape[real_axis]);
   }
+  if (leading == 1) {
+    // every output gradient is a contiguous block of the input gradient
+    MSHADOW_TYPE_SWITCH(input_grad.type_flag_, DType, {
+      for (size_t i = 0; i < inputs.size(); ++i) {
+        if (inputs[i].Size() == 0)
+          continue;
+        Tensor<xpu, 1, DType> out_grad = inputs[i].FlatTo1D<xpu, DType>(s);
+        Tensor<xpu, 1, DType> in_grad(
+            input_grad.dptr<DType>() + indices[i] * trailing, out_grad.shape_, s);
+        mshadow::Copy(in_grad, out_grad, s);
+      }
+    });
+    return;
+  }
   workspace_size += indices.size() * sizeof(size_t);
   MSHADOW_TYPE_SWITCH(input_grad.type_flag_, DType, {
     std::vector<DType*> out_grads;
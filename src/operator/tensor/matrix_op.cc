@@ -739,6 +739,10 @@ parameter values:
     .set_attr_parser(ParamParser<ClipParam>)
     .set_attr<mxnet::FInferShape>("FInferShape", ElemwiseShape<1, 1>)
     .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<1, 1>)
+    .set_attr<nnvm::FInplaceOption>("FInplaceOption",
+                                    [](const NodeAttrs& attrs) {
+                                      return std::vector<std::pair<int, int> >{{0, 0}};
+                                    })
     .set_attr<FCompute>("FCompute<cpu>", Clip<cpu>)
     .set_attr<FComputeEx>("FComputeEx<cpu>", ClipEx<cpu>)
     .set_attr<FInferStorageType>("FInferStorageType",
@@ -788,6 +792,10 @@ NNVM_REGISTER_OP(_backward_clip)
     .set_num_outputs(1)
     .set_attr_parser(ParamParser<ClipParam>)
     .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<nnvm::FInplaceOption>("FInplaceOption",
+                                    [](const NodeAttrs& attrs) {
+                                      return std::vector<std::pair<int, int> >{{0, 0}, {1, 0}};
+                                    })
     .set_attr<FCompute>("FCompute<cpu>", ClipGrad_<cpu>)
     .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes);
 
@@ -31,6 +31,7 @@
 #include <vector>
 #include <string>
 #include <type_traits>
+#include <utility>
 #include "../mshadow_op.h"
 #include "../elemwise_op_common.h"
 #include "./sort_op.h"
@@ -262,6 +263,43 @@ struct fill_ind {
   }
 };
 
+/*!
+ * \brief Select the first K of the N values vals in the order given by is_ascend.
+ *        A heap keeps the best K (value, index) pairs found so far with the worst one at
+ *        its root, so that most values are rejected by a single comparison, without going
+ *        through an index array. Equal values are kept in index order.
+ * \param first index of vals[0], added to the selected indices
+ * \param heap  on return, the K selected pairs, best first
+ */
+template <bool is_ascend, typename DType, typename IDXType>
+inline void TopKSelect(const DType* vals,
+                       IDXType first,
+                       IDXType K,
+                       IDXType N,
+                       std::vector<std::pair<DType, IDXType>>* heap) {
+  auto better = [](const std::pair<DType, IDXType>& a, const std::pair<DType, IDXType>& b) {
+    return (is_ascend ? a.first < b.first : a.first > b.first) ||
+           (a.first == b.first && a.second < b.second);
+  };
+  heap->clear();
+  if (K == 0)
+    return;
+  for (IDXType j = 0; j < K; ++j) {
+    heap->emplace_back(vals[j], first + j);
+  }
+  std::make_heap(heap->begin(), heap->end(), better);
+  for (IDXType j = K; j < N; ++j) {
+    const DType v = vals[j];
+    // a later index only wins with a strictly better value
+    if (is_ascend ? v < heap->front().first : v > heap->front().first) {
+      std::pop_heap(heap->begin(), heap->end(), better);
+      heap->back() = std::make_pair(v, first + j);
+      std::push_heap(heap->begin(), heap->end(), better);
+    }
+  }
+  std::sort_heap(heap->begin(), heap->end(), better);
+}
+
 template <typename DType, typename IDXType>
 MSHADOW_FORCE_INLINE void TopKSort(const Tensor<cpu, 1, DType>& dat,
                                    const Tensor<cpu, 1, IDXType>& ind,
@@ -270,42 +308,48 @@ MSHADOW_FORCE_INLINE void TopKSort(const Tensor<cpu, 1, DType>& dat,
                                    IDXType N,
                                    bool is_ascend,
                                    Stream<cpu>* s) {
-  // Use full sort when K is relatively large.
+  // Use full sort when K is relatively large, otherwise select the top K of each row.
   const bool full_sort(K * 8 > N);
   // Batch size.
   const size_t M(work.size(0) / (sizeof(DType) * N));
   const int omp_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount());
-#pragma omp parallel for num_threads(omp_threads)
-  for (index_t i = 0; i < static_cast<index_t>(M); ++i) {
-    // Tensor `work` stores the flattened source data, while `dat` stores the sorted result.
-    DType* vals        = reinterpret_cast<DType*>(work.dptr_);
-    DType* sorted_vals = dat.dptr_ + i * N;
-    IDXType* indices   = ind.dptr_ + i * N;
-    if (is_ascend) {
-      if (full_sort) {
+  // Tensor `work` stores the flattened source data, while `dat` stores the sorted result.
+  const DType* vals = reinterpret_cast<DType*>(work.dptr_);
+#pragma omp parallel num_threads(omp_threads)
+  {
+    std::vector<std::pair<DType, IDXType>> heap;
+#pragma omp for
+    for (index_t i = 0; i < static_cast<index_t>(M); ++i) {
+      DType* sorted_vals  = dat.dptr_ + i * N;
+      IDXType* indices    = ind.dptr_ + i * N;
+      const IDXType first = static_cast<IDXType>(i * N);
+      if (!full_sort) {
+        if (is_ascend) {
+          TopKSelect<true>(vals + first, first, K, N, &heap);
+        } else {
+          TopKSelect<false>(vals + first, first, K, N, &heap);
+        }
+        for (IDXType j = 0; j < K; ++j) {
+          sorted_vals[j] = heap[j].first;
+          indices[j]     = heap[j].second;
+        }
+        continue;
+      }
+      for (IDXType j = 0; j < N; ++j) {
+        indices[j] = first + j;
+      }
+      if (is_ascend) {
         std::sort(indices, indices + N, [&](const IDXType& i1, const IDXType& i2) {
           return vals[i1] < vals[i2];
         });
       } else {
-        std::partial_sort(
-            indices, indices + K, indices + N, [&](const IDXType& i1, const IDXType& i2) {
-              return vals[i1] < vals[i2];
-            });
-      }
-    } else {
-      if (full_sort) {
         std::sort(indices, indices + N, [&](const IDXType& i1, const IDXType& i2) {
           return vals[i1] > vals[i2];
         });
-      } else {
-        std::partial_sort(
-            indices, indices + K, indices + N, [&](const IDXType& i1, const IDXType& i2) {
-              return vals[i1] > vals[i2];
-            });
       }
-    }
-    for (IDXType j = 0; j < K; ++j) {
-      sorted_vals[j] = vals[indices[j]];
+      for (IDXType j = 0; j < K; ++j) {
+        sorted_vals[j] = vals[indices[j]];
+      }
     }
   }
 }
@@ -413,9 +457,14 @@ MSHADOW_FORCE_INLINE void TopKSort(const Tensor<gpu, 1, DType>& dat,
                                    IDXType N,
                                    bool is_ascend,
                                    Stream<gpu>* s) {
-  // Use full sort for all but very small K for which we
-  // can do a partial sort entirely within shared memory.
-  const bool full_sort(K > 5);
+  // Each thread of the partial sort keeps K values and indices in shared memory, so larger K
+  // get fewer threads per row to stay within 48kb.
+  const size_t entry_bytes = std::max<size_t>(1, K * (sizeof(IDXType) + sizeof(DType)));
+  const IDXType nthreads   = static_cast<IDXType>(
+      std::min<size_t>(mshadow::cuda::kBaseThreadNum, (48 << 10) / entry_bytes / 32 * 32));
+  // Use full sort unless K is very small, or small enough next to N that a selection within
+  // shared memory is cheaper, as for the top few entries of a vocabulary.
+  const bool full_sort(K > 5 && (K > 64 || K * 64 > N || nthreads < 32));
   // Batch size.
   const size_t M(dat.size(0) / N);
   if (full_sort) {
@@ -434,7 +483,6 @@ MSHADOW_FORCE_INLINE void TopKSort(const Tensor<gpu, 1, DType>& dat,
       mxnet::op::SortByKey(batch_id, ind, true, &sort_work);
     }
   } else {
-    const IDXType nthreads(mshadow::cuda::kBaseThreadNum);
     PartialSortSmallK<<<M,
                         nthreads,
                         nthreads * K*(sizeof(IDXType) + sizeof(DType)),
@@ -558,13 +606,16 @@ void TopKImpl(const RunContext& ctx,
     workspace_curr_ptr += temp_size;
   }
 
-  mxnet_op::Kernel<range_fwd, xpu>::Launch(s,
-                                           batch_size * element_num,
-                                           1,
-                                           IDXType{0},
-                                           IDXType{1},
-                                           kWriteTo,
-                                           reinterpret_cast<IDXType*>(indices.dptr_));
+  // the cpu sort sets up the indices of each row itself
+  if (!std::is_same<xpu, cpu>::value) {
+    mxnet_op::Kernel<range_fwd, xpu>::Launch(s,
+                                             batch_size * element_num,
+                                             1,
+                                             IDXType{0},
+                                             IDXType{1},
+                                             kWriteTo,
+                                             reinterpret_cast<IDXType*>(indices.dptr_));
+  }
   CHECK_EQ(indices.CheckContiguous(), true);
 
   // 2. Perform inplace batch sort.
@@ -791,8 +842,11 @@ void TopKImplwithWorkspace(const RunContext& ctx,
     workspace_curr_ptr += temp_size;
   }
 
-  mxnet_op::Kernel<range_fwd, xpu>::Launch(
-      s, batch_size * element_num, 1, index_t{0}, index_t{1}, kWriteTo, indices.dptr_);
+  // the cpu sort sets up the indices of each row itself
+  if (!std::is_same<xpu, cpu>::value) {
+    mxnet_op::Kernel<range_fwd, xpu>::Launch(
+        s, batch_size * element_num, 1, index_t{0}, index_t{1}, kWriteTo, indices.dptr_);
+  }
   CHECK_EQ(indices.CheckContiguous(), true);
 
   // 2. Perform inplace batch sort.
@@ -937,7 +991,7 @@ void Sort(const nnvm::NodeAttrs& attrs,
   topk_param.is_ascend = param.is_ascend;
   topk_param.k         = 0;
   topk_param.ret_typ   = topk_enum::kReturnValue;
-  MXNET_NO_FLOAT16_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+  MXNET_WITH_BFLOAT16_TYPE_SWITCH(MXNET_NO_FLOAT16_TYPE_SWITCH, inputs[0].type_flag_, DType, {
     if (inputs[0].Size() >= INT_MAX) {
       TopKImpl<xpu, DType, index_t, index_t>(
           ctx.run_ctx, ctx.requested[0], req, inputs[0], outputs, topk_param);
@@ -961,7 +1015,7 @@ void ArgSort(const nnvm::NodeAttrs& attrs,
   topk_param.k         = 0;
   topk_param.dtype     = param.dtype;
   topk_param.ret_typ   = topk_enum::kReturnIndices;
-  MXNET_NO_FLOAT16_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+  MXNET_WITH_BFLOAT16_TYPE_SWITCH(MXNET_NO_FLOAT16_TYPE_SWITCH, inputs[0].type_flag_, DType, {
     MSHADOW_TYPE_SWITCH(param.dtype, IDType, {
       if (inputs[0].Size() >= INT_MAX) {
         TopKImpl<xpu, DType, IDType, index_t>(
@@ -0,0 +1,88 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file prefix_count-inl.h
+ * \brief Parallel count of the elements selected by a predicate, used by the ops which
+ *        compact their input into an output of data dependent size
+ */
+#ifndef MXNET_OPERATOR_TENSOR_PREFIX_COUNT_INL_H_
+#define MXNET_OPERATOR_TENSOR_PREFIX_COUNT_INL_H_
+
+#include <mxnet/base.h>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include "../../engine/openmp.h"
+
+namespace mxnet {
+namespace op {
+
+/*!
+ * \brief Inclusive prefix count of pred over [0, n) on CPU: prefix_sum[i] is the number of
+ *        j <= i for which pred(j) holds, so the selected i is written to prefix_sum[i] - 1
+ *        by the compaction kernels, e.g. BooleanMaskForwardCPUKernel.
+ *        The range is cut into one block per thread. The first pass counts every block,
+ *        the block counts are scanned serially and the second pass writes the prefix of
+ *        every block from its offset.
+ * \return the number of selected elements
+ */
+template <typename IType, typename Pred>
+inline IType PrefixCountCPU(const index_t n, const Pred& pred, IType* prefix_sum) {
+  // below this many elements per block the second pass costs more than it saves
+  const index_t kMinBlock = 16384;
+  const int omp_threads   = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  const index_t nblocks   = std::max<index_t>(1, std::min<index_t>(omp_threads, n / kMinBlock));
+  const index_t block     = (n + nblocks - 1) / nblocks;
+  if (nblocks == 1) {
+    IType count = 0;
+    for (index_t i = 0; i < n; ++i) {
+      count += pred(i) ? 1 : 0;
+      prefix_sum[i] = count;
+    }
+    return count;
+  }
+  std::vector<IType> offsets(nblocks + 1, 0);
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t b = 0; b < nblocks; ++b) {
+    const index_t end = std::min(n, (b + 1) * block);
+    IType count       = 0;
+    for (index_t i = b * block; i < end; ++i) {
+      count += pred(i) ? 1 : 0;
+    }
+    offsets[b + 1] = count;
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t b = 0; b < nblocks; ++b) {
+    const index_t end = std::min(n, (b + 1) * block);
+    IType count       = offsets[b];
+    for (index_t i = b * block; i < end; ++i) {
+      count += pred(i) ? 1 : 0;
+      prefix_sum[i] = count;
+    }
+  }
+  return offsets[nblocks];
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_TENSOR_PREFIX_COUNT_INL_H_
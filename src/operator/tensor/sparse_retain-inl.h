@@ -116,7 +116,8 @@ inline bool SparseRetainBackwardInferStorageType(const nnvm::NodeAttrs& attrs,
  * has the almost the same workload. The overhead is the binary
  * search. If all the indices of the idx array are contained
  * in the in_idx, one should use SparseRetainRspRowBlockKernel instead,
- * where each thread only perform binary search once.
+ * where each thread only perform binary search once. The rows
+ * which are not found are filled with zeros.
  */
 struct SparseRetainRspThreadKernel {
   template <typename DType, typename RType, typename IType>
@@ -142,13 +143,17 @@ struct SparseRetainRspThreadKernel {
         right = m - 1;
       }
     }
-    out_idx[i] = idx[i];
+    out_idx[i]              = idx[i];
+    const size_t out_offset = i * row_length;
     if (j >= 0) {
-      const size_t in_offset  = j * row_length;
-      const size_t out_offset = i * row_length;
+      const size_t in_offset = j * row_length;
       for (size_t k = 0; k < row_length; ++k) {
         out_data[out_offset + k] = in_data[in_offset + k];
       }
+    } else {
+      for (size_t k = 0; k < row_length; ++k) {
+        out_data[out_offset + k] = 0;
+      }
     }
   }
 };
@@ -303,8 +308,8 @@ void SparseRetainOpForwardRspImpl(mshadow::Stream<xpu>* s,
   const auto row_length = input_data.shape_.ProdShape(1, input_data.shape_.ndim());
 
   using namespace mxnet_op;
+  // every row of the output is written once, by a copy or with zeros
   MSHADOW_TYPE_SWITCH(output_data.type_flag_, DType, {  // output data type
-    Kernel<set_zero, xpu>::Launch(s, output_data.Size(), output_data.dptr<DType>());
     MSHADOW_IDX_TYPE_SWITCH(output_idx.type_flag_, RType, {  // row index data type
       MSHADOW_TYPE_SWITCH(idx_data.type_flag_, IType, {      // index array data type
         if (input_idx.Size() == static_cast<size_t>(input_nd.shape()[0])) {  // input rsp is dense
@@ -0,0 +1,288 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file transpose_cpu-inl.h
+ * \brief Cache-blocked CPU transpose for the 2D and batched 2D cases
+ */
+#ifndef MXNET_OPERATOR_TENSOR_TRANSPOSE_CPU_INL_H_
+#define MXNET_OPERATOR_TENSOR_TRANSPOSE_CPU_INL_H_
+
+#include <mxnet/base.h>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+#include "../../engine/openmp.h"
+
+#if defined(__AVX__) && !defined(__CUDACC__)
+#include <immintrin.h>
+#endif
+
+namespace mxnet {
+namespace op {
+
+/*!
+ * \brief Simplify a transpose before running it: size-1 axes are dropped and input axes
+ *        which stay adjacent and in order after the permutation are merged into one.
+ *        E.g. axes (0, 2, 3, 1) on shape (N, C, H, W) become (0, 2, 1) on (N, C, H * W).
+ * \param shape     input shape
+ * \param axes      permutation of the input axes
+ * \param new_shape merged input shape
+ * \param new_axes  permutation of the merged axes
+ */
+inline void MergeTransposeAxes(const mxnet::TShape& shape,
+                               const mxnet::TShape& axes,
+                               mxnet::TShape* new_shape,
+                               mxnet::TShape* new_axes) {
+  const int ndim = shape.ndim();
+  std::vector<int> kept(ndim, -1);
+  std::vector<dim_t> dims;
+  for (int i = 0; i < ndim; ++i) {
+    if (shape[i] != 1) {
+      kept[i] = dims.size();
+      dims.push_back(shape[i]);
+    }
+  }
+  std::vector<int> perm;
+  for (int i = 0; i < ndim; ++i) {
+    if (kept[axes[i]] >= 0)
+      perm.push_back(kept[axes[i]]);
+  }
+  // an input axis starts a new group unless it directly follows its predecessor in the output
+  std::vector<bool> head(dims.size(), true);
+  for (size_t j = 1; j < perm.size(); ++j) {
+    if (perm[j] == perm[j - 1] + 1)
+      head[perm[j]] = false;
+  }
+  std::vector<int> group(dims.size());
+  std::vector<dim_t> merged;
+  for (size_t i = 0; i < dims.size(); ++i) {
+    if (head[i]) {
+      merged.push_back(dims[i]);
+    } else {
+      merged.back() *= dims[i];
+    }
+    group[i] = merged.size() - 1;
+  }
+  if (merged.empty()) {
+    *new_shape = mxnet::TShape(1, 1);
+    *new_axes  = mxnet::TShape(1, 0);
+    return;
+  }
+  *new_shape = mxnet::TShape(merged.begin(), merged.end());
+  *new_axes  = mxnet::TShape(merged.size(), -1);
+  int k      = 0;
+  for (const int p : perm) {
+    if (head[p])
+      (*new_axes)[k++] = group[p];
+  }
+}
+
+/*!
+ * \brief In-register transpose of a square block whose side is one SIMD register.
+ *        kBytes is the element size; 0 (the default) means there is no vector block.
+ */
+template <int kBytes, bool is_addto>
+struct TransposeBlockSIMD {
+  static const index_t kSize = 0;
+  static void Run(const void* in, index_t ld_in, void* out, index_t ld_out) {}
+};
+
+#if defined(__AVX__) && !defined(__CUDACC__)
+template <bool is_addto>
+struct TransposeBlockSIMD<4, is_addto> {
+  static const index_t kSize = 8;
+  static void Run(const void* in_ptr, index_t ld_in, void* out_ptr, index_t ld_out) {
+    const float* in = reinterpret_cast<const float*>(in_ptr);
+    float* out      = reinterpret_cast<float*>(out_ptr);
+    __m256 r[8], t[8];
+    for (int i = 0; i < 8; ++i)
+      r[i] = _mm256_loadu_ps(in + i * ld_in);
+    for (int i = 0; i < 8; i += 2) {
+      t[i]     = _mm256_unpacklo_ps(r[i], r[i + 1]);
+      t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+    }
+    for (int i = 0; i < 8; i += 4) {
+      r[i]     = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+      r[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+      r[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+      r[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+    }
+    for (int i = 0; i < 4; ++i) {
+      t[i]     = _mm256_permute2f128_ps(r[i], r[i + 4], 0x20);
+      t[i + 4] = _mm256_permute2f128_ps(r[i], r[i + 4], 0x31);
+    }
+    for (int i = 0; i < 8; ++i) {
+      if (is_addto)
+        t[i] = _mm256_add_ps(t[i], _mm256_loadu_ps(out + i * ld_out));
+      _mm256_storeu_ps(out + i * ld_out, t[i]);
+    }
+  }
+};
+
+template <bool is_addto>
+struct TransposeBlockSIMD<8, is_addto> {
+  static const index_t kSize = 4;
+  static void Run(const void* in_ptr, index_t ld_in, void* out_ptr, index_t ld_out) {
+    const double* in = reinterpret_cast<const double*>(in_ptr);
+    double* out      = reinterpret_cast<double*>(out_ptr);
+    __m256d r[4], t[4];
+    for (int i = 0; i < 4; ++i)
+      r[i] = _mm256_loadu_pd(in + i * ld_in);
+    t[0] = _mm256_unpacklo_pd(r[0], r[1]);
+    t[1] = _mm256_unpackhi_pd(r[0], r[1]);
+    t[2] = _mm256_unpacklo_pd(r[2], r[3]);
+    t[3] = _mm256_unpackhi_pd(r[2], r[3]);
+    r[0] = _mm256_permute2f128_pd(t[0], t[2], 0x20);
+    r[1] = _mm256_permute2f128_pd(t[1], t[3], 0x20);
+    r[2] = _mm256_permute2f128_pd(t[0], t[2], 0x31);
+    r[3] = _mm256_permute2f128_pd(t[1], t[3], 0x31);
+    for (int i = 0; i < 4; ++i) {
+      if (is_addto)
+        r[i] = _mm256_add_pd(r[i], _mm256_loadu_pd(out + i * ld_out));
+      _mm256_storeu_pd(out + i * ld_out, r[i]);
+    }
+  }
+};
+#endif  // __AVX__
+
+/*!
+ * \brief Transpose the tile [r0, r1) x [c0, c1) of a row x col matrix.
+ *        The vector block only moves bits, so every 4- and 8-byte type can use it for a
+ *        plain copy, while accumulation needs the matching float or double type.
+ */
+template <typename DType, bool is_addto>
+inline void TransposeTile(const DType* in,
+                          DType* out,
+                          index_t row,
+                          index_t col,
+                          index_t r0,
+                          index_t r1,
+                          index_t c0,
+                          index_t c1) {
+  using Block = TransposeBlockSIMD<(is_addto && !std::is_floating_point<DType>::value)
+                                       ? 0
+                                       : static_cast<int>(sizeof(DType)),
+                                   is_addto>;
+  const index_t vs = Block::kSize;
+  index_t r        = r0;
+  if (vs > 0) {
+    for (; r + vs <= r1; r += vs) {
+      index_t c = c0;
+      for (; c + vs <= c1; c += vs)
+        Block::Run(in + r * col + c, col, out + c * row + r, row);
+      for (; c < c1; ++c) {
+        for (index_t b = r; b < r + vs; ++b) {
+          if (!is_addto) {
+            out[c * row + b] = in[b * col + c];
+          } else {
+            out[c * row + b] += in[b * col + c];
+          }
+        }
+      }
+    }
+  }
+  if (r == r1)
+    return;
+  for (index_t c = c0; c < c1; ++c) {
+    for (index_t b = r; b < r1; ++b) {
+      if (!is_addto) {
+        out[c * row + b] = in[b * col + c];
+      } else {
+        out[c * row + b] += in[b * col + c];
+      }
+    }
+  }
+}
+
+/*!
+ * \brief Run a transpose whose axes have been simplified by MergeTransposeAxes.
+ *        Every supported pattern is a batched 2D transpose of contiguous chunks,
+ *        out[b][c][r][k] = in[b][r][c][k]:
+ *        (1, 0), (0, 2, 1), (1, 0, 2) and (0, 2, 1, 3).
+ *        The matrices are cut into tiles which fit in L1 and the tiles of all batches
+ *        are spread over the OpenMP threads.
+ * \return false when the pattern is not one of the above
+ */
+template <typename DType, bool is_addto>
+inline bool TransposeMergedCPU(const DType* in,
+                               DType* out,
+                               const mxnet::TShape& shape,
+                               const mxnet::TShape& axes) {
+  index_t batch = 1, row = 0, col = 0, inner = 1;
+  if (axes.ndim() == 2 && axes[0] == 1) {
+    row = shape[0];
+    col = shape[1];
+  } else if (axes.ndim() == 3 && axes[0] == 0 && axes[1] == 2) {
+    batch = shape[0];
+    row   = shape[1];
+    col   = shape[2];
+  } else if (axes.ndim() == 3 && axes[0] == 1 && axes[1] == 0) {
+    row   = shape[0];
+    col   = shape[1];
+    inner = shape[2];
+  } else if (axes.ndim() == 4 && axes[0] == 0 && axes[1] == 2 && axes[2] == 1) {
+    batch = shape[0];
+    row   = shape[1];
+    col   = shape[2];
+    inner = shape[3];
+  } else {
+    return false;
+  }
+  // 32 x 32 tiles of 8-byte elements fill a 32kb L1 with the input and output tiles.
+  // Wide inner chunks are already contiguous, so fewer of them are needed per tile.
+  const index_t tile = inner == 1 ? 32 : std::max<index_t>(1, 32 / inner);
+  const index_t tiles_r = (row + tile - 1) / tile;
+  const index_t tiles_c = (col + tile - 1) / tile;
+  const index_t ntiles  = batch * tiles_r * tiles_c;
+  const index_t mat     = row * col * inner;
+  const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(omp_threads) if (mat * batch > 4096)
+  for (index_t t = 0; t < ntiles; ++t) {
+    const index_t b  = t / (tiles_r * tiles_c);
+    const index_t r0 = (t / tiles_c) % tiles_r * tile;
+    const index_t c0 = t % tiles_c * tile;
+    const index_t r1 = std::min(r0 + tile, row);
+    const index_t c1 = std::min(c0 + tile, col);
+    const DType* src = in + b * mat;
+    DType* dst       = out + b * mat;
+    if (inner == 1) {
+      TransposeTile<DType, is_addto>(src, dst, row, col, r0, r1, c0, c1);
+      continue;
+    }
+    for (index_t c = c0; c < c1; ++c) {
+      for (index_t r = r0; r < r1; ++r) {
+        const DType* from = src + (r * col + c) * inner;
+        DType* to         = dst + (c * row + r) * inner;
+        if (!is_addto) {
+          std::copy(from, from + inner, to);
+        } else {
+          for (index_t k = 0; k < inner; ++k)
+            to[k] += from[k];
+        }
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_TENSOR_TRANSPOSE_CPU_INL_H_
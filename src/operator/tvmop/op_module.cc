@@ -26,7 +26,11 @@
 #include <tvm/runtime/packed_func.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/runtime/c_runtime_api.h>
+#include <dmlc/json.h>
+#include <algorithm>
+#include <fstream>
 #include <string>
+#include <utility>
 #include <vector>
 #include "op_module.h"
 
@@ -51,53 +55,45 @@ void TVMOpModule::Import(const TVMOpModule& module) {
   module_ptr_->Import(*(module.module_ptr_));
 }
 
+const char* DTypeName(int type_flag) {
+  switch (type_flag) {
+    case mshadow::kFloat32:
+      return "float32";
+    case mshadow::kFloat64:
+      return "float64";
+    case mshadow::kFloat16:
+      return "float16";
+    case mshadow::kUint8:
+      return "uint8";
+    case mshadow::kUint16:
+      return "uint16";
+    case mshadow::kUint32:
+      return "uint32";
+    case mshadow::kUint64:
+      return "uint64";
+    case mshadow::kInt16:
+      return "int16";
+    case mshadow::kInt32:
+      return "int32";
+    case mshadow::kInt8:
+      return "int8";
+    case mshadow::kInt64:
+      return "int64";
+    case mshadow::kBool:
+      return "bool";
+    default:
+      LOG(FATAL) << "Unknown dtype " << type_flag;
+  }
+  return "";
+}
+
 PackedFunc GetFunction(const std::shared_ptr<Module>& module,
                        const std::string& op_name,
                        const std::vector<mxnet::TBlob>& args) {
   std::ostringstream func_name;
   func_name << op_name;
   for (const auto& arg : args) {
-    switch (arg.type_flag_) {
-      case mshadow::kFloat32:
-        func_name << "float32";
-        break;
-      case mshadow::kFloat64:
-        func_name << "float64";
-        break;
-      case mshadow::kFloat16:
-        func_name << "float16";
-        break;
-      case mshadow::kUint8:
-        func_name << "uint8";
-        break;
-      case mshadow::kUint16:
-        func_name << "uint16";
-        break;
-      case mshadow::kUint32:
-        func_name << "uint32";
-        break;
-      case mshadow::kUint64:
-        func_name << "uint64";
-        break;
-      case mshadow::kInt16:
-        func_name << "int16";
-        break;
-      case mshadow::kInt32:
-        func_name << "int32";
-        break;
-      case mshadow::kInt8:
-        func_name << "int8";
-        break;
-      case mshadow::kInt64:
-        func_name << "int64";
-        break;
-      case mshadow::kBool:
-        func_name << "bool";
-        break;
-      default:
-        LOG(FATAL) << "Unknown dtype " << arg.type_flag_;
-    }
-    func_name << "_" << arg.shape_.ndim();
+    func_name << DTypeName(arg.type_flag_) << "_" << arg.shape_.ndim();
   }
   return module->GetFunction(func_name.str(), false);
 }
@@ -156,6 +152,154 @@ void TVMOpModule::CallEx(const std::string& func_name,
 #endif
 }
 
+struct TunedKernel {
+  std::string op;
+  std::string func_name;
+  std::string device;
+  /*! \brief attributes of the operator the kernel is valid for, without spaces */
+  std::map<std::string, std::string> attrs;
+  std::vector<std::string> dtypes;
+  std::vector<std::vector<int64_t>> shapes;
+  int dev_mask;
+  PackedFunc func;
+
+  void Load(dmlc::JSONReader* reader) {
+    dmlc::JSONObjectReadHelper helper;
+    helper.DeclareField("op", &op);
+    helper.DeclareField("func", &func_name);
+    helper.DeclareField("device", &device);
+    helper.DeclareOptionalField("attrs", &attrs);
+    helper.DeclareField("dtypes", &dtypes);
+    helper.DeclareField("shapes", &shapes);
+    helper.ReadAllFields(reader);
+  }
+
+  /*! \brief whether the kernel was tuned for the blob */
+  bool Matches(const mxnet::TBlob& blob, size_t i) const {
+    if (dtypes[i] != DTypeName(blob.type_flag_) ||
+        static_cast<int>(shapes[i].size()) != blob.shape_.ndim())
+      return false;
+    for (size_t j = 0; j < shapes[i].size(); ++j) {
+      if (shapes[i][j] != blob.shape_[j])
+        return false;
+    }
+    return true;
+  }
+};
+
+static std::string RemoveSpaces(std::string str) {
+  str.erase(std::remove(str.begin(), str.end(), ' '), str.end());
+  return str;
+}
+
+void TunedKernels::Load(const std::string& libpath, const std::string& manifest_path) {
+  static const PackedFunc* f_load = Registry::Get("runtime.ModuleLoadFromFile");
+  Module module = (*f_load)(libpath, "");
+  std::ifstream is(manifest_path);
+  CHECK(is) << "Cannot open the manifest of tuned kernels " << manifest_path;
+  dmlc::JSONReader reader(&is);
+  std::vector<TunedKernel> loaded;
+  reader.Read(&loaded);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto kernels = std::make_shared<KernelMap>(*std::atomic_load(&kernels_));
+  for (TunedKernel& kernel : loaded) {
+    CHECK(kernel.device == "cpu" || kernel.device == "gpu")
+        << "Unknown device " << kernel.device << " of the tuned kernel " << kernel.func_name;
+    CHECK_EQ(kernel.dtypes.size(), kernel.shapes.size())
+        << "Tuned kernel " << kernel.func_name << " has " << kernel.dtypes.size()
+        << " dtypes and " << kernel.shapes.size() << " shapes";
+    kernel.dev_mask = kernel.device == "cpu" ? mxnet::cpu::kDevMask : mxnet::gpu::kDevMask;
+    kernel.func     = module.GetFunction(kernel.func_name, true);
+    CHECK(kernel.func != nullptr)
+        << "Tuned kernel " << kernel.func_name << " is missing from " << libpath;
+    for (auto& attr : kernel.attrs)
+      attr.second = RemoveSpaces(attr.second);
+    Install(kernel.op, kernel.device);
+    (*kernels)[kernel.op].push_back(std::make_shared<TunedKernel>(std::move(kernel)));
+  }
+  std::atomic_store(&kernels_, std::shared_ptr<const KernelMap>(kernels));
+}
+
+void TunedKernels::Install(const std::string& op_name, const std::string& device) {
+  if (!installed_.insert(op_name + "<" + device + ">").second)
+    return;
+  const nnvm::Op* op = dmlc::Registry<nnvm::Op>::Get()->Find(op_name);
+  CHECK(op != nullptr) << "Tuned kernels of the unknown operator " << op_name;
+  const std::string attr_name = "FCompute<" + device + ">";
+  const mxnet::FCompute fcompute =
+      nnvm::Op::GetAttr<mxnet::FCompute>(attr_name).get(op, mxnet::FCompute());
+  CHECK(fcompute != nullptr) << "Operator " << op_name << " has no " << attr_name
+                             << " for its tuned kernels to replace";
+  auto tuned_fcompute = [op_name, fcompute](const nnvm::NodeAttrs& attrs,
+                                            const mxnet::OpContext& ctx,
+                                            const std::vector<mxnet::TBlob>& inputs,
+                                            const std::vector<mxnet::OpReqType>& req,
+                                            const std::vector<mxnet::TBlob>& outputs) {
+    if (!TunedKernels::Get()->Call(op_name, attrs, ctx, inputs, req, outputs))
+      fcompute(attrs, ctx, inputs, req, outputs);
+  };
+  // a higher priority level overwrites the native FCompute, as for the operators of libraries
+  dmlc::Registry<nnvm::Op>::Get()->__REGISTER_OR_GET__(op_name).set_attr<mxnet::FCompute>(
+      attr_name, tuned_fcompute, 11);
+}
+
+bool TunedKernels::Call(const std::string& op_name,
+                        const nnvm::NodeAttrs& attrs,
+                        const mxnet::OpContext& ctx,
+                        const std::vector<mxnet::TBlob>& inputs,
+                        const std::vector<mxnet::OpReqType>& req,
+                        const std::vector<mxnet::TBlob>& outputs) const {
+  const std::shared_ptr<const KernelMap> kernels = std::atomic_load(&kernels_);
+  auto it                                        = kernels->find(op_name);
+  if (it == kernels->end())
+    return false;
+  // tuned kernels overwrite all their outputs
+  for (const mxnet::OpReqType r : req) {
+    if (r != mxnet::kWriteTo && r != mxnet::kWriteInplace)
+      return false;
+  }
+  const int dev_mask = ctx.run_ctx.ctx.dev_mask();
+  const size_t nargs = inputs.size() + outputs.size();
+  for (const auto& kernel : it->second) {
+    if (kernel->dev_mask != dev_mask || kernel->shapes.size() != nargs)
+      continue;
+    bool match = true;
+    for (size_t i = 0; i < nargs && match; ++i)
+      match = kernel->Matches(i < inputs.size() ? inputs[i] : outputs[i - inputs.size()], i);
+    for (auto attr = kernel->attrs.begin(); attr != kernel->attrs.end() && match; ++attr) {
+      auto value = attrs.dict.find(attr->first);
+      match      = value != attrs.dict.end() && RemoveSpaces(value->second) == attr->second;
+    }
+    if (!match)
+      continue;
+
+    std::vector<int> type_codes(nargs, kTVMDLTensorHandle);
+    std::vector<TVMValue> values(nargs);
+    for (size_t i = 0; i < nargs; ++i) {
+      const mxnet::TBlob& blob = i < inputs.size() ? inputs[i] : outputs[i - inputs.size()];
+      values[i].v_handle       = const_cast<DLTensor*>(&(blob.dltensor()));
+    }
+    TVMArgs tvm_args(values.data(), type_codes.data(), nargs);
+    TVMRetValue rv;
+#if MXNET_USE_CUDA
+    int dev_id = ctx.run_ctx.ctx.dev_id;
+    if (dev_mask == mxnet::gpu::kDevMask) {
+      void* stream = static_cast<void*>(ctx.run_ctx.get_stream<mxnet::gpu>()->stream_);
+      TVMSetStream(kDLGPU, dev_id, stream);
+    }
+#endif
+    kernel->func.CallPacked(tvm_args, &rv);
+#if MXNET_USE_CUDA
+    if (dev_mask == mxnet::gpu::kDevMask) {
+      TVMSetStream(kDLGPU, dev_id, nullptr);
+    }
+#endif
+    return true;
+  }
+  return false;
+}
+
 const TVMOpConfig& GetOpConfig(const std::string& name) {
   const TVMOpConfig* ret = ::dmlc::Registry<TVMOpConfig>::Get()->Find(name);
   CHECK(ret != nullptr) << "op " << name << "does not exist.";
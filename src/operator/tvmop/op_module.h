@@ -28,8 +28,11 @@
 #if MXNET_USE_TVM_OP
 #include <mxnet/base.h>
 #include <mxnet/op_attr_types.h>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <map>
 
@@ -148,6 +151,52 @@ class TVMOpConfig {
 
 const TVMOpConfig& GetOpConfig(const std::string& name);
 
+struct TunedKernel;
+
+/*!
+ * \brief Kernels tuned by the TVM auto-scheduler for the shapes of a model, loaded at runtime.
+ * A tuned kernel replaces the FCompute of its registered operator for the dtypes, shapes and
+ * attributes it was tuned for, the other calls run the native FCompute.
+ */
+class TunedKernels {
+ public:
+  /*!
+   * \brief Load a library of tuned kernels, as written by contrib/tvmop/tune.py.
+   * \param libpath the library exported by TVM.
+   * \param manifest_path the json list of its kernels: for each of them the operator, the
+   *        function, the device ("cpu" or "gpu"), the attributes of the operator it is valid for
+   *        and the dtypes and shapes of the inputs followed by the outputs.
+   */
+  void Load(const std::string& libpath, const std::string& manifest_path);
+
+  /*!
+   * \brief Run the kernel tuned for a call of an operator.
+   * \return whether there is one, the native FCompute runs the call otherwise.
+   */
+  bool Call(const std::string& op_name,
+            const nnvm::NodeAttrs& attrs,
+            const mxnet::OpContext& ctx,
+            const std::vector<mxnet::TBlob>& inputs,
+            const std::vector<mxnet::OpReqType>& req,
+            const std::vector<mxnet::TBlob>& outputs) const;
+
+  static TunedKernels* Get() {
+    static TunedKernels inst;
+    return &inst;
+  }
+
+ private:
+  using KernelMap = std::unordered_map<std::string, std::vector<std::shared_ptr<TunedKernel>>>;
+  /*! \brief Make the FCompute of an operator on a device look for its tuned kernels first */
+  void Install(const std::string& op_name, const std::string& device);
+
+  std::mutex mutex_;
+  /*! \brief kernels by operator, replaced as a whole by Load so that calls read it unlocked */
+  std::shared_ptr<const KernelMap> kernels_ = std::make_shared<const KernelMap>();
+  /*! \brief operator and device pairs whose FCompute looks for tuned kernels */
+  std::unordered_set<std::string> installed_;
+};
+
 }  // namespace runtime
 }  // namespace tvm
 
@@ -0,0 +1,252 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file vectorized_math-inl.h
+ * \brief Float transcendental functions for the CPU elementwise kernels. They are branch-free
+ *        polynomial approximations without calls into libm, so that the compiler vectorizes the
+ *        loops which use them. Each one has an accurate version, within a few ulp of libm, and a
+ *        fast one, with a relative error around 1e-5.
+ */
+#ifndef MXNET_OPERATOR_VECTORIZED_MATH_INL_H_
+#define MXNET_OPERATOR_VECTORIZED_MATH_INL_H_
+
+#include <dmlc/parameter.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace mxnet {
+namespace op {
+namespace vmath {
+
+/*! \brief Accuracy modes, selected by MXNET_CPU_VECTORIZED_MATH */
+enum Mode { kOff = 0, kAccurate = 1, kFast = 2 };
+
+/*! \brief Mode of the CPU elementwise kernels, read once */
+inline int GetMode() {
+  static const int mode = dmlc::GetEnv("MXNET_CPU_VECTORIZED_MATH", static_cast<int>(kAccurate));
+  return mode;
+}
+
+/*! \brief Number of elements of the chunks the vectorized kernels are split in among threads */
+constexpr size_t kChunkSize = 4096;
+
+/*!
+ * \brief c ? a : b by bit masks. The compiler keeps a ternary of floating point results as a
+ *        branch, since evaluating both sides may raise exceptions.
+ */
+inline float select(bool c, float a, float b) {
+  uint32_t a_bits, b_bits;
+  std::memcpy(&a_bits, &a, sizeof(a_bits));
+  std::memcpy(&b_bits, &b, sizeof(b_bits));
+  const uint32_t mask = 0u - static_cast<uint32_t>(c);
+  const uint32_t bits = (a_bits & mask) | (b_bits & ~mask);
+  float ret;
+  std::memcpy(&ret, &bits, sizeof(ret));
+  return ret;
+}
+
+/*! \brief 2^k for k in the range of the normal exponents */
+inline float pow2i(int32_t k) {
+  const int32_t bits = (k + 127) << 23;
+  float ret;
+  std::memcpy(&ret, &bits, sizeof(ret));
+  return ret;
+}
+
+/*!
+ * \brief exp, by reduction to r = x - n * ln(2) with |r| <= ln(2) / 2 and a polynomial of r. The
+ *        scaling by 2^n is done in two steps to reach the denormals.
+ */
+template <bool fast>
+inline float exp(float x) {
+  const float hi = 88.7228393f;
+  const float lo = -104.0f;
+  // NaN is mapped to lo to keep the conversion to int defined, and restored at the end
+  const float xc = select(x >= lo, select(x <= hi, x, hi), lo);
+  // rounds to the nearest integer by the float spacing at 1.5 * 2^23, floor does not vectorize
+  const float n  = (xc * 1.44269504088896341f + 12582912.0f) - 12582912.0f;
+  float r        = xc - n * 0.693359375f;
+  r              = r - n * -2.12194440e-4f;
+  float p;
+  if (fast) {
+    p = 8.3333333333e-3f;
+    p = p * r + 4.1666666667e-2f;
+  } else {
+    p = 1.9875691500e-4f;
+    p = p * r + 1.3981999507e-3f;
+    p = p * r + 8.3334519073e-3f;
+    p = p * r + 4.1665795894e-2f;
+  }
+  p               = p * r + 1.6666665459e-1f;
+  p               = p * r + 5.0000001201e-1f;
+  p               = p * r * r + r + 1.0f;
+  const int32_t k = static_cast<int32_t>(n);
+  const int32_t h = k / 2;
+  const float ret = p * pow2i(h) * pow2i(k - h);
+  return select(x != x, x, select(x > hi, std::numeric_limits<float>::infinity(), ret));
+}
+
+/*!
+ * \brief log, by splitting x in 2^e * m with sqrt(0.5) <= m < sqrt(2) and a polynomial of m - 1.
+ *        Both modes are the same.
+ */
+template <bool fast>
+inline float log(float x) {
+  // denormals are scaled to normals first
+  const bool denormal = x < std::numeric_limits<float>::min();
+  const float xs      = x * select(denormal, 8388608.0f, 1.0f);
+  int32_t bits;
+  std::memcpy(&bits, &xs, sizeof(bits));
+  const int32_t eb = ((bits >> 23) & 0xff) - 126;
+  const int32_t mb = (bits & 0x7fffff) | 0x3f000000;
+  float e          = static_cast<float>(eb) - select(denormal, 23.0f, 0.0f);
+  float m;
+  std::memcpy(&m, &mb, sizeof(m));
+  // m is in [0.5, 1)
+  const bool small = m < 0.707106781186547524f;
+  e                = e - select(small, 1.0f, 0.0f);
+  m                = m * select(small, 2.0f, 1.0f) - 1.0f;
+  const float z    = m * m;
+  float p          = 7.0376836292e-2f;
+  p                = p * m - 1.1514610310e-1f;
+  p                = p * m + 1.1676998740e-1f;
+  p                = p * m - 1.2420140846e-1f;
+  p                = p * m + 1.4249322787e-1f;
+  p                = p * m - 1.6668057665e-1f;
+  p                = p * m + 2.0000714765e-1f;
+  p                = p * m - 2.4999993993e-1f;
+  p                = p * m + 3.3333331174e-1f;
+  p                = p * m * z;
+  p                = p + e * -2.12194440e-4f - 0.5f * z;
+  const float ret  = m + p + e * 0.693359375f;
+  const float inf  = std::numeric_limits<float>::infinity();
+  return select(x > 0.0f,
+                select(x < inf, ret, inf),
+                select(x == 0.0f, -inf, std::numeric_limits<float>::quiet_NaN()));
+}
+
+/*!
+ * \brief tanh. The accurate version is the clamped 13/6 rational approximation, the fast one
+ *        goes through exp and the Taylor series around 0.
+ */
+template <bool fast>
+inline float tanh(float x) {
+  if (fast) {
+    const float t = 1.0f - 2.0f / (exp<true>(2.0f * x) + 1.0f);
+    const float s = x - x * x * x * (1.0f / 3.0f);
+    return select(std::abs(x) < 0.0625f, s, t);
+  }
+  const float clamp = 7.90531110763549805f;
+  const float v     = select(x < -clamp, -clamp, select(x > clamp, clamp, x));
+  const float v2    = v * v;
+  float p           = -2.76076847742355e-16f;
+  p                 = p * v2 + 2.00018790482477e-13f;
+  p                 = p * v2 - 8.60467152213735e-11f;
+  p                 = p * v2 + 5.12229709037114e-08f;
+  p                 = p * v2 + 1.48572235717979e-05f;
+  p                 = p * v2 + 6.37261928875436e-04f;
+  p                 = p * v2 + 4.89352455891786e-03f;
+  float q           = 1.19825839466702e-06f;
+  q                 = q * v2 + 1.18534705686654e-04f;
+  q                 = q * v2 + 2.26843463243900e-03f;
+  q                 = q * v2 + 4.89352518554385e-03f;
+  const float t     = v * p / q;
+  return select(std::abs(x) < 4e-4f, x, t);
+}
+
+template <bool fast>
+inline float sigmoid(float x) {
+  return 1.0f / (1.0f + exp<fast>(-x));
+}
+
+/*!
+ * \brief erf, by the Taylor series below 0.5 and above by Abramowitz and Stegun 7.1.26, or 7.1.25
+ *        for the fast version.
+ */
+template <bool fast>
+inline float erf(float x) {
+  const float a = std::abs(x);
+  const float t = 1.0f / (1.0f + (fast ? 0.47047f : 0.3275911f) * a);
+  float p;
+  if (fast) {
+    p = 0.7478556f;
+    p = p * t - 0.0958798f;
+    p = p * t + 0.3480242f;
+  } else {
+    p = 1.061405429f;
+    p = p * t - 1.453152027f;
+    p = p * t + 1.421413741f;
+    p = p * t - 0.284496736f;
+    p = p * t + 0.254829592f;
+  }
+  const float l = 1.0f - p * t * exp<fast>(-a * a);
+  const float z = a * a;
+  float s       = 1.0f / 1320.0f;
+  s             = 1.0f / 216.0f - s * z;
+  s             = 1.0f / 42.0f - s * z;
+  s             = 0.1f - s * z;
+  s             = 1.0f / 3.0f - s * z;
+  s             = 1.0f - s * z;
+  const float h = 1.12837916709551257f * a * s;
+  return std::copysign(select(a < 0.5f, h, l), x);
+}
+
+template <bool fast>
+inline float gelu_erf(float x) {
+  return 0.5f * x * (1.0f + erf<fast>(x * 0.70710678118654752f));
+}
+
+/*! \brief Gradient of gelu_erf from its input x and output y */
+template <bool fast>
+inline float gelu_erf_grad(float x, float y) {
+  // erf'(z) = 2 / sqrt(pi) * exp(-z * z), at z = x / sqrt(2)
+  return y / x +
+         0.5f * x * 1.12837916709551257f * exp<fast>(-0.5f * x * x) * 0.70710678118654752f;
+}
+
+/*!
+ * \brief Float implementation of a primitive op of the CPU kernels built on the functions above,
+ *        taking over Map(float...) when value is set and MXNET_CPU_VECTORIZED_MATH is not 0.
+ *        Specializations provide a static Map<fast> with num_inputs float arguments.
+ */
+template <typename OP>
+struct vectorized_op {
+  static constexpr bool value     = false;
+  static constexpr int num_inputs = 0;
+};
+
+/*! \brief Whether all the types are pointers to float, const or not */
+template <typename... T>
+struct all_float_pointers : std::true_type {};
+
+template <typename T, typename... Rest>
+struct all_float_pointers<T, Rest...>
+    : std::integral_constant<bool,
+                             (std::is_same<T, float*>::value ||
+                              std::is_same<T, const float*>::value) &&
+                                 all_float_pointers<Rest...>::value> {};
+
+}  // namespace vmath
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_OPERATOR_VECTORIZED_MATH_INL_H_
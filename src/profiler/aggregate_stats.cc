@@ -24,12 +24,18 @@
 #include <dmlc/base.h>
 #include <dmlc/logging.h>
 #include <mxnet/base.h>
+#include <mxnet/storage.h>
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <thread>
 #include <iomanip>
 #include <queue>
+#include <sstream>
 #include <utility>
+#include <vector>
 #include "./profiler.h"
+#include "../engine/engine_stats.h"
 
 namespace mxnet {
 namespace profiler {
@@ -85,10 +91,49 @@ inline std::priority_queue<pi> BuildHeap(
   return heap;
 }
 
+/*! \brief Escape a label value of the OpenMetrics text format */
+inline std::string MetricLabel(const std::string& value) {
+  std::string escaped;
+  for (const char c : value) {
+    if (c == '\\' || c == '"') {
+      escaped += '\\';
+      escaped += c;
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+uint64_t AggregateStats::StatData::Quantile(double q) const {
+  uint64_t count = 0;
+  for (const uint64_t n : buckets_)
+    count += n;
+  if (count == 0)
+    return 0;
+  const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * count)));
+  uint64_t seen       = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      // the last duration of bucket i, the durations are integers
+      const uint64_t upper = i == 0 ? 0 : (uint64_t{1} << i) - 1;
+      return std::max(min_aggregate_, std::min(upper, max_aggregate_));
+    }
+  }
+  return max_aggregate_;
+}
+
 void AggregateStats::OnProfileStat(const ProfileStat& stat) {
   std::unique_lock<std::mutex> lk(m_);
   if (stat.enable_aggregate_) {
     stat.SaveAggregate(&stats_[stat.categories_.c_str()][stat.name_.c_str()]);
+    const std::string dispatch_name = stat.DispatchAggregateName();
+    if (!dispatch_name.empty()) {
+      stat.SaveAggregate(&stats_["Operator Dispatch"][dispatch_name]);
+    }
   }
 }
 
@@ -117,9 +162,12 @@ void AggregateStats::DumpTable(std::ostream& os, int sort_by, int ascending) {
        << " " << std::setw(16) << std::right << "-------------"
        << " " << std::setw(16) << std::right << "-------------" << std::endl;
     auto heap = BuildHeap(mm, sort_by, ascending);
+    std::vector<std::string> with_cost;
     while (!heap.empty()) {
       const std::string& name = heap.top().second;
       const StatData& data    = mm.at(name);
+      if (data.has_cost_)
+        with_cost.push_back(name);
       if (data.type_ == StatData::kDuration || data.type_ == StatData::kCounter) {
         os << std::setw(25) << std::left << name << std::setw(16) << std::right << data.total_count_
            << " " << std::fixed << (is_memory ? std::setw(0) : std::setw(16))
@@ -139,7 +187,28 @@ void AggregateStats::DumpTable(std::ostream& os, int sort_by, int ascending) {
       heap.pop();
     }
     os << std::endl;
+    if (!with_cost.empty()) {
+      os << type << " Roofline" << std::endl << "=================" << std::endl;
+      os << std::setw(25) << std::left << "Name" << std::setw(16) << std::right << "GFLOP/s"
+         << " " << std::setw(16) << std::right << "GB/s"
+         << " " << std::setw(16) << std::right << "FLOP/Byte" << std::endl;
+      os << std::setw(25) << std::left << "----" << std::setw(16) << std::right << "-------"
+         << " " << std::setw(16) << std::right << "----"
+         << " " << std::setw(16) << std::right << "---------" << std::endl;
+      for (const std::string& name : with_cost) {
+        const StatData& data = mm.at(name);
+        os << std::setw(25) << std::left << name << std::fixed << std::setprecision(4)
+           << std::setw(16) << std::right << data.GFlopsPerSec() << " " << std::setw(16)
+           << std::right << data.GBytesPerSec() << " " << std::setw(16) << std::right
+           << (data.total_bytes_ ? static_cast<double>(data.total_flops_) / data.total_bytes_ : 0)
+           << std::endl;
+      }
+      os << std::endl;
+    }
   }
+  const engine::EngineStats* engine_stats = engine::EngineStats::Get();
+  if (engine_stats->enabled())
+    engine_stats->DumpTable(os);
   os << std::flush;
   os.copyfmt(state);
 }
@@ -183,9 +252,14 @@ void AggregateStats::DumpJson(std::ostream& os, int sort_by, int ascending) {
             << "                \"Avg\": " << std::setprecision(4)
             << (data.type_ == AggregateStats::StatData::kCounter ?
                     ByteToKilobyte((data.max_aggregate_ - data.min_aggregate_) / 2) :
-                    MicroToMilli(static_cast<double>(data.total_aggregate_) / data.total_count_))
-            << std::endl
-            << "            }" << std::endl;
+                    MicroToMilli(static_cast<double>(data.total_aggregate_) / data.total_count_));
+        if (data.has_cost_) {
+          *ss << "," << std::endl
+              << "                \"GFLOP/s\": " << std::setprecision(4) << data.GFlopsPerSec()
+              << "," << std::endl
+              << "                \"GB/s\": " << std::setprecision(4) << data.GBytesPerSec();
+        }
+        *ss << std::endl << "            }" << std::endl;
       }
       heap.pop();
     }
@@ -198,6 +272,12 @@ void AggregateStats::DumpJson(std::ostream& os, int sort_by, int ascending) {
      << "    \"Memory\": {" << std::endl
      << memory_ss.str() << "    }" << std::endl
      << "," << std::endl
+     << "    \"Engine\": ";
+  engine::EngineStats::Get()->DumpJson(os);
+  os << std::endl
+     << "    ," << std::endl
+     << "    \"Storage\": " << Storage::Get()->GetStats() << std::endl
+     << "    ," << std::endl
      << "    \"Unit\": {" << std::endl
      << R"(        "Time": "ms",)" << std::endl
      << R"(        "Memory": "kB")" << std::endl
@@ -207,9 +287,69 @@ void AggregateStats::DumpJson(std::ostream& os, int sort_by, int ascending) {
   os.copyfmt(state);
 }
 
+void AggregateStats::DumpOpenMetrics(std::ostream& os) {
+  std::ostringstream durations, counters, comm_bytes, op_flops, op_bytes;
+  {
+    std::unique_lock<std::mutex> lk(m_);
+    for (const auto& stat : stats_) {
+      const std::string category = MetricLabel(stat.first);
+      for (const auto& iter : stat.second) {
+        const StatData& data     = iter.second;
+        const std::string labels = "category=\"" + category + "\",name=\"" +
+                                   MetricLabel(iter.first) + "\"";
+        if (data.type_ == StatData::kDuration) {
+          for (const double q : {0.5, 0.99}) {
+            durations << "mxnet_profile_duration_microseconds{" << labels << ",quantile=\"" << q
+                      << "\"} " << data.Quantile(q) << "\n";
+          }
+          durations << "mxnet_profile_duration_microseconds_sum{" << labels << "} "
+                    << data.total_aggregate_ << "\n"
+                    << "mxnet_profile_duration_microseconds_count{" << labels << "} "
+                    << data.total_count_ << "\n";
+          if (stat.first == "kvstore") {
+            comm_bytes << "mxnet_kvstore_bytes_total{name=\"" << MetricLabel(iter.first)
+                       << "\"} " << data.total_bytes_ << "\n";
+          }
+          if (stat.first == "operator" && data.has_cost_) {
+            op_flops << "mxnet_operator_flops_total{name=\"" << MetricLabel(iter.first)
+                     << "\"} " << data.total_flops_ << "\n";
+            op_bytes << "mxnet_operator_bytes_total{name=\"" << MetricLabel(iter.first)
+                     << "\"} " << data.total_bytes_ << "\n";
+          }
+        } else if (data.type_ == StatData::kCounter) {
+          counters << "mxnet_profile_counter{" << labels << "} " << data.total_aggregate_ << "\n";
+        }
+      }
+    }
+  }
+  os << "# TYPE mxnet_profile_duration_microseconds summary\n"
+     << "# UNIT mxnet_profile_duration_microseconds microseconds\n"
+     << "# HELP mxnet_profile_duration_microseconds Duration of the profiled operations.\n";
+  os << durations.str();
+  os << "# TYPE mxnet_profile_counter gauge\n"
+     << "# HELP mxnet_profile_counter Current value of the profiled counters and memory.\n";
+  os << counters.str();
+  os << "# TYPE mxnet_kvstore_bytes counter\n"
+     << "# UNIT mxnet_kvstore_bytes bytes\n"
+     << "# HELP mxnet_kvstore_bytes Bytes communicated by the kvstore.\n";
+  os << comm_bytes.str();
+  os << "# TYPE mxnet_operator_flops counter\n"
+     << "# HELP mxnet_operator_flops Floating point operations of the operators.\n";
+  os << op_flops.str();
+  os << "# TYPE mxnet_operator_bytes counter\n"
+     << "# UNIT mxnet_operator_bytes bytes\n"
+     << "# HELP mxnet_operator_bytes Bytes read and written by the operators.\n";
+  os << op_bytes.str();
+  const engine::EngineStats* engine_stats = engine::EngineStats::Get();
+  if (engine_stats->enabled())
+    engine_stats->DumpOpenMetrics(os);
+  os << Storage::Get()->GetMetrics() << "# EOF" << std::endl;
+}
+
 void AggregateStats::clear() {
   std::unique_lock<std::mutex> lk(m_);
   stats_.clear();
+  engine::EngineStats::Get()->Reset();
 }
 
 }  // namespace profiler
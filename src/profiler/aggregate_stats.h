@@ -20,6 +20,7 @@
 #ifndef MXNET_PROFILER_AGGREGATE_STATS_H_
 #define MXNET_PROFILER_AGGREGATE_STATS_H_
 
+#include <array>
 #include <string>
 #include <map>
 #include <cstdint>
@@ -40,11 +41,47 @@ class AggregateStats {
      */
     enum StatType { kDuration = 1, kCounter = 2, kOther = 4 };
 
+    /*! \brief number of buckets of the duration histogram */
+    static constexpr int kNumBuckets = 32;
+
     StatType type_            = kOther;
     size_t total_count_       = 0;
     uint64_t total_aggregate_ = 0;
     uint64_t max_aggregate_   = 0;
     uint64_t min_aggregate_   = INT_MAX;
+    /*!
+     * \brief durations in us with power of two buckets: bucket 0 counts 0, bucket i counts
+     *        [2^(i-1), 2^i), the last bucket also counts everything above
+     */
+    std::array<uint64_t, kNumBuckets> buckets_{};
+    /*! \brief bytes communicated by kvstore communications, or read and written by operators */
+    uint64_t total_bytes_ = 0;
+    /*! \brief floating point operations of the operators */
+    uint64_t total_flops_ = 0;
+    /*! \brief whether the operators reported their work, see FOpCost */
+    bool has_cost_ = false;
+
+    /*! \brief count a duration in the histogram */
+    inline void AddToHistogram(uint64_t duration) {
+      int bucket = 0;
+      for (uint64_t v = duration; v != 0 && bucket < kNumBuckets - 1; v >>= 1)
+        ++bucket;
+      ++buckets_[bucket];
+    }
+    /*!
+     * \brief Estimate a quantile of the durations from the histogram
+     * \param q quantile in [0, 1]
+     * \return upper bound of the bucket of the quantile, capped by the maximum duration
+     */
+    uint64_t Quantile(double q) const;
+    /*! \brief achieved floating point operations per second, in GFLOP/s */
+    inline double GFlopsPerSec() const {
+      return total_aggregate_ ? static_cast<double>(total_flops_) / total_aggregate_ / 1e3 : 0;
+    }
+    /*! \brief achieved memory bandwidth, in GB/s */
+    inline double GBytesPerSec() const {
+      return total_aggregate_ ? static_cast<double>(total_bytes_) / total_aggregate_ / 1e3 : 0;
+    }
   };
 
   /*!
@@ -64,6 +101,11 @@ class AggregateStats {
    * \param ascending whether to sort ascendingly
    */
   void DumpJson(std::ostream& os, int sort_by, int ascending);
+  /*!
+   * \brief Print the statistics, the engine counters and the memory pool counters in the
+   *        OpenMetrics text format, to be scraped while the profiler keeps running
+   */
+  void DumpOpenMetrics(std::ostream& os);
   /*!
    * \brief Delete all of the current statistics
    */
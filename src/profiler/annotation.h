@@ -0,0 +1,133 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file annotation.h
+ * \brief Named ranges for external timeline tools: NVTX (Nsight Systems) and ITT (VTune)
+ */
+#ifndef MXNET_PROFILER_ANNOTATION_H_
+#define MXNET_PROFILER_ANNOTATION_H_
+
+#include <dmlc/parameter.h>
+#include <string>
+#include <unordered_map>
+#include "../common/cuda/nvtx.h"
+#include "./vtune.h"
+
+namespace mxnet {
+namespace profiler {
+
+#if (MXNET_USE_CUDA && MXNET_USE_NVTX) || MXNET_USE_VTUNE
+#define MXNET_USE_ANNOTATIONS 1
+#else
+#define MXNET_USE_ANNOTATIONS 0
+#endif
+
+/*!
+ * \brief Scoped range shown on the timeline of the thread that opens it, as an NVTX range and an
+ *        ITT task, whichever the build supports. Independent from the mxnet profiler state.
+ */
+class AnnotationRange {
+ public:
+  explicit AnnotationRange(const std::string& name) {
+#if MXNET_USE_ANNOTATIONS
+    active_ = Enabled();
+    if (active_)
+      Start(name);
+#endif
+  }
+
+  /*! \brief Literal names are only copied when the range is emitted */
+  explicit AnnotationRange(const char* name) {
+#if MXNET_USE_ANNOTATIONS
+    active_ = Enabled();
+    if (active_)
+      Start(name);
+#endif
+  }
+
+  ~AnnotationRange() {
+#if MXNET_USE_ANNOTATIONS
+    if (active_)
+      Stop();
+#endif
+  }
+
+  AnnotationRange(const AnnotationRange&) = delete;
+  AnnotationRange& operator=(const AnnotationRange&) = delete;
+
+  /*!
+   * \brief Whether ranges are emitted. MXNET_PROFILER_ANNOTATIONS forces it, by default they are
+   *        on when an NVTX or ITT collector is attached to the process. Read once.
+   */
+  static bool Enabled() {
+#if MXNET_USE_ANNOTATIONS
+    static const bool enabled =
+        dmlc::GetEnv("MXNET_PROFILER_ANNOTATIONS",
+                     dmlc::GetEnv("NVTX_INJECTION64_PATH", std::string()).size() > 0 ||
+                         dmlc::GetEnv("INTEL_LIBITTNOTIFY64", std::string()).size() > 0);
+    return enabled;
+#else
+    return false;
+#endif
+  }
+
+ private:
+#if MXNET_USE_ANNOTATIONS
+  static void Start(const std::string& name) {
+#if MXNET_USE_CUDA && MXNET_USE_NVTX
+    // ranges of the same kind share a color: the prefix before the attributes, e.g. "[op{..."
+    const size_t end_pos = name.find('{');
+    common::cuda::nvtx::gpuRangeStart(
+        common::cuda::nvtx::nameToColor(name, end_pos != std::string::npos ? end_pos : name.size()),
+        name);
+#endif
+#if MXNET_USE_VTUNE
+    // string handles are interned by the collector, cache them to skip its global lookup
+    static thread_local std::unordered_map<std::string, __itt_string_handle*> handles;
+    __itt_string_handle*& handle = handles[name];
+    if (handle == nullptr)
+      handle = __itt_string_handle_create(name.c_str());
+    __itt_task_begin(Domain(), __itt_null, __itt_null, handle);
+#endif
+  }
+
+  static void Stop() {
+#if MXNET_USE_VTUNE
+    __itt_task_end(Domain());
+#endif
+#if MXNET_USE_CUDA && MXNET_USE_NVTX
+    common::cuda::nvtx::gpuRangeStop();
+#endif
+  }
+
+#if MXNET_USE_VTUNE
+  static __itt_domain* Domain() {
+    static vtune::VTuneDomain domain("MXNet");
+    return domain.dom();
+  }
+#endif
+
+  bool active_;
+#endif  // MXNET_USE_ANNOTATIONS
+};
+
+}  // namespace profiler
+}  // namespace mxnet
+#endif  // MXNET_PROFILER_ANNOTATION_H_
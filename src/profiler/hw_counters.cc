@@ -0,0 +1,123 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file hw_counters.cc
+ * \brief Hardware performance counters of the calling thread, read through perf_event_open
+ */
+#include "./hw_counters.h"
+
+#include <dmlc/logging.h>
+#include <dmlc/thread_local.h>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace mxnet {
+namespace profiler {
+
+namespace {
+
+/*! \brief Warn once that the counters are not available */
+void WarnUnavailable(const char* reason) {
+  static std::atomic<bool> warned{false};
+  if (!warned.exchange(true)) {
+    LOG(WARNING) << "Hardware counters are not recorded: " << reason;
+  }
+}
+
+#if defined(__linux__)
+int OpenCounter(uint64_t config, int group_fd) {
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.type   = PERF_TYPE_HARDWARE;
+  attr.size   = sizeof(attr);
+  attr.config = config;
+  // only user space, which is what perf_event_paranoid allows unprivileged users
+  attr.exclude_kernel = 1;
+  attr.exclude_hv     = 1;
+  attr.read_format    = PERF_FORMAT_GROUP;
+  // the calling thread, on any CPU
+  return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+#endif
+
+}  // namespace
+
+HwCounters* HwCounters::Get() {
+  return dmlc::ThreadLocalStore<HwCounters>::Get();
+}
+
+HwCounters::~HwCounters() {
+#if defined(__linux__)
+  for (int fd : fds_) {
+    if (fd != -1)
+      close(fd);
+  }
+#endif
+}
+
+void HwCounters::Open() {
+  opened_ = true;
+#if defined(__linux__)
+  const uint64_t configs[kNumCounters] = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES};
+  for (int i = 0; i < kNumCounters; ++i) {
+    fds_[i] = OpenCounter(configs[i], fds_[0]);
+    if (fds_[i] == -1) {
+      WarnUnavailable(strerror(errno));
+      for (int j = 0; j < i; ++j) {
+        close(fds_[j]);
+        fds_[j] = -1;
+      }
+      return;
+    }
+  }
+#else
+  WarnUnavailable("perf_event_open is only available on Linux");
+#endif
+}
+
+HwCounterValues HwCounters::Read() {
+  if (!opened_)
+    Open();
+  HwCounterValues values;
+#if defined(__linux__)
+  if (fds_[0] == -1)
+    return values;
+  // PERF_FORMAT_GROUP: the number of counters, then their values in the order they were opened
+  uint64_t data[1 + kNumCounters];
+  if (read(fds_[0], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) ||
+      data[0] != kNumCounters)
+    return values;
+  values.valid_        = true;
+  values.cycles_       = data[1];
+  values.instructions_ = data[2];
+  values.llc_misses_   = data[3];
+#endif
+  return values;
+}
+
+}  // namespace profiler
+}  // namespace mxnet
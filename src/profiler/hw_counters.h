@@ -0,0 +1,84 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file hw_counters.h
+ * \brief Hardware performance counters of the calling thread, read through perf_event_open
+ */
+#ifndef MXNET_PROFILER_HW_COUNTERS_H_
+#define MXNET_PROFILER_HW_COUNTERS_H_
+
+#include <cstdint>
+
+namespace mxnet {
+namespace profiler {
+
+/*!
+ * \brief Values of the hardware counters, or their increase over a profiled operator
+ */
+struct HwCounterValues {
+  /*! \brief whether the counters could be read */
+  bool valid_ = false;
+  /*! \brief CPU cycles */
+  uint64_t cycles_ = 0;
+  /*! \brief retired instructions */
+  uint64_t instructions_ = 0;
+  /*! \brief misses of the last level cache */
+  uint64_t llc_misses_ = 0;
+
+  /*! \brief increase of the counters since an earlier read */
+  HwCounterValues operator-(const HwCounterValues& start) const {
+    HwCounterValues diff;
+    diff.valid_        = valid_ && start.valid_;
+    diff.cycles_       = cycles_ - start.cycles_;
+    diff.instructions_ = instructions_ - start.instructions_;
+    diff.llc_misses_   = llc_misses_ - start.llc_misses_;
+    return diff;
+  }
+};
+
+/*!
+ * \brief Counts the cycles, instructions and last level cache misses of the calling thread in
+ *  user space. The counters of a thread are opened on its first read. Where perf_event_open is
+ *  not available or not permitted (see /proc/sys/kernel/perf_event_paranoid), the reads are
+ *  invalid and a warning is logged once.
+ */
+class HwCounters {
+ public:
+  HwCounters() = default;
+  ~HwCounters();
+  /*! \brief Counters of the calling thread */
+  static HwCounters* Get();
+  /*! \brief Read the counters of the calling thread */
+  HwCounterValues Read();
+
+ private:
+  /*! \brief Open the group of counters of the calling thread */
+  void Open();
+  /*! \brief number of counters of the group */
+  static constexpr int kNumCounters = 3;
+  /*! \brief whether Open was called */
+  bool opened_ = false;
+  /*! \brief file descriptors of the counters, the first one leads the group, -1 if not open */
+  int fds_[kNumCounters] = {-1, -1, -1};
+};
+
+}  // namespace profiler
+}  // namespace mxnet
+#endif  // MXNET_PROFILER_HW_COUNTERS_H_
@@ -42,6 +42,15 @@ namespace profiler {
 
 ProfileDomain ProfileOperator::domain_("operator");
 
+OprDispatchInfo* OprDispatchInfo::Get() {
+#if DMLC_CXX11_THREAD_LOCAL
+  static thread_local OprDispatchInfo info;
+#else
+  static MX_THREAD_LOCAL OprDispatchInfo info;
+#endif
+  return &info;
+}
+
 Profiler::Profiler()
     : state_(kNotRunning),
       enable_output_(false),
@@ -127,11 +136,21 @@ void Profiler::SetConfig(int mode,
                          std::string output_filename,
                          bool continuous_dump,
                          float dump_period,
-                         bool aggregate_stats) {
+                         bool aggregate_stats,
+                         int sample_period,
+                         size_t max_pending_records,
+                         bool hw_counters,
+                         int step_report_period) {
   CHECK(!continuous_dump || dump_period > 0);
+  CHECK_GE(sample_period, 1);
   std::lock_guard<std::recursive_mutex> lock{this->m_};
-  this->mode_     = mode;
-  this->filename_ = output_filename;
+  this->mode_                = mode;
+  this->filename_            = output_filename;
+  this->sample_period_       = sample_period;
+  this->max_pending_records_ = max_pending_records;
+  this->hw_counters_         = hw_counters;
+  this->step_stats_ =
+      step_report_period > 0 ? std::make_shared<StepStats>(step_report_period) : nullptr;
   // Remove the output file to start
   if (!this->filename_.empty()) {
     ::unlink(this->filename_.c_str());
@@ -173,7 +192,11 @@ void Profiler::DumpProfile(bool perform_cleanup) {
   std::ofstream file;
   const bool first_pass = ++profile_dump_count_ == 1;
   const bool last_pass  = perform_cleanup || !continuous_dump_;
-  if (!first_pass && continuous_dump_) {
+  // without a file name the records only feed the aggregate stats, the stream is left closed
+  const bool write_trace = !filename_.empty();
+  if (!write_trace) {
+    file.setstate(std::ios::badbit);
+  } else if (!first_pass && continuous_dump_) {
     file.open(filename_, std::ios::app | std::ios::out);
   } else {
     file.open(filename_, std::ios::trunc | std::ios::out);
@@ -205,10 +228,13 @@ void Profiler::DumpProfile(bool perform_cleanup) {
     ProfileStat* _opr_stat;
     while (d.opr_exec_stats_->try_dequeue(_opr_stat)) {
       CHECK_NOTNULL(_opr_stat);
+      d.num_pending_.fetch_sub(1, std::memory_order_relaxed);
       std::unique_ptr<ProfileStat> opr_stat(_opr_stat);  // manage lifecycle
       opr_stat->process_id_ = i;  // lie and set process id to be the device number
-      file << ",\n" << std::endl;
-      opr_stat->EmitEvents(&file);
+      if (write_trace) {
+        file << ",\n" << std::endl;
+        opr_stat->EmitEvents(&file);
+      }
       ++num_records_emitted_;
       if (ptr_aggregate_stats) {
         ptr_aggregate_stats->OnProfileStat(*_opr_stat);
@@ -220,6 +246,7 @@ void Profiler::DumpProfile(bool perform_cleanup) {
   ProfileStat* _profile_stat;
   while (general_stats_.opr_exec_stats_->try_dequeue(_profile_stat)) {
     CHECK_NOTNULL(_profile_stat);
+    general_stats_.num_pending_.fetch_sub(1, std::memory_order_relaxed);
     file << ",";
     std::unique_ptr<ProfileStat> profile_stat(_profile_stat);  // manage lifecycle
     CHECK_NE(profile_stat->categories_.c_str()[0], '\0') << "Category must be set";
@@ -234,8 +261,10 @@ void Profiler::DumpProfile(bool perform_cleanup) {
       file << ",\n";
     }
     profile_stat->process_id_ = iter->second;
-    file << std::endl;
-    profile_stat->EmitEvents(&file);
+    if (write_trace) {
+      file << std::endl;
+      profile_stat->EmitEvents(&file);
+    }
     ++num_records_emitted_;
     if (ptr_aggregate_stats) {
       ptr_aggregate_stats->OnProfileStat(*profile_stat);
@@ -243,6 +272,10 @@ void Profiler::DumpProfile(bool perform_cleanup) {
   }
 
   if (last_pass) {
+    if (NumRecordsDropped()) {
+      LOG(WARNING) << NumRecordsDropped() << " profile records were dropped, the dumps did not "
+                   << "keep up with max_pending_records";
+    }
     file << "\n" << std::endl;
     file << "    ]," << std::endl;
     file << R"(    "displayTimeUnit": "ms")" << std::endl;
@@ -32,8 +32,11 @@
 #include <mutex>
 #include <memory>
 #include <array>
+#include <atomic>
 #include "./vtune.h"
 #include "./aggregate_stats.h"
+#include "./hw_counters.h"
+#include "./step_stats.h"
 #include "../common/cuda/nvtx.h"
 #include "../common/utils.h"
 
@@ -194,6 +197,24 @@ struct ProfileStat {
     }
   }
 
+  /*!
+   * \brief Get the start and stop time of the stat
+   * \param start Start time in microseconds
+   * \param stop Stop time in microseconds
+   * \return false if the stat is not a duration
+   */
+  virtual bool GetDuration(uint64_t* start, uint64_t* stop) const {
+    return false;
+  }
+
+  /*!
+   * \brief Name under which the stat is also aggregated in the operator dispatch table
+   * \return The name, empty if the stat is not aggregated there
+   */
+  virtual std::string DispatchAggregateName() const {
+    return std::string();
+  }
+
  protected:
   /*!
    * \brief Override to emit extra items within the json event data block. Append with a comma ",".
@@ -246,6 +267,8 @@ struct DeviceStats {
   std::string dev_name_;
   /*! \brief operation execution statistics on this device */
   std::shared_ptr<TQueue> opr_exec_stats_ = std::make_shared<TQueue>();
+  /*! \brief number of statistics in the queue, waiting for the next dump */
+  std::atomic<size_t> num_pending_{0};
 };
 
 /*!
@@ -277,12 +300,23 @@ class Profiler {
    * \param output_filename profile output file name
    * \param continuous_dump true if profile information should be periodically dumped
    * \param dump_period Period (in seconds) of profile info dumping
+   * \param aggregate_stats true if aggregate stats are maintained
+   * \param sample_period Record one operator out of every sample_period
+   * \param max_pending_records Bound of the records of a device waiting for the next dump,
+   *        the ones over it are dropped. Zero for no bound.
+   * \param hw_counters true if CPU operators record hardware counters
+   * \param step_report_period Number of training steps summarized by a step breakdown report,
+   *        zero for no report
    */
   void SetConfig(int mode,
                  std::string output_filename,
                  bool continuous_dump,
                  float dump_period,
-                 bool aggregate_stats);
+                 bool aggregate_stats,
+                 int sample_period          = 1,
+                 size_t max_pending_records = 0,
+                 bool hw_counters           = false,
+                 int step_report_period     = 0);
 
   /*! \return mode of profiler */
   inline int GetMode() const {
@@ -293,6 +327,43 @@ class Profiler {
     return GetState() == kRunning && (GetMode() & pm) == pm;
   }
 
+  /*!
+   * \brief Whether to record the operator, or the graph execution, being pushed: one out of every
+   *        sample_period pushed by the calling thread. The count is per thread, so that the
+   *        operators left out cost no lock or atomic operation.
+   */
+  inline bool IsSampled() const {
+    if (sample_period_ <= 1) {
+      return true;
+    }
+#if DMLC_CXX11_THREAD_LOCAL
+    static thread_local uint64_t num_pushed = 0;
+#else
+    static MX_THREAD_LOCAL uint64_t num_pushed = 0;
+#endif
+    return ++num_pushed % sample_period_ == 0;
+  }
+
+  /*!
+   * \brief Mark the end of a training step
+   * \return The breakdown of the wall time of the last step_report_period steps, every
+   *         step_report_period steps, else empty
+   */
+  std::string MarkStep() {
+    std::shared_ptr<StepStats> step_stats = step_stats_;
+    return step_stats ? step_stats->MarkStep() : std::string();
+  }
+
+  /*! \return whether CPU operators record hardware counters */
+  inline bool HwCountersEnabled() const {
+    return hw_counters_;
+  }
+
+  /*! \return Number of records dropped because max_pending_records were waiting */
+  inline uint64_t NumRecordsDropped() const {
+    return num_records_dropped_.load(std::memory_order_relaxed);
+  }
+
   /*! \return whether the profiler is enabled to output */
   inline bool IsEnableOutput() const {
     return this->enable_output_;
@@ -435,7 +506,29 @@ class Profiler {
    */
   template <typename StatType>
   inline void AddProfileStat(std::unique_ptr<StatType>* stat) {
-    general_stats_.opr_exec_stats_->enqueue(stat->release());
+    EnqueueProfileStat(&general_stats_, stat->release());
+  }
+
+  /*!
+   * \brief Queue a statistic object until the next dump, or drop it when the queue of the device
+   *        already holds max_pending_records of them, which bounds the memory of the profiler
+   *        when the dumps do not keep up
+   * \param dev_stat Statistics of the device
+   * \param stat The statistic object, owned by the queue or deleted
+   */
+  inline void EnqueueProfileStat(DeviceStats* dev_stat, ProfileStat* stat) {
+    std::shared_ptr<StepStats> step_stats = step_stats_;
+    if (step_stats) {
+      step_stats->OnProfileStat(*stat);
+    }
+    const size_t pending = dev_stat->num_pending_.fetch_add(1, std::memory_order_relaxed);
+    if (max_pending_records_ && pending >= max_pending_records_) {
+      dev_stat->num_pending_.fetch_sub(1, std::memory_order_relaxed);
+      num_records_dropped_.fetch_add(1, std::memory_order_relaxed);
+      delete stat;
+      return;
+    }
+    dev_stat->opr_exec_stats_->enqueue(stat);
   }
 
   /*! \brief generate device information following chrome profile file format */
@@ -478,9 +571,19 @@ class Profiler {
   volatile uint64_t profile_dump_count_;
   /*! \brief Whether profiling is paused */
   volatile bool paused_ = false;
+  /*! \brief Record one operator out of every sample_period_ */
+  volatile int sample_period_ = 1;
+  /*! \brief Bound of the records queued per device, zero for none */
+  volatile size_t max_pending_records_ = 0;
+  /*! \brief Whether CPU operators record hardware counters */
+  volatile bool hw_counters_ = false;
+  /*! \brief Number of records dropped because the queue of their device was full */
+  std::atomic<uint64_t> num_records_dropped_{0};
   /*! \brief Maintain in-memory aggregate stats for print output.
    *  \warning This has a negative performance impact */
   std::shared_ptr<AggregateStats> aggregate_stats_ = nullptr;
+  /*! \brief Breakdown of the training steps, if reported */
+  std::shared_ptr<StepStats> step_stats_ = nullptr;
   /*! \brief Asynchronous operation thread lifecycle control object */
   std::shared_ptr<dmlc::ThreadGroup> thread_group_ = std::make_shared<dmlc::ThreadGroup>();
   /* !\brief pids */
@@ -755,6 +858,7 @@ class ProfileDuration : public ProfileObject {
         CHECK_GE(items_[kStop].timestamp_, items_[kStart].timestamp_);
         const uint64_t duration = items_[kStop].timestamp_ - items_[kStart].timestamp_;
         data->total_aggregate_ += duration;
+        data->AddToHistogram(duration);
         if (duration > data->max_aggregate_) {
           data->max_aggregate_ = duration;
         }
@@ -763,6 +867,12 @@ class ProfileDuration : public ProfileObject {
         }
       }
     }
+
+    bool GetDuration(uint64_t* start, uint64_t* stop) const override {
+      *start = items_[kStart].timestamp_;
+      *stop  = items_[kStop].timestamp_;
+      return true;
+    }
   };
 };
 
@@ -1026,6 +1136,114 @@ struct ProfileFrame : public ProfileDuration {
   uint64_t start_time_;
 };
 
+/*!
+ * \brief Comm - Asynchronous time block of the communication of a kvstore key, shown
+ *        with the key and the number of bytes communicated
+ */
+struct ProfileComm : public ProfileDuration {
+  /*!
+   * \brief Constructor
+   * \param name Name of the communication, i.e. push, pull, reduce, broadcast or update
+   * \param key Key communicated
+   * \param bytes Number of bytes communicated
+   */
+  ProfileComm(const char* name, int key, size_t bytes) : name_(name), key_(key), bytes_(bytes) {}
+
+  /*!
+   * \brief Start a communication if the profiler is running
+   * \return The communication to stop once done, or null if the profiler is not running
+   * \note The communication may stop on another thread than the one it started on
+   */
+  static std::shared_ptr<ProfileComm> Start(const char* name, int key, size_t bytes) {
+    if (Profiler::Get()->GetState() != Profiler::kRunning) {
+      return nullptr;
+    }
+    auto comm = std::make_shared<ProfileComm>(name, key, bytes);
+    comm->start();
+    return comm;
+  }
+
+  /*!
+   * \brief Start the profiling scope
+   */
+  void start() override {
+    start_time_ = ProfileStat::NowInMicrosec();
+  }
+
+  /*!
+   * \brief Stop the profiling scope
+   */
+  void stop() override {
+    SendStat();
+  }
+
+  ProfileObjectType type() const override {
+    return kEvent;
+  }
+
+ protected:
+  /*!
+   * \brief Communication statistic object
+   */
+  struct ProfileCommStat : public DurationStat {
+    ProfileCommStat(const char* name,
+                    int key,
+                    size_t bytes,
+                    uint64_t start_time,
+                    uint64_t stop_time,
+                    uint64_t id)
+        : DurationStat(ProfileStat::kAsyncNestableStart, ProfileStat::kAsyncNestableEnd),
+          key_(key),
+          bytes_(bytes),
+          id_(id) {
+      name_.set(name);
+      categories_.set("kvstore");
+      items_[kStart].timestamp_ = start_time;
+      items_[kStop].timestamp_  = stop_time;
+    }
+    void SaveAggregate(AggregateStats::StatData* data) const override {
+      DurationStat::SaveAggregate(data);
+      if (data) {
+        data->total_bytes_ += bytes_;
+      }
+    }
+    void EmitExtra(std::ostream* os, size_t idx) override {
+      DurationStat::EmitExtra(os, idx);
+      // communications overlap, each is a track of its own
+      *os << "        \"id\": " << id_ << ",\n";
+      if (idx == kStart) {
+        *os << "        \"args\": {\"key\": " << key_ << ", \"bytes\": " << bytes_ << "},\n";
+      }
+    }
+    int key_;
+    size_t bytes_;
+    uint64_t id_;
+  };
+
+ private:
+  /*!
+   * \brief Send this object's statistical datapoint to the profiler
+   */
+  void SendStat() {
+    static std::atomic<uint64_t> next_id{0};
+    Profiler::Get()->AddNewProfileStat<ProfileCommStat>([](ProfileCommStat* stat) {},
+                                                        name_.c_str(),
+                                                        key_,
+                                                        bytes_,
+                                                        start_time_,
+                                                        ProfileStat::NowInMicrosec(),
+                                                        next_id++);
+  }
+  /*! \brief Communication name */
+  const profile_stat_string name_;
+  /*! \brief Key communicated */
+  int key_;
+  /*! \brief Number of bytes communicated */
+  size_t bytes_;
+  /*! \brief Communication start time */
+  uint64_t start_time_;
+};
+
 /*!
  * \brief Marker - Mark an instance in time
  */
@@ -1127,6 +1345,69 @@ struct ProfileMarker {
 
 static ProfileDomain custom_op_domain("Custom Operator");
 
+/*!
+ * \brief How the operator running on the calling thread was dispatched, e.g. to oneDNN or to
+ *  the native kernel, and the work it did. The backends fill it in while a profiled operator
+ *  runs, and it is attached to the event of the operator in the trace and in the aggregate
+ *  statistics.
+ */
+struct OprDispatchInfo {
+  /*! \brief whether a profiled operator runs on this thread */
+  bool active_ = false;
+  /*! \brief name of the running operator */
+  profile_stat_string op_name_;
+  /*! \brief backend that ran the operator, e.g. "onednn", "onednn_subgraph" or "native" */
+  profile_stat_string backend_;
+  /*! \brief implementation of the primitive that ran, e.g. "jit:avx512_core" */
+  profile_stat_string impl_;
+  /*! \brief why the operator ran its native kernel instead of oneDNN */
+  profile_stat_string fallback_reason_;
+  /*! \brief whether the operator reported its work, see FOpCost */
+  bool has_cost_ = false;
+  /*! \brief floating point operations of the operator */
+  uint64_t flops_ = 0;
+  /*! \brief bytes read and written by the operator */
+  uint64_t bytes_ = 0;
+
+  /*!
+   * \brief Get the dispatch record of the calling thread
+   */
+  static OprDispatchInfo* Get();
+
+  /*!
+   * \brief Start recording for an operator
+   * \param op_name Name of the operator
+   */
+  void Begin(const char* op_name) {
+    active_ = true;
+    op_name_.set(op_name);
+    backend_.set("");
+    impl_.set("");
+    fallback_reason_.set("");
+    has_cost_ = false;
+    flops_    = 0;
+    bytes_    = 0;
+  }
+
+  /*!
+   * \brief Add work done by the operator, the work of bulked operators adds up
+   * \param flops Floating point operations
+   * \param bytes Bytes read and written
+   */
+  void AddCost(uint64_t flops, uint64_t bytes) {
+    has_cost_ = true;
+    flops_ += flops;
+    bytes_ += bytes;
+  }
+
+  /*!
+   * \brief Stop recording
+   */
+  void End() {
+    active_ = false;
+  }
+};
+
 /*!
  * \brief Operator profiler object. Logs as both an independent event and a task in
  * the operator domain
@@ -1198,6 +1479,10 @@ struct ProfileOperator : public ProfileEvent {
     dev_type_ = dev_type;
     dev_id_   = dev_id;
     if (profiling_) {
+      OprDispatchInfo::Get()->Begin(name_.c_str());
+      if (dev_type == Context::kCPU && Profiler::Get()->HwCountersEnabled()) {
+        hw_counters_ = HwCounters::Get()->Read();
+      }
       ProfileEvent::start();
       as_task_.start();
     }
@@ -1207,6 +1492,21 @@ struct ProfileOperator : public ProfileEvent {
    */
   void stop() override {
     if (profiling_) {
+      OprDispatchInfo* dispatch = OprDispatchInfo::Get();
+      // asynchronous operators may complete on another thread, whose record is not theirs
+      if (dispatch->active_ && strcmp(dispatch->op_name_.c_str(), name_.c_str()) == 0) {
+        if (hw_counters_.valid_) {
+          hw_counters_ = HwCounters::Get()->Read() - hw_counters_;
+        }
+        dispatch_ = *dispatch;
+        if (dev_type_ == Context::kCPU && dispatch_.backend_.c_str()[0] == '\0') {
+          dispatch_.backend_.set("native");
+        }
+        dispatch->End();
+      } else {
+        // the counters of another thread than the one that started
+        hw_counters_.valid_ = false;
+      }
       as_task_.stop();
       ProfileEvent::stop();
     }
@@ -1244,11 +1544,63 @@ struct ProfileOperator : public ProfileEvent {
       }
       items_[kStart].timestamp_ = start_time;
       items_[kStop].timestamp_  = stop_time;
+      op_name_.set(name);
+    }
+
+    void SaveAggregate(AggregateStats::StatData* data) const override {
+      DurationStat::SaveAggregate(data);
+      if (data && dispatch_.has_cost_) {
+        data->has_cost_ = true;
+        data->total_flops_ += dispatch_.flops_;
+        data->total_bytes_ += dispatch_.bytes_;
+      }
     }
+
+    std::string DispatchAggregateName() const override {
+      if (dispatch_.backend_.c_str()[0] == '\0') {
+        return std::string();
+      }
+      std::string name = std::string(op_name_.c_str()) + " [" + dispatch_.backend_.c_str();
+      if (dispatch_.impl_.c_str()[0] != '\0') {
+        name = name + " " + dispatch_.impl_.c_str();
+      }
+      if (dispatch_.fallback_reason_.c_str()[0] != '\0') {
+        name = name + ", " + dispatch_.fallback_reason_.c_str();
+      }
+      return name + "]";
+    }
+
     /*! \brief device type: CPU: 1, GPU: 2, CPUPinned: 3 */
     mxnet::Context::DeviceType dev_type_;
     /*! \brief device id */
     uint32_t dev_id_;
+    /*! \brief operator name without the attributes */
+    profile_stat_string op_name_;
+    /*! \brief how the operator was dispatched, empty backend if unknown */
+    OprDispatchInfo dispatch_;
+    /*! \brief increase of the hardware counters while the operator ran */
+    HwCounterValues hw_counters_;
+
+   protected:
+    void EmitExtra(std::ostream* os, size_t idx) override {
+      DurationStat::EmitExtra(os, idx);
+      const bool has_dispatch = dispatch_.backend_.c_str()[0] != '\0';
+      if (idx != kStart || (!has_dispatch && !hw_counters_.valid_)) {
+        return;
+      }
+      *os << "        \"args\": {";
+      if (has_dispatch) {
+        *os << "\"backend\": \"" << dispatch_.backend_.c_str() << "\", \"impl\": \""
+            << dispatch_.impl_.c_str() << "\", \"fallback_reason\": \""
+            << dispatch_.fallback_reason_.c_str() << "\"";
+      }
+      if (hw_counters_.valid_) {
+        *os << (has_dispatch ? ", " : "") << "\"cycles\": " << hw_counters_.cycles_
+            << ", \"instructions\": " << hw_counters_.instructions_
+            << ", \"llc_misses\": " << hw_counters_.llc_misses_;
+      }
+      *os << "},\n";
+    }
   };
 
  private:
@@ -1256,13 +1608,17 @@ struct ProfileOperator : public ProfileEvent {
    * \brief Send this object's statistical datapoint to the profiler
    */
   void SendStat() override {
-    Profiler::Get()->AddNewProfileStat<OprExecStat>([](OprExecStat* stat) {},
-                                                    name_.c_str(),
-                                                    dev_type_,
-                                                    dev_id_,
-                                                    start_time_,
-                                                    ProfileStat::NowInMicrosec(),
-                                                    attributes_.get());
+    Profiler::Get()->AddNewProfileStat<OprExecStat>(
+        [this](OprExecStat* stat) {
+          stat->dispatch_    = dispatch_;
+          stat->hw_counters_ = hw_counters_;
+        },
+        name_.c_str(),
+        dev_type_,
+        dev_id_,
+        start_time_,
+        ProfileStat::NowInMicrosec(),
+        attributes_.get());
   }
   /*!
    * \brief Check if this operator is no longer profiled
@@ -1292,6 +1648,10 @@ struct ProfileOperator : public ProfileEvent {
   std::unique_ptr<Attributes> attributes_;
   /*! \brief Whether to profile or not */
   const bool profiling_;
+  /*! \brief How the operator was dispatched, filled in when it stops */
+  OprDispatchInfo dispatch_;
+  /*! \brief Hardware counters when the operator started, their increase once it stopped */
+  HwCounterValues hw_counters_;
 };
 
 /*
@@ -1330,8 +1690,7 @@ inline void Profiler::AddProfileStat<ProfileOperator::OprExecStat>(
     std::unique_ptr<ProfileOperator::OprExecStat>* opr_stat) {
   const size_t idx = DeviceIndex((*opr_stat)->dev_type_, (*opr_stat)->dev_id_);
   CHECK_LT(idx, DeviceCount());
-  DeviceStats& dev_stat = profile_stat[idx];
-  dev_stat.opr_exec_stats_->enqueue((*opr_stat).release());
+  EnqueueProfileStat(&profile_stat[idx], (*opr_stat).release());
 }
 
 #undef VTUNE_ONLY_CODE  // This macro not meant to be used outside of this file
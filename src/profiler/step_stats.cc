@@ -0,0 +1,148 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file step_stats.cc
+ * \brief Breakdown of the wall time of training steps into their phases
+ */
+#include "./step_stats.h"
+
+#include <dmlc/logging.h>
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+#include "./profiler.h"
+
+namespace mxnet {
+namespace profiler {
+
+namespace {
+
+const char* const kPhaseNames[StepStats::kNumPhases] =
+    {"Data loading", "H2D copy", "Forward", "Backward", "KVStore", "Optimizer"};
+
+/*! \brief Total length of the union of intervals, clipped to [begin, end) */
+uint64_t UnionLength(std::vector<std::pair<uint64_t, uint64_t>>* intervals,
+                     uint64_t begin,
+                     uint64_t end) {
+  std::sort(intervals->begin(), intervals->end());
+  uint64_t length = 0;
+  uint64_t covered = begin;
+  for (const auto& interval : *intervals) {
+    const uint64_t start = std::max(interval.first, covered);
+    const uint64_t stop  = std::min(interval.second, end);
+    if (stop > start) {
+      length += stop - start;
+      covered = stop;
+    }
+  }
+  return length;
+}
+
+inline bool StartsWith(const char* str, const char* prefix) {
+  return strncmp(str, prefix, strlen(prefix)) == 0;
+}
+
+}  // namespace
+
+StepStats::StepStats(int report_period)
+    : report_period_(report_period), window_start_(ProfileStat::NowInMicrosec()) {
+  CHECK_GT(report_period, 0);
+}
+
+StepStats::Phase StepStats::Classify(const char* category, const char* name) {
+  if (strcmp(category, kDataLoadingCategory) == 0)
+    return kDataLoading;
+  if (strcmp(category, "kvstore") == 0)
+    return kKVStore;
+  if (strcmp(category, "operator") != 0 && strcmp(category, custom_op_domain.name()) != 0)
+    return kNumPhases;
+  if (strstr(name, "CPU2GPU"))
+    return kCopyH2D;
+  if (StartsWith(name, "KVStore"))
+    return kKVStore;
+  if (StartsWith(name, "_backward_"))
+    return kBackward;
+  // sgd_update, adam_update, multi_sgd_mom_update, _multi_adamw_update, ...
+  if (strstr(name, "_update"))
+    return kOptimizer;
+  return kForward;
+}
+
+void StepStats::OnProfileStat(const ProfileStat& stat) {
+  uint64_t start, stop;
+  if (!stat.enable_aggregate_ || !stat.GetDuration(&start, &stop))
+    return;
+  const Phase phase = Classify(stat.categories_.c_str(), stat.name_.c_str());
+  if (phase == kNumPhases)
+    return;
+  std::lock_guard<std::mutex> lock(m_);
+  intervals_.push_back({start, stop, phase});
+}
+
+std::string StepStats::MarkStep() {
+  const uint64_t now = ProfileStat::NowInMicrosec();
+  std::lock_guard<std::mutex> lock(m_);
+  if (++num_steps_ < report_period_)
+    return std::string();
+  return Report(now);
+}
+
+std::string StepStats::Report(uint64_t now) {
+  const uint64_t wall = now - window_start_;
+  std::vector<std::pair<uint64_t, uint64_t>> all, phases[kNumPhases];
+  std::vector<Interval> later;
+  for (const Interval& interval : intervals_) {
+    if (interval.start_ >= now) {
+      // started after the end of the step, it belongs to the next report
+      later.push_back(interval);
+      continue;
+    }
+    all.emplace_back(interval.start_, interval.stop_);
+    phases[interval.phase_].emplace_back(interval.start_, interval.stop_);
+  }
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(3);
+  os << "Step Breakdown (steps " << num_steps_reported_ + 1 << "-"
+     << num_steps_reported_ + num_steps_ << ", " << wall / 1000.0 << " ms)" << std::endl
+     << "=================" << std::endl
+     << std::setw(25) << std::left << "Phase" << std::setw(16) << std::right
+     << "Time/Step (ms)" << " " << std::setw(16) << std::right << "% of Wall" << std::endl
+     << std::setw(25) << std::left << "-----" << std::setw(16) << std::right
+     << "--------------" << " " << std::setw(16) << std::right << "---------" << std::endl;
+  auto print = [&](const char* name, uint64_t time) {
+    os << std::setw(25) << std::left << name << std::setw(16) << std::right
+       << time / 1000.0 / num_steps_ << " " << std::setw(16) << std::right
+       << (wall ? 100.0 * time / wall : 0) << std::endl;
+  };
+  for (int phase = 0; phase < kNumPhases; ++phase) {
+    print(kPhaseNames[phase], UnionLength(&phases[phase], window_start_, now));
+  }
+  print("Idle", wall - std::min(wall, UnionLength(&all, window_start_, now)));
+  num_steps_reported_ += num_steps_;
+  num_steps_    = 0;
+  window_start_ = now;
+  intervals_.swap(later);
+  return os.str();
+}
+
+}  // namespace profiler
+}  // namespace mxnet
@@ -0,0 +1,97 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file step_stats.h
+ * \brief Breakdown of the wall time of training steps into their phases
+ */
+#ifndef MXNET_PROFILER_STEP_STATS_H_
+#define MXNET_PROFILER_STEP_STATS_H_
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mxnet {
+namespace profiler {
+
+struct ProfileStat;
+
+/*!
+ * \brief Attributes the wall time between the ends of training steps to data loading, host to
+ *  device copies, forward, backward, kvstore communication, optimizer updates and idle gaps,
+ *  from the operators and tasks recorded by the profiler. Phases that run concurrently, e.g. on
+ *  several devices, overlap; the idle gaps are the time when nothing recorded was running.
+ */
+class StepStats {
+ public:
+  /*! \brief Category of the tasks waiting for the next batch of data */
+  static constexpr const char* kDataLoadingCategory = "Data Loading";
+
+  enum Phase { kDataLoading, kCopyH2D, kForward, kBackward, kKVStore, kOptimizer, kNumPhases };
+
+  /*!
+   * \brief Constructor, the first step starts now
+   * \param report_period Number of steps summarized by a report
+   */
+  explicit StepStats(int report_period);
+  /*!
+   * \brief Record a profiled duration
+   * \param stat The statistic object
+   */
+  void OnProfileStat(const ProfileStat& stat);
+  /*!
+   * \brief Mark the end of a training step
+   * \return The report of the last report_period steps, every report_period steps, else empty
+   */
+  std::string MarkStep();
+
+ private:
+  struct Interval {
+    uint64_t start_;
+    uint64_t stop_;
+    Phase phase_;
+  };
+
+  /*!
+   * \brief Phase of a duration
+   * \return kNumPhases if the duration belongs to no phase
+   */
+  static Phase Classify(const char* category, const char* name);
+  /*! \brief Print the report of the steps ending at now and drop their intervals */
+  std::string Report(uint64_t now);
+
+  /*! \brief protects the members, records come from every engine thread */
+  std::mutex m_;
+  /*! \brief number of steps of a report */
+  const int report_period_;
+  /*! \brief number of steps since the last report */
+  int num_steps_ = 0;
+  /*! \brief number of steps reported */
+  uint64_t num_steps_reported_ = 0;
+  /*! \brief start of the steps of the next report, in microseconds */
+  uint64_t window_start_;
+  /*! \brief recorded durations not reported yet */
+  std::vector<Interval> intervals_;
+};
+
+}  // namespace profiler
+}  // namespace mxnet
+#endif  // MXNET_PROFILER_STEP_STATS_H_
@@ -21,9 +21,12 @@
 #if MXNET_USE_NVML
 #include <nvml.h>
 #endif  // MXNET_USE_NVML
+#include <algorithm>
 #include <fstream>
+#include <functional>
 #include <map>
 #include <regex>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 #include <type_traits>
@@ -34,6 +37,189 @@
 namespace mxnet {
 namespace profiler {
 
+MemoryTimeline* MemoryTimeline::Get() {
+  static MemoryTimeline memory_timeline;
+  return &memory_timeline;
+}
+
+void MemoryTimeline::SetConfig(const std::string& filename_prefix) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  filename_prefix_ = filename_prefix;
+  events_.clear();
+  live_.clear();
+  const size_t device_count = Profiler::Get()->DeviceCount();
+  in_use_.assign(device_count, 0);
+  peak_.assign(device_count, 0);
+  peak_event_.assign(device_count, 0);
+  enabled_ = !filename_prefix.empty();
+}
+
+void MemoryTimeline::OnAlloc(const Storage::Handle& handle) {
+  if (!IsProfiling()) {
+    return;
+  }
+  const size_t device = Profiler::Get()->DeviceIndex(handle.ctx.dev_type, handle.ctx.dev_id);
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (device >= in_use_.size()) {
+    return;
+  }
+  live_[handle.dptr] = handle.size;
+  in_use_[device] += handle.size;
+  events_.push_back({ProfileStat::NowInMicrosec(),
+                     kAlloc,
+                     device,
+                     handle.dptr,
+                     handle.size,
+                     in_use_[device],
+                     handle.profiler_scope,
+                     handle.name});
+  if (in_use_[device] > peak_[device]) {
+    peak_[device]       = in_use_[device];
+    peak_event_[device] = events_.size() - 1;
+  }
+}
+
+void MemoryTimeline::OnFree(const Storage::Handle& handle) {
+  if (!IsProfiling()) {
+    return;
+  }
+  const size_t device = Profiler::Get()->DeviceIndex(handle.ctx.dev_type, handle.ctx.dev_id);
+  std::lock_guard<std::mutex> lk(mutex_);
+  const auto it = live_.find(handle.dptr);
+  if (it == live_.end() || device >= in_use_.size()) {
+    return;
+  }
+  const size_t size = it->second;
+  live_.erase(it);
+  in_use_[device] -= size;
+  events_.push_back({ProfileStat::NowInMicrosec(),
+                     kFree,
+                     device,
+                     handle.dptr,
+                     size,
+                     in_use_[device],
+                     handle.profiler_scope,
+                     handle.name});
+}
+
+void MemoryTimeline::OnTag(const Storage::Handle& handle) {
+  if (!IsProfiling()) {
+    return;
+  }
+  const size_t device = Profiler::Get()->DeviceIndex(handle.ctx.dev_type, handle.ctx.dev_id);
+  std::lock_guard<std::mutex> lk(mutex_);
+  const auto it = live_.find(handle.dptr);
+  if (it == live_.end() || device >= in_use_.size()) {
+    return;
+  }
+  events_.push_back({ProfileStat::NowInMicrosec(),
+                     kTag,
+                     device,
+                     handle.dptr,
+                     it->second,
+                     in_use_[device],
+                     handle.profiler_scope,
+                     handle.name});
+}
+
+const char* MemoryTimeline::Role(const std::string& profiler_scope, const std::string& name) {
+  auto contains = [](const std::string& s, const char* part) {
+    return s.find(part) != std::string::npos;
+  };
+  if (contains(profiler_scope, "optimizer_state")) {
+    return "optimizer state";
+  }
+  if (contains(profiler_scope, "arg_grad:") || contains(name, "_head_grad") ||
+      contains(name, "_backward")) {
+    return "gradient";
+  }
+  if (contains(profiler_scope, "in_arg:") || contains(profiler_scope, "aux_state:")) {
+    return "weight";
+  }
+  if (profiler_scope == "resource:" || profiler_scope == "<ephemeral>:" ||
+      profiler_scope == "cudnn_rnn:") {
+    return "workspace";
+  }
+  if (name == MXNET_STORAGE_DEFAULT_NAME_CSTR) {
+    return "other";
+  }
+  return "activation";
+}
+
+void MemoryTimeline::DumpProfile() {
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (filename_prefix_.empty()) {
+    return;
+  }
+  const std::string prefix =
+      filename_prefix_ + "-pid_" + std::to_string(common::current_process_id());
+  std::ofstream timeline((prefix + ".csv").c_str());
+  if (!timeline.is_open()) {
+    return;
+  }
+  Profiler* prof            = Profiler::Get();
+  const char* event_names[] = {"alloc", "free", "tag"};
+  timeline << "\"Time (us)\",\"Device\",\"Event\",\"Size\",\"In Use\",\"Role\","
+              "\"Attribute Name\""
+           << std::endl;
+  for (const Event& event : events_) {
+    timeline << event.timestamp << ",\"" << prof->DeviceName(event.device) << "\",\""
+             << event_names[event.type] << "\"," << event.size << "," << event.in_use << ",\""
+             << Role(event.profiler_scope, event.name) << "\",\"" << event.profiler_scope
+             << event.name << "\"" << std::endl;
+  }
+
+  std::ofstream peak((prefix + "-peak.csv").c_str());
+  if (!peak.is_open()) {
+    return;
+  }
+  peak << "\"Device\",\"Peak Time (us)\",\"Role\",\"Attribute Name\",\"Size\",\"Share\""
+       << std::endl;
+  for (size_t device = 0; device < peak_.size(); ++device) {
+    if (peak_[device] == 0) {
+      continue;
+    }
+    // replay the events up to the peak to find the allocations live at that time
+    std::unordered_map<void*, const Event*> live;
+    for (size_t i = 0; i <= peak_event_[device]; ++i) {
+      const Event& event = events_[i];
+      if (event.device != device) {
+        continue;
+      }
+      if (event.type == kFree) {
+        live.erase(event.dptr);
+      } else {
+        live[event.dptr] = &event;
+      }
+    }
+    std::map<std::string, size_t> by_role;
+    std::map<std::pair<std::string, std::string>, size_t> by_name;
+    for (const auto& kv : live) {
+      const Event& event = *kv.second;
+      const char* role   = Role(event.profiler_scope, event.name);
+      by_role[role] += event.size;
+      by_name[{role, event.profiler_scope + event.name}] += event.size;
+    }
+    // roles first, then the names, both largest first
+    std::vector<std::tuple<size_t, std::string, std::string>> rows;
+    for (const auto& kv : by_role) {
+      rows.emplace_back(kv.second, kv.first, "(total)");
+    }
+    std::sort(rows.begin(), rows.end(), std::greater<>());
+    const size_t num_roles = rows.size();
+    for (const auto& kv : by_name) {
+      rows.emplace_back(kv.second, kv.first.first, kv.first.second);
+    }
+    std::sort(rows.begin() + num_roles, rows.end(), std::greater<>());
+    const uint64_t peak_time = events_[peak_event_[device]].timestamp;
+    for (const auto& row : rows) {
+      peak << "\"" << prof->DeviceName(device) << "\"," << peak_time << ",\""
+           << std::get<1>(row) << "\",\"" << std::get<2>(row) << "\"," << std::get<0>(row)
+           << "," << static_cast<double>(std::get<0>(row)) / peak_[device] << std::endl;
+    }
+  }
+}
+
 #if MXNET_USE_CUDA
 
 GpuDeviceStorageProfiler* GpuDeviceStorageProfiler::Get() {
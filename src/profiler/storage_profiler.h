@@ -21,6 +21,7 @@
 
 #include <mxnet/libinfo.h>
 #include <mxnet/storage.h>
+#include <atomic>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -32,6 +33,91 @@
 namespace mxnet {
 namespace profiler {
 
+/*!
+ * \brief Timeline of the storage allocations and frees of all devices while memory is profiled.
+ *        Every allocation is tagged with the name of the node it holds the data of and its
+ *        storage role, so that the peak usage of every device can be broken down.
+ *        Memory returned to a storage pool counts as freed.
+ */
+class MemoryTimeline {
+ public:
+  /*! \brief get the global instance */
+  static MemoryTimeline* Get();
+
+  /*!
+   * \brief Set the file name prefix of the timeline, and clear the events recorded so far
+   * \param filename_prefix File name prefix, empty to disable the timeline
+   */
+  void SetConfig(const std::string& filename_prefix);
+
+  /*! \brief Whether allocations are recorded */
+  bool IsProfiling() const {
+    return enabled_.load(std::memory_order_relaxed) &&
+           Profiler::Get()->IsProfiling(Profiler::kMemory);
+  }
+
+  /*!
+   * \brief Record an allocation
+   * \param handle Handle to the allocated storage
+   */
+  void OnAlloc(const Storage::Handle& handle);
+
+  /*!
+   * \brief Record a free, ignored if the allocation was not recorded
+   * \param handle Handle to the freed storage
+   */
+  void OnFree(const Storage::Handle& handle);
+
+  /*!
+   * \brief Record the profiler scope and name assigned to storage after its allocation
+   * \param handle Handle to the storage
+   */
+  void OnTag(const Storage::Handle& handle);
+
+  /*!
+   * \brief Write the timeline to <prefix>-pid_<pid>.csv, and the breakdown of the peak usage of
+   *        every device by role and by name to <prefix>-pid_<pid>-peak.csv
+   */
+  void DumpProfile();
+
+  /*!
+   * \brief Storage role of an allocation, from its profiler scope and name
+   * \param profiler_scope Profiler scope of the storage handle
+   * \param name Name of the storage handle
+   * \return One of "weight", "gradient", "optimizer state", "workspace", "activation" or
+   *         "other" when the storage is not attributed to anything
+   */
+  static const char* Role(const std::string& profiler_scope, const std::string& name);
+
+ private:
+  enum EventType { kAlloc, kFree, kTag };
+  struct Event {
+    uint64_t timestamp;
+    EventType type;
+    size_t device;   // profiler device index
+    void* dptr;
+    size_t size;
+    size_t in_use;   // bytes in use on the device after the event
+    std::string profiler_scope;
+    std::string name;
+  };
+
+  /*! \brief Whether the timeline is enabled */
+  std::atomic<bool> enabled_{false};
+  std::string filename_prefix_;
+  std::mutex mutex_;
+  /*! \brief Recorded events, in order */
+  std::vector<Event> events_;
+  /*! \brief Size of the recorded allocations not freed yet */
+  std::unordered_map<void*, size_t> live_;
+  /*! \brief Bytes in use, by device index */
+  std::vector<size_t> in_use_;
+  /*! \brief Peak bytes in use, by device index */
+  std::vector<size_t> peak_;
+  /*! \brief Index of the event which reached the peak, by device index */
+  std::vector<size_t> peak_event_;
+};
+
 /*!
  * \brief Storage allocation/deallocation profiling via ProfileCounters
  */
@@ -61,6 +147,7 @@ class DeviceStorageProfiler {
         }
         CHECK_LT(idx, mem_counters_.size()) << "Invalid device index: " << idx;
         *mem_counters_[idx] += handle.size;
+        MemoryTimeline::Get()->OnAlloc(handle);
       }
     }
   }
@@ -87,6 +174,7 @@ class DeviceStorageProfiler {
         } else {
           *mem_counters_[idx] = 0;
         }
+        MemoryTimeline::Get()->OnFree(handle);
       }
     }
   }
@@ -28,12 +28,14 @@
 #include <mxnet/engine.h>
 #include <mxnet/random_generator.h>
 #include <mxnet/resource.h>
+#include <algorithm>
 #include <limits>
 #include <atomic>
 #include <memory>
 #include "./common/lazy_alloc_array.h"
 #include "./common/utils.h"
 #include "./common/cuda/utils.h"
+#include "./engine/engine_stats.h"
 #include "./profiler/storage_profiler.h"
 
 namespace mxnet {
@@ -47,6 +49,14 @@ struct SpaceAllocator {
   Storage::Handle handle;
   // internal CPU handle
   Storage::Handle host_handle;
+  // whether a space much larger than the recent requests is released, in dynamic pools
+  bool release_oversized = false;
+  // number of consecutive requests much smaller than the space
+  int num_small_requests = 0;
+  // a request is small when the space is this many times larger
+  static constexpr size_t kOversizedRatio = 4;
+  // number of consecutive small requests after which the space is released
+  static constexpr int kOversizedRequests = 16;
 
   SpaceAllocator() {
     handle.dptr      = nullptr;
@@ -66,19 +76,46 @@ struct SpaceAllocator {
   }
 
   inline void* GetSpace(size_t size, const std::string& name) {
-    if (handle.size >= size)
+    if (handle.size >= size && !ReleaseOversized(size))
       return handle.dptr;
 
-    Storage::Get()->DirectFree(handle);
+    FreeSpace();
     handle                = Storage::Get()->Alloc(size, ctx);
     handle.profiler_scope = "resource:";
     handle.name           = name;
+    profiler::MemoryTimeline::Get()->OnTag(handle);
 #if MXNET_USE_CUDA
     profiler::GpuDeviceStorageProfiler::Get()->UpdateStorageInfo(handle);
 #endif  // MXNET_USE_CUDA
     return handle.dptr;
   }
 
+  // whether the space is given back, being much larger than the recent requests,
+  // e.g. after a single operator asked for a huge workspace
+  inline bool ReleaseOversized(size_t size) {
+    if (!release_oversized || size * kOversizedRatio >= handle.size) {
+      num_small_requests = 0;
+      return false;
+    }
+    if (++num_small_requests < kOversizedRequests)
+      return false;
+    num_small_requests = 0;
+    if (engine::EngineStats::Get()->enabled())
+      engine::EngineStats::Get()->OnTempSpaceRelease(handle.size);
+    return true;
+  }
+
+  inline void FreeSpace() {
+    // kernels on another stream may still use a GPU space, which DirectFree synchronizes,
+    // while CPU operators are done with it and its memory can go back to the pool
+    if (release_oversized && ctx.dev_mask() == Context::kCPU) {
+      if (handle.dptr != nullptr)
+        Storage::Get()->Free(handle);
+    } else {
+      Storage::Get()->DirectFree(handle);
+    }
+  }
+
   inline void* GetHostSpace(size_t size) {
     if (host_handle.size >= size)
       return host_handle.dptr;
@@ -95,6 +132,12 @@ class ResourceManagerImpl : public ResourceManager {
   ResourceManagerImpl() noexcept(false) {
     cpu_temp_space_copy_  = dmlc::GetEnv("MXNET_CPU_TEMP_COPY", 4);
     gpu_temp_space_copy_  = dmlc::GetEnv("MXNET_GPU_TEMP_COPY", 1);
+    if (dmlc::GetEnv("MXNET_TEMP_SPACE_DYNAMIC", false)) {
+      cpu_temp_space_max_copy_ =
+          std::max(dmlc::GetEnv("MXNET_CPU_TEMP_COPY_MAX", 16), cpu_temp_space_copy_);
+      gpu_temp_space_max_copy_ =
+          std::max(dmlc::GetEnv("MXNET_GPU_TEMP_COPY_MAX", 4), gpu_temp_space_copy_);
+    }
     cpu_native_rand_copy_ = dmlc::GetEnv("MXNET_CPU_PARALLEL_RAND_COPY", 1);
     gpu_native_rand_copy_ = dmlc::GetEnv("MXNET_GPU_PARALLEL_RAND_COPY", 1);
 #if MXNET_USE_CUDNN == 1
@@ -104,7 +147,7 @@ class ResourceManagerImpl : public ResourceManager {
     storage_ref_ = Storage::_GetSharedRef();
     cpu_rand_    = std::make_unique<ResourceRandom<cpu>>(Context::CPU(), global_seed_);
     cpu_space_   = std::make_unique<ResourceTempSpace<ResourceRequest::kTempSpace>>(
-        Context::CPU(), cpu_temp_space_copy_);
+        Context::CPU(), cpu_temp_space_copy_, cpu_temp_space_max_copy_);
     cpu_parallel_rand_ = std::make_unique<ResourceParallelRandom<cpu>>(
         Context::CPU(), cpu_native_rand_copy_, global_seed_);
   }
@@ -156,7 +199,7 @@ class ResourceManagerImpl : public ResourceManager {
               .Get(ctx.dev_id,
                    [ctx, this]() {
                      return new ResourceTempSpace<ResourceRequest::kTempSpace>(
-                         ctx, gpu_temp_space_copy_);
+                         ctx, gpu_temp_space_copy_, gpu_temp_space_max_copy_);
                    })
               ->GetNext();
         }
@@ -288,26 +331,41 @@ class ResourceManagerImpl : public ResourceManager {
   struct ResourceTempSpace {
     /*! \brief the context of the device */
     Context ctx;
-    /*! \brief the underlying space */
+    /*! \brief the underlying space, of the maximum number of copies */
     std::vector<SpaceAllocator> space;
     /*! \brief resource representation */
     std::vector<Resource> resource;
     /*! \brief current pointer to the round roubin allocator */
     std::atomic<size_t> curr_ptr;
-    /*! \brief constructor */
-    explicit ResourceTempSpace(Context ctx, size_t ncopy)
-        : ctx(ctx), space(ncopy), resource(ncopy), curr_ptr(0) {
-      for (size_t i = 0; i < space.size(); ++i) {
-        resource[i].var  = Engine::Get()->NewVariable();
-        resource[i].id   = static_cast<int32_t>(i);
-        resource[i].ptr_ = &space[i];
-        resource[i].req  = ResourceRequest(req);
-        space[i].ctx     = ctx;
-        CHECK_EQ(space[i].handle.size, 0U);
-      }
+    /*! \brief number of copies in use */
+    size_t num_copy;
+    /*! \brief whether copies are added when all are busy, see GetNextIdle */
+    bool dynamic;
+    /*!
+     * \brief constructor
+     * \param max_copy maximum number of copies of a dynamic pool, 0 for a fixed pool.
+     */
+    explicit ResourceTempSpace(Context ctx, size_t ncopy, size_t max_copy = 0)
+        : ctx(ctx),
+          space(std::max(ncopy, max_copy)),
+          resource(std::max(ncopy, max_copy)),
+          curr_ptr(0),
+          num_copy(ncopy),
+          dynamic(max_copy > 0) {
+      for (size_t i = 0; i < num_copy; ++i)
+        InitCopy(i);
+    }
+    inline void InitCopy(size_t i) {
+      resource[i].var            = Engine::Get()->NewVariable();
+      resource[i].id             = static_cast<int32_t>(i);
+      resource[i].ptr_           = &space[i];
+      resource[i].req            = ResourceRequest(req);
+      space[i].ctx               = ctx;
+      space[i].release_oversized = dynamic;
+      CHECK_EQ(space[i].handle.size, 0U);
     }
     virtual ~ResourceTempSpace() {
-      for (size_t i = 0; i < space.size(); ++i) {
+      for (size_t i = 0; i < num_copy; ++i) {
         SpaceAllocator r = space[i];
         Engine::Get()->DeleteVariable(
             [r](RunContext rctx) {
@@ -325,9 +383,35 @@ class ResourceManagerImpl : public ResourceManager {
       // reset ptr to avoid undefined behavior during overflow
       // usually this won't happen
       if (ptr > kMaxDigit) {
-        curr_ptr.store((ptr + 1) % space.size());
+        curr_ptr.store((ptr + 1) % num_copy);
+      }
+      if (dynamic)
+        return GetNextIdle(ptr);
+      return resource[ptr % num_copy];
+    }
+    // get the first copy no operator waits for or runs with, in round robin order, so that
+    // operators do not serialize on the variable of a shared copy. A copy is added when all are
+    // busy, up to the maximum number of copies.
+    // The manager is thread local, copies are only added by the thread requesting them.
+    inline Resource GetNextIdle(size_t ptr) {
+      engine::EngineStats* stats = engine::EngineStats::Get();
+      for (size_t k = 0; k < num_copy; ++k) {
+        const Resource& r = resource[(ptr + k) % num_copy];
+        if (r.var->idle()) {
+          if (stats->enabled())
+            stats->OnTempSpaceRequest(false);
+          return r;
+        }
       }
-      return resource[ptr % space.size()];
+      const bool contended = num_copy == space.size();
+      if (stats->enabled())
+        stats->OnTempSpaceRequest(contended);
+      if (contended)
+        return resource[ptr % num_copy];
+      InitCopy(num_copy);
+      if (stats->enabled())
+        stats->OnTempSpaceGrow();
+      return resource[num_copy++];
     }
   };
 
@@ -485,6 +569,10 @@ class ResourceManagerImpl : public ResourceManager {
   int cpu_temp_space_copy_;
   /*! \brief number of copies in GPU temp space */
   int gpu_temp_space_copy_;
+  /*! \brief maximum number of copies in CPU temp space, 0 unless MXNET_TEMP_SPACE_DYNAMIC */
+  int cpu_temp_space_max_copy_{0};
+  /*! \brief maximum number of copies in GPU temp space, 0 unless MXNET_TEMP_SPACE_DYNAMIC */
+  int gpu_temp_space_max_copy_{0};
   /*! \brief number of copies in CPU native random sampler */
   int cpu_native_rand_copy_;
   /*! \brief number of copies in GPU native random sampler */
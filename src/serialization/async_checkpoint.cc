@@ -0,0 +1,91 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file async_checkpoint.cc
+ * \brief Checkpoint saved without blocking the caller
+ */
+#include "async_checkpoint.h"
+#include <dmlc/io.h>
+#include <mxnet/imperative.h>
+#include <memory>
+#include "mapped_params.h"
+#include "sharded_params.h"
+
+namespace mxnet {
+
+AsyncCheckpoint::AsyncCheckpoint(const std::string& fname,
+                                 const std::vector<NDArray>& arrays,
+                                 const std::vector<std::string>& names,
+                                 bool mapped,
+                                 size_t num_shards) {
+  CHECK(!(mapped && num_shards > 1)) << "Mapped parameter files cannot be sharded";
+  CHECK(names.empty() || names.size() == arrays.size())
+      << "Number of names and arrays to save differ";
+  for (const NDArray& array : arrays) {
+    if (array.is_none()) {
+      snapshots_.push_back(array);
+    } else if (array.ctx().dev_mask() == gpu::kDevMask) {
+      snapshots_.push_back(array.Copy(Context::CPUPinned(array.ctx().dev_id)));
+    } else {
+      snapshots_.push_back(array.Copy(Context::CPU()));
+    }
+  }
+  // the np shape semantics of the caller apply to the serialization
+  const int np_shape = Imperative::Get()->is_np_shape();
+  writer_ = std::thread([this, fname, names, mapped, num_shards, np_shape]() {
+    try {
+      if (np_shape == NumpyShape::ThreadLocalOn)
+        Imperative::Get()->set_is_np_shape(np_shape);
+      if (mapped) {
+        mapped_params::save_arrays(fname, snapshots_, names);
+      } else if (num_shards > 1) {
+        sharded_params::save_arrays(fname, snapshots_, names, num_shards);
+      } else {
+        std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(fname.c_str(), "w"));
+        NDArray::Save(fo.get(), snapshots_, names);
+      }
+    } catch (...) {
+      error_ = std::current_exception();
+    }
+    // the staging memory is released as soon as the file is written
+    snapshots_.clear();
+    done_ = true;
+  });
+}
+
+AsyncCheckpoint::~AsyncCheckpoint() {
+  try {
+    Wait();
+  } catch (const std::exception& e) {
+    LOG(WARNING) << "Asynchronous checkpoint failed: " << e.what();
+  }
+}
+
+void AsyncCheckpoint::Wait() {
+  if (writer_.joinable())
+    writer_.join();
+  if (error_) {
+    std::exception_ptr error = error_;
+    error_                   = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+}  // namespace mxnet
@@ -0,0 +1,69 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file async_checkpoint.h
+ * \brief Checkpoint saved without blocking the caller
+ */
+#ifndef MXNET_SERIALIZATION_ASYNC_CHECKPOINT_H_
+#define MXNET_SERIALIZATION_ASYNC_CHECKPOINT_H_
+
+#include <mxnet/ndarray.h>
+#include <atomic>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mxnet {
+
+/*!
+ * \brief Saves a snapshot of arrays in the background.
+ *
+ * The constructor pushes to the engine a copy of every array to the CPU, to pinned memory for
+ * arrays of a GPU, and returns. The copies read the arrays before any operation pushed later, so
+ * the arrays can be updated right away. A thread then writes the copies once they are done, in
+ * the format of NDArray::Save, or of the mapped or sharded parameter files. The arrays are saved
+ * from their CPU copy, so they are loaded on the CPU.
+ */
+class AsyncCheckpoint {
+ public:
+  AsyncCheckpoint(const std::string& fname,
+                  const std::vector<NDArray>& arrays,
+                  const std::vector<std::string>& names,
+                  bool mapped,
+                  size_t num_shards);
+  /*! \brief Waits for the file to be written */
+  ~AsyncCheckpoint();
+  /*! \brief Whether the file is written, or its writing failed */
+  bool Done() const {
+    return done_;
+  }
+  /*! \brief Waits for the file to be written, and throws the error of the writing if any */
+  void Wait();
+
+ private:
+  std::vector<NDArray> snapshots_;
+  std::thread writer_;
+  std::atomic<bool> done_{false};
+  std::exception_ptr error_;
+};
+
+}  // namespace mxnet
+#endif  // MXNET_SERIALIZATION_ASYNC_CHECKPOINT_H_
@@ -24,6 +24,10 @@
 #include <mxnet/op_attr_types.h>
 #include <mxnet/imperative.h>
 #include <string_view>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
@@ -38,6 +42,7 @@
 #include <set>
 #include <stdexcept>
 #include <typeinfo>
+#include "file_buffer.h"
 
 namespace mxnet {
 
@@ -200,32 +205,6 @@ std::string create_npy_header(const TBlob& blob) {
   return header;
 }
 
-uint32_t parse_npy_header_len(std::ifstream& strm) {
-  strm.exceptions(std::istream::eofbit);
-  strm.exceptions(std::istream::failbit);
-  strm.exceptions(std::istream::badbit);
-
-  CHECK_EQ(strm.get(), 0x93);
-  CHECK_EQ(strm.get(), 'N');
-  CHECK_EQ(strm.get(), 'U');
-  CHECK_EQ(strm.get(), 'M');
-  CHECK_EQ(strm.get(), 'P');
-  CHECK_EQ(strm.get(), 'Y');
-
-  uint8_t major_version = strm.get();
-  CHECK(major_version == 0x01 || major_version == 0x02) << "Unsupported npy major version";
-  CHECK(strm.get() == 0x00) << "Unsupported npy minor version";
-
-  uint32_t header_len = 0;
-  header_len += strm.get();
-  header_len += strm.get() >> 8;
-  if (major_version == 0x02) {
-    header_len += strm.get() >> 16;
-    header_len += strm.get() >> 24;
-  }
-  return header_len;
-}
-
 std::tuple<int, int, std::vector<dim_t>> parse_npy_header_descr(const std::string& header) {
   // Fortran order
   std::string::size_type loc = header.find("fortran_order");
@@ -287,15 +266,31 @@ void save_array(const std::string& fname, const NDArray& array_) {
                blob.Size() * mshadow::mshadow_sizeof(blob.type_flag_));
 }
 
-NDArray load_array(const std::string& fname) {
-  std::ifstream strm(fname, std::ios::binary);
-  strm.exceptions(std::istream::eofbit);
-  strm.exceptions(std::istream::failbit);
-  strm.exceptions(std::istream::badbit);
-
-  uint32_t header_len = parse_npy_header_len(strm);
-  std::string header(header_len, ' ');
-  strm.read(header.data(), header_len);
+size_t parse_npy_header(const char* data,
+                        size_t size,
+                        const std::string& fname,
+                        std::string* header) {
+  CHECK(size >= 10 && std::memcmp(data, "\x93NUMPY", 6) == 0) << fname << " is not in npy format";
+  const auto* bytes           = reinterpret_cast<const uint8_t*>(data);
+  const uint8_t major_version = bytes[6];
+  CHECK(major_version == 0x01 || major_version == 0x02) << "Unsupported npy major version";
+  CHECK(bytes[7] == 0x00) << "Unsupported npy minor version";
+  const size_t preamble = major_version == 0x01 ? 10 : 12;
+  CHECK_LE(preamble, size) << "Truncated npy data in " << fname;
+  size_t header_len = bytes[8] | bytes[9] << 8;
+  if (major_version == 0x02)
+    header_len |= static_cast<size_t>(bytes[10]) << 16 | static_cast<size_t>(bytes[11]) << 24;
+  CHECK_LE(preamble + header_len, size) << "Truncated npy data in " << fname;
+  header->assign(data + preamble, header_len);
+  return preamble + header_len;
+}
+
+NDArray array_from_buffer(const std::shared_ptr<FileBuffer>& buffer,
+                          char* data,
+                          size_t size,
+                          const std::string& fname) {
+  std::string header;
+  const size_t offset                    = parse_npy_header(data, size, fname, &header);
   auto [type_flag, fortran_order, shape] = parse_npy_header_descr(header);  // NOLINT
 
   if (fortran_order) {
@@ -303,10 +298,18 @@ NDArray load_array(const std::string& fname) {
   }
 
   TShape tshape(shape);
-  NDArray array(tshape, Context::CPU(), false, type_flag);
-  const TBlob& blob = array.data();
-  strm.read(reinterpret_cast<char*>(blob.dptr_),
-            blob.Size() * mshadow::mshadow_sizeof(blob.type_flag_));
+  const size_t elem_size = mshadow::mshadow_sizeof(type_flag);
+  const size_t nbytes    = tshape.Size() * elem_size;
+  CHECK_LE(offset + nbytes, size) << "Truncated npy data in " << fname;
+  char* payload = data + offset;
+  NDArray array;
+  if (reinterpret_cast<uintptr_t>(payload) % elem_size == 0) {
+    // every view holds the buffer, which is released with the last one
+    array = NDArray(TBlob(payload, tshape, cpu::kDevMask, type_flag, 0), 0, [buffer]() {});
+  } else {
+    array = NDArray(tshape, Context::CPU(), false, type_flag);
+    std::memcpy(array.data().dptr_, payload, nbytes);
+  }
 
   if (fortran_order) {
     array = fortran_order_transpose(shape, type_flag, array);
@@ -315,6 +318,11 @@ NDArray load_array(const std::string& fname) {
   return array;
 }
 
+NDArray load_array(const std::string& fname) {
+  auto buffer = std::make_shared<FileBuffer>(fname);
+  return array_from_buffer(buffer, buffer->data(), buffer->size(), fname);
+}
+
 }  // namespace npy
 
 namespace npz {
@@ -522,22 +530,73 @@ uint32_t parse_npy_header_len(mz_zip_reader_extract_iter_state* state,
   uint8_t major_version = buffer[6];
   CHECK(major_version == 0x01 || major_version == 0x02) << "Unsupported npy major version";
   CHECK(buffer[7] == 0x00) << "Unsupported npy minor version";
-  uint32_t header_len = 0;
-  header_len += buffer[8];
-  header_len += buffer[9] >> 8;
+  uint32_t header_len = static_cast<uint8_t>(buffer[8]) | static_cast<uint8_t>(buffer[9]) << 8;
   if (major_version == 0x02) {
     CHECK_EQ(mz_zip_reader_extract_iter_read(state, &buffer[10], 2), 2)
         << "Failed to read from " << fname << " member of " << zip_fname;
-    header_len += buffer[10] >> 16;
-    header_len += buffer[11] >> 24;
+    header_len |= static_cast<uint32_t>(static_cast<uint8_t>(buffer[10])) << 16 |
+                  static_cast<uint32_t>(static_cast<uint8_t>(buffer[11])) << 24;
   }
   return header_len;
 }
 
+// Offset in the archive of the data of a member, which follows its local header
+size_t member_data_offset(const FileBuffer& buffer,
+                          const mz_zip_archive_file_stat& stat,
+                          const std::string& zip_fname) {
+  constexpr size_t kLocalHeaderSize = 30;
+  const size_t header_ofs           = stat.m_local_header_ofs;
+  CHECK_LE(header_ofs + kLocalHeaderSize, buffer.size())
+      << "Invalid " << stat.m_filename << " member of " << zip_fname;
+  const auto* bytes = reinterpret_cast<const uint8_t*>(buffer.data() + header_ofs);
+  CHECK(bytes[0] == 0x50 && bytes[1] == 0x4b && bytes[2] == 0x03 && bytes[3] == 0x04)
+      << "Invalid local header of " << stat.m_filename << " member of " << zip_fname;
+  const size_t name_len  = bytes[26] | bytes[27] << 8;
+  const size_t extra_len = bytes[28] | bytes[29] << 8;
+  return header_ofs + kLocalHeaderSize + name_len + extra_len;
+}
+
+// Compressed member whose npy header is parsed, inflated in the buffer of its array
+struct InflateTask {
+  mz_zip_reader_extract_iter_state* file;
+  std::string path;
+  size_t array_index;
+  bool fortran_order;
+  std::vector<dim_t> shape;
+};
+
+// Run fn(i) for i in [0, n) on up to one thread per core, and rethrow the first error
+template <typename Fn>
+void parallel_for(size_t n, Fn fn) {
+  const size_t num_threads = std::min<size_t>(n, std::max(1U, std::thread::hardware_concurrency()));
+  std::atomic<size_t> next{0};
+  std::vector<std::exception_ptr> errors(num_threads);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      try {
+        for (size_t i; (i = next++) < n;)
+          fn(i);
+      } catch (...) {
+        errors[t] = std::current_exception();
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  for (const auto& error : errors) {
+    if (error)
+      std::rethrow_exception(error);
+  }
+}
+
 std::pair<std::vector<NDArray>, std::vector<std::string>> load_arrays(
     const std::string& zip_fname) {
+  // members are read from the mapped archive: stored arrays are views of the mapping and
+  // compressed ones are inflated in parallel, each straight into the buffer of its array
+  auto buffer = std::make_shared<FileBuffer>(zip_fname);
   mz_zip_archive archive{};
-  CHECK(mz_zip_reader_init_file(&archive, zip_fname.data(), 0))
+  CHECK(mz_zip_reader_init_mem(&archive, buffer->data(), buffer->size(), 0))
       << "Failed to open archive " << zip_fname << ": "
       << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
 
@@ -572,6 +631,7 @@ std::pair<std::vector<NDArray>, std::vector<std::string>> load_arrays(
   // Return values
   std::vector<NDArray> arrays;
   std::vector<std::string> return_names;
+  std::vector<InflateTask> inflate_tasks;
 
   // Patterns used by SciPy to save respective sparse matrix formats to a file
   const std::set<std::string> bsr_csr_csc_pattern{
@@ -895,8 +955,22 @@ std::pair<std::vector<NDArray>, std::vector<std::string>> load_arrays(
       for (const std::string& fname : dircontents) {
         std::string path(dirname);
         path += fname;
-        mz_zip_reader_extract_iter_state* file =
-            mz_zip_reader_extract_file_iter_new(&archive, path.data(), 0);
+        const int index = mz_zip_reader_locate_file(&archive, path.data(), nullptr, 0);
+        mz_zip_archive_file_stat stat;
+        CHECK(index >= 0 && mz_zip_reader_file_stat(&archive, index, &stat))
+            << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
+        return_names.emplace_back(path.substr(0, path.size() - 4));
+
+        if (stat.m_method == 0 && !stat.m_is_encrypted) {  // stored, as by numpy.savez
+          const size_t offset = member_data_offset(*buffer, stat, zip_fname);
+          CHECK_LE(offset + stat.m_uncomp_size, buffer->size())
+              << "Truncated " << path << " member of " << zip_fname;
+          arrays.push_back(npy::array_from_buffer(
+              buffer, buffer->data() + offset, stat.m_uncomp_size, path));
+          continue;
+        }
+
+        mz_zip_reader_extract_iter_state* file = mz_zip_reader_extract_iter_new(&archive, index, 0);
         CHECK(nullptr != file) << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
 
         uint32_t header_len = parse_npy_header_len(file, path, zip_fname);
@@ -912,24 +986,29 @@ std::pair<std::vector<NDArray>, std::vector<std::string>> load_arrays(
         }
 
         TShape tshape(shape);
-        NDArray array(tshape, Context::CPU(), false, type_flag);
-        const TBlob& blob = array.data();
-        size_t nbytes     = blob.Size() * mshadow::mshadow_sizeof(blob.type_flag_);
-        CHECK_EQ(mz_zip_reader_extract_iter_read(file, blob.dptr_, nbytes), nbytes)
-            << "Failed to read from " << fname << " member of " << zip_fname << ": "
-            << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
-        CHECK(mz_zip_reader_extract_iter_free(file));
-
-        if (fortran_order) {
-          array = fortran_order_transpose(shape, type_flag, array);
-        }
-
-        arrays.push_back(array);
-        return_names.emplace_back(path.substr(0, path.size() - 4));
+        inflate_tasks.push_back({file, path, arrays.size(), fortran_order, shape});
+        arrays.emplace_back(tshape, Context::CPU(), false, type_flag);
       }
     }
   }
 
+  // each member has its own inflate state, and reading from an archive in memory is stateless
+  parallel_for(inflate_tasks.size(), [&](size_t i) {
+    const InflateTask& task = inflate_tasks[i];
+    const TBlob& blob       = arrays[task.array_index].data();
+    size_t nbytes           = blob.Size() * mshadow::mshadow_sizeof(blob.type_flag_);
+    CHECK_EQ(mz_zip_reader_extract_iter_read(task.file, blob.dptr_, nbytes), nbytes)
+        << "Failed to inflate " << task.path << " member of " << zip_fname;
+    CHECK(mz_zip_reader_extract_iter_free(task.file))
+        << "Failed to inflate " << task.path << " member of " << zip_fname;
+  });
+  for (InflateTask& task : inflate_tasks) {
+    if (task.fortran_order) {
+      NDArray& array = arrays[task.array_index];
+      array          = fortran_order_transpose(task.shape, array.dtype(), array);
+    }
+  }
+
   mz_zip_reader_end(&archive);
 
   return std::make_pair(arrays, return_names);
@@ -0,0 +1,83 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file file_buffer.cc
+ * \brief Content of a file in memory, memory-mapped when local
+ */
+#include "file_buffer.h"
+#include <dmlc/io.h>
+#include <dmlc/logging.h>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <cerrno>
+#include <cstring>
+#include <memory>
+
+namespace mxnet {
+
+FileBuffer::FileBuffer(const std::string& fname) {
+  std::string path = fname;
+  if (path.compare(0, 7, "file://") == 0)
+    path = path.substr(7);
+#if !defined(_WIN32)
+  if (path.find("://") == std::string::npos) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    CHECK_GE(fd, 0) << "Failed to open " << fname << ": " << strerror(errno);
+    struct stat st;
+    CHECK_EQ(fstat(fd, &st), 0) << "Failed to stat " << fname << ": " << strerror(errno);
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+      // private writable mapping: arrays written to get their own copy of the pages
+      void* addr = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+      CHECK(addr != MAP_FAILED) << "Failed to map " << fname << ": " << strerror(errno);
+      data_ = static_cast<char*>(addr);
+    }
+    close(fd);
+    mapped_ = true;
+    return;
+  }
+#endif
+  std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(fname.c_str(), "r"));
+  char block[1 << 16];
+  for (size_t n; (n = fi->Read(block, sizeof(block))) > 0;)
+    heap_.insert(heap_.end(), block, block + n);
+  data_ = heap_.data();
+  size_ = heap_.size();
+}
+
+FileBuffer::~FileBuffer() {
+#if !defined(_WIN32)
+  if (mapped_ && data_ != nullptr)
+    munmap(data_, size_);
+#endif
+}
+
+void FileBuffer::Prefetch() {
+#if !defined(_WIN32)
+  if (mapped_ && data_ != nullptr)
+    madvise(data_, size_, MADV_WILLNEED);
+#endif
+}
+
+}  // namespace mxnet
@@ -0,0 +1,63 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file file_buffer.h
+ * \brief Content of a file in memory, memory-mapped when local
+ */
+#ifndef MXNET_SERIALIZATION_FILE_BUFFER_H_
+#define MXNET_SERIALIZATION_FILE_BUFFER_H_
+
+#include <string>
+#include <vector>
+
+namespace mxnet {
+
+/*!
+ * \brief Content of a file, shared by the arrays viewing it. Local files are memory-mapped
+ *        copy-on-write, so that arrays viewing them can be written to. Other files, and all files
+ *        on Windows, are read in memory.
+ */
+class FileBuffer {
+ public:
+  explicit FileBuffer(const std::string& fname);
+  ~FileBuffer();
+  FileBuffer(const FileBuffer&) = delete;
+  FileBuffer& operator=(const FileBuffer&) = delete;
+
+  /*! \brief Start reading the whole file in the background, before it is used */
+  void Prefetch();
+
+  char* data() const {
+    return data_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+ private:
+  char* data_  = nullptr;
+  size_t size_ = 0;
+  bool mapped_ = false;
+  std::vector<char> heap_;
+};
+
+}  // namespace mxnet
+#endif  // MXNET_SERIALIZATION_FILE_BUFFER_H_
@@ -0,0 +1,214 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file mapped_params.cc
+ * \brief Memory-mapped parameter files
+ */
+#include "mapped_params.h"
+#include <dmlc/io.h>
+#include <mxnet/engine.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include "file_buffer.h"
+
+namespace mxnet {
+namespace mapped_params {
+
+namespace {
+
+// the chunks of an array uploaded to a device are separate copies run in parallel by the engine
+constexpr size_t kUploadChunkBytes = 32 << 20;
+
+size_t Align(size_t offset) {
+  return (offset + kMappedParamsAlignment - 1) / kMappedParamsAlignment * kMappedParamsAlignment;
+}
+
+/*! \brief Bounds checked reader of the header */
+class HeaderReader {
+ public:
+  HeaderReader(const FileBuffer& buffer, const std::string& fname)
+      : buffer_(buffer), fname_(fname) {}
+
+  template <typename T>
+  T Read() {
+    T value;
+    ReadBytes(&value, sizeof(T));
+    return value;
+  }
+
+  void ReadBytes(void* dst, size_t n) {
+    CHECK_LE(pos_ + n, buffer_.size()) << "Truncated mapped parameter file " << fname_;
+    std::memcpy(dst, buffer_.data() + pos_, n);
+    pos_ += n;
+  }
+
+ private:
+  const FileBuffer& buffer_;
+  const std::string& fname_;
+  size_t pos_ = 0;
+};
+
+NDArray UploadInChunks(const std::shared_ptr<FileBuffer>& buffer,
+                       char* src,
+                       const mxnet::TShape& shape,
+                       int dtype,
+                       const Context& ctx) {
+  NDArray dst(shape, ctx, false, dtype);
+  const size_t elem_size   = mshadow::mshadow_sizeof(dtype);
+  const size_t size        = shape.Size();
+  const size_t chunk_elems = std::max<size_t>(1, kUploadChunkBytes / elem_size);
+  char* dst_ptr            = static_cast<char*>(dst.data().dptr_);
+  std::vector<NDArray> chunks;
+  std::vector<engine::VarHandle> chunk_vars;
+  for (size_t begin = 0; begin < size; begin += chunk_elems) {
+    const mxnet::TShape chunk_shape(1, std::min(chunk_elems, size - begin));
+    NDArray src_chunk(TBlob(src + begin * elem_size, chunk_shape, cpu::kDevMask, dtype, 0),
+                      0,
+                      [buffer]() {});
+    NDArray dst_chunk(
+        TBlob(dst_ptr + begin * elem_size, chunk_shape, ctx.dev_mask(), dtype, ctx.dev_id),
+        ctx.dev_id);
+    CopyFromTo(src_chunk, dst_chunk);
+    chunks.push_back(dst_chunk);
+    chunk_vars.push_back(dst_chunk.var());
+  }
+  // the array is ready once all its chunks are
+  Engine::Get()->PushSync([chunks](RunContext) {},
+                          ctx,
+                          chunk_vars,
+                          {dst.var()},
+                          FnProperty::kNormal,
+                          0,
+                          "MappedParamsUpload");
+  return dst;
+}
+
+}  // namespace
+
+void save_arrays(const std::string& fname,
+                 const std::vector<NDArray>& arrays,
+                 const std::vector<std::string>& names) {
+  CHECK(names.empty() || names.size() == arrays.size())
+      << "Number of names and arrays to save differ";
+  std::vector<NDArray> cpu_arrays;
+  size_t header_size = 2 * sizeof(uint32_t) + 2 * sizeof(uint64_t);
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    const NDArray& array = arrays[i];
+    CHECK(!array.is_none() && array.storage_type() == kDefaultStorage)
+        << "Mapped parameter files only hold dense arrays";
+    CHECK(shape_is_known(array.shape())) << "Cannot save an array of unknown shape";
+    cpu_arrays.push_back(array.ctx().dev_mask() == cpu::kDevMask ? array :
+                                                                     array.Copy(Context::CPU()));
+    header_size += sizeof(uint64_t) + (names.empty() ? 0 : names[i].size()) +
+                   2 * sizeof(int32_t) + array.shape().ndim() * sizeof(int64_t) +
+                   2 * sizeof(uint64_t);
+  }
+
+  std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(fname.c_str(), "w"));
+  const uint64_t num_arrays = arrays.size(), num_names = names.size();
+  fo->Write(&kMappedParamsMagic, sizeof(kMappedParamsMagic));
+  fo->Write(&kMappedParamsVersion, sizeof(kMappedParamsVersion));
+  fo->Write(&num_arrays, sizeof(num_arrays));
+  fo->Write(&num_names, sizeof(num_names));
+  uint64_t offset = Align(header_size);
+  for (size_t i = 0; i < cpu_arrays.size(); ++i) {
+    const NDArray& array    = cpu_arrays[i];
+    const uint64_t name_len = names.empty() ? 0 : names[i].size();
+    const int32_t dtype     = array.dtype();
+    const int32_t ndim      = array.shape().ndim();
+    const uint64_t nbytes   = array.shape().Size() * mshadow::mshadow_sizeof(dtype);
+    fo->Write(&name_len, sizeof(name_len));
+    if (name_len > 0)
+      fo->Write(names[i].data(), name_len);
+    fo->Write(&dtype, sizeof(dtype));
+    fo->Write(&ndim, sizeof(ndim));
+    for (int j = 0; j < ndim; ++j) {
+      const int64_t dim = array.shape()[j];
+      fo->Write(&dim, sizeof(dim));
+    }
+    fo->Write(&offset, sizeof(offset));
+    fo->Write(&nbytes, sizeof(nbytes));
+    offset = Align(offset + nbytes);
+  }
+
+  const char padding[kMappedParamsAlignment] = {0};
+  size_t written                             = header_size;
+  for (const NDArray& array : cpu_arrays) {
+    fo->Write(padding, Align(written) - written);
+    written = Align(written);
+    array.WaitToRead();
+    const size_t nbytes = array.shape().Size() * mshadow::mshadow_sizeof(array.dtype());
+    fo->Write(array.data().dptr_, nbytes);
+    written += nbytes;
+  }
+}
+
+std::pair<std::vector<NDArray>, std::vector<std::string>> load_arrays(const std::string& fname,
+                                                                      const Context& ctx) {
+  auto buffer = std::make_shared<FileBuffer>(fname);
+  HeaderReader header(*buffer, fname);
+  CHECK_EQ(header.Read<uint32_t>(), kMappedParamsMagic) << "Invalid mapped parameter file "
+                                                        << fname;
+  const uint32_t version = header.Read<uint32_t>();
+  CHECK_LE(version, kMappedParamsVersion)
+      << "Mapped parameter file " << fname << " has version " << version
+      << ", which is newer than the supported version " << kMappedParamsVersion;
+  const uint64_t num_arrays = header.Read<uint64_t>();
+  const uint64_t num_names  = header.Read<uint64_t>();
+  CHECK(num_names == 0 || num_names == num_arrays) << "Invalid mapped parameter file " << fname;
+  const bool upload = ctx.dev_type != Context::kCPU;
+  if (upload)
+    buffer->Prefetch();
+
+  std::vector<NDArray> arrays;
+  std::vector<std::string> names;
+  for (uint64_t i = 0; i < num_arrays; ++i) {
+    const uint64_t name_len = header.Read<uint64_t>();
+    CHECK_LE(name_len, buffer->size()) << "Invalid mapped parameter file " << fname;
+    std::string name(name_len, '\0');
+    header.ReadBytes(&name[0], name.size());
+    const int32_t dtype = header.Read<int32_t>();
+    const int32_t ndim  = header.Read<int32_t>();
+    mxnet::TShape shape(ndim, -1);
+    for (int j = 0; j < ndim; ++j)
+      shape[j] = header.Read<int64_t>();
+    const uint64_t offset = header.Read<uint64_t>();
+    const uint64_t nbytes = header.Read<uint64_t>();
+    CHECK(offset % kMappedParamsAlignment == 0 && offset + nbytes <= buffer->size() &&
+          nbytes == shape.Size() * mshadow::mshadow_sizeof(dtype))
+        << "Invalid entry " << i << " in mapped parameter file " << fname;
+    char* payload = buffer->data() + offset;
+    if (upload) {
+      arrays.push_back(UploadInChunks(buffer, payload, shape, dtype, ctx));
+    } else {
+      // every view holds the mapping, which is unmapped with the last one
+      arrays.emplace_back(TBlob(payload, shape, cpu::kDevMask, dtype, ctx.dev_id),
+                          ctx.dev_id,
+                          [buffer]() {});
+    }
+    if (num_names > 0)
+      names.push_back(std::move(name));
+  }
+  return {arrays, names};
+}
+
+}  // namespace mapped_params
+}  // namespace mxnet
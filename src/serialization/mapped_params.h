@@ -0,0 +1,66 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file mapped_params.h
+ * \brief Parameter file format which can be memory-mapped: a header with the index of the arrays
+ *        followed by their payloads, each aligned to kMappedParamsAlignment bytes.
+ *
+ * Layout, in host byte order:
+ *   uint32 magic, uint32 version, uint64 number of arrays, uint64 number of names (0 or the
+ *   number of arrays),
+ *   per array: uint64 name length, name, int32 dtype, int32 ndim, int64 shape[ndim],
+ *              uint64 payload offset from the start of the file, uint64 payload bytes,
+ *   the payloads.
+ */
+#ifndef MXNET_SERIALIZATION_MAPPED_PARAMS_H_
+#define MXNET_SERIALIZATION_MAPPED_PARAMS_H_
+
+#include <mxnet/ndarray.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mxnet {
+namespace mapped_params {
+
+/*! \brief First bytes of a mapped parameter file, "MXMA" */
+constexpr uint32_t kMappedParamsMagic   = 0x414d584d;
+constexpr uint32_t kMappedParamsVersion = 1;
+constexpr size_t kMappedParamsAlignment = 64;
+
+/*!
+ * \brief Save dense arrays, from any context. Names are optional, as for NDArray::Save.
+ */
+void save_arrays(const std::string& fname,
+                 const std::vector<NDArray>& arrays,
+                 const std::vector<std::string>& names);
+
+/*!
+ * \brief Load the arrays of a file. Local files are memory-mapped copy-on-write, and the arrays
+ *        of a CPU context are views of the mapping, which lives as long as one of them. Arrays of
+ *        a GPU context are uploaded from the mapping in chunks run in parallel by the engine.
+ *        Other files are read in memory first.
+ */
+std::pair<std::vector<NDArray>, std::vector<std::string>> load_arrays(const std::string& fname,
+                                                                      const Context& ctx);
+
+}  // namespace mapped_params
+}  // namespace mxnet
+#endif  // MXNET_SERIALIZATION_MAPPED_PARAMS_H_
@@ -0,0 +1,161 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file sharded_params.cc
+ * \brief Parameter files split in shards
+ */
+#include "sharded_params.h"
+#include <dmlc/io.h>
+#include <mxnet/imperative.h>
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <numeric>
+#include <thread>
+
+namespace mxnet {
+namespace sharded_params {
+
+namespace {
+
+/*! \brief Run fn(shard) for every shard on its own thread, and rethrow the first error */
+template <typename Fn>
+void ForEachShard(size_t num_shards, Fn fn) {
+  // the np shape semantics of the caller apply to the serialization
+  const int np_shape = Imperative::Get()->is_np_shape();
+  std::vector<std::exception_ptr> errors(num_shards);
+  std::vector<std::thread> threads;
+  for (size_t shard = 0; shard < num_shards; ++shard) {
+    threads.emplace_back([&, shard]() {
+      try {
+        if (np_shape == NumpyShape::ThreadLocalOn)
+          Imperative::Get()->set_is_np_shape(np_shape);
+        fn(shard);
+      } catch (...) {
+        errors[shard] = std::current_exception();
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  for (const auto& error : errors) {
+    if (error)
+      std::rethrow_exception(error);
+  }
+}
+
+}  // namespace
+
+std::string ShardFileName(const std::string& fname, size_t shard, size_t num_shards) {
+  return fname + ".shard-" + std::to_string(shard) + "-of-" + std::to_string(num_shards);
+}
+
+void save_arrays(const std::string& fname,
+                 const std::vector<NDArray>& arrays,
+                 const std::vector<std::string>& names,
+                 size_t num_shards) {
+  CHECK_GT(num_shards, 0U) << "A sharded parameter file needs at least one shard";
+  CHECK(names.empty() || names.size() == arrays.size())
+      << "Number of names and arrays to save differ";
+  // the largest arrays first, each to the shard with the fewest bytes yet
+  auto nbytes = [&](size_t i) -> size_t {
+    const NDArray& array = arrays[i];
+    if (array.is_none())
+      return 0;
+    return array.shape().Size() * mshadow::mshadow_sizeof(array.dtype());
+  };
+  std::vector<size_t> order(arrays.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(
+      order.begin(), order.end(), [&](size_t a, size_t b) { return nbytes(a) > nbytes(b); });
+  std::vector<uint32_t> shard_of(arrays.size());
+  std::vector<size_t> shard_bytes(num_shards, 0);
+  for (size_t i : order) {
+    const size_t shard =
+        std::min_element(shard_bytes.begin(), shard_bytes.end()) - shard_bytes.begin();
+    shard_of[i] = static_cast<uint32_t>(shard);
+    shard_bytes[shard] += nbytes(i);
+  }
+
+  ForEachShard(num_shards, [&](size_t shard) {
+    std::vector<NDArray> shard_arrays;
+    std::vector<std::string> shard_names;
+    for (size_t i = 0; i < arrays.size(); ++i) {
+      if (shard_of[i] != shard)
+        continue;
+      shard_arrays.push_back(arrays[i]);
+      if (!names.empty())
+        shard_names.push_back(names[i]);
+    }
+    std::unique_ptr<dmlc::Stream> fo(
+        dmlc::Stream::Create(ShardFileName(fname, shard, num_shards).c_str(), "w"));
+    NDArray::Save(fo.get(), shard_arrays, shard_names);
+  });
+
+  // the index is written last, so that it only exists once all the shards do
+  std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(fname.c_str(), "w"));
+  const uint64_t header = kShardedParamsMagic, reserved = 0, num_shards64 = num_shards;
+  fo->Write(&header, sizeof(header));
+  fo->Write(&reserved, sizeof(reserved));
+  fo->Write(&num_shards64, sizeof(num_shards64));
+  fo->Write(shard_of);
+}
+
+std::pair<std::vector<NDArray>, std::vector<std::string>> load_arrays(const std::string& fname) {
+  uint64_t header, reserved, num_shards;
+  std::vector<uint32_t> shard_of;
+  {
+    std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(fname.c_str(), "r"));
+    CHECK(fi->Read(&header) && header == kShardedParamsMagic)
+        << "Invalid sharded parameter file " << fname;
+    CHECK(fi->Read(&reserved) && fi->Read(&num_shards) && fi->Read(&shard_of))
+        << "Invalid sharded parameter file " << fname;
+  }
+  for (uint32_t shard : shard_of)
+    CHECK_LT(shard, num_shards) << "Invalid sharded parameter file " << fname;
+
+  std::vector<std::vector<NDArray>> shard_arrays(num_shards);
+  std::vector<std::vector<std::string>> shard_names(num_shards);
+  ForEachShard(num_shards, [&](size_t shard) {
+    const std::string shard_fname = ShardFileName(fname, shard, num_shards);
+    std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(shard_fname.c_str(), "r"));
+    NDArray::Load(fi.get(), &shard_arrays[shard], &shard_names[shard]);
+    CHECK_EQ(shard_arrays[shard].size(),
+             static_cast<size_t>(std::count(shard_of.begin(), shard_of.end(), shard)))
+        << "Shard " << shard_fname << " does not match its index " << fname;
+  });
+
+  // the arrays of every shard follow the order of the index
+  const bool named = std::any_of(
+      shard_names.begin(), shard_names.end(), [](const auto& n) { return !n.empty(); });
+  std::vector<NDArray> arrays;
+  std::vector<std::string> names;
+  std::vector<size_t> next(num_shards, 0);
+  for (uint32_t shard : shard_of) {
+    arrays.push_back(shard_arrays[shard][next[shard]]);
+    if (named)
+      names.push_back(shard_names[shard][next[shard]]);
+    ++next[shard];
+  }
+  return {arrays, names};
+}
+
+}  // namespace sharded_params
+}  // namespace mxnet
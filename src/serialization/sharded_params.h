@@ -0,0 +1,59 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file sharded_params.h
+ * \brief Parameter files split in shards, saved and loaded by one thread per shard.
+ *
+ * The file itself is an index: uint64 magic, uint64 reserved, uint64 number of shards and the
+ * vector of the shard of every array, in order. Each shard is a file of the NDArray::Save
+ * format next to it, named by ShardFileName, holding its arrays in order.
+ */
+#ifndef MXNET_SERIALIZATION_SHARDED_PARAMS_H_
+#define MXNET_SERIALIZATION_SHARDED_PARAMS_H_
+
+#include <mxnet/ndarray.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mxnet {
+namespace sharded_params {
+
+/*! \brief First bytes of a sharded parameter index, next to the 0x112 of NDArray::Save */
+constexpr uint64_t kShardedParamsMagic = 0x113;
+
+/*! \brief Name of a shard: <fname>.shard-<shard>-of-<num_shards> */
+std::string ShardFileName(const std::string& fname, size_t shard, size_t num_shards);
+
+/*!
+ * \brief Save the arrays in num_shards files of about the same size, written in parallel.
+ *        Names are optional, as for NDArray::Save.
+ */
+void save_arrays(const std::string& fname,
+                 const std::vector<NDArray>& arrays,
+                 const std::vector<std::string>& names,
+                 size_t num_shards);
+
+/*! \brief Load the arrays of all the shards, read in parallel, in the order they were saved */
+std::pair<std::vector<NDArray>, std::vector<std::string>> load_arrays(const std::string& fname);
+
+}  // namespace sharded_params
+}  // namespace mxnet
+#endif  // MXNET_SERIALIZATION_SHARDED_PARAMS_H_
@@ -25,6 +25,7 @@
 #define MXNET_STORAGE_CPU_DEVICE_STORAGE_H_
 
 #include "mxnet/base.h"
+#include "../common/huge_pages.h"
 
 namespace mxnet {
 namespace storage {
@@ -60,7 +61,9 @@ class CPUDeviceStorage {
 };  // class CPUDeviceStorage
 
 inline void CPUDeviceStorage::Alloc(Storage::Handle* handle, bool /* failsafe */) {
-  bool success = mxnet::common::AlignedMemAlloc(&(handle->dptr), handle->size, alignment_);
+  bool success = mxnet::common::UseHugePages(handle->size) ?
+                     mxnet::common::HugePageMemAlloc(&(handle->dptr), handle->size) :
+                     mxnet::common::AlignedMemAlloc(&(handle->dptr), handle->size, alignment_);
   if (!success)
     LOG(FATAL) << "Failed to allocate CPU Memory";
 }
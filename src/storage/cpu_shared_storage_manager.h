@@ -26,26 +26,41 @@
 #include <sys/mman.h>
 #include <sys/fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #else
 #include <Windows.h>
 #include <process.h>
 #endif  // _WIN32
 
+#include <dmlc/parameter.h>
+#include <list>
 #include <string>
 #include <limits>
+#include <unordered_set>
 #include "./storage_manager.h"
 
 namespace mxnet {
 namespace storage {
 /*!
  * \brief Storage manager for cpu shared memory
+ *
+ * On Linux, segments can be recycled instead of unmapped when they are freed,
+ * up to MXNET_CPU_SHARED_MEM_POOL_SIZE bytes per process:
+ *  - segments created by this process are reused by later allocations of the same
+ *    rounded size, once every process they were shared with has freed them;
+ *  - mappings of segments received from other processes are kept, keyed by inode,
+ *    and reused when the same segment is received again.
+ * In the steady state of a batch hand-off between processes, no segment is created,
+ * mapped or faulted in.
  */
 class CPUSharedStorageManager final : public StorageManager {
  public:
   /*!
    * \brief Default constructor.
    */
-  CPUSharedStorageManager() : rand_gen_(std::random_device()()) {}
+  CPUSharedStorageManager()
+      : rand_gen_(std::random_device()()),
+        recycle_limit_(dmlc::GetEnv("MXNET_CPU_SHARED_MEM_POOL_SIZE", size_t(0))) {}
   /*!
    * \brief Default destructor.
    */
@@ -53,6 +68,10 @@ class CPUSharedStorageManager final : public StorageManager {
     for (const auto& kv : pool_) {
       FreeImpl(kv.second);
     }
+#ifdef __linux__
+    recycle_limit_ = 0;
+    TrimRecycled();
+#endif
 #ifdef _WIN32
     CheckAndRealFree();
 #endif
@@ -69,6 +88,16 @@ class CPUSharedStorageManager final : public StorageManager {
     Free(handle);
   }
 
+  void ReleaseAll() override {
+#ifdef __linux__
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    const size_t limit = recycle_limit_;
+    recycle_limit_     = 0;
+    TrimRecycled();
+    recycle_limit_ = limit;
+#endif
+  }
+
   void IncrementRefCount(const Storage::Handle& handle) {
     std::atomic<int>* counter =
         reinterpret_cast<std::atomic<int>*>(static_cast<char*>(handle.dptr) - alignment_);
@@ -87,6 +116,87 @@ class CPUSharedStorageManager final : public StorageManager {
   std::recursive_mutex mutex_;
   std::mt19937 rand_gen_;
   std::unordered_map<void*, Storage::Handle> pool_;
+#ifdef __linux__
+  /*! \brief a mapped segment kept for reuse */
+  struct Segment {
+    // start of the mapping, where the reference counter lives
+    void* base;
+    // mapped bytes, a multiple of the page size
+    size_t size;
+    // descriptor of a segment created by this process, -1 for a received one
+    int fid;
+    // inode of a received segment
+    ino_t inode;
+  };
+  /*! \brief maximum number of bytes of recycled segments */
+  size_t recycle_limit_;
+  /*! \brief number of bytes of recycled segments */
+  size_t recycled_bytes_ = 0;
+  /*! \brief recycled segments, least recently freed first */
+  std::list<Segment> recycled_;
+  /*! \brief data pointers of the segments created by this process */
+  std::unordered_set<void*> created_;
+
+  /*! \return size of the mapping of a segment of a given data size */
+  static size_t MappedSize(size_t size) {
+    static const size_t page = sysconf(_SC_PAGESIZE);
+    return (size + alignment_ + page - 1) / page * page;
+  }
+  /*! \brief keep a freed segment for reuse */
+  void Recycle(const Segment& segment) {
+    recycled_.push_back(segment);
+    recycled_bytes_ += segment.size;
+    TrimRecycled();
+  }
+  /*! \brief unmap the least recently freed segments above the limit */
+  void TrimRecycled() {
+    while (recycled_bytes_ > recycle_limit_ && !recycled_.empty()) {
+      const Segment& segment = recycled_.front();
+      CHECK_EQ(munmap(segment.base, segment.size), 0)
+          << "Failed to unmap shared memory. munmap failed with error " << strerror(errno);
+      if (segment.fid != -1) {
+        CHECK_EQ(close(segment.fid), 0)
+            << "Failed to close shared memory. close failed with error " << strerror(errno);
+      }
+      recycled_bytes_ -= segment.size;
+      recycled_.pop_front();
+    }
+  }
+  /*!
+   * \brief take a recycled segment out of the pool.
+   * \param fid -1 to look for a segment created by this process, which every other
+   *  process has freed, otherwise the descriptor of a received segment.
+   * \param size mapped size required.
+   * \param own_fid will receive the descriptor of a segment created by this process.
+   * \return the segment base, nullptr if none matches.
+   */
+  void* Reuse(int fid, size_t size, int* own_fid) {
+    ino_t inode = 0;
+    if (fid != -1) {
+      struct stat st;
+      if (fstat(fid, &st) != 0)
+        return nullptr;
+      inode = st.st_ino;
+    }
+    for (auto it = recycled_.begin(); it != recycled_.end(); ++it) {
+      bool match;
+      if (fid == -1) {
+        match = it->fid != -1 && it->size == size &&
+                reinterpret_cast<std::atomic<int>*>(it->base)->load() == 0;
+      } else {
+        match = it->fid == -1 && it->inode == inode && it->size == size;
+      }
+      if (match) {
+        void* base = it->base;
+        *own_fid   = it->fid;
+        recycled_bytes_ -= it->size;
+        recycled_.erase(it);
+        return base;
+      }
+    }
+    return nullptr;
+  }
+#endif  // __linux__
 #ifdef _WIN32
   std::unordered_map<void*, Storage::Handle> is_free_;
   std::unordered_map<void*, HANDLE> map_handle_map_;
@@ -144,6 +254,26 @@ void CPUSharedStorageManager::Alloc(Storage::Handle* handle, bool /* failsafe */
                           << GetLastError();
   map_handle_map_[ptr] = map_handle;
 #else
+#ifdef __linux__
+  if (recycle_limit_) {
+    const bool is_new_segment = handle->shared_id == -1 && handle->shared_pid == -1;
+    int own_fid               = -1;
+    void* base                = Reuse(handle->shared_id, MappedSize(handle->size), &own_fid);
+    if (base) {
+      if (is_new_segment) {
+        // every process it was shared with has freed it
+        reinterpret_cast<std::atomic<int>*>(base)->store(1);
+        handle->shared_pid = getpid();
+        handle->shared_id  = own_fid;
+      }
+      handle->dptr = static_cast<char*>(base) + alignment_;
+      if (is_new_segment)
+        created_.insert(handle->dptr);
+      pool_[handle->dptr] = *handle;
+      return;
+    }
+  }
+#endif  // __linux__
   if (handle->shared_id == -1 && handle->shared_pid == -1) {
     is_new             = true;
     handle->shared_pid = getpid();
@@ -194,6 +324,10 @@ void CPUSharedStorageManager::Alloc(Storage::Handle* handle, bool /* failsafe */
   }
   handle->dptr        = static_cast<char*>(ptr) + alignment_;
   pool_[handle->dptr] = *handle;
+#ifdef __linux__
+  if (is_new)
+    created_.insert(handle->dptr);
+#endif  // __linux__
 }
 
 void CPUSharedStorageManager::FreeImpl(const Storage::Handle& handle) {
@@ -202,6 +336,28 @@ void CPUSharedStorageManager::FreeImpl(const Storage::Handle& handle) {
 #ifdef _WIN32
   is_free_[handle.dptr] = handle;
 #else
+#ifdef __linux__
+  const bool created = created_.erase(handle.dptr) != 0;
+  if (recycle_limit_) {
+    void* base  = static_cast<char*>(handle.dptr) - alignment_;
+    Segment seg = {base, MappedSize(handle.size), -1, 0};
+    if (created) {
+      // keep the descriptor, the segment is handed out again by Alloc
+      seg.fid = handle.shared_id;
+      Recycle(seg);
+      return;
+    }
+    struct stat st;
+    if (handle.shared_id != -1 && fstat(handle.shared_id, &st) == 0) {
+      // keep the mapping, for when the segment is received again
+      seg.inode = st.st_ino;
+      CHECK_EQ(close(handle.shared_id), 0)
+          << "Failed to close shared memory. close failed with error " << strerror(errno);
+      Recycle(seg);
+      return;
+    }
+  }
+#endif  // __linux__
   CHECK_EQ(munmap(static_cast<char*>(handle.dptr) - alignment_, handle.size + alignment_), 0)
       << "Failed to unmap shared memory. munmap failed with error " << strerror(errno);
 
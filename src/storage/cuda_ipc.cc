@@ -0,0 +1,86 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cuda_ipc.cc
+ * \brief Sharing of device allocations with other processes through CUDA IPC
+ */
+#include "./cuda_ipc.h"
+
+#if MXNET_USE_CUDA
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "../common/cuda/utils.h"
+
+namespace mxnet {
+namespace storage {
+
+namespace {
+
+struct ImportedAllocation {
+  void* base;
+  size_t refs;
+};
+
+std::mutex imported_mutex;
+// opening a handle which is already open in the process fails, so the mappings are shared
+std::unordered_map<std::string, ImportedAllocation> imported;
+
+}  // namespace
+
+cudaIpcMemHandle_t CudaIpcExport(void* base, int dev_id) {
+  mxnet::common::cuda::DeviceStore device_store(dev_id);
+  cudaIpcMemHandle_t handle;
+  const cudaError_t err = cudaIpcGetMemHandle(&handle, base);
+  CHECK_EQ(err, cudaSuccess) << "Failed to export the device allocation: "
+                             << cudaGetErrorString(err)
+                             << ". Only arrays allocated by cudaMalloc can be exported, not by "
+                                "the CudaAsync memory pool.";
+  return handle;
+}
+
+std::shared_ptr<void> CudaIpcImport(const cudaIpcMemHandle_t& handle, int dev_id) {
+  const std::string key(handle.reserved, sizeof(handle.reserved));
+  std::lock_guard<std::mutex> lock(imported_mutex);
+  auto it = imported.find(key);
+  if (it == imported.end()) {
+    mxnet::common::cuda::DeviceStore device_store(dev_id);
+    void* base = nullptr;
+    CUDA_CALL(cudaIpcOpenMemHandle(&base, handle, cudaIpcMemLazyEnablePeerAccess));
+    it = imported.emplace(key, ImportedAllocation{base, 0}).first;
+  }
+  ++it->second.refs;
+  return std::shared_ptr<void>(it->second.base, [key, dev_id](void* base) {
+    std::lock_guard<std::mutex> lock(imported_mutex);
+    auto it = imported.find(key);
+    if (--it->second.refs == 0) {
+      mxnet::common::cuda::DeviceStore device_store(dev_id);
+      const cudaError_t err = cudaIpcCloseMemHandle(base);
+      if (err != cudaSuccess)
+        LOG(WARNING) << "Failed to unmap an imported allocation: " << cudaGetErrorString(err);
+      imported.erase(it);
+    }
+  });
+}
+
+}  // namespace storage
+}  // namespace mxnet
+
+#endif  // MXNET_USE_CUDA
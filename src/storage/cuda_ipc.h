@@ -0,0 +1,54 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cuda_ipc.h
+ * \brief Sharing of device allocations with other processes through CUDA IPC
+ */
+#ifndef MXNET_STORAGE_CUDA_IPC_H_
+#define MXNET_STORAGE_CUDA_IPC_H_
+
+#if MXNET_USE_CUDA
+#include <cuda_runtime.h>
+#include <memory>
+
+namespace mxnet {
+namespace storage {
+
+/*!
+ * \brief Handle for other processes to map a device allocation made by GPUDeviceStorage.
+ * \param base the base of the allocation.
+ * \param dev_id the device of the allocation.
+ */
+cudaIpcMemHandle_t CudaIpcExport(void* base, int dev_id);
+
+/*!
+ * \brief Map a device allocation of another process. An allocation imported several times is
+ *        mapped once, and unmapped once the last pointer to it is released.
+ * \param handle the handle exported by the other process.
+ * \param dev_id the device of the allocation.
+ * \return the base of the allocation in this process.
+ */
+std::shared_ptr<void> CudaIpcImport(const cudaIpcMemHandle_t& handle, int dev_id);
+
+}  // namespace storage
+}  // namespace mxnet
+
+#endif  // MXNET_USE_CUDA
+#endif  // MXNET_STORAGE_CUDA_IPC_H_
@@ -0,0 +1,161 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file gpu_async_storage_manager.h
+ * \brief GPU storage manager using the stream-ordered memory pool of CUDA.
+ */
+#ifndef MXNET_STORAGE_GPU_ASYNC_STORAGE_MANAGER_H_
+#define MXNET_STORAGE_GPU_ASYNC_STORAGE_MANAGER_H_
+
+#if MXNET_USE_CUDA
+#include <cuda.h>
+#include <cuda_runtime.h>
+#include <cstdint>
+#include <mutex>
+#include "./storage_manager.h"
+#include "../common/cuda/utils.h"
+#include "../profiler/storage_profiler.h"
+
+/*! \brief whether the CUDA runtime provides stream-ordered allocations */
+#define MXNET_CUDA_HAS_MALLOC_ASYNC (CUDA_VERSION >= 11020)
+
+namespace mxnet {
+namespace storage {
+
+#if MXNET_CUDA_HAS_MALLOC_ASYNC
+/*!
+ * \brief Storage manager backed by the default memory pool of a GPU
+ *  (cudaMallocAsync/cudaFreeAsync).
+ *
+ * Frees are queued on a stream of the manager behind the events of the
+ * engine variable, so they neither block the host nor synchronize the device.
+ * The driver reuses the freed memory for later allocations and sub-allocates
+ * blocks of different sizes from the same reservations, which keeps fragmentation
+ * low when shapes change. Since the memory may come from frees still pending on the
+ * stream of the manager, an allocation made by a GPU worker of the engine makes the
+ * stream of the worker wait on an event recorded after it; other threads, which have
+ * no stream to order, wait for the stream of the manager on the host.
+ * Selected by MXNET_GPU_MEM_POOL_TYPE=Async.
+ */
+class GPUAsyncStorageManager final : public StorageManager {
+ public:
+  explicit GPUAsyncStorageManager(const Context& ctx) : ctx_(ctx) {
+    mxnet::common::cuda::DeviceStore device_store(ctx_.real_dev_id(), true);
+    int supported = 0;
+    CUDA_CALL(cudaDeviceGetAttribute(
+        &supported, cudaDevAttrMemoryPoolsSupported, ctx_.real_dev_id()));
+    CHECK(supported) << "MXNET_GPU_MEM_POOL_TYPE=Async requires a GPU and a driver "
+                     << "with memory pool support, GPU " << ctx_.real_dev_id() << " has none";
+    CUDA_CALL(cudaDeviceGetDefaultMemPool(&pool_, ctx_.real_dev_id()));
+    // keep freed memory reserved across synchronizations, ReleaseAll trims it
+    uint64_t threshold = UINT64_MAX;
+    CUDA_CALL(cudaMemPoolSetAttribute(pool_, cudaMemPoolAttrReleaseThreshold, &threshold));
+    CUDA_CALL(cudaStreamCreateWithFlags(&stream_, cudaStreamNonBlocking));
+    CUDA_CALL(cudaEventCreateWithFlags(&alloc_event_, cudaEventDisableTiming));
+  }
+  /*!
+   * \brief Default destructor.
+   */
+  ~GPUAsyncStorageManager() override {
+    // the CUDA runtime may already be unloaded at exit, errors are ignored
+    mxnet::common::cuda::DeviceStore device_store(ctx_.real_dev_id(), true);
+    if (cudaStreamSynchronize(stream_) == cudaSuccess)
+      cudaMemPoolTrimTo(pool_, 0);
+    cudaEventDestroy(alloc_event_);
+    cudaStreamDestroy(stream_);
+  }
+
+  void Alloc(Storage::Handle* handle, bool failsafe) override {
+    mxnet::common::cuda::DeviceStore device_store(handle->ctx.real_dev_id(), true);
+    std::lock_guard<std::mutex> lock(mutex_);
+    cudaError_t err = cudaMallocAsync(&handle->dptr, handle->size, pool_, stream_);
+    if (err == cudaErrorMemoryAllocation) {
+      // retry after giving the reserved, unused memory back to the device
+      cudaGetLastError();
+      CUDA_CALL(cudaStreamSynchronize(stream_));
+      CUDA_CALL(cudaMemPoolTrimTo(pool_, 0));
+      err = cudaMallocAsync(&handle->dptr, handle->size, pool_, stream_);
+    }
+    if (failsafe && err == cudaErrorMemoryAllocation) {
+      // Clear sticky cuda mem alloc error
+      cudaGetLastError();
+      handle->dptr = nullptr;
+      return;
+    }
+    CUDA_CALL(err);
+    // the chunk may be reused from frees still pending on stream_
+    cudaStream_t consumer = Storage::ConsumerStream();
+    if (consumer != nullptr) {
+      CUDA_CALL(cudaEventRecord(alloc_event_, stream_));
+      CUDA_CALL(cudaStreamWaitEvent(consumer, alloc_event_, 0));
+    } else {
+      CUDA_CALL(cudaStreamSynchronize(stream_));
+    }
+    profiler::GpuDeviceStorageProfiler::Get()->OnAlloc(*handle, handle->size, false);
+  }
+
+  void Free(Storage::Handle handle) override {
+    mxnet::common::cuda::DeviceStore device_store(handle.ctx.real_dev_id(), true);
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto ev : handle.sync_obj.events) {
+      auto valid_ev = ev.lock();
+      if (valid_ev) {
+        CUDA_CALL(cudaStreamWaitEvent(stream_, *valid_ev, 0));
+      }
+    }
+    CUDA_CALL(cudaFreeAsync(handle.dptr, stream_));
+    profiler::GpuDeviceStorageProfiler::Get()->OnFree(handle);
+  }
+
+  void DirectFree(Storage::Handle handle) override {
+    Free(handle);
+    std::lock_guard<std::mutex> lock(mutex_);
+    CUDA_CALL(cudaStreamSynchronize(stream_));
+    CUDA_CALL(cudaMemPoolTrimTo(pool_, 0));
+  }
+
+  void ReleaseAll() override {
+    mxnet::common::cuda::DeviceStore device_store(ctx_.real_dev_id(), true);
+    std::lock_guard<std::mutex> lock(mutex_);
+    CUDA_CALL(cudaStreamSynchronize(stream_));
+    CUDA_CALL(cudaMemPoolTrimTo(pool_, 0));
+  }
+
+ private:
+  // device served by this manager
+  Context ctx_;
+  // default memory pool of the device
+  cudaMemPool_t pool_;
+  // stream on which allocations and frees are ordered
+  cudaStream_t stream_;
+  // recorded on stream_ after an allocation for the consumer stream to wait on
+  cudaEvent_t alloc_event_;
+  // serializes the use of stream_
+  std::mutex mutex_;
+
+  DISALLOW_COPY_AND_ASSIGN(GPUAsyncStorageManager);
+};  // class GPUAsyncStorageManager
+#endif  // MXNET_CUDA_HAS_MALLOC_ASYNC
+
+}  // namespace storage
+}  // namespace mxnet
+
+#endif  // MXNET_USE_CUDA
+#endif  // MXNET_STORAGE_GPU_ASYNC_STORAGE_MANAGER_H_
@@ -24,11 +24,17 @@
 #ifndef MXNET_STORAGE_POOLED_STORAGE_MANAGER_H_
 #define MXNET_STORAGE_POOLED_STORAGE_MANAGER_H_
 
+#include <dmlc/thread_local.h>
+#include <ostream>
+#include <sstream>
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <tuple>
+#include <unordered_map>
 #include <utility>
 #include "./storage_manager.h"
 #include "../profiler/storage_profiler.h"
@@ -42,6 +48,9 @@ typedef enum {
   large_alloc_size,
   round_linear_cutoff,
   pool_reserve,
+  thread_cache_size,
+  thread_cache_count,
+  pool_budget,
 } env_var_type;
 
 const std::string env_var_name(const char* dev_type, env_var_type type);
@@ -69,6 +78,66 @@ const std::string env_var_name(const char* dev_type, env_var_type type);
 #define GPU_PROFILER_ON_FREE(prof, ...)
 #endif
 
+/*!
+ * \brief Free small chunks of one pooled storage manager, owned by a single thread.
+ *  ThreadChunkCache lets CPU allocations of small rounded sizes skip the pool mutex:
+ *  the owning thread pops and pushes chunks without locking, and only goes to the
+ *  shared pool to refill an empty bin or to give back the upper half of a full one.
+ */
+struct ThreadChunkCache {
+  /*! \brief free chunks of one bucket, with usage counters written by the owner only */
+  struct Bin {
+    std::vector<void*> chunks;
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> requested{0};
+  };
+  /*! \brief bins by bucket id */
+  std::unordered_map<size_t, Bin> bins;
+
+  /*! \return a new unique id for a pooled storage manager */
+  static uint64_t NewPoolId() {
+    static std::atomic<uint64_t> next_id{0};
+    return ++next_id;
+  }
+};
+
+/*! \brief caches of the calling thread, keyed by the id of their storage manager */
+typedef std::vector<std::pair<uint64_t, std::shared_ptr<ThreadChunkCache>>> ThreadChunkCaches;
+
+/*!
+ * \brief usage counters of one bucket of a pooled storage manager,
+ *  protected by the pool mutex.
+ */
+struct BucketStats {
+  /*! \brief rounded size of the chunks */
+  size_t chunk_size = 0;
+  /*! \brief number of chunks obtained from the device and not released yet */
+  size_t num_chunks = 0;
+  /*! \brief number of allocations served from the pool */
+  uint64_t hits = 0;
+  /*! \brief number of allocations served by the device */
+  uint64_t misses = 0;
+  /*! \brief total number of bytes requested by allocations */
+  uint64_t requested = 0;
+  /*! \brief thread local bins of this bucket, whose counters are not merged yet */
+  std::vector<const ThreadChunkCache::Bin*> thread_bins;
+
+  /*! \return number of allocations served from the pool, with the ones of the thread bins */
+  uint64_t TotalHits() const {
+    uint64_t total = hits;
+    for (const auto* bin : thread_bins)
+      total += bin->hits.load(std::memory_order_relaxed);
+    return total;
+  }
+  /*! \return number of bytes requested, with the ones of the thread bins */
+  uint64_t TotalRequested() const {
+    uint64_t total = requested;
+    for (const auto* bin : thread_bins)
+      total += bin->requested.load(std::memory_order_relaxed);
+    return total;
+  }
+};
+
 /*!
  * \brief Storage manager with a memory pool for GPU/CPU/CPUPunned memory chunks
  * memory chunks which reused based on rounded size match.
@@ -111,27 +180,54 @@ class PooledStorageManager : public StorageManager, public BucketingStrategy, pu
     StoringMethod::InitContainer(this);
     contextHelper_->set_initilal_context(ctx);
 
+    // thread local caching of small chunks, only for host memory
+    if (ctx.dev_type == Context::kCPU) {
+      const auto size_var  = env_var_name(dev_type, thread_cache_size);
+      const auto count_var = env_var_name(dev_type, thread_cache_count);
+      thread_cache_size_   = dmlc::GetEnv(size_var.c_str(), 4096);
+      thread_cache_count_  = dmlc::GetEnv(count_var.c_str(), 64);
+      if (thread_cache_count_ < 2)
+        thread_cache_size_ = 0;
+    }
+
     // percentage of reserved memory
     if (dev_type) {
       const auto env_var       = env_var_name(dev_type, pool_reserve);
       const size_t reserve     = dmlc::GetEnv(env_var.c_str(), 5);
       const size_t total       = std::get<1>(contextHelper_->getMemoryInfo());
       memory_allocation_limit_ = total * reserve / 100;
+      budget_ = dmlc::GetEnv(env_var_name(dev_type, pool_budget).c_str(), size_t(0));
     }
   }
   /*!
    * \brief Default destructor.
    */
   ~PooledStorageManager() override {
-    ReleaseAll();
+    std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+    ReclaimThreadCachesNoLock(true);
+    ReleaseAllNoLock();
   }
 
   void Alloc(Storage::Handle* handle, bool failsafe) override;
   void Free(Storage::Handle handle) override {
+    const auto bucket_id = BucketingStrategy::get_bucket(handle.size);
+    if (ThreadCached(bucket_id)) {
+      auto& bin = ThreadBin(bucket_id)->chunks;
+      bin.push_back(handle.dptr);
+      if (bin.size() <= thread_cache_count_)
+        return;
+      // give the upper half back, so that chunks freed by one thread
+      // can be reused by the others
+      std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+      while (bin.size() > thread_cache_count_ / 2) {
+        StoringMethod::InsertInCache(bucket_id, bin.back(), Storage::SyncObj());
+        bin.pop_back();
+      }
+      return;
+    }
     // Insert returned memory in cache
     std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
-    StoringMethod::InsertInCache(
-        BucketingStrategy::get_bucket(handle.size), handle.dptr, handle.sync_obj);
+    StoringMethod::InsertInCache(bucket_id, handle.dptr, handle.sync_obj);
   }
 
   void DirectFree(Storage::Handle handle) override {
@@ -142,6 +238,7 @@ class PooledStorageManager : public StorageManager, public BucketingStrategy, pu
     GPU_PROFILER_ON_FREE(profilerGPU, handle.dptr);
     UNSET_DEVICE(device_store);
     used_memory_ -= BucketingStrategy::RoundAllocSize(handle.size);
+    --Stats(BucketingStrategy::get_bucket(handle.size))->num_chunks;
   }
 
   void ReleaseAll() override {
@@ -149,13 +246,159 @@ class PooledStorageManager : public StorageManager, public BucketingStrategy, pu
     ReleaseAllNoLock();
   }
 
+  void SetBudget(size_t bytes) override {
+    std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+    budget_ = bytes;
+  }
+
+  void DumpStats(std::ostream& os) override {
+    std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+    std::vector<std::pair<size_t, BucketStats*>> buckets;
+    for (auto& b : bucket_stats_)
+      buckets.emplace_back(b.second.chunk_size, &b.second);
+    std::sort(buckets.begin(), buckets.end());
+    std::ostringstream buckets_ss;
+    for (const auto& b : buckets) {
+      const BucketStats& stats     = *b.second;
+      const uint64_t bucket_hits   = stats.TotalHits();
+      const uint64_t bucket_served = (bucket_hits + stats.misses) * stats.chunk_size;
+      buckets_ss << (&b == &buckets.front() ? "" : ", ") << "{\"chunk_size\": " << stats.chunk_size
+                 << ", \"chunks\": " << stats.num_chunks
+                 << ", \"reserved\": " << stats.num_chunks * stats.chunk_size
+                 << ", \"hits\": " << bucket_hits << ", \"misses\": " << stats.misses
+                 << ", \"requested\": " << stats.TotalRequested()
+                 << ", \"served\": " << bucket_served << "}";
+    }
+    const PoolStats pool = PoolStatsNoLock();
+    os << "{\"reserved\": " << pool.reserved << ", \"peak_reserved\": " << pool.peak_reserved
+       << ", \"budget\": " << pool.budget << ", \"hits\": " << pool.hits
+       << ", \"misses\": " << pool.misses << ", \"hit_rate\": "
+       << (pool.hits + pool.misses ? static_cast<double>(pool.hits) / (pool.hits + pool.misses) :
+                                     0.0)
+       << ", \"requested\": " << pool.requested << ", \"served\": " << pool.served
+       << ", \"efficiency\": "
+       << (pool.served ? static_cast<double>(pool.requested) / pool.served : 1.0)
+       << ", \"buckets\": [" << buckets_ss.str() << "]}";
+  }
+
+  bool GetPoolStats(PoolStats* stats) override {
+    std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+    *stats = PoolStatsNoLock();
+    return true;
+  }
+
  private:
+  PoolStats PoolStatsNoLock() const {
+    PoolStats pool;
+    pool.reserved      = used_memory_;
+    pool.peak_reserved = peak_memory_;
+    pool.budget        = budget_;
+    for (const auto& b : bucket_stats_) {
+      const BucketStats& stats = b.second;
+      pool.hits += stats.TotalHits();
+      pool.misses += stats.misses;
+      pool.requested += stats.TotalRequested();
+      pool.served += (stats.TotalHits() + stats.misses) * stats.chunk_size;
+    }
+    return pool;
+  }
+
   void ReleaseAllNoLock(bool set_device = true) {
+    ReclaimThreadCachesNoLock(false);
+    for (auto& b : bucket_stats_) {
+      const auto reuse_pool = StoringMethod::GetMemStorage(b.first);
+      if (reuse_pool)
+        b.second.num_chunks -= reuse_pool->size();
+    }
     SET_DEVICE(device_store, contextHelper_, contextHelper_->initilal_context(), set_device);
     used_memory_ -= StoringMethod::ReleaseAllNoLock(contextHelper_.get(), this);
     UNSET_DEVICE(device_store);
   }
 
+  /*! \brief whether chunks of a bucket go through the thread local caches */
+  inline bool ThreadCached(size_t bucket_id) const {
+    return thread_cache_size_ &&
+           BucketingStrategy::RoundAllocSizeForBucket(bucket_id) <= thread_cache_size_;
+  }
+
+  /*! \brief counters of a bucket, the pool mutex must be held */
+  BucketStats* Stats(size_t bucket_id) {
+    BucketStats* stats = &bucket_stats_[bucket_id];
+    if (!stats->chunk_size)
+      stats->chunk_size = BucketingStrategy::RoundAllocSizeForBucket(bucket_id);
+    return stats;
+  }
+
+  /*! \brief the cache of the calling thread, created on first use */
+  ThreadChunkCache* ThreadCache() {
+    auto* caches = dmlc::ThreadLocalStore<ThreadChunkCaches>::Get();
+    for (const auto& c : *caches) {
+      if (c.first == pool_id_)
+        return c.second.get();
+    }
+    auto cache = std::make_shared<ThreadChunkCache>();
+    {
+      std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+      thread_caches_.push_back(cache);
+    }
+    caches->emplace_back(pool_id_, cache);
+    return cache.get();
+  }
+
+  /*! \brief the bin of a bucket in the cache of the calling thread, created on first use */
+  ThreadChunkCache::Bin* ThreadBin(size_t bucket_id) {
+    auto& bins = ThreadCache()->bins;
+    auto it    = bins.find(bucket_id);
+    if (it != bins.end())
+      return &it->second;
+    ThreadChunkCache::Bin* bin = &bins[bucket_id];
+    std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+    Stats(bucket_id)->thread_bins.push_back(bin);
+    return bin;
+  }
+
+  /*!
+   * \brief move chunks from the shared pool to an empty bin of the calling thread.
+   * \return false if the shared pool has no chunk of this bucket.
+   */
+  bool RefillThreadCache(size_t bucket_id, std::vector<void*>* bin) {
+    std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+    auto reuse_pool = StoringMethod::GetMemStorage(bucket_id);
+    if (!reuse_pool)
+      return false;
+    while (!reuse_pool->empty() && bin->size() < thread_cache_count_ / 2) {
+      bin->push_back(reuse_pool->back().first);
+      reuse_pool->pop_back();
+    }
+    return true;
+  }
+
+  /*!
+   * \brief move the chunks of thread local caches back to the shared pool.
+   * \param all reclaim from all caches, otherwise only from caches of exited threads.
+   */
+  void ReclaimThreadCachesNoLock(bool all) {
+    for (auto it = thread_caches_.begin(); it != thread_caches_.end();) {
+      if (!all && it->use_count() > 1) {
+        ++it;
+        continue;
+      }
+      for (auto& bin : (*it)->bins) {
+        for (void* dptr : bin.second.chunks)
+          StoringMethod::InsertInCache(bin.first, dptr, Storage::SyncObj());
+        bin.second.chunks.clear();
+        // merge the counters of the bin, which is about to be destroyed
+        BucketStats* stats = Stats(bin.first);
+        stats->hits += bin.second.hits.exchange(0);
+        stats->requested += bin.second.requested.exchange(0);
+        auto& thread_bins = stats->thread_bins;
+        thread_bins.erase(std::remove(thread_bins.begin(), thread_bins.end(), &bin.second),
+                          thread_bins.end());
+      }
+      it = thread_caches_.erase(it);
+    }
+  }
+
   bool MemoryIsAvailable(size_t roundSize) const {
     const auto free = contextHelper_->freeMemorySize();
     return free > roundSize && memory_allocation_limit_ <= free - roundSize;
@@ -165,17 +408,45 @@ class PooledStorageManager : public StorageManager, public BucketingStrategy, pu
   Context::DeviceType dev_type_;
   // used memory
   size_t used_memory_ = 0;
+  // maximum of used_memory_
+  size_t peak_memory_ = 0;
+  // maximum of used_memory_ allowed, 0 for no limit
+  size_t budget_ = 0;
   // minimum amount of memory, which will never be allocated
   size_t memory_allocation_limit_ = 0;
   // Pointer to the Helper, supporting some context-specific operations in GPU/CPU/CPUPinned context
   std::unique_ptr<ContextHelper> contextHelper_;
+  // largest rounded size served by the thread local caches, 0 if they are disabled
+  size_t thread_cache_size_ = 0;
+  // maximum number of free chunks of one bucket kept by a thread
+  size_t thread_cache_count_ = 0;
+  // unique id of this manager, used as the key of the thread local caches
+  const uint64_t pool_id_ = ThreadChunkCache::NewPoolId();
+  // thread local caches of all threads, protected by the pool mutex
+  std::vector<std::shared_ptr<ThreadChunkCache>> thread_caches_;
+  // usage counters by bucket id, protected by the pool mutex
+  std::unordered_map<size_t, BucketStats> bucket_stats_;
 };
 
 template <typename BucketingStrategy, typename StoringMethod>
 void PooledStorageManager<BucketingStrategy, StoringMethod>::Alloc(Storage::Handle* handle,
                                                                    bool failsafe) {
-  std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
   const auto bucket_id = BucketingStrategy::get_bucket(handle->size);
+  if (ThreadCached(bucket_id)) {
+    ThreadChunkCache::Bin* bin = ThreadBin(bucket_id);
+    if (!bin->chunks.empty() || RefillThreadCache(bucket_id, &bin->chunks)) {
+      handle->dptr = bin->chunks.back();
+      bin->chunks.pop_back();
+      // only the owner writes, no read-modify-write needed
+      bin->hits.store(bin->hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      bin->requested.store(bin->requested.load(std::memory_order_relaxed) + handle->size,
+                           std::memory_order_relaxed);
+      return;
+    }
+  }
+  std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+  BucketStats* stats = Stats(bucket_id);
+  stats->requested += handle->size;
   size_t roundSize     = 0;
   auto reuse_pool      = StoringMethod::GetMemStorage(bucket_id);
   if (!reuse_pool) {
@@ -183,6 +454,20 @@ void PooledStorageManager<BucketingStrategy, StoringMethod>::Alloc(Storage::Hand
     roundSize = BucketingStrategy::RoundAllocSizeForBucket(bucket_id);
     if (!MemoryIsAvailable(roundSize))
       ReleaseAllNoLock(false);
+    if (budget_ && used_memory_ + roundSize > budget_) {
+      // give the cached chunks back before going over the budget
+      ReleaseAllNoLock(false);
+      if (used_memory_ + roundSize > budget_) {
+        UNSET_DEVICE(device_store);
+        if (failsafe) {
+          handle->dptr = nullptr;
+          return;
+        }
+        LOG(FATAL) << "Memory budget of " << budget_ << " bytes for " << handle->ctx
+                   << " exceeded: " << used_memory_ << " bytes are in use, " << roundSize
+                   << " more requested";
+      }
+    }
 
     void* ret = nullptr;
     auto e    = contextHelper_->Malloc(&ret, roundSize);
@@ -216,7 +501,12 @@ void PooledStorageManager<BucketingStrategy, StoringMethod>::Alloc(Storage::Hand
     UNSET_DEVICE(device_store);
 
     used_memory_ += roundSize;
+    peak_memory_ = std::max(peak_memory_, used_memory_);
     handle->dptr = ret;
+    if (ret) {
+      ++stats->misses;
+      ++stats->num_chunks;
+    }
   } else {
     // Reusing memory
     auto ptr_syncobj = reuse_pool->back();
@@ -233,6 +523,7 @@ void PooledStorageManager<BucketingStrategy, StoringMethod>::Alloc(Storage::Hand
 #endif
     }
     reuse_pool->pop_back();
+    ++stats->hits;
   }
 #if MXNET_USE_CUDA
   SET_GPU_PROFILER(profilerGPU, contextHelper_);
@@ -18,14 +18,23 @@
  */
 
 #include <mxnet/storage.h>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
 #include "./storage_manager.h"
 #include "./naive_storage_manager.h"
 #include "./pooled_storage_manager.h"
 #include "./cpu_shared_storage_manager.h"
 #include "./cpu_device_storage.h"
 #include "./gpu_device_storage.h"
+#include "./gpu_async_storage_manager.h"
 #include "./pinned_memory_storage.h"
 #include "../common/lazy_alloc_array.h"
+#include "../common/numa.h"
 #include "../profiler/storage_profiler.h"
 
 namespace mxnet {
@@ -40,6 +49,11 @@ class StorageImpl : public Storage {
   void ReleaseAll(Context ctx) override {
     storage_manager(ctx)->ReleaseAll();
   }
+  std::string GetStats() override;
+  std::string GetMetrics() override;
+  void SetBudget(Context ctx, size_t bytes) override;
+  int AddMemoryPressureCallback(MemoryPressureCallback callback) override;
+  void RemoveMemoryPressureCallback(int id) override;
 
   void SharedIncrementRefCount(Handle handle) override;
   StorageImpl()           = default;
@@ -48,16 +62,67 @@ class StorageImpl : public Storage {
  private:
   std::shared_ptr<StorageManager> storage_manager(const Context& ctx) {
     auto&& device                           = storage_managers_.at(ctx.dev_type);
-    std::shared_ptr<StorageManager> manager = device.Get(ctx.real_dev_id(), []() {
+    std::shared_ptr<StorageManager> manager = device.Get(manager_index(ctx), []() {
       LOG(FATAL) << "Cannot Free space to a device you have not allocated";
       return nullptr;
     });
     return manager;
   }
 
+  /*!
+   * \brief index of the storage manager serving a context.
+   *  All CPU contexts share one manager, unless NUMA-aware placement is enabled,
+   *  in which case there is one manager per NUMA node.
+   */
+  static int manager_index(const Context& ctx) {
+    if (ctx.dev_type == Context::kCPU) {
+      const common::NumaTopology* topo = common::NumaTopology::Get();
+      if (topo->enabled())
+        return topo->NodeOfDevice(ctx.dev_id);
+    }
+    return ctx.real_dev_id();
+  }
+
+  /*!
+   * \brief name of the storage manager of the given index in the stats.
+   *  The CPU managers of NUMA-aware placement serve a node, not a context.
+   */
+  static std::string manager_name(size_t dev_type, size_t index) {
+    std::ostringstream os;
+    if (dev_type == Context::kCPU && common::NumaTopology::Get()->enabled()) {
+      os << "cpu_numa(" << index << ")";
+    } else {
+      os << Context::Create(static_cast<Context::DeviceType>(dev_type),
+                            static_cast<int32_t>(index));
+    }
+    return os.str();
+  }
+
+  /*! \brief budget set by SetBudget of the manager serving a context, 0 if none */
+  size_t budget(const Context& ctx) {
+    std::lock_guard<std::mutex> lock(budget_mutex_);
+    auto it = budgets_.find(std::make_pair(ctx.dev_type, manager_index(ctx)));
+    return it == budgets_.end() ? 0 : it->second;
+  }
+
+  /*! \brief call the memory pressure callbacks for a context */
+  void OnMemoryPressure(const Context& ctx) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    for (const auto& callback : pressure_callbacks_)
+      callback.second(ctx);
+  }
+
   static constexpr size_t kMaxNumberOfDevices = Context::kMaxDevType + 1;
   // internal storage managers
   std::array<common::LazyAllocArray<StorageManager>, kMaxNumberOfDevices> storage_managers_;
+  // budgets by device type and manager index
+  std::map<std::pair<int, int>, size_t> budgets_;
+  std::mutex budget_mutex_;
+  // memory pressure callbacks by id
+  std::map<int, MemoryPressureCallback> pressure_callbacks_;
+  std::atomic<bool> has_pressure_callbacks_{false};
+  int next_callback_id_ = 0;
+  std::mutex callback_mutex_;
   profiler::DeviceStorageProfiler profiler_;
 };  // struct Storage::Impl
 
@@ -85,6 +150,17 @@ StorageManager* CreateStorageManager(const Context& ctx,
       ptr = new NaiveStorageManager<GPUDeviceStorage>();
     else  // Context::kCPUPinned
       ptr = new NaiveStorageManager<PinnedMemoryStorage>();
+#endif
+  } else if (*pStrategy == "Async") {
+    // stream-ordered allocations are only available for GPU memory
+#if MXNET_USE_CUDA
+    if (ctx.dev_type == Context::kGPU) {
+#if MXNET_CUDA_HAS_MALLOC_ASYNC
+      ptr = new GPUAsyncStorageManager(ctx);
+#else
+      LOG(FATAL) << env_var << "=Async requires MXNet built with CUDA 11.2 or newer";
+#endif
+    }
 #endif
   }
   return ptr;
@@ -99,7 +175,7 @@ void StorageImpl::Alloc(Storage::Handle* handle, bool failsafe) {
 
   // space already recycled, ignore request
   auto&& device                           = storage_managers_.at(handle->ctx.dev_type);
-  std::shared_ptr<StorageManager> manager = device.Get(handle->ctx.real_dev_id(), [handle]() {
+  std::shared_ptr<StorageManager> manager = device.Get(manager_index(handle->ctx), [this, handle]() {
     const auto dev_type = handle->ctx.dev_type;
     int num_gpu_device  = 0;
 #if MXNET_USE_CUDA
@@ -201,10 +277,22 @@ void StorageImpl::Alloc(Storage::Handle* handle, bool failsafe) {
     if (context)
       LOG(INFO) << "Using " << storage_manager_type << " StorageManager for " << context;
 
+    const size_t bytes = budget(handle->ctx);
+    if (bytes)
+      ptr->SetBudget(bytes);
     return ptr;
   });
 
-  manager->Alloc(handle, failsafe);
+  if (has_pressure_callbacks_.load()) {
+    // let the callbacks drop cached memory before failing
+    manager->Alloc(handle, true);
+    if (handle->dptr == nullptr) {
+      OnMemoryPressure(handle->ctx);
+      manager->Alloc(handle, failsafe);
+    }
+  } else {
+    manager->Alloc(handle, failsafe);
+  }
   if (!failsafe || handle->dptr != nullptr)
     profiler_.OnAlloc(*handle);
 }
@@ -229,6 +317,87 @@ void StorageImpl::DirectFree(Storage::Handle handle) {
   profiler_.OnFree(handle);
 }
 
+std::string StorageImpl::GetStats() {
+  std::ostringstream os;
+  os << "{";
+  bool first = true;
+  for (size_t dev_type = 0; dev_type < kMaxNumberOfDevices; ++dev_type) {
+    storage_managers_[dev_type].ForEach([&](size_t index, StorageManager* manager) {
+      os << (first ? "" : ", ") << "\"" << manager_name(dev_type, index) << "\": ";
+      manager->DumpStats(os);
+      first = false;
+    });
+  }
+  os << "}";
+  return os.str();
+}
+
+std::string StorageImpl::GetMetrics() {
+  using PoolStats = StorageManager::PoolStats;
+  std::vector<std::pair<std::string, PoolStats>> pools;
+  for (size_t dev_type = 0; dev_type < kMaxNumberOfDevices; ++dev_type) {
+    storage_managers_[dev_type].ForEach([&](size_t index, StorageManager* manager) {
+      PoolStats stats;
+      if (manager->GetPoolStats(&stats)) {
+        pools.emplace_back(manager_name(dev_type, index), stats);
+      }
+    });
+  }
+  std::ostringstream os;
+  auto family = [&](const char* name, bool counter, const char* help, uint64_t PoolStats::*field) {
+    os << "# TYPE " << name << (counter ? " counter" : " gauge") << "\n"
+       << "# HELP " << name << " " << help << "\n";
+    for (const auto& pool : pools) {
+      os << name << (counter ? "_total" : "") << "{device=\"" << pool.first << "\"} "
+         << pool.second.*field << "\n";
+    }
+  };
+  family("mxnet_pool_reserved_bytes", false, "Memory held by the pool.", &PoolStats::reserved);
+  family("mxnet_pool_peak_reserved_bytes",
+         false,
+         "Maximum of the memory held by the pool.",
+         &PoolStats::peak_reserved);
+  family("mxnet_pool_budget_bytes", false, "Budget of the pool, 0 for none.", &PoolStats::budget);
+  family("mxnet_pool_hits", true, "Allocations served from the pool.", &PoolStats::hits);
+  family("mxnet_pool_misses", true, "Allocations served by the device.", &PoolStats::misses);
+  family("mxnet_pool_requested_bytes",
+         true,
+         "Bytes requested by the allocations.",
+         &PoolStats::requested);
+  family("mxnet_pool_served_bytes",
+         true,
+         "Bytes of the chunks serving the allocations.",
+         &PoolStats::served);
+  return os.str();
+}
+
+void StorageImpl::SetBudget(Context ctx, size_t bytes) {
+  {
+    std::lock_guard<std::mutex> lock(budget_mutex_);
+    budgets_[std::make_pair(ctx.dev_type, manager_index(ctx))] = bytes;
+  }
+  // applied when the manager is created, if it does not exist yet
+  auto manager = storage_managers_.at(ctx.dev_type).Get(manager_index(ctx), []() {
+    return static_cast<StorageManager*>(nullptr);
+  });
+  if (manager)
+    manager->SetBudget(bytes);
+}
+
+int StorageImpl::AddMemoryPressureCallback(MemoryPressureCallback callback) {
+  std::lock_guard<std::mutex> lock(callback_mutex_);
+  const int id = next_callback_id_++;
+  pressure_callbacks_.emplace(id, std::move(callback));
+  has_pressure_callbacks_ = true;
+  return id;
+}
+
+void StorageImpl::RemoveMemoryPressureCallback(int id) {
+  std::lock_guard<std::mutex> lock(callback_mutex_);
+  pressure_callbacks_.erase(id);
+  has_pressure_callbacks_ = !pressure_callbacks_.empty();
+}
+
 void StorageImpl::SharedIncrementRefCount(Storage::Handle handle) {
   CHECK_EQ(handle.ctx.dev_type, Context::kCPUShared);
   auto&& device = storage_managers_.at(Context::kCPUShared);
@@ -244,12 +413,15 @@ void StorageImpl::SharedIncrementRefCount(Storage::Handle handle) {
 }
 
 const std::string env_var_name(const char* dev_type, env_var_type type) {
-  static const std::array<std::string, 5> name = {
+  static const std::array<std::string, 8> name = {
       "MEM_POOL_TYPE",
       "POOL_PAGE_SIZE",
       "MEM_LARGE_ALLOC_ROUND_SIZE",
       "MEM_POOL_ROUND_LINEAR_CUTOFF",
       "MEM_POOL_RESERVE",
+      "MEM_POOL_THREAD_CACHE_SIZE",
+      "MEM_POOL_THREAD_CACHE_COUNT",
+      "MEM_POOL_BUDGET",
   };
 
   return std::string("MXNET_") + dev_type + "_" + name[type];
@@ -271,4 +443,16 @@ Storage* Storage::Get() {
   static Storage* ptr = _GetSharedRef().get();
   return ptr;
 }
+
+#if MXNET_USE_CUDA
+static thread_local cudaStream_t consumer_stream = nullptr;
+
+void Storage::SetConsumerStream(cudaStream_t stream) {
+  consumer_stream = stream;
+}
+
+cudaStream_t Storage::ConsumerStream() {
+  return consumer_stream;
+}
+#endif
 }  // namespace mxnet
@@ -27,6 +27,7 @@
 
 #include "./storage_manager_helpers.h"
 #include <mxnet/storage.h>
+#include <ostream>
 
 namespace mxnet {
 namespace storage {
@@ -36,6 +37,16 @@ namespace storage {
  */
 class StorageManager {
  public:
+  /*! \brief Usage counters of a memory pool, in bytes and allocations */
+  struct PoolStats {
+    uint64_t reserved      = 0;
+    uint64_t peak_reserved = 0;
+    uint64_t budget        = 0;
+    uint64_t hits          = 0;
+    uint64_t misses        = 0;
+    uint64_t requested     = 0;
+    uint64_t served        = 0;
+  };
   /*!
    * \brief Allocation.
    * \param handle Handle struct.
@@ -60,6 +71,35 @@ class StorageManager {
    * For non-pool memory managers this has no effect.
    */
   virtual void ReleaseAll() {}
+  /*!
+   * \brief Print the usage counters of the memory pool as a json object.
+   *
+   * Pool storage managers report the reserved and peak reserved memory, the
+   * hit rate and, per bucket, the bytes requested vs the bytes of the served chunks.
+   * For non-pool memory managers the object is empty.
+   */
+  virtual void DumpStats(std::ostream& os) {
+    os << "{}";
+  }
+  /*!
+   * \brief Get the usage counters of the memory pool.
+   * \param stats the counters, left untouched for non-pool memory managers.
+   * \return whether this is a pool storage manager.
+   */
+  virtual bool GetPoolStats(PoolStats* stats) {
+    return false;
+  }
+  /*!
+   * \brief Limit the memory held by the storage manager.
+   *
+   * Pool storage managers release their cached chunks before going over the
+   * budget and then fail the allocation. Other memory managers ignore it.
+   * \param bytes the budget in bytes, 0 for no limit.
+   */
+  virtual void SetBudget(size_t bytes) {
+    if (bytes)
+      LOG(WARNING) << "Memory budgets are only supported by pooled storage managers, ignored";
+  }
   /*!
    * \brief Destructor.
    */
@@ -42,6 +42,8 @@ typedef mxnet::common::cuda::DeviceStore CudaDeviceStore;
 #endif  // _WIN32
 
 #include <tuple>
+#include "../common/huge_pages.h"
+#include "../common/numa.h"
 #include "../common/utils.h"
 
 namespace mxnet {
@@ -121,6 +123,22 @@ class ContextHelperCPU : public ContextHelper {
   }
 
   int Malloc(void** ppNtr, size_t size) const override {
+    const common::NumaTopology* topo = common::NumaTopology::Get();
+    const Context& ctx               = initilal_context();
+    if (ctx.dev_type == Context::kCPU && common::UseHugePages(size)) {
+      if (!common::HugePageMemAlloc(ppNtr, size))
+        return -1;
+      if (topo->enabled())
+        topo->BindMemoryToNode(*ppNtr, size, topo->NodeOfDevice(ctx.dev_id));
+      return 0;
+    }
+    if (topo->enabled() && ctx.dev_type == Context::kCPU) {
+      // page aligned, so that the node preference covers the whole chunk
+      if (!mxnet::common::AlignedMemAlloc(ppNtr, size, kNumaPageAlign))
+        return -1;
+      topo->BindMemoryToNode(*ppNtr, size, topo->NodeOfDevice(ctx.dev_id));
+      return 0;
+    }
     bool success = mxnet::common::AlignedMemAlloc(ppNtr, size, alignment_);
     return success ? 0 : -1;
   }
@@ -130,6 +148,7 @@ class ContextHelperCPU : public ContextHelper {
   }
 
  private:
+  static constexpr size_t kNumaPageAlign = 4096;
 #if MXNET_USE_ONEDNN == 1 || MXNET_USE_INTGEMM == 1
   // DNNL requires special alignment. 64 is used by the DNNL library in
   // memory allocation.
@@ -29,6 +29,7 @@
 #include <mxnet/engine.h>
 #include <mxnet/ndarray.h>
 #include <dmlc/timer.h>
+#include <algorithm>
 #include <ctime>
 #include <cstdio>
 #include <thread>
@@ -135,12 +136,16 @@ double EvaluateWorkloads(const std::vector<Workload>& workloads,
 }
 
 TEST(Engine, start_stop) {
-  const int num_engine = 3;
+  const int num_engine = 4;
   std::vector<mxnet::Engine*> engine(num_engine);
   engine[0]                 = mxnet::engine::CreateNaiveEngine();
   engine[1]                 = mxnet::engine::CreateThreadedEnginePooled();
   engine[2]                 = mxnet::engine::CreateThreadedEnginePerDevice();
-  std::string type_names[3] = {"NaiveEngine", "ThreadedEnginePooled", "ThreadedEnginePerDevice"};
+  engine[3]                 = mxnet::engine::CreateThreadedEngineWorkStealing();
+  std::string type_names[4] = {"NaiveEngine",
+                               "ThreadedEnginePooled",
+                               "ThreadedEnginePerDevice",
+                               "ThreadedEngineWorkStealing"};
 
   for (int i = 0; i < num_engine; ++i) {
     LOG(INFO) << "Stopping: " << type_names[i];
@@ -154,7 +159,7 @@ TEST(Engine, start_stop) {
 TEST(Engine, RandSumExpr) {
   std::vector<Workload> workloads;
   int num_repeat       = 5;
-  const int num_engine = 4;
+  const int num_engine = 5;
 
   std::vector<double> t(num_engine, 0.0);
   std::vector<mxnet::Engine*> engine(num_engine);
@@ -163,6 +168,7 @@ TEST(Engine, RandSumExpr) {
   engine[1] = mxnet::engine::CreateNaiveEngine();
   engine[2] = mxnet::engine::CreateThreadedEnginePooled();
   engine[3] = mxnet::engine::CreateThreadedEnginePerDevice();
+  engine[4] = mxnet::engine::CreateThreadedEngineWorkStealing();
 
   for (int repeat = 0; repeat < num_repeat; ++repeat) {
     srand(time(nullptr) + repeat);
@@ -185,6 +191,7 @@ TEST(Engine, RandSumExpr) {
   LOG(INFO) << "NaiveEngine\t\t" << t[1] << " sec";
   LOG(INFO) << "ThreadedEnginePooled\t" << t[2] << " sec";
   LOG(INFO) << "ThreadedEnginePerDevice\t" << t[3] << " sec";
+  LOG(INFO) << "ThreadedEngineWorkStealing\t" << t[4] << " sec";
 }
 
 void Foo(mxnet::RunContext, int i) {
@@ -502,12 +509,16 @@ TEST(Engine, basics) {
 }
 
 TEST(Engine, VarVersion) {
-  const size_t num_engines = 3;
+  const size_t num_engines = 4;
   std::vector<mxnet::Engine*> engines(num_engines);
   engines[0]                = mxnet::engine::CreateNaiveEngine();
   engines[1]                = mxnet::engine::CreateThreadedEnginePooled();
   engines[2]                = mxnet::engine::CreateThreadedEnginePerDevice();
-  std::string type_names[3] = {"NaiveEngine", "ThreadedEnginePooled", "ThreadedEnginePerDevice"};
+  engines[3]                = mxnet::engine::CreateThreadedEngineWorkStealing();
+  std::string type_names[4] = {"NaiveEngine",
+                               "ThreadedEnginePooled",
+                               "ThreadedEnginePerDevice",
+                               "ThreadedEngineWorkStealing"};
   for (size_t k = 0; k < num_engines; ++k) {
     auto engine = engines[k];
     std::vector<mxnet::Engine::OprHandle> oprs;
@@ -567,6 +578,56 @@ TEST(Engine, VarVersion) {
   }
 }
 
+/**
+ * Microbenchmark of the var dependency tracking: many tiny operators that all read
+ * a few shared variables and write a private one.  Pushing (AppendReadDependency)
+ * and completing (CompleteReadDependency) then contend on the shared variables.
+ * Run once from a build with USE_LOCKFREE_ENGINE_VAR=ON and once without to compare.
+ */
+TEST(Engine, VarDependencyThroughput) {
+  const int num_shared = 4;
+  const int num_opr    = 200000;
+  const int num_repeat = 3;
+  std::vector<mxnet::Engine*> engines = {mxnet::engine::CreateThreadedEnginePooled(),
+                                         mxnet::engine::CreateThreadedEnginePerDevice()};
+  std::string type_names[2]           = {"ThreadedEnginePooled", "ThreadedEnginePerDevice"};
+  for (size_t k = 0; k < engines.size(); ++k) {
+    auto engine = engines[k];
+    std::vector<mxnet::Engine::VarHandle> shared;
+    for (int i = 0; i < num_shared; ++i) {
+      shared.push_back(engine->NewVariable());
+    }
+    std::vector<mxnet::Engine::VarHandle> outputs;
+    for (int i = 0; i < num_shared; ++i) {
+      outputs.push_back(engine->NewVariable());
+    }
+    std::atomic<int> executed{0};
+    double best = 0;
+    for (int repeat = 0; repeat < num_repeat; ++repeat) {
+      const double t = dmlc::GetTime();
+      for (int i = 0; i < num_opr; ++i) {
+        engine->PushSync([&executed](mxnet::RunContext) { ++executed; },
+                         mxnet::Context::CPU(),
+                         shared,
+                         {outputs[i % num_shared]});
+      }
+      engine->WaitForAll();
+      const double elapsed = dmlc::GetTime() - t;
+      best                 = std::max(best, num_opr / elapsed);
+    }
+    EXPECT_EQ(executed.load(), num_opr * num_repeat);
+    LOG(INFO) << type_names[k] << " (MXNET_ENGINE_LOCKFREE_VAR=" << MXNET_ENGINE_LOCKFREE_VAR
+              << "): " << best << " push/complete per sec";
+    for (auto var : shared) {
+      engine->DeleteVariable([](mxnet::RunContext) {}, mxnet::Context::CPU(), var);
+    }
+    for (auto var : outputs) {
+      engine->DeleteVariable([](mxnet::RunContext) {}, mxnet::Context::CPU(), var);
+    }
+    engine->WaitForAll();
+  }
+}
+
 #ifdef _OPENMP
 
 struct TestSaveAndRestoreOMPState {
@@ -0,0 +1,103 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cached_op_batcher_test.cc
+ * \brief Tests the batching of the concurrent requests of a cached op
+ */
+#include <gtest/gtest.h>
+#include <mxnet/c_api.h>
+#include <mxnet/ndarray.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// out = data * 2
+const char* kSymbolJSON =
+    "{\"nodes\": [{\"op\": \"null\", \"name\": \"data\", \"inputs\": []},"
+    "{\"op\": \"_mul_scalar\", \"name\": \"mul\", \"attrs\": {\"scalar\": \"2\"},"
+    "\"inputs\": [[0, 0, 0]]}], \"arg_nodes\": [0], \"heads\": [[1, 0, 0]],"
+    "\"attrs\": {\"mxnet_version\": [\"int\", 20000]}}";
+
+void Batch(int max_batch_size, int timeout_us, int num_threads) {
+  SymbolHandle sym;
+  ASSERT_EQ(MXSymbolCreateFromJSON(kSymbolJSON, &sym), 0);
+  CachedOpHandle op;
+  ASSERT_EQ(MXCreateCachedOp(sym, 0, nullptr, nullptr, &op, true), 0);
+  CachedOpBatcherHandle batcher;
+  const int data_index = 0;
+  ASSERT_EQ(MXCreateCachedOpBatcher(op,
+                                    1,
+                                    &data_index,
+                                    max_batch_size,
+                                    timeout_us,
+                                    mxnet::Context::kCPU,
+                                    0,
+                                    &batcher),
+            0);
+
+  std::vector<std::thread> threads;
+  std::vector<int> errors(num_threads, 0);
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      mxnet::NDArray data(mxnet::TShape({1, 3}), mxnet::Context::CPU());
+      data = static_cast<float>(t);
+      NDArrayHandle input = &data;
+      int num_outputs     = 0;
+      NDArrayHandle* outputs;
+      if (MXInvokeCachedOpBatcher(batcher, 1, &input, &num_outputs, &outputs, nullptr) != 0) {
+        errors[t] = 1;
+        return;
+      }
+      auto out = static_cast<mxnet::NDArray*>(outputs[0]);
+      std::vector<float> values(3);
+      out->SyncCopyToCPU(values.data(), values.size());
+      for (float v : values) {
+        errors[t] |= v != 2.0f * t;
+      }
+      errors[t] |= out->shape() != mxnet::TShape({1, 3});
+      MXNDArrayFree(outputs[0]);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int t = 0; t < num_threads; ++t) {
+    EXPECT_EQ(errors[t], 0) << "request " << t;
+  }
+  EXPECT_EQ(MXFreeCachedOpBatcher(batcher), 0);
+  EXPECT_EQ(MXFreeCachedOp(op), 0);
+  EXPECT_EQ(MXSymbolFree(sym), 0);
+}
+
+}  // namespace
+
+TEST(CachedOpBatcher, BatchesConcurrentRequests) {
+  // the requests wait long enough to be batched together
+  Batch(8, 100000, 8);
+}
+
+TEST(CachedOpBatcher, SplitsBatchesAtMaxBatchSize) {
+  Batch(3, 100000, 8);
+}
+
+TEST(CachedOpBatcher, RunsAloneAfterTimeout) {
+  Batch(8, 0, 4);
+}
@@ -0,0 +1,280 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ *  \file kvstore_benchmark.cc
+ *  \brief Bandwidth and latency of the pushpull of the kvstore backends, over sweeps of key sizes,
+ *         key counts and gradient compressions
+ *
+ *  The run is configured through the environment:
+ *    MXNET_KVSTORE_BENCHMARK_TYPES        comma separated kvstore types, e.g. "local,device,nccl".
+ *                                         device_tree is device with MXNET_KVSTORE_USETREE=1,
+ *                                         unless MXNET_KVSTORE_USETREE is set by the user.
+ *                                         The dist types need the processes started by a launcher,
+ *                                         as with tools/launch.py, servers then serve until the
+ *                                         workers are done.
+ *    MXNET_KVSTORE_BENCHMARK_DEVICES      comma separated devices holding a copy of every key,
+ *                                         e.g. "gpu(0),gpu(1)", all the GPUs or 2 CPUs by default
+ *    MXNET_KVSTORE_BENCHMARK_SIZES        comma separated sizes of a key in bytes
+ *    MXNET_KVSTORE_BENCHMARK_KEYS         comma separated numbers of keys pushed together
+ *    MXNET_KVSTORE_BENCHMARK_COMPRESSION  comma separated compressions, "none" or type:threshold,
+ *                                         e.g. "none,2bit:0.5"
+ *    MXNET_KVSTORE_BENCHMARK_ITERS        timed pushpulls per measurement
+ *
+ *  The algorithmic bandwidth is the size of the keys over the time of their pushpull, the bus
+ *  bandwidth scales it by 2 (n - 1) / n for the n devices of all the workers, as an allreduce moves
+ *  that much data on each link. Comparable across backends and numbers of devices.
+ */
+
+#include <dmlc/parameter.h>
+#include <gtest/gtest.h>
+#include <mxnet/kvstore.h>
+#include <mxnet/ndarray.h>
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../include/test_perf.h"
+#include "../include/test_util.h"
+
+using namespace mxnet;
+
+namespace {
+
+struct BenchmarkConfig {
+  std::vector<std::string> types;
+  std::vector<Context> devices;
+  std::vector<size_t> sizes;
+  std::vector<size_t> num_keys;
+  std::vector<std::string> compressions;
+  size_t iterations;
+};
+
+std::vector<std::string> Split(const std::string& str, const char delim) {
+  std::vector<std::string> parts;
+  std::istringstream is(str);
+  std::string part;
+  while (std::getline(is, part, delim)) {
+    if (!part.empty()) {
+      parts.emplace_back(part);
+    }
+  }
+  return parts;
+}
+
+std::vector<size_t> ParseSizes(const std::string& str) {
+  std::vector<size_t> sizes;
+  for (const std::string& size : Split(str, ',')) {
+    sizes.push_back(std::stoull(size));
+  }
+  return sizes;
+}
+
+BenchmarkConfig ReadConfig() {
+  BenchmarkConfig config;
+  std::string default_types = "local,device";
+#if MXNET_USE_NCCL
+  if (test::unitTestsWithCuda) {
+    default_types += ",nccl";
+  }
+#endif  // MXNET_USE_NCCL
+  config.types = Split(dmlc::GetEnv("MXNET_KVSTORE_BENCHMARK_TYPES", default_types), ',');
+  const std::string devices = dmlc::GetEnv("MXNET_KVSTORE_BENCHMARK_DEVICES", std::string());
+  if (devices.empty()) {
+    const int num_gpus = test::unitTestsWithCuda ? Context::GetGPUCount() : 0;
+    for (int i = 0; i < std::max(num_gpus, 2); ++i) {
+      config.devices.push_back(num_gpus > 0 ? Context::GPU(i % num_gpus) : Context::CPU(i));
+    }
+  } else {
+    for (const std::string& device : Split(devices, ',')) {
+      config.devices.push_back(Context::FromString(device));
+    }
+  }
+  const std::string default_sizes = test::performance_run ? "4096,65536,1048576,16777216,67108864" :
+                                                            "4096,1048576";
+  config.sizes    = ParseSizes(dmlc::GetEnv("MXNET_KVSTORE_BENCHMARK_SIZES", default_sizes));
+  config.num_keys = ParseSizes(dmlc::GetEnv("MXNET_KVSTORE_BENCHMARK_KEYS", std::string("1,16")));
+  config.compressions =
+      Split(dmlc::GetEnv("MXNET_KVSTORE_BENCHMARK_COMPRESSION", std::string("none")), ',');
+  config.iterations =
+      dmlc::GetEnv("MXNET_KVSTORE_BENCHMARK_ITERS", test::performance_run ? 100 : 10);
+  CHECK_GT(config.iterations, 0) << "MXNET_KVSTORE_BENCHMARK_ITERS must be positive";
+  return config;
+}
+
+/*! \brief The kvstore of a benchmark type, nullptr when this build or these devices lack it */
+std::unique_ptr<KVStore> CreateKVStore(const std::string& type,
+                                       const std::vector<Context>& devices) {
+  const bool gpu_only = type.find("nccl") != std::string::npos || type == "device_tree";
+  if (gpu_only && devices[0].dev_mask() != gpu::kDevMask) {
+    return nullptr;
+  }
+  // read by the kvstore constructor, a value set by the user is left alone
+  const bool set_tree =
+      type == "device_tree" && std::getenv("MXNET_KVSTORE_USETREE") == nullptr;
+  if (set_tree) {
+    dmlc::SetEnv("MXNET_KVSTORE_USETREE", 1);
+  }
+  std::unique_ptr<KVStore> kv;
+  try {
+    kv.reset(KVStore::Create(type == "device_tree" ? "device" : type.c_str()));
+  } catch (const dmlc::Error& e) {
+    std::cout << type << " skipped: " << e.what() << std::endl;
+  }
+  if (set_tree) {
+    unsetenv("MXNET_KVSTORE_USETREE");
+  }
+  return kv;
+}
+
+struct Measurement {
+  double algbw_gbps;
+  double busbw_gbps;
+  double p50_us;
+  double p90_us;
+  double p99_us;
+};
+
+/*!
+ * \brief Times the pushpull of num_keys keys of size bytes from every device, after warm up ones.
+ *        Every key has a copy on each device, reduced in place.
+ */
+Measurement TimePushPull(KVStore* kv,
+                         const int first_key,
+                         const std::vector<Context>& devices,
+                         const size_t num_keys,
+                         const size_t size,
+                         const size_t iterations) {
+  const mxnet::TShape shape(1, std::max<size_t>(1, size / sizeof(float)));
+  std::vector<int> keys, vkeys;
+  std::vector<NDArray> init, values;
+  std::vector<NDArray*> outs;
+  for (size_t k = 0; k < num_keys; ++k) {
+    keys.push_back(first_key + k);
+    init.emplace_back(shape, devices[0], false, mshadow::kFloat32);
+    init.back() = 1.f;
+    for (const Context& device : devices) {
+      vkeys.push_back(keys.back());
+      values.emplace_back(shape, device, false, mshadow::kFloat32);
+      values.back() = 1.f;
+    }
+  }
+  for (NDArray& value : values) {
+    outs.push_back(&value);
+  }
+  kv->Init(keys, init);
+  auto pushpull = [&]() {
+    kv->PushPull(vkeys, vkeys, values, outs);
+    for (const NDArray& value : values) {
+      value.WaitToRead();
+    }
+  };
+  for (int i = 0; i < 2; ++i) {
+    pushpull();
+  }
+  kv->Barrier();
+  std::vector<double> latencies;
+  for (size_t i = 0; i < iterations; ++i) {
+    const uint64_t start = test::perf::getNannoTickCount();
+    pushpull();
+    latencies.push_back(static_cast<double>(test::perf::getNannoTickCount() - start) / 1000);
+  }
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&](const double p) {
+    return latencies[std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()))];
+  };
+  double mean_us = 0;
+  for (const double us : latencies) {
+    mean_us += us / latencies.size();
+  }
+  const double bytes = static_cast<double>(shape.Size() * sizeof(float) * num_keys);
+  const size_t ranks = devices.size() * kv->get_group_size();
+  Measurement m;
+  m.algbw_gbps = bytes / mean_us / 1e3;
+  m.busbw_gbps = m.algbw_gbps * 2 * (ranks - 1) / ranks;
+  m.p50_us     = percentile(0.5);
+  m.p90_us     = percentile(0.9);
+  m.p99_us     = percentile(0.99);
+  return m;
+}
+
+}  // namespace
+
+/*!
+ * \brief Measures every configured kvstore type on every size, number of keys and compression.
+ *        Reports only, the numbers depend on the interconnect of the machine.
+ */
+TEST(KVSTORE_BENCHMARK, PushPullBandwidth) {
+  const BenchmarkConfig config = ReadConfig();
+  if (test::csv) {
+    std::cout << "key,algbw_GBps,busbw_GBps,p50_us,p90_us,p99_us" << std::endl;
+  }
+  for (const std::string& type : config.types) {
+    for (const std::string& compression : config.compressions) {
+      std::unique_ptr<KVStore> kv = CreateKVStore(type, config.devices);
+      if (!kv) {
+        continue;
+      }
+      if (!KVStore::IsWorkerNode()) {
+        kv->RunServer(KVStore::Controller());
+        return;
+      }
+      if (compression != "none") {
+        const std::vector<std::string> fields = Split(compression, ':');
+        std::vector<std::pair<std::string, std::string>> kwargs = {{"type", fields[0]}};
+        if (fields.size() > 1) {
+          kwargs.emplace_back("threshold", fields[1]);
+        }
+        try {
+          kv->SetGradientCompression(kwargs);
+        } catch (const dmlc::Error& e) {
+          std::cout << type << "/" << compression << " skipped: " << e.what() << std::endl;
+          continue;
+        }
+      }
+      // every measurement initializes new keys
+      int first_key = 0;
+      for (const size_t num_keys : config.num_keys) {
+        for (const size_t size : config.sizes) {
+          const Measurement m = TimePushPull(
+              kv.get(), first_key, config.devices, num_keys, size, config.iterations);
+          first_key += num_keys;
+          if (kv->get_rank() != 0) {
+            continue;
+          }
+          std::ostringstream key;
+          key << type << "/" << compression << "/" << config.devices.size() << "dev/" << num_keys
+              << "x" << size << "B";
+          if (test::csv) {
+            std::cout << key.str() << "," << m.algbw_gbps << "," << m.busbw_gbps << ","
+                      << m.p50_us << "," << m.p90_us << "," << m.p99_us << std::endl;
+          } else {
+            std::cout << key.str() << ": algbw " << m.algbw_gbps << " GB/s, busbw "
+                      << m.busbw_gbps << " GB/s, latency p50 " << m.p50_us << " us, p90 "
+                      << m.p90_us << " us, p99 " << m.p99_us << " us" << std::endl;
+          }
+        }
+      }
+    }
+  }
+}
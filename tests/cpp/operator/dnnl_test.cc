@@ -238,6 +238,64 @@ TEST(DNNL_BASE, DNNLMemorySum) {
   }
 }
 
+TEST(DNNL_BASE, DNNLPrimitiveCache) {
+  DNNLPrimitiveCache<int, int, std::hash<int>> cache("test cache");
+  DNNLCacheStats* stats = DNNLCacheStats::Get("test cache");
+  const uint64_t hits   = stats->hits;
+  const uint64_t misses = stats->misses;
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(cache.find(i) == cache.end());
+    AddToCache(&cache, i, 10 * i);
+  }
+  // the lookup makes 0 the most recently used entry
+  auto it = cache.find(0);
+  ASSERT_TRUE(it != cache.end());
+  EXPECT_EQ(it->second, 0);
+  EXPECT_EQ(stats->hits, hits + 1);
+  EXPECT_EQ(stats->misses, misses + 3);
+
+  const uint64_t evictions = stats->evictions;
+  cache.EvictOldest();
+  EXPECT_EQ(stats->evictions, evictions + 1);
+  EXPECT_TRUE(cache.find(1) == cache.end());
+  EXPECT_TRUE(cache.find(0) != cache.end());
+  EXPECT_TRUE(cache.find(2) != cache.end());
+}
+
+TEST(DNNL_BASE, DNNLStreamThreads) {
+  DNNLStream* stream    = DNNLStream::Get();
+  const int threads     = stream->GetNumThreads();
+  const int omp_threads = omp_get_max_threads();
+  {
+    DNNLStreamThreadsScope scope(2);
+    EXPECT_EQ(stream->GetNumThreads(), 2);
+    // the OpenMP regions of the calling thread use the threads of the scope
+    EXPECT_EQ(omp_get_max_threads(), 2);
+#ifdef _OPENMP
+    int team = 0;
+#pragma omp parallel
+    {
+#pragma omp single
+      team = omp_get_num_threads();
+    }
+    EXPECT_EQ(team, 2);
+#endif
+    // and still do after a submit
+    NDArray arr(mxnet::TShape({4, 4}), Context::CPU());
+    op::DNNLMemorySum(*arr.GetDNNLData(), *arr.GetDNNLData(), *arr.GetDNNLData());
+    stream->Submit();
+    EXPECT_EQ(omp_get_max_threads(), 2);
+  }
+  EXPECT_EQ(stream->GetNumThreads(), threads);
+  EXPECT_EQ(omp_get_max_threads(), omp_threads);
+  {
+    // 0 keeps the threads of the stream
+    DNNLStreamThreadsScope scope(0);
+    EXPECT_EQ(stream->GetNumThreads(), threads);
+    EXPECT_EQ(omp_get_max_threads(), omp_threads);
+  }
+}
+
 TEST(DNNL_BASE, CreateDNNLMem) {
   std::vector<NDArrayAttrs> in_arrs   = GetTestInputArrays();
   std::vector<NDArrayAttrs> in_arrs2  = GetTestInputArrays(ArrayTypes::All, true);
@@ -0,0 +1,362 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ *  \file op_benchmark.cc
+ *  \brief Kernel-only timing of the registered operators per backend, compared against a JSON
+ *         baseline of a reference machine
+ *
+ *  The run is configured through the environment:
+ *    MXNET_OP_BENCHMARK_OPS        comma separated operators, each optionally followed by its
+ *                                  parameters, e.g. "FullyConnected:num_hidden=64,relu".
+ *                                  All the public operators are swept with --perf when empty.
+ *    MXNET_OP_BENCHMARK_SHAPES     comma separated data shapes, e.g. "32x3x64x64,64x1024"
+ *    MXNET_OP_BENCHMARK_DTYPES     comma separated data types among float32, float64 and int32
+ *    MXNET_OP_BENCHMARK_ITERS      timed executions per measurement
+ *    MXNET_OP_BENCHMARK_BASELINE   baseline file, the checked-in one of the architecture by default
+ *    MXNET_OP_BENCHMARK_THRESHOLD  relative slowdown over the baseline flagged as a regression
+ *    MXNET_OP_BENCHMARK_OUTPUT     file to write the measurements to, as a new baseline
+ */
+
+#include <dmlc/json.h>
+#include <dmlc/parameter.h>
+#include <dmlc/registry.h>
+#include <gtest/gtest.h>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../include/test_core_op.h"
+#include "../include/test_perf.h"
+
+#ifndef MXNET_OP_BENCHMARK_BASELINE_FILE
+#define MXNET_OP_BENCHMARK_BASELINE_FILE "op_benchmark_baseline.json"
+#endif
+
+using namespace mxnet;
+
+using kwargs_t = test::op::kwargs_t;
+
+namespace {
+
+/*! \brief Inputs left to FInferShape, the other inputs take the data shape */
+const std::set<std::string> kParameterInputs = {"weight",
+                                                "bias",
+                                                "gamma",
+                                                "beta",
+                                                "moving_mean",
+                                                "moving_var",
+                                                "parameters",
+                                                "state",
+                                                "state_cell"};
+
+/*! \brief Operators run without --perf or an explicit list */
+const char* const kQuickOps = "relu,sigmoid,softmax,sum,transpose,elemwise_add";
+
+struct BenchmarkOp {
+  std::string name;
+  kwargs_t kwargs;
+};
+
+struct BenchmarkConfig {
+  std::vector<BenchmarkOp> ops;
+  std::vector<mxnet::TShape> shapes;
+  std::vector<int> dtypes;
+  size_t iterations;
+  std::string baseline;
+  double threshold;
+  std::string output;
+};
+
+std::vector<std::string> Split(const std::string& str, const char delim) {
+  std::vector<std::string> parts;
+  std::istringstream is(str);
+  std::string part;
+  while (std::getline(is, part, delim)) {
+    if (!part.empty()) {
+      parts.emplace_back(part);
+    }
+  }
+  return parts;
+}
+
+std::string ShapeKey(const mxnet::TShape& shape) {
+  std::ostringstream os;
+  for (int i = 0; i < shape.ndim(); ++i) {
+    os << (i ? "x" : "") << shape[i];
+  }
+  return os.str();
+}
+
+std::string DTypeName(const int dtype) {
+  switch (dtype) {
+    case mshadow::kFloat32:
+      return "float32";
+    case mshadow::kFloat64:
+      return "float64";
+    case mshadow::kInt32:
+      return "int32";
+    default:
+      LOG(FATAL) << "Unsupported benchmark dtype " << dtype;
+      return "";
+  }
+}
+
+int ParseDType(const std::string& name) {
+  for (const int dtype : {mshadow::kFloat32, mshadow::kFloat64, mshadow::kInt32}) {
+    if (DTypeName(dtype) == name) {
+      return dtype;
+    }
+  }
+  LOG(FATAL) << "Unsupported benchmark dtype " << name << ", use float32, float64 or int32";
+  return -1;
+}
+
+/*! \brief The public operators with named inputs, whose parameters all have defaults */
+std::vector<BenchmarkOp> RegisteredOps() {
+  static auto& flist_inputs = Op::GetAttr<nnvm::FListInputNames>("FListInputNames");
+  std::vector<BenchmarkOp> ops;
+  for (const std::string& name : dmlc::Registry<nnvm::Op>::ListAllNames()) {
+    const nnvm::Op* op = nnvm::Op::Get(name);
+    if (name[0] != '_' && flist_inputs.count(op)) {
+      ops.push_back({name, {}});
+    }
+  }
+  return ops;
+}
+
+BenchmarkConfig ReadConfig() {
+  BenchmarkConfig config;
+  std::string ops = dmlc::GetEnv("MXNET_OP_BENCHMARK_OPS", std::string());
+  if (ops.empty() && test::performance_run) {
+    config.ops = RegisteredOps();
+  } else {
+    for (const std::string& entry : Split(ops.empty() ? kQuickOps : ops, ',')) {
+      std::vector<std::string> fields = Split(entry, ':');
+      BenchmarkOp op{fields[0], {}};
+      for (size_t i = 1; i < fields.size(); ++i) {
+        const size_t eq = fields[i].find('=');
+        CHECK_NE(eq, std::string::npos) << "Expected key=value, got " << fields[i];
+        op.kwargs.emplace_back(fields[i].substr(0, eq), fields[i].substr(eq + 1));
+      }
+      config.ops.emplace_back(op);
+    }
+  }
+  const std::string default_shapes = test::performance_run ? "1x3x224x224,32x3x64x64,64x1024" :
+                                                             "1x3x28x28,64x1024";
+  for (const std::string& shape :
+       Split(dmlc::GetEnv("MXNET_OP_BENCHMARK_SHAPES", default_shapes), ',')) {
+    std::vector<dim_t> dims;
+    for (const std::string& dim : Split(shape, 'x')) {
+      dims.push_back(std::stoll(dim));
+    }
+    config.shapes.emplace_back(dims.begin(), dims.end());
+  }
+  for (const std::string& dtype :
+       Split(dmlc::GetEnv("MXNET_OP_BENCHMARK_DTYPES", std::string("float32")), ',')) {
+    config.dtypes.push_back(ParseDType(dtype));
+  }
+  config.iterations = dmlc::GetEnv("MXNET_OP_BENCHMARK_ITERS", test::performance_run ? 100 : 10);
+  config.baseline =
+      dmlc::GetEnv("MXNET_OP_BENCHMARK_BASELINE", std::string(MXNET_OP_BENCHMARK_BASELINE_FILE));
+  config.threshold = dmlc::GetEnv("MXNET_OP_BENCHMARK_THRESHOLD", 0.1);
+  config.output    = dmlc::GetEnv("MXNET_OP_BENCHMARK_OUTPUT", std::string());
+  return config;
+}
+
+/*!
+ * \brief The data shape goes to the inputs FListInputNames does not name as parameters, the
+ *        parameters are left unknown for FInferShape of the operator to fill in
+ */
+mxnet::ShapeVector InputShapes(const nnvm::Op* op,
+                               const kwargs_t& kwargs,
+                               const mxnet::TShape& data_shape) {
+  static auto& flist_inputs = Op::GetAttr<nnvm::FListInputNames>("FListInputNames");
+  if (!flist_inputs.count(op)) {
+    return {data_shape};
+  }
+  std::vector<const char*> keys, values;
+  for (const auto& kv : kwargs) {
+    keys.push_back(kv.first.c_str());
+    values.push_back(kv.second.c_str());
+  }
+  const nnvm::NodeAttrs attrs =
+      imperative::ParseAttrs(op, op->num_inputs, kwargs.size(), keys.data(), values.data());
+  mxnet::ShapeVector shapes;
+  for (const std::string& name : flist_inputs[op](attrs)) {
+    shapes.emplace_back(kParameterInputs.count(name) ? mxnet::TShape() : data_shape);
+  }
+  return shapes;
+}
+
+enum Backend { kNative, kOneDNN, kGPU };
+
+const char* BackendName(const Backend backend) {
+  switch (backend) {
+    case kNative:
+      return "native";
+    case kOneDNN:
+      return "onednn";
+    case kGPU:
+      return "gpu";
+    default:
+      return "<unknown>";
+  }
+}
+
+/*!
+ * \brief Average time in microseconds of one compute call of the operator, without the engine,
+ *        after a warm up execution. Negative when the operator can not run on this backend.
+ */
+template <typename DType>
+double TimeKernel(const BenchmarkOp& bop,
+                  const Backend backend,
+                  const mxnet::TShape& data_shape,
+                  const size_t iterations) {
+  const bool isGPU   = backend == kGPU;
+  const nnvm::Op* op = nnvm::Op::Get(bop.name);
+  const Context ctx  = isGPU ? Context::GPU() : Context::CPU();
+  const bool has_fcompute    = common::GetFCompute<FCompute>(op, "FCompute", ctx) != nullptr;
+  const bool has_fcompute_ex = common::GetFCompute<FComputeEx>(op, "FComputeEx", ctx) != nullptr;
+  if ((backend == kOneDNN && !has_fcompute_ex) || (backend != kOneDNN && !has_fcompute)) {
+    return -1;
+  }
+  try {
+    test::op::CoreOpExecutor<DType> executor(isGPU, InputShapes(op, bop.kwargs, data_shape));
+    executor.set_verbose(false);
+    executor.Init(executor.ArgsWithOpName(bop.kwargs, bop.name, COREOP_BWD_OP_NAME_VALUE_NONE));
+    auto run = [&]() {
+      for (size_t i = 0; i < iterations; ++i) {
+        if (backend == kOneDNN) {
+          executor.ExecuteEx();
+        } else {
+          executor.Execute();
+        }
+      }
+#if MXNET_USE_CUDA
+      if (isGPU) {
+        executor.ctx().run_ctx.template get_stream<gpu>()->Wait();
+      }
+#endif  // MXNET_USE_CUDA
+    };
+    run();
+    const uint64_t start = test::perf::getMicroTickCount();
+    run();
+    return static_cast<double>(test::perf::getMicroTickCount() - start) / iterations;
+  } catch (const dmlc::Error& e) {
+    // missing required parameters, or inputs the generator can not build
+    if (test::debug_output) {
+      std::cout << bop.name << " skipped: " << e.what() << std::endl;
+    }
+    return -1;
+  }
+}
+
+std::map<std::string, double> ReadBaseline(const std::string& path) {
+  std::map<std::string, double> baseline;
+  std::ifstream is(path);
+  if (is.good()) {
+    dmlc::JSONReader reader(&is);
+    reader.Read(&baseline);
+  } else {
+    std::cout << "No operator baseline at " << path << std::endl;
+  }
+  return baseline;
+}
+
+}  // namespace
+
+/*!
+ * \brief Times every configured operator on every backend of this build and flags the ones
+ *        slower than the baseline by more than the threshold. Regressions only fail a --perf run,
+ *        the quick run of the unit tests is not on the reference machine.
+ */
+TEST(OP_BENCHMARK, KernelTiming) {
+  const BenchmarkConfig config = ReadConfig();
+  const std::map<std::string, double> baseline = ReadBaseline(config.baseline);
+  std::vector<Backend> backends = {kNative};
+#if MXNET_USE_ONEDNN == 1
+  backends.push_back(kOneDNN);
+#endif  // MXNET_USE_ONEDNN == 1
+  if (test::unitTestsWithCuda) {
+    backends.push_back(kGPU);
+  }
+  std::map<std::string, double> results;
+  std::vector<std::string> regressions;
+  if (test::csv) {
+    std::cout << "key,us,baseline_us" << std::endl;
+  }
+  for (const BenchmarkOp& op : config.ops) {
+    for (const Backend backend : backends) {
+      for (const int dtype : config.dtypes) {
+        for (const mxnet::TShape& shape : config.shapes) {
+          double us = -1;
+          switch (dtype) {
+            case mshadow::kFloat32:
+              us = TimeKernel<float>(op, backend, shape, config.iterations);
+              break;
+            case mshadow::kFloat64:
+              us = TimeKernel<double>(op, backend, shape, config.iterations);
+              break;
+            default:
+              us = TimeKernel<int32_t>(op, backend, shape, config.iterations);
+              break;
+          }
+          if (us < 0) {
+            continue;
+          }
+          const std::string key = op.name + "/" + BackendName(backend) + "/" + DTypeName(dtype) +
+                                  "/" + ShapeKey(shape);
+          results[key]          = us;
+          const auto it         = baseline.find(key);
+          const double base     = it != baseline.end() ? it->second : -1;
+          if (test::csv) {
+            std::cout << key << "," << us << "," << base << std::endl;
+          } else {
+            std::cout << key << ": " << us << " us";
+            if (base > 0) {
+              std::cout << " (baseline " << base << " us, " << (us / base - 1) * 100 << "%)";
+            }
+            std::cout << std::endl;
+          }
+          if (base > 0 && us > base * (1 + config.threshold)) {
+            regressions.push_back(key);
+          }
+        }
+      }
+    }
+  }
+  for (const std::string& key : regressions) {
+    std::cout << "REGRESSION " << key << ": " << results[key] << " us, baseline "
+              << baseline.at(key) << " us" << std::endl;
+  }
+  if (!config.output.empty()) {
+    std::ofstream os(config.output);
+    dmlc::JSONWriter writer(&os);
+    writer.Write(results);
+    os << std::endl;
+  }
+  if (test::performance_run) {
+    EXPECT_TRUE(regressions.empty())
+        << regressions.size() << " operators regressed by more than "
+        << config.threshold * 100 << "%";
+  }
+}
@@ -163,4 +163,33 @@ TEST(OMP_TUNING, EvaluateTuneTestInt64) {
   std::cout << "Success rate for type " << test::type_name<DType>() << ": " << result << std::endl;
 }
 
+/*! \brief Online re-tune moves a workload towards the measured serial launches */
+TEST(OMP_TUNING, RefineWorkload) {
+  using mxnet::op::OperatorTuneBase;
+  const size_t N = 2 * OperatorTuneBase::WORKLOAD_COUNT;
+  float workload = 1000;
+  // a serial launch twice as slow as the workload predicts
+  for (int i = 0; i < 64; ++i) {
+    OperatorTuneBase::RefineWorkload(&workload, N, 1, 4000);
+  }
+  EXPECT_NEAR(workload, 2000, 10);
+}
+
+TEST(OMP_TUNING, GetOMPThreadCount) {
+  using mxnet::op::OperatorTuneBase;
+  const uint64_t overhead = OperatorTuneBase::omp_overhead_ns();
+  const size_t N          = 1 << 20;
+  // each thread gets at least the OMP overhead worth of work
+  EXPECT_EQ(OperatorTuneBase::GetOMPThreadCount(N, 64, (4 * overhead) << WORKLOAD_COUNT_SHIFT), 4);
+  EXPECT_EQ(OperatorTuneBase::GetOMPThreadCount(N, 64, overhead << WORKLOAD_COUNT_SHIFT), 2);
+  EXPECT_EQ(OperatorTuneBase::GetOMPThreadCount(N, 64, (1024 * overhead) << WORKLOAD_COUNT_SHIFT),
+            64);
+  // and at least one iteration
+  EXPECT_EQ(OperatorTuneBase::GetOMPThreadCount(8, 64, (1024 * overhead) << WORKLOAD_COUNT_SHIFT),
+            8);
+  EXPECT_EQ(OperatorTuneBase::GetOMPThreadCount(1, 64, (1024 * overhead) << WORKLOAD_COUNT_SHIFT),
+            1);
+  EXPECT_EQ(OperatorTuneBase::GetOMPThreadCount(1, 64, overhead << WORKLOAD_COUNT_SHIFT), 1);
+}
+
 #endif  // MXNET_USE_OPERATOR_TUNING
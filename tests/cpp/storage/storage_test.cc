@@ -22,10 +22,16 @@
  */
 #include <gtest/gtest.h>
 #include <dmlc/logging.h>
+#include <dmlc/parameter.h>
 #include <mxnet/storage.h>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
 #include "test_util.h"
+#include "../../src/common/huge_pages.h"
 
 TEST(Storage, Basic_CPU) {
   constexpr size_t kSize = 1024;
@@ -68,6 +74,125 @@ TEST(Storage, CPU_MemAlign) {
   }
 }
 
+TEST(Storage, CPU_HugePageAlloc) {
+  using mxnet::common::kHugePageSize;
+  // off unless MXNET_CPU_HUGE_PAGE_THRESHOLD is set
+  if (std::getenv("MXNET_CPU_HUGE_PAGE_THRESHOLD") == nullptr) {
+    EXPECT_FALSE(mxnet::common::UseHugePages(size_t(1) << 40));
+  }
+  for (const size_t size : {size_t(1), kHugePageSize, kHugePageSize + 1, 3 * kHugePageSize}) {
+    void* ptr = nullptr;
+    ASSERT_TRUE(mxnet::common::HugePageMemAlloc(&ptr, size));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % kHugePageSize, 0);
+    // padded to whole huge pages
+    const size_t padded = (size + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+    std::memset(ptr, 1, padded);
+    mxnet::common::AlignedMemFree(ptr);
+  }
+}
+
+TEST(Storage, CPU_SmallAllocThreads) {
+  constexpr int kThreads     = 4;
+  constexpr int kChunks      = 300;
+  auto&& storage             = mxnet::Storage::Get();
+  mxnet::Context context_cpu = mxnet::Context::CPU(0);
+  // chunks allocated by the workers and freed by the main thread
+  std::vector<std::vector<mxnet::Storage::Handle>> handed_over(kThreads);
+  std::vector<std::thread> workers;
+  for (int t = 0; t < kThreads; ++t) {
+    workers.emplace_back([&, t]() {
+      for (int round = 0; round < 3; ++round) {
+        std::vector<mxnet::Storage::Handle> handles;
+        for (int i = 0; i < kChunks; ++i) {
+          handles.push_back(storage->Alloc(1 + (i * 37) % 4096, context_cpu));
+          std::memset(handles.back().dptr, t * kChunks + i, handles.back().size);
+        }
+        for (int i = 0; i < kChunks; ++i) {
+          const auto* data = static_cast<const unsigned char*>(handles[i].dptr);
+          EXPECT_EQ(data[0], static_cast<unsigned char>(t * kChunks + i));
+          EXPECT_EQ(data[handles[i].size - 1], static_cast<unsigned char>(t * kChunks + i));
+          if (round == 2 && i % 2)
+            handed_over[t].push_back(handles[i]);
+          else
+            storage->Free(handles[i]);
+        }
+      }
+    });
+  }
+  for (auto& w : workers)
+    w.join();
+  for (auto& handles : handed_over) {
+    for (auto& handle : handles)
+      storage->Free(handle);
+  }
+  // memory freed by exited threads is reused
+  auto&& handle = storage->Alloc(64, context_cpu);
+  EXPECT_NE(handle.dptr, nullptr);
+  storage->Free(handle);
+  storage->ReleaseAll(context_cpu);
+}
+
+TEST(Storage, CPU_Stats) {
+  auto&& storage             = mxnet::Storage::Get();
+  mxnet::Context context_cpu = mxnet::Context::CPU(0);
+  auto&& handle              = storage->Alloc(1 << 20, context_cpu);
+  storage->Free(handle);
+  handle = storage->Alloc(1 << 20, context_cpu);
+  storage->Free(handle);
+  const std::string stats = storage->GetStats();
+  EXPECT_EQ(stats.front(), '{');
+  EXPECT_EQ(stats.back(), '}');
+  EXPECT_NE(stats.find("\"cpu(0)\""), std::string::npos);
+  // default pool, 1MB is a multiple of the page size
+  if (!dmlc::GetEnv("MXNET_USE_NAIVE_STORAGE_MANAGER", 0) &&
+      std::getenv("MXNET_CPU_MEM_POOL_TYPE") == nullptr) {
+    EXPECT_NE(stats.find("\"chunk_size\": 1048576"), std::string::npos);
+    EXPECT_NE(stats.find("\"peak_reserved\""), std::string::npos);
+  }
+}
+
+TEST(Storage, CPU_Budget) {
+  if (dmlc::GetEnv("MXNET_USE_NAIVE_STORAGE_MANAGER", 0) ||
+      std::getenv("MXNET_CPU_MEM_POOL_TYPE") != nullptr)
+    return;
+  constexpr size_t kMB       = 1 << 20;
+  auto&& storage             = mxnet::Storage::Get();
+  mxnet::Context context_cpu = mxnet::Context::CPU(0);
+  auto&& first               = storage->Alloc(kMB, context_cpu);
+  storage->Free(first);
+  storage->ReleaseAll(context_cpu);
+  // memory still reserved, e.g. by thread local caches
+  const std::string stats = storage->GetStats();
+  const size_t pos        = stats.find("\"reserved\": ", stats.find("\"cpu(0)\""));
+  ASSERT_NE(pos, std::string::npos);
+  const size_t baseline = std::stoull(stats.substr(pos + std::strlen("\"reserved\": ")));
+
+  storage->SetBudget(context_cpu, baseline + 3 * kMB);
+  auto&& a = storage->Alloc(kMB, context_cpu);
+  auto&& b = storage->Alloc(kMB, context_cpu);
+  EXPECT_NE(a.dptr, nullptr);
+  EXPECT_NE(b.dptr, nullptr);
+  EXPECT_EQ(storage->Alloc(2 * kMB, context_cpu, true).dptr, nullptr);
+
+  // the callback frees a, whose cached chunk is released to fit the budget
+  int num_calls = 0;
+  const int id  = storage->AddMemoryPressureCallback([&](const mxnet::Context& ctx) {
+    EXPECT_EQ(ctx, context_cpu);
+    ++num_calls;
+    storage->Free(a);
+    a.dptr = nullptr;
+  });
+  auto&& c = storage->Alloc(2 * kMB, context_cpu, true);
+  storage->RemoveMemoryPressureCallback(id);
+  EXPECT_EQ(num_calls, 1);
+  EXPECT_NE(c.dptr, nullptr);
+
+  storage->Free(b);
+  storage->Free(c);
+  storage->SetBudget(context_cpu, 0);
+  storage->ReleaseAll(context_cpu);
+}
+
 #if MXNET_USE_CUDA
 TEST(Storage_GPU, Basic_GPU) {
   if (mxnet::test::unitTestsWithCuda) {
@@ -0,0 +1,84 @@
+#!/usr/bin/env python
+
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# Runs the workers of a dist_sync_allreduce kvstore on the local machine:
+#   python3 dist_sync_allreduce_kvstore.py --num-workers 4
+
+import argparse
+import os
+import subprocess
+import sys
+sys.path.insert(0, "../../python/")
+import numpy as np
+
+def check_diff_to_scalar(A, x, rank=None):
+    """ assert A == x"""
+    assert(np.sum(np.abs((A - x).asnumpy())) == 0), (rank, A.asnumpy(), x)
+
+shape = (2, 3)
+big_shape = (1200, 1200)
+rate = 2
+
+def run_worker():
+    import mxnet as mx
+    kv = mx.kv.create('dist_sync_allreduce')
+    my_rank = kv.rank
+    nworker = kv.num_workers
+    # keys start from the values of worker 0
+    kv.init(['3', '99'], [mx.nd.ones(shape) * (my_rank + 1), mx.nd.ones(big_shape) * (my_rank + 1)])
+    for key, s in [('3', shape), ('99', big_shape)]:
+        val = mx.nd.zeros(s)
+        kv.pull(key, out=val)
+        check_diff_to_scalar(val, 1, my_rank)
+
+    # pushpull sums over the workers
+    nrepeat = 3
+    expected = nworker * (nworker + 1) / 2
+    for _ in range(nrepeat):
+        for s in [shape, big_shape]:
+            out = mx.nd.zeros(s)
+            kv.pushpull('3' if s == shape else '99', mx.nd.ones(s) * (my_rank + 1), out=out)
+            check_diff_to_scalar(out, expected, my_rank)
+
+    # the optimizer runs on each worker
+    kv.init('5', mx.nd.ones(shape))
+    kv.set_optimizer(mx.optimizer.create('test', rescale_grad=rate))
+    for _ in range(nrepeat):
+        kv.push('5', mx.nd.ones(shape))
+    val = mx.nd.zeros(shape)
+    kv.pull('5', out=val)
+    check_diff_to_scalar(val, 1 + nrepeat * rate * nworker, my_rank)
+    kv.barrier()
+    print('worker ' + str(my_rank) + ' is done')
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description='test dist_sync_allreduce kvstore')
+    parser.add_argument('--num-workers', type=int, default=4)
+    parser.add_argument('--port', type=int, default=9191)
+    args = parser.parse_args()
+    if 'DMLC_WORKER_ID' in os.environ:
+        run_worker()
+    else:
+        procs = []
+        for rank in range(args.num_workers):
+            env = dict(os.environ, DMLC_WORKER_ID=str(rank), DMLC_NUM_WORKER=str(args.num_workers),
+                       DMLC_PS_ROOT_URI='127.0.0.1', DMLC_PS_ROOT_PORT=str(args.port))
+            procs.append(subprocess.Popen([sys.executable, __file__], env=env))
+        codes = [p.wait() for p in procs]
+        assert all(c == 0 for c in codes), codes
@@ -531,6 +531,60 @@ def test_gluon_trainer_sparse_step():
     check_trainer_sparse_step()
     print('worker ' + str(my_rank) + ' passed test_gluon_trainer_sparse_step')
 
+def test_sync_row_sparse_cache(nrepeat):
+    # run with MXNET_KVSTORE_ROW_CACHE_SIZE > 0 and MXNET_KVSTORE_ROW_CACHE_STALENESS=1
+    k = '15'
+    s = (10, 3)
+    kv.init(k, mx.nd.ones(s).tostype('row_sparse'))
+    kv.set_optimizer(mx.optimizer.create('test', rescale_grad=rate))
+
+    def check_pull(value):
+        # the rows wanted by both devices are pulled once, then served from the cache
+        row_ids = [mx.nd.array([0, 1, 5]), mx.nd.array([1, 5, 7])]
+        out = [mx.nd.zeros(s, ctx=mx.cpu(d), stype='row_sparse') for d in range(2)]
+        kv.row_sparse_pull(k, out=out, row_ids=row_ids)
+        for o, r in zip(out, row_ids):
+            expected = np.zeros(s)
+            expected[r.asnumpy().astype(np.int64)] = value
+            check_diff(o, expected, kv.rank)
+
+    for _ in range(nrepeat):
+        check_pull(1)
+    v = mx.nd.zeros(s)
+    v[:] = 1
+    kv.push(k, v.tostype('row_sparse'))
+    # the rows cached may be served once more before being pulled again
+    out = mx.nd.zeros(s, stype='row_sparse')
+    kv.row_sparse_pull(k, out=out, row_ids=mx.nd.array([0, 1, 5, 7]))
+    check_pull(1 + rate * nworker)
+    print('worker ' + str(my_rank) + ' passed test_sync_row_sparse_cache')
+
+def test_sync_elastic(nrepeat):
+    # run with MXNET_KVSTORE_ELASTIC=1
+    k = '16'
+    kv.init(k, mx.nd.zeros(shape))
+    kv.set_optimizer(mx.optimizer.create('test', rescale_grad=rate))
+
+    def push_pull(nrepeat):
+        val = mx.nd.zeros(shape)
+        for _ in range(nrepeat):
+            kv.push(k, mx.nd.ones(shape))
+            kv.pull(k, out=val)
+        return val
+
+    val = push_pull(nrepeat)
+    expected = nrepeat * rate * nworker
+    check_diff(val, expected, my_rank)
+    # the last worker leaves, the others keep training without it
+    if my_rank == nworker - 1:
+        kv.leave()
+    kv._barrier()
+    if my_rank != nworker - 1:
+        val = push_pull(nrepeat)
+        check_diff(val, expected + nrepeat * rate * (nworker - 1), my_rank)
+        kv._barrier()
+    print('worker ' + str(my_rank) + ' passed test_sync_elastic')
+
 if __name__ == "__main__":
     parser = argparse.ArgumentParser(description='test distributed kvstore in dist_sync mode')
     parser.add_argument('--nrepeat', type=int, default=7)
@@ -552,6 +606,10 @@ if __name__ == "__main__":
         kv = init_kv()
         kv = set_optimizer(use_multiprecision=opt.multiprecision)
         test_sync_push_pull(opt.nrepeat)
+    elif opt.type == 'row_sparse_cache_cpu':
+        test_sync_row_sparse_cache(opt.nrepeat)
+    elif opt.type == 'elastic_cpu':
+        test_sync_elastic(opt.nrepeat)
     elif opt.type == 'compressed_cpu_1bit':
         kv, threshold = init_kv_compressed(kv, '1bit', 0)
         kv = set_optimizer(use_multiprecision=opt.multiprecision)
@@ -18,6 +18,7 @@
 # specific language governing permissions and limitations
 # under the License.
 
+import os
 import sys
 sys.path.insert(0, "../../python/")
 import mxnet as mx
@@ -78,6 +79,27 @@ def compute_2bit(arr, curr_residual, threshold):
         str_quant += "0" * (16 - len(str_quant) % 16)
     return str_quant, new_residual, decompr
 
+def compute_fp16(arr, curr_residual, threshold):
+    val = (curr_residual + arr).astype(np.float32)
+    decompr = val.astype(np.float16).astype(np.float32)
+    return '', val - decompr, decompr
+
+def compute_bf16(arr, curr_residual, threshold):
+    val = (curr_residual + arr).astype(np.float32)
+    # bf16 keeps the 16 high bits of a float32
+    decompr = (val.view(np.uint32) & 0xffff0000).view(np.float32)
+    return '', val - decompr, decompr
+
+def compute_topk(arr, curr_residual, ratio):
+    block = int(round(1 / ratio))
+    val = (curr_residual + arr).astype(np.float32).flatten()
+    decompr = np.zeros_like(val)
+    for start in range(0, val.size, block):
+        top = start + np.argmax(np.abs(val[start:start + block]))
+        decompr[top] = np.float16(val[top])
+        val[top] -= decompr[top]
+    return '', val.reshape(arr.shape), decompr
+
 def compute_expected_quantization(arr, curr_residual, threshold, quantize_func):
 
     from struct import pack,unpack
@@ -126,10 +148,20 @@ def test_compress_kvstore(kv_type, compression='2bit', threshold=0.5):
         quantize_func = compute_1bit
     elif compression == '2bit':
         quantize_func = compute_2bit
+    elif compression == 'fp16':
+        quantize_func = compute_fp16
+    elif compression == 'bf16':
+        quantize_func = compute_bf16
+    elif compression == 'topk':
+        quantize_func = compute_topk
     else:
         raise RuntimeError("Unknown gradient compression type!")
     kv = mx.kv.create(kv_type)
-    kv.set_gradient_compression({'type':compression, 'threshold':threshold})
+    if compression == 'topk':
+        # threshold is the ratio of the values sent
+        kv.set_gradient_compression({'type':compression, 'ratio':threshold})
+    else:
+        kv.set_gradient_compression({'type':compression, 'threshold':threshold})
     kv.set_optimizer(mx.optimizer.create('test', learning_rate=-rate))
     for k, s in zip(keys, shapes):
         kv.init(k, mx.nd.zeros(s))
@@ -291,6 +323,8 @@ def test_compress_kvstore(kv_type, compression='2bit', threshold=0.5):
         push_zeros(kv)
         curval = verify_residual_2bit(kv, threshold, rate)
         check_neg(kv, -1*threshold, rate, curval)
+    else:
+        push_zeros(kv)
     check_compr_random(kv, threshold)
 
 ## group keys interface
@@ -338,7 +372,19 @@ if __name__ == "__main__":
     test_compress_kvstore('local_allreduce_device', '1bit', 0)
     test_compress_kvstore('local_allreduce_device', '1bit', .5)
     test_compress_kvstore('local_allreduce_device', '2bit', .5)
+    test_compress_kvstore('local_allreduce_device', 'fp16')
+    test_compress_kvstore('local_allreduce_device', 'bf16')
+    test_compress_kvstore('local_allreduce_device', 'topk', .1)
     for stype in stypes:
         test_group_kvstore('local_update_cpu', stype)
         test_group_kvstore('local_allreduce_cpu', stype)
         test_group_kvstore('local_allreduce_device', stype)
+
+    ## every reduction of the topology aware device kvstore, chunking the ring
+    os.environ['MXNET_KVSTORE_RING_CHUNK_SIZE'] = '100000'
+    for algo in ['direct', 'tree', 'ring']:
+        os.environ['MXNET_KVSTORE_AUTO_ALGO'] = algo
+        test_kvstore('local_allreduce_device', 'default')
+        test_group_kvstore('local_allreduce_device', 'default')
+    del os.environ['MXNET_KVSTORE_AUTO_ALGO']
+    del os.environ['MXNET_KVSTORE_RING_CHUNK_SIZE']
@@ -222,6 +222,29 @@ def test_amp_node_excluding(lp_dtype):
                       lp16_casts_num=0, other_casts_num=0)
 
 
+def test_amp_cast_optimization(lp_dtype):
+  data = mx.sym.var('data')
+  wei = mx.sym.var('weights')
+  # round trip through a wider type and casts of the weights to their own type, all redundant
+  x = mx.sym.amp_cast(mx.sym.amp_cast(data, dtype='float64'), dtype='float32')
+  fc1 = mx.sym.FullyConnected(x, mx.sym.amp_cast(wei, dtype='float32'), num_hidden=4,
+                              no_bias=True, name='fc1')
+  fc2 = mx.sym.FullyConnected(x, mx.sym.amp_cast(wei, dtype='float32'), num_hidden=4,
+                              no_bias=True, name='fc2')
+  symnet = mx.sym.Group([fc1, fc2])
+
+  net = mx.gluon.SymbolBlock(symnet, [data])
+  net.initialize()
+  data_example = mx.np.random.uniform(-1, 1, (4, 16))
+  lp_net = amp.convert_hybrid_block(net, data_example, lp_dtype, cast_params_offline=True)
+
+  # `data` is cast once for both layers, the weights are cast offline
+  check_amp_net_stats(lp_dtype, lp_net, data_example, lp16_tensors_num=3,
+                      lp16_casts_num=1, other_casts_num=2)
+  for param in lp_net.collect_params().values():
+    assert mx.nd.get_dtype_name(param.dtype) == lp_dtype
+
+
 def check_amp_net_stats(lp_dtype, net, data_example, lp16_tensors_num, lp16_casts_num, other_casts_num):
   lp16_tensors = set()
   lp16_casts = set()
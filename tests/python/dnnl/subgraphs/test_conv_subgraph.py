@@ -16,11 +16,14 @@
 # under the License.
 
 import copy
+import json
+import os
 import mxnet as mx
 import pytest
 from subgraph_common import check_fusion, check_neg_fusion, check_quantize
 from subgraph_common import CustomNormalInit, DATA_SHAPE, RELU6, TailNegBlock
 from subgraph_common import DATA_SHAPE, SG_PASS_NAME, QUANTIZE_SG_PASS_NAME
+from mxnet import profiler
 from mxnet.contrib import quantization
 from mxnet.gluon import nn
 from mxnet.test_utils import assert_almost_equal, assert_almost_equal_with_err
@@ -555,6 +558,46 @@ def test_deduplication(data_shape, reverse_sum_order, model_name):
   assert_almost_equal(out.asnumpy(), out_dedup.asnumpy(), rtol=1e-3, atol=1e-1)
 
 
+@mx.util.use_np
+@pytest.mark.parametrize('data_shape', DATA_SHAPE)
+def test_prepack(data_shape):
+  data_nd = mx.np.random.uniform(-1, 1, size=data_shape, device=mx.cpu())
+  net = ConvBNSum(channels=data_shape[1], reverse_sum_order=False)
+  net.initialize()
+  net.hybridize()
+  out_ref = net(data_nd)
+
+  net_prepack = copy.copy(net)
+  with pytest.raises(ValueError):
+    net_prepack.optimize_for(data_nd, backend=SG_PASS_NAME, clear=True, prepack=True)
+
+  def count_packings(fn):
+    # the packings are reported to the profiler as they happen
+    file_name = 'test_prepack.json'
+    profiler.set_config(profile_imperative=True, filename=file_name)
+    profiler.set_state('run')
+    result = fn()
+    mx.npx.waitall()
+    profiler.set_state('stop')
+    profiler.dump(True)
+    with open(file_name) as f:
+      events = json.load(f)['traceEvents']
+    os.remove(file_name)
+    return result, sum(1 for e in events if e.get('name') == 'packed weights misses')
+
+  _, packings = count_packings(lambda: net_prepack.optimize_for(
+      data_nd, backend=SG_PASS_NAME, clear=True, static_alloc=True, prepack=True))
+  assert packings > 0
+  # the weights prepared on the given inputs are reused by the following calls
+  out, packings = count_packings(lambda: net_prepack(data_nd))
+  assert packings == 0
+  assert_almost_equal(out.asnumpy(), out_ref.asnumpy(), rtol=1e-3, atol=1e-1)
+  other_nd = mx.np.random.uniform(-1, 1, size=data_shape, device=mx.cpu())
+  out, packings = count_packings(lambda: net_prepack(other_nd))
+  assert packings == 0
+  assert_almost_equal(out.asnumpy(), net(other_nd).asnumpy(), rtol=1e-3, atol=1e-1)
+
+
 @mx.util.use_np
 @pytest.mark.parametrize('data_shape', DATA_SHAPE)
 def test_neg_conv_bn(data_shape):
@@ -15,10 +15,11 @@
 # specific language governing permissions and limitations
 # under the License.
 
+import json
 import mxnet as mx
 import pytest
 from subgraph_common import check_fusion, check_neg_fusion, check_neg_fusion_quantized, check_quantize
-from subgraph_common import CustomNormalInit, DATA_SHAPE, TailNegBlock
+from subgraph_common import CustomNormalInit, DATA_SHAPE, SG_PASS_NAME, TailNegBlock
 from mxnet.contrib import quantization
 from mxnet.gluon import nn
 from mxnet.test_utils import assert_almost_equal_with_err
@@ -142,6 +143,39 @@ def test_fc_eltwise(data_shape, use_bias, flatten, alg):
   check_fusion(net, data_shape, attrs, check_quantization=flatten)
 
 
+@mx.util.use_np
+@pytest.mark.parametrize('data_shape', DATA_SHAPE)
+@pytest.mark.parametrize('use_bias', [True, False])
+@pytest.mark.parametrize('chain', ['gelu_add_mul', 'mul_add_tanh', 'clip_exp_sub', 'sigmoid_div_log'])
+def test_fc_eltwise_chain(data_shape, use_bias, chain):
+  # fc + chain of eltwise and scalar ops, all folded into the post-ops of fc
+  class FCEltwiseChain(nn.HybridBlock):
+    def __init__(self, use_bias, chain, **kwargs):
+      super(FCEltwiseChain, self).__init__(**kwargs)
+      self.fc = nn.Dense(units=64, use_bias=use_bias)
+      self.chain = chain
+
+    def forward(self, x):
+      out = self.fc(x)
+      if self.chain == 'gelu_add_mul':
+        out = (mx.npx.leaky_relu(out, act_type='gelu') + 0.5) * 2.0
+      elif self.chain == 'mul_add_tanh':
+        out = mx.np.tanh(out * 0.5 + 1.0)
+      elif self.chain == 'clip_exp_sub':
+        out = mx.np.exp(mx.np.clip(out, -2.0, 1.0)) - 1.0
+      else:
+        out = mx.np.log(mx.npx.activation(out, act_type='sigmoid') / 2.0)
+      return out
+
+  attrs = {'fc': {'with_eltwise': 'true'}}
+  net = FCEltwiseChain(use_bias, chain)
+  check_fusion(net, data_shape, attrs, check_quantization=False)
+
+  sym, _ = net.export(None)
+  sym_sg = sym.optimize_for(SG_PASS_NAME, dedup_subgraph=True, skip_infer=True)
+  assert len([n for n in json.loads(sym_sg.tojson())['nodes'] if n['op'] != 'null']) == 1
+
+
 @mx.util.use_np
 @pytest.mark.parametrize('data_shape', DATA_SHAPE)
 @pytest.mark.parametrize('use_bias', [True, False])
@@ -471,3 +505,33 @@ def test_add_quantized(add_op, quantize_mode, out_type, relu, broadcast, calib_m
     pytest.skip()
   data_shape = DATA_SHAPE[0]
   function_add_quantized(data_shape, add_op, quantize_mode, relu, out_type, broadcastB, calib_mode)
+
+
+@mx.util.use_np
+def test_fc_shared_weights_between_cached_ops():
+  """Two fused cached ops bound to the same parameters share their packed weights, which
+  must follow the updates of the parameters"""
+  class FCRelu(nn.HybridBlock):
+    def __init__(self, **kwargs):
+      super(FCRelu, self).__init__(**kwargs)
+      self.fc = nn.Dense(units=64)
+
+    def forward(self, x):
+      return mx.npx.relu(self.fc(x))
+
+  data = mx.np.random.uniform(-1, 1, size=DATA_SHAPE[0])
+  net_ref = FCRelu()
+  net_ref.initialize()
+  replicas = []
+  for _ in range(2):
+    net = FCRelu()
+    net.share_parameters(net_ref.collect_params())
+    net.optimize_for(data, backend=SG_PASS_NAME)
+    replicas.append(net)
+
+  for scale in [1, 2]:
+    if scale != 1:
+      net_ref.fc.weight.set_data(net_ref.fc.weight.data() * scale)
+    ref = net_ref(data)
+    for net in replicas:
+      assert_almost_equal_with_err(net(data), ref, rtol=1e-3, atol=1e-3, etol=0.01)
@@ -0,0 +1,83 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+import copy
+import mxnet as mx
+import pytest
+from subgraph_common import DATA_SHAPE, SG_PASS_NAME
+from mxnet.gluon import nn
+from mxnet.test_utils import assert_almost_equal
+
+
+def check_layout_fusion(net, data_shape, fused):
+  net.initialize()
+  net.hybridize()
+  data = mx.np.random.uniform(size=data_shape, low=-1.0, high=1.0)
+  out_unfused = net(data)
+
+  net_fusion = copy.copy(net)
+  net_fusion.optimize_for(data, backend=SG_PASS_NAME)
+  out_fused = net_fusion(data)
+  assert_almost_equal(out_unfused.asnumpy(), out_fused.asnumpy(), rtol=1e-3, atol=1e-3)
+
+  sym, _ = net_fusion.export(None)
+  found = ''.join(sym.get_internals().list_outputs()).find('sg_onednn_layout_eltwise') != -1
+  assert found == fused
+
+
+@mx.util.use_np
+@pytest.mark.parametrize('data_shape', DATA_SHAPE)
+def test_layout_eltwise_between_convs(data_shape):
+  class ConvScaleConv(nn.HybridBlock):
+    def __init__(self, **kwargs):
+      super(ConvScaleConv, self).__init__(**kwargs)
+      self.conv0 = nn.Conv2D(channels=16, kernel_size=(3, 3), strides=1)
+      self.conv1 = nn.Conv2D(channels=16, kernel_size=(3, 3), strides=1)
+
+    def forward(self, x):
+      out = mx.np.clip(self.conv0(x) * 0.5 + 1, -1, 2)
+      return self.conv1(mx.npx.stop_gradient(1 - out) / 4)
+
+  check_layout_fusion(ConvScaleConv(), data_shape, True)
+
+
+@mx.util.use_np
+@pytest.mark.parametrize('data_shape', DATA_SHAPE)
+def test_layout_eltwise_after_pooling(data_shape):
+  class PoolShift(nn.HybridBlock):
+    def __init__(self, **kwargs):
+      super(PoolShift, self).__init__(**kwargs)
+      self.conv = nn.Conv2D(channels=16, kernel_size=(3, 3), strides=1)
+      self.pool = nn.MaxPool2D(pool_size=(2, 2))
+
+    def forward(self, x):
+      pooled = self.pool(self.conv(x))
+      # shifted is read twice, so the chain stops at the subtraction
+      shifted = pooled - 3
+      return shifted * 2 + shifted
+
+  check_layout_fusion(PoolShift(), data_shape, True)
+
+
+@mx.util.use_np
+def test_neg_layout_eltwise():
+  class Scale(nn.HybridBlock):
+    def forward(self, x):
+      # no oneDNN operator produces the input
+      return x * 3 + 1
+
+  check_layout_fusion(Scale(), (4, 3, 24, 24), False)
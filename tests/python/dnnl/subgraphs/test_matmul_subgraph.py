@@ -16,6 +16,7 @@
 # under the License.
 
 import copy
+import json
 import mxnet as mx
 import numpy as np
 import pytest
@@ -140,6 +141,32 @@ def test_self_attention_negative(batch_size, seq_length, units, num_heads):
   atol = 0.1 * max(abs(min_range), abs(max_range))
   assert_almost_equal_with_err(qout.asnumpy(), ref_out.asnumpy(), rtol=0.1, atol=atol, etol=0.2)
 
+@use_np
+@pytest.mark.parametrize('batch_size', [1, 4])
+@pytest.mark.parametrize('seq_length', [7, 384])
+@pytest.mark.parametrize('num_heads', [4, 8])
+def test_fused_self_attention(batch_size, seq_length, num_heads):
+  units = 256
+  net = MultiHeadAttention(units, num_heads)
+  in_data = mx.np.random.uniform(size=[batch_size, seq_length, units], dtype='float32')
+  mask = mx.np.random.uniform(low=0, high=2, size=[batch_size, seq_length, seq_length], dtype='int32')
+  # a fully masked row
+  mask[0, 0, :] = 0
+
+  net.initialize()
+  net.hybridize()
+  ref_out = net(in_data, mask)
+
+  net.optimize_for(in_data, mask, backend="ONEDNN")
+  out = net(in_data, mask)
+  mx.nd.waitall()
+
+  sym, _ = net.export(None)
+  ops = [node['op'] for node in json.loads(sym.tojson())['nodes']]
+  assert '_sg_onednn_selfatt' in ops
+  assert '_sg_onednn_selfatt_qk_split' not in ops
+  assert_almost_equal(out.asnumpy(), ref_out.asnumpy())
+
 @use_np
 @pytest.mark.parametrize('batch_size', [1, 32])
 @pytest.mark.parametrize('seq_length', [124, 384])
@@ -65,6 +65,11 @@ def test_bf16_test_node_excluding():
     amp_common_tests.test_amp_node_excluding(AMP_DTYPE)
 
 
+@mx.util.use_np
+def test_bf16_cast_optimization():
+    amp_common_tests.test_amp_cast_optimization(AMP_DTYPE)
+
+
 def get_param_name(param):
     if isinstance(param, (mx.nd.NDArray, mx.np.ndarray)):
         return 'Tensor' + str(param.shape)
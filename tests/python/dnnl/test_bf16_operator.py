@@ -149,6 +149,18 @@ def test_bf16_fc():
     fc_bf16 = mx.sym.FullyConnected(data_sym_bf16, **fc_params)
     check_operator_accuracy(fc_fp32, fc_bf16, data_shape=(3, 3, 16, 16), bf16_use_fp32_params=False)
 
+@pytest.mark.parametrize('mode', ['lstm', 'gru', 'rnn_tanh'])
+@pytest.mark.parametrize('bidirectional', [False, True])
+def test_bf16_rnn(mode, bidirectional):
+    data_sym_fp32 = mx.sym.Variable(name='data')
+    data_sym_bf16 = mx.sym.Variable(name='data', dtype='bfloat16')
+
+    rnn_params = {"state_size": 16, "num_layers": 2, "mode": mode, "bidirectional": bidirectional,
+                  "name": "rnn"}
+    rnn_fp32 = mx.sym.RNN(data_sym_fp32, **rnn_params)
+    rnn_bf16 = mx.sym.RNN(data_sym_bf16, **rnn_params)
+    check_operator_accuracy(rnn_fp32, rnn_bf16, data_shape=(5, 2, 16), bf16_use_fp32_params=False)
+
 def test_bf16_pooling():
     pool_params = {"kernel": (3, 3), "stride": (1, 1), "pad": (0, 0), "name": "pool"}
     data_shapes = [(3, 16, 28, 28), (3, 32, 7, 7)]
@@ -20,11 +20,12 @@ DNNL related test cases
 """
 import sys
 import os
+import json
 import numpy as np
 import mxnet as mx
 import pytest
 from mxnet.test_utils import rand_ndarray, assert_almost_equal
-from mxnet import gluon, context, use_np
+from mxnet import gluon, context, profiler, use_np
 from mxnet.gluon import nn
 from mxnet.test_utils import *
 curr_path = os.path.dirname(os.path.abspath(os.path.expanduser(__file__)))
@@ -687,3 +688,72 @@ def test_rnn():
 
     for sl, ss, bs, in_s in itertools.product(SEQ_LENGTH, STATE_SIZE, BATCH_SIZE, INPUT_SIZE): 
         batch_check(sl, ss, bs, in_s)
+
+@pytest.mark.parametrize('dtype', ['float32', 'bfloat16'])
+@pytest.mark.parametrize('op, lhs_shape, rhs_shape', [
+    ('dot', (8, 64), (64, 32)),
+    ('batch_dot', (4, 8, 64), (4, 64, 32))])
+def test_dot_const_rhs(op, lhs_shape, rhs_shape, dtype):
+    # the rhs read again unchanged is cached reordered, writing it must drop the cache
+    lhs = mx.nd.random.uniform(-1, 1, lhs_shape).astype(dtype)
+    rhs = mx.nd.random.uniform(-1, 1, rhs_shape).astype(dtype)
+    rtol, atol = (5e-2, 5e-2) if dtype == 'bfloat16' else (1e-5, 1e-5)
+    for step in range(4):
+        if step == 2:
+            rhs[:] = mx.nd.random.uniform(-1, 1, rhs_shape).astype(dtype)
+        out = getattr(mx.nd, op)(lhs, rhs)
+        ref = np.matmul(lhs.astype('float32').asnumpy(), rhs.astype('float32').asnumpy())
+        assert_almost_equal(out.astype('float32').asnumpy(), ref, rtol=rtol, atol=atol)
+
+@pytest.mark.parametrize('op, lhs_shape, rhs_shape', [
+    ('dot', (8, 64), (64, 32)),
+    ('batch_dot', (4, 8, 64), (4, 64, 32))])
+def test_dot_const_rhs_reused_memory(op, lhs_shape, rhs_shape):
+    # a new rhs which could get the variable and the memory of a freed cached rhs must not be
+    # taken for it
+    lhs = mx.nd.random.uniform(-1, 1, lhs_shape)
+    for _ in range(4):
+        rhs = mx.nd.random.uniform(-1, 1, rhs_shape)
+        ref = np.matmul(lhs.asnumpy(), rhs.asnumpy())
+        for _ in range(2):
+            out = getattr(mx.nd, op)(lhs, rhs)
+            assert_almost_equal(out.asnumpy(), ref, rtol=1e-5, atol=1e-5)
+        del rhs, out
+        mx.nd.waitall()
+
+@pytest.mark.parametrize('op, np_op', [
+    (mx.nd.broadcast_add, np.add), (mx.nd.broadcast_sub, np.subtract),
+    (mx.nd.broadcast_mul, np.multiply), (mx.nd.broadcast_div, np.divide)])
+@pytest.mark.parametrize('lhs_shape, rhs_shape', [
+    ((2, 3, 2, 3, 2, 3, 128), (2, 1, 2, 1, 2, 1, 128)),
+    ((1, 64, 1, 512), (32, 64, 8, 512)),
+    ((8, 1, 4096), (1, 16, 1))])
+def test_binary_broadcast(op, np_op, lhs_shape, rhs_shape):
+    # more axes than the native kernels support, broadcast lhs and broadcast on both sides
+    lhs = mx.nd.random.uniform(1, 2, lhs_shape)
+    rhs = mx.nd.random.uniform(1, 2, rhs_shape)
+    out = op(lhs, rhs)
+    assert_almost_equal(out.asnumpy(), np_op(lhs.asnumpy(), rhs.asnumpy()), rtol=1e-5, atol=1e-5)
+
+@pytest.mark.parametrize('op, np_op', [
+    ('sum', np.sum), ('mean', np.mean), ('max', np.max), ('min', np.min)])
+@pytest.mark.parametrize('shape, axis', [
+    ((16, 1, 64), (1, 2)), ((16, 32, 1), 1), ((4, 8, 16, 32), (2, 3)),
+    ((4, 8, 16, 32), (0, 2)), ((4, 8, 16, 32), None), ((32, 64), 0)])
+def test_reduce(op, np_op, shape, axis):
+    data = mx.nd.random.uniform(-1, 1, shape)
+    out = getattr(mx.nd, op)(data, axis=axis)
+    assert_almost_equal(out.asnumpy(), np_op(data.asnumpy(), axis=axis), rtol=1e-5, atol=1e-5)
+
+def test_profiler_dispatch_report():
+    profiler.set_config(profile_imperative=True, aggregate_stats=True,
+                        filename='test_profiler_dispatch_report.json')
+    profiler.dumps(reset=True)
+    profiler.set_state('run')
+    data = mx.nd.random.uniform(shape=(64, 128))
+    weight = mx.nd.random.uniform(shape=(32, 128))
+    mx.nd.FullyConnected(data, weight, num_hidden=32, no_bias=True)
+    mx.nd.waitall()
+    profiler.set_state('stop')
+    dispatch = json.loads(profiler.dumps(format='json'))['Time']['Operator Dispatch']
+    assert any(name.startswith('FullyConnected [onednn ') for name in dispatch)
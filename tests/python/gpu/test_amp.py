@@ -64,6 +64,11 @@ def test_fp16_test_node_excluding():
     amp_common_tests.test_amp_node_excluding(AMP_DTYPE)
 
 
+@mx.util.use_np
+def test_fp16_cast_optimization():
+    amp_common_tests.test_amp_cast_optimization(AMP_DTYPE)
+
+
 @pytest.mark.skip(reason='Error during waitall(). Tracked in #18099')
 @assert_raises_cudnn_not_satisfied(min_version='5.1.10')
 def test_amp_conversion_rnn(amp_tests):
@@ -452,6 +452,40 @@ def test_sync_batchnorm():
         _check_batchnorm_result(mx.np.random.uniform(size=(4, 1, 4, 4)),
                                 num_devices=ndev, cuda=True)
 
+@mx.util.use_np
+def test_sync_batchnorm_parallel_layers():
+    # the two layers of each model run in parallel branches, so their statistics may be reduced
+    # in a different order on each device, and with 4 GPUs two models of 2 devices run side by side
+    from mxnet.gluon.utils import split_and_load
+    num_gpus = mx.device.num_gpus()
+    if num_gpus < 2:
+        return
+    groups = [[mx.gpu(0), mx.gpu(1)]]
+    if num_gpus >= 4:
+        groups.append([mx.gpu(2), mx.gpu(3)])
+    models = []
+    for devices in groups:
+        bns = [mx.gluon.nn.SyncBatchNorm(in_channels=3, num_devices=len(devices))
+               for _ in range(2)]
+        for bn in bns:
+            bn.initialize(device=devices)
+        data = mx.np.random.uniform(size=(8, 3, 4, 4))
+        models.append((devices, bns, data, split_and_load(data, devices, batch_axis=0)))
+    outs = []
+    with autograd.record():
+        for _, bns, _, xs in models:
+            # the layers are pushed in the reverse order on the odd devices
+            outs.append([[bn(x) for bn in bns] if j % 2 == 0 else
+                         [bn(x) for bn in bns[::-1]][::-1] for j, x in enumerate(xs)])
+    for (devices, bns, data, _), model_outs in zip(models, outs):
+        x = data.asnumpy()
+        mean = x.mean(axis=(0, 2, 3), keepdims=True)
+        var = x.var(axis=(0, 2, 3), keepdims=True)
+        expected = (x - mean) / _np.sqrt(var + 1e-5)
+        for i in range(len(bns)):
+            out = _np.concatenate([dev_outs[i].asnumpy() for dev_outs in model_outs], axis=0)
+            assert_almost_equal(out, expected, atol=1e-3, rtol=1e-3)
+
 def test_symbol_block_fp16(tmpdir):
     # Test case to verify if initializing the SymbolBlock from a model with params
     # other than fp32 param dtype.
@@ -704,3 +738,95 @@ def test_cuda_graphs():
                     if p1.grad_req != 'null':
                         assert_almost_equal(p1.grad(), p2.grad())
             mx.npx.waitall()
+
+@mx.util.use_np
+def test_cachedop_parallel_branches():
+    class Towers(mx.gluon.HybridBlock):
+        def __init__(self):
+            super(Towers, self).__init__()
+            self.towers = mx.gluon.nn.HybridSequential()
+            for kernel in [1, 3, 5]:
+                tower = mx.gluon.nn.HybridSequential()
+                tower.add(mx.gluon.nn.Conv2D(8, kernel, padding=kernel // 2),
+                          mx.gluon.nn.Activation('relu'),
+                          mx.gluon.nn.Conv2D(8, 3, padding=1))
+                self.towers.add(tower)
+
+        def forward(self, x):
+            return mx.np.concatenate([tower(x) for tower in self.towers], axis=1)
+
+    device = mx.gpu(0)
+    x = mx.np.random.uniform(size=(4, 3, 16, 16), device=device)
+    x.attach_grad()
+    results = []
+    for parallel in ['0', '1']:
+        with environment('MXNET_CACHEDOP_PARALLEL_BRANCHES', parallel):
+            net = Towers()
+            net.initialize(mx.init.One(), device=device)
+            net.hybridize(static_alloc=True, static_shape=True)
+            with mx.autograd.record():
+                out = net(x)
+            out.backward()
+            results.append((out, x.grad.copy()))
+    assert_almost_equal(results[0][0], results[1][0])
+    assert_almost_equal(results[0][1], results[1][1])
+
+@mx.util.use_np
+def test_cuda_graphs_shape_change():
+    device = mx.gpu(0)
+    net = mx.gluon.nn.HybridSequential()
+    net.add(mx.gluon.nn.Dense(16, activation='relu'), mx.gluon.nn.Dense(4))
+    net.initialize(mx.init.One(), device=device)
+    ref = mx.gluon.nn.HybridSequential()
+    ref.add(mx.gluon.nn.Dense(16, activation='relu'), mx.gluon.nn.Dense(4))
+    ref.initialize(mx.init.One(), device=device)
+    with environment({'MXNET_ENABLE_CUDA_GRAPHS': '1',
+                      'MXNET_USE_FUSION': '0'}):
+        net.hybridize(static_alloc=True, static_shape=True)
+        # the graphs captured for a batch size are updated for the next
+        for batch_size in [2, 2, 2, 5, 5, 5, 2, 2, 2]:
+            x = mx.np.random.uniform(size=(batch_size, 8), device=device)
+            xg = x.copy()
+            x.attach_grad()
+            xg.attach_grad()
+            with mx.autograd.record():
+                out = ref(x)
+            out.backward()
+            with mx.autograd.record():
+                outg = net(xg)
+            outg.backward()
+            assert_almost_equal(out, outg)
+            assert_almost_equal(x.grad, xg.grad)
+
+@mx.util.use_np
+def test_engine_named_streams():
+    device = mx.gpu(0)
+    x = mx.np.random.uniform(size=(8, 32), device=device)
+    nets, expected = [], []
+    for _ in range(2):
+        net = mx.gluon.nn.HybridSequential()
+        net.add(mx.gluon.nn.Dense(64, activation='relu'), mx.gluon.nn.Dense(8))
+        net.initialize(device=device)
+        net.hybridize(static_alloc=True, static_shape=True)
+        nets.append(net)
+        expected.append(net(x))
+    high = mx.engine.create_stream('high', device, priority=-1)
+    assert mx.engine.create_stream('high', device) == high
+    low = mx.engine.create_stream('low', device)
+    if os.environ.get('MXNET_ENGINE_TYPE', 'ThreadedEnginePerDevice') == 'ThreadedEnginePerDevice':
+        assert high != low and high > 0 and low > 0
+    outs = []
+    for _ in range(5):
+        with mx.engine.stream('high', device, priority=-1):
+            outs.append((0, nets[0](x)))
+        with mx.engine.stream('low', device):
+            outs.append((1, nets[1](x)))
+    for i, out in outs:
+        assert_almost_equal(out, expected[i])
+    # the data on a stream is read on the other streams after it is written
+    with mx.engine.stream('high', device):
+        y = x * 2
+    with mx.engine.stream('low', device):
+        z = y + 1
+    assert_almost_equal(z, x * 2 + 1)
+    assert mx.engine.set_stream(0) == 0
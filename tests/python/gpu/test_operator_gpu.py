@@ -49,6 +49,7 @@ from test_sparse_operator import *
 from test_ndarray import *
 from test_subgraph_op import *
 from test_contrib_operator import test_multibox_target_op
+from test_dgl_graph import test_uniform_sample, test_non_uniform_sample
 from test_optimizer import test_adamW
 del test_custom_op_fork  #noqa
 
@@ -2047,6 +2048,39 @@ def test_softmax_activation():
         assert_almost_equal(cpu_a.grad, gpu_a.grad, atol = 1e-3, rtol = 1e-3)
 
 
+@pytest.mark.parametrize('dtype', ['float16', 'float32', 'float64'])
+def test_ctc_loss_long_sequences(dtype):
+    seq_len, batch_size, alphabet_size, label_len = 300, 3, 40, 120
+    data = np.random.uniform(-1, 1, (seq_len, batch_size, alphabet_size)).astype(dtype)
+    label = np.random.randint(1, alphabet_size, (batch_size, label_len))
+    # repeated labels, a shorter label and a shorter sequence
+    label[0, 10:20] = 7
+    label[1, 90:] = 0
+    data_lengths = np.array([seq_len, seq_len, 250])
+    results = []
+    for ctx in [mx.cpu(0), mx.gpu(0)]:
+        x = mx.nd.array(data.astype(np.float32), ctx=ctx)
+        x.attach_grad()
+        with mx.autograd.record():
+            loss = mx.nd.ctc_loss(x, mx.nd.array(label, ctx=ctx),
+                                  mx.nd.array(data_lengths, ctx=ctx), use_data_lengths=True)
+        loss.backward()
+        results.append((loss, x.grad))
+    x = mx.nd.array(data, ctx=mx.gpu(0), dtype=dtype)
+    x.attach_grad()
+    with mx.autograd.record():
+        loss = mx.nd.ctc_loss(x, mx.nd.array(label, ctx=mx.gpu(0)),
+                              mx.nd.array(data_lengths, ctx=mx.gpu(0)), use_data_lengths=True)
+    loss.backward()
+    assert loss.dtype == np.dtype(dtype) and x.grad.dtype == np.dtype(dtype)
+    (cpu_loss, cpu_grad), (gpu_loss, gpu_grad) = results
+    assert_almost_equal(cpu_loss, gpu_loss, rtol=1e-4, atol=1e-3)
+    assert_almost_equal(cpu_grad, gpu_grad, rtol=1e-4, atol=1e-5)
+    tol = 1e-2 if dtype == 'float16' else 1e-4
+    assert_almost_equal(cpu_loss, loss.astype(np.float32), rtol=tol, atol=tol)
+    assert_almost_equal(cpu_grad, x.grad.astype(np.float32), rtol=tol, atol=tol)
+
+
 @pytest.mark.serial
 @pytest.mark.serial
 def test_bilinear_sampler_versions():
@@ -2219,3 +2253,86 @@ def test_split_v2_fwd(dtype):
     data = mx.sym.Variable("data")
     sym = mx.sym.split_v2(data, indices_or_sections=indices, axis=axis)
     check_symbolic_forward(sym, {"data": mx_data}, np_out, rtol=1e-3, atol=1e-5)
+
+
+def _async_mem_pool_churn(seed):
+    with random_seed(seed):
+        # Shapes change every step, so the pool keeps handing out chunks whose
+        # frees are still pending behind operators of the previous steps.
+        for _ in range(50):
+            n = np.random.randint(1, 512)
+            a_np = np.random.uniform(-1, 1, size=(n, 64)).astype('float32')
+            b_np = np.random.uniform(-1, 1, size=(64, n)).astype('float32')
+            a = mx.nd.array(a_np, ctx=mx.gpu(0))
+            b = mx.nd.array(b_np, ctx=mx.gpu(0))
+            c = mx.nd.dot(a, b) * 2 + 1
+            d = mx.nd.sum(c, axis=0)
+            del a, b, c
+            assert_almost_equal(d.asnumpy(), (np.dot(a_np, b_np) * 2 + 1).sum(axis=0),
+                                rtol=1e-3, atol=1e-3)
+
+
+@pytest.mark.serial
+@pytest.mark.parametrize('engine', ['ThreadedEnginePerDevice', 'ThreadedEnginePerDeviceAsync',
+                                    'NaiveEngine'])
+def test_async_mem_pool(engine):
+    run_in_spawned_process(_async_mem_pool_churn,
+                           {'MXNET_GPU_MEM_POOL_TYPE': 'Async', 'MXNET_ENGINE_TYPE': engine,
+                            'MXNET_GPU_WORKER_NSTREAMS': '2'})
+
+
+def _rtc_kernels(seed, out_file):
+    x = mx.nd.array(np.arange(60).reshape(3, 20) / 10, ctx=mx.gpu(0))
+    mx.nd.save(out_file, [mx.nd.softmax(x), mx.nd.sum(x, axis=1)])
+
+
+@pytest.mark.serial
+def test_rtc_disk_cache(tmpdir):
+    cache_dir = str(tmpdir.mkdir('cache'))
+    x_np = np.arange(60).reshape(3, 20) / 10
+    expected = [np.exp(x_np) / np.exp(x_np).sum(axis=1, keepdims=True), x_np.sum(axis=1)]
+    def run():
+        out_file = str(tmpdir.join('out.nd'))
+        run_in_spawned_process(_rtc_kernels, {'MXNET_RTC_CACHE_DIR': cache_dir}, out_file)
+        for out, ref in zip(mx.nd.load(out_file), expected):
+            assert_almost_equal(out.asnumpy(), ref, rtol=1e-5, atol=1e-5)
+        return {f: os.path.getmtime(os.path.join(cache_dir, f)) for f in os.listdir(cache_dir)}
+
+    # the compiled kernels are stored, then loaded by the next process
+    files = run()
+    assert len(files) > 0
+    assert run() == files
+
+    # a file whose key differs only in the source, as for a hash collision, is a miss
+    for f in files:
+        path = os.path.join(cache_dir, f)
+        with open(path, 'rb') as cached:
+            content = bytearray(cached.read())
+        key_end = content.index(b'\n') + 1 + int(content[:content.index(b'\n')])
+        content[key_end - 1:key_end] = b' ' if content[key_end - 1:key_end] != b' ' else b'\t'
+        with open(path, 'wb') as cached:
+            cached.write(content)
+        os.utime(path, (0, 0))
+    assert all(mtime > 0 for mtime in run().values())
+
+
+def _mixed_cpu_gpu_pipeline(seed):
+    with random_seed(seed):
+        # every CPU operator depends on the GPU operators just before it
+        x_np = np.random.uniform(-1, 1, size=(256, 256)).astype('float32')
+        x = mx.nd.array(x_np, ctx=mx.gpu(0))
+        expected = x_np
+        for _ in range(20):
+            y = mx.nd.dot(x, x, transpose_b=True) / 256
+            y_cpu = y.as_in_context(mx.cpu()) + 1
+            x = (y_cpu * 0.5).as_in_context(mx.gpu(0))
+            expected = (np.dot(expected, expected.T) / 256 + 1) * 0.5
+        assert_almost_equal(x.asnumpy(), expected, rtol=1e-3, atol=1e-3)
+
+
+@pytest.mark.serial
+@pytest.mark.parametrize('poll', ['1', '0'])
+def test_async_engine_cpu_gpu_pipeline(poll):
+    run_in_spawned_process(_mixed_cpu_gpu_pipeline,
+                           {'MXNET_ENGINE_TYPE': 'ThreadedEnginePerDeviceAsync',
+                            'MXNET_ENGINE_POLL_GPU_DEPENDENCIES': poll})
@@ -101,6 +101,30 @@ def test_calibrated_quantize_v2_bfloat16_to_int8():
     qdata_np = (onp.sign(data_np) * onp.minimum(onp.abs(data_np) * scale + 0.5, quantized_range)).astype(onp.int8)
     assert_almost_equal(qdata.asnumpy(), qdata_np, atol=1)
 
+def test_dynamic_quantize_v2():
+    # without calibration the range is found at runtime, for sizes not divisible by the threads
+    for size in [1, 7, 1000, 65537]:
+        data = mx.nd.random.uniform(-3, 5, (size,))
+        data_np = data.asnumpy()
+        min_range, max_range = data_np.min(), data_np.max()
+        qdata, min_val, max_val = mx.nd.contrib.quantize_v2(data, out_type='int8')
+        real_range = max(abs(min_range), abs(max_range))
+        assert qdata.dtype == onp.int8
+        assert same(min_val.asscalar(), -real_range)
+        assert same(max_val.asscalar(), real_range)
+        qdata_np = (onp.sign(data_np) * onp.minimum(onp.abs(data_np) * (127.0 / real_range) + 0.5,
+                                                    127.0)).astype(onp.int8)
+        assert_almost_equal(qdata.asnumpy(), qdata_np, atol=1)
+        if is_test_for_gpu():
+            continue
+        qdata, min_val, max_val = mx.nd.contrib.quantize_v2(data, out_type='uint8')
+        assert qdata.dtype == onp.uint8
+        assert same(min_val.asscalar(), min_range)
+        assert same(max_val.asscalar(), max_range)
+        scale = 255.0 / (max_range - min_range) if max_range > min_range else 0.0
+        qdata_np = ((data_np - min_range) * scale + 0.5).astype(onp.uint8)
+        assert_almost_equal(qdata.asnumpy(), qdata_np, atol=1)
+
 def test_dequantize_int8_to_float32():
 
     def get_test_data(real_range, qdata_np):
@@ -807,6 +831,41 @@ def test_quantized_fc():
         check_quantized_fc((256, 2048, 2, 2), 800, False, qdtype)
         check_quantized_fc((256, 111, 2, 2), 800, False, qdtype)
 
+@use_np
+def test_quantized_fc_channel_wise():
+    if not is_test_for_gpu():
+        print('skipped testing quantized_fc with channel-wise weight ranges, only supported on gpu')
+        return
+
+    def check_quantized_fc_channel_wise(data_shape, num_hidden, use_bias):
+        # data and weights are exact integers, the per channel weight scales powers of two,
+        # so the only error left is the rounding of the int32 output and of the float accumulation
+        data = mx.np.random.uniform(low=-127, high=127, size=data_shape).astype('int32')
+        weight = mx.np.random.uniform(low=-127, high=127,
+                                      size=(num_hidden, data_shape[1])).astype('int32')
+        weight_scale = mx.np.power(2.0, -mx.np.random.randint(0, 3, size=(num_hidden,))).astype('float32')
+        weight_range = 127.0 * weight_scale
+        fp32_weight = weight.astype('float32') * weight_scale.reshape(-1, 1)
+        output = mx.np.dot(data.astype('float32'), fp32_weight.T)
+        bias_args = {}
+        if use_bias:
+            bias = mx.np.random.uniform(low=-127, high=127, size=(num_hidden,)).astype('int32')
+            output = output + bias.astype('float32')
+            bias_args = {'bias': bias.astype('int8'),
+                         'min_bias': mx.np.array([-127.0]), 'max_bias': mx.np.array([127.0])}
+        qoutput, min_range, max_range = npx.quantized_fully_connected(
+            data=data.astype('int8'), weight=weight.astype('int8'),
+            min_data=mx.np.array([-127.0]), max_data=mx.np.array([127.0]),
+            min_weight=-weight_range, max_weight=weight_range,
+            num_hidden=num_hidden, no_bias=not use_bias, **bias_args)
+        # the output range follows the widest channel
+        scale = max_range.item() / 2147483647.0
+        assert_almost_equal(output.asnumpy(), qoutput.asnumpy() * scale, rtol=0, atol=1)
+
+    for use_bias in [False, True]:
+        check_quantized_fc_channel_wise((32, 64), 100, use_bias)
+        check_quantized_fc_channel_wise((256, 111), 800, use_bias)
+
 @use_np
 def test_quantized_transpose():
     def check_quantized_transpose(shape, qdtype, axes):
@@ -1054,6 +1113,87 @@ def test_quantized_bn():
       check_quantized_bn((32, 3, 224, 224), qdtype)
 
 
+@use_np
+def test_quantized_layer_norm_softmax_gelu():
+    def dequantize(qoutput, min_range, max_range):
+        threshold = max(abs(min_range.item()), abs(max_range.item()))
+        return qoutput.astype('float32') * (threshold / 127.0), threshold
+
+    def check_quantized_ops(data_shape, qdtype):
+        data_low, data_high = get_low_high(qdtype)
+        qdata = mx.np.random.uniform(low=data_low, high=data_high, size=data_shape).astype(qdtype)
+        min_data = mx.np.array([-4.0 if qdtype == 'int8' else 0.0])
+        max_data = mx.np.array([4.0])
+        data = qdata.astype('float32') * (4.0 / data_high)
+        gamma = mx.np.random.uniform(low=0.5, high=1.5, size=(data_shape[-1],))
+        beta = mx.np.random.uniform(low=-0.5, high=0.5, size=(data_shape[-1],))
+
+        # the output range is found at runtime, then taken from calibration
+        ref = npx.layer_norm(data, gamma, beta, axis=-1)
+        output, threshold = dequantize(*npx.quantized_layer_norm(
+            data=qdata, gamma=gamma, beta=beta, min_data=min_data, max_data=max_data))
+        assert_almost_equal(threshold, onp.abs(ref.asnumpy()).max(), rtol=1e-3, atol=1e-3)
+        assert_almost_equal(output.asnumpy(), ref.asnumpy(), rtol=0, atol=threshold / 127)
+        output, threshold = dequantize(*npx.quantized_layer_norm(
+            data=qdata, gamma=gamma, beta=beta, min_data=min_data, max_data=max_data,
+            min_calib_range=-2.0, max_calib_range=2.0))
+        assert threshold == 2.0
+        assert_almost_equal(output.asnumpy(), onp.clip(ref.asnumpy(), -2.0, 2.0),
+                            rtol=0, atol=threshold / 127)
+
+        ref = npx.softmax(data, axis=-1, temperature=2.0)
+        output, threshold = dequantize(*npx.quantized_softmax(
+            data=qdata, min_data=min_data, max_data=max_data, temperature=2.0))
+        assert threshold == 1.0
+        assert_almost_equal(output.asnumpy(), ref.asnumpy(), rtol=0, atol=1.0 / 127)
+        output = npx.quantized_softmax(data=qdata, min_data=min_data, max_data=max_data,
+                                       temperature=2.0, enabled_float_output='float32')[0]
+        assert output.dtype == onp.float32
+        assert_almost_equal(output.asnumpy(), ref.asnumpy(), rtol=1e-4, atol=1e-6)
+
+        for act_type in ['gelu_erf', 'gelu_tanh', 'elu', 'selu', 'leaky']:
+            ref = npx.leaky_relu(data, act_type=act_type, slope=0.1)
+            output, threshold = dequantize(*npx.quantized_leaky_relu(
+                data=qdata, min_data=min_data, max_data=max_data, act_type=act_type, slope=0.1))
+            assert threshold >= onp.abs(ref.asnumpy()).max()
+            assert_almost_equal(output.asnumpy(), ref.asnumpy(), rtol=0, atol=threshold / 127)
+
+    for qdtype in ['int8', 'uint8']:
+        check_quantized_ops((4, 16), qdtype)
+        check_quantized_ops((2, 3, 768), qdtype)
+
+
+@use_np
+def test_quantize_layer_norm_gelu_softmax_chain():
+    if not is_test_for_dnnl():
+        print('skipped testing quantize_net of layer_norm, gelu and softmax since it needs oneDNN')
+        return
+
+    # quantize_net keeps the chain in int8, only the softmax output is dequantized
+    class LayerNormGeluSoftmax(mx.gluon.HybridBlock):
+        def __init__(self, **kwargs):
+            super(LayerNormGeluSoftmax, self).__init__(**kwargs)
+            self.norm = mx.gluon.nn.LayerNorm(in_channels=32)
+
+        def forward(self, x):
+            x = npx.leaky_relu(self.norm(x), act_type='gelu_erf')
+            return npx.softmax(x, axis=-1)
+
+    net = LayerNormGeluSoftmax()
+    net.initialize()
+    data = mx.np.random.uniform(low=-1.0, high=1.0, size=(4, 8, 32))
+    ref = net(data)
+    calib_data = mx.gluon.data.DataLoader(data, batch_size=4)
+    qnet = mx.contrib.quant.quantize_net(net, quantized_dtype='int8', quantize_mode='full',
+                                         calib_data=calib_data, calib_mode='naive',
+                                         num_calib_batches=1, device=mx.current_device())
+    output = qnet(data)
+    assert_almost_equal(output.asnumpy(), ref.asnumpy(), rtol=0, atol=0.02)
+    qsym, _ = qnet.export(None)
+    for op_name in ['quantized_layer_norm', 'quantized_leaky_relu', 'quantized_softmax']:
+        assert qsym.tojson().find(op_name) != -1
+
+
 def test_quantized_reshape():
     test_cases = [((2, 3, 5, 5),  (-2, -1),         False, (2, 75)),
                   ((2, 3, 5, 5),  (-2, -2, -1),     False, (2, 3, 25)),
@@ -1492,6 +1632,46 @@ def test_get_optimal_thresholds():
         assert_almost_equal(onp.array([min_max_dict['layer1'][1]]), expected_threshold, rtol=1e-2, atol=1e-4)
 
 
+def test_calibrate_observe():
+    num_bins = 8001
+    hist = mx.nd.zeros((num_bins,), dtype='float64')
+    stats = mx.nd.array([onp.inf, -onp.inf, 0], dtype='float32')
+    data = mx.nd.uniform(low=-10.532, high=11.3432, shape=(8, 3, 23, 23))
+    mx.nd.contrib.calibrate_observe(data=data, hist=hist, stats=stats)
+    arr = data.asnumpy()
+    th = max(abs(arr.min()), abs(arr.max()))
+    expected_hist, _ = onp.histogram(arr, bins=num_bins, range=(-th, th))
+    assert_almost_equal(stats.asnumpy(), onp.array([arr.min(), arr.max(), th]))
+    # a few values can land in the neighbouring bin with the float32 binning
+    assert onp.abs(hist.asnumpy() - expected_hist).sum() <= 0.001 * arr.size
+
+    # a wider batch grows the range by a power of two and keeps all the counts
+    wider = mx.nd.uniform(low=-50, high=50, shape=(1000,))
+    mx.nd.contrib.calibrate_observe(data=wider, hist=hist, stats=stats)
+    new_th = stats.asnumpy()[2]
+    ratio = new_th / th
+    assert ratio >= 50 / th * 0.99 and abs(onp.log2(ratio) - onp.round(onp.log2(ratio))) < 1e-5
+    assert_almost_equal(hist.asnumpy().sum(), arr.size + 1000)
+
+
+def test_calibrate_entropy_batched():
+    hists, edges = [], []
+    for low, high in [(-10.532, 11.3432), (-1, 1), (-3, 5)]:
+        arr = mx.nd.uniform(low=low, high=high, shape=(4, 3, 23, 23)).asnumpy()
+        th = max(abs(arr.min()), abs(arr.max()))
+        hist, hist_edges = onp.histogram(arr, bins=2001, range=(-th, th))
+        hists.append(hist)
+        edges.append(hist_edges)
+    thresholds, divergences = mx.nd.contrib.calibrate_entropy(hist=mx.nd.array(onp.stack(hists)),
+                                                              hist_edges=mx.nd.array(onp.stack(edges)))
+    assert thresholds.shape == (3,)
+    for i in range(3):
+        th, div = mx.nd.contrib.calibrate_entropy(hist=mx.nd.array(hists[i]),
+                                                  hist_edges=mx.nd.array(edges[i]))
+        assert_almost_equal(thresholds.asnumpy()[i:i + 1], th.asnumpy())
+        assert_almost_equal(divergences.asnumpy()[i:i + 1], div.asnumpy())
+
+
 @use_np
 def test_rnn_quantization():
     data_low = -1
@@ -1551,17 +1731,21 @@ def test_rnn_quantization():
 
 @use_np
 def test_quantized_rnn():
-    def check_quantized_rnn(num_layers, bidirectional, seq_len, batch_size, input_dim, state_size):
+    def check_quantized_rnn(num_layers, bidirectional, seq_len, batch_size, input_dim, state_size,
+                            projection_size=None):
         ndir = 2 if bidirectional else 1
         size = ndir*state_size*4
-        first_lyr_param_size = (input_dim + state_size + 2) * size
-        other_lyr_param_size = (state_size * ndir + state_size + 2) * size
+        iter_size = projection_size if projection_size else state_size
+        proj_param_size = ndir * iter_size * state_size if projection_size else 0
+        first_lyr_param_size = (input_dim + iter_size + 2) * size + proj_param_size
+        other_lyr_param_size = (iter_size * ndir + iter_size + 2) * size + proj_param_size
         full_param_size = first_lyr_param_size + (num_layers - 1) * other_lyr_param_size
 
         data = mx.np.random.uniform(-1, 1, (seq_len, batch_size, input_dim))
-        state = mx.np.random.uniform(-1, 1, (num_layers*ndir, batch_size, state_size))
+        state = mx.np.random.uniform(-1, 1, (num_layers*ndir, batch_size, iter_size))
         state_cell = mx.np.random.uniform(0, 1, (num_layers*ndir, batch_size, state_size))
         params = mx.np.random.normal(0, 1, (full_param_size,))
+        proj_args = {'projection_size': projection_size} if projection_size else {}
 
         out = npx.rnn(data=data,
                       parameters=params,
@@ -1570,7 +1754,8 @@ def test_quantized_rnn():
                       state_size=state_size,
                       state_cell=state_cell,
                       num_layers=num_layers,
-                      bidirectional=bidirectional)
+                      bidirectional=bidirectional,
+                      **proj_args)
 
         data_min = mx.np.min(data)
         data_max = mx.np.max(data)
@@ -1587,10 +1772,13 @@ def test_quantized_rnn():
                                          num_layers=num_layers,
                                          bidirectional=bidirectional,
                                          data_scale=data_scale,
-                                         data_shift=data_shift)
+                                         data_shift=data_shift,
+                                         **proj_args)
 
         mse = onp.mean((out.asnumpy() - qout.asnumpy())**2)
         assert mse < 0.001
 
     check_quantized_rnn(1, False, 5, 2, 16, 16)
     check_quantized_rnn(1, True, 5, 2, 16, 16)
+    check_quantized_rnn(1, False, 5, 2, 16, 16, projection_size=8)
+    check_quantized_rnn(2, True, 5, 2, 16, 16, projection_size=8)
@@ -519,6 +519,25 @@ def test_gradient():
     dx.backward()
     assert abs(x.grad.asscalar() - 2.71828175) < 1e-7
 
+def test_repeated_tape():
+    # the gradient graph of a tape is reused for the tapes of the same structure
+    x = mx.nd.array([1., 2., 3.])
+    y = mx.nd.array([4., 5., 6.])
+    x.attach_grad()
+    y.attach_grad()
+    for i in range(3):
+        with record():
+            z = mx.nd.sum(x * y + mx.nd.exp(x * (i + 1)))
+        z.backward()
+        assert_almost_equal(x.grad, y.asnumpy() + (i + 1) * np.exp(x.asnumpy() * (i + 1)))
+        assert_almost_equal(y.grad, x.asnumpy())
+    for i in range(2):
+        with record():
+            z = mx.nd.sum(x * y)
+        dx, = mx.autograd.grad(z, [x])
+        assert_almost_equal(dx, y.asnumpy())
+        x += 1
+
 def test_retain_grad_drop_grad():
     x = nd.array([1,2,3,4])
     x.attach_grad()
@@ -25,6 +25,7 @@ from numpy.testing import assert_allclose, assert_array_equal
 from mxnet.test_utils import *
 from common import assert_raises_cudnn_not_satisfied, xfail_when_nonstandard_decimal_separator
 import unittest
+import pytest
 
 def test_box_nms_op():
     def test_box_nms_forward(data, expected, thresh=0.5, valid=0, topk=-1, coord=2, score=1, cid=0, bid=-1,
@@ -200,6 +201,67 @@ def test_box_nms_op():
     test_box_nms_forward(np.array(boxes9), np.array(expected9), force=force, thresh=thresh, bid=background_id)
     test_box_nms_backward(np.array(boxes9), grad9, expected_in_grad9, force=force, thresh=thresh, bid=background_id)
 
+def test_box_nms_many_boxes():
+    # more candidates than a bitmask word, in several batches and classes
+    def numpy_box_nms(data, thresh, topk, force):
+        out = np.full(data.shape, -1, dtype=data.dtype)
+        for b, boxes in enumerate(data):
+            order = np.argsort(-boxes[:, 1], kind='stable')[:topk]
+            areas = (boxes[:, 4] - boxes[:, 2]) * (boxes[:, 5] - boxes[:, 3])
+            keep = []
+            for i in order:
+                suppressed = False
+                for j in keep:
+                    if not force and boxes[i, 0] != boxes[j, 0]:
+                        continue
+                    w = max(0, min(boxes[i, 4], boxes[j, 4]) - max(boxes[i, 2], boxes[j, 2]))
+                    h = max(0, min(boxes[i, 5], boxes[j, 5]) - max(boxes[i, 3], boxes[j, 3]))
+                    if w * h / (areas[i] + areas[j] - w * h) > thresh:
+                        suppressed = True
+                        break
+                if not suppressed:
+                    keep.append(i)
+            out[b, :len(keep)] = boxes[keep]
+        return out
+
+    num_batch, num_box = 3, 300
+    data = np.zeros((num_batch, num_box, 6), dtype=np.float32)
+    data[:, :, 0] = np.random.randint(0, 3, size=(num_batch, num_box))
+    data[:, :, 1] = np.random.permutation(num_batch * num_box).reshape(num_batch, num_box) + 1
+    data[:, :, 2:4] = np.random.uniform(0, 80, size=(num_batch, num_box, 2))
+    data[:, :, 4:6] = data[:, :, 2:4] + np.random.uniform(5, 20, size=(num_batch, num_box, 2))
+    for topk, force in [(-1, False), (-1, True), (130, False)]:
+        out = mx.nd.contrib.box_nms(mx.nd.array(data), overlap_thresh=0.3, topk=topk,
+                                    coord_start=2, score_index=1, id_index=0,
+                                    force_suppress=force)
+        expected = numpy_box_nms(data, 0.3, num_box if topk < 0 else topk, force)
+        assert_almost_equal(out.asnumpy(), expected)
+
+def test_box_detection_op():
+    # same as decoding all anchors with box_decode and applying box_nms to every anchor and class
+    num_batch, num_anchor, num_class = 2, 200, 4
+    cls_prob = mx.nd.random.uniform(shape=(num_batch, num_anchor, num_class))
+    loc_pred = mx.nd.random.normal(scale=0.5, shape=(num_batch, num_anchor, 4))
+    anchors = mx.nd.random.uniform(0.1, 0.5, shape=(1, num_anchor, 4))
+    stds = dict(std0=0.1, std1=0.1, std2=0.2, std3=0.2)
+    for nms_topk, keep_topk, force, background_id in [(-1, 50, False, 0), (300, 20, True, -1)]:
+        out = mx.nd.contrib.box_detection(cls_prob, loc_pred, anchors, overlap_thresh=0.45,
+                                          valid_thresh=0.3, nms_topk=nms_topk,
+                                          keep_topk=keep_topk, background_id=background_id,
+                                          force_suppress=force, clip=2.0, **stds)
+        assert out.shape == (num_batch, keep_topk, 6)
+        boxes = mx.nd.contrib.box_decode(loc_pred, anchors, clip=2.0, **stds)
+        ids = mx.nd.broadcast_to(mx.nd.arange(num_class).reshape((1, 1, num_class, 1)),
+                                 shape=(num_batch, num_anchor, num_class, 1))
+        scores = cls_prob.expand_dims(axis=3)
+        boxes = mx.nd.broadcast_to(boxes.expand_dims(axis=2),
+                                   shape=(num_batch, num_anchor, num_class, 4))
+        rows = mx.nd.concat(ids, scores, boxes, dim=3).reshape((num_batch, -1, 6))
+        expected = mx.nd.contrib.box_nms(rows, overlap_thresh=0.45, valid_thresh=0.3,
+                                         topk=nms_topk, id_index=0,
+                                         background_id=background_id, force_suppress=force)
+        assert_almost_equal(out, expected[:, :keep_topk])
+
 def test_box_iou_op():
     def numpy_box_iou(a, b, fmt='corner'):
         def area(left, top, right, bottom):
@@ -454,6 +516,83 @@ def test_dynamic_reshape():
     for test_case in test_cases:
         dynamic_reshape_testcases(*test_case)
 
+@pytest.mark.parametrize('bits,group_size', [(8, 0), (8, 16), (4, 16), (4, 0)])
+@pytest.mark.parametrize('batch', [1, 5, 40])
+def test_weight_only_fully_connected(bits, group_size, batch):
+    num_hidden, num_input = 12, 35 if bits == 8 else 34
+    weight = np.random.uniform(-1, 1, (num_hidden, num_input)).astype(np.float32)
+    data = mx.nd.random.uniform(-1, 1, (batch, num_input))
+    bias = mx.nd.random.uniform(-1, 1, (num_hidden,))
+    qweight, scale = mx.nd.contrib.weight_only_quantize(mx.nd.array(weight), bits=bits,
+                                                        group_size=group_size)
+    num_groups = 1 if group_size == 0 else -(-num_input // group_size)
+    assert qweight.dtype == np.int8 and scale.dtype == np.float32
+    assert scale.shape == (num_hidden, num_groups)
+
+    # numpy reference of the symmetric group-wise quantization
+    qmax = 7 if bits == 4 else 127
+    group = num_input if group_size == 0 else group_size
+    ref_scale = np.stack([np.abs(weight[:, g * group:(g + 1) * group]).max(axis=1) / qmax
+                          for g in range(num_groups)], axis=1)
+    assert_almost_equal(scale, ref_scale, rtol=1e-6, atol=1e-7)
+    full_scale = np.repeat(ref_scale, group, axis=1)[:, :num_input]
+    q = np.rint(weight / full_scale)
+    if bits == 4:
+        packed = qweight.asnumpy().view(np.uint8)
+        assert packed.shape == (num_hidden, num_input // 2)
+        unpacked = np.empty((num_hidden, num_input), dtype=np.int8)
+        unpacked[:, 0::2] = (packed & 0x0F).astype(np.int8)
+        unpacked[:, 1::2] = (packed >> 4).astype(np.int8)
+        unpacked[unpacked > 7] -= 16
+        assert_array_equal(unpacked, q)
+    else:
+        assert_array_equal(qweight.asnumpy(), q)
+
+    out = mx.nd.contrib.weight_only_fully_connected(data, qweight, scale, bias,
+                                                    num_hidden=num_hidden, bits=bits,
+                                                    group_size=group_size)
+    expected = data.asnumpy().dot((q * full_scale).T) + bias.asnumpy()
+    assert_almost_equal(out, expected, rtol=1e-4, atol=1e-4)
+
+
+@pytest.mark.parametrize('batch', [1, 5, 40])
+def test_sparse24_fully_connected(batch):
+    num_hidden, num_input = 12, 32
+    weight = np.random.uniform(-1, 1, (num_hidden, num_input)).astype(np.float32)
+    data = mx.nd.random.uniform(-1, 1, (batch, num_input))
+    bias = mx.nd.random.uniform(-1, 1, (num_hidden,))
+    values, meta = mx.nd.contrib.sparse24_compress(mx.nd.array(weight))
+    assert values.shape == (num_hidden, num_input // 2) and meta.dtype == np.uint8
+
+    # numpy reference of the pruning: the two largest magnitudes of each group of four
+    groups = weight.reshape(num_hidden, -1, 4)
+    kept = np.sort(np.argsort(-np.abs(groups), axis=2, kind='stable')[:, :, :2], axis=2)
+    assert_array_equal(meta.asnumpy(), kept[:, :, 0] | (kept[:, :, 1] << 2))
+    assert_array_equal(values.asnumpy().reshape(kept.shape),
+                       np.take_along_axis(groups, kept, axis=2))
+    pruned = np.zeros_like(groups)
+    np.put_along_axis(pruned, kept, np.take_along_axis(groups, kept, axis=2), axis=2)
+    pruned = pruned.reshape(num_hidden, num_input)
+
+    out = mx.nd.contrib.sparse24_fully_connected(data, values, meta, bias, num_hidden=num_hidden)
+    expected = data.asnumpy().dot(pruned.T) + bias.asnumpy()
+    assert_almost_equal(out, expected, rtol=1e-4, atol=1e-4)
+
+    # the Sparse24 backend of optimize_for compresses the weights which are 2:4 sparse
+    x = mx.sym.var('data')
+    sym = mx.sym.FullyConnected(x, num_hidden=num_hidden, name='fc')
+    args = {'fc_weight': mx.nd.array(weight), 'fc_bias': bias}
+    dense_sym = sym.optimize_for('Sparse24', args, {})
+    assert 'fc_weight' in dense_sym.list_arguments()
+    args['fc_weight'] = mx.nd.array(pruned)
+    sparse_sym = sym.optimize_for('Sparse24', args, {})
+    assert 'fc_weight' not in sparse_sym.list_arguments()
+    assert_array_equal(args['fc_weight_sparse24_meta'], meta)
+    args['data'] = data
+    out = sparse_sym._bind(mx.cpu(), args=args).forward()[0]
+    assert_almost_equal(out, expected, rtol=1e-4, atol=1e-4)
+
+
 if __name__ == '__main__':
     import nose
     nose.runmodule()
@@ -234,3 +234,49 @@ def test_adamw():
 @pytest.mark.serial
 def test_adabelief():
     _AdaBeliefTestHelper()()
+
+@pytest.mark.parametrize('helper', [_AdamWTestHelper, _AdaBeliefTestHelper])
+def test_multi_adam_like_global_norm_and_skip(helper):
+    shapes = [(3, 4), (7,), (2, 5, 3)]
+    beta1, beta2, epsilon, lr, eta, wd = 0.9, 0.99, 1e-6, 0.01, 0.5, 0.1
+    weight = [mx.nd.random.uniform(shape=s) for s in shapes]
+    grad = [mx.nd.random.uniform(-10, 10, shape=s) for s in shapes]
+    m = [mx.nd.random.uniform(shape=s) for s in shapes]
+    v = [mx.nd.random.uniform(shape=s) for s in shapes]
+    rescale_grad = mx.nd.array([0.5])
+    kwargs = {'lrs': [lr] * len(shapes), 'wds': [wd] * len(shapes), 'etas': [eta] * len(shapes),
+              'beta1': beta1, 'beta2': beta2, 'epsilon': epsilon}
+
+    # the update of every weight is skipped if one gradient is not finite
+    bad_grad = [g.copy() for g in grad]
+    bad_grad[1][3] = np.nan
+    weight_test = [w.copy() for w in weight]
+    m_test, v_test = [x.copy() for x in m], [x.copy() for x in v]
+    helper.fn_multi_update(weight_test, bad_grad, m_test, v_test, rescale_grad,
+                           out=weight_test, skip_nonfinite=True, **kwargs)
+    for i in range(len(shapes)):
+        assert_almost_equal(weight[i], weight_test[i])
+        assert_almost_equal(m[i], m_test[i])
+
+    # the rescaled gradients are scaled down to the global norm max_grad_norm
+    max_grad_norm = 1.0
+    weight32 = [w.copy() for w in weight]
+    weight_fp16 = [w.astype('float16') for w in weight]
+    grad_fp16 = [g.astype('float16') for g in grad]
+    norm = 0.5 * np.sqrt(sum((g.asnumpy().astype(np.float64) ** 2).sum() for g in grad_fp16))
+    factor = 0.5 * min(1.0, max_grad_norm / norm)
+    m_refs, v_refs, weight_refs = [], [], []
+    for i in range(len(shapes)):
+        m_ref, v_ref, weight_ref = helper.ref_impl(
+            m[i], v[i], weight[i], factor * grad_fp16[i].astype('float32'),
+            beta1, beta2, lr, eta, wd, epsilon)
+        m_refs.append(m_ref)
+        v_refs.append(v_ref)
+        weight_refs.append(weight_ref)
+    helper.fn_multi_mp_update(weight_fp16, grad_fp16, m, v, weight32, rescale_grad,
+                              out=weight_fp16, max_grad_norm=max_grad_norm, **kwargs)
+    for i in range(len(shapes)):
+        assert_almost_equal(m_refs[i], m[i], rtol=1e-3, atol=1e-4)
+        assert_almost_equal(v_refs[i], v[i], rtol=1e-3, atol=1e-4)
+        assert_almost_equal(weight_refs[i], weight32[i], rtol=1e-3, atol=1e-4)
+        assert_almost_equal(weight_refs[i].astype('float16'), weight_fp16[i], rtol=1e-2, atol=1e-3)
@@ -18,6 +18,7 @@
 import mxnet as mx
 import os
 from mxnet.test_utils import environment
+from common import run_in_spawned_process
 import pytest
 
 def test_bulk():
@@ -32,6 +33,72 @@ def test_bulk():
             x += 1
     assert (x.asnumpy() == 104).all()
 
+def test_engine_stats():
+    # operators still running from the previous tests would be counted after the reset
+    mx.nd.waitall()
+    mx.engine.get_stats(reset=True)
+    x = mx.nd.ones((10,))
+    for _ in range(10):
+        x += 1
+    x.wait_to_read()
+    stats = mx.engine.get_stats()
+    if not stats['enabled'] or os.environ.get('MXNET_ENGINE_TYPE') == 'NaiveEngine':
+        return
+    assert stats['pushed'] >= 10
+    assert stats['wait_to_run_us']['count'] >= 10
+    assert sum(stats['wait_to_run_us']['buckets']) == stats['wait_to_run_us']['count']
+    assert stats['dependency_fanout']['count'] >= 10
+    with mx.engine.bulk(5):
+        for _ in range(10):
+            x += 1
+    mx.nd.waitall()
+    stats = mx.engine.get_stats(reset=True)
+    assert stats['bulk_segment_size']['count'] >= 1
+    assert stats['bulk_segment_size']['max'] <= 5
+    assert mx.engine.get_stats()['pushed'] == 0
+
+def _adaptive_bulk_segments(seed, size, max_segment):
+    if not mx.engine.get_stats()['enabled']:
+        return
+    x = mx.nd.ones((size, size))
+    with mx.engine.bulk(5):
+        # the first segments measure the op time, the later ones are sized from it
+        for _ in range(10):
+            x = mx.nd.dot(x, x) / size
+        mx.nd.waitall()
+        mx.engine.get_stats(reset=True)
+        for _ in range(200):
+            x = mx.nd.dot(x, x) / size
+    mx.nd.waitall()
+    stats = mx.engine.get_stats()
+    assert stats['bulk_segment_size']['count'] >= 1
+    assert stats['bulk_segment_size']['max'] == max_segment
+
+@pytest.mark.serial
+def test_engine_adaptive_bulk():
+    if os.environ.get('MXNET_ENGINE_TYPE') == 'NaiveEngine':
+        return
+    # cheap ops and a long target: segments grow to MXNET_ENGINE_BULK_MAX_NODE
+    run_in_spawned_process(_adaptive_bulk_segments,
+                           {'MXNET_ENGINE_BULK_TARGET_US': '1000000000',
+                            'MXNET_ENGINE_BULK_MAX_NODE': '40'}, 2, 40)
+    # ops longer than the target: segments shrink to a single op
+    run_in_spawned_process(_adaptive_bulk_segments,
+                           {'MXNET_ENGINE_BULK_TARGET_US': '1'}, 256, 1)
+
+def test_engine_stats_temp_space():
+    mx.nd.waitall()
+    stats = mx.engine.get_stats(reset=True)
+    if not stats['enabled'] or os.environ.get('MXNET_TEMP_SPACE_DYNAMIC', '0') == '0':
+        return
+    x = mx.nd.ones((64, 64))
+    for _ in range(10):
+        y = mx.nd.dot(x, x).sort(axis=1)
+    y.wait_to_read()
+    stats = mx.engine.get_stats()
+    assert stats['temp_space_requests'] >= 10
+    assert stats['temp_space_contended'] <= stats['temp_space_requests']
+
 @pytest.mark.skip(reason="OMP platform dependent")
 def test_engine_openmp_after_fork():
     """
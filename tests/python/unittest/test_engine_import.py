@@ -29,7 +29,8 @@ except NameError:  # Python 3
 def test_engine_import():
     import mxnet
     # Temporarily add an illegal entry (that is not caught) to show how the test needs improving
-    engine_types = [None, 'NaiveEngine', 'ThreadedEngine', 'ThreadedEnginePerDevice', 'BogusEngine']
+    engine_types = [None, 'NaiveEngine', 'ThreadedEngine', 'ThreadedEnginePerDevice',
+                    'ThreadedEngineWorkStealing', 'BogusEngine']
 
     for type in engine_types:
         with environment('MXNET_ENGINE_TYPE', type):
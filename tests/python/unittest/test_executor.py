@@ -16,6 +16,7 @@
 # under the License.
 
 import numpy as np
+import pytest
 import mxnet as mx
 from mxnet.test_utils import assert_almost_equal, environment
 
@@ -160,6 +161,20 @@ def test_cached_op_init():
     check_init(True, False)
     check_init(True, True)
 
+@pytest.mark.parametrize('cache_size', [1, 2])
+def test_cached_op_static_shape_cache(cache_size):
+    data = mx.sym.var('data')
+    out = mx.sym.sum(data * 2, axis=1)
+    flags = [('static_alloc', True), ('static_shape', True),
+             ('static_shape_cache_size', cache_size)]
+    op = mx.ndarray.CachedOp(out, flags)
+    # alternate between batch sizes, as when serving buckets of requests
+    for batch_size in [2, 3, 2, 3, 5, 2]:
+        x = mx.nd.ones((batch_size, 4))
+        y = op(x, default_device=mx.cpu())
+        assert y.shape == (batch_size,)
+        assert np.all(y.asnumpy() == 8)
+
 def test_elemwise_add_grad():
     json = "{\"nodes\": [{\"op\":\"null\",\"name\":\".Inputs.Input1\",\"inputs\":[]},{\"op\":\"null\",\"name\":\".Inputs.Input2\",\"inputs\":[]},{\"op\":\"elemwise_add\",\"name\":\".$0\",\"inputs\":[[0,0,0],[1,0,0]]},{\"op\":\"_copy\",\"name\":\".Outputs.Output\",\"inputs\":[[2,0,0]]}],\"arg_nodes\":[0,1],\"heads\":[[3,0,0]]}"
     sym = mx.symbol.fromjson(json)
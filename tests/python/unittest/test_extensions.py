@@ -96,6 +96,20 @@ def test_custom_op():
     assert_almost_equal(in_grad_base[0].asnumpy(), in_grad1[0].asnumpy(), rtol=1e-3, atol=1e-3)
     assert_almost_equal(in_grad_base[0].asnumpy(), in_grad2[0].asnumpy(), rtol=1e-3, atol=1e-3)
 
+    # test the fast compute path of a stateful operator, its Forward/Backward fail on dense inputs
+    e = mx.sym.fast_gemm(s,t,alpha=2.5)
+    in_grad3 = [mx.nd.empty((dim_n,dim_k),ctx=mx.cpu()),mx.nd.empty((dim_k,dim_m),ctx=mx.cpu())]
+    exe3 = e._bind(ctx=mx.cpu(),args={'s':mat1,'t':mat2},args_grad=in_grad3)
+    out3 = exe3.forward()
+    out3 = exe3.forward()
+    assert_almost_equal(2.5 * out_base[0].asnumpy(), out3[0].asnumpy(), rtol=1e-3, atol=1e-3)
+    exe3.backward([out_grad])
+    for grad, grad_base in zip(in_grad3, in_grad_base):
+        assert_almost_equal(2.5 * grad_base.asnumpy(), grad.asnumpy(), rtol=1e-3, atol=1e-3)
+
+    out4 = mx.nd.fast_gemm(mat1, mat2, alpha=2.5)
+    assert_almost_equal(2.5 * out_base[0].asnumpy(), out4.asnumpy(), rtol=1e-3, atol=1e-3)
+
 @pytest.mark.skipif(check_platform(), reason="not all machine types supported")
 @pytest.mark.skipif(is_cd_run(), reason="continuous delivery run - ignoring test")
 def test_subgraph():
@@ -0,0 +1,137 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+import mxnet as mx
+import numpy as np
+import pytest
+from mxnet.test_utils import environment, rand_shape_2d
+
+
+def check_fused_symbol(sym, dtypes=('float16', 'float32', 'float64'), **kwargs):
+    inputs = sym.list_inputs()
+    shapes = {inp : kwargs[inp].shape for inp in inputs}
+    ctx = mx.cpu()
+    # Double identity so that there is always something to fuse
+    test_sym = mx.sym.Group([mx.sym.identity(mx.sym.identity(s)) for s in sym])
+    rtol = {'float16' : 1e-2,
+            'float32' : 1.5e-6,
+            'float64' : 1.5e-6,
+            'int32' : 0,
+            }
+    atol = {'float16' : 1e-3,
+            'float32' : 1e-7,
+            'float64' : 1e-7,
+            'int32' : 0,
+            }
+    for dtype in dtypes:
+        data = {inp : kwargs[inp].astype(dtype) for inp in inputs}
+        # the integer inputs have no gradient
+        grad_reqs = ['null'] if dtype.startswith('int') else ['write', 'add']
+        for grad_req in grad_reqs:
+            type_dict = {inp : dtype for inp in inputs}
+            with environment('MXNET_USE_FUSION', '0'):
+                orig_exec = test_sym._simple_bind(ctx=ctx, grad_req=grad_req, type_dict=type_dict, **shapes)
+            with environment('MXNET_USE_FUSION', '1'):
+                fused_exec = test_sym._simple_bind(ctx=ctx, grad_req=grad_req, type_dict=type_dict, **shapes)
+            fwd_orig = orig_exec.forward(is_train=True, **data)
+            fwd_fused = fused_exec.forward(is_train=True, **data)
+            for orig, fused in zip(fwd_orig, fwd_fused):
+                np.testing.assert_allclose(orig.asnumpy(), fused.asnumpy(), rtol=rtol[dtype], atol=atol[dtype])
+            if grad_req == 'null':
+                continue
+            out_grads = [mx.nd.ones_like(arr) for arr in fwd_orig]
+            orig_exec.backward(out_grads=out_grads)
+            fused_exec.backward(out_grads=out_grads)
+            for orig, fused in zip(orig_exec.grad_arrays, fused_exec.grad_arrays):
+                if orig is None and fused is None:
+                    continue
+                assert orig is not None
+                assert fused is not None
+                np.testing.assert_allclose(orig.asnumpy(), fused.asnumpy(), rtol=rtol[dtype], atol=atol[dtype])
+
+
+@pytest.mark.parametrize('op_name', [
+    'relu', 'sigmoid', 'softsign', 'exp', 'expm1', 'log', 'log10', 'log2', 'log1p',
+    'degrees', 'radians', 'sin', 'cos', 'tan', 'arcsin', 'arccos', 'arctan', 'sinh',
+    'cosh', 'tanh', 'arcsinh', 'arctanh', 'sqrt', 'rsqrt', 'cbrt', 'rcbrt', 'square',
+    'squeeze', 'flatten', 'round', 'rint', 'fix', 'floor', 'ceil', 'trunc', 'sign',
+    'reciprocal', 'abs', 'gamma', 'gammaln', 'erf', 'negative'])
+def test_fusion_unary_ops(op_name):
+    a = mx.sym.Variable('a')
+    arr = mx.random.uniform(shape=rand_shape_2d())
+    check_fused_symbol(getattr(mx.sym, op_name)(a), a=arr)
+
+
+def test_fusion_unary_ops_with_attrs():
+    a = mx.sym.Variable('a')
+    arr = mx.random.uniform(shape=rand_shape_2d())
+    for act_type in ['relu', 'sigmoid', 'tanh', 'softrelu', 'softsign']:
+        check_fused_symbol(mx.sym.Activation(a, act_type=act_type), a=arr)
+    check_fused_symbol(mx.sym.Activation(a, act_type='softrelu'), a=1000 * arr)
+    for dtype in ['float16', 'float32', 'float64', 'int32']:
+        check_fused_symbol(mx.sym.Cast(a * 10, dtype=dtype), a=arr)
+    check_fused_symbol(mx.sym.reshape(a, shape=(-1,)), a=arr)
+    check_fused_symbol(mx.sym.expand_dims(a, axis=1), a=arr)
+    check_fused_symbol(mx.sym.clip(a, a_min=0.3, a_max=0.7), a=arr)
+    check_fused_symbol(mx.sym.clip(a, a_min=-np.inf, a_max=0.7), a=arr)
+
+
+def test_fusion_binary_ops():
+    a = mx.sym.Variable('a')
+    b = mx.sym.Variable('b')
+    shape = rand_shape_2d()
+    arr1 = mx.random.uniform(shape=shape)
+    arr2 = mx.random.uniform(shape=shape)
+
+    check_fused_symbol(a+b, a=arr1, b=arr2)
+    check_fused_symbol(a+3, a=arr1)
+    check_fused_symbol(a-b, a=arr1, b=arr2)
+    check_fused_symbol(a-3, a=arr1)
+    check_fused_symbol(3-a, a=arr1)
+    check_fused_symbol(a*b, a=arr1, b=arr2)
+    check_fused_symbol(a*3, a=arr1)
+    check_fused_symbol(a/(b+1), a=arr1, b=arr2)
+    check_fused_symbol(a/3, a=arr1)
+    check_fused_symbol(3/a, a=arr1)
+    check_fused_symbol(a**b, a=arr1, b=arr2)
+    check_fused_symbol(a**3, a=arr1)
+    check_fused_symbol(mx.sym.pow(3,a), a=arr1)
+    check_fused_symbol(mx.sym.maximum(a,b), a=arr1, b=arr2)
+    check_fused_symbol(mx.sym.minimum(a,b), a=arr1, b=arr2)
+
+
+def test_fusion_integer_chain():
+    # the intermediate values are rounded to the type of each op
+    a = mx.sym.Variable('a')
+    b = mx.sym.Variable('b')
+    shape = rand_shape_2d()
+    arr1 = mx.nd.random.randint(1, 100, shape=shape).astype('float32')
+    arr2 = mx.nd.random.randint(1, 10, shape=shape).astype('float32')
+    sym = ((a / b) * b + a % b) - 7
+    check_fused_symbol(sym, dtypes=('int32', 'float32'), a=arr1, b=arr2)
+
+
+def test_fusion_long_chain():
+    a = mx.sym.Variable('a')
+    b = mx.sym.Variable('b')
+    # more elements than one chunk of the evaluation
+    shape = (37, 1001)
+    arr1 = mx.random.uniform(shape=shape)
+    arr2 = mx.random.uniform(shape=shape)
+    sym = mx.sym.tanh(mx.sym.exp(a * 0.5 + b) - mx.sym.sqrt(b)) * mx.sym.sigmoid(a) + 1
+    check_fused_symbol(sym, a=arr1, b=arr2)
+
@@ -246,6 +246,90 @@ def test_sparse_hybrid_block():
         y = net(x)
 
 
+def test_pipeline():
+    from mxnet.gluon.contrib.pipeline import Pipeline, split_stages
+    data = mx.sym.var('data')
+    with mx.AttrScope(ctx_group='first'):
+        fc1 = mx.sym.FullyConnected(data, num_hidden=6, name='fc1')
+        act = mx.sym.Activation(fc1, act_type='tanh')
+    with mx.AttrScope(ctx_group='second'):
+        fc2 = mx.sym.FullyConnected(act, num_hidden=3, name='fc2')
+    # without ctx_group, in the stage of its input
+    loss = mx.sym.sum(mx.sym.square(fc2), axis=1)
+    stages = split_stages(loss, ['data'], ['first', 'second'])
+    assert len(stages) == 2
+    assert stages[0][2] == [(None, 'data')]
+    assert stages[1][2] == [(0, 0)]
+    with pytest.raises(ValueError):
+        split_stages(loss, ['data'], ['second', 'first'])
+
+    pipeline = Pipeline(loss, ['data'], {'first': mx.cpu(0), 'second': mx.cpu(1)}, 4)
+    pipeline.initialize()
+    ref = gluon.SymbolBlock(loss, [data])
+    ref.initialize()
+    for stage in pipeline.stages:
+        for name, param in stage.collect_params().items():
+            ref.collect_params()[name].set_data(param.data().copyto(mx.cpu()))
+
+    x = mx.nd.random.uniform(shape=(8, 5))
+    out = pipeline.forward_backward(x)
+    with mx.autograd.record():
+        ref_out = ref(x)
+    ref_out.backward()
+    assert_almost_equal(out, ref_out, rtol=1e-5, atol=1e-6)
+    for stage in pipeline.stages:
+        for name, param in stage.collect_params().items():
+            assert_almost_equal(param.grad(), ref.collect_params()[name].grad(),
+                                rtol=1e-5, atol=1e-6)
+    assert_almost_equal(pipeline(x), ref_out, rtol=1e-5, atol=1e-6)
+    with pytest.raises(ValueError):
+        pipeline(mx.nd.ones((6, 5)))
+
+
+@use_np
+def test_tensor_parallel():
+    from mxnet.gluon.contrib import tensor_parallel
+    devices = [mx.cpu(0), mx.cpu(1)]
+    column = tensor_parallel.ColumnParallelDense(5, 4, devices, gather_output=False)
+    row = tensor_parallel.RowParallelDense(3, 5, devices)
+    embedding = tensor_parallel.ParallelEmbedding(7, 4, devices)
+    for block in [column, row, embedding]:
+        block.initialize(init='normal')
+    ref_column = nn.Dense(5, in_units=4)
+    ref_row = nn.Dense(3, in_units=5)
+    ref_embedding = nn.Embedding(7, 4)
+    for block in [ref_column, ref_row, ref_embedding]:
+        block.initialize()
+    def cat(arrays, axis=0):
+        return mx.np.concatenate([x.to_device(mx.cpu()) for x in arrays], axis=axis)
+    ref_column.weight.set_data(cat([p.data() for p in column.weight]))
+    ref_column.bias.set_data(cat([p.data() for p in column.bias]))
+    ref_row.weight.set_data(cat([p.data() for p in row.weight], 1))
+    ref_row.bias.set_data(row.bias.data())
+    ref_embedding.weight.set_data(cat([p.data() for p in embedding.weight]))
+    assert [w.shape for w in column.weight] == [(3, 4), (2, 4)]
+    assert [w.data().device for w in column.weight] == devices
+
+    tokens = mx.np.array([[0, 3], [4, 6]])
+    with mx.autograd.record():
+        out = row(column(embedding(tokens).reshape(2, -1)[:, :4]))
+        out.sum().backward()
+    with mx.autograd.record():
+        ref_out = ref_row(ref_column(ref_embedding(tokens).reshape(2, -1)[:, :4]))
+        ref_out.sum().backward()
+    assert_almost_equal(out, ref_out, rtol=1e-5, atol=1e-6)
+    assert_almost_equal(cat([p.grad() for p in column.weight]), ref_column.weight.grad(),
+                        rtol=1e-5, atol=1e-6)
+    assert_almost_equal(cat([p.grad() for p in row.weight], 1), ref_row.weight.grad(),
+                        rtol=1e-5, atol=1e-6)
+    assert_almost_equal(cat([p.grad() for p in embedding.weight]), ref_embedding.weight.grad(),
+                        rtol=1e-5, atol=1e-6)
+
+    with pytest.raises(ValueError):
+        tensor_parallel.ParallelEmbedding(1, 4, devices)
+    with pytest.raises(ValueError):
+        tensor_parallel.ColumnParallelDense(1, 4, devices)
+
 @use_np
 def test_hybrid_block_none_args():
     class Foo(gluon.HybridBlock):
@@ -1051,6 +1135,27 @@ def test_import():
     assert lines[2] == ')'
 
 
+@use_np
+def test_import_compiled(tmpdir):
+    tmpfile = os.path.join(str(tmpdir), 'net')
+    device = mx.device.current_device()
+    net1 = gluon.model_zoo.vision.resnet18_v1(device=device, pretrained=False)
+    net1.initialize()
+    net1.hybridize(static_alloc=True)
+    data = mx.np.random.normal(size=(2, 3, 32, 32))
+    out1 = net1(data)
+
+    net1.export(tmpfile, compiled=True)
+    with open(tmpfile + '-compiled.json') as f:
+        manifest = json.load(f)
+    assert manifest['inputs'] == [{'name': 'data', 'shape': [2, 3, 32, 32], 'dtype': 'float32'}]
+    assert manifest['flags']['static_alloc']
+
+    net2 = gluon.SymbolBlock.imports_compiled(tmpfile, device)
+    out2 = net2(data)
+    assert_almost_equal(out1.asnumpy(), out2.asnumpy())
+
+
 def test_hybrid_stale_cache():
     net = mx.gluon.nn.HybridSequential()
     net.add(mx.gluon.nn.Dense(10, weight_initializer='zeros', bias_initializer='ones', flatten=False))
@@ -1337,6 +1442,41 @@ def test_req():
     assert_almost_equal(grad * 2, grad_double)
 
 
+@use_np
+@pytest.mark.parametrize('static_shape', [False, True])
+def test_req_add_shared_weight(static_shape):
+    class Shared(gluon.HybridBlock):
+        def __init__(self):
+            super(Shared, self).__init__()
+            self.dense = nn.Dense(8, in_units=8)
+
+        def forward(self, x):
+            # the gradients of the weight are summed over its uses
+            return self.dense(self.dense(self.dense(x)))
+
+    x = mx.np.random.uniform(size=(4, 8))
+
+    def grads(net, req, repeat):
+        for v in net.collect_params().values():
+            v.grad_req = req
+        net.zero_grad()
+        for _ in range(repeat):
+            with mx.autograd.record():
+                y = net(x)
+            y.backward()
+        return [v.grad().asnumpy() for v in net.collect_params().values()]
+
+    net = Shared()
+    net.initialize()
+    expected = grads(net, 'write', 1)
+    net.hybridize(static_alloc=True, static_shape=static_shape)
+    for e, g in zip(expected, grads(net, 'add', 3)):
+        assert_almost_equal(e * 3, g, rtol=1e-4, atol=1e-5)
+    # switching back to write replaces the accumulation
+    for e, g in zip(expected, grads(net, 'write', 2)):
+        assert_almost_equal(e, g, rtol=1e-4, atol=1e-5)
+
+
 @use_np
 def test_save_load(tmpdir):
     net = mx.gluon.model_zoo.vision.get_resnet(1, 18, pretrained=False, root=str(tmpdir))
@@ -1499,6 +1639,102 @@ def test_hybrid_static_memory(static_alloc, static_shape):
         assert_almost_equal(grads1[key].asnumpy(), grads2[key].asnumpy(), rtol=1e-3, atol=1e-4)
 
 
+@pytest.mark.parametrize('static_shape', [False, True])
+@with_environment('NNVM_EXEC_LIFETIME_PLAN', '1')
+def test_hybrid_static_memory_lifetime_plan(static_shape):
+    x = mx.np.random.uniform(size=(2, 3, 32, 32))
+    x.attach_grad()
+    net = gluon.model_zoo.vision.get_resnet(
+        1, 18, pretrained=False, device=mx.device.current_device())
+    net.initialize()
+
+    def test(net, x):
+        with mx.autograd.record():
+            y = net(x)
+            y.backward()
+        grads = {k: v.grad().copy() for k, v in net.collect_params().items()
+                 if v.grad_req != 'null'}
+        return y, grads
+
+    y1, grads1 = test(net, x)
+    net.hybridize(static_alloc=True, static_shape=static_shape)
+    y2, grads2 = test(net, x)
+
+    assert_almost_equal(y1.asnumpy(), y2.asnumpy(), rtol=1e-3, atol=1e-5)
+    for key in grads1:
+        assert_almost_equal(grads1[key].asnumpy(), grads2[key].asnumpy(), rtol=1e-3, atol=1e-4)
+
+
+@with_environment('MXNET_CACHEDOP_MEMORY_ORDER', '1')
+def test_hybrid_static_shape_memory_order():
+    class Branches(gluon.HybridBlock):
+        def forward(self, x):
+            # the large intermediate outputs of each branch are best released
+            # before the next branch starts
+            outs = []
+            for i in range(4):
+                y = mx.np.tile(x, (1, 8)) * (i + 1)
+                outs.append(mx.np.sum(mx.np.exp(y), axis=1))
+            return mx.np.stack(outs) + x.sum()
+
+    x = mx.np.random.uniform(size=(16, 64))
+    x.attach_grad()
+    net = Branches()
+
+    def test(net, x):
+        with mx.autograd.record():
+            y = net(x)
+            y.backward()
+        return y, x.grad.copy()
+
+    x2 = mx.np.random.uniform(size=(8, 64))
+    x2.attach_grad()
+    y1, grad1 = test(net, x)
+    y1_2, grad1_2 = test(net, x2)
+    # the memory order is only planned for the states of static shapes
+    net.hybridize(static_alloc=True, static_shape=True)
+    y2, grad2 = test(net, x)
+    # another state is reordered from the same graph, which must not carry the order of the first
+    y2_2, grad2_2 = test(net, x2)
+    # the state planned for the shape of x is reused
+    y3, grad3 = test(net, x)
+
+    for y, grad in [(y2, grad2), (y3, grad3)]:
+        assert_almost_equal(y1.asnumpy(), y.asnumpy(), rtol=1e-5, atol=1e-5)
+        assert_almost_equal(grad1.asnumpy(), grad.asnumpy(), rtol=1e-5, atol=1e-5)
+    assert_almost_equal(y1_2.asnumpy(), y2_2.asnumpy(), rtol=1e-5, atol=1e-5)
+    assert_almost_equal(grad1_2.asnumpy(), grad2_2.asnumpy(), rtol=1e-5, atol=1e-5)
+
+
+@pytest.mark.parametrize('static_alloc', [False, True])
+@pytest.mark.parametrize('recompute_segment_size', [None, 1, 4])
+def test_hybrid_backward_recompute(static_alloc, recompute_segment_size):
+    x = mx.np.random.uniform(size=(2, 3, 32, 32))
+    net = gluon.model_zoo.vision.get_resnet(
+        1, 18, pretrained=False, device=mx.device.current_device())
+    net.initialize()
+    net(x)
+
+    def test(net, x):
+        with mx.autograd.record():
+            y = net(x)
+            y.backward()
+        grads = {k: v.grad().copy() for k, v in net.collect_params().items()
+                 if v.grad_req != 'null'}
+        return y, grads
+
+    net.hybridize(static_alloc=static_alloc)
+    y1, grads1 = test(net, x)
+    # the batch norms mutate their running statistics, they are never recomputed
+    net.hybridize(static_alloc=static_alloc, backward_recompute=True,
+                  recompute_segment_size=recompute_segment_size)
+    y2, grads2 = test(net, x)
+
+    assert_almost_equal(y1.asnumpy(), y2.asnumpy(), rtol=1e-3, atol=1e-5)
+    for key in grads1:
+        assert_almost_equal(grads1[key].asnumpy(), grads2[key].asnumpy(), rtol=1e-3, atol=1e-4)
+
+
 @pytest.mark.parametrize('static_alloc', [False, True])
 @pytest.mark.parametrize('static_shape', [False, True])
 def test_hybrid_static_memory_switching(static_alloc, static_shape):
@@ -1521,6 +1757,59 @@ def test_hybrid_static_memory_switching(static_alloc, static_shape):
         y.backward()
     mx.npx.waitall()
 
+
+def test_hybrid_auto_hybridize():
+    class Net(gluon.HybridBlock):
+        def __init__(self):
+            super(Net, self).__init__()
+            self.dense0 = nn.Dense(8, in_units=4)
+            self.dense1 = nn.Dense(2, in_units=8)
+
+        def forward(self, x):
+            return self.dense1(mx.npx.relu(self.dense0(x)) * 2 + 1)
+
+    class Branching(gluon.HybridBlock):
+        def __init__(self):
+            super(Branching, self).__init__()
+            self.double = True
+
+        def forward(self, x):
+            return x * 2 if self.double else x + 1
+
+    def run(net, x):
+        x.attach_grad()
+        with mx.autograd.record():
+            y = net(x)
+        y.backward()
+        return y.asnumpy(), x.grad.asnumpy()
+
+    ref = Net()
+    ref.initialize()
+    with environment('MXNET_GLUON_AUTO_HYBRIDIZE', '2'):
+        net = Net()
+        branching = Branching()
+    net.initialize()
+    for name, param in net.collect_params().items():
+        param.set_data(ref.collect_params()[name].data())
+
+    for shape in [(3, 4), (3, 4), (3, 4), (5, 4), (5, 4), (5, 4)]:
+        x = mx.np.random.uniform(size=shape)
+        y, grad = run(net, x.copy())
+        y_ref, grad_ref = run(ref, x.copy())
+        assert_almost_equal(y, y_ref, rtol=1e-5, atol=1e-6)
+        assert_almost_equal(grad, grad_ref, rtol=1e-5, atol=1e-6)
+    # both shapes share the CachedOp of the graph
+    assert len(net._auto_signatures) == 2
+    assert len(net._auto_graphs) == 1
+    assert list(net._auto_graphs.values())[0]['_cached_op'] is not None
+
+    # the traces differ, the block stays eager
+    x = mx.np.full((2, 2), 3)
+    for double in [True, False, True, True, False, False]:
+        branching.double = double
+        assert_almost_equal(branching(x).asnumpy(), onp.full((2, 2), 6 if double else 4))
+    assert len(branching._auto_graphs) == 0
+
 def test_hook():
     global hook_call_count
     hook_call_count = 0
@@ -120,6 +120,65 @@ def test_recordimage_dataset_with_data_loader_multiworker(prepare_record):
         assert x.shape[0] == 1 and x.shape[3] == 3
         assert y.asscalar() == i
 
+def test_record_file_dataset_handle_mmap(tmpdir):
+    idx_file = str(tmpdir.join('test.idx'))
+    rec_file = str(tmpdir.join('test.rec'))
+    # records embedding the RecordIO magic number are written in several parts
+    magic = b'\x0a\x23\xd7\xce'
+    items = [b'a', b'abcde', magic, b'xy' + magic + b'z' + magic, os.urandom(1000)]
+    record = mx.recordio.MXIndexedRecordIO(idx_file, rec_file, 'w')
+    for i, item in enumerate(items):
+        record.write_idx(i, item)
+    record.close()
+
+    from mxnet.gluon.data._internal import RecordFileDataset
+    for use_mmap in [True, False]:
+        dataset = RecordFileDataset(rec_file=rec_file, idx_file=idx_file, use_mmap=use_mmap)
+        assert len(dataset) == len(items)
+        for i, item in enumerate(items):
+            data = dataset[i]
+            data = data.asnumpy() if isinstance(data, mx.nd.NDArray) else data
+            assert data.tobytes() == item
+
+def test_streaming_record_file_dataset(tmpdir):
+    rec_files, idx_files, items = [], [], []
+    for shard in range(3):
+        idx_file = str(tmpdir.join('shard{}.idx'.format(shard)))
+        rec_file = str(tmpdir.join('shard{}.rec'.format(shard)))
+        record = mx.recordio.MXIndexedRecordIO(idx_file, rec_file, 'w')
+        for i in range(20):
+            item = 'shard{}-{}'.format(shard, i).encode()
+            record.write_idx(i, item)
+            items.append(item)
+        record.close()
+        rec_files.append(rec_file)
+        idx_files.append(idx_file)
+
+    from mxnet.gluon.data._internal import StreamingRecordFileDataset
+    def read_epoch(dataset):
+        return [dataset[i].asnumpy().tobytes() for i in range(len(dataset))]
+
+    dataset = StreamingRecordFileDataset(rec_files=';'.join(rec_files),
+                                         idx_files=';'.join(idx_files), num_readers=1)
+    assert len(dataset) == len(items)
+    assert read_epoch(dataset) == items
+    assert read_epoch(dataset) == items
+
+    dataset = StreamingRecordFileDataset(rec_files=';'.join(rec_files),
+                                         idx_files=';'.join(idx_files), num_readers=2,
+                                         read_ahead=4, shuffle_window=8)
+    for _ in range(2):
+        assert sorted(read_epoch(dataset)) == sorted(items)
+
+    dataset = StreamingRecordFileDataset(rec_files=';'.join(rec_files),
+                                         idx_files=';'.join(idx_files), num_readers=1,
+                                         prefetch_window=4)
+    assert dataset[3].asnumpy().tobytes() == items[3]
+    with pytest.raises(mx.MXNetError):
+        dataset[4]
+    rest = [dataset[i].asnumpy().tobytes() for i in range(len(dataset)) if i != 3]
+    assert rest == items[:3] + items[4:]
+
 def test_sampler():
     seq_sampler = gluon.data.SequentialSampler(10)
     assert list(seq_sampler) == list(range(10))
@@ -553,6 +612,34 @@ def test_mx_data_loader_nopython():
     for _ in dl1:
         pass
 
+def test_mx_data_loader_nopython_epochs():
+    from mxnet.gluon.data.dataloader import DataLoader
+    data = np.arange(103).astype('float32')
+    dataset = gluon.data.SimpleDataset(data)
+    dl = DataLoader(dataset, batch_size=7, num_workers=4, try_nopython=True, shuffle=False)
+    for _ in range(3):
+        out = np.concatenate([x.asnumpy().reshape(-1) for x in dl])
+        assert mx.test_utils.almost_equal(out, data)
+    # reset in the middle of an epoch, with batches still being loaded ahead
+    it = dl._mx_iter._iter
+    for _ in range(3):
+        for _ in range(3):
+            assert it.iter_next()
+        it.reset()
+        assert it.iter_next()
+        first = it.getitems()[0]
+        assert mx.test_utils.almost_equal(first.asnumpy().reshape(-1), data[:7])
+        it.reset()
+
+def test_mx_data_loader_nopython_release():
+    from mxnet.gluon.data.dataloader import DataLoader
+    dataset = gluon.data.SimpleDataset(np.arange(64).astype('float32'))
+    # the loader threads are joined when the loaders are released
+    for _ in range(20):
+        dl = DataLoader(dataset, batch_size=4, num_workers=2, try_nopython=True)
+        next(iter(dl))
+        del dl
+
 def test_batchify_stack():
     a = np.array([[1, 2, 3, 4], [5, 6, 7, 8]])
     b = np.array([[5, 6, 7, 8], [1, 2, 3, 4]])
@@ -579,6 +666,32 @@ def test_batchify_pad():
                          [[ 9., 10., -1., -1.], [-1., -1., -1., -1.]]])
     assert mx.test_utils.almost_equal(d.asnumpy(), expected)
 
+def test_batchify_pad_nd():
+    shapes = [(3, 2, 5), (1, 2, 2), (4, 1, 3), (2, 2, 5)]
+    arrs = [np.random.uniform(size=shape).astype('float32') for shape in shapes]
+    for round_to in [None, 4]:
+        bf = mx.gluon.data.batchify.Pad(val=-1, round_to=round_to)
+        d = bf(arrs)
+        e = bf.__mx_handle__()(arrs)
+        assert d.shape == e.shape
+        assert mx.test_utils.almost_equal(d.asnumpy(), e.asnumpy())
+
+def test_batchify_pad_mixed_dtype():
+    a = np.array([[1, 2, 3], [4, 5, 6]], dtype='int64')
+    b = np.array([[7, 8]], dtype='int64')
+    for dtype in ['float32', 'float64', 'int32']:
+        bf = mx.gluon.data.batchify.Pad(val=-1, dtype=dtype)
+        d = bf([a, b])
+        e = bf.__mx_handle__()([a, b])
+        assert e.dtype == np.dtype(dtype)
+        assert d.shape == e.shape
+        assert mx.test_utils.almost_equal(d.asnumpy(), e.asnumpy())
+    bf = mx.gluon.data.batchify.Pad(val=-1, dtype='float32')
+    e = bf.__mx_handle__()([a, b])
+    expected = np.array([[[1, 2, 3], [4, 5, 6]],
+                         [[7, 8, -1], [-1, -1, -1]]], dtype='float32')
+    assert mx.test_utils.almost_equal(e.asnumpy(), expected)
+
 def test_batchify_group():
     a = [np.array([[1, 2, 3, 4], [5, 6, 7, 8]]), np.array([[1, 2, 3, 4], [11, 12, 13, 14]])]
     b = [np.array([[1, 2, 3, 4], [5, 6, 7, 8]]), np.array([[4, 5, 6]])]
@@ -598,6 +711,27 @@ def test_batchify_group():
                          [[ 9., 10., -1., -1.], [-1., -1., -1., -1.]]])
     assert mx.test_utils.almost_equal(d[1].asnumpy(), expected)
 
+def test_bucket_sampler():
+    lengths = [random.randint(1, 50) for _ in range(1000)]
+    sampler = mx.gluon.data._internal.MXSampler('BucketSampler', lengths=lengths, batch_size=10,
+                                                sort_window=5)
+    batches = list(sampler)
+    assert len(batches) == 100
+    assert sorted(sum(batches, [])) == list(range(1000))
+    # batches of similar lengths are padded much less than random ones
+    padded = sum(max(lengths[i] for i in batch) * len(batch) for batch in batches)
+    random_batches = [list(range(i, i + 10)) for i in range(0, 1000, 10)]
+    padded_random = sum(max(lengths[i] for i in batch) * len(batch) for batch in random_batches)
+    assert padded < padded_random
+
+    sampler = mx.gluon.data._internal.MXSampler('BucketSampler', lengths=lengths, batch_size=64,
+                                                sort_window=0, shuffle=False)
+    batches = list(sampler)
+    assert len(batches) == 16 and len(batches[-1]) == 1000 % 64
+    assert sorted(sum(batches, [])) == list(range(1000))
+    for prev, batch in zip(batches, batches[1:]):
+        assert max(lengths[i] for i in prev) <= min(lengths[i] for i in batch)
+
 def test_sampler():
     interval_sampler = mx.gluon.data.IntervalSampler(10, 3)
     assert sorted(list(interval_sampler)) == list(range(10))
@@ -18,6 +18,7 @@
 import mxnet as mx
 import unittest
 import os
+import gc
 import numpy as np
 from mxnet import gluon
 from mxnet.gluon import nn
@@ -351,3 +352,124 @@ def test_trainer_share_parameters():
 
     assert((shared_params[0] == shared_params[1]).all())
 
+
+def test_trainer_shard_optimizer_states(tmpdir):
+    ctxes = [mx.cpu(0), mx.cpu(1)]
+    def make_trainer(shard):
+        params = [gluon.Parameter(f'x{i}', shape=(i + 1, 4)) for i in range(3)]
+        for param in params:
+            param.initialize(ctx=ctxes, init='ones')
+        return params, gluon.Trainer(params, 'adam', {'learning_rate': 0.1},
+                                     update_on_kvstore=False, shard_optimizer_states=shard)
+
+    def step(params, trainer):
+        with mx.autograd.record():
+            for i, param in enumerate(params):
+                for j, w in enumerate(param.list_data()):
+                    y = (w * w * (i + j + 1)).sum()
+                    y.backward()
+        trainer.step(1)
+
+    params, trainer = make_trainer(False)
+    sharded_params, sharded_trainer = make_trainer(True)
+    for _ in range(3):
+        step(params, trainer)
+        step(sharded_params, sharded_trainer)
+    for param, sharded_param in zip(params, sharded_params):
+        for ctx in ctxes:
+            assert_almost_equal(param.data(ctx), sharded_param.data(ctx))
+
+    # every parameter has states on its owner only, largest parameter first
+    owners = [sharded_trainer._shard_owner(i) for i in range(3)]
+    assert owners == [1, 1, 0]
+    for owner, updater in enumerate(sharded_trainer._updaters):
+        assert sorted(updater.states.keys()) == [i for i in range(3) if owners[i] == owner]
+
+    fname = str(tmpdir.join('sharded.states'))
+    sharded_trainer.save_states(fname)
+    sharded_trainer.load_states(fname)
+    for owner, updater in enumerate(sharded_trainer._updaters):
+        assert sorted(updater.states.keys()) == [i for i in range(3) if owners[i] == owner]
+    step(params, trainer)
+    step(sharded_params, sharded_trainer)
+    for param, sharded_param in zip(params, sharded_params):
+        for ctx in ctxes:
+            assert_almost_equal(param.data(ctx), sharded_param.data(ctx))
+
+    pytest.raises(ValueError, gluon.Trainer, sharded_params, 'sgd',
+                  update_on_kvstore=True, shard_optimizer_states=True)
+
+
+def test_trainer_offload_optimizer_states():
+    def make_trainer(offload):
+        params = [gluon.Parameter(f'x{i}', shape=(i + 1, 4)) for i in range(3)]
+        for param in params:
+            param.initialize(ctx=mx.cpu(0), init='ones')
+        optimizer = mx.optimizer.SGD(learning_rate=0.1, momentum=0.9, aggregate_num=2)
+        return params, gluon.Trainer(params, optimizer, update_on_kvstore=False,
+                                     offload_optimizer_states=offload)
+
+    def step(params, trainer):
+        with mx.autograd.record():
+            y = sum((p.data() * p.data() * (i + 1)).sum() for i, p in enumerate(params))
+        y.backward()
+        trainer.step(1)
+
+    params, trainer = make_trainer(False)
+    offloaded_params, offloaded_trainer = make_trainer(True)
+    for _ in range(3):
+        step(params, trainer)
+        step(offloaded_params, offloaded_trainer)
+    for param, offloaded_param in zip(params, offloaded_params):
+        assert offloaded_param.data().device == mx.cpu(0)
+        assert_almost_equal(param.data(), offloaded_param.data())
+    for state in offloaded_trainer._updaters[0].states.values():
+        assert state.device == mx.cpu_pinned(0)
+
+    pytest.raises(ValueError, gluon.Trainer, offloaded_params, 'sgd',
+                  update_on_kvstore=True, offload_optimizer_states=True)
+
+
+@pytest.mark.parametrize('shard', [False, True])
+def test_trainer_overlap_allreduce(shard):
+    ctxes = [mx.cpu(0), mx.cpu(1)]
+    def make_trainer(overlap):
+        params = [gluon.Parameter(f'x{i}', shape=(i + 1, 4)) for i in range(3)]
+        for param in params:
+            param.initialize(ctx=ctxes, init='ones')
+        return params, gluon.Trainer(params, 'sgd', {'learning_rate': 0.1, 'momentum': 0.9},
+                                     update_on_kvstore=False, shard_optimizer_states=shard,
+                                     overlap_allreduce=overlap)
+
+    def backward(params):
+        with mx.autograd.record():
+            losses = [sum((p.data(ctx) * p.data(ctx) * (i + j + 1)).sum()
+                          for i, p in enumerate(params)) for j, ctx in enumerate(ctxes)]
+        mx.autograd.backward(losses)
+
+    params, trainer = make_trainer(False)
+    overlapped_params, overlapped_trainer = make_trainer(True)
+    for it in range(3):
+        backward(params)
+        trainer.step(1)
+        backward(overlapped_params)
+        # the hooks are set by the first step
+        assert overlapped_trainer._reduced_by_hooks == (set(range(3)) if it > 0 else set())
+        overlapped_trainer.step(1)
+    for param, overlapped_param in zip(params, overlapped_params):
+        for ctx in ctxes:
+            assert_almost_equal(param.data(ctx), overlapped_param.data(ctx))
+
+    overlapped_trainer._reset_kvstore()
+    assert not overlapped_trainer._hooked_grads
+
+    # the hooks of a trainer are removed when it is collected
+    params, trainer = make_trainer(True)
+    for _ in range(2):
+        backward(params)
+        trainer.step(1)
+    grads = [grad for param in params for grad in param.list_grad()]
+    assert all(grad.handle.value in mx.autograd._grad_hooks for grad in grads)
+    del trainer
+    gc.collect()
+    assert not any(grad.handle.value in mx.autograd._grad_hooks for grad in grads)
@@ -72,6 +72,28 @@ def test_MNISTIter(tmpdir):
     assert(sum(label_0 - label_1) == 0)
     mx.nd.waitall()
 
+@pytest.mark.skipif(mx.device.num_gpus() < 1, reason="copy_to_device needs a GPU")
+def test_MNISTIter_copy_to_device(tmpdir):
+    path = str(tmpdir)
+    get_mnist_ubyte(path)
+
+    def make_iter(copy_to_device):
+        return mx.io.MNISTIter(
+            image=os.path.join(path, 'train-images-idx3-ubyte'),
+            label=os.path.join(path, 'train-labels-idx1-ubyte'),
+            data_shape=(784,), batch_size=100, shuffle=0, flat=1,
+            prefetch_buffer=2, device_id=0, copy_to_device=copy_to_device)
+
+    num_batches = 0
+    for batch_cpu, batch_gpu in zip_longest(make_iter(False), make_iter(True)):
+        assert batch_cpu and batch_gpu, 'The iterators do not contain the same number of batches'
+        assert batch_gpu.data[0].context == mx.gpu(0)
+        assert batch_gpu.label[0].context == mx.gpu(0)
+        assert_almost_equal(batch_cpu.data[0].asnumpy(), batch_gpu.data[0].asnumpy())
+        assert_almost_equal(batch_cpu.label[0].asnumpy(), batch_gpu.label[0].asnumpy())
+        num_batches += 1
+    assert num_batches == 600
+
 def test_Cifar10Rec(cifar10):
     dataiter = mx.io.ImageRecordIter(
         path_imgrec=os.path.join(cifar10, 'cifar', 'train.rec'),
@@ -449,6 +471,19 @@ def test_CSVIter(tmpdir):
     for dtype in ['int32', 'int64', 'float32']:
         check_CSVIter_synthetic(dtype=dtype)
 
+def test_CSVIter_preprocess_threads(tmpdir):
+    data_path = os.path.join(str(tmpdir), 'data.t')
+    data = np.random.uniform(-1e3, 1e3, size=(997, 5)).astype(np.float32)
+    with open(data_path, 'w') as fout:
+        for i, row in enumerate(data):
+            fmt = '{:.6e}' if i % 2 else '{:.4f}'
+            fout.write(','.join(fmt.format(v) for v in row) + ('\r\n' if i % 3 else '\n'))
+    for threads in [1, 4]:
+        data_iter = mx.io.CSVIter(data_csv=data_path, data_shape=(5,), batch_size=997,
+                                  preprocess_threads=threads)
+        batch = data_iter.next()
+        assert_almost_equal(batch.data[0].asnumpy(), data, rtol=1e-4, atol=1e-3)
+
 def test_ImageRecordIter_seed_augmentation(cifar10):
     seed_aug = 3
 
@@ -572,3 +607,58 @@ def test_ImageRecordIter_seed_augmentation(cifar10):
         seed_aug=seed_aug)
 
     assert_dataiter_items_equals(dataiter1, dataiter2)
+
+@pytest.mark.skipif(not mx.runtime.Features().is_enabled('NVJPEG') or mx.device.num_gpus() < 1,
+                    reason="gpu_decode needs nvJPEG and a GPU")
+def test_ImageRecordIter_gpu_decode(cifar10):
+    def make_iter(gpu_decode):
+        return mx.io.ImageRecordIter(
+            path_imgrec=os.path.join(cifar10, 'cifar', 'train.rec'),
+            mean_img=os.path.join(cifar10, 'cifar', 'cifar10_mean.bin'),
+            shuffle=False,
+            data_shape=(3, 28, 28),
+            batch_size=10,
+            round_batch=False,
+            device_id=0,
+            gpu_decode=gpu_decode)
+
+    num_batches = 0
+    for batch_cpu, batch_gpu in zip_longest(make_iter(False), make_iter(True)):
+        assert batch_cpu and batch_gpu, 'The iterators do not contain the same number of batches'
+        assert batch_gpu.data[0].context == mx.gpu(0)
+        assert batch_cpu.pad == batch_gpu.pad
+        # the JPEG decoders of nvJPEG and libjpeg round differently
+        assert_almost_equal(batch_cpu.data[0].asnumpy(), batch_gpu.data[0].asnumpy(),
+                            rtol=0, atol=8)
+        assert_almost_equal(batch_cpu.label[0].asnumpy(), batch_gpu.label[0].asnumpy())
+        num_batches += 1
+        if num_batches == 20:
+            break
+
+def test_ImageRecordIter_cache(cifar10, tmpdir):
+    def make_iter(**kwargs):
+        return mx.io.ImageRecordIter(
+            path_imgrec=os.path.join(cifar10, 'cifar', 'train.rec'),
+            shuffle=False,
+            rand_crop=True,
+            rand_mirror=True,
+            seed_aug=3,
+            data_shape=(3, 28, 28),
+            batch_size=100,
+            round_batch=False,
+            **kwargs)
+
+    # 1 MB holds a few hundred images, the others are spilled to tmpdir
+    iters = [make_iter(), make_iter(cache_size=64), make_iter(cache_size=1, cache_dir=str(tmpdir))]
+    for _ in range(2):
+        num_batches = 0
+        for batches in zip_longest(*iters):
+            assert all(batches), 'The iterators do not contain the same number of batches'
+            for batch in batches[1:]:
+                assert_almost_equal(batches[0].data[0].asnumpy(), batch.data[0].asnumpy())
+                assert_almost_equal(batches[0].label[0].asnumpy(), batch.label[0].asnumpy())
+            num_batches += 1
+            if num_batches == 10:
+                break
+        for it in iters:
+            it.reset()
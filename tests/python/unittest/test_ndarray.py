@@ -20,11 +20,12 @@ import numpy as np
 from distutils.version import LooseVersion
 from itertools import permutations, combinations_with_replacement
 import os
+import sys
 import pickle as pkl
 import random
 import functools
 import pytest
-from common import assertRaises, TemporaryDirectory
+from common import assertRaises, TemporaryDirectory, run_in_spawned_process
 from mxnet.test_utils import almost_equal
 from mxnet.test_utils import assert_almost_equal, assert_exception
 from mxnet.test_utils import default_device
@@ -424,6 +425,90 @@ def test_ndarray_saveload(save_fn):
     os.remove(fname)
 
 
+def test_ndarray_save_load_mapped(tmp_path):
+    fname = str(tmp_path / 'mapped.params')
+    data = [random_ndarray(np.random.randint(1, 5)) for _ in range(5)]
+    data.append(mx.nd.array([1, 2, 3], dtype='int32'))
+    data.append(mx.nd.zeros((0, 3)))
+    mx.nd.save(fname, data, mapped=True)
+    for loaded in (mx.nd.load(fname), mx.nd.load_mapped(fname, ctx=mx.cpu())):
+        assert len(loaded) == len(data)
+        for x, y in zip(data, loaded):
+            assert x.dtype == y.dtype
+            assert same(x.asnumpy(), y.asnumpy())
+    dmap = {f'arg:w{i}': x for i, x in enumerate(data)}
+    mx.nd.save(fname, dmap, mapped=True)
+    dmap2 = mx.nd.load_mapped(fname)
+    assert sorted(dmap2.keys()) == sorted(dmap.keys())
+    # the views are copy-on-write, writing to one leaves the file untouched
+    dmap2['arg:w0'][:] = 7
+    for k, x in dmap.items():
+        assert same(x.asnumpy(), mx.nd.load(fname)[k].asnumpy())
+
+
+def test_ndarray_save_load_sharded(tmp_path):
+    fname = str(tmp_path / 'sharded.params')
+    data = [random_ndarray(np.random.randint(1, 5)) for _ in range(7)]
+    mx.nd.save(fname, data, num_shards=3)
+    for i in range(3):
+        assert os.path.exists(f'{fname}.shard-{i}-of-3')
+    loaded = mx.nd.load(fname)
+    assert len(loaded) == len(data)
+    for x, y in zip(data, loaded):
+        assert same(x.asnumpy(), y.asnumpy())
+    dmap = {f'arg:w{i}': x for i, x in enumerate(data)}
+    mx.nd.save(fname, dmap, num_shards=2)
+    dmap2 = mx.nd.load(fname)
+    assert sorted(dmap2.keys()) == sorted(dmap.keys())
+    for k, x in dmap.items():
+        assert same(x.asnumpy(), dmap2[k].asnumpy())
+
+
+@pytest.mark.parametrize('mapped,num_shards', [(False, 1), (True, 1), (False, 2)])
+def test_ndarray_save_async(tmp_path, mapped, num_shards):
+    fname = str(tmp_path / 'async.params')
+    dmap = {f'arg:w{i}': random_ndarray(np.random.randint(1, 5)) for i in range(5)}
+    expected = {k: x.asnumpy() for k, x in dmap.items()}
+    ckpt = mx.nd.save_async(fname, dmap, mapped=mapped, num_shards=num_shards)
+    # updates after the call do not change the saved values
+    for x in dmap.values():
+        x += 1
+    ckpt.wait()
+    assert ckpt.done
+    dmap2 = mx.nd.load(fname)
+    assert sorted(dmap2.keys()) == sorted(expected.keys())
+    for k, x in expected.items():
+        assert same(x, dmap2[k].asnumpy())
+
+
+def test_imperative_prepared_op():
+    import ctypes
+    from mxnet.base import _LIB, check_call, c_str, c_str_array, c_handle_array, NDArrayHandle
+    from mxnet.ndarray.ndarray import _new_empty_handle
+    op = ctypes.c_void_p()
+    check_call(_LIB.NNGetOpHandle(c_str('_plus_scalar'), ctypes.byref(op)))
+    prepared = ctypes.c_void_p()
+    check_call(_LIB.MXImperativePrepare(op, 1, 1, c_str_array(['scalar']), c_str_array(['2']),
+                                        ctypes.byref(prepared)))
+    x = mx.nd.array([1, 2, 3])
+    for _ in range(2):
+        num_outputs = ctypes.c_int(0)
+        outputs = ctypes.POINTER(NDArrayHandle)()
+        check_call(_LIB.MXImperativeInvokePrepared(prepared, 1, c_handle_array([x]),
+                                                   ctypes.byref(num_outputs),
+                                                   ctypes.byref(outputs), None))
+        assert num_outputs.value == 1
+        y = mx.nd.NDArray(NDArrayHandle(outputs[0]))
+        assert same(y.asnumpy(), x.asnumpy() + 2)
+    # the output of the first op is the input of the second
+    y, z = mx.nd.NDArray(_new_empty_handle()), mx.nd.NDArray(_new_empty_handle())
+    check_call(_LIB.MXImperativeInvokePreparedBatch(
+        2, (ctypes.c_void_p * 2)(prepared, prepared), (ctypes.c_int * 2)(1, 1),
+        c_handle_array([x, y]), (ctypes.c_int * 2)(1, 1), c_handle_array([y, z])))
+    assert same(z.asnumpy(), x.asnumpy() + 4)
+    check_call(_LIB.MXFreePreparedOp(prepared))
+
+
 @mx.util.use_np
 def test_ndarray_load_fortran_order(tmp_path):
     arr = np.arange(20).reshape((2, 10)).T
@@ -1790,6 +1875,28 @@ def test_ndarray_cpu_shared_ctx():
     res = mx.nd.zeros((1, 2, 3), ctx=ctx)
     assert(res.context == ctx)
 
+def _recycle_shared_mem(seed):
+    ctx = mx.Context('cpu_shared', 0)
+    a = mx.nd.ones((1000,), ctx=ctx)
+    handle = a._to_shared_mem()[:2]
+    del a
+    mx.nd.waitall()
+    # the freed segment is handed out again for the same size
+    b = mx.nd.zeros((1000,), ctx=ctx)
+    assert b._to_shared_mem()[:2] == handle
+    assert (b.asnumpy() == 0).all()
+    # but not while it is in use, nor for another size
+    c = mx.nd.zeros((1000,), ctx=ctx)
+    assert c._to_shared_mem()[:2] != handle
+    del b
+    mx.nd.waitall()
+    d = mx.nd.zeros((100000,), ctx=ctx)
+    assert d._to_shared_mem()[:2] != handle
+
+@pytest.mark.skipif(not sys.platform.startswith('linux'), reason='segments are recycled on Linux')
+def test_ndarray_cpu_shared_recycle():
+    run_in_spawned_process(_recycle_shared_mem, {'MXNET_CPU_SHARED_MEM_POOL_SIZE': '67108864'})
+
 @pytest.mark.serial
 def test_dlpack():
     for _ in [np.float32, np.int32]:
@@ -1818,6 +1925,17 @@ def test_dlpack():
             assert_almost_equal(a_np, d)
             assert_almost_equal(a_np, e)
 
+@pytest.mark.parametrize('stype', ['csr', 'row_sparse'])
+def test_dlpack_sparse(stype):
+    a = mx.test_utils.rand_ndarray((10, 8), stype, density=0.3)
+    a_np = a.asnumpy()
+    pack = mx.nd.to_dlpack_for_read(a)
+    assert pack[:2] == (stype, (10, 8))
+    b = mx.nd.from_dlpack(pack)
+    del a, pack
+    assert b.stype == stype
+    assert_almost_equal(a_np, b.asnumpy())
+
 def test_ndarray_is_inf():
     random_dimensions = np.random.randint(2, 5)
     random_shape = [np.random.randint(2, 5) for i in range(random_dimensions)]
@@ -2064,3 +2182,43 @@ def test_readable_bfloat16_print():
     arr_float = arr_bfloat16.astype(float)
     assert (arr_bfloat16.__str__() == arr_float.__str__())
     assert (arr_bfloat16.__repr__().find(arr_uint16.__str__()) != -1)
+
+def test_bfloat16_cpu_kernels():
+    data = mx.nd.random.uniform(-1, 1, shape=(8, 1000)).astype(bfloat16)
+    # the reference runs in float32 on the same, already rounded, values
+    data32 = data.astype('float32')
+    # a float accumulator keeps the sum of 1000 values within bfloat16 rounding of the result
+    assert_almost_equal(mx.nd.sum(data, axis=1).astype('float32'), mx.nd.sum(data32, axis=1),
+                        rtol=1e-2, atol=1e-1)
+    assert_almost_equal(mx.nd.softmax(data, axis=-1).astype('float32'),
+                        mx.nd.softmax(data32, axis=-1), rtol=1e-2, atol=1e-4)
+    assert_almost_equal(mx.nd.sort(data, axis=-1).astype('float32'),
+                        mx.nd.sort(data32, axis=-1))
+    idx = mx.nd.argsort(data, axis=-1, is_ascend=False).asnumpy().astype(np.int64)
+    assert_almost_equal(np.take_along_axis(data32.asnumpy(), idx, axis=-1),
+                        mx.nd.sort(data32, axis=-1, is_ascend=False))
+    # mixed precision update of a bfloat16 weight with a float32 master copy
+    weight32 = data32.copy()
+    grad = (data * 0.5).astype(bfloat16)
+    out = mx.nd.mp_sgd_update(data, grad, weight32, lr=0.1, wd=0.01)
+    expected = data32 - 0.1 * (grad.astype('float32') + 0.01 * data32)
+    assert_almost_equal(weight32, expected, rtol=1e-5, atol=1e-6)
+    assert_almost_equal(out.astype('float32'), expected, rtol=1e-2, atol=1e-2)
+
+def test_repeated_invoke_infer_cache():
+    # repeated invocations reuse the cached inference of the first one, the cache
+    # must still tell apart the attributes, shapes, types and storage types
+    x = mx.nd.random.uniform(shape=(4, 5))
+    for _ in range(3):
+        assert mx.nd.sum(x, axis=0).shape == (5,)
+        assert mx.nd.sum(x, axis=1).shape == (4,)
+        assert mx.nd.sum(x, axis=1, keepdims=True).shape == (4, 1)
+        assert mx.nd.sum(x.reshape((2, 10)), axis=1).shape == (2,)
+        assert mx.nd.sum(x.astype('float16'), axis=1).dtype == np.float16
+        assert (x.tostype('csr') * 2).stype == 'csr'
+        assert (x * 2).stype == 'default'
+    out = mx.nd.zeros((5,))
+    mx.nd.sum(x, axis=0, out=out)
+    assert_almost_equal(out, x.asnumpy().sum(axis=0))
+    with pytest.raises(mx.MXNetError):
+        mx.nd.sum(x, axis=0, out=mx.nd.zeros((4,)))
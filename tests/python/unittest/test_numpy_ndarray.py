@@ -1005,6 +1005,23 @@ def test_np_save_load_large_ndarrays(load_fn, tmp_path):
                            else arr_loaded, weight)
 
 
+@use_np
+@pytest.mark.parametrize('save_fn', [_np.savez, _np.savez_compressed])
+def test_np_load_numpy_npz(save_fn, tmp_path):
+    # members of odd sizes leave the following ones unaligned in the archive
+    arrays = {'a': _np.arange(3, dtype='uint8'), 'b': _np.random.normal(size=(5, 7)),
+              'c': _np.arange(24, dtype='int32').reshape((2, 3, 4)),
+              'd': _np.asfortranarray(_np.random.normal(size=(4, 6)).astype('float32'))}
+    save_fn(str(tmp_path / 'arrays.npz'), **arrays)
+    loaded = npx.load(str(tmp_path / 'arrays.npz'))
+    assert sorted(loaded.keys()) == sorted(arrays.keys())
+    for k, x in arrays.items():
+        assert loaded[k].dtype == x.dtype
+        assert _np.array_equal(loaded[k].asnumpy(), x)
+    _np.save(str(tmp_path / 'array.npy'), arrays['b'])
+    assert _np.array_equal(npx.load(str(tmp_path / 'array.npy')).asnumpy(), arrays['b'])
+
+
 @use_np
 @pytest.mark.serial
 @pytest.mark.parametrize('load_fn', [_np.load, npx.load])
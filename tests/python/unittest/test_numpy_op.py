@@ -58,6 +58,9 @@ from numpy.testing import assert_allclose
     ((3, 5, 4, 3, 2), (2, 3, 5, 1, 2), [[1, 3, 4], [2, 1, 0]]),
     ((3, 5, 4), (5, 4, 3), [[1, 0, 2], [0, 2, 1]]),
     ((3, 5, 4), (5, 3, 4), [[2, 0], [-1, -2]]),
+    ((5, 4, 3), (5, 4, 2), [[0, 1], [0, 1]]),
+    ((3, 5, 4), (2, 5, 4), [[1, 2], [1, 2]]),
+    ((4, 3), (2, 4), [[0], [1]]),
     ((2, 2), (2, 2), 2),
     ((3, 5, 4), (5, ), [[-2], [0]]),
     ((3, 5, 4), (5, ), [[1], [0]]),
@@ -456,7 +459,10 @@ def test_np_outer(a_shape, b_shape, dtype, hybridize):
     ((2, 1, 3, 4, 5), (5, 2)),
     ((1, 3, 5, 4), (1, 4, 3)),
     ((3, 5, 4), (2, 1, 4, 3)),
-    ((3, 4), (1, 5, 4, 3))
+    ((3, 4), (1, 5, 4, 3)),
+    ((2, 3, 4, 5), (1, 1, 5, 6)),
+    ((2, 3, 4, 5), (3, 5, 6)),
+    ((4, 5), (2, 3, 5, 6))
 ])
 @pytest.mark.parametrize('grad_req_a', ['write', 'add', 'null'])
 @pytest.mark.parametrize('grad_req_b', ['write', 'add', 'null'])
@@ -3261,6 +3267,29 @@ def test_np_binary_funcs():
             check_binary_func(func, lshape, rshape, low, high, lgrads, rgrads, dtypes)
 
 
+@use_np
+@pytest.mark.parametrize('lshape,rshape', [
+    ((300, 10000), ()),         # scalar
+    ((20000,), (1,)),           # scalar
+    ((300, 1000), (1000,)),     # row
+    ((300, 1000), (300, 1)),    # column
+    ((300, 1), (1, 1000)),      # outer
+    ((8, 16, 30, 30), (16, 1, 1)),
+    ((4, 1, 5, 100), (3, 1, 100)),
+    ((2, 1, 3, 1, 4), (1, 5, 1, 6, 4)),
+])
+@pytest.mark.parametrize('dtype', ['float32', 'float64', 'int32'])
+def test_np_binary_broadcast_patterns(lshape, rshape, dtype):
+    # each broadcast pattern runs its own contiguous loop on cpu
+    l_np = onp.random.randint(-5, 5, size=lshape).astype(dtype)
+    r_np = onp.random.randint(1, 5, size=rshape).astype(dtype)
+    l, r = np.array(l_np, dtype=dtype), np.array(r_np, dtype=dtype)
+    for func in ['add', 'subtract', 'multiply', 'maximum']:
+        expected = getattr(onp, func)(l_np, r_np)
+        assert same(getattr(np, func)(l, r).asnumpy(), expected)
+        assert same(getattr(np, func)(r, l).asnumpy(), getattr(onp, func)(r_np, l_np))
+
+
 @use_np
 def test_np_mixed_precision_binary_funcs():
     itypes = [np.bool, np.int8, np.int32, np.int64]
@@ -3971,6 +4000,38 @@ def test_np_split():
                     assert_almost_equal(mx_out.asnumpy(), np_out, rtol=1e-3, atol=1e-5)
 
 
+@use_np
+@pytest.mark.parametrize('shape,axis', [
+    ((12,), 0), ((6, 5), 0), ((1, 8, 3), 1), ((1, 1, 9), -1), ((4, 6), 1)
+])
+def test_np_split_contiguous_views(shape, axis):
+    a = np.arange(int(onp.prod(shape)), dtype=np.float32).reshape(shape)
+    size = shape[axis]
+    for indices_or_sections in [size // 2 if size % 2 == 0 else size, (1, size - 2)]:
+        expected = onp.split(a.asnumpy(), indices_or_sections, axis=axis)
+        outs = np.split(a, indices_or_sections, axis=axis)
+        assert len(outs) == len(expected)
+        for out, exp in zip(outs, expected):
+            assert out.shape == exp.shape
+            assert_almost_equal(out.asnumpy(), exp)
+        outs = np.array_split(a, 5, axis=axis)
+        for out, exp in zip(outs, onp.array_split(a.asnumpy(), 5, axis=axis)):
+            assert_almost_equal(out.asnumpy(), exp)
+    # the sections are views of the input when all the axes before `axis` have size 1
+    contiguous = all(d == 1 for d in shape[:axis % len(shape)])
+    outs = np.split(a, [1], axis=axis)
+    assert np.shares_memory(outs[1], a) == contiguous
+    # gradients still flow through the split operator under autograd
+    a.attach_grad()
+    with mx.autograd.record():
+        outs = np.split(a, [1], axis=axis)
+        loss = (outs[0] * 2).sum() + outs[1].sum()
+    loss.backward()
+    expected_grad = onp.ones(shape, dtype=onp.float32)
+    expected_grad[(slice(None),) * (axis % len(shape)) + (slice(0, 1),)] = 2
+    assert_almost_equal(a.grad.asnumpy(), expected_grad)
+
+
 @use_np
 def test_np_array_split():
     class TestArray_split(HybridBlock):
@@ -5595,6 +5656,30 @@ def test_np_cumsum():
                     assert_almost_equal(mx_out.asnumpy(), np_out, rtol=1e-3, atol=1e-5)
 
 
+@use_np
+@pytest.mark.parametrize('shape,axis', [
+    ((1 << 20,), None),
+    ((3, 200000), 1),
+    ((200000, 3), 0),
+    ((2, 50000, 5), 1),
+    ((4, 300, 700), -2),
+])
+def test_np_cumsum_long_axis(shape, axis):
+    # long scanned axes are cut into chunks which are scanned in parallel
+    x_np = onp.random.randint(-3, 4, size=shape).astype('int64')
+    x = np.array(x_np, dtype='int64')
+    assert same(np.cumsum(x, axis=axis).asnumpy(), onp.cumsum(x_np, axis=axis))
+    x = np.array(x_np, dtype='float64')
+    x.attach_grad()
+    with mx.autograd.record():
+        out = np.cumsum(x, axis=axis)
+    ograd_np = onp.random.randint(-3, 4, size=out.shape).astype('float64')
+    out.backward(np.array(ograd_np))
+    axis_np = 0 if axis is None else axis
+    igrad_np = onp.flip(onp.cumsum(onp.flip(ograd_np, axis=axis_np), axis=axis_np), axis=axis_np)
+    assert_almost_equal(x.grad.asnumpy(), igrad_np.reshape(shape))
+
+
 @use_np
 @pytest.mark.skip(reason='Skipped as the test is flaky and the feature causes curand error. Tracked in #18100')
 def test_np_histogram():
@@ -5858,6 +5943,35 @@ def test_np_repeat():
             assert same(ret_mx.asnumpy(), ret_np)
 
 
+@use_np
+@pytest.mark.parametrize('shape,axis', [
+    ((64, 33, 70), 0),
+    ((64, 33, 70), 1),
+    ((64, 33, 70), 2),
+    ((64, 33, 70), None),
+])
+def test_np_rearrange_large(shape, axis):
+    # repeat, tile and pad are copied on cpu as contiguous runs of the output rows
+    data_np = onp.random.uniform(-1, 1, size=shape).astype('float32')
+    data = np.array(data_np)
+    length = data_np.size if axis is None else shape[axis]
+    for repeats in [3, onp.random.randint(0, 4, size=length).tolist()]:
+        assert same(np.repeat(data, repeats, axis).asnumpy(), onp.repeat(data_np, repeats, axis))
+    for reps in [(2, 3), (3, 1, 1), (1, 2, 1, 2), (4,)]:
+        assert same(np.tile(data, reps).asnumpy(), onp.tile(data_np, reps))
+    pad_width = [(1, 2), (0, 3), (2, 0)]
+    assert same(np.pad(data, pad_width, mode='constant', constant_values=2).asnumpy(),
+                onp.pad(data_np, pad_width, mode='constant', constant_values=2))
+    for mode in ['edge', 'reflect', 'symmetric', 'maximum']:
+        assert same(np.pad(data, pad_width, mode=mode).asnumpy(),
+                    onp.pad(data_np, pad_width, mode=mode))
+    data.attach_grad()
+    with mx.autograd.record():
+        out = np.pad(data, pad_width, mode='constant')
+    out.backward(np.ones(out.shape))
+    assert same(data.grad.asnumpy(), onp.ones(shape, dtype='float32'))
+
+
 @use_np
 def test_np_linalg_norm():
     class TestLinalgNorm(HybridBlock):
@@ -8481,6 +8595,21 @@ def test_np_unique_values(shape, index, inverse, counts, dtype, hybridize):
     assert_almost_equal(mx_out.asnumpy(), np_out, rtol=1e-3, atol=1e-5)
 
 
+@use_np
+@pytest.mark.parametrize('size', [100003, 1 << 20])
+def test_np_compaction_large(size):
+    # large enough for the counts of nonzero, boolean_mask and unique to be split over threads
+    x_np = onp.random.randint(-3, 4, size=size).astype('float32')
+    x = np.array(x_np)
+    assert_almost_equal(npx.nonzero(x).asnumpy(), onp.transpose(onp.nonzero(x_np)))
+    assert_almost_equal(x[x > 0].asnumpy(), x_np[x_np > 0])
+    assert_almost_equal(np.unique(x).asnumpy(), onp.unique(x_np))
+    mx_outs = np.unique(x, return_index=True, return_inverse=True, return_counts=True)
+    np_outs = onp.unique(x_np, return_index=True, return_inverse=True, return_counts=True)
+    for mx_out, np_out in zip(mx_outs, np_outs):
+        assert_almost_equal(mx_out.asnumpy(), np_out)
+
+
 @use_np
 def test_np_take():
     configs = [
@@ -9035,6 +9164,44 @@ def test_np_einsum():
                     assert_almost_equal(grad[0][iop], grad[1][iop], rtol=rtol, atol=atol)
 
 
+@use_np
+@pytest.mark.parametrize('subscripts,shapes', [
+    ('bij,bjk->bik', [(3, 4, 5), (3, 5, 6)]),
+    ('bhqd,bhkd->bhqk', [(2, 3, 4, 5), (2, 3, 6, 5)]),
+    ('bhqk,bhkd->bhqd', [(2, 3, 4, 6), (2, 3, 6, 5)]),
+    ('bqhd,bkhd->bhqk', [(2, 4, 3, 5), (2, 6, 3, 5)]),
+    ('bij,bjk->bki', [(3, 4, 5), (3, 5, 6)]),
+    ('bij,bjk->kbi', [(3, 4, 5), (3, 5, 6)]),
+    ('ibj,bjk->bik', [(4, 3, 5), (3, 5, 6)]),
+    ('bij,bjk->bik', [(3, 1, 5), (3, 5, 1)]),
+    ('bij,bjk->bik', [(1, 4, 5), (3, 5, 6)]),
+    ('bij,bjk,bkl->bil', [(2, 3, 4), (2, 4, 5), (2, 5, 6)]),
+])
+@pytest.mark.parametrize('dtype', ['float32', 'float64'])
+@pytest.mark.parametrize('grad_req', ['write', 'add'])
+def test_np_einsum_batch_gemm(subscripts, shapes, dtype, grad_req):
+    rtol, atol = (1e-3, 1e-4) if dtype == 'float32' else (1e-6, 1e-8)
+    x_np = [onp.random.uniform(-1.0, 1.0, shape).astype(dtype) for shape in shapes]
+    expected = onp.einsum(subscripts, *x_np)
+    out_grad = onp.random.uniform(-1.0, 1.0, expected.shape).astype(dtype)
+    grads = []
+    for optimize in [False, True]:
+        x = [np.array(op, dtype=dtype) for op in x_np]
+        for op in x:
+            op.attach_grad(grad_req)
+            if grad_req == 'add':
+                op.grad[:] = 1
+        # run twice to also go through the cached contraction path
+        for _ in range(2):
+            with mx.autograd.record():
+                out = np.einsum(subscripts, *x, optimize=optimize)
+            assert_almost_equal(out.asnumpy(), expected, rtol=rtol, atol=atol)
+            out.backward(np.array(out_grad))
+        grads.append([op.grad.asnumpy() for op in x])
+    for grad_ref, grad_opt in zip(*grads):
+        assert_almost_equal(grad_opt, grad_ref, rtol=rtol, atol=atol)
+
+
 @use_np
 @pytest.mark.skip(reason='Skipped as the test is flaky and the feature causes curand error. Tracked in #18100')
 def test_np_diagflat():
@@ -9548,6 +9715,26 @@ def test_np_percentile():
         assert_almost_equal(mx_out.asnumpy(), np_out, atol=atol, rtol=rtol)
 
 
+@use_np
+@pytest.mark.parametrize('a_shape,axis', [
+    ((100000,), None),
+    ((64, 3000), 1),
+    ((3000, 64), 0),
+    ((8, 500, 20), (0, 2)),
+])
+@pytest.mark.parametrize('q', [50.0, [0.0, 1.0, 99.0, 100.0], list(range(0, 101, 5))])
+@pytest.mark.parametrize('interpolation', ['linear', 'lower', 'higher', 'nearest', 'midpoint'])
+def test_np_percentile_large(a_shape, axis, q, interpolation):
+    # few ranks of long lanes go through the selection path instead of a sort on cpu
+    a = np.random.uniform(-100.0, 100.0, size=a_shape)
+    a_np = a.asnumpy()
+    q_np = onp.array(q)
+    mx_out = np.percentile(a, np.array(q_np) if q_np.ndim else q, axis=axis, interpolation=interpolation)
+    np_out = onp.percentile(a_np, q_np, axis=axis, interpolation=interpolation)
+    assert mx_out.shape == np_out.shape
+    assert_almost_equal(mx_out.asnumpy(), np_out, atol=1e-4, rtol=1e-4)
+
+
 @use_np
 def test_np_diff():
     def np_diff_backward(ograd, n, axis):
@@ -10295,6 +10482,41 @@ def test_np_where():
         assert same(mx_out, np_out)
 
 
+@use_np
+@pytest.mark.parametrize('cshape,xshape,yshape', [
+    ((30, 40), (30, 40), (30, 40)),
+    ((30, 1), (30, 40), (30, 40)),
+    ((30, 40), (30, 40), (1, 40)),
+    ((30, 40), (1, 40), (30, 40)),
+    ((40,), (30, 40), (30, 1)),
+])
+def test_np_where_grad_chain(cshape, xshape, yshape):
+    # the head gradient goes through ops before and after where, so that the graph may
+    # run the backward of where in place of its output gradient
+    class TestWhereChain(HybridBlock):
+        def forward(self, cond, x, y):
+            return np.where(cond, x * 2, y * 3) * 5
+
+    cond = np.random.uniform(size=cshape) > 0.5
+    x = np.random.uniform(-1, 1, size=xshape)
+    y = np.random.uniform(-1, 1, size=yshape)
+    x.attach_grad()
+    y.attach_grad()
+    for hybridize in [False, True]:
+        net = TestWhereChain()
+        if hybridize:
+            net.hybridize()
+        with mx.autograd.record():
+            ret = net(cond, x, y)
+        ret.backward()
+        oshape = ret.shape
+        mask = onp.broadcast_to(cond.asnumpy(), oshape)
+        expected = onp.where(mask, x.asnumpy() * 2, y.asnumpy() * 3) * 5
+        assert_almost_equal(ret.asnumpy(), expected, rtol=1e-5, atol=1e-6)
+        assert_almost_equal(x.grad.asnumpy(), collapse_sum_like(mask * 10.0, xshape), rtol=1e-5, atol=1e-6)
+        assert_almost_equal(y.grad.asnumpy(), collapse_sum_like(~mask * 15.0, yshape), rtol=1e-5, atol=1e-6)
+
+
 @use_np
 def test_np_expand_dims():
     class TestExpandDims(HybridBlock):
@@ -10552,6 +10774,18 @@ def test_np_bincount():
         assert_almost_equal(mx_out.asnumpy(), np_out, rtol=rtol, atol=atol)
 
 
+@use_np
+@pytest.mark.parametrize('max_val', [10, 50000, 2000000])
+def test_np_bincount_large(max_val):
+    # counted into per-thread bins, or bucketed by bin range when there are many bins
+    data_np = onp.random.randint(0, max_val, size=(500000,)).astype('int64')
+    weights_np = onp.random.uniform(-1, 1, size=data_np.shape)
+    data = np.array(data_np, dtype='int64')
+    assert same(np.bincount(data).asnumpy(), onp.bincount(data_np))
+    assert_almost_equal(np.bincount(data, np.array(weights_np, dtype='float64')).asnumpy(),
+                        onp.bincount(data_np, weights_np))
+
+
 @use_np
 @pytest.mark.skip(reason='Test hangs. Tracked in #18144')
 def test_np_empty_like():
@@ -123,6 +123,34 @@ def test_rnnrelu_dropout():
     out = exe.forward(is_train=True)
     out[0].wait_to_read()
 
+@pytest.mark.parametrize('bidirectional', [False, True])
+def test_lstm_sequence_length(bidirectional):
+    T, N, I, H, L = 7, 5, 6, 4, 2
+    D = 2 if bidirectional else 1
+    param_size = ((I + H + 2) * H * 4 + (H * D + H + 2) * H * 4 * (L - 1)) * D
+    data = mx.nd.random.uniform(-1, 1, shape=(T, N, I))
+    params = mx.nd.random.uniform(-1, 1, shape=(param_size,))
+    state = mx.nd.random.uniform(-1, 1, shape=(L * D, N, H))
+    state_cell = mx.nd.random.uniform(-1, 1, shape=(L * D, N, H))
+    lengths = [4, 7, 0, 1, 7]
+    out, hy, cy = mx.nd.RNN(data, params, state, state_cell, mx.nd.array(lengths),
+                            state_size=H, num_layers=L, bidirectional=bidirectional,
+                            mode='lstm', state_outputs=True, use_sequence_length=True)
+    for j, length in enumerate(lengths):
+        if length == 0:
+            assert_almost_equal(hy[:, j], state[:, j])
+            assert_almost_equal(cy[:, j], state_cell[:, j])
+            assert_almost_equal(out[:, j], np.zeros((T, H * D)))
+            continue
+        ref_out, ref_hy, ref_cy = mx.nd.RNN(
+            data[:length, j:j + 1], params, state[:, j:j + 1], state_cell[:, j:j + 1],
+            state_size=H, num_layers=L, bidirectional=bidirectional, mode='lstm',
+            state_outputs=True)
+        assert_almost_equal(out[:length, j], ref_out[:, 0], rtol=1e-4, atol=1e-4)
+        assert_almost_equal(out[length:, j], np.zeros((T - length, H * D)))
+        assert_almost_equal(hy[:, j], ref_hy[:, 0], rtol=1e-4, atol=1e-4)
+        assert_almost_equal(cy[:, j], ref_cy[:, 0], rtol=1e-4, atol=1e-4)
+
 def test_RNN_float64():
     if default_device().device_type == 'gpu':
         return
@@ -687,6 +715,28 @@ def test_gelu_tanh():
         check_symbolic_forward(y, [xa], [ya], rtol=rtol, atol=atol, dtype=dtype)
         check_symbolic_backward(y, [xa], [np.ones(shape)], [ga], rtol=rtol, atol=atol, dtype=dtype)
 
+def test_cpu_vectorized_math():
+    # more than one chunk of the vectorized CPU kernels, with the special values
+    np_erf = np.vectorize(math.erf)
+    x = np.random.uniform(low=-20, high=20, size=(10000,)).astype(np.float32)
+    x = np.concatenate([x, np.array([0, -0., 1e-5, -1e-5, 88.8, -110, np.inf, -np.inf, np.nan],
+                                    dtype=np.float32)])
+    pos = np.concatenate([np.random.uniform(low=1e-3, high=1e3, size=(10000,)),
+                          np.array([0, -1, 1e-40, np.inf, np.nan])]).astype(np.float32)
+    with np.errstate(all='ignore'):
+        for op, fref, data in [(mx.nd.exp, np.exp, x),
+                               (mx.nd.log, np.log, pos),
+                               (mx.nd.tanh, np.tanh, x),
+                               (mx.nd.sigmoid, lambda a: 1 / (1 + np.exp(-a)), x),
+                               (mx.nd.erf, np_erf, x)]:
+            expected = fref(data.astype(np.float64)).astype(np.float32)
+            assert_almost_equal(op(mx.nd.array(data)), expected, rtol=1e-5, atol=1e-30,
+                                equal_nan=True)
+        finite = x[np.isfinite(x)]
+        gelu = 0.5 * finite * (1 + np_erf(finite.astype(np.float64) / np.sqrt(2)))
+        assert_almost_equal(mx.nd.LeakyReLU(mx.nd.array(finite), act_type='gelu'),
+                            gelu.astype(np.float32), rtol=1e-5, atol=1e-6)
+
 def test_sigmoid():
     def fsigmoid(a):
         return np.divide(1.0, (1.0 + np.exp(-a)))
@@ -1779,6 +1829,44 @@ def test_convolution_grouping():
                 assert_almost_equal(arr1, arr2)
 
 
+@pytest.mark.parametrize('dtype', [np.float32, np.float64])
+@pytest.mark.parametrize('shape,num_filter,num_group,kernel,stride,pad,dilate', [
+    ((2, 16, 9, 11), 8, 1, (3, 3), (1, 1), (1, 1), (1, 1)),   # Winograd F(4x4, 3x3)
+    ((1, 16, 5, 6), 16, 2, (3, 3), (1, 1), (0, 1), (1, 1)),   # Winograd F(2x2, 3x3)
+    ((2, 6, 10, 9), 12, 6, (3, 3), (2, 2), (1, 1), (2, 2)),   # depthwise, 2 filters per channel
+    ((1, 4, 8, 8), 4, 4, (5, 3), (1, 2), (2, 0), (1, 1)),     # depthwise
+])
+def test_convolution_native_paths(dtype, shape, num_filter, num_group, kernel, stride, pad, dilate):
+    def np_conv(data, weight):
+        n, c, h, w = data.shape
+        cg, kg = c // num_group, num_filter // num_group
+        padded = np.pad(data, ((0, 0), (0, 0), (pad[0], pad[0]), (pad[1], pad[1])))
+        oh = (h + 2 * pad[0] - dilate[0] * (kernel[0] - 1) - 1) // stride[0] + 1
+        ow = (w + 2 * pad[1] - dilate[1] * (kernel[1] - 1) - 1) // stride[1] + 1
+        out = np.zeros((n, num_filter, oh, ow), dtype=np.float64)
+        for i in range(kernel[0]):
+            for j in range(kernel[1]):
+                y0, x0 = i * dilate[0], j * dilate[1]
+                window = padded[:, :, y0:y0 + stride[0] * (oh - 1) + 1:stride[0],
+                                x0:x0 + stride[1] * (ow - 1) + 1:stride[1]]
+                for g in range(num_group):
+                    out[:, g * kg:(g + 1) * kg] += np.einsum(
+                        'nchw,kc->nkhw', window[:, g * cg:(g + 1) * cg],
+                        weight[g * kg:(g + 1) * kg, :, i, j])
+        return out
+
+    data = np.random.normal(size=shape).astype(dtype)
+    weight = np.random.normal(size=(num_filter, shape[1] // num_group) + kernel).astype(dtype)
+    bias = np.random.normal(size=(num_filter,)).astype(dtype)
+    out = mx.nd.Convolution(mx.nd.array(data, dtype=dtype), mx.nd.array(weight, dtype=dtype),
+                            mx.nd.array(bias, dtype=dtype), num_filter=num_filter,
+                            num_group=num_group, kernel=kernel, stride=stride, pad=pad,
+                            dilate=dilate)
+    expected = np_conv(data, weight) + bias.reshape(1, -1, 1, 1)
+    tol = 1e-4 if dtype == np.float32 else 1e-10
+    assert_almost_equal(out, expected, rtol=tol, atol=tol)
+
+
 @pytest.mark.skip(reason="Flaky test https://github.com/apache/mxnet/issues/14052")
 def test_depthwise_convolution():
     for dim in [1,2]:
@@ -2571,6 +2659,23 @@ def test_reduce():
                           mx.symbol.norm, test_exclude=False, test_none_axis=test_none)
 
 
+@pytest.mark.parametrize('shape,axis', [
+    ((64, 300), 1), ((300, 64), 0), ((8, 16, 64), (0, 2)), ((16, 8, 64), 1),
+    ((4, 6, 8, 40), (1, 3)), ((4, 6, 8, 40), (0, 2)),
+])
+def test_reduce_loop_order(shape, axis):
+    # big enough for the CPU to split the work into contiguous row or column loops
+    a_npy = np.random.uniform(-1, 1, size=shape).astype(np.float32)
+    a = mx.nd.array(a_npy)
+    assert_almost_equal(mx.nd.sum(a, axis=axis), a_npy.sum(axis=axis), rtol=1e-4, atol=1e-4)
+    assert_almost_equal(mx.nd.max(a, axis=axis), a_npy.max(axis=axis))
+    assert_almost_equal(mx.nd.min(a, axis=axis, keepdims=True), a_npy.min(axis=axis, keepdims=True))
+    assert_almost_equal(mx.np.mean(a.as_np_ndarray(), axis=axis), a_npy.mean(axis=axis),
+                        rtol=1e-4, atol=1e-4)
+    if isinstance(axis, int):
+        assert_almost_equal(mx.nd.argmax(a, axis=axis), a_npy.argmax(axis=axis))
+
+
 def test_broadcast():
     sample_num = 200
     for _ in range(sample_num):
@@ -2676,6 +2781,32 @@ def test_larger_transpose():
     assert_allclose(np.transpose(x.asnumpy()), y.asnumpy())
 
 
+@pytest.mark.parametrize('dtype', ['float32', 'float64', 'float16', 'int32', 'int8'])
+@pytest.mark.parametrize('shape,axes', [
+    ((67, 45), (1, 0)),
+    ((3, 37, 41), (0, 2, 1)),
+    ((19, 5, 33), (1, 0, 2)),
+    ((2, 17, 1, 23, 3), (0, 3, 2, 1, 4)),
+    ((2, 3, 9, 10), (0, 2, 3, 1)),
+    ((2, 1, 3, 2, 1, 2, 3, 2), (0, 1, 6, 7, 2, 3, 4, 5)),
+])
+def test_transpose_merged_axes(dtype, shape, axes):
+    x_np = np.random.uniform(-10, 10, size=shape).astype(dtype)
+    x = mx.nd.array(x_np, dtype=dtype)
+    y = mx.nd.transpose(x, axes=axes)
+    assert_allclose(np.transpose(x_np, axes=axes), y.asnumpy())
+    if dtype.startswith('float'):
+        # the gradient of transpose accumulates through the same kernel
+        x.attach_grad(grad_req='add')
+        for _ in range(2):
+            with mx.autograd.record():
+                y = mx.nd.transpose(x, axes=axes)
+            y.backward(mx.nd.array(np.transpose(x_np, axes=axes), dtype=dtype))
+        assert_allclose(2 * x_np, x.grad.asnumpy())
+    z = mx.nd.swapaxes(x, 0, len(shape) - 1)
+    assert_allclose(np.swapaxes(x_np, 0, len(shape) - 1), z.asnumpy())
+
+
 def test_expand_dims():
     for ndim in range(1, 6):
         for axis in range(-ndim + 1, ndim):
@@ -3593,6 +3724,97 @@ def test_layer_norm(enforce_safe_acc, dtype, forward_check_eps, backward_check_e
                                               finite_grad_check=finite_grad_check)
 
 
+def test_dropout_add_layer_norm():
+    shape = (6, 3, 37)
+    data = mx.nd.random.normal(shape=shape)
+    residual = mx.nd.random.normal(shape=shape)
+    gamma = mx.nd.random.uniform(0.5, 1.5, shape=(shape[-1],))
+    beta = mx.nd.random.normal(shape=(shape[-1],))
+    ograd = mx.nd.random.normal(shape=shape)
+
+    def run(fn, p, train_mode):
+        args = [arr.copy() for arr in (data, residual, gamma, beta)]
+        for arr in args:
+            arr.attach_grad()
+        with mx.autograd.record(train_mode=train_mode):
+            out = fn(*args, p)
+        out.backward(ograd, train_mode=train_mode)
+        return out, [arr.grad for arr in args]
+
+    def fused(x, res, g, b, p):
+        return mx.nd.contrib.dropout_add_layer_norm(x, res, g, b, p=p, eps=1e-5)
+
+    def reference(x, res, g, b, p):
+        return mx.nd.LayerNorm(res + x, g, b, axis=-1, eps=1e-5)
+
+    # without dropout the fused op is LayerNorm(residual + data)
+    for p, train_mode in [(0.0, True), (0.4, False)]:
+        out, grads = run(fused, p, train_mode)
+        ref_out, ref_grads = run(reference, p, train_mode)
+        assert_almost_equal(out, ref_out, rtol=1e-4, atol=1e-5)
+        for grad, ref_grad in zip(grads, ref_grads):
+            assert_almost_equal(grad, ref_grad, rtol=1e-4, atol=1e-4)
+
+    # in training the mask regenerated by the backward is the one of the forward
+    p = 0.4
+    out, (data_grad, res_grad, _, _) = run(fused, p, True)
+    kept = (data_grad != 0).astype('float32')
+    assert 0.4 < kept.mean().asscalar() < 0.8
+    assert_almost_equal(data_grad, res_grad * kept / (1 - p), rtol=1e-4, atol=1e-5)
+    ref_out = mx.nd.LayerNorm(residual + data * kept / (1 - p), gamma, beta, axis=-1, eps=1e-5)
+    assert_almost_equal(out, ref_out, rtol=1e-4, atol=1e-5)
+
+
+def test_fp8_fully_connected():
+    def fp8_round(x, mantissa_bits, min_exponent, max_value):
+        a = np.abs(x).astype(np.float64)
+        exponent = np.maximum(np.floor(np.log2(np.maximum(a, 1e-30))), min_exponent)
+        step = 2.0 ** (exponent - mantissa_bits)
+        return np.sign(x) * np.minimum(np.round(a / step) * step, max_value)
+
+    def e4m3(x, scale):
+        return fp8_round(x * scale, 3, -6, 448.0) / scale
+
+    data = mx.nd.random.normal(scale=3, shape=(8, 2, 5))
+    weight = mx.nd.random.normal(scale=0.05, shape=(7, 10))
+    bias = mx.nd.random.normal(shape=(7,))
+    amax_history = mx.nd.zeros((2, 4))
+    scale = mx.nd.ones((2,))
+    ograd = mx.nd.random.normal(shape=(8, 7))
+    for arr in (data, weight, bias):
+        arr.attach_grad()
+
+    def run():
+        with mx.autograd.record():
+            out = mx.nd.contrib.fp8_fully_connected(data, weight, bias, amax_history, scale,
+                                                    num_hidden=7, amax_history_len=4)
+        out.backward(ograd)
+        return out
+
+    # without history the scales stay at one, the amax of this step gets recorded
+    out = run()
+    x, w = data.asnumpy().reshape(8, 10), weight.asnumpy()
+    expected = e4m3(x, 1.0).dot(e4m3(w, 1.0).T) + bias.asnumpy()
+    assert_almost_equal(out, expected, rtol=1e-5, atol=1e-5)
+    assert_almost_equal(amax_history[:, 0], np.array([np.abs(x).max(), np.abs(w).max()]))
+
+    # the next step scales with the recorded amax
+    out = run()
+    data_scale, weight_scale = 448.0 / np.abs(x).max(), 448.0 / np.abs(w).max()
+    assert_almost_equal(scale, np.array([data_scale, weight_scale]), rtol=1e-5, atol=0)
+    expected = e4m3(x, data_scale).dot(e4m3(w, weight_scale).T) + bias.asnumpy()
+    assert_almost_equal(out, expected, rtol=1e-5, atol=1e-5)
+
+    # the bias gradient is exact, the others go through the E5M2 gradient
+    g = ograd.asnumpy()
+    assert_almost_equal(bias.grad, g.sum(axis=0), rtol=1e-5, atol=1e-5)
+    grad_scale = 57344.0 / np.abs(g).max()
+    fp8_g = fp8_round(g * grad_scale, 2, -14, 57344.0) / grad_scale
+    assert_almost_equal(weight.grad, fp8_g.T.dot(e4m3(x, data_scale)), rtol=1e-4, atol=1e-4)
+    assert_almost_equal(data.grad.reshape((8, 10)), fp8_g.dot(e4m3(w, weight_scale)),
+                        rtol=1e-4, atol=1e-4)
+
+
 # Numpy Implementation of Sequence Ops
 def sequence_last_numpy(array, lengths, axis):
     # create new array of dims [batch, seqlen, ...]
@@ -4164,6 +4386,25 @@ def test_order():
                     is_ascend=True)])
 
 
+@pytest.mark.parametrize('k', [1, 4, 40])
+@pytest.mark.parametrize('is_ascend', [True, False])
+@pytest.mark.parametrize('axis', [-1, 0])
+def test_topk_small_k(k, is_ascend, axis):
+    # k much smaller than the axis takes the selection path; the values repeat
+    # so that the result also checks that ties are broken by index
+    shape = (3, 5000) if axis == -1 else (5000, 3)
+    a_npy = np.random.randint(0, 100, size=shape).astype(np.float32)
+    order = np.argsort(a_npy if is_ascend else -a_npy, axis=axis, kind='stable')
+    expected_idx = np.take(order, np.arange(k), axis=axis)
+    a = mx.nd.array(a_npy)
+    val, idx = mx.nd.topk(a, axis=axis, k=k, ret_typ='both', is_ascend=is_ascend, dtype='int64')
+    assert_almost_equal(val, np.take_along_axis(a_npy, expected_idx, axis=axis))
+    if default_device().device_type == 'cpu':
+        assert_almost_equal(idx, expected_idx)
+    mask = mx.nd.topk(a, axis=axis, k=k, ret_typ='mask', is_ascend=is_ascend)
+    assert mask.sum().asscalar() == k * 3
+
+
 def test_blockgrad():
     a = mx.sym.Variable('a')
     b = mx.sym.BlockGrad(a)
@@ -4957,6 +5198,17 @@ def test_softmax_with_large_inputs():
     softmax_forward(mx.nd.array([[[[-3.4e38,-3.4e38]]]]), np.array([1.0,1.0]))
     softmax_forward(mx.nd.array([[[[3.4e38,3.4e38]]]]), np.array([1.0,1.0]))
 
+def test_softmax_online_normalizer():
+    # a large row that starts with masked out entries exercises the rescaling of the running sum
+    data = np.random.uniform(-10, 10, size=(3, 100003)).astype(np.float32)
+    data[:, :5] = -np.inf
+    data[1, -1] = 30
+    expected = np_softmax(data, axis=-1)
+    assert_almost_equal(mx.nd.softmax(mx.nd.array(data), axis=-1), expected, rtol=1e-4, atol=1e-7)
+    log_out = mx.nd.log_softmax(mx.nd.array(data), axis=-1).asnumpy()
+    assert_almost_equal(log_out[:, 5:], np.log(expected[:, 5:]), rtol=1e-4, atol=1e-4)
+    assert np.all(np.isneginf(log_out[:, :5]))
+
 @with_environment('MXNET_SAFE_ACCUMULATION', '1')
 def test_softmax_dtype():
     def check_dtypes_almost_equal(op_name,
@@ -5371,6 +5623,30 @@ def test_index_copy():
     assert same(x.grad.asnumpy(), x_grad.asnumpy())
     assert same(t.grad.asnumpy(), t_grad.asnumpy())
 
+    if default_device().device_type == 'cpu':
+        with pytest.raises(MXNetError):
+            mx.nd.contrib.index_copy(x, mx.nd.array([0, 5, 2], dtype=np.int64), t).wait_to_read()
+
+
+@pytest.mark.parametrize('dtype', ['float16', 'float32', 'int8', 'float64'])
+@pytest.mark.parametrize('row_shape', [(1,), (3,), (4, 5), (64,)])
+def test_gather_scatter_rows(dtype, row_shape):
+    # rows of various byte sizes, so that every load width of the row copies is used
+    data = np.random.uniform(-10, 10, size=(6, 7) + row_shape).astype(dtype)
+    indices = np.array([[5, 0, 2, 5, -1], [6, 0, 3, 1, -7]], dtype=np.int32)
+    expected = data[indices[0], indices[1]]
+    out = mx.nd.gather_nd(mx.nd.array(data, dtype=dtype), mx.nd.array(indices, dtype='int32'))
+    assert same(out.asnumpy(), expected)
+    taken = mx.nd.take(mx.nd.array(data, dtype=dtype), mx.nd.array([5, 0, 2, 9], dtype='int32'),
+                       mode='wrap')
+    assert same(taken.asnumpy(), data[[5, 0, 2, 3]])
+    scatter_idx = np.array([[5, 0, 2], [6, 0, 3]], dtype=np.int32)
+    scattered = mx.nd.scatter_nd(mx.nd.array(expected[:3], dtype=dtype),
+                                 mx.nd.array(scatter_idx, dtype='int32'), shape=data.shape)
+    ref = np.zeros(data.shape, dtype=dtype)
+    ref[scatter_idx[0], scatter_idx[1]] = expected[:3]
+    assert same(scattered.asnumpy(), ref)
+
 
 def test_boolean_mask():
     data = mx.nd.array([[1, 2, 3],[4, 5, 6],[7, 8, 9]])
@@ -5427,6 +5703,63 @@ def test_boolean_mask():
     assert same(c.asnumpy(), a_np[ci.asnumpy().astype('bool')])
 
 
+def test_boolean_mask_bounded():
+    data = mx.nd.array([[1, 2, 3],[4, 5, 6],[7, 8, 9]])
+    index = mx.nd.array([0, 1, 1])
+    data.attach_grad()
+    with mx.autograd.record():
+        out, num = mx.nd.contrib.boolean_mask_bounded(data, index, fill_value=-1)
+        loss = (out * mx.nd.array([[1], [2], [3]])).sum()
+    loss.backward()
+    assert num.dtype == np.int64
+    assert same(num.asnumpy(), np.array([2]))
+    assert same(out.asnumpy(), np.array([[4, 5, 6], [7, 8, 9], [-1, -1, -1]]))
+    assert same(out[:int(num.asscalar())].asnumpy(),
+                mx.nd.contrib.boolean_mask(data, index).asnumpy())
+    # the padding rows get no gradient
+    assert same(data.grad.asnumpy(), np.array([[0, 0, 0], [1, 1, 1], [2, 2, 2]]))
+
+    # the outputs keep static shapes in a hybridized block
+    class Masked(mx.gluon.HybridBlock):
+        def hybrid_forward(self, F, x, mask):
+            out, num = F.contrib.boolean_mask_bounded(x, mask)
+            return out * 2, num
+
+    block = Masked()
+    block.hybridize(static_alloc=True, static_shape=True)
+    for _ in range(2):
+        a = mx.nd.random.uniform(shape=(20, 4))
+        mask = mx.nd.random.uniform(shape=(20,)) > 0.5
+        out, num = block(a, mask)
+        assert out.shape == (20, 4)
+        n = int(num.asscalar())
+        assert n == int(mask.sum().asscalar())
+        assert_allclose(out[:n].asnumpy(),
+                        a.asnumpy()[mask.asnumpy().astype('bool')] * 2)
+        assert same(out[n:].asnumpy(), np.zeros((20 - n, 4)))
+
+
+def test_multi_tensor_stats():
+    # one array over several chunks, a small one, one with non-finite values, an empty one
+    shapes = [(70000,), (3, 4), (5, 6), (0, 3)]
+    for dtype in ['float16', 'float32', 'float64']:
+        arrays = [np.random.normal(size=shape).astype(dtype) for shape in shapes]
+        arrays[2][1, 2] = np.nan
+        arrays[2][3, 4] = np.inf
+        stats = mx.nd.multi_tensor_stats(*[mx.nd.array(a, dtype=dtype) for a in arrays],
+                                         num_arrays=len(arrays))
+        assert stats.shape == (len(arrays), 5)
+        assert stats.dtype == np.float32
+        stats = stats.asnumpy()
+        for a, row in zip(arrays[:3], stats):
+            finite = a[np.isfinite(a)].astype(np.float64)
+            expected = [finite.min(), finite.max(), finite.mean(),
+                        np.sqrt((finite ** 2).sum()), a.size - finite.size]
+            assert_almost_equal(row, np.array(expected), rtol=1e-3, atol=1e-3)
+        assert np.isnan(stats[3, :3]).all()
+        assert_almost_equal(stats[3, 3:], np.zeros(2))
+
+
 def test_div_sqrt_dim():
     data_tmp = np.random.normal(0, 1, (5, 10, 8))
     data = mx.symbol.Variable('data')
@@ -5810,6 +6143,20 @@ def test_custom_op_exc():
         pytest.raises(MXNetError, custom_exc4)
 
 
+def test_custom_op_priority():
+    def f(in_data, out_data):
+        out_data[0][:] = mx.nd.dot(in_data[0], in_data[1])
+    _build_dot_custom(f, 'DotPriority')
+    a = mx.nd.ones((2, 3))
+    b = mx.nd.ones((3, 4))
+    c = mx.nd.Custom(a, b, op_type='DotPriority', __priority__=-2)
+    assert_almost_equal(c, 3 * np.ones((2, 4)))
+    # the attribute is validated, not thrown out of std::stoi
+    for priority in ['high', '2x', '']:
+        with pytest.raises(MXNetError):
+            mx.nd.Custom(a, b, op_type='DotPriority', __priority__=priority).wait_to_read()
+
+
 def test_psroipooling():
     for num_rois in [1, 2]:
         for num_classes, num_group in itertools.product([2, 3], [2, 3]):
@@ -5897,6 +6244,61 @@ def test_deformable_convolution(num_batch, num_channel_data_deformable_group, in
                                grad_nodes=grad_nodes, ctx=mx.gpu(0), numeric_eps=1.0/64)
 
 
+@mx.util.use_np
+def test_deformable_convolution_row_bands():
+    # workspace=0 leaves room for a single output row in the column buffer, so that the op
+    # runs in bands of rows, which should match a single column buffer of the whole image
+    im_data = mx.np.random.uniform(size=(2, 4, 7, 6))
+    offset = mx.np.random.uniform(-1, 1, size=(2, 2 * 3 * 3 * 2, 7, 6))
+    weight = mx.np.random.normal(0, 0.1, size=(8, 4, 3, 3))
+    bias = mx.np.random.normal(size=(8,))
+    out_grad = mx.np.random.normal(size=(2, 8, 7, 6))
+    results = []
+    for workspace in [1024, 0]:
+        args = [a.copy() for a in (im_data, offset, weight, bias)]
+        for a in args:
+            a.attach_grad()
+        with mx.autograd.record():
+            out = mx.npx.deformable_convolution(data=args[0], offset=args[1], weight=args[2],
+                                                bias=args[3], kernel=(3, 3), pad=(1, 1),
+                                                num_filter=8, num_deformable_group=2,
+                                                workspace=workspace)
+        out.backward(out_grad)
+        results.append([out] + [a.grad for a in args])
+    for full, banded in zip(*results):
+        assert_almost_equal(full, banded, rtol=1e-4, atol=1e-5)
+
+
+def test_modulated_deformable_convolution_row_bands():
+    # as above, with the masks, and with the columns of several images kept at once or not
+    im_data = mx.np.random.uniform(size=(2, 4, 7, 6))
+    offset = mx.np.random.uniform(-1, 1, size=(2, 2 * 3 * 3 * 2, 7, 6))
+    mask = mx.np.random.uniform(size=(2, 2 * 3 * 3, 7, 6))
+    weight = mx.np.random.normal(0, 0.1, size=(8, 4, 3, 3))
+    bias = mx.np.random.normal(size=(8,))
+    out_grad = mx.np.random.normal(size=(2, 8, 7, 6))
+    # the backward is only implemented on GPU
+    backward = default_device().device_type == 'gpu'
+    results = []
+    for workspace, im2col_step in [(1024, 2), (0, 2), (0, 1)]:
+        args = [a.copy() for a in (im_data, offset, mask, weight, bias)]
+        for a in args:
+            a.attach_grad()
+        with mx.autograd.record(train_mode=backward):
+            out = mx.npx.modulated_deformable_convolution(
+                data=args[0], offset=args[1], mask=args[2], weight=args[3], bias=args[4],
+                kernel=(3, 3), pad=(1, 1), num_filter=8, num_deformable_group=2,
+                workspace=workspace, im2col_step=im2col_step)
+        if backward:
+            out.backward(out_grad)
+            results.append([out] + [a.grad for a in args])
+        else:
+            results.append([out])
+    for full, banded, single in zip(*results):
+        assert_almost_equal(full, banded, rtol=1e-4, atol=1e-5)
+        assert_almost_equal(full, single, rtol=1e-4, atol=1e-5)
+
+
 def _validate_sample_location(input_rois, input_offset, spatial_scale, pooled_w, pooled_h, sample_per_part, part_size, output_dim, num_classes, trans_std, feat_h, feat_w):
     num_rois = input_rois.shape[0]
     output_offset = input_offset.copy()
@@ -6636,6 +7038,35 @@ def test_laop_6():
     check_fw(test_logabsdet, [a], [r2])
     check_grad(test_logabsdet, [a])
 
+# Batches of small matrices are factored by mxnet's own kernels instead of LAPACK on cpu
+@pytest.mark.parametrize('n', [1, 4, 17, 32, 33])
+@pytest.mark.parametrize('dtype', [np.float32, np.float64])
+def test_laop_small_batch(n, dtype):
+    batch = 257
+    rtol, atol = (1e-3, 1e-3) if dtype == np.float32 else (1e-8, 1e-8)
+    r = np.random.uniform(-1, 1, (batch, n, n))
+    spd = np.matmul(r, r.transpose(0, 2, 1)) + n * np.eye(n)
+    chol = np.linalg.cholesky(spd)
+    for lower in [True, False]:
+        expected = chol if lower else chol.transpose(0, 2, 1)
+        out = mx.nd.linalg.potrf(mx.nd.array(spd, dtype=dtype), lower=lower)
+        assert_almost_equal(out.asnumpy(), expected, rtol=rtol, atol=atol)
+        out = mx.nd.linalg.potri(mx.nd.array(expected, dtype=dtype), lower=lower)
+        assert_almost_equal(out.asnumpy(), np.linalg.inv(spd), rtol=rtol, atol=atol)
+    a = r + n * np.eye(n)
+    a[::2] = a[::2, ::-1]
+    out = mx.nd.linalg.inverse(mx.nd.array(a, dtype=dtype))
+    assert_almost_equal(out.asnumpy(), np.linalg.inv(a), rtol=rtol, atol=atol)
+    x = mx.nd.array(a, dtype=dtype)
+    x.attach_grad()
+    with mx.autograd.record():
+        out = mx.nd.linalg.det(x)
+    out.backward()
+    det = np.linalg.det(a)
+    assert_almost_equal(out.asnumpy(), det, rtol=rtol, atol=atol)
+    expected_grad = det[:, None, None] * np.linalg.inv(a).transpose(0, 2, 1)
+    assert_almost_equal(x.grad.asnumpy(), expected_grad, rtol=rtol, atol=atol)
+
 def test_stack():
     for _ in range(100):
         ndim = random.randint(1, 5)
@@ -6784,6 +7215,9 @@ def test_dropout():
     check_dropout_ratio(1.0, shape, cudnn_off=False)
     check_dropout_ratio(0.75, shape, cudnn_off=False)
     check_dropout_ratio(0.25, shape, cudnn_off=False)
+    # the mask holds one bit per element, also when the size is not a multiple of 8
+    check_dropout_ratio(0.5, (37, 91))
+    check_dropout_ratio(0.5, (37, 91), cudnn_off=False)
 
     check_passthrough(0.5, shape)
     check_passthrough(0.0, shape)
@@ -7421,6 +7855,21 @@ def test_bilinear_resize_op():
         if mode == 'like':
             return data1, np.zeros_like(incoming_grads)
         return [data1]
+    def check_bilinear_resize_nhwc_op(shape, height, width, align_corners):
+        x = mx.nd.random.uniform(shape=shape)
+        ograd = mx.nd.random.uniform(-1, 1, shape=shape[:2] + (height, width))
+        x_nhwc = x.transpose((0, 2, 3, 1))
+        results = []
+        for data, layout in [(x, 'NCHW'), (x_nhwc, 'NHWC')]:
+            data.attach_grad()
+            with mx.autograd.record():
+                y = mx.nd.contrib.BilinearResize2D(data, height=height, width=width,
+                                                   align_corners=align_corners, layout=layout)
+            y.backward(ograd if layout == 'NCHW' else ograd.transpose((0, 2, 3, 1)))
+            results.append((y, data.grad))
+        (y, dx), (y_nhwc, dx_nhwc) = results
+        assert_almost_equal(y_nhwc.transpose((0, 3, 1, 2)), y, rtol=1e-5, atol=1e-6)
+        assert_almost_equal(dx_nhwc.transpose((0, 3, 1, 2)), dx, rtol=1e-5, atol=1e-5)
     def check_bilinear_resize_op(shape, height, width):
         x = mx.nd.random.uniform(shape=shape)
         y = mx.nd.contrib.BilinearResize2D(x, height=height, width=width)
@@ -7545,6 +7994,10 @@ def test_bilinear_resize_op():
     check_bilinear_resize_modes_op(shape_0, shape_1=shape_1, mode='like')
     check_bilinear_resize_modes_op(shape_1, shape_1=shape_0, mode='like')
     check_bilinear_resize_align_corners_op()
+    for align_corners in [True, False]:
+        check_bilinear_resize_nhwc_op((2, 5, 10, 10), 10, 10, align_corners)
+        check_bilinear_resize_nhwc_op((2, 5, 10, 10), 3, 7, align_corners)
+        check_bilinear_resize_nhwc_op((1, 17, 9, 12), 20, 31, align_corners)
 
 def test_multi_proposal_op():
     # paramters
@@ -7804,6 +8257,20 @@ def test_histogram():
         assert_almost_equal(np_histo2, executor2.outputs[0].asnumpy(), 0, 0, ("EXPECTED_histo2", "FORWARD_histo2"), equal_nan=False)
 
 
+@pytest.mark.parametrize('bin_cnt', [7, 1000, 100000])
+def test_histogram_large(bin_cnt):
+    # counted into per-thread bins, or bucketed by bin range when there are many bins
+    x = np.random.normal(0, 1, size=(1000, 500))
+    mx_histo, mx_bins = mx.nd.histogram(mx.nd.array(x, dtype=np.float64), bins=bin_cnt, range=(-3, 3))
+    np_histo, np_bins = np.histogram(x, bins=bin_cnt, range=(-3, 3))
+    assert_almost_equal(mx_bins, np_bins)
+    assert same(mx_histo.asnumpy(), np_histo)
+    bounds = np.sort(np.random.uniform(-4, 4, size=bin_cnt + 1))
+    mx_histo, _ = mx.nd.histogram(mx.nd.array(x, dtype=np.float64),
+                                  bins=mx.nd.array(bounds, dtype=np.float64))
+    np_histo, _ = np.histogram(x, bins=bounds)
+    assert same(mx_histo.asnumpy(), np_histo)
+
 @pytest.mark.skip(reason="test fails intermittently. temporarily disabled till it gets fixed. tracked at https://github.com/apache/mxnet/issues/13915")
 def test_activation():
     shapes = [(9,), (9, 10), (9, 10, 10), (1, 9, 10, 10)]
@@ -8088,6 +8555,37 @@ def test_op_roi_align():
     test_roi_align_value(position_sensitive=True)
     test_roi_align_autograd()
 
+
+def test_op_multi_level_roi_align():
+    ctx = default_context()
+    scales = (0.25, 0.125, 0.0625, 0.03125)
+    levels = [mx.nd.random.uniform(shape=(2, 3, 128 // 2 ** l, 96 // 2 ** l), ctx=ctx)
+              for l in range(len(scales))]
+    # sizes around the canonical scale of 224 at level 4
+    rois = mx.nd.array([[0, 10, 10, 40, 50],
+                        [1, 0, 0, 100, 120],
+                        [0, 30, 20, 300, 250],
+                        [1, 5, 5, 500, 480],
+                        [-1, 5, 5, 50, 50],
+                        [1, 20, 10, 21, 11]], ctx=ctx)
+    for aligned in [False, True]:
+        out = mx.nd.contrib.MultiLevelROIAlign(rois, *levels, pooled_size=(7, 7),
+                                               spatial_scales=scales, sample_ratio=2,
+                                               aligned=aligned)
+        assert out.shape == (rois.shape[0], 3, 7, 7)
+        for i, roi in enumerate(rois.asnumpy()):
+            if roi[0] < 0:
+                assert_almost_equal(out[i].asnumpy(), np.zeros((3, 7, 7)))
+                continue
+            size = np.sqrt((roi[3] - roi[1]) * (roi[4] - roi[2]))
+            level = int(np.floor(4 + np.log2(size / 224 + 1e-6)))
+            l = min(max(level - 2, 0), len(scales) - 1)
+            expected = mx.nd.contrib.ROIAlign(levels[l], mx.nd.array(roi[None], ctx=ctx),
+                                              pooled_size=(7, 7), spatial_scale=scales[l],
+                                              sample_ratio=2, aligned=aligned)
+            assert_almost_equal(out[i].asnumpy(), expected[0].asnumpy(), rtol=1e-5, atol=1e-5)
+
+
 def test_op_rroi_align():
     T = np.float32
 
@@ -8440,6 +8938,9 @@ def test_softmax_cross_entropy():
     np_one_hot_label = np.zeros((batch_size, num_labels))
     np_one_hot_label[np.arange(batch_size), np_label] = 1.
     check_symbolic_forward(sym, {'data' : np_data, 'label' : np_label}, [np.array([f_sm_ce(np_sm, np_one_hot_label)])], rtol=1e-3, atol=1e-5)
+    check_symbolic_backward(sym, {'data' : np_data, 'label' : np_label}, [np.array([2.])],
+                            {'data' : 2. * (np_sm - np_one_hot_label)}, rtol=1e-3, atol=1e-5,
+                            grad_req={'data' : 'write', 'label' : 'null'})
 
 
 def test_split_v2():
@@ -8487,6 +8988,20 @@ def test_moments():
         check_numeric_gradient(mx_test_sym, [np_a], numeric_eps=eps, rtol=1e-2, atol=2e-4)
 
 
+@pytest.mark.parametrize('dtype', ['float16', 'float32'])
+@pytest.mark.parametrize('shape,axes', [
+    ((4, 100000), (1,)), ((2, 3, 50000), (0, 2)), ((100000, 8), (0,)), ((64, 256), (1,)),
+])
+def test_moments_large_offset(dtype, shape, axes):
+    # the mean is much larger than the spread, which a sum of squares loses in low precision
+    np_a = (100 + np.random.uniform(-1.0, 1.0, shape)).astype(dtype)
+    mx_mean, mx_var = mx.nd.moments(mx.nd.array(np_a, dtype=dtype), axes=axes)
+    np_a = np_a.astype(np.float64)
+    rtol = 1e-2 if dtype == 'float16' else 1e-4
+    assert_almost_equal(mx_mean, np_a.mean(axis=axes), rtol=rtol, atol=1e-3)
+    assert_almost_equal(mx_var, np_a.var(axis=axes), rtol=rtol, atol=1e-3)
+
+
 def test_invalid_kernel_size():
     invalid_kernel_size = 28
     assert_exception(
@@ -8650,6 +9165,58 @@ def test_image_normalize():
     # check backward using finite difference
     check_numeric_gradient(img_norm_sym, [data_in_4d], atol=0.001)
 
+def test_image_batch_preprocess():
+    def resize_bilinear(img, height, width):
+        # half pixel centers, without antialiasing
+        h, w = img.shape[:2]
+        sy = np.clip((np.arange(height) + 0.5) * h / height - 0.5, 0, h - 1)
+        sx = np.clip((np.arange(width) + 0.5) * w / width - 0.5, 0, w - 1)
+        y0, x0 = sy.astype(np.int64), sx.astype(np.int64)
+        y1, x1 = np.minimum(y0 + 1, h - 1), np.minimum(x0 + 1, w - 1)
+        ly, lx = (sy - y0)[:, None, None], (sx - x0)[None, :, None]
+        top = (1 - lx) * img[y0][:, x0] + lx * img[y0][:, x1]
+        bottom = (1 - lx) * img[y1][:, x0] + lx * img[y1][:, x1]
+        return (1 - ly) * top + ly * bottom
+
+    def reference(images, size, resize_short, flip, mean, std):
+        out = []
+        for img, f in zip(images, flip):
+            img = img.astype(np.float64)
+            h, w = img.shape[:2]
+            if resize_short > 0:
+                if h < w:
+                    rh, rw = resize_short, w * resize_short // h
+                else:
+                    rh, rw = h * resize_short // w, resize_short
+            else:
+                rh, rw = size
+            resized = resize_bilinear(img, rh, rw)
+            top, left = (rh - size[0]) // 2, (rw - size[1]) // 2
+            crop = resized[top:top + size[0], left:left + size[1]]
+            if f:
+                crop = crop[:, ::-1]
+            out.append(((crop / 255.0 - mean) / std).transpose(2, 0, 1))
+        return np.stack(out)
+
+    mean, std = np.array([0.485, 0.456, 0.406]), np.array([0.229, 0.224, 0.225])
+    for dtype in ['uint8', 'float32']:
+        images = [np.random.uniform(0, 255, shape).astype(dtype)
+                  for shape in [(30, 40, 3), (17, 9, 3), (8, 8, 3)]]
+        flip = (0, 1, 1)
+        out = mx.nd.image.batch_preprocess(*[mx.nd.array(img, dtype=dtype) for img in images],
+                                           size=(12, 10), flip=flip, mean=mean, std=std)
+        assert out.dtype == np.float32
+        assert_almost_equal(out, reference(images, (10, 12), 0, flip, mean, std),
+                            rtol=1e-4, atol=1e-4)
+        out = mx.nd.image.batch_preprocess(*[mx.nd.array(img, dtype=dtype) for img in images],
+                                           size=6, resize_short=8, mean=mean, std=std)
+        assert_almost_equal(out, reference(images, (6, 6), 8, (0, 0, 0), mean, std),
+                            rtol=1e-4, atol=1e-4)
+    # the crop must fit in the resized images
+    assert_exception(lambda: mx.nd.image.batch_preprocess(
+        mx.nd.ones((8, 16, 3)), size=12, resize_short=8).wait_to_read(), MXNetError)
+
+
 @pytest.mark.serial
 def test_index_array():
     def test_index_array_default():
@@ -9222,6 +9789,80 @@ def test_multihead_attention_encdec():
     for dtype in dtypes:
         check_multihead_attention_encdec(dtype=dtype)
 
+@assert_raises_cuda_not_satisfied(min_version='9.1')
+@pytest.mark.parametrize('causal', [False, True])
+@pytest.mark.parametrize('use_length', [False, True])
+def test_interleaved_fused_selfatt(causal, use_length):
+    dtypes = ['float32']
+    if default_device().device_type == 'gpu':
+        dtypes += ['float16']
+    seq_length, batch_size, num_heads, head_dim = 37, 3, 2, 24
+    valid_length = mx.nd.array([seq_length, 1, 20], dtype='int32')
+    mask = np.ones((batch_size, seq_length, seq_length))
+    if causal:
+        mask = np.tril(mask)
+    if use_length:
+        for b, length in enumerate(valid_length.asnumpy()):
+            mask[b, :, length:] = 0
+    mask = np.repeat(mask, num_heads, axis=0)
+
+    for dtype in dtypes:
+        qkv = mx.nd.random.uniform(-1, 1, shape=(seq_length, batch_size, 3 * num_heads * head_dim),
+                                   dtype=dtype)
+        ograd = mx.nd.random.uniform(-1, 1, shape=(seq_length, batch_size, num_heads * head_dim),
+                                     dtype=dtype)
+        qkv.attach_grad()
+        with mx.autograd.record():
+            inputs = [qkv, valid_length] if use_length else [qkv]
+            out = mx.nd.contrib.interleaved_fused_selfatt(*inputs, heads=num_heads, causal=causal,
+                                                          use_length=use_length)
+        out.backward(ograd)
+        grad = qkv.grad.asnumpy()
+
+        with mx.autograd.record():
+            att = mx.nd.contrib.interleaved_matmul_selfatt_qk(qkv, heads=num_heads)
+            att = mx.nd.softmax(att + mx.nd.array((mask - 1) * 1e4, dtype=dtype), axis=-1)
+            expected = mx.nd.contrib.interleaved_matmul_selfatt_valatt(qkv, att, heads=num_heads)
+        expected.backward(ograd)
+        rtol, atol = (1e-2, 1e-2) if dtype == 'float16' else (1e-4, 1e-4)
+        assert_almost_equal(out, expected, rtol=rtol, atol=atol)
+        assert_almost_equal(grad, qkv.grad, rtol=rtol, atol=atol)
+
+
+def test_interleaved_decode_selfatt():
+    seq_length, batch_size, num_heads, head_dim, page_size = 11, 3, 2, 8, 4
+    prefix = np.array([0, 3, 6])
+    max_pages = (seq_length + page_size - 1) // page_size
+    num_pages = batch_size * max_pages + 1
+    qkv = np.random.uniform(-1, 1, size=(seq_length, batch_size, 3 * num_heads * head_dim))
+    expected = mx.nd.contrib.interleaved_fused_selfatt(mx.nd.array(qkv), heads=num_heads,
+                                                       causal=True).asnumpy()
+    pages = np.random.permutation(num_pages)[:batch_size * max_pages]
+    pages = pages.reshape(batch_size, max_pages)
+    # the cached prefixes of the sequences hold their first tokens
+    kv = qkv.reshape(seq_length, batch_size, num_heads, 3, head_dim)[:, :, :, 1:, :]
+    kv = kv.transpose(0, 1, 3, 2, 4).reshape(seq_length, batch_size, 2, -1)
+    cache = np.zeros((num_pages, 2, page_size, num_heads * head_dim))
+    for b in range(batch_size):
+        for t in range(prefix[b]):
+            cache[pages[b, t // page_size], :, t % page_size] = kv[t, b]
+    kv_cache = mx.nd.array(cache)
+    page_table = mx.nd.array(pages, dtype='int32')
+
+    for step in range(seq_length - prefix.max()):
+        positions = prefix + step
+        step_qkv = mx.nd.array(qkv[positions, np.arange(batch_size)][np.newaxis])
+        cache_length = mx.nd.array(positions, dtype='int32')
+        out = mx.nd.contrib.interleaved_decode_selfatt(step_qkv, kv_cache, page_table, cache_length,
+                                                       heads=num_heads)
+        assert out.shape == (1, batch_size, num_heads * head_dim)
+        assert_almost_equal(out.asnumpy()[0], expected[positions, np.arange(batch_size)],
+                            rtol=1e-4, atol=1e-4)
+    for b in range(batch_size):
+        for t in range(seq_length - prefix.max() + prefix[b]):
+            assert_almost_equal(kv_cache.asnumpy()[pages[b, t // page_size], :, t % page_size],
+                                kv[t, b], rtol=1e-5, atol=1e-5)
+
 @pytest.mark.serial
 def test_im2col_col2im():
     def compute_output_size(spatial, kernel, stride=1, dilate=1, pad=0):
@@ -858,6 +858,129 @@ def test_sparse_adagrad():
                                   g_stype='row_sparse')
 
 
+@pytest.mark.parametrize('op,num_states,kwargs', [
+    ('signsgd_update', 0, {}),
+    ('signum_update', 1, {'momentum': 0.9, 'wd_lh': 0.01}),
+    ('nag_mom_update', 1, {'momentum': 0.9}),
+    ('rmsprop_update', 1, {'clip_weights': 0.8}),
+    ('rmspropalex_update', 3, {}),
+    ('ftml_update', 3, {'t': 2}),
+    ('mp_sgd_update', 1, {}),
+    ('mp_sgd_mom_update', 2, {'momentum': 0.9}),
+    ('mp_nag_mom_update', 2, {'momentum': 0.9}),
+])
+@pytest.mark.parametrize('w_stype', ['default', 'row_sparse'])
+def test_lazy_row_sparse_update(op, num_states, kwargs, w_stype):
+    # the lazy update of a row_sparse gradient only touches the rows it holds,
+    # which get the same update as the dense op applied to these rows alone
+    shape = (20, 8)
+    rows = np.array([1, 5, 6, 17])
+    mp = op.startswith('mp_')
+    dtype = np.float16 if mp else np.float32
+    weight = np.random.uniform(-1, 1, shape).astype(dtype)
+    grad = np.random.uniform(-1, 1, (len(rows), shape[1])).astype(dtype)
+    states = [np.random.uniform(0.1, 0.5, shape).astype(np.float32 if mp else dtype)
+              for _ in range(num_states)]
+    if op == 'rmspropalex_update':
+        states[1] += 1  # n >= g * g
+    if mp:
+        states[-1] = weight.astype(np.float32)
+    kwargs = dict(kwargs, lr=0.1, wd=0.05, rescale_grad=0.9, clip_gradient=0.6)
+    if op == 'ftml_update':
+        kwargs['clip_grad'] = kwargs.pop('clip_gradient')
+
+    expected_w = mx.nd.array(weight[rows], dtype=dtype)
+    expected_states = [mx.nd.array(s[rows], dtype=s.dtype) for s in states]
+    getattr(mx.nd, op)(expected_w, mx.nd.array(grad, dtype=dtype), *expected_states,
+                       out=expected_w, **kwargs)
+
+    w = mx.nd.array(weight, dtype=dtype).tostype(w_stype)
+    g = mx.nd.sparse.row_sparse_array((grad, rows), shape=shape, dtype=dtype)
+    nd_states = [mx.nd.array(s, dtype=s.dtype).tostype(w_stype) for s in states]
+    getattr(mx.nd, op)(w, g, *nd_states, out=w, **kwargs)
+
+    others = np.setdiff1d(np.arange(shape[0]), rows)
+    assert w.stype == w_stype
+    assert_almost_equal(w.asnumpy()[rows], expected_w.asnumpy(), rtol=1e-3, atol=1e-3)
+    assert_almost_equal(w.asnumpy()[others], weight[others])
+    for state, expected, orig in zip(nd_states, expected_states, states):
+        assert_almost_equal(state.asnumpy()[rows], expected.asnumpy(), rtol=1e-3, atol=1e-3)
+        assert_almost_equal(state.asnumpy()[others], orig[others])
+
+
+@pytest.mark.parametrize('op,single_op,stride', [
+    ('multi_sgd_update', 'sgd_update', 2),
+    ('multi_sgd_mom_update', 'sgd_mom_update', 3),
+    ('multi_mp_sgd_update', 'mp_sgd_update', 3),
+    ('multi_mp_sgd_mom_update', 'mp_sgd_mom_update', 4),
+])
+def test_multi_sgd_lazy_row_sparse_update(op, single_op, stride):
+    # a row_sparse gradient gets the lazy update of the single tensor op,
+    # while the weights with a dense gradient keep the fused update
+    shapes = [(10, 4), (7, 3), (12, 5)]
+    g_stypes = ['row_sparse', 'default', 'row_sparse']
+    mp = 'mp' in op
+    dtype = np.float16 if mp else np.float32
+    kwargs = {'rescale_grad': 0.9, 'clip_gradient': 0.6}
+    if 'mom' in op:
+        kwargs['momentum'] = 0.9
+    lrs, wds = [0.1, 0.2, 0.3], [0.01, 0.02, 0.03]
+    inputs, expected = [], []
+    for shape, g_stype, lr, wd in zip(shapes, g_stypes, lrs, wds):
+        weight = mx.nd.random.uniform(-1, 1, shape).astype(dtype)
+        grad = mx.nd.random.uniform(-1, 1, shape).astype(dtype).tostype(g_stype)
+        if g_stype == 'row_sparse':
+            grad = mx.nd.sparse.retain(grad, mx.nd.array([0, 2, 3], dtype='int64'))
+        states = []
+        if 'mom' in op:
+            states.append(mx.nd.random.uniform(-1, 1, shape).astype(np.float32 if mp else dtype))
+        if mp:
+            states.append(weight.astype(np.float32))
+        inputs += [weight, grad] + states
+        ref = [x.copy() for x in [weight, grad] + states]
+        getattr(mx.nd, single_op)(*ref, out=ref[0], lr=lr, wd=wd, lazy_update=True, **kwargs)
+        expected.append(ref[0])
+    outs = inputs[::stride]
+    getattr(mx.nd, op)(*inputs, out=outs, lrs=lrs, wds=wds, num_weights=len(shapes), **kwargs)
+    for out, ref in zip(outs, expected):
+        assert_almost_equal(out, ref, rtol=1e-3, atol=1e-3)
+
+
+@pytest.mark.parametrize('op', ['adamw_update', 'mp_adamw_update',
+                                'adabelief_update', 'mp_adabelief_update'])
+@pytest.mark.parametrize('w_stype', ['default', 'row_sparse'])
+def test_contrib_lazy_row_sparse_update(op, w_stype):
+    # same as test_lazy_row_sparse_update, for the contrib ops taking rescale_grad as an array
+    shape = (20, 8)
+    rows = np.array([1, 5, 6, 17])
+    mp = op.startswith('mp_')
+    dtype = np.float16 if mp else np.float32
+    weight = np.random.uniform(-1, 1, shape).astype(dtype)
+    grad = np.random.uniform(-1, 1, (len(rows), shape[1])).astype(dtype)
+    states = [np.random.uniform(0.1, 0.5, shape).astype(np.float32) for _ in range(2)]
+    if mp:
+        states.append(weight.astype(np.float32))
+    kwargs = {'lr': 0.1, 'eta': 0.5, 'wd': 0.05, 'rescale_grad': 0.9, 'clip_gradient': 0.6}
+
+    expected_w = mx.nd.array(weight[rows], dtype=dtype)
+    expected_states = [mx.nd.array(s[rows]) for s in states]
+    getattr(mx.nd.contrib, op)(expected_w, mx.nd.array(grad, dtype=dtype), *expected_states,
+                               out=expected_w, **kwargs)
+
+    w = mx.nd.array(weight, dtype=dtype).tostype(w_stype)
+    g = mx.nd.sparse.row_sparse_array((grad, rows), shape=shape, dtype=dtype)
+    nd_states = [mx.nd.array(s).tostype(w_stype) for s in states]
+    getattr(mx.nd.contrib, op)(w, g, *nd_states, out=w, **kwargs)
+
+    others = np.setdiff1d(np.arange(shape[0]), rows)
+    assert w.stype == w_stype
+    assert_almost_equal(w.asnumpy()[rows], expected_w.asnumpy(), rtol=1e-3, atol=1e-3)
+    assert_almost_equal(w.asnumpy()[others], weight[others])
+    for state, expected, orig in zip(nd_states, expected_states, states):
+        assert_almost_equal(state.asnumpy()[rows], expected.asnumpy(), rtol=1e-3, atol=1e-3)
+        assert_almost_equal(state.asnumpy()[others], orig[others])
+
+
 def test_adadelta():
     opt1 = mx.optimizer.AdaDelta
     opt2 = mx.optimizer.AdaDelta
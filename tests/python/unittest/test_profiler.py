@@ -281,6 +281,215 @@ def test_aggregate_stats_sorting():
     profiler.set_state('stop')
 
 
+def test_aggregate_stats_openmetrics():
+    file_name = 'test_aggregate_stats_openmetrics.json'
+    enable_profiler(file_name, True, True, True)
+    inp = mx.nd.ones(shape=(10, 10))
+    for _ in range(4):
+        inp = mx.nd.sqrt(inp)
+    mx.nd.waitall()
+    text = profiler.dumps(format='openmetrics')
+    profiler.set_state('stop')
+    lines = text.strip().split('\n')
+    assert lines[-1] == '# EOF'
+    assert '# TYPE mxnet_profile_duration_microseconds summary' in lines
+    samples = {}
+    for line in lines:
+        if not line.startswith('#'):
+            name, value = line.rsplit(' ', 1)
+            samples[name] = float(value)
+    count = [v for k, v in samples.items()
+             if k.startswith('mxnet_profile_duration_microseconds_count{category="operator",'
+                             'name="sqrt')]
+    assert count and sum(count) >= 4
+    p50 = [v for k, v in samples.items() if 'name="sqrt' in k and 'quantile="0.5"' in k]
+    p99 = [v for k, v in samples.items() if 'name="sqrt' in k and 'quantile="0.99"' in k]
+    assert p50 and p99 and all(a <= b for a, b in zip(p50, p99))
+
+
+def test_aggregate_stats_op_cost():
+    file_name = 'test_aggregate_stats_op_cost.json'
+    enable_profiler(file_name, True, True, True)
+    profiler.dumps(reset=True)
+    batch, num_input, num_hidden = 64, 256, 128
+    data = mx.nd.ones((batch, num_input))
+    weight = mx.nd.ones((num_hidden, num_input))
+    bias = mx.nd.ones((num_hidden,))
+    for _ in range(2):
+        out = mx.nd.FullyConnected(data, weight, bias, num_hidden=num_hidden)
+    mx.nd.waitall()
+    text = profiler.dumps(format='openmetrics')
+    stats = json.loads(profiler.dumps(format='json'))
+    profiler.set_state('stop')
+    samples = {}
+    for line in text.strip().split('\n'):
+        if not line.startswith('#'):
+            name, value = line.rsplit(' ', 1)
+            samples[name] = float(value)
+    # a multiply-add per output element and input column, plus the bias
+    flops = 2 * batch * num_hidden * num_input + batch * num_hidden
+    nbytes = 4 * (batch * num_input + num_hidden * num_input + num_hidden + batch * num_hidden)
+    fc_flops = [v for k, v in samples.items()
+                if k.startswith('mxnet_operator_flops_total{name="FullyConnected')]
+    fc_bytes = [v for k, v in samples.items()
+                if k.startswith('mxnet_operator_bytes_total{name="FullyConnected')]
+    assert sum(fc_flops) == 2 * flops
+    assert sum(fc_bytes) == 2 * nbytes
+    fc_stats = [v for k, v in stats['Time']['operator'].items()
+                if k.startswith('FullyConnected')]
+    assert fc_stats and all('GFLOP/s' in v and 'GB/s' in v for v in fc_stats)
+
+
+def test_hw_counters():
+    file_name = 'test_hw_counters.json'
+    profiler.set_config(profile_imperative=True,
+                        profile_symbolic=False,
+                        profile_memory=False,
+                        profile_api=False,
+                        filename=file_name,
+                        hw_counters=True)
+    profiler.set_state('run')
+    inp = mx.nd.ones(shape=(100, 100))
+    for _ in range(4):
+        inp = mx.nd.sqrt(inp)
+    mx.nd.waitall()
+    profiler.set_state('stop')
+    profiler.dump(True)
+    with open(file_name) as f:
+        events = json.load(f)['traceEvents']
+    os.remove(file_name)
+    # the counters are missing where perf_event_open is not permitted, they come together
+    counted = [e['args'] for e in events if 'cycles' in e.get('args', {})]
+    for args in counted:
+        assert 'instructions' in args and 'llc_misses' in args
+        assert args['cycles'] > 0
+
+
+def test_step_breakdown():
+    profiler.set_config(profile_imperative=True,
+                        profile_symbolic=False,
+                        profile_memory=False,
+                        profile_api=False,
+                        filename='',
+                        step_report_period=2)
+    profiler.set_state('run')
+    reports = []
+    data = mx.nd.ones((16, 32))
+    weight = mx.nd.ones((8, 32))
+    weight.attach_grad()
+    for _ in range(4):
+        with mx.autograd.record():
+            out = mx.nd.FullyConnected(data, weight, no_bias=True, num_hidden=8)
+        out.backward()
+        mx.nd.sgd_update(weight, weight.grad, lr=0.1, out=weight)
+        mx.nd.waitall()
+        reports.append(profiler.mark_step())
+    profiler.set_state('stop')
+    profiler.set_config(filename='profile.json', step_report_period=0)
+    assert reports[0] is None and reports[2] is None
+    assert 'steps 1-2' in reports[1] and 'steps 3-4' in reports[3]
+    for phase in ['Data loading', 'H2D copy', 'Forward', 'Backward', 'KVStore', 'Optimizer',
+                  'Idle']:
+        assert phase in reports[3]
+
+
+def test_kvstore_comm_events():
+    file_name = 'test_kvstore_comm_events.json'
+    shape, key = (4, 8), 3
+    kv = mx.kv.create('local')
+    kv.init(key, mx.nd.zeros(shape))
+    grads = [mx.nd.ones(shape, ctx=mx.cpu(i)) for i in range(2)]
+    outs = [mx.nd.zeros(shape, ctx=mx.cpu(i)) for i in range(2)]
+    profiler.set_config(profile_imperative=True,
+                        profile_symbolic=False,
+                        profile_memory=False,
+                        profile_api=False,
+                        filename=file_name)
+    profiler.set_state('run')
+    kv.push(key, grads)
+    kv.pull(key, out=outs)
+    mx.nd.waitall()
+    profiler.set_state('stop')
+    profiler.dump(True)
+    with open(file_name) as f:
+        events = json.load(f)['traceEvents']
+    os.remove(file_name)
+    # the push reduces the gradients of the devices, the pull broadcasts the value to them
+    events = [e for e in events if e.get('cat') == 'kvstore']
+    starts = {e['name']: e['args'] for e in events if 'args' in e}
+    nbytes = 2 * 4 * 8 * 4
+    assert starts == {'KVStoreReduce': {'key': key, 'bytes': nbytes},
+                      'KVStoreBroadcast': {'key': key, 'bytes': nbytes}}
+    ids = [e['id'] for e in events]
+    assert all(ids.count(i) == 2 for i in ids)
+    assert (outs[1].asnumpy() == 2).all()
+
+def test_memory_timeline():
+    prefix = 'test_memory_timeline'
+    profiler.set_config(profile_imperative=True,
+                        profile_symbolic=False,
+                        profile_memory=True,
+                        profile_api=False,
+                        filename='test_memory_timeline.json',
+                        continuous_dump=False,
+                        memory_timeline_filename_prefix=prefix)
+    profiler.set_state('run')
+    data = mx.nd.ones((64, 256))
+    weight = mx.nd.ones((128, 256))
+    with profiler.scope('net:'):
+        out = mx.nd.FullyConnected(data, weight, no_bias=True, num_hidden=128)
+    out.wait_to_read()
+    profiler.set_state('stop')
+    profiler.dump(True)
+    profiler.set_config(filename='profile.json')
+    timeline_file = f'{prefix}-pid_{os.getpid()}.csv'
+    peak_file = f'{prefix}-pid_{os.getpid()}-peak.csv'
+    with open(timeline_file, mode='r') as csv_file:
+        events = list(csv.DictReader(csv_file))
+    with open(peak_file, mode='r') as csv_file:
+        peak = list(csv.DictReader(csv_file))
+    os.remove(timeline_file)
+    os.remove(peak_file)
+    os.remove('test_memory_timeline.json')
+    fc = [e for e in events if e['Attribute Name'] == 'net:FullyConnected']
+    assert fc and int(fc[0]['Size']) == 4 * 64 * 128
+    assert fc[0]['Role'] == 'activation'
+    # the role totals of a device add up to its peak, which holds the output
+    devices = set(row['Device'] for row in peak)
+    for device in devices:
+        totals = [int(row['Size']) for row in peak
+                  if row['Device'] == device and row['Attribute Name'] == '(total)']
+        peak_in_use = max(int(e['In Use']) for e in events if e['Device'] == device)
+        assert sum(totals) == peak_in_use
+    assert any(row['Attribute Name'] == 'net:FullyConnected' for row in peak)
+
+
+def test_sampled_aggregate_stats():
+    num_ops, sample_period = 32, 4
+    profiler.set_config(profile_symbolic=False,
+                        profile_imperative=True,
+                        profile_memory=False,
+                        profile_api=False,
+                        filename='',
+                        aggregate_stats=True,
+                        sample_period=sample_period,
+                        max_pending_records=1024)
+    profiler.set_state('run')
+    profiler.dumps(reset=True)
+    inp = mx.nd.zeros(shape=(10, 10))
+    for _ in range(num_ops):
+        inp = inp + 1
+    mx.nd.waitall()
+    target_dict = json.loads(profiler.dumps(format='json'))
+    profiler.set_state('stop')
+    profiler.set_config(sample_period=1, max_pending_records=0, filename='profile.json')
+    operators = target_dict['Time'].get('operator', {})
+    count = sum(stat['Count'] for name, stat in operators.items()
+                if name.startswith('_plus_scalar'))
+    # the pushing thread keeps one operator out of every sample_period
+    assert 0 < count <= num_ops // sample_period + 1
+
+
 @pytest.mark.skip(reason='https://github.com/apache/mxnet/issues/18564')
 def test_aggregate_duplication():
     file_name = 'test_aggregate_duplication.json'
@@ -22,7 +22,7 @@ import mxnet as mx
 from mxnet.test_utils import verify_generator, gen_buckets_probs_with_ppf, assert_almost_equal
 import numpy as np
 import random as rnd
-from common import retry, random_seed
+from common import retry, random_seed, run_in_spawned_process
 import scipy.stats as ss
 import unittest
 import pytest
@@ -939,6 +939,39 @@ def test_zipfian_generator():
     assert_almost_equal(exp_cnt_sampled, exp_cnt[sampled_classes], rtol=1e-1, atol=1e-2)
     assert_almost_equal(exp_cnt_true, exp_cnt[true_classes], rtol=1e-1, atol=1e-2)
 
+
+@pytest.mark.serial
+def test_unigram_candidate_sampler():
+    num_sampled = 100000
+    weights = mx.nd.array([0, 1, 2, 3, 4, 0, 10, 0.5], ctx=mx.cpu())
+    dist = weights.asnumpy() / weights.asnumpy().sum()
+    table = mx.nd.contrib.unigram_table(weights)
+    assert_almost_equal(table[2], dist, rtol=1e-5, atol=1e-7)
+    table = [t.as_in_context(mx.context.current_context()) for t in table]
+
+    true_classes = mx.nd.array([[6, 0], [3, 7]], dtype='int64')
+    samples, exp_cnt_true, exp_cnt_sampled = \
+        mx.nd.contrib.rand_unigram(true_classes, num_sampled, table)
+    samples = samples.asnumpy()
+    assert samples.shape == (num_sampled,)
+    assert exp_cnt_true.shape == (2, 2)
+    assert_almost_equal(exp_cnt_true, dist[true_classes.asnumpy()] * num_sampled, rtol=1e-5)
+    assert_almost_equal(exp_cnt_sampled, dist[samples] * num_sampled, rtol=1e-5)
+    # classes of weight 0 are never drawn, the others at their frequency
+    freq = np.bincount(samples, minlength=dist.size) / num_sampled
+    assert_almost_equal(freq, dist, rtol=0, atol=1e-2)
+    assert freq[dist == 0].sum() == 0
+
+    # symbol
+    true_classes_var = mx.sym.var('true_classes')
+    table_vars = [mx.sym.var(name) for name in ['accept', 'alias', 'dist']]
+    outputs = mx.sym.Group(mx.sym.contrib.rand_unigram(true_classes_var, 16, table_vars))
+    executor = outputs._bind(mx.context.current_context(),
+                             {'true_classes': true_classes, 'accept': table[0],
+                              'alias': table[1], 'dist': table[2]})
+    executor.forward()
+    assert_almost_equal(executor.outputs[2], dist[executor.outputs[0].asnumpy()] * 16, rtol=1e-5)
+
 # Issue #10277 (https://github.com/apache/mxnet/issues/10277) discusses this test.
 @pytest.mark.serial
 def test_shuffle():
@@ -1127,3 +1160,34 @@ def test_poisson_zero_size_dim():
 
     test_valid_zero_dim()
     test_invalid_zero_dim()
+
+def _draw_cpu_samples(seed, out_file):
+    mx.random.seed(1234)
+    normal = mx.nd.random.normal(loc=1, scale=2, shape=(1000, 1000), ctx=mx.cpu())
+    uniform = mx.nd.random.uniform(low=-1, high=3, shape=(1000, 1000), ctx=mx.cpu())
+    np.savez(out_file, normal=normal.asnumpy(), uniform=uniform.asnumpy())
+
+@pytest.mark.serial
+def test_cpu_random_seed_omp_threads(tmpdir):
+    """The CPU samples of a given seed must not depend on the number of OpenMP threads"""
+    samples = []
+    for num_threads in ['1', '4']:
+        out_file = os.path.join(str(tmpdir), 'samples_{}.npz'.format(num_threads))
+        if not run_in_spawned_process(_draw_cpu_samples, {'OMP_NUM_THREADS': num_threads},
+                                      out_file):
+            return
+        samples.append(np.load(out_file))
+    for name in ['normal', 'uniform']:
+        assert same(samples[0][name], samples[1][name])
+
+@pytest.mark.serial
+def test_cpu_random_moments():
+    """Mean and variance of the Philox based CPU samplers"""
+    shape = (1000, 1000)
+    normal = mx.nd.random.normal(loc=1, scale=2, shape=shape, ctx=mx.cpu()).asnumpy()
+    assert abs(normal.mean() - 1) < 0.01
+    assert abs(normal.var() - 4) < 0.05
+    uniform = mx.nd.random.uniform(low=-1, high=3, shape=shape, ctx=mx.cpu()).asnumpy()
+    assert uniform.min() >= -1 and uniform.max() < 3
+    assert abs(uniform.mean() - 1) < 0.01
+    assert abs(uniform.var() - 16. / 12) < 0.01
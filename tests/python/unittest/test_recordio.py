@@ -16,9 +16,12 @@
 # under the License.
 
 # pylint: skip-file
+import os
+import subprocess
 import sys
 import mxnet as mx
 import numpy as np
+import pytest
 import random
 import string
 
@@ -67,3 +70,47 @@ def test_recordio_pack_label():
             rheader, rcontent = mx.recordio.unpack(s)
             assert (label == rheader.label).all()
             assert content == rcontent
+
+def _find_im2rec():
+    base_path = os.path.join(os.path.dirname(__file__), '../../..')
+    for path in ['im2rec', os.path.join(base_path, 'build/im2rec')]:
+        if os.path.isfile(path):
+            return os.path.abspath(path)
+    return None
+
+@pytest.mark.skipif(_find_im2rec() is None, reason='im2rec is not built')
+def test_im2rec_threads_shards(tmpdir):
+    cv2 = pytest.importorskip('cv2')
+    N = 20
+    images = {}
+    with open(str(tmpdir.join('images.lst')), 'w') as lst:
+        for i in range(N):
+            img = np.random.randint(0, 256, size=(8 + i, 10, 3), dtype=np.uint8)
+            cv2.imwrite(str(tmpdir.join('{}.png'.format(i))), img)
+            lst.write('{}\t{}\t{}.png\n'.format(i, i % 3, i))
+            images[i] = img
+
+    def im2rec(output, *args):
+        subprocess.check_call([_find_im2rec(), str(tmpdir.join('images.lst')), str(tmpdir) + '/',
+                               str(tmpdir.join(output)), 'encoding=.png'] + list(args))
+
+    # the records are written in the order of the list, whatever the number of threads
+    im2rec('one.rec')
+    im2rec('threads.rec', 'num_thread=4')
+    with open(str(tmpdir.join('one.rec')), 'rb') as one, \
+         open(str(tmpdir.join('threads.rec')), 'rb') as threads:
+        assert one.read() == threads.read()
+
+    # every record is in exactly one shard, found through the index of the shard
+    im2rec('shards.rec', 'num_thread=4', 'num_shards=3')
+    keys = []
+    for k in range(3):
+        shard = str(tmpdir.join('shards.shard{:03d}'.format(k)))
+        reader = mx.recordio.MXIndexedRecordIO(shard + '.idx', shard + '.rec', 'r')
+        for key in reader.keys:
+            header, img = mx.recordio.unpack_img(reader.read_idx(key))
+            assert header.id == key and header.label == key % 3
+            assert (img == images[key]).all()
+        keys += reader.keys
+        reader.close()
+    assert sorted(keys) == list(range(N))
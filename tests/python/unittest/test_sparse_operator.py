@@ -1243,6 +1243,9 @@ def test_cast_storage_ex():
             # test gpu block  kernel
             check_cast_storage((dim0, rnd.randint(512, 1024)), d, 'default', 'row_sparse',
                                check_numeric_grad=False)
+        # test the parallel prefix sums of the cpu kernels
+        check_cast_storage((300000, 2), d, 'default', 'csr', check_numeric_grad=False)
+        check_cast_storage((300000, 2), d, 'default', 'row_sparse', check_numeric_grad=False)
 
 
 @pytest.mark.serial
@@ -1375,6 +1378,31 @@ def test_sparse_dot():
     test_sparse_dot_zero_output(rand_shape_2d(50, 200), False, 40)
     test_sparse_dot_zero_output(rand_shape_2d(50, 200), True, 40)
 
+@pytest.mark.parametrize('trans_lhs', [False, True])
+@pytest.mark.parametrize('out_stype', ['default', 'row_sparse'])
+@pytest.mark.parametrize('num_cols', [1, 37, 600])
+def test_sparse_dot_nnz_blocks(trans_lhs, out_stype, num_cols):
+    if out_stype == 'row_sparse' and not trans_lhs:
+        return
+    # a few dense rows among very sparse ones, and columns spanning several column blocks
+    lhs_np = np.random.uniform(-1, 1, size=(90, 70)) * (np.random.uniform(size=(90, 70)) < 0.03)
+    lhs_np[::17] = np.random.uniform(-1, 1, size=lhs_np[::17].shape)
+    lhs = mx.nd.array(lhs_np).tostype('csr')
+    rhs_np = np.random.uniform(-1, 1, size=(90 if trans_lhs else 70, num_cols))
+    rhs = mx.nd.array(rhs_np)
+    expected = np.dot(lhs_np.T if trans_lhs else lhs_np, rhs_np)
+    for nnz_blocks in ['0', '1']:
+        with environment('MXNET_CSR_DOT_NNZ_BLOCKS', nnz_blocks):
+            out = mx.nd.sparse.dot(lhs, rhs, transpose_a=trans_lhs, forward_stype=out_stype)
+            assert out.stype == out_stype
+            assert_almost_equal(out.tostype('default').asnumpy(), expected, rtol=1e-4, atol=1e-5)
+            if out_stype == 'default':
+                # the rows without non-zeros are overwritten too
+                out = mx.nd.ones(expected.shape)
+                mx.nd.sparse.dot(lhs, rhs, transpose_a=trans_lhs, out=out)
+                assert_almost_equal(out.asnumpy(), expected, rtol=1e-4, atol=1e-5)
+
+
 @pytest.mark.serial
 def test_sparse_dot_determinism():
     def check_dot_determinism(lhs_stype, rhs_stype, lhs_density, rhs_density, transpose_a, transpose_b, forward_stype):
@@ -1740,6 +1768,22 @@ def test_sparse_elementwise_sum():
             check_sparse_elementwise_sum_with_shape(stypes, shape, test_len+1)
 
 
+@pytest.mark.parametrize('num_rows,row_length', [(1, 3), (4000, 1), (3000, 17)])
+def test_sparse_elementwise_sum_rows(num_rows, row_length):
+    # enough rows for the sum to be split over several row ranges
+    shape = (num_rows, row_length)
+    rsps = [rand_ndarray(shape, 'row_sparse', density) for density in [0, 0.001, 0.05, 0.5, 1.0]]
+    out = mx.nd.sparse.add_n(*rsps)
+    assert out.stype == 'row_sparse'
+    assert_almost_equal(out.asnumpy(), sum(a.asnumpy() for a in rsps), atol=1e-5)
+    csr = rand_ndarray(shape, 'csr', 0.1)
+    dns = [mx.nd.random.uniform(shape=shape) for _ in range(2)]
+    for inputs in [[dns[0], csr, dns[1]], rsps + [csr] + dns]:
+        out = mx.nd.sparse.add_n(*inputs)
+        assert out.stype == 'default'
+        assert_almost_equal(out.asnumpy(), sum(a.asnumpy() for a in inputs), atol=1e-5)
+
+
 @pytest.mark.serial
 def test_sparse_embedding():
     ''' test sparse embedding operator '''
@@ -1790,6 +1834,70 @@ def test_sparse_embedding():
     for sparse_grad in sparse_grads:
         check_sparse_embedding(in_dim, out_dim, batch, densities, sparse_grad)
 
+
+@pytest.mark.parametrize('dtype', [np.float32, np.float64])
+def test_sparse_embedding_large_batch_backward(dtype):
+    # enough indices to spread the rows over the threads, with a few hot rows
+    in_dim, out_dim, batch = 100000, 16, (64, 97)
+    hot = np.random.randint(0, in_dim, size=8)
+    np_data = np.where(np.random.uniform(size=batch) < 0.3,
+                       hot[np.random.randint(0, len(hot), size=batch)],
+                       np.random.randint(0, in_dim, size=batch))
+    data = mx.nd.array(np_data, dtype=np.int64)
+    weight = mx.nd.random.uniform(shape=(in_dim, out_dim), dtype=dtype)
+    ograd = mx.nd.random.uniform(-1, 1, shape=batch + (out_dim,), dtype=dtype)
+    grads = []
+    for _ in range(2):
+        weight.attach_grad(stype='row_sparse')
+        with mx.autograd.record():
+            out = mx.nd.Embedding(data, weight, input_dim=in_dim, output_dim=out_dim,
+                                  sparse_grad=True)
+        out.backward(ograd)
+        grads.append(weight.grad)
+    rows = np.unique(np_data)
+    expected = np.zeros((in_dim, out_dim), dtype=dtype)
+    np.add.at(expected, np_data.reshape(-1), ograd.asnumpy().reshape(-1, out_dim))
+    assert grads[0].stype == 'row_sparse'
+    assert_almost_equal(grads[0].indices.asnumpy(), rows)
+    assert_almost_equal(grads[0].data.asnumpy(), expected[rows], rtol=1e-4, atol=1e-4)
+    # the sums follow the order of the data whatever the split among threads
+    assert (grads[0].data.asnumpy() == grads[1].data.asnumpy()).all()
+
+
+def test_hashed_embedding():
+    def hashed_row(i, h, num_rows):
+        mask = (1 << 64) - 1
+        x = (int(i) + (h + 1) * 0x9e3779b97f4a7c15) & mask
+        x = ((x ^ (x >> 30)) * 0xbf58476d1ce4e5b9) & mask
+        x = ((x ^ (x >> 27)) * 0x94d049bb133111eb) & mask
+        return (x ^ (x >> 31)) % num_rows
+
+    in_dim, out_dim, num_hashes = 37, 5, 3
+    # raw ids, far outside the rows of the weight
+    np_data = np.random.randint(0, 1 << 40, size=(4, 6)).astype(np.int64)
+    np_data[0, :3] = np_data[1, :3]
+    data = mx.nd.array(np_data, dtype=np.int64)
+    weight = mx.nd.random.uniform(shape=(in_dim, out_dim))
+    ograd = mx.nd.random.uniform(-1, 1, shape=np_data.shape + (out_dim,))
+    rows = np.array([[hashed_row(i, h, in_dim) for i in np_data.reshape(-1)]
+                     for h in range(num_hashes)])
+    expected_out = weight.asnumpy()[rows].sum(axis=0).reshape(ograd.shape)
+    expected_grad = np.zeros((in_dim, out_dim), dtype=np.float32)
+    for h in range(num_hashes):
+        np.add.at(expected_grad, rows[h], ograd.asnumpy().reshape(-1, out_dim))
+    for sparse_grad in [False, True]:
+        weight.attach_grad(stype='row_sparse' if sparse_grad else 'default')
+        with mx.autograd.record():
+            out = mx.nd.contrib.HashedEmbedding(data, weight, input_dim=in_dim,
+                                                output_dim=out_dim, num_hashes=num_hashes,
+                                                sparse_grad=sparse_grad)
+        out.backward(ograd)
+        assert_almost_equal(out.asnumpy(), expected_out, rtol=1e-5, atol=1e-5)
+        assert weight.grad.stype == ('row_sparse' if sparse_grad else 'default')
+        assert_almost_equal(weight.grad.asnumpy(), expected_grad, rtol=1e-4, atol=1e-4)
+        if sparse_grad:
+            assert_almost_equal(weight.grad.indices.asnumpy(), np.unique(rows))
+
 def test_sparse_broadcast_add_sub():
     def check_broadcast_add(mx_lhs, mx_rhs, np_lhs, np_rhs, dtype):
         assert_almost_equal(mx.nd.sparse.add(mx_lhs, mx_rhs).asnumpy(), np.add(np_lhs, np_rhs), atol=1e-4)
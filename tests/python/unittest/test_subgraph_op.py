@@ -17,6 +17,7 @@
 
 import os
 import sys
+import json
 import ctypes
 import mxnet as mx
 from mxnet.base import SymbolHandle, check_call, _LIB, mx_uint, c_str_array, c_str, mx_real_t
@@ -525,6 +526,94 @@ def test_subgraph_backend_gluon_ext2(tmpdir):
     for i in range(len(outputs1)):
         assert_almost_equal(mx.np.abs(outputs1[i] - outputs2[i]).sum().asnumpy(), onp.zeros(shape=(1,)))
 
+@pytest.mark.parametrize('subgraph_backend', ['default', 'default_v2'])
+@pytest.mark.parametrize('options,num_subgraphs', [
+    ({}, 1),
+    ({'min_subgraph_size': 2}, 1),
+    ({'min_subgraph_size': 3}, 0),
+    ({'subgraph_transition_cost': 0.5}, 1),
+    ({'subgraph_transition_cost': 1}, 0),
+])
+def test_subgraph_cost_model(subgraph_backend, options, num_subgraphs, tmp_path):
+    # sin and cos form a subgraph of 2 nodes with one input and one output
+    data = mx.sym.var('data', shape=(2, 3))
+    sym = mx.sym.exp(mx.sym.cos(mx.sym.sin(data)))
+    report_file = str(tmp_path / 'report.json')
+    check_call(_LIB.MXSetSubgraphPropertyOpNamesV2(c_str(subgraph_backend), mx_uint(2),
+                                                   c_str_array(['sin', 'cos'])))
+    part_sym = sym.optimize_for(subgraph_backend, partition_report=report_file, **options)
+    check_call(_LIB.MXRemoveSubgraphPropertyOpNamesV2(c_str(subgraph_backend)))
+
+    assert part_sym.tojson().count('"_CachedOp"') == num_subgraphs
+    with open(report_file) as f:
+        report = json.loads(f.readline())
+    assert len(report) == 1
+    assert sorted(report[0]['nodes']) == sorted(n.name for n in sym.get_internals()
+                                                if n.name.startswith(('sin', 'cos')))
+    assert report[0]['decision'] == ('accepted' if num_subgraphs else 'rejected')
+
+
+def test_constant_folding():
+    data = mx.sym.var('data')
+    conv = mx.sym.Convolution(data, kernel=(3, 3), num_filter=4, name='conv')
+    bn = mx.sym.BatchNorm(conv, fix_gamma=False, name='bn')
+    # the transpose and the cast of the weight only depend on parameters
+    weight = mx.sym.amp_cast(mx.sym.transpose(mx.sym.var('fc_weight_t')), dtype='float32',
+                             name='fc_weight')
+    sym = mx.sym.FullyConnected(bn, weight, num_hidden=5, no_bias=True, name='fc')
+    args = {'data': mx.nd.random.uniform(shape=(2, 3, 6, 6)),
+            'conv_weight': mx.nd.random.uniform(-1, 1, (4, 3, 3, 3)),
+            'conv_bias': mx.nd.random.uniform(-1, 1, (4,)),
+            'bn_gamma': mx.nd.random.uniform(0.5, 2, (4,)),
+            'bn_beta': mx.nd.random.uniform(-1, 1, (4,)),
+            'fc_weight_t': mx.nd.random.uniform(-1, 1, (64, 5))}
+    aux = {'bn_moving_mean': mx.nd.random.uniform(-1, 1, (4,)),
+           'bn_moving_var': mx.nd.random.uniform(0.5, 2, (4,))}
+    exe = sym._bind(ctx=mx.cpu(), args=dict(args), aux_states=aux, grad_req='null')
+    # the data given in shape_dict is not folded, though its array is in args, which gets the
+    # new arguments
+    folded = sym.optimize_for('ConstantFolding', args, aux,
+                              shape_dict={'data': args['data'].shape})
+
+    ops = [node['op'] for node in json.loads(folded.tojson())['nodes']]
+    assert ops == ['null', 'null', 'null', 'Convolution', 'null', 'FullyConnected']
+    assert sorted(folded.list_arguments()) == \
+        ['conv_folded_bias', 'conv_folded_weight', 'data', 'fc_weight_const']
+    assert folded.list_auxiliary_states() == []
+    # the folded layer keeps the name of BatchNorm, whose outputs it computes
+    internals = folded.get_internals().list_outputs()
+    assert 'bn_output' in internals and 'conv_output' not in internals
+
+    folded_exe = folded._bind(ctx=mx.cpu(), args=args, aux_states={}, grad_req='null')
+    exe.forward(is_train=False)
+    folded_exe.forward(is_train=False)
+    assert_almost_equal(exe.outputs[0], folded_exe.outputs[0], rtol=1e-4, atol=1e-4)
+
+
+def test_constant_folding_float64():
+    # the folded parameters keep the precision of float64
+    data = mx.sym.var('data')
+    conv = mx.sym.Convolution(data, kernel=(3, 3), num_filter=4, name='conv')
+    sym = mx.sym.BatchNorm(conv, fix_gamma=False, eps=1e-8, name='bn')
+    args = {'data': mx.nd.random.uniform(shape=(2, 3, 6, 6), dtype='float64'),
+            'conv_weight': mx.nd.random.uniform(-1, 1, (4, 3, 3, 3), dtype='float64'),
+            'conv_bias': mx.nd.random.uniform(-1, 1, (4,), dtype='float64'),
+            'bn_gamma': mx.nd.random.uniform(0.5, 2, (4,), dtype='float64'),
+            'bn_beta': mx.nd.random.uniform(-1, 1, (4,), dtype='float64')}
+    aux = {'bn_moving_mean': mx.nd.random.uniform(-1, 1, (4,), dtype='float64'),
+           'bn_moving_var': mx.nd.random.uniform(0.5, 2, (4,), dtype='float64')}
+    params = {k: v for k, v in args.items() if k != 'data'}
+    folded = sym.optimize_for('ConstantFolding', params, aux)
+    assert sorted(folded.list_arguments()) == ['conv_folded_bias', 'conv_folded_weight', 'data']
+
+    exe = sym._bind(ctx=mx.cpu(), args=args, aux_states=aux, grad_req='null')
+    folded_exe = folded._bind(ctx=mx.cpu(), args=dict(params, data=args['data']),
+                              aux_states={}, grad_req='null')
+    exe.forward(is_train=False)
+    folded_exe.forward(is_train=False)
+    assert folded_exe.outputs[0].dtype == onp.float64
+    assert_almost_equal(exe.outputs[0], folded_exe.outputs[0], rtol=1e-10, atol=1e-10)
+
 
 if __name__ == "__main__":
     import datetime
@@ -113,6 +113,20 @@ def test_symbol_saveload():
     assert sym.tojson() == data2.tojson()
     os.remove(fname)
 
+
+def test_symbol_binary_saveload(tmpdir):
+    data = mx.sym.var('data', shape=(2, 0), __lr_mult__='"2"')
+    sym = mx.sym.Group([models.mlp2(), mx.sym.Activation(data, act_type='relu', name='a\\b')])
+    buf = sym.tobinary()
+    assert mx.sym.frombinary(buf).tobinary() == buf
+    assert mx.sym.frombinary(buf).tojson() == sym.tojson()
+    fname = os.path.join(str(tmpdir), 'sym.bin')
+    sym.save(fname, binary=True)
+    assert mx.sym.load(fname).tojson() == sym.tojson()
+    # the JSON of the current version is read in a single pass, attributes with escapes too
+    assert mx.sym.fromjson(sym.tojson()).tojson() == sym.tojson()
+    assertRaises(mx.MXNetError, mx.sym.frombinary, buf[:-4])
+
 def test_symbol_infer_shape():
     num_hidden = 128
     num_dim    = 64
@@ -24,14 +24,25 @@
  *  The 64bit zero pad was reserved for future purposes
  *
  *  Image List Format: unique-image-index label[s] path-to-image
+ *
+ *  Images are packed by num_thread workers and written in the order of the list. With
+ *  num_shards > 1 the records are spread over shards of balanced sizes, each with an index of
+ *  the offsets of its records, which can be read together by ImageRecordIter with num_parts.
  * \sa dmlc/recordio.h
  */
+#include <algorithm>
 #include <cctype>
 #include <cstring>
 #include <string>
 #include <vector>
 #include <iomanip>
 #include <sstream>
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <dmlc/base.h>
 #include <dmlc/io.h>
 #include <dmlc/timer.h>
@@ -67,6 +78,151 @@ int GetInterMethod(int inter_method,
     return inter_method;
   }
 }
+/*! \brief settings of the conversion of an image into a record */
+struct PackParam {
+  std::string root;
+  int label_width;
+  int pack_label;
+  int new_size;
+  int center_crop;
+  int color_mode;
+  int unchanged;
+  int inter_method;
+  std::string encoding;
+  std::vector<int> encode_params;
+};
+
+/*!
+ * \brief convert a line of the image list into the content of its record
+ * \return false for lines without an index and a label, which are skipped
+ */
+bool PackRecord(const std::string& sline,
+                const PackParam& param,
+                std::mt19937* prnd,
+                uint64_t* image_id,
+                std::string* blob) {
+  using dmlc::BeginPtr;
+  const static size_t kBufferSize = 1 << 20UL;
+  mxnet::io::ImageRecordIO rec;
+  std::istringstream is(sline);
+  if (!(is >> rec.header.image_id[0] >> rec.header.label))
+    return false;
+  *image_id = rec.header.image_id[0];
+  std::vector<float> label_buf(param.label_width, 0.f);
+  label_buf[0] = rec.header.label;
+  for (int k = 1; k < param.label_width; ++k) {
+    CHECK(is >> label_buf[k]) << "Invalid ImageList, did you provide the correct label_width?";
+  }
+  if (param.pack_label)
+    rec.header.flag = param.label_width;
+  rec.SaveHeader(blob);
+  if (param.pack_label) {
+    size_t bsize = blob->size();
+    blob->resize(bsize + label_buf.size() * sizeof(float));
+    memcpy(BeginPtr(*blob) + bsize, BeginPtr(label_buf), label_buf.size() * sizeof(float));
+  }
+  std::string fname;
+  CHECK(std::getline(is, fname));
+  // eliminate invalid chars in the end
+  while (fname.length() != 0 && (isspace(*fname.rbegin()) || !isprint(*fname.rbegin()))) {
+    fname.resize(fname.length() - 1);
+  }
+  // eliminate invalid chars in beginning.
+  const char* p = fname.c_str();
+  while (isspace(*p))
+    ++p;
+  std::string path = param.root + p;
+  // use "r" is equal to rb in dmlc::Stream
+  std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(path.c_str(), "r"));
+  std::vector<unsigned char> decode_buf;
+  size_t imsize = 0;
+  while (true) {
+    decode_buf.resize(imsize + kBufferSize);
+    size_t nread = fi->Read(BeginPtr(decode_buf) + imsize, kBufferSize);
+    imsize += nread;
+    decode_buf.resize(imsize);
+    if (nread != kBufferSize)
+      break;
+  }
+  fi.reset();
+
+  if (param.unchanged != 1) {
+    const int new_size = param.new_size;
+    cv::Mat img        = cv::imdecode(decode_buf, param.color_mode);
+    CHECK(img.data != nullptr) << "OpenCV decode fail:" << path;
+    cv::Mat res = img;
+    if (new_size > 0) {
+      if (param.center_crop) {
+        if (img.rows > img.cols) {
+          int margin = (img.rows - img.cols) / 2;
+          img        = img(cv::Range(margin, margin + img.cols), cv::Range(0, img.cols));
+        } else {
+          int margin = (img.cols - img.rows) / 2;
+          img        = img(cv::Range(0, img.rows), cv::Range(margin, margin + img.rows));
+        }
+      }
+      int interpolation_method = 1;
+      if (img.rows > img.cols) {
+        if (img.cols != new_size) {
+          interpolation_method = GetInterMethod(param.inter_method,
+                                                img.cols,
+                                                img.rows,
+                                                new_size,
+                                                img.rows * new_size / img.cols,
+                                                *prnd);
+          cv::resize(img,
+                     res,
+                     cv::Size(new_size, img.rows * new_size / img.cols),
+                     0,
+                     0,
+                     interpolation_method);
+        } else {
+          res = img.clone();
+        }
+      } else {
+        if (img.rows != new_size) {
+          interpolation_method = GetInterMethod(param.inter_method,
+                                                img.cols,
+                                                img.rows,
+                                                new_size * img.cols / img.rows,
+                                                new_size,
+                                                *prnd);
+          cv::resize(img,
+                     res,
+                     cv::Size(new_size * img.cols / img.rows, new_size),
+                     0,
+                     0,
+                     interpolation_method);
+        } else {
+          res = img.clone();
+        }
+      }
+    }
+    std::vector<unsigned char> encode_buf;
+    CHECK(cv::imencode(param.encoding, res, encode_buf, param.encode_params));
+
+    // write buffer
+    size_t bsize = blob->size();
+    blob->resize(bsize + encode_buf.size());
+    memcpy(BeginPtr(*blob) + bsize, BeginPtr(encode_buf), encode_buf.size());
+  } else {
+    size_t bsize = blob->size();
+    blob->resize(bsize + decode_buf.size());
+    memcpy(BeginPtr(*blob) + bsize, BeginPtr(decode_buf), decode_buf.size());
+  }
+  return true;
+}
+
+/*! \brief output file of records, with the index of their offsets when sharded */
+struct RecordShard {
+  std::string rec_path;
+  std::string idx_path;
+  std::unique_ptr<dmlc::Stream> rec_file;
+  std::unique_ptr<dmlc::Stream> idx_file;
+  std::unique_ptr<dmlc::RecordIOWriter> writer;
+  size_t bytes = 0;
+};
+
 int main(int argc, char* argv[]) {
   if (argc < 4) {
     printf(
@@ -92,7 +248,13 @@ int main(int argc, char* argv[]) {
         "\tinter_method=INTER_METHOD[default=1] NN(0) BILINEAR(1) CUBIC(2) AREA(3) LANCZOS4(4) "
         "AUTO(9) RAND(10).\n"
         "\tunchanged=UNCHANGED[default=0] Keep the original image encoding, size and color. If set "
-        "to 1, it will ignore the others parameters.\n");
+        "to 1, it will ignore the others parameters.\n"
+        "\tnum_thread=NUM_THREAD[default=1] number of threads reading, resizing and encoding the "
+        "images. Records are written in the order of the list.\n"
+        "\tnum_shards=NUM_SHARDS[default=1] spread the records over NUM_SHARDS output files of "
+        "balanced sizes, <output>.shardXXX.rec, each with its index <output>.shardXXX.idx. The "
+        "offsets of the index are read from the output, which must be seekable, e.g. a local "
+        "file.\n");
     return 0;
   }
   int label_width  = 1;
@@ -105,6 +267,8 @@ int main(int argc, char* argv[]) {
   int color_mode   = CV_LOAD_IMAGE_COLOR;
   int unchanged    = 0;
   int inter_method = CV_INTER_LINEAR;
+  int num_thread   = 1;
+  int num_shards   = 1;
   std::string encoding(".jpg");
   for (int i = 4; i < argc; ++i) {
     char key[128], val[128];
@@ -139,6 +303,10 @@ int main(int argc, char* argv[]) {
         unchanged = atoi(val);
       if (!strcmp(key, "inter_method"))
         inter_method = atoi(val);
+      if (!strcmp(key, "num_thread"))
+        num_thread = atoi(val);
+      if (!strcmp(key, "num_shards"))
+        num_shards = atoi(val);
     }
   }
   // Check parameters ranges
@@ -151,6 +319,9 @@ int main(int argc, char* argv[]) {
   if (label_width <= 1 && pack_label) {
     LOG(FATAL) << "pack_label can only be used when label_width > 1";
   }
+  if (num_thread < 1 || num_shards < 1) {
+    LOG(FATAL) << "num_thread and num_shards must be positive.";
+  }
   if (new_size > 0) {
     LOG(INFO) << "New Image Size: Short Edge " << new_size;
   } else {
@@ -195,146 +366,169 @@ int main(int argc, char* argv[]) {
         return 0;
     }
   }
-  std::random_device rd;
-  std::mt19937 prnd(rd());
-  using namespace dmlc;
-  const static size_t kBufferSize = 1 << 20UL;
-  std::string root                = argv[2];
-  mxnet::io::ImageRecordIO rec;
-  size_t imcnt            = 0;
-  double tstart           = dmlc::GetTime();
-  dmlc::InputSplit* flist = dmlc::InputSplit::Create(argv[1], partid, nsplit, "text");
+  PackParam param;
+  param.root         = argv[2];
+  param.label_width  = label_width;
+  param.pack_label   = pack_label;
+  param.new_size     = new_size;
+  param.center_crop  = center_crop;
+  param.color_mode   = color_mode;
+  param.unchanged    = unchanged;
+  param.inter_method = inter_method;
+  param.encoding     = encoding;
+  if (encoding == std::string(".png")) {
+    param.encode_params.push_back(CV_IMWRITE_PNG_COMPRESSION);
+    param.encode_params.push_back(quality);
+    LOG(INFO) << "PNG encoding compression: " << quality;
+  } else {
+    param.encode_params.push_back(CV_IMWRITE_JPEG_QUALITY);
+    param.encode_params.push_back(quality);
+    LOG(INFO) << "JPEG encoding quality: " << quality;
+  }
+
+  size_t imcnt  = 0;
+  double tstart = dmlc::GetTime();
+  std::unique_ptr<dmlc::InputSplit> flist(
+      dmlc::InputSplit::Create(argv[1], partid, nsplit, "text"));
   std::ostringstream os;
   if (nsplit == 1) {
     os << argv[3];
   } else {
     os << argv[3] << ".part" << std::setw(3) << std::setfill('0') << partid;
   }
-  LOG(INFO) << "Write to output: " << os.str();
-  dmlc::Stream* fo = dmlc::Stream::Create(os.str().c_str(), "w");
-  LOG(INFO) << "Output: " << os.str();
-  dmlc::RecordIOWriter writer(fo);
-  std::string fname, path, blob;
-  std::vector<unsigned char> decode_buf;
-  std::vector<unsigned char> encode_buf;
-  std::vector<int> encode_params;
-  if (encoding == std::string(".png")) {
-    encode_params.push_back(CV_IMWRITE_PNG_COMPRESSION);
-    encode_params.push_back(quality);
-    LOG(INFO) << "PNG encoding compression: " << quality;
+  std::vector<RecordShard> shards(num_shards);
+  if (num_shards == 1) {
+    shards[0].rec_path = os.str();
   } else {
-    encode_params.push_back(CV_IMWRITE_JPEG_QUALITY);
-    encode_params.push_back(quality);
-    LOG(INFO) << "JPEG encoding quality: " << quality;
-  }
-  dmlc::InputSplit::Blob line;
-  std::vector<float> label_buf(label_width, 0.f);
-
-  while (flist->NextRecord(&line)) {
-    std::string sline(static_cast<char*>(line.dptr), line.size);
-    std::istringstream is(sline);
-    if (!(is >> rec.header.image_id[0] >> rec.header.label))
-      continue;
-    label_buf[0] = rec.header.label;
-    for (int k = 1; k < label_width; ++k) {
-      CHECK(is >> label_buf[k]) << "Invalid ImageList, did you provide the correct label_width?";
-    }
-    if (pack_label)
-      rec.header.flag = label_width;
-    rec.SaveHeader(&blob);
-    if (pack_label) {
-      size_t bsize = blob.size();
-      blob.resize(bsize + label_buf.size() * sizeof(float));
-      memcpy(BeginPtr(blob) + bsize, BeginPtr(label_buf), label_buf.size() * sizeof(float));
+    std::string stem = os.str();
+    if (stem.size() > 4 && stem.compare(stem.size() - 4, 4, ".rec") == 0)
+      stem.resize(stem.size() - 4);
+    for (int k = 0; k < num_shards; ++k) {
+      std::ostringstream shard;
+      shard << stem << ".shard" << std::setw(3) << std::setfill('0') << k;
+      shards[k].rec_path = shard.str() + ".rec";
+      shards[k].idx_path = shard.str() + ".idx";
     }
-    CHECK(std::getline(is, fname));
-    // eliminate invalid chars in the end
-    while (fname.length() != 0 && (isspace(*fname.rbegin()) || !isprint(*fname.rbegin()))) {
-      fname.resize(fname.length() - 1);
-    }
-    // eliminate invalid chars in beginning.
-    const char* p = fname.c_str();
-    while (isspace(*p))
-      ++p;
-    path = root + p;
-    // use "r" is equal to rb in dmlc::Stream
-    dmlc::Stream* fi = dmlc::Stream::Create(path.c_str(), "r");
-    decode_buf.clear();
-    size_t imsize = 0;
-    while (true) {
-      decode_buf.resize(imsize + kBufferSize);
-      size_t nread = fi->Read(BeginPtr(decode_buf) + imsize, kBufferSize);
-      imsize += nread;
-      decode_buf.resize(imsize);
-      if (nread != kBufferSize)
-        break;
+  }
+  for (auto& shard : shards) {
+    LOG(INFO) << "Write to output: " << shard.rec_path;
+    shard.rec_file.reset(dmlc::Stream::Create(shard.rec_path.c_str(), "w"));
+    shard.writer.reset(new dmlc::RecordIOWriter(shard.rec_file.get()));
+    if (!shard.idx_path.empty()) {
+      // RecordIOWriter::Tell gives the offsets of the index from the position of the stream
+      CHECK(dynamic_cast<dmlc::SeekStream*>(shard.rec_file.get()) != nullptr)
+          << "num_shards > 1 needs a seekable output to index the records, "
+          << shard.rec_path << " is not";
+      shard.idx_file.reset(dmlc::Stream::Create(shard.idx_path.c_str(), "w"));
     }
-    delete fi;
+  }
+  LOG(INFO) << "Use " << num_thread << " threads";
 
-    if (unchanged != 1) {
-      cv::Mat img = cv::imdecode(decode_buf, color_mode);
-      CHECK(img.data != nullptr) << "OpenCV decode fail:" << path;
-      cv::Mat res = img;
-      if (new_size > 0) {
-        if (center_crop) {
-          if (img.rows > img.cols) {
-            int margin = (img.rows - img.cols) / 2;
-            img        = img(cv::Range(margin, margin + img.cols), cv::Range(0, img.cols));
-          } else {
-            int margin = (img.cols - img.rows) / 2;
-            img        = img(cv::Range(0, img.rows), cv::Range(margin, margin + img.rows));
+  // workers take the lines of the list in turn and pack them, the main thread writes the records
+  // in the order of the list. Workers stay at most max_pending records ahead of the writer.
+  const size_t max_pending = 4 * num_thread;
+  std::mutex mutex;
+  std::condition_variable packed_cond, written_cond;
+  std::map<size_t, std::pair<uint64_t, std::string>> packed;
+  size_t num_read = 0, num_written = 0;
+  bool list_end = false;
+  int num_running = num_thread;
+  std::exception_ptr error;
+  std::random_device rd;
+  std::vector<std::thread> workers;
+  for (int t = 0; t < num_thread; ++t) {
+    workers.emplace_back([&, seed = rd()]() {
+      std::mt19937 prnd(seed);
+      std::string line;
+      while (true) {
+        size_t seq;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          written_cond.wait(lock, [&]() {
+            return error || list_end || num_read < num_written + max_pending;
+          });
+          dmlc::InputSplit::Blob blob;
+          if (error || list_end || !flist->NextRecord(&blob)) {
+            list_end = true;
+            break;
           }
+          line.assign(static_cast<char*>(blob.dptr), blob.size);
+          seq = num_read++;
         }
-        int interpolation_method = 1;
-        if (img.rows > img.cols) {
-          if (img.cols != new_size) {
-            interpolation_method = GetInterMethod(
-                inter_method, img.cols, img.rows, new_size, img.rows * new_size / img.cols, prnd);
-            cv::resize(img,
-                       res,
-                       cv::Size(new_size, img.rows * new_size / img.cols),
-                       0,
-                       0,
-                       interpolation_method);
-          } else {
-            res = img.clone();
-          }
-        } else {
-          if (img.rows != new_size) {
-            interpolation_method = GetInterMethod(
-                inter_method, img.cols, img.rows, new_size * img.cols / img.rows, new_size, prnd);
-            cv::resize(img,
-                       res,
-                       cv::Size(new_size * img.cols / img.rows, new_size),
-                       0,
-                       0,
-                       interpolation_method);
-          } else {
-            res = img.clone();
-          }
+        uint64_t image_id = 0;
+        std::string record;
+        try {
+          // skipped lines are written as empty records, which are dropped
+          if (!PackRecord(line, param, &prnd, &image_id, &record))
+            record.clear();
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!error)
+            error = std::current_exception();
+          break;
+        }
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          packed.emplace(seq, std::make_pair(image_id, std::move(record)));
         }
+        packed_cond.notify_all();
       }
-      encode_buf.clear();
-      CHECK(cv::imencode(encoding, res, encode_buf, encode_params));
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        --num_running;
+      }
+      written_cond.notify_all();
+      packed_cond.notify_all();
+    });
+  }
 
-      // write buffer
-      size_t bsize = blob.size();
-      blob.resize(bsize + encode_buf.size());
-      memcpy(BeginPtr(blob) + bsize, BeginPtr(encode_buf), encode_buf.size());
-    } else {
-      size_t bsize = blob.size();
-      blob.resize(bsize + decode_buf.size());
-      memcpy(BeginPtr(blob) + bsize, BeginPtr(decode_buf), decode_buf.size());
+  while (true) {
+    std::pair<uint64_t, std::string> record;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      packed_cond.wait(
+          lock, [&]() { return error || packed.count(num_written) || num_running == 0; });
+      auto it = packed.find(num_written);
+      if (error || it == packed.end())
+        break;
+      record = std::move(it->second);
+      packed.erase(it);
+      ++num_written;
     }
-    writer.WriteRecord(BeginPtr(blob), blob.size());
-    // write header
+    written_cond.notify_all();
+    if (record.second.empty())
+      continue;
+    // the smallest shard takes the record, so that they are balanced
+    RecordShard& shard = *std::min_element(
+        shards.begin(), shards.end(), [](const RecordShard& a, const RecordShard& b) {
+          return a.bytes < b.bytes;
+        });
+    if (shard.idx_file) {
+      std::ostringstream entry;
+      entry << record.first << '\t' << shard.writer->Tell() << '\n';
+      shard.idx_file->Write(entry.str().data(), entry.str().size());
+    }
+    shard.writer->WriteRecord(dmlc::BeginPtr(record.second), record.second.size());
+    shard.bytes += record.second.size();
     ++imcnt;
     if (imcnt % 1000 == 0) {
-      LOG(INFO) << imcnt << " images processed, " << GetTime() - tstart << " sec elapsed";
+      LOG(INFO) << imcnt << " images processed, " << dmlc::GetTime() - tstart << " sec elapsed";
+    }
+  }
+  for (auto& worker : workers)
+    worker.join();
+  if (error)
+    std::rethrow_exception(error);
+  LOG(INFO) << "Total: " << imcnt << " images processed, " << dmlc::GetTime() - tstart
+            << " sec elapsed";
+  if (num_shards > 1) {
+    std::string rec_paths, idx_paths;
+    for (const auto& shard : shards) {
+      rec_paths += (rec_paths.empty() ? "" : ";") + shard.rec_path;
+      idx_paths += (idx_paths.empty() ? "" : ";") + shard.idx_path;
     }
+    LOG(INFO) << "Read the shards with path_imgrec=\"" << rec_paths << "\" path_imgidx=\""
+              << idx_paths << "\"";
   }
-  LOG(INFO) << "Total: " << imcnt << " images processed, " << GetTime() - tstart << " sec elapsed";
-  delete fo;
-  delete flist;
   return 0;
 }